@@ -105,11 +105,7 @@ void SystemInit(void)
     ResetSource = XPD_RCC_GetResetSource(TRUE);
 
     /* TODO Configure system memory options */
-    XPD_FLASH_InstCacheCtrl(ENABLE);
-
-    XPD_FLASH_DataCacheCtrl(ENABLE);
-
-    XPD_FLASH_PrefetchBufferCtrl(ENABLE);
+    XPD_FLASH_AcceleratorCtrl(ENABLE);
 
     /* TODO Set Interrupt Group Priority */
     XPD_NVIC_SetPriorityGroup(NVIC_PRIOGROUP_0PRE_4SUB);
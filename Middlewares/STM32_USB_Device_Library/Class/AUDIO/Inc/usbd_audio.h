@@ -0,0 +1,190 @@
+/**
+ ******************************************************************************
+ * @file    usbd_audio.h
+ * @author  Benedek Kupper
+ * @version V0.1
+ * @date    2018-01-20
+ * @brief   header file for the usbd_audio.c file.
+ ******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; COPYRIGHT 2015 STMicroelectronics</center></h2>
+ *
+ * Licensed under MCD-ST Liberty SW License Agreement V2, (the "License");
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *        http://www.st.com/software_license_agreement_liberty_v2
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************************
+ */
+#ifndef __USB_AUDIO_H
+#define __USB_AUDIO_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include  "usbd_ioreq.h"
+
+/** @addtogroup STM32_USB_DEVICE_LIBRARY
+ * @{
+ */
+
+/** @defgroup usbd_audio
+ * @brief This file is the Header file for usbd_audio.c
+ * @{
+ */
+
+/** @defgroup usbd_audio_Exported_Defines
+ * @{
+ */
+#define AUDIO_OUT_EP                                0x01  /* EP1 for isochronous audio data OUT */
+#define AUDIO_FB_EP                                 0x81  /* EP1 for explicit rate feedback IN */
+
+/* Audio stream format parameters */
+#ifndef AUDIO_SAMPLE_RATE
+#define AUDIO_SAMPLE_RATE                           48000 /* Sample rate in Hz */
+#endif
+#ifndef AUDIO_CHANNELS
+#define AUDIO_CHANNELS                              2     /* Number of channels (1 or 2) */
+#endif
+#ifndef AUDIO_SUBFRAME_SIZE
+#define AUDIO_SUBFRAME_SIZE                         2     /* Bytes per channel sample */
+#endif
+
+/* Rate feedback parameters: the feedback is measured by capturing a free-running counter
+ * at each SOF, the counter is clocked by the codec (e.g. MCLK through timer ETR)
+ * and advances AUDIO_FB_CLOCK_RATIO ticks per audio sample. */
+#ifndef AUDIO_FB_REFRESH
+#define AUDIO_FB_REFRESH                            3     /* Feedback period is 2^AUDIO_FB_REFRESH frames (1 .. 9) */
+#endif
+#ifndef AUDIO_FB_CLOCK_RATIO
+#define AUDIO_FB_CLOCK_RATIO                        256   /* Counter ticks per audio sample */
+#endif
+#ifndef AUDIO_FB_COUNTER_MASK
+#define AUDIO_FB_COUNTER_MASK                       0xFFFFFFFF /* Value range of the captured counter */
+#endif
+
+/* A packet carries one frame's samples, plus one when the host speeds up on feedback */
+#define AUDIO_FRAME_SIZE                            (AUDIO_CHANNELS * AUDIO_SUBFRAME_SIZE)
+#define AUDIO_OUT_PACKET_SIZE                       ((AUDIO_SAMPLE_RATE / 1000 + 1) * AUDIO_FRAME_SIZE)
+#define AUDIO_FB_PACKET_SIZE                        3     /* 10.14 fixed point samples per frame */
+
+/* The nominal feedback value */
+#define AUDIO_FB_NOMINAL                            (((uint32_t)AUDIO_SAMPLE_RATE << 14) / 1000)
+
+#define USB_AUDIO_CONFIG_DESC_SIZ                   119
+
+/*---------------------------------------------------------------------*/
+/*  Audio definitions                                                  */
+/*---------------------------------------------------------------------*/
+#define AUDIO_DESCRIPTOR_TYPE_INTERFACE             0x24
+#define AUDIO_DESCRIPTOR_TYPE_ENDPOINT              0x25
+
+#define AUDIO_REQ_SET_CUR                           0x01
+#define AUDIO_REQ_GET_CUR                           0x81
+#define AUDIO_REQ_GET_MIN                           0x82
+#define AUDIO_REQ_GET_MAX                           0x83
+#define AUDIO_REQ_GET_RES                           0x84
+
+#define AUDIO_CONTROL_MUTE                          0x01
+#define AUDIO_CONTROL_SAMPLING_FREQ                 0x01
+
+/* Entity IDs of the audio function */
+#define AUDIO_INPUT_TERMINAL_ID                     0x01
+#define AUDIO_FEATURE_UNIT_ID                       0x02
+#define AUDIO_OUTPUT_TERMINAL_ID                    0x03
+
+/**
+ * @}
+ */
+
+/** @defgroup USBD_CORE_Exported_TypesDefinitions
+ * @{
+ */
+
+typedef struct _USBD_AUDIO_Itf
+{
+    void (*Init)(void);
+    void (*DeInit)(void);
+    void (*Streaming)(uint8_t);             /* Streaming interface activated (1) or deactivated (0) */
+    void (*Received)(uint8_t *, uint32_t);  /* Audio packet received */
+    void (*Mute)(uint8_t);                  /* Mute control changed */
+    void (*StartOfFrame)(void);             /* Only called when SOF is enabled in the USB driver */
+} USBD_AUDIO_ItfTypeDef;
+
+typedef struct
+{
+    uint32_t Packet[2][(AUDIO_OUT_PACKET_SIZE + 3) / 4]; /* Force 32bits alignment */
+    uint32_t data[1];                       /* Control request data */
+    uint8_t  FbPacket[4];                   /* Feedback value in transfer */
+    uint32_t SampleRate;                    /* Sampling frequency set by the host */
+    uint32_t Feedback;                      /* Current 10.14 feedback value */
+    struct {
+        uint32_t LastCapture;               /* Counter value at the previous SOF */
+        uint32_t Sum;                       /* Counter ticks accumulated in the period */
+        uint16_t Frames;                    /* Number of frames accumulated in the period */
+    } FbMeasure;
+    uint8_t  CmdOpCode;
+    uint8_t  CmdTarget;                     /* Recipient of the pending SET_CUR request */
+    uint8_t  CmdLength;
+    uint8_t  AltSetting;
+    uint8_t  Muted;
+    uint8_t  Index;                         /* Index of the receiving packet buffer */
+    volatile uint8_t FbBusy;                /* Feedback transfer is in progress */
+} USBD_AUDIO_HandleTypeDef;
+
+/**
+ * @}
+ */
+
+/** @defgroup USBD_CORE_Exported_Variables
+ * @{
+ */
+
+extern const USBD_ClassTypeDef USBD_AUDIO;
+#define USBD_AUDIO_CLASS    &USBD_AUDIO
+
+/**
+ * @}
+ */
+
+/** @defgroup USB_CORE_Exported_Functions
+ * @{
+ */
+
+uint8_t USBD_AUDIO_RegisterInterface(USBD_HandleTypeDef *pdev,
+        const USBD_AUDIO_ItfTypeDef *fops);
+
+void USBD_AUDIO_FeedbackCapture(USBD_HandleTypeDef *pdev, uint32_t capture);
+
+void USBD_AUDIO_SetFeedback(USBD_HandleTypeDef *pdev, uint32_t feedback);
+
+/**
+ * @}
+ */
+
+/**
+ * @}
+ */
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* __USB_AUDIO_H */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -0,0 +1,760 @@
+/**
+ ******************************************************************************
+ * @file    usbd_audio.c
+ * @author  Benedek Kupper
+ * @version V0.1
+ * @date    2018-01-20
+ * @brief   This file provides the high layer firmware functions to manage the
+ *          following functionalities of the USB Audio Class:
+ *           - Initialization and Configuration of high and low layer
+ *           - Enumeration as Audio Streaming Device
+ *           - Isochronous OUT audio data transfer
+ *           - Explicit rate feedback IN transfer
+ *           - Audio control requests management
+ *
+ *  @verbatim
+ *
+ *          ===================================================================
+ *                                AUDIO Class Driver Description
+ *          ===================================================================
+ *           This driver manages the "Universal Serial Bus Device Class Definition for Audio Devices
+ *           Release 1.0 March 18, 1998" and the "Universal Serial Bus Device Class Definition
+ *           for Audio Data Formats Release 1.0 March 18, 1998".
+ *           This driver implements the following aspects of the specification:
+ *             - Device descriptor management
+ *             - Configuration descriptor management
+ *             - Standard AC Interface Descriptor management
+ *             - 1 Audio Streaming Interface (with single channel, PCM, Stereo mode)
+ *             - 1 Audio Streaming Endpoint (asynchronous isochronous OUT)
+ *             - 1 Audio Terminal Input (1 channel)
+ *             - 1 Feedback Endpoint (isochronous IN) for the host to match the codec rate
+ *             - Audio Class-Specific AC Interfaces
+ *             - Audio Class-Specific AS Interfaces
+ *             - AudioControl Requests: only SET_CUR and GET_CUR requests are supported (for Mute)
+ *             - Audio Feature Unit (limited to Mute control)
+ *             - Audio Synchronization type: Asynchronous
+ *             - Single fixed audio sampling rate (configurable by AUDIO_SAMPLE_RATE)
+ *
+ *           The feedback value is the number of samples the codec consumes in a frame,
+ *           measured over 2^AUDIO_FB_REFRESH frames with @ref USBD_AUDIO_FeedbackCapture
+ *           (e.g. from a timer input capture triggered by the USB SOF), or provided
+ *           by the application with @ref USBD_AUDIO_SetFeedback. The feedback transfer
+ *           is armed at SOF, so SOF has to be enabled in the USB driver.
+ *
+ *           This driver doesn't implement the following aspects of the specification
+ *           (but it is possible to manage these features with some modifications on this driver):
+ *             - AudioControl Endpoint management
+ *             - AudioControl requests other than SET_CUR and GET_CUR
+ *             - Abstraction layer for AudioControl requests (only Mute functionality is managed)
+ *             - Audio Class 2.0 and high speed operation
+ *
+ *  @endverbatim
+ *
+ ******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; COPYRIGHT 2015 STMicroelectronics</center></h2>
+ *
+ * Licensed under MCD-ST Liberty SW License Agreement V2, (the "License");
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *        http://www.st.com/software_license_agreement_liberty_v2
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************************
+ */
+
+#include "usbd_audio.h"
+#include "usbd_ctlreq.h"
+
+/** @addtogroup STM32_USB_DEVICE_LIBRARY
+ * @{ */
+
+/** @defgroup USBD_AUDIO
+ * @brief USB Audio Device Class module
+ * @{ */
+
+static uint8_t USBD_AUDIO_Init(USBD_HandleTypeDef *pdev, uint8_t cfgidx);
+
+static uint8_t USBD_AUDIO_DeInit(USBD_HandleTypeDef *pdev, uint8_t cfgidx);
+
+static uint8_t USBD_AUDIO_Setup(USBD_HandleTypeDef *pdev, USBD_SetupReqTypedef *req);
+
+static uint8_t USBD_AUDIO_DataIn(USBD_HandleTypeDef *pdev, uint8_t epnum);
+
+static uint8_t USBD_AUDIO_DataOut(USBD_HandleTypeDef *pdev, uint8_t epnum);
+
+static uint8_t USBD_AUDIO_EP0_RxReady(USBD_HandleTypeDef *pdev);
+
+static uint8_t USBD_AUDIO_SOF(USBD_HandleTypeDef *pdev);
+
+static uint8_t USBD_AUDIO_IsoINIncomplete(USBD_HandleTypeDef *pdev, uint8_t epnum);
+
+static uint8_t USBD_AUDIO_IsoOUTIncomplete(USBD_HandleTypeDef *pdev, uint8_t epnum);
+
+static uint8_t *USBD_AUDIO_GetFSCfgDesc(uint16_t *length);
+
+static uint8_t *USBD_AUDIO_GetDeviceQualifierDescriptor(uint16_t *length);
+
+static void USBD_AUDIO_SetStreaming(USBD_HandleTypeDef *pdev, uint8_t alt);
+
+/* The audio streaming interface number */
+#define AUDIO_STREAMING_ITF             0x01
+
+/* The AUDIO handle and the user interface */
+#define AUDIO_HANDLE(PDEV)              ((USBD_AUDIO_HandleTypeDef*) (PDEV)->pClassData)
+#define AUDIO_ITF(PDEV)                 ((USBD_AUDIO_ItfTypeDef*) (PDEV)->pUserData)
+
+/** @defgroup USBD_AUDIO_Private_Variables
+ * @{ */
+
+/* USB Standard Device Descriptor */
+__ALIGN_BEGIN static const uint8_t USBD_AUDIO_DeviceQualifierDesc[USB_LEN_DEV_QUALIFIER_DESC] __ALIGN_END =
+{
+    USB_LEN_DEV_QUALIFIER_DESC,     /* bLength */
+    USB_DESC_TYPE_DEVICE_QUALIFIER, /* bDescriptorType */
+    0x00, 0x02,                     /* bcdUSB */
+    0x00,                           /* bDeviceClass */
+    0x00,                           /* bDeviceSubClass */
+    0x00,                           /* bDeviceProtocol */
+    0x40,                           /* bMaxPacketSize */
+    0x01,                           /* bNumConfigurations */
+    0x00,                           /* bReserved */
+};
+
+/* AUDIO interface class callbacks structure */
+const USBD_ClassTypeDef USBD_AUDIO = {
+    USBD_AUDIO_Init,
+    USBD_AUDIO_DeInit,
+    USBD_AUDIO_Setup,
+    NULL, /* EP0_TxSent, */
+    USBD_AUDIO_EP0_RxReady,
+    USBD_AUDIO_DataIn,
+    USBD_AUDIO_DataOut,
+    USBD_AUDIO_SOF,
+    USBD_AUDIO_IsoINIncomplete,
+    USBD_AUDIO_IsoOUTIncomplete,
+    NULL,
+    USBD_AUDIO_GetFSCfgDesc,
+    NULL, /* USBD_AUDIO_GetOtherSpeedCfgDesc, */
+    USBD_AUDIO_GetDeviceQualifierDescriptor
+};
+
+/* USB AUDIO device Configuration Descriptor */
+__ALIGN_BEGIN static const uint8_t USBD_AUDIO_CfgDesc[USB_AUDIO_CONFIG_DESC_SIZ] __ALIGN_END =
+{
+    /* Configuration Descriptor */
+    0x09,                                   /* bLength: Configuration Descriptor size */
+    USB_DESC_TYPE_CONFIGURATION,            /* bDescriptorType: Configuration */
+    LOBYTE(USB_AUDIO_CONFIG_DESC_SIZ),      /* wTotalLength: no of returned bytes */
+    HIBYTE(USB_AUDIO_CONFIG_DESC_SIZ),
+    0x02,                                   /* bNumInterfaces: 2 interfaces */
+    0x01,                                   /* bConfigurationValue: Configuration value */
+    0x00,                                   /* iConfiguration: Index of string descriptor describing the configuration */
+    0x80 | (USBD_SELF_POWERED << 6),        /* bmAttributes: self powered */
+    USBD_MAX_POWER_mA / 2,                  /* MaxPower x mA */
+
+    /* Standard AC Interface Descriptor */
+    0x09,                                   /* bLength */
+    USB_DESC_TYPE_INTERFACE,                /* bDescriptorType: Interface */
+    0x00,                                   /* bInterfaceNumber */
+    0x00,                                   /* bAlternateSetting */
+    0x00,                                   /* bNumEndpoints */
+    0x01,                                   /* bInterfaceClass: Audio */
+    0x01,                                   /* bInterfaceSubClass: Audio Control */
+    0x00,                                   /* bInterfaceProtocol */
+    0x00,                                   /* iInterface */
+
+    /* Class-specific AC Interface Header Descriptor */
+    0x09,                                   /* bLength */
+    AUDIO_DESCRIPTOR_TYPE_INTERFACE,        /* bDescriptorType: CS_INTERFACE */
+    0x01,                                   /* bDescriptorSubtype: Header */
+    0x00, 0x01,                             /* bcdADC: 1.00 */
+    0x28, 0x00,                             /* wTotalLength: 40 */
+    0x01,                                   /* bInCollection: 1 streaming interface */
+    AUDIO_STREAMING_ITF,                    /* baInterfaceNr */
+
+    /* Input Terminal Descriptor */
+    0x0C,                                   /* bLength */
+    AUDIO_DESCRIPTOR_TYPE_INTERFACE,        /* bDescriptorType: CS_INTERFACE */
+    0x02,                                   /* bDescriptorSubtype: Input Terminal */
+    AUDIO_INPUT_TERMINAL_ID,                /* bTerminalID */
+    0x01, 0x01,                             /* wTerminalType: USB streaming */
+    0x00,                                   /* bAssocTerminal */
+    AUDIO_CHANNELS,                         /* bNrChannels */
+    (AUDIO_CHANNELS > 1) ? 0x03 : 0x00,     /* wChannelConfig: Left and Right Front */
+    0x00,
+    0x00,                                   /* iChannelNames */
+    0x00,                                   /* iTerminal */
+
+    /* Feature Unit Descriptor */
+    0x0A,                                   /* bLength */
+    AUDIO_DESCRIPTOR_TYPE_INTERFACE,        /* bDescriptorType: CS_INTERFACE */
+    0x06,                                   /* bDescriptorSubtype: Feature Unit */
+    AUDIO_FEATURE_UNIT_ID,                  /* bUnitID */
+    AUDIO_INPUT_TERMINAL_ID,                /* bSourceID */
+    0x01,                                   /* bControlSize */
+    AUDIO_CONTROL_MUTE,                     /* bmaControls(0): Master Mute */
+    0x00,                                   /* bmaControls(1) */
+    0x00,                                   /* bmaControls(2) */
+    0x00,                                   /* iFeature */
+
+    /* Output Terminal Descriptor */
+    0x09,                                   /* bLength */
+    AUDIO_DESCRIPTOR_TYPE_INTERFACE,        /* bDescriptorType: CS_INTERFACE */
+    0x03,                                   /* bDescriptorSubtype: Output Terminal */
+    AUDIO_OUTPUT_TERMINAL_ID,               /* bTerminalID */
+    0x01, 0x03,                             /* wTerminalType: Speaker */
+    0x00,                                   /* bAssocTerminal */
+    AUDIO_FEATURE_UNIT_ID,                  /* bSourceID */
+    0x00,                                   /* iTerminal */
+
+    /* Standard AS Interface Descriptor - Alternate setting 0: zero bandwidth */
+    0x09,                                   /* bLength */
+    USB_DESC_TYPE_INTERFACE,                /* bDescriptorType: Interface */
+    AUDIO_STREAMING_ITF,                    /* bInterfaceNumber */
+    0x00,                                   /* bAlternateSetting */
+    0x00,                                   /* bNumEndpoints */
+    0x01,                                   /* bInterfaceClass: Audio */
+    0x02,                                   /* bInterfaceSubClass: Audio Streaming */
+    0x00,                                   /* bInterfaceProtocol */
+    0x00,                                   /* iInterface */
+
+    /* Standard AS Interface Descriptor - Alternate setting 1: operational */
+    0x09,                                   /* bLength */
+    USB_DESC_TYPE_INTERFACE,                /* bDescriptorType: Interface */
+    AUDIO_STREAMING_ITF,                    /* bInterfaceNumber */
+    0x01,                                   /* bAlternateSetting */
+    0x02,                                   /* bNumEndpoints: data and feedback */
+    0x01,                                   /* bInterfaceClass: Audio */
+    0x02,                                   /* bInterfaceSubClass: Audio Streaming */
+    0x00,                                   /* bInterfaceProtocol */
+    0x00,                                   /* iInterface */
+
+    /* Class-specific AS General Interface Descriptor */
+    0x07,                                   /* bLength */
+    AUDIO_DESCRIPTOR_TYPE_INTERFACE,        /* bDescriptorType: CS_INTERFACE */
+    0x01,                                   /* bDescriptorSubtype: AS General */
+    AUDIO_INPUT_TERMINAL_ID,                /* bTerminalLink */
+    0x01,                                   /* bDelay */
+    0x01, 0x00,                             /* wFormatTag: PCM */
+
+    /* Type I Format Type Descriptor */
+    0x0B,                                   /* bLength */
+    AUDIO_DESCRIPTOR_TYPE_INTERFACE,        /* bDescriptorType: CS_INTERFACE */
+    0x02,                                   /* bDescriptorSubtype: Format Type */
+    0x01,                                   /* bFormatType: Type I */
+    AUDIO_CHANNELS,                         /* bNrChannels */
+    AUDIO_SUBFRAME_SIZE,                    /* bSubFrameSize */
+    8 * AUDIO_SUBFRAME_SIZE,                /* bBitResolution */
+    0x01,                                   /* bSamFreqType: single frequency */
+    (uint8_t)(AUDIO_SAMPLE_RATE),           /* tSamFreq */
+    (uint8_t)(AUDIO_SAMPLE_RATE >> 8),
+    (uint8_t)(AUDIO_SAMPLE_RATE >> 16),
+
+    /* Standard AS Isochronous Audio Data Endpoint Descriptor */
+    0x09,                                   /* bLength */
+    USB_DESC_TYPE_ENDPOINT,                 /* bDescriptorType: Endpoint */
+    AUDIO_OUT_EP,                           /* bEndpointAddress */
+    0x05,                                   /* bmAttributes: Isochronous, Asynchronous */
+    LOBYTE(AUDIO_OUT_PACKET_SIZE),          /* wMaxPacketSize */
+    HIBYTE(AUDIO_OUT_PACKET_SIZE),
+    0x01,                                   /* bInterval: 1 frame */
+    0x00,                                   /* bRefresh */
+    AUDIO_FB_EP,                            /* bSynchAddress: feedback endpoint */
+
+    /* Class-specific AS Isochronous Audio Data Endpoint Descriptor */
+    0x07,                                   /* bLength */
+    AUDIO_DESCRIPTOR_TYPE_ENDPOINT,         /* bDescriptorType: CS_ENDPOINT */
+    0x01,                                   /* bDescriptorSubtype: EP General */
+    0x01,                                   /* bmAttributes: Sampling Frequency control */
+    0x00,                                   /* bLockDelayUnits */
+    0x00, 0x00,                             /* wLockDelay */
+
+    /* Standard AS Isochronous Synch Endpoint Descriptor */
+    0x09,                                   /* bLength */
+    USB_DESC_TYPE_ENDPOINT,                 /* bDescriptorType: Endpoint */
+    AUDIO_FB_EP,                            /* bEndpointAddress */
+    0x11,                                   /* bmAttributes: Isochronous, Feedback */
+    AUDIO_FB_PACKET_SIZE, 0x00,             /* wMaxPacketSize */
+    0x01,                                   /* bInterval: 1 frame */
+    AUDIO_FB_REFRESH,                       /* bRefresh: 2^AUDIO_FB_REFRESH frames */
+    0x00,                                   /* bSynchAddress */
+};
+
+/** @} */
+
+/** @defgroup USBD_AUDIO_Private_Functions
+ * @{ */
+
+/**
+ * @brief  (Re)Initialize the AUDIO interface
+ * @param  pdev: device instance
+ * @param  cfgidx: Configuration index
+ * @retval status
+ */
+static uint8_t USBD_AUDIO_Init(USBD_HandleTypeDef *pdev, uint8_t cfgidx)
+{
+    pdev->pClassData = USBD_malloc(sizeof(USBD_AUDIO_HandleTypeDef));
+
+    if (pdev->pClassData != NULL)
+    {
+        USBD_AUDIO_HandleTypeDef *haudio = AUDIO_HANDLE(pdev);
+        USBD_AUDIO_ItfTypeDef *itf       = AUDIO_ITF(pdev);
+
+        /* The endpoints are opened by the operational alternate setting */
+        haudio->SampleRate = AUDIO_SAMPLE_RATE;
+        haudio->Feedback   = AUDIO_FB_NOMINAL;
+        haudio->CmdOpCode  = 0xFF;
+        haudio->AltSetting = 0;
+        haudio->Muted      = 0;
+        haudio->FbBusy     = 0;
+
+        /* Initialize AUDIO Interface components */
+        if (itf->Init != NULL)
+        {
+            itf->Init();
+        }
+    }
+
+    return USBD_OK;
+}
+
+/**
+ * @brief  Deinitialize the AUDIO interface
+ * @param  pdev: device instance
+ * @param  cfgidx: Configuration index
+ * @retval status
+ */
+static uint8_t USBD_AUDIO_DeInit(USBD_HandleTypeDef *pdev, uint8_t cfgidx)
+{
+    /* DeInit AUDIO Interface components */
+    if (pdev->pClassData != NULL)
+    {
+        USBD_AUDIO_ItfTypeDef *itf = AUDIO_ITF(pdev);
+
+        USBD_AUDIO_SetStreaming(pdev, 0);
+
+        if (itf->DeInit != NULL)
+        {
+            itf->DeInit();
+        }
+
+        USBD_free(pdev->pClassData);
+        pdev->pClassData = NULL;
+    }
+
+    return USBD_OK;
+}
+
+/**
+ * @brief  Handle the AUDIO specific requests
+ * @param  pdev: instance
+ * @param  req: AUDIO request
+ * @retval status
+ */
+static uint8_t USBD_AUDIO_Setup(USBD_HandleTypeDef *pdev, USBD_SetupReqTypedef *req)
+{
+    USBD_AUDIO_HandleTypeDef *haudio = AUDIO_HANDLE(pdev);
+    uint8_t recipient = req->bmRequest & USB_REQ_RECIPIENT_MASK;
+    uint8_t target, control;
+
+    if (haudio == NULL)
+    {
+        return USBD_FAIL;
+    }
+
+    /* The addressed unit or endpoint, and the control selector */
+    target  = (recipient == USB_REQ_RECIPIENT_ENDPOINT) ? LOBYTE(req->wIndex) : HIBYTE(req->wIndex);
+    control = HIBYTE(req->wValue);
+
+    switch (req->bmRequest & USB_REQ_TYPE_MASK)
+    {
+    case USB_REQ_TYPE_CLASS:
+        if ((recipient == USB_REQ_RECIPIENT_INTERFACE) &&
+            (target == AUDIO_FEATURE_UNIT_ID) && (control == AUDIO_CONTROL_MUTE) && (req->wLength == 1))
+        {
+            if (req->bRequest == AUDIO_REQ_GET_CUR)
+            {
+                haudio->data[0] = haudio->Muted;
+                USBD_CtlSendData(pdev, (uint8_t *) haudio->data, 1);
+                break;
+            }
+        }
+        else if ((recipient == USB_REQ_RECIPIENT_ENDPOINT) &&
+            (target == AUDIO_OUT_EP) && (control == AUDIO_CONTROL_SAMPLING_FREQ) && (req->wLength == 3))
+        {
+            if (req->bRequest == AUDIO_REQ_GET_CUR)
+            {
+                haudio->data[0] = haudio->SampleRate;
+                USBD_CtlSendData(pdev, (uint8_t *) haudio->data, 3);
+                break;
+            }
+        }
+        else
+        {
+            USBD_CtlError(pdev, req);
+            break;
+        }
+
+        if (req->bRequest == AUDIO_REQ_SET_CUR)
+        {
+            /* The data stage is processed when it's received */
+            haudio->CmdOpCode = req->bRequest;
+            haudio->CmdTarget = target;
+            haudio->CmdLength = req->wLength;
+
+            USBD_CtlPrepareRx(pdev, (uint8_t *) haudio->data, req->wLength);
+        }
+        else
+        {
+            USBD_CtlError(pdev, req);
+        }
+        break;
+
+    case USB_REQ_TYPE_STANDARD:
+        switch (req->bRequest)
+        {
+        case USB_REQ_GET_INTERFACE:
+            {
+                uint8_t ifalt = (LOBYTE(req->wIndex) == AUDIO_STREAMING_ITF) ? haudio->AltSetting : 0;
+                USBD_CtlSendData(pdev, &ifalt, 1);
+            }
+            break;
+
+        case USB_REQ_SET_INTERFACE:
+            if ((LOBYTE(req->wIndex) == AUDIO_STREAMING_ITF) && (req->wValue <= 1))
+            {
+                USBD_AUDIO_SetStreaming(pdev, (uint8_t) req->wValue);
+            }
+            else if (req->wValue != 0)
+            {
+                USBD_CtlError(pdev, req);
+            }
+            break;
+        }
+        break;
+
+    default:
+        break;
+    }
+    return USBD_OK;
+}
+
+/**
+ * @brief  Data sent on non-control IN endpoint
+ * @param  pdev: device instance
+ * @param  epnum: endpoint number
+ * @retval status
+ */
+static uint8_t USBD_AUDIO_DataIn(USBD_HandleTypeDef *pdev, uint8_t epnum)
+{
+    if ((pdev->pClassData != NULL) && ((epnum & 0x7F) == (AUDIO_FB_EP & 0x7F)))
+    {
+        /* The next feedback value is armed at the following SOF */
+        AUDIO_HANDLE(pdev)->FbBusy = 0;
+    }
+
+    return USBD_OK;
+}
+
+/**
+ * @brief  Data received on non-control OUT endpoint
+ * @param  pdev: device instance
+ * @param  epnum: endpoint number
+ * @retval status
+ */
+static uint8_t USBD_AUDIO_DataOut(USBD_HandleTypeDef *pdev, uint8_t epnum)
+{
+    USBD_AUDIO_HandleTypeDef *haudio = AUDIO_HANDLE(pdev);
+    USBD_AUDIO_ItfTypeDef *itf       = AUDIO_ITF(pdev);
+
+    if ((haudio == NULL) || (epnum != AUDIO_OUT_EP))
+    {
+        return USBD_FAIL;
+    }
+
+    if (haudio->AltSetting != 0)
+    {
+        uint8_t  index  = haudio->Index;
+        uint32_t length = USBD_LL_GetRxDataSize(pdev, epnum);
+
+        /* The next packet is received to the other buffer while this one is processed */
+        haudio->Index = index ^ 1;
+        (void) USBD_LL_PrepareReceive(pdev, AUDIO_OUT_EP,
+                (uint8_t *) haudio->Packet[haudio->Index], AUDIO_OUT_PACKET_SIZE);
+
+        if ((itf->Received != NULL) && (length > 0))
+        {
+            /* Provide callback on successful reception */
+            itf->Received((uint8_t *) haudio->Packet[index], length);
+        }
+    }
+
+    return USBD_OK;
+}
+
+/**
+ * @brief  Setup endpoint data processing
+ * @param  pdev: device instance
+ * @retval status
+ */
+static uint8_t USBD_AUDIO_EP0_RxReady(USBD_HandleTypeDef *pdev)
+{
+    USBD_AUDIO_HandleTypeDef *haudio = AUDIO_HANDLE(pdev);
+
+    if ((haudio != NULL) && (haudio->CmdOpCode == AUDIO_REQ_SET_CUR))
+    {
+        if (haudio->CmdTarget == AUDIO_FEATURE_UNIT_ID)
+        {
+            USBD_AUDIO_ItfTypeDef *itf = AUDIO_ITF(pdev);
+
+            haudio->Muted = (uint8_t) haudio->data[0];
+
+            if (itf->Mute != NULL)
+            {
+                /* Provide callback on mute change */
+                itf->Mute(haudio->Muted);
+            }
+        }
+        else
+        {
+            /* Only the single supported rate is accepted */
+            if ((haudio->data[0] & 0xFFFFFF) == AUDIO_SAMPLE_RATE)
+            {
+                haudio->SampleRate = AUDIO_SAMPLE_RATE;
+            }
+        }
+        haudio->CmdOpCode = 0xFF;
+    }
+
+    return USBD_OK;
+}
+
+/**
+ * @brief  Start Of Frame event processing
+ * @param  pdev: device instance
+ * @retval status
+ */
+static uint8_t USBD_AUDIO_SOF(USBD_HandleTypeDef *pdev)
+{
+    USBD_AUDIO_HandleTypeDef *haudio = AUDIO_HANDLE(pdev);
+
+    if (haudio != NULL)
+    {
+        USBD_AUDIO_ItfTypeDef *itf = AUDIO_ITF(pdev);
+
+        /* Keep a feedback value ready for the host's next poll */
+        if ((haudio->AltSetting != 0) && (haudio->FbBusy == 0))
+        {
+            uint32_t feedback = haudio->Feedback;
+
+            haudio->FbPacket[0] = (uint8_t) feedback;
+            haudio->FbPacket[1] = (uint8_t) (feedback >> 8);
+            haudio->FbPacket[2] = (uint8_t) (feedback >> 16);
+            haudio->FbBusy = 1;
+
+            (void) USBD_LL_Transmit(pdev, AUDIO_FB_EP, haudio->FbPacket, AUDIO_FB_PACKET_SIZE);
+        }
+
+        if (itf->StartOfFrame != NULL)
+        {
+            /* Provide callback for frame timing */
+            itf->StartOfFrame();
+        }
+    }
+
+    return USBD_OK;
+}
+
+/**
+ * @brief  Isochronous IN transfer wasn't polled in the frame
+ * @param  pdev: device instance
+ * @param  epnum: endpoint number
+ * @retval status
+ */
+static uint8_t USBD_AUDIO_IsoINIncomplete(USBD_HandleTypeDef *pdev, uint8_t epnum)
+{
+    USBD_AUDIO_HandleTypeDef *haudio = AUDIO_HANDLE(pdev);
+
+    if ((haudio != NULL) && (haudio->FbBusy != 0))
+    {
+        /* Drop the stale feedback, the current value is armed at the next SOF */
+        (void) USBD_LL_FlushEP(pdev, AUDIO_FB_EP);
+        haudio->FbBusy = 0;
+    }
+
+    return USBD_OK;
+}
+
+/**
+ * @brief  Isochronous OUT transfer wasn't completed in the frame
+ * @param  pdev: device instance
+ * @param  epnum: endpoint number
+ * @retval status
+ */
+static uint8_t USBD_AUDIO_IsoOUTIncomplete(USBD_HandleTypeDef *pdev, uint8_t epnum)
+{
+    USBD_AUDIO_HandleTypeDef *haudio = AUDIO_HANDLE(pdev);
+
+    if ((haudio != NULL) && (haudio->AltSetting != 0))
+    {
+        /* Restart the reception to the current buffer */
+        (void) USBD_LL_PrepareReceive(pdev, AUDIO_OUT_EP,
+                (uint8_t *) haudio->Packet[haudio->Index], AUDIO_OUT_PACKET_SIZE);
+    }
+
+    return USBD_OK;
+}
+
+/**
+ * @brief  Returns the configuration descriptor
+ * @param  length: pointer to the data length
+ * @retval pointer to descriptor buffer
+ */
+static uint8_t *USBD_AUDIO_GetFSCfgDesc(uint16_t *length)
+{
+    *length = sizeof(USBD_AUDIO_CfgDesc);
+    return (uint8_t *) USBD_AUDIO_CfgDesc;
+}
+
+/**
+ * @brief  Returns the Device Qualifier descriptor
+ * @param  length: pointer to the data length
+ * @retval pointer to descriptor buffer
+ */
+static uint8_t *USBD_AUDIO_GetDeviceQualifierDescriptor(uint16_t *length)
+{
+    *length = sizeof(USBD_AUDIO_DeviceQualifierDesc);
+    return (uint8_t *) USBD_AUDIO_DeviceQualifierDesc;
+}
+
+/**
+ * @brief  Switches the alternate setting of the streaming interface
+ * @param  pdev: device instance
+ * @param  alt: the new alternate setting: 1 opens the endpoints, 0 closes them
+ */
+static void USBD_AUDIO_SetStreaming(USBD_HandleTypeDef *pdev, uint8_t alt)
+{
+    USBD_AUDIO_HandleTypeDef *haudio = AUDIO_HANDLE(pdev);
+    USBD_AUDIO_ItfTypeDef *itf       = AUDIO_ITF(pdev);
+
+    if (alt != haudio->AltSetting)
+    {
+        haudio->AltSetting = alt;
+
+        if (alt != 0)
+        {
+            /* Open the isochronous endpoints */
+            USBD_LL_OpenEP(pdev, AUDIO_OUT_EP, USBD_EP_TYPE_ISOC, AUDIO_OUT_PACKET_SIZE);
+            USBD_LL_OpenEP(pdev, AUDIO_FB_EP, USBD_EP_TYPE_ISOC, AUDIO_FB_PACKET_SIZE);
+
+            /* Restart the feedback measurement from the nominal rate */
+            haudio->Feedback = AUDIO_FB_NOMINAL;
+            haudio->FbMeasure.Sum = 0;
+            haudio->FbMeasure.Frames = 0xFFFF;
+            haudio->FbBusy = 0;
+
+            /* Start reception to the first packet buffer */
+            haudio->Index = 0;
+            (void) USBD_LL_PrepareReceive(pdev, AUDIO_OUT_EP,
+                    (uint8_t *) haudio->Packet[0], AUDIO_OUT_PACKET_SIZE);
+        }
+        else
+        {
+            /* Close the isochronous endpoints */
+            USBD_LL_CloseEP(pdev, AUDIO_OUT_EP);
+            USBD_LL_CloseEP(pdev, AUDIO_FB_EP);
+        }
+
+        if (itf->Streaming != NULL)
+        {
+            /* Provide callback on streaming state change */
+            itf->Streaming(alt);
+        }
+    }
+}
+
+/**
+ * @brief  Sets the AUDIO user interface to the handler
+ * @param  pdev: device instance
+ * @param  fops: AUDIO Interface callbacks
+ * @retval status
+ */
+uint8_t USBD_AUDIO_RegisterInterface(USBD_HandleTypeDef *pdev, const USBD_AUDIO_ItfTypeDef *fops)
+{
+    uint8_t ret = USBD_FAIL;
+
+    if (fops != NULL)
+    {
+        pdev->pUserData = fops;
+        ret = USBD_OK;
+    }
+
+    return ret;
+}
+
+/**
+ * @brief  Measures the codec rate against the USB frames. Shall be called once
+ *         in every frame with the value of a free-running counter (clocked by
+ *         AUDIO_FB_CLOCK_RATIO ticks per sample) captured at SOF, e.g.
+ *         from the timer input capture interrupt that is triggered by the USB SOF.
+ *         The feedback value is updated every 2^AUDIO_FB_REFRESH frames.
+ * @param  pdev: device instance
+ * @param  capture: the counter value captured at the last SOF
+ */
+void USBD_AUDIO_FeedbackCapture(USBD_HandleTypeDef *pdev, uint32_t capture)
+{
+    USBD_AUDIO_HandleTypeDef *haudio = AUDIO_HANDLE(pdev);
+
+    if ((haudio != NULL) && (haudio->AltSetting != 0))
+    {
+        /* The first capture only provides the reference */
+        if (haudio->FbMeasure.Frames == 0xFFFF)
+        {
+            haudio->FbMeasure.Frames = 0;
+        }
+        else
+        {
+            haudio->FbMeasure.Sum += (capture - haudio->FbMeasure.LastCapture) & AUDIO_FB_COUNTER_MASK;
+            haudio->FbMeasure.Frames++;
+
+            if (haudio->FbMeasure.Frames == (1 << AUDIO_FB_REFRESH))
+            {
+                /* Average samples per frame in 10.14 format */
+                haudio->Feedback = (haudio->FbMeasure.Sum << (14 - AUDIO_FB_REFRESH))
+                        / AUDIO_FB_CLOCK_RATIO;
+
+                haudio->FbMeasure.Sum    = 0;
+                haudio->FbMeasure.Frames = 0;
+            }
+        }
+        haudio->FbMeasure.LastCapture = capture;
+    }
+}
+
+/**
+ * @brief  Sets the feedback value directly, when the application measures
+ *         the codec rate by other means (e.g. from the audio buffer fill level).
+ * @param  pdev: device instance
+ * @param  feedback: the number of samples per frame in 10.14 fixed point format
+ */
+void USBD_AUDIO_SetFeedback(USBD_HandleTypeDef *pdev, uint32_t feedback)
+{
+    if (pdev->pClassData != NULL)
+    {
+        AUDIO_HANDLE(pdev)->Feedback = feedback;
+    }
+}
+
+/** @} */
+
+/** @} */
+
+/** @} */
@@ -47,16 +47,38 @@ extern "C"
 /** @defgroup usbd_cdc_Exported_Defines
  * @{
  */
+/* Multiple CDC instances form a composite device with Interface Association Descriptors,
+ * each instance uses 2 interfaces, 2 IN endpoints and 1 OUT endpoint. */
+#ifndef CDC_INSTANCE_COUNT
+#define CDC_INSTANCE_COUNT                          1
+#endif
+
 #define CDC_IN_EP                                   0x81  /* EP1 for data IN */
 #define CDC_OUT_EP                                  0x01  /* EP1 for data OUT */
-#define CDC_CMD_EP                                  0x82  /* EP2 for CDC commands */
+#define CDC_CMD_EP                                  (0x81 + CDC_INSTANCE_COUNT)  /* EP2 for CDC commands */
+
+/* Endpoint addresses of the CDC instances [0 .. CDC_INSTANCE_COUNT - 1] */
+#define CDC_INSTANCE_IN_EP(I)                       (CDC_IN_EP  + (I))
+#define CDC_INSTANCE_OUT_EP(I)                      (CDC_OUT_EP + (I))
+#define CDC_INSTANCE_CMD_EP(I)                      (CDC_CMD_EP + (I))
+
+/* CDC instance index of the data endpoint number */
+#define CDC_EP_INSTANCE(EPNUM)                      ((uint8_t)(((EPNUM) & 0x7F) - CDC_OUT_EP))
 
 /* CDC Endpoints parameters: you can fine tune these values depending on the needed baudrates and performance. */
 #define CDC_DATA_HS_MAX_PACKET_SIZE                 512  /* Endpoint IN & OUT Packet size */
 #define CDC_DATA_FS_MAX_PACKET_SIZE                 64  /* Endpoint IN & OUT Packet size */
 #define CDC_CMD_PACKET_SIZE                         8  /* Control Endpoint Packet size */ 
+#ifndef CDC_CMD_HS_INTR_INTERVAL
+#define CDC_CMD_HS_INTR_INTERVAL                    0x10  /* Command Endpoint interval at high speed (2^15 microframes) */
+#endif
 
-#define USB_CDC_CONFIG_DESC_SIZ                     67
+#define USB_CDC_FUNC_DESC_SIZ                       58
+#if (CDC_INSTANCE_COUNT > 1)
+#define USB_CDC_CONFIG_DESC_SIZ                     (9 + CDC_INSTANCE_COUNT * (8 + USB_CDC_FUNC_DESC_SIZ))
+#else
+#define USB_CDC_CONFIG_DESC_SIZ                     (9 + USB_CDC_FUNC_DESC_SIZ)
+#endif
 
 #define CDC_DATA_HS_IN_PACKET_SIZE                  CDC_DATA_HS_MAX_PACKET_SIZE
 #define CDC_DATA_HS_OUT_PACKET_SIZE                 CDC_DATA_HS_MAX_PACKET_SIZE
@@ -64,6 +86,19 @@ extern "C"
 #define CDC_DATA_FS_IN_PACKET_SIZE                  CDC_DATA_FS_MAX_PACKET_SIZE
 #define CDC_DATA_FS_OUT_PACKET_SIZE                 CDC_DATA_FS_MAX_PACKET_SIZE
 
+/* CDC buffered mode parameters: the OUT buffer pool keeps the endpoint receiving
+ * while the application processes the previously filled buffers,
+ * the IN buffer aggregates the written data while the endpoint is busy. */
+#ifndef CDC_OUT_BUFFER_COUNT
+#define CDC_OUT_BUFFER_COUNT                        0  /* Number of OUT pool buffers (0 disables the pool) */
+#endif
+#ifndef CDC_OUT_BUFFER_SIZE
+#define CDC_OUT_BUFFER_SIZE                         CDC_DATA_HS_MAX_PACKET_SIZE  /* OUT pool buffer size (multiple of packet size) */
+#endif
+#ifndef CDC_IN_BUFFER_SIZE
+#define CDC_IN_BUFFER_SIZE                          0  /* Max IN transfer size of aggregated writes (0 disables aggregation) */
+#endif
+
 /*---------------------------------------------------------------------*/
 /*  CDC definitions                                                    */
 /*---------------------------------------------------------------------*/
@@ -126,6 +161,7 @@ typedef struct _USBD_CDC_Itf
     void (*Control)(uint8_t, uint8_t *, uint16_t);
     void (*Received)(uint8_t *, uint32_t);
     void (*Transmitted)(uint8_t *, uint32_t);
+    void (*StartOfFrame)(void); /* Only called when SOF is enabled in the USB driver */
 } USBD_CDC_ItfTypeDef;
 
 typedef struct
@@ -141,6 +177,24 @@ typedef struct
     uint8_t CmdOpCode;
     uint8_t CmdLength;
     USBD_StatusTypeDef TxState;
+#if (CDC_OUT_BUFFER_COUNT > 0)
+    struct {
+        uint32_t Data[CDC_OUT_BUFFER_COUNT][CDC_OUT_BUFFER_SIZE / 4]; /* Force 32bits alignment */
+        uint16_t Length[CDC_OUT_BUFFER_COUNT];  /* Received data length of filled buffers */
+        volatile uint8_t Head;                  /* Index of the receiving buffer */
+        volatile uint8_t Tail;                  /* Index of the oldest filled buffer */
+        volatile uint8_t Held;                  /* Reception is held as all buffers are filled */
+        volatile uint8_t Paused;                /* Reception is held by the application */
+        volatile uint8_t Armed;                 /* The endpoint is receiving to the head buffer */
+    } OutPool;
+#endif
+#if (CDC_IN_BUFFER_SIZE > 0)
+    struct {
+        uint32_t Data[2][CDC_IN_BUFFER_SIZE / 4]; /* Force 32bits alignment */
+        volatile uint16_t Length;               /* Aggregated data length in the filling buffer */
+        uint8_t Index;                          /* Index of the filling buffer */
+    } InBuffer;
+#endif
 } USBD_CDC_HandleTypeDef;
 
 /**
@@ -165,11 +219,25 @@ extern const USBD_ClassTypeDef USBD_CDC;
 uint8_t USBD_CDC_RegisterInterface(USBD_HandleTypeDef *pdev,
         const USBD_CDC_ItfTypeDef *fops);
 
-uint8_t USBD_CDC_Transmit(USBD_HandleTypeDef *pdev, uint8_t *pbuff, uint16_t length);
+uint8_t USBD_CDC_Transmit(USBD_HandleTypeDef *pdev, uint8_t idx, uint8_t *pbuff, uint16_t length);
+
+uint8_t USBD_CDC_Receive(USBD_HandleTypeDef *pdev, uint8_t idx, uint8_t *pbuff, uint16_t length);
+
+uint8_t USBD_CDC_SendCommand(USBD_HandleTypeDef *pdev, uint8_t idx, uint8_t *pbuff);
 
-uint8_t USBD_CDC_Receive(USBD_HandleTypeDef *pdev, uint8_t *pbuff, uint16_t length);
+#if (CDC_OUT_BUFFER_COUNT > 0)
+uint8_t *USBD_CDC_GetRxBuffer(USBD_HandleTypeDef *pdev, uint8_t idx, uint16_t *length);
 
-uint8_t USBD_CDC_SendCommand(USBD_HandleTypeDef *pdev, uint8_t *pbuff);
+uint8_t USBD_CDC_ReleaseRxBuffer(USBD_HandleTypeDef *pdev, uint8_t idx);
+
+uint8_t USBD_CDC_HoldRx(USBD_HandleTypeDef *pdev, uint8_t idx);
+
+uint8_t USBD_CDC_ResumeRx(USBD_HandleTypeDef *pdev, uint8_t idx);
+#endif
+
+#if (CDC_IN_BUFFER_SIZE > 0)
+uint16_t USBD_CDC_Write(USBD_HandleTypeDef *pdev, uint8_t idx, const uint8_t *pbuff, uint16_t length);
+#endif
 
 /**
  * @}
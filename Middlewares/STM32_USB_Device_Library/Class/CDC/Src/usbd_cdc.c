@@ -80,6 +80,8 @@ static uint8_t USBD_CDC_DataOut(USBD_HandleTypeDef *pdev, uint8_t epnum);
 
 static uint8_t USBD_CDC_EP0_RxReady(USBD_HandleTypeDef *pdev);
 
+static uint8_t USBD_CDC_SOF(USBD_HandleTypeDef *pdev);
+
 static uint8_t *USBD_CDC_GetFSCfgDesc(uint16_t *length);
 
 #ifdef DEVICE_HS
@@ -88,6 +90,18 @@ static uint8_t *USBD_CDC_GetHSCfgDesc(uint16_t *length);
 
 static uint8_t *USBD_CDC_GetDeviceQualifierDescriptor(uint16_t *length);
 
+#if (CDC_OUT_BUFFER_COUNT > 0)
+static void USBD_CDC_PoolReceive(USBD_HandleTypeDef *pdev, uint8_t idx);
+#endif
+
+#if (CDC_IN_BUFFER_SIZE > 0)
+static void USBD_CDC_InFlush(USBD_HandleTypeDef *pdev, uint8_t idx);
+#endif
+
+/* The CDC handle and the user interface of the CDC instance */
+#define CDC_INSTANCE_HANDLE(PDEV, I)    (&((USBD_CDC_HandleTypeDef*) (PDEV)->pClassData)[I])
+#define CDC_INSTANCE_ITF(PDEV, I)       (&((USBD_CDC_ItfTypeDef*) (PDEV)->pUserData)[I])
+
 /** @defgroup USBD_CDC_Private_Variables
  * @{ */
 
@@ -97,9 +111,15 @@ __ALIGN_BEGIN static const uint8_t USBD_CDC_DeviceQualifierDesc[USB_LEN_DEV_QUAL
     USB_LEN_DEV_QUALIFIER_DESC,     /* bLength */
     USB_DESC_TYPE_DEVICE_QUALIFIER, /* bDescriptorType */
     0x00, 0x02,                     /* bcdUSB */
+#if (CDC_INSTANCE_COUNT > 1)
+    0xEF,                           /* bDeviceClass: Miscellaneous */
+    0x02,                           /* bDeviceSubClass: Common Class */
+    0x01,                           /* bDeviceProtocol: Interface Association Descriptor */
+#else
     0x02,                           /* bDeviceClass */
     0x00,                           /* bDeviceSubClass */
     0x00,                           /* bDeviceProtocol */
+#endif
     0x40,                           /* bMaxPacketSize */
     0x01,                           /* bNumConfigurations */
     0x00,                           /* bReserved */
@@ -114,7 +134,7 @@ const USBD_ClassTypeDef USBD_CDC = {
     USBD_CDC_EP0_RxReady,
     USBD_CDC_DataIn,
     USBD_CDC_DataOut,
-    NULL,
+    USBD_CDC_SOF,
     NULL,
     NULL,
 #ifdef DEVICE_HS
@@ -127,197 +147,154 @@ const USBD_ClassTypeDef USBD_CDC = {
     USBD_CDC_GetDeviceQualifierDescriptor
 };
 
-#ifdef DEVICE_HS
-/* USB CDC device Configuration Descriptor */
-__ALIGN_BEGIN static const uint8_t USBD_CDC_CfgHSDesc[USB_CDC_CONFIG_DESC_SIZ] __ALIGN_END =
-{
-    /* Configuration Descriptor */
-    0x09,                           /* bLength: Configuration Descriptor size */
-    USB_DESC_TYPE_CONFIGURATION,    /* bDescriptorType: Configuration */
-    USB_CDC_CONFIG_DESC_SIZ,0x00,   /* wTotalLength:no of returned bytes */
-    0x02,                           /* bNumInterfaces: 2 interface */
-    0x01,                           /* bConfigurationValue: Configuration value */
-    0x00,                           /* iConfiguration: Index of string descriptor describing the configuration */
-    0x80 | (USBD_SELF_POWERED << 6),/* bmAttributes: self powered */
-    USBD_MAX_POWER_mA / 2,          /* MaxPower x mA */
-
-    /* Interface Descriptor */
-    0x09,                       /* bLength: Interface Descriptor size */
-    USB_DESC_TYPE_INTERFACE,    /* bDescriptorType: Interface */
-    /* Interface descriptor type */
-    0x00,   /* bInterfaceNumber: Number of Interface */
-    0x00,   /* bAlternateSetting: Alternate setting */
-    0x01,   /* bNumEndpoints: One endpoints used */
-    0x02,   /* bInterfaceClass: Communication Interface Class */
-    0x02,   /* bInterfaceSubClass: Abstract Control Model */
-    0x01,   /* bInterfaceProtocol: Common AT commands */
-    0x00,   /* iInterface: */
-
-    /* Header Functional Descriptor */
-    0x05,   /* bLength: Endpoint Descriptor size */
-    0x24,   /* bDescriptorType: CS_INTERFACE */
-    0x00,   /* bDescriptorSubtype: Header Func Desc */
-    0x10,   /* bcdCDC: spec release number */
-    0x01,
-
-    /* Call Management Functional Descriptor */
-    0x05,   /* bFunctionLength */
-    0x24,   /* bDescriptorType: CS_INTERFACE */
-    0x01,   /* bDescriptorSubtype: Call Management Func Desc */
-    0x00,   /* bmCapabilities: D0+D1 */
-    0x01,   /* bDataInterface: 1 */
-
-    /* ACM Functional Descriptor */
-    0x04,   /* bFunctionLength */
-    0x24,   /* bDescriptorType: CS_INTERFACE */
-    0x02,   /* bDescriptorSubtype: Abstract Control Management desc */
-    0x02,   /* bmCapabilities */
-
-    /* Union Functional Descriptor */
-    0x05,   /* bFunctionLength */
-    0x24,   /* bDescriptorType: CS_INTERFACE */
-    0x06,   /* bDescriptorSubtype: Union func desc */
-    0x00,   /* bMasterInterface: Communication class interface */
-    0x01,   /* bSlaveInterface0: Data Class Interface */
-
-    /* Endpoint 2 Descriptor */
-    0x07,                       /* bLength: Endpoint Descriptor size */
-    USB_DESC_TYPE_ENDPOINT,     /* bDescriptorType: Endpoint */
-    CDC_CMD_EP,                 /* bEndpointAddress */
-    0x03,                       /* bmAttributes: Interrupt */
-    LOBYTE(CDC_CMD_PACKET_SIZE),/* wMaxPacketSize: */
-    HIBYTE(CDC_CMD_PACKET_SIZE),
-#ifdef CDC_CMD_INTR_INTERVAL
-    CDC_CMD_INTR_INTERVAL,      /* bInterval: */
+/* USB CDC function descriptors of the I-th instance
+ * with the data packet size MPS and the command endpoint interval ITV */
+#if (CDC_INSTANCE_COUNT > 1)
+#define USBD_CDC_IAD_DESC(I)                                                \
+    /* Interface Association Descriptor */                                  \
+    0x08,                       /* bLength: IAD size */                     \
+    USB_DESC_TYPE_IAD,          /* bDescriptorType: Interface Association */\
+    2 * (I),                    /* bFirstInterface */                       \
+    0x02,                       /* bInterfaceCount */                       \
+    0x02,                       /* bFunctionClass: Communication Interface Class */\
+    0x02,                       /* bFunctionSubClass: Abstract Control Model */\
+    0x01,                       /* bFunctionProtocol: Common AT commands */ \
+    0x00,                       /* iFunction */
 #else
-    0x80,                       /* bInterval: */
-#endif /* CDC_CMD_INTR_INTERVAL */
-
-    /* Data class interface descriptor */
-    0x09,   /* bLength: Endpoint Descriptor size */
-    USB_DESC_TYPE_INTERFACE,  /* bDescriptorType: */
-    0x01,   /* bInterfaceNumber: Number of Interface */
-    0x00,   /* bAlternateSetting: Alternate setting */
-    0x02,   /* bNumEndpoints: Two endpoints used */
-    0x0A,   /* bInterfaceClass: CDC */
-    0x00,   /* bInterfaceSubClass: */
-    0x00,   /* bInterfaceProtocol: */
-    0x00,   /* iInterface: */
-
-    /* Endpoint OUT Descriptor */
-    0x07,   /* bLength: Endpoint Descriptor size */
-    USB_DESC_TYPE_ENDPOINT,      /* bDescriptorType: Endpoint */
-    CDC_OUT_EP,                        /* bEndpointAddress */
-    0x02,                              /* bmAttributes: Bulk */
-    LOBYTE(CDC_DATA_HS_MAX_PACKET_SIZE),  /* wMaxPacketSize: */
-    HIBYTE(CDC_DATA_HS_MAX_PACKET_SIZE),
-    0x00,                              /* bInterval: ignore for Bulk transfer */
-
-    /* Endpoint IN Descriptor */
-    0x07,   /* bLength: Endpoint Descriptor size */
-    USB_DESC_TYPE_ENDPOINT,      /* bDescriptorType: Endpoint */
-    CDC_IN_EP,                         /* bEndpointAddress */
-    0x02,                              /* bmAttributes: Bulk */
-    LOBYTE(CDC_DATA_HS_MAX_PACKET_SIZE),  /* wMaxPacketSize: */
-    HIBYTE(CDC_DATA_HS_MAX_PACKET_SIZE),
-    0x00                               /* bInterval: ignore for Bulk transfer */
-};
+#define USBD_CDC_IAD_DESC(I)
 #endif
 
-/* USB CDC device Configuration Descriptor */
-__ALIGN_BEGIN static const uint8_t USBD_CDC_CfgFSDesc[USB_CDC_CONFIG_DESC_SIZ] __ALIGN_END =
-{
-    /* Configuration Descriptor */
-    0x09,                           /* bLength: Configuration Descriptor size */
-    USB_DESC_TYPE_CONFIGURATION,    /* bDescriptorType: Configuration */
-    USB_CDC_CONFIG_DESC_SIZ,0x00,   /* wTotalLength:no of returned bytes */
-    0x02,                           /* bNumInterfaces: 2 interface */
-    0x01,                           /* bConfigurationValue: Configuration value */
-    0x00,                           /* iConfiguration: Index of string descriptor describing the configuration */
-    0x80 | (USBD_SELF_POWERED << 6),/* bmAttributes: self powered */
-    USBD_MAX_POWER_mA / 2,          /* MaxPower x mA */
-
-    /* Interface Descriptor */
-    0x09,                       /* bLength: Interface Descriptor size */
-    USB_DESC_TYPE_INTERFACE,    /* bDescriptorType: Interface */
-    /* Interface descriptor type */
-    0x00,   /* bInterfaceNumber: Number of Interface */
-    0x00,   /* bAlternateSetting: Alternate setting */
-    0x01,   /* bNumEndpoints: One endpoints used */
-    0x02,   /* bInterfaceClass: Communication Interface Class */
-    0x02,   /* bInterfaceSubClass: Abstract Control Model */
-    0x01,   /* bInterfaceProtocol: Common AT commands */
-    0x00,   /* iInterface: */
-
-    /* Header Functional Descriptor */
-    0x05,   /* bLength: Endpoint Descriptor size */
-    0x24,   /* bDescriptorType: CS_INTERFACE */
-    0x00,   /* bDescriptorSubtype: Header Func Desc */
-    0x10,   /* bcdCDC: spec release number */
-    0x01,
-
-    /* Call Management Functional Descriptor */
-    0x05,   /* bFunctionLength */
-    0x24,   /* bDescriptorType: CS_INTERFACE */
-    0x01,   /* bDescriptorSubtype: Call Management Func Desc */
-    0x00,   /* bmCapabilities: D0+D1 */
-    0x01,   /* bDataInterface: 1 */
-
-    /* ACM Functional Descriptor */
-    0x04,   /* bFunctionLength */
-    0x24,   /* bDescriptorType: CS_INTERFACE */
-    0x02,   /* bDescriptorSubtype: Abstract Control Management desc */
-    0x02,   /* bmCapabilities */
-
-    /* Union Functional Descriptor */
-    0x05,   /* bFunctionLength */
-    0x24,   /* bDescriptorType: CS_INTERFACE */
-    0x06,   /* bDescriptorSubtype: Union func desc */
-    0x00,   /* bMasterInterface: Communication class interface */
-    0x01,   /* bSlaveInterface0: Data Class Interface */
-
-    /* Endpoint 2 Descriptor */
-    0x07,                       /* bLength: Endpoint Descriptor size */
-    USB_DESC_TYPE_ENDPOINT,     /* bDescriptorType: Endpoint */
-    CDC_CMD_EP,                 /* bEndpointAddress */
-    0x03,                       /* bmAttributes: Interrupt */
-    LOBYTE(CDC_CMD_PACKET_SIZE),/* wMaxPacketSize: */
-    HIBYTE(CDC_CMD_PACKET_SIZE),
-#ifdef CDC_CMD_INTR_INTERVAL
-    CDC_CMD_INTR_INTERVAL,      /* bInterval: */
+#define USBD_CDC_FUNC_DESC(I, MPS, ITV)                                     \
+    USBD_CDC_IAD_DESC(I)                                                    \
+    /* Interface Descriptor */                                              \
+    0x09,                       /* bLength: Interface Descriptor size */    \
+    USB_DESC_TYPE_INTERFACE,    /* bDescriptorType: Interface */            \
+    2 * (I),                    /* bInterfaceNumber: Number of Interface */ \
+    0x00,                       /* bAlternateSetting: Alternate setting */  \
+    0x01,                       /* bNumEndpoints: One endpoints used */     \
+    0x02,                       /* bInterfaceClass: Communication Interface Class */\
+    0x02,                       /* bInterfaceSubClass: Abstract Control Model */\
+    0x01,                       /* bInterfaceProtocol: Common AT commands */\
+    0x00,                       /* iInterface: */                           \
+                                                                            \
+    /* Header Functional Descriptor */                                      \
+    0x05,                       /* bLength: Endpoint Descriptor size */     \
+    0x24,                       /* bDescriptorType: CS_INTERFACE */         \
+    0x00,                       /* bDescriptorSubtype: Header Func Desc */  \
+    0x10,                       /* bcdCDC: spec release number */           \
+    0x01,                                                                   \
+                                                                            \
+    /* Call Management Functional Descriptor */                             \
+    0x05,                       /* bFunctionLength */                       \
+    0x24,                       /* bDescriptorType: CS_INTERFACE */         \
+    0x01,                       /* bDescriptorSubtype: Call Management Func Desc */\
+    0x00,                       /* bmCapabilities: D0+D1 */                 \
+    2 * (I) + 1,                /* bDataInterface */                        \
+                                                                            \
+    /* ACM Functional Descriptor */                                         \
+    0x04,                       /* bFunctionLength */                       \
+    0x24,                       /* bDescriptorType: CS_INTERFACE */         \
+    0x02,                       /* bDescriptorSubtype: Abstract Control Management desc */\
+    0x02,                       /* bmCapabilities */                        \
+                                                                            \
+    /* Union Functional Descriptor */                                       \
+    0x05,                       /* bFunctionLength */                       \
+    0x24,                       /* bDescriptorType: CS_INTERFACE */         \
+    0x06,                       /* bDescriptorSubtype: Union func desc */   \
+    2 * (I),                    /* bMasterInterface: Communication class interface */\
+    2 * (I) + 1,                /* bSlaveInterface0: Data Class Interface */\
+                                                                            \
+    /* Command Endpoint Descriptor */                                       \
+    0x07,                       /* bLength: Endpoint Descriptor size */     \
+    USB_DESC_TYPE_ENDPOINT,     /* bDescriptorType: Endpoint */             \
+    CDC_INSTANCE_CMD_EP(I),     /* bEndpointAddress */                      \
+    0x03,                       /* bmAttributes: Interrupt */               \
+    LOBYTE(CDC_CMD_PACKET_SIZE),/* wMaxPacketSize: */                       \
+    HIBYTE(CDC_CMD_PACKET_SIZE),                                            \
+    (ITV),                      /* bInterval: */                            \
+                                                                            \
+    /* Data class interface descriptor */                                   \
+    0x09,                       /* bLength: Endpoint Descriptor size */     \
+    USB_DESC_TYPE_INTERFACE,    /* bDescriptorType: */                      \
+    2 * (I) + 1,                /* bInterfaceNumber: Number of Interface */ \
+    0x00,                       /* bAlternateSetting: Alternate setting */  \
+    0x02,                       /* bNumEndpoints: Two endpoints used */     \
+    0x0A,                       /* bInterfaceClass: CDC */                  \
+    0x00,                       /* bInterfaceSubClass: */                   \
+    0x00,                       /* bInterfaceProtocol: */                   \
+    0x00,                       /* iInterface: */                           \
+                                                                            \
+    /* Endpoint OUT Descriptor */                                           \
+    0x07,                       /* bLength: Endpoint Descriptor size */     \
+    USB_DESC_TYPE_ENDPOINT,     /* bDescriptorType: Endpoint */             \
+    CDC_INSTANCE_OUT_EP(I),     /* bEndpointAddress */                      \
+    0x02,                       /* bmAttributes: Bulk */                    \
+    LOBYTE(MPS),                /* wMaxPacketSize: */                       \
+    HIBYTE(MPS),                                                            \
+    0x00,                       /* bInterval: ignore for Bulk transfer */   \
+                                                                            \
+    /* Endpoint IN Descriptor */                                            \
+    0x07,                       /* bLength: Endpoint Descriptor size */     \
+    USB_DESC_TYPE_ENDPOINT,     /* bDescriptorType: Endpoint */             \
+    CDC_INSTANCE_IN_EP(I),      /* bEndpointAddress */                      \
+    0x02,                       /* bmAttributes: Bulk */                    \
+    LOBYTE(MPS),                /* wMaxPacketSize: */                       \
+    HIBYTE(MPS),                                                            \
+    0x00,                       /* bInterval: ignore for Bulk transfer */
+
+#if (CDC_INSTANCE_COUNT > 4)
+#error "The configuration descriptor is defined for up to 4 CDC instances."
+#endif
+
+/* USB CDC device Configuration Descriptor of all instances */
+#define USBD_CDC_CFG_DESC(MPS, ITV)                                         \
+    0x09,                            /* bLength: Configuration Descriptor size */\
+    USB_DESC_TYPE_CONFIGURATION,     /* bDescriptorType: Configuration */   \
+    LOBYTE(USB_CDC_CONFIG_DESC_SIZ), /* wTotalLength:no of returned bytes */\
+    HIBYTE(USB_CDC_CONFIG_DESC_SIZ),                                        \
+    2 * CDC_INSTANCE_COUNT,          /* bNumInterfaces: 2 interface per instance */\
+    0x01,                            /* bConfigurationValue: Configuration value */\
+    0x00,                            /* iConfiguration: Index of string descriptor describing the configuration */\
+    0x80 | (USBD_SELF_POWERED << 6), /* bmAttributes: self powered */       \
+    USBD_MAX_POWER_mA / 2,           /* MaxPower x mA */                    \
+    USBD_CDC_FUNC_DESC(0, MPS, ITV)                                         \
+    USBD_CDC_FUNC_DESC_1(MPS, ITV)                                          \
+    USBD_CDC_FUNC_DESC_2(MPS, ITV)                                          \
+    USBD_CDC_FUNC_DESC_3(MPS, ITV)
+
+#if (CDC_INSTANCE_COUNT > 1)
+#define USBD_CDC_FUNC_DESC_1(MPS, ITV)  USBD_CDC_FUNC_DESC(1, MPS, ITV)
+#else
+#define USBD_CDC_FUNC_DESC_1(MPS, ITV)
+#endif
+#if (CDC_INSTANCE_COUNT > 2)
+#define USBD_CDC_FUNC_DESC_2(MPS, ITV)  USBD_CDC_FUNC_DESC(2, MPS, ITV)
+#else
+#define USBD_CDC_FUNC_DESC_2(MPS, ITV)
+#endif
+#if (CDC_INSTANCE_COUNT > 3)
+#define USBD_CDC_FUNC_DESC_3(MPS, ITV)  USBD_CDC_FUNC_DESC(3, MPS, ITV)
 #else
-    0x80,                       /* bInterval: */
-#endif /* CDC_CMD_INTR_INTERVAL */
-
-    /* Data class interface descriptor */
-    0x09,                   /* bLength: Endpoint Descriptor size */
-    USB_DESC_TYPE_INTERFACE,/* bDescriptorType: */
-    0x01,                   /* bInterfaceNumber: Number of Interface */
-    0x00,                   /* bAlternateSetting: Alternate setting */
-    0x02,                   /* bNumEndpoints: Two endpoints used */
-    0x0A,                   /* bInterfaceClass: CDC */
-    0x00,                   /* bInterfaceSubClass: */
-    0x00,                   /* bInterfaceProtocol: */
-    0x00,                   /* iInterface: */
-
-    /* Endpoint OUT Descripto r*/
-    0x07,                               /* bLength: Endpoint Descriptor size */
-    USB_DESC_TYPE_ENDPOINT,             /* bDescriptorType: Endpoint */
-    CDC_OUT_EP,                         /* bEndpointAddress */
-    0x02,                               /* bmAttributes: Bulk */
-    LOBYTE(CDC_DATA_FS_MAX_PACKET_SIZE),/* wMaxPacketSize: */
-    HIBYTE(CDC_DATA_FS_MAX_PACKET_SIZE),
-    0x00,                               /* bInterval: ignore for Bulk transfer */
-
-    /* Endpoint IN Descriptor */
-    0x07,                               /* bLength: Endpoint Descriptor size */
-    USB_DESC_TYPE_ENDPOINT,             /* bDescriptorType: Endpoint */
-    CDC_IN_EP,                          /* bEndpointAddress */
-    0x02,                               /* bmAttributes: Bulk */
-    LOBYTE(CDC_DATA_FS_MAX_PACKET_SIZE),/* wMaxPacketSize: */
-    HIBYTE(CDC_DATA_FS_MAX_PACKET_SIZE),
-    0x00                                /* bInterval: ignore for Bulk transfer */
+#define USBD_CDC_FUNC_DESC_3(MPS, ITV)
+#endif
+
+#ifndef CDC_CMD_INTR_INTERVAL
+#define CDC_CMD_INTR_INTERVAL           0x80
+#endif
+
+/* USB CDC device Configuration Descriptors, placed in flash */
+__ALIGN_BEGIN static const uint8_t USBD_CDC_FSCfgDesc[USB_CDC_CONFIG_DESC_SIZ] __ALIGN_END =
+{
+    USBD_CDC_CFG_DESC(CDC_DATA_FS_MAX_PACKET_SIZE, CDC_CMD_INTR_INTERVAL)
+};
+
+#ifdef DEVICE_HS
+/* High speed interrupt interval is in 2^(bInterval-1) microframes */
+__ALIGN_BEGIN static const uint8_t USBD_CDC_HSCfgDesc[USB_CDC_CONFIG_DESC_SIZ] __ALIGN_END =
+{
+    USBD_CDC_CFG_DESC(CDC_DATA_HS_MAX_PACKET_SIZE, CDC_CMD_HS_INTR_INTERVAL)
 };
+#endif
 
 /** @} */
 
@@ -333,6 +310,7 @@ __ALIGN_BEGIN static const uint8_t USBD_CDC_CfgFSDesc[USB_CDC_CONFIG_DESC_SIZ] _
 static uint8_t USBD_CDC_Init(USBD_HandleTypeDef *pdev, uint8_t cfgidx)
 {
     uint16_t in_packet_size, out_packet_size;
+    uint8_t idx;
 
 #ifdef DEVICE_HS
     if (pdev->dev_speed == USBD_SPEED_HIGH)
@@ -347,40 +325,60 @@ static uint8_t USBD_CDC_Init(USBD_HandleTypeDef *pdev, uint8_t cfgidx)
         out_packet_size = CDC_DATA_FS_OUT_PACKET_SIZE;
     }
 
-    /* Open EP IN */
-    USBD_LL_OpenEP(pdev,
-        CDC_IN_EP,
-        USBD_EP_TYPE_BULK,
-        in_packet_size);
-
-    /* Open EP OUT */
-    USBD_LL_OpenEP(pdev,
-        CDC_OUT_EP,
-        USBD_EP_TYPE_BULK,
-        out_packet_size);
+    for (idx = 0; idx < CDC_INSTANCE_COUNT; idx++)
+    {
+        /* Open EP IN */
+        USBD_LL_OpenEP(pdev,
+            CDC_INSTANCE_IN_EP(idx),
+            USBD_EP_TYPE_BULK,
+            in_packet_size);
+
+        /* Open EP OUT */
+        USBD_LL_OpenEP(pdev,
+            CDC_INSTANCE_OUT_EP(idx),
+            USBD_EP_TYPE_BULK,
+            out_packet_size);
 
 #if (CDC_AT_COMMAND_SUPPORT == 1)
-    /* Open Command IN EP */
-    USBD_LL_OpenEP(pdev,
-        CDC_CMD_EP,
-        USBD_EP_TYPE_INTR,
-        CDC_CMD_PACKET_SIZE);
+        /* Open Command IN EP */
+        USBD_LL_OpenEP(pdev,
+            CDC_INSTANCE_CMD_EP(idx),
+            USBD_EP_TYPE_INTR,
+            CDC_CMD_PACKET_SIZE);
 #endif
+    }
 
-    pdev->pClassData = USBD_malloc(sizeof(USBD_CDC_HandleTypeDef));
+    pdev->pClassData = USBD_malloc(sizeof(USBD_CDC_HandleTypeDef) * CDC_INSTANCE_COUNT);
 
     if (pdev->pClassData != NULL)
     {
-        USBD_CDC_HandleTypeDef *hcdc = (USBD_CDC_HandleTypeDef*) pdev->pClassData;
-        USBD_CDC_ItfTypeDef *itf     = (USBD_CDC_ItfTypeDef*) pdev->pUserData;
-
-        /* Initialize transfer states */
-        hcdc->TxLength = 0;
-
-        /* Initialize CDC Interface components */
-        if (itf->Init != NULL)
+        for (idx = 0; idx < CDC_INSTANCE_COUNT; idx++)
         {
-            itf->Init();
+            USBD_CDC_HandleTypeDef *hcdc = CDC_INSTANCE_HANDLE(pdev, idx);
+            USBD_CDC_ItfTypeDef *itf     = CDC_INSTANCE_ITF(pdev, idx);
+
+            /* Initialize transfer states */
+            hcdc->TxLength  = 0;
+            hcdc->CmdOpCode = 0xFF;
+
+#if (CDC_OUT_BUFFER_COUNT > 0)
+            /* Start reception to the first pool buffer */
+            hcdc->OutPool.Head = 0;
+            hcdc->OutPool.Tail = 0;
+            hcdc->OutPool.Held = 0;
+            hcdc->OutPool.Paused = 0;
+            USBD_CDC_PoolReceive(pdev, idx);
+#endif
+#if (CDC_IN_BUFFER_SIZE > 0)
+            hcdc->InBuffer.Length = 0;
+            hcdc->InBuffer.Index  = 0;
+#endif
+
+            /* Initialize CDC Interface components */
+            if (itf->Init != NULL)
+            {
+                itf->Init();
+            }
         }
     }
 
@@ -395,28 +393,36 @@ static uint8_t USBD_CDC_Init(USBD_HandleTypeDef *pdev, uint8_t cfgidx)
  */
 static uint8_t USBD_CDC_DeInit(USBD_HandleTypeDef *pdev, uint8_t cfgidx)
 {
-    /* Close EP IN */
-    USBD_LL_CloseEP(pdev,
-    CDC_IN_EP);
+    uint8_t idx;
+
+    for (idx = 0; idx < CDC_INSTANCE_COUNT; idx++)
+    {
+        /* Close EP IN */
+        USBD_LL_CloseEP(pdev,
+        CDC_INSTANCE_IN_EP(idx));
 
-    /* Close EP OUT */
-    USBD_LL_CloseEP(pdev,
-    CDC_OUT_EP);
+        /* Close EP OUT */
+        USBD_LL_CloseEP(pdev,
+        CDC_INSTANCE_OUT_EP(idx));
 
 #if (CDC_AT_COMMAND_SUPPORT == 1)
-    /* Close Command IN EP */
-    USBD_LL_CloseEP(pdev,
-    CDC_CMD_EP);
+        /* Close Command IN EP */
+        USBD_LL_CloseEP(pdev,
+        CDC_INSTANCE_CMD_EP(idx));
 #endif
+    }
 
     /* DeInit CDC Interface components */
     if (pdev->pClassData != NULL)
     {
-        USBD_CDC_ItfTypeDef *itf     = (USBD_CDC_ItfTypeDef*) pdev->pUserData;
-
-        if (itf->DeInit != NULL)
+        for (idx = 0; idx < CDC_INSTANCE_COUNT; idx++)
         {
-            itf->DeInit();
+            USBD_CDC_ItfTypeDef *itf = CDC_INSTANCE_ITF(pdev, idx);
+
+            if (itf->DeInit != NULL)
+            {
+                itf->DeInit();
+            }
         }
 
         USBD_free(pdev->pClassData);
@@ -434,8 +440,17 @@ static uint8_t USBD_CDC_DeInit(USBD_HandleTypeDef *pdev, uint8_t cfgidx)
  */
 static uint8_t USBD_CDC_Setup(USBD_HandleTypeDef *pdev, USBD_SetupReqTypedef *req)
 {
-    USBD_CDC_HandleTypeDef *hcdc = (USBD_CDC_HandleTypeDef*) pdev->pClassData;
-    USBD_CDC_ItfTypeDef *itf     = (USBD_CDC_ItfTypeDef*) pdev->pUserData;
+    /* The interface pair of the instance is addressed */
+    uint8_t idx = LOBYTE(req->wIndex) / 2;
+    USBD_CDC_HandleTypeDef *hcdc;
+    USBD_CDC_ItfTypeDef *itf;
+
+    if ((idx >= CDC_INSTANCE_COUNT) || (pdev->pClassData == NULL))
+    {
+        return USBD_FAIL;
+    }
+    hcdc = CDC_INSTANCE_HANDLE(pdev, idx);
+    itf  = CDC_INSTANCE_ITF(pdev, idx);
 
     switch (req->bmRequest & USB_REQ_TYPE_MASK)
     {
@@ -494,11 +509,14 @@ static uint8_t USBD_CDC_Setup(USBD_HandleTypeDef *pdev, USBD_SetupReqTypedef *re
  */
 static uint8_t USBD_CDC_DataIn(USBD_HandleTypeDef *pdev, uint8_t epnum)
 {
-    USBD_CDC_HandleTypeDef *hcdc = (USBD_CDC_HandleTypeDef*) pdev->pClassData;
-    USBD_CDC_ItfTypeDef *itf     = (USBD_CDC_ItfTypeDef*) pdev->pUserData;
+    uint8_t idx = CDC_EP_INSTANCE(epnum);
 
-    if (hcdc != NULL)
+    /* Only the data IN endpoints have transfer management */
+    if ((pdev->pClassData != NULL) && (idx < CDC_INSTANCE_COUNT))
     {
+        USBD_CDC_HandleTypeDef *hcdc = CDC_INSTANCE_HANDLE(pdev, idx);
+        USBD_CDC_ItfTypeDef *itf     = CDC_INSTANCE_ITF(pdev, idx);
+
         /* If there has been a valid transmit request */
         if (hcdc->TxLength > 0)
         {
@@ -512,6 +530,10 @@ static uint8_t USBD_CDC_DataIn(USBD_HandleTypeDef *pdev, uint8_t epnum)
                 itf->Transmitted(hcdc->TxBuffer, txLen);
             }
         }
+#if (CDC_IN_BUFFER_SIZE > 0)
+        /* Send the data aggregated during the transfer */
+        USBD_CDC_InFlush(pdev, idx);
+#endif
     }
 
     return USBD_OK;
@@ -525,16 +547,59 @@ static uint8_t USBD_CDC_DataIn(USBD_HandleTypeDef *pdev, uint8_t epnum)
  */
 static uint8_t USBD_CDC_DataOut(USBD_HandleTypeDef *pdev, uint8_t epnum)
 {
-    USBD_CDC_HandleTypeDef *hcdc = (USBD_CDC_HandleTypeDef*) pdev->pClassData;
-    USBD_CDC_ItfTypeDef *itf     = (USBD_CDC_ItfTypeDef*) pdev->pUserData;
+    uint8_t idx = CDC_EP_INSTANCE(epnum);
+    USBD_CDC_HandleTypeDef *hcdc;
+    USBD_CDC_ItfTypeDef *itf;
+
+    if ((pdev->pClassData == NULL) || (idx >= CDC_INSTANCE_COUNT))
+    {
+        return USBD_FAIL;
+    }
+    hcdc = CDC_INSTANCE_HANDLE(pdev, idx);
+    itf  = CDC_INSTANCE_ITF(pdev, idx);
+
+#if (CDC_OUT_BUFFER_COUNT > 0)
+    /* The filled buffer is queued for the application,
+     * reception continues to the next free pool buffer */
+    {
+        uint8_t  head   = hcdc->OutPool.Head;
+        uint16_t length = (uint16_t)USBD_LL_GetRxDataSize(pdev, epnum);
+
+        hcdc->OutPool.Armed = 0;
 
+        /* Empty transfers don't consume buffer */
+        if (length > 0)
+        {
+            hcdc->OutPool.Length[head] = length;
+            hcdc->OutPool.Head = (head + 1) % CDC_OUT_BUFFER_COUNT;
+
+            /* When all buffers are filled, the endpoint NAKs until a buffer is released */
+            if (hcdc->OutPool.Head == hcdc->OutPool.Tail)
+            {
+                hcdc->OutPool.Held = 1;
+            }
+        }
+        /* The endpoint also NAKs while the application holds the reception */
+        if ((hcdc->OutPool.Held == 0) && (hcdc->OutPool.Paused == 0))
+        {
+            USBD_CDC_PoolReceive(pdev, idx);
+        }
+
+        if ((itf->Received != NULL) && (length > 0))
+        {
+            /* Provide callback on successful reception */
+            itf->Received((uint8_t *) hcdc->OutPool.Data[head], length);
+        }
+    }
+#else
     /* USB data will be immediately processed, this allows next USB traffic being
      NAKed till the end of the application transfer */
-    if ((itf->Received != NULL) && (hcdc != NULL))
+    if (itf->Received != NULL)
     {
         /* Provide callback on successful reception */
         itf->Received(hcdc->RxBuffer, USBD_LL_GetRxDataSize(pdev, epnum));
     }
+#endif
 
     return USBD_OK;
 }
@@ -546,14 +611,43 @@ static uint8_t USBD_CDC_DataOut(USBD_HandleTypeDef *pdev, uint8_t epnum)
  */
 static uint8_t USBD_CDC_EP0_RxReady(USBD_HandleTypeDef *pdev)
 {
-    USBD_CDC_HandleTypeDef *hcdc = (USBD_CDC_HandleTypeDef*) pdev->pClassData;
-    USBD_CDC_ItfTypeDef *itf     = (USBD_CDC_ItfTypeDef*) pdev->pUserData;
+    uint8_t idx;
 
-    if ((itf->Control != NULL) && (hcdc != NULL) && (hcdc->CmdOpCode != 0xFF))
+    for (idx = 0; (pdev->pClassData != NULL) && (idx < CDC_INSTANCE_COUNT); idx++)
     {
-        /* Provide callback to CMD handler */
-        itf->Control(hcdc->CmdOpCode, (uint8_t *) hcdc->data, hcdc->CmdLength);
-        hcdc->CmdOpCode = 0xFF;
+        USBD_CDC_HandleTypeDef *hcdc = CDC_INSTANCE_HANDLE(pdev, idx);
+        USBD_CDC_ItfTypeDef *itf     = CDC_INSTANCE_ITF(pdev, idx);
+
+        /* Find the instance which received the command data */
+        if ((itf->Control != NULL) && (hcdc->CmdOpCode != 0xFF))
+        {
+            /* Provide callback to CMD handler */
+            itf->Control(hcdc->CmdOpCode, (uint8_t *) hcdc->data, hcdc->CmdLength);
+            hcdc->CmdOpCode = 0xFF;
+        }
+    }
+
+    return USBD_OK;
+}
+
+/**
+ * @brief  Start Of Frame event processing
+ * @param  pdev: device instance
+ * @retval status
+ */
+static uint8_t USBD_CDC_SOF(USBD_HandleTypeDef *pdev)
+{
+    uint8_t idx;
+
+    for (idx = 0; (pdev->pClassData != NULL) && (idx < CDC_INSTANCE_COUNT); idx++)
+    {
+        USBD_CDC_ItfTypeDef *itf = CDC_INSTANCE_ITF(pdev, idx);
+
+        if (itf->StartOfFrame != NULL)
+        {
+            /* Provide callback for frame timing */
+            itf->StartOfFrame();
+        }
     }
 
     return USBD_OK;
@@ -566,8 +660,8 @@ static uint8_t USBD_CDC_EP0_RxReady(USBD_HandleTypeDef *pdev)
  */
 static uint8_t *USBD_CDC_GetFSCfgDesc(uint16_t *length)
 {
-    *length = sizeof(USBD_CDC_CfgFSDesc);
-    return USBD_CDC_CfgFSDesc;
+    *length = sizeof(USBD_CDC_FSCfgDesc);
+    return (uint8_t*)USBD_CDC_FSCfgDesc;
 }
 
 #ifdef DEVICE_HS
@@ -579,8 +673,8 @@ static uint8_t *USBD_CDC_GetFSCfgDesc(uint16_t *length)
  */
 static uint8_t *USBD_CDC_GetHSCfgDesc(uint16_t *length)
 {
-    *length = sizeof(USBD_CDC_CfgHSDesc);
-    return USBD_CDC_CfgHSDesc;
+    *length = sizeof(USBD_CDC_HSCfgDesc);
+    return (uint8_t*)USBD_CDC_HSCfgDesc;
 }
 #endif
 
@@ -595,10 +689,51 @@ static uint8_t *USBD_CDC_GetDeviceQualifierDescriptor(uint16_t *length)
     return USBD_CDC_DeviceQualifierDesc;
 }
 
+#if (CDC_OUT_BUFFER_COUNT > 0)
+/**
+ * @brief  Starts OUT endpoint reception to the head buffer of the pool
+ * @param  pdev: device instance
+ * @param  idx: CDC instance index
+ */
+static void USBD_CDC_PoolReceive(USBD_HandleTypeDef *pdev, uint8_t idx)
+{
+    USBD_CDC_HandleTypeDef *hcdc = CDC_INSTANCE_HANDLE(pdev, idx);
+
+    hcdc->RxBuffer = (uint8_t *) hcdc->OutPool.Data[hcdc->OutPool.Head];
+    hcdc->OutPool.Armed = 1;
+
+    (void) USBD_LL_PrepareReceive(pdev, CDC_INSTANCE_OUT_EP(idx), hcdc->RxBuffer, CDC_OUT_BUFFER_SIZE);
+}
+#endif
+
+#if (CDC_IN_BUFFER_SIZE > 0)
+/**
+ * @brief  Transmits the aggregated IN data if the endpoint is available
+ * @param  pdev: device instance
+ * @param  idx: CDC instance index
+ */
+static void USBD_CDC_InFlush(USBD_HandleTypeDef *pdev, uint8_t idx)
+{
+    USBD_CDC_HandleTypeDef *hcdc = CDC_INSTANCE_HANDLE(pdev, idx);
+
+    if ((hcdc->TxLength == 0) && (hcdc->InBuffer.Length > 0))
+    {
+        /* Switch buffers, the next writes are aggregated in the other one */
+        hcdc->TxBuffer = (uint8_t *) hcdc->InBuffer.Data[hcdc->InBuffer.Index];
+        hcdc->TxLength = hcdc->InBuffer.Length;
+
+        hcdc->InBuffer.Index ^= 1;
+        hcdc->InBuffer.Length = 0;
+
+        (void) USBD_LL_Transmit(pdev, CDC_INSTANCE_IN_EP(idx), hcdc->TxBuffer, hcdc->TxLength);
+    }
+}
+#endif
+
 /**
  * @brief  Sets the CDC user interface to the handler
  * @param  pdev: device instance
- * @param  fops: CDC Interface callback
+ * @param  fops: CDC Interface callbacks, an array of CDC_INSTANCE_COUNT elements
  * @retval status
  */
 uint8_t USBD_CDC_RegisterInterface(USBD_HandleTypeDef *pdev, const USBD_CDC_ItfTypeDef *fops)
@@ -617,17 +752,19 @@ uint8_t USBD_CDC_RegisterInterface(USBD_HandleTypeDef *pdev, const USBD_CDC_ItfT
 /**
  * @brief  Transmits user data through the CDC IN endpoint
  * @param  pdev: device instance
+ * @param  idx: CDC instance index
  * @param  pbuff: Tx Buffer
  * @param  length: Tx data length
  * @retval USBD_BUSY if IN transfer is already ongoing, otherwise USBD_OK
  */
-uint8_t USBD_CDC_Transmit(USBD_HandleTypeDef *pdev, uint8_t *pbuff, uint16_t length)
+uint8_t USBD_CDC_Transmit(USBD_HandleTypeDef *pdev, uint8_t idx, uint8_t *pbuff, uint16_t length)
 {
-    USBD_CDC_HandleTypeDef *hcdc = (USBD_CDC_HandleTypeDef*) pdev->pClassData;
     uint8_t retval = USBD_FAIL;
 
-    if (hcdc != NULL)
+    if (pdev->pClassData != NULL)
     {
+        USBD_CDC_HandleTypeDef *hcdc = CDC_INSTANCE_HANDLE(pdev, idx);
+
         retval = USBD_BUSY;
 
         /* If the transmit state is: free to transmit */
@@ -638,30 +775,73 @@ uint8_t USBD_CDC_Transmit(USBD_HandleTypeDef *pdev, uint8_t *pbuff, uint16_t len
             hcdc->TxLength = length;
 
             /* Transmit next packet */
-            retval = USBD_LL_Transmit(pdev, CDC_IN_EP, pbuff, length);
+            retval = USBD_LL_Transmit(pdev, CDC_INSTANCE_IN_EP(idx), pbuff, length);
         }
     }
     return retval;
 }
 
+#if (CDC_IN_BUFFER_SIZE > 0)
+/**
+ * @brief  Writes user data to the CDC IN endpoint buffer. The data is transmitted
+ *         immediately when the endpoint is available, otherwise it is aggregated
+ *         with the following writes (up to CDC_IN_BUFFER_SIZE) until
+ *         the ongoing transfer is completed.
+ * @note   Must not be called from a context that can preempt the USB interrupt.
+ * @param  pdev: device instance
+ * @param  idx: CDC instance index
+ * @param  pbuff: data to write
+ * @param  length: data length
+ * @retval The number of bytes accepted to the buffer
+ */
+uint16_t USBD_CDC_Write(USBD_HandleTypeDef *pdev, uint8_t idx, const uint8_t *pbuff, uint16_t length)
+{
+    uint16_t space = 0, i;
+
+    if (pdev->pClassData != NULL)
+    {
+        USBD_CDC_HandleTypeDef *hcdc = CDC_INSTANCE_HANDLE(pdev, idx);
+        uint8_t *pdst = (uint8_t *) hcdc->InBuffer.Data[hcdc->InBuffer.Index] + hcdc->InBuffer.Length;
+
+        space = CDC_IN_BUFFER_SIZE - hcdc->InBuffer.Length;
+        if (space > length)
+        {
+            space = length;
+        }
+
+        for (i = 0; i < space; i++)
+        {
+            pdst[i] = pbuff[i];
+        }
+        hcdc->InBuffer.Length += space;
+
+        USBD_CDC_InFlush(pdev, idx);
+    }
+    return space;
+}
+#endif
+
 /**
  * @brief  Initiates reception of user data through the CDC OUT endpoint
+ * @note   Not used when the OUT buffer pool is enabled.
  * @param  pdev: device instance
+ * @param  idx: CDC instance index
  * @param  pbuff: Rx Buffer
  * @param  length: Rx data length
  * @retval status
  */
-uint8_t USBD_CDC_Receive(USBD_HandleTypeDef *pdev, uint8_t *pbuff, uint16_t length)
+uint8_t USBD_CDC_Receive(USBD_HandleTypeDef *pdev, uint8_t idx, uint8_t *pbuff, uint16_t length)
 {
-    USBD_CDC_HandleTypeDef *hcdc = (USBD_CDC_HandleTypeDef*) pdev->pClassData;
     uint8_t retval = USBD_FAIL;
 
-    if (hcdc != NULL)
+    if (pdev->pClassData != NULL)
     {
+        USBD_CDC_HandleTypeDef *hcdc = CDC_INSTANCE_HANDLE(pdev, idx);
+
         hcdc->RxBuffer = pbuff;
 
         /* Prepare Out endpoint to receive next packet */
-        retval = USBD_LL_PrepareReceive(pdev, CDC_OUT_EP, hcdc->RxBuffer, length);
+        retval = USBD_LL_PrepareReceive(pdev, CDC_INSTANCE_OUT_EP(idx), hcdc->RxBuffer, length);
     }
     return retval;
 }
@@ -669,24 +849,135 @@ uint8_t USBD_CDC_Receive(USBD_HandleTypeDef *pdev, uint8_t *pbuff, uint16_t leng
 /**
  * @brief  Sets the input as command data on the CMD IN endpoint
  * @param  pdev: device instance
+ * @param  idx: CDC instance index
  * @param  pbuff: Tx Buffer
  * @retval status
  */
-uint8_t USBD_CDC_SendCommand(USBD_HandleTypeDef *pdev, uint8_t *pbuff)
+uint8_t USBD_CDC_SendCommand(USBD_HandleTypeDef *pdev, uint8_t idx, uint8_t *pbuff)
 {
-    USBD_CDC_HandleTypeDef *hcdc = (USBD_CDC_HandleTypeDef*) pdev->pClassData;
     uint8_t retval = USBD_FAIL;
 
 #if (CDC_AT_COMMAND_SUPPORT == 1)
-    if (hcdc != NULL)
+    if (pdev->pClassData != NULL)
     {
         /* Transmit command packet */
-        retval = USBD_LL_Transmit(pdev, CDC_CMD_EP, pbuff, CDC_CMD_PACKET_SIZE);
+        retval = USBD_LL_Transmit(pdev, CDC_INSTANCE_CMD_EP(idx), pbuff, CDC_CMD_PACKET_SIZE);
     }
 #endif
     return retval;
 }
 
+#if (CDC_OUT_BUFFER_COUNT > 0)
+/**
+ * @brief  Provides the oldest filled buffer of the OUT pool
+ * @param  pdev: device instance
+ * @param  idx: CDC instance index
+ * @param  length: pointer to the received data length in the buffer
+ * @retval Pointer to the received data, or NULL if no buffer is filled
+ */
+uint8_t *USBD_CDC_GetRxBuffer(USBD_HandleTypeDef *pdev, uint8_t idx, uint16_t *length)
+{
+    uint8_t *pbuff = NULL;
+
+    if (pdev->pClassData != NULL)
+    {
+        USBD_CDC_HandleTypeDef *hcdc = CDC_INSTANCE_HANDLE(pdev, idx);
+
+        if ((hcdc->OutPool.Tail != hcdc->OutPool.Head) || (hcdc->OutPool.Held != 0))
+        {
+            pbuff   = (uint8_t *) hcdc->OutPool.Data[hcdc->OutPool.Tail];
+            *length = hcdc->OutPool.Length[hcdc->OutPool.Tail];
+        }
+    }
+    return pbuff;
+}
+
+/**
+ * @brief  Returns the oldest filled buffer to the OUT pool after it has been processed
+ * @note   Must not be called from a context that can preempt the USB interrupt.
+ * @param  pdev: device instance
+ * @param  idx: CDC instance index
+ * @retval USBD_FAIL if no buffer is filled, otherwise USBD_OK
+ */
+uint8_t USBD_CDC_ReleaseRxBuffer(USBD_HandleTypeDef *pdev, uint8_t idx)
+{
+    uint8_t retval = USBD_FAIL;
+
+    if (pdev->pClassData != NULL)
+    {
+        USBD_CDC_HandleTypeDef *hcdc = CDC_INSTANCE_HANDLE(pdev, idx);
+
+        if ((hcdc->OutPool.Tail != hcdc->OutPool.Head) || (hcdc->OutPool.Held != 0))
+        {
+            hcdc->OutPool.Tail = (hcdc->OutPool.Tail + 1) % CDC_OUT_BUFFER_COUNT;
+
+            /* Resume the held reception to the released buffer */
+            if (hcdc->OutPool.Held != 0)
+            {
+                hcdc->OutPool.Held = 0;
+
+                if (hcdc->OutPool.Paused == 0)
+                {
+                    USBD_CDC_PoolReceive(pdev, idx);
+                }
+            }
+            retval = USBD_OK;
+        }
+    }
+    return retval;
+}
+
+/**
+ * @brief  Holds the OUT reception until @ref USBD_CDC_ResumeRx is called,
+ *         the endpoint NAKs after the currently received buffer is filled,
+ *         so the host throttles the data flow without data loss.
+ * @param  pdev: device instance
+ * @param  idx: CDC instance index
+ * @retval status
+ */
+uint8_t USBD_CDC_HoldRx(USBD_HandleTypeDef *pdev, uint8_t idx)
+{
+    uint8_t retval = USBD_FAIL;
+
+    if (pdev->pClassData != NULL)
+    {
+        USBD_CDC_HandleTypeDef *hcdc = CDC_INSTANCE_HANDLE(pdev, idx);
+
+        hcdc->OutPool.Paused = 1;
+        retval = USBD_OK;
+    }
+    return retval;
+}
+
+/**
+ * @brief  Signals that the application is ready to process OUT data again,
+ *         the reception continues when a pool buffer is free.
+ * @note   Must not be called from a context that can preempt the USB interrupt.
+ * @param  pdev: device instance
+ * @param  idx: CDC instance index
+ * @retval status
+ */
+uint8_t USBD_CDC_ResumeRx(USBD_HandleTypeDef *pdev, uint8_t idx)
+{
+    uint8_t retval = USBD_FAIL;
+
+    if (pdev->pClassData != NULL)
+    {
+        USBD_CDC_HandleTypeDef *hcdc = CDC_INSTANCE_HANDLE(pdev, idx);
+
+        hcdc->OutPool.Paused = 0;
+
+        /* Restart the reception if it was stopped by the hold */
+        if ((hcdc->OutPool.Armed == 0) && (hcdc->OutPool.Held == 0))
+        {
+            USBD_CDC_PoolReceive(pdev, idx);
+        }
+        retval = USBD_OK;
+    }
+    return retval;
+}
+#endif
+
 /** @} */
 
 /** @} */
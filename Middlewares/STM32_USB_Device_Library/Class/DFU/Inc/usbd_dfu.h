@@ -178,8 +178,11 @@ typedef struct
     void  (* DeInit)   (void);
     void  (* Erase)    (uint32_t Add);
     void  (* Write)    (uint8_t *dest, uint8_t *src, uint32_t Len);
-    void  (* Read)     (uint8_t *dest, uint8_t *src, uint32_t Len);
+    uint8_t* (* Read)  (uint8_t *dest, uint8_t *src, uint32_t Len); /* Returns the data to send: dest or src */
     void  (* GetStatus)(uint32_t Add,  uint8_t cmd, uint8_t *buff);
+#if (USBD_DFU_MAX_ITF_NUM > 1)
+    const uint8_t* pAltStrDesc[USBD_DFU_MAX_ITF_NUM - 1]; /* Strings of the further alternate settings */
+#endif
 }USBD_DFU_MediaTypeDef;
 
 /**
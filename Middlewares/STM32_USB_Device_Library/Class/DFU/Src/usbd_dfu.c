@@ -218,7 +218,7 @@ __ALIGN_BEGIN static const uint8_t USBD_DFU_CfgDesc[USB_DFU_CONFIG_DESC_SIZ] __A
     0x00,
     /*WARNING: In DMA mode the multiple MPS packets feature is still not supported
     ==> In this case, when using DMA USBD_DFU_XFER_SIZE should be set to 64 in usbd_conf.h */
-    TRANSFER_SIZE_BYTES(USBD_DFU_XFER_SIZE),    /* TransferSize = 1024 Byte*/
+    TRANSFER_SIZE_BYTES(USBD_DFU_XFER_SIZE),    /* TransferSize = USBD_DFU_XFER_SIZE */
     0x1A, 0x01                                  /* bcdDFUVersion*/
     /***********************************************************/
 };
@@ -515,8 +515,18 @@ static uint8_t* USBD_DFU_GetUsrStringDesc (USBD_HandleTypeDef *pdev, uint8_t ind
     /* Check if the requested string interface is supported */
     if (index <= (USBD_IDX_INTERFACE_STR + USBD_DFU_MAX_ITF_NUM))
     {
-        USBD_GetString ((uint8_t *)((USBD_DFU_MediaTypeDef *)pdev->pUserData)->pStrDesc,
-                USBD_StrDesc, length);
+        const USBD_DFU_MediaTypeDef *media = (USBD_DFU_MediaTypeDef *)pdev->pUserData;
+        const uint8_t *str = media->pStrDesc;
+
+#if (USBD_DFU_MAX_ITF_NUM > 1)
+        /* Alternate setting n has the string index USBD_IDX_INTERFACE_STR + n + 1 */
+        if ((index > (USBD_IDX_INTERFACE_STR + 1)) &&
+            (media->pAltStrDesc[index - USBD_IDX_INTERFACE_STR - 2] != NULL))
+        {
+            str = media->pAltStrDesc[index - USBD_IDX_INTERFACE_STR - 2];
+        }
+#endif
+        USBD_GetString ((uint8_t *)str, USBD_StrDesc, length);
         return USBD_StrDesc;
     }
     /* Not supported Interface Descriptor index */
@@ -607,8 +617,10 @@ static void DFU_Download(USBD_HandleTypeDef *pdev, USBD_SetupReqTypedef *req)
     /* Data setup request */
     if (req->wLength > 0)
     {
-        if (   (hdfu->dev_state == DFU_STATE_IDLE)
-            || (hdfu->dev_state == DFU_STATE_DNLOAD_IDLE))
+        /* The block has to fit in the transfer buffer */
+        if (   ((hdfu->dev_state == DFU_STATE_IDLE)
+            ||  (hdfu->dev_state == DFU_STATE_DNLOAD_IDLE))
+            && (req->wLength <= USBD_DFU_XFER_SIZE))
         {
             /* Update the global length and block number */
             hdfu->wblock_num = req->wValue;
@@ -621,7 +633,7 @@ static void DFU_Download(USBD_HandleTypeDef *pdev, USBD_SetupReqTypedef *req)
             /* Prepare the reception of the buffer over EP0 */
             USBD_CtlPrepareRx(pdev, (uint8_t*) hdfu->buffer.d8, hdfu->wlength);
         }
-        /* Unsupported state */
+        /* Unsupported state or block size */
         else
         {
             /* Call the error management function (command will be nacked) */
@@ -668,8 +680,10 @@ static void DFU_Upload(USBD_HandleTypeDef *pdev, USBD_SetupReqTypedef *req)
     /* Data setup request */
     if (req->wLength > 0)
     {
-        if (   (hdfu->dev_state == DFU_STATE_IDLE)
-            || (hdfu->dev_state == DFU_STATE_UPLOAD_IDLE))
+        /* The block may not exceed the transfer size */
+        if (   ((hdfu->dev_state == DFU_STATE_IDLE)
+            ||  (hdfu->dev_state == DFU_STATE_UPLOAD_IDLE))
+            && (req->wLength <= USBD_DFU_XFER_SIZE))
         {
             /* Update the global length and block number */
             hdfu->wblock_num = req->wValue;
@@ -705,16 +719,18 @@ static void DFU_Upload(USBD_HandleTypeDef *pdev, USBD_SetupReqTypedef *req)
 
                 /* Change is Accelerated */
                 addr = ((hdfu->wblock_num - 2) * USBD_DFU_XFER_SIZE) + hdfu->data_ptr;
+                phaddr = hdfu->buffer.d8;
 
                 if (((USBD_DFU_MediaTypeDef *) pdev->pUserData)->Read != NULL)
                 {
-                    /* Return the physical address where data are stored */
-                    ((USBD_DFU_MediaTypeDef *) pdev->pUserData)->Read(
+                    /* Return the physical address where data are stored,
+                     * memory mapped media can provide it without copying */
+                    phaddr = ((USBD_DFU_MediaTypeDef *) pdev->pUserData)->Read(
                             hdfu->buffer.d8, (uint8_t *) addr, hdfu->wlength);
                 }
 
                 /* Send the status data over EP0 */
-                USBD_CtlSendData(pdev, hdfu->buffer.d8, hdfu->wlength);
+                USBD_CtlSendData(pdev, phaddr, hdfu->wlength);
             }
             else /* unsupported hdfu->wblock_num */
             {
@@ -729,7 +745,7 @@ static void DFU_Upload(USBD_HandleTypeDef *pdev, USBD_SetupReqTypedef *req)
                 USBD_CtlError(pdev, req);
             }
         }
-        /* Unsupported state */
+        /* Unsupported state or block size */
         else
         {
             hdfu->wlength = 0;
@@ -777,8 +793,14 @@ static void DFU_GetStatus(USBD_HandleTypeDef *pdev)
                 {
                     if ((hdfu->wblock_num == 0) && (hdfu->buffer.d8[0] == DFU_CMD_ERASE))
                     {
+                        /* Provide the address of the block to be erased */
+                        uint32_t addr =  hdfu->buffer.d8[1]
+                                      | (hdfu->buffer.d8[2] << 8)
+                                      | (hdfu->buffer.d8[3] << 16)
+                                      | (hdfu->buffer.d8[4] << 24);
+
                         ((USBD_DFU_MediaTypeDef *) pdev->pUserData)->GetStatus(
-                                hdfu->data_ptr, DFU_MEDIA_ERASE, hdfu->dev_status);
+                                addr, DFU_MEDIA_ERASE, hdfu->dev_status);
                     }
                     else
                     {
@@ -0,0 +1,164 @@
+/**
+ ******************************************************************************
+ * @file    usbd_hid.h
+ * @author  Benedek Kupper
+ * @version V0.1
+ * @date    2018-01-20
+ * @brief   header file for the usbd_hid.c file.
+ ******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; COPYRIGHT 2015 STMicroelectronics</center></h2>
+ *
+ * Licensed under MCD-ST Liberty SW License Agreement V2, (the "License");
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *        http://www.st.com/software_license_agreement_liberty_v2
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************************
+ */
+#ifndef __USB_HID_H
+#define __USB_HID_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include  "usbd_ioreq.h"
+
+/** @addtogroup STM32_USB_DEVICE_LIBRARY
+ * @{
+ */
+
+/** @defgroup usbd_hid
+ * @brief This file is the Header file for usbd_hid.c
+ * @{
+ */
+
+/** @defgroup usbd_hid_Exported_Defines
+ * @{
+ */
+#define HID_EPIN_ADDR                               0x81  /* EP1 for input reports */
+
+/* Size of the application report descriptor, to be defined in usbd_conf.h */
+#ifndef HID_REPORT_DESC_SIZE
+#error "HID_REPORT_DESC_SIZE is not defined."
+#endif
+
+/* Largest input report size (including the report ID), and the endpoint packet size */
+#ifndef HID_MAX_REPORT_SIZE
+#define HID_MAX_REPORT_SIZE                         64
+#endif
+
+/* Polling intervals of the input endpoint */
+#ifndef HID_FS_BINTERVAL
+#define HID_FS_BINTERVAL                            1     /* Full speed: 1 ms frames */
+#endif
+#ifndef HID_HS_BINTERVAL
+#define HID_HS_BINTERVAL                            1     /* High speed: 2^(bInterval-1) x 125 us microframes */
+#endif
+
+#define USB_HID_DESC_SIZ                            9
+#define USB_HID_CONFIG_DESC_SIZ                     34
+
+/*---------------------------------------------------------------------*/
+/*  HID definitions                                                    */
+/*---------------------------------------------------------------------*/
+#define HID_DESCRIPTOR_TYPE                         0x21
+#define HID_REPORT_DESC                             0x22
+
+#define HID_REQ_GET_REPORT                          0x01
+#define HID_REQ_GET_IDLE                            0x02
+#define HID_REQ_GET_PROTOCOL                        0x03
+#define HID_REQ_SET_REPORT                          0x09
+#define HID_REQ_SET_IDLE                            0x0A
+#define HID_REQ_SET_PROTOCOL                        0x0B
+
+/**
+ * @}
+ */
+
+/** @defgroup USBD_CORE_Exported_TypesDefinitions
+ * @{
+ */
+
+/* Report interface of the application. The report descriptor has HID_REPORT_DESC_SIZE bytes,
+ * SetReport is called with the output and feature reports received on the control endpoint. */
+typedef struct _USBD_HID_Itf
+{
+    const uint8_t *ReportDesc;
+    void (*Init)(void);
+    void (*DeInit)(void);
+    void (*SetReport)(uint8_t type, uint8_t id, uint8_t *buf, uint16_t length);
+    void (*Transmitted)(void);
+} USBD_HID_ItfTypeDef;
+
+typedef struct
+{
+    uint32_t Report[2][(HID_MAX_REPORT_SIZE + 3) / 4]; /* Double-buffered input report slots */
+    uint32_t data[USB_MAX_EP0_SIZE / 4];    /* Control request data */
+    uint16_t Length[2];                     /* Input report length of the slots */
+    volatile uint8_t Write;                 /* Index of the slot owned by the application */
+    volatile uint8_t Writing;               /* The application is updating the write slot */
+    volatile uint8_t Pending;               /* The write slot holds a committed report */
+    volatile uint8_t Busy;                  /* The endpoint is transmitting the other slot */
+    uint8_t  Protocol;
+    uint8_t  IdleRate;
+    uint8_t  CmdOpCode;
+    uint8_t  CmdReport;
+} USBD_HID_HandleTypeDef;
+
+/**
+ * @}
+ */
+
+/** @defgroup USBD_CORE_Exported_Variables
+ * @{
+ */
+
+extern const USBD_ClassTypeDef USBD_HID;
+#define USBD_HID_CLASS    &USBD_HID
+
+/**
+ * @}
+ */
+
+/** @defgroup USB_CORE_Exported_Functions
+ * @{
+ */
+
+uint8_t USBD_HID_RegisterInterface(USBD_HandleTypeDef *pdev,
+        const USBD_HID_ItfTypeDef *fops);
+
+uint8_t *USBD_HID_GetReportSlot(USBD_HandleTypeDef *pdev);
+
+uint8_t USBD_HID_CommitReport(USBD_HandleTypeDef *pdev, uint16_t length);
+
+/**
+ * @}
+ */
+
+/**
+ * @}
+ */
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* __USB_HID_H */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -0,0 +1,548 @@
+/**
+ ******************************************************************************
+ * @file    usbd_hid.c
+ * @author  Benedek Kupper
+ * @version V0.1
+ * @date    2018-01-20
+ * @brief   This file provides the high layer firmware functions to manage the
+ *          following functionalities of the USB HID Class:
+ *           - Initialization and Configuration of high and low layer
+ *           - Enumeration as HID device with a custom report descriptor
+ *           - Input reports on the interrupt IN endpoint
+ *           - HID class requests management
+ *
+ *  @verbatim
+ *
+ *          ===================================================================
+ *                                HID Class Driver Description
+ *          ===================================================================
+ *           This driver manages the "Device Class Definition for Human Interface
+ *           Devices (HID) Version 1.11 June 27, 2001".
+ *           This driver implements the following aspects of the specification:
+ *             - The Boot Interface Subclass is not used
+ *             - Application provided report descriptor
+ *             - Input reports on an interrupt endpoint polled every frame at full speed
+ *               and every microframe at high speed (HID_FS_BINTERVAL, HID_HS_BINTERVAL)
+ *             - Output and feature reports on the control endpoint
+ *             - GET/SET_REPORT, GET/SET_IDLE, GET/SET_PROTOCOL requests
+ *
+ *           The input reports are double-buffered: the application fills the slot
+ *           returned by @ref USBD_HID_GetReportSlot and commits it with
+ *           @ref USBD_HID_CommitReport. The IN-complete path swaps the slots
+ *           and transmits the committed one without copying, so the host always
+ *           receives complete reports, and the latest one at each poll.
+ *
+ *  @endverbatim
+ *
+ ******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; COPYRIGHT 2015 STMicroelectronics</center></h2>
+ *
+ * Licensed under MCD-ST Liberty SW License Agreement V2, (the "License");
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *        http://www.st.com/software_license_agreement_liberty_v2
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************************
+ */
+
+#include "usbd_hid.h"
+#include "usbd_ctlreq.h"
+
+/** @addtogroup STM32_USB_DEVICE_LIBRARY
+ * @{ */
+
+/** @defgroup USBD_HID
+ * @brief USB Human Interface Device Class module
+ * @{ */
+
+static uint8_t USBD_HID_Init(USBD_HandleTypeDef *pdev, uint8_t cfgidx);
+
+static uint8_t USBD_HID_DeInit(USBD_HandleTypeDef *pdev, uint8_t cfgidx);
+
+static uint8_t USBD_HID_Setup(USBD_HandleTypeDef *pdev, USBD_SetupReqTypedef *req);
+
+static uint8_t USBD_HID_DataIn(USBD_HandleTypeDef *pdev, uint8_t epnum);
+
+static uint8_t USBD_HID_EP0_RxReady(USBD_HandleTypeDef *pdev);
+
+static uint8_t *USBD_HID_GetFSCfgDesc(uint16_t *length);
+
+#ifdef DEVICE_HS
+static uint8_t *USBD_HID_GetHSCfgDesc(uint16_t *length);
+#endif
+
+static uint8_t *USBD_HID_GetDeviceQualifierDescriptor(uint16_t *length);
+
+static void USBD_HID_SwapTransmit(USBD_HandleTypeDef *pdev);
+
+/* The HID handle and the user interface */
+#define HID_HANDLE(PDEV)                ((USBD_HID_HandleTypeDef*) (PDEV)->pClassData)
+#define HID_ITF(PDEV)                   ((USBD_HID_ItfTypeDef*) (PDEV)->pUserData)
+
+/** @defgroup USBD_HID_Private_Variables
+ * @{ */
+
+/* USB Standard Device Descriptor */
+__ALIGN_BEGIN static const uint8_t USBD_HID_DeviceQualifierDesc[USB_LEN_DEV_QUALIFIER_DESC] __ALIGN_END =
+{
+    USB_LEN_DEV_QUALIFIER_DESC,     /* bLength */
+    USB_DESC_TYPE_DEVICE_QUALIFIER, /* bDescriptorType */
+    0x00, 0x02,                     /* bcdUSB */
+    0x00,                           /* bDeviceClass */
+    0x00,                           /* bDeviceSubClass */
+    0x00,                           /* bDeviceProtocol */
+    0x40,                           /* bMaxPacketSize */
+    0x01,                           /* bNumConfigurations */
+    0x00,                           /* bReserved */
+};
+
+/* HID interface class callbacks structure */
+const USBD_ClassTypeDef USBD_HID = {
+    USBD_HID_Init,
+    USBD_HID_DeInit,
+    USBD_HID_Setup,
+    NULL, /* EP0_TxSent, */
+    USBD_HID_EP0_RxReady,
+    USBD_HID_DataIn,
+    NULL,
+    NULL,
+    NULL,
+    NULL,
+#ifdef DEVICE_HS
+    USBD_HID_GetHSCfgDesc,
+#else
+    NULL,
+#endif
+    USBD_HID_GetFSCfgDesc,
+    NULL, /* USBD_HID_GetOtherSpeedCfgDesc, */
+    USBD_HID_GetDeviceQualifierDescriptor
+};
+
+/* USB HID device Configuration Descriptor with the input endpoint interval ITV */
+#define USBD_HID_CFG_DESC(ITV)                                              \
+    0x09,                            /* bLength: Configuration Descriptor size */\
+    USB_DESC_TYPE_CONFIGURATION,     /* bDescriptorType: Configuration */   \
+    LOBYTE(USB_HID_CONFIG_DESC_SIZ), /* wTotalLength:no of returned bytes */\
+    HIBYTE(USB_HID_CONFIG_DESC_SIZ),                                        \
+    0x01,                            /* bNumInterfaces: 1 interface */      \
+    0x01,                            /* bConfigurationValue: Configuration value */\
+    0x00,                            /* iConfiguration: Index of string descriptor describing the configuration */\
+    0x80 | (USBD_SELF_POWERED << 6), /* bmAttributes: self powered */       \
+    USBD_MAX_POWER_mA / 2,           /* MaxPower x mA */                    \
+                                                                            \
+    /* Interface Descriptor */                                              \
+    0x09,                       /* bLength: Interface Descriptor size */    \
+    USB_DESC_TYPE_INTERFACE,    /* bDescriptorType: Interface */            \
+    0x00,                       /* bInterfaceNumber: Number of Interface */ \
+    0x00,                       /* bAlternateSetting: Alternate setting */  \
+    0x01,                       /* bNumEndpoints */                         \
+    0x03,                       /* bInterfaceClass: HID */                  \
+    0x00,                       /* bInterfaceSubClass: no boot */           \
+    0x00,                       /* bInterfaceProtocol: none */              \
+    0x00,                       /* iInterface: */                           \
+                                                                            \
+    /* HID Descriptor */                                                    \
+    USB_HID_DESC_SIZ,           /* bLength: HID Descriptor size */          \
+    HID_DESCRIPTOR_TYPE,        /* bDescriptorType: HID */                  \
+    0x11, 0x01,                 /* bcdHID: HID Class Spec release number */ \
+    0x00,                       /* bCountryCode: Hardware target country */ \
+    0x01,                       /* bNumDescriptors */                       \
+    HID_REPORT_DESC,            /* bDescriptorType: Report */               \
+    LOBYTE(HID_REPORT_DESC_SIZE), /* wItemLength: Total length of Report descriptor */\
+    HIBYTE(HID_REPORT_DESC_SIZE),                                           \
+                                                                            \
+    /* Endpoint IN Descriptor */                                            \
+    0x07,                       /* bLength: Endpoint Descriptor size */     \
+    USB_DESC_TYPE_ENDPOINT,     /* bDescriptorType: Endpoint */             \
+    HID_EPIN_ADDR,              /* bEndpointAddress */                      \
+    0x03,                       /* bmAttributes: Interrupt */               \
+    LOBYTE(HID_MAX_REPORT_SIZE),/* wMaxPacketSize: */                       \
+    HIBYTE(HID_MAX_REPORT_SIZE),                                            \
+    (ITV),                      /* bInterval: */
+
+/* USB HID device Configuration Descriptors, placed in flash */
+__ALIGN_BEGIN static const uint8_t USBD_HID_FSCfgDesc[USB_HID_CONFIG_DESC_SIZ] __ALIGN_END =
+{
+    USBD_HID_CFG_DESC(HID_FS_BINTERVAL)
+};
+
+#ifdef DEVICE_HS
+__ALIGN_BEGIN static const uint8_t USBD_HID_HSCfgDesc[USB_HID_CONFIG_DESC_SIZ] __ALIGN_END =
+{
+    USBD_HID_CFG_DESC(HID_HS_BINTERVAL)
+};
+#endif
+
+/* Offset of the HID descriptor in the configuration descriptor */
+#define HID_DESC_OFFSET                 18
+
+/** @} */
+
+/** @defgroup USBD_HID_Private_Functions
+ * @{ */
+
+/**
+ * @brief  (Re)Initialize the HID interface
+ * @param  pdev: device instance
+ * @param  cfgidx: Configuration index
+ * @retval status
+ */
+static uint8_t USBD_HID_Init(USBD_HandleTypeDef *pdev, uint8_t cfgidx)
+{
+    /* Open EP IN */
+    USBD_LL_OpenEP(pdev,
+        HID_EPIN_ADDR,
+        USBD_EP_TYPE_INTR,
+        HID_MAX_REPORT_SIZE);
+
+    pdev->pClassData = USBD_malloc(sizeof(USBD_HID_HandleTypeDef));
+
+    if (pdev->pClassData != NULL)
+    {
+        USBD_HID_HandleTypeDef *hhid = HID_HANDLE(pdev);
+        USBD_HID_ItfTypeDef *itf     = HID_ITF(pdev);
+
+        hhid->Length[0] = 0;
+        hhid->Length[1] = 0;
+        hhid->Write     = 0;
+        hhid->Writing   = 0;
+        hhid->Pending   = 0;
+        hhid->Busy      = 0;
+        hhid->Protocol  = 1; /* Report protocol */
+        hhid->IdleRate  = 0;
+        hhid->CmdOpCode = 0xFF;
+
+        /* Initialize HID Interface components */
+        if (itf->Init != NULL)
+        {
+            itf->Init();
+        }
+    }
+
+    return USBD_OK;
+}
+
+/**
+ * @brief  Deinitialize the HID interface
+ * @param  pdev: device instance
+ * @param  cfgidx: Configuration index
+ * @retval status
+ */
+static uint8_t USBD_HID_DeInit(USBD_HandleTypeDef *pdev, uint8_t cfgidx)
+{
+    /* Close EP IN */
+    USBD_LL_CloseEP(pdev,
+    HID_EPIN_ADDR);
+
+    /* DeInit HID Interface components */
+    if (pdev->pClassData != NULL)
+    {
+        USBD_HID_ItfTypeDef *itf = HID_ITF(pdev);
+
+        if (itf->DeInit != NULL)
+        {
+            itf->DeInit();
+        }
+
+        USBD_free(pdev->pClassData);
+        pdev->pClassData = NULL;
+    }
+
+    return USBD_OK;
+}
+
+/**
+ * @brief  Handle the HID specific requests
+ * @param  pdev: instance
+ * @param  req: HID request
+ * @retval status
+ */
+static uint8_t USBD_HID_Setup(USBD_HandleTypeDef *pdev, USBD_SetupReqTypedef *req)
+{
+    USBD_HID_HandleTypeDef *hhid = HID_HANDLE(pdev);
+    USBD_HID_ItfTypeDef *itf     = HID_ITF(pdev);
+
+    if (hhid == NULL)
+    {
+        return USBD_FAIL;
+    }
+
+    switch (req->bmRequest & USB_REQ_TYPE_MASK)
+    {
+    case USB_REQ_TYPE_CLASS:
+        switch (req->bRequest)
+        {
+        case HID_REQ_GET_REPORT:
+        {
+            /* The last transmitted input report */
+            uint8_t slot = hhid->Write ^ 1;
+
+            USBD_CtlSendData(pdev, (uint8_t *) hhid->Report[slot],
+                    MIN(hhid->Length[slot], req->wLength));
+            break;
+        }
+
+        case HID_REQ_SET_REPORT:
+            if ((req->wLength == 0) || (req->wLength > sizeof(hhid->data)))
+            {
+                return USBD_FAIL;
+            }
+            hhid->CmdOpCode = HIBYTE(req->wValue);
+            hhid->CmdReport = LOBYTE(req->wValue);
+
+            USBD_CtlPrepareRx(pdev, (uint8_t *) hhid->data, req->wLength);
+            break;
+
+        case HID_REQ_GET_IDLE:
+            USBD_CtlSendData(pdev, &hhid->IdleRate, 1);
+            break;
+
+        case HID_REQ_SET_IDLE:
+            /* The reports are only sent on change, the idle rate is only stored */
+            hhid->IdleRate = HIBYTE(req->wValue);
+            break;
+
+        case HID_REQ_GET_PROTOCOL:
+            USBD_CtlSendData(pdev, &hhid->Protocol, 1);
+            break;
+
+        case HID_REQ_SET_PROTOCOL:
+            hhid->Protocol = LOBYTE(req->wValue);
+            break;
+
+        default:
+            return USBD_FAIL;
+        }
+        break;
+
+    case USB_REQ_TYPE_STANDARD:
+        switch (req->bRequest)
+        {
+        case USB_REQ_GET_DESCRIPTOR:
+            if (HIBYTE(req->wValue) == HID_REPORT_DESC)
+            {
+                USBD_CtlSendData(pdev, (uint8_t *) itf->ReportDesc,
+                        MIN(HID_REPORT_DESC_SIZE, req->wLength));
+            }
+            else if (HIBYTE(req->wValue) == HID_DESCRIPTOR_TYPE)
+            {
+                USBD_CtlSendData(pdev, (uint8_t *) &USBD_HID_FSCfgDesc[HID_DESC_OFFSET],
+                        MIN(USB_HID_DESC_SIZ, req->wLength));
+            }
+            break;
+
+        case USB_REQ_GET_INTERFACE:
+            {
+                uint8_t ifalt = 0;
+                USBD_CtlSendData(pdev, &ifalt, 1);
+            }
+            break;
+
+        case USB_REQ_SET_INTERFACE:
+            break;
+        }
+        break;
+
+    default:
+        return USBD_FAIL;
+    }
+    return USBD_OK;
+}
+
+/**
+ * @brief  Data sent on non-control IN endpoint
+ * @param  pdev: device instance
+ * @param  epnum: endpoint number
+ * @retval status
+ */
+static uint8_t USBD_HID_DataIn(USBD_HandleTypeDef *pdev, uint8_t epnum)
+{
+    if (pdev->pClassData != NULL)
+    {
+        USBD_HID_HandleTypeDef *hhid = HID_HANDLE(pdev);
+        USBD_HID_ItfTypeDef *itf     = HID_ITF(pdev);
+
+        /* The committed report is sent at the next poll,
+         * unless the application is updating it */
+        if ((hhid->Pending != 0) && (hhid->Writing == 0))
+        {
+            USBD_HID_SwapTransmit(pdev);
+        }
+        else
+        {
+            hhid->Busy = 0;
+        }
+
+        if (itf->Transmitted != NULL)
+        {
+            /* Provide callback on successful transmission */
+            itf->Transmitted();
+        }
+    }
+
+    return USBD_OK;
+}
+
+/**
+ * @brief  Setup endpoint data processing
+ * @param  pdev: device instance
+ * @retval status
+ */
+static uint8_t USBD_HID_EP0_RxReady(USBD_HandleTypeDef *pdev)
+{
+    USBD_HID_HandleTypeDef *hhid = HID_HANDLE(pdev);
+    USBD_HID_ItfTypeDef *itf     = HID_ITF(pdev);
+
+    if ((hhid != NULL) && (hhid->CmdOpCode != 0xFF))
+    {
+        if (itf->SetReport != NULL)
+        {
+            /* Provide callback with the received report */
+            itf->SetReport(hhid->CmdOpCode, hhid->CmdReport,
+                    (uint8_t *) hhid->data, (uint16_t) pdev->request.wLength);
+        }
+        hhid->CmdOpCode = 0xFF;
+    }
+
+    return USBD_OK;
+}
+
+/**
+ * @brief  Returns the configuration descriptor
+ * @param  length: pointer to the data length
+ * @retval pointer to descriptor buffer
+ */
+static uint8_t *USBD_HID_GetFSCfgDesc(uint16_t *length)
+{
+    *length = sizeof(USBD_HID_FSCfgDesc);
+    return (uint8_t*)USBD_HID_FSCfgDesc;
+}
+
+#ifdef DEVICE_HS
+/**
+ * @brief  Returns the high speed configuration descriptor
+ * @param  length: pointer to the data length
+ * @retval pointer to descriptor buffer
+ */
+static uint8_t *USBD_HID_GetHSCfgDesc(uint16_t *length)
+{
+    *length = sizeof(USBD_HID_HSCfgDesc);
+    return (uint8_t*)USBD_HID_HSCfgDesc;
+}
+#endif
+
+/**
+ * @brief  Returns the Device Qualifier descriptor
+ * @param  length: pointer to the data length
+ * @retval pointer to descriptor buffer
+ */
+static uint8_t *USBD_HID_GetDeviceQualifierDescriptor(uint16_t *length)
+{
+    *length = sizeof(USBD_HID_DeviceQualifierDesc);
+    return (uint8_t*)USBD_HID_DeviceQualifierDesc;
+}
+
+/**
+ * @brief  Hands over the committed write slot to the endpoint
+ *         and gives the other slot to the application
+ * @param  pdev: device instance
+ */
+static void USBD_HID_SwapTransmit(USBD_HandleTypeDef *pdev)
+{
+    USBD_HID_HandleTypeDef *hhid = HID_HANDLE(pdev);
+    uint8_t slot = hhid->Write;
+
+    hhid->Write   = slot ^ 1;
+    hhid->Pending = 0;
+
+    (void) USBD_LL_Transmit(pdev, HID_EPIN_ADDR,
+            (uint8_t *) hhid->Report[slot], hhid->Length[slot]);
+}
+
+/**
+ * @brief  Sets the HID user interface to the handler
+ * @param  pdev: device instance
+ * @param  fops: HID Interface callbacks and report descriptor
+ * @retval status
+ */
+uint8_t USBD_HID_RegisterInterface(USBD_HandleTypeDef *pdev, const USBD_HID_ItfTypeDef *fops)
+{
+    uint8_t ret = USBD_FAIL;
+
+    if (fops != NULL)
+    {
+        pdev->pUserData = (void*)fops;
+        ret = USBD_OK;
+    }
+
+    return ret;
+}
+
+/**
+ * @brief  Provides the input report slot for the application to update.
+ *         The slot is not transmitted until it is committed by @ref USBD_HID_CommitReport.
+ * @note   Must not be called from a context that can preempt the USB interrupt.
+ * @param  pdev: device instance
+ * @retval Pointer to the report slot of HID_MAX_REPORT_SIZE bytes, or NULL if not configured
+ */
+uint8_t *USBD_HID_GetReportSlot(USBD_HandleTypeDef *pdev)
+{
+    uint8_t *pbuff = NULL;
+
+    if (pdev->pClassData != NULL)
+    {
+        USBD_HID_HandleTypeDef *hhid = HID_HANDLE(pdev);
+
+        /* The slot is kept by the application until committed */
+        hhid->Writing = 1;
+        pbuff = (uint8_t *) hhid->Report[hhid->Write];
+    }
+    return pbuff;
+}
+
+/**
+ * @brief  Commits the updated input report slot. The report is transmitted
+ *         immediately if the endpoint is idle, otherwise at the next poll of the host.
+ *         A report committed before the previous one is sent replaces it.
+ * @note   Must not be called from a context that can preempt the USB interrupt.
+ * @param  pdev: device instance
+ * @param  length: input report length
+ * @retval status
+ */
+uint8_t USBD_HID_CommitReport(USBD_HandleTypeDef *pdev, uint16_t length)
+{
+    uint8_t retval = USBD_FAIL;
+
+    if ((pdev->pClassData != NULL) && (length <= HID_MAX_REPORT_SIZE))
+    {
+        USBD_HID_HandleTypeDef *hhid = HID_HANDLE(pdev);
+
+        hhid->Length[hhid->Write] = length;
+        hhid->Pending = 1;
+        hhid->Writing = 0;
+
+        /* An idle endpoint is started here, otherwise the DataIn stage swaps the slots */
+        if (hhid->Busy == 0)
+        {
+            hhid->Busy = 1;
+            USBD_HID_SwapTransmit(pdev);
+        }
+        retval = USBD_OK;
+    }
+    return retval;
+}
+
+/** @} */
+
+/** @} */
+
+/** @} */
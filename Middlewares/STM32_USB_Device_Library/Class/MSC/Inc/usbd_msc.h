@@ -0,0 +1,221 @@
+/**
+ ******************************************************************************
+ * @file    usbd_msc.h
+ * @author  Benedek Kupper
+ * @version V0.1
+ * @date    2018-01-20
+ * @brief   header file for the usbd_msc.c file.
+ ******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; COPYRIGHT 2015 STMicroelectronics</center></h2>
+ *
+ * Licensed under MCD-ST Liberty SW License Agreement V2, (the "License");
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *        http://www.st.com/software_license_agreement_liberty_v2
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************************
+ */
+#ifndef __USB_MSC_H
+#define __USB_MSC_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include  "usbd_ioreq.h"
+
+/** @addtogroup STM32_USB_DEVICE_LIBRARY
+ * @{
+ */
+
+/** @defgroup usbd_msc
+ * @brief This file is the Header file for usbd_msc.c
+ * @{
+ */
+
+/** @defgroup usbd_msc_Exported_Defines
+ * @{
+ */
+#define MSC_EPIN_ADDR                               0x81  /* EP1 for BOT data and status IN */
+#define MSC_EPOUT_ADDR                              0x01  /* EP1 for BOT commands and data OUT */
+
+#define MSC_MAX_FS_PACKET                           64    /* Bulk endpoint packet size */
+
+/* Number of logical units (e.g. SD card and QSPI flash) */
+#ifndef MSC_MAX_LUN
+#define MSC_MAX_LUN                                 1
+#endif
+
+/* Media transfer pipeline parameters: READ(10) and WRITE(10) data is passed through
+ * a pool of buffers, so the media transfer of one buffer overlaps
+ * with the USB transfer of another. */
+#ifndef MSC_BUFFER_COUNT
+#define MSC_BUFFER_COUNT                            2     /* Number of pool buffers (at least 2) */
+#endif
+#ifndef MSC_BUFFER_SIZE
+#define MSC_BUFFER_SIZE                             4096  /* Pool buffer size (multiple of the media block size) */
+#endif
+
+#define MSC_INQUIRY_DATA_LEN                        36    /* Standard INQUIRY data length of a LUN */
+
+#define USB_MSC_CONFIG_DESC_SIZ                     32
+
+/* Media interface operation results */
+#define MSC_MEDIA_OK                                0     /* Success, or the operation is started */
+#define MSC_MEDIA_BUSY                              1     /* The media is temporarily busy, retry later */
+#define MSC_MEDIA_FAIL                              (-1)  /* The operation failed */
+
+/*---------------------------------------------------------------------*/
+/*  MSC definitions                                                    */
+/*---------------------------------------------------------------------*/
+#define MSC_REQ_GET_MAX_LUN                         0xFE
+#define MSC_REQ_BOT_RESET                           0xFF
+
+#define MSC_CBW_SIGNATURE                           0x43425355
+#define MSC_CSW_SIGNATURE                           0x53425355
+#define MSC_CBW_LENGTH                              31
+#define MSC_CSW_LENGTH                              13
+
+#define MSC_CSW_CMD_PASSED                          0x00
+#define MSC_CSW_CMD_FAILED                          0x01
+#define MSC_CSW_PHASE_ERROR                         0x02
+
+/* SCSI commands */
+#define SCSI_TEST_UNIT_READY                        0x00
+#define SCSI_REQUEST_SENSE                          0x03
+#define SCSI_INQUIRY                                0x12
+#define SCSI_MODE_SENSE6                            0x1A
+#define SCSI_START_STOP_UNIT                        0x1B
+#define SCSI_ALLOW_MEDIUM_REMOVAL                   0x1E
+#define SCSI_READ_FORMAT_CAPACITIES                 0x23
+#define SCSI_READ_CAPACITY10                        0x25
+#define SCSI_READ10                                 0x28
+#define SCSI_WRITE10                                0x2A
+#define SCSI_VERIFY10                               0x2F
+#define SCSI_MODE_SENSE10                           0x5A
+
+/* SCSI sense keys */
+#define SCSI_SENSE_NO_SENSE                         0x00
+#define SCSI_SENSE_NOT_READY                        0x02
+#define SCSI_SENSE_MEDIUM_ERROR                     0x03
+#define SCSI_SENSE_ILLEGAL_REQUEST                  0x05
+#define SCSI_SENSE_DATA_PROTECT                     0x07
+
+/* SCSI additional sense codes */
+#define SCSI_ASC_WRITE_FAULT                        0x03
+#define SCSI_ASC_UNRECOVERED_READ_ERROR             0x11
+#define SCSI_ASC_INVALID_COMMAND                    0x20
+#define SCSI_ASC_ADDRESS_OUT_OF_RANGE               0x21
+#define SCSI_ASC_INVALID_FIELD_IN_CDB               0x24
+#define SCSI_ASC_WRITE_PROTECTED                    0x27
+#define SCSI_ASC_MEDIUM_NOT_PRESENT                 0x3A
+
+/**
+ * @}
+ */
+
+/** @defgroup USBD_CORE_Exported_TypesDefinitions
+ * @{
+ */
+
+/* Media interface of the logical units. Read and Write start the transfer of blk_len blocks,
+ * its end is signalled by USBD_MSC_MediaComplete (which may also be called before returning). */
+typedef struct _USBD_MSC_Itf
+{
+    int8_t (*Init)(uint8_t lun);
+    int8_t (*GetCapacity)(uint8_t lun, uint32_t *block_num, uint16_t *block_size);
+    int8_t (*IsReady)(uint8_t lun);
+    int8_t (*IsWriteProtected)(uint8_t lun);
+    int8_t (*Read)(uint8_t lun, uint8_t *buf, uint32_t blk_addr, uint16_t blk_len);
+    int8_t (*Write)(uint8_t lun, uint8_t *buf, uint32_t blk_addr, uint16_t blk_len);
+    const uint8_t *Inquiry;                 /* MSC_INQUIRY_DATA_LEN bytes of INQUIRY data for each LUN */
+} USBD_MSC_ItfTypeDef;
+
+typedef struct
+{
+    uint32_t Buffer[MSC_BUFFER_COUNT][MSC_BUFFER_SIZE / 4]; /* Force 32bits alignment */
+    uint32_t CBW[MSC_MAX_FS_PACKET / 4];    /* Command block wrapper reception */
+    uint32_t CSW[(MSC_CSW_LENGTH + 3) / 4]; /* Command status wrapper transmission */
+    uint32_t data[MSC_INQUIRY_DATA_LEN / 4]; /* Short SCSI command responses */
+    uint32_t BlockCount[MSC_MAX_LUN];       /* Number of media blocks of the LUNs */
+    uint16_t BlockSize[MSC_MAX_LUN];        /* Media block size of the LUNs */
+    uint32_t Tag;                           /* Tag of the ongoing command */
+    uint32_t DataLength;                    /* Number of data bytes expected by the host */
+    uint32_t Transferred;                   /* Number of data bytes transferred */
+    struct {
+        uint32_t MediaAddr;                 /* Next block address of the media transfer */
+        uint32_t MediaBlocks;               /* Number of blocks left to start on the media */
+        uint32_t UsbBytes;                  /* Number of bytes left to start on USB */
+        uint16_t Length[MSC_BUFFER_COUNT];  /* Data length of the filled buffers */
+        uint16_t MediaCount;                /* Number of blocks of the ongoing media transfer */
+        uint16_t UsbLength;                 /* Length of the ongoing USB reception */
+        uint8_t  MediaIndex;                /* Index of the buffer of the media transfer */
+        uint8_t  UsbIndex;                  /* Index of the buffer of the USB transfer */
+        uint8_t  Filled;                    /* Number of buffers holding data in transit */
+        uint8_t  MediaBusy;                 /* The media transfer is ongoing */
+        uint8_t  MediaDrop;                 /* The ongoing media transfer belongs to an aborted command */
+        uint8_t  MediaRetry;                /* The media was busy, the transfer is retried at SOF */
+        uint8_t  UsbBusy;                   /* The USB transfer is ongoing */
+    } Pipe;
+    uint8_t  State;                         /* Bulk-Only Transport state */
+    uint8_t  Status;                        /* CSW status of the ongoing command */
+    uint8_t  Lun;                           /* LUN of the ongoing command */
+    uint8_t  Flags;                         /* Direction flags of the ongoing command */
+    uint8_t  SenseKey;
+    uint8_t  SenseASC;
+} USBD_MSC_HandleTypeDef;
+
+/**
+ * @}
+ */
+
+/** @defgroup USBD_CORE_Exported_Variables
+ * @{
+ */
+
+extern const USBD_ClassTypeDef USBD_MSC;
+#define USBD_MSC_CLASS    &USBD_MSC
+
+/**
+ * @}
+ */
+
+/** @defgroup USB_CORE_Exported_Functions
+ * @{
+ */
+
+uint8_t USBD_MSC_RegisterInterface(USBD_HandleTypeDef *pdev,
+        const USBD_MSC_ItfTypeDef *fops);
+
+void USBD_MSC_MediaComplete(USBD_HandleTypeDef *pdev, int8_t status);
+
+/**
+ * @}
+ */
+
+/**
+ * @}
+ */
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* __USB_MSC_H */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -0,0 +1,1062 @@
+/**
+ ******************************************************************************
+ * @file    usbd_msc.c
+ * @author  Benedek Kupper
+ * @version V0.1
+ * @date    2018-01-20
+ * @brief   This file provides the high layer firmware functions to manage the
+ *          following functionalities of the USB Mass Storage Class:
+ *           - Initialization and Configuration of high and low layer
+ *           - Enumeration as Mass Storage Device
+ *           - Bulk-Only Transport command, data and status transfers
+ *           - SCSI command processing with pipelined media transfers
+ *
+ *  @verbatim
+ *
+ *          ===================================================================
+ *                                MSC Class Driver Description
+ *          ===================================================================
+ *           This driver manages the "Universal Serial Bus Mass Storage Class
+ *           Bulk-Only Transport Revision 1.0 September 31, 1999" with the
+ *           SCSI transparent command set (SCSI Primary and Block Commands).
+ *           This driver implements the following aspects of the specification:
+ *             - Bulk-Only Transport protocol with multiple logical units
+ *             - Bulk-Only Mass Storage Reset and Get Max LUN requests
+ *             - SCSI commands: TEST UNIT READY, REQUEST SENSE, INQUIRY, MODE SENSE(6/10),
+ *               START STOP UNIT, PREVENT ALLOW MEDIUM REMOVAL, READ FORMAT CAPACITIES,
+ *               READ CAPACITY(10), READ(10), WRITE(10), VERIFY(10)
+ *
+ *           The READ(10) and WRITE(10) data passes through MSC_BUFFER_COUNT buffers:
+ *           while one buffer is transferred over the bulk endpoint, the media fills
+ *           (or stores) the next one, so the media and the USB transfers overlap.
+ *           The media Read and Write interface functions only start the transfer
+ *           (e.g. an SD card DMA request), and its end is signalled with
+ *           @ref USBD_MSC_MediaComplete, which shall be called from an interrupt of the same
+ *           priority as the USB interrupt (or from the interface function itself).
+ *           When the media reports MSC_MEDIA_BUSY, the transfer is retried at the next SOF,
+ *           so SOF has to be enabled in the USB driver in this case.
+ *
+ *           This driver doesn't implement the following aspects of the specification
+ *           (but it is possible to manage these features with some modifications on this driver):
+ *             - SCSI commands other than the above, and vital product data pages
+ *             - High speed operation
+ *
+ *  @endverbatim
+ *
+ ******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; COPYRIGHT 2015 STMicroelectronics</center></h2>
+ *
+ * Licensed under MCD-ST Liberty SW License Agreement V2, (the "License");
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *        http://www.st.com/software_license_agreement_liberty_v2
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************************
+ */
+
+#include "usbd_msc.h"
+#include "usbd_ctlreq.h"
+#include <string.h>
+
+/** @addtogroup STM32_USB_DEVICE_LIBRARY
+ * @{ */
+
+/** @defgroup USBD_MSC
+ * @brief USB Mass Storage Device Class module
+ * @{ */
+
+static uint8_t USBD_MSC_Init(USBD_HandleTypeDef *pdev, uint8_t cfgidx);
+
+static uint8_t USBD_MSC_DeInit(USBD_HandleTypeDef *pdev, uint8_t cfgidx);
+
+static uint8_t USBD_MSC_Setup(USBD_HandleTypeDef *pdev, USBD_SetupReqTypedef *req);
+
+static uint8_t USBD_MSC_DataIn(USBD_HandleTypeDef *pdev, uint8_t epnum);
+
+static uint8_t USBD_MSC_DataOut(USBD_HandleTypeDef *pdev, uint8_t epnum);
+
+static uint8_t USBD_MSC_SOF(USBD_HandleTypeDef *pdev);
+
+static uint8_t *USBD_MSC_GetFSCfgDesc(uint16_t *length);
+
+static uint8_t *USBD_MSC_GetDeviceQualifierDescriptor(uint16_t *length);
+
+static void MSC_BOT_Reset(USBD_HandleTypeDef *pdev);
+
+static void MSC_BOT_DecodeCBW(USBD_HandleTypeDef *pdev);
+
+static void MSC_BOT_SendCSW(USBD_HandleTypeDef *pdev, uint8_t status);
+
+static void MSC_BOT_Fail(USBD_HandleTypeDef *pdev, uint8_t key, uint8_t asc);
+
+static void MSC_Pipe_MediaStart(USBD_HandleTypeDef *pdev);
+
+static void MSC_Pipe_UsbStart(USBD_HandleTypeDef *pdev);
+
+/* Bulk-Only Transport states */
+#define MSC_STATE_IDLE                  0   /* Waiting for the CBW */
+#define MSC_STATE_DATA_IN               1   /* Short command response is sent */
+#define MSC_STATE_READ                  2   /* READ(10) data is pipelined to the host */
+#define MSC_STATE_WRITE                 3   /* WRITE(10) data is pipelined to the media */
+#define MSC_STATE_STATUS                4   /* The CSW is sent */
+#define MSC_STATE_STALLED               5   /* The CSW is sent when the host clears the IN halt */
+#define MSC_STATE_ERROR                 6   /* Invalid CBW, halted until reset */
+
+/* CBW field offsets */
+#define MSC_CBW_TAG                     4
+#define MSC_CBW_DATA_LENGTH             8
+#define MSC_CBW_FLAGS                   12
+#define MSC_CBW_LUN                     13
+#define MSC_CBW_CB_LENGTH               14
+#define MSC_CBW_CB                      15
+
+#define MSC_CBW_FLAGS_IN                0x80
+
+/* The MSC handle and the user interface */
+#define MSC_HANDLE(PDEV)                ((USBD_MSC_HandleTypeDef*) (PDEV)->pClassData)
+#define MSC_ITF(PDEV)                   ((USBD_MSC_ItfTypeDef*) (PDEV)->pUserData)
+
+/* Pool buffer access */
+#define MSC_BUFFER(HMSC, INDEX)         ((uint8_t *) (HMSC)->Buffer[(INDEX)])
+#define MSC_NEXT_BUFFER(INDEX)          (((INDEX) + 1 < MSC_BUFFER_COUNT) ? ((INDEX) + 1) : 0)
+
+/** @defgroup USBD_MSC_Private_Variables
+ * @{ */
+
+/* USB Standard Device Descriptor */
+__ALIGN_BEGIN static const uint8_t USBD_MSC_DeviceQualifierDesc[USB_LEN_DEV_QUALIFIER_DESC] __ALIGN_END =
+{
+    USB_LEN_DEV_QUALIFIER_DESC,     /* bLength */
+    USB_DESC_TYPE_DEVICE_QUALIFIER, /* bDescriptorType */
+    0x00, 0x02,                     /* bcdUSB */
+    0x00,                           /* bDeviceClass */
+    0x00,                           /* bDeviceSubClass */
+    0x00,                           /* bDeviceProtocol */
+    0x40,                           /* bMaxPacketSize */
+    0x01,                           /* bNumConfigurations */
+    0x00,                           /* bReserved */
+};
+
+/* MSC interface class callbacks structure */
+const USBD_ClassTypeDef USBD_MSC = {
+    USBD_MSC_Init,
+    USBD_MSC_DeInit,
+    USBD_MSC_Setup,
+    NULL, /* EP0_TxSent, */
+    NULL, /* EP0_RxReady, */
+    USBD_MSC_DataIn,
+    USBD_MSC_DataOut,
+    USBD_MSC_SOF,
+    NULL,
+    NULL,
+    NULL,
+    USBD_MSC_GetFSCfgDesc,
+    NULL, /* USBD_MSC_GetOtherSpeedCfgDesc, */
+    USBD_MSC_GetDeviceQualifierDescriptor
+};
+
+/* USB MSC device Configuration Descriptor */
+__ALIGN_BEGIN static const uint8_t USBD_MSC_CfgDesc[USB_MSC_CONFIG_DESC_SIZ] __ALIGN_END =
+{
+    /* Configuration Descriptor */
+    0x09,                                   /* bLength: Configuration Descriptor size */
+    USB_DESC_TYPE_CONFIGURATION,            /* bDescriptorType: Configuration */
+    LOBYTE(USB_MSC_CONFIG_DESC_SIZ),        /* wTotalLength: no of returned bytes */
+    HIBYTE(USB_MSC_CONFIG_DESC_SIZ),
+    0x01,                                   /* bNumInterfaces: 1 interface */
+    0x01,                                   /* bConfigurationValue: Configuration value */
+    0x00,                                   /* iConfiguration: Index of string descriptor describing the configuration */
+    0x80 | (USBD_SELF_POWERED << 6),        /* bmAttributes: self powered */
+    USBD_MAX_POWER_mA / 2,                  /* MaxPower x mA */
+
+    /* Interface Descriptor */
+    0x09,                                   /* bLength */
+    USB_DESC_TYPE_INTERFACE,                /* bDescriptorType: Interface */
+    0x00,                                   /* bInterfaceNumber */
+    0x00,                                   /* bAlternateSetting */
+    0x02,                                   /* bNumEndpoints */
+    0x08,                                   /* bInterfaceClass: Mass Storage */
+    0x06,                                   /* bInterfaceSubClass: SCSI transparent */
+    0x50,                                   /* bInterfaceProtocol: Bulk-Only Transport */
+    0x00,                                   /* iInterface */
+
+    /* Endpoint IN Descriptor */
+    0x07,                                   /* bLength */
+    USB_DESC_TYPE_ENDPOINT,                 /* bDescriptorType: Endpoint */
+    MSC_EPIN_ADDR,                          /* bEndpointAddress */
+    0x02,                                   /* bmAttributes: Bulk */
+    LOBYTE(MSC_MAX_FS_PACKET),              /* wMaxPacketSize */
+    HIBYTE(MSC_MAX_FS_PACKET),
+    0x00,                                   /* bInterval */
+
+    /* Endpoint OUT Descriptor */
+    0x07,                                   /* bLength */
+    USB_DESC_TYPE_ENDPOINT,                 /* bDescriptorType: Endpoint */
+    MSC_EPOUT_ADDR,                         /* bEndpointAddress */
+    0x02,                                   /* bmAttributes: Bulk */
+    LOBYTE(MSC_MAX_FS_PACKET),              /* wMaxPacketSize */
+    HIBYTE(MSC_MAX_FS_PACKET),
+    0x00,                                   /* bInterval */
+};
+
+/** @} */
+
+/** @defgroup USBD_MSC_Private_Functions
+ * @{ */
+
+/**
+ * @brief  (Re)Initialize the MSC interface
+ * @param  pdev: device instance
+ * @param  cfgidx: Configuration index
+ * @retval status
+ */
+static uint8_t USBD_MSC_Init(USBD_HandleTypeDef *pdev, uint8_t cfgidx)
+{
+    pdev->pClassData = USBD_malloc(sizeof(USBD_MSC_HandleTypeDef));
+
+    if (pdev->pClassData != NULL)
+    {
+        USBD_MSC_HandleTypeDef *hmsc = MSC_HANDLE(pdev);
+        USBD_MSC_ItfTypeDef *itf     = MSC_ITF(pdev);
+        uint8_t lun;
+
+        /* Open the bulk endpoints */
+        USBD_LL_OpenEP(pdev, MSC_EPIN_ADDR, USBD_EP_TYPE_BULK, MSC_MAX_FS_PACKET);
+        USBD_LL_OpenEP(pdev, MSC_EPOUT_ADDR, USBD_EP_TYPE_BULK, MSC_MAX_FS_PACKET);
+
+        hmsc->Pipe.MediaBusy = 0;
+        hmsc->Pipe.MediaDrop = 0;
+        hmsc->SenseKey = SCSI_SENSE_NO_SENSE;
+        hmsc->SenseASC = 0;
+
+        /* Initialize MSC Interface components */
+        for (lun = 0; lun < MSC_MAX_LUN; lun++)
+        {
+            hmsc->BlockCount[lun] = 0;
+            hmsc->BlockSize[lun]  = 0;
+
+            if (itf->Init != NULL)
+            {
+                (void) itf->Init(lun);
+            }
+        }
+
+        MSC_BOT_Reset(pdev);
+    }
+
+    return USBD_OK;
+}
+
+/**
+ * @brief  Deinitialize the MSC interface
+ * @param  pdev: device instance
+ * @param  cfgidx: Configuration index
+ * @retval status
+ */
+static uint8_t USBD_MSC_DeInit(USBD_HandleTypeDef *pdev, uint8_t cfgidx)
+{
+    /* Close the bulk endpoints */
+    USBD_LL_CloseEP(pdev, MSC_EPIN_ADDR);
+    USBD_LL_CloseEP(pdev, MSC_EPOUT_ADDR);
+
+    if (pdev->pClassData != NULL)
+    {
+        USBD_free(pdev->pClassData);
+        pdev->pClassData = NULL;
+    }
+
+    return USBD_OK;
+}
+
+/**
+ * @brief  Handle the MSC specific requests
+ * @param  pdev: instance
+ * @param  req: MSC request
+ * @retval status
+ */
+static uint8_t USBD_MSC_Setup(USBD_HandleTypeDef *pdev, USBD_SetupReqTypedef *req)
+{
+    USBD_MSC_HandleTypeDef *hmsc = MSC_HANDLE(pdev);
+
+    if (hmsc == NULL)
+    {
+        return USBD_FAIL;
+    }
+
+    switch (req->bmRequest & USB_REQ_TYPE_MASK)
+    {
+    case USB_REQ_TYPE_CLASS:
+        if ((req->bRequest == MSC_REQ_GET_MAX_LUN) && (req->wValue == 0) && (req->wLength == 1))
+        {
+            hmsc->data[0] = MSC_MAX_LUN - 1;
+            USBD_CtlSendData(pdev, (uint8_t *) hmsc->data, 1);
+        }
+        else if ((req->bRequest == MSC_REQ_BOT_RESET) && (req->wValue == 0) && (req->wLength == 0))
+        {
+            MSC_BOT_Reset(pdev);
+            USBD_CtlSendStatus(pdev);
+        }
+        else
+        {
+            USBD_CtlError(pdev, req);
+        }
+        break;
+
+    case USB_REQ_TYPE_STANDARD:
+        switch (req->bRequest)
+        {
+        case USB_REQ_GET_INTERFACE:
+            hmsc->data[0] = 0;
+            USBD_CtlSendData(pdev, (uint8_t *) hmsc->data, 1);
+            break;
+
+        case USB_REQ_SET_INTERFACE:
+            if (req->wValue != 0)
+            {
+                USBD_CtlError(pdev, req);
+            }
+            break;
+
+        case USB_REQ_CLEAR_FEATURE:
+            if (hmsc->State == MSC_STATE_ERROR)
+            {
+                /* The halts persist until the reset recovery */
+                USBD_LL_StallEP(pdev, MSC_EPIN_ADDR);
+                USBD_LL_StallEP(pdev, MSC_EPOUT_ADDR);
+            }
+            else if ((hmsc->State == MSC_STATE_STALLED) && (LOBYTE(req->wIndex) == MSC_EPIN_ADDR))
+            {
+                /* The failed command's status follows the halted data stage */
+                MSC_BOT_SendCSW(pdev, hmsc->Status);
+            }
+            break;
+        }
+        break;
+
+    default:
+        break;
+    }
+    return USBD_OK;
+}
+
+/**
+ * @brief  Data sent on non-control IN endpoint
+ * @param  pdev: device instance
+ * @param  epnum: endpoint number
+ * @retval status
+ */
+static uint8_t USBD_MSC_DataIn(USBD_HandleTypeDef *pdev, uint8_t epnum)
+{
+    USBD_MSC_HandleTypeDef *hmsc = MSC_HANDLE(pdev);
+
+    if ((hmsc == NULL) || ((epnum & 0x7F) != (MSC_EPIN_ADDR & 0x7F)))
+    {
+        return USBD_FAIL;
+    }
+
+    switch (hmsc->State)
+    {
+    case MSC_STATE_DATA_IN:
+        MSC_BOT_SendCSW(pdev, MSC_CSW_CMD_PASSED);
+        break;
+
+    case MSC_STATE_READ:
+        /* The sent buffer is free for the media again */
+        hmsc->Transferred   += hmsc->Pipe.Length[hmsc->Pipe.UsbIndex];
+        hmsc->Pipe.UsbIndex  = MSC_NEXT_BUFFER(hmsc->Pipe.UsbIndex);
+        hmsc->Pipe.Filled--;
+        hmsc->Pipe.UsbBusy   = 0;
+
+        if (hmsc->Transferred == hmsc->DataLength)
+        {
+            MSC_BOT_SendCSW(pdev, MSC_CSW_CMD_PASSED);
+        }
+        else
+        {
+            MSC_Pipe_UsbStart(pdev);
+            MSC_Pipe_MediaStart(pdev);
+        }
+        break;
+
+    case MSC_STATE_STATUS:
+        /* Wait for the next command */
+        hmsc->State = MSC_STATE_IDLE;
+        (void) USBD_LL_PrepareReceive(pdev, MSC_EPOUT_ADDR, (uint8_t *) hmsc->CBW, MSC_MAX_FS_PACKET);
+        break;
+
+    default:
+        break;
+    }
+
+    return USBD_OK;
+}
+
+/**
+ * @brief  Data received on non-control OUT endpoint
+ * @param  pdev: device instance
+ * @param  epnum: endpoint number
+ * @retval status
+ */
+static uint8_t USBD_MSC_DataOut(USBD_HandleTypeDef *pdev, uint8_t epnum)
+{
+    USBD_MSC_HandleTypeDef *hmsc = MSC_HANDLE(pdev);
+
+    if ((hmsc == NULL) || (epnum != MSC_EPOUT_ADDR))
+    {
+        return USBD_FAIL;
+    }
+
+    switch (hmsc->State)
+    {
+    case MSC_STATE_IDLE:
+        MSC_BOT_DecodeCBW(pdev);
+        break;
+
+    case MSC_STATE_WRITE:
+        /* The received buffer is ready to be stored */
+        hmsc->Pipe.Length[hmsc->Pipe.UsbIndex] = hmsc->Pipe.UsbLength;
+        hmsc->Transferred   += hmsc->Pipe.UsbLength;
+        hmsc->Pipe.UsbIndex  = MSC_NEXT_BUFFER(hmsc->Pipe.UsbIndex);
+        hmsc->Pipe.Filled++;
+        hmsc->Pipe.UsbBusy   = 0;
+
+        MSC_Pipe_UsbStart(pdev);
+        MSC_Pipe_MediaStart(pdev);
+        break;
+
+    default:
+        break;
+    }
+
+    return USBD_OK;
+}
+
+/**
+ * @brief  Start Of Frame event processing
+ * @param  pdev: device instance
+ * @retval status
+ */
+static uint8_t USBD_MSC_SOF(USBD_HandleTypeDef *pdev)
+{
+    USBD_MSC_HandleTypeDef *hmsc = MSC_HANDLE(pdev);
+
+    if ((hmsc != NULL) && (hmsc->Pipe.MediaRetry != 0))
+    {
+        /* Retry the media transfer which was refused as busy */
+        hmsc->Pipe.MediaRetry = 0;
+        MSC_Pipe_MediaStart(pdev);
+    }
+
+    return USBD_OK;
+}
+
+/**
+ * @brief  Returns the configuration descriptor
+ * @param  length: pointer to the data length
+ * @retval pointer to descriptor buffer
+ */
+static uint8_t *USBD_MSC_GetFSCfgDesc(uint16_t *length)
+{
+    *length = sizeof(USBD_MSC_CfgDesc);
+    return (uint8_t *) USBD_MSC_CfgDesc;
+}
+
+/**
+ * @brief  Returns the Device Qualifier descriptor
+ * @param  length: pointer to the data length
+ * @retval pointer to descriptor buffer
+ */
+static uint8_t *USBD_MSC_GetDeviceQualifierDescriptor(uint16_t *length)
+{
+    *length = sizeof(USBD_MSC_DeviceQualifierDesc);
+    return (uint8_t *) USBD_MSC_DeviceQualifierDesc;
+}
+
+/**
+ * @brief  Returns the transport to the command stage
+ * @param  pdev: device instance
+ */
+static void MSC_BOT_Reset(USBD_HandleTypeDef *pdev)
+{
+    USBD_MSC_HandleTypeDef *hmsc = MSC_HANDLE(pdev);
+
+    /* A media transfer in progress is completed without effect */
+    if (hmsc->Pipe.MediaBusy != 0)
+    {
+        hmsc->Pipe.MediaDrop = 1;
+    }
+    hmsc->Pipe.MediaBlocks = 0;
+    hmsc->Pipe.MediaRetry  = 0;
+    hmsc->Pipe.UsbBusy     = 0;
+    hmsc->State = MSC_STATE_IDLE;
+
+    USBD_LL_ClearStallEP(pdev, MSC_EPIN_ADDR);
+    USBD_LL_ClearStallEP(pdev, MSC_EPOUT_ADDR);
+
+    (void) USBD_LL_PrepareReceive(pdev, MSC_EPOUT_ADDR, (uint8_t *) hmsc->CBW, MSC_MAX_FS_PACKET);
+}
+
+/**
+ * @brief  Sends the command status wrapper
+ * @param  pdev: device instance
+ * @param  status: the command status
+ */
+static void MSC_BOT_SendCSW(USBD_HandleTypeDef *pdev, uint8_t status)
+{
+    USBD_MSC_HandleTypeDef *hmsc = MSC_HANDLE(pdev);
+    uint8_t *csw = (uint8_t *) hmsc->CSW;
+    uint32_t residue = hmsc->DataLength - hmsc->Transferred;
+
+    csw[0]  = (uint8_t) MSC_CSW_SIGNATURE;
+    csw[1]  = (uint8_t) (MSC_CSW_SIGNATURE >> 8);
+    csw[2]  = (uint8_t) (MSC_CSW_SIGNATURE >> 16);
+    csw[3]  = (uint8_t) (MSC_CSW_SIGNATURE >> 24);
+    csw[4]  = (uint8_t) hmsc->Tag;
+    csw[5]  = (uint8_t) (hmsc->Tag >> 8);
+    csw[6]  = (uint8_t) (hmsc->Tag >> 16);
+    csw[7]  = (uint8_t) (hmsc->Tag >> 24);
+    csw[8]  = (uint8_t) residue;
+    csw[9]  = (uint8_t) (residue >> 8);
+    csw[10] = (uint8_t) (residue >> 16);
+    csw[11] = (uint8_t) (residue >> 24);
+    csw[12] = status;
+
+    hmsc->State = MSC_STATE_STATUS;
+    (void) USBD_LL_Transmit(pdev, MSC_EPIN_ADDR, csw, MSC_CSW_LENGTH);
+}
+
+/**
+ * @brief  Fails the current command: the remaining data stage is halted,
+ *         and the failed status is reported
+ * @param  pdev: device instance
+ * @param  key: the SCSI sense key
+ * @param  asc: the SCSI additional sense code
+ */
+static void MSC_BOT_Fail(USBD_HandleTypeDef *pdev, uint8_t key, uint8_t asc)
+{
+    USBD_MSC_HandleTypeDef *hmsc = MSC_HANDLE(pdev);
+
+    hmsc->SenseKey = key;
+    hmsc->SenseASC = asc;
+    hmsc->Status   = MSC_CSW_CMD_FAILED;
+
+    /* Stop the pipeline */
+    if (hmsc->Pipe.MediaBusy != 0)
+    {
+        hmsc->Pipe.MediaDrop = 1;
+    }
+    hmsc->Pipe.MediaBlocks = 0;
+    hmsc->Pipe.MediaRetry  = 0;
+    hmsc->Pipe.UsbBusy     = 0;
+
+    if (hmsc->Transferred == hmsc->DataLength)
+    {
+        MSC_BOT_SendCSW(pdev, MSC_CSW_CMD_FAILED);
+    }
+    else
+    {
+        /* The CSW is sent when the host clears the IN halt */
+        if ((hmsc->Flags & MSC_CBW_FLAGS_IN) == 0)
+        {
+            USBD_LL_StallEP(pdev, MSC_EPOUT_ADDR);
+        }
+        USBD_LL_StallEP(pdev, MSC_EPIN_ADDR);
+        hmsc->State = MSC_STATE_STALLED;
+    }
+}
+
+/**
+ * @brief  Sends a short command response
+ * @param  pdev: device instance
+ * @param  data: the response data
+ * @param  length: the length of the response
+ */
+static void MSC_BOT_SendData(USBD_HandleTypeDef *pdev, const uint8_t *data, uint32_t length)
+{
+    USBD_MSC_HandleTypeDef *hmsc = MSC_HANDLE(pdev);
+
+    /* The response is truncated to the host's allocation */
+    if (length > hmsc->DataLength)
+    {
+        length = hmsc->DataLength;
+    }
+
+    if ((length == 0) || ((hmsc->Flags & MSC_CBW_FLAGS_IN) == 0))
+    {
+        MSC_BOT_SendCSW(pdev, MSC_CSW_CMD_PASSED);
+    }
+    else
+    {
+        if (data != (uint8_t *) hmsc->data)
+        {
+            memcpy(hmsc->data, data, length);
+        }
+        hmsc->Transferred = length;
+        hmsc->State = MSC_STATE_DATA_IN;
+        (void) USBD_LL_Transmit(pdev, MSC_EPIN_ADDR, (uint8_t *) hmsc->data, length);
+    }
+}
+
+/**
+ * @brief  Updates the capacity of the command's LUN
+ * @param  pdev: device instance
+ * @retval 0 if the media is ready, the sense key otherwise
+ */
+static uint8_t MSC_SCSI_CheckMedia(USBD_HandleTypeDef *pdev)
+{
+    USBD_MSC_HandleTypeDef *hmsc = MSC_HANDLE(pdev);
+    USBD_MSC_ItfTypeDef *itf     = MSC_ITF(pdev);
+    uint8_t lun = hmsc->Lun;
+
+    if ((itf->IsReady(lun) != MSC_MEDIA_OK) ||
+        (itf->GetCapacity(lun, &hmsc->BlockCount[lun], &hmsc->BlockSize[lun]) != MSC_MEDIA_OK) ||
+        (hmsc->BlockSize[lun] == 0) || (hmsc->BlockSize[lun] > MSC_BUFFER_SIZE))
+    {
+        return SCSI_SENSE_NOT_READY;
+    }
+    return SCSI_SENSE_NO_SENSE;
+}
+
+/**
+ * @brief  Starts the READ(10) or WRITE(10) data transfer pipeline
+ * @param  pdev: device instance
+ * @param  cb: the command block
+ * @param  write: set for WRITE(10)
+ */
+static void MSC_SCSI_ReadWrite(USBD_HandleTypeDef *pdev, const uint8_t *cb, uint8_t write)
+{
+    USBD_MSC_HandleTypeDef *hmsc = MSC_HANDLE(pdev);
+    uint32_t addr   = ((uint32_t)cb[2] << 24) | ((uint32_t)cb[3] << 16) | ((uint32_t)cb[4] << 8) | cb[5];
+    uint32_t blocks = ((uint32_t)cb[7] << 8) | cb[8];
+    uint8_t lun = hmsc->Lun;
+
+    if (MSC_SCSI_CheckMedia(pdev) != SCSI_SENSE_NO_SENSE)
+    {
+        MSC_BOT_Fail(pdev, SCSI_SENSE_NOT_READY, SCSI_ASC_MEDIUM_NOT_PRESENT);
+    }
+    else if ((write != 0) && (MSC_ITF(pdev)->IsWriteProtected(lun) != MSC_MEDIA_OK))
+    {
+        MSC_BOT_Fail(pdev, SCSI_SENSE_DATA_PROTECT, SCSI_ASC_WRITE_PROTECTED);
+    }
+    else if ((addr + blocks) > hmsc->BlockCount[lun])
+    {
+        MSC_BOT_Fail(pdev, SCSI_SENSE_ILLEGAL_REQUEST, SCSI_ASC_ADDRESS_OUT_OF_RANGE);
+    }
+    else if ((hmsc->DataLength != (blocks * hmsc->BlockSize[lun])) ||
+             (((hmsc->Flags & MSC_CBW_FLAGS_IN) != 0) == (write != 0)))
+    {
+        /* The host's expectation doesn't match the command */
+        MSC_BOT_Fail(pdev, SCSI_SENSE_ILLEGAL_REQUEST, SCSI_ASC_INVALID_FIELD_IN_CDB);
+    }
+    else if (blocks == 0)
+    {
+        MSC_BOT_SendCSW(pdev, MSC_CSW_CMD_PASSED);
+    }
+    else
+    {
+        hmsc->Pipe.MediaAddr   = addr;
+        hmsc->Pipe.MediaBlocks = blocks;
+        hmsc->Pipe.UsbBytes    = hmsc->DataLength;
+        hmsc->Pipe.MediaIndex  = 0;
+        hmsc->Pipe.UsbIndex    = 0;
+        hmsc->Pipe.Filled      = 0;
+        hmsc->Pipe.UsbBusy     = 0;
+
+        /* Reads start on the media, writes start on USB */
+        if (write != 0)
+        {
+            hmsc->State = MSC_STATE_WRITE;
+            MSC_Pipe_UsbStart(pdev);
+        }
+        else
+        {
+            hmsc->State = MSC_STATE_READ;
+            MSC_Pipe_MediaStart(pdev);
+        }
+    }
+}
+
+/**
+ * @brief  Processes the SCSI command of the CBW
+ * @param  pdev: device instance
+ * @param  cb: the command block
+ */
+static void MSC_SCSI_ProcessCmd(USBD_HandleTypeDef *pdev, const uint8_t *cb)
+{
+    USBD_MSC_HandleTypeDef *hmsc = MSC_HANDLE(pdev);
+    USBD_MSC_ItfTypeDef *itf     = MSC_ITF(pdev);
+    uint8_t *data = (uint8_t *) hmsc->data;
+    uint8_t lun   = hmsc->Lun;
+
+    switch (cb[0])
+    {
+    case SCSI_TEST_UNIT_READY:
+        if (itf->IsReady(lun) != MSC_MEDIA_OK)
+        {
+            MSC_BOT_Fail(pdev, SCSI_SENSE_NOT_READY, SCSI_ASC_MEDIUM_NOT_PRESENT);
+        }
+        else
+        {
+            MSC_BOT_SendData(pdev, data, 0);
+        }
+        break;
+
+    case SCSI_REQUEST_SENSE:
+        memset(data, 0, 18);
+        data[0]  = 0x70;                    /* Current errors */
+        data[2]  = hmsc->SenseKey;
+        data[7]  = 18 - 8;                  /* Additional sense length */
+        data[12] = hmsc->SenseASC;
+
+        /* The sense data is reported once */
+        hmsc->SenseKey = SCSI_SENSE_NO_SENSE;
+        hmsc->SenseASC = 0;
+
+        MSC_BOT_SendData(pdev, data, (cb[4] < 18) ? cb[4] : 18);
+        break;
+
+    case SCSI_INQUIRY:
+        if ((cb[1] & 0x01) != 0)
+        {
+            /* Vital product data pages are not supported */
+            MSC_BOT_Fail(pdev, SCSI_SENSE_ILLEGAL_REQUEST, SCSI_ASC_INVALID_FIELD_IN_CDB);
+        }
+        else
+        {
+            uint16_t length = ((uint16_t)cb[3] << 8) | cb[4];
+
+            if (length > MSC_INQUIRY_DATA_LEN)
+            {
+                length = MSC_INQUIRY_DATA_LEN;
+            }
+            MSC_BOT_SendData(pdev, &itf->Inquiry[lun * MSC_INQUIRY_DATA_LEN], length);
+        }
+        break;
+
+    case SCSI_MODE_SENSE6:
+        data[0] = 0x03;                     /* Mode data length */
+        data[1] = 0x00;                     /* Medium type */
+        data[2] = (itf->IsWriteProtected(lun) != MSC_MEDIA_OK) ? 0x80 : 0x00;
+        data[3] = 0x00;                     /* Block descriptor length */
+        MSC_BOT_SendData(pdev, data, (cb[4] < 4) ? cb[4] : 4);
+        break;
+
+    case SCSI_MODE_SENSE10:
+        memset(data, 0, 8);
+        data[1] = 0x06;                     /* Mode data length */
+        data[3] = (itf->IsWriteProtected(lun) != MSC_MEDIA_OK) ? 0x80 : 0x00;
+        MSC_BOT_SendData(pdev, data, (((cb[7] << 8) | cb[8]) < 8) ? ((cb[7] << 8) | cb[8]) : 8);
+        break;
+
+    case SCSI_START_STOP_UNIT:
+    case SCSI_ALLOW_MEDIUM_REMOVAL:
+    case SCSI_VERIFY10:
+        MSC_BOT_SendData(pdev, data, 0);
+        break;
+
+    case SCSI_READ_FORMAT_CAPACITIES:
+    case SCSI_READ_CAPACITY10:
+        if (MSC_SCSI_CheckMedia(pdev) != SCSI_SENSE_NO_SENSE)
+        {
+            MSC_BOT_Fail(pdev, SCSI_SENSE_NOT_READY, SCSI_ASC_MEDIUM_NOT_PRESENT);
+        }
+        else
+        {
+            uint32_t count = hmsc->BlockCount[lun];
+            uint16_t size  = hmsc->BlockSize[lun];
+            uint32_t length;
+
+            if (cb[0] == SCSI_READ_CAPACITY10)
+            {
+                /* Last block address and block size */
+                count--;
+                data[0] = (uint8_t) (count >> 24);
+                data[1] = (uint8_t) (count >> 16);
+                data[2] = (uint8_t) (count >> 8);
+                data[3] = (uint8_t) count;
+                data[4] = 0;
+                data[5] = 0;
+                data[6] = (uint8_t) (size >> 8);
+                data[7] = (uint8_t) size;
+                length  = 8;
+            }
+            else
+            {
+                /* Capacity list with the current formatted capacity descriptor */
+                data[0]  = 0;
+                data[1]  = 0;
+                data[2]  = 0;
+                data[3]  = 0x08;
+                data[4]  = (uint8_t) (count >> 24);
+                data[5]  = (uint8_t) (count >> 16);
+                data[6]  = (uint8_t) (count >> 8);
+                data[7]  = (uint8_t) count;
+                data[8]  = 0x02;
+                data[9]  = 0;
+                data[10] = (uint8_t) (size >> 8);
+                data[11] = (uint8_t) size;
+                length   = (((cb[7] << 8) | cb[8]) < 12) ? ((cb[7] << 8) | cb[8]) : 12;
+            }
+            MSC_BOT_SendData(pdev, data, length);
+        }
+        break;
+
+    case SCSI_READ10:
+        MSC_SCSI_ReadWrite(pdev, cb, 0);
+        break;
+
+    case SCSI_WRITE10:
+        MSC_SCSI_ReadWrite(pdev, cb, 1);
+        break;
+
+    default:
+        MSC_BOT_Fail(pdev, SCSI_SENSE_ILLEGAL_REQUEST, SCSI_ASC_INVALID_COMMAND);
+        break;
+    }
+}
+
+/**
+ * @brief  Validates the received CBW and processes its command
+ * @param  pdev: device instance
+ */
+static void MSC_BOT_DecodeCBW(USBD_HandleTypeDef *pdev)
+{
+    USBD_MSC_HandleTypeDef *hmsc = MSC_HANDLE(pdev);
+    const uint8_t *cbw = (const uint8_t *) hmsc->CBW;
+    uint32_t signature = ((uint32_t)cbw[3] << 24) | ((uint32_t)cbw[2] << 16)
+                       | ((uint32_t)cbw[1] << 8) | cbw[0];
+
+    hmsc->Tag = ((uint32_t)cbw[MSC_CBW_TAG + 3] << 24) | ((uint32_t)cbw[MSC_CBW_TAG + 2] << 16)
+              | ((uint32_t)cbw[MSC_CBW_TAG + 1] << 8) | cbw[MSC_CBW_TAG];
+    hmsc->DataLength = ((uint32_t)cbw[MSC_CBW_DATA_LENGTH + 3] << 24)
+                     | ((uint32_t)cbw[MSC_CBW_DATA_LENGTH + 2] << 16)
+                     | ((uint32_t)cbw[MSC_CBW_DATA_LENGTH + 1] << 8) | cbw[MSC_CBW_DATA_LENGTH];
+    hmsc->Flags       = cbw[MSC_CBW_FLAGS];
+    hmsc->Lun         = cbw[MSC_CBW_LUN] & 0x0F;
+    hmsc->Transferred = 0;
+    hmsc->Status      = MSC_CSW_CMD_PASSED;
+
+    if ((USBD_LL_GetRxDataSize(pdev, MSC_EPOUT_ADDR) != MSC_CBW_LENGTH) ||
+        (signature != MSC_CBW_SIGNATURE) || (hmsc->Lun >= MSC_MAX_LUN) ||
+        (cbw[MSC_CBW_CB_LENGTH] < 1) || (cbw[MSC_CBW_CB_LENGTH] > 16))
+    {
+        /* Invalid CBW: halt both endpoints until the reset recovery */
+        USBD_LL_StallEP(pdev, MSC_EPIN_ADDR);
+        USBD_LL_StallEP(pdev, MSC_EPOUT_ADDR);
+        hmsc->State = MSC_STATE_ERROR;
+    }
+    else
+    {
+        MSC_SCSI_ProcessCmd(pdev, &cbw[MSC_CBW_CB]);
+    }
+}
+
+/**
+ * @brief  Starts the next media transfer of the pipeline if its buffer is available
+ * @param  pdev: device instance
+ */
+static void MSC_Pipe_MediaStart(USBD_HandleTypeDef *pdev)
+{
+    USBD_MSC_HandleTypeDef *hmsc = MSC_HANDLE(pdev);
+    USBD_MSC_ItfTypeDef *itf     = MSC_ITF(pdev);
+    uint16_t size = hmsc->BlockSize[hmsc->Lun];
+    uint8_t *buf  = MSC_BUFFER(hmsc, hmsc->Pipe.MediaIndex);
+    uint32_t addr = hmsc->Pipe.MediaAddr;
+    uint16_t blocks;
+    int8_t ret;
+
+    if ((hmsc->Pipe.MediaBusy != 0) || (hmsc->Pipe.MediaBlocks == 0))
+    {
+        return;
+    }
+
+    if (hmsc->State == MSC_STATE_READ)
+    {
+        /* A free buffer is filled from the media */
+        if (hmsc->Pipe.Filled >= MSC_BUFFER_COUNT)
+        {
+            return;
+        }
+        blocks = MSC_BUFFER_SIZE / size;
+        if (blocks > hmsc->Pipe.MediaBlocks)
+        {
+            blocks = (uint16_t) hmsc->Pipe.MediaBlocks;
+        }
+    }
+    else
+    {
+        /* The oldest received buffer is stored to the media */
+        if (hmsc->Pipe.Filled == 0)
+        {
+            return;
+        }
+        blocks = hmsc->Pipe.Length[hmsc->Pipe.MediaIndex] / size;
+    }
+
+    /* The pipeline is advanced before the call, as the completion may be signalled within */
+    hmsc->Pipe.MediaCount   = blocks;
+    hmsc->Pipe.MediaAddr   += blocks;
+    hmsc->Pipe.MediaBlocks -= blocks;
+    hmsc->Pipe.MediaBusy    = 1;
+
+    if (hmsc->State == MSC_STATE_READ)
+    {
+        ret = itf->Read(hmsc->Lun, buf, addr, blocks);
+    }
+    else
+    {
+        ret = itf->Write(hmsc->Lun, buf, addr, blocks);
+    }
+
+    if (ret == MSC_MEDIA_BUSY)
+    {
+        hmsc->Pipe.MediaAddr   -= blocks;
+        hmsc->Pipe.MediaBlocks += blocks;
+        hmsc->Pipe.MediaBusy    = 0;
+        hmsc->Pipe.MediaRetry   = 1;
+    }
+    else if (ret != MSC_MEDIA_OK)
+    {
+        hmsc->Pipe.MediaBusy = 0;
+        MSC_BOT_Fail(pdev, SCSI_SENSE_MEDIUM_ERROR, (hmsc->State == MSC_STATE_READ) ?
+                SCSI_ASC_UNRECOVERED_READ_ERROR : SCSI_ASC_WRITE_FAULT);
+    }
+}
+
+/**
+ * @brief  Starts the next USB transfer of the pipeline if its buffer is available
+ * @param  pdev: device instance
+ */
+static void MSC_Pipe_UsbStart(USBD_HandleTypeDef *pdev)
+{
+    USBD_MSC_HandleTypeDef *hmsc = MSC_HANDLE(pdev);
+    uint8_t *buf = MSC_BUFFER(hmsc, hmsc->Pipe.UsbIndex);
+
+    if (hmsc->Pipe.UsbBusy != 0)
+    {
+        return;
+    }
+
+    if (hmsc->State == MSC_STATE_READ)
+    {
+        /* The oldest filled buffer is sent to the host */
+        if (hmsc->Pipe.Filled > 0)
+        {
+            hmsc->Pipe.UsbBusy = 1;
+            (void) USBD_LL_Transmit(pdev, MSC_EPIN_ADDR, buf, hmsc->Pipe.Length[hmsc->Pipe.UsbIndex]);
+        }
+    }
+    else if ((hmsc->Pipe.UsbBytes > 0) && (hmsc->Pipe.Filled < MSC_BUFFER_COUNT))
+    {
+        /* A free buffer receives the next blocks from the host */
+        uint16_t size = hmsc->BlockSize[hmsc->Lun];
+        uint32_t length = (MSC_BUFFER_SIZE / size) * size;
+
+        if (length > hmsc->Pipe.UsbBytes)
+        {
+            length = hmsc->Pipe.UsbBytes;
+        }
+        hmsc->Pipe.UsbLength = (uint16_t) length;
+        hmsc->Pipe.UsbBytes -= length;
+        hmsc->Pipe.UsbBusy   = 1;
+        (void) USBD_LL_PrepareReceive(pdev, MSC_EPOUT_ADDR, buf, length);
+    }
+}
+
+/** @} */
+
+/** @defgroup USBD_MSC_Exported_Functions
+ * @{ */
+
+/**
+ * @brief  Sets the MSC user interface to the handler
+ * @param  pdev: device instance
+ * @param  fops: MSC Interface callbacks
+ * @retval status
+ */
+uint8_t USBD_MSC_RegisterInterface(USBD_HandleTypeDef *pdev, const USBD_MSC_ItfTypeDef *fops)
+{
+    uint8_t ret = USBD_FAIL;
+
+    if (fops != NULL)
+    {
+        pdev->pUserData = (void *) fops;
+        ret = USBD_OK;
+    }
+
+    return ret;
+}
+
+/**
+ * @brief  Signals the end of the media transfer started by the interface's Read or Write.
+ *         The pipeline continues with the next buffers, or the command's status is sent.
+ * @param  pdev: device instance
+ * @param  status: MSC_MEDIA_OK if the transfer was successful, MSC_MEDIA_FAIL otherwise
+ */
+void USBD_MSC_MediaComplete(USBD_HandleTypeDef *pdev, int8_t status)
+{
+    USBD_MSC_HandleTypeDef *hmsc = MSC_HANDLE(pdev);
+
+    if ((hmsc == NULL) || (hmsc->Pipe.MediaBusy == 0))
+    {
+        return;
+    }
+    hmsc->Pipe.MediaBusy = 0;
+
+    if (hmsc->Pipe.MediaDrop != 0)
+    {
+        /* The transfer belonged to an aborted command, a new one may be waiting for the media */
+        hmsc->Pipe.MediaDrop = 0;
+        if ((hmsc->State == MSC_STATE_READ) || (hmsc->State == MSC_STATE_WRITE))
+        {
+            MSC_Pipe_MediaStart(pdev);
+        }
+    }
+    else if (status != MSC_MEDIA_OK)
+    {
+        MSC_BOT_Fail(pdev, SCSI_SENSE_MEDIUM_ERROR, (hmsc->State == MSC_STATE_READ) ?
+                SCSI_ASC_UNRECOVERED_READ_ERROR : SCSI_ASC_WRITE_FAULT);
+    }
+    else if (hmsc->State == MSC_STATE_READ)
+    {
+        /* The filled buffer is queued for the host */
+        hmsc->Pipe.Length[hmsc->Pipe.MediaIndex] = hmsc->Pipe.MediaCount * hmsc->BlockSize[hmsc->Lun];
+        hmsc->Pipe.MediaIndex = MSC_NEXT_BUFFER(hmsc->Pipe.MediaIndex);
+        hmsc->Pipe.Filled++;
+
+        MSC_Pipe_UsbStart(pdev);
+        MSC_Pipe_MediaStart(pdev);
+    }
+    else if (hmsc->State == MSC_STATE_WRITE)
+    {
+        /* The stored buffer is free for the host again */
+        hmsc->Pipe.MediaIndex = MSC_NEXT_BUFFER(hmsc->Pipe.MediaIndex);
+        hmsc->Pipe.Filled--;
+
+        if ((hmsc->Pipe.MediaBlocks == 0) && (hmsc->Pipe.Filled == 0))
+        {
+            /* All data is stored, the status can be reported */
+            MSC_BOT_SendCSW(pdev, MSC_CSW_CMD_PASSED);
+        }
+        else
+        {
+            MSC_Pipe_UsbStart(pdev);
+            MSC_Pipe_MediaStart(pdev);
+        }
+    }
+}
+
+/** @} */
+
+/** @} */
+
+/** @} */
@@ -0,0 +1,246 @@
+/**
+ ******************************************************************************
+ * @file    usbd_ncm.h
+ * @author  Benedek Kupper
+ * @version V0.1
+ * @date    2018-01-20
+ * @brief   header file for the usbd_ncm.c file.
+ ******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; COPYRIGHT 2015 STMicroelectronics</center></h2>
+ *
+ * Licensed under MCD-ST Liberty SW License Agreement V2, (the "License");
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *        http://www.st.com/software_license_agreement_liberty_v2
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************************
+ */
+#ifndef __USB_NCM_H
+#define __USB_NCM_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include  "usbd_ioreq.h"
+
+/** @addtogroup STM32_USB_DEVICE_LIBRARY
+ * @{
+ */
+
+/** @defgroup usbd_ncm
+ * @brief This file is the Header file for usbd_ncm.c
+ * @{
+ */
+
+/** @defgroup usbd_ncm_Exported_Defines
+ * @{
+ */
+#define NCM_IN_EP                                   0x81  /* EP1 for NTB IN */
+#define NCM_OUT_EP                                  0x01  /* EP1 for NTB OUT */
+#define NCM_NOTIFY_EP                               0x82  /* EP2 for notifications */
+
+#define NCM_DATA_HS_MAX_PACKET_SIZE                 512   /* Bulk endpoint packet size */
+#define NCM_DATA_FS_MAX_PACKET_SIZE                 64    /* Bulk endpoint packet size */
+#define NCM_NOTIFY_PACKET_SIZE                      16    /* Notification endpoint packet size */
+#ifndef NCM_NOTIFY_FS_BINTERVAL
+#define NCM_NOTIFY_FS_BINTERVAL                     0x10  /* Notification interval at full speed (16 ms) */
+#endif
+#ifndef NCM_NOTIFY_HS_BINTERVAL
+#define NCM_NOTIFY_HS_BINTERVAL                     0x09  /* Notification interval at high speed (32 ms) */
+#endif
+
+/* String descriptor index of the host side MAC address */
+#ifndef NCM_MAC_STRING_INDEX
+#define NCM_MAC_STRING_INDEX                        0x06
+#endif
+
+/* NTB transfer parameters: the OUT NTBs are received to a pool of NCM_OUT_NTB_COUNT buffers,
+ * the IN datagrams are aggregated to one NTB while the previous one is transmitted. */
+#ifndef NCM_NTB_OUT_MAX_SIZE
+#define NCM_NTB_OUT_MAX_SIZE                        2048  /* dwNtbOutMaxSize (multiple of packet size) */
+#endif
+#ifndef NCM_OUT_NTB_COUNT
+#define NCM_OUT_NTB_COUNT                           2     /* Number of OUT pool NTB buffers */
+#endif
+#ifndef NCM_NTB_IN_MAX_SIZE
+#define NCM_NTB_IN_MAX_SIZE                         2048  /* dwNtbInMaxSize */
+#endif
+#ifndef NCM_MAX_IN_DATAGRAMS
+#define NCM_MAX_IN_DATAGRAMS                        8     /* Largest number of datagrams in an IN NTB */
+#endif
+
+#define NCM_MAX_SEGMENT_SIZE                        1514  /* Ethernet frame size without FCS */
+
+#define USB_NCM_CONFIG_DESC_SIZ                     94
+
+/*---------------------------------------------------------------------*/
+/*  NCM definitions                                                    */
+/*---------------------------------------------------------------------*/
+#define NCM_SET_ETHERNET_PACKET_FILTER              0x43
+#define NCM_GET_NTB_PARAMETERS                      0x80
+#define NCM_GET_NTB_FORMAT                          0x83
+#define NCM_SET_NTB_FORMAT                          0x84
+#define NCM_GET_NTB_INPUT_SIZE                      0x85
+#define NCM_SET_NTB_INPUT_SIZE                      0x86
+
+#define NCM_NOTIFY_NETWORK_CONNECTION               0x00
+#define NCM_NOTIFY_CONNECTION_SPEED_CHANGE          0x2A
+
+#define NCM_NTH16_SIGNATURE                         0x484D434E  /* "NCMH" */
+#define NCM_NDP16_SIGNATURE                         0x304D434E  /* "NCM0" */
+#define NCM_NTH16_LENGTH                            12
+#define NCM_NDP16_ALIGNMENT                         4
+
+/**
+ * @}
+ */
+
+/** @defgroup USBD_CORE_Exported_TypesDefinitions
+ * @{
+ */
+
+/* NTB parameter structure of the GET_NTB_PARAMETERS request */
+typedef struct
+{
+    uint16_t wLength;
+    uint16_t bmNtbFormatsSupported;
+    uint32_t dwNtbInMaxSize;
+    uint16_t wNdpInDivisor;
+    uint16_t wNdpInPayloadRemainder;
+    uint16_t wNdpInAlignment;
+    uint16_t wReserved;
+    uint32_t dwNtbOutMaxSize;
+    uint16_t wNdpOutDivisor;
+    uint16_t wNdpOutPayloadRemainder;
+    uint16_t wNdpOutAlignment;
+    uint16_t wNtbOutMaxDatagrams;
+} __packed USB_NCM_NtbParametersType;
+
+/* 16 bit NCM transfer header */
+typedef struct
+{
+    uint32_t dwSignature;           /*!< NCM_NTH16_SIGNATURE */
+    uint16_t wHeaderLength;         /*!< NCM_NTH16_LENGTH */
+    uint16_t wSequence;
+    uint16_t wBlockLength;          /*!< Size of the NTB */
+    uint16_t wNdpIndex;             /*!< Offset of the first NDP */
+} USB_NCM_NTH16Type;
+
+/* 16 bit NCM datagram pointer table */
+typedef struct
+{
+    uint32_t dwSignature;           /*!< NCM_NDP16_SIGNATURE */
+    uint16_t wLength;               /*!< Size of the NDP */
+    uint16_t wNextNdpIndex;         /*!< Offset of the next NDP, or 0 */
+    struct {
+        uint16_t wDatagramIndex;
+        uint16_t wDatagramLength;
+    } Datagram[];                   /*!< Datagram pointers, terminated by a null entry */
+} USB_NCM_NDP16Type;
+
+/* Network interface of the application. The NTBs received from the host signal Received,
+ * the transmitted IN NTBs signal Transmitted, and LinkState is called
+ * when the host (de)activates the data interface. */
+typedef struct _USBD_NCM_Itf
+{
+    uint8_t MACAddress[6];                  /* MAC address of the host side interface */
+    void (*Init)(void);
+    void (*DeInit)(void);
+    void (*LinkState)(uint8_t up);
+    void (*Received)(void);
+    void (*Transmitted)(void);
+} USBD_NCM_ItfTypeDef;
+
+typedef struct
+{
+    uint32_t Out[NCM_OUT_NTB_COUNT][NCM_NTB_OUT_MAX_SIZE / 4]; /* Force 32bits alignment */
+    uint32_t In[2][(NCM_NTB_IN_MAX_SIZE + 3) / 4]; /* Force 32bits alignment */
+    uint32_t data[USB_MAX_EP0_SIZE / 4];    /* Control request data */
+    uint32_t Notify[NCM_NOTIFY_PACKET_SIZE / 4]; /* Notification message */
+    struct {
+        uint16_t Index;
+        uint16_t Length;
+    } InDatagram[NCM_MAX_IN_DATAGRAMS];     /* Datagram pointers of the filling IN NTB */
+    uint32_t NtbInSize;                     /* IN NTB size selected by the host */
+    uint16_t OutLength[NCM_OUT_NTB_COUNT];  /* Received length of filled NTBs */
+    volatile uint8_t OutHead;               /* Index of the receiving NTB */
+    volatile uint8_t OutTail;               /* Index of the oldest filled NTB */
+    volatile uint8_t OutHeld;               /* Reception is held as all NTBs are filled */
+    uint16_t OutBlock;                      /* Block length of the parsed NTB */
+    uint16_t OutNdp;                        /* Offset of the parsed NDP */
+    uint16_t OutNdpEnd;                     /* End offset of the parsed NDP */
+    uint16_t OutEntry;                      /* Offset of the current datagram pointer, 0 if not parsed */
+    volatile uint16_t InLength;             /* Filled length of the filling IN NTB */
+    uint16_t InSequence;                    /* Sequence number of the next IN NTB */
+    uint16_t PacketSize;                    /* Bulk endpoint packet size */
+    uint8_t  InCount;                       /* Number of datagrams in the filling IN NTB */
+    uint8_t  InIndex;                       /* Index of the filling IN NTB */
+    volatile uint8_t InWriting;             /* The application is writing a datagram */
+    volatile uint8_t InBusy;                /* The endpoint is transmitting the other IN NTB */
+    uint8_t  NotifyState;                   /* Pending notifications */
+    uint8_t  NotifyBusy;                    /* The notification endpoint is transmitting */
+    uint8_t  AltSetting;                    /* Alternate setting of the data interface */
+    uint8_t  CmdOpCode;
+} USBD_NCM_HandleTypeDef;
+
+/**
+ * @}
+ */
+
+/** @defgroup USBD_CORE_Exported_Variables
+ * @{
+ */
+
+extern const USBD_ClassTypeDef USBD_NCM;
+#define USBD_NCM_CLASS    &USBD_NCM
+
+/**
+ * @}
+ */
+
+/** @defgroup USB_CORE_Exported_Functions
+ * @{
+ */
+
+uint8_t USBD_NCM_RegisterInterface(USBD_HandleTypeDef *pdev,
+        const USBD_NCM_ItfTypeDef *fops);
+
+uint8_t *USBD_NCM_GetRxDatagram(USBD_HandleTypeDef *pdev, uint16_t *length);
+
+uint8_t USBD_NCM_ReleaseRxDatagram(USBD_HandleTypeDef *pdev);
+
+uint8_t *USBD_NCM_GetTxDatagram(USBD_HandleTypeDef *pdev, uint16_t length);
+
+uint8_t USBD_NCM_SendTxDatagram(USBD_HandleTypeDef *pdev, uint16_t length);
+
+/**
+ * @}
+ */
+
+/**
+ * @}
+ */
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* __USB_NCM_H */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -0,0 +1,1089 @@
+/**
+ ******************************************************************************
+ * @file    usbd_ncm.c
+ * @author  Benedek Kupper
+ * @version V0.1
+ * @date    2018-01-20
+ * @brief   This file provides the high layer firmware functions to manage the
+ *          following functionalities of the USB CDC-NCM Class:
+ *           - Initialization and Configuration of high and low layer
+ *           - Enumeration as Network Control Model device (IAD)
+ *           - NTB aggregation of IN datagrams and parsing of OUT NTBs
+ *           - Network connection notifications
+ *
+ *  @verbatim
+ *
+ *          ===================================================================
+ *                              CDC-NCM Class Driver Description
+ *          ===================================================================
+ *           This driver implements an Ethernet-over-USB network interface
+ *           according to the "Universal Serial Bus Communications Class Subclass
+ *           Specification for Network Control Model Devices" Revision 1.0.
+ *           This driver implements the following aspects:
+ *             - Communication interface with the Ethernet Networking and NCM
+ *               functional descriptors, and interrupt IN notification endpoint
+ *             - Data interface with alternate setting 1 for the bulk endpoints
+ *             - NTB16 format with the host configurable IN NTB size
+ *             - Host side MAC address string descriptor (requires
+ *               USBD_SUPPORT_USER_STRING)
+ *
+ *           The OUT NTBs are received to a pool of NCM_OUT_NTB_COUNT buffers,
+ *           the datagrams are provided in place by @ref USBD_NCM_GetRxDatagram,
+ *           and the NTB returns to the pool once all its datagrams are released.
+ *           The IN datagrams are written in place to the filling NTB between
+ *           @ref USBD_NCM_GetTxDatagram and @ref USBD_NCM_SendTxDatagram.
+ *           An idle endpoint transmits the datagram immediately, otherwise
+ *           the datagrams are aggregated until the previous NTB is transmitted.
+ *
+ *  @endverbatim
+ *
+ ******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; COPYRIGHT 2015 STMicroelectronics</center></h2>
+ *
+ * Licensed under MCD-ST Liberty SW License Agreement V2, (the "License");
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *        http://www.st.com/software_license_agreement_liberty_v2
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************************
+ */
+
+#include "usbd_ncm.h"
+#include "usbd_ctlreq.h"
+
+/** @addtogroup STM32_USB_DEVICE_LIBRARY
+ * @{ */
+
+/** @defgroup USBD_NCM
+ * @brief USB CDC-NCM Class module
+ * @{ */
+
+#if (USBD_SUPPORT_USER_STRING != 1)
+#error "The NCM class requires USBD_SUPPORT_USER_STRING for the MAC address string."
+#endif
+
+#if ((NCM_NTB_OUT_MAX_SIZE > 0xFFFF) || (NCM_NTB_IN_MAX_SIZE > 0xFFFF))
+#error "The NTB16 format limits the NTB sizes to 64 kB."
+#endif
+
+static uint8_t USBD_NCM_Init(USBD_HandleTypeDef *pdev, uint8_t cfgidx);
+
+static uint8_t USBD_NCM_DeInit(USBD_HandleTypeDef *pdev, uint8_t cfgidx);
+
+static uint8_t USBD_NCM_Setup(USBD_HandleTypeDef *pdev, USBD_SetupReqTypedef *req);
+
+static uint8_t USBD_NCM_DataIn(USBD_HandleTypeDef *pdev, uint8_t epnum);
+
+static uint8_t USBD_NCM_DataOut(USBD_HandleTypeDef *pdev, uint8_t epnum);
+
+static uint8_t USBD_NCM_EP0_RxReady(USBD_HandleTypeDef *pdev);
+
+static uint8_t *USBD_NCM_GetFSCfgDesc(uint16_t *length);
+
+#ifdef DEVICE_HS
+static uint8_t *USBD_NCM_GetHSCfgDesc(uint16_t *length);
+#endif
+
+static uint8_t *USBD_NCM_GetDeviceQualifierDescriptor(uint16_t *length);
+
+static uint8_t *USBD_NCM_GetUsrStrDescriptor(USBD_HandleTypeDef *pdev, uint8_t index, uint16_t *length);
+
+static void USBD_NCM_SetAltSetting(USBD_HandleTypeDef *pdev, uint8_t alt);
+
+static void USBD_NCM_Notify(USBD_HandleTypeDef *pdev);
+
+static void USBD_NCM_PoolReceive(USBD_HandleTypeDef *pdev);
+
+static uint8_t *USBD_NCM_RxSeek(USBD_HandleTypeDef *pdev, uint16_t *length);
+
+static void USBD_NCM_InFlush(USBD_HandleTypeDef *pdev);
+
+/* The NCM handle and the user interface */
+#define NCM_HANDLE(PDEV)                ((USBD_NCM_HandleTypeDef*) (PDEV)->pClassData)
+#define NCM_ITF(PDEV)                   ((USBD_NCM_ItfTypeDef*) (PDEV)->pUserData)
+
+#define NCM_COMM_INTERFACE              0x00
+#define NCM_DATA_INTERFACE              0x01
+
+/* Offset rounded up to the NDP and datagram alignment */
+#define NCM_ALIGN(OFFSET)               (((OFFSET) + NCM_NDP16_ALIGNMENT - 1) & ~(NCM_NDP16_ALIGNMENT - 1))
+
+/* Largest IN NTB length with COUNT datagrams ending at OFFSET, including the padding byte */
+#define NCM_NTB_IN_LENGTH(OFFSET, COUNT) (NCM_ALIGN(OFFSET) + 8 + 4 * ((COUNT) + 1) + 1)
+
+/* Notification sequence states */
+#define NCM_NOTIFY_IDLE                 0
+#define NCM_NOTIFY_SPEED                1
+#define NCM_NOTIFY_CONNECTION           2
+
+/** @defgroup USBD_NCM_Private_Variables
+ * @{ */
+
+/* USB Standard Device Descriptor */
+__ALIGN_BEGIN static const uint8_t USBD_NCM_DeviceQualifierDesc[USB_LEN_DEV_QUALIFIER_DESC] __ALIGN_END =
+{
+    USB_LEN_DEV_QUALIFIER_DESC,     /* bLength */
+    USB_DESC_TYPE_DEVICE_QUALIFIER, /* bDescriptorType */
+    0x00, 0x02,                     /* bcdUSB */
+    0xEF,                           /* bDeviceClass: Miscellaneous */
+    0x02,                           /* bDeviceSubClass: Common */
+    0x01,                           /* bDeviceProtocol: IAD */
+    0x40,                           /* bMaxPacketSize */
+    0x01,                           /* bNumConfigurations */
+    0x00,                           /* bReserved */
+};
+
+/* NCM interface class callbacks structure */
+const USBD_ClassTypeDef USBD_NCM = {
+    USBD_NCM_Init,
+    USBD_NCM_DeInit,
+    USBD_NCM_Setup,
+    NULL, /* EP0_TxSent, */
+    USBD_NCM_EP0_RxReady,
+    USBD_NCM_DataIn,
+    USBD_NCM_DataOut,
+    NULL,
+    NULL,
+    NULL,
+#ifdef DEVICE_HS
+    USBD_NCM_GetHSCfgDesc,
+#else
+    NULL,
+#endif
+    USBD_NCM_GetFSCfgDesc,
+    NULL, /* USBD_NCM_GetOtherSpeedCfgDesc, */
+    USBD_NCM_GetDeviceQualifierDescriptor,
+    USBD_NCM_GetUsrStrDescriptor
+};
+
+/* USB NCM device Configuration Descriptor with the data packet size MPS
+ * and the notification interval ITV */
+#define USBD_NCM_CFG_DESC(MPS, ITV)                                         \
+    0x09,                            /* bLength: Configuration Descriptor size */\
+    USB_DESC_TYPE_CONFIGURATION,     /* bDescriptorType: Configuration */   \
+    LOBYTE(USB_NCM_CONFIG_DESC_SIZ), /* wTotalLength:no of returned bytes */\
+    HIBYTE(USB_NCM_CONFIG_DESC_SIZ),                                        \
+    0x02,                            /* bNumInterfaces: 2 interfaces */     \
+    0x01,                            /* bConfigurationValue: Configuration value */\
+    0x00,                            /* iConfiguration: Index of string descriptor describing the configuration */\
+    0x80 | (USBD_SELF_POWERED << 6), /* bmAttributes: self powered */       \
+    USBD_MAX_POWER_mA / 2,           /* MaxPower x mA */                    \
+                                                                            \
+    /* Interface Association Descriptor */                                  \
+    0x08,                       /* bLength: IAD size */                     \
+    0x0B,                       /* bDescriptorType: IAD */                  \
+    NCM_COMM_INTERFACE,         /* bFirstInterface */                       \
+    0x02,                       /* bInterfaceCount */                       \
+    0x02,                       /* bFunctionClass: Communication Interface Class */\
+    0x0D,                       /* bFunctionSubClass: Network Control Model */\
+    0x00,                       /* bFunctionProtocol: No class specific protocol */\
+    0x00,                       /* iFunction */                             \
+                                                                            \
+    /* Communication Interface Descriptor */                                \
+    0x09,                       /* bLength: Interface Descriptor size */    \
+    USB_DESC_TYPE_INTERFACE,    /* bDescriptorType: Interface */            \
+    NCM_COMM_INTERFACE,         /* bInterfaceNumber: Number of Interface */ \
+    0x00,                       /* bAlternateSetting: Alternate setting */  \
+    0x01,                       /* bNumEndpoints: One endpoints used */     \
+    0x02,                       /* bInterfaceClass: Communication Interface Class */\
+    0x0D,                       /* bInterfaceSubClass: Network Control Model */\
+    0x00,                       /* bInterfaceProtocol: No class specific protocol */\
+    0x00,                       /* iInterface: */                           \
+                                                                            \
+    /* Header Functional Descriptor */                                      \
+    0x05,                       /* bLength: Endpoint Descriptor size */     \
+    0x24,                       /* bDescriptorType: CS_INTERFACE */         \
+    0x00,                       /* bDescriptorSubtype: Header Func Desc */  \
+    0x10,                       /* bcdCDC: spec release number */           \
+    0x01,                                                                   \
+                                                                            \
+    /* Union Functional Descriptor */                                       \
+    0x05,                       /* bFunctionLength */                       \
+    0x24,                       /* bDescriptorType: CS_INTERFACE */         \
+    0x06,                       /* bDescriptorSubtype: Union func desc */   \
+    NCM_COMM_INTERFACE,         /* bMasterInterface: Communication class interface */\
+    NCM_DATA_INTERFACE,         /* bSlaveInterface0: Data Class Interface */\
+                                                                            \
+    /* Ethernet Networking Functional Descriptor */                         \
+    0x0D,                       /* bFunctionLength */                       \
+    0x24,                       /* bDescriptorType: CS_INTERFACE */         \
+    0x0F,                       /* bDescriptorSubtype: Ethernet Networking */\
+    NCM_MAC_STRING_INDEX,       /* iMACAddress */                           \
+    0x00, 0x00, 0x00, 0x00,     /* bmEthernetStatistics: none */            \
+    LOBYTE(NCM_MAX_SEGMENT_SIZE), /* wMaxSegmentSize */                     \
+    HIBYTE(NCM_MAX_SEGMENT_SIZE),                                           \
+    0x00, 0x00,                 /* wNumberMCFilters: none */                \
+    0x00,                       /* bNumberPowerFilters: none */             \
+                                                                            \
+    /* NCM Functional Descriptor */                                         \
+    0x06,                       /* bFunctionLength */                       \
+    0x24,                       /* bDescriptorType: CS_INTERFACE */         \
+    0x1A,                       /* bDescriptorSubtype: NCM */               \
+    0x00,                       /* bcdNcmVersion: 1.00 */                   \
+    0x01,                                                                   \
+    0x00,                       /* bmNetworkCapabilities: none */           \
+                                                                            \
+    /* Notification Endpoint Descriptor */                                  \
+    0x07,                       /* bLength: Endpoint Descriptor size */     \
+    USB_DESC_TYPE_ENDPOINT,     /* bDescriptorType: Endpoint */             \
+    NCM_NOTIFY_EP,              /* bEndpointAddress */                      \
+    0x03,                       /* bmAttributes: Interrupt */               \
+    LOBYTE(NCM_NOTIFY_PACKET_SIZE), /* wMaxPacketSize: */                   \
+    HIBYTE(NCM_NOTIFY_PACKET_SIZE),                                         \
+    ITV,                        /* bInterval: */                            \
+                                                                            \
+    /* Data Interface Descriptor, alternate setting 0: no endpoints */      \
+    0x09,                       /* bLength: Interface Descriptor size */    \
+    USB_DESC_TYPE_INTERFACE,    /* bDescriptorType: Interface */            \
+    NCM_DATA_INTERFACE,         /* bInterfaceNumber: Number of Interface */ \
+    0x00,                       /* bAlternateSetting: Alternate setting */  \
+    0x00,                       /* bNumEndpoints: no endpoints */           \
+    0x0A,                       /* bInterfaceClass: CDC Data */             \
+    0x00,                       /* bInterfaceSubClass: */                   \
+    0x01,                       /* bInterfaceProtocol: Network Transfer Block */\
+    0x00,                       /* iInterface: */                           \
+                                                                            \
+    /* Data Interface Descriptor, alternate setting 1: bulk endpoints */    \
+    0x09,                       /* bLength: Interface Descriptor size */    \
+    USB_DESC_TYPE_INTERFACE,    /* bDescriptorType: Interface */            \
+    NCM_DATA_INTERFACE,         /* bInterfaceNumber: Number of Interface */ \
+    0x01,                       /* bAlternateSetting: Alternate setting */  \
+    0x02,                       /* bNumEndpoints: Two endpoints used */     \
+    0x0A,                       /* bInterfaceClass: CDC Data */             \
+    0x00,                       /* bInterfaceSubClass: */                   \
+    0x01,                       /* bInterfaceProtocol: Network Transfer Block */\
+    0x00,                       /* iInterface: */                           \
+                                                                            \
+    /* Endpoint OUT Descriptor */                                           \
+    0x07,                       /* bLength: Endpoint Descriptor size */     \
+    USB_DESC_TYPE_ENDPOINT,     /* bDescriptorType: Endpoint */             \
+    NCM_OUT_EP,                 /* bEndpointAddress */                      \
+    0x02,                       /* bmAttributes: Bulk */                    \
+    LOBYTE(MPS),                /* wMaxPacketSize: */                       \
+    HIBYTE(MPS),                                                            \
+    0x00,                       /* bInterval: ignore for Bulk transfer */   \
+                                                                            \
+    /* Endpoint IN Descriptor */                                            \
+    0x07,                       /* bLength: Endpoint Descriptor size */     \
+    USB_DESC_TYPE_ENDPOINT,     /* bDescriptorType: Endpoint */             \
+    NCM_IN_EP,                  /* bEndpointAddress */                      \
+    0x02,                       /* bmAttributes: Bulk */                    \
+    LOBYTE(MPS),                /* wMaxPacketSize: */                       \
+    HIBYTE(MPS),                                                            \
+    0x00                        /* bInterval: ignore for Bulk transfer */
+
+/* USB NCM device Configuration Descriptors, placed in flash */
+__ALIGN_BEGIN static const uint8_t USBD_NCM_FSCfgDesc[USB_NCM_CONFIG_DESC_SIZ] __ALIGN_END =
+{
+    USBD_NCM_CFG_DESC(NCM_DATA_FS_MAX_PACKET_SIZE, NCM_NOTIFY_FS_BINTERVAL)
+};
+
+#ifdef DEVICE_HS
+__ALIGN_BEGIN static const uint8_t USBD_NCM_HSCfgDesc[USB_NCM_CONFIG_DESC_SIZ] __ALIGN_END =
+{
+    USBD_NCM_CFG_DESC(NCM_DATA_HS_MAX_PACKET_SIZE, NCM_NOTIFY_HS_BINTERVAL)
+};
+#endif
+
+/* NTB parameters: NTB16 format, 4 byte aligned NDPs and datagrams */
+__ALIGN_BEGIN static const USB_NCM_NtbParametersType USBD_NCM_NtbParameters __ALIGN_END =
+{
+    .wLength                = sizeof(USB_NCM_NtbParametersType),
+    .bmNtbFormatsSupported  = 0x0001,
+    .dwNtbInMaxSize         = NCM_NTB_IN_MAX_SIZE,
+    .wNdpInDivisor          = NCM_NDP16_ALIGNMENT,
+    .wNdpInPayloadRemainder = 0,
+    .wNdpInAlignment        = NCM_NDP16_ALIGNMENT,
+    .dwNtbOutMaxSize        = NCM_NTB_OUT_MAX_SIZE,
+    .wNdpOutDivisor         = NCM_NDP16_ALIGNMENT,
+    .wNdpOutPayloadRemainder = 0,
+    .wNdpOutAlignment       = NCM_NDP16_ALIGNMENT,
+    .wNtbOutMaxDatagrams    = 0,
+};
+
+/* Host side MAC address string descriptor, built from the user interface */
+__ALIGN_BEGIN static uint8_t USBD_NCM_MACStrDesc[2 + 12 * 2] __ALIGN_END;
+
+/** @} */
+
+/** @defgroup USBD_NCM_Private_Functions
+ * @{ */
+
+/**
+ * @brief  (Re)Initialize the NCM interface
+ * @param  pdev: device instance
+ * @param  cfgidx: Configuration index
+ * @retval status
+ */
+static uint8_t USBD_NCM_Init(USBD_HandleTypeDef *pdev, uint8_t cfgidx)
+{
+    /* Open EP INT, the data endpoints are opened with the alternate setting */
+    USBD_LL_OpenEP(pdev,
+        NCM_NOTIFY_EP,
+        USBD_EP_TYPE_INTR,
+        NCM_NOTIFY_PACKET_SIZE);
+
+    pdev->pClassData = USBD_malloc(sizeof(USBD_NCM_HandleTypeDef));
+
+    if (pdev->pClassData != NULL)
+    {
+        USBD_NCM_HandleTypeDef *hncm = NCM_HANDLE(pdev);
+        USBD_NCM_ItfTypeDef *itf     = NCM_ITF(pdev);
+
+        hncm->CmdOpCode   = 0xFF;
+        hncm->NtbInSize   = NCM_NTB_IN_MAX_SIZE;
+        hncm->InSequence  = 0;
+        hncm->AltSetting  = 0;
+        hncm->NotifyState = NCM_NOTIFY_IDLE;
+        hncm->NotifyBusy  = 0;
+        hncm->PacketSize  = NCM_DATA_FS_MAX_PACKET_SIZE;
+#ifdef DEVICE_HS
+        if (pdev->dev_speed == USBD_SPEED_HIGH)
+        {
+            hncm->PacketSize = NCM_DATA_HS_MAX_PACKET_SIZE;
+        }
+#endif
+
+        /* Initialize NCM Interface components */
+        if (itf->Init != NULL)
+        {
+            itf->Init();
+        }
+    }
+
+    return USBD_OK;
+}
+
+/**
+ * @brief  Deinitialize the NCM interface
+ * @param  pdev: device instance
+ * @param  cfgidx: Configuration index
+ * @retval status
+ */
+static uint8_t USBD_NCM_DeInit(USBD_HandleTypeDef *pdev, uint8_t cfgidx)
+{
+    /* Close EP INT */
+    USBD_LL_CloseEP(pdev,
+    NCM_NOTIFY_EP);
+
+    /* DeInit NCM Interface components */
+    if (pdev->pClassData != NULL)
+    {
+        USBD_NCM_ItfTypeDef *itf = NCM_ITF(pdev);
+
+        if (NCM_HANDLE(pdev)->AltSetting != 0)
+        {
+            /* Close the data endpoints */
+            USBD_LL_CloseEP(pdev,
+            NCM_IN_EP);
+            USBD_LL_CloseEP(pdev,
+            NCM_OUT_EP);
+
+            if (itf->LinkState != NULL)
+            {
+                itf->LinkState(0);
+            }
+        }
+
+        if (itf->DeInit != NULL)
+        {
+            itf->DeInit();
+        }
+
+        USBD_free(pdev->pClassData);
+        pdev->pClassData = NULL;
+    }
+
+    return USBD_OK;
+}
+
+/**
+ * @brief  Handle the NCM specific requests
+ * @param  pdev: instance
+ * @param  req: NCM request
+ * @retval status
+ */
+static uint8_t USBD_NCM_Setup(USBD_HandleTypeDef *pdev, USBD_SetupReqTypedef *req)
+{
+    USBD_NCM_HandleTypeDef *hncm = NCM_HANDLE(pdev);
+
+    if (hncm == NULL)
+    {
+        return USBD_FAIL;
+    }
+
+    switch (req->bmRequest & USB_REQ_TYPE_MASK)
+    {
+    case USB_REQ_TYPE_CLASS:
+        switch (req->bRequest)
+        {
+        case NCM_GET_NTB_PARAMETERS:
+            USBD_CtlSendData(pdev, (uint8_t *) &USBD_NCM_NtbParameters,
+                    MIN(sizeof(USBD_NCM_NtbParameters), req->wLength));
+            break;
+
+        case NCM_GET_NTB_FORMAT:
+            /* Only the NTB16 format is supported */
+            hncm->data[0] = 0;
+            USBD_CtlSendData(pdev, (uint8_t *) hncm->data, MIN(2, req->wLength));
+            break;
+
+        case NCM_SET_NTB_FORMAT:
+            if (req->wValue != 0)
+            {
+                return USBD_FAIL;
+            }
+            break;
+
+        case NCM_GET_NTB_INPUT_SIZE:
+            hncm->data[0] = hncm->NtbInSize;
+            USBD_CtlSendData(pdev, (uint8_t *) hncm->data, MIN(4, req->wLength));
+            break;
+
+        case NCM_SET_NTB_INPUT_SIZE:
+            if ((req->wLength < 4) || (req->wLength > sizeof(hncm->data)))
+            {
+                return USBD_FAIL;
+            }
+            hncm->CmdOpCode = req->bRequest;
+
+            USBD_CtlPrepareRx(pdev, (uint8_t *) hncm->data, req->wLength);
+            break;
+
+        case NCM_SET_ETHERNET_PACKET_FILTER:
+            /* All received datagrams are forwarded to the application */
+            break;
+
+        default:
+            return USBD_FAIL;
+        }
+        break;
+
+    case USB_REQ_TYPE_STANDARD:
+        switch (req->bRequest)
+        {
+        case USB_REQ_GET_INTERFACE:
+            hncm->data[0] = (LOBYTE(req->wIndex) == NCM_DATA_INTERFACE) ? hncm->AltSetting : 0;
+            USBD_CtlSendData(pdev, (uint8_t *) hncm->data, 1);
+            break;
+
+        case USB_REQ_SET_INTERFACE:
+            if ((LOBYTE(req->wIndex) == NCM_DATA_INTERFACE) && (req->wValue <= 1))
+            {
+                USBD_NCM_SetAltSetting(pdev, (uint8_t) req->wValue);
+            }
+            else if (req->wValue != 0)
+            {
+                return USBD_FAIL;
+            }
+            break;
+        }
+        break;
+
+    default:
+        return USBD_FAIL;
+    }
+    return USBD_OK;
+}
+
+/**
+ * @brief  Data sent on non-control IN endpoint
+ * @param  pdev: device instance
+ * @param  epnum: endpoint number
+ * @retval status
+ */
+static uint8_t USBD_NCM_DataIn(USBD_HandleTypeDef *pdev, uint8_t epnum)
+{
+    USBD_NCM_HandleTypeDef *hncm = NCM_HANDLE(pdev);
+    USBD_NCM_ItfTypeDef *itf     = NCM_ITF(pdev);
+
+    if (hncm == NULL)
+    {
+        return USBD_FAIL;
+    }
+
+    if ((epnum & 0x7F) == (NCM_NOTIFY_EP & 0x7F))
+    {
+        /* Continue the notification sequence */
+        hncm->NotifyBusy = 0;
+        USBD_NCM_Notify(pdev);
+    }
+    else if ((epnum & 0x7F) == (NCM_IN_EP & 0x7F))
+    {
+        /* The aggregated datagrams are transmitted unless one is being written */
+        hncm->InBusy = 0;
+        if ((hncm->InWriting == 0) && (hncm->InCount > 0))
+        {
+            USBD_NCM_InFlush(pdev);
+        }
+
+        if (itf->Transmitted != NULL)
+        {
+            /* Provide callback on successful transmission */
+            itf->Transmitted();
+        }
+    }
+
+    return USBD_OK;
+}
+
+/**
+ * @brief  Data received on non-control OUT endpoint
+ * @param  pdev: device instance
+ * @param  epnum: endpoint number
+ * @retval status
+ */
+static uint8_t USBD_NCM_DataOut(USBD_HandleTypeDef *pdev, uint8_t epnum)
+{
+    USBD_NCM_HandleTypeDef *hncm = NCM_HANDLE(pdev);
+    USBD_NCM_ItfTypeDef *itf     = NCM_ITF(pdev);
+    uint8_t  head;
+    uint16_t length;
+
+    if (hncm == NULL)
+    {
+        return USBD_FAIL;
+    }
+
+    /* The filled NTB is queued for parsing,
+     * reception continues to the next free pool buffer */
+    head   = hncm->OutHead;
+    length = (uint16_t)USBD_LL_GetRxDataSize(pdev, epnum);
+
+    /* Transfers shorter than the NTH don't consume buffer */
+    if (length >= NCM_NTH16_LENGTH)
+    {
+        hncm->OutLength[head] = length;
+        hncm->OutHead = (head + 1) % NCM_OUT_NTB_COUNT;
+
+        /* When all buffers are filled, the endpoint NAKs until a buffer is released */
+        if (hncm->OutHead == hncm->OutTail)
+        {
+            hncm->OutHeld = 1;
+        }
+    }
+    if (hncm->OutHeld == 0)
+    {
+        USBD_NCM_PoolReceive(pdev);
+    }
+
+    if ((itf->Received != NULL) && (length >= NCM_NTH16_LENGTH))
+    {
+        /* Provide callback on successful reception */
+        itf->Received();
+    }
+
+    return USBD_OK;
+}
+
+/**
+ * @brief  Setup endpoint data processing
+ * @param  pdev: device instance
+ * @retval status
+ */
+static uint8_t USBD_NCM_EP0_RxReady(USBD_HandleTypeDef *pdev)
+{
+    USBD_NCM_HandleTypeDef *hncm = NCM_HANDLE(pdev);
+
+    if ((hncm != NULL) && (hncm->CmdOpCode == NCM_SET_NTB_INPUT_SIZE))
+    {
+        /* The IN NTBs are limited by the host's receive buffer */
+        hncm->NtbInSize = MIN(hncm->data[0], NCM_NTB_IN_MAX_SIZE);
+        hncm->CmdOpCode = 0xFF;
+    }
+
+    return USBD_OK;
+}
+
+/**
+ * @brief  Returns the configuration descriptor
+ * @param  length: pointer to the data length
+ * @retval pointer to descriptor buffer
+ */
+static uint8_t *USBD_NCM_GetFSCfgDesc(uint16_t *length)
+{
+    *length = sizeof(USBD_NCM_FSCfgDesc);
+    return (uint8_t*)USBD_NCM_FSCfgDesc;
+}
+
+#ifdef DEVICE_HS
+/**
+ * @brief  Returns the high speed configuration descriptor
+ * @param  length: pointer to the data length
+ * @retval pointer to descriptor buffer
+ */
+static uint8_t *USBD_NCM_GetHSCfgDesc(uint16_t *length)
+{
+    *length = sizeof(USBD_NCM_HSCfgDesc);
+    return (uint8_t*)USBD_NCM_HSCfgDesc;
+}
+#endif
+
+/**
+ * @brief  Returns the Device Qualifier descriptor
+ * @param  length: pointer to the data length
+ * @retval pointer to descriptor buffer
+ */
+static uint8_t *USBD_NCM_GetDeviceQualifierDescriptor(uint16_t *length)
+{
+    *length = sizeof(USBD_NCM_DeviceQualifierDesc);
+    return (uint8_t*)USBD_NCM_DeviceQualifierDesc;
+}
+
+/**
+ * @brief  Returns the MAC address string descriptor
+ * @param  pdev: device instance
+ * @param  index: string descriptor index
+ * @param  length: pointer to the data length
+ * @retval pointer to the descriptor or NULL if the descriptor is not supported.
+ */
+static uint8_t *USBD_NCM_GetUsrStrDescriptor(USBD_HandleTypeDef *pdev, uint8_t index, uint16_t *length)
+{
+    USBD_NCM_ItfTypeDef *itf = NCM_ITF(pdev);
+    uint8_t i;
+
+    if ((index != NCM_MAC_STRING_INDEX) || (itf == NULL))
+    {
+        *length = 0;
+        return NULL;
+    }
+
+    /* 12 uppercase hexadecimal digits */
+    USBD_NCM_MACStrDesc[0] = sizeof(USBD_NCM_MACStrDesc);
+    USBD_NCM_MACStrDesc[1] = USB_DESC_TYPE_STRING;
+    for (i = 0; i < 12; i++)
+    {
+        uint8_t digit = (itf->MACAddress[i / 2] >> ((i & 1) ? 0 : 4)) & 0xF;
+
+        USBD_NCM_MACStrDesc[2 + 2 * i]     = (digit < 10) ? ('0' + digit) : ('A' + digit - 10);
+        USBD_NCM_MACStrDesc[2 + 2 * i + 1] = 0;
+    }
+
+    *length = sizeof(USBD_NCM_MACStrDesc);
+    return USBD_NCM_MACStrDesc;
+}
+
+/**
+ * @brief  Selects the alternate setting of the data interface,
+ *         which (de)activates the network connection
+ * @param  pdev: device instance
+ * @param  alt: alternate setting
+ */
+static void USBD_NCM_SetAltSetting(USBD_HandleTypeDef *pdev, uint8_t alt)
+{
+    USBD_NCM_HandleTypeDef *hncm = NCM_HANDLE(pdev);
+    USBD_NCM_ItfTypeDef *itf     = NCM_ITF(pdev);
+
+    if (hncm->AltSetting != 0)
+    {
+        /* Close the data endpoints */
+        USBD_LL_CloseEP(pdev,
+        NCM_IN_EP);
+        USBD_LL_CloseEP(pdev,
+        NCM_OUT_EP);
+    }
+
+    hncm->AltSetting = alt;
+
+    if (alt != 0)
+    {
+        /* Open the data endpoints */
+        USBD_LL_OpenEP(pdev,
+            NCM_IN_EP,
+            USBD_EP_TYPE_BULK,
+            hncm->PacketSize);
+
+        USBD_LL_OpenEP(pdev,
+            NCM_OUT_EP,
+            USBD_EP_TYPE_BULK,
+            hncm->PacketSize);
+
+        /* Empty IN NTB */
+        hncm->InIndex   = 0;
+        hncm->InLength  = NCM_NTH16_LENGTH;
+        hncm->InCount   = 0;
+        hncm->InWriting = 0;
+        hncm->InBusy    = 0;
+
+        /* Start reception to the first pool buffer */
+        hncm->OutHead  = 0;
+        hncm->OutTail  = 0;
+        hncm->OutHeld  = 0;
+        hncm->OutEntry = 0;
+        USBD_NCM_PoolReceive(pdev);
+
+        /* The connection speed is reported before the connection */
+        hncm->NotifyState = NCM_NOTIFY_SPEED;
+    }
+    else
+    {
+        hncm->NotifyState = NCM_NOTIFY_CONNECTION;
+    }
+
+    if (hncm->NotifyBusy == 0)
+    {
+        USBD_NCM_Notify(pdev);
+    }
+
+    if (itf->LinkState != NULL)
+    {
+        itf->LinkState(alt);
+    }
+}
+
+/**
+ * @brief  Transmits the next notification of the sequence
+ * @param  pdev: device instance
+ */
+static void USBD_NCM_Notify(USBD_HandleTypeDef *pdev)
+{
+    USBD_NCM_HandleTypeDef *hncm = NCM_HANDLE(pdev);
+    uint8_t *msg = (uint8_t *) hncm->Notify;
+    uint16_t length = 8;
+
+    if (hncm->NotifyState == NCM_NOTIFY_IDLE)
+    {
+        return;
+    }
+
+    msg[0] = 0xA1;
+    msg[2] = 0;
+    msg[3] = 0;
+    msg[4] = NCM_COMM_INTERFACE;
+    msg[5] = 0;
+    msg[6] = 0;
+    msg[7] = 0;
+
+    if (hncm->NotifyState == NCM_NOTIFY_SPEED)
+    {
+        /* Equal downstream and upstream bit rates of the bus */
+        uint32_t bitrate = (hncm->PacketSize == NCM_DATA_HS_MAX_PACKET_SIZE) ? 480000000 : 12000000;
+
+        msg[1] = NCM_NOTIFY_CONNECTION_SPEED_CHANGE;
+        msg[6] = 8;
+        hncm->Notify[2] = bitrate;
+        hncm->Notify[3] = bitrate;
+        length = 16;
+
+        hncm->NotifyState = NCM_NOTIFY_CONNECTION;
+    }
+    else
+    {
+        msg[1] = NCM_NOTIFY_NETWORK_CONNECTION;
+        msg[2] = (hncm->AltSetting != 0) ? 1 : 0;
+
+        hncm->NotifyState = NCM_NOTIFY_IDLE;
+    }
+
+    hncm->NotifyBusy = 1;
+    (void) USBD_LL_Transmit(pdev, NCM_NOTIFY_EP, msg, length);
+}
+
+/**
+ * @brief  Starts OUT endpoint reception to the head buffer of the pool
+ * @param  pdev: device instance
+ */
+static void USBD_NCM_PoolReceive(USBD_HandleTypeDef *pdev)
+{
+    USBD_NCM_HandleTypeDef *hncm = NCM_HANDLE(pdev);
+
+    (void) USBD_LL_PrepareReceive(pdev, NCM_OUT_EP,
+            (uint8_t *) hncm->Out[hncm->OutHead], NCM_NTB_OUT_MAX_SIZE);
+}
+
+/**
+ * @brief  Validates an NDP of the parsed NTB
+ * @param  hncm: NCM handle
+ * @param  ntb: the parsed NTB
+ * @param  index: offset of the NDP in the NTB
+ * @retval Offset of the first datagram pointer, or 0 if the NDP is invalid
+ */
+static uint16_t USBD_NCM_NdpOpen(USBD_NCM_HandleTypeDef *hncm, uint8_t *ntb, uint16_t index)
+{
+    USB_NCM_NDP16Type *ndp = (USB_NCM_NDP16Type *) &ntb[index];
+
+    /* The NDPs are aligned inside the block, and only chained forward */
+    if ((index <= hncm->OutNdp) || ((index % NCM_NDP16_ALIGNMENT) != 0)
+     || (((uint32_t)index + 16) > hncm->OutBlock)
+     || (ndp->dwSignature != NCM_NDP16_SIGNATURE) || (ndp->wLength < 16)
+     || (((uint32_t)index + ndp->wLength) > hncm->OutBlock))
+    {
+        return 0;
+    }
+
+    hncm->OutNdp    = index;
+    hncm->OutNdpEnd = index + ndp->wLength;
+    return index + 8;
+}
+
+/**
+ * @brief  Advances the OUT parsing to the current datagram,
+ *         and returns the consumed NTBs to the pool
+ * @param  pdev: device instance
+ * @param  length: pointer to the datagram length
+ * @retval Pointer to the datagram, or NULL if no datagram is received
+ */
+static uint8_t *USBD_NCM_RxSeek(USBD_HandleTypeDef *pdev, uint16_t *length)
+{
+    USBD_NCM_HandleTypeDef *hncm = NCM_HANDLE(pdev);
+
+    while ((hncm->OutTail != hncm->OutHead) || (hncm->OutHeld != 0))
+    {
+        uint8_t *ntb = (uint8_t *) hncm->Out[hncm->OutTail];
+
+        /* Validate the header of a new NTB */
+        if (hncm->OutEntry == 0)
+        {
+            USB_NCM_NTH16Type *nth = (USB_NCM_NTH16Type *) ntb;
+            uint16_t size = hncm->OutLength[hncm->OutTail];
+
+            hncm->OutNdp = 0;
+            if ((nth->dwSignature == NCM_NTH16_SIGNATURE)
+             && (nth->wHeaderLength == NCM_NTH16_LENGTH)
+             && (nth->wBlockLength <= size))
+            {
+                /* Zero block length indicates a short packet terminated NTB */
+                hncm->OutBlock = (nth->wBlockLength != 0) ? nth->wBlockLength : size;
+                hncm->OutEntry = USBD_NCM_NdpOpen(hncm, ntb, nth->wNdpIndex);
+            }
+        }
+
+        while (hncm->OutEntry != 0)
+        {
+            uint16_t *entry = (uint16_t *) &ntb[hncm->OutEntry];
+
+            if ((((uint32_t)hncm->OutEntry + 4) > hncm->OutNdpEnd) || (entry[0] == 0) || (entry[1] == 0))
+            {
+                /* End of the datagram pointers, continue with the next NDP */
+                hncm->OutEntry = USBD_NCM_NdpOpen(hncm, ntb,
+                        ((USB_NCM_NDP16Type *) &ntb[hncm->OutNdp])->wNextNdpIndex);
+            }
+            else if (((uint32_t)entry[0] + entry[1]) <= hncm->OutBlock)
+            {
+                *length = entry[1];
+                return &ntb[entry[0]];
+            }
+            else
+            {
+                /* Drop the rest of the malformed NTB */
+                hncm->OutEntry = 0;
+            }
+        }
+
+        /* All datagrams are consumed, the NTB returns to the pool */
+        hncm->OutTail = (hncm->OutTail + 1) % NCM_OUT_NTB_COUNT;
+
+        /* Resume the held reception to the released buffer */
+        if (hncm->OutHeld != 0)
+        {
+            hncm->OutHeld = 0;
+            USBD_NCM_PoolReceive(pdev);
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief  Completes the filling IN NTB with its NDP, starts its transmission,
+ *         and continues aggregation in the other NTB
+ * @param  pdev: device instance
+ */
+static void USBD_NCM_InFlush(USBD_HandleTypeDef *pdev)
+{
+    USBD_NCM_HandleTypeDef *hncm = NCM_HANDLE(pdev);
+    uint8_t *ntb = (uint8_t *) hncm->In[hncm->InIndex];
+    USB_NCM_NTH16Type *nth = (USB_NCM_NTH16Type *) ntb;
+    uint16_t index = NCM_ALIGN(hncm->InLength);
+    USB_NCM_NDP16Type *ndp = (USB_NCM_NDP16Type *) &ntb[index];
+    uint16_t length;
+    uint8_t i;
+
+    /* The NDP is placed after the datagrams */
+    ndp->dwSignature   = NCM_NDP16_SIGNATURE;
+    ndp->wLength       = 8 + 4 * (hncm->InCount + 1);
+    ndp->wNextNdpIndex = 0;
+    for (i = 0; i < hncm->InCount; i++)
+    {
+        ndp->Datagram[i].wDatagramIndex  = hncm->InDatagram[i].Index;
+        ndp->Datagram[i].wDatagramLength = hncm->InDatagram[i].Length;
+    }
+    ndp->Datagram[i].wDatagramIndex  = 0;
+    ndp->Datagram[i].wDatagramLength = 0;
+    length = index + ndp->wLength;
+
+    /* Pad the NTB instead of terminating it with a zero length packet */
+    if ((length % hncm->PacketSize) == 0)
+    {
+        ntb[length++] = 0;
+    }
+
+    nth->dwSignature   = NCM_NTH16_SIGNATURE;
+    nth->wHeaderLength = NCM_NTH16_LENGTH;
+    nth->wSequence     = hncm->InSequence++;
+    nth->wBlockLength  = length;
+    nth->wNdpIndex     = index;
+
+    hncm->InBusy   = 1;
+    hncm->InIndex ^= 1;
+    hncm->InLength = NCM_NTH16_LENGTH;
+    hncm->InCount  = 0;
+
+    (void) USBD_LL_Transmit(pdev, NCM_IN_EP, ntb, length);
+}
+
+/**
+ * @brief  Sets the NCM user interface to the handler
+ * @param  pdev: device instance
+ * @param  fops: NCM Interface callbacks
+ * @retval status
+ */
+uint8_t USBD_NCM_RegisterInterface(USBD_HandleTypeDef *pdev, const USBD_NCM_ItfTypeDef *fops)
+{
+    uint8_t ret = USBD_FAIL;
+
+    if (fops != NULL)
+    {
+        pdev->pUserData = (void*)fops;
+        ret = USBD_OK;
+    }
+
+    return ret;
+}
+
+/**
+ * @brief  Provides the next received datagram in place in its OUT NTB.
+ *         Repeated calls return the same datagram until it is released.
+ * @note   Must not be called from a context that can preempt the USB interrupt.
+ * @param  pdev: device instance
+ * @param  length: pointer to the datagram length
+ * @retval Pointer to the datagram, or NULL if no datagram is received
+ */
+uint8_t *USBD_NCM_GetRxDatagram(USBD_HandleTypeDef *pdev, uint16_t *length)
+{
+    uint8_t *pbuff = NULL;
+
+    if (pdev->pClassData != NULL)
+    {
+        pbuff = USBD_NCM_RxSeek(pdev, length);
+    }
+    return pbuff;
+}
+
+/**
+ * @brief  Releases the datagram provided by @ref USBD_NCM_GetRxDatagram,
+ *         the NTB returns to the OUT pool after its last datagram.
+ * @note   Must not be called from a context that can preempt the USB interrupt.
+ * @param  pdev: device instance
+ * @retval USBD_FAIL if no datagram is received, otherwise USBD_OK
+ */
+uint8_t USBD_NCM_ReleaseRxDatagram(USBD_HandleTypeDef *pdev)
+{
+    uint8_t retval = USBD_FAIL;
+
+    if (pdev->pClassData != NULL)
+    {
+        USBD_NCM_HandleTypeDef *hncm = NCM_HANDLE(pdev);
+        uint16_t length;
+
+        if (USBD_NCM_RxSeek(pdev, &length) != NULL)
+        {
+            /* Step to the next datagram pointer, and free the NTB if it was the last one */
+            hncm->OutEntry += 4;
+            (void) USBD_NCM_RxSeek(pdev, &length);
+            retval = USBD_OK;
+        }
+    }
+    return retval;
+}
+
+/**
+ * @brief  Reserves space for a datagram in the filling IN NTB.
+ *         The datagram is written in place, and is committed by @ref USBD_NCM_SendTxDatagram.
+ * @note   Must not be called from a context that can preempt the USB interrupt.
+ * @param  pdev: device instance
+ * @param  length: largest length of the datagram
+ * @retval Pointer to the datagram buffer, or NULL if the filling NTB is full
+ *         (retry after the Transmitted callback)
+ */
+uint8_t *USBD_NCM_GetTxDatagram(USBD_HandleTypeDef *pdev, uint16_t length)
+{
+    uint8_t *pbuff = NULL;
+
+    if (pdev->pClassData != NULL)
+    {
+        USBD_NCM_HandleTypeDef *hncm = NCM_HANDLE(pdev);
+
+        if (hncm->AltSetting != 0)
+        {
+            uint16_t index;
+
+            /* Hold the completion of the filling NTB by the DataIn stage */
+            hncm->InWriting = 1;
+            index = NCM_ALIGN(hncm->InLength);
+
+            if ((hncm->InCount < NCM_MAX_IN_DATAGRAMS) &&
+                (NCM_NTB_IN_LENGTH((uint32_t)index + length, hncm->InCount + 1) <= hncm->NtbInSize))
+            {
+                pbuff = (uint8_t *) hncm->In[hncm->InIndex] + index;
+            }
+            else
+            {
+                hncm->InWriting = 0;
+            }
+        }
+    }
+    return pbuff;
+}
+
+/**
+ * @brief  Commits the datagram written to the buffer of @ref USBD_NCM_GetTxDatagram.
+ *         An idle endpoint transmits the NTB immediately, otherwise the datagram is
+ *         aggregated with the following ones until the previous NTB is transmitted.
+ * @note   Must not be called from a context that can preempt the USB interrupt.
+ * @param  pdev: device instance
+ * @param  length: datagram length, not larger than the reserved length
+ * @retval USBD_FAIL if no datagram buffer is reserved, otherwise USBD_OK
+ */
+uint8_t USBD_NCM_SendTxDatagram(USBD_HandleTypeDef *pdev, uint16_t length)
+{
+    uint8_t retval = USBD_FAIL;
+
+    if (pdev->pClassData != NULL)
+    {
+        USBD_NCM_HandleTypeDef *hncm = NCM_HANDLE(pdev);
+
+        if (hncm->InWriting != 0)
+        {
+            uint16_t index = NCM_ALIGN(hncm->InLength);
+
+            hncm->InDatagram[hncm->InCount].Index  = index;
+            hncm->InDatagram[hncm->InCount].Length = length;
+            hncm->InCount++;
+            hncm->InLength = index + length;
+            hncm->InWriting = 0;
+
+            /* An idle endpoint is started here, otherwise the DataIn stage continues */
+            if (hncm->InBusy == 0)
+            {
+                USBD_NCM_InFlush(pdev);
+            }
+            retval = USBD_OK;
+        }
+    }
+    return retval;
+}
+
+/** @} */
+
+/** @} */
+
+/** @} */
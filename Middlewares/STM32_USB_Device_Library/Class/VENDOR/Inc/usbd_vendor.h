@@ -0,0 +1,234 @@
+/**
+ ******************************************************************************
+ * @file    usbd_vendor.h
+ * @author  Benedek Kupper
+ * @version V0.1
+ * @date    2018-01-20
+ * @brief   header file for the usbd_vendor.c file.
+ ******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; COPYRIGHT 2015 STMicroelectronics</center></h2>
+ *
+ * Licensed under MCD-ST Liberty SW License Agreement V2, (the "License");
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *        http://www.st.com/software_license_agreement_liberty_v2
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************************
+ */
+#ifndef __USB_VENDOR_H
+#define __USB_VENDOR_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include  "usbd_ioreq.h"
+
+/** @addtogroup STM32_USB_DEVICE_LIBRARY
+ * @{
+ */
+
+/** @defgroup usbd_vendor
+ * @brief This file is the Header file for usbd_vendor.c
+ * @{
+ */
+
+/** @defgroup usbd_vendor_Exported_Defines
+ * @{
+ */
+/* Number of bulk pipes, each pipe uses 1 IN and 1 OUT endpoint of the vendor interface */
+#ifndef VENDOR_PIPE_COUNT
+#define VENDOR_PIPE_COUNT                           1
+#endif
+
+/* Endpoint addresses of the pipes [0 .. VENDOR_PIPE_COUNT - 1] */
+#define VENDOR_PIPE_IN_EP(I)                        (0x81 + (I))
+#define VENDOR_PIPE_OUT_EP(I)                       (0x01 + (I))
+
+/* Pipe index of the endpoint number */
+#define VENDOR_EP_PIPE(EPNUM)                       ((uint8_t)(((EPNUM) & 0x7F) - 1))
+
+#define VENDOR_DATA_HS_MAX_PACKET_SIZE              512  /* Bulk endpoint packet size */
+#define VENDOR_DATA_FS_MAX_PACKET_SIZE              64   /* Bulk endpoint packet size */
+
+/* Pipe buffering parameters: the OUT endpoints keep receiving to the next free pool buffer
+ * while the application processes the filled ones, the IN endpoints transmit
+ * the queued application buffers back-to-back. */
+#ifndef VENDOR_OUT_BUFFER_COUNT
+#define VENDOR_OUT_BUFFER_COUNT                     2    /* Number of OUT pool buffers per pipe */
+#endif
+#ifndef VENDOR_OUT_BUFFER_SIZE
+#define VENDOR_OUT_BUFFER_SIZE                      2048 /* OUT pool buffer size (multiple of packet size) */
+#endif
+#ifndef VENDOR_IN_QUEUE_SIZE
+#define VENDOR_IN_QUEUE_SIZE                        4    /* Number of queued IN buffers per pipe (power of 2) */
+#endif
+
+/* Microsoft OS 2.0 descriptor parameters for driverless WinUSB binding */
+#ifndef VENDOR_MS_VENDOR_CODE
+#define VENDOR_MS_VENDOR_CODE                       0x01 /* bRequest of the descriptor set request */
+#endif
+#ifndef VENDOR_DEVICE_INTERFACE_GUID
+#define VENDOR_DEVICE_INTERFACE_GUID                "{13EB360B-BC1E-46CB-AC8B-EF3DA47B4062}"
+#endif
+
+#define USB_VENDOR_CONFIG_DESC_SIZ                  (9 + 9 + VENDOR_PIPE_COUNT * 2 * 7)
+
+/*---------------------------------------------------------------------*/
+/*  Microsoft OS 2.0 definitions                                       */
+/*---------------------------------------------------------------------*/
+#define MS_OS_20_DESCRIPTOR_INDEX                   0x07
+#define MS_OS_20_SET_HEADER_DESCRIPTOR              0x00
+#define MS_OS_20_FEATURE_COMPATIBLE_ID              0x03
+#define MS_OS_20_FEATURE_REG_PROPERTY               0x04
+#define MS_OS_20_WINDOWS_VERSION                    0x06030000 /* Windows 8.1 */
+#define MS_OS_20_REG_MULTI_SZ                       0x07
+
+#define USB_VENDOR_MSOS20_DESC_SIZ                  162
+#define USB_VENDOR_MSOS20_PLATFORM_CAP_SIZ          28
+
+/* The Microsoft OS 2.0 platform capability descriptor, to be included in the BOS descriptor
+ * of the device (which requires bcdUSB 2.01 in the device descriptor):
+ * @code
+    __ALIGN_BEGIN const uint8_t USBD_BOSDesc[5 + USB_VENDOR_MSOS20_PLATFORM_CAP_SIZ] __ALIGN_END = {
+        0x05, USB_DESC_TYPE_BOS,
+        LOBYTE(5 + USB_VENDOR_MSOS20_PLATFORM_CAP_SIZ), HIBYTE(5 + USB_VENDOR_MSOS20_PLATFORM_CAP_SIZ),
+        0x01,
+        USB_VENDOR_MSOS20_PLATFORM_CAP_DESC
+    };
+ * @endcode */
+#define USB_VENDOR_MSOS20_PLATFORM_CAP_DESC                                 \
+    USB_VENDOR_MSOS20_PLATFORM_CAP_SIZ, /* bLength */                       \
+    0x10,                       /* bDescriptorType: Device Capability */    \
+    0x05,                       /* bDevCapabilityType: Platform */          \
+    0x00,                       /* bReserved */                             \
+    0xDF, 0x60, 0xDD, 0xD8,     /* PlatformCapabilityUUID: */               \
+    0x89, 0x45, 0xC7, 0x4C,     /* {D8DD60DF-4589-4CC7-9CD2-659D9E648A9F} */\
+    0x9C, 0xD2, 0x65, 0x9D,                                                 \
+    0x9E, 0x64, 0x8A, 0x9F,                                                 \
+    0x00, 0x00, 0x03, 0x06,     /* dwWindowsVersion: Windows 8.1 */         \
+    LOBYTE(USB_VENDOR_MSOS20_DESC_SIZ), /* wMSOSDescriptorSetTotalLength */ \
+    HIBYTE(USB_VENDOR_MSOS20_DESC_SIZ),                                     \
+    VENDOR_MS_VENDOR_CODE,      /* bMS_VendorCode */                        \
+    0x00                        /* bAltEnumCode */
+
+/**
+ * @}
+ */
+
+/** @defgroup USBD_CORE_Exported_TypesDefinitions
+ * @{
+ */
+
+/* Microsoft OS 2.0 descriptor set of a single function device */
+typedef struct
+{
+    uint16_t wLength;               /*!< Size of the set header (10 bytes) */
+    uint16_t wDescriptorType;       /*!< MS_OS_20_SET_HEADER_DESCRIPTOR */
+    uint32_t dwWindowsVersion;      /*!< Minimum Windows version */
+    uint16_t wTotalLength;          /*!< Size of the entire set */
+    struct {
+        uint16_t wLength;           /*!< Size of the compatible ID descriptor (20 bytes) */
+        uint16_t wDescriptorType;   /*!< MS_OS_20_FEATURE_COMPATIBLE_ID */
+        uint8_t  CompatibleID[8];   /*!< "WINUSB" */
+        uint8_t  SubCompatibleID[8];
+    } CompatibleID;
+    struct {
+        uint16_t wLength;           /*!< Size of the registry property descriptor */
+        uint16_t wDescriptorType;   /*!< MS_OS_20_FEATURE_REG_PROPERTY */
+        uint16_t wPropertyDataType; /*!< MS_OS_20_REG_MULTI_SZ */
+        uint16_t wPropertyNameLength;
+        uint16_t PropertyName[21];  /*!< "DeviceInterfaceGUIDs" */
+        uint16_t wPropertyDataLength;
+        uint16_t PropertyData[40];  /*!< The device interface GUID string list */
+    } RegProperty;
+} __packed USB_MSOS20DescSetType;
+
+typedef struct _USBD_VENDOR_Itf
+{
+    void (*Init)(void);
+    void (*DeInit)(void);
+    void (*Control)(uint8_t, uint8_t *, uint16_t);
+    void (*Received)(uint8_t, uint8_t *, uint32_t);
+    void (*Transmitted)(uint8_t, uint8_t *, uint32_t);
+} USBD_VENDOR_ItfTypeDef;
+
+typedef struct
+{
+    uint32_t data[USB_MAX_EP0_SIZE / 4];    /* Force 32bits alignment */
+    struct {
+        uint32_t Data[VENDOR_OUT_BUFFER_COUNT][VENDOR_OUT_BUFFER_SIZE / 4]; /* Force 32bits alignment */
+        uint16_t Length[VENDOR_OUT_BUFFER_COUNT];  /* Received data length of filled buffers */
+        volatile uint8_t Head;                  /* Index of the receiving buffer */
+        volatile uint8_t Tail;                  /* Index of the oldest filled buffer */
+        volatile uint8_t Held;                  /* Reception is held as all buffers are filled */
+    } Out[VENDOR_PIPE_COUNT];
+    struct {
+        uint8_t *Buffer[VENDOR_IN_QUEUE_SIZE];  /* Queued buffers */
+        uint16_t Length[VENDOR_IN_QUEUE_SIZE];  /* Data length of queued buffers */
+        volatile uint8_t Head;                  /* Free running count of queued buffers */
+        volatile uint8_t Tail;                  /* Free running count of transmitted buffers */
+        volatile uint8_t Busy;                  /* The endpoint is transmitting the tail buffer */
+    } In[VENDOR_PIPE_COUNT];
+    uint8_t CmdOpCode;
+    uint8_t CmdLength;
+} USBD_VENDOR_HandleTypeDef;
+
+/**
+ * @}
+ */
+
+/** @defgroup USBD_CORE_Exported_Variables
+ * @{
+ */
+
+extern const USBD_ClassTypeDef USBD_VENDOR;
+#define USBD_VENDOR_CLASS    &USBD_VENDOR
+
+/**
+ * @}
+ */
+
+/** @defgroup USB_CORE_Exported_Functions
+ * @{
+ */
+
+uint8_t USBD_VENDOR_RegisterInterface(USBD_HandleTypeDef *pdev,
+        const USBD_VENDOR_ItfTypeDef *fops);
+
+uint8_t USBD_VENDOR_Transmit(USBD_HandleTypeDef *pdev, uint8_t pipe, uint8_t *pbuff, uint16_t length);
+
+uint8_t *USBD_VENDOR_GetRxBuffer(USBD_HandleTypeDef *pdev, uint8_t pipe, uint16_t *length);
+
+uint8_t USBD_VENDOR_ReleaseRxBuffer(USBD_HandleTypeDef *pdev, uint8_t pipe);
+
+/**
+ * @}
+ */
+
+/**
+ * @}
+ */
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* __USB_VENDOR_H */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -0,0 +1,718 @@
+/**
+ ******************************************************************************
+ * @file    usbd_vendor.c
+ * @author  Benedek Kupper
+ * @version V0.1
+ * @date    2018-01-20
+ * @brief   This file provides the high layer firmware functions to manage the
+ *          following functionalities of the USB Vendor Bulk Class:
+ *           - Initialization and Configuration of high and low layer
+ *           - Enumeration as vendor specific device with WinUSB compatible ID
+ *           - Bulk OUT/IN data transfer on multiple pipes
+ *           - Vendor control requests management
+ *
+ *  @verbatim
+ *
+ *          ===================================================================
+ *                              Vendor Class Driver Description
+ *          ===================================================================
+ *           This driver implements a vendor specific interface with raw bulk pipes,
+ *           which are accessed by the host with a generic driver (e.g. libusb).
+ *           This driver implements the following aspects:
+ *             - Configuration descriptor with one interface and VENDOR_PIPE_COUNT
+ *               bulk IN and OUT endpoint pairs
+ *             - Microsoft OS 2.0 descriptor set with WinUSB compatible ID and
+ *               device interface GUID, so Windows binds WinUSB without INF file
+ *             - Vendor requests forwarded to the Control interface function
+ *
+ *           The OUT endpoints receive to a pool of VENDOR_OUT_BUFFER_COUNT buffers:
+ *           the reception continues to the next free buffer as soon as one is filled,
+ *           and the filled buffers are returned to the pool by the application
+ *           with @ref USBD_VENDOR_ReleaseRxBuffer. The IN endpoints transmit
+ *           the buffers queued by @ref USBD_VENDOR_Transmit back-to-back, the next
+ *           transfer is started before the Transmitted callback of the previous one.
+ *
+ *           The device descriptor shall use bcdUSB 2.01, and the BOS descriptor
+ *           shall contain USB_VENDOR_MSOS20_PLATFORM_CAP_DESC, see usbd_vendor.h.
+ *
+ *  @endverbatim
+ *
+ ******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; COPYRIGHT 2015 STMicroelectronics</center></h2>
+ *
+ * Licensed under MCD-ST Liberty SW License Agreement V2, (the "License");
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *        http://www.st.com/software_license_agreement_liberty_v2
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************************
+ */
+
+#include "usbd_vendor.h"
+#include "usbd_ctlreq.h"
+
+/** @addtogroup STM32_USB_DEVICE_LIBRARY
+ * @{ */
+
+/** @defgroup USBD_VENDOR
+ * @brief USB Vendor Bulk Class module
+ * @{ */
+
+#if (VENDOR_PIPE_COUNT > 4)
+#error "The configuration descriptor is defined for up to 4 vendor pipes."
+#endif
+
+#if ((VENDOR_IN_QUEUE_SIZE & (VENDOR_IN_QUEUE_SIZE - 1)) != 0)
+#error "VENDOR_IN_QUEUE_SIZE must be a power of 2."
+#endif
+
+static uint8_t USBD_VENDOR_Init(USBD_HandleTypeDef *pdev, uint8_t cfgidx);
+
+static uint8_t USBD_VENDOR_DeInit(USBD_HandleTypeDef *pdev, uint8_t cfgidx);
+
+static uint8_t USBD_VENDOR_Setup(USBD_HandleTypeDef *pdev, USBD_SetupReqTypedef *req);
+
+static uint8_t USBD_VENDOR_DataIn(USBD_HandleTypeDef *pdev, uint8_t epnum);
+
+static uint8_t USBD_VENDOR_DataOut(USBD_HandleTypeDef *pdev, uint8_t epnum);
+
+static uint8_t USBD_VENDOR_EP0_RxReady(USBD_HandleTypeDef *pdev);
+
+static uint8_t *USBD_VENDOR_GetFSCfgDesc(uint16_t *length);
+
+#ifdef DEVICE_HS
+static uint8_t *USBD_VENDOR_GetHSCfgDesc(uint16_t *length);
+#endif
+
+static uint8_t *USBD_VENDOR_GetDeviceQualifierDescriptor(uint16_t *length);
+
+static void USBD_VENDOR_PoolReceive(USBD_HandleTypeDef *pdev, uint8_t pipe);
+
+static void USBD_VENDOR_InStart(USBD_HandleTypeDef *pdev, uint8_t pipe);
+
+/* The vendor handle and the user interface */
+#define VENDOR_HANDLE(PDEV)             ((USBD_VENDOR_HandleTypeDef*) (PDEV)->pClassData)
+#define VENDOR_ITF(PDEV)                ((USBD_VENDOR_ItfTypeDef*) (PDEV)->pUserData)
+
+/* The queue slot of the free running IN counter */
+#define VENDOR_IN_SLOT(COUNT)           ((COUNT) & (VENDOR_IN_QUEUE_SIZE - 1))
+
+/** @defgroup USBD_VENDOR_Private_Variables
+ * @{ */
+
+/* USB Standard Device Descriptor */
+__ALIGN_BEGIN static const uint8_t USBD_VENDOR_DeviceQualifierDesc[USB_LEN_DEV_QUALIFIER_DESC] __ALIGN_END =
+{
+    USB_LEN_DEV_QUALIFIER_DESC,     /* bLength */
+    USB_DESC_TYPE_DEVICE_QUALIFIER, /* bDescriptorType */
+    0x00, 0x02,                     /* bcdUSB */
+    0x00,                           /* bDeviceClass */
+    0x00,                           /* bDeviceSubClass */
+    0x00,                           /* bDeviceProtocol */
+    0x40,                           /* bMaxPacketSize */
+    0x01,                           /* bNumConfigurations */
+    0x00,                           /* bReserved */
+};
+
+/* Vendor interface class callbacks structure */
+const USBD_ClassTypeDef USBD_VENDOR = {
+    USBD_VENDOR_Init,
+    USBD_VENDOR_DeInit,
+    USBD_VENDOR_Setup,
+    NULL, /* EP0_TxSent, */
+    USBD_VENDOR_EP0_RxReady,
+    USBD_VENDOR_DataIn,
+    USBD_VENDOR_DataOut,
+    NULL,
+    NULL,
+    NULL,
+#ifdef DEVICE_HS
+    USBD_VENDOR_GetHSCfgDesc,
+#else
+    NULL,
+#endif
+    USBD_VENDOR_GetFSCfgDesc,
+    NULL, /* USBD_VENDOR_GetOtherSpeedCfgDesc, */
+    USBD_VENDOR_GetDeviceQualifierDescriptor
+};
+
+/* Bulk endpoint descriptors of the I-th pipe with the packet size MPS */
+#define USBD_VENDOR_PIPE_DESC(I, MPS)                                       \
+    /* Endpoint OUT Descriptor */                                           \
+    0x07,                       /* bLength: Endpoint Descriptor size */     \
+    USB_DESC_TYPE_ENDPOINT,     /* bDescriptorType: Endpoint */             \
+    VENDOR_PIPE_OUT_EP(I),      /* bEndpointAddress */                      \
+    0x02,                       /* bmAttributes: Bulk */                    \
+    LOBYTE(MPS),                /* wMaxPacketSize: */                       \
+    HIBYTE(MPS),                                                            \
+    0x00,                       /* bInterval: ignore for Bulk transfer */   \
+                                                                            \
+    /* Endpoint IN Descriptor */                                            \
+    0x07,                       /* bLength: Endpoint Descriptor size */     \
+    USB_DESC_TYPE_ENDPOINT,     /* bDescriptorType: Endpoint */             \
+    VENDOR_PIPE_IN_EP(I),       /* bEndpointAddress */                      \
+    0x02,                       /* bmAttributes: Bulk */                    \
+    LOBYTE(MPS),                /* wMaxPacketSize: */                       \
+    HIBYTE(MPS),                                                            \
+    0x00,                       /* bInterval: ignore for Bulk transfer */
+
+#if (VENDOR_PIPE_COUNT > 1)
+#define USBD_VENDOR_PIPE_DESC_1(MPS)    USBD_VENDOR_PIPE_DESC(1, MPS)
+#else
+#define USBD_VENDOR_PIPE_DESC_1(MPS)
+#endif
+#if (VENDOR_PIPE_COUNT > 2)
+#define USBD_VENDOR_PIPE_DESC_2(MPS)    USBD_VENDOR_PIPE_DESC(2, MPS)
+#else
+#define USBD_VENDOR_PIPE_DESC_2(MPS)
+#endif
+#if (VENDOR_PIPE_COUNT > 3)
+#define USBD_VENDOR_PIPE_DESC_3(MPS)    USBD_VENDOR_PIPE_DESC(3, MPS)
+#else
+#define USBD_VENDOR_PIPE_DESC_3(MPS)
+#endif
+
+/* USB Vendor device Configuration Descriptor of all pipes */
+#define USBD_VENDOR_CFG_DESC(MPS)                                           \
+    0x09,                            /* bLength: Configuration Descriptor size */\
+    USB_DESC_TYPE_CONFIGURATION,     /* bDescriptorType: Configuration */   \
+    LOBYTE(USB_VENDOR_CONFIG_DESC_SIZ), /* wTotalLength:no of returned bytes */\
+    HIBYTE(USB_VENDOR_CONFIG_DESC_SIZ),                                     \
+    0x01,                            /* bNumInterfaces: 1 interface */      \
+    0x01,                            /* bConfigurationValue: Configuration value */\
+    0x00,                            /* iConfiguration: Index of string descriptor describing the configuration */\
+    0x80 | (USBD_SELF_POWERED << 6), /* bmAttributes: self powered */       \
+    USBD_MAX_POWER_mA / 2,           /* MaxPower x mA */                    \
+                                                                            \
+    /* Interface Descriptor */                                              \
+    0x09,                       /* bLength: Interface Descriptor size */    \
+    USB_DESC_TYPE_INTERFACE,    /* bDescriptorType: Interface */            \
+    0x00,                       /* bInterfaceNumber: Number of Interface */ \
+    0x00,                       /* bAlternateSetting: Alternate setting */  \
+    2 * VENDOR_PIPE_COUNT,      /* bNumEndpoints */                         \
+    0xFF,                       /* bInterfaceClass: Vendor specific */      \
+    0x00,                       /* bInterfaceSubClass: */                   \
+    0x00,                       /* bInterfaceProtocol: */                   \
+    0x00,                       /* iInterface: */                           \
+                                                                            \
+    USBD_VENDOR_PIPE_DESC(0, MPS)                                           \
+    USBD_VENDOR_PIPE_DESC_1(MPS)                                            \
+    USBD_VENDOR_PIPE_DESC_2(MPS)                                            \
+    USBD_VENDOR_PIPE_DESC_3(MPS)
+
+/* USB Vendor device Configuration Descriptors, placed in flash */
+__ALIGN_BEGIN static const uint8_t USBD_VENDOR_FSCfgDesc[USB_VENDOR_CONFIG_DESC_SIZ] __ALIGN_END =
+{
+    USBD_VENDOR_CFG_DESC(VENDOR_DATA_FS_MAX_PACKET_SIZE)
+};
+
+#ifdef DEVICE_HS
+__ALIGN_BEGIN static const uint8_t USBD_VENDOR_HSCfgDesc[USB_VENDOR_CONFIG_DESC_SIZ] __ALIGN_END =
+{
+    USBD_VENDOR_CFG_DESC(VENDOR_DATA_HS_MAX_PACKET_SIZE)
+};
+#endif
+
+/* Microsoft OS 2.0 descriptor set, the WinUSB driver is bound to the whole device */
+__ALIGN_BEGIN static const USB_MSOS20DescSetType USBD_VENDOR_MSOS20Desc __ALIGN_END =
+{
+    .wLength                = 10,
+    .wDescriptorType        = MS_OS_20_SET_HEADER_DESCRIPTOR,
+    .dwWindowsVersion       = MS_OS_20_WINDOWS_VERSION,
+    .wTotalLength           = USB_VENDOR_MSOS20_DESC_SIZ,
+    .CompatibleID = {
+        .wLength            = 20,
+        .wDescriptorType    = MS_OS_20_FEATURE_COMPATIBLE_ID,
+        .CompatibleID       = "WINUSB",
+    },
+    .RegProperty = {
+        .wLength            = 132,
+        .wDescriptorType    = MS_OS_20_FEATURE_REG_PROPERTY,
+        .wPropertyDataType  = MS_OS_20_REG_MULTI_SZ,
+        .wPropertyNameLength = 42,
+        .PropertyName       = u"DeviceInterfaceGUIDs",
+        .wPropertyDataLength = 80,
+        .PropertyData       = u"" VENDOR_DEVICE_INTERFACE_GUID,
+    },
+};
+
+/** @} */
+
+/** @defgroup USBD_VENDOR_Private_Functions
+ * @{ */
+
+/**
+ * @brief  (Re)Initialize the vendor interface
+ * @param  pdev: device instance
+ * @param  cfgidx: Configuration index
+ * @retval status
+ */
+static uint8_t USBD_VENDOR_Init(USBD_HandleTypeDef *pdev, uint8_t cfgidx)
+{
+    uint16_t packet_size = VENDOR_DATA_FS_MAX_PACKET_SIZE;
+    uint8_t pipe;
+
+#ifdef DEVICE_HS
+    if (pdev->dev_speed == USBD_SPEED_HIGH)
+    {
+        packet_size = VENDOR_DATA_HS_MAX_PACKET_SIZE;
+    }
+#endif
+
+    for (pipe = 0; pipe < VENDOR_PIPE_COUNT; pipe++)
+    {
+        /* Open EP IN */
+        USBD_LL_OpenEP(pdev,
+            VENDOR_PIPE_IN_EP(pipe),
+            USBD_EP_TYPE_BULK,
+            packet_size);
+
+        /* Open EP OUT */
+        USBD_LL_OpenEP(pdev,
+            VENDOR_PIPE_OUT_EP(pipe),
+            USBD_EP_TYPE_BULK,
+            packet_size);
+    }
+
+    pdev->pClassData = USBD_malloc(sizeof(USBD_VENDOR_HandleTypeDef));
+
+    if (pdev->pClassData != NULL)
+    {
+        USBD_VENDOR_HandleTypeDef *hvnd = VENDOR_HANDLE(pdev);
+        USBD_VENDOR_ItfTypeDef *itf     = VENDOR_ITF(pdev);
+
+        hvnd->CmdOpCode = 0xFF;
+
+        for (pipe = 0; pipe < VENDOR_PIPE_COUNT; pipe++)
+        {
+            hvnd->In[pipe].Head = 0;
+            hvnd->In[pipe].Tail = 0;
+            hvnd->In[pipe].Busy = 0;
+
+            /* Start reception to the first pool buffer */
+            hvnd->Out[pipe].Head = 0;
+            hvnd->Out[pipe].Tail = 0;
+            hvnd->Out[pipe].Held = 0;
+            USBD_VENDOR_PoolReceive(pdev, pipe);
+        }
+
+        /* Initialize vendor Interface components */
+        if (itf->Init != NULL)
+        {
+            itf->Init();
+        }
+    }
+
+    return USBD_OK;
+}
+
+/**
+ * @brief  Deinitialize the vendor interface
+ * @param  pdev: device instance
+ * @param  cfgidx: Configuration index
+ * @retval status
+ */
+static uint8_t USBD_VENDOR_DeInit(USBD_HandleTypeDef *pdev, uint8_t cfgidx)
+{
+    uint8_t pipe;
+
+    for (pipe = 0; pipe < VENDOR_PIPE_COUNT; pipe++)
+    {
+        /* Close EP IN */
+        USBD_LL_CloseEP(pdev,
+        VENDOR_PIPE_IN_EP(pipe));
+
+        /* Close EP OUT */
+        USBD_LL_CloseEP(pdev,
+        VENDOR_PIPE_OUT_EP(pipe));
+    }
+
+    /* DeInit vendor Interface components */
+    if (pdev->pClassData != NULL)
+    {
+        USBD_VENDOR_ItfTypeDef *itf = VENDOR_ITF(pdev);
+
+        if (itf->DeInit != NULL)
+        {
+            itf->DeInit();
+        }
+
+        USBD_free(pdev->pClassData);
+        pdev->pClassData = NULL;
+    }
+
+    return USBD_OK;
+}
+
+/**
+ * @brief  Handle the vendor specific requests
+ * @param  pdev: instance
+ * @param  req: vendor request
+ * @retval status
+ */
+static uint8_t USBD_VENDOR_Setup(USBD_HandleTypeDef *pdev, USBD_SetupReqTypedef *req)
+{
+    USBD_VENDOR_HandleTypeDef *hvnd = VENDOR_HANDLE(pdev);
+    USBD_VENDOR_ItfTypeDef *itf     = VENDOR_ITF(pdev);
+
+    switch (req->bmRequest & USB_REQ_TYPE_MASK)
+    {
+    case USB_REQ_TYPE_VENDOR:
+        /* The descriptor set is requested before the configuration */
+        if ((req->bRequest == VENDOR_MS_VENDOR_CODE) &&
+            (req->wIndex == MS_OS_20_DESCRIPTOR_INDEX))
+        {
+            if ((req->bmRequest & 0x80) == 0)
+            {
+                return USBD_FAIL;
+            }
+            USBD_CtlSendData(pdev, (uint8_t *) &USBD_VENDOR_MSOS20Desc,
+                    MIN(sizeof(USBD_VENDOR_MSOS20Desc), req->wLength));
+        }
+        else if ((hvnd == NULL) || (itf->Control == NULL) || (req->wLength > sizeof(hvnd->data)))
+        {
+            return USBD_FAIL;
+        }
+        else if (req->wLength)
+        {
+            if (req->bmRequest & 0x80)
+            {
+                itf->Control(req->bRequest, (uint8_t *) hvnd->data, req->wLength);
+
+                USBD_CtlSendData(pdev, (uint8_t *) hvnd->data, req->wLength);
+            }
+            else
+            {
+                hvnd->CmdOpCode = req->bRequest;
+                hvnd->CmdLength = req->wLength;
+
+                USBD_CtlPrepareRx(pdev, (uint8_t *) hvnd->data, req->wLength);
+            }
+        }
+        else
+        {
+            itf->Control(req->bRequest, (uint8_t*) req, 0);
+        }
+        break;
+
+    case USB_REQ_TYPE_STANDARD:
+        switch (req->bRequest)
+        {
+        case USB_REQ_GET_INTERFACE:
+            {
+                uint8_t ifalt = 0;
+                USBD_CtlSendData(pdev, &ifalt, 1);
+            }
+            break;
+
+        case USB_REQ_SET_INTERFACE:
+            break;
+        }
+        break;
+
+    default:
+        return USBD_FAIL;
+    }
+    return USBD_OK;
+}
+
+/**
+ * @brief  Data sent on non-control IN endpoint
+ * @param  pdev: device instance
+ * @param  epnum: endpoint number
+ * @retval status
+ */
+static uint8_t USBD_VENDOR_DataIn(USBD_HandleTypeDef *pdev, uint8_t epnum)
+{
+    uint8_t pipe = VENDOR_EP_PIPE(epnum);
+
+    if ((pdev->pClassData != NULL) && (pipe < VENDOR_PIPE_COUNT))
+    {
+        USBD_VENDOR_HandleTypeDef *hvnd = VENDOR_HANDLE(pdev);
+        USBD_VENDOR_ItfTypeDef *itf     = VENDOR_ITF(pdev);
+        uint8_t slot = VENDOR_IN_SLOT(hvnd->In[pipe].Tail);
+
+        hvnd->In[pipe].Tail++;
+
+        /* Continue with the next queued buffer before notifying the application */
+        if (hvnd->In[pipe].Tail != hvnd->In[pipe].Head)
+        {
+            USBD_VENDOR_InStart(pdev, pipe);
+        }
+        else
+        {
+            hvnd->In[pipe].Busy = 0;
+        }
+
+        if (itf->Transmitted != NULL)
+        {
+            /* Provide callback on successful transmission */
+            itf->Transmitted(pipe, hvnd->In[pipe].Buffer[slot], hvnd->In[pipe].Length[slot]);
+        }
+    }
+
+    return USBD_OK;
+}
+
+/**
+ * @brief  Data received on non-control OUT endpoint
+ * @param  pdev: device instance
+ * @param  epnum: endpoint number
+ * @retval status
+ */
+static uint8_t USBD_VENDOR_DataOut(USBD_HandleTypeDef *pdev, uint8_t epnum)
+{
+    uint8_t pipe = VENDOR_EP_PIPE(epnum);
+    USBD_VENDOR_HandleTypeDef *hvnd;
+    USBD_VENDOR_ItfTypeDef *itf;
+    uint8_t  head;
+    uint16_t length;
+
+    if ((pdev->pClassData == NULL) || (pipe >= VENDOR_PIPE_COUNT))
+    {
+        return USBD_FAIL;
+    }
+    hvnd = VENDOR_HANDLE(pdev);
+    itf  = VENDOR_ITF(pdev);
+
+    /* The filled buffer is queued for the application,
+     * reception continues to the next free pool buffer */
+    head   = hvnd->Out[pipe].Head;
+    length = (uint16_t)USBD_LL_GetRxDataSize(pdev, epnum);
+
+    /* Empty transfers don't consume buffer */
+    if (length > 0)
+    {
+        hvnd->Out[pipe].Length[head] = length;
+        hvnd->Out[pipe].Head = (head + 1) % VENDOR_OUT_BUFFER_COUNT;
+
+        /* When all buffers are filled, the endpoint NAKs until a buffer is released */
+        if (hvnd->Out[pipe].Head == hvnd->Out[pipe].Tail)
+        {
+            hvnd->Out[pipe].Held = 1;
+        }
+    }
+    if (hvnd->Out[pipe].Held == 0)
+    {
+        USBD_VENDOR_PoolReceive(pdev, pipe);
+    }
+
+    if ((itf->Received != NULL) && (length > 0))
+    {
+        /* Provide callback on successful reception */
+        itf->Received(pipe, (uint8_t *) hvnd->Out[pipe].Data[head], length);
+    }
+
+    return USBD_OK;
+}
+
+/**
+ * @brief  Setup endpoint data processing
+ * @param  pdev: device instance
+ * @retval status
+ */
+static uint8_t USBD_VENDOR_EP0_RxReady(USBD_HandleTypeDef *pdev)
+{
+    USBD_VENDOR_HandleTypeDef *hvnd = VENDOR_HANDLE(pdev);
+    USBD_VENDOR_ItfTypeDef *itf     = VENDOR_ITF(pdev);
+
+    if ((hvnd != NULL) && (itf->Control != NULL) && (hvnd->CmdOpCode != 0xFF))
+    {
+        /* Provide callback to request handler */
+        itf->Control(hvnd->CmdOpCode, (uint8_t *) hvnd->data, hvnd->CmdLength);
+        hvnd->CmdOpCode = 0xFF;
+    }
+
+    return USBD_OK;
+}
+
+/**
+ * @brief  Returns the configuration descriptor
+ * @param  length: pointer to the data length
+ * @retval pointer to descriptor buffer
+ */
+static uint8_t *USBD_VENDOR_GetFSCfgDesc(uint16_t *length)
+{
+    *length = sizeof(USBD_VENDOR_FSCfgDesc);
+    return (uint8_t*)USBD_VENDOR_FSCfgDesc;
+}
+
+#ifdef DEVICE_HS
+/**
+ * @brief  Returns the high speed configuration descriptor
+ * @param  length: pointer to the data length
+ * @retval pointer to descriptor buffer
+ */
+static uint8_t *USBD_VENDOR_GetHSCfgDesc(uint16_t *length)
+{
+    *length = sizeof(USBD_VENDOR_HSCfgDesc);
+    return (uint8_t*)USBD_VENDOR_HSCfgDesc;
+}
+#endif
+
+/**
+ * @brief  Returns the Device Qualifier descriptor
+ * @param  length: pointer to the data length
+ * @retval pointer to descriptor buffer
+ */
+static uint8_t *USBD_VENDOR_GetDeviceQualifierDescriptor(uint16_t *length)
+{
+    *length = sizeof(USBD_VENDOR_DeviceQualifierDesc);
+    return (uint8_t*)USBD_VENDOR_DeviceQualifierDesc;
+}
+
+/**
+ * @brief  Starts OUT endpoint reception to the head buffer of the pool
+ * @param  pdev: device instance
+ * @param  pipe: pipe index
+ */
+static void USBD_VENDOR_PoolReceive(USBD_HandleTypeDef *pdev, uint8_t pipe)
+{
+    USBD_VENDOR_HandleTypeDef *hvnd = VENDOR_HANDLE(pdev);
+
+    (void) USBD_LL_PrepareReceive(pdev, VENDOR_PIPE_OUT_EP(pipe),
+            (uint8_t *) hvnd->Out[pipe].Data[hvnd->Out[pipe].Head], VENDOR_OUT_BUFFER_SIZE);
+}
+
+/**
+ * @brief  Starts IN endpoint transmission of the tail buffer of the queue
+ * @param  pdev: device instance
+ * @param  pipe: pipe index
+ */
+static void USBD_VENDOR_InStart(USBD_HandleTypeDef *pdev, uint8_t pipe)
+{
+    USBD_VENDOR_HandleTypeDef *hvnd = VENDOR_HANDLE(pdev);
+    uint8_t slot = VENDOR_IN_SLOT(hvnd->In[pipe].Tail);
+
+    (void) USBD_LL_Transmit(pdev, VENDOR_PIPE_IN_EP(pipe),
+            hvnd->In[pipe].Buffer[slot], hvnd->In[pipe].Length[slot]);
+}
+
+/**
+ * @brief  Sets the vendor user interface to the handler
+ * @param  pdev: device instance
+ * @param  fops: vendor Interface callbacks
+ * @retval status
+ */
+uint8_t USBD_VENDOR_RegisterInterface(USBD_HandleTypeDef *pdev, const USBD_VENDOR_ItfTypeDef *fops)
+{
+    uint8_t ret = USBD_FAIL;
+
+    if (fops != NULL)
+    {
+        pdev->pUserData = (void*)fops;
+        ret = USBD_OK;
+    }
+
+    return ret;
+}
+
+/**
+ * @brief  Queues user data for transmission through the pipe IN endpoint.
+ *         The queued buffers are transmitted back-to-back, each as a separate transfer,
+ *         and the buffer is returned by the Transmitted callback.
+ * @note   Must not be called from a context that can preempt the USB interrupt.
+ * @param  pdev: device instance
+ * @param  pipe: pipe index
+ * @param  pbuff: Tx Buffer, which shall remain valid until it is transmitted
+ * @param  length: Tx data length
+ * @retval USBD_BUSY if the queue of the pipe is full, otherwise USBD_OK
+ */
+uint8_t USBD_VENDOR_Transmit(USBD_HandleTypeDef *pdev, uint8_t pipe, uint8_t *pbuff, uint16_t length)
+{
+    uint8_t retval = USBD_FAIL;
+
+    if ((pdev->pClassData != NULL) && (pipe < VENDOR_PIPE_COUNT))
+    {
+        USBD_VENDOR_HandleTypeDef *hvnd = VENDOR_HANDLE(pdev);
+        uint8_t head = hvnd->In[pipe].Head;
+
+        retval = USBD_BUSY;
+
+        if ((uint8_t)(head - hvnd->In[pipe].Tail) < VENDOR_IN_QUEUE_SIZE)
+        {
+            hvnd->In[pipe].Buffer[VENDOR_IN_SLOT(head)] = pbuff;
+            hvnd->In[pipe].Length[VENDOR_IN_SLOT(head)] = length;
+            hvnd->In[pipe].Head = head + 1;
+
+            /* An idle endpoint is started here, otherwise the DataIn stage continues */
+            if (hvnd->In[pipe].Busy == 0)
+            {
+                hvnd->In[pipe].Busy = 1;
+                USBD_VENDOR_InStart(pdev, pipe);
+            }
+            retval = USBD_OK;
+        }
+    }
+    return retval;
+}
+
+/**
+ * @brief  Provides the oldest filled buffer of the pipe OUT pool
+ * @param  pdev: device instance
+ * @param  pipe: pipe index
+ * @param  length: pointer to the received data length in the buffer
+ * @retval Pointer to the received data, or NULL if no buffer is filled
+ */
+uint8_t *USBD_VENDOR_GetRxBuffer(USBD_HandleTypeDef *pdev, uint8_t pipe, uint16_t *length)
+{
+    uint8_t *pbuff = NULL;
+
+    if ((pdev->pClassData != NULL) && (pipe < VENDOR_PIPE_COUNT))
+    {
+        USBD_VENDOR_HandleTypeDef *hvnd = VENDOR_HANDLE(pdev);
+
+        if ((hvnd->Out[pipe].Tail != hvnd->Out[pipe].Head) || (hvnd->Out[pipe].Held != 0))
+        {
+            pbuff   = (uint8_t *) hvnd->Out[pipe].Data[hvnd->Out[pipe].Tail];
+            *length = hvnd->Out[pipe].Length[hvnd->Out[pipe].Tail];
+        }
+    }
+    return pbuff;
+}
+
+/**
+ * @brief  Returns the oldest filled buffer to the pipe OUT pool after it has been processed
+ * @note   Must not be called from a context that can preempt the USB interrupt.
+ * @param  pdev: device instance
+ * @param  pipe: pipe index
+ * @retval USBD_FAIL if no buffer is filled, otherwise USBD_OK
+ */
+uint8_t USBD_VENDOR_ReleaseRxBuffer(USBD_HandleTypeDef *pdev, uint8_t pipe)
+{
+    uint8_t retval = USBD_FAIL;
+
+    if ((pdev->pClassData != NULL) && (pipe < VENDOR_PIPE_COUNT))
+    {
+        USBD_VENDOR_HandleTypeDef *hvnd = VENDOR_HANDLE(pdev);
+
+        if ((hvnd->Out[pipe].Tail != hvnd->Out[pipe].Head) || (hvnd->Out[pipe].Held != 0))
+        {
+            hvnd->Out[pipe].Tail = (hvnd->Out[pipe].Tail + 1) % VENDOR_OUT_BUFFER_COUNT;
+
+            /* Resume the held reception to the released buffer */
+            if (hvnd->Out[pipe].Held != 0)
+            {
+                hvnd->Out[pipe].Held = 0;
+                USBD_VENDOR_PoolReceive(pdev, pipe);
+            }
+            retval = USBD_OK;
+        }
+    }
+    return retval;
+}
+
+/** @} */
+
+/** @} */
+
+/** @} */
@@ -92,6 +92,7 @@ USBD_StatusTypeDef USBD_Init(USBD_HandleTypeDef *pdev, USBD_DescriptorsTypeDef *
 USBD_StatusTypeDef USBD_DeInit(USBD_HandleTypeDef *pdev);
 USBD_StatusTypeDef USBD_Start  (USBD_HandleTypeDef *pdev);
 USBD_StatusTypeDef USBD_Stop   (USBD_HandleTypeDef *pdev);
+uint32_t           USBD_Poll   (USBD_HandleTypeDef *pdev, uint32_t maxPackets);
 USBD_StatusTypeDef USBD_RegisterClass(USBD_HandleTypeDef *pdev, USBD_ClassTypeDef *pclass);
 
 USBD_StatusTypeDef USBD_RunTestMode (USBD_HandleTypeDef  *pdev); 
@@ -127,6 +128,9 @@ USBD_StatusTypeDef  USBD_LL_Start(USBD_HandleTypeDef *pdev);
 #ifndef             USBD_LL_Stop
 USBD_StatusTypeDef  USBD_LL_Stop (USBD_HandleTypeDef *pdev);
 #endif
+#ifndef             USBD_LL_Poll
+uint32_t            USBD_LL_Poll (USBD_HandleTypeDef *pdev, uint32_t maxPackets);
+#endif
 #ifndef             USBD_LL_OpenEP
 USBD_StatusTypeDef  USBD_LL_OpenEP  (USBD_HandleTypeDef *pdev, 
                                       uint8_t  ep_addr,
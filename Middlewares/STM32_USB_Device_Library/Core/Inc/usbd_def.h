@@ -36,6 +36,12 @@
 /* Includes ------------------------------------------------------------------*/
 #include "usbd_conf.h"
 
+/* The device provides a BOS descriptor, which is required for the LPM
+ * and the platform (e.g. Microsoft OS 2.0) capabilities */
+#ifndef USBD_BOS_ENABLED
+#define USBD_BOS_ENABLED     USBD_LPM_ENABLED
+#endif
+
 /** @addtogroup STM32_USBD_DEVICE_LIBRARY
   * @{
   */
@@ -99,6 +105,7 @@
 #define  USB_DESC_TYPE_ENDPOINT                            5
 #define  USB_DESC_TYPE_DEVICE_QUALIFIER                    6
 #define  USB_DESC_TYPE_OTHER_SPEED_CONFIGURATION           7
+#define  USB_DESC_TYPE_IAD                                 0x0B
 #define  USB_DESC_TYPE_BOS                                 0x0F
 
 #define USB_CONFIG_REMOTE_WAKEUP                           2
@@ -206,7 +213,7 @@ typedef struct
   uint8_t  *(*GetSerialStrDescriptor)( USBD_SpeedTypeDef speed , uint16_t *length);  
   uint8_t  *(*GetConfigurationStrDescriptor)( USBD_SpeedTypeDef speed , uint16_t *length);  
   uint8_t  *(*GetInterfaceStrDescriptor)( USBD_SpeedTypeDef speed , uint16_t *length); 
-#if (USBD_LPM_ENABLED == 1)
+#if (USBD_BOS_ENABLED == 1)
   uint8_t  *(*GetBOSDescriptor)( USBD_SpeedTypeDef speed , uint16_t *length); 
 #endif  
 } USBD_DescriptorsTypeDef;
@@ -260,6 +267,15 @@ typedef struct _USBD_HandleTypeDef
 #define MIN(a, b)  (((a) < (b)) ? (a) : (b))
 #define MAX(a, b)  (((a) > (b)) ? (a) : (b))
 
+/* Defines a string descriptor in flash, the ASCII string literal STR
+ * is encoded to UTF-16LE at build time, so it can be transmitted without conversion */
+#define USBD_STRING_DESC(NAME, STR)                                         \
+    __ALIGN_BEGIN static const struct {                                     \
+        uint8_t  bLength;                                                   \
+        uint8_t  bDescriptorType;                                           \
+        uint16_t wString[sizeof(STR) - 1];                                  \
+    } NAME __ALIGN_END = { sizeof(NAME), USB_DESC_TYPE_STRING, { u"" STR } }
+
 
 #if  defined ( __GNUC__ )
   #ifndef __weak
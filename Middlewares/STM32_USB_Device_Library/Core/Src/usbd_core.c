@@ -200,6 +200,19 @@ USBD_StatusTypeDef USBD_Stop(USBD_HandleTypeDef *pdev)
     return USBD_LL_Stop(pdev);
 }
 
+/**
+  * @brief  USBD_Poll 
+  *         Service the USB Device Core without the USB interrupt.
+  * @param  pdev: Device Handle
+  * @param  maxPackets: maximum number of packets to process in this call
+  * @retval Number of processed packets
+  */
+uint32_t USBD_Poll(USBD_HandleTypeDef *pdev, uint32_t maxPackets)
+{
+    /* Process the pending events of the low level driver */
+    return USBD_LL_Poll(pdev, maxPackets);
+}
+
 /**
 * @brief  USBD_SetClassConfig 
 *        Configure device and start the interface
@@ -469,6 +482,13 @@ USBD_StatusTypeDef USBD_LL_SOF(USBD_HandleTypeDef *pdev)
 */
 USBD_StatusTypeDef USBD_LL_IsoINIncomplete(USBD_HandleTypeDef *pdev, uint8_t epnum)
 {
+    if (pdev->dev_state == USBD_STATE_CONFIGURED)
+    {
+        if (pdev->pClass->IsoINIncomplete != NULL)
+        {
+            pdev->pClass->IsoINIncomplete(pdev, epnum);
+        }
+    }
     return USBD_OK;
 }
 
@@ -480,6 +500,13 @@ USBD_StatusTypeDef USBD_LL_IsoINIncomplete(USBD_HandleTypeDef *pdev, uint8_t epn
 */
 USBD_StatusTypeDef USBD_LL_IsoOUTIncomplete(USBD_HandleTypeDef *pdev, uint8_t epnum)
 {
+    if (pdev->dev_state == USBD_STATE_CONFIGURED)
+    {
+        if (pdev->pClass->IsoOUTIncomplete != NULL)
+        {
+            pdev->pClass->IsoOUTIncomplete(pdev, epnum);
+        }
+    }
     return USBD_OK;
 }
 
@@ -120,6 +120,21 @@ USBD_StatusTypeDef USBD_StdDevReq(USBD_HandleTypeDef *pdev, USBD_SetupReqTypedef
 {
     USBD_StatusTypeDef ret = USBD_OK;
 
+    /* Class and vendor specific device requests (e.g. the Microsoft OS descriptor request)
+     * are handled by the class */
+    if ((req->bmRequest & USB_REQ_TYPE_MASK) != USB_REQ_TYPE_STANDARD)
+    {
+        if (pdev->pClass->Setup(pdev, req) != USBD_OK)
+        {
+            USBD_CtlError(pdev, req);
+        }
+        else if (req->wLength == 0)
+        {
+            USBD_CtlSendStatus(pdev);
+        }
+        return ret;
+    }
+
     switch (req->bRequest)
     {
         case USB_REQ_GET_DESCRIPTOR:
@@ -323,7 +338,7 @@ static void USBD_GetDescriptor(USBD_HandleTypeDef *pdev, USBD_SetupReqTypedef *r
 
     switch (req->wValue >> 8)
     {
-#if (USBD_LPM_ENABLED == 1)
+#if (USBD_BOS_ENABLED == 1)
         case USB_DESC_TYPE_BOS:
             pbuf = pdev->pDesc->GetBOSDescriptor(pdev->dev_speed, &len);
             break;
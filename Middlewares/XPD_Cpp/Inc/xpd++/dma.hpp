@@ -0,0 +1,237 @@
+/**
+  ******************************************************************************
+  * @file    dma.hpp
+  * @author  Benedek Kupper
+  * @version V0.1
+  * @date    2018-02-10
+  * @brief   STM32 eXtensible Peripheral Drivers C++ Facade DMA Module
+  *
+  *  This file is part of STM32_XPD.
+  *
+  *  STM32_XPD is free software: you can redistribute it and/or modify
+  *  it under the terms of the GNU General Public License as published by
+  *  the Free Software Foundation, either version 3 of the License, or
+  *  (at your option) any later version.
+  *
+  *  STM32_XPD is distributed in the hope that it will be useful,
+  *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with STM32_XPD.  If not, see <http://www.gnu.org/licenses/>.
+  */
+#ifndef __XPDXX_DMA_HPP_
+#define __XPDXX_DMA_HPP_
+
+#include <xpd++/xpd.hpp>
+#include <xpd_dma.h>
+
+namespace xpd
+{
+/** @addtogroup XPD_Cpp
+ * @{ */
+
+/** @brief DMA stream / channel handle wrapper */
+class dma
+{
+public:
+    /** @brief Scoped DMA transfer: the transfer is stopped when the object is destroyed
+     *         while the DMA is still running. */
+    class transfer
+    {
+    public:
+        transfer() = default;
+
+        /**
+         * @brief Starts a DMA transfer with interrupts.
+         * @param d: the DMA to use
+         * @param periph: the peripheral side address
+         * @param mem: the memory side address
+         * @param count: the number of data transfers
+         */
+        transfer(dma & d, void * periph, void * mem, uint16_t count)
+            : dma_(&d.handle_),
+              result_(XPD_DMA_Start_IT(&d.handle_, periph, mem, count))
+        {
+            if (result_ != XPD_OK)
+            {
+                dma_ = nullptr;
+            }
+        }
+
+        transfer(const transfer &) = delete;
+        transfer & operator=(const transfer &) = delete;
+
+        transfer(transfer && other) noexcept
+            : dma_(other.dma_), result_(other.result_)
+        {
+            other.dma_ = nullptr;
+        }
+
+        transfer & operator=(transfer && other) noexcept
+        {
+            if (this != &other)
+            {
+                stop();
+                dma_ = other.dma_;
+                result_ = other.result_;
+                other.dma_ = nullptr;
+            }
+            return *this;
+        }
+
+        ~transfer()
+        {
+            stop();
+        }
+
+        /** @brief The transfer has been started successfully */
+        explicit operator bool() const
+        {
+            return dma_ != nullptr;
+        }
+
+        /** @brief The result of the transfer start */
+        xpd::result result() const
+        {
+            return result_;
+        }
+
+        /** @brief The number of transfers left until completion */
+        uint16_t remaining() const
+        {
+            return (dma_ != nullptr) ? XPD_DMA_GetStatus(dma_) : 0;
+        }
+
+        /** @brief The transfer is no longer running */
+        bool done() const
+        {
+            return remaining() == 0;
+        }
+
+        /**
+         * @brief Polls the transfer completion.
+         * @param timeout: the timeout in ms
+         * @return The result of @ref XPD_DMA_PollStatus
+         */
+        xpd::result wait(uint32_t timeout)
+        {
+            return (dma_ != nullptr) ?
+                    XPD_DMA_PollStatus(dma_, DMA_OPERATION_TRANSFER, timeout) : result_;
+        }
+
+        /** @brief Stops the transfer if it is still running */
+        void stop()
+        {
+            if ((dma_ != nullptr) && (XPD_DMA_GetStatus(dma_) != 0))
+            {
+                XPD_DMA_Stop_IT(dma_);
+            }
+            dma_ = nullptr;
+        }
+
+        /** @brief Lets the transfer run on after the object is destroyed */
+        void release()
+        {
+            dma_ = nullptr;
+        }
+
+    private:
+        DMA_HandleType * dma_ = nullptr;
+        xpd::result result_ = XPD_ERROR;
+    };
+
+#if defined(DMA_Stream_BB)
+    using instance = DMA_Stream_TypeDef;
+#else
+    using instance = DMA_Channel_TypeDef;
+#endif
+
+    /**
+     * @brief Constructs the wrapper of a DMA stream / channel.
+     * @param inst: the DMA stream / channel instance
+     */
+    explicit dma(instance * inst)
+        : handle_()
+    {
+        handle_.Inst = inst;
+#if defined(DMA_Stream_BB)
+        handle_.Inst_BB = DMA_Stream_BB(inst);
+#elif defined(DMA_BB)
+        handle_.Inst_BB = DMA_Channel_BB(inst);
+#endif
+    }
+
+    dma(const dma &) = delete;
+    dma & operator=(const dma &) = delete;
+
+    /** @brief The C driver handle */
+    DMA_HandleType * handle()
+    {
+        return &handle_;
+    }
+
+    xpd::result init(const DMA_InitType & config)
+    {
+        return XPD_DMA_Init(&handle_, &config);
+    }
+
+    xpd::result deinit()
+    {
+        return XPD_DMA_Deinit(&handle_);
+    }
+
+    /**
+     * @brief Starts a scoped transfer.
+     * @param periph: the peripheral side address
+     * @param mem: the memory side address
+     * @param count: the number of data transfers
+     * @return The transfer, which stops the DMA when destroyed while running
+     */
+    transfer start(void * periph, void * mem, uint16_t count)
+    {
+        return transfer(*this, periph, mem, count);
+    }
+
+    /** @brief The interrupt handler of the stream / channel */
+    void irq_handler()
+    {
+        XPD_DMA_IRQHandler(&handle_);
+    }
+
+    /** @brief Binds the transfer complete callback */
+    template<auto Fn>
+    void on_complete()
+    {
+        handle_.Callbacks.Complete = &detail::callback<dma, Fn>;
+    }
+
+    /** @brief Binds the half transfer complete callback */
+    template<auto Fn>
+    void on_half_complete()
+    {
+        handle_.Callbacks.HalfComplete = &detail::callback<dma, Fn>;
+    }
+
+#ifdef USE_XPD_DMA_ERROR_DETECT
+    /** @brief Binds the transfer error callback */
+    template<auto Fn>
+    void on_error()
+    {
+        handle_.Callbacks.Error = &detail::callback<dma, Fn>;
+    }
+#endif
+
+private:
+    DMA_HandleType handle_;
+};
+
+static_assert(detail::is_handle_wrapper<dma, DMA_HandleType>(),
+        "The DMA wrapper must only contain the handle");
+
+/** @} */
+
+} /* namespace xpd */
+
+#endif /* __XPDXX_DMA_HPP_ */
@@ -0,0 +1,221 @@
+/**
+  ******************************************************************************
+  * @file    spi.hpp
+  * @author  Benedek Kupper
+  * @version V0.1
+  * @date    2018-02-10
+  * @brief   STM32 eXtensible Peripheral Drivers C++ Facade SPI Module
+  *
+  *  This file is part of STM32_XPD.
+  *
+  *  STM32_XPD is free software: you can redistribute it and/or modify
+  *  it under the terms of the GNU General Public License as published by
+  *  the Free Software Foundation, either version 3 of the License, or
+  *  (at your option) any later version.
+  *
+  *  STM32_XPD is distributed in the hope that it will be useful,
+  *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with STM32_XPD.  If not, see <http://www.gnu.org/licenses/>.
+  */
+#ifndef __XPDXX_SPI_HPP_
+#define __XPDXX_SPI_HPP_
+
+#include <xpd++/xpd.hpp>
+#include <xpd++/dma.hpp>
+#include <xpd_spi.h>
+
+namespace xpd
+{
+/** @addtogroup XPD_Cpp
+ * @{ */
+
+/** @brief SPI handle wrapper */
+class spi
+{
+public:
+    /**
+     * @brief Calculates the serial clock prescaler at compile time.
+     * @param pclk: the kernel clock frequency of the SPI
+     * @param max_hz: the highest serial clock frequency supported by the slave
+     * @return The smallest prescaler which doesn't exceed the frequency limit,
+     *         or CLK_DIV1 if no prescaler can satisfy it
+     */
+    static constexpr ClockDividerType prescaler(uint32_t pclk, uint32_t max_hz)
+    {
+        for (uint32_t div = CLK_DIV2; div <= CLK_DIV256; div++)
+        {
+            if ((pclk >> div) <= max_hz)
+            {
+                return static_cast<ClockDividerType>(div);
+            }
+        }
+        return CLK_DIV1;
+    }
+
+    /**
+     * @brief Calculates the serial clock prescaler at compile time,
+     *        failing the build if the frequency limit can't be satisfied.
+     * @tparam Pclk: the kernel clock frequency of the SPI
+     * @tparam MaxHz: the highest serial clock frequency supported by the slave
+     * @return The smallest prescaler which doesn't exceed the frequency limit
+     */
+    template<uint32_t Pclk, uint32_t MaxHz>
+    static constexpr ClockDividerType prescaler()
+    {
+        constexpr ClockDividerType div = prescaler(Pclk, MaxHz);
+        static_assert(div != CLK_DIV1, "The serial clock can't be slowed down to the limit");
+        return div;
+    }
+
+    /**
+     * @brief Constructs the wrapper of an SPI instance.
+     * @param inst: the SPI instance
+     * @param clock: the RCC clock control function of the instance, e.g. XPD_SPI1_ClockCtrl
+     */
+    spi(SPI_TypeDef * inst, XPD_CtrlFnType clock)
+        : handle_()
+    {
+        handle_.Inst = inst;
+#ifdef SPI_BB
+        handle_.Inst_BB = SPI_BB(inst);
+#endif
+        handle_.ClockCtrl = clock;
+    }
+
+    spi(const spi &) = delete;
+    spi & operator=(const spi &) = delete;
+
+    /** @brief The C driver handle */
+    SPI_HandleType * handle()
+    {
+        return &handle_;
+    }
+
+    xpd::result init(const SPI_InitType & config)
+    {
+        return XPD_SPI_Init(&handle_, &config);
+    }
+
+    xpd::result deinit()
+    {
+        return XPD_SPI_Deinit(&handle_);
+    }
+
+    /** @brief Recalculates the clock dependent settings after a clock change */
+    void clock_update()
+    {
+        XPD_SPI_ClockUpdate(&handle_);
+    }
+
+    void transmit_it(void * data, uint16_t length)
+    {
+        XPD_SPI_Transmit_IT(&handle_, data, length);
+    }
+
+    void receive_it(void * data, uint16_t length)
+    {
+        XPD_SPI_Receive_IT(&handle_, data, length);
+    }
+
+    /**
+     * @brief Queues a transaction with a slave.
+     * @param transaction: the transaction, which has to remain valid until it is completed
+     * @return The result of @ref XPD_SPI_Queue_Submit
+     */
+    xpd::result submit(SPI_TransactionType & transaction)
+    {
+        return XPD_SPI_Queue_Submit(&handle_, &transaction);
+    }
+
+#ifndef XPD_SPI_EXCLUDE_DMA
+    /**
+     * @brief Sets the DMA streams / channels used by the SPI.
+     * @param tx: the transmit DMA (nullptr if not used)
+     * @param rx: the receive DMA (nullptr if not used)
+     */
+    void link_dma(dma * tx, dma * rx)
+    {
+        handle_.DMA.Transmit = (tx != nullptr) ? tx->handle() : nullptr;
+        handle_.DMA.Receive  = (rx != nullptr) ? rx->handle() : nullptr;
+    }
+
+    xpd::result transmit_dma(void * data, uint16_t length)
+    {
+        return XPD_SPI_Transmit_DMA(&handle_, data, length);
+    }
+
+    xpd::result receive_dma(void * data, uint16_t length)
+    {
+        return XPD_SPI_Receive_DMA(&handle_, data, length);
+    }
+
+    xpd::result transmit_receive_dma(void * tx_data, void * rx_data, uint16_t length)
+    {
+        return XPD_SPI_TransmitReceive_DMA(&handle_, tx_data, rx_data, length);
+    }
+
+    void stop_dma()
+    {
+        XPD_SPI_Stop_DMA(&handle_);
+    }
+#endif
+
+    /** @brief The interrupt handler of the SPI */
+    void irq_handler()
+    {
+        XPD_SPI_IRQHandler(&handle_);
+    }
+
+    /** @brief Binds the dependency initialization callback (GPIOs, IRQs, DMAs) */
+    template<auto Fn>
+    void on_dep_init()
+    {
+        handle_.Callbacks.DepInit = &detail::callback<spi, Fn>;
+    }
+
+    /** @brief Binds the dependency deinitialization callback */
+    template<auto Fn>
+    void on_dep_deinit()
+    {
+        handle_.Callbacks.DepDeinit = &detail::callback<spi, Fn>;
+    }
+
+    /** @brief Binds the transmission complete callback */
+    template<auto Fn>
+    void on_transmit()
+    {
+        handle_.Callbacks.Transmit = &detail::callback<spi, Fn>;
+    }
+
+    /** @brief Binds the reception complete callback */
+    template<auto Fn>
+    void on_receive()
+    {
+        handle_.Callbacks.Receive = &detail::callback<spi, Fn>;
+    }
+
+#if defined(USE_XPD_SPI_ERROR_DETECT) || defined(USE_XPD_DMA_ERROR_DETECT)
+    /** @brief Binds the error callback */
+    template<auto Fn>
+    void on_error()
+    {
+        handle_.Callbacks.Error = &detail::callback<spi, Fn>;
+    }
+#endif
+
+private:
+    SPI_HandleType handle_;
+};
+
+static_assert(detail::is_handle_wrapper<spi, SPI_HandleType>(),
+        "The SPI wrapper must only contain the handle");
+
+/** @} */
+
+} /* namespace xpd */
+
+#endif /* __XPDXX_SPI_HPP_ */
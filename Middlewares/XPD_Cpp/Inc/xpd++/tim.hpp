@@ -0,0 +1,246 @@
+/**
+  ******************************************************************************
+  * @file    tim.hpp
+  * @author  Benedek Kupper
+  * @version V0.1
+  * @date    2018-02-10
+  * @brief   STM32 eXtensible Peripheral Drivers C++ Facade TIM Module
+  *
+  *  This file is part of STM32_XPD.
+  *
+  *  STM32_XPD is free software: you can redistribute it and/or modify
+  *  it under the terms of the GNU General Public License as published by
+  *  the Free Software Foundation, either version 3 of the License, or
+  *  (at your option) any later version.
+  *
+  *  STM32_XPD is distributed in the hope that it will be useful,
+  *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with STM32_XPD.  If not, see <http://www.gnu.org/licenses/>.
+  */
+#ifndef __XPDXX_TIM_HPP_
+#define __XPDXX_TIM_HPP_
+
+#include <xpd++/xpd.hpp>
+#include <xpd_tim.h>
+
+namespace xpd
+{
+/** @addtogroup XPD_Cpp
+ * @{ */
+
+/** @brief TIM handle wrapper */
+class tim
+{
+public:
+    /** @brief The number of prescaler settings of every timer */
+    static constexpr uint32_t max_prescaler = 0x10000;
+
+    /**
+     * @brief Calculates the counter setup of an update frequency at compile time.
+     * @param clk: the counter clock frequency of the timer
+     * @param hz: the requested update frequency
+     * @param mode: the counter mode
+     * @param max_period: the number of counter values, 0x10000 for 16 bit timers
+     * @return The counter setup with the smallest prescaler (for the best resolution)
+     *         at which the period fits the counter; the Prescaler is 0 if the frequency
+     *         can't be generated
+     */
+    static constexpr TIM_Counter_InitType timebase(uint32_t clk, uint32_t hz,
+            TIM_CounterType mode = TIM_COUNTER_UP, uint32_t max_period = 0x10000)
+    {
+        TIM_Counter_InitType config = {};
+        uint64_t ticks = (hz == 0) ? 0 : ((static_cast<uint64_t>(clk) + (hz / 2)) / hz);
+        uint64_t prescaler = (ticks + max_period - 1) / max_period;
+
+        if (prescaler == 0)
+        {
+            prescaler = 1;
+        }
+        if ((ticks != 0) && (prescaler <= max_prescaler))
+        {
+            uint64_t step   = prescaler * hz;
+            uint64_t period = (clk + (step / 2)) / step;
+
+            if ((period > 0) && (period <= max_period))
+            {
+                config.Prescaler = static_cast<uint32_t>(prescaler);
+                config.Period    = static_cast<uint32_t>(period);
+            }
+        }
+        config.Mode = mode;
+        config.ClockDivision = CLK_DIV1;
+        return config;
+    }
+
+    /**
+     * @brief Calculates the counter setup of an update frequency at compile time,
+     *        failing the build if the frequency can't be generated.
+     * @tparam Clk: the counter clock frequency of the timer
+     * @tparam Hz: the requested update frequency
+     * @tparam MaxPeriod: the number of counter values, 0x10000 for 16 bit timers
+     * @return The counter setup
+     */
+    template<uint32_t Clk, uint32_t Hz, uint32_t MaxPeriod = 0x10000>
+    static constexpr TIM_Counter_InitType timebase(TIM_CounterType mode = TIM_COUNTER_UP)
+    {
+        static_assert(timebase(Clk, Hz, TIM_COUNTER_UP, MaxPeriod).Prescaler != 0,
+                "The update frequency can't be generated from the timer clock");
+        return timebase(Clk, Hz, mode, MaxPeriod);
+    }
+
+    /**
+     * @brief Constructs the wrapper of a timer instance.
+     * @param inst: the TIM instance
+     * @param clock: the RCC clock control function of the instance, e.g. XPD_TIM2_ClockCtrl
+     */
+    tim(TIM_TypeDef * inst, XPD_CtrlFnType clock)
+        : handle_()
+    {
+        handle_.Inst = inst;
+#ifdef TIM_BB
+        handle_.Inst_BB = TIM_BB(inst);
+#endif
+        handle_.ClockCtrl = clock;
+    }
+
+    tim(const tim &) = delete;
+    tim & operator=(const tim &) = delete;
+
+    /** @brief The C driver handle */
+    TIM_HandleType * handle()
+    {
+        return &handle_;
+    }
+
+    xpd::result init(const TIM_Counter_InitType & config)
+    {
+        return XPD_TIM_Init(&handle_, &config);
+    }
+
+    xpd::result deinit()
+    {
+        return XPD_TIM_Deinit(&handle_);
+    }
+
+    /** @brief Starts the counter with the update interrupt */
+    void start_it()
+    {
+        XPD_TIM_Counter_Start_IT(&handle_);
+    }
+
+    /** @brief Stops the counter and its update interrupt */
+    void stop_it()
+    {
+        XPD_TIM_Counter_Stop_IT(&handle_);
+    }
+
+    /** @brief Starts a capture / compare channel with its interrupt */
+    void channel_start_it(TIM_ChannelType channel)
+    {
+        XPD_TIM_Channel_Start_IT(&handle_, channel);
+    }
+
+    /** @brief Stops a capture / compare channel and its interrupt */
+    void channel_stop_it(TIM_ChannelType channel)
+    {
+        XPD_TIM_Channel_Stop_IT(&handle_, channel);
+    }
+
+    /** @brief The channel which raised the ongoing channel event */
+    TIM_ChannelType active_channel() const
+    {
+        return handle_.ActiveChannel;
+    }
+
+    /** @brief The shared interrupt handler of the timer */
+    void irq_handler()
+    {
+        XPD_TIM_IRQHandler(&handle_);
+    }
+
+    /** @brief The update interrupt handler of the timer */
+    void up_irq_handler()
+    {
+        XPD_TIM_UP_IRQHandler(&handle_);
+    }
+
+    /** @brief The capture / compare interrupt handler of the timer */
+    void cc_irq_handler()
+    {
+        XPD_TIM_CC_IRQHandler(&handle_);
+    }
+
+    /** @brief Binds the dependency initialization callback (GPIOs, IRQs, DMAs) */
+    template<auto Fn>
+    void on_dep_init()
+    {
+        handle_.Callbacks.DepInit = &detail::callback<tim, Fn>;
+    }
+
+    /** @brief Binds the dependency deinitialization callback */
+    template<auto Fn>
+    void on_dep_deinit()
+    {
+        handle_.Callbacks.DepDeinit = &detail::callback<tim, Fn>;
+    }
+
+    /** @brief Binds the counter update callback */
+    template<auto Fn>
+    void on_update()
+    {
+        handle_.Callbacks.Update = &detail::callback<tim, Fn>;
+    }
+
+    /** @brief Binds the capture / compare callback, see @ref active_channel */
+    template<auto Fn>
+    void on_channel_event()
+    {
+        handle_.Callbacks.ChannelEvent = &detail::callback<tim, Fn>;
+    }
+
+    /** @brief Binds the trigger callback */
+    template<auto Fn>
+    void on_trigger()
+    {
+        handle_.Callbacks.Trigger = &detail::callback<tim, Fn>;
+    }
+
+    /** @brief Binds the commutation callback */
+    template<auto Fn>
+    void on_commutation()
+    {
+        handle_.Callbacks.Commutation = &detail::callback<tim, Fn>;
+    }
+
+    /** @brief Binds the break callback */
+    template<auto Fn>
+    void on_break()
+    {
+        handle_.Callbacks.Break = &detail::callback<tim, Fn>;
+    }
+
+#ifdef USE_XPD_DMA_ERROR_DETECT
+    /** @brief Binds the DMA error callback */
+    template<auto Fn>
+    void on_error()
+    {
+        handle_.Callbacks.Error = &detail::callback<tim, Fn>;
+    }
+#endif
+
+private:
+    TIM_HandleType handle_;
+};
+
+static_assert(detail::is_handle_wrapper<tim, TIM_HandleType>(),
+        "The TIM wrapper must only contain the handle");
+
+/** @} */
+
+} /* namespace xpd */
+
+#endif /* __XPDXX_TIM_HPP_ */
@@ -0,0 +1,280 @@
+/**
+  ******************************************************************************
+  * @file    usart.hpp
+  * @author  Benedek Kupper
+  * @version V0.1
+  * @date    2018-02-10
+  * @brief   STM32 eXtensible Peripheral Drivers C++ Facade USART Module
+  *
+  *  This file is part of STM32_XPD.
+  *
+  *  STM32_XPD is free software: you can redistribute it and/or modify
+  *  it under the terms of the GNU General Public License as published by
+  *  the Free Software Foundation, either version 3 of the License, or
+  *  (at your option) any later version.
+  *
+  *  STM32_XPD is distributed in the hope that it will be useful,
+  *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with STM32_XPD.  If not, see <http://www.gnu.org/licenses/>.
+  */
+#ifndef __XPDXX_USART_HPP_
+#define __XPDXX_USART_HPP_
+
+#include <xpd++/xpd.hpp>
+#include <xpd++/dma.hpp>
+#include <xpd_usart.h>
+
+namespace xpd
+{
+/** @addtogroup XPD_Cpp
+ * @{ */
+
+/** @brief USART handle wrapper */
+class usart
+{
+public:
+    /**
+     * @brief Calculates the BRR register value of a USART (not LPUART) at compile time.
+     * @param pclk: the kernel clock frequency of the USART
+     * @param baud: the requested baud rate
+     * @param over8: the over sampling 8 mode is used
+     * @return The BRR register value
+     */
+    static constexpr uint32_t brr(uint32_t pclk, uint32_t baud, bool over8 = false)
+    {
+#if (USART_PERIPHERAL_VERSION > 1)
+        if (!over8)
+        {
+            return (pclk + (baud / 2)) / baud;
+        }
+        else
+        {
+            uint32_t tmp = static_cast<uint32_t>(((2ULL * pclk) + (baud / 2)) / baud);
+            return (tmp & USART_BRR_DIV_MANTISSA) | ((tmp & USART_BRR_DIV_FRACTION) >> 1);
+        }
+#else
+        uint32_t div     = static_cast<uint32_t>((25ULL * pclk) / ((4 >> over8) * baud));
+        uint32_t divmant = div / 100;
+        uint32_t divfraq = ((div - (divmant * 100)) * (16 >> over8) + 50) / 100;
+
+        return ((divmant + (divfraq >> (4 - over8))) << 4) | (divfraq & (0xf >> over8));
+#endif
+    }
+
+    /**
+     * @brief Calculates the baud rate which results from a BRR register value.
+     * @param pclk: the kernel clock frequency of the USART
+     * @param brr: the BRR register value
+     * @param over8: the over sampling 8 mode is used
+     * @return The actual baud rate
+     */
+    static constexpr uint32_t baudrate(uint32_t pclk, uint32_t brr, bool over8 = false)
+    {
+#if (USART_PERIPHERAL_VERSION > 1)
+        uint32_t div = over8 ? ((brr & ~0xfUL) | ((brr & 0x7) << 1)) : brr;
+        return (div == 0) ? 0 : static_cast<uint32_t>(((over8 ? 2ULL : 1ULL) * pclk) / div);
+#else
+        uint32_t div = ((brr >> 4) * (16 >> over8)) + (brr & (0xf >> over8));
+        return (div == 0) ? 0 : (pclk / div);
+#endif
+    }
+
+    /**
+     * @brief Tells if the baud rate is achievable within 2% error at compile time.
+     * @param pclk: the kernel clock frequency of the USART
+     * @param baud: the requested baud rate
+     * @param over8: the over sampling 8 mode is used
+     * @return True if the BRR value is in range and the baud rate error is acceptable
+     */
+    static constexpr bool baudrate_valid(uint32_t pclk, uint32_t baud, bool over8 = false)
+    {
+        uint32_t div    = brr(pclk, baud, over8);
+        uint32_t actual = baudrate(pclk, div, over8);
+        uint32_t error  = (actual > baud) ? (actual - baud) : (baud - actual);
+
+        return (div >= 16) && (div <= 0xFFFF) && ((error * 50) <= baud);
+    }
+
+    /**
+     * @brief Constructs the wrapper of a USART instance.
+     * @param inst: the USART instance
+     * @param clock: the RCC clock control function of the instance, e.g. XPD_USART2_ClockCtrl
+     */
+    usart(USART_TypeDef * inst, XPD_CtrlFnType clock)
+        : handle_()
+    {
+        handle_.Inst = inst;
+#ifdef USART_BB
+        handle_.Inst_BB = USART_BB(inst);
+#endif
+        handle_.ClockCtrl = clock;
+    }
+
+    usart(const usart &) = delete;
+    usart & operator=(const usart &) = delete;
+
+    /** @brief The C driver handle */
+    USART_HandleType * handle()
+    {
+        return &handle_;
+    }
+
+    xpd::result init(const USART_InitType & common, const UART_InitType & config)
+    {
+        return XPD_UART_Init(&handle_, &common, &config);
+    }
+
+    xpd::result deinit()
+    {
+        return XPD_USART_Deinit(&handle_);
+    }
+
+    /**
+     * @brief Sets a compile time calculated baud rate.
+     * @note  The USART has to be initialized with the matching over sampling setting
+     *        and clock frequency. The baud rate is stored in the handle,
+     *        so @ref XPD_USART_ClockUpdate recalculates the divider after a clock change.
+     * @tparam Pclk: the kernel clock frequency of the USART
+     * @tparam Baud: the requested baud rate
+     * @tparam Over8: the over sampling 8 mode is used
+     */
+    template<uint32_t Pclk, uint32_t Baud, bool Over8 = false>
+    void set_baudrate()
+    {
+        static_assert(baudrate_valid(Pclk, Baud, Over8),
+                "The baud rate is not achievable within 2% error");
+        constexpr uint32_t div = brr(Pclk, Baud, Over8);
+
+        /* The divider can only be changed while the USART is disabled */
+        uint32_t cr1 = handle_.Inst->CR1.w;
+        handle_.Inst->CR1.w = cr1 & ~USART_CR1_UE;
+        handle_.Inst->BRR.w = div;
+        handle_.Inst->CR1.w = cr1;
+
+        handle_.BaudRate = Baud;
+    }
+
+    /** @brief Recalculates the baud rate divider after a clock change */
+    void clock_update()
+    {
+        XPD_USART_ClockUpdate(&handle_);
+    }
+
+    void transmit_it(void * data, uint16_t length)
+    {
+        XPD_USART_Transmit_IT(&handle_, data, length);
+    }
+
+    void receive_it(void * data, uint16_t length)
+    {
+        XPD_USART_Receive_IT(&handle_, data, length);
+    }
+
+#ifndef XPD_USART_EXCLUDE_DMA
+    /**
+     * @brief Sets the DMA streams / channels used by the USART.
+     * @param tx: the transmit DMA (nullptr if not used)
+     * @param rx: the receive DMA (nullptr if not used)
+     */
+    void link_dma(dma * tx, dma * rx)
+    {
+        handle_.DMA.Transmit = (tx != nullptr) ? tx->handle() : nullptr;
+        handle_.DMA.Receive  = (rx != nullptr) ? rx->handle() : nullptr;
+    }
+
+    xpd::result transmit_dma(void * data, uint16_t length)
+    {
+        return XPD_USART_Transmit_DMA(&handle_, data, length);
+    }
+
+    xpd::result receive_dma(void * data, uint16_t length)
+    {
+        return XPD_USART_Receive_DMA(&handle_, data, length);
+    }
+
+    void stop_dma()
+    {
+        XPD_USART_Stop_DMA(&handle_);
+    }
+#endif
+
+    /** @brief The interrupt handler of the USART */
+    void irq_handler()
+    {
+        XPD_USART_IRQHandler(&handle_);
+    }
+
+    /** @brief Binds the dependency initialization callback (GPIOs, IRQs, DMAs) */
+    template<auto Fn>
+    void on_dep_init()
+    {
+        handle_.Callbacks.DepInit = &detail::callback<usart, Fn>;
+    }
+
+    /** @brief Binds the dependency deinitialization callback */
+    template<auto Fn>
+    void on_dep_deinit()
+    {
+        handle_.Callbacks.DepDeinit = &detail::callback<usart, Fn>;
+    }
+
+    /** @brief Binds the transmission complete callback */
+    template<auto Fn>
+    void on_transmit()
+    {
+        handle_.Callbacks.Transmit = &detail::callback<usart, Fn>;
+    }
+
+    /** @brief Binds the reception complete callback */
+    template<auto Fn>
+    void on_receive()
+    {
+        handle_.Callbacks.Receive = &detail::callback<usart, Fn>;
+    }
+
+    /** @brief Binds the LIN break detection callback */
+    template<auto Fn>
+    void on_break()
+    {
+        handle_.Callbacks.Break = &detail::callback<usart, Fn>;
+    }
+
+    /** @brief Binds the idle line callback */
+    template<auto Fn>
+    void on_idle()
+    {
+        handle_.Callbacks.Idle = &detail::callback<usart, Fn>;
+    }
+
+    /** @brief Binds the clear to send callback */
+    template<auto Fn>
+    void on_clear_to_send()
+    {
+        handle_.Callbacks.ClearToSend = &detail::callback<usart, Fn>;
+    }
+
+#if defined(USE_XPD_USART_ERROR_DETECT) || defined(USE_XPD_DMA_ERROR_DETECT)
+    /** @brief Binds the error callback */
+    template<auto Fn>
+    void on_error()
+    {
+        handle_.Callbacks.Error = &detail::callback<usart, Fn>;
+    }
+#endif
+
+private:
+    USART_HandleType handle_;
+};
+
+static_assert(detail::is_handle_wrapper<usart, USART_HandleType>(),
+        "The USART wrapper must only contain the handle");
+
+/** @} */
+
+} /* namespace xpd */
+
+#endif /* __XPDXX_USART_HPP_ */
@@ -0,0 +1,123 @@
+/**
+  ******************************************************************************
+  * @file    xpd.hpp
+  * @author  Benedek Kupper
+  * @version V0.1
+  * @date    2018-02-10
+  * @brief   STM32 eXtensible Peripheral Drivers C++ Facade Common Definitions
+  *
+  *  This file is part of STM32_XPD.
+  *
+  *  STM32_XPD is free software: you can redistribute it and/or modify
+  *  it under the terms of the GNU General Public License as published by
+  *  the Free Software Foundation, either version 3 of the License, or
+  *  (at your option) any later version.
+  *
+  *  STM32_XPD is distributed in the hope that it will be useful,
+  *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with STM32_XPD.  If not, see <http://www.gnu.org/licenses/>.
+  */
+#ifndef __XPDXX_XPD_HPP_
+#define __XPDXX_XPD_HPP_
+
+#include <xpd_utils.h>
+#include <type_traits>
+
+/** @defgroup XPD_Cpp XPD C++ Facade
+ *  @brief    Header-only C++17 layer over the unchanged XPD C drivers
+ *  @details  Each wrapper class holds the C driver handle as its first member, so the
+ *            wrapper is recovered from the handle pointer that the driver passes to its callbacks.
+ *            The callbacks are bound as template arguments: the driver's callback slot
+ *            is set to a function instantiated for the bound callable, in which the user
+ *            code is called directly, so it can be inlined, and no casts are needed in
+ *            the application. The bound callable is either a member function of the wrapper
+ *            (or of a class derived from it), or a function / captureless constexpr lambda
+ *            taking the wrapper (or the derived class) by reference:
+ *  @code
+    class Console : public xpd::usart
+    {
+    public:
+        using xpd::usart::usart;
+        void received();
+        void transmitted();
+    };
+
+    Console console(USART2, XPD_USART2_ClockCtrl);
+
+    constexpr auto transmitted = [](Console & c) { c.transmitted(); };
+
+    void setup()
+    {
+        console.on_receive<&Console::received>();
+        console.on_transmit<+transmitted>();
+        console.set_baudrate<42000000, 115200>();
+    }
+
+    extern "C" void USART2_IRQHandler(void)
+    {
+        console.irq_handler();
+    }
+ *  @endcode
+ * @{ */
+
+namespace xpd
+{
+/** @brief Operation result type of the C drivers */
+using result = XPD_ReturnType;
+
+namespace detail
+{
+/* The class whose object the bound callable operates on */
+template<class T>
+struct callback_owner;
+
+template<class C>
+struct callback_owner<void (C::*)()>
+{
+    using type = C;
+};
+
+template<class C>
+struct callback_owner<void (*)(C &)>
+{
+    using type = C;
+};
+
+/* The C driver callback which calls the bound callable on the wrapper of the handle */
+template<class Wrapper, auto Fn>
+void callback(void * handle)
+{
+    using Owner = typename callback_owner<decltype(Fn)>::type;
+    static_assert(std::is_base_of<Wrapper, Owner>::value,
+            "The callback has to operate on the wrapper or on a class derived from it");
+
+    /* The handle is the first member of the standard layout wrapper */
+    Owner & owner = static_cast<Owner &>(*reinterpret_cast<Wrapper *>(handle));
+
+    if constexpr (std::is_member_function_pointer<decltype(Fn)>::value)
+    {
+        (owner.*Fn)();
+    }
+    else
+    {
+        Fn(owner);
+    }
+}
+
+/* Ensures that the handle can be converted to its wrapper */
+template<class Wrapper, class Handle>
+constexpr bool is_handle_wrapper()
+{
+    return std::is_standard_layout<Wrapper>::value && (sizeof(Wrapper) == sizeof(Handle));
+}
+} /* namespace detail */
+
+} /* namespace xpd */
+
+/** @} */
+
+#endif /* __XPDXX_XPD_HPP_ */
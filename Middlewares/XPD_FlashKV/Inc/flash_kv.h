@@ -0,0 +1,87 @@
+/**
+  ******************************************************************************
+  * @file    flash_kv.h
+  * @author  Benedek Kupper
+  * @version V0.1
+  * @date    2018-01-20
+  * @brief   STM32 eXtensible Peripheral Drivers Flash Key-Value Store
+  *
+  *  This file is part of STM32_XPD.
+  *
+  *  STM32_XPD is free software: you can redistribute it and/or modify
+  *  it under the terms of the GNU General Public License as published by
+  *  the Free Software Foundation, either version 3 of the License, or
+  *  (at your option) any later version.
+  *
+  *  STM32_XPD is distributed in the hope that it will be useful,
+  *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with STM32_XPD.  If not, see <http://www.gnu.org/licenses/>.
+  */
+#ifndef __FLASH_KV_H_
+#define __FLASH_KV_H_
+
+#include <xpd_flash.h>
+
+/** @defgroup FlashKV
+ * @{ */
+
+/** @defgroup FlashKV_Exported_Macros FlashKV Exported Macros
+ * @{ */
+
+#ifndef FLASHKV_ALIGN
+/** @brief Alignment of the records in bytes, multiple of the flash programming unit [overrideable] */
+#define FLASHKV_ALIGN               8
+#endif
+
+#ifndef FLASHKV_ERASE_THRESHOLD
+/** @brief Fill level of the active area in percents, when the spare area erasure starts [overrideable] */
+#define FLASHKV_ERASE_THRESHOLD     50
+#endif
+
+/** @} */
+
+/** @defgroup FlashKV_Exported_Types FlashKV Exported Types
+ * @{ */
+
+/** @brief Spare area states */
+typedef enum
+{
+    FLASHKV_SPARE_DIRTY   = 0, /*!< Spare area contains obsolete data */
+    FLASHKV_SPARE_ERASING = 1, /*!< Spare area is being erased in the background */
+    FLASHKV_SPARE_READY   = 2, /*!< Spare area is erased */
+}FlashKV_SpareType;
+
+/** @brief Flash key-value store handle structure */
+typedef struct
+{
+    uint8_t *   Area[2];                /*!< Start addresses of the two flash areas */
+    uint32_t    AreaSize;               /*!< Size of one area in bytes, multiple of the flash erase unit */
+    uint32_t *  Index;                  /*!< Offsets of the latest records of each key (KeyCount elements) */
+    uint16_t    KeyCount;               /*!< Number of keys, the valid keys are [0 .. KeyCount - 1] */
+    uint8_t     Active;                 /*!< [Internal] Index of the active area */
+    uint32_t    Sequence;               /*!< [Internal] Sequence number of the active area */
+    uint32_t    Offset;                 /*!< [Internal] Free space offset in the active area */
+    volatile FlashKV_SpareType Spare;   /*!< [Internal] State of the spare area */
+}FlashKV_HandleType;
+
+/** @} */
+
+/** @defgroup FlashKV_Exported_Functions FlashKV Exported Functions
+ * @{ */
+XPD_ReturnType  FlashKV_Init            (FlashKV_HandleType * hkv);
+
+const void *    FlashKV_Get             (FlashKV_HandleType * hkv, uint16_t Key, uint16_t * Length);
+XPD_ReturnType  FlashKV_Put             (FlashKV_HandleType * hkv, uint16_t Key,
+                                         const void * Data, uint16_t Length);
+XPD_ReturnType  FlashKV_Delete          (FlashKV_HandleType * hkv, uint16_t Key);
+
+XPD_ReturnType  FlashKV_Compact         (FlashKV_HandleType * hkv);
+/** @} */
+
+/** @} */
+
+#endif /* __FLASH_KV_H_ */
@@ -0,0 +1,513 @@
+/**
+  ******************************************************************************
+  * @file    flash_kv.c
+  * @author  Benedek Kupper
+  * @version V0.1
+  * @date    2018-01-20
+  * @brief   STM32 eXtensible Peripheral Drivers Flash Key-Value Store
+  *
+  *  @verbatim
+  *
+  *          ===================================================================
+  *                            Log-structured Key-Value Store
+  *          ===================================================================
+  *           The store uses two flash areas, of which one is active at a time.
+  *           Each value update is appended to the active area as a new record,
+  *           which has a header with the key, the data length and a CRC.
+  *           The offset of the latest record of each key is kept in a RAM index,
+  *           so the values are accessed directly in flash.
+  *           When the active area is full, the latest records are copied to the
+  *           spare area, which then becomes active after its header is written.
+  *           The spare area is erased in the background in advance.
+  *  @endverbatim
+  *
+  *  This file is part of STM32_XPD.
+  *
+  *  STM32_XPD is free software: you can redistribute it and/or modify
+  *  it under the terms of the GNU General Public License as published by
+  *  the Free Software Foundation, either version 3 of the License, or
+  *  (at your option) any later version.
+  *
+  *  STM32_XPD is distributed in the hope that it will be useful,
+  *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with STM32_XPD.  If not, see <http://www.gnu.org/licenses/>.
+  */
+#include <flash_kv.h>
+
+/** @addtogroup FlashKV
+ * @{ */
+
+/** @defgroup FlashKV_Private_Types FlashKV Private Types
+ * @{ */
+
+/* Area header, programmed when the area content is complete */
+typedef struct
+{
+    uint32_t Magic;
+    uint32_t Sequence;
+}FlashKV_AreaHeaderType;
+
+/* Record header, followed by the record data */
+typedef struct
+{
+    uint16_t Key;
+    uint16_t Length;
+    uint16_t Checksum;
+    uint16_t Reserved;
+}FlashKV_RecordType;
+
+/** @} */
+
+/** @defgroup FlashKV_Private_Macros FlashKV Private Macros
+ * @{ */
+
+#define FLASHKV_MAGIC               0x564B5058 /* "XPKV" */
+
+#define FLASHKV_KEY_FREE            0xFFFF
+
+#define FLASHKV_ALIGNED(SIZE)       \
+    (((SIZE) + FLASHKV_ALIGN - 1) & ~(FLASHKV_ALIGN - 1))
+
+#define FLASHKV_HEADER_SIZE         \
+    FLASHKV_ALIGNED(sizeof(FlashKV_AreaHeaderType))
+
+#define FLASHKV_DATA_OFFSET         \
+    FLASHKV_ALIGNED(sizeof(FlashKV_RecordType))
+
+#define FLASHKV_RECORD_SIZE(LENGTH) \
+    (FLASHKV_DATA_OFFSET + FLASHKV_ALIGNED(LENGTH))
+
+#define FLASHKV_RECORD(HKV, OFFSET) \
+    ((const FlashKV_RecordType *)((HKV)->Area[(HKV)->Active] + (OFFSET)))
+
+/** @} */
+
+/* The store which has an ongoing background erase */
+static FlashKV_HandleType * flashkv_erasing = NULL;
+
+/* CRC-16-CCITT calculation */
+static uint16_t flashkv_crc(uint16_t crc, const uint8_t * data, uint32_t length)
+{
+    while (length-- > 0)
+    {
+        uint8_t i;
+
+        crc ^= (uint16_t)(*data++) << 8;
+        for (i = 0; i < 8; i++)
+        {
+            crc = (crc & 0x8000) ? ((crc << 1) ^ 0x1021) : (crc << 1);
+        }
+    }
+    return crc;
+}
+
+/* CRC of the record key, length and data */
+static uint16_t flashkv_recordCRC(uint16_t Key, uint16_t Length, const void * Data)
+{
+    uint16_t fields[2] = { Key, Length };
+    uint16_t crc = flashkv_crc(0xFFFF, (const uint8_t*)fields, sizeof(fields));
+
+    return flashkv_crc(crc, Data, Length);
+}
+
+/* Checks whether the flash region is in erased state */
+static boolean_t flashkv_isBlank(const uint8_t * Address, uint32_t Size)
+{
+    const uint32_t * word = (const uint32_t *)Address;
+
+    for (Size /= sizeof(uint32_t); Size > 0; Size--)
+    {
+        if (*word++ != 0xFFFFFFFF)
+        {
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
+
+/* Programs the data through an aligned buffer, padding the tail with erased bytes */
+static XPD_ReturnType flashkv_program(uint8_t * Address, const void * Data, uint32_t Length)
+{
+    uint32_t buffer[FLASHKV_ALIGNED(32) / sizeof(uint32_t)];
+    const uint8_t * src = Data;
+    XPD_ReturnType result = XPD_OK;
+
+    while ((Length > 0) && (result == XPD_OK))
+    {
+        uint8_t * dest = (uint8_t *)buffer;
+        uint32_t chunk = (Length < sizeof(buffer)) ? Length : sizeof(buffer);
+        uint32_t i;
+
+        for (i = 0; i < chunk; i++)
+        {
+            dest[i] = src[i];
+        }
+        for (; i < FLASHKV_ALIGNED(chunk); i++)
+        {
+            dest[i] = 0xFF;
+        }
+
+        result = XPD_FLASH_Program(Address, buffer, FLASHKV_ALIGNED(chunk));
+
+        Address += chunk;
+        src     += chunk;
+        Length  -= chunk;
+    }
+    return result;
+}
+
+/* Background erase finished callback */
+static void flashkv_eraseComplete(void)
+{
+    if (flashkv_erasing != NULL)
+    {
+        flashkv_erasing->Spare = FLASHKV_SPARE_READY;
+        flashkv_erasing = NULL;
+    }
+}
+
+/* Background erase failed callback */
+static void flashkv_eraseError(void)
+{
+    if (flashkv_erasing != NULL)
+    {
+        flashkv_erasing->Spare = FLASHKV_SPARE_DIRTY;
+        flashkv_erasing = NULL;
+    }
+}
+
+/* Starts the background erasure of the spare area if necessary */
+static void flashkv_eraseSpare(FlashKV_HandleType * hkv)
+{
+    uint8_t * spare = hkv->Area[hkv->Active ^ 1];
+
+    if (hkv->Spare != FLASHKV_SPARE_DIRTY)
+    {
+        /* Nothing to do */
+    }
+    else if (flashkv_isBlank(spare, hkv->AreaSize))
+    {
+        hkv->Spare = FLASHKV_SPARE_READY;
+    }
+    else
+    {
+        XPD_FLASH_Callbacks.EraseComplete = flashkv_eraseComplete;
+        XPD_FLASH_Callbacks.Error         = flashkv_eraseError;
+
+        flashkv_erasing = hkv;
+        hkv->Spare = FLASHKV_SPARE_ERASING;
+
+        if (XPD_FLASH_Erase_IT(spare, hkv->AreaSize >> 10) != XPD_OK)
+        {
+            flashkv_erasing = NULL;
+            hkv->Spare = FLASHKV_SPARE_DIRTY;
+        }
+    }
+}
+
+/* Waits for the completion of the background erase */
+static void flashkv_waitErase(FlashKV_HandleType * hkv)
+{
+    while (hkv->Spare == FLASHKV_SPARE_ERASING)
+    {
+    }
+}
+
+/* Builds the RAM index from the records of the active area */
+static void flashkv_scan(FlashKV_HandleType * hkv)
+{
+    uint32_t offset = FLASHKV_HEADER_SIZE;
+    uint16_t key;
+
+    for (key = 0; key < hkv->KeyCount; key++)
+    {
+        hkv->Index[key] = 0;
+    }
+
+    while ((offset + FLASHKV_DATA_OFFSET) <= hkv->AreaSize)
+    {
+        const FlashKV_RecordType * record = FLASHKV_RECORD(hkv, offset);
+        uint32_t size;
+
+        if (record->Key == FLASHKV_KEY_FREE)
+        {
+            /* An interrupted header write makes the rest of the area unusable */
+            if (!flashkv_isBlank((const uint8_t *)record, FLASHKV_DATA_OFFSET))
+            {
+                offset = hkv->AreaSize;
+            }
+            break;
+        }
+
+        size = FLASHKV_RECORD_SIZE(record->Length);
+        if ((offset + size) > hkv->AreaSize)
+        {
+            offset = hkv->AreaSize;
+            break;
+        }
+
+        /* Records with invalid CRC are skipped */
+        if ((record->Key < hkv->KeyCount) && (record->Checksum == flashkv_recordCRC(
+                record->Key, record->Length, (const uint8_t *)record + FLASHKV_DATA_OFFSET)))
+        {
+            hkv->Index[record->Key] = (record->Length > 0) ? offset : 0;
+        }
+
+        offset += size;
+    }
+
+    hkv->Offset = offset;
+}
+
+/** @defgroup FlashKV_Exported_Functions FlashKV Exported Functions
+ * @{ */
+
+/**
+ * @brief Initializes the key-value store by selecting the latest valid area
+ *        (or formatting the first one if none is found) and building the index.
+ * @note  The FLASH interface should be unlocked while the store is used.
+ *        The FLASH interrupt has to be enabled for the background erase,
+ *        which uses the erase callbacks of XPD_FLASH_Callbacks.
+ * @param hkv: pointer to the key-value store handle structure
+ * @return ERROR if formatting failed, OK otherwise
+ */
+XPD_ReturnType FlashKV_Init(FlashKV_HandleType * hkv)
+{
+    const FlashKV_AreaHeaderType * header[2] = {
+            (const FlashKV_AreaHeaderType *)hkv->Area[0],
+            (const FlashKV_AreaHeaderType *)hkv->Area[1] };
+    boolean_t valid[2] = {
+            header[0]->Magic == FLASHKV_MAGIC,
+            header[1]->Magic == FLASHKV_MAGIC };
+    XPD_ReturnType result = XPD_OK;
+
+    hkv->Spare = FLASHKV_SPARE_DIRTY;
+
+    if (valid[0] && valid[1])
+    {
+        /* The area with the later sequence number is active */
+        hkv->Active = ((int32_t)(header[1]->Sequence - header[0]->Sequence) > 0) ? 1 : 0;
+    }
+    else if (valid[0] || valid[1])
+    {
+        hkv->Active = valid[1] ? 1 : 0;
+    }
+    else
+    {
+        /* Format the first area */
+        FlashKV_AreaHeaderType format = { FLASHKV_MAGIC, 1 };
+
+        hkv->Active = 0;
+
+        if (!flashkv_isBlank(hkv->Area[0], hkv->AreaSize))
+        {
+            result = XPD_FLASH_Erase(hkv->Area[0], hkv->AreaSize >> 10);
+        }
+        if (result == XPD_OK)
+        {
+            result = flashkv_program(hkv->Area[0], &format, sizeof(format));
+        }
+    }
+
+    hkv->Sequence = header[hkv->Active]->Sequence;
+
+    flashkv_scan(hkv);
+
+    return result;
+}
+
+/**
+ * @brief Provides the latest value of the key.
+ * @note  The returned pointer points to the flash memory,
+ *        and it remains valid until the next compaction.
+ * @param hkv: pointer to the key-value store handle structure
+ * @param Key: the key of the value
+ * @param Length: the length of the value is returned here (optional)
+ * @return The value address, or NULL if the key has no value
+ */
+const void * FlashKV_Get(FlashKV_HandleType * hkv, uint16_t Key, uint16_t * Length)
+{
+    const FlashKV_RecordType * record;
+
+    if ((Key >= hkv->KeyCount) || (hkv->Index[Key] == 0))
+    {
+        return NULL;
+    }
+
+    record = FLASHKV_RECORD(hkv, hkv->Index[Key]);
+    if (Length != NULL)
+    {
+        *Length = record->Length;
+    }
+    return (const uint8_t *)record + FLASHKV_DATA_OFFSET;
+}
+
+/**
+ * @brief Sets a new value for the key by appending a record to the active area.
+ * @note  When the active area is full, it is compacted first. When the fill level
+ *        reaches FLASHKV_ERASE_THRESHOLD, the spare area is erased in the background,
+ *        meanwhile this function waits for the erase completion.
+ * @param hkv: pointer to the key-value store handle structure
+ * @param Key: the key of the value
+ * @param Data: the new value
+ * @param Length: the length of the new value (0 deletes the value)
+ * @return ERROR if the key or length is invalid, or the programming failed,
+ *         the result of the compaction if it failed,
+ *         OK if successful
+ */
+XPD_ReturnType FlashKV_Put(FlashKV_HandleType * hkv, uint16_t Key,
+        const void * Data, uint16_t Length)
+{
+    uint32_t size = FLASHKV_RECORD_SIZE(Length);
+    FlashKV_RecordType record;
+    uint8_t * address;
+    XPD_ReturnType result = XPD_OK;
+
+    if ((Key >= hkv->KeyCount) || ((FLASHKV_HEADER_SIZE + size) > hkv->AreaSize))
+    {
+        return XPD_ERROR;
+    }
+
+    if ((hkv->Offset + size) > hkv->AreaSize)
+    {
+        result = FlashKV_Compact(hkv);
+
+        if ((result == XPD_OK) && ((hkv->Offset + size) > hkv->AreaSize))
+        {
+            /* The latest values occupy the whole area */
+            result = XPD_ERROR;
+        }
+        if (result != XPD_OK)
+        {
+            return result;
+        }
+    }
+
+    /* No programming is possible during the erase */
+    flashkv_waitErase(hkv);
+
+    record.Key      = Key;
+    record.Length   = Length;
+    record.Checksum = flashkv_recordCRC(Key, Length, Data);
+    record.Reserved = 0xFFFF;
+
+    /* The header is written first, so an interrupted write is detected by the CRC */
+    address = hkv->Area[hkv->Active] + hkv->Offset;
+    result = flashkv_program(address, &record, sizeof(record));
+    if ((result == XPD_OK) && (Length > 0))
+    {
+        result = flashkv_program(address + FLASHKV_DATA_OFFSET, Data, Length);
+    }
+
+    if (result == XPD_OK)
+    {
+        hkv->Index[Key] = (Length > 0) ? hkv->Offset : 0;
+    }
+    hkv->Offset += size;
+
+    /* Prepare the spare area for the next compaction */
+    if (hkv->Offset >= ((hkv->AreaSize / 100) * FLASHKV_ERASE_THRESHOLD))
+    {
+        flashkv_eraseSpare(hkv);
+    }
+
+    return result;
+}
+
+/**
+ * @brief Removes the value of the key.
+ * @param hkv: pointer to the key-value store handle structure
+ * @param Key: the key of the value
+ * @return The result of the deletion record append
+ */
+XPD_ReturnType FlashKV_Delete(FlashKV_HandleType * hkv, uint16_t Key)
+{
+    XPD_ReturnType result = XPD_OK;
+
+    if ((Key >= hkv->KeyCount) || (hkv->Index[Key] != 0))
+    {
+        result = FlashKV_Put(hkv, Key, NULL, 0);
+    }
+    return result;
+}
+
+/**
+ * @brief Copies the latest records to the spare area, and makes it the active one.
+ * @note  The previously active area remains valid until the new area header is written.
+ * @param hkv: pointer to the key-value store handle structure
+ * @return ERROR    if the spare area erase or programming failed,
+ *         TIMEOUT  if the spare area erase timed out,
+ *         OK       if successful
+ */
+XPD_ReturnType FlashKV_Compact(FlashKV_HandleType * hkv)
+{
+    uint8_t * spare = hkv->Area[hkv->Active ^ 1];
+    uint32_t offset = FLASHKV_HEADER_SIZE;
+    XPD_ReturnType result = XPD_OK;
+    uint16_t key;
+
+    flashkv_waitErase(hkv);
+
+    if (hkv->Spare == FLASHKV_SPARE_DIRTY)
+    {
+        flashkv_eraseSpare(hkv);
+        flashkv_waitErase(hkv);
+    }
+    if (hkv->Spare != FLASHKV_SPARE_READY)
+    {
+        result = XPD_FLASH_Erase(spare, hkv->AreaSize >> 10);
+    }
+
+    /* Copy the latest records in key order */
+    for (key = 0; (key < hkv->KeyCount) && (result == XPD_OK); key++)
+    {
+        if (hkv->Index[key] != 0)
+        {
+            const FlashKV_RecordType * record = FLASHKV_RECORD(hkv, hkv->Index[key]);
+            uint32_t size = FLASHKV_RECORD_SIZE(record->Length);
+
+            result = flashkv_program(spare + offset, record, size);
+            offset += size;
+        }
+    }
+
+    hkv->Spare = FLASHKV_SPARE_DIRTY;
+
+    if (result == XPD_OK)
+    {
+        FlashKV_AreaHeaderType header = { FLASHKV_MAGIC, hkv->Sequence + 1 };
+
+        /* Commit the new area */
+        result = flashkv_program(spare, &header, sizeof(header));
+    }
+
+    if (result == XPD_OK)
+    {
+        /* Relocate the index to the new area, in the same order as copied */
+        offset = FLASHKV_HEADER_SIZE;
+        for (key = 0; key < hkv->KeyCount; key++)
+        {
+            if (hkv->Index[key] != 0)
+            {
+                uint32_t size = FLASHKV_RECORD_SIZE(FLASHKV_RECORD(hkv, hkv->Index[key])->Length);
+
+                hkv->Index[key] = offset;
+                offset += size;
+            }
+        }
+
+        hkv->Active ^= 1;
+        hkv->Sequence++;
+        hkv->Offset = offset;
+    }
+
+    return result;
+}
+
+/** @} */
+
+/** @} */
@@ -0,0 +1,87 @@
+/**
+  ******************************************************************************
+  * @file    eth_netif.h
+  * @author  Benedek Kupper
+  * @version V0.1
+  * @date    2018-01-20
+  * @brief   STM32 eXtensible Peripheral Drivers lwIP Ethernet Interface
+  *
+  *  This file is part of STM32_XPD.
+  *
+  *  STM32_XPD is free software: you can redistribute it and/or modify
+  *  it under the terms of the GNU General Public License as published by
+  *  the Free Software Foundation, either version 3 of the License, or
+  *  (at your option) any later version.
+  *
+  *  STM32_XPD is distributed in the hope that it will be useful,
+  *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with STM32_XPD.  If not, see <http://www.gnu.org/licenses/>.
+  */
+#ifndef __ETH_NETIF_H_
+#define __ETH_NETIF_H_
+
+#include <xpd_eth.h>
+#include <lwip/netif.h>
+#include <lwip/pbuf.h>
+
+/** @defgroup EthNetif
+ * @{ */
+
+/** @defgroup EthNetif_Exported_Macros EthNetif Exported Macros
+ * @{ */
+
+#ifndef ETHNETIF_RX_BUFFERS
+/** @brief Number of receive buffers, each one has its own descriptor [overrideable] */
+#define ETHNETIF_RX_BUFFERS         8
+#endif
+
+#ifndef ETHNETIF_TX_DESCRIPTORS
+/** @brief Number of transmit descriptors, each pbuf of a frame uses one [overrideable] */
+#define ETHNETIF_TX_DESCRIPTORS     16
+#endif
+
+#ifndef ETHNETIF_TX_MAX_SEGMENTS
+/** @brief Largest number of pbufs transmitted without copying, longer chains are copied [overrideable] */
+#define ETHNETIF_TX_MAX_SEGMENTS    4
+#endif
+
+/** @} */
+
+/** @defgroup EthNetif_Exported_Types EthNetif Exported Types
+ * @{ */
+
+/** @brief Receive buffer, handed to the stack as a custom pbuf */
+typedef struct
+{
+    struct pbuf_custom Pbuf;            /*!< [Internal] The pbuf referencing the data */
+    struct netif * Netif;               /*!< [Internal] The owner interface */
+    uint32_t Data[ETH_RX_BUFFER_SIZE / 4]; /*!< [Internal] The frame data */
+}EthNetif_RxBufferType;
+
+/** @brief lwIP Ethernet interface handle structure, the state of the netif */
+typedef struct
+{
+    ETH_HandleType * Eth;               /*!< The Ethernet MAC handle */
+    const ETH_InitType * Config;        /*!< The Ethernet MAC setup */
+    ETH_DescType RxDesc[ETHNETIF_RX_BUFFERS];       /*!< [Internal] Receive descriptors */
+    ETH_DescType TxDesc[ETHNETIF_TX_DESCRIPTORS];   /*!< [Internal] Transmit descriptors */
+    EthNetif_RxBufferType RxBuffer[ETHNETIF_RX_BUFFERS]; /*!< [Internal] Receive buffers */
+}EthNetif_HandleType;
+
+/** @} */
+
+/** @defgroup EthNetif_Exported_Functions EthNetif Exported Functions
+ * @{ */
+err_t           EthNetif_Init           (struct netif * netif);
+
+void            EthNetif_Input          (struct netif * netif);
+void            EthNetif_Reclaim        (struct netif * netif);
+/** @} */
+
+/** @} */
+
+#endif /* __ETH_NETIF_H_ */
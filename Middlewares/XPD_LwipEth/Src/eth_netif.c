@@ -0,0 +1,230 @@
+/**
+  ******************************************************************************
+  * @file    eth_netif.c
+  * @author  Benedek Kupper
+  * @version V0.1
+  * @date    2018-01-20
+  * @brief   STM32 eXtensible Peripheral Drivers lwIP Ethernet Interface
+  *
+  *  @verbatim
+  *
+  *          ===================================================================
+  *                            Zero-copy lwIP Ethernet Interface
+  *          ===================================================================
+  *           The interface connects the Ethernet MAC driver to the lwIP stack.
+  *           Each receive buffer is attached to a custom pbuf, which is passed
+  *           to the stack without copying. When the stack frees the pbuf, its
+  *           buffer is given back to the receive descriptor ring.
+  *           The transmitted pbuf chains are referenced by the transmit
+  *           descriptors directly, one descriptor per pbuf. The pbufs are
+  *           freed when their frame is reclaimed from the transmit ring.
+  *           Only chains longer than ETHNETIF_TX_MAX_SEGMENTS are copied.
+  *
+  *           The EthNetif_Input() and EthNetif_Reclaim() functions have to be
+  *           called from the lwIP core context, when the Received and
+  *           Transmitted callbacks of the Ethernet handle signal it.
+  *           The handle structure has to be placed in a memory region which
+  *           is accessible by the Ethernet DMA (i.e. not in CCM RAM).
+  *           With ETH_InitType::ChecksumOffload enabled, the lwIP checksum
+  *           generation and checking should be disabled in lwipopts.h,
+  *           unless LWIP_CHECKSUM_CTRL_PER_NETIF is used.
+  *  @endverbatim
+  *
+  *  This file is part of STM32_XPD.
+  *
+  *  STM32_XPD is free software: you can redistribute it and/or modify
+  *  it under the terms of the GNU General Public License as published by
+  *  the Free Software Foundation, either version 3 of the License, or
+  *  (at your option) any later version.
+  *
+  *  STM32_XPD is distributed in the hope that it will be useful,
+  *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with STM32_XPD.  If not, see <http://www.gnu.org/licenses/>.
+  */
+#include <eth_netif.h>
+#include <lwip/etharp.h>
+#include <lwip/ethip6.h>
+#include <string.h>
+#include <stddef.h>
+
+#if !LWIP_SUPPORT_CUSTOM_PBUF
+#error "The zero-copy reception requires LWIP_SUPPORT_CUSTOM_PBUF."
+#endif
+
+#if ETH_PAD_SIZE != 0
+#error "The received frames start at the buffer beginning, ETH_PAD_SIZE must be 0."
+#endif
+
+/** @addtogroup EthNetif
+ * @{ */
+
+/* Gives the buffer of the freed receive pbuf back to the descriptor ring */
+static void eth_netifRxFree(struct pbuf * p)
+{
+    EthNetif_RxBufferType * buffer = (EthNetif_RxBufferType *)p;
+    EthNetif_HandleType * hnet = buffer->Netif->state;
+
+    (void) XPD_ETH_RxRing_Give(hnet->Eth, buffer->Data);
+}
+
+/* Frees the pbufs of the transmitted frames */
+static void eth_netifTxReclaim(EthNetif_HandleType * hnet)
+{
+    void * context;
+
+    while (XPD_ETH_TxRing_Reclaim(hnet->Eth, &context))
+    {
+        (void) pbuf_free((struct pbuf *)context);
+    }
+}
+
+/* Transmits the pbuf chain, referencing its buffers directly when possible */
+static err_t eth_netifOutput(struct netif * netif, struct pbuf * p)
+{
+    EthNetif_HandleType * hnet = netif->state;
+    ETH_BufferType buffers[ETHNETIF_TX_MAX_SEGMENTS];
+    struct pbuf * q;
+    uint8_t count = 0;
+
+    eth_netifTxReclaim(hnet);
+
+    for (q = p; q != NULL; q = q->next)
+    {
+        if (q->len > 0)
+        {
+            if (count == ETHNETIF_TX_MAX_SEGMENTS)
+            {
+                break;
+            }
+            buffers[count].Data   = q->payload;
+            buffers[count].Length = q->len;
+            count++;
+        }
+    }
+
+    if (q == NULL)
+    {
+        /* The chain is referenced until transmitted */
+        pbuf_ref(p);
+    }
+    else
+    {
+        /* Too many segments, the frame is copied to a single buffer */
+        q = pbuf_alloc(PBUF_RAW, p->tot_len, PBUF_RAM);
+        if (q == NULL)
+        {
+            return ERR_MEM;
+        }
+        (void) pbuf_copy(q, p);
+
+        p = q;
+        buffers[0].Data   = p->payload;
+        buffers[0].Length = p->len;
+        count = 1;
+    }
+
+    if (XPD_ETH_Transmit(hnet->Eth, buffers, count, p) != XPD_OK)
+    {
+        (void) pbuf_free(p);
+        return ERR_MEM;
+    }
+    return ERR_OK;
+}
+
+/** @defgroup EthNetif_Exported_Functions EthNetif Exported Functions
+ * @{ */
+
+/**
+ * @brief Initializes the Ethernet MAC and sets up the lwIP network interface.
+ *        To be passed to netif_add() with the EthNetif handle as state.
+ * @param netif: pointer to the lwIP network interface
+ * @return ERR_IF if the Ethernet MAC fails to initialize, ERR_OK if success
+ */
+err_t EthNetif_Init(struct netif * netif)
+{
+    EthNetif_HandleType * hnet = netif->state;
+    uint8_t i;
+
+    netif->name[0] = 'e';
+    netif->name[1] = 't';
+#if LWIP_IPV4
+    netif->output = etharp_output;
+#endif
+#if LWIP_IPV6
+    netif->output_ip6 = ethip6_output;
+#endif
+    netif->linkoutput = eth_netifOutput;
+
+    netif->hwaddr_len = ETH_HWADDR_LEN;
+    memcpy(netif->hwaddr, hnet->Config->MACAddress, ETH_HWADDR_LEN);
+    netif->mtu = 1500;
+    netif->flags = NETIF_FLAG_BROADCAST | NETIF_FLAG_ETHARP;
+
+#if LWIP_CHECKSUM_CTRL_PER_NETIF
+    if (hnet->Config->ChecksumOffload == ENABLE)
+    {
+        NETIF_SET_CHECKSUM_CTRL(netif, NETIF_CHECKSUM_DISABLE_ALL);
+    }
+#endif
+
+    if (XPD_ETH_Init(hnet->Eth, hnet->Config) != XPD_OK)
+    {
+        return ERR_IF;
+    }
+
+    XPD_ETH_RxRing_Init(hnet->Eth, hnet->RxDesc, ETHNETIF_RX_BUFFERS);
+    for (i = 0; i < ETHNETIF_RX_BUFFERS; i++)
+    {
+        hnet->RxBuffer[i].Netif = netif;
+        hnet->RxBuffer[i].Pbuf.custom_free_function = eth_netifRxFree;
+        (void) XPD_ETH_RxRing_Give(hnet->Eth, hnet->RxBuffer[i].Data);
+    }
+    XPD_ETH_TxRing_Init(hnet->Eth, hnet->TxDesc, ETHNETIF_TX_DESCRIPTORS);
+
+    XPD_ETH_Start(hnet->Eth);
+
+    return ERR_OK;
+}
+
+/**
+ * @brief Passes the received frames to the stack without copying their buffers.
+ * @param netif: pointer to the lwIP network interface
+ */
+void EthNetif_Input(struct netif * netif)
+{
+    EthNetif_HandleType * hnet = netif->state;
+    EthNetif_RxBufferType * buffer;
+    struct pbuf * p;
+    uint8_t * data;
+    uint16_t length;
+
+    while (NULL != (data = XPD_ETH_RxRing_Take(hnet->Eth, &length)))
+    {
+        buffer = (EthNetif_RxBufferType *)(data - offsetof(EthNetif_RxBufferType, Data));
+
+        p = pbuf_alloced_custom(PBUF_RAW, length, PBUF_REF, &buffer->Pbuf,
+                buffer->Data, sizeof(buffer->Data));
+
+        if (netif->input(p, netif) != ERR_OK)
+        {
+            (void) pbuf_free(p);
+        }
+    }
+}
+
+/**
+ * @brief Frees the pbufs of the transmitted frames.
+ * @param netif: pointer to the lwIP network interface
+ */
+void EthNetif_Reclaim(struct netif * netif)
+{
+    eth_netifTxReclaim(netif->state);
+}
+
+/** @} */
+
+/** @} */
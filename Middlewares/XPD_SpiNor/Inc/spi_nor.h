@@ -0,0 +1,110 @@
+/**
+  ******************************************************************************
+  * @file    spi_nor.h
+  * @author  Benedek Kupper
+  * @version V0.1
+  * @date    2018-01-20
+  * @brief   STM32 eXtensible Peripheral Drivers SPI NOR Flash Component
+  *
+  *  This file is part of STM32_XPD.
+  *
+  *  STM32_XPD is free software: you can redistribute it and/or modify
+  *  it under the terms of the GNU General Public License as published by
+  *  the Free Software Foundation, either version 3 of the License, or
+  *  (at your option) any later version.
+  *
+  *  STM32_XPD is distributed in the hope that it will be useful,
+  *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with STM32_XPD.  If not, see <http://www.gnu.org/licenses/>.
+  */
+#ifndef __SPI_NOR_H_
+#define __SPI_NOR_H_
+
+#include <xpd_spi.h>
+
+/** @defgroup SpiNor
+ *  @brief    Asynchronous serial NOR flash (W25Q and compatible) access through the SPI bus queue
+ *  @details  The operations only start the transfers, their end is signalled by the
+ *            Complete callback, and the Result token of the handle, which is BUSY
+ *            until the operation is finished. The write-in-progress status is polled
+ *            by @ref SpiNor_TimerHandler, which shall be called periodically,
+ *            e.g. from a timer update interrupt. A USB Mass Storage media
+ *            with 4 kB blocks can be built on the component:
+ *  @code
+    static int8_t STORAGE_Write(uint8_t lun, uint8_t *buf, uint32_t blk_addr, uint16_t blk_len)
+    {
+        return (SpiNor_Write(&hnor, blk_addr * SPINOR_SECTOR_SIZE, buf,
+                blk_len * SPINOR_SECTOR_SIZE) == XPD_OK) ? MSC_MEDIA_OK : MSC_MEDIA_BUSY;
+    }
+
+    static void STORAGE_Complete(void * handle)
+    {
+        USBD_MSC_MediaComplete(&hUsbDevice,
+                (((SpiNor_HandleType*)handle)->Result == XPD_OK) ? MSC_MEDIA_OK : MSC_MEDIA_FAIL);
+    }
+ *  @endcode
+ * @{ */
+
+/** @defgroup SpiNor_Exported_Macros SpiNor Exported Macros
+ * @{ */
+
+#define SPINOR_PAGE_SIZE            256     /*!< Programming unit size in bytes */
+#define SPINOR_SECTOR_SIZE          4096    /*!< Smallest erase unit size in bytes */
+#define SPINOR_BLOCK_SIZE           65536   /*!< Largest erase unit size in bytes */
+
+#ifndef SPINOR_MAX_CHUNK
+/** @brief Largest amount of data read in one SPI transaction [overrideable] */
+#define SPINOR_MAX_CHUNK            32768
+#endif
+
+/** @} */
+
+/** @defgroup SpiNor_Exported_Types SpiNor Exported Types
+ * @{ */
+
+/** @brief SPI NOR flash handle structure */
+typedef struct
+{
+    SPI_TransactionType Xfer;           /*!< [Internal] The SPI transaction of the ongoing transfer */
+    SPI_HandleType *    hspi;           /*!< The SPI bus of the flash (8 bit master mode) */
+    GPIO_TypeDef *      CS_Port;        /*!< The GPIO port of the flash chip select */
+    uint8_t             CS_Pin;         /*!< The GPIO pin of the flash chip select */
+    ClockDividerType    Prescaler;      /*!< The serial clock prescaler of the flash transactions */
+    uint32_t            JedecID;        /*!< The manufacturer and device ID read by @ref SpiNor_Probe */
+    uint32_t            Size;           /*!< The flash size in bytes determined by @ref SpiNor_Probe */
+    XPD_HandleCallbackType Complete;    /*!< Operation finished callback, the argument is the handle */
+    volatile XPD_ReturnType Result;     /*!< BUSY while an operation is ongoing, then the result of the operation */
+    uint8_t *           Data;           /*!< [Internal] The data of the next transfer */
+    uint32_t            Address;        /*!< [Internal] The flash address of the next transfer */
+    uint32_t            Length;         /*!< [Internal] The remaining amount of bytes */
+    uint8_t             Operation;      /*!< [Internal] The ongoing operation */
+    uint8_t             Step;           /*!< [Internal] The ongoing transfer of the operation */
+    volatile uint8_t    Polling;        /*!< [Internal] The status is polled at the next timer call */
+    uint8_t             Command[5];     /*!< [Internal] The command header buffer */
+    uint8_t             Status[4];      /*!< [Internal] The status and ID response buffer */
+}SpiNor_HandleType;
+
+/** @} */
+
+/** @defgroup SpiNor_Exported_Functions SpiNor Exported Functions
+ * @{ */
+XPD_ReturnType  SpiNor_Probe            (SpiNor_HandleType * hnor);
+
+XPD_ReturnType  SpiNor_Read             (SpiNor_HandleType * hnor, uint32_t Address,
+                                         void * Data, uint32_t Length);
+XPD_ReturnType  SpiNor_Program          (SpiNor_HandleType * hnor, uint32_t Address,
+                                         const void * Data, uint32_t Length);
+XPD_ReturnType  SpiNor_Erase            (SpiNor_HandleType * hnor, uint32_t Address, uint32_t Length);
+XPD_ReturnType  SpiNor_Write            (SpiNor_HandleType * hnor, uint32_t Address,
+                                         const void * Data, uint32_t Length);
+
+void            SpiNor_TimerHandler     (SpiNor_HandleType * hnor);
+/** @} */
+
+/** @} */
+
+#endif /* __SPI_NOR_H_ */
@@ -0,0 +1,395 @@
+/**
+  ******************************************************************************
+  * @file    spi_nor.c
+  * @author  Benedek Kupper
+  * @version V0.1
+  * @date    2018-01-20
+  * @brief   STM32 eXtensible Peripheral Drivers SPI NOR Flash Component
+  *
+  *  @verbatim
+  *
+  *          ===================================================================
+  *                          Serial NOR Flash Operations
+  *          ===================================================================
+  *           Each operation is a sequence of SPI bus queue transactions,
+  *           the next one is submitted from the completion callback of the
+  *           previous one. The read data and the programmed data are moved
+  *           by the SPI DMA directly, the command headers are transmitted
+  *           before them within the same chip selection.
+  *           Programming and erasing are followed by the status register
+  *           polling, which is submitted from the periodic timer handler,
+  *           so the bus remains free for the other devices meanwhile.
+  *           The 3 byte addressing limits the accessible size to 16 MB.
+  *  @endverbatim
+  *
+  *  This file is part of STM32_XPD.
+  *
+  *  STM32_XPD is free software: you can redistribute it and/or modify
+  *  it under the terms of the GNU General Public License as published by
+  *  the Free Software Foundation, either version 3 of the License, or
+  *  (at your option) any later version.
+  *
+  *  STM32_XPD is distributed in the hope that it will be useful,
+  *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with STM32_XPD.  If not, see <http://www.gnu.org/licenses/>.
+  */
+#include <spi_nor.h>
+
+/** @addtogroup SpiNor
+ * @{ */
+
+/** @defgroup SpiNor_Private_Macros SpiNor Private Macros
+ * @{ */
+
+#define SPINOR_CMD_WRITE_ENABLE     0x06
+#define SPINOR_CMD_READ_STATUS      0x05
+#define SPINOR_CMD_FAST_READ        0x0B
+#define SPINOR_CMD_PAGE_PROGRAM     0x02
+#define SPINOR_CMD_SECTOR_ERASE     0x20
+#define SPINOR_CMD_BLOCK_ERASE      0xD8
+#define SPINOR_CMD_JEDEC_ID         0x9F
+
+#define SPINOR_STATUS_WIP           0x01
+
+#define SPINOR_MAX_SIZE             0x01000000
+
+/* Operations */
+#define SPINOR_OP_NONE              0
+#define SPINOR_OP_PROBE             1
+#define SPINOR_OP_READ              2
+#define SPINOR_OP_PROGRAM           3
+#define SPINOR_OP_ERASE             4
+#define SPINOR_OP_WRITE_ERASE       5
+#define SPINOR_OP_WRITE_PROGRAM     6
+
+/* Transfer steps */
+#define SPINOR_STEP_DATA            0
+#define SPINOR_STEP_WRITE_ENABLE    1
+#define SPINOR_STEP_COMMIT          2
+#define SPINOR_STEP_STATUS          3
+
+/** @} */
+
+static void spinor_xferRedirect(void * transaction);
+
+/* Sets the 3 byte address of the command header */
+static void spinor_setAddress(SpiNor_HandleType * hnor, uint32_t address)
+{
+    hnor->Command[1] = (uint8_t)(address >> 16);
+    hnor->Command[2] = (uint8_t)(address >> 8);
+    hnor->Command[3] = (uint8_t)(address);
+}
+
+/* Submits a transaction of the flash */
+static void spinor_submit(SpiNor_HandleType * hnor, uint8_t step, uint8_t commandLength,
+        void * txData, void * rxData, uint16_t length)
+{
+    hnor->Step               = step;
+    hnor->Xfer.CS_Port       = hnor->CS_Port;
+    hnor->Xfer.CS_Pin        = hnor->CS_Pin;
+    hnor->Xfer.Clock.Polarity  = ACTIVE_HIGH;
+    hnor->Xfer.Clock.Phase     = CLOCK_PHASE_1EDGE;
+    hnor->Xfer.Clock.Prescaler = hnor->Prescaler;
+    hnor->Xfer.Command       = (commandLength > 0) ? hnor->Command : NULL;
+    hnor->Xfer.CommandLength = commandLength;
+    hnor->Xfer.TxData        = txData;
+    hnor->Xfer.RxData        = rxData;
+    hnor->Xfer.Length        = length;
+    hnor->Xfer.Complete      = spinor_xferRedirect;
+
+    (void) XPD_SPI_Queue_Submit(hnor->hspi, &hnor->Xfer);
+}
+
+/* Finishes the ongoing operation */
+static void spinor_finish(SpiNor_HandleType * hnor, XPD_ReturnType result)
+{
+    hnor->Operation = SPINOR_OP_NONE;
+    hnor->Result    = result;
+
+    XPD_SAFE_CALLBACK(hnor->Complete, hnor);
+}
+
+/* Submits the programming or erasing command after the write enable */
+static void spinor_commit(SpiNor_HandleType * hnor)
+{
+    uint32_t chunk;
+
+    spinor_setAddress(hnor, hnor->Address);
+
+    if (hnor->Operation == SPINOR_OP_WRITE_ERASE)
+    {
+        /* Erase the sector, then program it */
+        hnor->Command[0] = SPINOR_CMD_SECTOR_ERASE;
+        hnor->Operation  = SPINOR_OP_WRITE_PROGRAM;
+
+        spinor_submit(hnor, SPINOR_STEP_COMMIT, 0, hnor->Command, NULL, 4);
+    }
+    else if (hnor->Operation == SPINOR_OP_ERASE)
+    {
+        /* The large erase unit is selected when applicable */
+        if (((hnor->Address & (SPINOR_BLOCK_SIZE - 1)) == 0) && (hnor->Length >= SPINOR_BLOCK_SIZE))
+        {
+            chunk = SPINOR_BLOCK_SIZE;
+            hnor->Command[0] = SPINOR_CMD_BLOCK_ERASE;
+        }
+        else
+        {
+            chunk = SPINOR_SECTOR_SIZE;
+            hnor->Command[0] = SPINOR_CMD_SECTOR_ERASE;
+        }
+
+        hnor->Address += chunk;
+        hnor->Length  -= chunk;
+
+        spinor_submit(hnor, SPINOR_STEP_COMMIT, 0, hnor->Command, NULL, 4);
+    }
+    else
+    {
+        uint8_t * data = hnor->Data;
+
+        /* The programming cannot cross a page boundary */
+        chunk = SPINOR_PAGE_SIZE - (hnor->Address & (SPINOR_PAGE_SIZE - 1));
+        if (chunk > hnor->Length)
+        {
+            chunk = hnor->Length;
+        }
+        hnor->Command[0] = SPINOR_CMD_PAGE_PROGRAM;
+
+        hnor->Data    += chunk;
+        hnor->Address += chunk;
+        hnor->Length  -= chunk;
+
+        /* The next sector of the overwritten area is erased first */
+        if ((hnor->Operation == SPINOR_OP_WRITE_PROGRAM)
+            && ((hnor->Address & (SPINOR_SECTOR_SIZE - 1)) == 0))
+        {
+            hnor->Operation = SPINOR_OP_WRITE_ERASE;
+        }
+
+        spinor_submit(hnor, SPINOR_STEP_COMMIT, 4, data, NULL, chunk);
+    }
+}
+
+/* Continues the operation with the next transfer */
+static void spinor_next(SpiNor_HandleType * hnor)
+{
+    if (hnor->Length == 0)
+    {
+        spinor_finish(hnor, XPD_OK);
+    }
+    else if (hnor->Operation == SPINOR_OP_READ)
+    {
+        uint32_t chunk = (hnor->Length < SPINOR_MAX_CHUNK) ? hnor->Length : SPINOR_MAX_CHUNK;
+        uint8_t * data = hnor->Data;
+
+        hnor->Command[0] = SPINOR_CMD_FAST_READ;
+        spinor_setAddress(hnor, hnor->Address);
+        hnor->Command[4] = 0;
+
+        hnor->Data    += chunk;
+        hnor->Address += chunk;
+        hnor->Length  -= chunk;
+
+        /* The receive buffer content is transmitted as dummy */
+        spinor_submit(hnor, SPINOR_STEP_DATA, 5, NULL, data, chunk);
+    }
+    else
+    {
+        hnor->Status[0] = SPINOR_CMD_WRITE_ENABLE;
+
+        spinor_submit(hnor, SPINOR_STEP_WRITE_ENABLE, 0, hnor->Status, NULL, 1);
+    }
+}
+
+/* Advances the operation when a transaction is finished */
+static void spinor_xferRedirect(void * transaction)
+{
+    SpiNor_HandleType * hnor = (SpiNor_HandleType*)transaction;
+
+    if (hnor->Xfer.Result != XPD_OK)
+    {
+        spinor_finish(hnor, hnor->Xfer.Result);
+    }
+    else if (hnor->Operation == SPINOR_OP_PROBE)
+    {
+        uint8_t capacity = hnor->Status[3];
+
+        hnor->JedecID = ((uint32_t)hnor->Status[1] << 16) | ((uint32_t)hnor->Status[2] << 8) | capacity;
+
+        /* The capacity code is the base 2 logarithm of the size */
+        if ((hnor->Status[1] == 0x00) || (hnor->Status[1] == 0xFF) || (capacity < 16) || (capacity > 31))
+        {
+            hnor->Size = 0;
+            spinor_finish(hnor, XPD_ERROR);
+        }
+        else
+        {
+            hnor->Size = (capacity < 24) ? (1UL << capacity) : SPINOR_MAX_SIZE;
+            spinor_finish(hnor, XPD_OK);
+        }
+    }
+    else switch (hnor->Step)
+    {
+        case SPINOR_STEP_WRITE_ENABLE:
+            spinor_commit(hnor);
+            break;
+
+        case SPINOR_STEP_COMMIT:
+            /* Wait for the end of the internal write cycle */
+            hnor->Polling = 1;
+            break;
+
+        case SPINOR_STEP_STATUS:
+            if ((hnor->Status[1] & SPINOR_STATUS_WIP) != 0)
+            {
+                hnor->Polling = 1;
+            }
+            else
+            {
+                spinor_next(hnor);
+            }
+            break;
+
+        default:
+            spinor_next(hnor);
+            break;
+    }
+}
+
+/* Starts an operation if the flash is available */
+static XPD_ReturnType spinor_start(SpiNor_HandleType * hnor, uint8_t operation,
+        uint32_t Address, const void * Data, uint32_t Length)
+{
+    if (hnor->Operation != SPINOR_OP_NONE)
+    {
+        return XPD_BUSY;
+    }
+    if ((operation != SPINOR_OP_PROBE) && ((Address + Length) > hnor->Size))
+    {
+        return XPD_ERROR;
+    }
+
+    hnor->Operation = operation;
+    hnor->Result    = XPD_BUSY;
+    hnor->Polling   = 0;
+    hnor->Address   = Address;
+    hnor->Data      = (uint8_t *)Data;
+    hnor->Length    = Length;
+
+    if (operation == SPINOR_OP_PROBE)
+    {
+        hnor->Status[0] = SPINOR_CMD_JEDEC_ID;
+
+        spinor_submit(hnor, SPINOR_STEP_DATA, 0, hnor->Status, hnor->Status, 4);
+    }
+    else
+    {
+        spinor_next(hnor);
+    }
+
+    return ((hnor->Result == XPD_BUSY) || (hnor->Result == XPD_OK)) ? XPD_OK : hnor->Result;
+}
+
+/** @defgroup SpiNor_Exported_Functions SpiNor Exported Functions
+ * @{ */
+
+/**
+ * @brief Starts reading the JEDEC ID of the flash, and determines the flash size from it.
+ * @note  The other operations are only permitted on flash which has been successfully probed.
+ * @param hnor: pointer to the SPI NOR flash handle structure
+ * @return BUSY if an operation is ongoing, OK if the operation is started
+ *         (the Result of the handle is ERROR if no supported flash responded)
+ */
+XPD_ReturnType SpiNor_Probe(SpiNor_HandleType * hnor)
+{
+    return spinor_start(hnor, SPINOR_OP_PROBE, 0, NULL, 0);
+}
+
+/**
+ * @brief Starts reading the flash contents with the fast read command using DMA.
+ * @param hnor: pointer to the SPI NOR flash handle structure
+ * @param Address: the flash address to read from
+ * @param Data: the buffer to read to
+ * @param Length: the amount of bytes to read
+ * @return ERROR if the range is outside of the flash, BUSY if an operation is ongoing,
+ *         OK if the operation is started
+ */
+XPD_ReturnType SpiNor_Read(SpiNor_HandleType * hnor, uint32_t Address, void * Data, uint32_t Length)
+{
+    return spinor_start(hnor, SPINOR_OP_READ, Address, Data, Length);
+}
+
+/**
+ * @brief Starts programming the erased flash area page by page using DMA.
+ * @param hnor: pointer to the SPI NOR flash handle structure
+ * @param Address: the flash address to program
+ * @param Data: the data to program, which must remain valid until the operation is finished
+ * @param Length: the amount of bytes to program
+ * @return ERROR if the range is outside of the flash, BUSY if an operation is ongoing,
+ *         OK if the operation is started
+ */
+XPD_ReturnType SpiNor_Program(SpiNor_HandleType * hnor, uint32_t Address, const void * Data, uint32_t Length)
+{
+    return spinor_start(hnor, SPINOR_OP_PROGRAM, Address, Data, Length);
+}
+
+/**
+ * @brief Starts erasing the sectors of the flash area. The 64 kB block erase is used
+ *        for the aligned blocks within the area, the 4 kB sector erase for the rest.
+ * @param hnor: pointer to the SPI NOR flash handle structure
+ * @param Address: the start address of the area, multiple of @ref SPINOR_SECTOR_SIZE
+ * @param Length: the size of the area in bytes, multiple of @ref SPINOR_SECTOR_SIZE
+ * @return ERROR if the area is invalid, BUSY if an operation is ongoing,
+ *         OK if the operation is started
+ */
+XPD_ReturnType SpiNor_Erase(SpiNor_HandleType * hnor, uint32_t Address, uint32_t Length)
+{
+    if (((Address | Length) & (SPINOR_SECTOR_SIZE - 1)) != 0)
+    {
+        return XPD_ERROR;
+    }
+    return spinor_start(hnor, SPINOR_OP_ERASE, Address, NULL, Length);
+}
+
+/**
+ * @brief Starts overwriting the flash sectors, each sector is erased before it is programmed.
+ * @param hnor: pointer to the SPI NOR flash handle structure
+ * @param Address: the start address of the area, multiple of @ref SPINOR_SECTOR_SIZE
+ * @param Data: the data to program, which must remain valid until the operation is finished
+ * @param Length: the size of the area in bytes, multiple of @ref SPINOR_SECTOR_SIZE
+ * @return ERROR if the area is invalid, BUSY if an operation is ongoing,
+ *         OK if the operation is started
+ */
+XPD_ReturnType SpiNor_Write(SpiNor_HandleType * hnor, uint32_t Address, const void * Data, uint32_t Length)
+{
+    if (((Address | Length) & (SPINOR_SECTOR_SIZE - 1)) != 0)
+    {
+        return XPD_ERROR;
+    }
+    return spinor_start(hnor, SPINOR_OP_WRITE_ERASE, Address, Data, Length);
+}
+
+/**
+ * @brief Polls the busy status of the flash during programming and erasing.
+ * @note  This function shall be called periodically, e.g. from a timer interrupt at 1 ms period,
+ *        at the same interrupt priority as the SPI DMA interrupts.
+ * @param hnor: pointer to the SPI NOR flash handle structure
+ */
+void SpiNor_TimerHandler(SpiNor_HandleType * hnor)
+{
+    if (hnor->Polling != 0)
+    {
+        hnor->Polling   = 0;
+        hnor->Status[0] = SPINOR_CMD_READ_STATUS;
+
+        spinor_submit(hnor, SPINOR_STEP_STATUS, 0, hnor->Status, hnor->Status, 2);
+    }
+}
+
+/** @} */
+
+/** @} */
@@ -0,0 +1,136 @@
+/**
+  ******************************************************************************
+  * @file    usb_host.h
+  * @author  Benedek Kupper
+  * @version V0.1
+  * @date    2018-02-10
+  * @brief   STM32 eXtensible Peripheral Drivers USB Host Component
+  *
+  *  This file is part of STM32_XPD.
+  *
+  *  STM32_XPD is free software: you can redistribute it and/or modify
+  *  it under the terms of the GNU General Public License as published by
+  *  the Free Software Foundation, either version 3 of the License, or
+  *  (at your option) any later version.
+  *
+  *  STM32_XPD is distributed in the hope that it will be useful,
+  *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with STM32_XPD.  If not, see <http://www.gnu.org/licenses/>.
+  */
+#ifndef __USB_HOST_H_
+#define __USB_HOST_H_
+
+#include <xpd_usbh.h>
+
+/** @defgroup UsbHost
+ *  @brief    Single device USB host on the channels of the host controller driver
+ *  @details  The component enumerates the device attached to the root port, and provides
+ *            blocking control and bulk transfers for the class components
+ *            (@ref UsbMsc, @ref UsbCdc). The functions shall be called from thread context,
+ *            the transfers are carried out by the USB interrupt meanwhile.
+ *  @code
+    static volatile boolean_t portEnabled;
+
+    static void portEnabledCallback(void * handle)
+    {
+        portEnabled = TRUE;
+    }
+
+    // Connected callback -> XPD_USBH_PortReset(&husbh);
+    husbh.Callbacks.PortEnabled = portEnabledCallback;
+    XPD_USBH_Start(&husbh);
+
+    while (portEnabled == FALSE);
+    hdev.husbh = &husbh;
+    if ((UsbHost_Enumerate(&hdev) == XPD_OK) && (UsbMsc_Init(&hmsc, &hdev) == XPD_OK))
+    {
+        UsbMsc_Read(&hmsc, 0, sector, 1);
+    }
+ *  @endcode
+ * @{ */
+
+/** @defgroup UsbHost_Exported_Macros UsbHost Exported Macros
+ * @{ */
+
+#ifndef USBHOST_CONFIG_SIZE
+/** @brief The size of the stored configuration descriptor set [overrideable] */
+#define USBHOST_CONFIG_SIZE         256
+#endif
+
+#ifndef USBHOST_CTRL_TIMEOUT
+/** @brief The timeout of each control transfer stage in ms [overrideable] */
+#define USBHOST_CTRL_TIMEOUT        1000
+#endif
+
+/** @brief The USB address assigned to the device */
+#define USBHOST_DEVICE_ADDRESS      1
+
+/** @brief Wildcard interface subclass and protocol code of @ref UsbHost_FindInterface */
+#define USBHOST_ANY                 0xFF
+
+/** @brief Standard descriptor types */
+#define USBHOST_DESC_DEVICE         1
+#define USBHOST_DESC_CONFIGURATION  2
+#define USBHOST_DESC_INTERFACE      4
+#define USBHOST_DESC_ENDPOINT       5
+
+/** @} */
+
+/** @defgroup UsbHost_Exported_Types UsbHost Exported Types
+ * @{ */
+
+/** @brief USB setup request structure (in wire format) */
+typedef struct
+{
+    uint8_t  bmRequestType;             /*!< Request direction, type and recipient */
+    uint8_t  bRequest;                  /*!< Request code */
+    uint16_t wValue;                    /*!< Request specific value */
+    uint16_t wIndex;                    /*!< Request specific index (interface or endpoint) */
+    uint16_t wLength;                   /*!< Data stage length */
+}UsbHost_SetupType;
+
+/** @brief USB host device handle structure */
+typedef struct
+{
+    USBH_HandleType *   husbh;          /*!< The host controller of the device's port */
+    uint16_t            VendorID;       /*!< The vendor ID of the device */
+    uint16_t            ProductID;      /*!< The product ID of the device */
+    uint8_t             MaxPacketSize0; /*!< The max packet size of the default control endpoint */
+    uint8_t             CtrlOut;        /*!< [Internal] The control OUT host channel */
+    uint8_t             CtrlIn;         /*!< [Internal] The control IN host channel */
+    uint16_t            ConfigLength;   /*!< The stored length of the configuration descriptor set */
+    UsbHost_SetupType   Setup;          /*!< [Internal] The SETUP packet buffer */
+    uint8_t             Device[18];     /*!< The device descriptor */
+    uint8_t             Config[USBHOST_CONFIG_SIZE]; /*!< The active configuration descriptor set */
+}UsbHost_DeviceType;
+
+/** @} */
+
+/** @defgroup UsbHost_Exported_Functions UsbHost Exported Functions
+ * @{ */
+XPD_ReturnType  UsbHost_Enumerate       (UsbHost_DeviceType * hdev);
+void            UsbHost_Release         (UsbHost_DeviceType * hdev);
+
+XPD_ReturnType  UsbHost_Control         (UsbHost_DeviceType * hdev, const UsbHost_SetupType * Setup,
+                                         void * Data);
+XPD_ReturnType  UsbHost_ClearHalt       (UsbHost_DeviceType * hdev, uint8_t Channel);
+
+const uint8_t * UsbHost_FindInterface   (UsbHost_DeviceType * hdev, uint8_t Class,
+                                         uint8_t SubClass, uint8_t Protocol);
+const uint8_t * UsbHost_FindEndpoint    (UsbHost_DeviceType * hdev, const uint8_t * Interface,
+                                         USB_EndPointType Type, boolean_t In);
+
+uint8_t         UsbHost_OpenPipe        (UsbHost_DeviceType * hdev, const uint8_t * Endpoint);
+void            UsbHost_ClosePipe       (UsbHost_DeviceType * hdev, uint8_t Channel);
+XPD_ReturnType  UsbHost_Transfer        (UsbHost_DeviceType * hdev, uint8_t Channel,
+                                         void * Data, uint32_t Length, uint32_t Timeout,
+                                         uint32_t * Count);
+/** @} */
+
+/** @} */
+
+#endif /* __USB_HOST_H_ */
@@ -0,0 +1,92 @@
+/**
+  ******************************************************************************
+  * @file    usb_host_cdc.h
+  * @author  Benedek Kupper
+  * @version V0.1
+  * @date    2018-02-10
+  * @brief   STM32 eXtensible Peripheral Drivers USB Host Communications Device Class
+  *
+  *  This file is part of STM32_XPD.
+  *
+  *  STM32_XPD is free software: you can redistribute it and/or modify
+  *  it under the terms of the GNU General Public License as published by
+  *  the Free Software Foundation, either version 3 of the License, or
+  *  (at your option) any later version.
+  *
+  *  STM32_XPD is distributed in the hope that it will be useful,
+  *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with STM32_XPD.  If not, see <http://www.gnu.org/licenses/>.
+  */
+#ifndef __USB_HOST_CDC_H_
+#define __USB_HOST_CDC_H_
+
+#include <usb_host.h>
+
+/** @defgroup UsbCdc
+ *  @brief    USB CDC Abstract Control Model host for serial adapters and modems
+ *  @details  The data is sent with blocking transfers, while the reception
+ *            is left ongoing in the background: the idle device NAKs the
+ *            submitted transfer, which is retried in per frame batches by
+ *            the host controller driver, so it doesn't load the CPU.
+ *  @code
+    UsbCdc_SetLineCoding(&hcdc, &(const UsbCdc_LineCodingType){ 115200, 0, 0, 8 });
+    UsbCdc_Receive(&hcdc, rxBuffer, sizeof(rxBuffer));
+
+    while (UsbCdc_GetReceived(&hcdc, &count) == XPD_BUSY);
+ *  @endcode
+ * @{ */
+
+/** @defgroup UsbCdc_Exported_Macros UsbCdc Exported Macros
+ * @{ */
+
+#ifndef USBCDC_TIMEOUT
+/** @brief The timeout of the transmission in ms [overrideable] */
+#define USBCDC_TIMEOUT              1000
+#endif
+
+/** @} */
+
+/** @defgroup UsbCdc_Exported_Types UsbCdc Exported Types
+ * @{ */
+
+/** @brief CDC line coding structure */
+typedef struct
+{
+    uint32_t dwDTERate;                 /*!< Baud rate in bits per second */
+    uint8_t  bCharFormat;               /*!< Stop bits: 0 = 1, 1 = 1.5, 2 = 2 */
+    uint8_t  bParityType;               /*!< Parity: 0 = none, 1 = odd, 2 = even, 3 = mark, 4 = space */
+    uint8_t  bDataBits;                 /*!< Data bits: 5, 6, 7, 8 or 16 */
+}UsbCdc_LineCodingType;
+
+/** @brief USB host CDC ACM handle structure */
+typedef struct
+{
+    UsbHost_DeviceType * Device;        /*!< The enumerated device */
+    uint8_t             Interface;      /*!< [Internal] The communication interface number */
+    uint8_t             BulkIn;         /*!< [Internal] The data IN host channel */
+    uint8_t             BulkOut;        /*!< [Internal] The data OUT host channel */
+    uint8_t             LineCoding[7];  /*!< [Internal] The line coding request buffer */
+}UsbCdc_HandleType;
+
+/** @} */
+
+/** @defgroup UsbCdc_Exported_Functions UsbCdc Exported Functions
+ * @{ */
+XPD_ReturnType  UsbCdc_Init             (UsbCdc_HandleType * hcdc, UsbHost_DeviceType * hdev);
+void            UsbCdc_Deinit           (UsbCdc_HandleType * hcdc);
+
+XPD_ReturnType  UsbCdc_SetLineCoding    (UsbCdc_HandleType * hcdc, const UsbCdc_LineCodingType * LineCoding);
+
+XPD_ReturnType  UsbCdc_Transmit         (UsbCdc_HandleType * hcdc, const void * Data, uint32_t Length);
+
+XPD_ReturnType  UsbCdc_Receive          (UsbCdc_HandleType * hcdc, void * Data, uint32_t Length);
+XPD_ReturnType  UsbCdc_GetReceived      (UsbCdc_HandleType * hcdc, uint32_t * Count);
+/** @} */
+
+/** @} */
+
+#endif /* __USB_HOST_CDC_H_ */
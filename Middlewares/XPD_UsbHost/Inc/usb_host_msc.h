@@ -0,0 +1,93 @@
+/**
+  ******************************************************************************
+  * @file    usb_host_msc.h
+  * @author  Benedek Kupper
+  * @version V0.1
+  * @date    2018-02-10
+  * @brief   STM32 eXtensible Peripheral Drivers USB Host Mass Storage Class
+  *
+  *  This file is part of STM32_XPD.
+  *
+  *  STM32_XPD is free software: you can redistribute it and/or modify
+  *  it under the terms of the GNU General Public License as published by
+  *  the Free Software Foundation, either version 3 of the License, or
+  *  (at your option) any later version.
+  *
+  *  STM32_XPD is distributed in the hope that it will be useful,
+  *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with STM32_XPD.  If not, see <http://www.gnu.org/licenses/>.
+  */
+#ifndef __USB_HOST_MSC_H_
+#define __USB_HOST_MSC_H_
+
+#include <usb_host.h>
+
+/** @defgroup UsbMsc
+ *  @brief    USB Mass Storage Bulk-Only Transport host with SCSI block commands
+ *  @details  Flash drives and card readers can be accessed with the blocking
+ *            block read and write functions. The capacity of the selected
+ *            logical unit is determined by @ref UsbMsc_Init.
+ *            The failed commands provide the sense data of the unit.
+ * @{ */
+
+/** @defgroup UsbMsc_Exported_Macros UsbMsc Exported Macros
+ * @{ */
+
+#ifndef USBMSC_TIMEOUT
+/** @brief The timeout of each transport stage in ms [overrideable] */
+#define USBMSC_TIMEOUT              5000
+#endif
+
+#ifndef USBMSC_READY_RETRIES
+/** @brief The number of TEST UNIT READY attempts at initialization [overrideable] */
+#define USBMSC_READY_RETRIES        10
+#endif
+
+/** @} */
+
+/** @defgroup UsbMsc_Exported_Types UsbMsc Exported Types
+ * @{ */
+
+/** @brief USB host mass storage handle structure */
+typedef struct
+{
+    UsbHost_DeviceType * Device;        /*!< The enumerated device */
+    uint8_t             Interface;      /*!< [Internal] The interface number of the class */
+    uint8_t             BulkIn;         /*!< [Internal] The bulk IN host channel */
+    uint8_t             BulkOut;        /*!< [Internal] The bulk OUT host channel */
+    uint8_t             MaxLun;         /*!< The highest logical unit number of the device */
+    uint8_t             Lun;            /*!< The logical unit number accessed by the block functions */
+    uint32_t            Tag;            /*!< [Internal] The tag of the last command */
+    uint32_t            BlockCount;     /*!< The number of blocks of the unit */
+    uint32_t            BlockSize;      /*!< The block size of the unit in bytes */
+    uint8_t             SenseKey;       /*!< The sense key of the last failed command */
+    uint8_t             ASC;            /*!< The additional sense code of the last failed command */
+    uint8_t             ASCQ;           /*!< The additional sense code qualifier of the last failed command */
+    uint8_t             Buffer[36];     /*!< [Internal] The response buffer of the management commands */
+    uint8_t             CBW[31];        /*!< [Internal] The command block wrapper buffer */
+    uint8_t             CSW[13];        /*!< [Internal] The command status wrapper buffer */
+}UsbMsc_HandleType;
+
+/** @} */
+
+/** @defgroup UsbMsc_Exported_Functions UsbMsc Exported Functions
+ * @{ */
+XPD_ReturnType  UsbMsc_Init             (UsbMsc_HandleType * hmsc, UsbHost_DeviceType * hdev);
+void            UsbMsc_Deinit           (UsbMsc_HandleType * hmsc);
+
+XPD_ReturnType  UsbMsc_TestUnitReady    (UsbMsc_HandleType * hmsc);
+XPD_ReturnType  UsbMsc_RequestSense     (UsbMsc_HandleType * hmsc);
+
+XPD_ReturnType  UsbMsc_Read             (UsbMsc_HandleType * hmsc, uint32_t Block,
+                                         void * Data, uint16_t Count);
+XPD_ReturnType  UsbMsc_Write            (UsbMsc_HandleType * hmsc, uint32_t Block,
+                                         const void * Data, uint16_t Count);
+/** @} */
+
+/** @} */
+
+#endif /* __USB_HOST_MSC_H_ */
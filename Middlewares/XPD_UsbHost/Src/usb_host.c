@@ -0,0 +1,403 @@
+/**
+  ******************************************************************************
+  * @file    usb_host.c
+  * @author  Benedek Kupper
+  * @version V0.1
+  * @date    2018-02-10
+  * @brief   STM32 eXtensible Peripheral Drivers USB Host Component
+  *
+  *  @verbatim
+  *
+  *          ===================================================================
+  *                              Device enumeration
+  *          ===================================================================
+  *           The device is enumerated on a pair of control channels:
+  *           the max packet size of the default pipe is read from the first
+  *           8 bytes of the device descriptor, the fixed address is assigned,
+  *           then the device and configuration descriptors are read and
+  *           the first configuration is activated. The class components find
+  *           their interfaces and endpoints in the stored configuration set.
+  *           Each transfer is submitted to the channel and awaited with
+  *           timeout: the NAKed transactions are retried in per frame
+  *           batches by the host controller driver meanwhile.
+  *  @endverbatim
+  *
+  *  This file is part of STM32_XPD.
+  *
+  *  STM32_XPD is free software: you can redistribute it and/or modify
+  *  it under the terms of the GNU General Public License as published by
+  *  the Free Software Foundation, either version 3 of the License, or
+  *  (at your option) any later version.
+  *
+  *  STM32_XPD is distributed in the hope that it will be useful,
+  *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with STM32_XPD.  If not, see <http://www.gnu.org/licenses/>.
+  */
+#include <usb_host.h>
+#include <xpd_utils.h>
+
+/** @addtogroup UsbHost
+ * @{ */
+
+/** @defgroup UsbHost_Private_Macros UsbHost Private Macros
+ * @{ */
+
+#define USB_REQ_CLEAR_FEATURE       0x01
+#define USB_REQ_SET_ADDRESS         0x05
+#define USB_REQ_GET_DESCRIPTOR      0x06
+#define USB_REQ_SET_CONFIGURATION   0x09
+
+#define USB_FEATURE_EP_HALT         0x00
+
+#define USB_REQ_DIR_IN              0x80
+#define USB_REQ_RECIPIENT_EP        0x02
+
+/* The device has 2 ms to apply the new address */
+#define USBHOST_SET_ADDRESS_DELAY   2
+
+/** @} */
+
+/* Open both directions of the default control pipe */
+static void usbhost_openControl(UsbHost_DeviceType * hdev, uint8_t Address)
+{
+    XPD_USBH_Channel_Open(hdev->husbh, hdev->CtrlOut, Address, 0x00,
+            USB_EP_TYPE_CONTROL, hdev->MaxPacketSize0);
+    XPD_USBH_Channel_Open(hdev->husbh, hdev->CtrlIn, Address, 0x80,
+            USB_EP_TYPE_CONTROL, hdev->MaxPacketSize0);
+}
+
+/* Read a standard descriptor of the device */
+static XPD_ReturnType usbhost_getDescriptor(UsbHost_DeviceType * hdev, uint8_t Type,
+        void * Data, uint16_t Length)
+{
+    const UsbHost_SetupType setup = {
+        .bmRequestType = USB_REQ_DIR_IN,
+        .bRequest      = USB_REQ_GET_DESCRIPTOR,
+        .wValue        = (uint16_t)Type << 8,
+        .wIndex        = 0,
+        .wLength       = Length,
+    };
+    return UsbHost_Control(hdev, &setup, Data);
+}
+
+/* Submit a transfer and wait for its conclusion */
+static XPD_ReturnType usbhost_transfer(UsbHost_DeviceType * hdev, uint8_t Channel,
+        boolean_t Setup, void * Data, uint32_t Length, uint32_t Timeout, uint32_t * Count)
+{
+    uint64_t deadline = XPD_GetTicks64() + (uint64_t)Timeout * (SystemCoreClock / 1000);
+    XPD_ReturnType result;
+
+    result = XPD_USBH_Channel_Submit(hdev->husbh, Channel, Setup, Data, Length);
+
+    while ((result == XPD_OK) && (XPD_USBH_Channel_GetState(hdev->husbh, Channel) == USBH_URB_IDLE))
+    {
+        if (XPD_USBH_IsConnected(hdev->husbh) == 0)
+        {
+            result = XPD_ERROR;
+        }
+        else if (XPD_GetTicks64() > deadline)
+        {
+            result = XPD_TIMEOUT;
+        }
+    }
+
+    if (result != XPD_OK)
+    {
+        XPD_USBH_Channel_Abort(hdev->husbh, Channel);
+    }
+    else if (XPD_USBH_Channel_GetState(hdev->husbh, Channel) != USBH_URB_DONE)
+    {
+        result = XPD_ERROR;
+    }
+
+    if (Count != NULL)
+    {
+        *Count = XPD_USBH_Channel_GetCount(hdev->husbh, Channel);
+    }
+    return result;
+}
+
+/** @defgroup UsbHost_Exported_Functions UsbHost Exported Functions
+ * @{ */
+
+/**
+ * @brief Enumerates the device attached to the enabled root port,
+ *        and activates its first configuration.
+ * @note  The port has to be enabled by @ref XPD_USBH_PortReset before calling this function.
+ * @param hdev: pointer to the USB host device handle structure with the host controller set
+ * @return ERROR if no channels are available or the device doesn't respond properly,
+ *         TIMEOUT if the device doesn't complete a request in time, OK if configured
+ */
+XPD_ReturnType UsbHost_Enumerate(UsbHost_DeviceType * hdev)
+{
+    XPD_ReturnType result = XPD_ERROR;
+    UsbHost_SetupType setup = { .bmRequestType = 0, .wIndex = 0, .wLength = 0 };
+
+    hdev->CtrlOut = XPD_USBH_Channel_Alloc(hdev->husbh);
+    hdev->CtrlIn  = XPD_USBH_Channel_Alloc(hdev->husbh);
+    hdev->ConfigLength = 0;
+
+    if ((hdev->CtrlOut != USBH_NO_CHANNEL) && (hdev->CtrlIn != USBH_NO_CHANNEL))
+    {
+        /* The first 8 bytes contain the max packet size, which is at least 8 */
+        hdev->MaxPacketSize0 = 8;
+        usbhost_openControl(hdev, 0);
+        result = usbhost_getDescriptor(hdev, USBHOST_DESC_DEVICE, hdev->Device, 8);
+    }
+
+    if (result == XPD_OK)
+    {
+        hdev->MaxPacketSize0 = hdev->Device[7];
+        usbhost_openControl(hdev, 0);
+
+        setup.bRequest = USB_REQ_SET_ADDRESS;
+        setup.wValue   = USBHOST_DEVICE_ADDRESS;
+        result = UsbHost_Control(hdev, &setup, NULL);
+    }
+
+    if (result == XPD_OK)
+    {
+        XPD_Delay_ms(USBHOST_SET_ADDRESS_DELAY);
+        usbhost_openControl(hdev, USBHOST_DEVICE_ADDRESS);
+
+        result = usbhost_getDescriptor(hdev, USBHOST_DESC_DEVICE, hdev->Device, sizeof(hdev->Device));
+    }
+
+    if (result == XPD_OK)
+    {
+        hdev->VendorID  = hdev->Device[8]  | ((uint16_t)hdev->Device[9]  << 8);
+        hdev->ProductID = hdev->Device[10] | ((uint16_t)hdev->Device[11] << 8);
+
+        /* The header contains the total length of the set */
+        result = usbhost_getDescriptor(hdev, USBHOST_DESC_CONFIGURATION, hdev->Config, 9);
+    }
+
+    if (result == XPD_OK)
+    {
+        uint16_t length = hdev->Config[2] | ((uint16_t)hdev->Config[3] << 8);
+
+        /* The descriptors which don't fit are ignored */
+        if (length > sizeof(hdev->Config))
+        {
+            length = sizeof(hdev->Config);
+        }
+        result = usbhost_getDescriptor(hdev, USBHOST_DESC_CONFIGURATION, hdev->Config, length);
+        if (result == XPD_OK)
+        {
+            hdev->ConfigLength = length;
+        }
+    }
+
+    if (result == XPD_OK)
+    {
+        setup.bRequest = USB_REQ_SET_CONFIGURATION;
+        setup.wValue   = hdev->Config[5];
+        result = UsbHost_Control(hdev, &setup, NULL);
+    }
+
+    if (result != XPD_OK)
+    {
+        UsbHost_Release(hdev);
+    }
+    return result;
+}
+
+/**
+ * @brief Releases the control channels of the device.
+ * @note  The class components have to release their pipes separately.
+ * @param hdev: pointer to the USB host device handle structure
+ */
+void UsbHost_Release(UsbHost_DeviceType * hdev)
+{
+    UsbHost_ClosePipe(hdev, hdev->CtrlOut);
+    UsbHost_ClosePipe(hdev, hdev->CtrlIn);
+
+    hdev->CtrlOut      = USBH_NO_CHANNEL;
+    hdev->CtrlIn       = USBH_NO_CHANNEL;
+    hdev->ConfigLength = 0;
+}
+
+/**
+ * @brief Performs a control request on the default pipe of the device.
+ * @param hdev: pointer to the USB host device handle structure
+ * @param Setup: the setup request, its wLength determines the data stage length
+ * @param Data: the data stage buffer (direction determined by bmRequestType)
+ * @return ERROR if the request is stalled or failed, TIMEOUT if a stage isn't completed in time,
+ *         OK if the request is completed
+ */
+XPD_ReturnType UsbHost_Control(UsbHost_DeviceType * hdev, const UsbHost_SetupType * Setup, void * Data)
+{
+    boolean_t in = (Setup->bmRequestType & USB_REQ_DIR_IN) != 0;
+    XPD_ReturnType result;
+
+    hdev->Setup = *Setup;
+
+    result = usbhost_transfer(hdev, hdev->CtrlOut, TRUE, (uint8_t*)&hdev->Setup, sizeof(hdev->Setup),
+            USBHOST_CTRL_TIMEOUT, NULL);
+
+    /* The data stage starts with DATA1 */
+    if ((result == XPD_OK) && (Setup->wLength > 0))
+    {
+        uint8_t channel = in ? hdev->CtrlIn : hdev->CtrlOut;
+
+        XPD_USBH_Channel_SetToggle(hdev->husbh, channel, 1);
+        result = usbhost_transfer(hdev, channel, FALSE, Data, Setup->wLength,
+                USBHOST_CTRL_TIMEOUT, NULL);
+    }
+
+    /* The status stage is a DATA1 zero length packet in the opposite direction */
+    if (result == XPD_OK)
+    {
+        uint8_t channel = (in && (Setup->wLength > 0)) ? hdev->CtrlOut : hdev->CtrlIn;
+
+        XPD_USBH_Channel_SetToggle(hdev->husbh, channel, 1);
+        result = usbhost_transfer(hdev, channel, FALSE, NULL, 0, USBHOST_CTRL_TIMEOUT, NULL);
+    }
+    return result;
+}
+
+/**
+ * @brief Clears the halt feature of the pipe's endpoint, and resets its data toggle.
+ * @param hdev: pointer to the USB host device handle structure
+ * @param Channel: the host channel of the stalled endpoint
+ * @return The result of the request
+ */
+XPD_ReturnType UsbHost_ClearHalt(UsbHost_DeviceType * hdev, uint8_t Channel)
+{
+    const UsbHost_SetupType setup = {
+        .bmRequestType = USB_REQ_RECIPIENT_EP,
+        .bRequest      = USB_REQ_CLEAR_FEATURE,
+        .wValue        = USB_FEATURE_EP_HALT,
+        .wIndex        = hdev->husbh->Channel[Channel].EpAddress,
+        .wLength       = 0,
+    };
+    XPD_ReturnType result = UsbHost_Control(hdev, &setup, NULL);
+
+    XPD_USBH_Channel_SetToggle(hdev->husbh, Channel, 0);
+
+    return result;
+}
+
+/**
+ * @brief Finds an interface descriptor in the active configuration.
+ * @param hdev: pointer to the USB host device handle structure
+ * @param Class: the interface class code
+ * @param SubClass: the interface subclass code, or @ref USBHOST_ANY
+ * @param Protocol: the interface protocol code, or @ref USBHOST_ANY
+ * @return Pointer to the first matching interface descriptor, or NULL if not found
+ */
+const uint8_t * UsbHost_FindInterface(UsbHost_DeviceType * hdev, uint8_t Class,
+        uint8_t SubClass, uint8_t Protocol)
+{
+    uint16_t pos;
+
+    for (pos = 0; (pos + 2) <= hdev->ConfigLength; pos += hdev->Config[pos])
+    {
+        const uint8_t * desc = &hdev->Config[pos];
+
+        if (desc[0] == 0)
+        {
+            break;
+        }
+        if ((desc[1] == USBHOST_DESC_INTERFACE) && ((pos + 9) <= hdev->ConfigLength)
+                && (desc[5] == Class)
+                && ((SubClass == USBHOST_ANY) || (desc[6] == SubClass))
+                && ((Protocol == USBHOST_ANY) || (desc[7] == Protocol)))
+        {
+            return desc;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Finds an endpoint descriptor of the interface.
+ * @param hdev: pointer to the USB host device handle structure
+ * @param Interface: the interface descriptor found by @ref UsbHost_FindInterface
+ * @param Type: the requested endpoint type
+ * @param In: the requested endpoint direction
+ * @return Pointer to the first matching endpoint descriptor, or NULL if not found
+ */
+const uint8_t * UsbHost_FindEndpoint(UsbHost_DeviceType * hdev, const uint8_t * Interface,
+        USB_EndPointType Type, boolean_t In)
+{
+    uint16_t pos = (Interface - hdev->Config) + Interface[0];
+
+    for (; (pos + 2) <= hdev->ConfigLength; pos += hdev->Config[pos])
+    {
+        const uint8_t * desc = &hdev->Config[pos];
+
+        /* The endpoints of the interface precede the next interface */
+        if ((desc[0] == 0) || (desc[1] == USBHOST_DESC_INTERFACE))
+        {
+            break;
+        }
+        if ((desc[1] == USBHOST_DESC_ENDPOINT) && ((pos + 7) <= hdev->ConfigLength)
+                && ((desc[3] & 3) == Type) && (((desc[2] & 0x80) != 0) == (In != FALSE)))
+        {
+            return desc;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Allocates a host channel for the device endpoint.
+ * @param hdev: pointer to the USB host device handle structure
+ * @param Endpoint: the endpoint descriptor found by @ref UsbHost_FindEndpoint
+ * @return The opened host channel number, or @ref USBH_NO_CHANNEL if none is available
+ */
+uint8_t UsbHost_OpenPipe(UsbHost_DeviceType * hdev, const uint8_t * Endpoint)
+{
+    uint8_t channel = USBH_NO_CHANNEL;
+
+    if (Endpoint != NULL)
+    {
+        channel = XPD_USBH_Channel_Alloc(hdev->husbh);
+    }
+    if (channel != USBH_NO_CHANNEL)
+    {
+        XPD_USBH_Channel_Open(hdev->husbh, channel, USBHOST_DEVICE_ADDRESS, Endpoint[2],
+                (USB_EndPointType)(Endpoint[3] & 3), Endpoint[4] | ((uint16_t)Endpoint[5] << 8));
+    }
+    return channel;
+}
+
+/**
+ * @brief Closes and releases the host channel of the pipe.
+ * @param hdev: pointer to the USB host device handle structure
+ * @param Channel: the host channel number (@ref USBH_NO_CHANNEL is ignored)
+ */
+void UsbHost_ClosePipe(UsbHost_DeviceType * hdev, uint8_t Channel)
+{
+    if (Channel != USBH_NO_CHANNEL)
+    {
+        XPD_USBH_Channel_Free(hdev->husbh, Channel);
+    }
+}
+
+/**
+ * @brief Performs a bulk or interrupt transfer on the pipe in the endpoint's direction.
+ * @note  The unfinished transfer is aborted at timeout, the data toggle is kept.
+ * @param hdev: pointer to the USB host device handle structure
+ * @param Channel: the host channel of the pipe
+ * @param Data: the transfer buffer
+ * @param Length: the transfer length
+ * @param Timeout: the timeout of the transfer in ms
+ * @param Count: the amount of transferred bytes is written here (can be NULL)
+ * @return ERROR if the transfer is stalled (the URB state is STALL) or failed,
+ *         TIMEOUT if not completed in time, OK if completed
+ */
+XPD_ReturnType UsbHost_Transfer(UsbHost_DeviceType * hdev, uint8_t Channel,
+        void * Data, uint32_t Length, uint32_t Timeout, uint32_t * Count)
+{
+    return usbhost_transfer(hdev, Channel, FALSE, Data, Length, Timeout, Count);
+}
+
+/** @} */
+
+/** @} */
@@ -0,0 +1,198 @@
+/**
+  ******************************************************************************
+  * @file    usb_host_cdc.c
+  * @author  Benedek Kupper
+  * @version V0.1
+  * @date    2018-02-10
+  * @brief   STM32 eXtensible Peripheral Drivers USB Host Communications Device Class
+  *
+  *  This file is part of STM32_XPD.
+  *
+  *  STM32_XPD is free software: you can redistribute it and/or modify
+  *  it under the terms of the GNU General Public License as published by
+  *  the Free Software Foundation, either version 3 of the License, or
+  *  (at your option) any later version.
+  *
+  *  STM32_XPD is distributed in the hope that it will be useful,
+  *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with STM32_XPD.  If not, see <http://www.gnu.org/licenses/>.
+  */
+#include <usb_host_cdc.h>
+
+/** @addtogroup UsbCdc
+ * @{ */
+
+/** @defgroup UsbCdc_Private_Macros UsbCdc Private Macros
+ * @{ */
+
+#define USBCDC_COMM_CLASS           0x02
+#define USBCDC_ACM_SUBCLASS         0x02
+#define USBCDC_DATA_CLASS           0x0A
+
+#define USBCDC_REQ_SET_LINE_CODING  0x20
+#define USBCDC_REQ_SET_CONTROL_LINE 0x22
+
+#define USBCDC_CONTROL_LINE_DTR     0x01
+#define USBCDC_CONTROL_LINE_RTS     0x02
+
+/** @} */
+
+/** @defgroup UsbCdc_Exported_Functions UsbCdc Exported Functions
+ * @{ */
+
+/**
+ * @brief Initializes the ACM interfaces of the enumerated device,
+ *        and activates the DTR and RTS control lines.
+ * @param hcdc: pointer to the USB host CDC handle structure
+ * @param hdev: pointer to the enumerated USB host device handle structure
+ * @return ERROR if the device has no ACM interfaces or it fails to respond,
+ *         TIMEOUT if the request isn't completed in time, OK if initialized
+ */
+XPD_ReturnType UsbCdc_Init(UsbCdc_HandleType * hcdc, UsbHost_DeviceType * hdev)
+{
+    const uint8_t * comm = UsbHost_FindInterface(hdev, USBCDC_COMM_CLASS, USBCDC_ACM_SUBCLASS, USBHOST_ANY);
+    const uint8_t * data = UsbHost_FindInterface(hdev, USBCDC_DATA_CLASS, USBHOST_ANY, USBHOST_ANY);
+    XPD_ReturnType result = XPD_ERROR;
+
+    hcdc->Device  = hdev;
+    hcdc->BulkIn  = USBH_NO_CHANNEL;
+    hcdc->BulkOut = USBH_NO_CHANNEL;
+
+    if ((comm != NULL) && (data != NULL))
+    {
+        hcdc->Interface = comm[2];
+        hcdc->BulkIn  = UsbHost_OpenPipe(hdev, UsbHost_FindEndpoint(hdev, data, USB_EP_TYPE_BULK, TRUE));
+        hcdc->BulkOut = UsbHost_OpenPipe(hdev, UsbHost_FindEndpoint(hdev, data, USB_EP_TYPE_BULK, FALSE));
+
+        if ((hcdc->BulkIn != USBH_NO_CHANNEL) && (hcdc->BulkOut != USBH_NO_CHANNEL))
+        {
+            const UsbHost_SetupType setup = {
+                .bmRequestType = 0x21,
+                .bRequest      = USBCDC_REQ_SET_CONTROL_LINE,
+                .wValue        = USBCDC_CONTROL_LINE_DTR | USBCDC_CONTROL_LINE_RTS,
+                .wIndex        = hcdc->Interface,
+                .wLength       = 0,
+            };
+            result = UsbHost_Control(hdev, &setup, NULL);
+        }
+    }
+
+    if (result != XPD_OK)
+    {
+        UsbCdc_Deinit(hcdc);
+    }
+    return result;
+}
+
+/**
+ * @brief Releases the data pipes of the ACM interface, aborting the ongoing reception.
+ * @param hcdc: pointer to the USB host CDC handle structure
+ */
+void UsbCdc_Deinit(UsbCdc_HandleType * hcdc)
+{
+    UsbHost_ClosePipe(hcdc->Device, hcdc->BulkIn);
+    UsbHost_ClosePipe(hcdc->Device, hcdc->BulkOut);
+
+    hcdc->BulkIn  = USBH_NO_CHANNEL;
+    hcdc->BulkOut = USBH_NO_CHANNEL;
+}
+
+/**
+ * @brief Sets the serial line parameters of the device.
+ * @param hcdc: pointer to the USB host CDC handle structure
+ * @param LineCoding: the requested line coding
+ * @return The result of the request
+ */
+XPD_ReturnType UsbCdc_SetLineCoding(UsbCdc_HandleType * hcdc, const UsbCdc_LineCodingType * LineCoding)
+{
+    const UsbHost_SetupType setup = {
+        .bmRequestType = 0x21,
+        .bRequest      = USBCDC_REQ_SET_LINE_CODING,
+        .wValue        = 0,
+        .wIndex        = hcdc->Interface,
+        .wLength       = sizeof(hcdc->LineCoding),
+    };
+
+    hcdc->LineCoding[0] = LineCoding->dwDTERate;
+    hcdc->LineCoding[1] = LineCoding->dwDTERate >> 8;
+    hcdc->LineCoding[2] = LineCoding->dwDTERate >> 16;
+    hcdc->LineCoding[3] = LineCoding->dwDTERate >> 24;
+    hcdc->LineCoding[4] = LineCoding->bCharFormat;
+    hcdc->LineCoding[5] = LineCoding->bParityType;
+    hcdc->LineCoding[6] = LineCoding->bDataBits;
+
+    return UsbHost_Control(hcdc->Device, &setup, hcdc->LineCoding);
+}
+
+/**
+ * @brief Sends the data to the device, ending it with a zero length packet when necessary.
+ * @param hcdc: pointer to the USB host CDC handle structure
+ * @param Data: the data to send
+ * @param Length: the amount of bytes to send
+ * @return ERROR if the transfer failed, TIMEOUT if the device didn't accept
+ *         the data in time, OK if the data is sent
+ */
+XPD_ReturnType UsbCdc_Transmit(UsbCdc_HandleType * hcdc, const void * Data, uint32_t Length)
+{
+    uint16_t mps = hcdc->Device->husbh->Channel[hcdc->BulkOut].MaxPacketSize;
+    XPD_ReturnType result;
+
+    result = UsbHost_Transfer(hcdc->Device, hcdc->BulkOut, (void*)Data, Length, USBCDC_TIMEOUT, NULL);
+
+    /* A full last packet doesn't terminate the transfer */
+    if ((result == XPD_OK) && (Length > 0) && ((Length % mps) == 0))
+    {
+        result = UsbHost_Transfer(hcdc->Device, hcdc->BulkOut, NULL, 0, USBCDC_TIMEOUT, NULL);
+    }
+    return result;
+}
+
+/**
+ * @brief Starts the reception of data from the device in the background.
+ * @note  The reception is completed when the device sends a short packet
+ *        or the buffer is filled.
+ * @param hcdc: pointer to the USB host CDC handle structure
+ * @param Data: the receive buffer (shall be a multiple of the max packet size)
+ * @param Length: the size of the receive buffer
+ * @return BUSY if a reception is already ongoing, OK if started
+ */
+XPD_ReturnType UsbCdc_Receive(UsbCdc_HandleType * hcdc, void * Data, uint32_t Length)
+{
+    return XPD_USBH_Channel_Submit(hcdc->Device->husbh, hcdc->BulkIn, FALSE, Data, Length);
+}
+
+/**
+ * @brief Provides the state of the reception started by @ref UsbCdc_Receive.
+ * @param hcdc: pointer to the USB host CDC handle structure
+ * @param Count: the amount of received bytes is written here when completed
+ * @return BUSY while the reception is ongoing, ERROR if it failed, OK if completed
+ */
+XPD_ReturnType UsbCdc_GetReceived(UsbCdc_HandleType * hcdc, uint32_t * Count)
+{
+    XPD_ReturnType result;
+
+    switch (XPD_USBH_Channel_GetState(hcdc->Device->husbh, hcdc->BulkIn))
+    {
+        case USBH_URB_IDLE:
+            result = XPD_BUSY;
+            break;
+
+        case USBH_URB_DONE:
+            *Count = XPD_USBH_Channel_GetCount(hcdc->Device->husbh, hcdc->BulkIn);
+            result = XPD_OK;
+            break;
+
+        default:
+            result = XPD_ERROR;
+            break;
+    }
+    return result;
+}
+
+/** @} */
+
+/** @} */
@@ -0,0 +1,400 @@
+/**
+  ******************************************************************************
+  * @file    usb_host_msc.c
+  * @author  Benedek Kupper
+  * @version V0.1
+  * @date    2018-02-10
+  * @brief   STM32 eXtensible Peripheral Drivers USB Host Mass Storage Class
+  *
+  *  @verbatim
+  *
+  *          ===================================================================
+  *                            Bulk-Only Transport
+  *          ===================================================================
+  *           Each SCSI command is sent in a Command Block Wrapper, followed by
+  *           the optional data stage and the Command Status Wrapper. A stalled
+  *           data stage is cleared before reading the status, and a stalled
+  *           status read is retried once after clearing the halt. An invalid
+  *           status or a phase error is handled by reset recovery:
+  *           the Bulk-Only Mass Storage Reset request, then clearing
+  *           both bulk endpoints.
+  *  @endverbatim
+  *
+  *  This file is part of STM32_XPD.
+  *
+  *  STM32_XPD is free software: you can redistribute it and/or modify
+  *  it under the terms of the GNU General Public License as published by
+  *  the Free Software Foundation, either version 3 of the License, or
+  *  (at your option) any later version.
+  *
+  *  STM32_XPD is distributed in the hope that it will be useful,
+  *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with STM32_XPD.  If not, see <http://www.gnu.org/licenses/>.
+  */
+#include <usb_host_msc.h>
+#include <xpd_utils.h>
+#include <string.h>
+
+/** @addtogroup UsbMsc
+ * @{ */
+
+/** @defgroup UsbMsc_Private_Macros UsbMsc Private Macros
+ * @{ */
+
+#define USBMSC_CLASS                0x08
+#define USBMSC_SUBCLASS_SCSI        0x06
+#define USBMSC_PROTOCOL_BOT         0x50
+
+#define USBMSC_REQ_RESET            0xFF
+#define USBMSC_REQ_GET_MAX_LUN      0xFE
+
+#define USBMSC_CBW_SIGNATURE        0x43425355
+#define USBMSC_CSW_SIGNATURE        0x53425355
+
+#define USBMSC_CSW_PASSED           0x00
+#define USBMSC_CSW_FAILED           0x01
+#define USBMSC_CSW_PHASE_ERROR      0x02
+
+#define SCSI_TEST_UNIT_READY        0x00
+#define SCSI_REQUEST_SENSE          0x03
+#define SCSI_INQUIRY                0x12
+#define SCSI_READ_CAPACITY10        0x25
+#define SCSI_READ10                 0x28
+#define SCSI_WRITE10                0x2A
+
+#define SCSI_SENSE_LENGTH           18
+#define SCSI_INQUIRY_LENGTH         36
+
+/** @} */
+
+__STATIC_INLINE void usbmsc_putLE32(uint8_t * Buffer, uint32_t Value)
+{
+    Buffer[0] = Value;
+    Buffer[1] = Value >> 8;
+    Buffer[2] = Value >> 16;
+    Buffer[3] = Value >> 24;
+}
+
+__STATIC_INLINE uint32_t usbmsc_getLE32(const uint8_t * Buffer)
+{
+    return Buffer[0] | ((uint32_t)Buffer[1] << 8) | ((uint32_t)Buffer[2] << 16) | ((uint32_t)Buffer[3] << 24);
+}
+
+__STATIC_INLINE uint32_t usbmsc_getBE32(const uint8_t * Buffer)
+{
+    return ((uint32_t)Buffer[0] << 24) | ((uint32_t)Buffer[1] << 16) | ((uint32_t)Buffer[2] << 8) | Buffer[3];
+}
+
+/* Determines whether the last transfer of the channel was stalled */
+__STATIC_INLINE boolean_t usbmsc_stalled(UsbMsc_HandleType * hmsc, uint8_t Channel)
+{
+    return XPD_USBH_Channel_GetState(hmsc->Device->husbh, Channel) == USBH_URB_STALL;
+}
+
+/* Bulk-Only Mass Storage Reset, then clear both endpoints */
+static void usbmsc_resetRecovery(UsbMsc_HandleType * hmsc)
+{
+    const UsbHost_SetupType setup = {
+        .bmRequestType = 0x21,
+        .bRequest      = USBMSC_REQ_RESET,
+        .wValue        = 0,
+        .wIndex        = hmsc->Interface,
+        .wLength       = 0,
+    };
+
+    (void) UsbHost_Control(hmsc->Device, &setup, NULL);
+    (void) UsbHost_ClearHalt(hmsc->Device, hmsc->BulkIn);
+    (void) UsbHost_ClearHalt(hmsc->Device, hmsc->BulkOut);
+}
+
+/* Read the command status, retrying once if the endpoint is stalled */
+static XPD_ReturnType usbmsc_readStatus(UsbMsc_HandleType * hmsc)
+{
+    XPD_ReturnType result;
+    uint32_t count = 0;
+    uint8_t retry;
+
+    for (retry = 0; retry < 2; retry++)
+    {
+        result = UsbHost_Transfer(hmsc->Device, hmsc->BulkIn, hmsc->CSW, sizeof(hmsc->CSW),
+                USBMSC_TIMEOUT, &count);
+
+        if ((result == XPD_ERROR) && usbmsc_stalled(hmsc, hmsc->BulkIn))
+        {
+            (void) UsbHost_ClearHalt(hmsc->Device, hmsc->BulkIn);
+        }
+        else
+        {
+            break;
+        }
+    }
+
+    /* The status has to be valid and meaningful */
+    if ((result == XPD_OK) && ((count != sizeof(hmsc->CSW))
+            || (usbmsc_getLE32(&hmsc->CSW[0]) != USBMSC_CSW_SIGNATURE)
+            || (usbmsc_getLE32(&hmsc->CSW[4]) != hmsc->Tag)
+            || (hmsc->CSW[12] > USBMSC_CSW_PHASE_ERROR)))
+    {
+        result = XPD_ERROR;
+    }
+    return result;
+}
+
+/* Execute a SCSI command with the Bulk-Only Transport */
+static XPD_ReturnType usbmsc_command(UsbMsc_HandleType * hmsc, const uint8_t * Command,
+        uint8_t CommandLength, void * Data, uint32_t Length, boolean_t In)
+{
+    XPD_ReturnType result;
+
+    usbmsc_putLE32(&hmsc->CBW[0], USBMSC_CBW_SIGNATURE);
+    usbmsc_putLE32(&hmsc->CBW[4], ++hmsc->Tag);
+    usbmsc_putLE32(&hmsc->CBW[8], Length);
+    hmsc->CBW[12] = (In != FALSE) ? 0x80 : 0x00;
+    hmsc->CBW[13] = hmsc->Lun;
+    hmsc->CBW[14] = CommandLength;
+    memset(&hmsc->CBW[15], 0, 16);
+    memcpy(&hmsc->CBW[15], Command, CommandLength);
+
+    result = UsbHost_Transfer(hmsc->Device, hmsc->BulkOut, hmsc->CBW, sizeof(hmsc->CBW),
+            USBMSC_TIMEOUT, NULL);
+
+    /* The device ends a data stage early by stalling the endpoint */
+    if ((result == XPD_OK) && (Length > 0))
+    {
+        uint8_t channel = (In != FALSE) ? hmsc->BulkIn : hmsc->BulkOut;
+
+        result = UsbHost_Transfer(hmsc->Device, channel, Data, Length, USBMSC_TIMEOUT, NULL);
+
+        if ((result == XPD_ERROR) && usbmsc_stalled(hmsc, channel))
+        {
+            result = UsbHost_ClearHalt(hmsc->Device, channel);
+        }
+    }
+
+    if (result == XPD_OK)
+    {
+        result = usbmsc_readStatus(hmsc);
+    }
+
+    if ((result != XPD_OK) || (hmsc->CSW[12] == USBMSC_CSW_PHASE_ERROR))
+    {
+        usbmsc_resetRecovery(hmsc);
+        if (result == XPD_OK)
+        {
+            result = XPD_ERROR;
+        }
+    }
+    else if (hmsc->CSW[12] == USBMSC_CSW_FAILED)
+    {
+        result = XPD_ERROR;
+    }
+    return result;
+}
+
+/** @defgroup UsbMsc_Exported_Functions UsbMsc Exported Functions
+ * @{ */
+
+/**
+ * @brief Initializes the mass storage interface of the enumerated device,
+ *        and reads the capacity of the first logical unit.
+ * @param hmsc: pointer to the USB host mass storage handle structure
+ * @param hdev: pointer to the enumerated USB host device handle structure
+ * @return ERROR if the device has no SCSI Bulk-Only interface or it fails to respond,
+ *         TIMEOUT if the unit doesn't become ready, OK if it's ready for block access
+ */
+XPD_ReturnType UsbMsc_Init(UsbMsc_HandleType * hmsc, UsbHost_DeviceType * hdev)
+{
+    UsbHost_SetupType setup = {
+        .bmRequestType = 0xA1,
+        .bRequest      = USBMSC_REQ_GET_MAX_LUN,
+        .wValue        = 0,
+        .wLength       = 1,
+    };
+    const uint8_t * intf = UsbHost_FindInterface(hdev, USBMSC_CLASS,
+            USBMSC_SUBCLASS_SCSI, USBMSC_PROTOCOL_BOT);
+    XPD_ReturnType result = XPD_ERROR;
+    uint8_t command[10];
+    uint8_t retry;
+
+    hmsc->Device     = hdev;
+    hmsc->BulkIn     = USBH_NO_CHANNEL;
+    hmsc->BulkOut    = USBH_NO_CHANNEL;
+    hmsc->MaxLun     = 0;
+    hmsc->Lun        = 0;
+    hmsc->BlockCount = 0;
+    hmsc->BlockSize  = 0;
+
+    if (intf != NULL)
+    {
+        hmsc->Interface = intf[2];
+        hmsc->BulkIn  = UsbHost_OpenPipe(hdev, UsbHost_FindEndpoint(hdev, intf, USB_EP_TYPE_BULK, TRUE));
+        hmsc->BulkOut = UsbHost_OpenPipe(hdev, UsbHost_FindEndpoint(hdev, intf, USB_EP_TYPE_BULK, FALSE));
+
+        if ((hmsc->BulkIn != USBH_NO_CHANNEL) && (hmsc->BulkOut != USBH_NO_CHANNEL))
+        {
+            result = XPD_OK;
+        }
+    }
+
+    /* Single unit devices may stall the request */
+    if (result == XPD_OK)
+    {
+        setup.wIndex = hmsc->Interface;
+        if (UsbHost_Control(hdev, &setup, hmsc->Buffer) == XPD_OK)
+        {
+            hmsc->MaxLun = hmsc->Buffer[0];
+        }
+
+        memset(command, 0, sizeof(command));
+        command[0] = SCSI_INQUIRY;
+        command[4] = SCSI_INQUIRY_LENGTH;
+        result = usbmsc_command(hmsc, command, 6, hmsc->Buffer, SCSI_INQUIRY_LENGTH, TRUE);
+    }
+
+    /* The unit reports the media change at first */
+    for (retry = 0; (result == XPD_OK) && (retry < USBMSC_READY_RETRIES); retry++)
+    {
+        if (UsbMsc_TestUnitReady(hmsc) == XPD_OK)
+        {
+            break;
+        }
+        result = UsbMsc_RequestSense(hmsc);
+        XPD_Delay_ms(100);
+    }
+    if (retry == USBMSC_READY_RETRIES)
+    {
+        result = XPD_TIMEOUT;
+    }
+
+    if (result == XPD_OK)
+    {
+        memset(command, 0, sizeof(command));
+        command[0] = SCSI_READ_CAPACITY10;
+        result = usbmsc_command(hmsc, command, 10, hmsc->Buffer, 8, TRUE);
+    }
+
+    if (result == XPD_OK)
+    {
+        hmsc->BlockCount = usbmsc_getBE32(&hmsc->Buffer[0]) + 1;
+        hmsc->BlockSize  = usbmsc_getBE32(&hmsc->Buffer[4]);
+    }
+    else
+    {
+        UsbMsc_Deinit(hmsc);
+    }
+    return result;
+}
+
+/**
+ * @brief Releases the bulk pipes of the mass storage interface.
+ * @param hmsc: pointer to the USB host mass storage handle structure
+ */
+void UsbMsc_Deinit(UsbMsc_HandleType * hmsc)
+{
+    UsbHost_ClosePipe(hmsc->Device, hmsc->BulkIn);
+    UsbHost_ClosePipe(hmsc->Device, hmsc->BulkOut);
+
+    hmsc->BulkIn  = USBH_NO_CHANNEL;
+    hmsc->BulkOut = USBH_NO_CHANNEL;
+}
+
+/**
+ * @brief Checks whether the logical unit is ready for access.
+ * @param hmsc: pointer to the USB host mass storage handle structure
+ * @return ERROR if the unit isn't ready (see @ref UsbMsc_RequestSense), OK if ready
+ */
+XPD_ReturnType UsbMsc_TestUnitReady(UsbMsc_HandleType * hmsc)
+{
+    const uint8_t command[6] = { SCSI_TEST_UNIT_READY };
+
+    return usbmsc_command(hmsc, command, sizeof(command), NULL, 0, FALSE);
+}
+
+/**
+ * @brief Reads the sense data of the last failed command into the handle.
+ * @param hmsc: pointer to the USB host mass storage handle structure
+ * @return The result of the command
+ */
+XPD_ReturnType UsbMsc_RequestSense(UsbMsc_HandleType * hmsc)
+{
+    const uint8_t command[6] = { SCSI_REQUEST_SENSE, 0, 0, 0, SCSI_SENSE_LENGTH };
+    XPD_ReturnType result;
+
+    result = usbmsc_command(hmsc, command, sizeof(command), hmsc->Buffer, SCSI_SENSE_LENGTH, TRUE);
+    if (result == XPD_OK)
+    {
+        hmsc->SenseKey = hmsc->Buffer[2] & 0x0F;
+        hmsc->ASC      = hmsc->Buffer[12];
+        hmsc->ASCQ     = hmsc->Buffer[13];
+    }
+    return result;
+}
+
+/* Build a READ(10) or WRITE(10) command block */
+static void usbmsc_blockCommand(uint8_t * Command, uint8_t Code, uint32_t Block, uint16_t Count)
+{
+    memset(Command, 0, 10);
+    Command[0] = Code;
+    Command[2] = Block >> 24;
+    Command[3] = Block >> 16;
+    Command[4] = Block >> 8;
+    Command[5] = Block;
+    Command[7] = Count >> 8;
+    Command[8] = Count;
+}
+
+/**
+ * @brief Reads consecutive blocks from the logical unit.
+ * @param hmsc: pointer to the USB host mass storage handle structure
+ * @param Block: the address of the first block
+ * @param Data: the buffer of Count * BlockSize bytes
+ * @param Count: the number of blocks to read
+ * @return ERROR if the command failed (the sense data is read), TIMEOUT if the device
+ *         doesn't respond in time, OK if the blocks are read
+ */
+XPD_ReturnType UsbMsc_Read(UsbMsc_HandleType * hmsc, uint32_t Block, void * Data, uint16_t Count)
+{
+    uint8_t command[10];
+    XPD_ReturnType result;
+
+    usbmsc_blockCommand(command, SCSI_READ10, Block, Count);
+
+    result = usbmsc_command(hmsc, command, sizeof(command), Data, Count * hmsc->BlockSize, TRUE);
+    if (result == XPD_ERROR)
+    {
+        (void) UsbMsc_RequestSense(hmsc);
+    }
+    return result;
+}
+
+/**
+ * @brief Writes consecutive blocks to the logical unit.
+ * @param hmsc: pointer to the USB host mass storage handle structure
+ * @param Block: the address of the first block
+ * @param Data: the data of Count * BlockSize bytes
+ * @param Count: the number of blocks to write
+ * @return ERROR if the command failed (the sense data is read), TIMEOUT if the device
+ *         doesn't respond in time, OK if the blocks are written
+ */
+XPD_ReturnType UsbMsc_Write(UsbMsc_HandleType * hmsc, uint32_t Block, const void * Data, uint16_t Count)
+{
+    uint8_t command[10];
+    XPD_ReturnType result;
+
+    usbmsc_blockCommand(command, SCSI_WRITE10, Block, Count);
+
+    result = usbmsc_command(hmsc, command, sizeof(command), (void*)Data, Count * hmsc->BlockSize, FALSE);
+    if (result == XPD_ERROR)
+    {
+        (void) UsbMsc_RequestSense(hmsc);
+    }
+    return result;
+}
+
+/** @} */
+
+/** @} */
@@ -0,0 +1,842 @@
+/**
+  ******************************************************************************
+  * @file    bench.c
+  * @author  Benedek Kupper
+  * @version V0.1
+  * @date    2018-01-20
+  * @brief   STM32 eXtensible Peripheral Drivers Benchmarks Project
+  *
+  *  @verbatim
+  *
+  *          ===================================================================
+  *                                  Driver benchmarks
+  *          ===================================================================
+  *           Each benchmark measures the elapsed core clock cycles of a driver
+  *           operation using the XPD tick counter, and prints the result
+  *           on the console. The peripherals are initialized on demand
+  *           and deinitialized after the measurement.
+  *           The loopback benchmarks require external wiring:
+  *            - UART: TX connected to RX
+  *            - SPI: MOSI connected to MISO
+  *           When the loopback is missing, the transfer is reported as failed.
+  *  @endverbatim
+  *
+  *  This file is part of STM32_XPD.
+  *
+  *  STM32_XPD is free software: you can redistribute it and/or modify
+  *  it under the terms of the GNU General Public License as published by
+  *  the Free Software Foundation, either version 3 of the License, or
+  *  (at your option) any later version.
+  *
+  *  STM32_XPD is distributed in the hope that it will be useful,
+  *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with STM32_XPD.  If not, see <http://www.gnu.org/licenses/>.
+  */
+#include <bench.h>
+#include <usbd_cdc_if.h>
+#include <xpd_bsp.h>
+#include <xpd_utils.h>
+
+#define BENCH_STREAM_COUNT      256
+#define BENCH_FLASH_SIZE        1024
+#define BENCH_UART_SIZE         4096
+#define BENCH_UART_RING_SIZE    256
+#define BENCH_SPI_SIZE          1024
+#define BENCH_ADC_BLOCK_SIZE    256
+#define BENCH_ADC_TIME_MS       100
+#define BENCH_CAN_FRAMES        1000
+#define BENCH_USB_IN_SIZE       (512 * 1024)
+#define BENCH_USB_OUT_IDLE_MS   1000
+#define BENCH_ADC_USB_TIME_MS   1000
+#define BENCH_LOAD_BAUDRATE     2000000
+#define BENCH_LATENCY_TIME_MS   500
+#define BENCH_LATENCY_RATE      20000
+#define BENCH_LATENCY_BINS      16
+#define BENCH_LATENCY_BIN_NS    250
+
+/* Shared transfer buffers */
+static uint32_t bench_txBuffer[BENCH_UART_SIZE / 4];
+static uint32_t bench_rxBuffer[BENCH_UART_SIZE / 4];
+
+static volatile boolean_t bench_done;
+static volatile uint32_t bench_blocks;
+static volatile uint32_t bench_overruns;
+static volatile boolean_t bench_loadActive;
+static uint32_t bench_histogram[BENCH_LATENCY_BINS];
+
+/* Converts a number to decimal string, returns the start of the string */
+static char * bench_utoa(uint32_t Value, char * Buffer, uint8_t Size)
+{
+    char * str = &Buffer[Size - 1];
+
+    *str = '\0';
+    do {
+        *(--str) = '0' + (Value % 10);
+        Value /= 10;
+    } while ((Value > 0) && (str > Buffer));
+
+    return str;
+}
+
+/* Prints a single result line: name: value unit */
+static void bench_printResult(const char * Name, uint32_t Value, const char * Unit)
+{
+    char num[12];
+
+    CDC_Print(Name);
+    CDC_Print(": ");
+    CDC_Print(bench_utoa(Value, num, sizeof(num)));
+    CDC_Print(" ");
+    CDC_Print(Unit);
+    CDC_Print("\r\n");
+}
+
+/* Prints a failed benchmark line */
+static void bench_printFailure(const char * Name, XPD_ReturnType Result)
+{
+    char num[12];
+
+    CDC_Print(Name);
+    CDC_Print(": FAILED (");
+    CDC_Print(bench_utoa(Result, num, sizeof(num)));
+    CDC_Print(")\r\n");
+}
+
+/* Converts elapsed core clock cycles to microseconds */
+static uint32_t bench_cyclesToUs(uint64_t Cycles)
+{
+    return (uint32_t)((Cycles * 1000000) / SystemCoreClock);
+}
+
+/* Calculates the rate of events per second */
+static uint32_t bench_rate(uint32_t Count, uint64_t Cycles)
+{
+    return (Cycles > 0) ? (uint32_t)(((uint64_t)Count * SystemCoreClock) / Cycles) : 0;
+}
+
+/* Fills the transmit buffer with a pattern, clears the receive buffer */
+static void bench_prepareBuffers(uint16_t Length)
+{
+    uint8_t * tx = (uint8_t*)bench_txBuffer;
+    uint8_t * rx = (uint8_t*)bench_rxBuffer;
+    uint16_t i;
+
+    for (i = 0; i < Length; i++)
+    {
+        tx[i] = (uint8_t)(i * 7 + 1);
+        rx[i] = 0;
+    }
+}
+
+/* Compares the receive buffer to the transmit buffer */
+static boolean_t bench_checkBuffers(uint16_t Length)
+{
+    uint8_t * tx = (uint8_t*)bench_txBuffer;
+    uint8_t * rx = (uint8_t*)bench_rxBuffer;
+    uint16_t i;
+
+    for (i = 0; i < Length; i++)
+    {
+        if (tx[i] != rx[i])
+        {
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
+
+/* Completion callback of the interrupt and DMA driven transfers */
+static void bench_transferComplete(void * handle)
+{
+    bench_done = TRUE;
+}
+
+/* Waits for the completion callback, with timeout in ms */
+static XPD_ReturnType bench_waitDone(uint32_t Timeout)
+{
+    uint64_t deadline = XPD_GetTicks64() + (uint64_t)Timeout * (SystemCoreClock / 1000);
+
+    while (bench_done == FALSE)
+    {
+        if (XPD_GetTicks64() > deadline)
+        {
+            return XPD_TIMEOUT;
+        }
+    }
+    return XPD_OK;
+}
+
+/* Measures the data stream register access helpers for each element size */
+static void bench_streams(void)
+{
+    static const char * const names[] = {
+        "ReadToStream 8 bit", "ReadToStream 16 bit", "ReadToStream 32 bit",
+        "WriteFromStream 8 bit", "WriteFromStream 16 bit", "WriteFromStream 32 bit" };
+    volatile uint32_t reg = 0x5A5A5A5A;
+    DataStreamType stream;
+    uint64_t start, cycles;
+    uint8_t size, i;
+    uint16_t j;
+
+    for (i = 0; i < 6; i++)
+    {
+        size = 1 << (i % 3);
+        stream.buffer = bench_rxBuffer;
+        stream.length = BENCH_STREAM_COUNT;
+        stream.size   = size;
+
+        start = XPD_GetTicks64();
+        if (i < 3)
+        {
+            for (j = 0; j < BENCH_STREAM_COUNT; j++)
+            {
+                XPD_ReadToStream(&reg, &stream);
+            }
+        }
+        else
+        {
+            for (j = 0; j < BENCH_STREAM_COUNT; j++)
+            {
+                XPD_WriteFromStream(&reg, &stream);
+            }
+        }
+        cycles = XPD_GetTicks64() - start;
+
+        bench_printResult(names[i], (uint32_t)(cycles / BENCH_STREAM_COUNT), "cycles/element");
+    }
+}
+
+/* Measures the erase and programming time of the reserved flash area */
+static void bench_flash(void)
+{
+    XPD_ReturnType result;
+    uint64_t start, cycles;
+
+    bench_prepareBuffers(BENCH_FLASH_SIZE);
+
+    XPD_FLASH_Unlock();
+
+    start = XPD_GetTicks64();
+    result = XPD_FLASH_Erase(BENCH_FLASH_ADDRESS, BENCH_FLASH_KBYTES);
+    cycles = XPD_GetTicks64() - start;
+
+    if (result != XPD_OK)
+    {
+        bench_printFailure("FLASH erase", result);
+    }
+    else
+    {
+        bench_printResult("FLASH erase", bench_cyclesToUs(cycles), "us");
+
+        start = XPD_GetTicks64();
+        result = XPD_FLASH_Program(BENCH_FLASH_ADDRESS, bench_txBuffer, BENCH_FLASH_SIZE);
+        cycles = XPD_GetTicks64() - start;
+
+        if (result != XPD_OK)
+        {
+            bench_printFailure("FLASH program", result);
+        }
+        else
+        {
+            bench_printResult("FLASH program 1 kB", bench_cyclesToUs(cycles), "us");
+            bench_printResult("FLASH program rate", bench_rate(BENCH_FLASH_SIZE, cycles), "B/s");
+        }
+    }
+
+    XPD_FLASH_Lock();
+}
+
+/* UART loopback setup of the throughput and load generation */
+static const USART_InitType bench_serialConfig = {
+    .Transmitter   = ENABLE,
+    .Receiver      = ENABLE,
+    .DataSize      = 8,
+    .StopBits      = USART_STOPBITS_1,
+    .SingleSample  = DISABLE,
+    .Parity        = USART_PARITY_NONE,
+};
+static const UART_InitType bench_uartConfig = {
+    .FlowControl   = UART_FLOWCONTROL_NONE,
+    .OverSampling8 = ENABLE,
+    .HalfDuplex    = DISABLE,
+};
+
+/* Measures the UART DMA loopback throughput at different baudrates */
+static void bench_uart(void)
+{
+    static const uint32_t baudrates[] = { 115200, 1000000, 2000000 };
+    USART_InitType config = bench_serialConfig;
+    uint8_t * rx = (uint8_t*)bench_rxBuffer;
+    uint8_t i;
+
+    bench_prepareBuffers(BENCH_UART_SIZE);
+
+    for (i = 0; i < sizeof(baudrates) / sizeof(baudrates[0]); i++)
+    {
+        XPD_ReturnType result;
+        uint64_t start, now, deadline;
+        uint16_t received = 0, length;
+        void * data;
+
+        config.BaudRate = baudrates[i];
+        (void) XPD_UART_Init(&uart, &config, &bench_uartConfig);
+        XPD_USART_ClearFlag(&uart, RXNE);
+
+        /* The ring uses the upper part of the receive buffer */
+        result = XPD_USART_RxRing_Start(&uart, &rx[BENCH_UART_SIZE - BENCH_UART_RING_SIZE],
+                BENCH_UART_RING_SIZE);
+
+        /* Allow twice the nominal transfer time */
+        start    = XPD_GetTicks64();
+        deadline = start + (((uint64_t)BENCH_UART_SIZE * 20 * SystemCoreClock) / baudrates[i]);
+
+        if (result == XPD_OK)
+        {
+            result = XPD_USART_Transmit_DMA(&uart, bench_txBuffer, BENCH_UART_SIZE);
+        }
+
+        for (now = start; (result == XPD_OK) && (received < BENCH_UART_SIZE); )
+        {
+            length = XPD_USART_RxRing_Peek(&uart, &data);
+            if (length > 0)
+            {
+                XPD_USART_RxRing_Consume(&uart, length);
+                received += length;
+            }
+            now = XPD_GetTicks64();
+            if (now > deadline)
+            {
+                result = XPD_TIMEOUT;
+            }
+        }
+
+        XPD_USART_RxRing_Stop(&uart);
+        (void) XPD_USART_Deinit(&uart);
+
+        CDC_Print((i == 0) ? "UART 115200 baud" : (i == 1) ? "UART 1 Mbaud" : "UART 2 Mbaud");
+        if (result != XPD_OK)
+        {
+            bench_printFailure(" DMA loopback", result);
+        }
+        else
+        {
+            bench_printResult(" DMA loopback", bench_rate(received, now - start), "B/s");
+        }
+    }
+}
+
+/* Measures the SPI loopback throughput in polling, interrupt and DMA mode */
+static void bench_spi(void)
+{
+    static const char * const names[] = {
+        "SPI polling", "SPI interrupt", "SPI DMA" };
+    const SPI_InitType spiConfig = {
+        .Mode            = SPI_MODE_MASTER,
+        .Channel         = SPI_CHANNEL_FULL_DUPLEX,
+        .DataSize        = 8,
+        .Format          = SPI_FORMAT_MSB_FIRST,
+        .TI_Mode         = DISABLE,
+        .NSS             = SPI_NSS_SOFT,
+        .Clock.Polarity  = ACTIVE_HIGH,
+        .Clock.Phase     = CLOCK_PHASE_1EDGE,
+        .Clock.Prescaler = CLK_DIV8,
+    };
+    uint8_t i;
+
+    (void) XPD_SPI_Init(&spi, &spiConfig);
+    spi.Callbacks.Receive = bench_transferComplete;
+
+    for (i = 0; i < 3; i++)
+    {
+        XPD_ReturnType result = XPD_OK;
+        uint64_t start, cycles;
+
+        bench_prepareBuffers(BENCH_SPI_SIZE);
+        bench_done = FALSE;
+
+        start = XPD_GetTicks64();
+        switch (i)
+        {
+            case 0:
+                result = XPD_SPI_TransmitReceive(&spi, bench_txBuffer, bench_rxBuffer,
+                        BENCH_SPI_SIZE, 100);
+                break;
+            case 1:
+                XPD_SPI_TransmitReceive_IT(&spi, bench_txBuffer, bench_rxBuffer, BENCH_SPI_SIZE);
+                result = bench_waitDone(100);
+                break;
+            default:
+                result = XPD_SPI_TransmitReceive_DMA(&spi, bench_txBuffer, bench_rxBuffer,
+                        BENCH_SPI_SIZE);
+                if (result == XPD_OK)
+                {
+                    result = bench_waitDone(100);
+                }
+                break;
+        }
+        cycles = XPD_GetTicks64() - start;
+
+        if ((result == XPD_OK) && (bench_checkBuffers(BENCH_SPI_SIZE) == FALSE))
+        {
+            result = XPD_ERROR;
+        }
+
+        if (result != XPD_OK)
+        {
+            bench_printFailure(names[i], result);
+        }
+        else
+        {
+            bench_printResult(names[i], bench_rate(BENCH_SPI_SIZE, cycles), "B/s");
+        }
+    }
+
+    (void) XPD_SPI_Deinit(&spi);
+}
+
+/* Counts the filled blocks of the ADC stream */
+static void bench_adcBlockReady(void * handle)
+{
+    bench_blocks++;
+}
+
+/* Measures the maximal continuous ADC conversion rate with DMA streaming */
+static void bench_adc(void)
+{
+    XPD_ReturnType result;
+    uint64_t start, cycles;
+
+    (void) XPD_ADC_Init(&adc, &AdcConfig);
+    XPD_ADC_ChannelConfig(&adc, &AdcChannel, 1);
+    adc.Callbacks.BlockReady = bench_adcBlockReady;
+
+    bench_blocks = 0;
+
+    start = XPD_GetTicks64();
+    result = XPD_ADC_Stream_Start(&adc, bench_rxBuffer, BENCH_ADC_BLOCK_SIZE);
+    if (result == XPD_OK)
+    {
+        XPD_Delay_ms(BENCH_ADC_TIME_MS);
+        XPD_ADC_Stop_DMA(&adc);
+    }
+    cycles = XPD_GetTicks64() - start;
+
+    (void) XPD_ADC_Deinit(&adc);
+
+    if (result != XPD_OK)
+    {
+        bench_printFailure("ADC DMA stream", result);
+    }
+    else
+    {
+        bench_printResult("ADC DMA stream", bench_rate(bench_blocks * BENCH_ADC_BLOCK_SIZE, cycles),
+                "samples/s");
+    }
+}
+
+#ifdef USE_XPD_CAN
+/* Measures the CAN frame rate in silent loopback mode */
+static void bench_can(void)
+{
+    const CAN_FilterType acceptAll = {
+        .Mask    = 0,
+        .Pattern = { .Value = 0, .Type = CAN_IDTYPE_STD_DATA },
+        .Mode    = CAN_FILTER_MASK_ANYTYPE,
+        .FIFO    = 0,
+    };
+    CAN_FrameType txFrame = {
+        .Data.Word = { 0x01234567, 0x89ABCDEF },
+        .Id        = { .Value = 0x123, .Type = CAN_IDTYPE_STD_DATA },
+        .DLC       = 8,
+    };
+    CAN_FrameType rxFrame;
+    XPD_ReturnType result;
+    uint64_t start, cycles;
+    uint8_t matchIndex;
+    uint16_t i;
+
+    result = XPD_CAN_Init(&can, &CanConfig);
+    if (result == XPD_OK)
+    {
+        result = XPD_CAN_FilterConfig(&can, &acceptAll, &matchIndex, 1);
+    }
+
+    start = XPD_GetTicks64();
+    for (i = 0; (i < BENCH_CAN_FRAMES) && (result == XPD_OK); i++)
+    {
+        result = XPD_CAN_Transmit(&can, &txFrame, 10);
+        if (result == XPD_OK)
+        {
+            result = XPD_CAN_Receive(&can, &rxFrame, 0, 10);
+        }
+    }
+    cycles = XPD_GetTicks64() - start;
+
+    (void) XPD_CAN_Deinit(&can);
+
+    if (result != XPD_OK)
+    {
+        bench_printFailure("CAN loopback", result);
+    }
+    else
+    {
+        bench_printResult("CAN loopback 1 Mbit/s", bench_rate(BENCH_CAN_FRAMES, cycles), "frames/s");
+    }
+}
+#endif
+
+/* Hands the filled ADC block to the USB IN endpoint in place.
+ * The ADC DMA and USB interrupts have the same priority, so they don't preempt each other. */
+static void bench_adcUsbBlockReady(void * handle)
+{
+    ADC_HandleType * hadc = handle;
+
+    /* If the previous block is still in transfer, the DMA is already overwriting it */
+    if (CDC_Send(hadc->Block.buffer, hadc->Block.length * hadc->Block.size) != FALSE)
+    {
+        bench_blocks++;
+    }
+    else
+    {
+        bench_overruns++;
+    }
+}
+
+/* Keeps the UART DMA loopback running while the load is active */
+static void bench_uartLoadDone(void * handle)
+{
+    if (bench_loadActive != FALSE)
+    {
+        (void) XPD_USART_Transmit_DMA(&uart, bench_txBuffer, BENCH_UART_SIZE);
+    }
+}
+
+/* Starts the background load: continuous UART DMA loopback and ADC streaming on USB IN */
+static XPD_ReturnType bench_loadStart(void)
+{
+    USART_InitType config = bench_serialConfig;
+    uint8_t * rx = (uint8_t*)bench_rxBuffer;
+    XPD_ReturnType result;
+
+    bench_prepareBuffers(BENCH_UART_SIZE);
+    bench_blocks     = 0;
+    bench_overruns   = 0;
+    bench_loadActive = TRUE;
+
+    config.BaudRate = BENCH_LOAD_BAUDRATE;
+    (void) XPD_UART_Init(&uart, &config, &bench_uartConfig);
+    XPD_USART_ClearFlag(&uart, RXNE);
+    uart.Callbacks.Transmit = bench_uartLoadDone;
+
+    /* The ring uses the upper part of the receive buffer, the ADC blocks the lower part */
+    result = XPD_USART_RxRing_Start(&uart, &rx[BENCH_UART_SIZE - BENCH_UART_RING_SIZE],
+            BENCH_UART_RING_SIZE);
+    if (result == XPD_OK)
+    {
+        result = XPD_USART_Transmit_DMA(&uart, bench_txBuffer, BENCH_UART_SIZE);
+    }
+
+    (void) XPD_ADC_Init(&adc, &AdcConfig);
+    XPD_ADC_ChannelConfig(&adc, &AdcStreamChannel, 1);
+    adc.Callbacks.BlockReady = bench_adcUsbBlockReady;
+    if (result == XPD_OK)
+    {
+        result = XPD_ADC_Stream_Start(&adc, bench_rxBuffer, BENCH_ADC_BLOCK_SIZE);
+    }
+    return result;
+}
+
+/* Stops the background load */
+static void bench_loadStop(void)
+{
+    bench_loadActive = FALSE;
+
+    XPD_ADC_Stop_DMA(&adc);
+    XPD_USART_Stop_DMA(&uart);
+    XPD_USART_RxRing_Stop(&uart);
+
+    /* Wait for the last block to be sent */
+    while ((CDC_IsSending() != FALSE) && (CDC_IsConnected() != FALSE))
+    {
+    }
+
+    (void) XPD_ADC_Deinit(&adc);
+    (void) XPD_USART_Deinit(&uart);
+    uart.Callbacks.Transmit = NULL;
+}
+
+/* Converts latency timer counts to nanoseconds */
+static uint32_t bench_countsToNs(uint32_t Counts)
+{
+    return (uint32_t)(((uint64_t)Counts * 1000000000) / latencyTimer.CounterFreq);
+}
+
+/* Measures the latency of the timer interrupt at the selected priority
+ * while the load is running, and prints the statistics with the histogram */
+static void bench_latencyLevel(const char * Name, uint8_t Priority)
+{
+    uint64_t deadline;
+    uint32_t average;
+    uint16_t length;
+    uint8_t i;
+    void * data;
+
+    /* Without priority grouping (Cortex-M0) the subpriority argument is the priority */
+    XPD_NVIC_SetPriorityConfig(LATENCY_TIM_IRQn, Priority, Priority);
+
+    XPD_TIM_Latency_Start(&latency);
+    XPD_TIM_Channel_Start_IT(latency.Timer, latency.Output);
+
+    /* The received loopback data is consumed meanwhile */
+    deadline = XPD_GetTicks64() + (uint64_t)BENCH_LATENCY_TIME_MS * (SystemCoreClock / 1000);
+    while (XPD_GetTicks64() < deadline)
+    {
+        length = XPD_USART_RxRing_Peek(&uart, &data);
+        if (length > 0)
+        {
+            XPD_USART_RxRing_Consume(&uart, length);
+        }
+    }
+
+    XPD_TIM_Channel_Stop_IT(latency.Timer, latency.Output);
+    XPD_TIM_Latency_Stop(&latency);
+
+    CDC_Print(Name);
+    CDC_Print("\r\n");
+    if (latency.Count == 0)
+    {
+        bench_printFailure(" IRQ latency", XPD_TIMEOUT);
+        return;
+    }
+    average = (uint32_t)(latency.Total / latency.Count);
+    bench_printResult(" samples", latency.Count, "");
+    bench_printResult(" min", bench_countsToNs(latency.Min), "ns");
+    bench_printResult(" average", bench_countsToNs(average), "ns");
+    bench_printResult(" max", bench_countsToNs(latency.Max), "ns");
+    bench_printResult(" jitter", bench_countsToNs(XPD_TIM_Latency_GetJitter(&latency)), "ns");
+
+    for (i = 0; i < latency.Bins; i++)
+    {
+        char num[12];
+
+        /* Only the populated bins are printed, the last one collects the overflow */
+        if (latency.Histogram[i] > 0)
+        {
+            CDC_Print((i < (latency.Bins - 1)) ? "  < " : "  >= ");
+            CDC_Print(bench_utoa(bench_countsToNs(
+                    (i < (latency.Bins - 1)) ? ((i + 1) * latency.BinWidth) : (i * latency.BinWidth)),
+                    num, sizeof(num)));
+            bench_printResult(" ns", latency.Histogram[i], "");
+        }
+    }
+}
+
+/**
+ * @brief  Prints the available console commands.
+ */
+void Bench_Help(void)
+{
+    CDC_Print("STM32 XPD Benchmarks\r\n"
+              " a: run driver benchmarks\r\n"
+              " i: USB CDC IN throughput\r\n"
+              " o: USB CDC OUT throughput\r\n"
+              " s: ADC samples streaming on USB CDC IN\r\n"
+              " l: interrupt latency under DMA and USB load\r\n");
+}
+
+/**
+ * @brief  Runs all driver benchmarks and prints the results.
+ */
+void Bench_Drivers(void)
+{
+    bench_printResult("Core clock", SystemCoreClock, "Hz");
+
+    bench_streams();
+    bench_flash();
+    bench_uart();
+    bench_spi();
+    bench_adc();
+#ifdef USE_XPD_CAN
+    bench_can();
+#endif
+}
+
+/**
+ * @brief  Measures the USB CDC IN throughput by sending a block of data.
+ * @note   The host has to read the data continuously during the measurement.
+ */
+void Bench_UsbIn(void)
+{
+    uint64_t start, cycles;
+    uint32_t sent;
+
+    bench_prepareBuffers(BENCH_UART_SIZE);
+
+    start = XPD_GetTicks64();
+    for (sent = 0; (sent < BENCH_USB_IN_SIZE) && (CDC_IsConnected() != FALSE);
+         sent += BENCH_UART_SIZE)
+    {
+        CDC_Write(bench_txBuffer, BENCH_UART_SIZE);
+    }
+    cycles = XPD_GetTicks64() - start;
+
+    CDC_Print("\r\n");
+    bench_printResult("USB CDC IN", bench_rate(sent, cycles), "B/s");
+}
+
+/**
+ * @brief  Measures the USB CDC OUT throughput by counting the received data
+ *         until the host stops sending for BENCH_USB_OUT_IDLE_MS.
+ */
+void Bench_UsbOut(void)
+{
+    uint64_t first, last, now;
+    uint32_t count;
+
+    CDC_Print("Send data, measurement ends after 1 s idle\r\n");
+    CDC_OutCounter_Start();
+
+    /* Wait for the data reception to start and then stop */
+    do {
+        count = CDC_OutCounter_Read(&first, &last);
+        now   = XPD_GetTicks64();
+    } while ((CDC_IsConnected() != FALSE) &&
+            ((count == 0) || ((now - last) < ((uint64_t)BENCH_USB_OUT_IDLE_MS * (SystemCoreClock / 1000)))));
+
+    /* Return to command interpretation */
+    CDC_OutCounter_Stop();
+
+    bench_printResult("USB CDC OUT bytes", count, "B");
+    bench_printResult("USB CDC OUT", bench_rate(count, last - first), "B/s");
+}
+
+/**
+ * @brief  Streams the ADC conversions on the USB CDC IN endpoint for BENCH_ADC_USB_TIME_MS.
+ *         The DMA filled blocks are transmitted from the ADC buffer without copying,
+ *         and are returned to the conversion ring by the IN transfer completion.
+ * @note   The host has to read the data continuously during the measurement.
+ */
+void Bench_AdcUsb(void)
+{
+    XPD_ReturnType result;
+    uint64_t start, cycles;
+
+    (void) XPD_ADC_Init(&adc, &AdcConfig);
+    XPD_ADC_ChannelConfig(&adc, &AdcStreamChannel, 1);
+    adc.Callbacks.BlockReady = bench_adcUsbBlockReady;
+
+    bench_blocks   = 0;
+    bench_overruns = 0;
+
+    start = XPD_GetTicks64();
+    result = XPD_ADC_Stream_Start(&adc, bench_rxBuffer, BENCH_ADC_BLOCK_SIZE);
+    if (result == XPD_OK)
+    {
+        XPD_Delay_ms(BENCH_ADC_USB_TIME_MS);
+        XPD_ADC_Stop_DMA(&adc);
+    }
+    cycles = XPD_GetTicks64() - start;
+
+    /* Wait for the last block to be sent */
+    while ((CDC_IsSending() != FALSE) && (CDC_IsConnected() != FALSE))
+    {
+    }
+
+    (void) XPD_ADC_Deinit(&adc);
+
+    CDC_Print("\r\n");
+    if (result != XPD_OK)
+    {
+        bench_printFailure("ADC USB stream", result);
+    }
+    else
+    {
+        bench_printResult("ADC USB stream", bench_rate(bench_blocks * BENCH_ADC_BLOCK_SIZE, cycles),
+                "samples/s");
+        bench_printResult("ADC USB overruns", bench_overruns, "blocks");
+    }
+}
+
+/**
+ * @brief  Measures the interrupt entry latency of a timer compare event
+ *         at different priority levels, while the UART DMA loopback and the
+ *         ADC streaming on USB IN are running in the background.
+ *         The timer interrupt is measured with a higher, the same and a lower
+ *         priority than the load interrupts, and the results are printed
+ *         with a latency histogram for each level.
+ * @note   The host should read the IN endpoint during the measurement,
+ *         otherwise the USB load is reduced to the failed transfer attempts.
+ */
+void Bench_Latency(void)
+{
+    static const char * const names[] = {
+        "IRQ latency above load priority",
+        "IRQ latency at load priority",
+        "IRQ latency below load priority" };
+    const TIM_Counter_InitType counter = {
+        .Prescaler     = 1,
+        .Period        = 0x10000,
+        .Mode          = TIM_COUNTER_UP,
+        .ClockDivision = CLK_DIV1,
+    };
+#if (__CORTEX_M >= 3)
+    NVIC_PrioGroupType group = XPD_NVIC_GetPriorityGroup();
+#endif
+    XPD_ReturnType result;
+    uint8_t i;
+
+    (void) XPD_TIM_Init(&latencyTimer, &counter);
+
+    latency.Interval  = latencyTimer.CounterFreq / BENCH_LATENCY_RATE;
+    latency.Histogram = bench_histogram;
+    latency.Bins      = BENCH_LATENCY_BINS;
+    latency.BinWidth  = (uint16_t)(((uint64_t)latencyTimer.CounterFreq * BENCH_LATENCY_BIN_NS) / 1000000000);
+    if (latency.BinWidth == 0)
+    {
+        latency.BinWidth = 1;
+    }
+
+    /* The load interrupts are moved to the middle priority level */
+#if (__CORTEX_M >= 3)
+    XPD_NVIC_SetPriorityGroup(NVIC_PRIOGROUP_4PRE_0SUB);
+#endif
+    XPD_NVIC_InitPriorities(LoadPriorities, LoadPriorityCount);
+
+    result = bench_loadStart();
+    if (result == XPD_OK)
+    {
+        for (i = 0; i < 3; i++)
+        {
+            bench_latencyLevel(names[i], LoadPriorities[0].Preemption + i - 1);
+        }
+    }
+    bench_loadStop();
+
+    /* Restore the reset priorities */
+    for (i = 0; i < LoadPriorityCount; i++)
+    {
+        XPD_NVIC_SetPriorityConfig(LoadPriorities[i].IRQn, 0, 0);
+    }
+    XPD_NVIC_SetPriorityConfig(LATENCY_TIM_IRQn, 0, 0);
+#if (__CORTEX_M >= 3)
+    XPD_NVIC_SetPriorityGroup(group);
+#endif
+
+    (void) XPD_TIM_Deinit(&latencyTimer);
+
+    CDC_Print("\r\n");
+    if (result != XPD_OK)
+    {
+        bench_printFailure("IRQ latency load", result);
+    }
+    else
+    {
+        bench_printResult("ADC USB stream", bench_rate(bench_blocks * BENCH_ADC_BLOCK_SIZE,
+                (uint64_t)3 * BENCH_LATENCY_TIME_MS * (SystemCoreClock / 1000)), "samples/s");
+        bench_printResult("ADC USB overruns", bench_overruns, "blocks");
+    }
+}
@@ -0,0 +1,43 @@
+/**
+  ******************************************************************************
+  * @file    bench.h
+  * @author  Benedek Kupper
+  * @version V0.1
+  * @date    2018-01-20
+  * @brief   STM32 eXtensible Peripheral Drivers Benchmarks Project
+  *
+  *  This file is part of STM32_XPD.
+  *
+  *  STM32_XPD is free software: you can redistribute it and/or modify
+  *  it under the terms of the GNU General Public License as published by
+  *  the Free Software Foundation, either version 3 of the License, or
+  *  (at your option) any later version.
+  *
+  *  STM32_XPD is distributed in the hope that it will be useful,
+  *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with STM32_XPD.  If not, see <http://www.gnu.org/licenses/>.
+  */
+#ifndef __BENCH_H_
+#define __BENCH_H_
+
+#include <xpd_common.h>
+
+/* Console commands */
+#define BENCH_CMD_DRIVERS       'a'
+#define BENCH_CMD_USB_IN        'i'
+#define BENCH_CMD_USB_OUT       'o'
+#define BENCH_CMD_ADC_USB       's'
+#define BENCH_CMD_LATENCY       'l'
+
+void            Bench_Help          (void);
+void            Bench_Drivers       (void);
+void            Bench_UsbIn         (void);
+void            Bench_UsbOut        (void);
+void            Bench_AdcUsb        (void);
+void            Bench_Latency       (void);
+
+#endif /* __BENCH_H_ */
@@ -0,0 +1,77 @@
+/**
+  ******************************************************************************
+  * @file    main.c
+  * @author  Benedek Kupper
+  * @version V0.1
+  * @date    2018-01-20
+  * @brief   STM32 eXtensible Peripheral Drivers Benchmarks Project
+  *
+  *  This file is part of STM32_XPD.
+  *
+  *  STM32_XPD is free software: you can redistribute it and/or modify
+  *  it under the terms of the GNU General Public License as published by
+  *  the Free Software Foundation, either version 3 of the License, or
+  *  (at your option) any later version.
+  *
+  *  STM32_XPD is distributed in the hope that it will be useful,
+  *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with STM32_XPD.  If not, see <http://www.gnu.org/licenses/>.
+  */
+#include <xpd_bsp.h>
+
+#include <usbd_core.h>
+#include <usbd_desc.h>
+#include <usbd_cdc_if.h>
+#include <bench.h>
+
+
+int main(void)
+{
+    ClockConfiguration();
+
+    /* Init Device Library, Add Supported Class and Start the library */
+    USBD_Init(&hUsbDeviceFS, (void*)&CDC_Desc, DEVICE_FS);
+
+    USBD_RegisterClass(&hUsbDeviceFS, (void*)&USBD_CDC);
+
+    USBD_CDC_RegisterInterface(&hUsbDeviceFS, &USBD_Interface_fops_FS);
+
+    USBD_Start(&hUsbDeviceFS);
+
+    while(1)
+    {
+        switch (CDC_GetCommand())
+        {
+            case 0:
+                break;
+
+            case BENCH_CMD_DRIVERS:
+                Bench_Drivers();
+                break;
+
+            case BENCH_CMD_USB_IN:
+                Bench_UsbIn();
+                break;
+
+            case BENCH_CMD_USB_OUT:
+                Bench_UsbOut();
+                break;
+
+            case BENCH_CMD_ADC_USB:
+                Bench_AdcUsb();
+                break;
+
+            case BENCH_CMD_LATENCY:
+                Bench_Latency();
+                break;
+
+            default:
+                Bench_Help();
+                break;
+        }
+    }
+}
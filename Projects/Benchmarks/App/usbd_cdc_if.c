@@ -0,0 +1,284 @@
+/**
+  ******************************************************************************
+  * @file    usbd_cdc_if.c
+  * @author  Benedek Kupper
+  * @version V0.1
+  * @date    2018-01-20
+  * @brief   STM32 eXtensible Peripheral Drivers Benchmarks Project
+  *
+  *  @verbatim
+  *
+  *          ===================================================================
+  *                                Benchmark console
+  *          ===================================================================
+  *           The USB CDC interface serves as the console of the benchmarks.
+  *           The first byte of each OUT transfer is stored as the pending
+  *           command, while the OUT throughput measurement is inactive.
+  *           When the OUT counter is running, the received bytes are only
+  *           counted with the time of the first and last reception.
+  *           The results are written to the aggregating CDC IN buffer.
+  *  @endverbatim
+  *
+  *  This file is part of STM32_XPD.
+  *
+  *  STM32_XPD is free software: you can redistribute it and/or modify
+  *  it under the terms of the GNU General Public License as published by
+  *  the Free Software Foundation, either version 3 of the License, or
+  *  (at your option) any later version.
+  *
+  *  STM32_XPD is distributed in the hope that it will be useful,
+  *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with STM32_XPD.  If not, see <http://www.gnu.org/licenses/>.
+  */
+#include <usbd_cdc_if.h>
+#include <xpd_utils.h>
+
+/* USB Device Core handle declaration */
+USBD_HandleTypeDef hUsbDeviceFS;
+
+/* The line coding is only stored, it has no effect on the console */
+static uint8_t CDC_LineCoding[7] = { 0x00, 0xC2, 0x01, 0x00, 0x00, 0x00, 0x08 };
+
+/* This structure is used for console state management */
+static struct {
+    volatile boolean_t Connected;
+    volatile uint8_t   Command;
+    volatile boolean_t Counting;
+    volatile uint32_t  OutBytes;
+    volatile uint64_t  FirstTick;
+    volatile uint64_t  LastTick;
+    void * volatile    SendData;
+}CDC_Console;
+
+static void CDC_Init(void);
+static void CDC_DeInit(void);
+static void CDC_USB_Control(uint8_t cmd, uint8_t* pbuf, uint16_t length);
+static void CDC_USB_Received(uint8_t* pbuf, uint32_t length);
+static void CDC_USB_Transmitted(uint8_t* pbuf, uint32_t length);
+
+const USBD_CDC_ItfTypeDef USBD_Interface_fops_FS =
+{ CDC_Init, CDC_DeInit, CDC_USB_Control, CDC_USB_Received, CDC_USB_Transmitted, NULL };
+
+/**
+ * @brief  This function is called from USB CDC when the device is connected
+ */
+static void CDC_Init(void)
+{
+    CDC_Console.Command   = 0;
+    CDC_Console.Counting  = FALSE;
+    CDC_Console.SendData  = NULL;
+    CDC_Console.Connected = TRUE;
+}
+
+/**
+ * @brief  This function is called from USB CDC when the device is disconnected.
+ */
+static void CDC_DeInit(void)
+{
+    CDC_Console.Connected = FALSE;
+}
+
+/**
+ * @brief  Manage the CDC class requests
+ * @param  cmd: Command code
+ * @param  pbuf: Buffer containing command data (request parameters)
+ * @param  length: Number of data to be sent (in bytes)
+ */
+static void CDC_USB_Control(uint8_t cmd, uint8_t* pbuf, uint16_t length)
+{
+    uint8_t i;
+
+    switch (cmd)
+    {
+    case CDC_SET_LINE_CODING:
+        for (i = 0; i < sizeof(CDC_LineCoding); i++)
+        {
+            CDC_LineCoding[i] = pbuf[i];
+        }
+        break;
+
+    case CDC_GET_LINE_CODING:
+        for (i = 0; i < sizeof(CDC_LineCoding); i++)
+        {
+            pbuf[i] = CDC_LineCoding[i];
+        }
+        break;
+
+    default:
+        break;
+    }
+}
+
+/**
+ * @brief  Data received over USB OUT endpoint are sent over CDC interface
+ *         through this function.
+ * @param  pbuf: Buffer of data to be received
+ * @param  length: Number of data received (in bytes)
+ */
+static void CDC_USB_Received(uint8_t * pbuf, uint32_t length)
+{
+    uint16_t len;
+
+    /* Process and release all queued buffers of the pool */
+    while (NULL != (pbuf = USBD_CDC_GetRxBuffer(&hUsbDeviceFS, 0, &len)))
+    {
+        if (CDC_Console.Counting != FALSE)
+        {
+            CDC_Console.LastTick = XPD_GetTicks64();
+            if (CDC_Console.OutBytes == 0)
+            {
+                CDC_Console.FirstTick = CDC_Console.LastTick;
+            }
+            CDC_Console.OutBytes += len;
+        }
+        else if (len > 0)
+        {
+            CDC_Console.Command = pbuf[0];
+        }
+        (void) USBD_CDC_ReleaseRxBuffer(&hUsbDeviceFS, 0);
+    }
+}
+
+/**
+ * @brief  This function is called when an IN transfer is completed,
+ *         the buffer of @ref CDC_Send is returned to its owner.
+ * @param  pbuf: Buffer of data transmitted
+ * @param  length: Number of data transmitted (in bytes)
+ */
+static void CDC_USB_Transmitted(uint8_t * pbuf, uint32_t length)
+{
+    if (pbuf == CDC_Console.SendData)
+    {
+        CDC_Console.SendData = NULL;
+    }
+}
+
+/**
+ * @brief  Determines if the console is usable.
+ * @return TRUE if the host has configured the CDC interface
+ */
+boolean_t CDC_IsConnected(void)
+{
+    return CDC_Console.Connected;
+}
+
+/**
+ * @brief  Returns and clears the pending console command.
+ * @return The command character, or 0 if none has been received
+ */
+uint8_t CDC_GetCommand(void)
+{
+    uint8_t cmd = CDC_Console.Command;
+    CDC_Console.Command = 0;
+    return cmd;
+}
+
+/**
+ * @brief  Writes the data to the console, waits until all of it is buffered.
+ * @note   The data is discarded if the device is not connected.
+ * @param  Data: pointer to the data to write
+ * @param  Length: the amount of bytes to write
+ */
+void CDC_Write(const void * Data, uint16_t Length)
+{
+    const uint8_t * pdata = Data;
+    uint16_t written;
+
+    while ((Length > 0) && (CDC_Console.Connected != FALSE))
+    {
+        written = USBD_CDC_Write(&hUsbDeviceFS, 0, pdata, Length);
+        pdata  += written;
+        Length -= written;
+    }
+}
+
+/**
+ * @brief  Writes a null-terminated string to the console.
+ * @param  Text: the string to write
+ */
+void CDC_Print(const char * Text)
+{
+    uint16_t length = 0;
+
+    while (Text[length] != '\0')
+    {
+        length++;
+    }
+    CDC_Write(Text, length);
+}
+
+/**
+ * @brief  Transmits the data on the IN endpoint directly from the provided buffer.
+ *         The buffer is owned by the USB transfer until @ref CDC_IsSending returns FALSE.
+ * @note   Must not be called from a context that can preempt the USB interrupt.
+ * @param  Data: pointer to the data to send
+ * @param  Length: the amount of bytes to send
+ * @return TRUE if the transfer is started, FALSE if the endpoint is busy
+ */
+boolean_t CDC_Send(void * Data, uint16_t Length)
+{
+    boolean_t started = FALSE;
+
+    if ((CDC_Console.Connected != FALSE) && (CDC_Console.SendData == NULL))
+    {
+        CDC_Console.SendData = Data;
+        started = (USBD_OK == USBD_CDC_Transmit(&hUsbDeviceFS, 0, Data, Length)) ? TRUE : FALSE;
+        if (started == FALSE)
+        {
+            CDC_Console.SendData = NULL;
+        }
+    }
+    return started;
+}
+
+/**
+ * @brief  Determines if the buffer of @ref CDC_Send is in use by the USB transfer.
+ * @return TRUE until the IN transfer is completed
+ */
+boolean_t CDC_IsSending(void)
+{
+    return (CDC_Console.SendData != NULL) ? TRUE : FALSE;
+}
+
+/**
+ * @brief  Starts counting the received OUT bytes instead of command interpretation.
+ */
+void CDC_OutCounter_Start(void)
+{
+    CDC_Console.Counting = FALSE;
+    CDC_Console.OutBytes = 0;
+    CDC_Console.Counting = TRUE;
+}
+
+/**
+ * @brief  Stops counting the received OUT bytes, returns to command interpretation.
+ */
+void CDC_OutCounter_Stop(void)
+{
+    CDC_Console.Counting = FALSE;
+    CDC_Console.Command  = 0;
+}
+
+/**
+ * @brief  Reads the OUT counter state.
+ * @param  FirstTick: the tick count of the first counted reception
+ * @param  LastTick: the tick count of the last counted reception
+ * @return The number of bytes received since @ref CDC_OutCounter_Start
+ */
+uint32_t CDC_OutCounter_Read(uint64_t * FirstTick, uint64_t * LastTick)
+{
+    uint32_t count;
+
+    /* Repeat the read if a reception has updated the state meanwhile */
+    do {
+        count      = CDC_Console.OutBytes;
+        *FirstTick = CDC_Console.FirstTick;
+        *LastTick  = CDC_Console.LastTick;
+    } while (count != CDC_Console.OutBytes);
+
+    return count;
+}
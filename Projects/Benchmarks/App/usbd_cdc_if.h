@@ -0,0 +1,44 @@
+/**
+  ******************************************************************************
+  * @file    usbd_cdc_if.h
+  * @author  Benedek Kupper
+  * @version V0.1
+  * @date    2018-01-20
+  * @brief   STM32 eXtensible Peripheral Drivers Benchmarks Project
+  *
+  *  This file is part of STM32_XPD.
+  *
+  *  STM32_XPD is free software: you can redistribute it and/or modify
+  *  it under the terms of the GNU General Public License as published by
+  *  the Free Software Foundation, either version 3 of the License, or
+  *  (at your option) any later version.
+  *
+  *  STM32_XPD is distributed in the hope that it will be useful,
+  *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with STM32_XPD.  If not, see <http://www.gnu.org/licenses/>.
+  */
+#ifndef __USBD_CDC_IF_H
+#define __USBD_CDC_IF_H
+#include <usbd_cdc.h>
+#include <xpd_common.h>
+
+extern const USBD_CDC_ItfTypeDef USBD_Interface_fops_FS;
+
+extern USBD_HandleTypeDef hUsbDeviceFS;
+
+boolean_t       CDC_IsConnected     (void);
+uint8_t         CDC_GetCommand      (void);
+void            CDC_Write           (const void * Data, uint16_t Length);
+void            CDC_Print           (const char * Text);
+boolean_t       CDC_Send            (void * Data, uint16_t Length);
+boolean_t       CDC_IsSending       (void);
+
+void            CDC_OutCounter_Start(void);
+void            CDC_OutCounter_Stop (void);
+uint32_t        CDC_OutCounter_Read (uint64_t * FirstTick, uint64_t * LastTick);
+
+#endif /* __USBD_CDC_IF_H */
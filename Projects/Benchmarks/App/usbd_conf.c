@@ -0,0 +1,195 @@
+/**
+  ******************************************************************************
+  * @file    usbd_conf.c
+  * @author  Benedek Kupper
+  * @version V0.2
+  * @date    2017-05-15
+  * @brief   STM32 eXtensible Peripheral Drivers USB Device Module
+  *
+  *  This file is part of STM32_XPD.
+  *
+  *  STM32_XPD is free software: you can redistribute it and/or modify
+  *  it under the terms of the GNU General Public License as published by
+  *  the Free Software Foundation, either version 3 of the License, or
+  *  (at your option) any later version.
+  *
+  *  STM32_XPD is distributed in the hope that it will be useful,
+  *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with STM32_XPD.  If not, see <http://www.gnu.org/licenses/>.
+  */
+#include "usbd_conf.h"
+#include "usbd_cdc.h"
+#include "usbd_core.h"
+
+#include "xpd_bsp.h"
+
+static int usbSuspendCallback(void * user)
+{
+    USB_HandleType * husb = ((USBD_HandleTypeDef *)user)->pData;
+
+    /* Inform USB library that core enters in suspend Mode */
+    int retval = USBD_LL_Suspend(user);
+
+    /* The PHY clock is gated by the driver after this callback */
+    if (husb->LowPowerMode == ENABLE)
+    {
+        if (husb->LinkState == USB_LPM_L2)
+        {
+            /* Set SLEEPDEEP bit and SleepOnExit of Cortex System Control Register */
+            SET_BIT(SCB->SCR.w, SCB_SCR_SLEEPDEEP_Msk | SCB_SCR_SLEEPONEXIT_Msk);
+        }
+        else
+        {
+            /* L1 sleep has to be exited within the BESL time, only stop the core */
+            SET_BIT(SCB->SCR.w, SCB_SCR_SLEEPONEXIT_Msk);
+        }
+    }
+    return retval;
+}
+
+static int usbResumeCallback(void * user)
+{
+    USB_HandleType * husb = ((USBD_HandleTypeDef *)user)->pData;
+
+    /* The link state still indicates the exited suspend level */
+    if (husb->LowPowerMode == ENABLE)
+    {
+        CLEAR_BIT(SCB->SCR.w, SCB_SCR_SLEEPDEEP_Msk | SCB_SCR_SLEEPONEXIT_Msk);
+
+        if (husb->LinkState == USB_LPM_L2)
+        {
+            /* Reconfigure system clocks */
+            ClockConfiguration();
+        }
+    }
+    return USBD_LL_Resume(user);
+}
+
+#ifdef USB_OTG_HS
+static int usbResetCallback(void * user)
+{
+    USB_SpeedType speed = ((USB_HandleType *)(((USBD_HandleTypeDef *)user)->pData))->Speed;
+
+    /* Reset Device */
+    USBD_LL_Reset(user);
+
+    return USBD_LL_SetSpeed(user,
+            (speed == USB_SPEED_FULL) ? USBD_SPEED_FULL : USBD_SPEED_HIGH);
+}
+#endif
+
+/*******************************************************************************
+ LL Driver Interface (USB Device Library --> XPD)
+ *******************************************************************************/
+
+/**
+ * @brief  Initializes the Low Level portion of the Device driver.
+ * @param  pdev: Device handle
+ * @retval USBD Status
+ */
+USBD_StatusTypeDef USBD_LL_Init(USBD_HandleTypeDef *pdev)
+{
+    if (pdev->id == DEVICE_FS)
+    {
+        uint8_t idx;
+        /* USB init setup */
+        const USB_InitType init = {
+            .Speed = USB_SPEED_FULL,
+#if (CDC_IN_COALESCE_FRAMES > 0)
+            .SOF   = ENABLE,
+#endif
+        };
+
+        /* Link driver to user */
+        pdev->pData = &usbHandle;
+
+        /* Link the stack to the driver */
+        usbHandle.User = pdev;
+
+        /* Set direct USBD API callbacks */
+        usbHandle.Callbacks.SetupStage       = USBD_LL_SetupStage;
+        usbHandle.Callbacks.DataOutStage     = USBD_LL_DataOutStage;
+        usbHandle.Callbacks.DataInStage      = USBD_LL_DataInStage;
+        usbHandle.Callbacks.SOF              = USBD_LL_SOF;
+#ifdef USB_OTG_HS
+        usbHandle.Callbacks.Reset            = usbResetCallback;
+#else
+        usbHandle.Callbacks.Reset            = USBD_LL_Reset;
+#endif
+        usbHandle.Callbacks.Suspend          = usbSuspendCallback;
+        usbHandle.Callbacks.Resume           = usbResumeCallback;
+        usbHandle.Callbacks.Connected        = USBD_LL_DevConnected;
+        usbHandle.Callbacks.Disconnected     = USBD_LL_DevDisconnected;
+
+        XPD_USB_Init(&usbHandle, &init);
+
+        {
+            /* Endpoints for CDC device (the spare buffer memory is shared out among the bulk EPs) */
+            USB_EndPointConfigType eps[CDC_INSTANCE_COUNT * 3];
+            uint8_t epCount = 0;
+
+            for (idx = 0; idx < CDC_INSTANCE_COUNT; idx++)
+            {
+                eps[epCount].Address       = CDC_INSTANCE_IN_EP(idx);
+                eps[epCount].Type          = USB_EP_TYPE_BULK;
+                eps[epCount].MaxPacketSize = CDC_DATA_FS_MAX_PACKET_SIZE;
+                epCount++;
+                eps[epCount].Address       = CDC_INSTANCE_OUT_EP(idx);
+                eps[epCount].Type          = USB_EP_TYPE_BULK;
+                eps[epCount].MaxPacketSize = CDC_DATA_FS_MAX_PACKET_SIZE;
+                epCount++;
+#if (CDC_AT_COMMAND_SUPPORT == 1)
+                eps[epCount].Address       = CDC_INSTANCE_CMD_EP(idx);
+                eps[epCount].Type          = USB_EP_TYPE_INTERRUPT;
+                eps[epCount].MaxPacketSize = CDC_CMD_PACKET_SIZE;
+                epCount++;
+#endif
+            }
+#ifdef USB_OTG_FS
+            if (XPD_USB_EP_FifoAlloc(pdev->pData, eps, epCount) != XPD_OK)
+#else
+            if (XPD_USB_EP_PmaAlloc(pdev->pData, eps, epCount) != XPD_OK)
+#endif
+            {
+                return USBD_FAIL;
+            }
+        }
+
+        /* USB device only supports full speed */
+        USBD_LL_SetSpeed(pdev, USBD_SPEED_FULL);
+    }
+
+    return USBD_OK;
+}
+
+/* Block pool of the USB class data: one block for the class instance */
+static XPD_POOL_STORAGE(usbd_classStorage, sizeof(USBD_CDC_HandleTypeDef) * CDC_INSTANCE_COUNT, 1);
+static XPD_PoolType usbd_classPool;
+
+/**
+ * @brief  Class data allocation from the static block pool.
+ * @param  size: size of allocated memory
+ * @retval The allocated memory, or NULL if the pool is exhausted
+ */
+void *USBD_static_malloc(uint32_t size)
+{
+    if (usbd_classPool.BlockSize == 0)
+    {
+        (void) XPD_Pool_Init(&usbd_classPool, usbd_classStorage, sizeof(usbd_classStorage), 1);
+    }
+    return XPD_Pool_AllocSize(&usbd_classPool, 1, size);
+}
+
+/**
+ * @brief  Releases the class data to the static block pool.
+ * @param  p: the allocated memory
+ * @retval None
+ */
+void USBD_static_free(void *p)
+{
+    XPD_Pool_FreeAny(&usbd_classPool, 1, p);
+}
@@ -0,0 +1,416 @@
+/**
+  ******************************************************************************
+  * @file    xpd_bsp.c
+  * @author  Benedek Kupper
+  * @version V0.1
+  * @date    2018-01-20
+  * @brief   STM32 eXtensible Peripheral Drivers Benchmarks Project
+  *
+  *  This file is part of STM32_XPD.
+  *
+  *  STM32_XPD is free software: you can redistribute it and/or modify
+  *  it under the terms of the GNU General Public License as published by
+  *  the Free Software Foundation, either version 3 of the License, or
+  *  (at your option) any later version.
+  *
+  *  STM32_XPD is distributed in the hope that it will be useful,
+  *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with STM32_XPD.  If not, see <http://www.gnu.org/licenses/>.
+  */
+#include <xpd_bsp.h>
+
+#include <xpd_flash.h>
+#include <xpd_rcc.h>
+
+const GPIO_InitType PinConfig[] =
+{
+    /* UART pins */
+    {
+        .Mode = GPIO_MODE_ALTERNATE,
+        .Pull = GPIO_PULL_FLOAT,
+        .Output.Type  = GPIO_OUTPUT_PUSHPULL,
+        .Output.Speed = VERY_HIGH,
+        .AlternateMap = GPIO_USART2_AF7
+    },
+    /* USB pins */
+    {
+        .Mode = GPIO_MODE_ALTERNATE,
+        .Pull = GPIO_PULL_FLOAT,
+        .Output.Type  = GPIO_OUTPUT_PUSHPULL,
+        .Output.Speed = VERY_HIGH,
+        .AlternateMap = GPIO_OTG_FS_AF10
+    },
+    /* SPI pins */
+    {
+        .Mode = GPIO_MODE_ALTERNATE,
+        .Pull = GPIO_PULL_FLOAT,
+        .Output.Type  = GPIO_OUTPUT_PUSHPULL,
+        .Output.Speed = VERY_HIGH,
+        .AlternateMap = GPIO_SPI1_AF5
+    },
+    /* ADC pins */
+    {
+        .Mode = GPIO_MODE_ANALOG,
+        .Pull = GPIO_PULL_FLOAT,
+    },
+    /* Outputs:
+     * MEMS chip select */
+    {
+        .Mode = GPIO_MODE_OUTPUT,
+        .Pull = GPIO_PULL_FLOAT,
+        .Output.Type  = GPIO_OUTPUT_PUSHPULL,
+        .Output.Speed = HIGH,
+    },
+};
+
+/* System clocks configuration */
+void ClockConfiguration(void)
+{
+    const RCC_PLL_InitType pll = {
+        .State = OSC_ON,
+        .Source = HSE,
+        .M = 8,
+        .N = 336,
+        .P = 2,
+        .Q = 7
+    };
+
+    /* HSE configuration */
+    XPD_RCC_HSEConfig(OSC_ON);
+
+    /* PLL configuration */
+    XPD_RCC_PLLConfig(&pll);
+
+    /* System clocks configuration */
+    XPD_RCC_HCLKConfig(PLL, CLK_DIV1, FLASH_LATENCY_AUTO);
+
+    XPD_RCC_PCLKConfig(PCLK1, CLK_DIV4);
+    XPD_RCC_PCLKConfig(PCLK2, CLK_DIV2);
+}
+
+/************************* USB ************************************/
+
+/* USB dependencies initialization */
+static void usbinit(void * handle)
+{
+    /* GPIO settings */
+    XPD_GPIO_InitPin(USB_DM_PIN, &PinConfig[USB_PIN_CFG]);
+    XPD_GPIO_InitPin(USB_DP_PIN, &PinConfig[USB_PIN_CFG]);
+
+    /* USB clock configuration - must be operated from 48 MHz */
+
+    /* Enable USB FS Interrupt */
+    XPD_NVIC_EnableIRQ(OTG_FS_IRQn);
+
+    /* Wakeup EXTI line setup */
+    if (((USB_HandleType*)handle)->LowPowerMode != DISABLE)
+    {
+        EXTI_InitType wakeup = USB_WAKEUP_EXTI_INIT;
+        XPD_EXTI_Init(USB_OTG_FS_WAKEUP_EXTI_LINE, &wakeup);
+
+        XPD_NVIC_EnableIRQ(OTG_FS_WKUP_IRQn);
+    }
+}
+
+/* USB dependencies deinitialization */
+static void usbdeinit(void * handle)
+{
+    XPD_GPIO_DeinitPin(USB_DM_PIN);
+    XPD_GPIO_DeinitPin(USB_DP_PIN);
+    XPD_EXTI_Deinit(USB_OTG_FS_WAKEUP_EXTI_LINE);
+    XPD_NVIC_DisableIRQ(OTG_FS_IRQn);
+    XPD_NVIC_DisableIRQ(OTG_FS_WKUP_IRQn);
+}
+
+USB_HandleType usbHandle = NEW_USB_HANDLE(USB_OTG_FS,usbinit,usbdeinit);
+
+/* USB interrupt handling */
+void OTG_FS_IRQHandler(void)
+{
+    XPD_USB_IRQHandler(&usbHandle);
+}
+
+/* USB wakeup interrupt handling */
+void OTG_FS_WKUP_IRQHandler(void)
+{
+    XPD_EXTI_ClearFlag(USB_OTG_FS_WAKEUP_EXTI_LINE);
+
+    /* Re-enable suspended PHY clock */
+    XPD_USB_PHY_ClockCtrl(&usbHandle, ENABLE);
+
+    XPD_USB_IRQHandler(&usbHandle);
+}
+
+/************************* UART ************************************/
+DMA_HandleType dmauat = NEW_DMA_HANDLE(DMA1_Stream6);
+DMA_HandleType dmauar = NEW_DMA_HANDLE(DMA1_Stream5);
+
+/* UART dependencies initialization */
+static void uartinit(void * handle)
+{
+    DMA_InitType dmaSetup =
+    {
+        .Channel                  = 4,
+        .Priority                 = MEDIUM,
+        .Mode                     = DMA_MODE_NORMAL,
+        .Memory.DataAlignment     = DMA_ALIGN_BYTE,
+        .Memory.Increment         = ENABLE,
+        .Peripheral.DataAlignment = DMA_ALIGN_BYTE,
+        .Peripheral.Increment     = DISABLE,
+        .Direction                = DMA_MEMORY2PERIPH,
+    };
+
+    /* GPIO settings */
+    XPD_GPIO_InitPin(UART_TX_PIN, &PinConfig[UART_PIN_CFG]);
+    XPD_GPIO_InitPin(UART_RX_PIN, &PinConfig[UART_PIN_CFG]);
+
+    /* DMA settings */
+    XPD_DMA_Init(&dmauat, &dmaSetup);
+    dmaSetup.Direction = DMA_PERIPH2MEMORY;
+    dmaSetup.Mode      = DMA_MODE_CIRCULAR;
+    XPD_DMA_Init(&dmauar, &dmaSetup);
+
+    ((USART_HandleType*)handle)->DMA.Transmit = &dmauat;
+    ((USART_HandleType*)handle)->DMA.Receive  = &dmauar;
+
+    XPD_NVIC_EnableIRQ(DMA1_Stream5_IRQn);
+    XPD_NVIC_EnableIRQ(DMA1_Stream6_IRQn);
+
+    /* USART transmit DMA uses TC interrupt for completion callback */
+    XPD_NVIC_EnableIRQ(USART2_IRQn);
+}
+
+/* UART dependencies deinitialization */
+static void uartdeinit(void * handle)
+{
+    XPD_GPIO_DeinitPin(UART_TX_PIN);
+    XPD_GPIO_DeinitPin(UART_RX_PIN);
+
+    XPD_DMA_Deinit(&dmauat);
+    XPD_DMA_Deinit(&dmauar);
+    XPD_NVIC_DisableIRQ(DMA1_Stream5_IRQn);
+    XPD_NVIC_DisableIRQ(DMA1_Stream6_IRQn);
+    XPD_NVIC_DisableIRQ(USART2_IRQn);
+}
+
+/* UART DMA interrupt handling */
+void DMA1_Stream5_IRQHandler(void)
+{
+    XPD_DMA_IRQHandler(&dmauar);
+}
+void DMA1_Stream6_IRQHandler(void)
+{
+    XPD_DMA_IRQHandler(&dmauat);
+}
+
+USART_HandleType uart = NEW_USART_HANDLE(USART2, uartinit, uartdeinit);
+
+/* UART interrupt handling */
+void USART2_IRQHandler(void)
+{
+    XPD_USART_IRQHandler(&uart);
+}
+
+/************************* SPI ************************************/
+DMA_HandleType dmaspit = NEW_DMA_HANDLE(DMA2_Stream3);
+DMA_HandleType dmaspir = NEW_DMA_HANDLE(DMA2_Stream2);
+
+/* SPI dependencies initialization */
+static void spiinit(void * handle)
+{
+    DMA_InitType dmaSetup =
+    {
+        .Channel                  = 3,
+        .Priority                 = HIGH,
+        .Mode                     = DMA_MODE_NORMAL,
+        .Memory.DataAlignment     = DMA_ALIGN_BYTE,
+        .Memory.Increment         = ENABLE,
+        .Peripheral.DataAlignment = DMA_ALIGN_BYTE,
+        .Peripheral.Increment     = DISABLE,
+        .Direction                = DMA_MEMORY2PERIPH,
+    };
+    const GPIO_PinMapType spiPins[] = {
+        { SPI_SCK_PIN,  &PinConfig[SPI_PIN_CFG] },
+        { SPI_MISO_PIN, &PinConfig[SPI_PIN_CFG] },
+        { SPI_MOSI_PIN, &PinConfig[SPI_PIN_CFG] },
+        { MEMS_CS_PIN,  &PinConfig[OUT_PIN_CFG] },
+    };
+
+    /* GPIO settings, the on-board MEMS is kept deselected */
+    XPD_GPIO_WritePin(MEMS_CS_PIN, 1);
+    XPD_GPIO_InitPinMap(spiPins, sizeof(spiPins) / sizeof(spiPins[0]));
+
+    /* DMA settings */
+    XPD_DMA_Init(&dmaspit, &dmaSetup);
+    dmaSetup.Direction = DMA_PERIPH2MEMORY;
+    XPD_DMA_Init(&dmaspir, &dmaSetup);
+
+    ((SPI_HandleType*)handle)->DMA.Transmit = &dmaspit;
+    ((SPI_HandleType*)handle)->DMA.Receive  = &dmaspir;
+
+    XPD_NVIC_EnableIRQ(DMA2_Stream2_IRQn);
+    XPD_NVIC_EnableIRQ(DMA2_Stream3_IRQn);
+    XPD_NVIC_EnableIRQ(SPI1_IRQn);
+}
+
+/* SPI dependencies deinitialization */
+static void spideinit(void * handle)
+{
+    XPD_GPIO_DeinitPin(SPI_SCK_PIN);
+    XPD_GPIO_DeinitPin(SPI_MISO_PIN);
+    XPD_GPIO_DeinitPin(SPI_MOSI_PIN);
+
+    XPD_DMA_Deinit(&dmaspit);
+    XPD_DMA_Deinit(&dmaspir);
+    XPD_NVIC_DisableIRQ(DMA2_Stream2_IRQn);
+    XPD_NVIC_DisableIRQ(DMA2_Stream3_IRQn);
+    XPD_NVIC_DisableIRQ(SPI1_IRQn);
+}
+
+/* SPI DMA interrupt handling */
+void DMA2_Stream2_IRQHandler(void)
+{
+    XPD_DMA_IRQHandler(&dmaspir);
+}
+void DMA2_Stream3_IRQHandler(void)
+{
+    XPD_DMA_IRQHandler(&dmaspit);
+}
+
+SPI_HandleType spi = NEW_SPI_HANDLE(SPI1, spiinit, spideinit);
+
+/* SPI interrupt handling */
+void SPI1_IRQHandler(void)
+{
+    XPD_SPI_IRQHandler(&spi);
+}
+
+/************************* ADC ************************************/
+DMA_HandleType dmaadc = NEW_DMA_HANDLE(DMA2_Stream0);
+
+const ADC_InitType AdcConfig = {
+    .Resolution            = ADC_RESOLUTION_12BIT,
+    .LeftAlignment         = DISABLE,
+    .ContinuousMode        = ENABLE,
+    .ContinuousDMARequests = ENABLE,
+    .ScanMode              = DISABLE,
+    .DiscontinuousCount    = 0,
+    .EndFlagSelection      = ADC_EOC_SINGLE,
+    .Trigger.Source        = ADC_TRIGGER_SOFTWARE,
+};
+
+const ADC_ChannelInitType AdcChannel = {
+    .Number     = ADC_CHANNEL,
+    .SampleTime = ADC_SAMPLETIME_3,
+};
+
+/* Longest sampling, so the conversion rate fits in the USB bandwidth */
+const ADC_ChannelInitType AdcStreamChannel = {
+    .Number     = ADC_CHANNEL,
+    .SampleTime = ADC_SAMPLETIME_480,
+};
+
+/* ADC dependencies initialization */
+static void adcinit(void * handle)
+{
+    DMA_InitType dmaSetup =
+    {
+        .Channel                  = 0,
+        .Priority                 = HIGH,
+        .Mode                     = DMA_MODE_CIRCULAR,
+        .Memory.DataAlignment     = DMA_ALIGN_HALFWORD,
+        .Memory.Increment         = ENABLE,
+        .Peripheral.DataAlignment = DMA_ALIGN_HALFWORD,
+        .Peripheral.Increment     = DISABLE,
+        .Direction                = DMA_PERIPH2MEMORY,
+    };
+
+    /* ADC clock configuration - 21 MHz from PCLK2 */
+    XPD_ADC_ClockConfig(ADC_CLOCKSOURCE_PCLK_DIV4);
+
+    /* GPIO settings */
+    XPD_GPIO_InitPin(ADC_IN_PIN, &PinConfig[ADC_PIN_CFG]);
+
+    /* DMA settings */
+    XPD_DMA_Init(&dmaadc, &dmaSetup);
+
+    ((ADC_HandleType*)handle)->DMA.Conversion = &dmaadc;
+
+    XPD_NVIC_EnableIRQ(DMA2_Stream0_IRQn);
+}
+
+/* ADC dependencies deinitialization */
+static void adcdeinit(void * handle)
+{
+    XPD_GPIO_DeinitPin(ADC_IN_PIN);
+
+    XPD_DMA_Deinit(&dmaadc);
+    XPD_NVIC_DisableIRQ(DMA2_Stream0_IRQn);
+}
+
+/* ADC DMA interrupt handling */
+void DMA2_Stream0_IRQHandler(void)
+{
+    XPD_DMA_IRQHandler(&dmaadc);
+}
+
+ADC_HandleType adc = NEW_ADC_HANDLE(ADC1, adcinit, adcdeinit);
+
+/************************* CAN ************************************/
+
+/* 1 Mbit/s from the 42 MHz PCLK1 */
+const CAN_InitType CanConfig = {
+    .Timing.Prescaler = 3,
+    .Timing.BS1       = 11,
+    .Timing.BS2       = 2,
+    .Timing.SJW       = 1,
+    .Settings.Mode    = CAN_MODE_SILENTLOOPBACK,
+};
+
+/* The silent loopback mode doesn't require any dependencies */
+CAN_HandleType can = NEW_CAN_HANDLE(CAN1, NULL, NULL);
+
+/************************* TIM ************************************/
+
+/* Latency timer dependencies initialization */
+static void latinit(void * handle)
+{
+    XPD_NVIC_EnableIRQ(TIM2_IRQn);
+}
+
+/* Latency timer dependencies deinitialization */
+static void latdeinit(void * handle)
+{
+    XPD_NVIC_DisableIRQ(TIM2_IRQn);
+}
+
+TIM_HandleType latencyTimer = NEW_TIM_HANDLE(TIM2, latinit, latdeinit);
+
+/* The compare event of the first channel is measured, no wiring is required */
+TIM_LatencyType latency = {
+    .Timer   = &latencyTimer,
+    .Output  = TIM_CHANNEL_1,
+    .Capture = TIM_CHANNEL_1,
+};
+
+/* The load interrupts are on the same level, so the in place USB transmission
+ * of the ADC blocks is kept safe */
+const NVIC_PriorityConfigType LoadPriorities[] = {
+    { .IRQn = OTG_FS_IRQn, .Preemption = 1, .Sub = 1 },
+    { .IRQn = DMA1_Stream5_IRQn, .Preemption = 1, .Sub = 1 },
+    { .IRQn = DMA1_Stream6_IRQn, .Preemption = 1, .Sub = 1 },
+    { .IRQn = USART2_IRQn, .Preemption = 1, .Sub = 1 },
+    { .IRQn = DMA2_Stream0_IRQn, .Preemption = 1, .Sub = 1 },
+};
+const uint8_t LoadPriorityCount = sizeof(LoadPriorities) / sizeof(LoadPriorities[0]);
+
+/* Latency timer interrupt handling, the latency is recorded first */
+void TIM2_IRQHandler(void)
+{
+    (void) XPD_TIM_Latency_Record(&latency);
+    XPD_TIM_ClearFlag(&latencyTimer, CC1);
+}
@@ -0,0 +1,421 @@
+/**
+  ******************************************************************************
+  * @file    xpd_bsp.c
+  * @author  Benedek Kupper
+  * @version V0.1
+  * @date    2018-01-20
+  * @brief   STM32 eXtensible Peripheral Drivers Benchmarks Project
+  *
+  *  This file is part of STM32_XPD.
+  *
+  *  STM32_XPD is free software: you can redistribute it and/or modify
+  *  it under the terms of the GNU General Public License as published by
+  *  the Free Software Foundation, either version 3 of the License, or
+  *  (at your option) any later version.
+  *
+  *  STM32_XPD is distributed in the hope that it will be useful,
+  *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with STM32_XPD.  If not, see <http://www.gnu.org/licenses/>.
+  */
+#include <xpd_bsp.h>
+
+#include <xpd_flash.h>
+#include <xpd_rcc.h>
+
+const GPIO_InitType PinConfig[] =
+{
+    /* UART pins */
+    {
+        .Mode = GPIO_MODE_ALTERNATE,
+        .Pull = GPIO_PULL_FLOAT,
+        .Output.Type  = GPIO_OUTPUT_PUSHPULL,
+        .Output.Speed = VERY_HIGH,
+        .AlternateMap = GPIO_USART2_AF7
+    },
+    /* USB pins */
+    {
+        .Mode = GPIO_MODE_ALTERNATE,
+        .Pull = GPIO_PULL_FLOAT,
+        .Output.Type  = GPIO_OUTPUT_PUSHPULL,
+        .Output.Speed = VERY_HIGH,
+        .AlternateMap = GPIO_OTG_FS_AF10
+    },
+    /* SPI pins */
+    {
+        .Mode = GPIO_MODE_ALTERNATE,
+        .Pull = GPIO_PULL_FLOAT,
+        .Output.Type  = GPIO_OUTPUT_PUSHPULL,
+        .Output.Speed = VERY_HIGH,
+        .AlternateMap = GPIO_SPI2_AF5
+    },
+    /* ADC pins */
+    {
+        .Mode = GPIO_MODE_ANALOG,
+        .Pull = GPIO_PULL_FLOAT,
+        .AlternateMap = GPIO_ADC_AF
+    },
+    /* Outputs:
+     * MEMS chip select */
+    {
+        .Mode = GPIO_MODE_OUTPUT,
+        .Pull = GPIO_PULL_FLOAT,
+        .Output.Type  = GPIO_OUTPUT_PUSHPULL,
+        .Output.Speed = HIGH,
+    },
+};
+
+/* System clocks configuration */
+void ClockConfiguration(void)
+{
+    const RCC_MSI_InitType msi = {
+            .ClockFreq = MSI_48MHz,
+            .State = OSC_ON};
+
+    const RCC_PLL_InitType pll = {
+        .State = OSC_ON,
+        .Source = MSI,
+        .M = 6,
+        .N = 20,
+        .R = 2,
+        .Q = 2, /* don't care */
+        .P = 7  /* don't care */
+    };
+
+    /* MSI configuration */
+    XPD_RCC_MSIConfig(&msi);
+
+    /* Use LSE to synchronize MSI */
+    XPD_RCC_LSEConfig(OSC_ON);
+
+    /* PLL configuration */
+    XPD_RCC_PLLConfig(&pll);
+
+    /* System clocks configuration */
+    XPD_RCC_HCLKConfig(PLL, CLK_DIV1, FLASH_LATENCY_AUTO);
+
+    XPD_RCC_PCLKConfig(PCLK1, CLK_DIV1);
+    XPD_RCC_PCLKConfig(PCLK2, CLK_DIV1);
+}
+
+/************************* USB ************************************/
+
+/* USB dependencies initialization */
+static void usbinit(void * handle)
+{
+    /* GPIO settings */
+    XPD_GPIO_InitPin(USB_DM_PIN, &PinConfig[USB_PIN_CFG]);
+    XPD_GPIO_InitPin(USB_DP_PIN, &PinConfig[USB_PIN_CFG]);
+
+    /* USB clock configuration - must be operated from 48 MHz */
+    XPD_USB_ClockConfig(USB_CLOCKSOURCE_MSI);
+
+    /* Enable USB FS Interrupt */
+    XPD_NVIC_EnableIRQ(OTG_FS_IRQn);
+
+    /* Wakeup EXTI line setup */
+    if (((USB_HandleType*)handle)->LowPowerMode != DISABLE)
+    {
+        EXTI_InitType wakeup = USB_WAKEUP_EXTI_INIT;
+        XPD_EXTI_Init(USB_OTG_FS_WAKEUP_EXTI_LINE, &wakeup);
+    }
+}
+
+/* USB dependencies deinitialization */
+static void usbdeinit(void * handle)
+{
+    XPD_GPIO_DeinitPin(USB_DM_PIN);
+    XPD_GPIO_DeinitPin(USB_DP_PIN);
+    XPD_EXTI_Deinit(USB_OTG_FS_WAKEUP_EXTI_LINE);
+    XPD_NVIC_DisableIRQ(OTG_FS_IRQn);
+}
+
+USB_HandleType usbHandle = NEW_USB_HANDLE(USB_OTG_FS,usbinit,usbdeinit);
+
+/* USB interrupt handling */
+void OTG_FS_IRQHandler(void)
+{
+    XPD_USB_IRQHandler(&usbHandle);
+
+    XPD_EXTI_ClearFlag(USB_OTG_FS_WAKEUP_EXTI_LINE);
+
+    /* Re-enable suspended PHY clock */
+    XPD_USB_PHY_ClockCtrl(&usbHandle, ENABLE);
+}
+
+/************************* UART ************************************/
+DMA_HandleType dmauat = NEW_DMA_HANDLE(DMA1_Channel7);
+DMA_HandleType dmauar = NEW_DMA_HANDLE(DMA1_Channel6);
+
+/* UART dependencies initialization */
+static void uartinit(void * handle)
+{
+    DMA_InitType dmaSetup =
+    {
+        .Priority                 = MEDIUM,
+        .Mode                     = DMA_MODE_NORMAL,
+        .Memory.DataAlignment     = DMA_ALIGN_BYTE,
+        .Memory.Increment         = ENABLE,
+        .Peripheral.DataAlignment = DMA_ALIGN_BYTE,
+        .Peripheral.Increment     = DISABLE,
+        .Direction                = DMA_MEMORY2PERIPH,
+    };
+
+    /* GPIO settings */
+    XPD_GPIO_InitPin(UART_TX_PIN, &PinConfig[UART_PIN_CFG]);
+    XPD_GPIO_InitPin(UART_RX_PIN, &PinConfig[UART_PIN_CFG]);
+
+    /* DMA settings */
+    XPD_DMA_Init(&dmauat, &dmaSetup);
+    dmaSetup.Direction = DMA_PERIPH2MEMORY;
+    dmaSetup.Mode      = DMA_MODE_CIRCULAR;
+    XPD_DMA_Init(&dmauar, &dmaSetup);
+
+    ((USART_HandleType*)handle)->DMA.Transmit = &dmauat;
+    ((USART_HandleType*)handle)->DMA.Receive  = &dmauar;
+
+    XPD_NVIC_EnableIRQ(DMA1_Channel6_IRQn);
+    XPD_NVIC_EnableIRQ(DMA1_Channel7_IRQn);
+
+    /* USART transmit DMA uses TC interrupt for completion callback */
+    XPD_NVIC_EnableIRQ(USART2_IRQn);
+}
+
+/* UART dependencies deinitialization */
+static void uartdeinit(void * handle)
+{
+    XPD_GPIO_DeinitPin(UART_TX_PIN);
+    XPD_GPIO_DeinitPin(UART_RX_PIN);
+
+    XPD_DMA_Deinit(&dmauat);
+    XPD_DMA_Deinit(&dmauar);
+    XPD_NVIC_DisableIRQ(DMA1_Channel6_IRQn);
+    XPD_NVIC_DisableIRQ(DMA1_Channel7_IRQn);
+    XPD_NVIC_DisableIRQ(USART2_IRQn);
+}
+
+/* UART DMA interrupt handling */
+void DMA1_Channel6_IRQHandler(void)
+{
+    XPD_DMA_IRQHandler(&dmauar);
+}
+void DMA1_Channel7_IRQHandler(void)
+{
+    XPD_DMA_IRQHandler(&dmauat);
+}
+
+USART_HandleType uart = NEW_USART_HANDLE(USART2, uartinit, uartdeinit);
+
+/* UART interrupt handling */
+void USART2_IRQHandler(void)
+{
+    XPD_USART_IRQHandler(&uart);
+}
+
+/************************* SPI ************************************/
+DMA_HandleType dmaspit = NEW_DMA_HANDLE(DMA1_Channel5);
+DMA_HandleType dmaspir = NEW_DMA_HANDLE(DMA1_Channel4);
+
+/* SPI dependencies initialization */
+static void spiinit(void * handle)
+{
+    DMA_InitType dmaSetup =
+    {
+        .Priority                 = HIGH,
+        .Mode                     = DMA_MODE_NORMAL,
+        .Memory.DataAlignment     = DMA_ALIGN_BYTE,
+        .Memory.Increment         = ENABLE,
+        .Peripheral.DataAlignment = DMA_ALIGN_BYTE,
+        .Peripheral.Increment     = DISABLE,
+        .Direction                = DMA_MEMORY2PERIPH,
+    };
+    const GPIO_PinMapType spiPins[] = {
+        { SPI_SCK_PIN,  &PinConfig[SPI_PIN_CFG] },
+        { SPI_MISO_PIN, &PinConfig[SPI_PIN_CFG] },
+        { SPI_MOSI_PIN, &PinConfig[SPI_PIN_CFG] },
+        { MEMS_CS_PIN,  &PinConfig[OUT_PIN_CFG] },
+    };
+
+    /* GPIO settings, the on-board MEMS is kept deselected */
+    XPD_GPIO_WritePin(MEMS_CS_PIN, 1);
+    XPD_GPIO_InitPinMap(spiPins, sizeof(spiPins) / sizeof(spiPins[0]));
+
+    /* DMA settings, SPI2 is mapped to request 1 of channels 4 and 5 */
+    XPD_DMA_Init(&dmaspit, &dmaSetup);
+    dmaSetup.Direction = DMA_PERIPH2MEMORY;
+    XPD_DMA_Init(&dmaspir, &dmaSetup);
+    DMA1_CSELR->CSELR.b.C4S = 1;
+    DMA1_CSELR->CSELR.b.C5S = 1;
+
+    ((SPI_HandleType*)handle)->DMA.Transmit = &dmaspit;
+    ((SPI_HandleType*)handle)->DMA.Receive  = &dmaspir;
+
+    XPD_NVIC_EnableIRQ(DMA1_Channel4_IRQn);
+    XPD_NVIC_EnableIRQ(DMA1_Channel5_IRQn);
+    XPD_NVIC_EnableIRQ(SPI2_IRQn);
+}
+
+/* SPI dependencies deinitialization */
+static void spideinit(void * handle)
+{
+    XPD_GPIO_DeinitPin(SPI_SCK_PIN);
+    XPD_GPIO_DeinitPin(SPI_MISO_PIN);
+    XPD_GPIO_DeinitPin(SPI_MOSI_PIN);
+
+    XPD_DMA_Deinit(&dmaspit);
+    XPD_DMA_Deinit(&dmaspir);
+    XPD_NVIC_DisableIRQ(DMA1_Channel4_IRQn);
+    XPD_NVIC_DisableIRQ(DMA1_Channel5_IRQn);
+    XPD_NVIC_DisableIRQ(SPI2_IRQn);
+}
+
+/* SPI DMA interrupt handling */
+void DMA1_Channel4_IRQHandler(void)
+{
+    XPD_DMA_IRQHandler(&dmaspir);
+}
+void DMA1_Channel5_IRQHandler(void)
+{
+    XPD_DMA_IRQHandler(&dmaspit);
+}
+
+SPI_HandleType spi = NEW_SPI_HANDLE(SPI2, spiinit, spideinit);
+
+/* SPI interrupt handling */
+void SPI2_IRQHandler(void)
+{
+    XPD_SPI_IRQHandler(&spi);
+}
+
+/************************* ADC ************************************/
+DMA_HandleType dmaadc = NEW_DMA_HANDLE(DMA1_Channel1);
+
+const ADC_InitType AdcConfig = {
+    .Resolution            = ADC_RESOLUTION_12BIT,
+    .LeftAlignment         = DISABLE,
+    .ContinuousMode        = ENABLE,
+    .ContinuousDMARequests = ENABLE,
+    .ScanMode              = DISABLE,
+    .DiscontinuousCount    = 0,
+    .EndFlagSelection      = ADC_EOC_SINGLE,
+    .LPAutoWait            = DISABLE,
+    .Trigger.Source        = ADC_TRIGGER_SOFTWARE,
+    .Oversampling.State    = DISABLE,
+};
+
+const ADC_ChannelInitType AdcChannel = {
+    .Number       = ADC_CHANNEL,
+    .SampleTime   = ADC_SAMPLETIME_2p5,
+    .Differential = DISABLE,
+};
+
+/* Longest sampling, so the conversion rate fits in the USB bandwidth */
+const ADC_ChannelInitType AdcStreamChannel = {
+    .Number       = ADC_CHANNEL,
+    .SampleTime   = ADC_SAMPLETIME_640p5,
+    .Differential = DISABLE,
+};
+
+/* ADC dependencies initialization */
+static void adcinit(void * handle)
+{
+    DMA_InitType dmaSetup =
+    {
+        .Priority                 = HIGH,
+        .Mode                     = DMA_MODE_CIRCULAR,
+        .Memory.DataAlignment     = DMA_ALIGN_HALFWORD,
+        .Memory.Increment         = ENABLE,
+        .Peripheral.DataAlignment = DMA_ALIGN_HALFWORD,
+        .Peripheral.Increment     = DISABLE,
+        .Direction                = DMA_PERIPH2MEMORY,
+    };
+
+    /* ADC clock configuration - 80 MHz SYSCLK */
+    XPD_ADC_ClockConfig(ADC_CLOCKSOURCE_SYSCLK);
+
+    /* GPIO settings */
+    XPD_GPIO_InitPin(ADC_IN_PIN, &PinConfig[ADC_PIN_CFG]);
+
+    /* DMA settings, ADC1 is mapped to request 0 of channel 1 */
+    XPD_DMA_Init(&dmaadc, &dmaSetup);
+    DMA1_CSELR->CSELR.b.C1S = 0;
+
+    ((ADC_HandleType*)handle)->DMA.Conversion = &dmaadc;
+
+    XPD_NVIC_EnableIRQ(DMA1_Channel1_IRQn);
+}
+
+/* ADC dependencies deinitialization */
+static void adcdeinit(void * handle)
+{
+    XPD_GPIO_DeinitPin(ADC_IN_PIN);
+
+    XPD_DMA_Deinit(&dmaadc);
+    XPD_NVIC_DisableIRQ(DMA1_Channel1_IRQn);
+}
+
+/* ADC DMA interrupt handling */
+void DMA1_Channel1_IRQHandler(void)
+{
+    XPD_DMA_IRQHandler(&dmaadc);
+}
+
+ADC_HandleType adc = NEW_ADC_HANDLE(ADC1, adcinit, adcdeinit);
+
+/************************* CAN ************************************/
+
+/* 1 Mbit/s from the 80 MHz PCLK1 */
+const CAN_InitType CanConfig = {
+    .Timing.Prescaler = 5,
+    .Timing.BS1       = 13,
+    .Timing.BS2       = 2,
+    .Timing.SJW       = 1,
+    .Settings.Mode    = CAN_MODE_SILENTLOOPBACK,
+};
+
+/* The silent loopback mode doesn't require any dependencies */
+CAN_HandleType can = NEW_CAN_HANDLE(CAN1, NULL, NULL);
+
+/************************* TIM ************************************/
+
+/* Latency timer dependencies initialization */
+static void latinit(void * handle)
+{
+    XPD_NVIC_EnableIRQ(TIM2_IRQn);
+}
+
+/* Latency timer dependencies deinitialization */
+static void latdeinit(void * handle)
+{
+    XPD_NVIC_DisableIRQ(TIM2_IRQn);
+}
+
+TIM_HandleType latencyTimer = NEW_TIM_HANDLE(TIM2, latinit, latdeinit);
+
+/* The compare event of the first channel is measured, no wiring is required */
+TIM_LatencyType latency = {
+    .Timer   = &latencyTimer,
+    .Output  = TIM_CHANNEL_1,
+    .Capture = TIM_CHANNEL_1,
+};
+
+/* The load interrupts are on the same level, so the in place USB transmission
+ * of the ADC blocks is kept safe */
+const NVIC_PriorityConfigType LoadPriorities[] = {
+    { .IRQn = OTG_FS_IRQn, .Preemption = 1, .Sub = 1 },
+    { .IRQn = DMA1_Channel6_IRQn, .Preemption = 1, .Sub = 1 },
+    { .IRQn = DMA1_Channel7_IRQn, .Preemption = 1, .Sub = 1 },
+    { .IRQn = USART2_IRQn, .Preemption = 1, .Sub = 1 },
+    { .IRQn = DMA1_Channel1_IRQn, .Preemption = 1, .Sub = 1 },
+};
+const uint8_t LoadPriorityCount = sizeof(LoadPriorities) / sizeof(LoadPriorities[0]);
+
+/* Latency timer interrupt handling, the latency is recorded first */
+void TIM2_IRQHandler(void)
+{
+    (void) XPD_TIM_Latency_Record(&latency);
+    XPD_TIM_ClearFlag(&latencyTimer, CC1);
+}
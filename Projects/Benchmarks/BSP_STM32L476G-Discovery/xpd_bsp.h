@@ -0,0 +1,91 @@
+/**
+  ******************************************************************************
+  * @file    xpd_bsp.h
+  * @author  Benedek Kupper
+  * @version V0.1
+  * @date    2018-01-20
+  * @brief   STM32 eXtensible Peripheral Drivers Benchmarks Project
+  *
+  *  This file is part of STM32_XPD.
+  *
+  *  STM32_XPD is free software: you can redistribute it and/or modify
+  *  it under the terms of the GNU General Public License as published by
+  *  the Free Software Foundation, either version 3 of the License, or
+  *  (at your option) any later version.
+  *
+  *  STM32_XPD is distributed in the hope that it will be useful,
+  *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with STM32_XPD.  If not, see <http://www.gnu.org/licenses/>.
+  */
+#ifndef __XPD_BSP_H_
+#define __XPD_BSP_H_
+
+#include <xpd_core.h>
+#include <xpd_gpio.h>
+#include <xpd_usart.h>
+#include <xpd_usb.h>
+#include <xpd_spi.h>
+#include <xpd_adc.h>
+#include <xpd_can.h>
+#include <xpd_flash.h>
+#include <xpd_tim.h>
+
+typedef enum
+{
+    UART_PIN_CFG = 0,
+    USB_PIN_CFG,
+    SPI_PIN_CFG,
+    ADC_PIN_CFG,
+    OUT_PIN_CFG,
+    PIN_CFG_COUNT
+}PinType;
+
+#define UART_TX_PIN     GPIOD, 5
+#define UART_RX_PIN     GPIOD, 6
+#define USB_DP_PIN      GPIOA, 12
+#define USB_DM_PIN      GPIOA, 11
+#define USB_VBUS_PIN    GPIOA, 9
+#define SPI_SCK_PIN     GPIOD, 1
+#define SPI_MISO_PIN    GPIOD, 3
+#define SPI_MOSI_PIN    GPIOD, 4
+#define MEMS_CS_PIN     GPIOD, 7
+#define ADC_IN_PIN      GPIOA, 1
+#define ADC_CHANNEL     6
+
+/* The last flash page is used for the flash benchmark */
+#define BENCH_FLASH_ADDRESS     ((void*)0x080FF800)
+#define BENCH_FLASH_KBYTES      2
+
+/* Indexed by PinType */
+extern const GPIO_InitType PinConfig[];
+
+/* Peripheral handle references */
+extern USART_HandleType uart;
+extern USB_HandleType usbHandle;
+extern SPI_HandleType spi;
+extern ADC_HandleType adc;
+extern CAN_HandleType can;
+extern TIM_HandleType latencyTimer;
+
+/* Interrupt latency measurement on the compare events of the latency timer */
+#define LATENCY_TIM_IRQn        TIM2_IRQn
+extern TIM_LatencyType latency;
+
+/* The interrupt lines of the background load of the latency benchmark */
+extern const NVIC_PriorityConfigType LoadPriorities[];
+extern const uint8_t LoadPriorityCount;
+
+/* Board specific benchmark peripheral configurations */
+extern const ADC_InitType AdcConfig;
+extern const ADC_ChannelInitType AdcChannel;
+extern const ADC_ChannelInitType AdcStreamChannel;
+extern const CAN_InitType CanConfig;
+
+/* System clocks configuration */
+void ClockConfiguration(void);
+
+#endif /* __XPD_BSP_H_ */
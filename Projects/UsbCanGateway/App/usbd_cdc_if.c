@@ -0,0 +1,270 @@
+/**
+  ******************************************************************************
+  * @file    usbd_cdc_if.c
+  * @author  Benedek Kupper
+  * @version V0.1
+  * @date    2018-01-20
+  * @brief   STM32 eXtensible Peripheral Drivers USB CAN Gateway Project
+  *
+  *  @verbatim
+  *
+  *          ===================================================================
+  *                                  USB CAN Gateway
+  *          ===================================================================
+  *           This project bridges a CAN bus to the USB host through the bulk
+  *           endpoints of the CDC interface. Both directions transfer batches
+  *           of raw CAN_FrameType structures, which are 24 bytes each.
+  *           The received CAN frames are timestamped by the peripheral in
+  *           Time-Triggered Communication Mode, and are queued by the receive
+  *           interrupt. The queue is drained into the filling IN batch on each
+  *           USB Start Of Frame, and the batch is transmitted when the IN
+  *           endpoint is available. The OUT batches are held in the CDC buffer
+  *           pool until all their frames are put in the CAN transmit queue,
+  *           so the host is flow controlled by the transmission progress.
+  *           A batch whose size is a multiple of the packet size has to be
+  *           terminated with a zero-length packet by the host.
+  *  @endverbatim
+  *
+  *  This file is part of STM32_XPD.
+  *
+  *  STM32_XPD is free software: you can redistribute it and/or modify
+  *  it under the terms of the GNU General Public License as published by
+  *  the Free Software Foundation, either version 3 of the License, or
+  *  (at your option) any later version.
+  *
+  *  STM32_XPD is distributed in the hope that it will be useful,
+  *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with STM32_XPD.  If not, see <http://www.gnu.org/licenses/>.
+  */
+#include <usbd_cdc_if.h>
+#include <xpd_bsp.h>
+
+/* Largest number of frames in an IN batch */
+#define CAN_IN_BATCH_FRAMES     20
+
+/* The number of frames in the CAN receive queue (holds one less) */
+#define CAN_RX_QUEUE_FRAMES     64
+
+/* The number of frames in the CAN transmit queue */
+#define CAN_TX_QUEUE_FRAMES     32
+
+/* Batches of this many frames fill whole packets (8 * 24 = 3 * 64 bytes),
+ * and would need a zero-length packet to end the transfer */
+#define CAN_PACKET_FRAMES       8
+
+/* USB Device Core handle declaration */
+USBD_HandleTypeDef hUsbDeviceFS;
+
+/* This structure is used for frame transfer management
+ * between the two communication channels */
+struct {
+    CAN_FrameType In[2][CAN_IN_BATCH_FRAMES];
+    CAN_FrameType Rx[CAN_RX_QUEUE_FRAMES];
+    CAN_FrameType Tx[CAN_TX_QUEUE_FRAMES + 3]; /* Queued and mailbox frames */
+    CAN_FrameType * TxQueue[CAN_TX_QUEUE_FRAMES];
+    uint16_t OutIndex;
+    uint8_t InCount;
+    uint8_t InIndex;
+    boolean_t InBusy;
+    uint8_t TxNext;
+}CAN_Memory;
+
+static void CDC_Init(void);
+static void CDC_DeInit(void);
+static void CDC_USB_Control(uint8_t cmd, uint8_t* pbuf, uint16_t length);
+static void CDC_USB_Received(uint8_t* pbuf, uint32_t length);
+static void CDC_USB_Transmitted(uint8_t* pbuf, uint32_t length);
+static void CDC_USB_StartOfFrame(void);
+
+static void CAN_ProcessOUT(void);
+static void CAN_ProcessIN(void);
+
+const USBD_CDC_ItfTypeDef USBD_Interface_fops_FS =
+{ CDC_Init, CDC_DeInit, CDC_USB_Control, CDC_USB_Received, CDC_USB_Transmitted,
+  CDC_USB_StartOfFrame };
+
+/**
+ * @brief  This function is called from USB CDC when the device is connected
+ */
+static void CDC_Init(void)
+{
+    const CAN_FilterType acceptAll = {
+        .Mask    = 0,
+        .Pattern = { .Value = 0, .Type = CAN_IDTYPE_STD_DATA },
+        .Mode    = CAN_FILTER_MASK_ANYTYPE,
+        .FIFO    = 0,
+    };
+    uint8_t i, matchIndex;
+
+    (void) XPD_CAN_Init(&can, &CanConfig);
+    (void) XPD_CAN_FilterConfig(&can, &acceptAll, &matchIndex, 1);
+
+    /* All transmit frame slots are free */
+    for (i = 0; i < (sizeof(CAN_Memory.Tx) / sizeof(CAN_Memory.Tx[0])); i++)
+    {
+        CAN_Memory.Tx[i].Index = CAN_TXINDEX_DONE;
+    }
+    CAN_Memory.TxNext   = 0;
+    CAN_Memory.OutIndex = 0;
+    XPD_CAN_TxQueue_Init(&can, CAN_Memory.TxQueue, CAN_TX_QUEUE_FRAMES);
+
+    /* Start queued reception for the IN batches */
+    CAN_Memory.InCount = 0;
+    CAN_Memory.InIndex = 0;
+    CAN_Memory.InBusy  = FALSE;
+    (void) XPD_CAN_RxQueue_Start(&can, 0, CAN_Memory.Rx, CAN_RX_QUEUE_FRAMES);
+}
+
+/**
+ * @brief  This function is called from USB CDC when the device is disconnected.
+ */
+static void CDC_DeInit(void)
+{
+    XPD_CAN_RxQueue_Stop(&can, 0);
+    (void) XPD_CAN_Deinit(&can);
+}
+
+/**
+ * @brief  Manage the CDC class requests
+ * @param  cmd: Command code
+ * @param  pbuf: Buffer containing command data (request parameters)
+ * @param  length: Number of data to be sent (in bytes)
+ */
+static void CDC_USB_Control(uint8_t cmd, uint8_t* pbuf, uint16_t length)
+{
+    /* The line coding has no meaning for the CAN bus */
+}
+
+/**
+ * @brief  Data received over USB OUT endpoint are sent over CDC interface
+ *         through this function.
+ * @param  pbuf: Buffer of data to be received
+ * @param  length: Number of data received (in bytes)
+ */
+static void CDC_USB_Received(uint8_t * pbuf, uint32_t length)
+{
+    /* The batch is queued in the pool, put its frames on the CAN transmit queue */
+    CAN_ProcessOUT();
+}
+
+/**
+ * @brief  This function is called when USB CDC interface finished transmission
+ *         of buffer data.
+ * @param  pbuf: Buffer of data transmitted
+ * @param  length: Number of data transmitted (in bytes)
+ */
+static void CDC_USB_Transmitted(uint8_t * pbuf, uint32_t length)
+{
+    CAN_Memory.InBusy = FALSE;
+
+    /* Send the frames which have been received in the meantime */
+    CAN_ProcessIN();
+}
+
+/**
+ * @brief  This function is called on each USB frame start,
+ *         flushes the received frames and retries the held OUT frames.
+ */
+static void CDC_USB_StartOfFrame(void)
+{
+    CAN_ProcessOUT();
+    CAN_ProcessIN();
+}
+
+/**
+ * @brief  Finds a transmit frame slot which is not used by the CAN transmit queue.
+ * @return Pointer to the free frame, or NULL if all are in use
+ */
+static CAN_FrameType * CAN_TxAlloc(void)
+{
+    uint8_t i, idx = CAN_Memory.TxNext;
+    CAN_FrameType * frame = NULL;
+
+    for (i = 0; (i < (sizeof(CAN_Memory.Tx) / sizeof(CAN_Memory.Tx[0]))) && (frame == NULL); i++)
+    {
+        if (CAN_Memory.Tx[idx].Index >= CAN_TXINDEX_DONE)
+        {
+            frame = &CAN_Memory.Tx[idx];
+        }
+        if (++idx == (sizeof(CAN_Memory.Tx) / sizeof(CAN_Memory.Tx[0])))
+        {
+            idx = 0;
+        }
+    }
+    CAN_Memory.TxNext = idx;
+
+    return frame;
+}
+
+/**
+ * @brief  This function is called when a USB OUT batch is received
+ *         or on USB frame start. It puts the frames of the received batches
+ *         on the CAN transmit queue, a batch is released when all of its frames are queued.
+ */
+static void CAN_ProcessOUT(void)
+{
+    const CAN_FrameType * batch;
+    CAN_FrameType * frame;
+    uint16_t length;
+
+    while (NULL != (batch = (const CAN_FrameType *) USBD_CDC_GetRxBuffer(&hUsbDeviceFS, 0, &length)))
+    {
+        for (; CAN_Memory.OutIndex < (length / sizeof(CAN_FrameType)); CAN_Memory.OutIndex++)
+        {
+            frame = CAN_TxAlloc();
+            if (frame == NULL)
+            {
+                /* Retry when transmission has freed up slots */
+                return;
+            }
+
+            *frame = batch[CAN_Memory.OutIndex];
+            if (XPD_CAN_TxQueue_Put(&can, frame) != XPD_OK)
+            {
+                frame->Index = CAN_TXINDEX_DONE;
+                return;
+            }
+        }
+
+        CAN_Memory.OutIndex = 0;
+        (void) USBD_CDC_ReleaseRxBuffer(&hUsbDeviceFS, 0);
+    }
+}
+
+/**
+ * @brief  This function is called on USB frame start or when the USB IN transfer completes.
+ *         It moves the received CAN frames to the filling IN batch,
+ *         and transmits the batch if the endpoint is available.
+ */
+static void CAN_ProcessIN(void)
+{
+    CAN_FrameType * batch = CAN_Memory.In[CAN_Memory.InIndex];
+    uint8_t count;
+
+    CAN_Memory.InCount += XPD_CAN_RxQueue_Read(&can, 0, &batch[CAN_Memory.InCount],
+            CAN_IN_BATCH_FRAMES - CAN_Memory.InCount);
+
+    count = CAN_Memory.InCount;
+    if ((count > 0) && ((count % CAN_PACKET_FRAMES) == 0))
+    {
+        /* Keep the last frame for the next batch */
+        count--;
+    }
+
+    if ((CAN_Memory.InBusy == FALSE) && (count > 0) && (USBD_OK ==
+        USBD_CDC_Transmit(&hUsbDeviceFS, 0, (uint8_t*)batch, count * sizeof(CAN_FrameType))))
+    {
+        CAN_Memory.InBusy  = TRUE;
+        CAN_Memory.InIndex ^= 1;
+
+        CAN_Memory.InCount -= count;
+        if (CAN_Memory.InCount > 0)
+        {
+            CAN_Memory.In[CAN_Memory.InIndex][0] = batch[count];
+        }
+    }
+}
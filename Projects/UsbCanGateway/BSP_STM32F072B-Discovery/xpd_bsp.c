@@ -0,0 +1,167 @@
+/**
+  ******************************************************************************
+  * @file    xpd_bsp.c
+  * @author  Benedek Kupper
+  * @version V0.1
+  * @date    2017-07-15
+  * @brief   STM32 eXtensible Peripheral Drivers USB CAN Gateway Project
+  *
+  *  This file is part of STM32_XPD.
+  *
+  *  STM32_XPD is free software: you can redistribute it and/or modify
+  *  it under the terms of the GNU General Public License as published by
+  *  the Free Software Foundation, either version 3 of the License, or
+  *  (at your option) any later version.
+  *
+  *  STM32_XPD is distributed in the hope that it will be useful,
+  *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with STM32_XPD.  If not, see <http://www.gnu.org/licenses/>.
+  */
+#include <xpd_bsp.h>
+
+#include <xpd_flash.h>
+#include <xpd_rcc.h>
+#include <xpd_utils.h>
+
+const GPIO_InitType PinConfig[] =
+{
+    /* CAN pins */
+    {
+        .Mode = GPIO_MODE_ALTERNATE,
+        .Pull = GPIO_PULL_FLOAT,
+        .Output.Type  = GPIO_OUTPUT_PUSHPULL,
+        .Output.Speed = VERY_HIGH,
+        .AlternateMap = GPIO_CAN_AF4
+    },
+    /* USB pins */
+    {
+        .Mode = GPIO_MODE_ALTERNATE,
+        .Pull = GPIO_PULL_FLOAT,
+        .Output.Type  = GPIO_OUTPUT_PUSHPULL,
+        .Output.Speed = VERY_HIGH,
+        .AlternateMap = GPIO_USB_AF2
+    },
+};
+
+/* System clocks configuration */
+void ClockConfiguration(void)
+{
+    const CRS_InitType crsSetup = {
+        .Source     = CRS_SYNC_SOURCE_USB,
+        .ErrorLimit = CRS_ERRORLIMIT_DEFAULT
+    };
+
+    /* HSI48 configuration, trimmed to the USB SOF without external crystal */
+    XPD_RCC_HSI48Config(OSC_ON);
+    XPD_CRS_Init(&crsSetup);
+
+    /* Monitor the trimming convergence, the USB can start before the lock */
+    XPD_CRS_Sync_Start();
+    XPD_NVIC_EnableIRQ(RCC_CRS_IRQn);
+
+    /* System clocks configuration */
+    XPD_RCC_HCLKConfig(HSI48, CLK_DIV1, FLASH_LATENCY_AUTO);
+
+    XPD_RCC_PCLKConfig(PCLK1, CLK_DIV1);
+}
+
+/* Common interrupt handler for RCC and CRS */
+void RCC_CRS_IRQHandler(void)
+{
+    XPD_CRS_IRQHandler();
+}
+
+/************************* USB ************************************/
+
+/* USB dependencies initialization */
+static void usbinit(void * handle)
+{
+    /* GPIO settings */
+    XPD_GPIO_InitPin(USB_DM_PIN, &PinConfig[USB_PIN_CFG]);
+    XPD_GPIO_InitPin(USB_DP_PIN, &PinConfig[USB_PIN_CFG]);
+
+    /* USB clock configuration - must be operated from 48 MHz */
+    XPD_USB_ClockConfig(USB_CLOCKSOURCE_HSI48);
+
+    /* Enable USB FS Interrupt */
+    XPD_NVIC_EnableIRQ(USB_IRQn);
+
+#ifdef XPD_GPIOA_PinRemap
+    XPD_GPIOA_PinRemap(11);
+#endif
+
+    /* Wakeup EXTI line setup */
+    if (((USB_HandleType*)handle)->LowPowerMode != DISABLE)
+    {
+        EXTI_InitType wakeup = USB_WAKEUP_EXTI_INIT;
+        XPD_EXTI_Init(USB_WAKEUP_EXTI_LINE, &wakeup);
+    }
+}
+
+/* USB dependencies deinitialization */
+static void usbdeinit(void * handle)
+{
+    XPD_GPIO_DeinitPin(USB_DM_PIN);
+    XPD_GPIO_DeinitPin(USB_DP_PIN);
+    XPD_NVIC_DisableIRQ(USB_IRQn);
+}
+
+USB_HandleType usbHandle = NEW_USB_HANDLE(USB, usbinit, usbdeinit);
+
+/* Common interrupt handler for USB core and WKUP line */
+void USB_IRQHandler(void)
+{
+    /* Handle USB interrupts */
+    XPD_USB_IRQHandler(&usbHandle);
+
+    /* Handle USB WKUP interrupts */
+    XPD_EXTI_ClearFlag(USB_WAKEUP_EXTI_LINE);
+
+    XPD_USB_PHY_ClockCtrl(&usbHandle, ENABLE);
+}
+
+/************************* CAN ************************************/
+
+/* 1 Mbit/s from the 48 MHz PCLK */
+const CAN_InitType CanConfig = {
+    .Timing.Prescaler = 3,
+    .Timing.BS1       = 13,
+    .Timing.BS2       = 2,
+    .Timing.SJW       = 1,
+    .Settings.Mode    = CAN_MODE_NORMAL,
+    .Settings.ABOM    = ENABLE,
+    .Settings.TTCM    = ENABLE,
+};
+
+/* CAN dependencies initialization */
+static void caninit(void * handle)
+{
+    /* GPIO settings */
+    XPD_GPIO_InitPin(CAN_RX_PIN, &PinConfig[CAN_PIN_CFG]);
+    XPD_GPIO_InitPin(CAN_TX_PIN, &PinConfig[CAN_PIN_CFG]);
+
+    XPD_NVIC_EnableIRQ(CEC_CAN_IRQn);
+}
+
+/* CAN dependencies deinitialization */
+static void candeinit(void * handle)
+{
+    XPD_GPIO_DeinitPin(CAN_RX_PIN);
+    XPD_GPIO_DeinitPin(CAN_TX_PIN);
+
+    XPD_NVIC_DisableIRQ(CEC_CAN_IRQn);
+}
+
+CAN_HandleType can = NEW_CAN_HANDLE(CAN, caninit, candeinit);
+
+/* CAN interrupt handling */
+void CEC_CAN_IRQHandler(void)
+{
+    XPD_CAN_TX_IRQHandler(&can);
+    XPD_CAN_RX0_IRQHandler(&can);
+    XPD_CAN_SCE_IRQHandler(&can);
+}
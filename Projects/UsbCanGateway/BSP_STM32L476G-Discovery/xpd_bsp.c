@@ -0,0 +1,178 @@
+/**
+  ******************************************************************************
+  * @file    xpd_bsp.c
+  * @author  Benedek Kupper
+  * @version V0.1
+  * @date    2017-07-15
+  * @brief   STM32 eXtensible Peripheral Drivers USB CAN Gateway Project
+  *
+  *  This file is part of STM32_XPD.
+  *
+  *  STM32_XPD is free software: you can redistribute it and/or modify
+  *  it under the terms of the GNU General Public License as published by
+  *  the Free Software Foundation, either version 3 of the License, or
+  *  (at your option) any later version.
+  *
+  *  STM32_XPD is distributed in the hope that it will be useful,
+  *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with STM32_XPD.  If not, see <http://www.gnu.org/licenses/>.
+  */
+#include <xpd_bsp.h>
+
+#include <xpd_flash.h>
+#include <xpd_rcc.h>
+#include <xpd_utils.h>
+
+const GPIO_InitType PinConfig[] =
+{
+    /* CAN pins */
+    {
+        .Mode = GPIO_MODE_ALTERNATE,
+        .Pull = GPIO_PULL_FLOAT,
+        .Output.Type  = GPIO_OUTPUT_PUSHPULL,
+        .Output.Speed = VERY_HIGH,
+        .AlternateMap = GPIO_CAN1_AF9
+    },
+    /* USB pins */
+    {
+        .Mode = GPIO_MODE_ALTERNATE,
+        .Pull = GPIO_PULL_FLOAT,
+        .Output.Type  = GPIO_OUTPUT_PUSHPULL,
+        .Output.Speed = VERY_HIGH,
+        .AlternateMap = GPIO_OTG_FS_AF10
+    },
+};
+
+/* System clocks configuration */
+void ClockConfiguration(void)
+{
+    const RCC_MSI_InitType msi = {
+            .ClockFreq = MSI_48MHz,
+            .State = OSC_ON};
+
+    const RCC_PLL_InitType pll = {
+        .State = OSC_ON,
+        .Source = MSI,
+        .M = 6,
+        .N = 20,
+        .R = 2,
+        .Q = 2, /* don't care */
+        .P = 7  /* don't care */
+    };
+
+    /* MSI configuration */
+    XPD_RCC_MSIConfig(&msi);
+
+    /* Use LSE to synchronize MSI */
+    XPD_RCC_LSEConfig(OSC_ON);
+
+    /* PLL configuration */
+    XPD_RCC_PLLConfig(&pll);
+
+    /* System clocks configuration */
+    XPD_RCC_HCLKConfig(PLL, CLK_DIV1, FLASH_LATENCY_AUTO);
+
+    XPD_RCC_PCLKConfig(PCLK1, CLK_DIV1);
+    XPD_RCC_PCLKConfig(PCLK2, CLK_DIV1);
+}
+
+/************************* USB ************************************/
+
+/* USB dependencies initialization */
+static void usbinit(void * handle)
+{
+    /* GPIO settings */
+    XPD_GPIO_InitPin(USB_DM_PIN, &PinConfig[USB_PIN_CFG]);
+    XPD_GPIO_InitPin(USB_DP_PIN, &PinConfig[USB_PIN_CFG]);
+
+    /* USB clock configuration - must be operated from 48 MHz */
+    XPD_USB_ClockConfig(USB_CLOCKSOURCE_MSI);
+
+    /* Enable USB FS Interrupt */
+    XPD_NVIC_EnableIRQ(OTG_FS_IRQn);
+
+    /* Wakeup EXTI line setup */
+    if (((USB_HandleType*)handle)->LowPowerMode != DISABLE)
+    {
+        EXTI_InitType wakeup = USB_WAKEUP_EXTI_INIT;
+        XPD_EXTI_Init(USB_OTG_FS_WAKEUP_EXTI_LINE, &wakeup);
+    }
+}
+
+/* USB dependencies deinitialization */
+static void usbdeinit(void * handle)
+{
+    XPD_GPIO_DeinitPin(USB_DM_PIN);
+    XPD_GPIO_DeinitPin(USB_DP_PIN);
+    XPD_EXTI_Deinit(USB_OTG_FS_WAKEUP_EXTI_LINE);
+    XPD_NVIC_DisableIRQ(OTG_FS_IRQn);
+}
+
+USB_HandleType usbHandle = NEW_USB_HANDLE(USB_OTG_FS,usbinit,usbdeinit);
+
+/* USB interrupt handling */
+void OTG_FS_IRQHandler(void)
+{
+    XPD_USB_IRQHandler(&usbHandle);
+
+    XPD_EXTI_ClearFlag(USB_OTG_FS_WAKEUP_EXTI_LINE);
+
+    /* Re-enable suspended PHY clock */
+    XPD_USB_PHY_ClockCtrl(&usbHandle, ENABLE);
+}
+
+/************************* CAN ************************************/
+
+/* 1 Mbit/s from the 80 MHz PCLK1 */
+const CAN_InitType CanConfig = {
+    .Timing.Prescaler = 5,
+    .Timing.BS1       = 13,
+    .Timing.BS2       = 2,
+    .Timing.SJW       = 1,
+    .Settings.Mode    = CAN_MODE_NORMAL,
+    .Settings.ABOM    = ENABLE,
+    .Settings.TTCM    = ENABLE,
+};
+
+/* CAN dependencies initialization */
+static void caninit(void * handle)
+{
+    /* GPIO settings */
+    XPD_GPIO_InitPin(CAN_RX_PIN, &PinConfig[CAN_PIN_CFG]);
+    XPD_GPIO_InitPin(CAN_TX_PIN, &PinConfig[CAN_PIN_CFG]);
+
+    XPD_NVIC_EnableIRQ(CAN1_TX_IRQn);
+    XPD_NVIC_EnableIRQ(CAN1_RX0_IRQn);
+    XPD_NVIC_EnableIRQ(CAN1_SCE_IRQn);
+}
+
+/* CAN dependencies deinitialization */
+static void candeinit(void * handle)
+{
+    XPD_GPIO_DeinitPin(CAN_RX_PIN);
+    XPD_GPIO_DeinitPin(CAN_TX_PIN);
+
+    XPD_NVIC_DisableIRQ(CAN1_TX_IRQn);
+    XPD_NVIC_DisableIRQ(CAN1_RX0_IRQn);
+    XPD_NVIC_DisableIRQ(CAN1_SCE_IRQn);
+}
+
+CAN_HandleType can = NEW_CAN_HANDLE(CAN1, caninit, candeinit);
+
+/* CAN interrupt handling */
+void CAN1_TX_IRQHandler(void)
+{
+    XPD_CAN_TX_IRQHandler(&can);
+}
+void CAN1_RX0_IRQHandler(void)
+{
+    XPD_CAN_RX0_IRQHandler(&can);
+}
+void CAN1_SCE_IRQHandler(void)
+{
+    XPD_CAN_SCE_IRQHandler(&can);
+}
@@ -0,0 +1,332 @@
+/**
+  ******************************************************************************
+  * @file    spi_nor.c
+  * @author  Benedek Kupper
+  * @version V0.1
+  * @date    2017-06-05
+  * @brief   STM32 eXtensible Peripheral Drivers USB Firmware Upgrade Project
+  *
+  *  This file is part of STM32_XPD.
+  *
+  *  STM32_XPD is free software: you can redistribute it and/or modify
+  *  it under the terms of the GNU General Public License as published by
+  *  the Free Software Foundation, either version 3 of the License, or
+  *  (at your option) any later version.
+  *
+  *  STM32_XPD is distributed in the hope that it will be useful,
+  *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with STM32_XPD.  If not, see <http://www.gnu.org/licenses/>.
+  */
+#include <spi_nor.h>
+
+#include <xpd_bsp.h>
+#include <xpd_mem.h>
+
+/* Standard serial NOR flash commands */
+#define SPINOR_CMD_WRITE_ENABLE 0x06
+#define SPINOR_CMD_READ_STATUS  0x05
+#define SPINOR_CMD_PAGE_PROGRAM 0x02
+#define SPINOR_CMD_FAST_READ    0x0B
+#define SPINOR_CMD_BLOCK_ERASE  0xD8
+#define SPINOR_CMD_RELEASE_PD   0xAB
+
+#define SPINOR_STATUS_WIP       0x01
+
+/* The status register is output repeatedly while selected, so a single
+ * polling transaction covers this many status reads */
+#define SPINOR_POLL_LENGTH      64
+
+/* Operation steps, each one is a single SPI transaction */
+typedef enum
+{
+    SPINOR_IDLE = 0,
+    SPINOR_ENABLE,      /* Write enable before programming or erasing */
+    SPINOR_WRITE,       /* Page program or block erase command */
+    SPINOR_POLL,        /* Status polling until the write is finished */
+    SPINOR_READ,        /* Data read */
+}SpiNor_StepType;
+
+static struct
+{
+    SPI_TransactionType Transaction;
+    uint8_t  Command[5];
+    uint8_t  Status[SPINOR_POLL_LENGTH];
+    const uint8_t * Data;       /* The remaining data to program */
+    uint32_t Address;           /* The address of the next page program or the block erase */
+    uint32_t Length;            /* The amount of data remaining to program, 0 for erase */
+    uint16_t Chunk;             /* The amount of data in the ongoing page program */
+    volatile uint8_t Step;      /* @ref SpiNor_StepType */
+    volatile XPD_ReturnType Result;
+}SpiNor;
+
+/* Standard mode 0, PCLK1 / 2 = 18 MHz */
+static const SPI_InitType SpiNor_Config = {
+    .Mode            = SPI_MODE_MASTER,
+    .Channel         = SPI_CHANNEL_FULL_DUPLEX,
+    .DataSize        = 8,
+    .Format          = SPI_FORMAT_MSB_FIRST,
+    .TI_Mode         = DISABLE,
+    .NSS             = SPI_NSS_SOFT,
+    .Clock.Polarity  = ACTIVE_HIGH,
+    .Clock.Phase     = CLOCK_PHASE_1EDGE,
+    .Clock.Prescaler = CLK_DIV2,
+};
+
+/* Sets the slave of the transaction, the arguments are given by the pin macro */
+static void SpiNor_Select(GPIO_TypeDef * Port, uint8_t Pin)
+{
+    SpiNor.Transaction.CS_Port = Port;
+    SpiNor.Transaction.CS_Pin  = Pin;
+}
+
+/* Queues the next transaction of the operation */
+static void SpiNor_Submit(uint8_t CommandLength, const void * TxData, void * RxData, uint16_t Length)
+{
+    SpiNor.Transaction.Command       = (CommandLength > 0) ? SpiNor.Command : NULL;
+    SpiNor.Transaction.CommandLength = CommandLength;
+    SpiNor.Transaction.TxData        = (void*)TxData;
+    SpiNor.Transaction.RxData        = RxData;
+    SpiNor.Transaction.Length        = Length;
+
+    if (XPD_SPI_Queue_Submit(&spiHandle, &SpiNor.Transaction) != XPD_OK)
+    {
+        SpiNor.Result = XPD_ERROR;
+        SpiNor.Step   = SPINOR_IDLE;
+    }
+}
+
+/* Fills the command header with the address */
+static void SpiNor_SetCommand(uint8_t Command, uint32_t Address)
+{
+    SpiNor.Command[0] = Command;
+    SpiNor.Command[1] = Address >> 16;
+    SpiNor.Command[2] = Address >> 8;
+    SpiNor.Command[3] = Address;
+    SpiNor.Command[4] = 0;
+}
+
+/* Starts a write operation of the flash, which has to be enabled first */
+static void SpiNor_WriteEnable(void)
+{
+    SpiNor.Step = SPINOR_ENABLE;
+    SpiNor.Command[0] = SPINOR_CMD_WRITE_ENABLE;
+    SpiNor_Submit(0, SpiNor.Command, NULL, 1);
+}
+
+/* Reads the status register continuously */
+static void SpiNor_Poll(void)
+{
+    SpiNor.Step = SPINOR_POLL;
+    SpiNor.Command[0] = SPINOR_CMD_READ_STATUS;
+    SpiNor_Submit(1, NULL, SpiNor.Status, SPINOR_POLL_LENGTH);
+}
+
+/* Continues the operation with the next transaction, in interrupt context */
+static void SpiNor_Complete(void * Transaction)
+{
+    XPD_ReturnType result = ((SPI_TransactionType*)Transaction)->Result;
+
+    if (result != XPD_OK)
+    {
+        SpiNor.Result = result;
+        SpiNor.Step   = SPINOR_IDLE;
+        return;
+    }
+
+    switch (SpiNor.Step)
+    {
+        case SPINOR_ENABLE:
+            SpiNor.Step = SPINOR_WRITE;
+            if (SpiNor.Length > 0)
+            {
+                /* The page program wraps around at the page boundary */
+                SpiNor.Chunk = SPINOR_PAGE_SIZE - (SpiNor.Address % SPINOR_PAGE_SIZE);
+                if (SpiNor.Chunk > SpiNor.Length)
+                {
+                    SpiNor.Chunk = SpiNor.Length;
+                }
+                SpiNor_SetCommand(SPINOR_CMD_PAGE_PROGRAM, SpiNor.Address);
+                SpiNor_Submit(4, SpiNor.Data, NULL, SpiNor.Chunk);
+            }
+            else
+            {
+                SpiNor_SetCommand(SPINOR_CMD_BLOCK_ERASE, SpiNor.Address);
+                SpiNor_Submit(0, SpiNor.Command, NULL, 4);
+            }
+            break;
+
+        case SPINOR_WRITE:
+            SpiNor_Poll();
+            break;
+
+        case SPINOR_POLL:
+            if ((SpiNor.Status[SPINOR_POLL_LENGTH - 1] & SPINOR_STATUS_WIP) != 0)
+            {
+                SpiNor_Poll();
+            }
+            else if (SpiNor.Length > SpiNor.Chunk)
+            {
+                /* Continue with the next page */
+                SpiNor.Data    += SpiNor.Chunk;
+                SpiNor.Address += SpiNor.Chunk;
+                SpiNor.Length  -= SpiNor.Chunk;
+                SpiNor_WriteEnable();
+            }
+            else
+            {
+                SpiNor.Length = 0;
+                SpiNor.Step   = SPINOR_IDLE;
+            }
+            break;
+
+        case SPINOR_READ:
+        default:
+            SpiNor.Step = SPINOR_IDLE;
+            break;
+    }
+}
+
+/**
+ * @brief  Initializes the SPI interface and wakes up the flash device.
+ */
+void SpiNor_Init(void)
+{
+    XPD_MemSet(&SpiNor, 0, sizeof(SpiNor));
+
+    SpiNor_Select(NOR_CS_PIN);
+    SpiNor.Transaction.Clock.Polarity  = SpiNor_Config.Clock.Polarity;
+    SpiNor.Transaction.Clock.Phase     = SpiNor_Config.Clock.Phase;
+    SpiNor.Transaction.Clock.Prescaler = SpiNor_Config.Clock.Prescaler;
+    SpiNor.Transaction.Complete        = SpiNor_Complete;
+
+    (void) XPD_SPI_Init(&spiHandle, &SpiNor_Config);
+
+    /* The device may be in deep power-down mode, the single transaction
+     * is finished the same way as a read */
+    SpiNor.Step = SPINOR_READ;
+    SpiNor.Command[0] = SPINOR_CMD_RELEASE_PD;
+    SpiNor_Submit(0, SpiNor.Command, NULL, 1);
+    (void) SpiNor_Wait();
+}
+
+/**
+ * @brief  Completes the ongoing operation and deinitializes the SPI interface.
+ */
+void SpiNor_Deinit(void)
+{
+    (void) SpiNor_Wait();
+
+    XPD_SPI_Deinit(&spiHandle);
+}
+
+/**
+ * @brief  Starts erasing a 64 kB block in the background.
+ * @param  Address: the address of the block in the flash device
+ * @return The result of the previous operation
+ */
+XPD_ReturnType SpiNor_Erase(uint32_t Address)
+{
+    XPD_ReturnType result = SpiNor_Wait();
+
+    SpiNor.Address = Address & ~(SPINOR_BLOCK_SIZE - 1);
+    SpiNor.Length  = 0;
+    SpiNor_WriteEnable();
+
+    return result;
+}
+
+/**
+ * @brief  Starts programming data in the background, page by page.
+ * @note   The data has to remain unchanged until the operation is finished.
+ * @param  Address: the start address in the flash device
+ * @param  Data: the data to program
+ * @param  Length: the amount of bytes to program
+ * @return The result of the previous operation
+ */
+XPD_ReturnType SpiNor_Program(uint32_t Address, const uint8_t * Data, uint32_t Length)
+{
+    XPD_ReturnType result = SpiNor_Wait();
+
+    if (Length > 0)
+    {
+        SpiNor.Address = Address;
+        SpiNor.Data    = Data;
+        SpiNor.Length  = Length;
+        SpiNor.Chunk   = 0;
+        SpiNor_WriteEnable();
+    }
+    return result;
+}
+
+/**
+ * @brief  Reads data from the flash device after the ongoing operation is finished.
+ * @param  Address: the start address in the flash device
+ * @param  Data: the buffer of the read data
+ * @param  Length: the amount of bytes to read
+ * @return The result of the read
+ */
+XPD_ReturnType SpiNor_Read(uint32_t Address, uint8_t * Data, uint16_t Length)
+{
+    (void) SpiNor_Wait();
+
+    /* The fast read has a dummy byte after the address */
+    SpiNor.Step = SPINOR_READ;
+    SpiNor_SetCommand(SPINOR_CMD_FAST_READ, Address);
+    SpiNor_Submit(5, NULL, Data, Length);
+
+    return SpiNor_Wait();
+}
+
+/**
+ * @brief  Waits until the ongoing operation is finished.
+ * @note   Relies on the SPI interrupts preempting the caller.
+ * @return The result of the operation, the error is cleared
+ */
+XPD_ReturnType SpiNor_Wait(void)
+{
+    XPD_ReturnType result;
+
+    while (SpiNor.Step != SPINOR_IDLE)
+    {
+    }
+    result = SpiNor.Result;
+    SpiNor.Result = XPD_OK;
+
+    return result;
+}
+
+/**
+ * @brief  Determines whether an operation is ongoing.
+ * @return TRUE if the flash device is busy
+ */
+boolean_t SpiNor_Busy(void)
+{
+    return SpiNor.Step != SPINOR_IDLE;
+}
+
+/**
+ * @brief  Estimates the remaining time of the ongoing operation.
+ * @return The remaining time in milliseconds
+ */
+uint32_t SpiNor_PendingTime(void)
+{
+    uint32_t time = 0;
+
+    if (SpiNor.Step != SPINOR_IDLE)
+    {
+        if (SpiNor.Length > 0)
+        {
+            uint32_t pages = (SpiNor.Length + SPINOR_PAGE_SIZE - 1) / SPINOR_PAGE_SIZE;
+            time = (pages * SPINOR_PAGE_PROGRAM_US + 999) / 1000;
+        }
+        else
+        {
+            time = SPINOR_BLOCK_ERASE_MS;
+        }
+    }
+    return time;
+}
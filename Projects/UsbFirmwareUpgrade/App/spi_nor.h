@@ -0,0 +1,48 @@
+/**
+  ******************************************************************************
+  * @file    spi_nor.h
+  * @author  Benedek Kupper
+  * @version V0.1
+  * @date    2017-06-05
+  * @brief   STM32 eXtensible Peripheral Drivers USB Firmware Upgrade Project
+  *
+  *  This file is part of STM32_XPD.
+  *
+  *  STM32_XPD is free software: you can redistribute it and/or modify
+  *  it under the terms of the GNU General Public License as published by
+  *  the Free Software Foundation, either version 3 of the License, or
+  *  (at your option) any later version.
+  *
+  *  STM32_XPD is distributed in the hope that it will be useful,
+  *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with STM32_XPD.  If not, see <http://www.gnu.org/licenses/>.
+  */
+#ifndef __SPI_NOR_H_
+#define __SPI_NOR_H_
+
+#include <xpd_spi.h>
+
+/* Geometry of the standard serial NOR flash devices */
+#define SPINOR_PAGE_SIZE        0x100
+#define SPINOR_BLOCK_SIZE       0x10000
+
+/* Typical timings, the longer operations are waited for by the next access */
+#define SPINOR_PAGE_PROGRAM_US  700
+#define SPINOR_BLOCK_ERASE_MS   150
+
+void            SpiNor_Init         (void);
+void            SpiNor_Deinit       (void);
+
+XPD_ReturnType  SpiNor_Erase        (uint32_t Address);
+XPD_ReturnType  SpiNor_Program      (uint32_t Address, const uint8_t * Data, uint32_t Length);
+XPD_ReturnType  SpiNor_Read         (uint32_t Address, uint8_t * Data, uint16_t Length);
+
+XPD_ReturnType  SpiNor_Wait         (void);
+boolean_t       SpiNor_Busy         (void);
+uint32_t        SpiNor_PendingTime  (void);
+
+#endif /* __SPI_NOR_H_ */
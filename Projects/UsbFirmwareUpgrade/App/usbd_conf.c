@@ -87,13 +87,30 @@ USBD_StatusTypeDef USBD_LL_Init(USBD_HandleTypeDef *pdev)
     return USBD_OK;
 }
 
+/* Block pool of the USB class data: one block for the class instance */
+static XPD_POOL_STORAGE(usbd_classStorage, sizeof(USBD_DFU_HandleTypeDef), 1);
+static XPD_PoolType usbd_classPool;
+
 /**
- * @brief  static single allocation.
+ * @brief  Class data allocation from the static block pool.
  * @param  size: size of allocated memory
- * @retval None
+ * @retval The allocated memory, or NULL if the pool is exhausted
  */
 void *USBD_static_malloc(uint32_t size)
 {
-    static uint32_t mem[(sizeof(USBD_DFU_HandleTypeDef) / 4) + 1];
-    return mem;
+    if (usbd_classPool.BlockSize == 0)
+    {
+        (void) XPD_Pool_Init(&usbd_classPool, usbd_classStorage, sizeof(usbd_classStorage), 1);
+    }
+    return XPD_Pool_AllocSize(&usbd_classPool, 1, size);
+}
+
+/**
+ * @brief  Releases the class data to the static block pool.
+ * @param  p: the allocated memory
+ * @retval None
+ */
+void USBD_static_free(void *p)
+{
+    XPD_Pool_FreeAny(&usbd_classPool, 1, p);
 }
@@ -51,14 +51,31 @@
 #define USBD_MAX_POWER_mA                   100
 #define USBD_DEBUG_LEVEL                    0
 
+/* Flash media: external SPI NOR flash on the second alternate setting
+ * at 0x90000000, the value is its size in 64 kB blocks (0 disables) */
+#define DFU_FLASH_EXTERNAL                  128
+
 /* DFU Class Config */
-#define USBD_DFU_MAX_ITF_NUM                1
-#define USBD_DFU_XFER_SIZE                  1024   /* Max DFU Packet Size = 1024 bytes */
+#define USBD_DFU_MAX_ITF_NUM                ((DFU_FLASH_EXTERNAL > 0) ? 2 : 1)
+#define USBD_DFU_XFER_SIZE                  2048   /* Max DFU Packet Size = 2048 bytes */
 
 #define USBD_DFU_DOWNLOAD_SUPPORT           1
 #define USBD_DFU_UPLOAD_SUPPORT             1
 #define USBD_DFU_DETACH_SUPPORT             1
 
+/* Flash media: program the previous block in the background
+ * while the next one is received */
+#define DFU_FLASH_PIPELINED                 1
+/* Flash media: erase up to this many subsequent non-blank pages
+ * in the background on a page erase request (requires pipelining) */
+#define DFU_FLASH_ERASE_AHEAD               8
+/* Flash media: accept heatshrink compressed images with windows
+ * up to this many bits (0 disables, the window takes 2^N bytes of RAM) */
+#define DFU_FLASH_COMPRESSED                8
+/* Flash media: apply differential patches downloaded to the virtual
+ * segment at 0x0A000000, rewriting only the changed pages */
+#define DFU_FLASH_DELTA                     1
+
 /* #define for FS and HS identification */
 #define DEVICE_FS       0
 #ifdef USB_OTG_HS
@@ -70,7 +87,7 @@
 
 /* Memory management macros */
 #define USBD_malloc(SIZE)       (USBD_static_malloc(SIZE))
-#define USBD_free(PTR)          ((void)0)
+#define USBD_free(PTR)          (USBD_static_free(PTR))
 #define USBD_SystemReset        NVIC_SystemReset
 
 #define USBD_Delay(MS)                          \
@@ -85,6 +102,9 @@
 #define USBD_LL_Stop(PDEV)                      \
     (XPD_USB_Stop((PDEV)->pData), USBD_OK)
 
+#define USBD_LL_Poll(PDEV, MAX)                 \
+    (XPD_USB_Poll((PDEV)->pData, MAX))
+
 #define USBD_LL_OpenEP(PDEV, EA, TYPE, MPS)     \
     (XPD_USB_EP_Open((PDEV)->pData, EA, TYPE, MPS), USBD_OK)
 
@@ -116,12 +116,19 @@ __ALIGN_BEGIN const uint8_t USBD_LangIDDesc[USB_LEN_LANGID_STR_DESC] __ALIGN_END
     LOBYTE(USBD_LANGID_STRING),HIBYTE(USBD_LANGID_STRING),
 };
 
+/* USB String Descriptors, encoded at build time */
+USBD_STRING_DESC(USBD_ManufacturerStrDesc, USBD_MANUFACTURER_STRING);
+USBD_STRING_DESC(USBD_ProductStrDesc, USBD_PRODUCT_FS_STRING);
+USBD_STRING_DESC(USBD_ConfigStrDesc, USBD_CONFIGURATION_FS_STRING);
+USBD_STRING_DESC(USBD_InterfaceStrDesc, USBD_INTERFACE_FS_STRING);
+
 uint8_t USBD_StringSerial[USB_SIZ_STRING_SERIAL] =
 {
     USB_SIZ_STRING_SERIAL,
     USB_DESC_TYPE_STRING,
 };
 
+/* String descriptor buffer of the media names */
 #if defined ( __ICCARM__ ) /*!< IAR Compiler */
   #pragma data_alignment=4   
 #endif
@@ -162,8 +169,8 @@ uint8_t *USBD_CDC_LangIDStrDescriptor(USBD_SpeedTypeDef speed, uint16_t *length)
   */
 uint8_t *USBD_CDC_ProductStrDescriptor(USBD_SpeedTypeDef speed, uint16_t *length)
 {
-    USBD_GetString((uint8_t *)USBD_PRODUCT_FS_STRING, USBD_StrDesc, length);
-    return USBD_StrDesc;
+    *length = sizeof(USBD_ProductStrDesc);
+    return (uint8_t*)&USBD_ProductStrDesc;
 }
 
 /**
@@ -174,8 +181,8 @@ uint8_t *USBD_CDC_ProductStrDescriptor(USBD_SpeedTypeDef speed, uint16_t *length
   */
 uint8_t *USBD_CDC_ManufacturerStrDescriptor(USBD_SpeedTypeDef speed, uint16_t *length)
 {
-    USBD_GetString((uint8_t *)USBD_MANUFACTURER_STRING, USBD_StrDesc, length);
-    return USBD_StrDesc;
+    *length = sizeof(USBD_ManufacturerStrDesc);
+    return (uint8_t*)&USBD_ManufacturerStrDesc;
 }
 
 /**
@@ -188,8 +195,12 @@ uint8_t *USBD_CDC_SerialStrDescriptor(USBD_SpeedTypeDef speed, uint16_t *length)
 {
     *length = USB_SIZ_STRING_SERIAL;
 
-    UintToUnicode(DEVICE_ID_REG[0] + DEVICE_ID_REG[2], &USBD_StringSerial[2], 8);
-    UintToUnicode(DEVICE_ID_REG[1], &USBD_StringSerial[18], 4);
+    /* The unique ID is only converted at the first request */
+    if (USBD_StringSerial[2] == 0)
+    {
+        UintToUnicode(DEVICE_ID_REG[0] + DEVICE_ID_REG[2], &USBD_StringSerial[2], 8);
+        UintToUnicode(DEVICE_ID_REG[1], &USBD_StringSerial[18], 4);
+    }
 
     return (uint8_t*)USBD_StringSerial;
 }
@@ -202,8 +213,8 @@ uint8_t *USBD_CDC_SerialStrDescriptor(USBD_SpeedTypeDef speed, uint16_t *length)
   */
 uint8_t *USBD_CDC_ConfigStrDescriptor(USBD_SpeedTypeDef speed, uint16_t *length)
 {
-    USBD_GetString((uint8_t *)USBD_CONFIGURATION_FS_STRING, USBD_StrDesc, length);
-    return USBD_StrDesc;
+    *length = sizeof(USBD_ConfigStrDesc);
+    return (uint8_t*)&USBD_ConfigStrDesc;
 }
 
 /**
@@ -214,8 +225,8 @@ uint8_t *USBD_CDC_ConfigStrDescriptor(USBD_SpeedTypeDef speed, uint16_t *length)
   */
 uint8_t *USBD_CDC_InterfaceStrDescriptor(USBD_SpeedTypeDef speed, uint16_t *length)
 {
-    USBD_GetString((uint8_t *)USBD_INTERFACE_FS_STRING, USBD_StrDesc, length);
-    return USBD_StrDesc;
+    *length = sizeof(USBD_InterfaceStrDesc);
+    return (uint8_t*)&USBD_InterfaceStrDesc;
 }
 
 /**
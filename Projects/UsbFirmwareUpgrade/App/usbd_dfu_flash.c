@@ -33,96 +33,1000 @@
 #include <usbd_dfu_flash.h>
 
 #include <xpd_bsp.h>
+#include <xpd_mem.h>
+#include <spi_nor.h>
 
 /* USB Device Core handle declaration */
 USBD_HandleTypeDef hUsbDeviceFS;
 
 
-#define FLASH_ERASE_TIME      50
-#define FLASH_PROGRAM_TIME    50
+#ifndef DFU_FLASH_PIPELINED
+#define DFU_FLASH_PIPELINED   0
+#endif
+
+#ifndef DFU_FLASH_ERASE_AHEAD
+#define DFU_FLASH_ERASE_AHEAD 0
+#endif
+
+/* Compressed image support, the value is the maximal window size in bits */
+#ifndef DFU_FLASH_COMPRESSED
+#define DFU_FLASH_COMPRESSED  0
+#endif
+
+/* Differential update support */
+#ifndef DFU_FLASH_DELTA
+#define DFU_FLASH_DELTA       0
+#endif
+
+/* External SPI NOR flash support, the value is its size in 64 kB blocks */
+#ifndef DFU_FLASH_EXTERNAL
+#define DFU_FLASH_EXTERNAL    0
+#endif
+
+/* Worst case timings of the embedded flash */
+#define FLASH_PAGE_ERASE_MS   40
+#define FLASH_HALFWORD_US     70
+
+#define FLASH_PROGRAM_MS(BYTES)                         \
+    ((((BYTES) / sizeof(uint16_t)) * FLASH_HALFWORD_US + 999) / 1000)
 
 /*
  * Device memory:   128 kB
  * Layout:          64 pages of 2 kBytes
  * Bootloader size: 24 kB */
 #define FLASH_WRITE_ADDRESS   (FLASH_BASE + 0x5000)
+#define FLASH_PAGE_COUNT      64
+#define FLASH_PAGE_SIZE       0x800
 
+#if (DFU_FLASH_DELTA > 0)
+/* Virtual memory segment receiving the patches, outside of the flash */
+#define FLASH_DELTA_ADDRESS   0x0A000000
+#define FLASH_DELTA_SIZE      0x10000
+
+#define FLASH_DESC_STR        "@Internal Flash /0x08000000/10*2Ka,54*2Kg/0x0A000000/32*2Kf"
+#else
 #define FLASH_DESC_STR        "@Internal Flash /0x08000000/10*2Ka,54*2Kg"
+#endif
+
+#if (DFU_FLASH_EXTERNAL > 0)
+/* The external flash is presented at the usual memory mapped QSPI location */
+#define FLASH_EXT_ADDRESS     0x90000000
+#define FLASH_EXT_SIZE        ((uint32_t)DFU_FLASH_EXTERNAL * SPINOR_BLOCK_SIZE)
+
+#define FLASH_EXT_STR_(N)     #N
+#define FLASH_EXT_STR(N)      FLASH_EXT_STR_(N)
+#define FLASH_EXT_DESC_STR    "@SPI Flash /0x90000000/" FLASH_EXT_STR(DFU_FLASH_EXTERNAL) "*64Kg"
+
+#define FLASH_IS_EXTERNAL(ADDR)         \
+    (((uint32_t)(ADDR) - FLASH_EXT_ADDRESS) < FLASH_EXT_SIZE)
+#endif
+
+/* Flash memory bank with uniform page size */
+typedef struct
+{
+    uint32_t Address;   /* Start address of the bank */
+    uint32_t PageSize;  /* Size of a page in bytes */
+    uint32_t PageCount; /* Number of pages in the bank */
+}FlashIf_BankType;
+
+/* Flash page properties */
+typedef struct
+{
+    uint32_t Address;   /* Start address of the page */
+    uint32_t Size;      /* Size of the page in bytes */
+    uint32_t Index;     /* Index of the page in the whole layout */
+    uint32_t Remaining; /* Number of subsequent pages in the same bank */
+    uint8_t  Bank;      /* Index of the containing bank */
+}FlashIf_PageType;
+
+/* Flash layout, the banks' page count sum is FLASH_PAGE_COUNT */
+static const FlashIf_BankType FlashIf_Layout[] = {
+    { FLASH_BASE, FLASH_PAGE_SIZE, FLASH_PAGE_COUNT },
+};
 
+/* Bitmap of the pages which are known to be erased */
+static volatile uint32_t FlashIf_Blank[(FLASH_PAGE_COUNT + 31) / 32];
 
+#define FLASH_PAGE_BLANK(INDEX)         \
+    ((FlashIf_Blank[(INDEX) / 32] >> ((INDEX) % 32)) & 1)
+
+#define FLASH_PAGE_SET_BLANK(INDEX)     \
+    (FlashIf_Blank[(INDEX) / 32] |= 1UL << ((INDEX) % 32))
+
+#define FLASH_PAGE_CLR_BLANK(INDEX)     \
+    (FlashIf_Blank[(INDEX) / 32] &= ~(1UL << ((INDEX) % 32)))
+
+
+void FlashIf_Init(void);
+void FlashIf_DeInit(void);
 void FlashIf_Erase(uint32_t Add);
 void FlashIf_Write(uint8_t *dest, uint8_t *src, uint32_t Len);
-void FlashIf_Read(uint8_t *dest, uint8_t *src, uint32_t Len);
+uint8_t *FlashIf_Read(uint8_t *dest, uint8_t *src, uint32_t Len);
 void FlashIf_GetStatus(uint32_t Add, uint8_t Cmd, uint8_t *buffer);
 
 const USBD_DFU_MediaTypeDef USBD_DFU_Flash_fops = {
     (uint8_t *)FLASH_DESC_STR,
     (void*)FLASH_WRITE_ADDRESS,
-    XPD_FLASH_Unlock,
-    XPD_FLASH_Lock,
+    FlashIf_Init,
+    FlashIf_DeInit,
     FlashIf_Erase,
     FlashIf_Write,
     FlashIf_Read,
-    FlashIf_GetStatus
+    FlashIf_GetStatus,
+#if (DFU_FLASH_EXTERNAL > 0)
+    { (uint8_t *)FLASH_EXT_DESC_STR },
+#endif
 };
 
+#if (USBD_DFU_XFER_SIZE > FLASH_PAGE_SIZE)
+#error "The DFU transfer size cannot exceed the flash page size."
+#endif
+
+#if (DFU_FLASH_PIPELINED > 0)
+/* Copy of the block under programming, the DFU buffer receives the next one meanwhile */
+static uint16_t FlashIf_Block[USBD_DFU_XFER_SIZE / sizeof(uint16_t)];
+
+/* Size of the block under programming, 0 when not programming */
+static volatile uint32_t FlashIf_Pending = 0;
+
+/* Number of pages under erasure, 0 when not erasing */
+static volatile uint32_t FlashIf_Erasing = 0;
+
+/* Programming is finished */
+static void FlashIf_ProgramComplete(void)
+{
+    FlashIf_Pending = 0;
+}
+
+/* Erasure is finished */
+static void FlashIf_EraseComplete(void)
+{
+    FlashIf_Erasing = 0;
+}
+
+/* Operation is aborted, the erased state of pages is unknown */
+static void FlashIf_Error(void)
+{
+    uint32_t i;
+
+    for (i = 0; i < sizeof(FlashIf_Blank) / sizeof(FlashIf_Blank[0]); i++)
+    {
+        FlashIf_Blank[i] = 0;
+    }
+    FlashIf_Pending = 0;
+    FlashIf_Erasing = 0;
+}
+
+/* Waits until the ongoing background operation is completed.
+ * Relies on the FLASH interrupt preempting the USB interrupt. */
+static void FlashIf_Wait(void)
+{
+    while ((FlashIf_Pending > 0) || (FlashIf_Erasing > 0))
+    {
+    }
+}
+#else
+#define FlashIf_Pending       0
+#define FlashIf_Erasing       0
+#define FlashIf_Wait()        ((void)0)
+#endif
+
+#if (DFU_FLASH_EXTERNAL > 0)
+/* Copy of the block under programming in the external flash */
+static uint8_t FlashIf_ExtBlock[USBD_DFU_XFER_SIZE];
+#endif
+
+#if (DFU_FLASH_COMPRESSED > 0)
+/*
+ * Compressed image format: 8 byte header followed by the heatshrink (LZSS) stream
+ * of the image, which is downloaded to FLASH_WRITE_ADDRESS.
+ * Header: "XPDZ" magic, window bits, lookahead bits, 2 reserved bytes */
+#define FLASH_ZIP_MAGIC       0x5A445058
+#define FLASH_ZIP_HEADER_SIZE 8
+
+/* Decoder states */
+typedef enum
+{
+    FLASHIF_ZIP_TAG,        /* Waiting for the literal / backreference tag bit */
+    FLASHIF_ZIP_LITERAL,    /* Waiting for the literal byte */
+    FLASHIF_ZIP_INDEX,      /* Waiting for the backreference offset */
+    FLASHIF_ZIP_COUNT,      /* Waiting for the backreference length */
+}FlashIf_ZipStateType;
+
+/* Decompression context of a compressed download */
+static struct
+{
+    uint8_t  Window[1 << DFU_FLASH_COMPRESSED];     /* Sliding window of the decompressed data */
+    uint8_t  Output[USBD_DFU_XFER_SIZE];            /* Decompressed data waiting for programming */
+    uint32_t Address;                               /* Flash address of the Output start */
+    uint32_t Prepared;                              /* End address of the pages prepared for programming */
+    uint32_t Bits;                                  /* Input bit buffer */
+    uint16_t Head;                                  /* Write index of the window */
+    uint16_t Index;                                 /* Offset of the decoded backreference */
+    uint16_t Length;                                /* Number of bytes in Output */
+    uint8_t  BitCount;                              /* Number of bits in the bit buffer */
+    uint8_t  WindowBits;                            /* Window size of the stream */
+    uint8_t  LookaheadBits;                         /* Lookahead size of the stream */
+    uint8_t  State;                                 /* @ref FlashIf_ZipStateType */
+    boolean_t Active;                               /* The ongoing download is compressed */
+}FlashIf_Zip;
+
+static void FlashIf_ZipFlush(boolean_t Final);
+#endif
+
+#if (DFU_FLASH_DELTA > 0)
+/*
+ * Patch format: "XPDD" magic, 32 bit size of the new image, followed by operations:
+ * COPY:   0x01, 16 bit length, 32 bit offset of the source in the current image
+ * INSERT: 0x02, 16 bit length, followed by the inserted bytes
+ * All fields are little-endian. The new image is assembled page by page, and only
+ * the changed pages are rewritten. The copy sources must not be in pages which
+ * are already rewritten by the patch. */
+#define FLASH_DELTA_MAGIC     0x44445058
+#define FLASH_DELTA_HEADER_SIZE 8
+#define FLASH_DELTA_COPY      0x01
+#define FLASH_DELTA_INSERT    0x02
+
+/* Patch applier states */
+typedef enum
+{
+    FLASHIF_DELTA_IDLE,     /* No patch is applied */
+    FLASHIF_DELTA_OP,       /* Collecting the next operation */
+    FLASHIF_DELTA_INSERT,   /* Receiving the inserted bytes */
+    FLASHIF_DELTA_DONE,     /* The new image is complete */
+    FLASHIF_DELTA_ERROR,    /* The patch is invalid, the rest of it is ignored */
+}FlashIf_DeltaStateType;
+
+/* Patch applier context */
+static struct
+{
+    uint8_t  Page[FLASH_PAGE_SIZE];                 /* The new contents of the page under assembly */
+    uint32_t Written[(FLASH_PAGE_COUNT + 31) / 32]; /* Bitmap of the pages rewritten by the patch */
+    uint32_t Address;                               /* Flash address of the page under assembly */
+    uint32_t Remaining;                             /* Number of new image bytes to assemble */
+    uint16_t Offset;                                /* Number of assembled bytes in Page */
+    uint16_t Count;                                 /* Remaining length of the inserting operation */
+    uint8_t  Op[7];                                 /* The collected operation */
+    uint8_t  OpLength;                              /* Number of collected operation bytes */
+    uint8_t  State;                                 /* @ref FlashIf_DeltaStateType */
+}FlashIf_Delta;
+#endif
+
+/* Finds the page which contains the address, returns FALSE if there is none */
+static boolean_t FlashIf_GetPage(uint32_t Add, FlashIf_PageType * page)
+{
+    uint32_t index = 0;
+    uint8_t bank;
+
+    for (bank = 0; bank < sizeof(FlashIf_Layout) / sizeof(FlashIf_Layout[0]); bank++)
+    {
+        const FlashIf_BankType * b = &FlashIf_Layout[bank];
+
+        if ((Add >= b->Address) && ((Add - b->Address) < (b->PageSize * b->PageCount)))
+        {
+            uint32_t offset = (Add - b->Address) / b->PageSize;
+
+            page->Address   = b->Address + offset * b->PageSize;
+            page->Size      = b->PageSize;
+            page->Index     = index + offset;
+            page->Remaining = b->PageCount - offset - 1;
+            page->Bank      = bank;
+            return TRUE;
+        }
+        index += b->PageCount;
+    }
+    return FALSE;
+}
+
+/* Checks whether the page is in erased state */
+static boolean_t FlashIf_IsBlank(const FlashIf_PageType * page)
+{
+    const uint32_t * word = (const uint32_t *)page->Address;
+    uint32_t count = page->Size / sizeof(uint32_t);
+
+    while (count-- > 0)
+    {
+        if (*word++ != 0xFFFFFFFF)
+        {
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
+
+/* Estimated time in ms until the ongoing background operation completes */
+static uint32_t FlashIf_PendingTime(void)
+{
+    return FLASH_PROGRAM_MS(FlashIf_Pending) + FlashIf_Erasing * FLASH_PAGE_ERASE_MS;
+}
+
+/**
+ * @brief  Initializes the flash interface.
+ */
+void FlashIf_Init(void)
+{
+    uint32_t i;
+
+    XPD_FLASH_Unlock();
+
+    for (i = 0; i < sizeof(FlashIf_Blank) / sizeof(FlashIf_Blank[0]); i++)
+    {
+        FlashIf_Blank[i] = 0;
+    }
+#if (DFU_FLASH_COMPRESSED > 0)
+    FlashIf_Zip.Active = FALSE;
+#endif
+#if (DFU_FLASH_DELTA > 0)
+    FlashIf_Delta.State = FLASHIF_DELTA_IDLE;
+#endif
+
+#if (DFU_FLASH_PIPELINED > 0)
+    FlashIf_Pending = 0;
+    FlashIf_Erasing = 0;
+    XPD_FLASH_Callbacks.ProgramComplete = FlashIf_ProgramComplete;
+    XPD_FLASH_Callbacks.EraseComplete   = FlashIf_EraseComplete;
+    XPD_FLASH_Callbacks.Error           = FlashIf_Error;
+
+    XPD_NVIC_SetPriorityConfig(FLASH_IRQn, 0, 0);
+    XPD_NVIC_EnableIRQ(FLASH_IRQn);
+#endif
+#if (DFU_FLASH_EXTERNAL > 0)
+    SpiNor_Init();
+#endif
+}
+
+/**
+ * @brief  Deinitializes the flash interface after completing the pending operation.
+ */
+void FlashIf_DeInit(void)
+{
+#if (DFU_FLASH_COMPRESSED > 0)
+    /* Program the remaining decompressed data */
+    if (FlashIf_Zip.Active)
+    {
+        FlashIf_ZipFlush(TRUE);
+        FlashIf_Zip.Active = FALSE;
+    }
+#endif
+    FlashIf_Wait();
+
+    XPD_FLASH_Lock();
+#if (DFU_FLASH_EXTERNAL > 0)
+    SpiNor_Deinit();
+#endif
+}
+
+/* Erases the page containing the address unless it is known to be blank */
+static void FlashIf_ErasePage(uint32_t Add)
+{
+    FlashIf_PageType page;
+
+    /* Page is already erased, or its erasure is ongoing */
+    if (!FlashIf_GetPage(Add, &page) || (FLASH_PAGE_BLANK(page.Index) != 0))
+    {
+        return;
+    }
+
+    FlashIf_Wait();
+
+    if (FlashIf_IsBlank(&page))
+    {
+        FLASH_PAGE_SET_BLANK(page.Index);
+    }
+#if (DFU_FLASH_PIPELINED > 0) && (DFU_FLASH_ERASE_AHEAD > 0)
+    else if (page.Address >= FLASH_WRITE_ADDRESS)
+    {
+        const FlashIf_BankType * bank = &FlashIf_Layout[page.Bank];
+        FlashIf_PageType next = page;
+        uint32_t count = 1;
+        XPD_ReturnType result;
+
+        /* Extend the span with the following non-blank pages */
+        while ((count < DFU_FLASH_ERASE_AHEAD) && (next.Remaining > 0))
+        {
+            next.Address += next.Size;
+            next.Index++;
+            next.Remaining--;
+
+            if ((FLASH_PAGE_BLANK(next.Index) != 0) || FlashIf_IsBlank(&next))
+            {
+                FLASH_PAGE_SET_BLANK(next.Index);
+                break;
+            }
+            count++;
+        }
+
+        for (next.Index = page.Index; next.Index < (page.Index + count); next.Index++)
+        {
+            FLASH_PAGE_SET_BLANK(next.Index);
+        }
+        FlashIf_Erasing = count;
+
+        /* Erase in the background */
+        if (count == bank->PageCount)
+        {
+            result = XPD_FLASH_EraseBank_IT(page.Bank);
+        }
+        else
+        {
+            result = XPD_FLASH_Erase_IT((void*)page.Address, (count * page.Size) >> 10);
+        }
+
+        if (result != XPD_OK)
+        {
+            FlashIf_Error();
+        }
+    }
+#endif
+    else if (XPD_FLASH_Erase((void*)page.Address, page.Size >> 10) == XPD_OK)
+    {
+        FLASH_PAGE_SET_BLANK(page.Index);
+    }
+}
+
+/* Programs the data to the flash, the written pages are no longer blank */
+static void FlashIf_Program(uint8_t *dest, uint8_t *src, uint32_t Len)
+{
+    FlashIf_PageType page;
+
+    /* The written pages are no longer blank */
+    if (FlashIf_GetPage((uint32_t)dest, &page))
+    {
+        FLASH_PAGE_CLR_BLANK(page.Index);
+    }
+    if ((Len > 0) && FlashIf_GetPage((uint32_t)dest + Len - 1, &page))
+    {
+        FLASH_PAGE_CLR_BLANK(page.Index);
+    }
+
+#if (DFU_FLASH_PIPELINED > 0)
+    {
+        /* The previous operation has to be finished first */
+        FlashIf_Wait();
+
+        XPD_MemCopy(FlashIf_Block, src, Len);
+
+        /* Program in the background, while the next block is received */
+        FlashIf_Pending = Len;
+        if (XPD_FLASH_Program_IT(dest, FlashIf_Block, Len) != XPD_OK)
+        {
+            FlashIf_Pending = 0;
+        }
+    }
+#else
+    XPD_FLASH_Program(dest, src, Len);
+#endif
+}
+
+#if (DFU_FLASH_COMPRESSED > 0)
+/* Programs the decompressed data, the last odd byte is kept unless Final is set */
+static void FlashIf_ZipFlush(boolean_t Final)
+{
+    uint32_t length = FlashIf_Zip.Length;
+
+    /* Flash is programmed by halfwords */
+    if (Final)
+    {
+        if ((length & 1) != 0)
+        {
+            FlashIf_Zip.Output[length++] = 0xFF;
+        }
+    }
+    else
+    {
+        length &= ~1;
+    }
+
+    if (length > 0)
+    {
+        FlashIf_PageType page;
+
+        /* The host only erases the compressed image's pages,
+         * the rest of the output range is erased on its first write */
+        while ((FlashIf_Zip.Prepared < (FlashIf_Zip.Address + length))
+                && FlashIf_GetPage(FlashIf_Zip.Prepared, &page))
+        {
+            FlashIf_ErasePage(page.Address);
+            FlashIf_Zip.Prepared = page.Address + page.Size;
+        }
+
+        FlashIf_Program((uint8_t*)FlashIf_Zip.Address, FlashIf_Zip.Output, length);
+
+        FlashIf_Zip.Address += length;
+        FlashIf_Zip.Length  -= length;
+
+        if (FlashIf_Zip.Length > 0)
+        {
+            FlashIf_Zip.Output[0] = FlashIf_Zip.Output[length];
+        }
+    }
+}
+
+/* Appends a decompressed byte to the window and the output */
+static void FlashIf_ZipEmit(uint8_t Data)
+{
+    FlashIf_Zip.Window[FlashIf_Zip.Head] = Data;
+    FlashIf_Zip.Head = (FlashIf_Zip.Head + 1) & ((1 << FlashIf_Zip.WindowBits) - 1);
+
+    FlashIf_Zip.Output[FlashIf_Zip.Length++] = Data;
+    if (FlashIf_Zip.Length == sizeof(FlashIf_Zip.Output))
+    {
+        FlashIf_ZipFlush(FALSE);
+    }
+}
+
+/* Takes Count bits from the input, returns FALSE if more input is needed */
+static boolean_t FlashIf_ZipBits(uint8_t Count, const uint8_t **src, uint32_t *Len, uint16_t *value)
+{
+    while (FlashIf_Zip.BitCount < Count)
+    {
+        if (*Len == 0)
+        {
+            return FALSE;
+        }
+        FlashIf_Zip.Bits = (FlashIf_Zip.Bits << 8) | *(*src)++;
+        FlashIf_Zip.BitCount += 8;
+        (*Len)--;
+    }
+
+    FlashIf_Zip.BitCount -= Count;
+    *value = (FlashIf_Zip.Bits >> FlashIf_Zip.BitCount) & ((1 << Count) - 1);
+    return TRUE;
+}
+
+/* Decompresses the input stream segment into the flash */
+static void FlashIf_ZipDecode(const uint8_t *src, uint32_t Len)
+{
+    uint16_t value;
+
+    while (1)
+    {
+        switch (FlashIf_Zip.State)
+        {
+            case FLASHIF_ZIP_TAG:
+                if (!FlashIf_ZipBits(1, &src, &Len, &value))
+                {
+                    return;
+                }
+                FlashIf_Zip.State = (value != 0) ? FLASHIF_ZIP_LITERAL : FLASHIF_ZIP_INDEX;
+                break;
+
+            case FLASHIF_ZIP_LITERAL:
+                if (!FlashIf_ZipBits(8, &src, &Len, &value))
+                {
+                    return;
+                }
+                FlashIf_ZipEmit((uint8_t)value);
+                FlashIf_Zip.State = FLASHIF_ZIP_TAG;
+                break;
+
+            case FLASHIF_ZIP_INDEX:
+                if (!FlashIf_ZipBits(FlashIf_Zip.WindowBits, &src, &Len, &value))
+                {
+                    return;
+                }
+                FlashIf_Zip.Index = value + 1;
+                FlashIf_Zip.State = FLASHIF_ZIP_COUNT;
+                break;
+
+            case FLASHIF_ZIP_COUNT:
+            default:
+                if (!FlashIf_ZipBits(FlashIf_Zip.LookaheadBits, &src, &Len, &value))
+                {
+                    return;
+                }
+                /* Copy the backreference from the window */
+                for (value++; value > 0; value--)
+                {
+                    FlashIf_ZipEmit(FlashIf_Zip.Window[(FlashIf_Zip.Head - FlashIf_Zip.Index)
+                            & ((1 << FlashIf_Zip.WindowBits) - 1)]);
+                }
+                FlashIf_Zip.State = FLASHIF_ZIP_TAG;
+                break;
+        }
+    }
+}
+
+/* Starts a compressed download if the first block has a valid header */
+static boolean_t FlashIf_ZipStart(const uint8_t *src, uint32_t Len)
+{
+    uint32_t i;
+
+    if (    (Len < FLASH_ZIP_HEADER_SIZE)
+         || (*(const uint32_t*)src != FLASH_ZIP_MAGIC)
+         || (src[4] < 4) || (src[4] > DFU_FLASH_COMPRESSED)
+         || (src[5] < 3) || (src[5] >= src[4]))
+    {
+        return FALSE;
+    }
+
+    for (i = 0; i < sizeof(FlashIf_Zip.Window); i++)
+    {
+        FlashIf_Zip.Window[i] = 0;
+    }
+    FlashIf_Zip.Address       = FLASH_WRITE_ADDRESS;
+    FlashIf_Zip.Prepared      = FLASH_WRITE_ADDRESS;
+    FlashIf_Zip.Bits          = 0;
+    FlashIf_Zip.BitCount      = 0;
+    FlashIf_Zip.Head          = 0;
+    FlashIf_Zip.Length        = 0;
+    FlashIf_Zip.WindowBits    = src[4];
+    FlashIf_Zip.LookaheadBits = src[5];
+    FlashIf_Zip.State         = FLASHIF_ZIP_TAG;
+    FlashIf_Zip.Active        = TRUE;
+    return TRUE;
+}
+#endif
+
+#if (DFU_FLASH_DELTA > 0)
+/* Programs the assembled page if it differs from the current contents */
+static void FlashIf_DeltaCommit(void)
+{
+    FlashIf_PageType page;
+    const uint8_t * current = (const uint8_t *)FlashIf_Delta.Address;
+    uint32_t i;
+
+    FlashIf_Wait();
+
+    for (i = 0; (i < FLASH_PAGE_SIZE) && (FlashIf_Delta.Page[i] == current[i]); i++)
+    {
+    }
+
+    if ((i < FLASH_PAGE_SIZE) && FlashIf_GetPage(FlashIf_Delta.Address, &page))
+    {
+        /* The old contents are no longer available as copy source */
+        FlashIf_Delta.Written[page.Index / 32] |= 1UL << (page.Index % 32);
+
+        if (XPD_FLASH_Erase((void*)page.Address, page.Size >> 10) == XPD_OK)
+        {
+            /* Programmed in transfer sized parts for the pipelined path */
+            for (i = 0; i < FLASH_PAGE_SIZE; i += USBD_DFU_XFER_SIZE)
+            {
+                FlashIf_Program((uint8_t*)page.Address + i, &FlashIf_Delta.Page[i],
+                        USBD_DFU_XFER_SIZE);
+            }
+        }
+        else
+        {
+            FlashIf_Delta.State = FLASHIF_DELTA_ERROR;
+        }
+    }
+
+    FlashIf_Delta.Address += FLASH_PAGE_SIZE;
+    FlashIf_Delta.Offset   = 0;
+}
+
+/* Appends a byte to the new image */
+static void FlashIf_DeltaEmit(uint8_t Data)
+{
+    FlashIf_Delta.Page[FlashIf_Delta.Offset++] = Data;
+    FlashIf_Delta.Remaining--;
+
+    if (FlashIf_Delta.Remaining == 0)
+    {
+        /* The rest of the last page is left erased */
+        XPD_MemSet(&FlashIf_Delta.Page[FlashIf_Delta.Offset], 0xFF,
+                FLASH_PAGE_SIZE - FlashIf_Delta.Offset);
+        FlashIf_Delta.Offset = FLASH_PAGE_SIZE;
+        FlashIf_DeltaCommit();
+        if (FlashIf_Delta.State != FLASHIF_DELTA_ERROR)
+        {
+            FlashIf_Delta.State = FLASHIF_DELTA_DONE;
+        }
+    }
+    else if (FlashIf_Delta.Offset == FLASH_PAGE_SIZE)
+    {
+        FlashIf_DeltaCommit();
+    }
+}
+
+/* Copies a section of the current image to the new image */
+static void FlashIf_DeltaCopy(uint32_t Source, uint16_t Length)
+{
+    FlashIf_PageType page;
+
+    while ((Length-- > 0) && (FlashIf_Delta.State == FLASHIF_DELTA_OP))
+    {
+        uint32_t address = FLASH_WRITE_ADDRESS + Source++;
+
+        if (    (FlashIf_Delta.Remaining == 0)
+             || !FlashIf_GetPage(address, &page)
+             || (((FlashIf_Delta.Written[page.Index / 32] >> (page.Index % 32)) & 1) != 0))
+        {
+            FlashIf_Delta.State = FLASHIF_DELTA_ERROR;
+        }
+        else
+        {
+            FlashIf_DeltaEmit(*(const uint8_t *)address);
+        }
+    }
+}
+
+/* Applies the patch stream segment */
+static void FlashIf_DeltaApply(const uint8_t *src, uint32_t Len)
+{
+    while (Len > 0)
+    {
+        switch (FlashIf_Delta.State)
+        {
+            case FLASHIF_DELTA_OP:
+            {
+                uint8_t opSize;
+
+                FlashIf_Delta.Op[FlashIf_Delta.OpLength++] = *src++;
+                Len--;
+
+                opSize = (FlashIf_Delta.Op[0] == FLASH_DELTA_COPY) ? 7 : 3;
+                if (FlashIf_Delta.OpLength == opSize)
+                {
+                    uint16_t length = FlashIf_Delta.Op[1] | ((uint16_t)FlashIf_Delta.Op[2] << 8);
+
+                    FlashIf_Delta.OpLength = 0;
+
+                    if (length == 0)
+                    {
+                        FlashIf_Delta.State = FLASHIF_DELTA_ERROR;
+                    }
+                    else if (FlashIf_Delta.Op[0] == FLASH_DELTA_COPY)
+                    {
+                        FlashIf_DeltaCopy(   FlashIf_Delta.Op[3]
+                                          | ((uint32_t)FlashIf_Delta.Op[4] << 8)
+                                          | ((uint32_t)FlashIf_Delta.Op[5] << 16)
+                                          | ((uint32_t)FlashIf_Delta.Op[6] << 24), length);
+                    }
+                    else if (FlashIf_Delta.Op[0] == FLASH_DELTA_INSERT)
+                    {
+                        FlashIf_Delta.Count = length;
+                        FlashIf_Delta.State = FLASHIF_DELTA_INSERT;
+                    }
+                    else
+                    {
+                        FlashIf_Delta.State = FLASHIF_DELTA_ERROR;
+                    }
+                }
+                break;
+            }
+
+            case FLASHIF_DELTA_INSERT:
+                FlashIf_Delta.Count--;
+                FlashIf_Delta.State = (FlashIf_Delta.Count > 0) ?
+                        FLASHIF_DELTA_INSERT : FLASHIF_DELTA_OP;
+                FlashIf_DeltaEmit(*src++);
+                Len--;
+                break;
+
+            default:
+                /* Complete or invalid, the rest is ignored */
+                return;
+        }
+    }
+}
+
+/* Starts applying a patch if the first block has a valid header */
+static void FlashIf_DeltaStart(const uint8_t *src, uint32_t Len)
+{
+    uint32_t i, size = 0;
+
+    if (Len >= FLASH_DELTA_HEADER_SIZE)
+    {
+        size = src[4] | ((uint32_t)src[5] << 8) | ((uint32_t)src[6] << 16) | ((uint32_t)src[7] << 24);
+    }
+
+    if (    (size == 0)
+         || (*(const uint32_t*)src != FLASH_DELTA_MAGIC)
+         || (size > ((uint32_t)FLASH_PAGE_SIZE * FLASH_PAGE_COUNT - (FLASH_WRITE_ADDRESS - FLASH_BASE))))
+    {
+        FlashIf_Delta.State = FLASHIF_DELTA_ERROR;
+        return;
+    }
+
+    for (i = 0; i < sizeof(FlashIf_Delta.Written) / sizeof(FlashIf_Delta.Written[0]); i++)
+    {
+        FlashIf_Delta.Written[i] = 0;
+    }
+    FlashIf_Delta.Address   = FLASH_WRITE_ADDRESS;
+    FlashIf_Delta.Remaining = size;
+    FlashIf_Delta.Offset    = 0;
+    FlashIf_Delta.OpLength  = 0;
+    FlashIf_Delta.State     = FLASHIF_DELTA_OP;
+
+    FlashIf_DeltaApply(src + FLASH_DELTA_HEADER_SIZE, Len - FLASH_DELTA_HEADER_SIZE);
+}
+#endif
+
 /**
  * @brief  Erases flash block.
+ * @note   Pages which are already erased are skipped. With erase-ahead,
+ *         the subsequent non-blank pages of the bank are erased in the
+ *         same background operation, so their erase requests are
+ *         completed instantly. During a compressed download the erase
+ *         requests are ignored, the pages are erased as the output reaches them.
  * @param  Add: Address of block to be erased.
  */
 void FlashIf_Erase(uint32_t Add)
 {
-    /* Erase flash memory from the start address
-     * As length is not provided, only delete one block */
-    XPD_FLASH_Erase((void*)Add, 1);
+#if (DFU_FLASH_EXTERNAL > 0)
+    /* The external block is erased in the background */
+    if (FLASH_IS_EXTERNAL(Add))
+    {
+        (void) SpiNor_Erase(Add - FLASH_EXT_ADDRESS);
+        return;
+    }
+#endif
+#if (DFU_FLASH_COMPRESSED > 0)
+    if (FlashIf_Zip.Active)
+    {
+        return;
+    }
+#endif
+    FlashIf_ErasePage(Add);
 }
 
 /**
  * @brief  Writes Data into Memory.
+ * @note   A download starting at the application address with a compressed image
+ *         header is decompressed on the fly into the flash. A download to the
+ *         virtual patch segment is applied as a differential update of the image.
  * @param  dest: Pointer to the destination buffer.
  * @param  src: Pointer to the source buffer. Address to be written to.
  * @param  Len: Number of data to be written (in bytes).
  */
 void FlashIf_Write(uint8_t *dest, uint8_t *src, uint32_t Len)
 {
-    XPD_FLASH_Program(dest, src, Len);
+#if (DFU_FLASH_EXTERNAL > 0)
+    /* The external pages are programmed in the background from a copy,
+     * while the DFU buffer receives the next block */
+    if (FLASH_IS_EXTERNAL(dest))
+    {
+        (void) SpiNor_Wait();
+        XPD_MemCopy(FlashIf_ExtBlock, src, Len);
+        (void) SpiNor_Program((uint32_t)dest - FLASH_EXT_ADDRESS, FlashIf_ExtBlock, Len);
+        return;
+    }
+#endif
+#if (DFU_FLASH_DELTA > 0)
+    /* Patches are received in the virtual segment */
+    if (((uint32_t)dest - FLASH_DELTA_ADDRESS) < FLASH_DELTA_SIZE)
+    {
+        if ((uint32_t)dest == FLASH_DELTA_ADDRESS)
+        {
+            FlashIf_DeltaStart(src, Len);
+        }
+        else
+        {
+            FlashIf_DeltaApply(src, Len);
+        }
+        return;
+    }
+#endif
+#if (DFU_FLASH_COMPRESSED > 0)
+    if ((uint32_t)dest == FLASH_WRITE_ADDRESS)
+    {
+        /* A new download is started */
+        FlashIf_Zip.Active = FALSE;
+
+        if (FlashIf_ZipStart(src, Len))
+        {
+            src += FLASH_ZIP_HEADER_SIZE;
+            Len -= FLASH_ZIP_HEADER_SIZE;
+        }
+    }
+    if (FlashIf_Zip.Active)
+    {
+        FlashIf_ZipDecode(src, Len);
+        FlashIf_ZipFlush(FALSE);
+        return;
+    }
+#endif
+    FlashIf_Program(dest, src, Len);
 }
 
 /**
- * @brief  Reads Data into Memory.
+ * @brief  Provides the memory contents to upload.
+ * @note   The memory is mapped, so the data is transmitted directly from its location.
  * @param  dest: Pointer to the destination buffer.
- * @param  src: Pointer to the source buffer. Address to be written to.
+ * @param  src: Pointer to the source buffer. Address to be read from.
  * @param  Len: Number of data to be read (in bytes).
+ * @return Pointer to the read data.
  */
-void FlashIf_Read(uint8_t *dest, uint8_t *src, uint32_t Len)
+uint8_t *FlashIf_Read(uint8_t *dest, uint8_t *src, uint32_t Len)
 {
-    while (Len-- > 0)
+#if (DFU_FLASH_EXTERNAL > 0)
+    /* The external flash isn't mapped, it is read to the DFU buffer */
+    if (FLASH_IS_EXTERNAL(src))
     {
-        *dest++ = *src++;
+        if (SpiNor_Read((uint32_t)src - FLASH_EXT_ADDRESS, dest, Len) != XPD_OK)
+        {
+            XPD_MemSet(dest, 0xFF, Len);
+        }
+        return dest;
     }
+#endif
+    /* The flash contents are only valid once the background operations are done */
+    FlashIf_Wait();
+
+#if (DFU_FLASH_DELTA > 0)
+    /* The patch segment isn't mapped, it reads as erased */
+    if (((uint32_t)src >= FLASH_DELTA_ADDRESS) &&
+        ((uint32_t)src < (FLASH_DELTA_ADDRESS + FLASH_DELTA_SIZE)))
+    {
+        XPD_MemSet(dest, 0xFF, Len);
+        return dest;
+    }
+#endif
+    return src;
 }
 
 /**
  * @brief  Gets memory operation duration.
+ * @note   In pipelined mode the operations are performed in the background,
+ *         so the reported duration is the remaining time of the ongoing one.
  * @param  Add: Address to be read from.
  * @param  Cmd: Type of operation.
  * @param  buffer: Response data - duration of operation.
  */
 void FlashIf_GetStatus(uint32_t Add, uint8_t Cmd, uint8_t *buffer)
 {
+    FlashIf_PageType page;
+    uint32_t time;
+
+#if (DFU_FLASH_EXTERNAL > 0)
+    /* The external operations are started after the status is sent,
+     * only the completion of the ongoing one is waited for */
+    if (FLASH_IS_EXTERNAL(Add))
+    {
+        time = SpiNor_PendingTime();
+    }
+    else
+#endif
     switch (Cmd)
     {
         case DFU_MEDIA_PROGRAM:
-            buffer[1] = (uint8_t) FLASH_PROGRAM_TIME;
-            buffer[2] = (uint8_t)(FLASH_PROGRAM_TIME << 8);
-            buffer[3] = 0;
+#if (DFU_FLASH_PIPELINED > 0)
+            time = FlashIf_PendingTime();
+#else
+            time = FLASH_PROGRAM_MS(USBD_DFU_XFER_SIZE);
+#endif
+#if (DFU_FLASH_DELTA > 0)
+            /* A patch block may complete a changed page */
+            if ((Add - FLASH_DELTA_ADDRESS) < FLASH_DELTA_SIZE)
+            {
+                time += FLASH_PAGE_ERASE_MS + FLASH_PROGRAM_MS(FLASH_PAGE_SIZE);
+            }
+#endif
+#if (DFU_FLASH_COMPRESSED > 0)
+            /* The decompressed output of a block is typically twice as large,
+             * and may reach a page which needs to be erased */
+            if (FlashIf_Zip.Active)
+            {
+                time += FLASH_PROGRAM_MS(USBD_DFU_XFER_SIZE) + FLASH_PAGE_ERASE_MS;
+            }
+#endif
             break;
 
         case DFU_MEDIA_ERASE:
         default:
-            buffer[1] = (uint8_t) FLASH_ERASE_TIME;
-            buffer[2] = (uint8_t)(FLASH_ERASE_TIME << 8);
-            buffer[3] = 0;
+            if (!FlashIf_GetPage(Add, &page) || (FLASH_PAGE_BLANK(page.Index) != 0)
+#if (DFU_FLASH_COMPRESSED > 0)
+                    || FlashIf_Zip.Active
+#endif
+               )
+            {
+                /* Erase is skipped */
+                time = 0;
+            }
+            else
+            {
+                time = FlashIf_PendingTime();
+#if (DFU_FLASH_PIPELINED == 0) || (DFU_FLASH_ERASE_AHEAD == 0)
+                time += FLASH_PAGE_ERASE_MS;
+#endif
+            }
             break;
     }
+
+    /* bwPollTimeout */
+    buffer[1] = (uint8_t) time;
+    buffer[2] = (uint8_t)(time >> 8);
+    buffer[3] = (uint8_t)(time >> 16);
 }
@@ -52,6 +52,10 @@
                                   This value must be a multiple of 0x200. */
 #endif
 
+/*!< Comment the following line if the linker script doesn't provide the .ccmram section.
+     When enabled, the .ccmram section (code and initialized data) is loaded from flash */
+#define CCMRAM_INIT
+
 /**
   * @}
   */
@@ -80,6 +84,20 @@ RCC_ResetSourceType ResetSource;
   */
 void SystemInit(void)
 {
+#if defined(CCMRAM_INIT) && defined(__GNUC__)
+    /* Load the CCM RAM section, using the linker script symbols */
+    {
+        extern uint32_t _siccmram, _sccmram, _eccmram;
+        const uint32_t * src = &_siccmram;
+        uint32_t * dst;
+
+        for (dst = &_sccmram; dst < &_eccmram; dst++)
+        {
+            *dst = *src++;
+        }
+    }
+#endif
+
     /* Reset all peripherals */
     XPD_Deinit();
 
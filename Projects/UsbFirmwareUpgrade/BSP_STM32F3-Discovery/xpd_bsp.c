@@ -23,6 +23,7 @@
   */
 #include <xpd_bsp.h>
 
+#include <xpd_flash.h>
 #include <xpd_rcc.h>
 
 const GPIO_InitType PinConfig[] =
@@ -35,8 +36,17 @@ const GPIO_InitType PinConfig[] =
         .Output.Speed = VERY_HIGH,
         .AlternateMap = GPIO_USB_AF14
     },
+    /* SPI pins */
+    {
+        .Mode = GPIO_MODE_ALTERNATE,
+        .Pull = GPIO_PULL_FLOAT,
+        .Output.Type  = GPIO_OUTPUT_PUSHPULL,
+        .Output.Speed = VERY_HIGH,
+        .AlternateMap = GPIO_SPI2_AF5
+    },
     /* Outputs:
      * USB 1K5 pullup connector
+     * SPI flash chip select
      * LEDs */
     {
         .Mode = GPIO_MODE_OUTPUT,
@@ -60,7 +70,7 @@ void ClockConfiguration(void)
     XPD_RCC_PLLConfig(&pll);
 
     /* System clocks configuration */
-    XPD_RCC_HCLKConfig(PLL, CLK_DIV1, 2);
+    XPD_RCC_HCLKConfig(PLL, CLK_DIV1, FLASH_LATENCY_AUTO);
 
     XPD_RCC_PCLKConfig(PCLK1, CLK_DIV2);
     XPD_RCC_PCLKConfig(PCLK2, CLK_DIV1);
@@ -95,7 +105,9 @@ static void usbinit(void * handle)
     /* Remap USB interrupts */
     XPD_USB_ITRemap(ENABLE);
 
-    /* Enable USB FS Interrupt (only EP0 used, USB_HP_IRQn is not used) */
+    /* Enable USB FS Interrupt (only EP0 used, USB_HP_IRQn is not used),
+     * FLASH interrupt has to be able to preempt it */
+    XPD_NVIC_SetPriorityConfig(USB_LP_IRQn, 1, 0);
     XPD_NVIC_EnableIRQ(USB_LP_IRQn);
 }
 
@@ -117,3 +129,90 @@ void USB_LP_IRQHandler(void)
 {
     XPD_USB_IRQHandler(&usbHandle);
 }
+
+/************************* FLASH **********************************/
+
+/* FLASH interrupt handling */
+void FLASH_IRQHandler(void)
+{
+    XPD_FLASH_IRQHandler();
+}
+
+/************************* SPI ************************************/
+DMA_HandleType dmaspit = NEW_DMA_HANDLE(DMA1_Channel5);
+DMA_HandleType dmaspir = NEW_DMA_HANDLE(DMA1_Channel4);
+
+/* SPI dependencies initialization */
+static void spiinit(void * handle)
+{
+    DMA_InitType dmaSetup =
+    {
+        .Priority                 = HIGH,
+        .Mode                     = DMA_MODE_NORMAL,
+        .Memory.DataAlignment     = DMA_ALIGN_BYTE,
+        .Memory.Increment         = ENABLE,
+        .Peripheral.DataAlignment = DMA_ALIGN_BYTE,
+        .Peripheral.Increment     = DISABLE,
+        .Direction                = DMA_MEMORY2PERIPH,
+    };
+    const GPIO_PinMapType spiPins[] = {
+        { NOR_SCK_PIN,  &PinConfig[SPI_PIN_CFG] },
+        { NOR_MISO_PIN, &PinConfig[SPI_PIN_CFG] },
+        { NOR_MOSI_PIN, &PinConfig[SPI_PIN_CFG] },
+        { NOR_CS_PIN,   &PinConfig[OUT_PIN_CFG] },
+    };
+
+    /* GPIO settings, the flash is deselected between transactions */
+    XPD_GPIO_WritePin(NOR_CS_PIN, 1);
+    XPD_GPIO_InitPinMap(spiPins, sizeof(spiPins) / sizeof(spiPins[0]));
+
+    /* DMA settings */
+    XPD_DMA_Init(&dmaspit, &dmaSetup);
+    dmaSetup.Direction = DMA_PERIPH2MEMORY;
+    XPD_DMA_Init(&dmaspir, &dmaSetup);
+
+    ((SPI_HandleType*)handle)->DMA.Transmit = &dmaspit;
+    ((SPI_HandleType*)handle)->DMA.Receive  = &dmaspir;
+
+    /* The flash operations are waited for in the USB interrupt,
+     * so the SPI interrupts have to be able to preempt it */
+    XPD_NVIC_SetPriorityConfig(DMA1_Channel4_IRQn, 0, 0);
+    XPD_NVIC_SetPriorityConfig(DMA1_Channel5_IRQn, 0, 0);
+    XPD_NVIC_SetPriorityConfig(SPI2_IRQn, 0, 0);
+    XPD_NVIC_EnableIRQ(DMA1_Channel4_IRQn);
+    XPD_NVIC_EnableIRQ(DMA1_Channel5_IRQn);
+    XPD_NVIC_EnableIRQ(SPI2_IRQn);
+}
+
+/* SPI dependencies deinitialization */
+static void spideinit(void * handle)
+{
+    XPD_GPIO_DeinitPin(NOR_SCK_PIN);
+    XPD_GPIO_DeinitPin(NOR_MISO_PIN);
+    XPD_GPIO_DeinitPin(NOR_MOSI_PIN);
+    XPD_GPIO_DeinitPin(NOR_CS_PIN);
+
+    XPD_DMA_Deinit(&dmaspit);
+    XPD_DMA_Deinit(&dmaspir);
+    XPD_NVIC_DisableIRQ(DMA1_Channel4_IRQn);
+    XPD_NVIC_DisableIRQ(DMA1_Channel5_IRQn);
+    XPD_NVIC_DisableIRQ(SPI2_IRQn);
+}
+
+/* SPI DMA interrupt handling */
+void DMA1_Channel4_IRQHandler(void)
+{
+    XPD_DMA_IRQHandler(&dmaspir);
+}
+void DMA1_Channel5_IRQHandler(void)
+{
+    XPD_DMA_IRQHandler(&dmaspit);
+}
+
+SPI_HandleType spiHandle = NEW_SPI_HANDLE(SPI2, spiinit, spideinit);
+
+/* SPI interrupt handling */
+void SPI2_IRQHandler(void)
+{
+    XPD_SPI_IRQHandler(&spiHandle);
+}
@@ -27,11 +27,13 @@
 #include <xpd_core.h>
 #include <xpd_flash.h>
 #include <xpd_gpio.h>
+#include <xpd_spi.h>
 #include <xpd_usb.h>
 
 typedef enum
 {
     USB_PIN_CFG = 0,
+    SPI_PIN_CFG,
     OUT_PIN_CFG,
     PIN_CFG_COUNT
 }PinType;
@@ -42,11 +44,19 @@ typedef enum
 #define USB_DP_PIN      GPIOA, 12
 #define USB_DM_PIN      GPIOA, 11
 
+/* External SPI NOR flash on SPI2 */
+#define NOR_SCK_PIN     GPIOB, 13
+#define NOR_MISO_PIN    GPIOB, 14
+#define NOR_MOSI_PIN    GPIOB, 15
+#define NOR_CS_PIN      GPIOB, 12
+
 /* Indexed by PinType */
 extern const GPIO_InitType PinConfig[];
 
 extern USB_HandleType usbHandle;
 
+extern SPI_HandleType spiHandle;
+
 extern void ClockConfiguration(void);
 
 #endif /* __XPD_BSP_H_ */
@@ -34,6 +34,7 @@
 
 /* TODO step 3: specify used XPD modules */
 #define USE_XPD_FLASH
+#define USE_XPD_SPI
 #define USE_XPD_USB
 
 
@@ -0,0 +1,50 @@
+/**
+  ******************************************************************************
+  * @file    main.c
+  * @author  Benedek Kupper
+  * @version V0.1
+  * @date    2018-01-20
+  * @brief   STM32 eXtensible Peripheral Drivers USB SPI I2C Bridge Project
+  *
+  *  This file is part of STM32_XPD.
+  *
+  *  STM32_XPD is free software: you can redistribute it and/or modify
+  *  it under the terms of the GNU General Public License as published by
+  *  the Free Software Foundation, either version 3 of the License, or
+  *  (at your option) any later version.
+  *
+  *  STM32_XPD is distributed in the hope that it will be useful,
+  *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with STM32_XPD.  If not, see <http://www.gnu.org/licenses/>.
+  */
+#include <xpd_bsp.h>
+
+#include <usbd_core.h>
+#include <usbd_desc.h>
+#include <usbd_vendor_if.h>
+
+int main(void)
+{
+    ClockConfiguration();
+
+    Bridge_Init();
+
+    /* Init Device Library, Add Supported Class and Start the library */
+    USBD_Init(&hUsbDeviceFS, (void*)&VENDOR_Desc, DEVICE_FS);
+
+    USBD_RegisterClass(&hUsbDeviceFS, (void*)&USBD_VENDOR);
+
+    USBD_VENDOR_RegisterInterface(&hUsbDeviceFS, &USBD_Interface_fops_FS);
+
+    USBD_Start(&hUsbDeviceFS);
+
+    while(1)
+    {
+        /* The batches are executed in thread mode, as they may contain delays */
+        Bridge_Process();
+    }
+}
@@ -0,0 +1,298 @@
+/**
+  ******************************************************************************
+  * @file    USB_Device/CDC_Standalone/Src/usbd_desc.c
+  * @author  MCD Application Team
+  * @version V1.7.0
+  * @date    17-February-2017
+  * @brief   This file provides the USBD descriptors and string formating method.
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright(c) 2017 STMicroelectronics International N.V.
+  * All rights reserved.</center></h2>
+  *
+  * Redistribution and use in source and binary forms, with or without
+  * modification, are permitted, provided that the following conditions are met:
+  *
+  * 1. Redistribution of source code must retain the above copyright notice,
+  *    this list of conditions and the following disclaimer.
+  * 2. Redistributions in binary form must reproduce the above copyright notice,
+  *    this list of conditions and the following disclaimer in the documentation
+  *    and/or other materials provided with the distribution.
+  * 3. Neither the name of STMicroelectronics nor the names of other
+  *    contributors to this software may be used to endorse or promote products
+  *    derived from this software without specific written permission.
+  * 4. This software, including modifications and/or derivative works of this
+  *    software, must execute solely and exclusively on microcontroller or
+  *    microprocessor devices manufactured by or for STMicroelectronics.
+  * 5. Redistribution and use of this software other than as permitted under
+  *    this license is void and will automatically terminate your rights under
+  *    this license.
+  *
+  * THIS SOFTWARE IS PROVIDED BY STMICROELECTRONICS AND CONTRIBUTORS "AS IS"
+  * AND ANY EXPRESS, IMPLIED OR STATUTORY WARRANTIES, INCLUDING, BUT NOT
+  * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+  * PARTICULAR PURPOSE AND NON-INFRINGEMENT OF THIRD PARTY INTELLECTUAL PROPERTY
+  * RIGHTS ARE DISCLAIMED TO THE FULLEST EXTENT PERMITTED BY LAW. IN NO EVENT
+  * SHALL STMICROELECTRONICS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+  * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+  * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+  * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+  * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+  * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+  * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "usbd_core.h"
+#include "usbd_desc.h"
+#include "usbd_conf.h"
+#include "usbd_vendor.h"
+
+/* Private typedef -----------------------------------------------------------*/
+/* Private define ------------------------------------------------------------*/
+#define USBD_VID                      0x0483
+#define USBD_PID                      0x5750
+#define USBD_LANGID_STRING            0x409
+#define USBD_MANUFACTURER_STRING      "STMicroelectronics"
+#define USBD_PRODUCT_FS_STRING        "STM32 SPI I2C Bridge"
+#define USBD_CONFIGURATION_FS_STRING  "Vendor Config"
+#define USBD_INTERFACE_FS_STRING      "Bridge Interface"
+#define  USB_SIZ_STRING_SERIAL        0x1A
+#if (USBD_LPM_ENABLED == 1)
+#define  USB_SIZ_BOS_DESC             (0x0C + USB_VENDOR_MSOS20_PLATFORM_CAP_SIZ)
+#else
+#define  USB_SIZ_BOS_DESC             (0x05 + USB_VENDOR_MSOS20_PLATFORM_CAP_SIZ)
+#endif
+
+/* Private macro -------------------------------------------------------------*/
+/* Private function prototypes -----------------------------------------------*/
+uint8_t *USBD_VENDOR_DeviceDescriptor(USBD_SpeedTypeDef speed, uint16_t *length);
+uint8_t *USBD_VENDOR_LangIDStrDescriptor(USBD_SpeedTypeDef speed, uint16_t *length);
+uint8_t *USBD_VENDOR_ManufacturerStrDescriptor(USBD_SpeedTypeDef speed, uint16_t *length);
+uint8_t *USBD_VENDOR_ProductStrDescriptor(USBD_SpeedTypeDef speed, uint16_t *length);
+uint8_t *USBD_VENDOR_SerialStrDescriptor(USBD_SpeedTypeDef speed, uint16_t *length);
+uint8_t *USBD_VENDOR_ConfigStrDescriptor(USBD_SpeedTypeDef speed, uint16_t *length);
+uint8_t *USBD_VENDOR_InterfaceStrDescriptor(USBD_SpeedTypeDef speed, uint16_t *length);
+uint8_t *USBD_VENDOR_BOSDescriptor(USBD_SpeedTypeDef speed, uint16_t *length);
+#ifdef USB_SUPPORT_USER_STRING_DESC
+uint8_t *USBD_VENDOR_USRStringDesc (USBD_SpeedTypeDef speed, uint8_t idx, uint16_t *length);
+#endif /* USB_SUPPORT_USER_STRING_DESC */  
+
+/* Private variables ---------------------------------------------------------*/
+const USBD_DescriptorsTypeDef VENDOR_Desc = {
+    USBD_VENDOR_DeviceDescriptor,
+    USBD_VENDOR_LangIDStrDescriptor,
+    USBD_VENDOR_ManufacturerStrDescriptor,
+    USBD_VENDOR_ProductStrDescriptor,
+    USBD_VENDOR_SerialStrDescriptor,
+    USBD_VENDOR_ConfigStrDescriptor,
+    USBD_VENDOR_InterfaceStrDescriptor,
+    USBD_VENDOR_BOSDescriptor,
+};
+
+/* USB Standard Device Descriptor */
+#if defined ( __ICCARM__ ) /*!< IAR Compiler */
+#pragma data_alignment=4
+#endif
+__ALIGN_BEGIN const uint8_t USBD_DeviceDesc[USB_LEN_DEV_DESC] __ALIGN_END = {
+    0x12,                               /* bLength */
+    USB_DESC_TYPE_DEVICE,               /* bDescriptorType */
+    0x01,0x02,                          /* bcdUSB: 2.01 for BOS descriptor support */
+    0x00,                               /* bDeviceClass: defined by the interface */
+    0x00,                               /* bDeviceSubClass */
+    0x00,                               /* bDeviceProtocol */
+    USB_MAX_EP0_SIZE,                   /* bMaxPacketSize */
+    LOBYTE(USBD_VID),HIBYTE(USBD_VID),  /* idVendor */
+    LOBYTE(USBD_PID),HIBYTE(USBD_PID),  /* idVendor */
+    0x00,0x02,                          /* bcdDevice rel. 2.00 */
+    USBD_IDX_MFC_STR,                   /* Index of manufacturer string */
+    USBD_IDX_PRODUCT_STR,               /* Index of product string */
+    USBD_IDX_SERIAL_STR,                /* Index of serial number string */
+    USBD_MAX_NUM_CONFIGURATION          /* bNumConfigurations */
+};
+
+/* USB Standard Device Descriptor */
+#if defined ( __ICCARM__ ) /*!< IAR Compiler */
+#pragma data_alignment=4
+#endif
+__ALIGN_BEGIN const uint8_t USBD_LangIDDesc[USB_LEN_LANGID_STR_DESC] __ALIGN_END = {
+    USB_LEN_LANGID_STR_DESC,
+    USB_DESC_TYPE_STRING,
+    LOBYTE(USBD_LANGID_STRING),HIBYTE(USBD_LANGID_STRING),
+};
+
+/* USB BOS Descriptor with the Microsoft OS 2.0 platform capability,
+ * and the USB 2.0 Extension capability when LPM is supported */
+#if defined ( __ICCARM__ ) /*!< IAR Compiler */
+#pragma data_alignment=4
+#endif
+__ALIGN_BEGIN const uint8_t USBD_BOSDesc[USB_SIZ_BOS_DESC] __ALIGN_END = {
+    0x05,                               /* bLength */
+    USB_DESC_TYPE_BOS,                  /* bDescriptorType */
+    LOBYTE(USB_SIZ_BOS_DESC),HIBYTE(USB_SIZ_BOS_DESC), /* wTotalLength */
+#if (USBD_LPM_ENABLED == 1)
+    0x02,                               /* bNumDeviceCaps */
+
+    0x07,                               /* bLength */
+    0x10,                               /* bDescriptorType: Device Capability */
+    0x02,                               /* bDevCapabilityType: USB 2.0 Extension */
+    0x06,0x00,0x00,0x00,                /* bmAttributes: LPM and BESL support */
+#else
+    0x01,                               /* bNumDeviceCaps */
+#endif
+
+    USB_VENDOR_MSOS20_PLATFORM_CAP_DESC
+};
+
+/* USB String Descriptors, encoded at build time */
+USBD_STRING_DESC(USBD_ManufacturerStrDesc, USBD_MANUFACTURER_STRING);
+USBD_STRING_DESC(USBD_ProductStrDesc, USBD_PRODUCT_FS_STRING);
+USBD_STRING_DESC(USBD_ConfigStrDesc, USBD_CONFIGURATION_FS_STRING);
+USBD_STRING_DESC(USBD_InterfaceStrDesc, USBD_INTERFACE_FS_STRING);
+
+uint8_t USBD_StringSerial[USB_SIZ_STRING_SERIAL] =
+{
+    USB_SIZ_STRING_SERIAL,
+    USB_DESC_TYPE_STRING,
+};
+
+/* Private functions ---------------------------------------------------------*/
+static void UintToUnicode (uint32_t value , uint8_t *pbuf , uint8_t len);
+
+/**
+  * @brief  Returns the device descriptor.
+  * @param  speed: Current device speed
+  * @param  length: Pointer to data length variable
+  * @retval Pointer to descriptor buffer
+  */
+uint8_t *USBD_VENDOR_DeviceDescriptor(USBD_SpeedTypeDef speed, uint16_t *length)
+{
+    *length = sizeof(USBD_DeviceDesc);
+    return (uint8_t*)USBD_DeviceDesc;
+}
+
+/**
+  * @brief  Returns the BOS descriptor.
+  * @param  speed: Current device speed
+  * @param  length: Pointer to data length variable
+  * @retval Pointer to descriptor buffer
+  */
+uint8_t *USBD_VENDOR_BOSDescriptor(USBD_SpeedTypeDef speed, uint16_t *length)
+{
+    *length = sizeof(USBD_BOSDesc);
+    return (uint8_t*)USBD_BOSDesc;
+}
+
+/**
+  * @brief  Returns the LangID string descriptor.
+  * @param  speed: Current device speed
+  * @param  length: Pointer to data length variable
+  * @retval Pointer to descriptor buffer
+  */
+uint8_t *USBD_VENDOR_LangIDStrDescriptor(USBD_SpeedTypeDef speed, uint16_t *length)
+{
+    *length = sizeof(USBD_LangIDDesc);
+    return (uint8_t*)USBD_LangIDDesc;
+}
+
+/**
+  * @brief  Returns the product string descriptor.
+  * @param  speed: Current device speed
+  * @param  length: Pointer to data length variable
+  * @retval Pointer to descriptor buffer
+  */
+uint8_t *USBD_VENDOR_ProductStrDescriptor(USBD_SpeedTypeDef speed, uint16_t *length)
+{
+    *length = sizeof(USBD_ProductStrDesc);
+    return (uint8_t*)&USBD_ProductStrDesc;
+}
+
+/**
+  * @brief  Returns the manufacturer string descriptor.
+  * @param  speed: Current device speed
+  * @param  length: Pointer to data length variable
+  * @retval Pointer to descriptor buffer
+  */
+uint8_t *USBD_VENDOR_ManufacturerStrDescriptor(USBD_SpeedTypeDef speed, uint16_t *length)
+{
+    *length = sizeof(USBD_ManufacturerStrDesc);
+    return (uint8_t*)&USBD_ManufacturerStrDesc;
+}
+
+/**
+  * @brief  Returns the serial number string descriptor.
+  * @param  speed: Current device speed
+  * @param  length: Pointer to data length variable
+  * @retval Pointer to descriptor buffer
+  */
+uint8_t *USBD_VENDOR_SerialStrDescriptor(USBD_SpeedTypeDef speed, uint16_t *length)
+{
+    *length = USB_SIZ_STRING_SERIAL;
+
+    /* The unique ID is only converted at the first request */
+    if (USBD_StringSerial[2] == 0)
+    {
+        UintToUnicode(DEVICE_ID_REG[0] + DEVICE_ID_REG[2], &USBD_StringSerial[2], 8);
+        UintToUnicode(DEVICE_ID_REG[1], &USBD_StringSerial[18], 4);
+    }
+
+    return (uint8_t*)USBD_StringSerial;
+}
+
+/**
+  * @brief  Returns the configuration string descriptor.
+  * @param  speed: Current device speed
+  * @param  length: Pointer to data length variable
+  * @retval Pointer to descriptor buffer
+  */
+uint8_t *USBD_VENDOR_ConfigStrDescriptor(USBD_SpeedTypeDef speed, uint16_t *length)
+{
+    *length = sizeof(USBD_ConfigStrDesc);
+    return (uint8_t*)&USBD_ConfigStrDesc;
+}
+
+/**
+  * @brief  Returns the interface string descriptor.
+  * @param  speed: Current device speed
+  * @param  length: Pointer to data length variable
+  * @retval Pointer to descriptor buffer
+  */
+uint8_t *USBD_VENDOR_InterfaceStrDescriptor(USBD_SpeedTypeDef speed, uint16_t *length)
+{
+    *length = sizeof(USBD_InterfaceStrDesc);
+    return (uint8_t*)&USBD_InterfaceStrDesc;
+}
+
+/**
+  * @brief  Convert Hex 32Bits value into char
+  * @param  value: value to convert
+  * @param  pbuf: pointer to the buffer
+  * @param  len: buffer length
+  * @retval None
+  */
+static void UintToUnicode (uint32_t value , uint8_t *pbuf , uint8_t len)
+{
+    uint8_t idx = 0;
+
+    for (idx = 0; idx < len; idx++)
+    {
+        if (((value >> 28)) < 0xA)
+        {
+            pbuf[2 * idx] = (value >> 28) + '0';
+        }
+        else
+        {
+            pbuf[2 * idx] = (value >> 28) + 'A' - 10;
+        }
+
+        value = value << 4;
+
+        pbuf[2 * idx + 1] = 0;
+    }
+}
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
+
@@ -0,0 +1,385 @@
+/**
+  ******************************************************************************
+  * @file    usbd_vendor_if.c
+  * @author  Benedek Kupper
+  * @version V0.1
+  * @date    2018-01-20
+  * @brief   STM32 eXtensible Peripheral Drivers USB SPI I2C Bridge Project
+  *
+  *  @verbatim
+  *
+  *          ===================================================================
+  *                                USB SPI I2C Bridge
+  *          ===================================================================
+  *           This project executes batches of SPI and I2C transactions, which
+  *           are received over the bulk OUT endpoint of the vendor interface.
+  *           The consecutive transactions of a bus are put in the transaction
+  *           queue of the bus together, so they are performed back-to-back
+  *           without software latency, and their data is transferred directly
+  *           between the bus and the USB buffers. The queue is drained
+  *           before the bus is changed and before a delay, so the commands
+  *           take effect in their batch order. The results of all commands
+  *           are returned in a single IN transfer, while the next batch
+  *           is already being executed. The OUT batch is held in the vendor
+  *           buffer pool until its execution is finished, so the host is
+  *           flow controlled by NAKs while the pool is full.
+  *  @endverbatim
+  *
+  *  This file is part of STM32_XPD.
+  *
+  *  STM32_XPD is free software: you can redistribute it and/or modify
+  *  it under the terms of the GNU General Public License as published by
+  *  the Free Software Foundation, either version 3 of the License, or
+  *  (at your option) any later version.
+  *
+  *  STM32_XPD is distributed in the hope that it will be useful,
+  *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with STM32_XPD.  If not, see <http://www.gnu.org/licenses/>.
+  */
+#include <usbd_vendor_if.h>
+#include <xpd_bsp.h>
+#include <xpd_utils.h>
+
+/* The number of transactions which can be queued at once */
+#define BRIDGE_TRANSACTIONS     32
+
+/* The response buffer size, the last byte is reserved for the padding */
+#define BRIDGE_RESPONSE_SIZE    VENDOR_OUT_BUFFER_SIZE
+
+/* The bus of the queued transactions */
+#define BRIDGE_BUS_SPI          0
+#define BRIDGE_BUS_I2C          1
+
+/* USB Device Core handle declaration */
+USBD_HandleTypeDef hUsbDeviceFS;
+
+/* The bus master setup, the transactions provide their own clock setup */
+static const SPI_InitType Bridge_SpiConfig = {
+    .Mode            = SPI_MODE_MASTER,
+    .Channel         = SPI_CHANNEL_FULL_DUPLEX,
+    .DataSize        = 8,
+    .Format          = SPI_FORMAT_MSB_FIRST,
+    .TI_Mode         = DISABLE,
+    .NSS             = SPI_NSS_SOFT,
+    .Clock.Polarity  = ACTIVE_HIGH,
+    .Clock.Phase     = CLOCK_PHASE_1EDGE,
+    .Clock.Prescaler = CLK_DIV2,
+};
+
+/* This structure is used for batch execution management */
+struct {
+    union {
+        SPI_TransactionType Spi;
+        I2C_TransactionType I2c;
+    } Transactions[BRIDGE_TRANSACTIONS];
+    uint8_t * Status[BRIDGE_TRANSACTIONS];
+    uint32_t Response[2][BRIDGE_RESPONSE_SIZE / 4];
+    volatile boolean_t InBusy[2];
+    uint8_t InIndex;
+    uint8_t Count;
+    uint8_t Bus;
+}Bridge;
+
+static void VENDOR_Init(void);
+static void VENDOR_DeInit(void);
+static void VENDOR_USB_Control(uint8_t cmd, uint8_t* pbuf, uint16_t length);
+static void VENDOR_USB_Transmitted(uint8_t pipe, uint8_t* pbuf, uint32_t length);
+
+const USBD_VENDOR_ItfTypeDef USBD_Interface_fops_FS =
+{ VENDOR_Init, VENDOR_DeInit, VENDOR_USB_Control, NULL, VENDOR_USB_Transmitted };
+
+/**
+ * @brief  This function is called from USB vendor class when the device is configured
+ */
+static void VENDOR_Init(void)
+{
+    Bridge.InBusy[0] = FALSE;
+    Bridge.InBusy[1] = FALSE;
+}
+
+/**
+ * @brief  This function is called from USB vendor class when the device is deconfigured.
+ */
+static void VENDOR_DeInit(void)
+{
+    /* The buses remain initialized, as a batch may be under execution */
+}
+
+/**
+ * @brief  Manage the vendor class requests
+ * @param  cmd: Command code
+ * @param  pbuf: Buffer containing command data (request parameters)
+ * @param  length: Number of data to be sent (in bytes)
+ */
+static void VENDOR_USB_Control(uint8_t cmd, uint8_t* pbuf, uint16_t length)
+{
+    /* The bridge is only controlled through the bulk pipe */
+}
+
+/**
+ * @brief  This function is called when USB vendor interface finished transmission
+ *         of buffer data.
+ * @param  pipe: the pipe index
+ * @param  pbuf: Buffer of data transmitted
+ * @param  length: Number of data transmitted (in bytes)
+ */
+static void VENDOR_USB_Transmitted(uint8_t pipe, uint8_t * pbuf, uint32_t length)
+{
+    Bridge.InBusy[(pbuf == (uint8_t*)Bridge.Response[0]) ? 0 : 1] = FALSE;
+}
+
+/**
+ * @brief  Waits until all queued transactions are finished,
+ *         and writes their result statuses to the response.
+ */
+static void Bridge_Drain(void)
+{
+    uint8_t i;
+
+    for (i = 0; i < Bridge.Count; i++)
+    {
+        if (Bridge.Bus == BRIDGE_BUS_SPI)
+        {
+            SPI_TransactionType * transaction = &Bridge.Transactions[i].Spi;
+
+            while (transaction->Result == XPD_BUSY);
+
+            *Bridge.Status[i] = (transaction->Result == XPD_OK) ?
+                    BRIDGE_STATUS_OK : BRIDGE_STATUS_FAILED;
+        }
+        else
+        {
+            I2C_TransactionType * transaction = &Bridge.Transactions[i].I2c;
+
+            while (transaction->Result == XPD_BUSY);
+
+            *Bridge.Status[i] = (transaction->Result == XPD_OK) ?
+                    BRIDGE_STATUS_OK : (BRIDGE_STATUS_FAILED | transaction->Errors);
+        }
+    }
+    Bridge.Count = 0;
+}
+
+/**
+ * @brief  Provides a free transaction for the bus. The queue is drained first
+ *         when it contains the transactions of the other bus, or when all are used.
+ * @param  Bus: the bus of the transaction
+ * @param  Status: the result status location of the transaction in the response
+ * @return Pointer to the free transaction
+ */
+static void * Bridge_Alloc(uint8_t Bus, uint8_t * Status)
+{
+    if ((Bridge.Bus != Bus) || (Bridge.Count == BRIDGE_TRANSACTIONS))
+    {
+        Bridge_Drain();
+    }
+    Bridge.Bus = Bus;
+    Bridge.Status[Bridge.Count] = Status;
+
+    return &Bridge.Transactions[Bridge.Count++];
+}
+
+/**
+ * @brief  Executes the commands of a batch, and fills the response with their results.
+ * @param  Batch: the received command batch
+ * @param  Length: the size of the batch
+ * @param  Response: the response buffer
+ * @return The size of the response
+ */
+static uint16_t Bridge_Execute(const uint8_t * Batch, uint16_t Length, uint8_t * Response)
+{
+    uint16_t in = 0, out = BRIDGE_RESPONSE_HEADER_SIZE, executed = 0;
+    uint8_t status = BRIDGE_STATUS_OK;
+
+    while ((in < Length) && (status == BRIDGE_STATUS_OK))
+    {
+        const uint8_t * cmd = &Batch[in];
+        const uint8_t * txData = &cmd[BRIDGE_COMMAND_SIZE];
+        uint16_t dataLength, txLength, rxLength;
+
+        if ((Length - in) < BRIDGE_COMMAND_SIZE)
+        {
+            status = BRIDGE_STATUS_INVALID;
+            break;
+        }
+        dataLength = cmd[4] | ((uint16_t)cmd[5] << 8);
+
+        /* The prefix is a command header on SPI, and the register address on I2C */
+        txLength = cmd[3];
+        rxLength = 0;
+        switch (cmd[0])
+        {
+            case BRIDGE_SPI_WRITE:
+            case BRIDGE_I2C_WRITE:
+                txLength += dataLength;
+                break;
+            case BRIDGE_SPI_EXCHANGE:
+                txLength += dataLength;
+                /* fall through */
+            case BRIDGE_SPI_READ:
+            case BRIDGE_I2C_READ:
+                rxLength  = dataLength;
+                break;
+            default:
+                break;
+        }
+
+        /* The command data has to be in the batch, and its result has to fit in the response */
+        if (((Length - in - BRIDGE_COMMAND_SIZE) < txLength) ||
+            ((BRIDGE_RESPONSE_SIZE - 1 - out) < (1 + rxLength)))
+        {
+            status = BRIDGE_STATUS_INVALID;
+            break;
+        }
+
+        switch (cmd[0])
+        {
+            case BRIDGE_SPI_WRITE:
+            case BRIDGE_SPI_READ:
+            case BRIDGE_SPI_EXCHANGE:
+            {
+                SPI_TransactionType * transaction;
+
+                if (cmd[1] >= SPI_SELECT_COUNT)
+                {
+                    status = BRIDGE_STATUS_INVALID;
+                    break;
+                }
+                transaction = Bridge_Alloc(BRIDGE_BUS_SPI, &Response[out]);
+
+                transaction->CS_Port         = SpiSelects[cmd[1]].GPIOx;
+                transaction->CS_Pin          = SpiSelects[cmd[1]].Pin;
+                transaction->Clock.Polarity  = ((cmd[2] & 2) != 0) ? ACTIVE_LOW : ACTIVE_HIGH;
+                transaction->Clock.Phase     = ((cmd[2] & 1) != 0) ? CLOCK_PHASE_2EDGE : CLOCK_PHASE_1EDGE;
+                transaction->Clock.Prescaler = CLK_DIV2 + ((cmd[2] >> 4) & 7);
+                transaction->Command         = txData;
+                transaction->CommandLength   = cmd[3];
+                transaction->TxData          = (cmd[0] != BRIDGE_SPI_READ) ?
+                                                    (void*)&txData[cmd[3]] : NULL;
+                transaction->RxData          = (rxLength > 0) ? &Response[out + 1] : NULL;
+                transaction->Length          = dataLength;
+                transaction->Complete        = NULL;
+
+                /* The result is collected when the queue is drained */
+                (void) XPD_SPI_Queue_Submit(&spi, transaction);
+                break;
+            }
+
+            case BRIDGE_I2C_WRITE:
+            case BRIDGE_I2C_READ:
+            {
+                I2C_TransactionType * transaction;
+                uint8_t i;
+
+                if ((cmd[3] > 4) || ((cmd[0] == BRIDGE_I2C_READ) && (dataLength == 0)))
+                {
+                    status = BRIDGE_STATUS_INVALID;
+                    break;
+                }
+                transaction = Bridge_Alloc(BRIDGE_BUS_I2C, &Response[out]);
+
+                transaction->Address   = cmd[1];
+                transaction->RegSize   = cmd[3];
+                transaction->Register  = 0;
+                for (i = 0; i < cmd[3]; i++)
+                {
+                    transaction->Register = (transaction->Register << 8) | txData[i];
+                }
+                if (cmd[0] == BRIDGE_I2C_WRITE)
+                {
+                    transaction->Direction = I2C_DIRECTION_WRITE;
+                    transaction->Data      = (void*)&txData[cmd[3]];
+                }
+                else
+                {
+                    transaction->Direction = I2C_DIRECTION_READ;
+                    transaction->Data      = &Response[out + 1];
+                }
+                transaction->Length    = dataLength;
+                transaction->Complete  = NULL;
+
+                /* The result is collected when the queue is drained */
+                (void) XPD_I2C_Queue_Submit(&i2c, transaction);
+                break;
+            }
+
+            case BRIDGE_DELAY:
+                /* The delay starts when the previous transactions are finished */
+                Bridge_Drain();
+                XPD_Delay_us(dataLength);
+                Response[out] = BRIDGE_STATUS_OK;
+                break;
+
+            default:
+                status = BRIDGE_STATUS_INVALID;
+                break;
+        }
+
+        if (status == BRIDGE_STATUS_OK)
+        {
+            in  += BRIDGE_COMMAND_SIZE + txLength;
+            out += 1 + rxLength;
+            executed++;
+        }
+    }
+
+    Bridge_Drain();
+
+    Response[0] = executed;
+    Response[1] = executed >> 8;
+    Response[2] = status;
+    Response[3] = 0;
+
+    return out;
+}
+
+/**
+ * @brief  Initializes the buses of the bridge.
+ */
+void Bridge_Init(void)
+{
+    (void) XPD_SPI_Init(&spi, &Bridge_SpiConfig);
+    (void) XPD_I2C_Init(&i2c, &I2cConfig);
+
+    Bridge.Count = 0;
+}
+
+/**
+ * @brief  This function is called from the main loop. It executes the oldest
+ *         received batch when a response buffer is available, transmits the response
+ *         and releases the batch buffer.
+ */
+void Bridge_Process(void)
+{
+    const uint8_t * batch;
+    uint8_t * response = (uint8_t*)Bridge.Response[Bridge.InIndex];
+    uint16_t length;
+
+    if ((Bridge.InBusy[Bridge.InIndex] == FALSE) && (NULL !=
+        (batch = USBD_VENDOR_GetRxBuffer(&hUsbDeviceFS, 0, &length))))
+    {
+        length = Bridge_Execute(batch, length, response);
+
+        (void) USBD_VENDOR_ReleaseRxBuffer(&hUsbDeviceFS, 0);
+
+        /* A padding byte ends the transfer instead of a zero-length packet */
+        if ((length % VENDOR_DATA_FS_MAX_PACKET_SIZE) == 0)
+        {
+            response[length++] = 0;
+        }
+
+        Bridge.InBusy[Bridge.InIndex] = TRUE;
+        if (USBD_OK == USBD_VENDOR_Transmit(&hUsbDeviceFS, 0, response, length))
+        {
+            Bridge.InIndex ^= 1;
+        }
+        else
+        {
+            Bridge.InBusy[Bridge.InIndex] = FALSE;
+        }
+    }
+}
@@ -0,0 +1,54 @@
+/**
+  ******************************************************************************
+  * @file    usbd_vendor_if.h
+  * @author  Benedek Kupper
+  * @version V0.1
+  * @date    2018-01-20
+  * @brief   STM32 eXtensible Peripheral Drivers USB SPI I2C Bridge Project
+  *
+  *  This file is part of STM32_XPD.
+  *
+  *  STM32_XPD is free software: you can redistribute it and/or modify
+  *  it under the terms of the GNU General Public License as published by
+  *  the Free Software Foundation, either version 3 of the License, or
+  *  (at your option) any later version.
+  *
+  *  STM32_XPD is distributed in the hope that it will be useful,
+  *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with STM32_XPD.  If not, see <http://www.gnu.org/licenses/>.
+  */
+#ifndef __USBD_VENDOR_IF_H
+#define __USBD_VENDOR_IF_H
+#include <usbd_vendor.h>
+
+/* Command opcodes */
+#define BRIDGE_SPI_WRITE            0x01 /* SPI transmission of the data */
+#define BRIDGE_SPI_READ             0x02 /* SPI reception of Length bytes */
+#define BRIDGE_SPI_EXCHANGE         0x03 /* SPI full duplex transfer of the data */
+#define BRIDGE_I2C_WRITE            0x11 /* I2C register write of the data */
+#define BRIDGE_I2C_READ             0x12 /* I2C register read of Length bytes */
+#define BRIDGE_DELAY                0x20 /* Wait of Length microseconds */
+
+/* Result status values */
+#define BRIDGE_STATUS_OK            0x00 /* The command is successful */
+#define BRIDGE_STATUS_FAILED        0x40 /* The transaction failed, I2C adds the I2C_ErrorType bits */
+#define BRIDGE_STATUS_INVALID       0x80 /* The batch contains an invalid command */
+
+/* Size of the command header preceding the transmitted data */
+#define BRIDGE_COMMAND_SIZE         6
+
+/* Size of the response header preceding the command results */
+#define BRIDGE_RESPONSE_HEADER_SIZE 4
+
+extern const USBD_VENDOR_ItfTypeDef USBD_Interface_fops_FS;
+
+extern USBD_HandleTypeDef hUsbDeviceFS;
+
+void Bridge_Init(void);
+void Bridge_Process(void);
+
+#endif /* __USBD_VENDOR_IF_H */
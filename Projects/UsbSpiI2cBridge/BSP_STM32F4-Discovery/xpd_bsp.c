@@ -0,0 +1,277 @@
+/**
+  ******************************************************************************
+  * @file    xpd_bsp.c
+  * @author  Benedek Kupper
+  * @version V0.1
+  * @date    2018-01-20
+  * @brief   STM32 eXtensible Peripheral Drivers USB SPI I2C Bridge Project
+  *
+  *  This file is part of STM32_XPD.
+  *
+  *  STM32_XPD is free software: you can redistribute it and/or modify
+  *  it under the terms of the GNU General Public License as published by
+  *  the Free Software Foundation, either version 3 of the License, or
+  *  (at your option) any later version.
+  *
+  *  STM32_XPD is distributed in the hope that it will be useful,
+  *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with STM32_XPD.  If not, see <http://www.gnu.org/licenses/>.
+  */
+#include <xpd_bsp.h>
+
+#include <xpd_dma.h>
+#include <xpd_flash.h>
+#include <xpd_rcc.h>
+#include <xpd_utils.h>
+
+const GPIO_InitType PinConfig[] =
+{
+    /* I2C pins */
+    {
+        .Mode = GPIO_MODE_ALTERNATE,
+        .Pull = GPIO_PULL_UP,
+        .Output.Type  = GPIO_OUTPUT_OPENDRAIN,
+        .Output.Speed = HIGH,
+        .AlternateMap = GPIO_I2C1_AF4
+    },
+    /* SPI pins */
+    {
+        .Mode = GPIO_MODE_ALTERNATE,
+        .Pull = GPIO_PULL_FLOAT,
+        .Output.Type  = GPIO_OUTPUT_PUSHPULL,
+        .Output.Speed = VERY_HIGH,
+        .AlternateMap = GPIO_SPI2_AF5
+    },
+    /* Outputs:
+     * SPI chip selects */
+    {
+        .Mode = GPIO_MODE_OUTPUT,
+        .Pull = GPIO_PULL_FLOAT,
+        .Output.Type  = GPIO_OUTPUT_PUSHPULL,
+        .Output.Speed = HIGH,
+    },
+    /* USB pins */
+    {
+        .Mode = GPIO_MODE_ALTERNATE,
+        .Pull = GPIO_PULL_FLOAT,
+        .Output.Type  = GPIO_OUTPUT_PUSHPULL,
+        .Output.Speed = VERY_HIGH,
+        .AlternateMap = GPIO_OTG_FS_AF10
+    },
+};
+
+const GPIO_PinMapType SpiSelects[SPI_SELECT_COUNT] =
+{
+    { GPIOE,  7, &PinConfig[OUT_PIN_CFG] },
+    { GPIOE,  8, &PinConfig[OUT_PIN_CFG] },
+    { GPIOE,  9, &PinConfig[OUT_PIN_CFG] },
+    { GPIOE, 10, &PinConfig[OUT_PIN_CFG] },
+};
+
+/* System clocks configuration */
+void ClockConfiguration(void)
+{
+    const RCC_PLL_InitType pll = {
+        .State = OSC_ON,
+        .Source = HSE,
+        .M = 8,
+        .N = 336,
+        .P = 2,
+        .Q = 7
+    };
+
+    /* HSE configuration */
+    XPD_RCC_HSEConfig(OSC_ON);
+
+    /* PLL configuration */
+    XPD_RCC_PLLConfig(&pll);
+
+    /* System clocks configuration */
+    XPD_RCC_HCLKConfig(PLL, CLK_DIV1, FLASH_LATENCY_AUTO);
+
+    XPD_RCC_PCLKConfig(PCLK1, CLK_DIV4);
+    XPD_RCC_PCLKConfig(PCLK2, CLK_DIV2);
+}
+
+/************************* USB ************************************/
+
+/* USB dependencies initialization */
+static void usbinit(void * handle)
+{
+    /* GPIO settings */
+    XPD_GPIO_InitPin(USB_DM_PIN, &PinConfig[USB_PIN_CFG]);
+    XPD_GPIO_InitPin(USB_DP_PIN, &PinConfig[USB_PIN_CFG]);
+
+    /* USB clock configuration - must be operated from 48 MHz */
+
+    /* Enable USB FS Interrupt */
+    XPD_NVIC_EnableIRQ(OTG_FS_IRQn);
+
+    /* Wakeup EXTI line setup */
+    if (((USB_HandleType*)handle)->LowPowerMode != DISABLE)
+    {
+        EXTI_InitType wakeup = USB_WAKEUP_EXTI_INIT;
+        XPD_EXTI_Init(USB_OTG_FS_WAKEUP_EXTI_LINE, &wakeup);
+
+        XPD_NVIC_EnableIRQ(OTG_FS_WKUP_IRQn);
+    }
+}
+
+/* USB dependencies deinitialization */
+static void usbdeinit(void * handle)
+{
+    XPD_GPIO_DeinitPin(USB_DM_PIN);
+    XPD_GPIO_DeinitPin(USB_DP_PIN);
+    XPD_EXTI_Deinit(USB_OTG_FS_WAKEUP_EXTI_LINE);
+    XPD_NVIC_DisableIRQ(OTG_FS_IRQn);
+    XPD_NVIC_DisableIRQ(OTG_FS_WKUP_IRQn);
+}
+
+USB_HandleType usbHandle = NEW_USB_HANDLE(USB_OTG_FS,usbinit,usbdeinit);
+
+/* USB interrupt handling */
+void OTG_FS_IRQHandler(void)
+{
+    XPD_USB_IRQHandler(&usbHandle);
+}
+
+/* USB wakeup interrupt handling */
+void OTG_FS_WKUP_IRQHandler(void)
+{
+    XPD_EXTI_ClearFlag(USB_OTG_FS_WAKEUP_EXTI_LINE);
+
+    /* Re-enable suspended PHY clock */
+    XPD_USB_PHY_ClockCtrl(&usbHandle, ENABLE);
+
+    XPD_USB_IRQHandler(&usbHandle);
+}
+
+/************************* SPI ************************************/
+DMA_HandleType dmaspit, dmaspir;
+
+/* SPI dependencies initialization */
+static void spiinit(void * handle)
+{
+    DMA_InitType dmaSetup =
+    {
+        .Priority                 = HIGH,
+        .Mode                     = DMA_MODE_NORMAL,
+        .Memory.DataAlignment     = DMA_ALIGN_BYTE,
+        .Memory.Increment         = ENABLE,
+        .Peripheral.DataAlignment = DMA_ALIGN_BYTE,
+        .Peripheral.Increment     = DISABLE,
+        .Direction                = DMA_MEMORY2PERIPH,
+    };
+    const GPIO_PinMapType spiPins[] = {
+        { SPI_SCK_PIN,  &PinConfig[SPI_PIN_CFG] },
+        { SPI_MISO_PIN, &PinConfig[SPI_PIN_CFG] },
+        { SPI_MOSI_PIN, &PinConfig[SPI_PIN_CFG] },
+    };
+    uint8_t i;
+
+    /* GPIO settings, the slaves are deselected between transactions */
+    for (i = 0; i < SPI_SELECT_COUNT; i++)
+    {
+        XPD_GPIO_WritePin(SpiSelects[i].GPIOx, SpiSelects[i].Pin, 1);
+    }
+    XPD_GPIO_InitPinMap(SpiSelects, SPI_SELECT_COUNT);
+    XPD_GPIO_InitPinMap(spiPins, sizeof(spiPins) / sizeof(spiPins[0]));
+
+    /* DMA settings: DMA1 Stream4 for TX, Stream3 for RX */
+    (void) XPD_DMA_Allocate(&dmaspit, DMA_REQUEST_SPI2_TX, &dmaSetup);
+    dmaSetup.Direction = DMA_PERIPH2MEMORY;
+    (void) XPD_DMA_Allocate(&dmaspir, DMA_REQUEST_SPI2_RX, &dmaSetup);
+
+    ((SPI_HandleType*)handle)->DMA.Transmit = &dmaspit;
+    ((SPI_HandleType*)handle)->DMA.Receive  = &dmaspir;
+
+    XPD_NVIC_EnableIRQ(DMA1_Stream3_IRQn);
+    XPD_NVIC_EnableIRQ(DMA1_Stream4_IRQn);
+    XPD_NVIC_EnableIRQ(SPI2_IRQn);
+}
+
+/* SPI dependencies deinitialization */
+static void spideinit(void * handle)
+{
+    uint8_t i;
+
+    XPD_GPIO_DeinitPin(SPI_SCK_PIN);
+    XPD_GPIO_DeinitPin(SPI_MISO_PIN);
+    XPD_GPIO_DeinitPin(SPI_MOSI_PIN);
+    for (i = 0; i < SPI_SELECT_COUNT; i++)
+    {
+        XPD_GPIO_DeinitPin(SpiSelects[i].GPIOx, SpiSelects[i].Pin);
+    }
+
+    XPD_DMA_Deinit(&dmaspit);
+    XPD_DMA_Deinit(&dmaspir);
+    XPD_NVIC_DisableIRQ(DMA1_Stream3_IRQn);
+    XPD_NVIC_DisableIRQ(DMA1_Stream4_IRQn);
+    XPD_NVIC_DisableIRQ(SPI2_IRQn);
+}
+
+/* SPI DMA interrupt handling */
+void DMA1_Stream3_IRQHandler(void)
+{
+    XPD_DMA_IRQHandler(&dmaspir);
+}
+void DMA1_Stream4_IRQHandler(void)
+{
+    XPD_DMA_IRQHandler(&dmaspit);
+}
+
+SPI_HandleType spi = NEW_SPI_HANDLE(SPI2, spiinit, spideinit);
+
+/* SPI interrupt handling */
+void SPI2_IRQHandler(void)
+{
+    XPD_SPI_IRQHandler(&spi);
+}
+
+/************************* I2C ************************************/
+
+/* Fast-mode, the bus is shared with the on-board audio DAC */
+const I2C_InitType I2cConfig = {
+    .BusFreq = 400000,
+};
+
+/* I2C dependencies initialization */
+static void i2cinit(void * handle)
+{
+    /* GPIO settings */
+    XPD_GPIO_InitPin(I2C_SCL_PIN, &PinConfig[I2C_PIN_CFG]);
+    XPD_GPIO_InitPin(I2C_SDA_PIN, &PinConfig[I2C_PIN_CFG]);
+
+    /* Interrupt driven transfers */
+    ((I2C_HandleType*)handle)->DMA.Transmit = NULL;
+    ((I2C_HandleType*)handle)->DMA.Receive  = NULL;
+
+    XPD_NVIC_EnableIRQ(I2C1_EV_IRQn);
+    XPD_NVIC_EnableIRQ(I2C1_ER_IRQn);
+}
+
+/* I2C dependencies deinitialization */
+static void i2cdeinit(void * handle)
+{
+    XPD_GPIO_DeinitPin(I2C_SCL_PIN);
+    XPD_GPIO_DeinitPin(I2C_SDA_PIN);
+
+    XPD_NVIC_DisableIRQ(I2C1_EV_IRQn);
+    XPD_NVIC_DisableIRQ(I2C1_ER_IRQn);
+}
+
+I2C_HandleType i2c = NEW_I2C_HANDLE(I2C1, i2cinit, i2cdeinit);
+
+/* I2C interrupt handling */
+void I2C1_EV_IRQHandler(void)
+{
+    XPD_I2C_IRQHandler(&i2c);
+}
+void I2C1_ER_IRQHandler(void)
+{
+    XPD_I2C_IRQHandler(&i2c);
+}
@@ -0,0 +1,71 @@
+/**
+  ******************************************************************************
+  * @file    xpd_bsp.h
+  * @author  Benedek Kupper
+  * @version V0.1
+  * @date    2018-01-20
+  * @brief   STM32 eXtensible Peripheral Drivers USB SPI I2C Bridge Project
+  *
+  *  This file is part of STM32_XPD.
+  *
+  *  STM32_XPD is free software: you can redistribute it and/or modify
+  *  it under the terms of the GNU General Public License as published by
+  *  the Free Software Foundation, either version 3 of the License, or
+  *  (at your option) any later version.
+  *
+  *  STM32_XPD is distributed in the hope that it will be useful,
+  *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with STM32_XPD.  If not, see <http://www.gnu.org/licenses/>.
+  */
+#ifndef __XPD_BSP_H_
+#define __XPD_BSP_H_
+
+#include <xpd_core.h>
+#include <xpd_gpio.h>
+#include <xpd_i2c.h>
+#include <xpd_spi.h>
+#include <xpd_usb.h>
+
+typedef enum
+{
+    I2C_PIN_CFG = 0,
+    SPI_PIN_CFG,
+    OUT_PIN_CFG,
+    USB_PIN_CFG,
+    PIN_CFG_COUNT
+}PinType;
+
+#define I2C_SCL_PIN     GPIOB, 6
+#define I2C_SDA_PIN     GPIOB, 9
+#define SPI_SCK_PIN     GPIOB, 13
+#define SPI_MISO_PIN    GPIOB, 14
+#define SPI_MOSI_PIN    GPIOB, 15
+#define USB_DP_PIN      GPIOA, 12
+#define USB_DM_PIN      GPIOA, 11
+#define USB_VBUS_PIN    GPIOA, 9
+
+/* Number of SPI slave chip selects */
+#define SPI_SELECT_COUNT    4
+
+/* Indexed by PinType */
+extern const GPIO_InitType PinConfig[];
+
+/* SPI slave chip selects, indexed by the command target */
+extern const GPIO_PinMapType SpiSelects[SPI_SELECT_COUNT];
+
+/* Peripheral handle references */
+extern I2C_HandleType i2c;
+extern SPI_HandleType spi;
+extern USB_HandleType usbHandle;
+
+/* Board specific peripheral configurations */
+extern const I2C_InitType I2cConfig;
+
+/* System clocks configuration */
+void ClockConfiguration(void);
+
+#endif /* __XPD_BSP_H_ */
@@ -27,11 +27,16 @@
 #include <usbd_desc.h>
 #include <usbd_cdc_if.h>
 
+/* Work items deferred from the USB and UART interrupts */
+static XPD_WorkType workItems[8];
+static uint16_t workSequence[8];
 
 int main(void)
 {
     ClockConfiguration();
 
+    (void) XPD_Defer_Init(workItems, workSequence, 8);
+
     /* Init Device Library, Add Supported Class and Start the library */
     USBD_Init(&hUsbDeviceFS, (void*)&CDC_Desc, DEVICE_FS);
 
@@ -12,12 +12,18 @@
   *                                  USB Virtual COM Port
   *          ===================================================================
   *           This project implements a virtual COM port using USB CDC interface
-  *           and the UART peripheral of the device. The received USB packets
-  *           are transferred on UART using a 2-page buffer, one is receiving
-  *           the USB OUT endpoint data, the other is used by the UART Tx DMA.
-  *           The received UART bytes are put in a circular buffer by the Rx DMA
-  *           and are monitored by a timer callback to determine when new bytes
-  *           have been received that can be sent on USB IN endpoint.
+  *           and the UART peripheral of the device. The received USB transfers
+  *           are queued in the CDC OUT buffer pool, and are transferred on UART
+  *           by the Tx DMA in reception order, while the USB OUT endpoint
+  *           keeps receiving to the free buffers of the pool.
+  *           The received UART bytes are put in a circular buffer by the Rx DMA,
+  *           the UART driver notifies when the line becomes idle or half of the
+  *           buffer is filled, and the new bytes are sent on USB IN endpoint.
+  *           Short frames can be coalesced for CDC_IN_COALESCE_FRAMES USB frames
+  *           before transmission, driven by the USB Start Of Frame event.
+  *           When the BSP maps the RTS and CTS pins, hardware flow control
+  *           is used: the Tx DMA is paused by the CTS signal, and RTS is
+  *           deasserted while half of the circular buffer is unsent on USB.
   *  @endverbatim
   *
   *  This file is part of STM32_XPD.
@@ -38,9 +44,15 @@
 #include <usbd_cdc_if.h>
 #include <xpd_bsp.h>
 
-#define CDC_OUT_DATA_SIZE   256
 #define CDC_IN_DATA_SIZE    256
 
+/* Use RTS/CTS flow control when the signals are mapped */
+#if defined(UART_RTS_PIN) && defined(UART_CTS_PIN)
+#define CDC_UART_FLOW_CONTROL   1
+#else
+#define CDC_UART_FLOW_CONTROL   0
+#endif
+
 /* USB Device Core handle declaration */
 USBD_HandleTypeDef hUsbDeviceFS;
 
@@ -55,27 +67,27 @@ USART_InitType SerialConfig = {
 };
 
 UART_InitType UartConfig = {
+#if (CDC_UART_FLOW_CONTROL != 0)
+        .FlowControl   = UART_FLOWCONTROL_RTS_CTS,
+#else
         .FlowControl   = UART_FLOWCONTROL_NONE,
+#endif
         .OverSampling8 = ENABLE,
         .HalfDuplex    = DISABLE,
 };
 
-typedef enum
-{
-    BUFFER_EMPTY = 0,
-    BUFFER_FULL,
-    BUFFER_RECEIVING,
-    BUFFER_TRANSMITTING
-}BufferStatusType;
-
 /* This structure is used for data transfer management
  * between the two communication channels */
 struct {
-    uint8_t OutData[2][CDC_OUT_DATA_SIZE / 2];
-    BufferStatusType OutStatus[2];
-    uint16_t OutLength;
+    boolean_t OutTransmitting;
     uint8_t InData[CDC_IN_DATA_SIZE];
-    uint16_t Index;
+    uint16_t InLength;
+#if (CDC_IN_COALESCE_FRAMES > 0)
+    uint8_t InDelay;
+#endif
+#if (CDC_UART_FLOW_CONTROL != 0)
+    volatile boolean_t InHeld;
+#endif
 }CDC_Memory;
 
 static void CDC_Init(void);
@@ -83,21 +95,27 @@ static void CDC_DeInit(void);
 static void CDC_USB_Control(uint8_t cmd, uint8_t* pbuf, uint16_t length);
 static void CDC_USB_Received(uint8_t* pbuf, uint32_t length);
 static void CDC_USB_Transmitted(uint8_t* pbuf, uint32_t length);
+#if (CDC_IN_COALESCE_FRAMES > 0)
+static void CDC_USB_StartOfFrame(void);
+#endif
 
 static void CDC_UART_Transmitted(void * handle);
-static void CDC_ProcessIN(void);
+static void CDC_UART_Received(void * handle);
+static void CDC_ProcessOUT(void);
+static void CDC_DeferredOUT(void * arg);
+static void CDC_ProcessIN(boolean_t flush);
+#if (CDC_UART_FLOW_CONTROL != 0)
+static void CDC_ThrottleIN(void);
+#endif
 
 const USBD_CDC_ItfTypeDef USBD_Interface_fops_FS =
-{ CDC_Init, CDC_DeInit, CDC_USB_Control, CDC_USB_Received, CDC_USB_Transmitted };
-
-/**
- * @brief  This interrupt handler periodically updates IN endpoint data
- *         from UART received data
- */
-void SysTick_Handler(void)
-{
-    CDC_ProcessIN();
-}
+{ CDC_Init, CDC_DeInit, CDC_USB_Control, CDC_USB_Received, CDC_USB_Transmitted,
+#if (CDC_IN_COALESCE_FRAMES > 0)
+  CDC_USB_StartOfFrame
+#else
+  NULL
+#endif
+};
 
 /**
  * @brief  This function is called from USB CDC when the device is connected
@@ -105,29 +123,29 @@ void SysTick_Handler(void)
  */
 static void CDC_Init(void)
 {
-    /* Unsubscribe from periodic callback handler during initialization */
-    XPD_SysTick_DisableIT();
-
     /* Initialize UART with the current configuration, reset DMAs */
     (void) XPD_UART_Init(&uart, &SerialConfig, &UartConfig);
     XPD_DMA_Stop(uart.DMA.Transmit);
     XPD_DMA_Stop(uart.DMA.Receive);
 
-    /* Subscribe to UART transmit complete callback */
+    /* Subscribe to UART transmit complete and reception callbacks */
     uart.Callbacks.Transmit = CDC_UART_Transmitted;
+    uart.Callbacks.Receive  = CDC_UART_Received;
 
-    /* Page 0 is initialized for OUT endpoint reception */
-    CDC_Memory.OutStatus[0] = BUFFER_RECEIVING;
-    CDC_Memory.OutStatus[1] = BUFFER_EMPTY;
-    (void) USBD_CDC_Receive(&hUsbDeviceFS, CDC_Memory.OutData[0], CDC_OUT_DATA_SIZE / 2);
+    /* Restart the UART transmission of the pending OUT buffers */
+    CDC_Memory.OutTransmitting = FALSE;
+    CDC_ProcessOUT();
 
     /* Start circular buffer reception with DMA for IN endpoint */
-    CDC_Memory.Index = 0;
+    CDC_Memory.InLength = 0;
+#if (CDC_IN_COALESCE_FRAMES > 0)
+    CDC_Memory.InDelay  = 0;
+#endif
+#if (CDC_UART_FLOW_CONTROL != 0)
+    CDC_Memory.InHeld   = FALSE;
+#endif
     XPD_USART_ClearFlag(&uart, RXNE);
-    (void) XPD_USART_Receive_DMA(&uart, CDC_Memory.InData, CDC_IN_DATA_SIZE);
-
-    /* Periodic function is subscribed to timer callback */
-    XPD_SysTick_EnableIT();
+    (void) XPD_USART_RxRing_Start(&uart, CDC_Memory.InData, CDC_IN_DATA_SIZE);
 }
 
 /**
@@ -135,7 +153,7 @@ static void CDC_Init(void)
  */
 static void CDC_DeInit(void)
 {
-    XPD_SysTick_DisableIT();
+    XPD_USART_RxRing_Stop(&uart);
     (void) XPD_USART_Deinit(&uart);
 }
 
@@ -173,7 +191,13 @@ static void CDC_USB_Control(uint8_t cmd, uint8_t* pbuf, uint16_t length)
             SerialConfig.Parity = USART_PARITY_NONE;
             break;
         }
-        CDC_Init();
+
+        /* Keep the reception running if only the frame timing changes,
+         * reinitialize if the UART is transmitting or the data width changes */
+        if (XPD_UART_Reconfigure(&uart, &SerialConfig) != XPD_OK)
+        {
+            CDC_Init();
+        }
         break;
 
     /* Returns the current UART configuration */
@@ -215,24 +239,8 @@ static void CDC_USB_Control(uint8_t cmd, uint8_t* pbuf, uint16_t length)
  */
 static void CDC_USB_Received(uint8_t * pbuf, uint32_t length)
 {
-    uint8_t page = (CDC_Memory.OutStatus[0] == BUFFER_RECEIVING) ? 0 : 1;
-
-    /* If UART transmission is ongoing on other page */
-    if (CDC_Memory.OutStatus[1 - page] == BUFFER_TRANSMITTING)
-    {
-        /* Just indicate buffer status */
-        CDC_Memory.OutStatus[page] = BUFFER_FULL;
-        CDC_Memory.OutLength       = (uint16_t)length;
-    }
-    else
-    {
-        /* Switch pages, start transfer on both */
-        CDC_Memory.OutStatus[page] = BUFFER_TRANSMITTING;
-        (void) XPD_USART_Transmit_DMA(&uart, CDC_Memory.OutData[page], (uint16_t)length);
-
-        CDC_Memory.OutStatus[1 - page] = BUFFER_RECEIVING;
-        (void) USBD_CDC_Receive(&hUsbDeviceFS, CDC_Memory.OutData[1 - page], CDC_OUT_DATA_SIZE / 2);
-    }
+    /* The buffer is queued in the pool, start UART transmission if idle */
+    (void) XPD_Defer(CDC_DeferredOUT, NULL);
 }
 
 /**
@@ -241,23 +249,46 @@ static void CDC_USB_Received(uint8_t * pbuf, uint32_t length)
  */
 static void CDC_UART_Transmitted(void * handle)
 {
-    uint8_t page = (CDC_Memory.OutStatus[0] == BUFFER_TRANSMITTING) ? 0 : 1;
+    /* The oldest buffer has been transferred over UART, return it to the pool */
+    CDC_Memory.OutTransmitting = FALSE;
+    (void) USBD_CDC_ReleaseRxBuffer(&hUsbDeviceFS, 0);
+
+    (void) XPD_Defer(CDC_DeferredOUT, NULL);
+}
 
-    /* The current page has been transferred over UART */
-    CDC_Memory.OutStatus[page] = BUFFER_EMPTY;
+/**
+ * @brief  This function is called when USB OUT data is received
+ *         or UART transmission completes. It starts UART transmission
+ *         of the oldest received OUT buffer when the UART is idle.
+ */
+static void CDC_ProcessOUT(void)
+{
+    uint8_t * pbuf;
+    uint16_t length;
 
-    /* If other page is full already */
-    if (CDC_Memory.OutStatus[1 - page] == BUFFER_FULL)
+    if (CDC_Memory.OutTransmitting == FALSE)
     {
-        /* Switch pages, start transfer on both */
-        CDC_Memory.OutStatus[1 - page] = BUFFER_TRANSMITTING;
-        (void) XPD_USART_Transmit_DMA(&uart, CDC_Memory.OutData[1 - page], CDC_Memory.OutLength);
+        pbuf = USBD_CDC_GetRxBuffer(&hUsbDeviceFS, 0, &length);
 
-        CDC_Memory.OutStatus[page] = BUFFER_RECEIVING;
-        (void) USBD_CDC_Receive(&hUsbDeviceFS, CDC_Memory.OutData[page], CDC_OUT_DATA_SIZE / 2);
+        if (pbuf != NULL)
+        {
+            CDC_Memory.OutTransmitting = TRUE;
+            (void) XPD_USART_Transmit_DMA(&uart, pbuf, length);
+        }
     }
 }
 
+/**
+ * @brief  Deferred work of the OUT processing, executed in PendSV context
+ *         so the USB and UART interrupts aren't extended by the transfer start.
+ * @note   When the work queue is full, an already queued item processes the new state.
+ * @param  arg: unused
+ */
+static void CDC_DeferredOUT(void * arg)
+{
+    CDC_ProcessOUT();
+}
+
 /**
  * @brief  This function is called when USB CDC interface finished transmission
  *         of buffer data.
@@ -266,37 +297,114 @@ static void CDC_UART_Transmitted(void * handle)
  */
 static void CDC_USB_Transmitted(uint8_t * pbuf, uint32_t length)
 {
-    /* Call the UART Rx -> USB IN processing */
-    CDC_ProcessIN();
+    /* The transmitted data is released from the UART reception buffer */
+    XPD_USART_RxRing_Consume(&uart, CDC_Memory.InLength);
+    CDC_Memory.InLength = 0;
+
+#if (CDC_UART_FLOW_CONTROL != 0)
+    /* Resume the held reception if enough space is freed */
+    CDC_ThrottleIN();
+#endif
+
+    /* Transmit the data which has been received in the meantime */
+    CDC_ProcessIN(TRUE);
 }
 
+#if (CDC_IN_COALESCE_FRAMES > 0)
 /**
- * @brief  This function is called periodically from timer callback
- *         or when USB IN transfer completes. It requests new USB IN transfer
- *         when new UART data has been received.
+ * @brief  This function is called on each USB frame start,
+ *         transmits the coalesced data when the delay has elapsed.
+ */
+static void CDC_USB_StartOfFrame(void)
+{
+    if ((CDC_Memory.InDelay > 0) && (--CDC_Memory.InDelay == 0))
+    {
+        CDC_ProcessIN(TRUE);
+    }
+}
+#endif
+
+/**
+ * @brief  Callback for UART data reception: called when the line becomes idle,
+ *         or when half of the circular buffer is filled
+ * @param  handle: Pointer to the callback issuer handle
  */
-static void CDC_ProcessIN(void)
+static void CDC_UART_Received(void * handle)
 {
-    /* Determine the buffer index of the UART DMA */
-    uint16_t rxIndex = CDC_IN_DATA_SIZE - XPD_DMA_GetStatus(uart.DMA.Receive);
+#if (CDC_UART_FLOW_CONTROL != 0)
+    CDC_ThrottleIN();
+#endif
+    CDC_ProcessIN(FALSE);
+}
 
-    /* If the UART RX index is ahead, transmit the new data */
-    if (CDC_Memory.Index < rxIndex)
+#if (CDC_UART_FLOW_CONTROL != 0)
+/**
+ * @brief  Holds the UART reception, deasserting RTS, while at least half
+ *         of the circular buffer is waiting for USB IN transfer.
+ *         As the reception callback is called on each buffer half,
+ *         the buffer can't overflow until the next evaluation.
+ * @note   This function is called from both UART and USB interrupt contexts.
+ */
+static void CDC_ThrottleIN(void)
+{
+    if (XPD_USART_RxRing_Count(&uart) >= (CDC_IN_DATA_SIZE / 2))
     {
-        if(USBD_OK == USBD_CDC_Transmit(&hUsbDeviceFS,
-                &CDC_Memory.InData[CDC_Memory.Index], rxIndex - CDC_Memory.Index))
+        CDC_Memory.InHeld = TRUE;
+        XPD_USART_RxRing_Hold(&uart);
+
+        /* Check again in case the data was consumed meanwhile */
+        if (XPD_USART_RxRing_Count(&uart) >= (CDC_IN_DATA_SIZE / 2))
         {
-            CDC_Memory.Index = rxIndex;
+            return;
         }
     }
-    /* If the USB IN index is ahead, the buffer has wrapped, transmit until the end */
-    else if (CDC_Memory.Index > rxIndex)
+
+    if (CDC_Memory.InHeld != FALSE)
+    {
+        CDC_Memory.InHeld = FALSE;
+        XPD_USART_RxRing_Resume(&uart);
+    }
+}
+#endif
+
+/**
+ * @brief  This function is called when new UART data has been received
+ *         or when USB IN transfer completes. It requests new USB IN transfer
+ *         with the unsent UART data.
+ * @param  flush: when FALSE, the transmission of less than a packet of data
+ *         is delayed by CDC_IN_COALESCE_FRAMES
+ */
+static void CDC_ProcessIN(boolean_t flush)
+{
+    void * data;
+    uint16_t length;
+
+    /* If USB IN transfer is ongoing, the data is sent when it completes */
+    if (CDC_Memory.InLength == 0)
     {
-        if (USBD_OK == USBD_CDC_Transmit(&hUsbDeviceFS,
-                &CDC_Memory.InData[CDC_Memory.Index], CDC_IN_DATA_SIZE - CDC_Memory.Index))
+        /* The contiguous unsent data in the UART buffer */
+        length = XPD_USART_RxRing_Peek(&uart, &data);
+
+#if (CDC_IN_COALESCE_FRAMES > 0)
+        /* Wait for more data if the new data doesn't fill a packet */
+        if ((flush == FALSE) && (length < CDC_DATA_FS_MAX_PACKET_SIZE))
+        {
+            if (CDC_Memory.InDelay == 0)
+            {
+                CDC_Memory.InDelay = CDC_IN_COALESCE_FRAMES;
+            }
+            length = 0;
+        }
+        else
         {
-            CDC_Memory.Index = 0;
+            CDC_Memory.InDelay = 0;
+        }
+#endif
+
+        if ((length > 0) &&
+            (USBD_OK == USBD_CDC_Transmit(&hUsbDeviceFS, 0, data, length)))
+        {
+            CDC_Memory.InLength = length;
         }
     }
 }
-
@@ -29,26 +29,42 @@
 
 static int usbSuspendCallback(void * user)
 {
+    USB_HandleType * husb = ((USBD_HandleTypeDef *)user)->pData;
+
     /* Inform USB library that core enters in suspend Mode */
     int retval = USBD_LL_Suspend(user);
 
-    if (((USB_HandleType *)(((USBD_HandleTypeDef *)user)->pData))->LowPowerMode == ENABLE)
+    /* The PHY clock is gated by the driver after this callback */
+    if (husb->LowPowerMode == ENABLE)
     {
-        XPD_USB_PHY_ClockCtrl(&usbHandle, DISABLE);
-
-        /* Set SLEEPDEEP bit and SleepOnExit of Cortex System Control Register */
-        SET_BIT(SCB->SCR.w, SCB_SCR_SLEEPDEEP_Msk | SCB_SCR_SLEEPONEXIT_Msk);
+        if (husb->LinkState == USB_LPM_L2)
+        {
+            /* Set SLEEPDEEP bit and SleepOnExit of Cortex System Control Register */
+            SET_BIT(SCB->SCR.w, SCB_SCR_SLEEPDEEP_Msk | SCB_SCR_SLEEPONEXIT_Msk);
+        }
+        else
+        {
+            /* L1 sleep has to be exited within the BESL time, only stop the core */
+            SET_BIT(SCB->SCR.w, SCB_SCR_SLEEPONEXIT_Msk);
+        }
     }
     return retval;
 }
 
 static int usbResumeCallback(void * user)
 {
-    if (((USB_HandleType *)(((USBD_HandleTypeDef *)user)->pData))->LowPowerMode == ENABLE)
+    USB_HandleType * husb = ((USBD_HandleTypeDef *)user)->pData;
+
+    /* The link state still indicates the exited suspend level */
+    if (husb->LowPowerMode == ENABLE)
     {
         CLEAR_BIT(SCB->SCR.w, SCB_SCR_SLEEPDEEP_Msk | SCB_SCR_SLEEPONEXIT_Msk);
-        /* Reconfigure system clocks */
-        ClockConfiguration();
+
+        if (husb->LinkState == USB_LPM_L2)
+        {
+            /* Reconfigure system clocks */
+            ClockConfiguration();
+        }
     }
     return USBD_LL_Resume(user);
 }
@@ -79,9 +95,16 @@ USBD_StatusTypeDef USBD_LL_Init(USBD_HandleTypeDef *pdev)
 {
     if (pdev->id == DEVICE_FS)
     {
+        uint8_t idx;
         /* USB init setup */
         const USB_InitType init = {
             .Speed = USB_SPEED_FULL,
+#if (CDC_IN_COALESCE_FRAMES > 0)
+            .SOF   = ENABLE,
+#endif
+#if (USBD_LPM_ENABLED == 1)
+            .LinkPowerMgmt = ENABLE,
+#endif
         };
 
         /* Link driver to user */
@@ -107,13 +130,37 @@ USBD_StatusTypeDef USBD_LL_Init(USBD_HandleTypeDef *pdev)
 
         XPD_USB_Init(&usbHandle, &init);
 
-        /* Endpoints for CDC device (bulk EPs are set to double-buffered) */
-        XPD_USB_EP_BufferInit(pdev->pData, CDC_IN_EP,  CDC_DATA_FS_MAX_PACKET_SIZE * 2);
-        XPD_USB_EP_BufferInit(pdev->pData, CDC_OUT_EP, CDC_DATA_FS_MAX_PACKET_SIZE * 2);
-
+        {
+            /* Endpoints for CDC device (the spare buffer memory is shared out among the bulk EPs) */
+            USB_EndPointConfigType eps[CDC_INSTANCE_COUNT * 3];
+            uint8_t epCount = 0;
+
+            for (idx = 0; idx < CDC_INSTANCE_COUNT; idx++)
+            {
+                eps[epCount].Address       = CDC_INSTANCE_IN_EP(idx);
+                eps[epCount].Type          = USB_EP_TYPE_BULK;
+                eps[epCount].MaxPacketSize = CDC_DATA_FS_MAX_PACKET_SIZE;
+                epCount++;
+                eps[epCount].Address       = CDC_INSTANCE_OUT_EP(idx);
+                eps[epCount].Type          = USB_EP_TYPE_BULK;
+                eps[epCount].MaxPacketSize = CDC_DATA_FS_MAX_PACKET_SIZE;
+                epCount++;
 #if (CDC_AT_COMMAND_SUPPORT == 1)
-        XPD_USB_EP_BufferInit(pdev->pData, CDC_CMD_EP, CDC_CMD_PACKET_SIZE);
+                eps[epCount].Address       = CDC_INSTANCE_CMD_EP(idx);
+                eps[epCount].Type          = USB_EP_TYPE_INTERRUPT;
+                eps[epCount].MaxPacketSize = CDC_CMD_PACKET_SIZE;
+                epCount++;
 #endif
+            }
+#ifdef USB_OTG_FS
+            if (XPD_USB_EP_FifoAlloc(pdev->pData, eps, epCount) != XPD_OK)
+#else
+            if (XPD_USB_EP_PmaAlloc(pdev->pData, eps, epCount) != XPD_OK)
+#endif
+            {
+                return USBD_FAIL;
+            }
+        }
 
         /* USB device only supports full speed */
         USBD_LL_SetSpeed(pdev, USBD_SPEED_FULL);
@@ -122,13 +169,30 @@ USBD_StatusTypeDef USBD_LL_Init(USBD_HandleTypeDef *pdev)
     return USBD_OK;
 }
 
+/* Block pool of the USB class data: one block for the class instance */
+static XPD_POOL_STORAGE(usbd_classStorage, sizeof(USBD_CDC_HandleTypeDef) * CDC_INSTANCE_COUNT, 1);
+static XPD_PoolType usbd_classPool;
+
 /**
- * @brief  static single allocation.
+ * @brief  Class data allocation from the static block pool.
  * @param  size: size of allocated memory
- * @retval None
+ * @retval The allocated memory, or NULL if the pool is exhausted
  */
 void *USBD_static_malloc(uint32_t size)
 {
-    static uint32_t mem[(sizeof(USBD_CDC_HandleTypeDef) / 4) + 1];
-    return mem;
+    if (usbd_classPool.BlockSize == 0)
+    {
+        (void) XPD_Pool_Init(&usbd_classPool, usbd_classStorage, sizeof(usbd_classStorage), 1);
+    }
+    return XPD_Pool_AllocSize(&usbd_classPool, 1, size);
+}
+
+/**
+ * @brief  Releases the class data to the static block pool.
+ * @param  p: the allocated memory
+ * @retval None
+ */
+void USBD_static_free(void *p)
+{
+    XPD_Pool_FreeAny(&usbd_classPool, 1, p);
 }
@@ -31,6 +31,15 @@
 #endif
 #include "xpd_usb.h"
 #include "xpd_utils.h"
+
+/* LPM (L1 sleep) is advertised in the BOS descriptor where the peripheral supports it,
+ * it is defined here as the device library structures depend on it */
+#if defined(USB_OTG_GLPMCFG_LPMEN) || defined(USB_LPMCSR_LMPEN)
+#define USBD_LPM_ENABLED                    1
+#else
+#define USBD_LPM_ENABLED                    0
+#endif
+
 #include "usbd_def.h"
 
 /** @addtogroup USBD_OTG_DRIVER
@@ -43,7 +52,7 @@
 /** @defgroup USBD_CONF_Exported_Defines
   * @{ */
 
-#define USBD_MAX_NUM_INTERFACES             1
+#define USBD_MAX_NUM_INTERFACES             (2 * CDC_INSTANCE_COUNT)
 #define USBD_MAX_NUM_CONFIGURATION          1
 #define USBD_MAX_STR_DESC_SIZ               0x100
 #define USBD_SUPPORT_USER_STRING            0
@@ -53,7 +62,12 @@
 #define USBD_CDC_INTERVAL                   1000
 #define MAX_STATIC_ALLOC_SIZE               1000
 
+#define CDC_INSTANCE_COUNT                  1
 #define CDC_AT_COMMAND_SUPPORT              0
+#define CDC_OUT_BUFFER_COUNT                4
+#define CDC_OUT_BUFFER_SIZE                 512
+#define CDC_IN_BUFFER_SIZE                  0
+#define CDC_IN_COALESCE_FRAMES              0
 
 /* #define for FS and HS identification */
 #define DEVICE_FS       0
@@ -66,7 +80,7 @@
 
 /* Memory management macros */
 #define USBD_malloc(SIZE)       (USBD_static_malloc(SIZE))
-#define USBD_free(PTR)          ((void)0)
+#define USBD_free(PTR)          (USBD_static_free(PTR))
 
 #define USBD_Delay(MS)                          \
     (XPD_Delay_ms(MS))
@@ -80,6 +94,9 @@
 #define USBD_LL_Stop(PDEV)                      \
     (XPD_USB_Stop((PDEV)->pData), USBD_OK)
 
+#define USBD_LL_Poll(PDEV, MAX)                 \
+    (XPD_USB_Poll((PDEV)->pData, MAX))
+
 #define USBD_LL_OpenEP(PDEV, EA, TYPE, MPS)     \
     (XPD_USB_EP_Open((PDEV)->pData, EA, TYPE, MPS), USBD_OK)
 
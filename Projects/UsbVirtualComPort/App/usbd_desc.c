@@ -60,6 +60,7 @@
 #define USBD_CONFIGURATION_FS_STRING  "CDC Config"
 #define USBD_INTERFACE_FS_STRING      "CDC Interface"
 #define  USB_SIZ_STRING_SERIAL        0x1A
+#define  USB_SIZ_BOS_DESC             0x0C
 
 /* Private macro -------------------------------------------------------------*/
 /* Private function prototypes -----------------------------------------------*/
@@ -70,6 +71,9 @@ uint8_t *USBD_CDC_ProductStrDescriptor(USBD_SpeedTypeDef speed, uint16_t *length
 uint8_t *USBD_CDC_SerialStrDescriptor(USBD_SpeedTypeDef speed, uint16_t *length);
 uint8_t *USBD_CDC_ConfigStrDescriptor(USBD_SpeedTypeDef speed, uint16_t *length);
 uint8_t *USBD_CDC_InterfaceStrDescriptor(USBD_SpeedTypeDef speed, uint16_t *length);
+#if (USBD_LPM_ENABLED == 1)
+uint8_t *USBD_CDC_BOSDescriptor(USBD_SpeedTypeDef speed, uint16_t *length);
+#endif
 #ifdef USB_SUPPORT_USER_STRING_DESC
 uint8_t *USBD_CDC_USRStringDesc (USBD_SpeedTypeDef speed, uint8_t idx, uint16_t *length);
 #endif /* USB_SUPPORT_USER_STRING_DESC */  
@@ -83,6 +87,9 @@ const USBD_DescriptorsTypeDef CDC_Desc = {
     USBD_CDC_SerialStrDescriptor,
     USBD_CDC_ConfigStrDescriptor,
     USBD_CDC_InterfaceStrDescriptor,
+#if (USBD_LPM_ENABLED == 1)
+    USBD_CDC_BOSDescriptor,
+#endif
 };
 
 /* USB Standard Device Descriptor */
@@ -92,10 +99,20 @@ const USBD_DescriptorsTypeDef CDC_Desc = {
 __ALIGN_BEGIN const uint8_t USBD_DeviceDesc[USB_LEN_DEV_DESC] __ALIGN_END = {
     0x12,                               /* bLength */
     USB_DESC_TYPE_DEVICE,               /* bDescriptorType */
+#if (USBD_LPM_ENABLED == 1)
+    0x01,0x02,                          /* bcdUSB: 2.01 for BOS descriptor support */
+#else
     0x00,0x02,                          /* bcdUSB */
+#endif
+#if (CDC_INSTANCE_COUNT > 1)
+    0xEF,                               /* bDeviceClass: Miscellaneous */
+    0x02,                               /* bDeviceSubClass: Common Class */
+    0x01,                               /* bDeviceProtocol: Interface Association Descriptor */
+#else
     0x02,                               /* bDeviceClass */
     0x02,                               /* bDeviceSubClass */
     0x00,                               /* bDeviceProtocol */
+#endif
     USB_MAX_EP0_SIZE,                   /* bMaxPacketSize */
     LOBYTE(USBD_VID),HIBYTE(USBD_VID),  /* idVendor */
     LOBYTE(USBD_PID),HIBYTE(USBD_PID),  /* idVendor */
@@ -116,17 +133,36 @@ __ALIGN_BEGIN const uint8_t USBD_LangIDDesc[USB_LEN_LANGID_STR_DESC] __ALIGN_END
     LOBYTE(USBD_LANGID_STRING),HIBYTE(USBD_LANGID_STRING),
 };
 
+#if (USBD_LPM_ENABLED == 1)
+/* USB BOS Descriptor with the USB 2.0 Extension capability */
+#if defined ( __ICCARM__ ) /*!< IAR Compiler */
+#pragma data_alignment=4
+#endif
+__ALIGN_BEGIN const uint8_t USBD_BOSDesc[USB_SIZ_BOS_DESC] __ALIGN_END = {
+    0x05,                               /* bLength */
+    USB_DESC_TYPE_BOS,                  /* bDescriptorType */
+    LOBYTE(USB_SIZ_BOS_DESC),HIBYTE(USB_SIZ_BOS_DESC), /* wTotalLength */
+    0x01,                               /* bNumDeviceCaps */
+
+    0x07,                               /* bLength */
+    0x10,                               /* bDescriptorType: Device Capability */
+    0x02,                               /* bDevCapabilityType: USB 2.0 Extension */
+    0x06,0x00,0x00,0x00,                /* bmAttributes: LPM and BESL support */
+};
+#endif
+
+/* USB String Descriptors, encoded at build time */
+USBD_STRING_DESC(USBD_ManufacturerStrDesc, USBD_MANUFACTURER_STRING);
+USBD_STRING_DESC(USBD_ProductStrDesc, USBD_PRODUCT_FS_STRING);
+USBD_STRING_DESC(USBD_ConfigStrDesc, USBD_CONFIGURATION_FS_STRING);
+USBD_STRING_DESC(USBD_InterfaceStrDesc, USBD_INTERFACE_FS_STRING);
+
 uint8_t USBD_StringSerial[USB_SIZ_STRING_SERIAL] =
 {
     USB_SIZ_STRING_SERIAL,
     USB_DESC_TYPE_STRING,
 };
 
-#if defined ( __ICCARM__ ) /*!< IAR Compiler */
-  #pragma data_alignment=4   
-#endif
-__ALIGN_BEGIN uint8_t USBD_StrDesc[USBD_MAX_STR_DESC_SIZ] __ALIGN_END;
-
 /* Private functions ---------------------------------------------------------*/
 static void UintToUnicode (uint32_t value , uint8_t *pbuf , uint8_t len);
 
@@ -142,6 +178,20 @@ uint8_t *USBD_CDC_DeviceDescriptor(USBD_SpeedTypeDef speed, uint16_t *length)
     return (uint8_t*)USBD_DeviceDesc;
 }
 
+#if (USBD_LPM_ENABLED == 1)
+/**
+  * @brief  Returns the BOS descriptor.
+  * @param  speed: Current device speed
+  * @param  length: Pointer to data length variable
+  * @retval Pointer to descriptor buffer
+  */
+uint8_t *USBD_CDC_BOSDescriptor(USBD_SpeedTypeDef speed, uint16_t *length)
+{
+    *length = sizeof(USBD_BOSDesc);
+    return (uint8_t*)USBD_BOSDesc;
+}
+#endif
+
 /**
   * @brief  Returns the LangID string descriptor.
   * @param  speed: Current device speed
@@ -162,8 +212,8 @@ uint8_t *USBD_CDC_LangIDStrDescriptor(USBD_SpeedTypeDef speed, uint16_t *length)
   */
 uint8_t *USBD_CDC_ProductStrDescriptor(USBD_SpeedTypeDef speed, uint16_t *length)
 {
-    USBD_GetString((uint8_t *)USBD_PRODUCT_FS_STRING, USBD_StrDesc, length);
-    return USBD_StrDesc;
+    *length = sizeof(USBD_ProductStrDesc);
+    return (uint8_t*)&USBD_ProductStrDesc;
 }
 
 /**
@@ -174,8 +224,8 @@ uint8_t *USBD_CDC_ProductStrDescriptor(USBD_SpeedTypeDef speed, uint16_t *length
   */
 uint8_t *USBD_CDC_ManufacturerStrDescriptor(USBD_SpeedTypeDef speed, uint16_t *length)
 {
-    USBD_GetString((uint8_t *)USBD_MANUFACTURER_STRING, USBD_StrDesc, length);
-    return USBD_StrDesc;
+    *length = sizeof(USBD_ManufacturerStrDesc);
+    return (uint8_t*)&USBD_ManufacturerStrDesc;
 }
 
 /**
@@ -188,8 +238,12 @@ uint8_t *USBD_CDC_SerialStrDescriptor(USBD_SpeedTypeDef speed, uint16_t *length)
 {
     *length = USB_SIZ_STRING_SERIAL;
 
-    UintToUnicode(DEVICE_ID_REG[0] + DEVICE_ID_REG[2], &USBD_StringSerial[2], 8);
-    UintToUnicode(DEVICE_ID_REG[1], &USBD_StringSerial[18], 4);
+    /* The unique ID is only converted at the first request */
+    if (USBD_StringSerial[2] == 0)
+    {
+        UintToUnicode(DEVICE_ID_REG[0] + DEVICE_ID_REG[2], &USBD_StringSerial[2], 8);
+        UintToUnicode(DEVICE_ID_REG[1], &USBD_StringSerial[18], 4);
+    }
 
     return (uint8_t*)USBD_StringSerial;
 }
@@ -202,8 +256,8 @@ uint8_t *USBD_CDC_SerialStrDescriptor(USBD_SpeedTypeDef speed, uint16_t *length)
   */
 uint8_t *USBD_CDC_ConfigStrDescriptor(USBD_SpeedTypeDef speed, uint16_t *length)
 {
-    USBD_GetString((uint8_t *)USBD_CONFIGURATION_FS_STRING, USBD_StrDesc, length);
-    return USBD_StrDesc;
+    *length = sizeof(USBD_ConfigStrDesc);
+    return (uint8_t*)&USBD_ConfigStrDesc;
 }
 
 /**
@@ -214,8 +268,8 @@ uint8_t *USBD_CDC_ConfigStrDescriptor(USBD_SpeedTypeDef speed, uint16_t *length)
   */
 uint8_t *USBD_CDC_InterfaceStrDescriptor(USBD_SpeedTypeDef speed, uint16_t *length)
 {
-    USBD_GetString((uint8_t *)USBD_INTERFACE_FS_STRING, USBD_StrDesc, length);
-    return USBD_StrDesc;
+    *length = sizeof(USBD_InterfaceStrDesc);
+    return (uint8_t*)&USBD_InterfaceStrDesc;
 }
 
 /**
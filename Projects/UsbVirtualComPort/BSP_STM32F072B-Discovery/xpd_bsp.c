@@ -23,7 +23,9 @@
   */
 #include <xpd_bsp.h>
 
+#include <xpd_flash.h>
 #include <xpd_rcc.h>
+#include <xpd_utils.h>
 
 const GPIO_InitType PinConfig[] =
 {
@@ -53,16 +55,26 @@ void ClockConfiguration(void)
         .ErrorLimit = CRS_ERRORLIMIT_DEFAULT
     };
 
-    /* HSI48 configuration */
+    /* HSI48 configuration, trimmed to the USB SOF without external crystal */
     XPD_RCC_HSI48Config(OSC_ON);
     XPD_CRS_Init(&crsSetup);
 
+    /* Monitor the trimming convergence, the USB can start before the lock */
+    XPD_CRS_Sync_Start();
+    XPD_NVIC_EnableIRQ(RCC_CRS_IRQn);
+
     /* System clocks configuration */
-    XPD_RCC_HCLKConfig(HSI48, CLK_DIV1, 1);
+    XPD_RCC_HCLKConfig(HSI48, CLK_DIV1, FLASH_LATENCY_AUTO);
 
     XPD_RCC_PCLKConfig(PCLK1, CLK_DIV1);
 }
 
+/* Common interrupt handler for RCC and CRS */
+void RCC_CRS_IRQHandler(void)
+{
+    XPD_CRS_IRQHandler();
+}
+
 /************************* USB ************************************/
 
 /* USB dependencies initialization */
@@ -175,3 +187,11 @@ void USART1_IRQHandler(void)
 {
     XPD_USART_IRQHandler(&uart);
 }
+
+/************************* Deferred work ***************************/
+
+/* Deferred interrupt work execution */
+void PendSV_Handler(void)
+{
+    XPD_Defer_IRQHandler();
+}
@@ -23,7 +23,9 @@
   */
 #include <xpd_bsp.h>
 
+#include <xpd_flash.h>
 #include <xpd_rcc.h>
+#include <xpd_utils.h>
 
 const GPIO_InitType PinConfig[] =
 {
@@ -68,7 +70,7 @@ void ClockConfiguration(void)
     XPD_RCC_PLLConfig(&pll);
 
     /* System clocks configuration */
-    XPD_RCC_HCLKConfig(PLL, CLK_DIV1, 2);
+    XPD_RCC_HCLKConfig(PLL, CLK_DIV1, FLASH_LATENCY_AUTO);
 
     XPD_RCC_PCLKConfig(PCLK1, CLK_DIV2);
     XPD_RCC_PCLKConfig(PCLK2, CLK_DIV1);
@@ -219,3 +221,11 @@ void USART1_IRQHandler(void)
 {
     XPD_USART_IRQHandler(&uart);
 }
+
+/************************* Deferred work ***************************/
+
+/* Deferred interrupt work execution */
+void PendSV_Handler(void)
+{
+    XPD_Defer_IRQHandler();
+}
@@ -60,6 +60,10 @@
                                   This value must be a multiple of 0x200. */
 #endif
 
+/*!< Comment the following line if the linker script doesn't provide the .ccmram section.
+     When enabled, the .ccmram section (code and initialized data) is loaded from flash */
+#define CCMRAM_INIT
+
 /**
   * @}
   */
@@ -94,6 +98,20 @@ uint32_t SystemCoreClock;
   */
 void SystemInit(void)
 {
+#if defined(CCMRAM_INIT) && defined(__GNUC__)
+    /* Load the CCM RAM section, using the linker script symbols */
+    {
+        extern uint32_t _siccmram, _sccmram, _eccmram;
+        const uint32_t * src = &_siccmram;
+        uint32_t * dst;
+
+        for (dst = &_sccmram; dst < &_eccmram; dst++)
+        {
+            *dst = *src++;
+        }
+    }
+#endif
+
     /* Reset all peripherals */
     XPD_Deinit();
 
@@ -117,11 +135,7 @@ void SystemInit(void)
     XPD_Init();
 
     /* Configure system memory options */
-    XPD_FLASH_InstCacheCtrl(ENABLE);
-
-    XPD_FLASH_DataCacheCtrl(ENABLE);
-
-    XPD_FLASH_PrefetchBufferCtrl(ENABLE);
+    XPD_FLASH_AcceleratorCtrl(ENABLE);
 
     /* Set Interrupt Group Priority */
     XPD_NVIC_SetPriorityGroup(NVIC_PRIOGROUP_0PRE_4SUB);
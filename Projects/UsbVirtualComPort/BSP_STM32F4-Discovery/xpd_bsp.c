@@ -23,7 +23,9 @@
   */
 #include <xpd_bsp.h>
 
+#include <xpd_flash.h>
 #include <xpd_rcc.h>
+#include <xpd_utils.h>
 
 const GPIO_InitType PinConfig[] =
 {
@@ -64,7 +66,7 @@ void ClockConfiguration(void)
     XPD_RCC_PLLConfig(&pll);
 
     /* System clocks configuration */
-    XPD_RCC_HCLKConfig(PLL, CLK_DIV1, 5);
+    XPD_RCC_HCLKConfig(PLL, CLK_DIV1, FLASH_LATENCY_AUTO);
 
     XPD_RCC_PCLKConfig(PCLK1, CLK_DIV4);
     XPD_RCC_PCLKConfig(PCLK2, CLK_DIV2);
@@ -145,6 +147,10 @@ static void uartinit(void * handle)
     /* GPIO settings */
     XPD_GPIO_InitPin(UART_TX_PIN, &PinConfig[UART_PIN_CFG]);
     XPD_GPIO_InitPin(UART_RX_PIN, &PinConfig[UART_PIN_CFG]);
+#if defined(UART_CTS_PIN) && defined(UART_RTS_PIN)
+    XPD_GPIO_InitPin(UART_CTS_PIN, &PinConfig[UART_PIN_CFG]);
+    XPD_GPIO_InitPin(UART_RTS_PIN, &PinConfig[UART_PIN_CFG]);
+#endif
 
     /* DMA settings */
     XPD_DMA_Init(&dmauat, &dmaSetup);
@@ -167,6 +173,10 @@ static void uartdeinit(void * handle)
 {
     XPD_GPIO_DeinitPin(UART_TX_PIN);
     XPD_GPIO_DeinitPin(UART_RX_PIN);
+#if defined(UART_CTS_PIN) && defined(UART_RTS_PIN)
+    XPD_GPIO_DeinitPin(UART_CTS_PIN);
+    XPD_GPIO_DeinitPin(UART_RTS_PIN);
+#endif
 
     XPD_DMA_Deinit(&dmauat);
     XPD_DMA_Deinit(&dmauar);
@@ -192,3 +202,11 @@ void USART2_IRQHandler(void)
 {
     XPD_USART_IRQHandler(&uart);
 }
+
+/************************* Deferred work ***************************/
+
+/* Deferred interrupt work execution */
+void PendSV_Handler(void)
+{
+    XPD_Defer_IRQHandler();
+}
@@ -38,6 +38,9 @@ typedef enum
 
 #define UART_TX_PIN     GPIOA, 2
 #define UART_RX_PIN     GPIOA, 3
+/* Map the flow control signals to enable RTS/CTS bridging */
+/* #define UART_CTS_PIN    GPIOA, 0 */
+/* #define UART_RTS_PIN    GPIOA, 1 */
 #define USB_DP_PIN      GPIOA, 12
 #define USB_DM_PIN      GPIOA, 11
 #define USB_VBUS_PIN    GPIOA, 9
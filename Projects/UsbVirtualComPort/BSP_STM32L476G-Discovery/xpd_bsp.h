@@ -38,6 +38,9 @@ typedef enum
 
 #define UART_TX_PIN     GPIOD, 5
 #define UART_RX_PIN     GPIOD, 6
+/* Map the flow control signals to enable RTS/CTS bridging */
+/* #define UART_CTS_PIN    GPIOD, 3 */
+/* #define UART_RTS_PIN    GPIOD, 4 */
 #define USB_DP_PIN      GPIOA, 12
 #define USB_DM_PIN      GPIOA, 11
 #define USB_VBUS_PIN    GPIOA, 9
@@ -29,6 +29,11 @@
 #include "xpd_adc_calc.h"
 #include "xpd_dma.h"
 
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
 /** @defgroup ADC
  * @{ */
 
@@ -156,6 +161,7 @@ typedef struct
         XPD_HandleCallbackType DepDeinit;           /*!< Callback to restore module dependencies (GPIOs, IRQs, DMAs) */
         XPD_HandleCallbackType ConvComplete;        /*!< Conversion(s) complete callback */
         XPD_HandleCallbackType Watchdog;            /*!< Watchdog alert callback */
+        XPD_HandleCallbackType BlockReady;          /*!< Streaming conversions block filled callback */
 #if defined(USE_XPD_ADC_ERROR_DETECT) || defined(USE_XPD_DMA_ERROR_DETECT)
         XPD_HandleCallbackType Error;
 #endif
@@ -163,6 +169,14 @@ typedef struct
     struct {
         DMA_HandleType * Conversion;                /*!< DMA handle for update transfer */
     }DMA;                                           /*   DMA handle references */
+    DataStreamType Block;                           /*!< The last filled block of the streaming conversions */
+    struct {
+        DMA_DescriptorType Blocks[2];               /*!< [Internal] The post-trigger transfers of the capture */
+        uint16_t PostTrigger;                       /*!< [Internal] The number of conversions stored after the trigger */
+        uint16_t Trigger;                           /*!< The buffer index of the first conversion after the trigger */
+        uint16_t Start;                             /*!< The buffer index of the oldest conversion of the capture */
+        volatile uint8_t Armed;                     /*!< [Internal] The capture is waiting for the trigger */
+    }Capture;                                       /*   Watchdog triggered capture state */
     uint8_t ConversionCount;                        /*!< ADC number of regular conversions */
     uint8_t EndFlagSelection;                       /*!< [Internal] Stores the EOC configuration */
 #if defined(USE_XPD_ADC_ERROR_DETECT) || defined(USE_XPD_DMA_ERROR_DETECT)
@@ -338,6 +352,10 @@ void            XPD_ADC_IRQHandler          (ADC_HandleType * hadc);
 
 XPD_ReturnType  XPD_ADC_Start_DMA           (ADC_HandleType * hadc, void * Address);
 void            XPD_ADC_Stop_DMA            (ADC_HandleType * hadc);
+XPD_ReturnType  XPD_ADC_DMA_BytePacking     (ADC_HandleType * hadc, FunctionalState NewState);
+XPD_ReturnType  XPD_ADC_Stream_Start        (ADC_HandleType * hadc, void * Buffer, uint16_t BlockSize);
+XPD_ReturnType  XPD_ADC_Capture_Start       (ADC_HandleType * hadc, ADC_WatchdogType Watchdog,
+                                             void * Buffer, uint16_t Length, uint16_t PostTrigger);
 
 void            XPD_ADC_WatchdogConfig      (ADC_HandleType * hadc, ADC_WatchdogType Watchdog,
                                              const ADC_WatchdogThresholdType * Config);
@@ -373,4 +391,8 @@ XPD_ReturnType  XPD_ADC_Calibrate           (ADC_HandleType * hadc, boolean_t Di
 #include "xpd_rcc_pc.h"
 #undef XPD_ADC_API
 
+#ifdef __cplusplus
+}
+#endif
+
 #endif /* __XPD_ADC_H_ */
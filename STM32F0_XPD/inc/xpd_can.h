@@ -26,6 +26,12 @@
 
 #include "xpd_common.h"
 #include "xpd_config.h"
+#include "xpd_os.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
 
 /** @defgroup CAN
  * @{ */
@@ -81,6 +87,16 @@ typedef struct
     CAN_IdType Type;            /*!< ID and data type (Std/Ext, Data/RTR) */
 }CAN_IdentifierFieldType;
 
+/** @brief CAN error management setup structure */
+typedef struct
+{
+    uint16_t MinBackoff;                /*!< Delay of the first bus-off recovery in ms */
+    uint16_t MaxBackoff;                /*!< Longest bus-off recovery delay in ms,
+                                             the delay doubles with each bus-off without successful transmission */
+    CAN_IdentifierFieldType Throttle;   /*!< The lowest priority transmit queue frame identifier
+                                             which is transmitted in error passive state */
+}CAN_ErrorMgmt_InitType;
+
 /** @brief CAN Frame structure */
 typedef struct
 {
@@ -93,9 +109,21 @@ typedef struct
     uint8_t                 Index; /*!< This field has different use based on its direction:
                                      @arg Received frames: Filter Match Index,
                                           for pairing with acceptance filter
-                                     @arg Transmitted frames: Mailbox Index */
+                                     @arg Transmitted frames: Mailbox Index,
+                                          or @ref CAN_TxIndexType for transmit queue frames */
+    uint32_t                Timestamp; /*!< Start of frame time in CAN bit times, extended to 32 bits
+                                            (only valid in Time-Triggered Communication Mode,
+                                            set for the received, the blocking and the queued transmitted frames) */
 }CAN_FrameType;
 
+/** @brief CAN transmit queue frame states, provided in the Index field of the queued frames */
+typedef enum
+{
+    CAN_TXINDEX_QUEUED = 3, /*!< The frame is waiting in the transmit queue */
+    CAN_TXINDEX_DONE   = 4, /*!< The frame is successfully transmitted */
+    CAN_TXINDEX_FAILED = 5, /*!< The frame transmission has failed */
+}CAN_TxIndexType;
+
 /** @brief CAN Error types */
 typedef enum
 {
@@ -130,6 +158,34 @@ typedef struct
     uint8_t                 FIFO;    /*!< The selected receive FIFO [0 .. 1]*/
 }CAN_FilterType;
 
+/** @brief CAN accepted Identifier range structure */
+typedef struct
+{
+    uint32_t   First;           /*!< The first accepted Identifier value */
+    uint32_t   Last;            /*!< The last accepted Identifier value (equal to First for a single Identifier) */
+    CAN_IdType Type;            /*!< ID and data type (Std/Ext, Data/RTR) */
+    uint8_t    FIFO;            /*!< The selected receive FIFO [0 .. 1]*/
+}CAN_FilterRangeType;
+
+/** @brief CAN receive queue structure */
+typedef struct
+{
+    CAN_FrameType * Buffer;                /*!< [Internal] Frame storage of the queue */
+    uint8_t Size;                          /*!< [Internal] Number of frames the queue can hold */
+    volatile uint8_t Head;                 /*!< [Internal] Write index, advanced by the interrupt handler */
+    volatile uint8_t Tail;                 /*!< [Internal] Read index, advanced by the reader */
+    uint16_t HwOverruns;                   /*!< Number of hardware FIFO overrun events */
+    uint16_t SwOverruns;                   /*!< Number of frames dropped due to full queue */
+}CAN_RxQueueType;
+
+/** @brief CAN event callbacks structure */
+typedef struct
+{
+    XPD_HandleCallbackType Transmit;       /*!< Frame transmission successful callback */
+    XPD_HandleCallbackType Receive[2];     /*!< Frame reception successful callback for each FIFO */
+    XPD_HandleCallbackType Error;          /*!< Error detection callback */
+}CAN_CallbacksType;
+
 /** @brief CAN Handle structure */
 typedef struct
 {
@@ -141,12 +197,50 @@ typedef struct
     struct {
         XPD_HandleCallbackType DepInit;    /*!< Callback to initialize module dependencies (GPIOs, IRQs) */
         XPD_HandleCallbackType DepDeinit;  /*!< Callback to restore module dependencies (GPIOs, IRQs) */
+#ifdef USE_XPD_CONST_CALLBACKS
+        const CAN_CallbacksType * Table;   /*!< Constant event callbacks table, none of its entries
+                                                may be NULL (see @ref XPD_NullCallback) */
+#else
         XPD_HandleCallbackType Transmit;   /*!< Frame transmission successful callback */
         XPD_HandleCallbackType Receive[2]; /*!< Frame reception successful callback for each FIFO */
         XPD_HandleCallbackType Error;      /*!< Error detection callback */
+#endif
     } Callbacks;                           /*   Handle Callbacks */
     CAN_FrameType * RxFrame[2];            /*!< [Internal] Pointers to where the received frames will be stored */
+    CAN_RxQueueType RxQueue[2];            /*!< [Internal] Software receive queues for each FIFO */
+    struct {
+        CAN_FrameType ** Buffer;           /*!< [Internal] Queued frames, ordered by decreasing identifier */
+        uint8_t Size;                      /*!< [Internal] Number of frames the queue can hold */
+        volatile uint8_t Count;            /*!< [Internal] Number of queued frames */
+        volatile uint8_t Aborting;         /*!< [Internal] Mailbox flag whose frame is preempted */
+    }TxQueue;                              /*   Software transmit queue */
+    CAN_FrameType * TxFrame[3];            /*!< [Internal] The transmit queue frames in the mailboxes */
+#ifdef USE_XPD_CAN_ERROR_DETECT
+    struct {
+        uint32_t Throttle;                 /*!< [Internal] Arbitration field of the lowest priority frame
+                                                transmitted in error passive state */
+        uint16_t MinBackoff;               /*!< [Internal] Delay of the first bus-off recovery in ms */
+        uint16_t MaxBackoff;               /*!< [Internal] Longest bus-off recovery delay in ms (0 if not managed) */
+        uint16_t Backoff;                  /*!< [Internal] Delay of the next bus-off recovery in ms */
+        volatile uint16_t Countdown;       /*!< [Internal] Remaining time until the bus-off recovery in ms */
+        volatile uint8_t Recovery;         /*!< [Internal] Bus-off recovery progress */
+        uint8_t TEC;                       /*!< Transmit error counter at the last error event */
+        uint8_t REC;                       /*!< Receive error counter at the last error event */
+        uint16_t BusOffs;                  /*!< Number of bus-off events */
+    }ErrorMgmt;                            /*   Error management state */
+#endif
     volatile uint8_t State;                /*!< [Internal] CAN interrupt-controlled communication state */
+    uint32_t Time;                         /*!< [Internal] The last extended frame timestamp */
+    uint32_t BitRate;                      /*!< [Internal] The bit rate of the initial bit timing, kept by @ref XPD_CAN_ClockUpdate */
+#ifdef USE_XPD_OS
+    struct {
+        XPD_OS_SignalType Transmit;        /*!< [Internal] Signal of @ref XPD_CAN_Transmit_Blocking */
+        XPD_OS_SignalType Receive[2];      /*!< [Internal] Signals of @ref XPD_CAN_Receive_Blocking for each FIFO */
+    }Signal;                               /*   Blocking transfer completion signals */
+#endif
+#ifdef USE_XPD_STATISTICS
+    XPD_StatsType Stats;                   /*!< Runtime statistics (errors: [0..2] error states, [3] FIFO overrun, [4] protocol error) */
+#endif
 }CAN_HandleType;
 
 /** @} */
@@ -167,6 +261,17 @@ typedef struct
      .Callbacks.DepInit   = (INIT_FN),                          \
      .Callbacks.DepDeinit = (DEINIT_FN)}
 
+/**
+ * @brief  Constant CAN Handle reference for a peripheral instance.
+ * @note   Resolved at compile time, it can replace the handle argument of the
+ *         flag and interrupt control macros in time-critical code, such as
+ *         user interrupt handlers, so that the register addresses become
+ *         immediate values instead of loads through the handle.
+ * @param  INSTANCE: specifies the CAN peripheral instance.
+ */
+#define         CAN_INST_HANDLE(INSTANCE)                       \
+    (&(const CAN_HandleType){.Inst = (INSTANCE), .Inst_BB = CAN_BB(INSTANCE)})
+
 /**
  * @brief CAN register bit accessing macro
  * @param HANDLE: specifies the peripheral handle.
@@ -189,6 +294,17 @@ typedef struct
      .Callbacks.DepInit   = (INIT_FN),                          \
      .Callbacks.DepDeinit = (DEINIT_FN)}
 
+/**
+ * @brief  Constant CAN Handle reference for a peripheral instance.
+ * @note   Resolved at compile time, it can replace the handle argument of the
+ *         flag and interrupt control macros in time-critical code, such as
+ *         user interrupt handlers, so that the register addresses become
+ *         immediate values instead of loads through the handle.
+ * @param  INSTANCE: specifies the CAN peripheral instance.
+ */
+#define         CAN_INST_HANDLE(INSTANCE)                       \
+    (&(const CAN_HandleType){.Inst = (INSTANCE)})
+
 /**
  * @brief CAN register bit accessing macro
  * @param HANDLE: specifies the peripheral handle.
@@ -200,6 +316,28 @@ typedef struct
 
 #endif /* CAN_BB */
 
+/**
+ * @brief  Computes the bit timing prescaler at build time.
+ * @param  CLOCK: the constant CAN peripheral clock frequency in Hz
+ * @param  BITRATE: the requested bus bitrate
+ * @param  BS1: the bit segment 1 length in time quanta
+ * @param  BS2: the bit segment 2 length in time quanta
+ */
+#define         CAN_TIMING_PRESCALER(CLOCK, BITRATE, BS1, BS2)  \
+    XPD_DIV_ROUND((CLOCK), (BITRATE) * (1 + (BS1) + (BS2)))
+
+/**
+ * @brief  Computes the relative bitrate error of the bit timing setup.
+ * @param  CLOCK: the constant CAN peripheral clock frequency in Hz
+ * @param  BITRATE: the requested bus bitrate
+ * @param  BS1: the bit segment 1 length in time quanta
+ * @param  BS2: the bit segment 2 length in time quanta
+ * @return The bitrate deviation in permille
+ */
+#define         CAN_BITRATE_ERROR_PERMILLE(CLOCK, BITRATE, BS1, BS2) \
+    XPD_ERROR_PERMILLE(CAN_TIMING_PRESCALER(CLOCK, BITRATE, BS1, BS2) \
+            * (BITRATE) * (1 + (BS1) + (BS2)), (CLOCK))
+
 /**
  * @brief  Enable the specified CAN interrupt.
  * @param  HANDLE: specifies the CAN Handle.
@@ -358,6 +496,22 @@ typedef struct
 #define         XPD_CAN_ClearFlag(  HANDLE, FLAG_NAME)          \
     ((HANDLE)->Inst->MSR.w = CAN_MSR_##FLAG_NAME)
 
+/**
+ * @brief  Get the transmit error counter of the CAN peripheral.
+ * @param  HANDLE: specifies the CAN Handle.
+ * @return The lower 8 bits of the transmit error counter.
+ */
+#define         XPD_CAN_GetTxErrorCounter(  HANDLE)         \
+    ((HANDLE)->Inst->ESR.b.TEC)
+
+/**
+ * @brief  Get the receive error counter of the CAN peripheral.
+ * @param  HANDLE: specifies the CAN Handle.
+ * @return The receive error counter.
+ */
+#define         XPD_CAN_GetRxErrorCounter(  HANDLE)         \
+    ((HANDLE)->Inst->ESR.b.REC)
+
 /** @} */
 
 /** @addtogroup CAN_Exported_Functions
@@ -379,7 +533,14 @@ XPD_ReturnType  XPD_CAN_Deinit              (CAN_HandleType * hcan);
 XPD_ReturnType  XPD_CAN_Sleep               (CAN_HandleType * hcan);
 XPD_ReturnType  XPD_CAN_WakeUp              (CAN_HandleType * hcan);
 
+XPD_ReturnType  XPD_CAN_ClockUpdate         (CAN_HandleType * hcan);
+
 CAN_ErrorType   XPD_CAN_GetError            (CAN_HandleType * hcan);
+
+#ifdef USE_XPD_CAN_ERROR_DETECT
+void            XPD_CAN_ErrorMgmt_Init      (CAN_HandleType * hcan, const CAN_ErrorMgmt_InitType * Config);
+void            XPD_CAN_ErrorMgmt_Tick      (CAN_HandleType * hcan);
+#endif
 /** @} */
 
 /** @addtogroup CAN_Exported_Functions_Filter
@@ -387,18 +548,38 @@ CAN_ErrorType   XPD_CAN_GetError            (CAN_HandleType * hcan);
 XPD_ReturnType  XPD_CAN_FilterBankConfig    (CAN_HandleType * hcan, uint8_t NewSize);
 XPD_ReturnType  XPD_CAN_FilterConfig        (CAN_HandleType * hcan, const CAN_FilterType * Filters,
                                              uint8_t * MatchIndexes, uint8_t FilterCount);
+
+XPD_ReturnType  XPD_CAN_FilterCompile       (const CAN_FilterRangeType * Ranges, uint8_t RangeCount,
+                                             CAN_FilterType * Filters, uint8_t * FilterCount);
+uint8_t         XPD_CAN_FilterBankDemand    (const CAN_FilterType * Filters, uint8_t FilterCount);
 /** @} */
 
 /** @addtogroup CAN_Exported_Functions_Transmit
  * @{ */
 XPD_ReturnType  XPD_CAN_Transmit            (CAN_HandleType * hcan, CAN_FrameType * Frame, uint32_t Timeout);
 XPD_ReturnType  XPD_CAN_Transmit_IT         (CAN_HandleType * hcan, CAN_FrameType * Frame);
+#ifdef USE_XPD_OS
+XPD_ReturnType  XPD_CAN_Transmit_Blocking   (CAN_HandleType * hcan, CAN_FrameType * Frame, uint32_t Timeout);
+#endif
+
+void            XPD_CAN_TxQueue_Init        (CAN_HandleType * hcan, CAN_FrameType ** Buffer, uint8_t Size);
+XPD_ReturnType  XPD_CAN_TxQueue_Put         (CAN_HandleType * hcan, CAN_FrameType * Frame);
 /** @} */
 
 /** @addtogroup CAN_Exported_Functions_Receive
  * @{ */
 XPD_ReturnType  XPD_CAN_Receive             (CAN_HandleType * hcan, CAN_FrameType * Frame, uint8_t FIFONumber, uint32_t Timeout);
 XPD_ReturnType  XPD_CAN_Receive_IT          (CAN_HandleType * hcan, CAN_FrameType * Frame, uint8_t FIFONumber);
+#ifdef USE_XPD_OS
+XPD_ReturnType  XPD_CAN_Receive_Blocking    (CAN_HandleType * hcan, CAN_FrameType * Frame, uint8_t FIFONumber,
+                                             uint32_t Timeout);
+#endif
+
+XPD_ReturnType  XPD_CAN_RxQueue_Start       (CAN_HandleType * hcan, uint8_t FIFONumber,
+                                             CAN_FrameType * Buffer, uint8_t Size);
+void            XPD_CAN_RxQueue_Stop        (CAN_HandleType * hcan, uint8_t FIFONumber);
+uint8_t         XPD_CAN_RxQueue_Read        (CAN_HandleType * hcan, uint8_t FIFONumber,
+                                             CAN_FrameType * Frames, uint8_t Count);
 /** @} */
 
 /** @} */
@@ -409,4 +590,8 @@ XPD_ReturnType  XPD_CAN_Receive_IT          (CAN_HandleType * hcan, CAN_FrameTyp
 #include "xpd_rcc_gen.h"
 #undef XPD_CAN_API
 
+#ifdef __cplusplus
+}
+#endif
+
 #endif /* __XPD_CAN_H_ */
@@ -26,6 +26,11 @@
 
 #include <stdint.h>
 
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
 /**
  * @mainpage STM32 eXtensible Peripheral Drivers for STM32F4 device family
  *
@@ -133,6 +138,16 @@ typedef struct
     uint16_t size;   /*!< Size of a data element */
 }DataStreamType;
 
+/** @brief Peripheral handle runtime statistics structure */
+typedef struct
+{
+    uint32_t Transfers;      /*!< The number of completed transfers (in each direction) */
+    uint32_t Bytes;          /*!< The number of transferred data bytes (in both directions) */
+    uint32_t MaxIRQCycles;   /*!< The longest execution time of the handle's IRQ handler */
+    uint16_t QueueHighWater; /*!< The maximal observed fill level of the handle's queue */
+    uint16_t Errors[8];      /*!< Occurrence counters of each error flag, indexed by its bit position */
+}XPD_StatsType;
+
 /**
  * @brief Function pointer type for binary control function reference
  * @param NewState: the state to set
@@ -180,10 +195,94 @@ typedef void ( *XPD_HandleCallbackType )    ( void * Handle );
 #define XPD_SAFE_CALLBACK(CALLBACK, ...)      \
     do{ if ((CALLBACK) != NULL) (void) CALLBACK(__VA_ARGS__); }while(0)
 
+/**
+ * @brief  Starts the cycle measurement of the enclosing function's body.
+ * @note   Only has effect when USE_XPD_PROFILING is defined.
+ */
+#define XPD_PROFILE_BEGIN()
+
+/**
+ * @brief  Finishes the cycle measurement of the enclosing function's body.
+ * @note   Only has effect when USE_XPD_PROFILING is defined.
+ */
+#define XPD_PROFILE_END()
+
+/**
+ * @brief  Emits a timestamped event to the trace ring.
+ * @note   Only has effect when USE_XPD_TRACE is defined.
+ * @param  ID: the event identifier
+ * @param  VALUE: the 16-bit event parameter
+ */
+#define XPD_TRACE(ID, VALUE)
+
+/**
+ * @brief  Records a power state transition for the energy profiling.
+ * @note   Only has effect when USE_XPD_ENERGY_PROFILING is defined.
+ * @param  STATE: the new power state
+ */
+#define XPD_ENERGY_STATE(STATE)
+
+/**
+ * @brief  Adds a value to a statistics counter of the handle.
+ * @note   Only has effect when USE_XPD_STATISTICS is defined.
+ * @param  HANDLE: pointer to the peripheral handle
+ * @param  FIELD: the statistics field name
+ * @param  VALUE: the value to add
+ */
+#define XPD_STATS_ADD(HANDLE, FIELD, VALUE)
+
+/**
+ * @brief  Raises a statistics field of the handle to the value if it exceeds it.
+ * @note   Only has effect when USE_XPD_STATISTICS is defined.
+ * @param  HANDLE: pointer to the peripheral handle
+ * @param  FIELD: the statistics field name
+ * @param  VALUE: the observed value
+ */
+#define XPD_STATS_MAX(HANDLE, FIELD, VALUE)
+
+/**
+ * @brief  Counts the set error flags in the error counters of the handle.
+ * @note   Only has effect when USE_XPD_STATISTICS is defined.
+ * @param  HANDLE: pointer to the peripheral handle
+ * @param  ERRORS: the newly detected error flags
+ */
+#define XPD_STATS_ERROR(HANDLE, ERRORS)
+
+/**
+ * @brief  Starts the execution time measurement of the IRQ handler for the statistics.
+ * @note   Only has effect when USE_XPD_STATISTICS is defined.
+ */
+#define XPD_STATS_IRQ_BEGIN()
+
+/**
+ * @brief  Finishes the IRQ handler execution time measurement of the handle.
+ * @note   Only has effect when USE_XPD_STATISTICS is defined.
+ * @param  HANDLE: pointer to the peripheral handle
+ */
+#define XPD_STATS_IRQ_END(HANDLE)
+
 /** @} */
 
 /** @} */
 
+/* Compile-time clock divider helpers, the arguments are expected to be constant
+ * expressions (e.g. derived from HSE_VALUE and the static PLL setup) */
+
+/** @brief Integer division of clock values rounded to the nearest result */
+#define XPD_DIV_ROUND(NUM, DEN)                 \
+    (((NUM) + ((DEN) / 2)) / (DEN))
+
+/** @brief Deviation of an achieved value from the target in permille */
+#define XPD_ERROR_PERMILLE(ACTUAL, TARGET)      \
+    (((((ACTUAL) > (TARGET)) ? ((ACTUAL) - (TARGET)) : ((TARGET) - (ACTUAL))) * 1000) / (TARGET))
+
+/** @brief Build time assertion of a constant expression */
+#ifdef __cplusplus
+#define XPD_STATIC_ASSERT(EXPR, MSG)            static_assert(EXPR, MSG)
+#else
+#define XPD_STATIC_ASSERT(EXPR, MSG)            _Static_assert(EXPR, MSG)
+#endif
+
 /* Inherited macros */
 
 #define SET_BIT(REG, BIT)     ((REG) |= (BIT))
@@ -224,5 +323,41 @@ typedef void ( *XPD_HandleCallbackType )    ( void * Handle );
 #endif /* __ALIGN_BEGIN */
 #endif /* __GNUC__ */
 
+/* Macros to place functions and variables in RAM regions, the linker script has to map
+ * the .ramfunc input sections to the initialized .data section of the SRAM,
+ * and the .ccmram input sections to the CCM RAM (available on STM32F3 and STM32F4 devices),
+ * or to the SRAM2 on STM32L4 devices */
+#if defined   (__GNUC__)        /* GNU Compiler */
+#ifndef __RAMFUNC
+#define __RAMFUNC       __attribute__((section(".ramfunc"), long_call, noinline))
+#endif /* __RAMFUNC */
+#ifndef __CCMRAM
+/* STM32F3 and STM32F4 CCM RAM isn't accessible by the DMA, see DMA_ADDRESS_ACCESSIBLE */
+#define __CCMRAM        __attribute__((section(".ccmram")))
+#endif /* __CCMRAM */
+#ifndef __CCMFUNC
+/* Only STM32F3 CCM RAM is connected to the instruction bus */
+#define __CCMFUNC       __attribute__((section(".ccmram.text"), long_call, noinline))
+#endif /* __CCMFUNC */
+#elif defined (__ICCARM__)      /* IAR Compiler */
+#ifndef __RAMFUNC
+#define __RAMFUNC       __ramfunc
+#endif /* __RAMFUNC */
+#ifndef __CCMRAM
+#define __CCMRAM        _Pragma("location=\".ccmram\"")
+#endif /* __CCMRAM */
+#else
+#ifndef __RAMFUNC
+#define __RAMFUNC       __attribute__((section(".ramfunc")))
+#endif /* __RAMFUNC */
+#ifndef __CCMRAM
+#define __CCMRAM        __attribute__((section(".ccmram")))
+#endif /* __CCMRAM */
+#endif /* __GNUC__ */
+
+
+#ifdef __cplusplus
+}
+#endif
 
 #endif /* __XPD_COMMON_H_ */
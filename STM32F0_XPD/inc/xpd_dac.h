@@ -0,0 +1,226 @@
+/**
+  ******************************************************************************
+  * @file    xpd_dac.h
+  * @author  Benedek Kupper
+  * @version V0.1
+  * @date    2018-01-20
+  * @brief   STM32 eXtensible Peripheral Drivers DAC Module
+  *
+  *  This file is part of STM32_XPD.
+  *
+  *  STM32_XPD is free software: you can redistribute it and/or modify
+  *  it under the terms of the GNU General Public License as published by
+  *  the Free Software Foundation, either version 3 of the License, or
+  *  (at your option) any later version.
+  *
+  *  STM32_XPD is distributed in the hope that it will be useful,
+  *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with STM32_XPD.  If not, see <http://www.gnu.org/licenses/>.
+  */
+#ifndef __XPD_DAC_H_
+#define __XPD_DAC_H_
+
+#include "xpd_common.h"
+#include "xpd_config.h"
+#include "xpd_dma.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/** @defgroup DAC
+ * @{ */
+
+/** @defgroup DAC_Exported_Types DAC Exported Types
+ * @{ */
+
+/** @brief DAC channels */
+typedef enum
+{
+    DAC_CHANNEL_1 = 0, /*!< DAC channel 1 */
+    DAC_CHANNEL_2 = 1, /*!< DAC channel 2 */
+}DAC_ChannelType;
+
+/** @brief DAC conversion trigger sources */
+typedef enum
+{
+    DAC_TRIGGER_TIM6_TRGO  = 0, /*!< TIM6 TRGO event */
+#if defined(TIM8)
+    DAC_TRIGGER_TIM8_TRGO  = 1, /*!< TIM8 TRGO event */
+#elif defined(TIM3)
+    DAC_TRIGGER_TIM3_TRGO  = 1, /*!< TIM3 TRGO event */
+#endif
+    DAC_TRIGGER_TIM7_TRGO  = 2, /*!< TIM7 TRGO event */
+#if defined(TIM5)
+    DAC_TRIGGER_TIM5_TRGO  = 3, /*!< TIM5 TRGO event */
+#elif defined(TIM15) && defined(DAC_CR_BOFF1)
+    DAC_TRIGGER_TIM15_TRGO = 3, /*!< TIM15 TRGO event */
+#endif
+    DAC_TRIGGER_TIM2_TRGO  = 4, /*!< TIM2 TRGO event */
+#if defined(TIM4)
+    DAC_TRIGGER_TIM4_TRGO  = 5, /*!< TIM4 TRGO event */
+#endif
+    DAC_TRIGGER_EXTI9      = 6, /*!< EXTI line 9 */
+    DAC_TRIGGER_SOFTWARE   = 7, /*!< Software trigger by @ref XPD_DAC_SoftwareTrigger */
+    DAC_TRIGGER_NONE       = 8, /*!< The output is updated right after the data holding register write */
+}DAC_TriggerType;
+
+/** @brief DAC data formats */
+typedef enum
+{
+    DAC_DATA_12R = 0, /*!< 12-bit right aligned data */
+    DAC_DATA_12L = 1, /*!< 12-bit left aligned data */
+    DAC_DATA_8R  = 2, /*!< 8-bit right aligned data */
+}DAC_DataFormatType;
+
+/** @brief DAC error types */
+typedef enum
+{
+    DAC_ERROR_NONE      = 0, /*!< No error */
+    DAC_ERROR_UNDERRUN1 = 1, /*!< Channel 1 trigger occurred before the DMA could provide the data */
+    DAC_ERROR_UNDERRUN2 = 2, /*!< Channel 2 trigger occurred before the DMA could provide the data */
+    DAC_ERROR_DMA       = 4, /*!< DMA transfer error */
+}DAC_ErrorType;
+
+/** @brief DAC channel setup structure */
+typedef struct
+{
+    DAC_TriggerType Trigger;      /*!< Conversion trigger source */
+    FunctionalState OutputBuffer; /*!< Output buffer state: enable for driving loads directly */
+}DAC_Channel_InitType;
+
+/** @brief DAC Handle structure */
+typedef struct
+{
+    DAC_TypeDef * Inst;                      /*!< The address of the peripheral instance used by the handle */
+    XPD_CtrlFnType ClockCtrl;                /*!< Function pointer for RCC clock control */
+    struct {
+        XPD_HandleCallbackType DepInit;      /*!< Callback to initialize module dependencies (GPIOs, IRQs, DMAs) */
+        XPD_HandleCallbackType DepDeinit;    /*!< Callback to restore module dependencies (GPIOs, IRQs, DMAs) */
+#if defined(USE_XPD_DAC_ERROR_DETECT) || defined(USE_XPD_DMA_ERROR_DETECT)
+        XPD_HandleCallbackType Error;        /*!< DMA underrun or DMA transfer error callback */
+#endif
+    }Callbacks;                              /*   Handle Callbacks */
+    struct {
+        DMA_HandleType * Channel[2];         /*!< DMA handles of the channel data streams */
+    }DMA;                                    /*   DMA handle references */
+#if defined(USE_XPD_DAC_ERROR_DETECT) || defined(USE_XPD_DMA_ERROR_DETECT)
+    volatile DAC_ErrorType Errors;           /*!< Streaming errors */
+#endif
+#ifdef USE_XPD_STATISTICS
+    XPD_StatsType Stats;                     /*!< Runtime statistics (errors indexed by @ref DAC_ErrorType bits) */
+#endif
+}DAC_HandleType;
+
+/** @brief DAC DMA stream context structure */
+typedef struct
+{
+    DataStreamType         Block;            /*!< The transmitted block of the double buffer, which is free to refill */
+    XPD_HandleCallbackType BlockFree;        /*!< Block transmitted callback, the argument is the stream */
+    void *                 Buffer;           /*!< [Internal] The double buffer of the stream */
+    void *                 Owner;            /*!< [Internal] The DAC handle of the stream */
+    DAC_ChannelType        Channel;          /*!< [Internal] The DMA requesting channel of the stream */
+}DAC_StreamType;
+
+/** @} */
+
+/** @defgroup DAC_Exported_Macros DAC Exported Macros
+ * @{ */
+
+/**
+ * @brief  DAC Handle initializer macro
+ * @param  INSTANCE: specifies the DAC peripheral instance.
+ * @param  INIT_FN: specifies the dependency initialization function to call back.
+ * @param  DEINIT_FN: specifies the dependency deinitialization function to call back.
+ */
+#define         NEW_DAC_HANDLE(INSTANCE, INIT_FN, DEINIT_FN)    \
+    {.Inst = (INSTANCE),                                        \
+     .ClockCtrl = XPD_##INSTANCE##_ClockCtrl,                   \
+     .Callbacks.DepInit   = (INIT_FN),                          \
+     .Callbacks.DepDeinit = (DEINIT_FN)}
+
+/**
+ * @brief  Get the specified DAC flag.
+ * @param  HANDLE: specifies the DAC Handle.
+ * @param  FLAG_NAME: specifies the flag to return.
+ *         This parameter can be one of the following values:
+ *            @arg DMAUDR1:   Channel 1 DMA underrun
+ *            @arg DMAUDR2:   Channel 2 DMA underrun
+ */
+#define         XPD_DAC_GetFlag(HANDLE, FLAG_NAME)              \
+    ((HANDLE)->Inst->SR.b.FLAG_NAME)
+
+/**
+ * @brief  Clear the specified DAC flag.
+ * @param  HANDLE: specifies the DAC Handle.
+ * @param  FLAG_NAME: specifies the flag to clear.
+ *         This parameter can be one of the following values:
+ *            @arg DMAUDR1:   Channel 1 DMA underrun
+ *            @arg DMAUDR2:   Channel 2 DMA underrun
+ */
+#define         XPD_DAC_ClearFlag(HANDLE, FLAG_NAME)            \
+    ((HANDLE)->Inst->SR.w = DAC_SR_##FLAG_NAME)
+
+/**
+ * @brief  Triggers a conversion of the channel by software.
+ * @note   Only has effect when the channel trigger is @ref DAC_TRIGGER_SOFTWARE.
+ * @param  HANDLE: specifies the DAC Handle.
+ * @param  CHANNEL: the @ref DAC_ChannelType to trigger
+ */
+#define         XPD_DAC_SoftwareTrigger(HANDLE, CHANNEL)        \
+    ((HANDLE)->Inst->SWTRIGR.w = DAC_SWTRIGR_SWTRIG1 << (CHANNEL))
+
+/**
+ * @brief  Provides the current output value of the channel.
+ * @param  HANDLE: specifies the DAC Handle.
+ * @param  CHANNEL: the @ref DAC_ChannelType to read
+ */
+#define         XPD_DAC_Channel_GetValue(HANDLE, CHANNEL)       \
+    ((&(HANDLE)->Inst->DOR1)[(CHANNEL)])
+
+/** @} */
+
+/** @addtogroup DAC_Exported_Functions
+ * @{ */
+XPD_ReturnType  XPD_DAC_Init                (DAC_HandleType * hdac);
+XPD_ReturnType  XPD_DAC_Deinit              (DAC_HandleType * hdac);
+
+void            XPD_DAC_Channel_Init        (DAC_HandleType * hdac, DAC_ChannelType Channel,
+                                             const DAC_Channel_InitType * Config);
+void            XPD_DAC_Channel_Enable      (DAC_HandleType * hdac, DAC_ChannelType Channel);
+void            XPD_DAC_Channel_Disable     (DAC_HandleType * hdac, DAC_ChannelType Channel);
+void            XPD_DAC_Channel_SetValue    (DAC_HandleType * hdac, DAC_ChannelType Channel,
+                                             DAC_DataFormatType Format, uint16_t Value);
+void            XPD_DAC_Dual_SetValue       (DAC_HandleType * hdac, DAC_DataFormatType Format,
+                                             uint16_t Value1, uint16_t Value2);
+
+XPD_ReturnType  XPD_DAC_Stream_Start        (DAC_HandleType * hdac, DAC_ChannelType Channel,
+                                             DAC_StreamType * Stream, DAC_DataFormatType Format,
+                                             void * Buffer, uint16_t BlockSize);
+XPD_ReturnType  XPD_DAC_DualStream_Start    (DAC_HandleType * hdac, DAC_StreamType * Stream,
+                                             DAC_DataFormatType Format,
+                                             void * Buffer, uint16_t BlockSize);
+void            XPD_DAC_Stream_Stop         (DAC_HandleType * hdac, DAC_StreamType * Stream);
+
+#ifdef USE_XPD_DAC_ERROR_DETECT
+void            XPD_DAC_IRQHandler          (DAC_HandleType * hdac);
+#endif
+/** @} */
+
+/** @} */
+
+#define XPD_DAC_API
+#include "xpd_rcc_gen.h"
+#include "xpd_rcc_pc.h"
+#undef XPD_DAC_API
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __XPD_DAC_H_ */
@@ -28,6 +28,11 @@
 #include "xpd_config.h"
 #include "xpd_exti.h"
 
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
 /** @defgroup GPIO
  * @{ */
 
@@ -76,6 +81,132 @@ typedef struct
 #endif
 }GPIO_InitType;
 
+/** @brief GPIO pin map entry, used to set up multiple pins with a single call */
+typedef struct
+{
+    GPIO_TypeDef *        GPIOx;  /*!< Pointer to the GPIO peripheral */
+    uint8_t               Pin;    /*!< Selected pin of the port [0 .. 15] */
+    const GPIO_InitType * Config; /*!< Pointer to the setup parameters of the pin */
+}GPIO_PinMapType;
+
+/** @brief GPIO port register contents for the selected pins of a port */
+typedef struct
+{
+    GPIO_TypeDef * GPIOx;   /*!< Pointer to the GPIO peripheral */
+    uint32_t       Pins;    /*!< Bit mask of the pins which are set up by this structure */
+    uint32_t       MODER;   /*!< Mode register value of the selected pins */
+    uint32_t       OTYPER;  /*!< Output type register value of the selected pins */
+    uint32_t       OSPEEDR; /*!< Output speed register value of the selected pins */
+    uint32_t       PUPDR;   /*!< Pull-up/pull-down register value of the selected pins */
+    uint32_t       AFR[2];  /*!< Alternate function register values of the selected pins */
+#ifdef GPIO_ASCR_ASC0
+    uint32_t       ASCR;    /*!< Analog switch control register value of the selected pins */
+#endif
+}GPIO_PortConfigType;
+
+/** @brief GPIO mode switching token, the precomputed mode register fields of pins of a port */
+typedef struct
+{
+    uint32_t Mask;          /*!< Mode register field mask of the switched pins */
+    uint32_t MODER;         /*!< Mode register value of the switched pins */
+}GPIO_ModeTokenType;
+
+/** @} */
+
+/** @defgroup GPIO_Exported_Macros GPIO Exported Macros
+ * @{ */
+
+/**
+ * @brief  Constant initializer of a @ref GPIO_PortConfigType structure.
+ * @param  GPIOX: pointer to the GPIO peripheral
+ * @param  PINLIST: function-like macro which takes a register selector
+ *         and expands to the bitwise OR of @ref GPIO_PIN_CONFIG entries
+ *         of the port, passing the register selector to each of them
+ * @note   Example usage:
+ *         #define LED_PINS(REG) (GPIO_PIN_CONFIG(REG, 12, GPIO_MODE_OUTPUT, GPIO_PULL_FLOAT, GPIO_OUTPUT_PUSHPULL, LOW, 0) | \
+ *                                GPIO_PIN_CONFIG(REG, 13, GPIO_MODE_OUTPUT, GPIO_PULL_FLOAT, GPIO_OUTPUT_PUSHPULL, LOW, 0))
+ *         static const GPIO_PortConfigType ledPort = GPIO_PORT_CONFIG(GPIOD, LED_PINS);
+ */
+#ifdef GPIO_ASCR_ASC0
+#define GPIO_PORT_CONFIG(GPIOX, PINLIST)    \
+    {   .GPIOx   = (GPIOX),                 \
+        .Pins    = PINLIST(PINS),           \
+        .MODER   = PINLIST(MODER),          \
+        .OTYPER  = PINLIST(OTYPER),         \
+        .OSPEEDR = PINLIST(OSPEEDR),        \
+        .PUPDR   = PINLIST(PUPDR),          \
+        .AFR     = { PINLIST(AFRL), PINLIST(AFRH) }, \
+        .ASCR    = PINLIST(ASCR) }
+#else
+#define GPIO_PORT_CONFIG(GPIOX, PINLIST)    \
+    {   .GPIOx   = (GPIOX),                 \
+        .Pins    = PINLIST(PINS),           \
+        .MODER   = PINLIST(MODER),          \
+        .OTYPER  = PINLIST(OTYPER),         \
+        .OSPEEDR = PINLIST(OSPEEDR),        \
+        .PUPDR   = PINLIST(PUPDR),          \
+        .AFR     = { PINLIST(AFRL), PINLIST(AFRH) } }
+#endif
+
+/**
+ * @brief  Calculates the contribution of a single pin to the selected port register.
+ * @param  REG: register selector, provided by @ref GPIO_PORT_CONFIG
+ * @param  PIN: selected pin of the port [0 .. 15]
+ * @param  MODE: @ref GPIO_ModeType (EXTI mode is not supported)
+ * @param  PULL: @ref GPIO_PullType
+ * @param  TYPE: @ref GPIO_OutputType
+ * @param  SPEED: output switching speed
+ * @param  AF: mapping to alternate function @ref GPIO_Alternate_function_map
+ * @return The register contents belonging to the pin, resolved at compile time
+ *         when all parameters are constant
+ */
+#define GPIO_PIN_CONFIG(REG, PIN, MODE, PULL, TYPE, SPEED, AF)  \
+    GPIO_PIN_CONFIG_##REG((uint32_t)(PIN), (uint32_t)(MODE), (uint32_t)(PULL), \
+                          (uint32_t)(TYPE), (uint32_t)(SPEED), (uint32_t)(AF))
+
+#define GPIO_PIN_CONFIG_PINS(PIN, MODE, PULL, TYPE, SPEED, AF)      \
+    (1 << (PIN))
+#define GPIO_PIN_CONFIG_MODER(PIN, MODE, PULL, TYPE, SPEED, AF)     \
+    (((MODE) & 3) << ((PIN) * 2))
+#define GPIO_PIN_CONFIG_OTYPER(PIN, MODE, PULL, TYPE, SPEED, AF)    \
+    ((TYPE) << (PIN))
+#define GPIO_PIN_CONFIG_OSPEEDR(PIN, MODE, PULL, TYPE, SPEED, AF)   \
+    ((SPEED) << ((PIN) * 2))
+#define GPIO_PIN_CONFIG_PUPDR(PIN, MODE, PULL, TYPE, SPEED, AF)     \
+    ((PULL) << ((PIN) * 2))
+#define GPIO_PIN_CONFIG_AFRL(PIN, MODE, PULL, TYPE, SPEED, AF)      \
+    (((PIN) < 8) ? (((AF) & 0xF) << ((PIN) * 4)) : 0)
+#define GPIO_PIN_CONFIG_AFRH(PIN, MODE, PULL, TYPE, SPEED, AF)      \
+    (((PIN) < 8) ? 0 : (((AF) & 0xF) << (((PIN) - 8) * 4)))
+#define GPIO_PIN_CONFIG_ASCR(PIN, MODE, PULL, TYPE, SPEED, AF)      \
+    ((((AF) >> 4) & 1) << (PIN))
+
+/**
+ * @brief  Constant initializer of a @ref GPIO_ModeTokenType structure.
+ * @param  PINS: bit mask of the switched pins of the port
+ * @param  MODE: @ref GPIO_ModeType (EXTI mode is not supported)
+ * @note   Example usage, switching the data bus direction:
+ *         static const GPIO_ModeTokenType busIn  = GPIO_MODE_TOKEN(0x00FF, GPIO_MODE_INPUT);
+ *         static const GPIO_ModeTokenType busOut = GPIO_MODE_TOKEN(0x00FF, GPIO_MODE_OUTPUT);
+ */
+#define GPIO_MODE_TOKEN(PINS, MODE)         \
+    {   .Mask  = GPIO_PINS_FIELDS(PINS) * 3,  \
+        .MODER = GPIO_PINS_FIELDS(PINS) * ((uint32_t)(MODE) & 3) }
+
+/**
+ * @brief  Spreads the pin mask bits to the LSB of the 2-bit register fields of the pins.
+ * @param  PINS: bit mask of the pins of the port
+ */
+#define GPIO_PINS_FIELDS(PINS)              \
+    ((((uint32_t)(PINS) & 0x0001)     ) | (((uint32_t)(PINS) & 0x0002) << 1) | \
+     (((uint32_t)(PINS) & 0x0004) << 2) | (((uint32_t)(PINS) & 0x0008) << 3) | \
+     (((uint32_t)(PINS) & 0x0010) << 4) | (((uint32_t)(PINS) & 0x0020) << 5) | \
+     (((uint32_t)(PINS) & 0x0040) << 6) | (((uint32_t)(PINS) & 0x0080) << 7) | \
+     (((uint32_t)(PINS) & 0x0100) << 8) | (((uint32_t)(PINS) & 0x0200) << 9) | \
+     (((uint32_t)(PINS) & 0x0400) << 10) | (((uint32_t)(PINS) & 0x0800) << 11) | \
+     (((uint32_t)(PINS) & 0x1000) << 12) | (((uint32_t)(PINS) & 0x2000) << 13) | \
+     (((uint32_t)(PINS) & 0x4000) << 14) | (((uint32_t)(PINS) & 0x8000) << 15))
+
 /** @} */
 
 /** @addtogroup GPIO_Alternate_function_map
@@ -89,6 +220,12 @@ typedef struct
 /** @addtogroup GPIO_Exported_Functions_Port
  * @{ */
 void            XPD_GPIO_InitPort   (GPIO_TypeDef * GPIOx, const GPIO_InitType * Config);
+void            XPD_GPIO_InitPortConfig(const GPIO_PortConfigType * Config);
+/** @} */
+
+/** @addtogroup GPIO_Exported_Functions_Mode
+ * @{ */
+void            XPD_GPIO_InitModeToken(GPIO_ModeTokenType * Token, uint16_t Pins, GPIO_ModeType Mode);
 /** @} */
 
 /** @addtogroup GPIO_Exported_Functions_Pin
@@ -96,6 +233,8 @@ void            XPD_GPIO_InitPort   (GPIO_TypeDef * GPIOx, const GPIO_InitType *
 void            XPD_GPIO_InitPin    (GPIO_TypeDef * GPIOx, uint8_t Pin, const GPIO_InitType * Config);
 void            XPD_GPIO_DeinitPin  (GPIO_TypeDef * GPIOx, uint8_t Pin);
 void            XPD_GPIO_LockPin    (GPIO_TypeDef * GPIOx, uint8_t Pin);
+
+void            XPD_GPIO_InitPinMap (const GPIO_PinMapType * PinMap, uint8_t Count);
 /** @} */
 
 /** @addtogroup GPIO_Exported_Functions_Port
@@ -133,6 +272,49 @@ __STATIC_INLINE void XPD_GPIO_SetResetPort(GPIO_TypeDef * GPIOx, uint16_t SetBit
 
 /** @} */
 
+/** @addtogroup GPIO_Exported_Functions_Mode
+ * @{ */
+
+/**
+ * @brief Switches the mode of the token's pins with a single register modification.
+ *        The output type, speed, pull and alternate function settings of the pins
+ *        are retained from their initialization.
+ * @note  The modification isn't atomic, the mode of the other pins of the port
+ *        shall not be changed from a preempting context.
+ * @param GPIOx: pointer to the GPIO peripheral
+ * @param Token: the mode switching token of the pins
+ */
+__STATIC_INLINE void XPD_GPIO_SwitchMode(GPIO_TypeDef * GPIOx, const GPIO_ModeTokenType * Token)
+{
+    GPIOx->MODER = (GPIOx->MODER & ~Token->Mask) | Token->MODER;
+}
+
+/**
+ * @brief Calculates the mode register value of the whole port with the token applied
+ *        to the current modes, for switching with @ref XPD_GPIO_WritePortMode.
+ * @param GPIOx: pointer to the GPIO peripheral
+ * @param Token: the mode switching token of the pins
+ * @return The mode register value of the port
+ */
+__STATIC_INLINE uint32_t XPD_GPIO_GetPortMode(GPIO_TypeDef * GPIOx, const GPIO_ModeTokenType * Token)
+{
+    return (GPIOx->MODER & ~Token->Mask) | Token->MODER;
+}
+
+/**
+ * @brief Switches the mode of all pins of the port with a single register write.
+ * @note  The value shall be calculated by @ref XPD_GPIO_GetPortMode after the last
+ *        mode change of the pins which aren't switched by the token.
+ * @param GPIOx: pointer to the GPIO peripheral
+ * @param Modes: the mode register value of the port
+ */
+__STATIC_INLINE void XPD_GPIO_WritePortMode(GPIO_TypeDef * GPIOx, uint32_t Modes)
+{
+    GPIOx->MODER = Modes;
+}
+
+/** @} */
+
 /** @addtogroup GPIO_Exported_Functions_Pin
  * @{ */
 
@@ -193,4 +375,8 @@ __STATIC_INLINE void XPD_GPIO_TogglePin(GPIO_TypeDef * GPIOx, uint8_t Pin)
 
 /** @} */
 
+#ifdef __cplusplus
+}
+#endif
+
 #endif /* __XPD_GPIO_H_ */
@@ -27,9 +27,37 @@
 #include "xpd_common.h"
 #include "xpd_config.h"
 
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
 /** @defgroup NVIC
  * @{ */
 
+/** @defgroup NVIC_Exported_Types NVIC Exported Types
+ * @{ */
+
+/** @brief NVIC interrupt priority table entry */
+typedef struct
+{
+    IRQn_Type    IRQn;          /*!< The interrupt line */
+    uint8_t      Preemption;    /*!< The preemption priority value */
+    uint8_t      Sub;           /*!< The subpriority value */
+    const char * Handler;       /*!< The name of the profiled handler function serving the line
+                                     (e.g. "XPD_USART_IRQHandler"), used by the latency report (can be NULL) */
+    uint32_t     Budget;        /*!< The tolerated worst-case latency of the line in profiling ticks (0 for no limit) */
+}NVIC_PriorityConfigType;
+
+/** @brief NVIC interrupt preemption requirement */
+typedef struct
+{
+    IRQn_Type    Producer;      /*!< The interrupt line which has to preempt the consumer (e.g. DMA stream) */
+    IRQn_Type    Consumer;      /*!< The interrupt line which depends on the producer (e.g. USART) */
+}NVIC_PriorityOrderType;
+
+/** @} */
+
 /** @defgroup NVIC_Exported_Macros NVIC Exported Macros
  * @{ */
 
@@ -73,7 +101,7 @@
  * @param  IRQN: the selected @ref IRQn_Type line to disable
  */
 #define         XPD_NVIC_DisableIRQ(IRQN)                                   \
-    NVIC_EnableIRQ(IRQN)
+    NVIC_DisableIRQ(IRQN)
 
 /**
  * @brief  NVIC interrupt priority configuration setting macro.
@@ -90,8 +118,40 @@
 #define         XPD_SystemReset()                                           \
     NVIC_SystemReset()
 
+#ifdef USE_XPD_IRQ_REGISTRY
+#ifndef XPD_NVIC_HANDLER_COUNT
+/**
+ * @brief  The number of interrupt lines which can be served from the handler registry. [overrideable]
+ */
+#define XPD_NVIC_HANDLER_COUNT  8
+#endif
+#endif
+
+/** @} */
+
+
+/** @addtogroup NVIC_Exported_Functions
+ * @{ */
+uint32_t        XPD_NVIC_GetPreemptPriority (IRQn_Type IRQn);
+
+void            XPD_NVIC_InitPriorities     (const NVIC_PriorityConfigType * Table, uint8_t Count);
+XPD_ReturnType  XPD_NVIC_CheckPriorityOrder (const NVIC_PriorityOrderType * Order, uint8_t Count,
+                                             uint8_t * FailedIndex);
+
+#ifdef USE_XPD_IRQ_REGISTRY
+XPD_ReturnType  XPD_NVIC_InitVectorTable    (uint32_t * Table, uint16_t Count);
+
+XPD_ReturnType  XPD_NVIC_RegisterHandler    (IRQn_Type IRQn, XPD_HandleCallbackType Handler, void * Handle);
+void            XPD_NVIC_UnregisterHandler  (IRQn_Type IRQn);
+
+void            XPD_NVIC_IRQHandler         (void);
+#endif
 /** @} */
 
 /** @} */
 
+#ifdef __cplusplus
+}
+#endif
+
 #endif /* __XPD_NVIC_H_ */
@@ -0,0 +1,125 @@
+/**
+  ******************************************************************************
+  * @file    xpd_os.h
+  * @author  Benedek Kupper
+  * @version V0.1
+  * @date    2018-01-20
+  * @brief   STM32 eXtensible Peripheral Drivers Operating System Abstraction Module
+  *
+  *  This file is part of STM32_XPD.
+  *
+  *  STM32_XPD is free software: you can redistribute it and/or modify
+  *  it under the terms of the GNU General Public License as published by
+  *  the Free Software Foundation, either version 3 of the License, or
+  *  (at your option) any later version.
+  *
+  *  STM32_XPD is distributed in the hope that it will be useful,
+  *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with STM32_XPD.  If not, see <http://www.gnu.org/licenses/>.
+  */
+#ifndef __XPD_OS_H_
+#define __XPD_OS_H_
+
+#include "xpd_common.h"
+#include "xpd_config.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/** @defgroup XPD_OS XPD Operating System Abstraction
+ * @{ */
+
+#ifdef USE_XPD_OS
+/** @defgroup XPD_OS_Exported_Types XPD OS Exported Types
+ * @{ */
+
+/** @brief XPD OS signal structure, which wakes up the task waiting in a _Blocking driver function */
+typedef struct
+{
+    void *            Object;       /*!< The OS object of the waiting (e.g. the task or semaphore handle) */
+    volatile uint32_t Posted;       /*!< [Internal] The signal has been posted since the last wait */
+}XPD_OS_SignalType;
+
+/** @} */
+
+/** @defgroup XPD_OS_Exported_Macros XPD OS Exported Macros
+ * @{ */
+
+/**
+ * @brief Posts the signal from the transfer completion context.
+ * @param SIGNAL: the @ref XPD_OS_SignalType structure
+ */
+#define XPD_OS_SIGNAL(SIGNAL)       XPD_OS_SignalPost(&(SIGNAL))
+
+/** @} */
+
+/** @addtogroup XPD_OS_Exported_Functions
+ * @{ */
+
+/** @defgroup XPD_OS_Exported_Functions_Signal XPD OS Signal Functions
+ *  @brief    Task blocking hooks of the driver _Blocking functions
+ *  @details  The default implementations busy-wait on the signal, the RTOS port
+ *            has to override them to put the waiting task to sleep, e.g. with FreeRTOS:
+ *  @code
+    void XPD_OS_SignalInit(XPD_OS_SignalType * Signal)
+    {
+        Signal->Posted = 0;
+        Signal->Object = xTaskGetCurrentTaskHandle();
+        (void) ulTaskNotifyTake(pdTRUE, 0);
+    }
+
+    void XPD_OS_SignalPost(XPD_OS_SignalType * Signal)
+    {
+        BaseType_t woken = pdFALSE;
+        Signal->Posted = 1;
+        if (Signal->Object != NULL)
+        {
+            vTaskNotifyGiveFromISR(Signal->Object, &woken);
+            portYIELD_FROM_ISR(woken);
+        }
+    }
+
+    XPD_ReturnType XPD_OS_SignalWait(XPD_OS_SignalType * Signal, uint32_t * Timeout)
+    {
+        TickType_t start = xTaskGetTickCount();
+        while (Signal->Posted == 0)
+        {
+            TickType_t elapsed = xTaskGetTickCount() - start;
+            if ((elapsed >= pdMS_TO_TICKS(*Timeout)) ||
+                (ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(*Timeout) - elapsed) == 0))
+            {
+                *Timeout = 0;
+                return XPD_TIMEOUT;
+            }
+        }
+        *Timeout -= (xTaskGetTickCount() - start) * portTICK_PERIOD_MS;
+        Signal->Posted = 0;
+        return XPD_OK;
+    }
+ *  @endcode
+ * @{
+ */
+void            XPD_OS_SignalInit       (XPD_OS_SignalType * Signal);
+void            XPD_OS_SignalPost       (XPD_OS_SignalType * Signal);
+XPD_ReturnType  XPD_OS_SignalWait       (XPD_OS_SignalType * Signal, uint32_t * Timeout);
+/** @} */
+
+/** @} */
+
+#else
+#define XPD_OS_SIGNAL(SIGNAL)
+#endif /* USE_XPD_OS */
+
+/** @} */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __XPD_OS_H_ */
@@ -24,6 +24,11 @@
 #ifndef __XPD_RCC_CRS_H_
 #define __XPD_RCC_CRS_H_
 
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
 #ifdef CRS
 
 /** @addtogroup RCC
@@ -59,6 +64,15 @@ typedef enum
     CRS_TRIMMING_OVF  = CRS_ISR_TRIMOVF,    /*!< the automatic trimming tries to over- or under-flow the TRIM value */
 }CRS_StatusType;
 
+/** @brief CRS synchronization convergence states */
+typedef enum
+{
+    CRS_STATE_OFF      = 0, /*!< The synchronization is not monitored */
+    CRS_STATE_SEARCH   = 1, /*!< SYNC events are missing or out of the trimming range */
+    CRS_STATE_TRIMMING = 2, /*!< The frequency error is in the warning range, the trimming converges */
+    CRS_STATE_LOCKED   = 3, /*!< The frequency error is consistently in the OK range */
+}CRS_SyncStateType;
+
 /** @brief HSI48 setup structure */
 typedef struct
 {
@@ -93,6 +107,16 @@ typedef struct
 /** @brief Default HSI48 calibration value (step is around 67 kHz) */
 #define HSI48_CALIBRATION_DEFAULT_VALUE 0x20
 
+#ifndef CRS_HISTORY_SIZE
+/** @brief Number of recorded frequency error captures (power of two) */
+#define CRS_HISTORY_SIZE                16
+#endif
+
+#ifndef CRS_LOCK_COUNT
+/** @brief Number of consecutive SYNC OK events required to consider the HSI48 locked */
+#define CRS_LOCK_COUNT                  8
+#endif
+
 /**
  * @brief  Enable the specified CRS interrupt.
  * @param  IT_NAME: specifies the interrupt to enable.
@@ -156,6 +180,11 @@ XPD_ReturnType  XPD_CRS_PollStatus              (CRS_StatusType * Status, uint32
 CRS_StatusType  XPD_CRS_GetStatus               (void);
 void            XPD_CRS_IRQHandler              (void);
 
+void            XPD_CRS_Sync_Start              (void);
+void            XPD_CRS_Sync_Stop               (void);
+CRS_SyncStateType XPD_CRS_GetSyncState          (void);
+uint8_t         XPD_CRS_GetErrorHistory         (int32_t * History, uint8_t Count);
+
 /**
  * @brief Generates a software synchronization event.
  */
@@ -190,4 +219,8 @@ __STATIC_INLINE void XPD_CRS_AutoCalibration(FunctionalState NewState)
 
 #endif /* CRS */
 
+#ifdef __cplusplus
+}
+#endif
+
 #endif /* __XPD_RCC_CRS_H_ */
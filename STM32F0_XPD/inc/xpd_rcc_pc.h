@@ -147,6 +147,23 @@ uint32_t        XPD_RTC_GetClockFreq        (void);
 
 /** @} */
 
+#elif defined(XPD_SPI_API)
+
+/** @addtogroup SPI
+ * @{ */
+
+/** @defgroup SPI_Clock_Source SPI Clock Source
+ * @{ */
+
+/** @addtogroup SPI_Clock_Source_Exported_Functions
+ * @{ */
+uint32_t        XPD_SPI_GetClockFreq        (SPI_HandleType * hspi);
+/** @} */
+
+/** @} */
+
+/** @} */
+
 #elif defined(XPD_TIM_API)
 
 /** @addtogroup TIM
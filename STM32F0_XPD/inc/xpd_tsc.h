@@ -0,0 +1,182 @@
+/**
+  ******************************************************************************
+  * @file    xpd_tsc.h
+  * @author  Benedek Kupper
+  * @version V0.1
+  * @date    2018-01-20
+  * @brief   STM32 eXtensible Peripheral Drivers Touch Sensing Controller Module
+  *
+  *  This file is part of STM32_XPD.
+  *
+  *  STM32_XPD is free software: you can redistribute it and/or modify
+  *  it under the terms of the GNU General Public License as published by
+  *  the Free Software Foundation, either version 3 of the License, or
+  *  (at your option) any later version.
+  *
+  *  STM32_XPD is distributed in the hope that it will be useful,
+  *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with STM32_XPD.  If not, see <http://www.gnu.org/licenses/>.
+  */
+#ifndef __XPD_TSC_H_
+#define __XPD_TSC_H_
+
+#include "xpd_common.h"
+#include "xpd_config.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#ifdef TSC
+
+/** @defgroup TSC
+ *  @brief    Charge transfer touch sensing with hardware acquisition
+ *  @details  All I/O groups are acquired in parallel, one channel per group at a time.
+ *            The sensors are distributed to acquisition banks so that each bank contains
+ *            at most one channel of every group, and a scan acquires all banks one after the other.
+ *            The raw counts are filtered, and the touch is detected against a tracked baseline:
+ *  @code
+    static TSC_SensorType keys[] = {
+        { .Group = 1, .IO = 2, .Threshold = 40, .Hysteresis = 10 },
+        { .Group = 1, .IO = 3, .Threshold = 40, .Hysteresis = 10 },
+        { .Group = 2, .IO = 2, .Threshold = 40, .Hysteresis = 10 },
+    };
+
+    XPD_TSC_Init(&htsc, &config);
+    // IO1 of group 1 and 2 have the sampling capacitors
+    XPD_TSC_SensorConfig(&htsc, TSC_GROUP_IO(1, 1) | TSC_GROUP_IO(2, 1), keys, 3);
+    XPD_TSC_Start_IT(&htsc); // in each scan period, e.g. from a timer
+ *  @endcode
+ * @{ */
+
+/** @defgroup TSC_Exported_Types TSC Exported Types
+ * @{ */
+
+/** @brief TSC maximum count values */
+typedef enum
+{
+    TSC_MAXCOUNT_255   = 0, /*!< 255 charge transfer cycles */
+    TSC_MAXCOUNT_511   = 1, /*!< 511 charge transfer cycles */
+    TSC_MAXCOUNT_1023  = 2, /*!< 1023 charge transfer cycles */
+    TSC_MAXCOUNT_2047  = 3, /*!< 2047 charge transfer cycles */
+    TSC_MAXCOUNT_4095  = 4, /*!< 4095 charge transfer cycles */
+    TSC_MAXCOUNT_8191  = 5, /*!< 8191 charge transfer cycles */
+    TSC_MAXCOUNT_16383 = 6, /*!< 16383 charge transfer cycles */
+}TSC_MaxCountType;
+
+/** @brief TSC setup structure */
+typedef struct
+{
+    uint8_t PulseHigh;              /*!< Charge transfer pulse high duration in pulse generator cycles [1..16] */
+    uint8_t PulseLow;               /*!< Charge transfer pulse low duration in pulse generator cycles [1..16] */
+    uint8_t Prescaler;              /*!< Pulse generator clock is HCLK / 2^Prescaler [0..7] */
+    TSC_MaxCountType MaxCount;      /*!< Maximum number of charge transfer cycles of an acquisition */
+    uint8_t SpreadSpectrum;         /*!< Spread spectrum deviation in spread spectrum clock cycles [1..128],
+                                         0 to disable */
+    uint8_t FilterShift;            /*!< Raw count filter strength, the new sample weight is 1 / 2^FilterShift */
+    uint8_t BaselineShift;          /*!< Baseline tracking speed, the new value weight is 1 / 2^BaselineShift */
+}TSC_InitType;
+
+/** @brief TSC sensor structure */
+typedef struct
+{
+    uint8_t Group;                  /*!< The I/O group of the sensor channel [1..8] */
+    uint8_t IO;                     /*!< The I/O of the sensor channel within the group [1..4] */
+    uint16_t Threshold;             /*!< Touch detection level of the count decrease from the baseline */
+    uint16_t Hysteresis;            /*!< Release detection is this much below the threshold */
+    uint16_t Raw;                   /*!< The latest acquired count */
+    uint16_t Delta;                 /*!< The filtered count decrease from the baseline */
+    uint8_t Touched;                /*!< The sensor is touched */
+    uint8_t Bank;                   /*!< [Internal] The acquisition bank of the sensor */
+    uint32_t Filtered;              /*!< [Internal] The filtered count (in 1/16 units) */
+    uint32_t Baseline;              /*!< [Internal] The untouched count (in 1/16 units), 0 until the first acquisition */
+}TSC_SensorType;
+
+/** @brief TSC Handle structure */
+typedef struct
+{
+    TSC_TypeDef * Inst;                      /*!< The address of the peripheral instance used by the handle */
+    XPD_CtrlFnType ClockCtrl;                /*!< Function pointer for RCC clock control */
+    struct {
+        XPD_HandleCallbackType DepInit;      /*!< Callback to initialize module dependencies (GPIOs, IRQs) */
+        XPD_HandleCallbackType DepDeinit;    /*!< Callback to restore module dependencies (GPIOs, IRQs) */
+        XPD_HandleCallbackType Scan;         /*!< Scan of all sensors finished callback */
+        XPD_HandleCallbackType Change;       /*!< Touch state of any sensor changed callback */
+        XPD_HandleCallbackType Error;        /*!< Max count error callback, the affected sensors are not updated */
+    }Callbacks;                              /*   Handle Callbacks */
+    TSC_SensorType * Sensors;                /*!< [Internal] The sensors array */
+    uint8_t SensorCount;                     /*!< [Internal] The number of sensors */
+    uint8_t BankCount;                       /*!< [Internal] The number of acquisition banks */
+    volatile uint8_t Bank;                   /*!< [Internal] The currently acquired bank */
+    uint8_t FilterShift;                     /*!< [Internal] Raw count filter strength */
+    uint8_t BaselineShift;                   /*!< [Internal] Baseline tracking speed */
+    uint32_t Banks[3];                       /*!< [Internal] The channel selection of each bank */
+}TSC_HandleType;
+
+/** @} */
+
+/** @defgroup TSC_Exported_Macros TSC Exported Macros
+ * @{ */
+
+/**
+ * @brief  TSC Handle initializer macro
+ * @param  INSTANCE: specifies the TSC peripheral instance.
+ * @param  INIT_FN: specifies the dependency initialization function to call back.
+ * @param  DEINIT_FN: specifies the dependency deinitialization function to call back.
+ */
+#define         NEW_TSC_HANDLE(INSTANCE, INIT_FN, DEINIT_FN)    \
+    {.Inst = (INSTANCE),                                        \
+     .ClockCtrl = XPD_##INSTANCE##_ClockCtrl,                   \
+     .Callbacks.DepInit   = (INIT_FN),                          \
+     .Callbacks.DepDeinit = (DEINIT_FN)}
+
+/**
+ * @brief  Provides the I/O selection mask of a group I/O.
+ * @param  GROUP: the I/O group [1..8]
+ * @param  IO: the I/O within the group [1..4]
+ */
+#define         TSC_GROUP_IO(GROUP, IO)                         \
+    (1UL << ((((GROUP) - 1) * 4) + ((IO) - 1)))
+
+/**
+ * @brief  Determines whether a scan is in progress.
+ * @param  HANDLE: specifies the TSC Handle.
+ */
+#define         XPD_TSC_IsScanning(HANDLE)                      \
+    ((HANDLE)->Inst->IER.w != 0)
+
+/** @} */
+
+/** @addtogroup TSC_Exported_Functions
+ * @{ */
+void            XPD_TSC_Init                (TSC_HandleType * htsc, const TSC_InitType * Config);
+void            XPD_TSC_Deinit              (TSC_HandleType * htsc);
+
+XPD_ReturnType  XPD_TSC_SensorConfig        (TSC_HandleType * htsc, uint32_t Samplings,
+                                             TSC_SensorType * Sensors, uint8_t Count);
+
+XPD_ReturnType  XPD_TSC_Start_IT            (TSC_HandleType * htsc);
+void            XPD_TSC_Stop_IT             (TSC_HandleType * htsc);
+
+void            XPD_TSC_IRQHandler          (TSC_HandleType * htsc);
+/** @} */
+
+/** @} */
+
+#endif /* TSC */
+
+#define XPD_TSC_API
+#include "xpd_rcc_gen.h"
+#include "xpd_rcc_pc.h"
+#undef XPD_TSC_API
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __XPD_TSC_H_ */
@@ -70,6 +70,82 @@ static void adc_dmaErrorRedirect(void *hdma)
 }
 #endif
 
+static void adc_dmaHalfBlockRedirect(void *hdma)
+{
+    ADC_HandleType* hadc = (ADC_HandleType*) ((DMA_HandleType*) hdma)->Owner;
+
+    /* The first half of the double buffer is filled */
+    hadc->Block.buffer = (void*)((DMA_HandleType*) hdma)->Inst->CMAR;
+
+    XPD_SAFE_CALLBACK(hadc->Callbacks.BlockReady, hadc);
+}
+
+static void adc_dmaBlockRedirect(void *hdma)
+{
+    ADC_HandleType* hadc = (ADC_HandleType*) ((DMA_HandleType*) hdma)->Owner;
+
+    /* The second half of the double buffer is filled */
+    hadc->Block.buffer = (uint8_t*)((DMA_HandleType*) hdma)->Inst->CMAR
+            + hadc->Block.length * hadc->Block.size;
+
+    XPD_SAFE_CALLBACK(hadc->Callbacks.BlockReady, hadc);
+}
+
+static void adc_dmaCaptureRedirect(void *hdma)
+{
+    ADC_HandleType* hadc = (ADC_HandleType*) ((DMA_HandleType*) hdma)->Owner;
+
+    /* The post-trigger conversions are stored */
+    XPD_ADC_Stop_DMA(hadc);
+    XPD_DMA_CircularMode(hadc->DMA.Conversion) = 1;
+
+    XPD_SAFE_CALLBACK(hadc->Callbacks.BlockReady, hadc);
+}
+
+/* Redirects the circular capture transfer to stop after the post-trigger conversions */
+static void adc_captureTrigger(ADC_HandleType * hadc)
+{
+    if (hadc->Capture.Armed != 0)
+    {
+        DMA_HandleType * hdma = hadc->DMA.Conversion;
+        uint16_t index, count;
+
+        hadc->Capture.Armed = 0;
+        XPD_ADC_DisableIT(hadc, AWD1);
+
+        /* Freeze the circular transfer at the current position */
+        XPD_DMA_Stop_IT(hdma);
+        index = (hadc->Block.length - hdma->Inst->CNDTR) % hadc->Block.length;
+        XPD_DMA_CircularMode(hdma) = 0;
+
+        hadc->Capture.Trigger = index;
+        hadc->Capture.Start   = (index + hadc->Capture.PostTrigger) % hadc->Block.length;
+
+        /* The post-trigger conversions overwrite the oldest ones, wrapping at the buffer end */
+        count = hadc->Block.length - index;
+        if (count > hadc->Capture.PostTrigger)
+        {
+            count = hadc->Capture.PostTrigger;
+        }
+        hadc->Capture.Blocks[0].MemAddress = (uint8_t*)hadc->Block.buffer + index * hadc->Block.size;
+        hadc->Capture.Blocks[0].DataCount  = count;
+        hadc->Capture.Blocks[1].MemAddress = hadc->Block.buffer;
+        hadc->Capture.Blocks[1].DataCount  = hadc->Capture.PostTrigger - count;
+
+        hdma->Callbacks.Complete = adc_dmaCaptureRedirect;
+
+        if (count == 0)
+        {
+            adc_dmaCaptureRedirect(hdma);
+        }
+        else
+        {
+            (void) XPD_DMA_StartChain_IT(hdma, (void *)&hadc->Inst->DR, hadc->Capture.Blocks,
+                    (hadc->Capture.Blocks[1].DataCount > 0) ? 2 : 1);
+        }
+    }
+}
+
 /* Enables the peripheral */
 static boolean_t adcx_enable(ADC_TypeDef * ADCx)
 {
@@ -464,6 +540,8 @@ void XPD_ADC_Stop_IT(ADC_HandleType * hadc)
  */
 void XPD_ADC_IRQHandler(ADC_HandleType * hadc)
 {
+    XPD_PROFILE_BEGIN();
+
     uint32_t isr = hadc->Inst->ISR.w;
     uint32_t ier = hadc->Inst->IER.w;
 
@@ -495,6 +573,8 @@ void XPD_ADC_IRQHandler(ADC_HandleType * hadc)
     if (    ((isr & ADC_ISR_AWD1) != 0)
          && ((ier & ADC_IER_AWD1IE) != 0))
     {
+        adc_captureTrigger(hadc);
+
         /* watchdog callback */
         XPD_SAFE_CALLBACK(hadc->Callbacks.Watchdog, hadc);
 
@@ -518,6 +598,8 @@ void XPD_ADC_IRQHandler(ADC_HandleType * hadc)
         XPD_SAFE_CALLBACK(hadc->Callbacks.Error, hadc);
     }
 #endif
+
+    XPD_PROFILE_END();
 }
 
 /**
@@ -582,6 +664,168 @@ void XPD_ADC_Stop_DMA(ADC_HandleType * hadc)
     XPD_DMA_Stop_IT(hadc->DMA.Conversion);
 }
 
+/**
+ * @brief Sets the data widths of the conversion DMA to store each reduced resolution conversion
+ *        in a single byte, so the DMA buffers hold twice as many conversions.
+ * @note  The packed conversions have 8 bit range if the ADC is initialized with 8 bit resolution
+ *        right-aligned, or 6 bit resolution left-aligned (the left-aligned 8 bit data is in the
+ *        upper byte of the data register).
+ *        This function shall be called while the conversion DMA is not running.
+ * @param hadc: pointer to the ADC handle structure
+ * @param NewState: ENABLE for byte storage, DISABLE for the default half word storage
+ * @return ERROR if the conversion data doesn't fit in a byte, OK otherwise
+ */
+XPD_ReturnType XPD_ADC_DMA_BytePacking(ADC_HandleType * hadc, FunctionalState NewState)
+{
+    XPD_ReturnType result = XPD_OK;
+
+    if (NewState == DISABLE)
+    {
+        XPD_DMA_SetDataAlignment(hadc->DMA.Conversion, DMA_ALIGN_HALFWORD, DMA_ALIGN_HALFWORD);
+    }
+    else if ((hadc->Inst->CFGR1.b.RES == ADC_RESOLUTION_6BIT) ||
+            ((hadc->Inst->CFGR1.b.RES == ADC_RESOLUTION_8BIT) && (ADC_REG_BIT(hadc, CFGR1, ALIGN) == 0)))
+    {
+        /* Only the low byte of the read half word is stored */
+        XPD_DMA_SetDataAlignment(hadc->DMA.Conversion, DMA_ALIGN_HALFWORD, DMA_ALIGN_BYTE);
+    }
+    else
+    {
+        result = XPD_ERROR;
+    }
+    return result;
+}
+
+/**
+ * @brief Starts continuous DMA-managed streaming of the ADC regular conversions
+ *        into a double buffer. The BlockReady callback is called each time a block is filled,
+ *        the filled block is available in the handle's Block stream while the DMA fills the other.
+ * @note  The conversions shall be triggered by a timer (see @ref XPD_TIM_MasterConfig)
+ *        for a constant sampling rate. The conversion DMA must be initialized in circular mode.
+ *        The streaming is stopped by @ref XPD_ADC_Stop_DMA.
+ * @param hadc: pointer to the ADC handle structure
+ * @param Buffer: memory address of the double buffer, which has the storage for two blocks
+ * @param BlockSize: the number of conversions in a single block
+ * @return ERROR if the DMA is not circular, BUSY if the DMA is in use, OK if successful
+ */
+XPD_ReturnType XPD_ADC_Stream_Start(ADC_HandleType * hadc, void * Buffer, uint16_t BlockSize)
+{
+    XPD_ReturnType result = XPD_ERROR;
+
+    /* The double buffer is continuously filled by circular DMA */
+    if (XPD_DMA_CircularMode(hadc->DMA.Conversion) != 0)
+    {
+        hadc->Block.length = BlockSize;
+        hadc->Block.size   = 1 << hadc->DMA.Conversion->Inst->CCR.b.MSIZE;
+
+        /* Set up DMA for transfer */
+        result = XPD_DMA_Start_IT(hadc->DMA.Conversion,
+                (void *)&hadc->Inst->DR, Buffer, 2 * BlockSize);
+    }
+
+    if (result == XPD_OK)
+    {
+        /* Set the callback owner */
+        hadc->DMA.Conversion->Owner = hadc;
+
+        /* Set the DMA transfer callbacks */
+        hadc->DMA.Conversion->Callbacks.HalfComplete = adc_dmaHalfBlockRedirect;
+        hadc->DMA.Conversion->Callbacks.Complete     = adc_dmaBlockRedirect;
+#ifdef USE_XPD_DMA_ERROR_DETECT
+        hadc->DMA.Conversion->Callbacks.Error        = adc_dmaErrorRedirect;
+#endif
+        XPD_DMA_EnableIT(hadc->DMA.Conversion, HT);
+
+#ifdef USE_XPD_ADC_ERROR_DETECT
+        /* Enable ADC overrun interrupt */
+        XPD_ADC_EnableIT(hadc, OVR);
+#endif
+
+        /* Enable ADC DMA mode with continuous requests */
+        ADC_REG_BIT(hadc, CFGR1, DMACFG) = 1;
+        ADC_REG_BIT(hadc, CFGR1, DMAEN)  = 1;
+
+        XPD_ADC_Start(hadc);
+    }
+
+    return result;
+}
+
+/**
+ * @brief Starts the watchdog triggered capture of the ADC regular conversions.
+ *        The conversions are continuously stored in a circular buffer until the selected
+ *        analog watchdog is triggered, after which only the requested number of conversions
+ *        is stored. The buffer then contains a contiguous window of conversions before and after
+ *        the trigger, starting at the Capture.Start index (wrapping at the buffer end),
+ *        and the BlockReady callback is called.
+ * @note  The conversions shall be triggered by a timer (see @ref XPD_TIM_MasterConfig)
+ *        for a constant sampling rate. The watchdog has to be configured beforehand,
+ *        and its interrupt is enabled until the trigger. The Capture.Trigger index is the
+ *        first conversion stored after the watchdog interrupt is serviced.
+ *        The capture is stopped by @ref XPD_ADC_Stop_DMA.
+ * @param hadc: pointer to the ADC handle structure
+ * @param Watchdog: the analog watchdog which triggers the capture
+ * @param Buffer: memory address of the circular capture buffer
+ * @param Length: the number of conversions in the buffer
+ * @param PostTrigger: the number of conversions stored after the trigger [0 .. Length]
+ * @return ERROR if the input is invalid, BUSY if the DMA is in use, OK if successful
+ */
+XPD_ReturnType XPD_ADC_Capture_Start(ADC_HandleType * hadc, ADC_WatchdogType Watchdog,
+        void * Buffer, uint16_t Length, uint16_t PostTrigger)
+{
+    XPD_ReturnType result = XPD_ERROR;
+    DMA_HandleType * hdma = hadc->DMA.Conversion;
+
+    if ((Watchdog != ADC_AWD_NONE) && (PostTrigger <= Length))
+    {
+        result = XPD_BUSY;
+    }
+    if ((result == XPD_BUSY) && (XPD_DMA_GetStatus(hdma) == 0))
+    {
+        /* The pre-trigger conversions are continuously stored by circular DMA */
+        XPD_DMA_CircularMode(hdma) = 1;
+
+        hadc->Block.buffer  = Buffer;
+        hadc->Block.length  = Length;
+        hadc->Block.size    = 1 << hdma->Inst->CCR.b.MSIZE;
+        hadc->Capture.PostTrigger = PostTrigger;
+        hadc->Capture.Trigger     = 0;
+        hadc->Capture.Start       = 0;
+
+        /* Set the callback owner */
+        hdma->Owner = hadc;
+
+        /* Set the DMA transfer callbacks */
+        hdma->Callbacks.HalfComplete = NULL;
+        hdma->Callbacks.Complete     = NULL;
+#ifdef USE_XPD_DMA_ERROR_DETECT
+        hdma->Callbacks.Error        = adc_dmaErrorRedirect;
+#endif
+
+        /* Set up DMA for transfer */
+        result = XPD_DMA_Start_IT(hdma, (void *)&hadc->Inst->DR, Buffer, Length);
+    }
+
+    if (result == XPD_OK)
+    {
+        hadc->Capture.Armed = 1;
+        XPD_ADC_EnableIT(hadc, AWD1);
+
+#ifdef USE_XPD_ADC_ERROR_DETECT
+        /* Enable ADC overrun interrupt */
+        XPD_ADC_EnableIT(hadc, OVR);
+#endif
+
+        /* Enable ADC DMA mode with continuous requests */
+        ADC_REG_BIT(hadc, CFGR1, DMACFG) = 1;
+        ADC_REG_BIT(hadc, CFGR1, DMAEN)  = 1;
+
+        XPD_ADC_Start(hadc);
+    }
+
+    return result;
+}
+
 /**
  * @brief Initializes the analog watchdog using the setup configuration.
  * @param hadc: pointer to the ADC handle structure
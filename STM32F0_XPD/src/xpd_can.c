@@ -22,6 +22,7 @@
   *  along with STM32_XPD.  If not, see <http://www.gnu.org/licenses/>.
   */
 #include "xpd_can.h"
+#include "xpd_rcc.h"
 #include "xpd_utils.h"
 
 #ifdef USE_XPD_CAN
@@ -48,6 +49,16 @@
 #define CAN_RECEIVE1_INTERRUPTS  CAN_IER_FMPIE1
 #define CAN_TRANSMIT_INTERRUPTS  CAN_IER_TMEIE
 
+/* Bus-off recovery progress */
+#define CAN_RECOVERY_NONE        0
+#define CAN_RECOVERY_BACKOFF     1
+#define CAN_RECOVERY_INIT        2
+#define CAN_RECOVERY_REJOIN      3
+
+/* Statistics error counter flags beside the error states */
+#define CAN_STATS_FIFO_OVERRUN   0x08
+#define CAN_STATS_PROTOCOL_ERROR 0x10
+
 #if defined(CAN3)
 #define CAN_MASTER(HANDLE)                                      \
     (((HANDLE)->Inst == CAN3) ? CAN3 : CAN1)
@@ -123,6 +134,23 @@ __STATIC_INLINE XPD_ReturnType can_getEmptyMailbox(CAN_HandleType * hcan, uint8_
     return result;
 }
 
+/**
+ * @brief Gets the identifier register value of the frame, which is also its arbitration field:
+ *        lower values win the bus arbitration.
+ * @param Frame: pointer to the frame
+ * @return The transmit identifier register value
+ */
+__STATIC_INLINE uint32_t can_frameArbitration(const CAN_FrameType * Frame)
+{
+    uint32_t temp = 3;
+
+    if ((Frame->Id.Type & CAN_IDTYPE_EXT_DATA) == CAN_IDTYPE_STD_DATA)
+    {
+        temp = 21;
+    }
+    return (Frame->Id.Value << temp) | (uint32_t)Frame->Id.Type;
+}
+
 /**
  * @brief Puts the frame data in an empty transmit mailbox, and requests transmission.
  * @param hcan: pointer to the CAN handle structure
@@ -138,14 +166,8 @@ static XPD_ReturnType can_frameTransmit(CAN_HandleType * hcan, CAN_FrameType * F
 
     if (result == XPD_OK)
     {
-        uint32_t temp = 3;
-
         /* set up the Id */
-        if ((Frame->Id.Type & CAN_IDTYPE_EXT_DATA) == CAN_IDTYPE_STD_DATA)
-        {
-            temp = 21;
-        }
-        hcan->Inst->sTxMailBox[transmitmailbox].TIR.w = ((Frame->Id.Value << temp) | (uint32_t)Frame->Id.Type);
+        hcan->Inst->sTxMailBox[transmitmailbox].TIR.w = can_frameArbitration(Frame);
 
         /* set up the DLC */
         hcan->Inst->sTxMailBox[transmitmailbox].TDTR.b.DLC = (uint32_t) Frame->DLC;
@@ -164,6 +186,182 @@ static XPD_ReturnType can_frameTransmit(CAN_HandleType * hcan, CAN_FrameType * F
     return result;
 }
 
+/**
+ * @brief Inserts a frame into the transmit queue, keeping it sorted by arbitration priority.
+ *        The frames with equal arbitration are transmitted in the order of their submission.
+ * @param hcan: pointer to the CAN handle structure
+ * @param Frame: pointer to the frame to queue
+ * @param Preempted: the frame is queued again after being preempted in a mailbox,
+ *                   so it precedes the queued frames with equal arbitration
+ */
+static void can_txQueueInsert(CAN_HandleType * hcan, CAN_FrameType * Frame, boolean_t Preempted)
+{
+    uint32_t arbitration = can_frameArbitration(Frame);
+    uint8_t i;
+
+    /* the highest priority frame is at the end of the queue */
+    for (i = hcan->TxQueue.Count; i > 0; i--)
+    {
+        uint32_t queued = can_frameArbitration(hcan->TxQueue.Buffer[i - 1]);
+
+        if ((queued > arbitration) || ((Preempted == TRUE) && (queued == arbitration)))
+        {
+            break;
+        }
+        hcan->TxQueue.Buffer[i] = hcan->TxQueue.Buffer[i - 1];
+    }
+    hcan->TxQueue.Buffer[i] = Frame;
+    hcan->TxQueue.Count++;
+    XPD_STATS_MAX(hcan, QueueHighWater, hcan->TxQueue.Count);
+
+    Frame->Index = CAN_TXINDEX_QUEUED;
+}
+
+/**
+ * @brief Moves the highest priority queued frames into the empty transmit mailboxes,
+ *        and preempts the lowest priority mailbox if a higher priority frame is queued.
+ * @param hcan: pointer to the CAN handle structure
+ */
+static void can_txQueueService(CAN_HandleType * hcan)
+{
+    while (hcan->TxQueue.Count > 0)
+    {
+        CAN_FrameType * frame = hcan->TxQueue.Buffer[hcan->TxQueue.Count - 1];
+
+#ifdef USE_XPD_CAN_ERROR_DETECT
+        /* in error passive state the low priority frames are held back */
+        if ((XPD_CAN_GetErrorFlag(hcan, EPV) != 0)
+            && (can_frameArbitration(frame) > hcan->ErrorMgmt.Throttle))
+        {
+            break;
+        }
+#endif
+
+        if (can_frameTransmit(hcan, frame) == XPD_OK)
+        {
+            hcan->TxQueue.Count--;
+            hcan->TxFrame[frame->Index] = frame;
+
+            /* state bit is set for the transmit mailbox */
+            XPD_AtomicSetBits(&hcan->State, 1 << frame->Index);
+        }
+        else
+        {
+            /* all mailboxes are used, only one preemption at a time,
+             * and the preempted frame needs space in the queue */
+            if ((hcan->TxQueue.Aborting == 0) && (hcan->TxQueue.Count < hcan->TxQueue.Size))
+            {
+                uint32_t arbitration = can_frameArbitration(frame);
+                uint8_t i, mailbox = 3;
+
+                /* find the lowest priority queue frame in the mailboxes */
+                for (i = 0; i < 3; i++)
+                {
+                    if (    (hcan->TxFrame[i] != NULL)
+                         && (can_frameArbitration(hcan->TxFrame[i]) > arbitration))
+                    {
+                        arbitration = can_frameArbitration(hcan->TxFrame[i]);
+                        mailbox = i;
+                    }
+                }
+
+                if (mailbox < 3)
+                {
+                    /* request abort, the frame is queued again on completion */
+                    hcan->TxQueue.Aborting = 1 << mailbox;
+                    SET_BIT(hcan->Inst->TSR.w, CAN_TSR_ABRQ0 << (8 * mailbox));
+                }
+            }
+            break;
+        }
+    }
+}
+
+/**
+ * @brief Extends the 16 bit frame timestamp to 32 bits, based on the last timestamp of the handle.
+ * @note  The extension is correct as long as the frames are at most 32768 bit times apart.
+ * @param hcan: pointer to the CAN handle structure
+ * @param Time: the TIME field of the frame
+ * @return The extended timestamp
+ */
+static uint32_t can_frameTime(CAN_HandleType * hcan, uint16_t Time)
+{
+    /* the signed difference allows the slightly out of order FIFO and mailbox processing */
+    hcan->Time += (int16_t)(Time - (uint16_t)hcan->Time);
+
+    return hcan->Time;
+}
+
+#ifdef USE_XPD_CAN_ERROR_DETECT
+/**
+ * @brief Records the error counters and schedules the bus-off recovery.
+ * @param hcan: pointer to the CAN handle structure
+ */
+static void can_errorMgmtUpdate(CAN_HandleType * hcan)
+{
+    hcan->ErrorMgmt.TEC = XPD_CAN_GetTxErrorCounter(hcan);
+    hcan->ErrorMgmt.REC = XPD_CAN_GetRxErrorCounter(hcan);
+
+    if ((hcan->ErrorMgmt.MaxBackoff != 0) && (hcan->ErrorMgmt.Recovery == CAN_RECOVERY_NONE)
+        && (XPD_CAN_GetErrorFlag(hcan, BOF) != 0))
+    {
+        hcan->ErrorMgmt.BusOffs++;
+        hcan->ErrorMgmt.Countdown = hcan->ErrorMgmt.Backoff;
+        hcan->ErrorMgmt.Recovery  = CAN_RECOVERY_BACKOFF;
+
+        /* consecutive bus-offs double the delay */
+        if (hcan->ErrorMgmt.Backoff < (hcan->ErrorMgmt.MaxBackoff >> 1))
+        {
+            hcan->ErrorMgmt.Backoff <<= 1;
+        }
+        else
+        {
+            hcan->ErrorMgmt.Backoff = hcan->ErrorMgmt.MaxBackoff;
+        }
+    }
+}
+#endif
+
+/**
+ * @brief Gets the data from the receive FIFO to the frame and flushes the frame from the FIFO.
+ * @param hcan: pointer to the CAN handle structure
+ * @param FIFONumber: the selected receive FIFO [0 .. 1]
+ * @param Frame: pointer to the frame to put the received frame data to
+ */
+static void can_frameRead(CAN_HandleType * hcan, uint8_t FIFONumber, CAN_FrameType * Frame)
+{
+    /* copy the FIFO data to stack */
+    CAN_FIFOMailBox_TypeDef rxFIFO = hcan->Inst->sFIFOMailBox[FIFONumber];
+
+    /* Get the Id */
+    Frame->Id.Type = rxFIFO.RIR.w & CAN_IDTYPE_EXT_RTR;
+
+    if ((Frame->Id.Type & CAN_IDTYPE_EXT_DATA) == CAN_IDTYPE_STD_DATA)
+    {
+        Frame->Id.Value = rxFIFO.RIR.w >> 21;
+    }
+    else
+    {
+        Frame->Id.Value = rxFIFO.RIR.w >> 3;
+    }
+
+    /* Get the DLC */
+    Frame->DLC = rxFIFO.RDTR.b.DLC;
+    /* Get the FMI */
+    Frame->Index = rxFIFO.RDTR.b.FMI;
+    /* Get the timestamp */
+    Frame->Timestamp = can_frameTime(hcan, rxFIFO.RDTR.b.TIME);
+    /* Get the data field */
+    Frame->Data.Word[0] = rxFIFO.RDLR.w;
+    Frame->Data.Word[1] = rxFIFO.RDHR.w;
+
+    XPD_STATS_ADD(hcan, Transfers, 1);
+    XPD_STATS_ADD(hcan, Bytes, Frame->DLC);
+
+    /* Release the FIFO */
+    XPD_CAN_ClearRxFlag(hcan, FIFONumber, RFOM);
+}
+
 /**
  * @brief Gets the data from the receive FIFO to the receive frame pointer of the handle
  *        and flushes the frame from the FIFO.
@@ -174,31 +372,61 @@ static void can_frameReceive(CAN_HandleType * hcan, uint8_t FIFONumber)
 {
     if (hcan->RxFrame[FIFONumber] != NULL)
     {
-        /* copy the FIFO data to stack */
-        CAN_FIFOMailBox_TypeDef rxFIFO = hcan->Inst->sFIFOMailBox[FIFONumber];
+        can_frameRead(hcan, FIFONumber, hcan->RxFrame[FIFONumber]);
+    }
+}
+
+/**
+ * @brief Moves all pending frames of the receive FIFO to the software receive queue,
+ *        and provides a single receive callback for them.
+ * @param hcan: pointer to the CAN handle structure
+ * @param FIFONumber: the selected receive FIFO [0 .. 1]
+ */
+static void can_rxQueueDrain(CAN_HandleType * hcan, uint8_t FIFONumber)
+{
+    CAN_RxQueueType * queue = &hcan->RxQueue[FIFONumber];
+    uint8_t received = 0;
+    uint32_t rfr;
 
-        /* Get the Id */
-        hcan->RxFrame[FIFONumber]->Id.Type = rxFIFO.RIR.w & CAN_IDTYPE_EXT_RTR;
+    /* hardware FIFO overrun is counted */
+    if (XPD_CAN_GetRxFlag(hcan, FIFONumber, FOVR) != 0)
+    {
+        XPD_CAN_ClearRxFlag(hcan, FIFONumber, FOVR);
+        queue->HwOverruns++;
+        XPD_STATS_ERROR(hcan, CAN_STATS_FIFO_OVERRUN);
+    }
 
-        if ((hcan->RxFrame[FIFONumber]->Id.Type & CAN_IDTYPE_EXT_DATA) == CAN_IDTYPE_STD_DATA)
-        {
-            hcan->RxFrame[FIFONumber]->Id.Value = rxFIFO.RIR.w >> 21;
-        }
-        else
+    while (((rfr = hcan->Inst->RFR[FIFONumber].w) & CAN_RF0R_FMP0) != 0)
+    {
+        /* wait until the previous output mailbox is released */
+        if ((rfr & CAN_RF0R_RFOM0) == 0)
         {
-            hcan->RxFrame[FIFONumber]->Id.Value = rxFIFO.RIR.w >> 3;
-        }
+            uint8_t head = queue->Head + 1;
 
-        /* Get the DLC */
-        hcan->RxFrame[FIFONumber]->DLC = rxFIFO.RDTR.b.DLC;
-        /* Get the FMI */
-        hcan->RxFrame[FIFONumber]->Index = rxFIFO.RDTR.b.FMI;
-        /* Get the data field */
-        hcan->RxFrame[FIFONumber]->Data.Word[0] = rxFIFO.RDLR.w;
-        hcan->RxFrame[FIFONumber]->Data.Word[1] = rxFIFO.RDHR.w;
+            if (head >= queue->Size)
+            {
+                head = 0;
+            }
+
+            if (head != queue->Tail)
+            {
+                can_frameRead(hcan, FIFONumber, &queue->Buffer[queue->Head]);
+                queue->Head = head;
+                received++;
+            }
+            else
+            {
+                /* the queue is full, drop the frame */
+                XPD_CAN_ClearRxFlag(hcan, FIFONumber, RFOM);
+                queue->SwOverruns++;
+            }
+        }
+    }
 
-        /* Release the FIFO */
-        XPD_CAN_ClearRxFlag(hcan, FIFONumber, RFOM);
+    if (received != 0)
+    {
+        /* receive complete callback */
+        XPD_HANDLE_CALLBACK(hcan, Receive[FIFONumber], hcan);
     }
 }
 
@@ -285,6 +513,18 @@ XPD_ReturnType XPD_CAN_Init(CAN_HandleType * hcan, const CAN_InitType * Config)
 
     /* reset operation state */
     hcan->State = 0;
+    hcan->Time = 0;
+    hcan->BitRate = XPD_RCC_GetClockFreq(PCLK1) / ((uint32_t)Config->Timing.Prescaler
+            * (1 + Config->Timing.BS1 + Config->Timing.BS2));
+#ifdef USE_XPD_CAN_ERROR_DETECT
+    hcan->ErrorMgmt.Throttle   = ~0UL;
+    hcan->ErrorMgmt.MaxBackoff = 0;
+    hcan->ErrorMgmt.Recovery   = CAN_RECOVERY_NONE;
+    hcan->ErrorMgmt.BusOffs    = 0;
+#endif
+    hcan->RxQueue[0].Size = hcan->RxQueue[1].Size = 0;
+    hcan->TxQueue.Count = hcan->TxQueue.Aborting = 0;
+    hcan->TxFrame[0] = hcan->TxFrame[1] = hcan->TxFrame[2] = NULL;
 
     /* reset filter banks */
     can_filterReset(hcan);
@@ -347,6 +587,95 @@ XPD_ReturnType XPD_CAN_WakeUp(CAN_HandleType * hcan)
     return XPD_WaitForMatch(&hcan->Inst->MSR.w, CAN_MSR_SLAK, 0, &timeout);
 }
 
+/**
+ * @brief Recalculates the bit timing for the current peripheral clock frequency,
+ *        keeping the bit rate and the sample point of the initial configuration.
+ * @note  It can be registered as RCC clock change listener callback.
+ *        The controller is in initialization mode while the bit timing is updated,
+ *        the ongoing frame transfer is disrupted.
+ * @param hcan: pointer to the CAN handle structure
+ * @return ERROR if the bit rate can't be derived from the new clock frequency,
+ *         TIMEOUT if the initialization mode request timed out, OK if successful
+ */
+XPD_ReturnType XPD_CAN_ClockUpdate(CAN_HandleType * hcan)
+{
+    XPD_ReturnType result = XPD_ERROR;
+    uint32_t pclk = XPD_RCC_GetClockFreq(PCLK1);
+    uint32_t bs1 = hcan->Inst->BTR.b.TS1 + 1;
+    uint32_t bs2 = hcan->Inst->BTR.b.TS2 + 1;
+    uint32_t sjw = hcan->Inst->BTR.b.SJW + 1;
+    uint32_t quanta = 1 + bs1 + bs2;
+    uint32_t prescaler, n = 0;
+
+    /* the smallest prescaler gives the most time quanta per bit */
+    for (prescaler = 1; (prescaler <= 1024) && (hcan->BitRate > 0); prescaler++)
+    {
+        uint32_t div = prescaler * hcan->BitRate;
+
+        n = pclk / div;
+        if (n < 4)
+        {
+            break;
+        }
+        else if ((n <= 25) && ((n * div) == pclk))
+        {
+            result = XPD_OK;
+            break;
+        }
+    }
+
+    if (result == XPD_OK)
+    {
+        uint32_t timeout = INAK_TIMEOUT;
+
+        /* place the sample point to the closest quantum,
+         * within the segment limits of BS1: 1 .. 16 and BS2: 1 .. 8 */
+        bs1 = (n * (1 + bs1) + quanta / 2) / quanta;
+        if (bs1 > (n - 2))
+        {
+            bs1 = n - 2;
+        }
+        if (bs1 > 17)
+        {
+            bs1 = 17;
+        }
+        if ((bs1 + 8) < n)
+        {
+            bs1 = n - 8;
+        }
+        if (bs1 < 2)
+        {
+            bs1 = 2;
+        }
+        bs1--;
+        bs2 = n - 1 - bs1;
+        if (sjw > bs2)
+        {
+            sjw = bs2;
+        }
+
+        /* the bit timing is only writable in initialization mode */
+        CAN_REG_BIT(hcan, MCR, INRQ) = 1;
+
+        result = XPD_WaitForMatch(&hcan->Inst->MSR.w, CAN_MSR_INAK, CAN_MSR_INAK, &timeout);
+        if (result == XPD_OK)
+        {
+            hcan->Inst->BTR.b.SJW = sjw - 1;
+            hcan->Inst->BTR.b.TS1 = bs1 - 1;
+            hcan->Inst->BTR.b.TS2 = bs2 - 1;
+            hcan->Inst->BTR.b.BRP = prescaler - 1;
+        }
+
+        CAN_REG_BIT(hcan, MCR, INRQ) = 0;
+
+        if (result == XPD_OK)
+        {
+            result = XPD_WaitForMatch(&hcan->Inst->MSR.w, CAN_MSR_INAK, 0, &timeout);
+        }
+    }
+    return result;
+}
+
 /**
  * @brief Gets the error state of the CAN peripheral and clears its last error code.
  * @param hcan: pointer to the CAN handle structure
@@ -362,6 +691,85 @@ CAN_ErrorType XPD_CAN_GetError(CAN_HandleType * hcan)
     return errors;
 }
 
+#ifdef USE_XPD_CAN_ERROR_DETECT
+/**
+ * @brief Sets up the error management of the CAN peripheral: the bus-off state is recovered
+ *        by software after an exponentially increasing delay, and in error passive state
+ *        only the high priority frames of the transmit queue are transmitted.
+ * @note  The automatic bus-off recovery (ABOM) should be disabled in the initialization
+ *        setup, as it rejoins the bus without delay. @ref XPD_CAN_ErrorMgmt_Tick
+ *        is required to be called periodically at 1 ms.
+ * @param hcan: pointer to the CAN handle structure
+ * @param Config: pointer to the error management setup
+ */
+void XPD_CAN_ErrorMgmt_Init(CAN_HandleType * hcan, const CAN_ErrorMgmt_InitType * Config)
+{
+    CAN_FrameType throttle;
+
+    throttle.Id = Config->Throttle;
+
+    hcan->ErrorMgmt.Throttle   = can_frameArbitration(&throttle);
+    hcan->ErrorMgmt.MinBackoff = (Config->MinBackoff > 0) ? Config->MinBackoff : 1;
+    hcan->ErrorMgmt.MaxBackoff = (Config->MaxBackoff > hcan->ErrorMgmt.MinBackoff) ?
+            Config->MaxBackoff : hcan->ErrorMgmt.MinBackoff;
+    hcan->ErrorMgmt.Backoff    = hcan->ErrorMgmt.MinBackoff;
+    hcan->ErrorMgmt.Recovery   = CAN_RECOVERY_NONE;
+}
+
+/**
+ * @brief Performs the timed error management tasks: counts down the bus-off recovery delay,
+ *        requests the recovery sequence, and resumes the held back transmit queue frames
+ *        when the error passive state is left.
+ * @param hcan: pointer to the CAN handle structure
+ */
+void XPD_CAN_ErrorMgmt_Tick(CAN_HandleType * hcan)
+{
+    switch (hcan->ErrorMgmt.Recovery)
+    {
+        case CAN_RECOVERY_BACKOFF:
+            if (--hcan->ErrorMgmt.Countdown == 0)
+            {
+                /* entering and leaving initialization starts the recovery sequence */
+                CAN_REG_BIT(hcan, MCR, INRQ) = 1;
+                hcan->ErrorMgmt.Recovery = CAN_RECOVERY_INIT;
+            }
+            break;
+
+        case CAN_RECOVERY_INIT:
+            if (XPD_CAN_GetFlag(hcan, INAK) != 0)
+            {
+                CAN_REG_BIT(hcan, MCR, INRQ) = 0;
+                hcan->ErrorMgmt.Recovery = CAN_RECOVERY_REJOIN;
+            }
+            break;
+
+        case CAN_RECOVERY_REJOIN:
+            /* the bus-off state is left after 128 x 11 recessive bits */
+            if (XPD_CAN_GetErrorFlag(hcan, BOF) == 0)
+            {
+                hcan->ErrorMgmt.Recovery = CAN_RECOVERY_NONE;
+            }
+            break;
+
+        default:
+            /* the bus-off state may not have been signalled by interrupt */
+            can_errorMgmtUpdate(hcan);
+
+            if ((hcan->TxQueue.Count > 0) && (XPD_CAN_GetErrorFlag(hcan, EPV) == 0))
+            {
+                XPD_ENTER_CRITICAL(hcan);
+
+                can_txQueueService(hcan);
+
+                SET_BIT(hcan->Inst->IER.w, CAN_ERROR_INTERRUPTS | CAN_TRANSMIT_INTERRUPTS);
+
+                XPD_EXIT_CRITICAL(hcan);
+            }
+            break;
+    }
+}
+#endif /* USE_XPD_CAN_ERROR_DETECT */
+
 /** @} */
 
 /** @defgroup CAN_Exported_Functions_Transmit CAN Transmit Control Functions
@@ -422,6 +830,12 @@ XPD_ReturnType XPD_CAN_Transmit(CAN_HandleType * hcan, CAN_FrameType * Frame, ui
 
             /* wait for txok with the remaining time */
             result = XPD_WaitForMatch(&hcan->Inst->TSR.w, txok, txok, &Timeout);
+
+            if (result == XPD_OK)
+            {
+                Frame->Timestamp = can_frameTime(hcan,
+                        hcan->Inst->sTxMailBox[Frame->Index].TDTR.b.TIME);
+            }
         }
     }
 
@@ -446,9 +860,92 @@ XPD_ReturnType XPD_CAN_Transmit_IT(CAN_HandleType * hcan, CAN_FrameType * Frame)
         SET_BIT(hcan->Inst->IER.w, CAN_ERROR_INTERRUPTS | CAN_TRANSMIT_INTERRUPTS);
 
         /* state bit is set for the transmit mailbox */
-        SET_BIT(hcan->State, 1 << Frame->Index);
+        XPD_AtomicSetBits(&hcan->State, 1 << Frame->Index);
+    }
+
+    return result;
+}
+
+#ifdef USE_XPD_OS
+/**
+ * @brief Sets up a frame transmission using the interrupt stack,
+ *        blocking the calling task until the frame is sent.
+ * @note  Only one task can wait on the transmission of a handle at a time.
+ * @param hcan: pointer to the CAN handle structure
+ * @param Frame: pointer to the frame to transmit
+ * @param Timeout: available time for successfully sending the frame in ms
+ * @return BUSY if no empty mailbox was available, TIMEOUT if timed out (the transmission is aborted),
+ *         OK if frame is sent
+ */
+XPD_ReturnType XPD_CAN_Transmit_Blocking(CAN_HandleType * hcan, CAN_FrameType * Frame, uint32_t Timeout)
+{
+    XPD_ReturnType result;
+
+    XPD_OS_SignalInit(&hcan->Signal.Transmit);
+
+    result = XPD_CAN_Transmit_IT(hcan, Frame);
+
+    while ((result == XPD_OK) && ((hcan->State & (1 << Frame->Index)) != 0))
+    {
+        result = XPD_OS_SignalWait(&hcan->Signal.Transmit, &Timeout);
+
+        if (result != XPD_OK)
+        {
+            /* Abort the mailbox transmission request */
+            hcan->Inst->TSR.w = CAN_TSR_ABRQ0 << (Frame->Index * 8);
+            XPD_AtomicClearBits(&hcan->State, 1 << Frame->Index);
+        }
+    }
+    return result;
+}
+#endif /* USE_XPD_OS */
+
+/**
+ * @brief Sets up the software transmit queue, which keeps the highest priority
+ *        (lowest identifier) frames in the transmit mailboxes.
+ * @param hcan: pointer to the CAN handle structure
+ * @param Buffer: storage of the queued frame pointers
+ * @param Size: the number of frame pointers in the Buffer
+ */
+void XPD_CAN_TxQueue_Init(CAN_HandleType * hcan, CAN_FrameType ** Buffer, uint8_t Size)
+{
+    hcan->TxQueue.Buffer   = Buffer;
+    hcan->TxQueue.Size     = Size;
+    hcan->TxQueue.Count    = 0;
+    hcan->TxQueue.Aborting = 0;
+}
+
+/**
+ * @brief Adds a frame to the transmit queue, from which the transmit interrupt refills
+ *        the mailboxes in identifier priority order. When all mailboxes are used
+ *        by lower priority frames, the lowest priority one is aborted and queued again.
+ * @note  The frame shall remain valid until its Index field is set to
+ *        @ref CAN_TXINDEX_DONE or @ref CAN_TXINDEX_FAILED. The Transmit callback
+ *        is called after each successfully transmitted frame.
+ * @param hcan: pointer to the CAN handle structure
+ * @param Frame: pointer to the frame to transmit
+ * @return BUSY if the queue is full, OK if the frame is queued for transmission
+ */
+XPD_ReturnType XPD_CAN_TxQueue_Put(CAN_HandleType * hcan, CAN_FrameType * Frame)
+{
+    XPD_ReturnType result = XPD_BUSY;
+
+    XPD_ENTER_CRITICAL(hcan);
+
+    /* a slot is kept free for the preempted frame */
+    if ((hcan->TxQueue.Count + (hcan->TxQueue.Aborting != 0 ? 1 : 0)) < hcan->TxQueue.Size)
+    {
+        can_txQueueInsert(hcan, Frame, FALSE);
+
+        can_txQueueService(hcan);
+
+        SET_BIT(hcan->Inst->IER.w, CAN_ERROR_INTERRUPTS | CAN_TRANSMIT_INTERRUPTS);
+
+        result = XPD_OK;
     }
 
+    XPD_EXIT_CRITICAL(hcan);
+
     return result;
 }
 
@@ -477,7 +974,7 @@ XPD_ReturnType XPD_CAN_Receive(CAN_HandleType * hcan, CAN_FrameType* Frame, uint
     /* check if FIFO is not in use */
     if ((hcan->State & recState) == 0)
     {
-        SET_BIT(hcan->State, recState);
+        XPD_AtomicSetBits(&hcan->State, recState);
 
         /* save receive data target */
         hcan->RxFrame[FIFONumber] = Frame;
@@ -510,7 +1007,7 @@ XPD_ReturnType XPD_CAN_Receive_IT(CAN_HandleType * hcan, CAN_FrameType * Frame,
     /* check if FIFO is not in use */
     if ((hcan->State & recState) == 0)
     {
-        SET_BIT(hcan->State, recState);
+        XPD_AtomicSetBits(&hcan->State, recState);
 
         /* save receive data target */
         hcan->RxFrame[FIFONumber] = Frame;
@@ -523,6 +1020,139 @@ XPD_ReturnType XPD_CAN_Receive_IT(CAN_HandleType * hcan, CAN_FrameType * Frame,
     return result;
 }
 
+#ifdef USE_XPD_OS
+/**
+ * @brief Requests a frame reception using the interrupt stack,
+ *        blocking the calling task until the frame is received.
+ * @note  Only one task can wait on the reception of a FIFO at a time.
+ * @param hcan: pointer to the CAN handle structure
+ * @param Frame: pointer to the frame to put the received frame data to
+ * @param FIFONumber: the selected receive FIFO [0 .. 1]
+ * @param Timeout: available time for frame reception in ms
+ * @return BUSY if the FIFO is already in use, TIMEOUT if timed out, OK if frame is received
+ */
+XPD_ReturnType XPD_CAN_Receive_Blocking(CAN_HandleType * hcan, CAN_FrameType * Frame, uint8_t FIFONumber,
+        uint32_t Timeout)
+{
+    XPD_ReturnType result;
+    uint8_t recState = CAN_STATE_RECEIVE0 << FIFONumber;
+
+    XPD_OS_SignalInit(&hcan->Signal.Receive[FIFONumber]);
+
+    result = XPD_CAN_Receive_IT(hcan, Frame, FIFONumber);
+
+    while ((result == XPD_OK) && ((hcan->State & recState) != 0))
+    {
+        result = XPD_OS_SignalWait(&hcan->Signal.Receive[FIFONumber], &Timeout);
+
+        if (result != XPD_OK)
+        {
+            /* Cancel the reception request */
+            CLEAR_BIT(hcan->Inst->IER.w,
+                (FIFONumber == 0) ? CAN_RECEIVE0_INTERRUPTS : CAN_RECEIVE1_INTERRUPTS);
+            XPD_AtomicClearBits(&hcan->State, recState);
+        }
+    }
+    return result;
+}
+#endif /* USE_XPD_OS */
+
+/**
+ * @brief Starts continuous frame reception into a software queue using the interrupt stack.
+ *        All pending frames of the FIFO are moved to the queue on each interrupt,
+ *        and the Receive callback is called once for them.
+ * @note  The queue holds at most Size - 1 frames.
+ * @param hcan: pointer to the CAN handle structure
+ * @param FIFONumber: the selected receive FIFO [0 .. 1]
+ * @param Buffer: frame storage of the queue
+ * @param Size: the number of frames in the Buffer [2 .. 255]
+ * @return BUSY if the FIFO is already in use, OK otherwise
+ */
+XPD_ReturnType XPD_CAN_RxQueue_Start(CAN_HandleType * hcan, uint8_t FIFONumber,
+        CAN_FrameType * Buffer, uint8_t Size)
+{
+    XPD_ReturnType result = XPD_BUSY;
+    uint8_t recState = CAN_STATE_RECEIVE0 << FIFONumber;
+
+    /* check if FIFO is not in use */
+    if ((hcan->State & recState) == 0)
+    {
+        CAN_RxQueueType * queue = &hcan->RxQueue[FIFONumber];
+
+        XPD_AtomicSetBits(&hcan->State, recState);
+
+        queue->Buffer     = Buffer;
+        queue->Head       = queue->Tail = 0;
+        queue->HwOverruns = queue->SwOverruns = 0;
+        queue->Size       = Size;
+
+        SET_BIT(hcan->Inst->IER.w, CAN_ERROR_INTERRUPTS
+            | ((FIFONumber == 0) ? (CAN_RECEIVE0_INTERRUPTS | CAN_IER_FOVIE0)
+                                 : (CAN_RECEIVE1_INTERRUPTS | CAN_IER_FOVIE1)));
+
+        result = XPD_OK;
+    }
+    return result;
+}
+
+/**
+ * @brief Stops the frame reception into the software receive queue.
+ * @param hcan: pointer to the CAN handle structure
+ * @param FIFONumber: the selected receive FIFO [0 .. 1]
+ */
+void XPD_CAN_RxQueue_Stop(CAN_HandleType * hcan, uint8_t FIFONumber)
+{
+    uint32_t temp = (FIFONumber == 0) ? (CAN_RECEIVE0_INTERRUPTS | CAN_IER_FOVIE0)
+                                      : (CAN_RECEIVE1_INTERRUPTS | CAN_IER_FOVIE1);
+
+    if (hcan->RxQueue[FIFONumber].Size != 0)
+    {
+        hcan->RxQueue[FIFONumber].Size = 0;
+
+        XPD_AtomicClearBits(&hcan->State, CAN_STATE_RECEIVE0 << FIFONumber);
+
+#ifdef USE_XPD_CAN_ERROR_DETECT
+        if ((hcan->State & (CAN_STATE_TRANSMIT | CAN_STATE_RECEIVE)) == 0)
+        {
+            temp |= CAN_ERROR_INTERRUPTS;
+        }
+#endif
+        CLEAR_BIT(hcan->Inst->IER.w, temp);
+    }
+}
+
+/**
+ * @brief Reads the received frames from the software receive queue.
+ * @param hcan: pointer to the CAN handle structure
+ * @param FIFONumber: the selected receive FIFO [0 .. 1]
+ * @param Frames: array to copy the received frames to
+ * @param Count: the maximal number of frames to read
+ * @return The number of frames read from the queue
+ */
+uint8_t XPD_CAN_RxQueue_Read(CAN_HandleType * hcan, uint8_t FIFONumber,
+        CAN_FrameType * Frames, uint8_t Count)
+{
+    CAN_RxQueueType * queue = &hcan->RxQueue[FIFONumber];
+    uint8_t tail = queue->Tail;
+    uint8_t head = queue->Head;
+    uint8_t i;
+
+    for (i = 0; (i < Count) && (tail != head); i++)
+    {
+        Frames[i] = queue->Buffer[tail];
+
+        if (++tail >= queue->Size)
+        {
+            tail = 0;
+        }
+    }
+
+    /* release the read frames */
+    queue->Tail = tail;
+
+    return i;
+}
+
 /** @} */
 
 /** @defgroup CAN_Exported_Functions_IRQ CAN Interrupt Handling Functions
@@ -539,6 +1169,9 @@ XPD_ReturnType XPD_CAN_Receive_IT(CAN_HandleType * hcan, CAN_FrameType * Frame,
  */
 void XPD_CAN_TX_IRQHandler(CAN_HandleType * hcan)
 {
+    XPD_PROFILE_BEGIN();
+    XPD_STATS_IRQ_BEGIN();
+
     uint32_t temp, i;
 
     /* check end of transmission */
@@ -547,16 +1180,68 @@ void XPD_CAN_TX_IRQHandler(CAN_HandleType * hcan)
         /* check all mailboxes for successful interrupt requests */
         for (i = 0; i < 3; i++)
         {
+            CAN_FrameType * frame = hcan->TxFrame[i];
+
             temp = 1 << i;
-            if (((hcan->State & temp) != 0) && XPD_CAN_GetTxFlag(hcan, i, TXOK))
+            if ((hcan->State & temp) == 0)
+            {
+                continue;
+            }
+
+            /* transmit queue frame is completed */
+            if (frame != NULL)
+            {
+                if (XPD_CAN_GetTxFlag(hcan, i, RQCP))
+                {
+                    XPD_AtomicClearBits(&hcan->State, temp);
+                    hcan->TxFrame[i] = NULL;
+
+                    if (XPD_CAN_GetTxFlag(hcan, i, TXOK))
+                    {
+                        frame->Index = CAN_TXINDEX_DONE;
+                        frame->Timestamp = can_frameTime(hcan, hcan->Inst->sTxMailBox[i].TDTR.b.TIME);
+#ifdef USE_XPD_CAN_ERROR_DETECT
+                        hcan->ErrorMgmt.Backoff = hcan->ErrorMgmt.MinBackoff;
+#endif
+                        XPD_STATS_ADD(hcan, Transfers, 1);
+                        XPD_STATS_ADD(hcan, Bytes, frame->DLC);
+
+                        /* transmission complete callback */
+                        XPD_HANDLE_CALLBACK(hcan, Transmit, hcan);
+                        XPD_OS_SIGNAL(hcan->Signal.Transmit);
+                    }
+                    else if ((hcan->TxQueue.Aborting & temp) != 0)
+                    {
+                        /* preempted frame is queued again */
+                        can_txQueueInsert(hcan, frame, TRUE);
+                    }
+                    else
+                    {
+                        frame->Index = CAN_TXINDEX_FAILED;
+                    }
+                    XPD_AtomicClearBits(&hcan->TxQueue.Aborting, temp);
+
+                    XPD_CAN_ClearTxFlag(hcan, i, RQCP);
+                }
+            }
+            else if (XPD_CAN_GetTxFlag(hcan, i, TXOK))
             {
-                CLEAR_BIT(hcan->State, temp);
+                XPD_AtomicClearBits(&hcan->State, temp);
+                XPD_STATS_ADD(hcan, Transfers, 1);
+                XPD_STATS_ADD(hcan, Bytes, hcan->Inst->sTxMailBox[i].TDTR.b.DLC);
+#ifdef USE_XPD_CAN_ERROR_DETECT
+                hcan->ErrorMgmt.Backoff = hcan->ErrorMgmt.MinBackoff;
+#endif
 
                 /* transmission complete callback */
-                XPD_SAFE_CALLBACK(hcan->Callbacks.Transmit, hcan);
+                XPD_HANDLE_CALLBACK(hcan, Transmit, hcan);
+                XPD_OS_SIGNAL(hcan->Signal.Transmit);
             }
         }
 
+        /* refill the mailboxes from the transmit queue */
+        can_txQueueService(hcan);
+
         /* if no more transmission requests are pending */
         if ((hcan->State & CAN_STATE_TRANSMIT) == 0)
         {
@@ -572,6 +1257,9 @@ void XPD_CAN_TX_IRQHandler(CAN_HandleType * hcan)
             CLEAR_BIT(hcan->Inst->IER.w, temp);
         }
     }
+
+    XPD_STATS_IRQ_END(hcan);
+    XPD_PROFILE_END();
 }
 
 /**
@@ -580,10 +1268,18 @@ void XPD_CAN_TX_IRQHandler(CAN_HandleType * hcan)
  */
 void XPD_CAN_RX0_IRQHandler(CAN_HandleType * hcan)
 {
+    XPD_PROFILE_BEGIN();
+    XPD_STATS_IRQ_BEGIN();
+
     uint32_t temp;
 
+    /* empty the FIFO to the software queue */
+    if (hcan->RxQueue[0].Size != 0)
+    {
+        can_rxQueueDrain(hcan, 0);
+    }
     /* check reception completion */
-    if (CAN_REG_BIT(hcan,IER,FMP0IE) && (hcan->Inst->RFR[0].b.FMP != 0))
+    else if (CAN_REG_BIT(hcan,IER,FMP0IE) && (hcan->Inst->RFR[0].b.FMP != 0))
     {
         /* get the FIFO contents to the requested frame structure */
         can_frameReceive(hcan, 0);
@@ -599,14 +1295,18 @@ void XPD_CAN_RX0_IRQHandler(CAN_HandleType * hcan)
                 temp |= CAN_ERROR_INTERRUPTS;
             }
 #endif
-            CLEAR_BIT(hcan->State, CAN_STATE_RECEIVE0);
+            XPD_AtomicClearBits(&hcan->State, CAN_STATE_RECEIVE0);
 
             CLEAR_BIT(hcan->Inst->IER.w, temp);
         }
 
         /* receive complete callback */
-        XPD_SAFE_CALLBACK(hcan->Callbacks.Receive[0], hcan);
+        XPD_HANDLE_CALLBACK(hcan, Receive[0], hcan);
+        XPD_OS_SIGNAL(hcan->Signal.Receive[0]);
     }
+
+    XPD_STATS_IRQ_END(hcan);
+    XPD_PROFILE_END();
 }
 
 /**
@@ -615,10 +1315,18 @@ void XPD_CAN_RX0_IRQHandler(CAN_HandleType * hcan)
  */
 void XPD_CAN_RX1_IRQHandler(CAN_HandleType * hcan)
 {
+    XPD_PROFILE_BEGIN();
+    XPD_STATS_IRQ_BEGIN();
+
     uint32_t temp;
 
+    /* empty the FIFO to the software queue */
+    if (hcan->RxQueue[1].Size != 0)
+    {
+        can_rxQueueDrain(hcan, 1);
+    }
     /* check reception completion */
-    if (CAN_REG_BIT(hcan,IER,FMP1IE) && (hcan->Inst->RFR[1].b.FMP != 0))
+    else if (CAN_REG_BIT(hcan,IER,FMP1IE) && (hcan->Inst->RFR[1].b.FMP != 0))
     {
         /* get the FIFO contents to the requested frame structure */
         can_frameReceive(hcan, 1);
@@ -634,14 +1342,18 @@ void XPD_CAN_RX1_IRQHandler(CAN_HandleType * hcan)
                 temp |= CAN_ERROR_INTERRUPTS;
             }
 #endif
-            CLEAR_BIT(hcan->State, CAN_STATE_RECEIVE1);
+            XPD_AtomicClearBits(&hcan->State, CAN_STATE_RECEIVE1);
 
             CLEAR_BIT(hcan->Inst->IER.w, temp);
         }
 
         /* receive complete callback */
-        XPD_SAFE_CALLBACK(hcan->Callbacks.Receive[1], hcan);
+        XPD_HANDLE_CALLBACK(hcan, Receive[1], hcan);
+        XPD_OS_SIGNAL(hcan->Signal.Receive[1]);
     }
+
+    XPD_STATS_IRQ_END(hcan);
+    XPD_PROFILE_END();
 }
 
 /**
@@ -650,13 +1362,28 @@ void XPD_CAN_RX1_IRQHandler(CAN_HandleType * hcan)
  */
 void XPD_CAN_SCE_IRQHandler(CAN_HandleType * hcan)
 {
+    XPD_PROFILE_BEGIN();
+    XPD_STATS_IRQ_BEGIN();
+
     /* check if errors are configured for interrupt and present */
     if (    ((hcan->Inst->IER.w & (CAN_IER_BOFIE | CAN_IER_EPVIE | CAN_IER_EWGIE | CAN_IER_LECIE)) != 0)
          && ((hcan->Inst->ESR.w & (CAN_ESR_LEC | CAN_ESR_BOFF | CAN_ESR_EPVF | CAN_ESR_EWGF)) != 0))
     {
+#ifdef USE_XPD_STATISTICS
+        uint32_t esr = hcan->Inst->ESR.w;
+
+        XPD_STATS_ERROR(hcan, (esr & (CAN_ESR_BOFF | CAN_ESR_EPVF | CAN_ESR_EWGF))
+                | (((esr & CAN_ESR_LEC) != 0) ? CAN_STATS_PROTOCOL_ERROR : 0));
+#endif
+#ifdef USE_XPD_CAN_ERROR_DETECT
+        can_errorMgmtUpdate(hcan);
+#endif
         /* call error callback function if interrupt is not by state change */
-        XPD_SAFE_CALLBACK(hcan->Callbacks.Error, hcan);
+        XPD_HANDLE_CALLBACK(hcan, Error, hcan);
     }
+
+    XPD_STATS_IRQ_END(hcan);
+    XPD_PROFILE_END();
 }
 
 /** @} */
@@ -880,6 +1607,101 @@ XPD_ReturnType XPD_CAN_FilterConfig(CAN_HandleType * hcan, const CAN_FilterType
     return result;
 }
 
+/**
+ * @brief Compiles the accepted Identifier ranges to a minimal set of receive filters.
+ *        Each range is split to the fewest aligned power of two blocks, single Identifiers
+ *        are matched in list mode, larger blocks are matched in mask mode.
+ *        The resulting filters can be configured by @ref XPD_CAN_FilterConfig,
+ *        which packs them in 16 bit scale for standard, in 32 bit scale for extended Identifiers.
+ * @param Ranges: the accepted Identifier ranges
+ * @param RangeCount: the number of input ranges
+ * @param Filters: the filter array to fill
+ * @param FilterCount: input the size of the Filters array, output the number of compiled filters
+ * @return ERROR if the filters do not fit in the array, OK if successful
+ */
+XPD_ReturnType XPD_CAN_FilterCompile(const CAN_FilterRangeType * Ranges, uint8_t RangeCount,
+        CAN_FilterType * Filters, uint8_t * FilterCount)
+{
+    XPD_ReturnType result = XPD_OK;
+    uint8_t i, count = 0;
+
+    for (i = 0; (i < RangeCount) && (result == XPD_OK); i++)
+    {
+        uint32_t idMask = ((Ranges[i].Type & CAN_IDTYPE_EXT_DATA) == CAN_IDTYPE_STD_DATA) ?
+                0x7FF : 0x1FFFFFFF;
+        uint32_t first = Ranges[i].First;
+
+        while (first <= Ranges[i].Last)
+        {
+            uint32_t size = 1;
+
+            /* Find the largest aligned block starting at the first Identifier */
+            while (  ((first & ((size << 1) - 1)) == 0)
+                  && ((size << 1) <= (Ranges[i].Last - first + 1))
+                  && ((size << 1) <= (idMask + 1)))
+            {
+                size <<= 1;
+            }
+
+            if (count >= *FilterCount)
+            {
+                result = XPD_ERROR;
+                break;
+            }
+
+            Filters[count].Pattern.Value = first;
+            Filters[count].Pattern.Type  = Ranges[i].Type;
+            Filters[count].Mask          = idMask & ~(size - 1);
+            Filters[count].Mode          = (size == 1) ? CAN_FILTER_MATCH : CAN_FILTER_MASK;
+            Filters[count].FIFO          = Ranges[i].FIFO;
+            count++;
+
+            /* Avoid overflow at the end of the Identifier space */
+            if ((first + size - 1) >= Ranges[i].Last)
+            {
+                break;
+            }
+            first += size;
+        }
+    }
+
+    *FilterCount = count;
+
+    return result;
+}
+
+/**
+ * @brief Calculates the number of filter banks that the filters occupy
+ *        when configured by @ref XPD_CAN_FilterConfig. This can be used to split
+ *        the filter banks between CAN controllers by @ref XPD_CAN_FilterBankConfig.
+ * @param Filters: filter configuration list (array)
+ * @param FilterCount: the number of input filters
+ * @return The number of required filter banks
+ */
+uint8_t XPD_CAN_FilterBankDemand(const CAN_FilterType * Filters, uint8_t FilterCount)
+{
+    uint8_t typeCount[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+    uint8_t i, fbDemand = 0;
+
+    /* Count the filters of each type */
+    for (i = 0; i < FilterCount; i++)
+    {
+        typeCount[Filters[i].FIFO
+               | (Filters[i].Mode         & CAN_FILTER_MATCH)
+               | (Filters[i].Pattern.Type & CAN_IDTYPE_EXT_DATA)]++;
+    }
+
+    /* Each type occupies full banks */
+    for (i = 0; i < 8; i++)
+    {
+        uint8_t space = filterTypeSpace[i >> 1];
+
+        fbDemand += (typeCount[i] + space - 1) / space;
+    }
+
+    return fbDemand;
+}
+
 /**
  * @brief Sets the filter bank size for the CAN peripheral.
  * @note  This operation resets the filter configuration for the slave CAN controller.
@@ -0,0 +1,85 @@
+/**
+  ******************************************************************************
+  * @file    xpd_dma_map.c
+  * @author  Benedek Kupper
+  * @version V0.1
+  * @date    2018-01-20
+  * @brief   STM32 eXtensible Peripheral Drivers DMA Request Map
+  *
+  *  This file is part of STM32_XPD.
+  *
+  *  STM32_XPD is free software: you can redistribute it and/or modify
+  *  it under the terms of the GNU General Public License as published by
+  *  the Free Software Foundation, either version 3 of the License, or
+  *  (at your option) any later version.
+  *
+  *  STM32_XPD is distributed in the hope that it will be useful,
+  *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with STM32_XPD.  If not, see <http://www.gnu.org/licenses/>.
+  */
+#include "xpd_dma.h"
+
+/** @addtogroup DMA
+ * @{ */
+
+/* Channel location of the request: DMA number, channel offset, selection */
+#define DMA_MAP(DMA, OFFSET, SELECT)   {.Channel = (DMA) * 8 + (OFFSET), .Select = (SELECT)}
+
+/** @addtogroup DMA_Exported_Variables
+ * @{ */
+
+#ifdef SYSCFG_CFGR1_ADC_DMA_RMP
+#define DMA_MAP_ADC_RMP(VALUE)        (SYSCFG_CFGR1_ADC_DMA_RMP_Pos | ((VALUE) << 7))
+#else
+#define DMA_MAP_ADC_RMP(VALUE)        0
+#endif
+#ifdef SYSCFG_CFGR1_USART1TX_DMA_RMP
+#define DMA_MAP_USART1TX_RMP(VALUE)   (SYSCFG_CFGR1_USART1TX_DMA_RMP_Pos | ((VALUE) << 7))
+#define DMA_MAP_USART1RX_RMP(VALUE)   (SYSCFG_CFGR1_USART1RX_DMA_RMP_Pos | ((VALUE) << 7))
+#endif
+
+/** @brief The channel candidates of each request (channel offset is the channel number - 1,
+ *         selection is the SYSCFG remap bit of the independently remappable requests) */
+const DMA_RequestMapType XPD_DMA_RequestMap[DMA_REQUEST_COUNT][2] = {
+    [DMA_REQUEST_ADC1]      = { DMA_MAP(1, 0, DMA_MAP_ADC_RMP(0)), DMA_MAP(1, 1, DMA_MAP_ADC_RMP(1)) },
+    [DMA_REQUEST_SPI1_RX]   = { DMA_MAP(1, 1, 0) },
+    [DMA_REQUEST_SPI1_TX]   = { DMA_MAP(1, 2, 0) },
+#ifdef SPI2
+    [DMA_REQUEST_SPI2_RX]   = { DMA_MAP(1, 3, 0) },
+    [DMA_REQUEST_SPI2_TX]   = { DMA_MAP(1, 4, 0) },
+#endif
+#ifdef SYSCFG_CFGR1_USART1TX_DMA_RMP
+    [DMA_REQUEST_USART1_RX] = { DMA_MAP(1, 2, DMA_MAP_USART1RX_RMP(0)), DMA_MAP(1, 4, DMA_MAP_USART1RX_RMP(1)) },
+    [DMA_REQUEST_USART1_TX] = { DMA_MAP(1, 1, DMA_MAP_USART1TX_RMP(0)), DMA_MAP(1, 3, DMA_MAP_USART1TX_RMP(1)) },
+#else
+    [DMA_REQUEST_USART1_RX] = { DMA_MAP(1, 2, 0) },
+    [DMA_REQUEST_USART1_TX] = { DMA_MAP(1, 1, 0) },
+#endif
+#ifdef USART2
+    [DMA_REQUEST_USART2_RX] = { DMA_MAP(1, 4, 0) },
+    [DMA_REQUEST_USART2_TX] = { DMA_MAP(1, 3, 0) },
+#endif
+#ifdef USART3
+    [DMA_REQUEST_USART3_RX] = { DMA_MAP(1, 5, 0) },
+    [DMA_REQUEST_USART3_TX] = { DMA_MAP(1, 6, 0) },
+#endif
+    [DMA_REQUEST_TIM1_UP]   = { DMA_MAP(1, 4, 0) },
+#ifdef TIM2
+    [DMA_REQUEST_TIM2_UP]   = { DMA_MAP(1, 1, 0) },
+#endif
+    [DMA_REQUEST_TIM3_UP]   = { DMA_MAP(1, 2, 0) },
+#ifdef TIM6
+    [DMA_REQUEST_TIM6_UP]   = { DMA_MAP(1, 2, 0) },
+#endif
+#ifdef TIM7
+    [DMA_REQUEST_TIM7_UP]   = { DMA_MAP(1, 3, 0) },
+#endif
+};
+
+/** @} */
+
+/** @} */
@@ -53,6 +53,13 @@ static struct
     void * Address;
     DataStreamType  MemStream;
     volatile FLASH_ErrorType Errors;
+#ifdef USE_XPD_OS
+    XPD_OS_SignalType Signal;
+#endif
+    struct {
+        FLASH_JobType * Head;
+        FLASH_JobType * Tail;
+    } Queue;
 } xpd_flashHandle =
 {
         .Errors         = FLASH_ERROR_NONE,
@@ -60,7 +67,7 @@ static struct
 };
 
 /* Erase the next scheduled block */
-static void flash_blockErase(void)
+XPD_FLASH_RAMFUNC static void flash_blockErase(void)
 {
     /* Proceed to erase the page */
     FLASH_REG_BIT(CR,PER) = 1;
@@ -71,7 +78,7 @@ static void flash_blockErase(void)
 }
 
 /* Read errors to context, and clear them in register */
-void flash_checkErrors(void)
+XPD_FLASH_RAMFUNC void flash_checkErrors(void)
 {
     /* Read error flags */
     hflash->Errors = FLASH->SR.w & (FLASH_SR_PGERR | FLASH_SR_WRPERR);
@@ -80,6 +87,132 @@ void flash_checkErrors(void)
     FLASH->SR.w = hflash->Errors;
 }
 
+#ifdef USE_XPD_OS
+/* Waits until the interrupt driven operation is finished */
+static XPD_ReturnType flash_waitBlocking(uint32_t * timeout)
+{
+    XPD_ReturnType result = XPD_OK;
+
+    while ((result == XPD_OK) && (FLASH_GETOPERATION() != FLASH_OPERATION_NONE))
+    {
+        result = XPD_OS_SignalWait(&hflash->Signal, timeout);
+    }
+    if ((result == XPD_OK) && (hflash->Errors != FLASH_ERROR_NONE))
+    {
+        result = XPD_ERROR;
+    }
+    return result;
+}
+#endif
+
+static void flash_queueRedirect(XPD_ReturnType Result);
+
+/* Compares the flash content to the job data */
+XPD_FLASH_RAMFUNC static XPD_ReturnType flash_jobVerify(FLASH_JobType * Job)
+{
+    const uint16_t * flash = Job->Address;
+    const uint16_t * data  = Job->Data;
+    uint16_t length = Job->Length / sizeof(uint16_t);
+
+    while ((length > 0) && (*flash == *data))
+    {
+        flash++;
+        data++;
+        length--;
+    }
+
+    return (length == 0) ? XPD_OK : XPD_ERROR;
+}
+
+/* End of operation callback of the queued jobs */
+XPD_FLASH_RAMFUNC static void flash_queueComplete(void)
+{
+    flash_queueRedirect(XPD_OK);
+}
+
+/* Error callback of the queued jobs */
+XPD_FLASH_RAMFUNC static void flash_queueError(void)
+{
+    /* The aborted operation doesn't signal completion */
+    XPD_FLASH_ClearFlag(EOP);
+
+    flash_queueRedirect(XPD_ERROR);
+}
+
+/* Removes the finished job from the queue and signals its completion */
+XPD_FLASH_RAMFUNC static void flash_jobFinish(FLASH_JobType * Job, XPD_ReturnType Result)
+{
+    XPD_ENTER_CRITICAL(hflash);
+
+    /* Remove the finished job from the queue */
+    hflash->Queue.Head = Job->Next;
+    if (hflash->Queue.Head == NULL)
+    {
+        hflash->Queue.Tail = NULL;
+    }
+
+    XPD_EXIT_CRITICAL(hflash);
+
+    Job->Result = Result;
+    XPD_SAFE_CALLBACK(Job->Complete, Job);
+}
+
+/* Starts the queued jobs until one of them is left ongoing */
+XPD_FLASH_RAMFUNC static void flash_queueStart(void)
+{
+    FLASH_JobType * job = hflash->Queue.Head;
+
+    XPD_FLASH_Callbacks.EraseComplete   = flash_queueComplete;
+    XPD_FLASH_Callbacks.ProgramComplete = flash_queueComplete;
+    XPD_FLASH_Callbacks.Error           = flash_queueError;
+
+    /* The jobs finishing synchronously are iterated here, the call depth doesn't grow */
+    while (job != NULL)
+    {
+        XPD_ReturnType result;
+
+        switch (job->Operation)
+        {
+            case FLASH_JOB_ERASE:
+                result = XPD_FLASH_Erase_IT(job->Address, job->Length);
+                break;
+
+            case FLASH_JOB_PROGRAM:
+                result = XPD_FLASH_Program_IT(job->Address, job->Data, job->Length);
+                break;
+
+            case FLASH_JOB_VERIFY:
+            default:
+                result = flash_jobVerify(job);
+                break;
+        }
+
+        /* The operation is ongoing, the queue is continued from its callback */
+        if ((result == XPD_OK) && (job->Operation != FLASH_JOB_VERIFY))
+        {
+            break;
+        }
+
+        /* The job could not be started, or it is already finished */
+        flash_jobFinish(job, result);
+
+        /* Continue with the next job, unless the Complete callback has already started it */
+        job = (FLASH_GETOPERATION() == FLASH_OPERATION_NONE) ? hflash->Queue.Head : NULL;
+    }
+}
+
+/* Finishes the ongoing job and starts the next queued one */
+XPD_FLASH_RAMFUNC static void flash_queueRedirect(XPD_ReturnType Result)
+{
+    flash_jobFinish(hflash->Queue.Head, Result);
+
+    /* Start the next job, unless the callback has already done so */
+    if ((hflash->Queue.Head != NULL) && (FLASH_GETOPERATION() == FLASH_OPERATION_NONE))
+    {
+        flash_queueStart();
+    }
+}
+
 /** @addtogroup FLASH_Exported_Functions
  * @{ */
 
@@ -200,7 +333,7 @@ XPD_ReturnType XPD_FLASH_Program(void * Address, const void * Data, uint16_t Len
  * @return BUSY     if another operation is already ongoing,
  *         OK       if programming started
  */
-XPD_ReturnType XPD_FLASH_Program_IT(void * Address, const void * Data, uint16_t Length)
+XPD_FLASH_RAMFUNC XPD_ReturnType XPD_FLASH_Program_IT(void * Address, const void * Data, uint16_t Length)
 {
     XPD_ReturnType result = XPD_BUSY;
 
@@ -259,7 +392,7 @@ XPD_ReturnType XPD_FLASH_EraseBank(uint8_t Bank)
  * @return BUSY     if another operation is already ongoing,
  *         OK       if mass erase started
  */
-XPD_ReturnType XPD_FLASH_EraseBank_IT(uint8_t Bank)
+XPD_FLASH_RAMFUNC XPD_ReturnType XPD_FLASH_EraseBank_IT(uint8_t Bank)
 {
     XPD_ReturnType result = XPD_BUSY;
 
@@ -334,7 +467,7 @@ XPD_ReturnType XPD_FLASH_Erase(void * Address, uint16_t kBytes)
  * @return BUSY     if another operation is already ongoing,
  *         OK       if page erase started
  */
-XPD_ReturnType XPD_FLASH_Erase_IT(void * Address, uint16_t kBytes)
+XPD_FLASH_RAMFUNC XPD_ReturnType XPD_FLASH_Erase_IT(void * Address, uint16_t kBytes)
 {
     XPD_ReturnType result = XPD_BUSY;
 
@@ -355,11 +488,71 @@ XPD_ReturnType XPD_FLASH_Erase_IT(void * Address, uint16_t kBytes)
     return result;
 }
 
+#ifdef USE_XPD_OS
+/**
+ * @brief Programs the input data to the specified flash address,
+ *        blocking the calling task until the programming is finished.
+ * @note  The FLASH interface should be unlocked beforehand, and locked afterwards.
+ * @note  Other tasks can only run meanwhile if they don't access the flash bank
+ *        being programmed (e.g. they execute from RAM or from the other bank).
+ * @param Address: the start flash address to write
+ * @param Data: input data to program
+ * @param Length: amount of bytes to program
+ * @param Timeout: available time for the operation in ms
+ * @return BUSY     if another operation is already ongoing,
+ *         ERROR    if there were errors,
+ *         TIMEOUT  if timed out,
+ *         OK       if successful
+ */
+XPD_ReturnType XPD_FLASH_Program_Blocking(void * Address, const void * Data, uint16_t Length, uint32_t Timeout)
+{
+    XPD_ReturnType result;
+
+    XPD_OS_SignalInit(&hflash->Signal);
+
+    result = XPD_FLASH_Program_IT(Address, Data, Length);
+
+    if (result == XPD_OK)
+    {
+        result = flash_waitBlocking(&Timeout);
+    }
+    return result;
+}
+
+/**
+ * @brief Performs consecutive flash erases, blocking the calling task until the erase is finished.
+ * @note  The FLASH interface should be unlocked beforehand, and locked afterwards.
+ * @note  Other tasks can only run meanwhile if they don't access the flash bank
+ *        being erased (e.g. they execute from RAM or from the other bank).
+ * @param Address: start address of first block to be erased
+ * @param kBytes: amount of flash memory to erase in kilobytes
+ * @param Timeout: available time for the operation in ms
+ * @return BUSY     if another operation is already ongoing,
+ *         ERROR    if there were errors,
+ *         TIMEOUT  if timed out,
+ *         OK       if successful
+ */
+XPD_ReturnType XPD_FLASH_Erase_Blocking(void * Address, uint16_t kBytes, uint32_t Timeout)
+{
+    XPD_ReturnType result;
+
+    XPD_OS_SignalInit(&hflash->Signal);
+
+    result = XPD_FLASH_Erase_IT(Address, kBytes);
+
+    if (result == XPD_OK)
+    {
+        result = flash_waitBlocking(&Timeout);
+    }
+    return result;
+}
+#endif /* USE_XPD_OS */
+
 /**
  * @brief FLASH interrupt handler that manages consecutive block erasing
  *        and programming, and provides completion and error callbacks.
  */
-void XPD_FLASH_IRQHandler(void)
+XPD_FLASH_RAMFUNC void XPD_FLASH_IRQHandler(void)
 {
     /* Check FLASH error flags */
     flash_checkErrors();
@@ -440,6 +633,9 @@ void XPD_FLASH_IRQHandler(void)
     if (FLASH_GETOPERATION() == FLASH_OPERATION_NONE)
     {
         CLEAR_BIT(FLASH->CR.w, FLASH_CR_EOPIE | FLASH_CR_ERRIE);
+
+        /* Wake up the waiting task */
+        XPD_OS_SIGNAL(hflash->Signal);
     }
 }
 
@@ -452,6 +648,59 @@ FLASH_ErrorType XPD_FLASH_GetError(void)
     return hflash->Errors;
 }
 
+/**
+ * @brief Adds a job to the FLASH operation queue. The queued jobs are performed
+ *        one after the other in interrupt mode, and the Complete callback of the job
+ *        is called when it is finished.
+ * @note  The FLASH interface should be unlocked beforehand, and locked when the queue is idle.
+ *        The queue uses the XPD_FLASH_Callbacks, the FLASH interrupt has to be enabled.
+ *        The job structure (and its data) must remain valid until its Complete callback.
+ *        On single bank devices the CPU stalls while fetching from flash during an operation,
+ *        the whole driver path of the job processing is placed by XPD_FLASH_RAMFUNC.
+ *        To avoid the stalls completely, the job Complete callbacks and the vector table
+ *        have to be located in RAM as well.
+ * @param Job: pointer to the job to queue
+ * @return BUSY if the job is pending, otherwise the result of the job
+ */
+XPD_FLASH_RAMFUNC XPD_ReturnType XPD_FLASH_Queue_Submit(FLASH_JobType * Job)
+{
+    FLASH_JobType * tail;
+
+    Job->Next   = NULL;
+    Job->Result = XPD_BUSY;
+
+    XPD_ENTER_CRITICAL(hflash);
+
+    tail = hflash->Queue.Tail;
+    if (tail != NULL)
+    {
+        tail->Next = Job;
+    }
+    else
+    {
+        hflash->Queue.Head = Job;
+    }
+    hflash->Queue.Tail = Job;
+
+    XPD_EXIT_CRITICAL(hflash);
+
+    /* The FLASH is idle, start the job now */
+    if (tail == NULL)
+    {
+        flash_queueStart();
+    }
+    return Job->Result;
+}
+
+/**
+ * @brief Determines whether all the queued FLASH jobs are finished.
+ * @return TRUE if the queue is empty, FALSE otherwise
+ */
+XPD_FLASH_RAMFUNC boolean_t XPD_FLASH_Queue_Idle(void)
+{
+    return (hflash->Queue.Head == NULL) ? TRUE : FALSE;
+}
+
 /** @} */
 
 XPD_FLASH_CallbacksType XPD_FLASH_Callbacks = { NULL, NULL, NULL };
@@ -459,3 +708,29 @@ XPD_FLASH_CallbacksType XPD_FLASH_Callbacks = { NULL, NULL, NULL };
 /** @} */
 
 #endif /* USE_XPD_FLASH */
+
+/** @addtogroup FLASH
+ * @{ */
+
+/** @addtogroup FLASH_Exported_Functions
+ * @{ */
+
+/**
+ * @brief Determines the minimal flash access latency for the HCLK frequency.
+ * @param HCLK_Frequency: the target AHB clock frequency [Hz]
+ * @return The minimal number of flash wait states
+ */
+uint8_t XPD_FLASH_GetMinLatency(uint32_t HCLK_Frequency)
+{
+    uint8_t latency = 0;
+
+    if (HCLK_Frequency > FLASH_WAITSTATE_FREQ)
+    {
+        latency = (HCLK_Frequency - 1) / FLASH_WAITSTATE_FREQ;
+    }
+    return latency;
+}
+
+/** @} */
+
+/** @} */
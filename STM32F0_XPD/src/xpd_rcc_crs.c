@@ -31,6 +31,63 @@
 /** @addtogroup RCC_CRS
  * @{ */
 
+/* The synchronization monitor is updated from the CRS interrupt context,
+ * the history is a ring of the last frequency error captures */
+static struct {
+    int32_t History[CRS_HISTORY_SIZE];
+    volatile uint32_t Count;
+    volatile CRS_SyncStateType State;
+    uint8_t OkCount;
+    uint8_t OkIT;
+} crs_sync;
+
+/* Calculates the signed frequency error from the captured status */
+__STATIC_INLINE int32_t crs_errorValue(uint32_t ISR)
+{
+    int32_t value = (int32_t)((ISR & CRS_ISR_FECAP_Msk) >> CRS_ISR_FECAP_Pos);
+
+    return ((ISR & CRS_ISR_FEDIR) != 0) ? -value : value;
+}
+
+/* Updates the convergence state with a SYNC event */
+static void crs_syncUpdate(uint32_t Event, uint32_t ISR)
+{
+    if (crs_sync.State != CRS_STATE_OFF)
+    {
+        if ((Event & (CRS_ISR_SYNCOKF | CRS_ISR_SYNCWARNF)) != 0)
+        {
+            /* Record the frequency error captured at the SYNC event */
+            crs_sync.History[crs_sync.Count % CRS_HISTORY_SIZE] = crs_errorValue(ISR);
+            crs_sync.Count++;
+        }
+
+        if (Event == CRS_ISR_SYNCOKF)
+        {
+            if (crs_sync.OkCount < CRS_LOCK_COUNT)
+            {
+                crs_sync.OkCount++;
+            }
+            else if (crs_sync.State != CRS_STATE_LOCKED)
+            {
+                crs_sync.State = CRS_STATE_LOCKED;
+
+                /* Only the deviations are monitored in locked state */
+                if (crs_sync.OkIT == 0)
+                {
+                    XPD_CRS_DisableIT(SYNCOK);
+                }
+            }
+        }
+        else
+        {
+            crs_sync.OkCount = 0;
+            crs_sync.State = (Event == CRS_ISR_SYNCWARNF) ? CRS_STATE_TRIMMING : CRS_STATE_SEARCH;
+
+            XPD_CRS_EnableIT(SYNCOK);
+        }
+    }
+}
+
 /** @defgroup RCC_CRS_Exported_Functions RCC CRS Exported Functions
  * @{ */
 
@@ -159,6 +216,8 @@ CRS_StatusType XPD_CRS_GetStatus(void)
  */
 void XPD_CRS_IRQHandler(void)
 {
+    XPD_PROFILE_BEGIN();
+
     CRS_StatusType status = 0;
     uint32_t isr = CRS->ISR.w;
     uint32_t cr = CRS->CR.w;
@@ -167,6 +226,7 @@ void XPD_CRS_IRQHandler(void)
     if (((isr & CRS_ISR_SYNCOKF) != 0) && ((cr & CRS_CR_SYNCOKIE) != 0))
     {
         XPD_CRS_ClearFlag(SYNCOK);
+        crs_syncUpdate(CRS_ISR_SYNCOKF, isr);
 
         XPD_SAFE_CALLBACK(XPD_RCC_Callbacks.HSI48.SyncSuccess,);
     }
@@ -174,6 +234,7 @@ void XPD_CRS_IRQHandler(void)
     if (((isr & CRS_ISR_SYNCWARNF) != 0) && ((cr & CRS_CR_SYNCWARNIE) != 0))
     {
         XPD_CRS_ClearFlag(SYNCWARN);
+        crs_syncUpdate(CRS_ISR_SYNCWARNF, isr);
 
         XPD_SAFE_CALLBACK(XPD_RCC_Callbacks.HSI48.SyncWarning,);
     }
@@ -187,6 +248,8 @@ void XPD_CRS_IRQHandler(void)
     /* SyncErrors */
     if (((isr & CRS_ERROR_FLAGS_MASK) != 0) && ((cr & CRS_CR_ERRIE) != 0))
     {
+        crs_syncUpdate(isr & CRS_ERROR_FLAGS_MASK, isr);
+
         /* Calling XPD_RCC_CRS_GetStatus in callback context
          * will return the active errors */
         XPD_SAFE_CALLBACK(XPD_RCC_Callbacks.HSI48.SyncError,);
@@ -194,6 +257,76 @@ void XPD_CRS_IRQHandler(void)
         /* Flag is cleared after callback */
         XPD_CRS_ClearFlag(ERR);
     }
+
+    XPD_PROFILE_END();
+}
+
+/**
+ * @brief Starts the interrupt-driven monitoring of the automatic HSI48 synchronization.
+ * @note  The CRS shall be initialized with a SYNC source by @ref XPD_CRS_Init,
+ *        and the CRS interrupt line shall be enabled with @ref XPD_CRS_IRQHandler called.
+ *        When the USB SOF is the SYNC source, the USB peripheral is started on the
+ *        factory trimmed HSI48, and the lock is reached once the host sends SOF packets.
+ */
+void XPD_CRS_Sync_Start(void)
+{
+    uint32_t cr = CRS->CR.w;
+
+    crs_sync.Count   = 0;
+    crs_sync.OkCount = 0;
+    crs_sync.OkIT    = ((cr & CRS_CR_SYNCOKIE) != 0) ? 1 : 0;
+    crs_sync.State   = CRS_STATE_SEARCH;
+
+    /* Clear stale events, then enable the SYNC result interrupts */
+    CRS->ICR.w = CRS_ICR_SYNCOKC | CRS_ICR_SYNCWARNC | CRS_ICR_ERRC;
+    CRS->CR.w  = cr | CRS_CR_SYNCOKIE | CRS_CR_SYNCWARNIE | CRS_CR_ERRIE;
+}
+
+/**
+ * @brief Stops the monitoring of the HSI48 synchronization.
+ * @note  The automatic trimming remains active.
+ */
+void XPD_CRS_Sync_Stop(void)
+{
+    crs_sync.State = CRS_STATE_OFF;
+
+    CLEAR_BIT(CRS->CR.w, CRS_CR_SYNCWARNIE | CRS_CR_ERRIE |
+            ((crs_sync.OkIT == 0) ? CRS_CR_SYNCOKIE : 0));
+}
+
+/**
+ * @brief Returns the convergence state of the HSI48 synchronization.
+ * @return The current synchronization state
+ */
+CRS_SyncStateType XPD_CRS_GetSyncState(void)
+{
+    return crs_sync.State;
+}
+
+/**
+ * @brief Provides the recent frequency error captures of the SYNC events.
+ * @param History: the output array of signed frequency errors, the most recent first
+ * @param Count: the requested number of captures
+ * @return The number of captures written to the History
+ */
+uint8_t XPD_CRS_GetErrorHistory(int32_t * History, uint8_t Count)
+{
+    uint32_t last = crs_sync.Count;
+    uint8_t i;
+
+    if (Count > CRS_HISTORY_SIZE)
+    {
+        Count = CRS_HISTORY_SIZE;
+    }
+    if (Count > last)
+    {
+        Count = last;
+    }
+    for (i = 0; i < Count; i++)
+    {
+        History[i] = crs_sync.History[(last - 1 - i) % CRS_HISTORY_SIZE];
+    }
+    return Count;
 }
 
 /** @} */
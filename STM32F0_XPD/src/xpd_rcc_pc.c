@@ -346,6 +346,35 @@ uint32_t XPD_RTC_GetClockFreq(void)
 /** @} */
 #endif /* USE_XPD_RTC */
 
+#if defined(USE_XPD_SPI)
+#include "xpd_spi.h"
+
+/** @addtogroup SPI
+ * @{ */
+
+/** @addtogroup SPI_Clock_Source
+ * @{ */
+
+/** @defgroup SPI_Clock_Source_Exported_Functions SPI Clock Source Exported Functions
+ * @{ */
+
+/**
+ * @brief Returns the input clock frequency of the SPI.
+ * @param hspi: pointer to the SPI handle structure
+ * @return The clock frequency of the SPI in Hz
+ */
+uint32_t XPD_SPI_GetClockFreq(SPI_HandleType * hspi)
+{
+    return XPD_RCC_GetClockFreq(PCLK1);
+}
+
+/** @} */
+
+/** @} */
+
+/** @} */
+#endif /* USE_XPD_SPI */
+
 #if defined(USE_XPD_TIM)
 #include "xpd_tim.h"
 
@@ -22,6 +22,7 @@
   *  along with STM32_XPD.  If not, see <http://www.gnu.org/licenses/>.
   */
 #include "xpd_spi.h"
+#include "xpd_gpio.h"
 #include "xpd_utils.h"
 
 #if defined(USE_XPD_SPI)
@@ -53,6 +54,34 @@
 #define SPI_REG_BY_SIZE(REG, SIZE) \
     ((SIZE == 1) ? *((__IO uint8_t *)REG) : *((__IO uint16_t *)REG))
 
+#ifdef SPI_SR_FRLVL
+#define SPI_DMA_PACKED(HANDLE)      ((HANDLE)->DMAPacking)
+#else
+#define SPI_DMA_PACKED(HANDLE)      0
+#endif
+
+/* The number of DMA transfers for the data frames */
+#define SPI_DMA_COUNT(HANDLE, LENGTH) \
+    (((LENGTH) + SPI_DMA_PACKED(HANDLE)) >> SPI_DMA_PACKED(HANDLE))
+
+/* Waits until the ongoing transfer is finished on the bus */
+static XPD_ReturnType spi_waitFinished(SPI_HandleType * hspi, uint32_t * timeout)
+{
+    XPD_ReturnType result = XPD_OK;
+
+#ifdef SPI_SR_FTLVL
+    /* wait until the transmit FIFO is empty */
+    result = XPD_WaitForMatch(&hspi->Inst->SR.w, SPI_SR_FTLVL, 0, timeout);
+#endif
+
+    if (result == XPD_OK)
+    {
+        /* wait until the last data is shifted out */
+        result = XPD_WaitForMatch(&hspi->Inst->SR.w, SPI_SR_BSY, 0, timeout);
+    }
+    return result;
+}
+
 #ifdef USE_XPD_SPI_ERROR_DETECT
 /* Reinitialize CRC calculation by OFF-ON switch */
 __STATIC_INLINE void spi_initCRC(SPI_HandleType * hspi)
@@ -76,8 +105,8 @@ static XPD_ReturnType spi_receiveCRC(SPI_HandleType * hspi, uint32_t * timeout)
 
     if (result == XPD_OK)
     {
-        /* read CRC data from data register */
-        uint16_t temp = SPI_REG_BY_SIZE(&hspi->Inst->DR, hspi->RxStream.size);
+        /* read CRC data from data register, a 16 bit CRC is read at once */
+        uint16_t temp = SPI_REG_BY_SIZE(&hspi->Inst->DR, hspi->CRCSize);
     }
 
 #ifdef SPI_SR_FRLVL
@@ -89,14 +118,54 @@ static XPD_ReturnType spi_receiveCRC(SPI_HandleType * hspi, uint32_t * timeout)
     if (XPD_SPI_GetFlag(hspi, CRCERR) != 0)
     {
         hspi->Errors |= SPI_ERROR_CRC;
+        XPD_STATS_ERROR(hspi, SPI_ERROR_CRC);
         XPD_SPI_ClearFlag(hspi, CRCERR);
 
         result = XPD_ERROR;
     }
     return result;
 }
+
+#ifndef XPD_SPI_EXCLUDE_DMA
+/* Receives the CRC after the DMA reception of the data,
+ * returns 1 if the reception is finished by the interrupt handler */
+static uint8_t spi_dmaReceiveCRC(SPI_HandleType * hspi)
+{
+    if (SPI_REG_BIT(hspi, CR1, MSTR) != 0)
+    {
+        /* The master clocks the CRC right after the data, so it is only waited for */
+        uint32_t timeout = SPI_BUSY_TIMEOUT;
+
+        if (spi_receiveCRC(hspi, &timeout) != XPD_OK)
+        {
+            XPD_SAFE_CALLBACK(hspi->Callbacks.Error, hspi);
+        }
+
+        /* If master mode, and either simplex, or half duplex communication */
+        if (SPI_MASTER_RXONLY(hspi))
+        {
+            /* Disable SPI peripheral */
+            XPD_SPI_Disable(hspi);
+        }
+        return 0;
+    }
+    else
+    {
+        /* CRC reception is processed by SPI interrupt */
+#ifdef SPI_SR_FRLVL
+        /* Set FIFO threshold according to CRC size */
+        SPI_REG_BIT(hspi, CR2, FRXTH) = 2 - hspi->CRCSize;
+#endif
+        /* Enable RXNE and ERR interrupt */
+        SET_BIT(hspi->Inst->CR2.w, SPI_CR2_RXNEIE | SPI_CR2_ERRIE);
+
+        return 1;
+    }
+}
+#endif
 #endif
 
+#ifndef XPD_SPI_EXCLUDE_DMA
 static void spi_dmaTransmitRedirect(void * hdma)
 {
     SPI_HandleType * hspi = (SPI_HandleType*) ((DMA_HandleType*) hdma)->Owner;
@@ -122,10 +191,12 @@ static void spi_dmaTransmitRedirect(void * hdma)
         }
 
         /* Update stream status */
+        XPD_STATS_ADD(hspi, Bytes, hspi->TxStream.length * hspi->TxStream.size);
         hspi->TxStream.buffer += hspi->TxStream.length * hspi->TxStream.size;
         hspi->TxStream.length = 0;
     }
 
+    XPD_STATS_ADD(hspi, Transfers, 1);
     XPD_SAFE_CALLBACK(hspi->Callbacks.Transmit, hspi);
 }
 
@@ -139,26 +210,24 @@ static void spi_dmaReceiveRedirect(void * hdma)
         SPI_REG_BIT(hspi, CR2, RXDMAEN) = 0;
 
         /* Update stream status */
+        XPD_STATS_ADD(hspi, Bytes, hspi->RxStream.length * hspi->RxStream.size);
         hspi->RxStream.buffer += hspi->RxStream.length * hspi->RxStream.size;
         hspi->RxStream.length = 0;
 
-#ifdef USE_XPD_SPI_ERROR_DETECT
-        /* CRC handling */
-        if (hspi->CRCSize > 0)
-        {
-            /* CRC reception is processed by SPI interrupt */
 #ifdef SPI_SR_FRLVL
-            /* Set FIFO threshold according to CRC size */
-            SPI_REG_BIT(hspi, CR2, FRXTH) = 2 - hspi->CRCSize;
+        /* Reset Rx FIFO threshold after packed reception */
+        SPI_REG_BIT(hspi, CR2, FRXTH) = 2 - hspi->RxStream.size;
 #endif
-            /* Enable RXNE and ERR interrupt */
-            SET_BIT(hspi->Inst->CR2.w, SPI_CR2_RXNEIE | SPI_CR2_ERRIE);
 
-            /* callback is provided in interrupt handler in CRC mode */
+#ifdef USE_XPD_SPI_ERROR_DETECT
+        /* CRC handling, the slave's callback is provided in interrupt handler */
+        if ((hspi->CRCSize > 0) && (spi_dmaReceiveCRC(hspi) != 0))
+        {
             return;
         }
 #endif
     }
+    XPD_STATS_ADD(hspi, Transfers, 1);
     XPD_SAFE_CALLBACK(hspi->Callbacks.Receive, hspi);
 }
 
@@ -172,30 +241,31 @@ static void spi_dmaTransmitReceiveRedirect(void * hdma)
         CLEAR_BIT(hspi->Inst->CR2.w, SPI_CR2_RXDMAEN | SPI_CR2_TXDMAEN);
 
         /* Update stream status */
+        XPD_STATS_ADD(hspi, Bytes, hspi->RxStream.length * hspi->RxStream.size);
         hspi->RxStream.buffer += hspi->RxStream.length * hspi->RxStream.size;
         hspi->RxStream.length = 0;
+        XPD_STATS_ADD(hspi, Bytes, hspi->TxStream.length * hspi->TxStream.size);
         hspi->TxStream.buffer += hspi->TxStream.length * hspi->TxStream.size;
         hspi->TxStream.length = 0;
 
-#ifdef USE_XPD_SPI_ERROR_DETECT
-        /* CRC handling */
-        if (hspi->CRCSize > 0)
-        {
-            /* CRC reception is processed by SPI interrupt */
 #ifdef SPI_SR_FRLVL
-            /* Set FIFO threshold according to CRC size */
-            SPI_REG_BIT(hspi, CR2, FRXTH) = 2 - hspi->CRCSize;
+        /* Reset Rx FIFO threshold after packed reception */
+        SPI_REG_BIT(hspi, CR2, FRXTH) = 2 - hspi->RxStream.size;
 #endif
-            /* Enable RXNE and ERR interrupt */
-            SET_BIT(hspi->Inst->CR2.w, SPI_CR2_RXNEIE | SPI_CR2_ERRIE);
 
-            /* receive callback is provided in interrupt handler in CRC mode */
+#ifdef USE_XPD_SPI_ERROR_DETECT
+        /* CRC handling, the slave's receive callback is provided in interrupt handler */
+        if ((hspi->CRCSize > 0) && (spi_dmaReceiveCRC(hspi) != 0))
+        {
+            XPD_STATS_ADD(hspi, Transfers, 1);
             XPD_SAFE_CALLBACK(hspi->Callbacks.Transmit, hspi);
             return;
         }
 #endif
     }
+    XPD_STATS_ADD(hspi, Transfers, 1);
     XPD_SAFE_CALLBACK(hspi->Callbacks.Transmit, hspi);
+    XPD_STATS_ADD(hspi, Transfers, 1);
     XPD_SAFE_CALLBACK(hspi->Callbacks.Receive, hspi);
 }
 
@@ -205,11 +275,185 @@ static void spi_dmaErrorRedirect(void * hdma)
     SPI_HandleType * hspi = (SPI_HandleType*) ((DMA_HandleType*) hdma)->Owner;
 
     hspi->Errors |= SPI_ERROR_DMA;
+    XPD_STATS_ERROR(hspi, SPI_ERROR_DMA);
 
     XPD_SAFE_CALLBACK(hspi->Callbacks.Error, hspi);
 }
 #endif
 
+static void spi_queueRedirect(void * handle);
+static void spi_queueCommandRedirect(void * handle);
+
+/* The transmit DMA completes ahead of the bus,
+ * the transaction is continued from the TXE interrupt of the drained transmitter */
+static void spi_queueTransmitDrain(void * handle)
+{
+    SPI_HandleType * hspi = (SPI_HandleType*)handle;
+
+    hspi->Callbacks.Transmit = spi_queueRedirect;
+    XPD_SPI_EnableIT(hspi, TXE);
+}
+
+static void spi_queueCommandDrain(void * handle)
+{
+    SPI_HandleType * hspi = (SPI_HandleType*)handle;
+
+    hspi->Callbacks.Transmit = spi_queueCommandRedirect;
+    XPD_SPI_EnableIT(hspi, TXE);
+}
+
+/* Starts the data transfer of the transaction */
+static XPD_ReturnType spi_queueTransfer(SPI_HandleType * hspi, SPI_TransactionType * transaction)
+{
+    XPD_ReturnType result;
+
+    /* The transaction end is signalled by the last active stream */
+    if (transaction->RxData == NULL)
+    {
+        hspi->Callbacks.Transmit = spi_queueTransmitDrain;
+        hspi->Callbacks.Receive  = NULL;
+
+        result = XPD_SPI_Transmit_DMA(hspi, transaction->TxData, transaction->Length);
+    }
+    else
+    {
+        hspi->Callbacks.Transmit = NULL;
+        hspi->Callbacks.Receive  = spi_queueRedirect;
+
+        result = XPD_SPI_TransmitReceive_DMA(hspi, transaction->TxData,
+                transaction->RxData, transaction->Length);
+    }
+    return result;
+}
+
+/* Continues the transaction with the data transfer after the command header */
+static void spi_queueCommandRedirect(void * handle)
+{
+    SPI_HandleType * hspi = (SPI_HandleType*)handle;
+    SPI_TransactionType * transaction = hspi->Queue.Head;
+    uint32_t timeout = SPI_BUSY_TIMEOUT;
+    XPD_ReturnType result;
+
+    /* The data received during the command header is discarded,
+     * at most the last frame is still on the bus */
+    (void) spi_waitFinished(hspi, &timeout);
+    while (XPD_SPI_GetFlag(hspi, RXNE) != 0)
+    {
+        uint16_t temp = SPI_REG_BY_SIZE(&hspi->Inst->DR, hspi->RxStream.size);
+    }
+    XPD_SPI_ClearFlag(hspi, OVR);
+
+    result = spi_queueTransfer(hspi, transaction);
+
+    /* Transaction could not be continued, finish it */
+    if (result != XPD_OK)
+    {
+        transaction->Result = result;
+        spi_queueRedirect(hspi);
+    }
+}
+
+/* Configures the bus for the first queued transaction and starts it */
+static void spi_queueStart(SPI_HandleType * hspi)
+{
+    SPI_TransactionType * transaction = hspi->Queue.Head;
+    XPD_ReturnType result;
+
+    /* Clock configuration can only be changed when the peripheral is disabled */
+    if (    (SPI_REG_BIT(hspi, CR1, CPOL) != transaction->Clock.Polarity)
+         || (SPI_REG_BIT(hspi, CR1, CPHA) != transaction->Clock.Phase)
+         || (hspi->Inst->CR1.b.BR != (transaction->Clock.Prescaler - 1)))
+    {
+        XPD_SPI_Disable(hspi);
+
+        SPI_REG_BIT(hspi, CR1, CPOL) = transaction->Clock.Polarity;
+        SPI_REG_BIT(hspi, CR1, CPHA) = transaction->Clock.Phase;
+        hspi->Inst->CR1.b.BR = transaction->Clock.Prescaler - 1;
+    }
+
+    /* Select the slave */
+    if (transaction->CS_Port != NULL)
+    {
+        XPD_GPIO_WritePin(transaction->CS_Port, transaction->CS_Pin, 0);
+    }
+
+    /* The command header is transmitted first, with the same chip select */
+    if (transaction->CommandLength > 0)
+    {
+        hspi->Callbacks.Transmit = spi_queueCommandDrain;
+        hspi->Callbacks.Receive  = NULL;
+
+        result = XPD_SPI_Transmit_DMA(hspi, (void*)transaction->Command, transaction->CommandLength);
+    }
+    else
+    {
+        result = spi_queueTransfer(hspi, transaction);
+    }
+
+    /* Transaction could not be started, finish it */
+    if (result != XPD_OK)
+    {
+        transaction->Result = result;
+        spi_queueRedirect(hspi);
+    }
+}
+
+/* Finishes the ongoing transaction and starts the next queued one */
+static void spi_queueRedirect(void * handle)
+{
+    SPI_HandleType * hspi = (SPI_HandleType*)handle;
+    SPI_TransactionType * transaction = hspi->Queue.Head;
+    uint32_t timeout = SPI_BUSY_TIMEOUT;
+
+    /* Wait until the last frame is shifted out before deselecting the slave */
+    (void) spi_waitFinished(hspi, &timeout);
+
+    if (transaction->CS_Port != NULL)
+    {
+        XPD_GPIO_WritePin(transaction->CS_Port, transaction->CS_Pin, 1);
+    }
+
+    XPD_ENTER_CRITICAL(hspi);
+
+    /* Remove the finished transaction from the queue */
+    hspi->Queue.Head = transaction->Next;
+    if (hspi->Queue.Head == NULL)
+    {
+        hspi->Queue.Tail = NULL;
+    }
+
+    XPD_EXIT_CRITICAL(hspi);
+
+    /* Start the next transaction without delay */
+    if (hspi->Queue.Head != NULL)
+    {
+        spi_queueStart(hspi);
+    }
+
+    /* Release the completion token */
+    if (transaction->Result == XPD_BUSY)
+    {
+        transaction->Result = XPD_OK;
+#ifdef USE_XPD_SPI_ERROR_DETECT
+        /* The received data failed the CRC check */
+        if ((hspi->Errors & SPI_ERROR_CRC) != 0)
+        {
+            transaction->Result = XPD_ERROR;
+        }
+#endif
+    }
+    XPD_SAFE_CALLBACK(transaction->Complete, transaction);
+}
+
+#ifdef USE_XPD_OS
+/* Wakes up the task waiting for the finished transaction */
+static void spi_blockingRedirect(void * transaction)
+{
+    XPD_OS_SIGNAL(((SPI_TransactionType*)transaction)->Signal);
+}
+#endif
+#endif /* XPD_SPI_EXCLUDE_DMA */
+
 /** @defgroup SPI_Exported_Functions SPI Exported Functions
  * @{ */
 
@@ -238,6 +482,7 @@ XPD_ReturnType XPD_SPI_Init(SPI_HandleType * hspi, const SPI_InitType * Config)
     SPI_REG_BIT(hspi, CR1, LSBFIRST) = Config->Format;
 
     hspi->Inst->CR1.b.BR = Config->Clock.Prescaler - 1;
+    hspi->ClockFreq      = XPD_SPI_GetClockFreq(hspi) >> Config->Clock.Prescaler;
 
 #ifdef USE_XPD_SPI_ERROR_DETECT
     /* Disable CRC by setting 0 length */
@@ -295,6 +540,9 @@ XPD_ReturnType XPD_SPI_Init(SPI_HandleType * hspi, const SPI_InitType * Config)
     /* Initialize handle variables */
     hspi->TxStream.length = hspi->RxStream.length = 0;
     hspi->TxStream.size   = hspi->RxStream.size   = (Config->DataSize <= 8) ? 1 : 2;
+#ifdef SPI_SR_FRLVL
+    hspi->DMAPacking = 0;
+#endif
 
     /* Dependencies initialization */
     XPD_SAFE_CALLBACK(hspi->Callbacks.DepInit, hspi);
@@ -367,6 +615,7 @@ XPD_ReturnType XPD_SPI_PollStatus(SPI_HandleType * hspi, uint32_t Timeout)
     {
         /* Update error code */
         hspi->Errors |= SPI_ERROR_OVERRUN;
+        XPD_STATS_ERROR(hspi, SPI_ERROR_OVERRUN);
 
         /* Clear the transfer error flag */
         XPD_SPI_ClearFlag(hspi, OVR);
@@ -377,6 +626,7 @@ XPD_ReturnType XPD_SPI_PollStatus(SPI_HandleType * hspi, uint32_t Timeout)
     {
         /* Update error code */
         hspi->Errors |= SPI_ERROR_MODE;
+        XPD_STATS_ERROR(hspi, SPI_ERROR_MODE);
 
         /* Clear the transfer error flag */
         XPD_SPI_ClearFlag(hspi, MODF);
@@ -387,6 +637,7 @@ XPD_ReturnType XPD_SPI_PollStatus(SPI_HandleType * hspi, uint32_t Timeout)
     {
         /* Update error code */
         hspi->Errors |= SPI_ERROR_CRC;
+        XPD_STATS_ERROR(hspi, SPI_ERROR_CRC);
 
         /* Clear the transfer error flag */
         XPD_SPI_ClearFlag(hspi, CRCERR);
@@ -397,6 +648,7 @@ XPD_ReturnType XPD_SPI_PollStatus(SPI_HandleType * hspi, uint32_t Timeout)
     {
         /* Update error code */
         hspi->Errors |= SPI_ERROR_FRAME;
+        XPD_STATS_ERROR(hspi, SPI_ERROR_FRAME);
 
         /* Clear the transfer error flag */
         XPD_SPI_ClearFlag(hspi, FRE);
@@ -647,6 +899,7 @@ XPD_ReturnType XPD_SPI_TransmitReceive(SPI_HandleType * hspi, void * TxData, voi
  * @note  The Transmit callback will be called when the last data is written to buffer,
  *        the user has to wait for the end of that transfer by XPD_SPI_PollStatus() before
  *        switching ChipSelect or starting a new reception.
+ *        When CRC is enabled, the peripheral transmits it after the last data.
  * @param hspi: pointer to the SPI handle structure
  * @param TxData: pointer to the data buffer
  * @param Length: amount of data transfers
@@ -763,6 +1016,9 @@ void XPD_SPI_TransmitReceive_IT(SPI_HandleType * hspi, void * TxData, void * RxD
  */
 void XPD_SPI_IRQHandler(SPI_HandleType * hspi)
 {
+    XPD_PROFILE_BEGIN();
+    XPD_STATS_IRQ_BEGIN();
+
     uint32_t cr2 = hspi->Inst->CR2.w;
     uint32_t sr = hspi->Inst->SR.w;
 
@@ -778,6 +1034,7 @@ void XPD_SPI_IRQHandler(SPI_HandleType * hspi)
             {
                 /* Read data from FIFO */
                 XPD_ReadToStream(&hspi->Inst->DR, &hspi->RxStream);
+                XPD_STATS_ADD(hspi, Bytes, hspi->RxStream.size);
 
                 /* This is done to handle the CRCNEXT before the last data */
                 if (hspi->RxStream.length == 1)
@@ -796,8 +1053,8 @@ void XPD_SPI_IRQHandler(SPI_HandleType * hspi)
             }
             else
             {
-                /* read CRC data from data register */
-                uint16_t temp = SPI_REG_BY_SIZE(&hspi->Inst->DR, hspi->RxStream.size);
+                /* read CRC data from data register, a 16 bit CRC is read at once */
+                uint16_t temp = SPI_REG_BY_SIZE(&hspi->Inst->DR, hspi->CRCSize);
 #ifdef SPI_SR_FRLVL
                 /* Reset Rx FIFO threshold */
                 SPI_REG_BIT(hspi, CR2, FRXTH) = 2 - hspi->RxStream.size;
@@ -807,6 +1064,7 @@ void XPD_SPI_IRQHandler(SPI_HandleType * hspi)
                 if ((sr & SPI_SR_CRCERR) != 0)
                 {
                     hspi->Errors |= SPI_ERROR_CRC;
+                    XPD_STATS_ERROR(hspi, SPI_ERROR_CRC);
                     XPD_SPI_ClearFlag(hspi, CRCERR);
 
                     /* error callback */
@@ -824,6 +1082,7 @@ void XPD_SPI_IRQHandler(SPI_HandleType * hspi)
                 CLEAR_BIT(hspi->Inst->CR2.w, SPI_CR2_RXNEIE | SPI_CR2_ERRIE);
 
                 /* reception finished callback */
+                XPD_STATS_ADD(hspi, Transfers, 1);
                 XPD_SAFE_CALLBACK(hspi->Callbacks.Receive, hspi);
             }
         }
@@ -831,6 +1090,16 @@ void XPD_SPI_IRQHandler(SPI_HandleType * hspi)
 #endif
         {
             XPD_ReadToStream(&hspi->Inst->DR, &hspi->RxStream);
+            XPD_STATS_ADD(hspi, Bytes, hspi->RxStream.size);
+
+#ifdef SPI_SR_FRLVL
+            /* Drain the available data from the receive FIFO */
+            while ((hspi->RxStream.length > 0) && (XPD_SPI_GetFlag(hspi, RXNE) != 0))
+            {
+                XPD_ReadToStream(&hspi->Inst->DR, &hspi->RxStream);
+                XPD_STATS_ADD(hspi, Bytes, hspi->RxStream.size);
+            }
+#endif
 
             /* End of reception */
             if (hspi->RxStream.length == 0)
@@ -846,15 +1115,34 @@ void XPD_SPI_IRQHandler(SPI_HandleType * hspi)
                 CLEAR_BIT(hspi->Inst->CR2.w, SPI_CR2_RXNEIE | SPI_CR2_ERRIE);
 
                 /* reception finished callback */
+                XPD_STATS_ADD(hspi, Transfers, 1);
                 XPD_SAFE_CALLBACK(hspi->Callbacks.Receive, hspi);
             }
         }
     }
 
+    /* Transmitter drained after a DMA transmission */
+    if (((sr & SPI_SR_TXE) != 0) && ((cr2 & SPI_CR2_TXEIE) != 0) && (hspi->TxStream.length == 0))
+    {
+        XPD_SPI_DisableIT(hspi, TXE);
+
+        XPD_SAFE_CALLBACK(hspi->Callbacks.Transmit, hspi);
+    }
     /* Successful transmission */
-    if (((sr & SPI_SR_TXE) != 0) && ((cr2 & SPI_CR2_TXEIE) != 0))
+    else if (((sr & SPI_SR_TXE) != 0) && ((cr2 & SPI_CR2_TXEIE) != 0))
     {
         XPD_WriteFromStream(&hspi->Inst->DR, &hspi->TxStream);
+        XPD_STATS_ADD(hspi, Bytes, hspi->TxStream.size);
+
+#ifdef SPI_SR_FRLVL
+        /* Fill the transmit FIFO when there is no reception to overrun */
+        while ((hspi->TxStream.length > 0) && ((cr2 & SPI_CR2_RXNEIE) == 0)
+                && (XPD_SPI_GetFlag(hspi, TXE) != 0))
+        {
+            XPD_WriteFromStream(&hspi->Inst->DR, &hspi->TxStream);
+            XPD_STATS_ADD(hspi, Bytes, hspi->TxStream.size);
+        }
+#endif
 
         if (hspi->TxStream.length == 0)
         {
@@ -882,6 +1170,7 @@ void XPD_SPI_IRQHandler(SPI_HandleType * hspi)
                 XPD_SPI_ClearFlag(hspi, OVR);
             }
 
+            XPD_STATS_ADD(hspi, Transfers, 1);
             XPD_SAFE_CALLBACK(hspi->Callbacks.Transmit, hspi);
         }
     }
@@ -893,16 +1182,19 @@ void XPD_SPI_IRQHandler(SPI_HandleType * hspi)
         if ((sr & SPI_SR_OVR) != 0)
         {
             hspi->Errors |= SPI_ERROR_OVERRUN;
+            XPD_STATS_ERROR(hspi, SPI_ERROR_OVERRUN);
             XPD_SPI_ClearFlag(hspi, OVR);
         }
         if ((sr & SPI_SR_MODF) != 0)
         {
             hspi->Errors |= SPI_ERROR_MODE;
+            XPD_STATS_ERROR(hspi, SPI_ERROR_MODE);
             XPD_SPI_ClearFlag(hspi, MODF);
         }
         if ((sr & SPI_SR_FRE) != 0)
         {
             hspi->Errors |= SPI_ERROR_FRAME;
+            XPD_STATS_ERROR(hspi, SPI_ERROR_FRAME);
             XPD_SPI_ClearFlag(hspi, FRE);
         }
         /* Clear interrupt enable bits */
@@ -911,13 +1203,18 @@ void XPD_SPI_IRQHandler(SPI_HandleType * hspi)
         XPD_SAFE_CALLBACK(hspi->Callbacks.Error, hspi);
     }
 #endif
+
+    XPD_STATS_IRQ_END(hspi);
+    XPD_PROFILE_END();
 }
 
+#ifndef XPD_SPI_EXCLUDE_DMA
 /**
  * @brief Starts DMA-managed data transmission over SPI.
  * @note  The Transmit callback will be called when the last data is written to buffer,
  *        the user has to wait for the end of that transfer by XPD_SPI_PollStatus() before
  *        switching ChipSelect or starting a new reception.
+ *        When CRC is enabled, the peripheral transmits it after the last data.
  * @param hspi: pointer to the SPI handle structure
  * @param TxData: pointer to the data buffer
  * @param Length: amount of data transfers
@@ -932,7 +1229,8 @@ XPD_ReturnType XPD_SPI_Transmit_DMA(SPI_HandleType * hspi, void * TxData, uint16
     hspi->TxStream.length = Length;
 
     /* Set up DMA for transfer */
-    result = XPD_DMA_Start_IT(hspi->DMA.Transmit, (void*) &hspi->Inst->DR, TxData, Length);
+    result = XPD_DMA_Start_IT(hspi->DMA.Transmit, (void*) &hspi->Inst->DR, TxData,
+            SPI_DMA_COUNT(hspi, Length));
 
     if (result == XPD_OK)
     {
@@ -960,6 +1258,11 @@ XPD_ReturnType XPD_SPI_Transmit_DMA(SPI_HandleType * hspi, void * TxData, uint16
             SPI_REG_BIT(hspi, CR1, BIDIOE) = 1;
         }
 
+#ifdef SPI_SR_FRLVL
+        /* Odd number of packed frames: the last DMA transfer contains a single frame */
+        SPI_REG_BIT(hspi, CR2, LDMATX) = Length & SPI_DMA_PACKED(hspi);
+#endif
+
         /* Enable Tx DMA Request */
         SPI_REG_BIT(hspi, CR2, TXDMAEN) = 1;
 
@@ -971,6 +1274,10 @@ XPD_ReturnType XPD_SPI_Transmit_DMA(SPI_HandleType * hspi, void * TxData, uint16
 
 /**
  * @brief Starts DMA-managed data reception over SPI.
+ * @note  When CRC is enabled, the received CRC is checked after the data: by the master
+ *        in the DMA completion, by the slave in @ref XPD_SPI_IRQHandler (then the SPI
+ *        interrupt has to be enabled). A mismatch sets SPI_ERROR_CRC and calls the
+ *        Error callback before the Receive callback.
  * @param hspi: pointer to the SPI handle structure
  * @param RxData: pointer to the data buffer
  * @param Length: amount of data transfers
@@ -994,7 +1301,8 @@ XPD_ReturnType XPD_SPI_Receive_DMA(SPI_HandleType * hspi, void * RxData, uint16_
         hspi->RxStream.length = Length;
 
         /* Set up DMA for transfer */
-        result = XPD_DMA_Start_IT(hspi->DMA.Receive, (void*) &hspi->Inst->DR, RxData, Length);
+        result = XPD_DMA_Start_IT(hspi->DMA.Receive, (void*) &hspi->Inst->DR, RxData,
+                SPI_DMA_COUNT(hspi, Length));
 
         if (result == XPD_OK)
         {
@@ -1022,6 +1330,16 @@ XPD_ReturnType XPD_SPI_Receive_DMA(SPI_HandleType * hspi, void * RxData, uint16_
                 SPI_REG_BIT(hspi, CR1, BIDIOE) = 0;
             }
 
+#ifdef SPI_SR_FRLVL
+            if (SPI_DMA_PACKED(hspi) != 0)
+            {
+                /* Rx FIFO threshold is set to half full for packed reception */
+                SPI_REG_BIT(hspi, CR2, FRXTH) = 0;
+            }
+            /* Odd number of packed frames: the last DMA transfer contains a single frame */
+            SPI_REG_BIT(hspi, CR2, LDMARX) = Length & SPI_DMA_PACKED(hspi);
+#endif
+
             /* Enable Rx DMA Request */
             SPI_REG_BIT(hspi, CR2, RXDMAEN) = 1;
 
@@ -1034,6 +1352,8 @@ XPD_ReturnType XPD_SPI_Receive_DMA(SPI_HandleType * hspi, void * RxData, uint16_
 
 /**
  * @brief Starts DMA-managed full-duplex data transfer over SPI.
+ * @note  When CRC is enabled, it is transmitted after the last data,
+ *        and the received CRC is checked as in @ref XPD_SPI_Receive_DMA.
  * @param hspi: pointer to the SPI handle structure
  * @param TxData: pointer to the transmitted data buffer
  * @param RxData: pointer to the received data buffer
@@ -1060,11 +1380,13 @@ XPD_ReturnType XPD_SPI_TransmitReceive_DMA(SPI_HandleType * hspi, void * TxData,
     }
 
     /* Set up DMAs for transfers */
-    result = XPD_DMA_Start_IT(hspi->DMA.Receive, (void*) &hspi->Inst->DR, RxData, Length);
+    result = XPD_DMA_Start_IT(hspi->DMA.Receive, (void*) &hspi->Inst->DR, RxData,
+            SPI_DMA_COUNT(hspi, Length));
 
     if (result == XPD_OK)
     {
-        result = XPD_DMA_Start_IT(hspi->DMA.Transmit, (void*) &hspi->Inst->DR, TxData, Length);
+        result = XPD_DMA_Start_IT(hspi->DMA.Transmit, (void*) &hspi->Inst->DR, TxData,
+                SPI_DMA_COUNT(hspi, Length));
 
         /* If one DMA allocation failed, reset the other and exit */
         if (result != XPD_OK)
@@ -1109,6 +1431,17 @@ XPD_ReturnType XPD_SPI_TransmitReceive_DMA(SPI_HandleType * hspi, void * TxData,
         }
 #endif
 
+#ifdef SPI_SR_FRLVL
+        if (SPI_DMA_PACKED(hspi) != 0)
+        {
+            /* Rx FIFO threshold is set to half full for packed reception */
+            SPI_REG_BIT(hspi, CR2, FRXTH) = 0;
+        }
+        /* Odd number of packed frames: the last DMA transfer contains a single frame */
+        SPI_REG_BIT(hspi, CR2, LDMARX) = Length & SPI_DMA_PACKED(hspi);
+        SPI_REG_BIT(hspi, CR2, LDMATX) = Length & SPI_DMA_PACKED(hspi);
+#endif
+
         /* Enable DMA Requests */
         SET_BIT(hspi->Inst->CR2.w, SPI_CR2_RXDMAEN | SPI_CR2_TXDMAEN);
 
@@ -1133,6 +1466,12 @@ void XPD_SPI_Stop_DMA(SPI_HandleType * hspi)
         /* Read remaining transfer count */
         remaining = XPD_DMA_GetStatus(hspi->DMA.Transmit);
 
+        /* Convert packed transfers to data frames */
+        if ((SPI_DMA_PACKED(hspi) != 0) && (remaining > 0))
+        {
+            remaining = remaining * 2 - (hspi->TxStream.length & 1);
+        }
+
         /* Update transfer context */
         hspi->TxStream.buffer += (hspi->TxStream.length - remaining)
                 * hspi->TxStream.size;
@@ -1149,6 +1488,12 @@ void XPD_SPI_Stop_DMA(SPI_HandleType * hspi)
         /* Read remaining transfer count */
         remaining = XPD_DMA_GetStatus(hspi->DMA.Receive);
 
+        /* Convert packed transfers to data frames */
+        if ((SPI_DMA_PACKED(hspi) != 0) && (remaining > 0))
+        {
+            remaining = remaining * 2 - (hspi->RxStream.length & 1);
+        }
+
         /* Update transfer context */
         hspi->RxStream.buffer += (hspi->RxStream.length - remaining)
                 * hspi->RxStream.size;
@@ -1158,6 +1503,374 @@ void XPD_SPI_Stop_DMA(SPI_HandleType * hspi)
     }
 }
 
+#ifdef SPI_SR_FRLVL
+/**
+ * @brief Sets the packing of data frames in DMA transfers. When enabled, two data frames
+ *        of up to 8 bits are moved by each half-word DMA transfer, halving the DMA bus load.
+ * @note  The data widths of the handle's DMA streams are set by this function,
+ *        therefore it can only be used when no DMA transfer is ongoing.
+ *        The data buffers shall be half-word aligned when packing is used.
+ * @param hspi: pointer to the SPI handle structure
+ * @param NewState: the new packing state
+ * @return ERROR if the data frames are larger than 8 bits or CRC is used, OK if successful
+ */
+XPD_ReturnType XPD_SPI_DMAPackingConfig(SPI_HandleType * hspi, FunctionalState NewState)
+{
+    XPD_ReturnType result = XPD_ERROR;
+
+    if ((hspi->TxStream.size == 1) && (SPI_REG_BIT(hspi, CR1, CRCEN) == 0))
+    {
+        DMA_AlignmentType align = (NewState != DISABLE) ? DMA_ALIGN_HALFWORD : DMA_ALIGN_BYTE;
+
+        if (hspi->DMA.Transmit != NULL)
+        {
+            XPD_DMA_SetDataAlignment(hspi->DMA.Transmit, align, align);
+        }
+        if (hspi->DMA.Receive != NULL)
+        {
+            XPD_DMA_SetDataAlignment(hspi->DMA.Receive, align, align);
+        }
+
+        hspi->DMAPacking = (NewState != DISABLE) ? 1 : 0;
+        result = XPD_OK;
+    }
+    return result;
+}
+#endif
+
+/**
+ * @brief Starts the continuous slave mode exchange of variable length frames over SPI
+ *        using circular DMA buffers. The frames are delimited by the master's NSS signal,
+ *        whose rising edge EXTI callback has to call @ref XPD_SPI_SlaveStream_FrameEnd.
+ * @note  Both DMA streams have to be configured in circular mode, and DMA packing is not supported.
+ *        The transmit buffer is sent in a loop, the response for the next frame has to be
+ *        placed starting at the Frame.TxStart index. The first data of each frame are the ones
+ *        already loaded into the transmitter before the response was updated.
+ * @param hspi: pointer to the SPI handle structure
+ * @param TxData: pointer to the circular transmit buffer (if NULL, the receive buffer is transmitted)
+ * @param RxData: pointer to the circular receive buffer
+ * @param Length: the amount of data transfers in each buffer
+ * @return ERROR if not in slave mode or the DMAs are not circular, BUSY if a DMA is in use,
+ *         OK if the stream is started
+ */
+XPD_ReturnType XPD_SPI_SlaveStream_Start(SPI_HandleType * hspi, void * TxData, void * RxData, uint16_t Length)
+{
+    XPD_ReturnType result = XPD_ERROR;
+
+    if (TxData == NULL)
+    {
+        TxData = RxData;
+    }
+
+    if ((SPI_REG_BIT(hspi, CR1, MSTR) == 0) && (SPI_DMA_PACKED(hspi) == 0) &&
+        (XPD_DMA_CircularMode(hspi->DMA.Receive) != 0) &&
+        (XPD_DMA_CircularMode(hspi->DMA.Transmit) != 0))
+    {
+        /* save stream info */
+        hspi->RxStream.buffer = RxData;
+        hspi->RxStream.length = Length;
+        hspi->TxStream.buffer = TxData;
+        hspi->TxStream.length = Length;
+
+        /* Set up DMAs for transfers */
+        result = XPD_DMA_Start_IT(hspi->DMA.Receive, (void*) &hspi->Inst->DR, RxData, Length);
+    }
+
+    if (result == XPD_OK)
+    {
+        result = XPD_DMA_Start_IT(hspi->DMA.Transmit, (void*) &hspi->Inst->DR, TxData, Length);
+
+        /* If one DMA allocation failed, reset the other and exit */
+        if (result != XPD_OK)
+        {
+            XPD_DMA_Stop_IT(hspi->DMA.Receive);
+            return result;
+        }
+
+        /* Set the callback owners */
+        hspi->DMA.Receive->Owner  = hspi;
+        hspi->DMA.Transmit->Owner = hspi;
+
+        /* The frames are delimited by the NSS edges instead of the buffer wraps */
+        hspi->DMA.Receive->Callbacks.Complete  = NULL;
+        hspi->DMA.Transmit->Callbacks.Complete = NULL;
+#ifdef USE_XPD_DMA_ERROR_DETECT
+        hspi->DMA.Receive->Callbacks.Error     = spi_dmaErrorRedirect;
+        hspi->DMA.Transmit->Callbacks.Error    = spi_dmaErrorRedirect;
+#endif
+        SPI_RESET_ERRORS(hspi);
+
+        hspi->Frame.RxStart  = 0;
+        hspi->Frame.RxLength = 0;
+        hspi->Frame.TxStart  = 0;
+
+        /* Enable Rx DMA Request first, then Tx DMA Request to preload the transmitter */
+        SPI_REG_BIT(hspi, CR2, RXDMAEN) = 1;
+        SPI_REG_BIT(hspi, CR2, TXDMAEN) = 1;
+
+        XPD_SPI_Enable(hspi);
+    }
+    return result;
+}
+
+/**
+ * @brief Marks the end of the current frame of the slave stream, and calls the Receive callback.
+ *        The received frame occupies Frame.RxLength transfers from the Frame.RxStart index
+ *        of the circular receive buffer (wrapping around its end).
+ * @note  This function has to be called from the NSS rising edge EXTI callback.
+ *        Frames longer than the buffer cannot be distinguished from shorter ones.
+ * @param hspi: pointer to the SPI handle structure
+ */
+void XPD_SPI_SlaveStream_FrameEnd(SPI_HandleType * hspi)
+{
+    uint16_t length = hspi->RxStream.length;
+    uint16_t head, start;
+    uint32_t timeout = 1;
+
+    /* the last received data is transferred by the DMA shortly after the NSS edge */
+    (void) XPD_WaitForMatch(&hspi->Inst->SR.w, SPI_SR_RXNE, 0, &timeout);
+
+    /* The frame end position is given by the transfer counter */
+    head = length - XPD_DMA_GetStatus(hspi->DMA.Receive);
+    if (head >= length)
+    {
+        head -= length;
+    }
+
+    /* The new frame starts at the end of the previous one */
+    start = hspi->Frame.RxStart + hspi->Frame.RxLength;
+    if (start >= length)
+    {
+        start -= length;
+    }
+    hspi->Frame.RxStart  = start;
+    hspi->Frame.RxLength = (head >= start) ? (head - start) : (head + length - start);
+
+    head = length - XPD_DMA_GetStatus(hspi->DMA.Transmit);
+    hspi->Frame.TxStart  = (head >= length) ? (head - length) : head;
+
+    XPD_STATS_ADD(hspi, Bytes, hspi->Frame.RxLength * hspi->RxStream.size);
+    XPD_STATS_ADD(hspi, Transfers, 1);
+    XPD_SAFE_CALLBACK(hspi->Callbacks.Receive, hspi);
+}
+
+/**
+ * @brief Stops the slave mode stream of the SPI.
+ * @param hspi: pointer to the SPI handle structure
+ */
+void XPD_SPI_SlaveStream_Stop(SPI_HandleType * hspi)
+{
+    SPI_REG_BIT(hspi, CR2, TXDMAEN) = 0;
+    SPI_REG_BIT(hspi, CR2, RXDMAEN) = 0;
+
+    XPD_DMA_Stop_IT(hspi->DMA.Transmit);
+    XPD_DMA_Stop_IT(hspi->DMA.Receive);
+
+    XPD_SPI_Disable(hspi);
+}
+
+/**
+ * @brief Starts the continuous master mode acquisition of an external converter,
+ *        where each data transfer is started by a DMA request of a timer, and the received data
+ *        is stored in a circular buffer by the Receive DMA, without any CPU intervention.
+ *        The Receive callback is called when each half of the buffer is filled.
+ * @note  The Pacer DMA handle (e.g. the Update DMA of the timer) has to be initialized in
+ *        memory to peripheral direction, circular mode with memory address increment disabled
+ *        and the data width of the SPI frame. The Receive DMA has to be configured in circular mode,
+ *        and DMA packing is not supported. The transfers are started by the pacer's requests
+ *        once its timer is started, e.g. with the DMA request enabled by XPD_TIM_EnableDMA(htim, U).
+ *        The converter's chip select can be generated by a PWM output channel of the same timer,
+ *        active from the update event for the duration of the conversion and the frame transfer.
+ * @param hspi: pointer to the SPI handle structure
+ * @param Pacer: pointer to the DMA handle which is triggered by the timer
+ * @param TxData: pointer to the data which is transmitted in each frame (e.g. the converter command)
+ * @param RxData: pointer to the circular receive buffer
+ * @param Length: the amount of data transfers in the receive buffer
+ * @return ERROR if not in master mode or the DMAs are not circular, BUSY if a DMA is in use,
+ *         OK if the stream is started
+ */
+XPD_ReturnType XPD_SPI_PacedStream_Start(SPI_HandleType * hspi, DMA_HandleType * Pacer,
+        const void * TxData, void * RxData, uint16_t Length)
+{
+    XPD_ReturnType result = XPD_ERROR;
+
+    if ((SPI_REG_BIT(hspi, CR1, MSTR) != 0) && (SPI_DMA_PACKED(hspi) == 0) &&
+        (XPD_DMA_CircularMode(hspi->DMA.Receive) != 0) &&
+        (XPD_DMA_CircularMode(Pacer) != 0))
+    {
+        /* save stream info */
+        hspi->RxStream.buffer = RxData;
+        hspi->RxStream.length = Length;
+
+        /* Set up DMA for reception */
+        result = XPD_DMA_Start_IT(hspi->DMA.Receive, (void*) &hspi->Inst->DR, RxData, Length);
+    }
+
+    if (result == XPD_OK)
+    {
+        /* The pacer writes the same data for each request,
+         * the transfer count only determines its reload period */
+        result = XPD_DMA_Start(Pacer, (void*) &hspi->Inst->DR, (void*) TxData, Length);
+
+        /* If the pacer allocation failed, reset the receiver and exit */
+        if (result != XPD_OK)
+        {
+            XPD_DMA_Stop_IT(hspi->DMA.Receive);
+            return result;
+        }
+
+        /* Set the callback owner */
+        hspi->DMA.Receive->Owner = hspi;
+
+        /* Set the DMA transfer callbacks */
+        hspi->DMA.Receive->Callbacks.HalfComplete = spi_dmaReceiveRedirect;
+        hspi->DMA.Receive->Callbacks.Complete     = spi_dmaReceiveRedirect;
+#ifdef USE_XPD_DMA_ERROR_DETECT
+        hspi->DMA.Receive->Callbacks.Error        = spi_dmaErrorRedirect;
+#endif
+        XPD_DMA_EnableIT(hspi->DMA.Receive, HT);
+
+        SPI_RESET_ERRORS(hspi);
+
+        /* Enable Rx DMA Request, the transmitter is fed by the pacer */
+        SPI_REG_BIT(hspi, CR2, RXDMAEN) = 1;
+
+        XPD_SPI_Enable(hspi);
+    }
+    return result;
+}
+
+/**
+ * @brief Stops the paced acquisition stream of the SPI.
+ * @note  The pacer's timer should be stopped first, so no transfer is interrupted.
+ * @param hspi: pointer to the SPI handle structure
+ * @param Pacer: pointer to the DMA handle which is triggered by the timer
+ */
+void XPD_SPI_PacedStream_Stop(SPI_HandleType * hspi, DMA_HandleType * Pacer)
+{
+    (void) XPD_DMA_Stop(Pacer);
+
+    SPI_REG_BIT(hspi, CR2, RXDMAEN) = 0;
+
+    XPD_DMA_Stop_IT(hspi->DMA.Receive);
+
+    XPD_SPI_Disable(hspi);
+}
+
+/**
+ * @brief Adds a transaction to the SPI bus queue. The queued transactions are performed
+ *        one after the other using DMA, each with its own slave chip select and clock setup.
+ *        The optional command header is transmitted before the data within the same selection,
+ *        so the data buffers don't need to reserve space for it.
+ *        The Complete callback of the transaction is called when its transfer is finished.
+ * @note  The queue uses the Transmit and Receive callbacks of the handle. The end of the
+ *        transmissions is detected by the TXE interrupt, so @ref XPD_SPI_IRQHandler
+ *        has to be serviced besides the DMA interrupts.
+ *        The transaction structure must remain valid until its Complete callback.
+ *        The queue can be used by multiple drivers if XPD_ENTER_CRITICAL provides mutual exclusion.
+ * @param hspi: pointer to the SPI handle structure
+ * @param Transaction: pointer to the transaction to queue
+ * @return BUSY if the transaction is queued after others, otherwise the result of the transaction start
+ *         (the Result of the transaction is BUSY until the transaction is finished)
+ */
+XPD_ReturnType XPD_SPI_Queue_Submit(SPI_HandleType * hspi, SPI_TransactionType * Transaction)
+{
+    XPD_ReturnType result = XPD_BUSY;
+    SPI_TransactionType * tail;
+
+    Transaction->Next   = NULL;
+    Transaction->Result = XPD_BUSY;
+
+    XPD_ENTER_CRITICAL(hspi);
+
+    tail = hspi->Queue.Tail;
+    if (tail != NULL)
+    {
+        tail->Next = Transaction;
+    }
+    else
+    {
+        hspi->Queue.Head = Transaction;
+    }
+    hspi->Queue.Tail = Transaction;
+
+#ifdef USE_XPD_STATISTICS
+    {
+        SPI_TransactionType * queued;
+        uint16_t depth = 0;
+
+        for (queued = hspi->Queue.Head; queued != NULL; queued = queued->Next)
+        {
+            depth++;
+        }
+        XPD_STATS_MAX(hspi, QueueHighWater, depth);
+    }
+#endif
+
+    XPD_EXIT_CRITICAL(hspi);
+
+    /* The bus is idle, start the transaction now */
+    if (tail == NULL)
+    {
+        spi_queueStart(hspi);
+
+        result = (Transaction->Result == XPD_BUSY) ? XPD_OK : Transaction->Result;
+    }
+    return result;
+}
+
+#ifdef USE_XPD_OS
+/**
+ * @brief Performs a transaction through the SPI bus queue, blocking the calling task
+ *        until the transaction is finished.
+ * @note  The Complete callback of the transaction is used by this function.
+ *        If the function times out, the transaction remains queued, and its structure
+ *        must remain valid until its transfer is finished.
+ * @param hspi: pointer to the SPI handle structure
+ * @param Transaction: pointer to the transaction to perform
+ * @param Timeout: available time for the queued and the own transfers in ms
+ * @return TIMEOUT if timed out, otherwise the result of the transaction
+ */
+XPD_ReturnType XPD_SPI_Transfer_Blocking(SPI_HandleType * hspi, SPI_TransactionType * Transaction,
+        uint32_t Timeout)
+{
+    XPD_ReturnType result;
+
+    Transaction->Complete = spi_blockingRedirect;
+    XPD_OS_SignalInit(&Transaction->Signal);
+
+    (void) XPD_SPI_Queue_Submit(hspi, Transaction);
+
+    result = XPD_OS_SignalWait(&Transaction->Signal, &Timeout);
+    if (result == XPD_OK)
+    {
+        result = Transaction->Result;
+    }
+    return result;
+}
+#endif /* USE_XPD_OS */
+#endif /* XPD_SPI_EXCLUDE_DMA */
+
+/**
+ * @brief Recalculates the baud rate prescaler for the current SPI clock frequency,
+ *        the new serial clock frequency doesn't exceed the one of the initial setup.
+ * @note  It can be registered as RCC clock change listener callback.
+ *        It shouldn't be called during communication. The prescalers of the queued
+ *        transactions are not affected.
+ * @param hspi: pointer to the SPI handle structure
+ */
+void XPD_SPI_ClockUpdate(SPI_HandleType * hspi)
+{
+    uint32_t freq = XPD_SPI_GetClockFreq(hspi);
+    uint8_t prescaler = CLK_DIV2;
+
+    while (((freq >> prescaler) > hspi->ClockFreq) && (prescaler < CLK_DIV256))
+    {
+        prescaler++;
+    }
+    hspi->Inst->CR1.b.BR = prescaler - 1;
+}
+
 /** @} */
 
 /** @} */
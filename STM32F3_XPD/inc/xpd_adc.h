@@ -28,6 +28,12 @@
 #include "xpd_config.h"
 #include "xpd_adc_calc.h"
 #include "xpd_dma.h"
+#include "xpd_utils.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
 
 /** @defgroup ADC
  * @{ */
@@ -187,6 +193,15 @@ typedef struct
     uint16_t Low;              /*!< Watchdog low threshold */
 }ADC_WatchdogThresholdType;
 
+/** @brief ADC scheduled channel setup structure */
+typedef struct
+{
+    ADC_ChannelInitType Channel;    /*!< The channel configuration (watchdog selection is not recommended) */
+    uint8_t             Weight;     /*!< The number of conversions of the channel in each sequence [1..16] */
+    XPD_RingType *      Ring;       /*!< The ring of 16 bit elements to receive the channel's conversions,
+                                         or NULL to discard them */
+}ADC_ScheduledChannelType;
+
 /** @brief ADC Handle structure */
 typedef struct
 {
@@ -200,6 +215,7 @@ typedef struct
         XPD_HandleCallbackType ConvComplete;        /*!< Conversion(s) complete callback */
         XPD_HandleCallbackType InjConvComplete;     /*!< Injected conversion(s) complete callback */
         XPD_HandleCallbackType Watchdog;            /*!< Watchdog alert callback */
+        XPD_HandleCallbackType BlockReady;          /*!< Streaming conversions block filled callback */
 #if defined(USE_XPD_ADC_ERROR_DETECT) || defined(USE_XPD_DMA_ERROR_DETECT)
         XPD_HandleCallbackType Error;
 #endif
@@ -207,6 +223,24 @@ typedef struct
     struct {
         DMA_HandleType * Conversion;                /*!< DMA handle for update transfer */
     }DMA;                                           /*   DMA handle references */
+    DataStreamType Block;                           /*!< The last filled block of the streaming conversions */
+    struct {
+        DMA_DescriptorType Blocks[2];               /*!< [Internal] The post-trigger transfers of the capture */
+        uint16_t PostTrigger;                       /*!< [Internal] The number of conversions stored after the trigger */
+        uint16_t Trigger;                           /*!< The buffer index of the first conversion after the trigger */
+        uint16_t Start;                             /*!< The buffer index of the oldest conversion of the capture */
+        volatile uint8_t Armed;                     /*!< [Internal] The capture is waiting for the trigger */
+    }Capture;                                       /*   Watchdog triggered capture state */
+    struct {
+        volatile uint16_t Temperature;              /*!< The last temperature sensor conversion of the monitor */
+        uint8_t Active;                             /*!< [Internal] The injected group is used by the monitor */
+    }Monitor;                                       /*   Background supply and temperature monitor state */
+    struct {
+        const ADC_ScheduledChannelType * Channels;  /*!< [Internal] The scheduled channels */
+        uint8_t Ranks[16];                          /*!< [Internal] The scheduled channel index of each sequence rank */
+        uint8_t Length;                             /*!< [Internal] The number of sequence ranks */
+        uint8_t Rank;                               /*!< [Internal] The sequence rank of the next conversion to distribute */
+    }Schedule;                                      /*   Multirate channel schedule */
     uint32_t OffsetUsage;                           /*!< [Internal] Bitflag for offset using channel numbers */
     uint32_t InjectedContextQueue;                  /*!< [Internal] The injected channel context queue */
     uint8_t ConversionCount;                        /*!< ADC number of regular conversions */
@@ -465,6 +499,14 @@ void            XPD_ADC_IRQHandler          (ADC_HandleType * hadc);
 
 XPD_ReturnType  XPD_ADC_Start_DMA           (ADC_HandleType * hadc, void * Address);
 void            XPD_ADC_Stop_DMA            (ADC_HandleType * hadc);
+XPD_ReturnType  XPD_ADC_DMA_BytePacking     (ADC_HandleType * hadc, FunctionalState NewState);
+XPD_ReturnType  XPD_ADC_Stream_Start        (ADC_HandleType * hadc, void * Buffer, uint16_t BlockSize);
+XPD_ReturnType  XPD_ADC_Capture_Start       (ADC_HandleType * hadc, ADC_WatchdogType Watchdog,
+                                             void * Buffer, uint16_t Length, uint16_t PostTrigger);
+XPD_ReturnType  XPD_ADC_Schedule_Config     (ADC_HandleType * hadc,
+                                             const ADC_ScheduledChannelType * Channels, uint8_t ChannelCount);
+void            XPD_ADC_Schedule_Demux      (ADC_HandleType * hadc, const uint16_t * Conversions,
+                                             uint32_t Count);
 
 void            XPD_ADC_WatchdogConfig      (ADC_HandleType * hadc, ADC_WatchdogType Watchdog,
                                              const ADC_WatchdogThresholdType * Config);
@@ -596,6 +638,10 @@ void            XPD_ADC_Injected_Stop       (ADC_HandleType * hadc);
 void            XPD_ADC_Injected_Start_IT   (ADC_HandleType * hadc);
 void            XPD_ADC_Injected_Stop_IT    (ADC_HandleType * hadc);
 
+void            XPD_ADC_Monitor_Start       (ADC_HandleType * hadc, ADC_InjTriggerSourceType Trigger,
+                                             ADC_SampleTimeType SampleTime);
+void            XPD_ADC_Monitor_Stop        (ADC_HandleType * hadc);
+
 /**
  * @brief Return the result of an ADC injected conversion.
  * @param hadc: pointer to the ADC handle structure
@@ -610,6 +656,16 @@ __STATIC_INLINE uint16_t XPD_ADC_Inject_GetValue(ADC_HandleType * hadc, uint8_t
     return (uint16_t)((&hadc->Inst->JDR1)[Index]);
 }
 
+/**
+ * @brief Returns the die temperature measured by the background monitor.
+ * @param hadc: pointer to the ADC handle structure
+ * @return The temperature in degree Celsius
+ */
+__STATIC_INLINE int32_t XPD_ADC_Monitor_GetTemperature(ADC_HandleType * hadc)
+{
+    return XPD_ADC_GetTemperature(hadc->Monitor.Temperature);
+}
+
 /** @} */
 
 /** @} */
@@ -678,9 +734,43 @@ __STATIC_INLINE uint32_t XPD_ADC_MultiMode_GetValues(ADC_HandleType * hadc)
 /** @defgroup ADC_Calibration ADC Calibration
  * @{ */
 
+/** @defgroup ADC_Calibration_Exported_Types ADC Calibration Exported Types
+ * @{ */
+
+/** @brief ADC calibration factors with the operating conditions of the calibration */
+typedef struct
+{
+    uint8_t  Single;            /*!< Single-ended calibration factor */
+    uint8_t  Differential;      /*!< Differential calibration factor */
+    int16_t  Temperature;       /*!< The die temperature at the calibration [C] */
+    uint16_t VDDA;              /*!< The analog supply voltage at the calibration [mV], 0 if invalid */
+}ADC_CalibrationType;
+
+/** @} */
+
+/** @defgroup ADC_Calibration_Exported_Macros ADC Calibration Exported Macros
+ * @{ */
+
+#ifndef ADC_CALIBRATION_TEMPERATURE_DRIFT
+/** @brief Largest die temperature change for which the stored calibration is reused [C] [overrideable] */
+#define ADC_CALIBRATION_TEMPERATURE_DRIFT   10
+#endif
+
+#ifndef ADC_CALIBRATION_VDDA_DRIFT
+/** @brief Largest analog supply change for which the stored calibration is reused [mV] [overrideable] */
+#define ADC_CALIBRATION_VDDA_DRIFT          100
+#endif
+
+/** @} */
+
 /** @addtogroup ADC_Calibration_Exported_Functions
  * @{ */
 XPD_ReturnType  XPD_ADC_Calibrate           (ADC_HandleType * hadc, boolean_t Differential);
+
+void            XPD_ADC_GetCalibration      (ADC_HandleType * hadc, ADC_CalibrationType * Calibration);
+XPD_ReturnType  XPD_ADC_SetCalibration      (ADC_HandleType * hadc, const ADC_CalibrationType * Calibration);
+boolean_t       XPD_ADC_CalibrationValid    (const ADC_CalibrationType * Calibration,
+                                             int16_t Temperature, uint16_t VDDA);
 /** @} */
 
 /** @} */
@@ -691,4 +781,8 @@ XPD_ReturnType  XPD_ADC_Calibrate           (ADC_HandleType * hadc, boolean_t Di
 #include "xpd_rcc_pc.h"
 #undef XPD_ADC_API
 
+#ifdef __cplusplus
+}
+#endif
+
 #endif /* __XPD_ADC_H_ */
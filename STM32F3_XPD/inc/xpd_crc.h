@@ -0,0 +1,119 @@
+/**
+  ******************************************************************************
+  * @file    xpd_crc.h
+  * @author  Benedek Kupper
+  * @version V0.1
+  * @date    2018-01-20
+  * @brief   STM32 eXtensible Peripheral Drivers CRC Module
+  *
+  *  This file is part of STM32_XPD.
+  *
+  *  STM32_XPD is free software: you can redistribute it and/or modify
+  *  it under the terms of the GNU General Public License as published by
+  *  the Free Software Foundation, either version 3 of the License, or
+  *  (at your option) any later version.
+  *
+  *  STM32_XPD is distributed in the hope that it will be useful,
+  *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with STM32_XPD.  If not, see <http://www.gnu.org/licenses/>.
+  */
+#ifndef __XPD_CRC_H_
+#define __XPD_CRC_H_
+
+#include "xpd_common.h"
+#include "xpd_config.h"
+#include "xpd_dma.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/** @defgroup CRC
+ * @{ */
+
+/** @defgroup CRC_Exported_Types CRC Exported Types
+ * @{ */
+
+#ifdef CRC_CR_POLYSIZE
+/** @brief CRC polynomial size types */
+typedef enum
+{
+    CRC_POLYSIZE_32 = 0, /*!< 32 bit polynomial */
+    CRC_POLYSIZE_16 = 1, /*!< 16 bit polynomial */
+    CRC_POLYSIZE_8  = 2, /*!< 8 bit polynomial */
+    CRC_POLYSIZE_7  = 3  /*!< 7 bit polynomial */
+}CRC_PolySizeType;
+#endif
+
+#ifdef CRC_CR_REV_IN
+/** @brief CRC input data bit reversal types */
+typedef enum
+{
+    CRC_REVERSE_NONE     = 0, /*!< Input data isn't reversed */
+    CRC_REVERSE_BYTE     = 1, /*!< Bit order is reversed by byte */
+    CRC_REVERSE_HALFWORD = 2, /*!< Bit order is reversed by half word */
+    CRC_REVERSE_WORD     = 3  /*!< Bit order is reversed by word */
+}CRC_ReverseType;
+#endif
+
+/** @brief CRC setup structure */
+typedef struct
+{
+#ifdef CRC_CR_POLYSIZE
+    uint32_t         Polynomial;    /*!< The coefficients of the polynomial (POL register) */
+    CRC_PolySizeType PolySize;      /*!< The size of the polynomial */
+#endif
+#ifdef CRC_CR_REV_IN
+    uint32_t         InitValue;     /*!< The initial value of each calculation */
+    CRC_ReverseType  InputReverse;  /*!< The bit reversal of the input data */
+    FunctionalState  OutputReverse; /*!< The bit order of the result is reversed */
+#endif
+}CRC_InitType;
+
+/** @} */
+
+/** @addtogroup CRC_Exported_Functions
+ * @{ */
+void            XPD_CRC_Init            (const CRC_InitType * Config);
+void            XPD_CRC_Deinit          (void);
+
+uint32_t        XPD_CRC_Accumulate      (const uint32_t * Data, uint32_t Count);
+uint32_t        XPD_CRC_Calculate       (const uint32_t * Data, uint32_t Count);
+#ifdef CRC_CR_REV_IN
+uint32_t        XPD_CRC_Accumulate8     (const uint8_t * Data, uint32_t Length);
+#endif
+
+XPD_ReturnType  XPD_CRC_Accumulate_DMA  (DMA_MemEngineType * hmem, DMA_MemJobType * Job,
+                                         const uint32_t * Data, uint32_t Count);
+
+/**
+ * @brief Restarts the calculation from the initial value.
+ */
+__STATIC_INLINE void XPD_CRC_Restart(void)
+{
+    CRC->CR.b.RESET = 1;
+}
+
+/**
+ * @brief Gets the result of the calculation so far.
+ * @return The current CRC value
+ */
+__STATIC_INLINE uint32_t XPD_CRC_GetValue(void)
+{
+    return CRC->DR;
+}
+
+/** @} */
+
+/** @} */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __XPD_CRC_H_ */
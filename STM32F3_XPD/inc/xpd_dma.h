@@ -27,6 +27,11 @@
 #include "xpd_common.h"
 #include "xpd_config.h"
 
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
 /** @defgroup DMA
  * @{ */
 
@@ -86,6 +91,50 @@ typedef struct
     }Peripheral;                         /*   Peripheral side configuration */
 }DMA_InitType;
 
+/** @brief DMA peripheral request types for automatic channel allocation */
+typedef enum
+{
+    DMA_REQUEST_ADC1 = 0,  /*!< ADC1 conversion data */
+    DMA_REQUEST_ADC2,      /*!< ADC2 conversion data */
+    DMA_REQUEST_ADC3,      /*!< ADC3 conversion data */
+    DMA_REQUEST_SPI1_RX,   /*!< SPI1 reception */
+    DMA_REQUEST_SPI1_TX,   /*!< SPI1 transmission */
+    DMA_REQUEST_SPI2_RX,   /*!< SPI2 reception */
+    DMA_REQUEST_SPI2_TX,   /*!< SPI2 transmission */
+    DMA_REQUEST_SPI3_RX,   /*!< SPI3 reception */
+    DMA_REQUEST_SPI3_TX,   /*!< SPI3 transmission */
+    DMA_REQUEST_USART1_RX, /*!< USART1 reception */
+    DMA_REQUEST_USART1_TX, /*!< USART1 transmission */
+    DMA_REQUEST_USART2_RX, /*!< USART2 reception */
+    DMA_REQUEST_USART2_TX, /*!< USART2 transmission */
+    DMA_REQUEST_USART3_RX, /*!< USART3 reception */
+    DMA_REQUEST_USART3_TX, /*!< USART3 transmission */
+    DMA_REQUEST_UART4_RX,  /*!< UART4 reception */
+    DMA_REQUEST_UART4_TX,  /*!< UART4 transmission */
+    DMA_REQUEST_TIM1_UP,   /*!< TIM1 update event */
+    DMA_REQUEST_TIM2_UP,   /*!< TIM2 update event */
+    DMA_REQUEST_TIM3_UP,   /*!< TIM3 update event */
+    DMA_REQUEST_TIM6_UP,   /*!< TIM6 update event */
+    DMA_REQUEST_TIM7_UP,   /*!< TIM7 update event */
+    DMA_REQUEST_TIM8_UP,   /*!< TIM8 update event */
+    DMA_REQUEST_COUNT      /*!< [Internal] The number of request types */
+}DMA_RequestType;
+
+/** @brief DMA request mapping candidate structure */
+typedef struct
+{
+    uint8_t Channel;    /*!< The channel location: DMA number * 8 + channel offset, 0 if unused */
+    uint8_t Select;     /*!< The request selection: CSELR value if available, otherwise
+                             SYSCFG remap bit position (0 if none) with the remap value in the MSB */
+}DMA_RequestMapType;
+
+/** @brief DMA chained transfer descriptor structure */
+typedef struct
+{
+    void *   MemAddress;                      /*!< Memory address of the transfer block */
+    uint16_t DataCount;                       /*!< The amount of data to be transferred from the block */
+}DMA_DescriptorType;
+
 /** @brief DMA channel handle structure */
 typedef struct
 {
@@ -102,9 +151,24 @@ typedef struct
         XPD_HandleCallbackType Error;         /*!< DMA transfer error callback */
 #endif
     } Callbacks;                              /*   Handle Callbacks */
+    struct {
+        const DMA_DescriptorType * List;      /*!< [Internal] The descriptor list of the chained transfer */
+        uint16_t Count;                       /*!< [Internal] The number of descriptors in the list */
+        uint16_t Index;                       /*!< [Internal] The index of the next descriptor to load */
+    } Chain;                                  /*   Chained transfer context */
     void * Owner;                             /*!< [Internal] The pointer of the peripheral handle which uses this handle */
 #ifdef USE_XPD_DMA_ERROR_DETECT
     volatile DMA_ErrorType Errors;            /*!< Transfer errors */
+    FunctionalState ErrorRecovery;            /*!< A circular transfer stopped by a transfer error is restarted
+                                                   from its current position instead of reporting the error */
+    uint16_t Recoveries;                      /*!< The number of recovered transfer errors */
+    uint32_t RecoveryBase;                    /*!< [Internal] The memory address of the circular block
+                                                   while its remainder is transferred after an error, 0 otherwise */
+#endif
+    uint16_t BlockLength;                     /*!< [Internal] The data count of the ongoing block */
+    volatile uint32_t Wraps;                  /*!< [Internal] The number of completed blocks since the transfer start */
+#ifdef USE_XPD_STATISTICS
+    XPD_StatsType Stats;                      /*!< Runtime statistics (errors indexed by @ref DMA_ErrorType bits) */
 #endif
 }DMA_HandleType;
 
@@ -113,6 +177,23 @@ typedef struct
 /** @defgroup DMA_Exported_Macros DMA Exported Macros
  * @{ */
 
+#ifdef CCMDATARAM_BASE
+/**
+ * @brief  Determines if the memory address is accessible by the DMA,
+ *         as the CCM RAM is only connected to the CPU.
+ * @param  ADDRESS: the memory address to check
+ */
+#define         DMA_ADDRESS_ACCESSIBLE(ADDRESS)             \
+    ((((uint32_t)(ADDRESS)) - CCMDATARAM_BASE) >= 0x10000)
+#else
+/**
+ * @brief  Determines if the memory address is accessible by the DMA.
+ * @param  ADDRESS: the memory address to check
+ */
+#define         DMA_ADDRESS_ACCESSIBLE(ADDRESS)             \
+    ((void)(ADDRESS), 1)
+#endif
+
 #ifdef DMA_Channel_BB
 /**
  * @brief  DMA Handle initializer macro
@@ -206,12 +287,64 @@ typedef struct
 #define         XPD_DMA_CircularMode(HANDLE)                \
         (DMA_REG_BIT((HANDLE), CCR, CIRC))
 
+/**
+ * @brief  Sets the data width of the DMA transfers.
+ * @note   The data width can only be changed while the DMA transfer is disabled.
+ * @param  HANDLE: specifies the DMA Handle.
+ * @param  PERIPH_ALIGN: the @ref DMA_AlignmentType of the peripheral data
+ * @param  MEM_ALIGN: the @ref DMA_AlignmentType of the memory data
+ */
+#define         XPD_DMA_SetDataAlignment(HANDLE, PERIPH_ALIGN, MEM_ALIGN)  \
+    do { (HANDLE)->Inst->CCR.b.PSIZE = (PERIPH_ALIGN);                     \
+         (HANDLE)->Inst->CCR.b.MSIZE = (MEM_ALIGN); } while (0)
+
+#ifdef DMA_CSELR_C1S
+
+/* Additional defines for complete macro functionality */
+#define DMA1_CSELR_CH1_DEFAULT      0U
+#define DMA1_CSELR_CH2_DEFAULT      0U
+#define DMA1_CSELR_CH3_DEFAULT      0U
+#define DMA1_CSELR_CH4_DEFAULT      0U
+#define DMA1_CSELR_CH5_DEFAULT      0U
+#define DMA1_CSELR_CH6_DEFAULT      0U
+#define DMA1_CSELR_CH7_DEFAULT      0U
+#define DMA2_CSELR_CH1_DEFAULT      0U
+#define DMA2_CSELR_CH2_DEFAULT      0U
+#define DMA2_CSELR_CH3_DEFAULT      0U
+#define DMA2_CSELR_CH4_DEFAULT      0U
+#define DMA2_CSELR_CH5_DEFAULT      0U
+#define DMA2_CSELR_CH6_DEFAULT      0U
+#define DMA2_CSELR_CH7_DEFAULT      0U
+
+/**
+ * @brief  Sets the DMA remapping for the given channel.
+ * @param  BASE: specifies the name of the DMA base.
+ *         This parameter can be one of the following values:
+ *            @arg DMA1
+ *            @arg DMA2 (if available)
+ * @param  CHANNEL: specifies the channel number to remap [1..7].
+ * @param  SELECTION: specify the remap target selection. Using DEFAULT resets the remapping.
+ */
+#define XPD_DMA_ChannelRemap(BASE, CHANNEL, SELECTION)           \
+    (MODIFY_REG(BASE->CSELR.w, 0xF << ((uint32_t)((CHANNEL) - 1) * 4), BASE##_CSELR_CH##CHANNEL##_##SELECTION))
+#endif /* DMA_CSELR_C1S */
+
+/** @} */
+
+/** @defgroup DMA_Exported_Variables DMA Exported Variables
+ * @{ */
+
+/** @brief [Internal] The channel candidates of each request, located in xpd_dma_map.c */
+extern const DMA_RequestMapType XPD_DMA_RequestMap[DMA_REQUEST_COUNT][2];
+
 /** @} */
 
 /** @addtogroup DMA_Exported_Functions
  * @{ */
 XPD_ReturnType  XPD_DMA_Init            (DMA_HandleType * hdma, const DMA_InitType * Config);
 XPD_ReturnType  XPD_DMA_Deinit          (DMA_HandleType * hdma);
+XPD_ReturnType  XPD_DMA_Allocate        (DMA_HandleType * hdma, DMA_RequestType Request,
+                                         const DMA_InitType * Config);
 
 void            XPD_DMA_Enable          (DMA_HandleType * hdma);
 void            XPD_DMA_Disable         (DMA_HandleType * hdma);
@@ -220,10 +353,13 @@ XPD_ReturnType  XPD_DMA_Start           (DMA_HandleType * hdma, void * PeriphAdd
                                          void * MemAddress, uint16_t DataCount);
 XPD_ReturnType  XPD_DMA_Start_IT        (DMA_HandleType * hdma, void * PeriphAddress,
                                          void * MemAddress, uint16_t DataCount);
+XPD_ReturnType  XPD_DMA_StartChain_IT   (DMA_HandleType * hdma, void * PeriphAddress,
+                                         const DMA_DescriptorType * Descriptors, uint16_t Count);
 XPD_ReturnType  XPD_DMA_Stop            (DMA_HandleType * hdma);
 void            XPD_DMA_Stop_IT         (DMA_HandleType * hdma);
 
 uint16_t        XPD_DMA_GetStatus       (DMA_HandleType * hdma);
+uint32_t        XPD_DMA_GetPosition     (DMA_HandleType * hdma, void ** Buffer, uint16_t * Offset);
 XPD_ReturnType  XPD_DMA_PollStatus      (DMA_HandleType * hdma, DMA_OperationType Operation, uint32_t Timeout);
 
 void            XPD_DMA_IRQHandler      (DMA_HandleType * hdma);
@@ -242,10 +378,97 @@ __STATIC_INLINE DMA_ErrorType XPD_DMA_GetError(DMA_HandleType * hdma)
 
 /** @} */
 
+/** @defgroup DMA_Memory DMA Memory Operations
+ * @{ */
+
+/** @defgroup DMA_Memory_Exported_Types DMA Memory Operations Exported Types
+ * @{ */
+
+/** @brief DMA memory operation job structure */
+typedef struct DMA_MemJobType
+{
+    XPD_HandleCallbackType  Callback;   /*!< Job completion callback, receives the job as parameter */
+    volatile XPD_ReturnType Status;     /*!< Job state: BUSY while queued, ERROR if the transfer failed, OK when done */
+    struct DMA_MemJobType * Next;       /*!< [Internal] The next job in the queue */
+    uint8_t *               Dest;       /*!< [Internal] The destination of the remaining data */
+    const uint8_t *         Src;        /*!< [Internal] The source of the remaining data, NULL for fill */
+    uint32_t                Size;       /*!< [Internal] The remaining size in bytes */
+    uint32_t                Pattern;    /*!< [Internal] The fill pattern */
+    FunctionalState         DestIncrement; /*!< [Internal] The destination address is incremented */
+}DMA_MemJobType;
+
+/** @brief DMA memory operation engine structure */
+typedef struct
+{
+    DMA_HandleType * DMA;               /*!< The DMA channel used for memory-to-memory transfers */
+    uint32_t Threshold;                 /*!< Operations up to this size in bytes are performed by the CPU */
+    DMA_MemJobType * volatile Head;     /*!< [Internal] The job being transferred */
+    DMA_MemJobType * Tail;              /*!< [Internal] The last queued job */
+}DMA_MemEngineType;
+
+/** @} */
+
+/** @defgroup DMA_Memory_Exported_Functions DMA Memory Operations Exported Functions
+ * @{ */
+XPD_ReturnType  XPD_DMA_MemInit         (DMA_MemEngineType * hmem);
+XPD_ReturnType  XPD_DMA_MemCpy_IT       (DMA_MemEngineType * hmem, DMA_MemJobType * Job,
+                                         void * Dest, const void * Src, uint32_t Size);
+XPD_ReturnType  XPD_DMA_MemSet_IT       (DMA_MemEngineType * hmem, DMA_MemJobType * Job,
+                                         void * Dest, uint8_t Value, uint32_t Size);
+XPD_ReturnType  XPD_DMA_MemFeed_IT      (DMA_MemEngineType * hmem, DMA_MemJobType * Job,
+                                         volatile void * Register, const void * Src, uint32_t Size);
+/** @} */
+
+/** @} */
+
+/** @defgroup DMA_Bridge DMA Peripheral Bridge
+ *  @brief    Continuous data forwarding between peripheral data registers without CPU involvement
+ *  @details  In direct mode a single DMA channel is triggered by the source peripheral's requests,
+ *            and moves each element into the destination peripheral's data register.
+ *            The destination has to accept the elements at the source rate
+ *            (e.g. SPI transmission is faster than the USART reception).
+ *
+ *            In ring mode the source channel stores the elements in a RAM ring, which is read
+ *            by a second channel triggered by the destination peripheral's requests. The destination
+ *            channel is started when the ring is half filled, then both sides are paced by their own
+ *            requests with a constant latency of half the ring. This suits paths with equal rates,
+ *            e.g. ADC and DAC conversions triggered by the same timer.
+ * @{ */
+
+/** @defgroup DMA_Bridge_Exported_Types DMA Peripheral Bridge Exported Types
+ * @{ */
+
+/** @brief DMA peripheral bridge structure */
+typedef struct
+{
+    DMA_HandleType * Source;            /*!< The DMA channel of the source peripheral requests,
+                                             initialized in peripheral-to-memory direction */
+    DMA_HandleType * Destination;       /*!< The DMA channel of the destination peripheral requests,
+                                             initialized in memory-to-peripheral direction (NULL for direct mode) */
+    volatile void *  DestRegister;      /*!< [Internal] The destination peripheral data register */
+    void *           Ring;              /*!< [Internal] The RAM ring of the ring mode */
+    uint16_t         Length;            /*!< [Internal] The number of elements in the ring */
+}DMA_BridgeType;
+
+/** @} */
+
+/** @defgroup DMA_Bridge_Exported_Functions DMA Peripheral Bridge Exported Functions
+ * @{ */
+XPD_ReturnType  XPD_DMA_Bridge_Start    (DMA_BridgeType * hbr, volatile void * SrcRegister,
+                                         volatile void * DestRegister, void * Ring, uint16_t Length);
+void            XPD_DMA_Bridge_Stop     (DMA_BridgeType * hbr);
+/** @} */
+
+/** @} */
+
 /** @} */
 
 #define XPD_DMA_API
 #include "xpd_syscfg.h"
 #undef XPD_DMA_API
 
+#ifdef __cplusplus
+}
+#endif
+
 #endif /* __XPD_DMA_H_ */
@@ -26,6 +26,12 @@
 
 #include "xpd_common.h"
 #include "xpd_config.h"
+#include "xpd_os.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
 
 /** @defgroup FLASH
  * @{ */
@@ -57,6 +63,26 @@ typedef struct {
     XPD_SimpleCallbackType Error;           /*!< Operation error callback */
 }XPD_FLASH_CallbacksType;
 
+/** @brief FLASH job operation types */
+typedef enum
+{
+    FLASH_JOB_ERASE   = 0, /*!< Erase consecutive pages */
+    FLASH_JOB_PROGRAM = 1, /*!< Program data to flash */
+    FLASH_JOB_VERIFY  = 2, /*!< Compare flash content to data */
+}FLASH_JobOperationType;
+
+/** @brief FLASH job structure */
+typedef struct FLASH_JobType
+{
+    struct FLASH_JobType * Next;            /*!< [Internal] The next queued job */
+    FLASH_JobOperationType Operation;       /*!< The operation to perform */
+    void *           Address;               /*!< The start flash address */
+    const void *     Data;                  /*!< The data to program or verify against */
+    uint16_t         Length;                /*!< Amount of bytes to program or verify, kilobytes to erase */
+    XPD_HandleCallbackType Complete;        /*!< Job finished callback, the argument is the job */
+    volatile XPD_ReturnType Result;         /*!< BUSY while the job is pending, then the result of the job */
+}FLASH_JobType;
+
 /** @} */
 
 /** @defgroup FLASH_Exported_Variables FLASH Exported Variables
@@ -70,6 +96,22 @@ extern XPD_FLASH_CallbacksType XPD_FLASH_Callbacks;
 /** @defgroup FLASH_Exported_Macros FLASH Exported Macros
  * @{ */
 
+#ifndef XPD_FLASH_RAMFUNC
+/**
+ * @brief Placement attribute of the functions which execute during FLASH operations,
+ *        can be set to a RAM section to avoid stalling on instruction fetch. [overrideable]
+ */
+#define             XPD_FLASH_RAMFUNC
+#endif
+
+#ifndef FLASH_WAITSTATE_FREQ
+/** @brief The maximal HCLK frequency range of a single flash wait state [overrideable] */
+#define             FLASH_WAITSTATE_FREQ    24000000
+#endif
+
+/** @brief Flash latency value for automatic selection of the minimal wait states */
+#define             FLASH_LATENCY_AUTO      0xFF
+
 #ifdef FLASH_BB
 /**
  * @brief FLASH register bit accessing macro
@@ -145,12 +187,22 @@ XPD_ReturnType  XPD_FLASH_EraseBank         (uint8_t Bank);
 XPD_ReturnType  XPD_FLASH_EraseBank_IT      (uint8_t Bank);
 XPD_ReturnType  XPD_FLASH_Erase             (void * Address, uint16_t kBytes);
 XPD_ReturnType  XPD_FLASH_Erase_IT          (void * Address, uint16_t kBytes);
+#ifdef USE_XPD_OS
+XPD_ReturnType  XPD_FLASH_Program_Blocking  (void * Address, const void * Data, uint16_t Length,
+                                             uint32_t Timeout);
+XPD_ReturnType  XPD_FLASH_Erase_Blocking    (void * Address, uint16_t kBytes, uint32_t Timeout);
+#endif
 
 XPD_ReturnType  XPD_FLASH_PollStatus        (uint32_t Timeout);
 FLASH_ErrorType XPD_FLASH_GetError          (void);
 
+uint8_t         XPD_FLASH_GetMinLatency     (uint32_t HCLK_Frequency);
+
 void            XPD_FLASH_IRQHandler        (void);
 
+XPD_ReturnType  XPD_FLASH_Queue_Submit      (FLASH_JobType * Job);
+boolean_t       XPD_FLASH_Queue_Idle        (void);
+
 /**
  * @brief Sets the flash memory access latency (in clock cycles).
  * @param Latency: the flash access latency
@@ -195,4 +247,8 @@ __STATIC_INLINE void XPD_FLASH_HalfCycleAccess(FunctionalState NewState)
 
 /** @} */
 
+#ifdef __cplusplus
+}
+#endif
+
 #endif /* __XPD_FLASH_H_ */
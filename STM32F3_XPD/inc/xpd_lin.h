@@ -0,0 +1,147 @@
+/**
+  ******************************************************************************
+  * @file    xpd_lin.h
+  * @author  Benedek Kupper
+  * @version V0.1
+  * @date    2018-01-20
+  * @brief   STM32 eXtensible Peripheral Drivers LIN Bus Module
+  *
+  *  This file is part of STM32_XPD.
+  *
+  *  STM32_XPD is free software: you can redistribute it and/or modify
+  *  it under the terms of the GNU General Public License as published by
+  *  the Free Software Foundation, either version 3 of the License, or
+  *  (at your option) any later version.
+  *
+  *  STM32_XPD is distributed in the hope that it will be useful,
+  *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with STM32_XPD.  If not, see <http://www.gnu.org/licenses/>.
+  */
+#ifndef __XPD_LIN_H_
+#define __XPD_LIN_H_
+
+#include "xpd_common.h"
+#include "xpd_config.h"
+#include "xpd_usart.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#if !defined(XPD_USART_EXCLUDE_DMA) && !defined(XPD_USART_EXCLUDE_MODES)
+
+/** @defgroup LIN_Bus
+ *  @brief    LIN master schedule table and slave frame processing on USART
+ *  @details  The break is generated and detected by the USART in LIN mode, the headers and
+ *            the responses are transferred by DMA. Each frame is received back through the
+ *            bus transceiver, so the published responses are verified by their readback,
+ *            and the subscribed responses by their checksum. The master runs the schedule table
+ *            from the periodic calls of @ref XPD_LIN_Master_Tick, which also detects the missing
+ *            responses at the end of each slot. The Frame callback is called with the finished
+ *            frame in the Current field. The USART has to be initialized by @ref XPD_LIN_Init,
+ *            and its interrupt (for the break detection) and DMA interrupts have to be enabled.
+ *  @code
+    static uint8_t lights[2], switches[1];
+    static LIN_FrameType frames[] = {
+        { .Id = 0x10, .Length = 2, .Publish = 1, .Checksum = LIN_CHECKSUM_ENHANCED, .Data = lights },
+        { .Id = 0x21, .Length = 1, .Publish = 0, .Checksum = LIN_CHECKSUM_ENHANCED, .Data = switches },
+    };
+    static const LIN_ScheduleEntryType schedule[] = {
+        { .Frame = &frames[0], .Slots = 10 },
+        { .Frame = &frames[1], .Slots = 10 },
+    };
+
+    XPD_LIN_Init(&hlin.Serial, &common, 11);
+    XPD_LIN_Master_Start(&hlin, schedule, 2);
+    // in the 1 ms timer update callback:
+    XPD_LIN_Master_Tick(&hlin);
+ *  @endcode
+ * @{ */
+
+/** @defgroup LIN_Bus_Exported_Types LIN Bus Exported Types
+ * @{ */
+
+/** @brief LIN frame status types */
+typedef enum
+{
+    LIN_STATUS_OK          = 0, /*!< The frame is transferred successfully */
+    LIN_STATUS_PENDING     = 1, /*!< The frame transfer is ongoing */
+    LIN_STATUS_NO_RESPONSE = 2, /*!< No response was received in the frame slot */
+    LIN_STATUS_INCOMPLETE  = 3, /*!< The response was shorter than the frame */
+    LIN_STATUS_CHECKSUM    = 4, /*!< The received response has invalid checksum */
+    LIN_STATUS_READBACK    = 5, /*!< The published frame was corrupted on the bus */
+}LIN_StatusType;
+
+/** @brief LIN checksum model types */
+typedef enum
+{
+    LIN_CHECKSUM_CLASSIC  = 0, /*!< The checksum covers the data bytes (LIN 1.x, diagnostic frames) */
+    LIN_CHECKSUM_ENHANCED = 1, /*!< The checksum covers the protected identifier and the data bytes (LIN 2.x) */
+}LIN_ChecksumType;
+
+/** @brief LIN frame structure */
+typedef struct
+{
+    uint8_t  Id;                        /*!< The frame identifier [0 .. 63] */
+    uint8_t  Length;                    /*!< The number of data bytes in the response [1 .. 8] */
+    uint8_t  Publish;                   /*!< The response is transmitted by this node */
+    LIN_ChecksumType Checksum;          /*!< The checksum model of the frame, the diagnostic frames (60, 61)
+                                             always use the classic checksum */
+    uint8_t * Data;                     /*!< The response data, only updated by a valid received response */
+    volatile LIN_StatusType Status;     /*!< The status of the last transfer of the frame */
+}LIN_FrameType;
+
+/** @brief LIN master schedule table entry structure */
+typedef struct
+{
+    LIN_FrameType * Frame;              /*!< The frame which is sent in the slot */
+    uint8_t Slots;                      /*!< The slot duration in @ref XPD_LIN_Master_Tick periods [1 .. 255] */
+}LIN_ScheduleEntryType;
+
+/** @brief LIN handle structure */
+typedef struct
+{
+    USART_HandleType Serial;                 /*!< The handle of the bus USART */
+    struct {
+        XPD_HandleCallbackType Frame;        /*!< Frame finished callback, the frame is provided in Current */
+    }Callbacks;                              /*   LIN callbacks */
+    LIN_FrameType * Current;                 /*!< The frame under transfer, or the last finished one */
+    const LIN_ScheduleEntryType * Schedule;  /*!< [Internal] Master: the running schedule table */
+    LIN_FrameType * Frames;                  /*!< [Internal] Slave: the frames processed by the node */
+    uint8_t Count;                           /*!< [Internal] The number of schedule entries or slave frames */
+    uint8_t Index;                           /*!< [Internal] Master: the next schedule entry */
+    uint8_t Ticks;                           /*!< [Internal] Master: the remaining ticks of the current slot */
+    uint8_t Master;                          /*!< [Internal] The handle is used as master */
+    volatile uint8_t State;                  /*!< [Internal] The frame transfer state */
+    uint8_t Expected;                        /*!< [Internal] The length of the frame from the sync byte */
+    uint8_t TxBuffer[11];                    /*!< [Internal] The transmitted frame from the sync byte */
+    uint8_t RxBuffer[11];                    /*!< [Internal] The received frame from the sync byte */
+}LIN_HandleType;
+
+/** @} */
+
+/** @addtogroup LIN_Bus_Exported_Functions
+ * @{ */
+XPD_ReturnType  XPD_LIN_Master_Start        (LIN_HandleType * hlin,
+                                             const LIN_ScheduleEntryType * Schedule, uint8_t Length);
+void            XPD_LIN_Master_Tick         (LIN_HandleType * hlin);
+
+XPD_ReturnType  XPD_LIN_Slave_Start         (LIN_HandleType * hlin, LIN_FrameType * Frames, uint8_t Count);
+
+void            XPD_LIN_Stop                (LIN_HandleType * hlin);
+/** @} */
+
+/** @} */
+
+#endif /* XPD_USART_EXCLUDE_MODES */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __XPD_LIN_H_ */
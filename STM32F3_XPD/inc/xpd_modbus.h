@@ -0,0 +1,178 @@
+/**
+  ******************************************************************************
+  * @file    xpd_modbus.h
+  * @author  Benedek Kupper
+  * @version V0.1
+  * @date    2018-01-20
+  * @brief   STM32 eXtensible Peripheral Drivers Modbus RTU Module
+  *
+  *  This file is part of STM32_XPD.
+  *
+  *  STM32_XPD is free software: you can redistribute it and/or modify
+  *  it under the terms of the GNU General Public License as published by
+  *  the Free Software Foundation, either version 3 of the License, or
+  *  (at your option) any later version.
+  *
+  *  STM32_XPD is distributed in the hope that it will be useful,
+  *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with STM32_XPD.  If not, see <http://www.gnu.org/licenses/>.
+  */
+#ifndef __XPD_MODBUS_H_
+#define __XPD_MODBUS_H_
+
+#include "xpd_common.h"
+#include "xpd_config.h"
+#include "xpd_usart.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#if defined(USART_CR2_RTOEN) && !defined(XPD_USART_EXCLUDE_DMA)
+
+/** @defgroup MODBUS
+ *  @brief    Modbus RTU slave and master on USART
+ *  @details  The frames are delimited by the USART receiver timeout in hardware,
+ *            so the frame end is detected without any software timer. The requests
+ *            are processed in the receiver timeout interrupt, and the responses
+ *            are transmitted through the USART transmit queue, the register values
+ *            directly from the register map memory. The RS485 Driver Enable signal
+ *            is handled by the USART when initialized by @ref XPD_RS485_Init.
+ *  @code
+    static uint8_t setpoints[2 * 8], measurements[2 * 16];
+    static const MODBUS_RegisterBlockType holding[] = {
+        { .Address = 0x0000, .Count = 8, .Data = setpoints, .Writable = 1 },
+    };
+    static const MODBUS_RegisterBlockType input[] = {
+        { .Address = 0x1000, .Count = 16, .Data = measurements },
+    };
+
+    hmb.Address = 17;
+    hmb.Holding = holding; hmb.HoldingCount = 1;
+    hmb.Input   = input;   hmb.InputCount   = 1;
+    XPD_RS485_Init(&hmb.Serial, &common, &rs485);
+    XPD_USART_TxQueue_Init(&hmb.Serial, descriptors, 4);
+    XPD_Modbus_Slave_Start(&hmb);
+ *  @endcode
+ * @{ */
+
+/** @defgroup MODBUS_Exported_Types MODBUS Exported Types
+ * @{ */
+
+/** @brief Modbus register block structure */
+typedef struct
+{
+    uint16_t  Address;                  /*!< The address of the first register of the block */
+    uint16_t  Count;                    /*!< The number of registers in the block */
+    uint8_t * Data;                     /*!< The register values in big-endian byte order, as transmitted */
+    uint8_t   Writable;                 /*!< The holding registers of the block can be written by the master */
+}MODBUS_RegisterBlockType;
+
+/** @brief Modbus RTU handle structure */
+typedef struct
+{
+    USART_HandleType Serial;                 /*!< The handle of the bus USART, its transmit queue has to be
+                                                  set up with at least 3 elements */
+    uint8_t  Address;                        /*!< The own slave address [1 .. 247] */
+    uint32_t FrameTimeout;                   /*!< The frame end idle time in bit durations,
+                                                  0 for the standard 3.5 character time */
+    const MODBUS_RegisterBlockType * Holding;/*!< The holding register blocks of the slave */
+    const MODBUS_RegisterBlockType * Input;  /*!< The input register blocks of the slave */
+    uint8_t HoldingCount;                    /*!< The number of holding register blocks */
+    uint8_t InputCount;                      /*!< The number of input register blocks */
+    struct {
+        XPD_HandleCallbackType Write;        /*!< Slave: holding registers written callback,
+                                                  the registers are given by WriteAddress and WriteCount */
+        XPD_HandleCallbackType Response;     /*!< Master: response received callback,
+                                                  the response PDU is provided by @ref XPD_Modbus_GetPDU */
+    }Callbacks;                              /*   Modbus callbacks */
+    uint16_t WriteAddress;                   /*!< Slave: the address of the first written register */
+    uint16_t WriteCount;                     /*!< Slave: the number of written registers */
+    uint16_t Length;                         /*!< Master: the PDU length of the response, 0 if invalid */
+    uint16_t Errors;                         /*!< The number of dropped frames due to invalid length or CRC */
+    uint8_t  Master;                         /*!< [Internal] The handle is used as master */
+    uint8_t  Slave;                          /*!< [Internal] The addressed slave of the master request */
+    uint8_t  Responding;                     /*!< [Internal] The slave response is under transmission */
+    uint8_t  Crc[2];                         /*!< [Internal] The CRC of the response */
+    uint8_t  Buffer[256];                    /*!< [Internal] The ADU of the received frame and the response */
+}MODBUS_HandleType;
+
+/** @} */
+
+/** @defgroup MODBUS_Exported_Macros MODBUS Exported Macros
+ * @{ */
+
+/** @brief The initial value of the Modbus CRC calculation */
+#define MODBUS_CRC_INIT         0xFFFF
+
+/** @brief Modbus function codes */
+#define MODBUS_READ_HOLDING_REGISTERS   0x03
+#define MODBUS_READ_INPUT_REGISTERS     0x04
+#define MODBUS_WRITE_SINGLE_REGISTER    0x06
+#define MODBUS_WRITE_MULTIPLE_REGISTERS 0x10
+
+/** @brief Modbus exception codes */
+#define MODBUS_EXCEPTION_ILLEGAL_FUNCTION       0x01
+#define MODBUS_EXCEPTION_ILLEGAL_DATA_ADDRESS   0x02
+#define MODBUS_EXCEPTION_ILLEGAL_DATA_VALUE     0x03
+
+/** @} */
+
+/** @addtogroup MODBUS_Exported_Functions
+ * @{ */
+XPD_ReturnType  XPD_Modbus_Slave_Start      (MODBUS_HandleType * hmb);
+XPD_ReturnType  XPD_Modbus_Master_Request   (MODBUS_HandleType * hmb, uint8_t Slave,
+                                             const uint8_t * Pdu, uint8_t Length);
+void            XPD_Modbus_Stop             (MODBUS_HandleType * hmb);
+
+uint16_t        XPD_Modbus_CRC16            (uint16_t Crc, const uint8_t * Data, uint16_t Length);
+
+/**
+ * @brief Provides the PDU of the last received response.
+ * @param hmb: pointer to the Modbus handle structure
+ * @return Pointer to the function code of the response, which is followed by Length - 1 data bytes
+ */
+__STATIC_INLINE const uint8_t * XPD_Modbus_GetPDU(MODBUS_HandleType * hmb)
+{
+    return &hmb->Buffer[1];
+}
+
+/**
+ * @brief Reads a register value from a register block.
+ * @param Block: pointer to the register block
+ * @param Index: the index of the register within the block
+ * @return The value of the register
+ */
+__STATIC_INLINE uint16_t XPD_Modbus_GetRegister(const MODBUS_RegisterBlockType * Block, uint16_t Index)
+{
+    return ((uint16_t)Block->Data[2 * Index] << 8) | Block->Data[2 * Index + 1];
+}
+
+/**
+ * @brief Writes a register value to a register block.
+ * @param Block: pointer to the register block
+ * @param Index: the index of the register within the block
+ * @param Value: the new value of the register
+ */
+__STATIC_INLINE void XPD_Modbus_SetRegister(const MODBUS_RegisterBlockType * Block, uint16_t Index,
+        uint16_t Value)
+{
+    Block->Data[2 * Index]     = Value >> 8;
+    Block->Data[2 * Index + 1] = Value;
+}
+/** @} */
+
+/** @} */
+
+#endif /* USART_CR2_RTOEN */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __XPD_MODBUS_H_ */
@@ -27,6 +27,11 @@
 #include "xpd_common.h"
 #include "xpd_config.h"
 
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
 /** @defgroup NVIC
  * @{ */
 
@@ -43,6 +48,44 @@ typedef enum
     NVIC_PRIOGROUP_4PRE_0SUB = 3  /*!< 4 preemption priority bits, 0 subpriority bits */
 }NVIC_PrioGroupType;
 
+/** @brief NVIC interrupt priority table entry */
+typedef struct
+{
+    IRQn_Type    IRQn;          /*!< The interrupt line */
+    uint8_t      Preemption;    /*!< The preemption priority value */
+    uint8_t      Sub;           /*!< The subpriority value */
+    const char * Handler;       /*!< The name of the profiled handler function serving the line
+                                     (e.g. "XPD_USART_IRQHandler"), used by the latency report (can be NULL) */
+    uint32_t     Budget;        /*!< The tolerated worst-case latency of the line in profiling ticks (0 for no limit) */
+}NVIC_PriorityConfigType;
+
+/** @brief NVIC interrupt preemption requirement */
+typedef struct
+{
+    IRQn_Type    Producer;      /*!< The interrupt line which has to preempt the consumer (e.g. DMA stream) */
+    IRQn_Type    Consumer;      /*!< The interrupt line which depends on the producer (e.g. USART) */
+}NVIC_PriorityOrderType;
+
+#if (__FPU_PRESENT == 1)
+/** @brief NVIC floating-point context stacking types
+ *  @details When the interrupted context has an active FP state, the exception entry
+ *           stacks 17 more words (S0-S15, FPSCR) for the FP context:
+ *           @n - immediately, at each exception entry
+ *           @n - lazily, only the stack space is reserved, and the registers are only saved
+ *                when the handler executes its first FP instruction, therefore the
+ *                integer-only handlers (such as the XPD peripheral IRQ handlers) have no FP stacking overhead
+ */
+typedef enum
+{
+    NVIC_FPU_STACKING_OFF       = 0,                    /*!< The FP context is not stacked, the handlers
+                                                             must not use the FPU */
+    NVIC_FPU_STACKING_IMMEDIATE = FPU_FPCCR_ASPEN_Msk,  /*!< The FP context is stacked at the exception entry */
+    NVIC_FPU_STACKING_LAZY      = FPU_FPCCR_ASPEN_Msk
+                                | FPU_FPCCR_LSPEN_Msk,  /*!< The FP context is stacked at the first FP instruction
+                                                             of the handler (reset default) */
+}NVIC_FPUStackingType;
+#endif
+
 /** @} */
 
 /** @defgroup NVIC_Exported_Macros NVIC Exported Macros
@@ -98,7 +141,7 @@ typedef enum
  * @param  IRQN: the selected @ref IRQn_Type line to disable
  */
 #define         XPD_NVIC_DisableIRQ(IRQN)                                   \
-    NVIC_EnableIRQ(IRQN)
+    NVIC_DisableIRQ(IRQN)
 
 /**
  * @brief  NVIC interrupt priority configuration setting macro.
@@ -109,14 +152,69 @@ typedef enum
 #define         XPD_NVIC_SetPriorityConfig(IRQN,PREEMPT_PRIO,SUB_PRIO)      \
     NVIC_SetPriority((IRQN), NVIC_EncodePriority(NVIC_GetPriorityGrouping(),(PREEMPT_PRIO),(SUB_PRIO)))
 
+#if (__FPU_PRESENT == 1)
+#ifndef XPD_FPU_STACKING
+/**
+ * @brief  The FP context stacking mode which is set by XPD_Init. [overrideable]
+ */
+#define XPD_FPU_STACKING        NVIC_FPU_STACKING_LAZY
+#endif
+
+/**
+ * @brief  Sets the floating-point context stacking of the exceptions.
+ * @param  MODE: the selected @ref NVIC_FPUStackingType
+ */
+#define         XPD_NVIC_SetFPUStacking(MODE)                               \
+    (FPU->FPCCR.w = (FPU->FPCCR.w & ~(FPU_FPCCR_ASPEN_Msk | FPU_FPCCR_LSPEN_Msk)) | (MODE))
+
+/**
+ * @brief  Returns the floating-point context stacking of the exceptions.
+ * @return The configured @ref NVIC_FPUStackingType
+ */
+#define         XPD_NVIC_GetFPUStacking()                                   \
+    ((NVIC_FPUStackingType)(FPU->FPCCR.w & (FPU_FPCCR_ASPEN_Msk | FPU_FPCCR_LSPEN_Msk)))
+#endif
+
 /**
  * @brief System reset redirection macro.
  */
 #define         XPD_SystemReset()                                           \
     NVIC_SystemReset()
 
+#ifdef USE_XPD_IRQ_REGISTRY
+#ifndef XPD_NVIC_HANDLER_COUNT
+/**
+ * @brief  The number of interrupt lines which can be served from the handler registry. [overrideable]
+ */
+#define XPD_NVIC_HANDLER_COUNT  8
+#endif
+#endif
+
 /** @} */
 
+
+/** @addtogroup NVIC_Exported_Functions
+ * @{ */
+uint32_t        XPD_NVIC_GetPreemptPriority (IRQn_Type IRQn);
+
+void            XPD_NVIC_InitPriorities     (const NVIC_PriorityConfigType * Table, uint8_t Count);
+XPD_ReturnType  XPD_NVIC_CheckPriorityOrder (const NVIC_PriorityOrderType * Order, uint8_t Count,
+                                             uint8_t * FailedIndex);
+
+#ifdef USE_XPD_IRQ_REGISTRY
+XPD_ReturnType  XPD_NVIC_InitVectorTable    (uint32_t * Table, uint16_t Count);
+
+XPD_ReturnType  XPD_NVIC_RegisterHandler    (IRQn_Type IRQn, XPD_HandleCallbackType Handler, void * Handle);
+void            XPD_NVIC_UnregisterHandler  (IRQn_Type IRQn);
+
+void            XPD_NVIC_IRQHandler         (void);
+#endif
 /** @} */
 
+/** @} */
+
+#ifdef __cplusplus
+}
+#endif
+
 #endif /* __XPD_NVIC_H_ */
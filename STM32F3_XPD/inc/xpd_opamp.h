@@ -0,0 +1,151 @@
+/**
+  ******************************************************************************
+  * @file    xpd_opamp.h
+  * @author  Benedek Kupper
+  * @version V0.1
+  * @date    2018-01-20
+  * @brief   STM32 eXtensible Peripheral Drivers OPAMP Module
+  *
+  *  This file is part of STM32_XPD.
+  *
+  *  STM32_XPD is free software: you can redistribute it and/or modify
+  *  it under the terms of the GNU General Public License as published by
+  *  the Free Software Foundation, either version 3 of the License, or
+  *  (at your option) any later version.
+  *
+  *  STM32_XPD is distributed in the hope that it will be useful,
+  *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with STM32_XPD.  If not, see <http://www.gnu.org/licenses/>.
+  */
+#ifndef __XPD_OPAMP_H_
+#define __XPD_OPAMP_H_
+
+#include "xpd_common.h"
+#include "xpd_config.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/** @defgroup OPAMP
+ *  @brief    Operational amplifiers with programmable gain and offset self-calibration
+ *  @details  A shunt current sense amplifier can feed both a comparator and an ADC channel:
+ *  @code
+    const OPAMP_InitType shunt = {
+        .Mode        = OPAMP_MODE_PGA,
+        .InputPlus   = OPAMP_INPUTPLUS_VP0,
+        .Gain        = OPAMP_PGA_GAIN_8,
+    };
+    OPAMP_TrimType trim;
+
+    XPD_OPAMP_Init(OPAMP1, &shunt);
+    XPD_OPAMP_SelfCalibrate(OPAMP1, &trim);
+    XPD_OPAMP_Enable(OPAMP1);
+ *  @endcode
+ * @{ */
+
+/** @defgroup OPAMP_Exported_Types OPAMP Exported Types
+ * @{ */
+
+/** @brief OPAMP operating modes */
+typedef enum
+{
+    OPAMP_MODE_STANDALONE_VM1 = 0, /*!< Standalone mode with the VM1 pin as inverting input */
+    OPAMP_MODE_STANDALONE_VM0 = 1, /*!< Standalone mode with the VM0 pin as inverting input */
+    OPAMP_MODE_PGA            = 2, /*!< Programmable gain amplifier mode */
+    OPAMP_MODE_FOLLOWER       = 3, /*!< Voltage follower mode */
+}OPAMP_ModeType;
+
+/** @brief OPAMP non-inverting input selection */
+typedef enum
+{
+    OPAMP_INPUTPLUS_VP3 = 0, /*!< VP3 pin */
+    OPAMP_INPUTPLUS_VP2 = 1, /*!< VP2 pin */
+    OPAMP_INPUTPLUS_VP1 = 2, /*!< VP1 pin */
+    OPAMP_INPUTPLUS_VP0 = 3, /*!< VP0 pin */
+}OPAMP_InputPlusType;
+
+/** @brief OPAMP programmable gain values */
+typedef enum
+{
+    OPAMP_PGA_GAIN_2  = 0, /*!< Gain of 2 */
+    OPAMP_PGA_GAIN_4  = 1, /*!< Gain of 4 */
+    OPAMP_PGA_GAIN_8  = 2, /*!< Gain of 8 */
+    OPAMP_PGA_GAIN_16 = 3, /*!< Gain of 16 */
+}OPAMP_PgaGainType;
+
+/** @brief OPAMP programmable gain feedback network connection */
+typedef enum
+{
+    OPAMP_PGA_CONNECT_INTERNAL = 0, /*!< The feedback network is connected to ground internally */
+    OPAMP_PGA_CONNECT_VM0      = 2, /*!< The feedback network is connected to VM0 for filtering */
+    OPAMP_PGA_CONNECT_VM1      = 3, /*!< The feedback network is connected to VM1 for filtering */
+}OPAMP_PgaConnectType;
+
+/** @brief OPAMP setup structure */
+typedef struct
+{
+    OPAMP_ModeType       Mode;          /*!< Operating mode */
+    OPAMP_InputPlusType  InputPlus;     /*!< Non-inverting input selection */
+    OPAMP_PgaGainType    Gain;          /*!< Gain in PGA mode */
+    OPAMP_PgaConnectType Connect;       /*!< Feedback network connection in PGA mode */
+}OPAMP_InitType;
+
+/** @brief OPAMP offset trimming values */
+typedef struct
+{
+    uint8_t P;                          /*!< PMOS differential pair trimming value [0..31] */
+    uint8_t N;                          /*!< NMOS differential pair trimming value [0..31] */
+}OPAMP_TrimType;
+
+/** @} */
+
+/** @addtogroup OPAMP_Exported_Functions
+ * @{ */
+void            XPD_OPAMP_Init          (OPAMP_TypeDef * OPAMPx, const OPAMP_InitType * Config);
+void            XPD_OPAMP_Deinit        (OPAMP_TypeDef * OPAMPx);
+
+void            XPD_OPAMP_SelfCalibrate (OPAMP_TypeDef * OPAMPx, OPAMP_TrimType * Trim);
+void            XPD_OPAMP_SetTrim       (OPAMP_TypeDef * OPAMPx, const OPAMP_TrimType * Trim);
+
+/**
+ * @brief Enables the operational amplifier.
+ * @param OPAMPx: the operational amplifier peripheral
+ */
+__STATIC_INLINE void XPD_OPAMP_Enable(OPAMP_TypeDef * OPAMPx)
+{
+    OPAMPx->CSR.b.EN = 1;
+}
+
+/**
+ * @brief Disables the operational amplifier.
+ * @param OPAMPx: the operational amplifier peripheral
+ */
+__STATIC_INLINE void XPD_OPAMP_Disable(OPAMP_TypeDef * OPAMPx)
+{
+    OPAMPx->CSR.b.EN = 0;
+}
+
+/**
+ * @brief Makes the operational amplifier configuration read-only until the next system reset.
+ * @param OPAMPx: the operational amplifier peripheral
+ */
+__STATIC_INLINE void XPD_OPAMP_Lock(OPAMP_TypeDef * OPAMPx)
+{
+    OPAMPx->CSR.b.LOCK = 1;
+}
+
+/** @} */
+
+/** @} */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __XPD_OPAMP_H_ */
@@ -27,6 +27,11 @@
 #include "xpd_common.h"
 #include "xpd_config.h"
 
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
 /** @defgroup PWR
  * @{ */
 
@@ -70,6 +75,15 @@ typedef enum
 #define         XPD_PWR_ClearFlag(FLAG_NAME)    \
     (PWR_REG_BIT(CR,C##FLAG_NAME) = 1)
 
+/** @brief RTC wakeup timer EXTI line number */
+#define PWR_RTC_WAKEUP_EXTI_LINE        20
+
+/** @brief RTC alarms EXTI line number */
+#define PWR_RTC_ALARM_EXTI_LINE         17
+
+/** @brief RTC tamper and timestamp EXTI line number */
+#define PWR_RTC_TAMP_STAMP_EXTI_LINE    19
+
 #ifdef PWR_BB
 #define PWR_REG_BIT(_REG_NAME_, _BIT_NAME_) (PWR_BB->_REG_NAME_._BIT_NAME_)
 #else
@@ -220,4 +234,8 @@ __STATIC_INLINE void XPD_PWR_PVD_Disable(void)
 
 /** @} */
 
+#ifdef __cplusplus
+}
+#endif
+
 #endif /* __XPD_PWR_H_ */
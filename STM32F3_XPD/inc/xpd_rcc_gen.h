@@ -24,6 +24,11 @@
 #ifndef __XPD_RCC_GEN_H_
 #define __XPD_RCC_GEN_H_
 
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
 
 /** @addtogroup RCC
  * @{ */
@@ -385,4 +390,8 @@ void XPD_WWDG_Reset(void);
 
 /** @} */
 
+#ifdef __cplusplus
+}
+#endif
+
 #endif /* __XPD_RCC_GEN_H_ */
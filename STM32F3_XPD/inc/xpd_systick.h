@@ -27,6 +27,11 @@
 #include "xpd_common.h"
 #include "xpd_config.h"
 
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
 /** @defgroup SysTick
  * @{ */
 
@@ -40,6 +45,15 @@ typedef enum
     SYSTICK_CLOCKSOURCE_HCLK      = 1  /*!< SysTick clock source is HCLK */
 }SysTick_ClockSourceType;
 
+/** @brief SysTick periodic subscriber structure */
+typedef struct SysTick_SubscriberType
+{
+    XPD_SimpleCallbackType Callback;        /*!< The function to call periodically from the SysTick handler */
+    uint16_t Divisor;                       /*!< The callback period in SysTick periods (ms) */
+    uint16_t Countdown;                     /*!< [Internal] The remaining SysTick periods until the next callback */
+    struct SysTick_SubscriberType * Next;   /*!< [Internal] The next registered subscriber */
+}SysTick_SubscriberType;
+
 /** @} */
 
 /** @defgroup SysTick_Exported_Functions SysTick Exported Functions
@@ -120,8 +134,23 @@ __STATIC_INLINE void XPD_SysTick_Stop_IT(void)
 
 /** @} */
 
+/** @addtogroup SysTick_Exported_Functions_Service
+ * @{ */
+void            XPD_SysTick_Subscribe       (SysTick_SubscriberType * Subscriber);
+void            XPD_SysTick_Unsubscribe     (SysTick_SubscriberType * Subscriber);
+
+uint64_t        XPD_SysTick_GetUptime_ms    (void);
+uint64_t        XPD_SysTick_GetUptime_us    (void);
+
+void            XPD_SysTick_IRQHandler      (void);
+/** @} */
+
 /** @} */
 
 /** @} */
 
+#ifdef __cplusplus
+}
+#endif
+
 #endif /* __XPD_SYSTICK_H_ */
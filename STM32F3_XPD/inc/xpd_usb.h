@@ -27,6 +27,11 @@
 #include "xpd_common.h"
 #include "xpd_config.h"
 
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
 #ifdef USB
 /** @defgroup USB
  * @{ */
@@ -60,6 +65,14 @@ typedef enum
     USB_EP_TYPE_INTERRUPT   = 3  /*!< Interrupt endpoint type */
 }USB_EndPointType;
 
+/** @brief USB Endpoint configuration structure for packet memory allocation */
+typedef struct
+{
+    uint8_t             Address;        /*!< Endpoint address (the direction is set by bit 7) */
+    USB_EndPointType    Type;           /*!< Endpoint type */
+    uint16_t            MaxPacketSize;  /*!< Endpoint Max packet size [0..1023] */
+}USB_EndPointConfigType;
+
 /** @brief USB Endpoint management structure */
 typedef struct
 {
@@ -70,6 +83,8 @@ typedef struct
     boolean_t           Stalled;        /*!< Endpoint stall status */
     uint8_t             RegId;          /*!< Endpoint register ID */
     FunctionalState     DoubleBuffer;   /*!< Double buffer configuration */
+    boolean_t           PendingZLP;     /*!< [Internal] IN transfer is terminated by ZLP */
+    uint16_t            PacketLength;   /*!< [Internal] OUT packet size limit of the transfer */
 }USB_EndPointHandleType;
 
 /** @brief Device Link power state */
@@ -95,6 +110,20 @@ typedef enum
 }USB_ChargerType;
 #endif
 
+/** @brief USB event callbacks structure */
+typedef struct
+{
+    int (*SetupStage)       (void *, uint8_t *);            /*!< SETUP packet received */
+    int (*DataOutStage)     (void *, uint8_t, uint8_t *);   /*!< OUT data received */
+    int (*DataInStage)      (void *, uint8_t, uint8_t *);   /*!< IN data transmitted */
+    int (*SOF)              (void *);                       /*!< StartOfFrame signal */
+    int (*Reset)            (void *);                       /*!< Device reset */
+    int (*Suspend)          (void *);                       /*!< Suspend request */
+    int (*Resume)           (void *);                       /*!< Resume request */
+    int (*Connected)        (void *);                       /*!< Device connected to bus */
+    int (*Disconnected)     (void *);                       /*!< Device disconnected from bus */
+}USB_CallbacksType;
+
 /** @brief USB Handle structure */
 typedef struct
 {
@@ -105,6 +134,10 @@ typedef struct
 #ifndef USB_BCDR_DPPU
         XPD_CtrlFnType ConnectionStateCtrl;                     /*!< Callback to set USB device bus line connection state */
 #endif
+#ifdef USE_XPD_CONST_CALLBACKS
+        const USB_CallbacksType * Table;                        /*!< Constant event callbacks table, none of its
+                                                                     entries may be NULL (see @ref XPD_USB_NullCallback) */
+#else
         int (*SetupStage)       (void *, uint8_t *);            /*!< SETUP packet received */
         int (*DataOutStage)     (void *, uint8_t, uint8_t *);   /*!< OUT data received */
         int (*DataInStage)      (void *, uint8_t, uint8_t *);   /*!< IN data transmitted */
@@ -114,6 +147,7 @@ typedef struct
         int (*Resume)           (void *);                       /*!< Resume request */
         int (*Connected)        (void *);                       /*!< Device connected to bus */
         int (*Disconnected)     (void *);                       /*!< Device disconnected from bus */
+#endif
     }Callbacks;                                                 /*   Handle Callbacks */
     uint32_t                    Setup[12];                      /*!< Setup packet buffer */
     struct {
@@ -125,6 +159,9 @@ typedef struct
     uint8_t                     DeviceAddress;                  /*!< USB Address */
     FunctionalState             LowPowerMode;                   /*!< Low power mode configuration */
     USB_LinkStateType           LinkState;                      /*!< Device link status */
+#ifdef USE_XPD_STATISTICS
+    XPD_StatsType               Stats;                          /*!< Runtime statistics (errors: [0] packet error, [1] packet memory overrun) */
+#endif
 }USB_HandleType;
 
 /** @} */
@@ -233,6 +270,13 @@ typedef struct
 #define         XPD_USB_ClearFlag(HANDLE, FLAG_NAME)    \
     (USB_REG_BIT(HANDLE,ISTR,FLAG_NAME) = 0)
 
+/**
+ * @brief  Provides the frame number of the last received SOF.
+ * @param  HANDLE: specifies the USB Handle.
+ */
+#define         XPD_USB_GetFrameNumber(HANDLE)          \
+    (USB->FNR.w & USB_FNR_FN)
+
 /** @brief USB Wake up line number */
 #define         USB_WAKEUP_EXTI_LINE            18
 
@@ -248,6 +292,16 @@ typedef struct
  */
 #define         XPD_USB_BESL(HANDLE)                (USB->LPMCSR.b.BESL)
 
+/**
+ * @brief  Provides the host's resume latency of the L1 sleep state in microseconds,
+ *         as determined by the BESL value of the last acknowledged LPM token.
+ * @param  HANDLE: specifies the USB Handle.
+ */
+#define         XPD_USB_L1Latency_us(HANDLE)                                \
+    ((XPD_USB_BESL(HANDLE) < 2) ? (125 + 25 * XPD_USB_BESL(HANDLE)) :       \
+     (XPD_USB_BESL(HANDLE) < 6) ? (100 * XPD_USB_BESL(HANDLE)) :            \
+                                  (1000 * (XPD_USB_BESL(HANDLE) - 5)))
+
 /** @brief Compatibility macro */
 #define         XPD_USB_EP_Flush(HANDLE,EP_NUMBER)  ((void)0)
 
@@ -268,6 +322,8 @@ void            XPD_USB_SetAddress              (USB_HandleType * husb, uint8_t
 
 void            XPD_USB_EP_BufferInit           (USB_HandleType * husb, uint8_t EpAddress,
                                                  uint16_t BufferSize);
+XPD_ReturnType  XPD_USB_EP_PmaAlloc             (USB_HandleType * husb,
+                                                 const USB_EndPointConfigType * Endpoints, uint8_t Count);
 
 void            XPD_USB_EP_Open                 (USB_HandleType * husb, uint8_t EpAddress,
                                                  USB_EndPointType Type, uint16_t MaxPacketSize);
@@ -279,11 +335,18 @@ uint16_t        XPD_USB_EP_GetRxCount           (USB_HandleType * husb, uint8_t
 
 void            XPD_USB_EP_Transmit             (USB_HandleType * husb, uint8_t EpAddress,
                                                  uint8_t * Data, uint16_t Length);
+void            XPD_USB_EP_TransmitEnd          (USB_HandleType * husb, uint8_t EpAddress,
+                                                 uint8_t * Data, uint16_t Length);
 
 void            XPD_USB_EP_SetStall             (USB_HandleType * husb, uint8_t EpAddress);
 void            XPD_USB_EP_ClearStall           (USB_HandleType * husb, uint8_t EpAddress);
 
 void            XPD_USB_IRQHandler              (USB_HandleType * husb);
+uint32_t        XPD_USB_Poll                    (USB_HandleType * husb, uint32_t MaxPackets);
+
+#ifdef USE_XPD_CONST_CALLBACKS
+int             XPD_USB_NullCallback            (void * User);
+#endif
 
 void            XPD_USB_ActivateRemoteWakeup    (USB_HandleType * husb);
 void            XPD_USB_DeactivateRemoteWakeup  (USB_HandleType * husb);
@@ -302,4 +365,8 @@ USB_ChargerType XPD_USB_ChargerDetect           (USB_HandleType * husb);
 
 #endif /* USB */
 
+#ifdef __cplusplus
+}
+#endif
+
 #endif /* __XPD_USB_H_ */
@@ -0,0 +1,136 @@
+/**
+  ******************************************************************************
+  * @file    xpd_usb_sync.h
+  * @author  Benedek Kupper
+  * @version V0.1
+  * @date    2018-01-20
+  * @brief   STM32 eXtensible Peripheral Drivers USB Frame Synchronization Module
+  *
+  *  This file is part of STM32_XPD.
+  *
+  *  STM32_XPD is free software: you can redistribute it and/or modify
+  *  it under the terms of the GNU General Public License as published by
+  *  the Free Software Foundation, either version 3 of the License, or
+  *  (at your option) any later version.
+  *
+  *  STM32_XPD is distributed in the hope that it will be useful,
+  *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with STM32_XPD.  If not, see <http://www.gnu.org/licenses/>.
+  */
+#ifndef __XPD_USB_SYNC_H_
+#define __XPD_USB_SYNC_H_
+
+#include "xpd_common.h"
+#include "xpd_config.h"
+#include "xpd_tim.h"
+#include "xpd_usb.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#if defined(USB) || defined(USB_OTG_FS)
+
+/** @defgroup USB_Sync
+ *  @brief    Local timebase disciplined by the USB Start of Frames
+ *  @details  The host transmits a SOF with an incrementing 11 bit frame number every millisecond
+ *            to all devices on the bus. The start of each frame is timestamped with a free-running
+ *            local timer, and a tracking loop estimates the phase and the period of the host frames
+ *            in timer ticks. The local timestamps are then converted to the host's time, which is
+ *            common for all devices connected to the same host controller (modulo 2048 ms).
+ *            The timestamp is either captured by the timer from the SOF pulse through an internal
+ *            trigger (see @ref XPD_USB_SOF_TimerTrigger where available), or the counter is read
+ *            at the SOF interrupt, which adds the interrupt latency jitter.
+ *            The counter period of the timer has to be longer than a frame.
+ *  @code
+    XPD_TIM_Init(&htim2, &counter);
+    XPD_TIM_Counter_Start(&htim2);
+    XPD_USB_SOF_TimerTrigger(&husb, ENABLE);
+    XPD_USB_Sync_Init(&hsync, &syncConfig);
+
+    // in the SOF callback of the USB device stack
+    XPD_USB_Sync_SOF(&hsync);
+
+    // convert the capture timestamp of a sample
+    sample.Time = XPD_USB_Sync_ToHostTime(&hsync, XPD_TIM_Channel_Value(&htim3, TIM_CHANNEL_1));
+ *  @endcode
+ * @{ */
+
+/** @defgroup USB_Sync_Exported_Types USB Sync Exported Types
+ * @{ */
+
+/** @brief USB frame synchronization setup structure */
+typedef struct
+{
+    FunctionalState      Capture;   /*!< The SOF pulse is captured by the timer through an internal trigger,
+                                         otherwise the counter is read at the SOF interrupt */
+    TIM_ChannelType      Channel;   /*!< The capture channel of the SOF pulse (if Capture is enabled) */
+    TIM_TriggerInputType Trigger;   /*!< The internal trigger carrying the SOF pulse
+                                         [TIM_TRGI_ITR0..TIM_TRGI_ITR3] (if Capture is enabled) */
+    uint8_t              Shift;     /*!< Tracking loop strength, the phase error weight is 1 / 2^Shift [0..7] */
+}USB_Sync_InitType;
+
+/** @brief USB frame synchronization handle structure */
+typedef struct
+{
+    USB_HandleType * Usb;           /*!< The USB device handle providing the frame numbers */
+    TIM_HandleType * Timer;         /*!< The free-running timer of the local timebase */
+    uint32_t Frame;                 /*!< The host frame count of the last SOF, its low 11 bits
+                                         are the frame number on the bus */
+    uint32_t Stamp;                 /*!< [Internal] The estimated timer value at the last SOF */
+    uint32_t Period;                /*!< [Internal] The estimated frame duration in 1/256 timer ticks */
+    uint16_t Tracked;               /*!< [Internal] The number of tracked frames since the last resynchronization */
+    uint16_t FrameNumber;           /*!< [Internal] The bus frame number of the last SOF */
+    uint8_t  Fraction;              /*!< [Internal] The sub-tick part of the stamp in 1/256 timer ticks */
+    uint8_t  Shift;                 /*!< [Internal] Tracking loop strength */
+    uint8_t  Capture;               /*!< [Internal] The SOF is captured by the timer */
+    TIM_ChannelType Channel;        /*!< [Internal] The capture channel of the SOF pulse */
+}USB_SyncHandleType;
+
+/** @} */
+
+/** @defgroup USB_Sync_Exported_Macros USB Sync Exported Macros
+ * @{ */
+
+/**
+ * @brief  USB frame synchronization handle initializer macro
+ * @param  USB_HANDLE: specifies the USB device handle.
+ * @param  TIM_HANDLE: specifies the timer handle of the local timebase.
+ */
+#define         NEW_USB_SYNC_HANDLE(USB_HANDLE, TIM_HANDLE)     \
+    {.Usb = (USB_HANDLE), .Timer = (TIM_HANDLE)}
+
+/**
+ * @brief  Determines whether the tracking loop has settled since the last resynchronization.
+ * @param  HANDLE: specifies the USB frame synchronization handle.
+ */
+#define         XPD_USB_Sync_IsLocked(HANDLE)                   \
+    ((HANDLE)->Tracked > (2UL << (2 * (HANDLE)->Shift)))
+
+/** @} */
+
+/** @addtogroup USB_Sync_Exported_Functions
+ * @{ */
+void            XPD_USB_Sync_Init           (USB_SyncHandleType * hsync, const USB_Sync_InitType * Config);
+void            XPD_USB_Sync_Deinit         (USB_SyncHandleType * hsync);
+
+void            XPD_USB_Sync_SOF            (USB_SyncHandleType * hsync);
+
+uint32_t        XPD_USB_Sync_ToHostTime     (USB_SyncHandleType * hsync, uint32_t Ticks);
+int32_t         XPD_USB_Sync_GetDrift       (USB_SyncHandleType * hsync);
+/** @} */
+
+/** @} */
+
+#endif /* defined(USB) || defined(USB_OTG_FS) */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __XPD_USB_SYNC_H_ */
@@ -37,6 +37,15 @@
 
 static int32_t VDDA_mV = (int32_t)VDDA_VALUE;
 
+/* Q15 scale of a 12 bit conversion count to milliVolts */
+static int32_t VDDA_mV_Q15 = ((int32_t)VDDA_VALUE << 15) / 4095;
+
+#define ADC_Q15_ROUND           (1 << 14)
+#define ADC_Q11_ROUND           (1 << 10)
+
+/* Filtered VREFINT conversion, scaled by 2^ADC_VDDA_FILTER_SHIFT, 0 until the first sample */
+static uint32_t VREFINT_Filtered = 0;
+
 #if (__FPU_PRESENT == 1) && (__FPU_USED == 1)
 static float   VDDA_V  = ((float)VDDA_VALUE) / 1000.0;
 
@@ -113,12 +122,56 @@ int32_t XPD_ADC_SetVDDA(uint16_t vRefintConversion)
      * VREFINT_CAL * 3300 / 4095 = vRefintConversion * VDD / 4095
      */
     VDDA_mV = ((int32_t)ADC_VREFINT_CAL * ADC_CAL_mV) / (int32_t)vRefintConversion;
+    VDDA_mV_Q15 = (VDDA_mV << 15) / 4095;
 #if (__FPU_PRESENT == 1) && (__FPU_USED == 1)
     VDDA_V  = ((float)ADC_VREFINT_CAL * ((float)ADC_CAL_mV / 1000.0)) / (float)vRefintConversion;
 #endif
     return VDDA_mV;
 }
 
+/**
+ * @brief Smooths the VREFINT conversions of a background monitor with a first order low-pass filter,
+ *        and updates the VDDA value of the other calculations with the filtered result.
+ * @note  The VDDA values are replaced in a critical section, so the calculations never use
+ *        the milliVolt and the scale values of different measurements.
+ * @param vRefintConversion: the (12 bit right aligned) VREFINT conversion
+ * @return The filtered VDDA voltage in milliVolts
+ */
+int32_t XPD_ADC_TrackVDDA(uint16_t vRefintConversion)
+{
+    uint32_t primask, filtered;
+    int32_t mV, mV_Q15;
+
+    if (VREFINT_Filtered == 0)
+    {
+        /* Start from the first sample instead of settling from zero */
+        VREFINT_Filtered = (uint32_t)vRefintConversion << ADC_VDDA_FILTER_SHIFT;
+    }
+    else
+    {
+        VREFINT_Filtered -= VREFINT_Filtered >> ADC_VDDA_FILTER_SHIFT;
+        VREFINT_Filtered += vRefintConversion;
+    }
+    filtered = VREFINT_Filtered;
+
+    /* The calculations are done on the scaled value for extra resolution */
+    mV     = ((int32_t)ADC_VREFINT_CAL * ADC_CAL_mV << ADC_VDDA_FILTER_SHIFT) / (int32_t)filtered;
+    mV_Q15 = (mV << 15) / 4095;
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+
+    VDDA_mV     = mV;
+    VDDA_mV_Q15 = mV_Q15;
+#if (__FPU_PRESENT == 1) && (__FPU_USED == 1)
+    VDDA_V      = (float)mV / 1000.0;
+#endif
+
+    __set_PRIMASK(primask);
+
+    return mV;
+}
+
 /**
  * @brief Returns the last measured VDDA value in voltage.
  * @return The VDDA voltage measured in milliVolts
@@ -148,6 +201,137 @@ int32_t XPD_ADC_GetValue_mV(uint16_t channelConversion)
     return ((int32_t)channelConversion * VDDA_mV) / 4095;
 }
 
+/**
+ * @brief Converts a block of (12 bit right aligned) channel measurements to voltage.
+ * @note  The conversion uses a fixed-point scale derived from VDDA, the results
+ *        may differ by 1 mV from @ref XPD_ADC_GetValue_mV due to rounding.
+ * @param channelConversions: pointer to the array of conversions
+ * @param values: pointer to the array of channel voltage levels in milliVolts
+ * @param count: the number of conversions to process
+ */
+void XPD_ADC_ConvertBlock_mV(const uint16_t * channelConversions, int32_t * values, uint32_t count)
+{
+    int32_t scale = VDDA_mV_Q15;
+
+#if (__CORTEX_M >= 0x04U)
+    /* Word align the input to process two conversions with each access */
+    if (((uint32_t)channelConversions & 2) && (count > 0))
+    {
+        *values++ = ((int32_t)*channelConversions++ * scale + ADC_Q15_ROUND) >> 15;
+        count--;
+    }
+    {
+        const uint32_t * pairs = (const uint32_t *)channelConversions;
+        uint32_t scaleLow = (uint32_t)scale, scaleHigh = (uint32_t)scale << 16;
+
+        for (; count >= 2; count -= 2)
+        {
+            uint32_t pair = *pairs++;
+
+            /* The dual multiplication selects the conversion by the zero half of the scale */
+            values[0] = ((int32_t)__SMUAD(pair, scaleLow)  + ADC_Q15_ROUND) >> 15;
+            values[1] = ((int32_t)__SMUAD(pair, scaleHigh) + ADC_Q15_ROUND) >> 15;
+            values += 2;
+        }
+        channelConversions = (const uint16_t *)pairs;
+    }
+#endif
+    for (; count > 0; count--)
+    {
+        *values++ = ((int32_t)*channelConversions++ * scale + ADC_Q15_ROUND) >> 15;
+    }
+}
+
+/**
+ * @brief Converts a block of byte packed (8 bit range) channel measurements to voltage.
+ * @note  The byte packed conversions are stored by @ref XPD_ADC_DMA_BytePacking.
+ * @param channelConversions: pointer to the array of byte conversions
+ * @param values: pointer to the array of channel voltage levels in milliVolts
+ * @param count: the number of conversions to process
+ */
+void XPD_ADC_ConvertBlock8_mV(const uint8_t * channelConversions, int32_t * values, uint32_t count)
+{
+    /* The Q11 scale of an 8 bit conversion fits in a signed half word */
+    int32_t scale = (VDDA_mV << 11) / 255;
+
+#if (__CORTEX_M >= 0x04U)
+    /* Word align the input to process four conversions with each access */
+    for (; (count > 0) && (((uint32_t)channelConversions & 3) != 0); count--)
+    {
+        *values++ = ((int32_t)*channelConversions++ * scale + ADC_Q11_ROUND) >> 11;
+    }
+    {
+        const uint32_t * quads = (const uint32_t *)channelConversions;
+        uint32_t scaleLow = (uint32_t)scale, scaleHigh = (uint32_t)scale << 16;
+
+        for (; count >= 4; count -= 4)
+        {
+            uint32_t quad = *quads++;
+
+            /* The even and the odd conversions are extended to half word pairs */
+            uint32_t even = __UXTB16(quad), odd = __UXTB16(__ROR(quad, 8));
+
+            values[0] = ((int32_t)__SMUAD(even, scaleLow)  + ADC_Q11_ROUND) >> 11;
+            values[1] = ((int32_t)__SMUAD(odd,  scaleLow)  + ADC_Q11_ROUND) >> 11;
+            values[2] = ((int32_t)__SMUAD(even, scaleHigh) + ADC_Q11_ROUND) >> 11;
+            values[3] = ((int32_t)__SMUAD(odd,  scaleHigh) + ADC_Q11_ROUND) >> 11;
+            values += 4;
+        }
+        channelConversions = (const uint8_t *)quads;
+    }
+#endif
+    for (; count > 0; count--)
+    {
+        *values++ = ((int32_t)*channelConversions++ * scale + ADC_Q11_ROUND) >> 11;
+    }
+}
+
+/**
+ * @brief Searches the first byte packed conversion which reaches a level,
+ *        e.g. to locate the trigger point in a captured block.
+ * @param input: pointer to the array of byte conversions
+ * @param count: the number of conversions to search
+ * @param level: the searched conversion level
+ * @return The index of the first conversion not below the level, or count if there is none
+ */
+uint32_t XPD_ADC_FindLevel8(const uint8_t * input, uint32_t count, uint8_t level)
+{
+    uint32_t i = 0;
+
+#if (__CORTEX_M >= 0x04U)
+    uint32_t levels = level * 0x01010101UL;
+
+    for (; (i < count) && (((uint32_t)&input[i] & 3) != 0); i++)
+    {
+        if (input[i] >= level)
+        {
+            return i;
+        }
+    }
+    for (; (i + 4) <= count; i += 4)
+    {
+        uint32_t mask;
+
+        /* The GE flags are set for the bytes which are not below the level */
+        (void) __USUB8(*(const uint32_t*)&input[i], levels);
+        mask = __SEL(0xFFFFFFFFUL, 0);
+
+        if (mask != 0)
+        {
+            return i + (__CLZ(__RBIT(mask)) >> 3);
+        }
+    }
+#endif
+    for (; i < count; i++)
+    {
+        if (input[i] >= level)
+        {
+            break;
+        }
+    }
+    return i;
+}
+
 /**
  * @brief Converts a (12 bit right aligned) temperature sensor measurement to degree Celsius.
  * @return The temperature sensor's value in degree Celcius
@@ -184,6 +368,187 @@ int32_t XPD_ADC_GetTemperature(uint16_t tempConversion)
 
 /** @} */
 
+/** @addtogroup ADC_Decimation
+ * @{ */
+
+/** @addtogroup ADC_Decimation_Exported_Functions
+ * @{ */
+
+/**
+ * @brief Initializes a cascaded integrator-comb decimation filter.
+ * @note  The filter gain is compensated exactly for power of two decimation factors.
+ *        Order * log2(Decimation) must not exceed 16.
+ * @param cic: pointer to the CIC filter
+ * @param Order: the number of integrator and comb stages [1..4]
+ * @param Decimation: the rate change factor
+ */
+void XPD_ADC_CIC_Init(ADC_CICFilterType * cic, uint8_t Order, uint16_t Decimation)
+{
+    uint32_t i, bits = 0;
+
+    for (i = Decimation; i > 1; i >>= 1)
+    {
+        bits++;
+    }
+
+    for (i = 0; i < 4; i++)
+    {
+        cic->Integrators[i] = 0;
+        cic->Combs[i]       = 0;
+    }
+    cic->Decimation = Decimation;
+    cic->Phase      = 0;
+    cic->Order      = Order;
+    cic->Shift      = Order * bits;
+}
+
+/**
+ * @brief Filters and decimates a block of conversions with a CIC filter.
+ *        The integrators run at the input rate, the combs only at the output rate.
+ *        The block length doesn't need to be a multiple of the decimation factor.
+ * @param cic: pointer to the CIC filter
+ * @param input: pointer to the array of conversions
+ * @param output: pointer to the array of filtered outputs
+ * @param count: the number of conversions to process
+ * @return The number of outputs produced
+ */
+uint32_t XPD_ADC_CIC_Decimate(ADC_CICFilterType * cic, const uint16_t * input,
+        uint16_t * output, uint32_t count)
+{
+    uint32_t i1 = cic->Integrators[0], i2 = cic->Integrators[1];
+    uint32_t i3 = cic->Integrators[2], i4 = cic->Integrators[3];
+    uint32_t phase = cic->Phase, decimation = cic->Decimation;
+    uint32_t last = cic->Order - 1, outputs = 0;
+
+    for (; count > 0; count--)
+    {
+        /* The unused stages don't affect the output */
+        i1 += *input++;
+        i2 += i1;
+        i3 += i2;
+        i4 += i3;
+
+        if (++phase == decimation)
+        {
+            uint32_t value = (last == 0) ? i1 : (last == 1) ? i2 : (last == 2) ? i3 : i4;
+            uint32_t k;
+
+            for (k = 0; k <= last; k++)
+            {
+                uint32_t delayed = cic->Combs[k];
+                cic->Combs[k] = value;
+                value -= delayed;
+            }
+            value >>= cic->Shift;
+
+            *output++ = (value > 0xFFFF) ? 0xFFFF : value;
+            outputs++;
+            phase = 0;
+        }
+    }
+
+    cic->Integrators[0] = i1;
+    cic->Integrators[1] = i2;
+    cic->Integrators[2] = i3;
+    cic->Integrators[3] = i4;
+    cic->Phase = phase;
+
+    return outputs;
+}
+
+/**
+ * @brief Initializes a decimating FIR filter.
+ * @param fir: pointer to the FIR filter
+ * @param Coeffs: the Q15 filter coefficients in time reversed order (word aligned)
+ * @param Length: the number of filter coefficients
+ * @param Decimation: the rate change factor
+ * @param State: the sample history buffer for (Length - 1 + largest block length) samples (word aligned)
+ */
+void XPD_ADC_FIR_Init(ADC_FIRFilterType * fir, const int16_t * Coeffs,
+        uint16_t Length, uint16_t Decimation, uint16_t * State)
+{
+    uint32_t i;
+
+    fir->Coeffs     = Coeffs;
+    fir->State      = State;
+    fir->Length     = Length;
+    fir->Decimation = Decimation;
+
+    for (i = 0; i < (uint32_t)(Length - 1); i++)
+    {
+        State[i] = 0;
+    }
+}
+
+/**
+ * @brief Filters and decimates a block of conversions with a FIR filter.
+ *        Only the retained outputs are calculated, which is equivalent to the polyphase form.
+ * @note  On Cortex-M4 devices two taps are calculated with each __SMLAD instruction,
+ *        for all outputs if the decimation factor is even. The conversions therefore
+ *        may have at most 15 bits.
+ * @param fir: pointer to the FIR filter
+ * @param input: pointer to the array of conversions
+ * @param output: pointer to the array of filtered outputs
+ * @param count: the number of conversions to process, a multiple of the decimation factor
+ * @return The number of outputs produced
+ */
+uint32_t XPD_ADC_FIR_Decimate(ADC_FIRFilterType * fir, const uint16_t * input,
+        uint16_t * output, uint32_t count)
+{
+    uint16_t * state = fir->State;
+    uint32_t taps = fir->Length, outputs = count / fir->Decimation;
+    uint32_t n;
+
+    /* Append the new conversions to the history */
+    for (n = 0; n < count; n++)
+    {
+        state[taps - 1 + n] = input[n];
+    }
+
+    for (n = 0; n < outputs; n++)
+    {
+        const uint16_t * x = &state[n * fir->Decimation];
+        int32_t acc = 0;
+        uint32_t k = 0;
+
+#if (__CORTEX_M >= 0x04U)
+        if (((uint32_t)x & 2) == 0)
+        {
+            const uint32_t * xpairs = (const uint32_t *)x;
+            const uint32_t * hpairs = (const uint32_t *)fir->Coeffs;
+
+            for (; (k + 1) < taps; k += 2)
+            {
+                acc = (int32_t)__SMLAD(*xpairs++, *hpairs++, (uint32_t)acc);
+            }
+        }
+#endif
+        for (; k < taps; k++)
+        {
+            acc += (int32_t)x[k] * fir->Coeffs[k];
+        }
+        acc = (acc + ADC_Q15_ROUND) >> 15;
+
+#if (__CORTEX_M >= 0x04U)
+        output[n] = __USAT(acc, 16);
+#else
+        output[n] = (acc < 0) ? 0 : ((acc > 0xFFFF) ? 0xFFFF : acc);
+#endif
+    }
+
+    /* Keep the most recent conversions for the next block */
+    for (n = 0; n < (taps - 1); n++)
+    {
+        state[n] = state[count + n];
+    }
+
+    return outputs;
+}
+
+/** @} */
+
+/** @} */
+
 /** @} */
 
 #endif /* USE_XPD_ADC */
@@ -0,0 +1,77 @@
+/**
+  ******************************************************************************
+  * @file    xpd_comp.c
+  * @author  Benedek Kupper
+  * @version V0.1
+  * @date    2018-01-20
+  * @brief   STM32 eXtensible Peripheral Drivers COMP Module
+  *
+  *  This file is part of STM32_XPD.
+  *
+  *  STM32_XPD is free software: you can redistribute it and/or modify
+  *  it under the terms of the GNU General Public License as published by
+  *  the Free Software Foundation, either version 3 of the License, or
+  *  (at your option) any later version.
+  *
+  *  STM32_XPD is distributed in the hope that it will be useful,
+  *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with STM32_XPD.  If not, see <http://www.gnu.org/licenses/>.
+  */
+#include "xpd_comp.h"
+#include "xpd_rcc.h"
+
+#if defined(USE_XPD_COMP)
+
+/** @addtogroup COMP
+ * @{ */
+
+/** @defgroup COMP_Exported_Functions COMP Exported Functions
+ * @{ */
+
+/**
+ * @brief Initializes the comparator using the setup configuration.
+ *        The comparator is left disabled.
+ * @param COMPx: the comparator peripheral
+ * @param Config: pointer to COMP setup configuration
+ */
+void XPD_COMP_Init(COMP_TypeDef * COMPx, const COMP_InitType * Config)
+{
+    /* The comparators are clocked with the system configuration controller */
+    XPD_SYSCFG_ClockCtrl(ENABLE);
+
+    COMPx->CSR.w = 0;
+
+    COMPx->CSR.b.INSEL    = Config->InputMinus;
+    COMPx->CSR.b.OUTSEL   = Config->Output;
+    COMPx->CSR.b.POL      = Config->Polarity;
+    COMPx->CSR.b.BLANKING = Config->Blanking;
+#ifdef COMP_CSR_COMPxNONINSEL
+    COMPx->CSR.b.NONINSEL = Config->InputPlus;
+#endif
+#ifdef COMP_CSR_COMPxHYST
+    COMPx->CSR.b.HYST     = Config->Hysteresis;
+#endif
+#ifdef COMP_CSR_COMPxMODE
+    COMPx->CSR.b.MODE     = Config->PowerMode;
+#endif
+}
+
+/**
+ * @brief Restores the comparator to its default state.
+ * @note  A locked comparator can only be reset by a system reset.
+ * @param COMPx: the comparator peripheral
+ */
+void XPD_COMP_Deinit(COMP_TypeDef * COMPx)
+{
+    COMPx->CSR.w = 0;
+}
+
+/** @} */
+
+/** @} */
+
+#endif /* USE_XPD_COMP */
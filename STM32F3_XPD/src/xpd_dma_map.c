@@ -0,0 +1,88 @@
+/**
+  ******************************************************************************
+  * @file    xpd_dma_map.c
+  * @author  Benedek Kupper
+  * @version V0.1
+  * @date    2018-01-20
+  * @brief   STM32 eXtensible Peripheral Drivers DMA Request Map
+  *
+  *  This file is part of STM32_XPD.
+  *
+  *  STM32_XPD is free software: you can redistribute it and/or modify
+  *  it under the terms of the GNU General Public License as published by
+  *  the Free Software Foundation, either version 3 of the License, or
+  *  (at your option) any later version.
+  *
+  *  STM32_XPD is distributed in the hope that it will be useful,
+  *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with STM32_XPD.  If not, see <http://www.gnu.org/licenses/>.
+  */
+#include "xpd_dma.h"
+
+/** @addtogroup DMA
+ * @{ */
+
+/* Channel location of the request: DMA number, channel offset, selection */
+#define DMA_MAP(DMA, OFFSET, SELECT)   {.Channel = (DMA) * 8 + (OFFSET), .Select = (SELECT)}
+
+/** @addtogroup DMA_Exported_Variables
+ * @{ */
+
+/** @brief The channel candidates of each request (channel offset is the channel number - 1, the requests are hard-wired) */
+const DMA_RequestMapType XPD_DMA_RequestMap[DMA_REQUEST_COUNT][2] = {
+    [DMA_REQUEST_ADC1]      = { DMA_MAP(1, 0, 0) },
+#ifdef ADC2
+    [DMA_REQUEST_ADC2]      = { DMA_MAP(2, 0, 0) },
+#endif
+#ifdef ADC3
+    [DMA_REQUEST_ADC3]      = { DMA_MAP(2, 4, 0) },
+#endif
+    [DMA_REQUEST_SPI1_RX]   = { DMA_MAP(1, 1, 0) },
+    [DMA_REQUEST_SPI1_TX]   = { DMA_MAP(1, 2, 0) },
+#ifdef SPI2
+    [DMA_REQUEST_SPI2_RX]   = { DMA_MAP(1, 3, 0) },
+    [DMA_REQUEST_SPI2_TX]   = { DMA_MAP(1, 4, 0) },
+#endif
+#ifdef SPI3
+    [DMA_REQUEST_SPI3_RX]   = { DMA_MAP(2, 0, 0) },
+    [DMA_REQUEST_SPI3_TX]   = { DMA_MAP(2, 1, 0) },
+#endif
+    [DMA_REQUEST_USART1_RX] = { DMA_MAP(1, 4, 0) },
+    [DMA_REQUEST_USART1_TX] = { DMA_MAP(1, 3, 0) },
+#ifdef USART2
+    [DMA_REQUEST_USART2_RX] = { DMA_MAP(1, 5, 0) },
+    [DMA_REQUEST_USART2_TX] = { DMA_MAP(1, 6, 0) },
+#endif
+#ifdef USART3
+    [DMA_REQUEST_USART3_RX] = { DMA_MAP(1, 2, 0) },
+    [DMA_REQUEST_USART3_TX] = { DMA_MAP(1, 1, 0) },
+#endif
+#ifdef UART4
+    [DMA_REQUEST_UART4_RX]  = { DMA_MAP(2, 2, 0) },
+    [DMA_REQUEST_UART4_TX]  = { DMA_MAP(2, 4, 0) },
+#endif
+    [DMA_REQUEST_TIM1_UP]   = { DMA_MAP(1, 4, 0) },
+#ifdef TIM2
+    [DMA_REQUEST_TIM2_UP]   = { DMA_MAP(1, 1, 0) },
+#endif
+#ifdef TIM3
+    [DMA_REQUEST_TIM3_UP]   = { DMA_MAP(1, 2, 0) },
+#endif
+#ifdef TIM6
+    [DMA_REQUEST_TIM6_UP]   = { DMA_MAP(2, 2, 0) },
+#endif
+#ifdef TIM7
+    [DMA_REQUEST_TIM7_UP]   = { DMA_MAP(2, 3, 0) },
+#endif
+#ifdef TIM8
+    [DMA_REQUEST_TIM8_UP]   = { DMA_MAP(2, 0, 0) },
+#endif
+};
+
+/** @} */
+
+/** @} */
@@ -0,0 +1,144 @@
+/**
+  ******************************************************************************
+  * @file    xpd_mem.c
+  * @author  Benedek Kupper
+  * @version V0.1
+  * @date    2018-01-20
+  * @brief   STM32 eXtensible Peripheral Drivers Memory Operations Module
+  *
+  *  This file is part of STM32_XPD.
+  *
+  *  STM32_XPD is free software: you can redistribute it and/or modify
+  *  it under the terms of the GNU General Public License as published by
+  *  the Free Software Foundation, either version 3 of the License, or
+  *  (at your option) any later version.
+  *
+  *  STM32_XPD is distributed in the hope that it will be useful,
+  *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with STM32_XPD.  If not, see <http://www.gnu.org/licenses/>.
+  */
+#include "xpd_mem.h"
+
+/** @addtogroup MEM
+ * @{ */
+
+/* The data unit of the multiple load and store instructions */
+typedef struct
+{
+    uint32_t w[4];
+}mem_BlockType;
+
+#if (__CORTEX_M >= 3)
+/* A word which may be unaligned */
+typedef struct __packed
+{
+    uint32_t w;
+}mem_UnalignedType;
+#endif
+
+/* The size below which the alignment handling isn't worth it */
+#define MEM_WORD_THRESHOLD      8
+
+/** @defgroup MEM_Exported_Functions MEM Exported Functions
+ * @{ */
+
+/**
+ * @brief Copies data to a non-overlapping memory area.
+ * @param Dest: the destination address
+ * @param Src: the source address
+ * @param Size: the number of bytes to copy
+ */
+void XPD_MemCopy(void * Dest, const void * Src, uint32_t Size)
+{
+    uint8_t * dest = (uint8_t*)Dest;
+    const uint8_t * src = (const uint8_t*)Src;
+
+#if (__CORTEX_M >= 3)
+    if (Size >= MEM_WORD_THRESHOLD)
+#else
+    if ((Size >= MEM_WORD_THRESHOLD) && ((((uint32_t)dest ^ (uint32_t)src) & 3) == 0))
+#endif
+    {
+        for (; ((uint32_t)dest & 3) != 0; Size--)
+        {
+            *dest++ = *src++;
+        }
+
+        if (((uint32_t)src & 3) == 0)
+        {
+            for (; Size >= sizeof(mem_BlockType); Size -= sizeof(mem_BlockType))
+            {
+                *(mem_BlockType*)dest = *(const mem_BlockType*)src;
+                dest += sizeof(mem_BlockType);
+                src  += sizeof(mem_BlockType);
+            }
+            for (; Size >= sizeof(uint32_t); Size -= sizeof(uint32_t))
+            {
+                *(uint32_t*)dest = *(const uint32_t*)src;
+                dest += sizeof(uint32_t);
+                src  += sizeof(uint32_t);
+            }
+        }
+#if (__CORTEX_M >= 3)
+        else
+        {
+            for (; Size >= sizeof(uint32_t); Size -= sizeof(uint32_t))
+            {
+                *(uint32_t*)dest = ((const mem_UnalignedType*)src)->w;
+                dest += sizeof(uint32_t);
+                src  += sizeof(uint32_t);
+            }
+        }
+#endif
+    }
+
+    for (; Size > 0; Size--)
+    {
+        *dest++ = *src++;
+    }
+}
+
+/**
+ * @brief Fills a memory area with a byte value.
+ * @param Dest: the destination address
+ * @param Value: the fill value
+ * @param Size: the number of bytes to fill
+ */
+void XPD_MemSet(void * Dest, uint8_t Value, uint32_t Size)
+{
+    uint8_t * dest = (uint8_t*)Dest;
+
+    if (Size >= MEM_WORD_THRESHOLD)
+    {
+        uint32_t pattern = Value * 0x01010101UL;
+        mem_BlockType block = {{ pattern, pattern, pattern, pattern }};
+
+        for (; ((uint32_t)dest & 3) != 0; Size--)
+        {
+            *dest++ = Value;
+        }
+        for (; Size >= sizeof(mem_BlockType); Size -= sizeof(mem_BlockType))
+        {
+            *(mem_BlockType*)dest = block;
+            dest += sizeof(mem_BlockType);
+        }
+        for (; Size >= sizeof(uint32_t); Size -= sizeof(uint32_t))
+        {
+            *(uint32_t*)dest = pattern;
+            dest += sizeof(uint32_t);
+        }
+    }
+
+    for (; Size > 0; Size--)
+    {
+        *dest++ = Value;
+    }
+}
+
+/** @} */
+
+/** @} */
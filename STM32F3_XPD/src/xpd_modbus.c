@@ -0,0 +1,422 @@
+/**
+  ******************************************************************************
+  * @file    xpd_modbus.c
+  * @author  Benedek Kupper
+  * @version V0.1
+  * @date    2018-01-20
+  * @brief   STM32 eXtensible Peripheral Drivers Modbus RTU Module
+  *
+  *  This file is part of STM32_XPD.
+  *
+  *  STM32_XPD is free software: you can redistribute it and/or modify
+  *  it under the terms of the GNU General Public License as published by
+  *  the Free Software Foundation, either version 3 of the License, or
+  *  (at your option) any later version.
+  *
+  *  STM32_XPD is distributed in the hope that it will be useful,
+  *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with STM32_XPD.  If not, see <http://www.gnu.org/licenses/>.
+  */
+#include "xpd_modbus.h"
+
+#if defined(USE_XPD_MODBUS) && defined(USART_CR2_RTOEN) && !defined(XPD_USART_EXCLUDE_DMA)
+
+/** @addtogroup MODBUS
+ * @{ */
+
+#define MODBUS_BROADCAST_ADDRESS    0
+#define MODBUS_EXCEPTION_FLAG       0x80
+
+/* Smallest valid ADU: address, function code and CRC */
+#define MODBUS_MIN_ADU_LENGTH       4
+
+#define MODBUS_MAX_READ_COUNT       125
+#define MODBUS_MAX_WRITE_COUNT      123
+
+/* Above 19200 baud the frame end is fixed 1750 us */
+#define MODBUS_FIXED_TIMING_BAUD    19200
+#define MODBUS_FIXED_FRAME_END_US   1750
+#define MODBUS_FRAME_END_BITS       39
+
+/* CRC-16/MODBUS (reflected 0x8005 polynomial) lookup table */
+static const uint16_t modbus_crcTable[256] = {
+    0x0000, 0xC0C1, 0xC181, 0x0140, 0xC301, 0x03C0, 0x0280, 0xC241,
+    0xC601, 0x06C0, 0x0780, 0xC741, 0x0500, 0xC5C1, 0xC481, 0x0440,
+    0xCC01, 0x0CC0, 0x0D80, 0xCD41, 0x0F00, 0xCFC1, 0xCE81, 0x0E40,
+    0x0A00, 0xCAC1, 0xCB81, 0x0B40, 0xC901, 0x09C0, 0x0880, 0xC841,
+    0xD801, 0x18C0, 0x1980, 0xD941, 0x1B00, 0xDBC1, 0xDA81, 0x1A40,
+    0x1E00, 0xDEC1, 0xDF81, 0x1F40, 0xDD01, 0x1DC0, 0x1C80, 0xDC41,
+    0x1400, 0xD4C1, 0xD581, 0x1540, 0xD701, 0x17C0, 0x1680, 0xD641,
+    0xD201, 0x12C0, 0x1380, 0xD341, 0x1100, 0xD1C1, 0xD081, 0x1040,
+    0xF001, 0x30C0, 0x3180, 0xF141, 0x3300, 0xF3C1, 0xF281, 0x3240,
+    0x3600, 0xF6C1, 0xF781, 0x3740, 0xF501, 0x35C0, 0x3480, 0xF441,
+    0x3C00, 0xFCC1, 0xFD81, 0x3D40, 0xFF01, 0x3FC0, 0x3E80, 0xFE41,
+    0xFA01, 0x3AC0, 0x3B80, 0xFB41, 0x3900, 0xF9C1, 0xF881, 0x3840,
+    0x2800, 0xE8C1, 0xE981, 0x2940, 0xEB01, 0x2BC0, 0x2A80, 0xEA41,
+    0xEE01, 0x2EC0, 0x2F80, 0xEF41, 0x2D00, 0xEDC1, 0xEC81, 0x2C40,
+    0xE401, 0x24C0, 0x2580, 0xE541, 0x2700, 0xE7C1, 0xE681, 0x2640,
+    0x2200, 0xE2C1, 0xE381, 0x2340, 0xE101, 0x21C0, 0x2080, 0xE041,
+    0xA001, 0x60C0, 0x6180, 0xA141, 0x6300, 0xA3C1, 0xA281, 0x6240,
+    0x6600, 0xA6C1, 0xA781, 0x6740, 0xA501, 0x65C0, 0x6480, 0xA441,
+    0x6C00, 0xACC1, 0xAD81, 0x6D40, 0xAF01, 0x6FC0, 0x6E80, 0xAE41,
+    0xAA01, 0x6AC0, 0x6B80, 0xAB41, 0x6900, 0xA9C1, 0xA881, 0x6840,
+    0x7800, 0xB8C1, 0xB981, 0x7940, 0xBB01, 0x7BC0, 0x7A80, 0xBA41,
+    0xBE01, 0x7EC0, 0x7F80, 0xBF41, 0x7D00, 0xBDC1, 0xBC81, 0x7C40,
+    0xB401, 0x74C0, 0x7580, 0xB541, 0x7700, 0xB7C1, 0xB681, 0x7640,
+    0x7200, 0xB2C1, 0xB381, 0x7340, 0xB101, 0x71C0, 0x7080, 0xB041,
+    0x5000, 0x90C1, 0x9181, 0x5140, 0x9301, 0x53C0, 0x5280, 0x9241,
+    0x9601, 0x56C0, 0x5780, 0x9741, 0x5500, 0x95C1, 0x9481, 0x5440,
+    0x9C01, 0x5CC0, 0x5D80, 0x9D41, 0x5F00, 0x9FC1, 0x9E81, 0x5E40,
+    0x5A00, 0x9AC1, 0x9B81, 0x5B40, 0x9901, 0x59C0, 0x5880, 0x9841,
+    0x8801, 0x48C0, 0x4980, 0x8941, 0x4B00, 0x8BC1, 0x8A81, 0x4A40,
+    0x4E00, 0x8EC1, 0x8F81, 0x4F40, 0x8D01, 0x4DC0, 0x4C80, 0x8C41,
+    0x4400, 0x84C1, 0x8581, 0x4540, 0x8701, 0x47C0, 0x4680, 0x8641,
+    0x8201, 0x42C0, 0x4380, 0x8341, 0x4100, 0x81C1, 0x8081, 0x4040
+};
+
+#define MODBUS_GET16(DATA)          (((uint16_t)(DATA)[0] << 8) | (DATA)[1])
+
+/* Finds the register block which contains the whole addressed range */
+static const MODBUS_RegisterBlockType * modbus_findBlock(const MODBUS_RegisterBlockType * Blocks,
+        uint8_t BlockCount, uint16_t Address, uint16_t Count)
+{
+    uint32_t i;
+
+    for (i = 0; i < BlockCount; i++)
+    {
+        if ((Address >= Blocks[i].Address) &&
+            (((uint32_t)Address + Count) <= ((uint32_t)Blocks[i].Address + Blocks[i].Count)))
+        {
+            return &Blocks[i];
+        }
+    }
+    return NULL;
+}
+
+/* Determines the frame end idle time in bit durations */
+static uint32_t modbus_getFrameTimeout(MODBUS_HandleType * hmb)
+{
+    uint32_t timeout = hmb->FrameTimeout;
+
+    if (timeout == 0)
+    {
+        timeout = MODBUS_FRAME_END_BITS;
+        if (hmb->Serial.BaudRate > MODBUS_FIXED_TIMING_BAUD)
+        {
+            timeout = (hmb->Serial.BaudRate * MODBUS_FIXED_FRAME_END_US) / 1000000;
+        }
+    }
+    return timeout;
+}
+
+/* Starts the reception of the next frame */
+static XPD_ReturnType modbus_receive(MODBUS_HandleType * hmb)
+{
+    const USART_Frame_InitType frame = {
+        .RxTimeout = modbus_getFrameTimeout(hmb),
+        .CharMatch = DISABLE,
+    };
+
+    return XPD_USART_Frame_Start(&hmb->Serial, &frame, hmb->Buffer, sizeof(hmb->Buffer));
+}
+
+/* Transmits the response ADU from the segments, the CRC is appended */
+static void modbus_respond(MODBUS_HandleType * hmb, uint16_t HeaderLength,
+        uint8_t * Data, uint16_t DataLength)
+{
+    uint16_t crc;
+
+    /* the broadcast requests are executed without response */
+    if (hmb->Buffer[0] == MODBUS_BROADCAST_ADDRESS)
+    {
+        return;
+    }
+
+    crc = XPD_Modbus_CRC16(MODBUS_CRC_INIT, hmb->Buffer, HeaderLength);
+    crc = XPD_Modbus_CRC16(crc, Data, DataLength);
+    hmb->Crc[0] = crc;
+    hmb->Crc[1] = crc >> 8;
+
+    hmb->Responding = XPD_USART_TxQueue_Put(&hmb->Serial, hmb->Buffer, HeaderLength) == XPD_OK;
+    if (DataLength > 0)
+    {
+        (void) XPD_USART_TxQueue_Put(&hmb->Serial, Data, DataLength);
+    }
+    (void) XPD_USART_TxQueue_Put(&hmb->Serial, hmb->Crc, sizeof(hmb->Crc));
+}
+
+/* Processes the request PDU, and builds the response in the buffer
+ * returns the exception code, or 0 if the response is queued */
+static uint8_t modbus_process(MODBUS_HandleType * hmb, uint16_t Length)
+{
+    uint8_t * pdu = &hmb->Buffer[1];
+    const MODBUS_RegisterBlockType * block;
+    uint16_t address, count;
+
+    if (Length < 5)
+    {
+        return MODBUS_EXCEPTION_ILLEGAL_DATA_VALUE;
+    }
+    address = MODBUS_GET16(&pdu[1]);
+    count   = MODBUS_GET16(&pdu[3]);
+
+    switch (pdu[0])
+    {
+        case MODBUS_READ_HOLDING_REGISTERS:
+        case MODBUS_READ_INPUT_REGISTERS:
+            if ((Length != 5) || (count == 0) || (count > MODBUS_MAX_READ_COUNT))
+            {
+                return MODBUS_EXCEPTION_ILLEGAL_DATA_VALUE;
+            }
+            if (pdu[0] == MODBUS_READ_HOLDING_REGISTERS)
+            {
+                block = modbus_findBlock(hmb->Holding, hmb->HoldingCount, address, count);
+            }
+            else
+            {
+                block = modbus_findBlock(hmb->Input, hmb->InputCount, address, count);
+            }
+            if (block == NULL)
+            {
+                return MODBUS_EXCEPTION_ILLEGAL_DATA_ADDRESS;
+            }
+
+            /* The register values are transmitted directly from the map */
+            pdu[1] = count * 2;
+            modbus_respond(hmb, 3, &block->Data[(address - block->Address) * 2], count * 2);
+            break;
+
+        case MODBUS_WRITE_SINGLE_REGISTER:
+            if (Length != 5)
+            {
+                return MODBUS_EXCEPTION_ILLEGAL_DATA_VALUE;
+            }
+            block = modbus_findBlock(hmb->Holding, hmb->HoldingCount, address, 1);
+            if ((block == NULL) || (block->Writable == 0))
+            {
+                return MODBUS_EXCEPTION_ILLEGAL_DATA_ADDRESS;
+            }
+            /* the register value is in place of the quantity */
+            XPD_Modbus_SetRegister(block, address - block->Address, count);
+
+            hmb->WriteAddress = address;
+            hmb->WriteCount   = 1;
+            XPD_SAFE_CALLBACK(hmb->Callbacks.Write, hmb);
+
+            /* The response is the echo of the request */
+            modbus_respond(hmb, 6, NULL, 0);
+            break;
+
+        case MODBUS_WRITE_MULTIPLE_REGISTERS:
+            if ((count == 0) || (count > MODBUS_MAX_WRITE_COUNT) ||
+                (Length < 6) || (pdu[5] != (count * 2)) || (Length != (6 + count * 2)))
+            {
+                return MODBUS_EXCEPTION_ILLEGAL_DATA_VALUE;
+            }
+            block = modbus_findBlock(hmb->Holding, hmb->HoldingCount, address, count);
+            if ((block == NULL) || (block->Writable == 0))
+            {
+                return MODBUS_EXCEPTION_ILLEGAL_DATA_ADDRESS;
+            }
+            {
+                uint8_t * dest = &block->Data[(address - block->Address) * 2];
+                uint32_t i;
+
+                for (i = 0; i < (count * 2U); i++)
+                {
+                    dest[i] = pdu[6 + i];
+                }
+            }
+
+            hmb->WriteAddress = address;
+            hmb->WriteCount   = count;
+            XPD_SAFE_CALLBACK(hmb->Callbacks.Write, hmb);
+
+            /* The response contains the address and quantity */
+            modbus_respond(hmb, 6, NULL, 0);
+            break;
+
+        default:
+            return MODBUS_EXCEPTION_ILLEGAL_FUNCTION;
+    }
+    return 0;
+}
+
+/* Frame end callback of the USART */
+static void modbus_receiveRedirect(void * husart)
+{
+    MODBUS_HandleType * hmb = (MODBUS_HandleType*) husart;
+    uint16_t length = hmb->Serial.RxFrameLength;
+
+    hmb->Length = 0;
+
+    if ((length < MODBUS_MIN_ADU_LENGTH) ||
+        (XPD_Modbus_CRC16(MODBUS_CRC_INIT, hmb->Buffer, length) != 0))
+    {
+        /* invalid frames are dropped silently */
+        hmb->Errors++;
+
+        if (hmb->Master != 0)
+        {
+            XPD_SAFE_CALLBACK(hmb->Callbacks.Response, hmb);
+        }
+    }
+    else if (hmb->Master != 0)
+    {
+        /* response from the addressed slave */
+        if (hmb->Buffer[0] == hmb->Slave)
+        {
+            hmb->Length = length - 3;
+        }
+        XPD_SAFE_CALLBACK(hmb->Callbacks.Response, hmb);
+    }
+    else if ((hmb->Buffer[0] == hmb->Address) || (hmb->Buffer[0] == MODBUS_BROADCAST_ADDRESS))
+    {
+        uint8_t exception;
+
+        hmb->Responding = 0;
+        exception = modbus_process(hmb, length - 3);
+
+        if (exception != 0)
+        {
+            hmb->Buffer[1] |= MODBUS_EXCEPTION_FLAG;
+            hmb->Buffer[2]  = exception;
+            modbus_respond(hmb, 3, NULL, 0);
+        }
+    }
+
+    /* the next request is received after the response is transmitted */
+    if ((hmb->Master == 0) && (hmb->Responding == 0))
+    {
+        (void) modbus_receive(hmb);
+    }
+}
+
+/* Transmit queue emptied callback of the USART */
+static void modbus_transmitRedirect(void * husart)
+{
+    MODBUS_HandleType * hmb = (MODBUS_HandleType*) husart;
+
+    hmb->Responding = 0;
+
+    if ((hmb->Master != 0) && (hmb->Slave == MODBUS_BROADCAST_ADDRESS))
+    {
+        /* no response is given to broadcast requests */
+        hmb->Length = 0;
+        XPD_SAFE_CALLBACK(hmb->Callbacks.Response, hmb);
+    }
+    else
+    {
+        (void) modbus_receive(hmb);
+    }
+}
+
+/** @defgroup MODBUS_Exported_Functions MODBUS Exported Functions
+ * @{ */
+
+/**
+ * @brief Calculates the Modbus CRC-16 of the data. The CRC over a whole frame
+ *        (including its transmitted CRC) is 0 if the frame is valid.
+ * @param Crc: the initial value, @ref MODBUS_CRC_INIT or the result of the previous data block
+ * @param Data: pointer to the data
+ * @param Length: the number of data bytes
+ * @return The calculated CRC, which is transmitted in little-endian byte order
+ */
+uint16_t XPD_Modbus_CRC16(uint16_t Crc, const uint8_t * Data, uint16_t Length)
+{
+    while (Length-- > 0)
+    {
+        Crc = (Crc >> 8) ^ modbus_crcTable[(Crc ^ *Data++) & 0xFF];
+    }
+    return Crc;
+}
+
+/**
+ * @brief Starts the Modbus RTU slave operation. The requests are processed
+ *        in the USART receiver timeout interrupt at the frame end, and the responses
+ *        are transmitted by DMA, the read register values directly from the register map.
+ * @note  The standard 3.5 character frame end (1.75 ms above 19200 baud) limits
+ *        the response latency, which can be reduced with a shorter FrameTimeout,
+ *        e.g. 39 bit durations are 0.34 ms at 115200 baud.
+ *        The read registers shouldn't be modified while the response is transmitted.
+ * @param hmb: pointer to the Modbus handle structure
+ * @return BUSY if the USART DMA is in use, OK if the slave is started
+ */
+XPD_ReturnType XPD_Modbus_Slave_Start(MODBUS_HandleType * hmb)
+{
+    hmb->Master     = 0;
+    hmb->Responding = 0;
+    hmb->Serial.Callbacks.Receive  = modbus_receiveRedirect;
+    hmb->Serial.Callbacks.Transmit = modbus_transmitRedirect;
+
+    return modbus_receive(hmb);
+}
+
+/**
+ * @brief Transmits a Modbus RTU master request, and receives the response of the slave.
+ *        The Response callback is called at the response frame end, with the PDU length
+ *        of a valid response in the Length field, or 0 if the response is invalid.
+ *        The broadcast request completion is signalled by the callback with 0 Length.
+ * @note  The receiver timeout is only counted after the first response character,
+ *        the missing response has to be detected by the application using @ref XPD_Modbus_Stop.
+ * @param hmb: pointer to the Modbus handle structure
+ * @param Slave: the address of the slave, 0 for broadcast
+ * @param Pdu: pointer to the request PDU, starting with the function code
+ * @param Length: the length of the request PDU [1 .. 253]
+ * @return ERROR if the PDU length is invalid, BUSY if a transfer is ongoing,
+ *         OK if the request is started
+ */
+XPD_ReturnType XPD_Modbus_Master_Request(MODBUS_HandleType * hmb, uint8_t Slave,
+        const uint8_t * Pdu, uint8_t Length)
+{
+    uint16_t crc;
+    uint32_t i;
+
+    if ((Length == 0) || (Length > (sizeof(hmb->Buffer) - 3)))
+    {
+        return XPD_ERROR;
+    }
+    if ((hmb->Serial.TxQueue.Pending != 0) || (USART_REG_BIT(&hmb->Serial, CR3, DMAR) != 0))
+    {
+        return XPD_BUSY;
+    }
+
+    hmb->Master = 1;
+    hmb->Slave  = Slave;
+    hmb->Length = 0;
+    hmb->Serial.Callbacks.Receive  = modbus_receiveRedirect;
+    hmb->Serial.Callbacks.Transmit = modbus_transmitRedirect;
+
+    hmb->Buffer[0] = Slave;
+    for (i = 0; i < Length; i++)
+    {
+        hmb->Buffer[1 + i] = Pdu[i];
+    }
+    crc = XPD_Modbus_CRC16(MODBUS_CRC_INIT, hmb->Buffer, Length + 1);
+    hmb->Buffer[Length + 1] = crc;
+    hmb->Buffer[Length + 2] = crc >> 8;
+
+    return XPD_USART_TxQueue_Put(&hmb->Serial, hmb->Buffer, Length + 3);
+}
+
+/**
+ * @brief Stops the Modbus operation, cancelling the ongoing transfers.
+ * @param hmb: pointer to the Modbus handle structure
+ */
+void XPD_Modbus_Stop(MODBUS_HandleType * hmb)
+{
+    hmb->Serial.Callbacks.Receive  = NULL;
+    hmb->Serial.Callbacks.Transmit = NULL;
+
+    XPD_USART_Stop_DMA(&hmb->Serial);
+}
+
+/** @} */
+
+/** @} */
+
+#endif /* USE_XPD_MODBUS */
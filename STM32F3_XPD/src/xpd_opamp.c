@@ -0,0 +1,151 @@
+/**
+  ******************************************************************************
+  * @file    xpd_opamp.c
+  * @author  Benedek Kupper
+  * @version V0.1
+  * @date    2018-01-20
+  * @brief   STM32 eXtensible Peripheral Drivers OPAMP Module
+  *
+  *  This file is part of STM32_XPD.
+  *
+  *  STM32_XPD is free software: you can redistribute it and/or modify
+  *  it under the terms of the GNU General Public License as published by
+  *  the Free Software Foundation, either version 3 of the License, or
+  *  (at your option) any later version.
+  *
+  *  STM32_XPD is distributed in the hope that it will be useful,
+  *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with STM32_XPD.  If not, see <http://www.gnu.org/licenses/>.
+  */
+#include "xpd_opamp.h"
+#include "xpd_rcc.h"
+#include "xpd_utils.h"
+
+#if defined(USE_XPD_OPAMP)
+
+/** @addtogroup OPAMP
+ * @{ */
+
+/* Settling time of the output after a trimming value change */
+#define OPAMP_TRIMMING_DELAY_MS     1
+
+/* Calibration reference voltage selections */
+#define OPAMP_CALSEL_10_PERCENT     1
+#define OPAMP_CALSEL_90_PERCENT     3
+
+/* Successive approximation of a trimming value, OUTCAL is high while the value is too low */
+static uint8_t opamp_trim(OPAMP_TypeDef * OPAMPx, uint8_t CalSel)
+{
+    uint8_t value = 16, delta = 8;
+
+    OPAMPx->CSR.b.CALSEL = CalSel;
+
+    for (; delta > 0; delta >>= 1)
+    {
+        if (CalSel == OPAMP_CALSEL_90_PERCENT)
+        {   OPAMPx->CSR.b.TRIMOFFSETN = value; }
+        else
+        {   OPAMPx->CSR.b.TRIMOFFSETP = value; }
+
+        XPD_Delay_ms(OPAMP_TRIMMING_DELAY_MS);
+
+        if (OPAMPx->CSR.b.OUTCAL != 0)
+        {
+            value += delta;
+        }
+        else
+        {
+            value -= delta;
+        }
+    }
+
+    /* The approximation ends one step below the transition point */
+    if (CalSel == OPAMP_CALSEL_90_PERCENT)
+    {   OPAMPx->CSR.b.TRIMOFFSETN = value; }
+    else
+    {   OPAMPx->CSR.b.TRIMOFFSETP = value; }
+
+    XPD_Delay_ms(OPAMP_TRIMMING_DELAY_MS);
+
+    if (OPAMPx->CSR.b.OUTCAL != 0)
+    {
+        value++;
+    }
+    return value;
+}
+
+/** @defgroup OPAMP_Exported_Functions OPAMP Exported Functions
+ * @{ */
+
+/**
+ * @brief Initializes the operational amplifier using the setup configuration.
+ *        The amplifier is left disabled, with the factory trimming.
+ * @param OPAMPx: the operational amplifier peripheral
+ * @param Config: pointer to OPAMP setup configuration
+ */
+void XPD_OPAMP_Init(OPAMP_TypeDef * OPAMPx, const OPAMP_InitType * Config)
+{
+    /* The amplifiers are clocked with the system configuration controller */
+    XPD_SYSCFG_ClockCtrl(ENABLE);
+
+    OPAMPx->CSR.w = 0;
+
+    OPAMPx->CSR.b.VMSEL  = Config->Mode;
+    OPAMPx->CSR.b.VPSEL  = Config->InputPlus;
+    OPAMPx->CSR.b.PGGAIN = (Config->Connect << 2) | Config->Gain;
+}
+
+/**
+ * @brief Restores the operational amplifier to its default state.
+ * @note  A locked amplifier can only be reset by a system reset.
+ * @param OPAMPx: the operational amplifier peripheral
+ */
+void XPD_OPAMP_Deinit(OPAMP_TypeDef * OPAMPx)
+{
+    OPAMPx->CSR.w = 0;
+}
+
+/**
+ * @brief Measures and applies the input offset trimming values of the operational amplifier
+ *        at the actual supply voltage and temperature.
+ * @note  The amplifier is disconnected from its inputs during the calibration,
+ *        which takes about 10 ms. The amplifier is left disabled.
+ * @param OPAMPx: the operational amplifier peripheral
+ * @param Trim: pointer to the trimming values to store the result, for later @ref XPD_OPAMP_SetTrim
+ */
+void XPD_OPAMP_SelfCalibrate(OPAMP_TypeDef * OPAMPx, OPAMP_TrimType * Trim)
+{
+    OPAMPx->CSR.b.USERTRIM = 1;
+    OPAMPx->CSR.b.CALON    = 1;
+    OPAMPx->CSR.b.EN       = 1;
+
+    /* NMOS pair is calibrated close to the high rail, PMOS pair close to ground */
+    Trim->N = opamp_trim(OPAMPx, OPAMP_CALSEL_90_PERCENT);
+    Trim->P = opamp_trim(OPAMPx, OPAMP_CALSEL_10_PERCENT);
+
+    OPAMPx->CSR.b.EN       = 0;
+    OPAMPx->CSR.b.CALON    = 0;
+    OPAMPx->CSR.b.CALSEL   = 0;
+}
+
+/**
+ * @brief Applies previously measured input offset trimming values to the operational amplifier.
+ * @param OPAMPx: the operational amplifier peripheral
+ * @param Trim: pointer to the trimming values
+ */
+void XPD_OPAMP_SetTrim(OPAMP_TypeDef * OPAMPx, const OPAMP_TrimType * Trim)
+{
+    OPAMPx->CSR.b.TRIMOFFSETN = Trim->N;
+    OPAMPx->CSR.b.TRIMOFFSETP = Trim->P;
+    OPAMPx->CSR.b.USERTRIM    = 1;
+}
+
+/** @} */
+
+/** @} */
+
+#endif /* USE_XPD_OPAMP */
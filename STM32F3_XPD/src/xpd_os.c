@@ -0,0 +1,79 @@
+/**
+  ******************************************************************************
+  * @file    xpd_os.c
+  * @author  Benedek Kupper
+  * @version V0.1
+  * @date    2018-01-20
+  * @brief   STM32 eXtensible Peripheral Drivers Operating System Abstraction Module
+  *
+  *  This file is part of STM32_XPD.
+  *
+  *  STM32_XPD is free software: you can redistribute it and/or modify
+  *  it under the terms of the GNU General Public License as published by
+  *  the Free Software Foundation, either version 3 of the License, or
+  *  (at your option) any later version.
+  *
+  *  STM32_XPD is distributed in the hope that it will be useful,
+  *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with STM32_XPD.  If not, see <http://www.gnu.org/licenses/>.
+  */
+#include "xpd_os.h"
+#include "xpd_utils.h"
+
+#ifdef USE_XPD_OS
+
+/** @addtogroup XPD_OS
+ * @{ */
+
+/** @defgroup XPD_OS_Exported_Functions XPD OS Exported Functions
+ * @{ */
+
+/** @addtogroup XPD_OS_Exported_Functions_Signal
+ * @{ */
+
+/**
+ * @brief Prepares the signal for waiting, called by the waiting task before the transfer is started. [overrideable]
+ * @param Signal: pointer to the signal structure
+ */
+__weak void XPD_OS_SignalInit(XPD_OS_SignalType * Signal)
+{
+    Signal->Posted = 0;
+}
+
+/**
+ * @brief Posts the signal, called from the transfer completion (interrupt) context. [overrideable]
+ * @param Signal: pointer to the signal structure
+ */
+__weak void XPD_OS_SignalPost(XPD_OS_SignalType * Signal)
+{
+    Signal->Posted = 1;
+}
+
+/**
+ * @brief Blocks the calling task until the signal is posted, or until times out. [overrideable]
+ * @param Signal: pointer to the signal structure
+ * @param Timeout: pointer to the timeout in ms, updated with the remaining time
+ * @return TIMEOUT if timed out, or OK if the signal was posted within the deadline
+ */
+__weak XPD_ReturnType XPD_OS_SignalWait(XPD_OS_SignalType * Signal, uint32_t * Timeout)
+{
+    XPD_ReturnType result = XPD_WaitForDiff(&Signal->Posted, 1, 0, Timeout);
+
+    if (result == XPD_OK)
+    {
+        Signal->Posted = 0;
+    }
+    return result;
+}
+
+/** @} */
+
+/** @} */
+
+/** @} */
+
+#endif /* USE_XPD_OS */
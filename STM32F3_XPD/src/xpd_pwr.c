@@ -22,6 +22,7 @@
   *  along with STM32_XPD.  If not, see <http://www.gnu.org/licenses/>.
   */
 #include "xpd_pwr.h"
+#include "xpd_utils.h"
 
 /** @addtogroup PWR
  * @{ */
@@ -45,6 +46,8 @@ void XPD_PWR_SleepMode(ReactionType WakeUpOn)
     /* Clear SLEEPDEEP bit of Cortex System Control Register */
     SCB->SCR.b.SLEEPDEEP = 0;
 
+    XPD_ENERGY_STATE(XPD_ENERGY_SLEEP);
+
     if (WakeUpOn == REACTION_IT)
     {
         /* Request Wait For Interrupt */
@@ -57,6 +60,8 @@ void XPD_PWR_SleepMode(ReactionType WakeUpOn)
         __WFE();
         __WFE();
     }
+
+    XPD_ENERGY_STATE(XPD_ENERGY_RUN);
 }
 
 /**
@@ -85,6 +90,8 @@ void XPD_PWR_StopMode(ReactionType WakeUpOn, PWR_RegulatorType Regulator)
     /* Set SLEEPDEEP bit of Cortex System Control Register */
     SCB->SCR.b.SLEEPDEEP = 1;
 
+    XPD_ENERGY_STATE(XPD_ENERGY_STOP);
+
     /* Select STOP mode entry */
     if (WakeUpOn == REACTION_IT)
     {
@@ -101,6 +108,8 @@ void XPD_PWR_StopMode(ReactionType WakeUpOn, PWR_RegulatorType Regulator)
 
     /* Reset SLEEPDEEP bit of Cortex System Control Register */
     SCB->SCR.b.SLEEPDEEP = 0;
+
+    XPD_ENERGY_STATE(XPD_ENERGY_RUN);
 }
 
 /**
@@ -59,6 +59,39 @@ static uint32_t rcc_convertClockDivider(RCC_ClockType clockType, ClockDividerTyp
     }
 }
 
+/* cached core clock frequencies, updated by the clock configuration functions */
+static struct {
+    uint32_t SYSCLK;
+    uint32_t PCLK1;
+    uint32_t PCLK2;
+    uint32_t PLL;       /* 0 when it has to be recalculated */
+}rcc_clockTree = { HSI_VALUE, HSI_VALUE, HSI_VALUE, 0 };
+
+static RCC_ClockListenerType * rcc_clockListeners = NULL;
+static boolean_t rcc_clockTransition = FALSE;
+
+/* the operating point which is applied once its oscillators are ready */
+static RCC_OperatingPointType rcc_pendingOperatingPoint;
+static boolean_t rcc_operatingPointPending = FALSE;
+static boolean_t rcc_operatingPointReady   = FALSE;
+
+static void rcc_operatingPointProceed(void);
+
+/* notifies the registered listeners about the changed clock frequencies */
+static void rcc_clockChanged(void)
+{
+    RCC_ClockListenerType * listener;
+
+    /* the listeners are only notified at the end of an operating point transition */
+    if (rcc_clockTransition == FALSE)
+    {
+        for (listener = rcc_clockListeners; listener != NULL; listener = listener->Next)
+        {
+            XPD_SAFE_CALLBACK(listener->Callback, listener->Handle);
+        }
+    }
+}
+
 /** @defgroup RCC_Core_Clocks_Exported_Functions RCC Core Exported Functions
  * @{ */
 
@@ -153,6 +186,29 @@ XPD_ReturnType XPD_RCC_HSEConfig(RCC_OscStateType NewState)
 }
 #endif
 
+/* configures the PLL source and factors, the PLL has to be disabled */
+static XPD_ReturnType rcc_pllSetup(const RCC_PLL_InitType * Config)
+{
+#if defined(RCC_CFGR_PLLSRC_HSI_PREDIV)
+    RCC->CFGR2.b.PREDIV = Config->Predivider - 1;
+
+    {
+        RCC->CFGR.b.PLLSRC = Config->Source + 1;
+    }
+#else
+    /* HSI can only be predivided by fixed 2, otherwise throw error */
+    if ((Config->Source == HSI) && (Config->Predivider != 2))
+    {
+        return XPD_ERROR;
+    }
+
+    RCC_REG_BIT(CFGR,PLLSRC) = Config->Source;
+#endif
+    RCC->CFGR.b.PLLMUL = Config->Multiplier - 2;
+
+    return XPD_OK;
+}
+
 /**
  * Configures the phase locked loop.
  * @param Config: pointer to the configuration parameters
@@ -176,30 +232,21 @@ XPD_ReturnType XPD_RCC_PLLConfig(const RCC_PLL_InitType * Config)
         if ((result == XPD_OK) && (Config->State != OSC_OFF))
         {
             /* Configure the main PLL clock source and multiplication factor. */
-#if defined(RCC_CFGR_PLLSRC_HSI_PREDIV)
-            RCC->CFGR2.b.PREDIV = Config->Predivider - 1;
+            result = rcc_pllSetup(Config);
 
+            if (result == XPD_OK)
             {
-                RCC->CFGR.b.PLLSRC = Config->Source + 1;
-            }
-#else
-            /* HSI can only be predivided by fixed 2, otherwise throw error */
-            if ((Config->Source == HSI) && (Config->Predivider != 2))
-            {
-                return XPD_ERROR;
-            }
-
-            RCC_REG_BIT(CFGR,PLLSRC) = Config->Source;
-#endif
-            RCC->CFGR.b.PLLMUL = Config->Multiplier - 2;
+                /* Enable the main PLL. */
+                RCC_REG_BIT(CR,PLLON) = OSC_ON;
 
-            /* Enable the main PLL. */
-            RCC_REG_BIT(CR,PLLON) = OSC_ON;
-
-            /* Wait until PLL is ready */
-            result = XPD_WaitForMatch(&RCC->CR.w, RCC_CR_PLLRDY, RCC_CR_PLLRDY, &timeout);
+                /* Wait until PLL is ready */
+                result = XPD_WaitForMatch(&RCC->CR.w, RCC_CR_PLLRDY, RCC_CR_PLLRDY, &timeout);
+            }
         }
     }
+    /* the PLL output frequency is recalculated on demand */
+    rcc_clockTree.PLL = 0;
+
     return result;
 }
 
@@ -321,6 +368,12 @@ uint32_t XPD_RCC_GetOscFreq(RCC_OscType Oscillator)
         {
             uint32_t freq = HSI_VALUE, pllsrc = RCC->CFGR.b.PLLSRC;
 
+            /* the PLL output is only calculated after reconfiguration */
+            if (rcc_clockTree.PLL != 0)
+            {
+                return rcc_clockTree.PLL;
+            }
+
             switch (RCC->CFGR.b.PLLSRC)
             {
 #ifdef RCC_CFGR_PLLSRC_HSI_PREDIV
@@ -342,13 +395,15 @@ uint32_t XPD_RCC_GetOscFreq(RCC_OscType Oscillator)
 
             if (pllsrc > 0)
             {
-                return (freq * (RCC->CFGR.b.PLLMUL + 2)) / (RCC->CFGR2.b.PREDIV + 1);
+                freq = (freq * (RCC->CFGR.b.PLLMUL + 2)) / (RCC->CFGR2.b.PREDIV + 1);
             }
             else
             {
                 /* HSI/2 is PLL input */
-                return (freq * (RCC->CFGR.b.PLLMUL + 2)) / 2;
+                freq = (freq * (RCC->CFGR.b.PLLMUL + 2)) / 2;
             }
+            rcc_clockTree.PLL = freq;
+            return freq;
         }
 
         case LSI:
@@ -380,6 +435,8 @@ RCC_OscType XPD_RCC_GetReadyOsc(void)
  */
 void XPD_RCC_IRQHandler(void)
 {
+    XPD_PROFILE_BEGIN();
+
     uint32_t cir = RCC->CIR.w;
 
 #ifdef LSE_VALUE
@@ -410,6 +467,12 @@ void XPD_RCC_IRQHandler(void)
         /* Clear RCC PLLRDY pending bit */
         XPD_RCC_ClearFlag(PLLRDY);
 
+        /* Continue the pending operating point switch */
+        if (rcc_operatingPointPending != FALSE)
+        {
+            rcc_operatingPointProceed();
+        }
+
         /* PLL Ready callback */
         rcc_readyOscillator = PLL;
         XPD_SAFE_CALLBACK(XPD_RCC_Callbacks.OscReady,);
@@ -421,6 +484,12 @@ void XPD_RCC_IRQHandler(void)
         /* Clear RCC HSERDY pending bit */
         XPD_RCC_ClearFlag(HSERDY);
 
+        /* Continue the pending operating point switch */
+        if (rcc_operatingPointPending != FALSE)
+        {
+            rcc_operatingPointProceed();
+        }
+
         /* HSE Ready callback */
         rcc_readyOscillator = HSE;
         XPD_SAFE_CALLBACK(XPD_RCC_Callbacks.OscReady,);
@@ -436,6 +505,8 @@ void XPD_RCC_IRQHandler(void)
         rcc_readyOscillator = HSI;
         XPD_SAFE_CALLBACK(XPD_RCC_Callbacks.OscReady,);
     }
+
+    XPD_PROFILE_END();
 }
 
 /** @} */
@@ -448,6 +519,14 @@ void XPD_RCC_IRQHandler(void)
 static const uint8_t AHBPrescTable[16] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 2, 3, 4, 6, 7, 8, 9};
 #define APBPrescTable (&AHBPrescTable[4])
 
+/* recalculates the cached frequencies of the core clocks */
+static void rcc_clockTreeUpdate(void)
+{
+    rcc_clockTree.SYSCLK = XPD_RCC_GetOscFreq(XPD_RCC_GetSYSCLKSource());
+    rcc_clockTree.PCLK1  = SystemCoreClock >> APBPrescTable[RCC->CFGR.b.PPRE1];
+    rcc_clockTree.PCLK2  = SystemCoreClock >> APBPrescTable[RCC->CFGR.b.PPRE2];
+}
+
 /**
  * @brief Sets the new configuration for the AHB system clocks and the new matching flash latency.
  * @param SYSCLK_Source: @ref RCC_ClockType::SYSCLK input source selection. Permitted values:
@@ -455,7 +534,8 @@ static const uint8_t AHBPrescTable[16] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 2, 3, 4, 6,
              @arg @ref RCC_OscType::HSE
              @arg @ref RCC_OscType::PLL
  * @param HCLK_Divider: Clock divider of @ref RCC_ClockType::HCLK clock. Must not be CLK_DIV32.
- * @param FlashLatency: the desired amount of flash wait states
+ * @param FlashLatency: the desired amount of flash wait states,
+ *        or @ref FLASH_LATENCY_AUTO to select the minimal wait states for the new HCLK frequency
  * @return Result of the operation
  * @note To correctly read data from FLASH memory, the number of wait states must be
  * correctly programmed according to the frequency of the CPU clock (HCLK) of the device.
@@ -499,6 +579,14 @@ XPD_ReturnType XPD_RCC_HCLKConfig(RCC_OscType SYSCLK_Source, ClockDividerType HC
             return XPD_ERROR;
     }
 
+    clkDiv = rcc_convertClockDivider(HCLK, HCLK_Divider);
+
+    /* Select the minimal wait states for the new HCLK frequency */
+    if (FlashLatency == FLASH_LATENCY_AUTO)
+    {
+        FlashLatency = XPD_FLASH_GetMinLatency(XPD_RCC_GetOscFreq(SYSCLK_Source) >> AHBPrescTable[clkDiv]);
+    }
+
     /* Increasing the CPU frequency */
     if (FlashLatency > XPD_FLASH_GetLatency())
     {
@@ -514,7 +602,6 @@ XPD_ReturnType XPD_RCC_HCLKConfig(RCC_OscType SYSCLK_Source, ClockDividerType HC
     }
 
     /* Set SYSCLK source and HCLK prescaler */
-    clkDiv = rcc_convertClockDivider(HCLK, HCLK_Divider);
     RCC->CFGR.b.HPRE = clkDiv;
     RCC->CFGR.b.SW   = SYSCLK_Source;
 
@@ -537,10 +624,13 @@ XPD_ReturnType XPD_RCC_HCLKConfig(RCC_OscType SYSCLK_Source, ClockDividerType HC
 
     /* Update SystemCoreClock variable */
     SystemCoreClock = XPD_RCC_GetOscFreq(SYSCLK_Source) >> AHBPrescTable[clkDiv];
+    rcc_clockTreeUpdate();
 
     /* Configure the source of time base considering new system clocks settings*/
     XPD_InitTimer();
 
+    rcc_clockChanged();
+
     return result;
 }
 
@@ -574,6 +664,10 @@ void XPD_RCC_PCLKConfig(RCC_ClockType PCLKx, ClockDividerType PCLK_Divider)
         default:
             break;
     }
+
+    rcc_clockTreeUpdate();
+
+    rcc_clockChanged();
 }
 
 /**
@@ -589,13 +683,13 @@ uint32_t XPD_RCC_GetClockFreq(RCC_ClockType SelectedClock)
         return SystemCoreClock;
 
     case SYSCLK:
-        return XPD_RCC_GetOscFreq(XPD_RCC_GetSYSCLKSource());
+        return rcc_clockTree.SYSCLK;
 
     case PCLK1:
-        return SystemCoreClock >> APBPrescTable[RCC->CFGR.b.PPRE1];
+        return rcc_clockTree.PCLK1;
 
     case PCLK2:
-        return SystemCoreClock >> APBPrescTable[RCC->CFGR.b.PPRE2];
+        return rcc_clockTree.PCLK2;
 
     default:
         return 0;
@@ -604,6 +698,230 @@ uint32_t XPD_RCC_GetClockFreq(RCC_ClockType SelectedClock)
 
 /** @} */
 
+/** @defgroup RCC_Core_Clocks_Exported_Functions_Scaling RCC Operating Point Functions
+ *  @brief    RCC dynamic frequency and voltage scaling
+ * @{
+ */
+
+/**
+ * @brief Switches the system to a new operating point: configures the clock tree,
+ *        the flash latency, then notifies the registered clock change listeners.
+ * @note  The PLL is reconfigured while the SYSCLK is provided by HSI.
+ *        The flash latency is always set to the minimal value for the new HCLK frequency.
+ * @param Config: pointer to the operating point configuration
+ * @return Result of the operation
+ */
+XPD_ReturnType XPD_RCC_OperatingPointConfig(const RCC_OperatingPointType * Config)
+{
+    XPD_ReturnType result = XPD_OK;
+
+    rcc_clockTransition = TRUE;
+    XPD_ENERGY_STATE(XPD_ENERGY_CLOCK);
+
+#ifdef HSE_VALUE
+    /* Start the HSE if it's needed by the new clock tree */
+    if ((Config->HSE_State != OSC_OFF) && (RCC_REG_BIT(CR,HSERDY) == 0))
+    {
+        result = XPD_RCC_HSEConfig(Config->HSE_State);
+    }
+#endif
+
+    /* Step on the HSI while the PLL is reconfigured */
+    if (Config->PLL != NULL)
+    {
+        if (XPD_RCC_GetSYSCLKSource() == PLL)
+        {
+            result = XPD_RCC_HSIConfig(ENABLE);
+
+            if (result == XPD_OK)
+            {
+                result = XPD_RCC_HCLKConfig(HSI, CLK_DIV1, FLASH_LATENCY_AUTO);
+            }
+        }
+        if ((result == XPD_OK) && (Config->PLL != NULL))
+        {
+            result = XPD_RCC_PLLConfig(Config->PLL);
+        }
+    }
+
+    if (result == XPD_OK)
+    {
+        uint32_t hclk = XPD_RCC_GetOscFreq(Config->SYSCLK_Source)
+                >> AHBPrescTable[rcc_convertClockDivider(HCLK, Config->HCLK_Divider)];
+
+        /* The APB dividers are set on the lower HCLK frequency,
+         * so the APB clocks remain within limits during the transition */
+        if (hclk > XPD_RCC_GetClockFreq(HCLK))
+        {
+            XPD_RCC_PCLKConfig(PCLK1, Config->PCLK1_Divider);
+            XPD_RCC_PCLKConfig(PCLK2, Config->PCLK2_Divider);
+
+            result = XPD_RCC_HCLKConfig(Config->SYSCLK_Source, Config->HCLK_Divider, FLASH_LATENCY_AUTO);
+        }
+        else
+        {
+            result = XPD_RCC_HCLKConfig(Config->SYSCLK_Source, Config->HCLK_Divider, FLASH_LATENCY_AUTO);
+
+            XPD_RCC_PCLKConfig(PCLK1, Config->PCLK1_Divider);
+            XPD_RCC_PCLKConfig(PCLK2, Config->PCLK2_Divider);
+        }
+    }
+
+    /* Notify the listeners once about the new clock configuration */
+    rcc_clockTransition = FALSE;
+    XPD_ENERGY_STATE(XPD_ENERGY_RUN);
+    rcc_clockChanged();
+
+    return result;
+}
+
+/* advances the pending operating point switch: starts the next oscillator
+ * which isn't ready yet, or completes the switch when all of them are */
+static void rcc_operatingPointProceed(void)
+{
+#ifdef HSE_VALUE
+    if ((rcc_pendingOperatingPoint.HSE_State != OSC_OFF) && (RCC_REG_BIT(CR,HSERDY) == 0))
+    {
+        /* Start the HSE, continue on HSERDY interrupt */
+        XPD_RCC_EnableIT(HSERDY);
+
+        if (RCC_REG_BIT(CR,HSEON) == 0)
+        {
+            RCC_REG_BIT(CR,HSEBYP) = rcc_pendingOperatingPoint.HSE_State >> 1;
+            RCC_REG_BIT(CR,HSEON)  = 1;
+        }
+    }
+    else
+#endif
+    if ((rcc_pendingOperatingPoint.PLL != NULL) && (rcc_pendingOperatingPoint.PLL->State != OSC_OFF))
+    {
+        const RCC_PLL_InitType * pll = rcc_pendingOperatingPoint.PLL;
+        uint32_t timeout = RCC_PLL_TIMEOUT;
+
+        /* The PLL is started only once, the completion leaves it untouched */
+        rcc_pendingOperatingPoint.PLL = NULL;
+
+        /* Disable the main PLL. */
+        RCC_REG_BIT(CR,PLLON) = OSC_OFF;
+        (void) XPD_WaitForMatch(&RCC->CR.w, RCC_CR_PLLRDY, 0, &timeout);
+
+        /* Configure the PLL while it's disabled */
+        if (rcc_pllSetup(pll) != XPD_OK)
+        {
+            rcc_operatingPointPending = FALSE;
+        }
+        else
+        {
+            /* the PLL output frequency is recalculated on demand */
+            rcc_clockTree.PLL = 0;
+
+            /* Start the PLL, continue on PLLRDY interrupt */
+            XPD_RCC_EnableIT(PLLRDY);
+            RCC_REG_BIT(CR,PLLON) = OSC_ON;
+        }
+    }
+    else
+    {
+        /* All oscillators are ready, the switch is completed in thread context */
+        rcc_operatingPointReady = TRUE;
+    }
+}
+
+/**
+ * @brief Starts the switch to a new operating point without waiting for the oscillators to stabilize.
+ *        The HSE and the PLL are started in the background, and when they are ready
+ *        the switch is completed by @ref XPD_RCC_OperatingPointComplete.
+ *        Meanwhile the application can carry on with its clock independent initialization
+ *        (GPIO, DMA, RAM structures) on the current HSI clock.
+ * @note  The RCC interrupt has to be enabled in the NVIC, it only starts the oscillators.
+ *        The readiness is signalled by the OscReady callback with @ref XPD_RCC_GetReadyOsc
+ *        returning PLL (or HSE), then @ref XPD_RCC_OperatingPointComplete has to be called
+ *        from thread context, which notifies the registered clock change listeners.
+ * @param Config: pointer to the operating point configuration (copied)
+ * @return BUSY if a switch is already pending or the PLL to reconfigure provides the SYSCLK, OK otherwise
+ */
+XPD_ReturnType XPD_RCC_OperatingPointConfig_IT(const RCC_OperatingPointType * Config)
+{
+    XPD_ReturnType result = XPD_OK;
+
+    if ((rcc_operatingPointPending != FALSE)
+     || ((Config->PLL != NULL) && (XPD_RCC_GetSYSCLKSource() == PLL)))
+    {
+        result = XPD_BUSY;
+    }
+    else
+    {
+        rcc_pendingOperatingPoint = *Config;
+        rcc_operatingPointPending = TRUE;
+        rcc_operatingPointReady   = FALSE;
+
+        rcc_operatingPointProceed();
+    }
+    return result;
+}
+
+/**
+ * @brief Completes the operating point switch started by @ref XPD_RCC_OperatingPointConfig_IT
+ *        once its oscillators are ready. The clock tree reconfiguration waits for the clock
+ *        switch and the regulator, therefore it's performed in thread context
+ *        instead of @ref XPD_RCC_IRQHandler.
+ * @return BUSY if the oscillators are still starting, OK if no switch is pending,
+ *         otherwise the result of @ref XPD_RCC_OperatingPointConfig
+ */
+XPD_ReturnType XPD_RCC_OperatingPointComplete(void)
+{
+    XPD_ReturnType result = XPD_OK;
+
+    if (rcc_operatingPointPending != FALSE)
+    {
+        if (rcc_operatingPointReady == FALSE)
+        {
+            result = XPD_BUSY;
+        }
+        else
+        {
+            rcc_operatingPointPending = FALSE;
+            rcc_operatingPointReady   = FALSE;
+
+            result = XPD_RCC_OperatingPointConfig(&rcc_pendingOperatingPoint);
+        }
+    }
+    return result;
+}
+
+/**
+ * @brief Registers a listener which is notified after each change of the core clocks,
+ *        so that the clock dependent peripheral settings can be recalculated.
+ * @note  The peripheral drivers provide such callbacks, e.g. @ref XPD_USART_ClockUpdate,
+ *        @ref XPD_SPI_ClockUpdate and @ref XPD_TIM_ClockUpdate.
+ * @param Listener: pointer to the listener, which has to remain valid while it's registered
+ */
+void XPD_RCC_ClockListener_Register(RCC_ClockListenerType * Listener)
+{
+    Listener->Next = rcc_clockListeners;
+    rcc_clockListeners = Listener;
+}
+
+/**
+ * @brief Removes a listener from the clock change notification list.
+ * @param Listener: pointer to the registered listener
+ */
+void XPD_RCC_ClockListener_Unregister(RCC_ClockListenerType * Listener)
+{
+    RCC_ClockListenerType ** link;
+
+    for (link = &rcc_clockListeners; *link != NULL; link = &(*link)->Next)
+    {
+        if (*link == Listener)
+        {
+            *link = Listener->Next;
+            break;
+        }
+    }
+}
+
+/** @} */
+
 /** @defgroup RCC_Core_Clocks_Exported_Functions_MCO RCC Clock Outputs
  *  @brief    RCC microcontroller clock outputs
  * @{
@@ -673,6 +991,26 @@ void XPD_RCC_Deinit(void)
     RCC->CIR.w = 0;
 
     SystemCoreClock = HSI_VALUE;
+    rcc_clockTree.SYSCLK = HSI_VALUE;
+    rcc_clockTree.PCLK1  = HSI_VALUE;
+    rcc_clockTree.PCLK2  = HSI_VALUE;
+    rcc_clockTree.PLL    = 0;
+
+    rcc_operatingPointPending = FALSE;
+    rcc_operatingPointReady   = FALSE;
+}
+
+/**
+ * @brief Updates the cached clock frequencies to the current clock configuration,
+ *        which was set up before the application started (e.g. by a boot loader).
+ */
+void XPD_RCC_ClockTreeSync(void)
+{
+    rcc_clockTree.PLL = 0;
+
+    /* Update SystemCoreClock variable */
+    SystemCoreClock = XPD_RCC_GetOscFreq(XPD_RCC_GetSYSCLKSource()) >> AHBPrescTable[RCC->CFGR.b.HPRE];
+    rcc_clockTreeUpdate();
 }
 
 /**
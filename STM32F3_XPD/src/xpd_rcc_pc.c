@@ -583,6 +583,43 @@ uint32_t XPD_SDADC_GetClockFreq(void)
 
 #endif /* USE_XPD_SDADC */
 
+#if defined(USE_XPD_SPI)
+#include "xpd_spi.h"
+
+/** @addtogroup SPI
+ * @{ */
+
+/** @addtogroup SPI_Clock_Source
+ * @{ */
+
+/** @defgroup SPI_Clock_Source_Exported_Functions SPI Clock Source Exported Functions
+ * @{ */
+
+/**
+ * @brief Returns the input clock frequency of the SPI.
+ * @param hspi: pointer to the SPI handle structure
+ * @return The clock frequency of the SPI in Hz
+ */
+uint32_t XPD_SPI_GetClockFreq(SPI_HandleType * hspi)
+{
+    /* decide which APB bus the SPI is on */
+    if (((uint32_t)hspi->Inst) < APB2PERIPH_BASE)
+    {
+        return XPD_RCC_GetClockFreq(PCLK1);
+    }
+    else
+    {
+        return XPD_RCC_GetClockFreq(PCLK2);
+    }
+}
+
+/** @} */
+
+/** @} */
+
+/** @} */
+#endif /* USE_XPD_SPI */
+
 #if defined(USE_XPD_TIM)
 #include "xpd_tim.h"
 
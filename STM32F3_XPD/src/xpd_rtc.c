@@ -0,0 +1,568 @@
+/**
+  ******************************************************************************
+  * @file    xpd_rtc.c
+  * @author  Benedek Kupper
+  * @version V0.1
+  * @date    2018-01-20
+  * @brief   STM32 eXtensible Peripheral Drivers Real Time Clock Module
+  *
+  *  This file is part of STM32_XPD.
+  *
+  *  STM32_XPD is free software: you can redistribute it and/or modify
+  *  it under the terms of the GNU General Public License as published by
+  *  the Free Software Foundation, either version 3 of the License, or
+  *  (at your option) any later version.
+  *
+  *  STM32_XPD is distributed in the hope that it will be useful,
+  *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with STM32_XPD.  If not, see <http://www.gnu.org/licenses/>.
+  */
+#include "xpd_rtc.h"
+#include "xpd_exti.h"
+#include "xpd_pwr.h"
+#include "xpd_utils.h"
+
+#if defined(USE_XPD_RTC)
+
+/** @addtogroup RTC
+ * @{ */
+
+/* The initialization and synchronization take at most a few RTCCLK cycles */
+#define RTC_TIMEOUT             2
+
+#define RTC_ALRMAR_ANY_SECOND   RTC_ALRMAR_MSK1
+#define RTC_ALRMAR_ANY_MINUTE   RTC_ALRMAR_MSK2
+#define RTC_ALRMAR_ANY_HOUR     RTC_ALRMAR_MSK3
+#define RTC_ALRMAR_ANY_DAY      RTC_ALRMAR_MSK4
+
+/* The wakeup timer clock selections */
+#define RTC_WUCKSEL_DIV16       0
+#define RTC_WUCKSEL_SPRE        4
+#define RTC_WUCKSEL_SPRE_EXT    6
+
+static void rtc_unlock(void)
+{
+    XPD_PWR_BackupAccess(ENABLE);
+
+    RTC->WPR = 0xCA;
+    RTC->WPR = 0x53;
+}
+
+static void rtc_lock(void)
+{
+    RTC->WPR = 0xFF;
+}
+
+/* Clears the selected flags without affecting the others or the init mode */
+static void rtc_clearFlags(uint32_t Flags)
+{
+    RTC->ISR.w = ~(Flags | RTC_ISR_INIT) | (RTC->ISR.w & RTC_ISR_INIT);
+}
+
+static XPD_ReturnType rtc_enterInit(void)
+{
+    uint32_t timeout = RTC_TIMEOUT;
+
+    /* Setting every bit keeps the flags intact */
+    RTC->ISR.w = ~0UL;
+
+    return XPD_WaitForMatch(&RTC->ISR.w, RTC_ISR_INITF, RTC_ISR_INITF, &timeout);
+}
+
+static void rtc_exitInit(void)
+{
+    RTC->ISR.w = ~RTC_ISR_INIT;
+}
+
+static uint8_t rtc_fromBcd(uint32_t Value)
+{
+    return ((Value >> 4) * 10) + (Value & 0xF);
+}
+
+static uint32_t rtc_toBcd(uint8_t Value)
+{
+    return ((Value / 10) << 4) | (Value % 10);
+}
+
+/* Converts the calendar registers to the calendar structure */
+static void rtc_fromRegs(RTC_DateTimeType * DateTime, uint32_t TR, uint32_t DR, uint32_t SSR)
+{
+    uint32_t prediv = RTC->PRER.w & RTC_PRER_PREDIV_S;
+
+    DateTime->Year      = rtc_fromBcd((DR >> RTC_DR_YU_Pos)  & 0xFF);
+    DateTime->Month     = rtc_fromBcd((DR >> RTC_DR_MU_Pos)  & 0x1F);
+    DateTime->Day       = rtc_fromBcd((DR >> RTC_DR_DU_Pos)  & 0x3F);
+    DateTime->WeekDay   =             (DR >> RTC_DR_WDU_Pos) & 0x7;
+    DateTime->Hour      = rtc_fromBcd((TR >> RTC_TR_HU_Pos)  & 0x3F);
+    DateTime->Minute    = rtc_fromBcd((TR >> RTC_TR_MNU_Pos) & 0x7F);
+    DateTime->Second    = rtc_fromBcd((TR >> RTC_TR_SU_Pos)  & 0x7F);
+
+    /* The sub-second value can exceed the prescaler after a shift operation */
+    DateTime->SubSecond = (SSR <= prediv) ? (prediv - SSR) : 0;
+}
+
+/** @defgroup RTC_Exported_Functions RTC Exported Functions
+ * @{ */
+
+/**
+ * @brief Sets the RTC prescalers and the register access mode.
+ *        The running calendar isn't stopped if the prescalers are already set up.
+ * @note  The RTC clock source has to be configured beforehand by @ref XPD_RTC_ClockConfig.
+ *        The synchronous prescaler is calculated to provide the 1 Hz calendar clock.
+ * @param Config: RTC setup configuration
+ * @return ERROR if the RTC clock can't be prescaled to 1 Hz, TIMEOUT if the initialization
+ *         mode can't be entered, OK if success
+ */
+XPD_ReturnType XPD_RTC_Init(const RTC_InitType * Config)
+{
+    XPD_ReturnType result = XPD_OK;
+    uint32_t freq = XPD_RTC_GetClockFreq();
+    uint32_t sync, prer;
+
+    if ((Config->AsyncPrescaler == 0) || (Config->AsyncPrescaler > 128))
+    {
+        return XPD_ERROR;
+    }
+
+    sync = freq / Config->AsyncPrescaler;
+    if ((sync == 0) || (sync > (RTC_PRER_PREDIV_S + 1)))
+    {
+        return XPD_ERROR;
+    }
+    prer = ((uint32_t)(Config->AsyncPrescaler - 1) << RTC_PRER_PREDIV_A_Pos) | (sync - 1);
+
+    rtc_unlock();
+
+    if (RTC->PRER.w != prer)
+    {
+        result = rtc_enterInit();
+
+        if (result == XPD_OK)
+        {
+            /* The synchronous prescaler has to be written first */
+            RTC->PRER.w = prer & RTC_PRER_PREDIV_S;
+            RTC->PRER.w = prer;
+
+            RTC->CR.w &= ~RTC_CR_FMT;
+        }
+        rtc_exitInit();
+    }
+
+    if (Config->BypassShadow == ENABLE)
+    {
+        RTC->CR.w |= RTC_CR_BYPSHAD;
+    }
+    else
+    {
+        RTC->CR.w &= ~RTC_CR_BYPSHAD;
+    }
+
+    rtc_lock();
+
+    return result;
+}
+
+/**
+ * @brief Sets the calendar date and time.
+ * @note  The sub-second counter is restarted.
+ * @param DateTime: the new calendar value (the SubSecond field is ignored)
+ * @return TIMEOUT if the initialization mode can't be entered, OK if success
+ */
+XPD_ReturnType XPD_RTC_SetDateTime(const RTC_DateTimeType * DateTime)
+{
+    XPD_ReturnType result;
+
+    rtc_unlock();
+
+    result = rtc_enterInit();
+
+    if (result == XPD_OK)
+    {
+        RTC->TR.w = (rtc_toBcd(DateTime->Hour)   << RTC_TR_HU_Pos)
+                  | (rtc_toBcd(DateTime->Minute) << RTC_TR_MNU_Pos)
+                  | (rtc_toBcd(DateTime->Second) << RTC_TR_SU_Pos);
+
+        RTC->DR.w = (rtc_toBcd(DateTime->Year)   << RTC_DR_YU_Pos)
+                  | (rtc_toBcd(DateTime->Month)  << RTC_DR_MU_Pos)
+                  | (rtc_toBcd(DateTime->Day)    << RTC_DR_DU_Pos)
+                  | ((uint32_t)DateTime->WeekDay << RTC_DR_WDU_Pos);
+    }
+    rtc_exitInit();
+
+    rtc_lock();
+
+    /* The shadow registers are updated with the new value */
+    if ((result == XPD_OK) && ((RTC->CR.w & RTC_CR_BYPSHAD) == 0))
+    {
+        result = XPD_RTC_WaitForSync();
+    }
+    return result;
+}
+
+/**
+ * @brief Reads the current calendar date and time.
+ * @param DateTime: the calendar structure to fill
+ */
+void XPD_RTC_GetDateTime(RTC_DateTimeType * DateTime)
+{
+    uint32_t ssr, tr, dr;
+
+    if ((RTC->CR.w & RTC_CR_BYPSHAD) != 0)
+    {
+        /* The counters are read until no carry happens during the read */
+        do {
+            tr  = RTC->TR.w;
+            dr  = RTC->DR.w;
+            ssr = RTC->SSR;
+        } while ((tr != RTC->TR.w) || (dr != RTC->DR.w));
+    }
+    else
+    {
+        /* Reading the sub-seconds locks the shadow registers until the date is read */
+        ssr = RTC->SSR;
+        tr  = RTC->TR.w;
+        dr  = RTC->DR.w;
+    }
+
+    rtc_fromRegs(DateTime, tr, dr, ssr);
+}
+
+/**
+ * @brief Reads the time of the day in sub-second ticks, for cheap and precise timestamps.
+ *        The value wraps around at midnight, with @ref XPD_RTC_GetTicksPerSecond ticks per second.
+ * @note  After low power modes the shadow registers have to be resynchronized by
+ *        @ref XPD_RTC_WaitForSync, unless the shadow registers are bypassed.
+ * @return The elapsed sub-second ticks since midnight
+ */
+uint32_t XPD_RTC_GetTimestamp(void)
+{
+    uint32_t prediv = RTC->PRER.w & RTC_PRER_PREDIV_S;
+    uint32_t ssr, tr, seconds;
+
+    if ((RTC->CR.w & RTC_CR_BYPSHAD) != 0)
+    {
+        /* A second carry between the reads changes the time register */
+        do {
+            tr  = RTC->TR.w;
+            ssr = RTC->SSR;
+        } while (tr != RTC->TR.w);
+    }
+    else
+    {
+        ssr = RTC->SSR;
+        tr  = RTC->TR.w;
+
+        /* Reading the date unlocks the shadow registers */
+        (void) RTC->DR.w;
+    }
+
+    seconds = ((uint32_t)rtc_fromBcd((tr >> RTC_TR_HU_Pos)  & 0x3F) * 3600)
+            + ((uint32_t)rtc_fromBcd((tr >> RTC_TR_MNU_Pos) & 0x7F) * 60)
+            +  (uint32_t)rtc_fromBcd((tr >> RTC_TR_SU_Pos)  & 0x7F);
+
+    return (seconds * (prediv + 1)) + ((ssr <= prediv) ? (prediv - ssr) : 0);
+}
+
+/**
+ * @brief Waits until the calendar shadow registers are resynchronized,
+ *        which is necessary after the system wakes up from low power modes.
+ * @return TIMEOUT if the synchronization doesn't happen in time, OK if success
+ */
+XPD_ReturnType XPD_RTC_WaitForSync(void)
+{
+    uint32_t timeout = RTC_TIMEOUT;
+
+    rtc_unlock();
+    rtc_clearFlags(RTC_ISR_RSF);
+    rtc_lock();
+
+    return XPD_WaitForMatch(&RTC->ISR.w, RTC_ISR_RSF, RTC_ISR_RSF, &timeout);
+}
+
+/**
+ * @brief Sets up and starts an alarm with interrupt generation.
+ * @param Alarm: the alarm index (0 for A, 1 for B)
+ * @param Config: the alarm matching fields
+ * @return ERROR if the alarm doesn't exist, TIMEOUT if the alarm can't be written, OK if success
+ */
+XPD_ReturnType XPD_RTC_AlarmStart_IT(uint8_t Alarm, const RTC_AlarmType * Config)
+{
+    XPD_ReturnType result;
+    uint32_t timeout = RTC_TIMEOUT;
+    uint32_t alrmr = 0;
+
+#ifdef RTC_CR_ALRBE
+    if (Alarm > 1)
+#else
+    if (Alarm > 0)
+#endif
+    {
+        return XPD_ERROR;
+    }
+
+    alrmr |= (Config->Day    == RTC_ALARM_ANY) ? RTC_ALRMAR_ANY_DAY    : (rtc_toBcd(Config->Day)    << RTC_ALRMAR_DU_Pos);
+    alrmr |= (Config->Hour   == RTC_ALARM_ANY) ? RTC_ALRMAR_ANY_HOUR   : (rtc_toBcd(Config->Hour)   << RTC_ALRMAR_HU_Pos);
+    alrmr |= (Config->Minute == RTC_ALARM_ANY) ? RTC_ALRMAR_ANY_MINUTE : (rtc_toBcd(Config->Minute) << RTC_ALRMAR_MNU_Pos);
+    alrmr |= (Config->Second == RTC_ALARM_ANY) ? RTC_ALRMAR_ANY_SECOND : (rtc_toBcd(Config->Second) << RTC_ALRMAR_SU_Pos);
+
+    rtc_unlock();
+
+    /* The alarm can only be written while it's disabled */
+    RTC->CR.w &= ~((RTC_CR_ALRAE | RTC_CR_ALRAIE) << Alarm);
+    result = XPD_WaitForMatch(&RTC->ISR.w, RTC_ISR_ALRAWF << Alarm, RTC_ISR_ALRAWF << Alarm, &timeout);
+
+    if (result == XPD_OK)
+    {
+        /* The sub-seconds aren't compared */
+#ifdef RTC_CR_ALRBE
+        if (Alarm != 0)
+        {
+            RTC->ALRMBR.w    = alrmr;
+            RTC->ALRMBSSR.w  = 0;
+        }
+        else
+#endif
+        {
+            RTC->ALRMAR.w    = alrmr;
+            RTC->ALRMASSR.w  = 0;
+        }
+
+        rtc_clearFlags(RTC_ISR_ALRAF << Alarm);
+        RTC->CR.w |= (RTC_CR_ALRAE | RTC_CR_ALRAIE) << Alarm;
+    }
+
+    rtc_lock();
+
+    return result;
+}
+
+/**
+ * @brief Stops the alarm.
+ * @param Alarm: the alarm index (0 for A, 1 for B)
+ */
+void XPD_RTC_AlarmStop_IT(uint8_t Alarm)
+{
+    rtc_unlock();
+
+    RTC->CR.w &= ~((RTC_CR_ALRAE | RTC_CR_ALRAIE) << Alarm);
+    rtc_clearFlags(RTC_ISR_ALRAF << Alarm);
+
+    rtc_lock();
+}
+
+#ifdef RTC_CR_WUTE
+/**
+ * @brief Starts the periodic wakeup timer with interrupt generation.
+ *        Periods up to 0x10000 RTCCLK / 16 cycles (32 s with a 32768 Hz clock) are timed
+ *        by the prescaled RTCCLK, longer periods (up to 36 hours) are timed by the calendar seconds.
+ * @param Milliseconds: the requested wakeup period in ms
+ * @return The set wakeup period in ms, 0 if the timer can't be set
+ */
+uint32_t XPD_RTC_WakeupStart_IT(uint32_t Milliseconds)
+{
+    uint32_t tickFreq = XPD_RTC_GetClockFreq() >> 4;
+    uint32_t timeout = RTC_TIMEOUT;
+    uint32_t wucksel, wutr;
+
+    if ((tickFreq == 0) || (Milliseconds == 0))
+    {
+        return 0;
+    }
+
+    if (Milliseconds <= ((0x10000 * 1000) / tickFreq))
+    {
+        wucksel = RTC_WUCKSEL_DIV16;
+        wutr = (Milliseconds * tickFreq) / 1000;
+        if (wutr == 0)
+        {
+            wutr = 1;
+        }
+        Milliseconds = (wutr * 1000) / tickFreq;
+    }
+    else
+    {
+        uint32_t seconds = Milliseconds / 1000;
+
+        if (seconds > 0x20000)
+        {
+            seconds = 0x20000;
+        }
+        Milliseconds = seconds * 1000;
+
+        /* The extended selection adds 0x10000 to the counter period */
+        if (seconds > 0x10000)
+        {
+            wucksel = RTC_WUCKSEL_SPRE_EXT;
+            wutr = seconds - 0x10000;
+        }
+        else
+        {
+            wucksel = RTC_WUCKSEL_SPRE;
+            wutr = seconds;
+        }
+    }
+
+    rtc_unlock();
+
+    /* The wakeup timer can only be written while it's disabled */
+    RTC->CR.w &= ~(RTC_CR_WUTE | RTC_CR_WUTIE);
+    if (XPD_WaitForMatch(&RTC->ISR.w, RTC_ISR_WUTWF, RTC_ISR_WUTWF, &timeout) != XPD_OK)
+    {
+        Milliseconds = 0;
+    }
+    else
+    {
+        RTC->WUTR = wutr - 1;
+        RTC->CR.w = (RTC->CR.w & ~RTC_CR_WUCKSEL) | (wucksel << RTC_CR_WUCKSEL_Pos);
+
+        rtc_clearFlags(RTC_ISR_WUTF);
+        RTC->CR.w |= RTC_CR_WUTE | RTC_CR_WUTIE;
+    }
+
+    rtc_lock();
+
+    return Milliseconds;
+}
+
+/**
+ * @brief Stops the wakeup timer.
+ */
+void XPD_RTC_WakeupStop_IT(void)
+{
+    rtc_unlock();
+
+    RTC->CR.w &= ~(RTC_CR_WUTE | RTC_CR_WUTIE);
+    rtc_clearFlags(RTC_ISR_WUTF);
+
+    rtc_lock();
+}
+#endif /* RTC_CR_WUTE */
+
+/**
+ * @brief Enables the capture of the calendar on the edge of the timestamp pin.
+ * @param Edge: the active edge of the timestamp pin (rising or falling)
+ */
+void XPD_RTC_TimestampStart_IT(EdgeType Edge)
+{
+    rtc_unlock();
+
+    /* The edge can only be changed while the timestamp is disabled */
+    RTC->CR.w &= ~(RTC_CR_TSE | RTC_CR_TSIE);
+
+    if (Edge == EDGE_FALLING)
+    {
+        RTC->CR.w |= RTC_CR_TSEDGE;
+    }
+    else
+    {
+        RTC->CR.w &= ~RTC_CR_TSEDGE;
+    }
+
+    rtc_clearFlags(RTC_ISR_TSF | RTC_ISR_TSOVF);
+    RTC->CR.w |= RTC_CR_TSE | RTC_CR_TSIE;
+
+    rtc_lock();
+}
+
+/**
+ * @brief Disables the timestamp capture.
+ */
+void XPD_RTC_TimestampStop_IT(void)
+{
+    rtc_unlock();
+
+    RTC->CR.w &= ~(RTC_CR_TSE | RTC_CR_TSIE);
+    rtc_clearFlags(RTC_ISR_TSF | RTC_ISR_TSOVF);
+
+    rtc_lock();
+}
+
+/**
+ * @brief Reads the calendar value captured by the timestamp event, and releases the capture.
+ * @note  The year isn't captured, it is filled with the current year.
+ * @param DateTime: the calendar structure to fill
+ * @return ERROR if no event was captured, BUSY if further events were missed, OK otherwise
+ */
+XPD_ReturnType XPD_RTC_GetEventTimestamp(RTC_DateTimeType * DateTime)
+{
+    XPD_ReturnType result = XPD_OK;
+    uint32_t isr = RTC->ISR.w;
+
+    if ((isr & RTC_ISR_TSF) == 0)
+    {
+        return XPD_ERROR;
+    }
+
+    rtc_fromRegs(DateTime, RTC->TSTR.w, (RTC->TSDR.w & ~RTC_DR_YT & ~RTC_DR_YU)
+            | (RTC->DR.w & (RTC_DR_YT | RTC_DR_YU)), RTC->TSSSR);
+
+    if ((isr & RTC_ISR_TSOVF) != 0)
+    {
+        result = XPD_BUSY;
+    }
+
+    rtc_clearFlags(RTC_ISR_TSF | RTC_ISR_TSOVF);
+
+    return result;
+}
+
+/**
+ * @brief RTC interrupt handler that provides the alarm, wakeup and timestamp callbacks.
+ *        It is shared by all RTC interrupt vectors.
+ */
+void XPD_RTC_IRQHandler(void)
+{
+    uint32_t cr  = RTC->CR.w;
+    uint32_t isr = RTC->ISR.w;
+
+    XPD_PROFILE_BEGIN();
+
+    if (((isr & RTC_ISR_ALRAF) != 0) && ((cr & RTC_CR_ALRAIE) != 0))
+    {
+        rtc_clearFlags(RTC_ISR_ALRAF);
+        XPD_EXTI_ClearFlag(PWR_RTC_ALARM_EXTI_LINE);
+
+        XPD_SAFE_CALLBACK(XPD_RTC_Callbacks.Alarm, 0);
+    }
+#ifdef RTC_CR_ALRBE
+    if (((isr & RTC_ISR_ALRBF) != 0) && ((cr & RTC_CR_ALRBIE) != 0))
+    {
+        rtc_clearFlags(RTC_ISR_ALRBF);
+        XPD_EXTI_ClearFlag(PWR_RTC_ALARM_EXTI_LINE);
+
+        XPD_SAFE_CALLBACK(XPD_RTC_Callbacks.Alarm, 1);
+    }
+#endif
+#ifdef RTC_CR_WUTE
+    if (((isr & RTC_ISR_WUTF) != 0) && ((cr & RTC_CR_WUTIE) != 0))
+    {
+        rtc_clearFlags(RTC_ISR_WUTF);
+        XPD_EXTI_ClearFlag(PWR_RTC_WAKEUP_EXTI_LINE);
+
+        XPD_SAFE_CALLBACK(XPD_RTC_Callbacks.Wakeup,);
+    }
+#endif
+    if (((isr & RTC_ISR_TSF) != 0) && ((cr & RTC_CR_TSIE) != 0))
+    {
+        XPD_EXTI_ClearFlag(PWR_RTC_TAMP_STAMP_EXTI_LINE);
+
+        XPD_SAFE_CALLBACK(XPD_RTC_Callbacks.Timestamp,);
+
+        /* Release the capture if it wasn't read by the callback */
+        rtc_clearFlags(RTC_ISR_TSF | RTC_ISR_TSOVF);
+    }
+
+    XPD_PROFILE_END();
+}
+
+/** @} */
+
+XPD_RTC_CallbacksType XPD_RTC_Callbacks = { NULL, NULL, NULL };
+
+/** @} */
+
+#endif /* USE_XPD_RTC */
@@ -23,6 +23,8 @@
   */
 
 #include "xpd_tim.h"
+#include "xpd_exti.h"
+#include "xpd_gpio.h"
 #include "xpd_utils.h"
 
 #ifdef USE_XPD_TIM
@@ -131,6 +133,7 @@ XPD_ReturnType XPD_TIM_Init(TIM_HandleType * htim, const TIM_Counter_InitType *
 
     htim->Inst->ARR             = (uint32_t)(Config->Period - 1);
     htim->Inst->PSC             = (uint32_t)(Config->Prescaler - 1);
+    htim->CounterFreq           = XPD_TIM_GetClockFreq(htim) / Config->Prescaler;
 
     htim->Inst->RCR             = Config->RepetitionCounter;
 
@@ -166,6 +169,32 @@ XPD_ReturnType XPD_TIM_Deinit(TIM_HandleType * htim)
     return XPD_OK;
 }
 
+/**
+ * @brief Recalculates the counter prescaler for the current timer clock frequency,
+ *        so that the counter frequency of the initial setup is kept.
+ * @note  It can be registered as RCC clock change listener callback.
+ *        The new prescaler value is loaded at the next update event.
+ *        Only applicable when the counter is clocked by the internal clock.
+ * @param htim: pointer to the TIM handle structure
+ */
+void XPD_TIM_ClockUpdate(TIM_HandleType * htim)
+{
+    if (htim->CounterFreq != 0)
+    {
+        uint32_t prescaler = (XPD_TIM_GetClockFreq(htim) + (htim->CounterFreq / 2)) / htim->CounterFreq;
+
+        if (prescaler == 0)
+        {
+            prescaler = 1;
+        }
+        else if (prescaler > 0x10000)
+        {
+            prescaler = 0x10000;
+        }
+        htim->Inst->PSC = prescaler - 1;
+    }
+}
+
 /**
  * @brief Enables the TIM counter and update interrupt.
  * @param htim: pointer to the TIM handle structure
@@ -354,12 +383,143 @@ void XPD_TIM_Channel_Stop_DMA(TIM_HandleType * htim, TIM_ChannelType Channel)
     XPD_TIM_Channel_Stop(htim, Channel);
 }
 
+/* fills the selected half of the waveform buffer, zero padded after the end of the waveform */
+static void tim_waveformFill(TIM_HandleType * htim, uint16_t * buffer)
+{
+    uint16_t count = 0;
+
+    if (htim->Waveform.Countdown == 0)
+    {
+        count = htim->Waveform.Encoder(htim, buffer, htim->Waveform.Length);
+
+        /* The last values are output during the next half transfer,
+         * the one after that (with idle output) is waited to finish as well */
+        if (count < htim->Waveform.Length)
+        {
+            htim->Waveform.Countdown = 3;
+        }
+    }
+
+    for (; count < htim->Waveform.Length; count++)
+    {
+        buffer[count] = 0;
+    }
+}
+
+/* refills the transferred half of the waveform buffer, or stops the output after the waveform end */
+static void tim_waveformProceed(TIM_HandleType * htim, uint16_t * buffer)
+{
+    if ((htim->Waveform.Countdown != 0) && (--htim->Waveform.Countdown == 0))
+    {
+        XPD_TIM_Waveform_Stop_DMA(htim);
+
+        /* Waveform complete callback */
+        htim->ActiveChannel = htim->Waveform.Channel;
+        XPD_SAFE_CALLBACK(htim->Callbacks.ChannelEvent, htim);
+    }
+    else
+    {
+        tim_waveformFill(htim, buffer);
+    }
+}
+
+static void tim_dmaWaveformHalfRedirect(void *hdma)
+{
+    TIM_HandleType* htim = (TIM_HandleType*) ((DMA_HandleType*) hdma)->Owner;
+
+    tim_waveformProceed(htim, htim->Waveform.Buffer);
+}
+static void tim_dmaWaveformCompleteRedirect(void *hdma)
+{
+    TIM_HandleType* htim = (TIM_HandleType*) ((DMA_HandleType*) hdma)->Owner;
+
+    tim_waveformProceed(htim, &htim->Waveform.Buffer[htim->Waveform.Length]);
+}
+
+/**
+ * @brief Starts streaming a waveform of compare values to the selected timer channel.
+ *        The values are transferred by the channel DMA from a circular buffer,
+ *        the half of which is refilled by the encoder callback each time its transfer is complete,
+ *        therefore waveforms of arbitrary length can be generated (e.g. bit to duty cycle expansion).
+ *        The Channel event callback is called once the waveform has been output.
+ * @note  The channel DMA has to be initialized in circular mode with halfword memory data alignment,
+ *        and the waveform is followed by 0 compare values until the output is stopped.
+ *        Only one waveform can be streamed by a timer at once.
+ * @param htim: pointer to the TIM handle structure
+ * @param Channel: the selected capture/compare channel to use
+ * @param Buffer: the buffer of 2 * Length compare values
+ * @param Length: the number of compare values which are encoded at once
+ * @param Encoder: the callback which provides the next compare values of the waveform
+ * @return ERROR if the DMA isn't circular, BUSY if the DMA is used by other peripheral, OK otherwise
+ */
+XPD_ReturnType XPD_TIM_Waveform_Start_DMA(TIM_HandleType * htim, TIM_ChannelType Channel,
+        uint16_t * Buffer, uint16_t Length, TIM_WaveformEncoderType Encoder)
+{
+    XPD_ReturnType result = XPD_ERROR;
+    DMA_HandleType * hdma = htim->DMA.Channel[Channel];
+
+    if (XPD_DMA_CircularMode(hdma) != 0)
+    {
+        htim->Waveform.Encoder   = Encoder;
+        htim->Waveform.Buffer    = Buffer;
+        htim->Waveform.Length    = Length;
+        htim->Waveform.Countdown = 0;
+        htim->Waveform.Channel   = Channel;
+
+        /* Encode the beginning of the waveform to both buffer halves */
+        tim_waveformFill(htim, Buffer);
+        if (htim->Waveform.Countdown != 0)
+        {
+            /* The waveform ends in the first half */
+            htim->Waveform.Countdown--;
+        }
+        tim_waveformFill(htim, &Buffer[Length]);
+
+        /* Set up DMA for transfer */
+        result = XPD_DMA_Start_IT(hdma, (void*)&((&htim->Inst->CCR1)[Channel]), Buffer, 2 * Length);
+
+        /* If the DMA is currently used, return with error */
+        if (result == XPD_OK)
+        {
+            /* Set the callback owner */
+            hdma->Owner = htim;
+
+            /* set the DMA buffer half refill callbacks */
+            hdma->Callbacks.HalfComplete = tim_dmaWaveformHalfRedirect;
+            hdma->Callbacks.Complete     = tim_dmaWaveformCompleteRedirect;
+#ifdef USE_XPD_DMA_ERROR_DETECT
+            hdma->Callbacks.Error        = tim_dmaErrorRedirect;
+#endif
+            XPD_DMA_EnableIT(hdma, HT);
+
+            XPD_TIM_Channel_EnableDMA(htim, Channel);
+
+            XPD_TIM_Channel_Start(htim, Channel);
+        }
+    }
+    return result;
+}
+
+/**
+ * @brief Stops the waveform streaming, the timer channel (and the timer if required)
+ *        and disables the DMA requests.
+ * @param htim: pointer to the TIM handle structure
+ */
+void XPD_TIM_Waveform_Stop_DMA(TIM_HandleType * htim)
+{
+    htim->DMA.Channel[htim->Waveform.Channel]->Callbacks.HalfComplete = NULL;
+
+    XPD_TIM_Channel_Stop_DMA(htim, htim->Waveform.Channel);
+}
+
 /**
  * @brief TIM update interrupt handler that provides handle callbacks.
  * @param htim: pointer to the TIM handle structure
  */
 void XPD_TIM_UP_IRQHandler(TIM_HandleType * htim)
 {
+    XPD_PROFILE_BEGIN();
+
     /* TIM update event */
     if (XPD_TIM_GetFlag(htim, U) != 0)
     {
@@ -368,6 +528,8 @@ void XPD_TIM_UP_IRQHandler(TIM_HandleType * htim)
 
         XPD_SAFE_CALLBACK(htim->Callbacks.Update, htim);
     }
+
+    XPD_PROFILE_END();
 }
 
 /**
@@ -376,6 +538,8 @@ void XPD_TIM_UP_IRQHandler(TIM_HandleType * htim)
  */
 void XPD_TIM_CC_IRQHandler(TIM_HandleType * htim)
 {
+    XPD_PROFILE_BEGIN();
+
     uint32_t sr = (htim->Inst->SR.w & (TIM_SR_CC1IF | TIM_SR_CC2IF | TIM_SR_CC3IF | TIM_SR_CC4IF)) >> 1;
     TIM_ChannelType ch;
 
@@ -392,6 +556,8 @@ void XPD_TIM_CC_IRQHandler(TIM_HandleType * htim)
             XPD_SAFE_CALLBACK(htim->Callbacks.ChannelEvent, htim);
         }
     }
+
+    XPD_PROFILE_END();
 }
 
 /**
@@ -400,6 +566,8 @@ void XPD_TIM_CC_IRQHandler(TIM_HandleType * htim)
  */
 void XPD_TIM_BRK_IRQHandler(TIM_HandleType * htim)
 {
+    XPD_PROFILE_BEGIN();
+
     /* TIM Break input event */
     if (XPD_TIM_GetFlag(htim, B) != 0)
     {
@@ -408,6 +576,8 @@ void XPD_TIM_BRK_IRQHandler(TIM_HandleType * htim)
 
         XPD_SAFE_CALLBACK(htim->Callbacks.Break, htim);
     }
+
+    XPD_PROFILE_END();
 }
 
 /**
@@ -416,6 +586,8 @@ void XPD_TIM_BRK_IRQHandler(TIM_HandleType * htim)
  */
 void XPD_TIM_TRG_COM_IRQHandler(TIM_HandleType * htim)
 {
+    XPD_PROFILE_BEGIN();
+
     uint32_t sr = htim->Inst->SR.w;
 
     /* TIM Trigger detection event */
@@ -434,6 +606,8 @@ void XPD_TIM_TRG_COM_IRQHandler(TIM_HandleType * htim)
 
         XPD_SAFE_CALLBACK(htim->Callbacks.Commutation, htim);
     }
+
+    XPD_PROFILE_END();
 }
 
 /**
@@ -442,11 +616,15 @@ void XPD_TIM_TRG_COM_IRQHandler(TIM_HandleType * htim)
  */
 void XPD_TIM_IRQHandler(TIM_HandleType * htim)
 {
+    XPD_PROFILE_BEGIN();
+
     XPD_TIM_UP_IRQHandler(htim);
     XPD_TIM_CC_IRQHandler(htim);
     XPD_TIM_TRG_COM_IRQHandler(htim);
     /* leave out break interrupt, timers that have break also have separate interrupt line */
     /*XPD_TIM_BRK_IRQHandler(htim);*/
+
+    XPD_PROFILE_END();
 }
 
 /** @} */
@@ -476,7 +654,7 @@ XPD_ReturnType XPD_TIM_Burst_Start_DMA(TIM_HandleType * htim, const TIM_Burst_In
     /* Set the DMA start address location - relative to timer start address */
     htim->Inst->DCR.b.DBA = Config->RegIndex;
     /* Set the DMA burst transfer length */
-    htim->Inst->DCR.b.DBL = Length - 1;
+    htim->Inst->DCR.b.DBL = ((Config->Registers != 0) ? Config->Registers : Length) - 1;
 
     /* Set up DMA for transfer */
     result = XPD_DMA_Start_IT(hdma, (void*)&htim->Inst->DMAR, Address, Length);
@@ -514,6 +692,148 @@ void XPD_TIM_Burst_Stop_DMA(TIM_HandleType * htim, TIM_BurstSourceType Source)
     XPD_DMA_Stop_IT(hdma);
 }
 
+/* The number of registers read by each snapshot burst */
+#define TIM_SNAPSHOT_REGISTERS  (sizeof(TIM_SnapshotType) / sizeof(uint32_t))
+
+/**
+ * @brief Starts capturing the counter and all four capture registers into a ring of snapshots
+ *        by a single burst DMA read at each event of the selected source.
+ *        The source callback is called each time the ring is filled.
+ * @note  The Burst DMA handle has to be set up with peripheral to memory direction,
+ *        memory increment, word data width and circular mode.
+ *        The capture flags are cleared by the DMA reads of the capture registers,
+ *        so the channels don't need interrupts: the source should be the
+ *        channel which captures last, or the update event for periodic sampling.
+ * @param htim: pointer to the TIM handle structure
+ * @param Source: the DMA request source which triggers the snapshots
+ * @param Ring: the ring of snapshots
+ * @param Count: the number of snapshots in the ring
+ * @return BUSY if the DMA is used by other peripheral, OK otherwise
+ */
+XPD_ReturnType XPD_TIM_Snapshot_Start_DMA(TIM_HandleType * htim, TIM_BurstSourceType Source,
+        TIM_SnapshotType * Ring, uint16_t Count)
+{
+    TIM_Burst_InitType burst = {
+        .RegIndex  = TIM_CNT_REG_INDEX,
+        .Source    = Source,
+        .Registers = TIM_SNAPSHOT_REGISTERS,
+    };
+
+    return XPD_TIM_Burst_Start_DMA(htim, &burst, Ring, Count * TIM_SNAPSHOT_REGISTERS);
+}
+
+/**
+ * @brief Stops the capture snapshots.
+ * @param htim: pointer to the TIM handle structure
+ * @param Source: the DMA request source which triggers the snapshots
+ */
+void XPD_TIM_Snapshot_Stop_DMA(TIM_HandleType * htim, TIM_BurstSourceType Source)
+{
+    XPD_TIM_Burst_Stop_DMA(htim, Source);
+}
+
+/**
+ * @brief Gets the number of completed snapshots since the start,
+ *        the next snapshot is written into the ring at this count modulo the ring size.
+ * @note  The transfer complete interrupt of the Burst DMA has to be served for the ring wrap counting.
+ * @param htim: pointer to the TIM handle structure
+ * @return The number of completed snapshots
+ */
+uint32_t XPD_TIM_Snapshot_GetCount(TIM_HandleType * htim)
+{
+    DMA_HandleType * hdma = htim->DMA.Burst;
+    uint16_t offset;
+    uint32_t wraps = XPD_DMA_GetPosition(hdma, NULL, &offset);
+
+    /* a partially read snapshot is not counted */
+    return wraps * (hdma->BlockLength / TIM_SNAPSHOT_REGISTERS) + offset / TIM_SNAPSHOT_REGISTERS;
+}
+
+/** @} */
+
+/** @} */
+
+/** @addtogroup TIM_Parallel
+ * @{ */
+
+/** @defgroup TIM_Parallel_Exported_Functions TIM Parallel GPIO Bus Exported Functions
+ *  @brief    Timer update paced DMA transfers between memory and a GPIO port
+ *  @details  The timer's update events pace the transfers of the Update DMA handle,
+ *            providing deterministic parallel bus output or logic capture without CPU load.
+ *            The Update DMA handle has to be initialized with the matching direction
+ *            (memory to peripheral for BSRR or ODR, peripheral to memory for IDR),
+ *            peripheral address increment disabled and the data width of the buffer.
+ *            The counter period sets the bus word rate.
+ * @note      The GPIO ports must be accessible by the selected DMA master.
+ *            On STM32F4 only the DMA2 peripheral port is connected to the AHB1 GPIOs,
+ *            therefore TIM1_UP (DMA2 Stream5 Channel6) or TIM8_UP (DMA2 Stream1 Channel7)
+ *            has to be used.
+ * @{
+ */
+
+/**
+ * @brief Sets up and enables timer update paced DMA transfers to or from the GPIO port.
+ * @param htim: pointer to the TIM handle structure
+ * @param GPIOx: pointer to the GPIO peripheral
+ * @param Register: the GPIO port register to access
+ * @param Address: memory address of the bus data
+ * @param Length: the amount of data to be transferred
+ * @return BUSY if the DMA is used by other peripheral, OK otherwise
+ */
+XPD_ReturnType XPD_TIM_Parallel_Start_DMA(TIM_HandleType * htim, GPIO_TypeDef * GPIOx,
+        TIM_ParallelRegisterType Register, void * Address, uint16_t Length)
+{
+    XPD_ReturnType result;
+    void * port;
+
+    switch (Register)
+    {
+        case TIM_PARALLEL_ODR:
+            port = (void*)&GPIOx->ODR;
+            break;
+        case TIM_PARALLEL_IDR:
+            port = (void*)&GPIOx->IDR;
+            break;
+        case TIM_PARALLEL_BSRR:
+        default:
+            port = (void*)&GPIOx->BSRR;
+            break;
+    }
+
+    /* Set up DMA for transfer */
+    result = XPD_DMA_Start_IT(htim->DMA.Update, port, Address, Length);
+
+    /* If the DMA is currently used, return with error */
+    if (result == XPD_OK)
+    {
+        /* Set the callback owner */
+        htim->DMA.Update->Owner = htim;
+
+        /* Set the DMA transfer callbacks */
+        htim->DMA.Update->Callbacks.Complete = tim_dmaUpdateRedirect;
+#ifdef USE_XPD_DMA_ERROR_DETECT
+        htim->DMA.Update->Callbacks.Error    = tim_dmaErrorRedirect;
+#endif
+
+        /* enable the TIM Update DMA request */
+        TIM_REG_BIT(htim, DIER, UDE) = 1;
+
+        /* enable the counter */
+        XPD_TIM_Counter_Start(htim);
+    }
+
+    return result;
+}
+
+/**
+ * @brief Disables the TIM counter and the paced GPIO DMA transfer.
+ * @param htim: pointer to the TIM handle structure
+ */
+void XPD_TIM_Parallel_Stop_DMA(TIM_HandleType * htim)
+{
+    XPD_TIM_Counter_Stop_DMA(htim);
+}
+
 /** @} */
 
 /** @} */
@@ -802,6 +1122,198 @@ void XPD_TIM_Input_ChannelConfig(TIM_HandleType * htim, TIM_ChannelType Channel,
     }
 }
 
+/**
+ * @brief Starts streaming the captured values of the selected timer channel
+ *        to a circular buffer by DMA, without any CPU load per captured edge.
+ *        The update interrupt is enabled, so the stream can be read from the Update callback.
+ * @note  The channel DMA has to be initialized in circular mode with halfword memory data alignment,
+ *        and the timer update interrupt has to be enabled in the NVIC.
+ * @param htim: pointer to the TIM handle structure
+ * @param Channel: the selected capture channel to use
+ * @param Stream: pointer to the capture stream context
+ * @param Buffer: the circular buffer of the captured values
+ * @param Length: the size of the buffer
+ * @return ERROR if the DMA isn't circular, BUSY if the DMA is used by other peripheral, OK otherwise
+ */
+XPD_ReturnType XPD_TIM_Capture_Start_DMA(TIM_HandleType * htim, TIM_ChannelType Channel,
+        TIM_CaptureStreamType * Stream, uint16_t * Buffer, uint16_t Length)
+{
+    XPD_ReturnType result = XPD_ERROR;
+    DMA_HandleType * hdma = htim->DMA.Channel[Channel];
+
+    if (XPD_DMA_CircularMode(hdma) != 0)
+    {
+        /* Set up DMA for transfer */
+        result = XPD_DMA_Start(hdma, (void*)&((&htim->Inst->CCR1)[Channel]), Buffer, Length);
+
+        /* If the DMA is currently used, return with error */
+        if (result == XPD_OK)
+        {
+            /* Set the callback owner */
+            hdma->Owner = htim;
+
+            /* The timestamps are relative to the start */
+            Stream->Buffer        = Buffer;
+            Stream->Length        = Length;
+            Stream->Index         = 0;
+            Stream->LastValue     = htim->Inst->CNT;
+            Stream->Timestamp     = 0;
+            Stream->Channel       = Channel;
+
+            XPD_TIM_EnableIT(htim, U);
+
+            XPD_TIM_Channel_EnableDMA(htim, Channel);
+
+            XPD_TIM_Channel_Start(htim, Channel);
+        }
+    }
+    return result;
+}
+
+/**
+ * @brief Stops the capture stream of the timer channel (and the timer if required)
+ *        and disables the DMA requests.
+ * @param htim: pointer to the TIM handle structure
+ * @param Stream: pointer to the capture stream context
+ */
+void XPD_TIM_Capture_Stop_DMA(TIM_HandleType * htim, TIM_CaptureStreamType * Stream)
+{
+    XPD_TIM_Channel_DisableDMA(htim, Stream->Channel);
+
+    (void) XPD_DMA_Stop(htim->DMA.Channel[Stream->Channel]);
+
+    XPD_TIM_Channel_Stop(htim, Stream->Channel);
+}
+
+/**
+ * @brief Sets the timestamp base of the stream to the one of a reference stream of the same timer,
+ *        so that their timestamps are comparable (e.g. the edges captured for duty cycle measurement).
+ * @note  The function has to be called after both streams are started, before any read,
+ *        within a counter period from the start of the reference stream.
+ * @param Stream: pointer to the capture stream context to synchronize
+ * @param Reference: pointer to the reference capture stream context
+ */
+void XPD_TIM_Capture_SyncStream(TIM_CaptureStreamType * Stream, const TIM_CaptureStreamType * Reference)
+{
+    Stream->LastValue = Reference->LastValue;
+    Stream->Timestamp = Reference->Timestamp;
+}
+
+/**
+ * @brief Reads the new captures of the stream, extended to 32 bit timestamps.
+ *        The captured values are unwrapped using the counter period.
+ * @note  The stream has to be read before the DMA overwrites the unread captures,
+ *        and at least once per counter period, as the timestamps are only exact
+ *        while the consecutive captures (and the last read capture and the next one)
+ *        are less than a counter period apart.
+ *        The counter period has to fit in the 16 bit capture values.
+ * @param htim: pointer to the TIM handle structure
+ * @param Stream: pointer to the capture stream context
+ * @param Timestamps: the destination of the timestamps in counter ticks
+ * @param Count: the maximal number of timestamps to read
+ * @return The number of read timestamps
+ */
+uint16_t XPD_TIM_Capture_Read(TIM_HandleType * htim, TIM_CaptureStreamType * Stream,
+        uint32_t * Timestamps, uint16_t Count)
+{
+    uint32_t period = htim->Inst->ARR + 1;
+    uint16_t writeIndex = Stream->Length - XPD_DMA_GetStatus(htim->DMA.Channel[Stream->Channel]);
+    uint16_t count;
+
+    if (writeIndex >= Stream->Length)
+    {
+        writeIndex = 0;
+    }
+
+    for (count = 0; (count < Count) && (Stream->Index != writeIndex); count++)
+    {
+        uint16_t value = Stream->Buffer[Stream->Index];
+        uint32_t delta = (value >= Stream->LastValue) ?
+                (uint32_t)(value - Stream->LastValue) : (value + period - Stream->LastValue);
+
+        Stream->Timestamp += delta;
+        Stream->LastValue  = value;
+        Timestamps[count]  = Stream->Timestamp;
+
+        if (++Stream->Index >= Stream->Length)
+        {
+            Stream->Index = 0;
+        }
+    }
+
+    return count;
+}
+
+/**
+ * @brief Calculates the average period of a block of consecutive timestamps.
+ * @param Timestamps: the timestamps of the same input edges
+ * @param Count: the number of timestamps
+ * @return The average period in counter ticks, 0 if the block has less than 2 timestamps
+ */
+uint32_t XPD_TIM_Capture_GetPeriod(const uint32_t * Timestamps, uint16_t Count)
+{
+    uint32_t period = 0;
+
+    if (Count > 1)
+    {
+        period = (Timestamps[Count - 1] - Timestamps[0]) / (Count - 1);
+    }
+    return period;
+}
+
+/**
+ * @brief Calculates the average frequency of a block of consecutive timestamps.
+ * @param htim: pointer to the TIM handle structure
+ * @param Timestamps: the timestamps of the same input edges
+ * @param Count: the number of timestamps
+ * @return The input frequency in Hz, 0 if it cannot be determined
+ */
+uint32_t XPD_TIM_Capture_GetFrequency(TIM_HandleType * htim,
+        const uint32_t * Timestamps, uint16_t Count)
+{
+    uint32_t freq = 0;
+    uint32_t duration = (Count > 1) ? (Timestamps[Count - 1] - Timestamps[0]) : 0;
+
+    if (duration != 0)
+    {
+        uint64_t counterFreq = XPD_TIM_GetClockFreq(htim) / (htim->Inst->PSC + 1);
+
+        /* Rounded to the nearest integer */
+        freq = (uint32_t)((counterFreq * (Count - 1) + (duration / 2)) / duration);
+    }
+    return freq;
+}
+
+/**
+ * @brief Calculates the average duty cycle of a pulse train from the timestamps of its edges.
+ * @note  The edges are typically captured by a pair of channels on the same input,
+ *        one of them set to the opposite polarity and the paired input source.
+ * @param Rising: the timestamps of the active edges
+ * @param Falling: the timestamps of the inactive edges, each following the same indexed active edge
+ * @param Count: the number of pulses
+ * @return The duty cycle in 1/1000 units, 0 if it cannot be determined
+ */
+uint16_t XPD_TIM_Capture_GetDutyCycle(const uint32_t * Rising, const uint32_t * Falling,
+        uint16_t Count)
+{
+    uint16_t duty = 0;
+    uint32_t duration = (Count > 1) ? (Rising[Count - 1] - Rising[0]) : 0;
+
+    if (duration != 0)
+    {
+        uint64_t pulses = 0;
+        uint16_t i;
+
+        /* The last pulse is not part of the measured duration */
+        for (i = 0; i < (Count - 1); i++)
+        {
+            pulses += Falling[i] - Rising[i];
+        }
+        duty = (uint16_t)((pulses * 1000) / duration);
+    }
+    return duty;
+}
+
 /** @} */
 
 /** @} */
@@ -892,6 +1404,1467 @@ void XPD_TIM_SlaveConfig(TIM_HandleType * htim, const TIM_SlaveConfigType * Conf
     }
 }
 
+/**
+ * @brief Starts a group of timers simultaneously with phase offsets. The first member
+ *        is the master, which starts the other members through its TRGO
+ *        in trigger slave mode when its counter is enabled.
+ * @note  The timers and their channels have to be initialized and enabled beforehand.
+ *        The auto-reload preload is enabled on all members, see @ref XPD_TIM_Group_SetPeriod.
+ *        The triggers are resynchronized to the clock of each slave, therefore members
+ *        on a different APB bus than the master may lag by one or two timer clock cycles.
+ * @param Members: array of the group members, starting with the master
+ * @param Count: the number of group members
+ */
+void XPD_TIM_Group_Start(const TIM_GroupMemberType * Members, uint8_t Count)
+{
+    TIM_HandleType * master = Members[0].Timer;
+    TIM_MasterConfigType masterConfig = {
+        .MasterSlaveMode = ENABLE,
+        .MasterTrigger   = TIM_TRGO_ENABLE,
+    };
+    TIM_SlaveConfigType slaveConfig = {
+        .SlaveMode = TIM_SLAVEMODE_TRIGGER,
+    };
+    uint8_t i;
+
+    /* TRGO is the counter enable, the master is delayed to start together with the slaves */
+#ifdef TIM_CR2_MMS2
+    masterConfig.MasterTrigger2 = master->Inst->CR2.b.MMS2;
+#endif
+    XPD_TIM_MasterConfig(master, &masterConfig);
+
+    master->Inst->CNT = Members[0].Phase;
+    TIM_REG_BIT(master,CR1,ARPE) = 1;
+
+    for (i = 1; i < Count; i++)
+    {
+        TIM_HandleType * htim = Members[i].Timer;
+
+        /* Slave counters are enabled by the master's TRGO */
+        XPD_TIM_Counter_Stop(htim);
+        slaveConfig.SlaveTrigger = Members[i].Trigger;
+        XPD_TIM_SlaveConfig(htim, &slaveConfig);
+
+        htim->Inst->CNT = Members[i].Phase;
+        TIM_REG_BIT(htim,CR1,ARPE) = 1;
+    }
+
+    /* Start all timers at once */
+    XPD_TIM_Counter_Start(master);
+}
+
+/**
+ * @brief Stops the counters of a group of timers and disables their trigger slave mode.
+ * @param Members: array of the group members, starting with the master
+ * @param Count: the number of group members
+ */
+void XPD_TIM_Group_Stop(const TIM_GroupMemberType * Members, uint8_t Count)
+{
+    uint8_t i;
+
+    for (i = 0; i < Count; i++)
+    {
+        XPD_TIM_Counter_Stop(Members[i].Timer);
+    }
+    for (i = 1; i < Count; i++)
+    {
+        CLEAR_BIT(Members[i].Timer->Inst->SMCR.w, TIM_SMCR_SMS);
+    }
+}
+
+/**
+ * @brief Sets a new period for a group of running timers. The update events are disabled
+ *        while the preloaded auto-reload registers are written, so all members switch
+ *        to the new period at their next update event, in the same period.
+ * @note  The phase offsets are kept in counter values. The compare values can be modified
+ *        consistently with the period between @ref XPD_TIM_Group_Lock and @ref XPD_TIM_Group_Unlock.
+ * @param Members: array of the group members, started by @ref XPD_TIM_Group_Start
+ * @param Count: the number of group members
+ * @param Period: the new counter period, [1 .. (1 << timer bit size)]
+ */
+void XPD_TIM_Group_SetPeriod(const TIM_GroupMemberType * Members, uint8_t Count, uint32_t Period)
+{
+    uint8_t i;
+
+    XPD_TIM_Group_Lock(Members, Count);
+
+    for (i = 0; i < Count; i++)
+    {
+        Members[i].Timer->Inst->ARR = Period - 1;
+    }
+
+    XPD_TIM_Group_Unlock(Members, Count);
+}
+
+/** @} */
+
+/** @} */
+
+/** @addtogroup TIM_OnePulseMode
+ * @{ */
+
+static void tim_dmaPulseTrainRedirect(void *hdma)
+{
+    TIM_HandleType* htim = (TIM_HandleType*) ((DMA_HandleType*) hdma)->Owner;
+
+    /* The last pulse is running, the counter stops at its end */
+    XPD_TIM_OnePulseMode_Enable(htim);
+    TIM_REG_BIT(htim, DIER, UDE) = 0;
+
+    XPD_SAFE_CALLBACK(htim->Callbacks.Update, htim);
+}
+
+/** @addtogroup TIM_OnePulseMode_Exported_Functions
+ * @{ */
+
+/**
+ * @brief Sets up the timer to generate a single delayed pulse on a channel
+ *        for each trigger, or when the counter is started by software.
+ * @note  The channel output has to be enabled with @ref XPD_TIM_Channel_Enable
+ *        (and @ref XPD_TIM_Output_Enable for advanced timers).
+ * @param htim: pointer to the TIM handle structure
+ * @param Channel: the selected compare channel to use [TIM_CHANNEL_1..TIM_CHANNEL_4]
+ * @param Config: pointer to TIM one pulse setup configuration
+ */
+void XPD_TIM_OnePulse_Init(TIM_HandleType * htim, TIM_ChannelType Channel,
+        const TIM_OnePulse_InitType * Config)
+{
+    TIM_Output_InitType output = {
+        .Mode          = TIM_OUTPUT_PWM2,
+        .Polarity      = Config->Polarity,
+        .IdleState     = RESET,
+        .CompPolarity  = Config->Polarity,
+        .CompIdleState = RESET,
+    };
+    TIM_SlaveConfigType slave = {
+        .SlaveMode    = TIM_SLAVEMODE_TRIGGER,
+        .SlaveTrigger = Config->Trigger,
+        .Polarity     = Config->TriggerPolarity,
+        .Prescaler    = CLK_DIV1,
+        .Filter       = Config->TriggerFilter,
+    };
+    __IO uint32_t * pccmr = (Channel < TIM_CHANNEL_3) ? &htim->Inst->CCMR1.w : &htim->Inst->CCMR2.w;
+
+#if defined(TIM_SMCR_SMS_3) && (TIM_CCMR1_OC1M > 0xFFFF)
+    if (Config->Retriggerable != DISABLE)
+    {
+        /* The trigger restarts the counter during the pulse as well */
+        output.Mode     = TIM_OUTPUT_RETRIGERRABLE_OPM2;
+        slave.SlaveMode = TIM_SLAVEMODE_RESET_TRIGGER;
+    }
+#endif
+
+    XPD_TIM_Counter_Stop(htim);
+    XPD_TIM_OnePulseMode_Enable(htim);
+
+    XPD_TIM_Output_ChannelConfig(htim, Channel, &output);
+
+    /* The output stays inactive until the delay elapses */
+    CLEAR_BIT(*pccmr, TIM_CCMR1_OC1FE << ((Channel & 1) * 8));
+
+    XPD_TIM_SlaveConfig(htim, &slave);
+
+    /* The output is active from the delay until the end of the period */
+    XPD_TIM_Channel_Value(htim, Channel) = Config->Delay;
+    htim->Inst->ARR = Config->Delay + Config->Width - 1;
+
+    XPD_TIM_GenerateEvent(htim, U);
+    XPD_TIM_ClearFlag(htim, U);
+}
+
+/**
+ * @brief Generates a sequence of pulse periods, each with its own period, repetition and
+ *        compare values, without CPU intervention. The first entry is loaded immediately,
+ *        the following ones are written by a burst DMA at each update event.
+ *        The Update callback is called when the last pulse period is started.
+ * @note  The last entry is not generated, it is loaded when the counter stops,
+ *        therefore its compare values set the idle output levels.
+ *        The Burst DMA handle has to be set up with memory to peripheral direction,
+ *        memory increment and halfword data width. The output channels have to be
+ *        configured in PWM mode and enabled beforehand.
+ * @param htim: pointer to the TIM handle structure
+ * @param Pulses: the sequence table of the pulse periods
+ * @param Count: the number of entries in the table (at least 2)
+ * @return BUSY if the DMA is used by other peripheral, OK otherwise
+ */
+XPD_ReturnType XPD_TIM_PulseTrain_Start_DMA(TIM_HandleType * htim,
+        const TIM_PulseType * Pulses, uint16_t Count)
+{
+    XPD_ReturnType result = XPD_BUSY;
+
+    if (XPD_DMA_GetStatus(htim->DMA.Burst) == 0)
+    {
+        TIM_Burst_InitType burst = {
+            .RegIndex  = TIM_ARR_REG_INDEX,
+            .Source    = TIM_BURSTSOURCE_UPDATE,
+            .Registers = sizeof(TIM_PulseType) / sizeof(uint16_t),
+        };
+        uint8_t i;
+
+        XPD_TIM_Counter_Stop(htim);
+        XPD_TIM_OnePulseMode_Disable(htim);
+        TIM_REG_BIT(htim, CR1, ARPE) = 1;
+
+        /* The first entry is preloaded */
+        htim->Inst->ARR = Pulses[0].Reload;
+        htim->Inst->RCR = Pulses[0].Repetition;
+        for (i = 0; i < 4; i++)
+        {
+            (&htim->Inst->CCR1)[i] = Pulses[0].Compare[i];
+        }
+
+        result = XPD_TIM_Burst_Start_DMA(htim, &burst, (void*)&Pulses[1],
+                (Count - 1) * burst.Registers);
+
+        if (result == XPD_OK)
+        {
+            htim->DMA.Burst->Callbacks.Complete = tim_dmaPulseTrainRedirect;
+
+            /* The update loads the first entry, and its DMA request preloads the second one */
+            XPD_TIM_GenerateEvent(htim, U);
+            XPD_TIM_ClearFlag(htim, U);
+
+            XPD_TIM_Counter_Start(htim);
+        }
+    }
+    return result;
+}
+
+/**
+ * @brief Stops the pulse train generation.
+ * @param htim: pointer to the TIM handle structure
+ */
+void XPD_TIM_PulseTrain_Stop_DMA(TIM_HandleType * htim)
+{
+    XPD_TIM_Counter_Stop(htim);
+
+    XPD_TIM_Burst_Stop_DMA(htim, TIM_BURSTSOURCE_UPDATE);
+}
+
+/** @} */
+
+/** @} */
+
+/** @addtogroup TIM_Encoder
+ * @{ */
+
+/** @defgroup TIM_Encoder_Exported_Functions TIM Encoder Exported Functions
+ * @{ */
+
+/**
+ * @brief Initializes the timer as a quadrature encoder counter with a 32-bit position extension.
+ *        If sampling is enabled, the counter value is latched to channel 3 through TRC
+ *        on each TRGO pulse of the sampling timer, which provides the velocity.
+ * @note  The sampling timer has to be configured as master with @ref XPD_TIM_MasterConfig,
+ *        e.g. with TIM_TRGO_UPDATE at the control loop frequency.
+ * @param henc: pointer to the TIM encoder handle structure
+ * @param Config: pointer to TIM encoder setup configuration
+ * @return The result of the timer initialization
+ */
+XPD_ReturnType XPD_TIM_Encoder_Init(TIM_EncoderHandleType * henc, const TIM_Encoder_InitType * Config)
+{
+    TIM_HandleType * htim = &henc->Timer;
+    XPD_ReturnType result;
+    TIM_Counter_InitType counter = {
+        .Prescaler         = 1,
+        .Period            = 0x10000,
+        .Mode              = TIM_COUNTER_UP,
+        .ClockDivision     = CLK_DIV1,
+        .RepetitionCounter = 0,
+    };
+
+    result = XPD_TIM_Init(htim, &counter);
+
+    if (result == XPD_OK)
+    {
+        TIM_Input_InitType input = {
+            .Source    = TIM_INPUT_OWN_TI,
+            .Prescaler = CLK_DIV1,
+            .Filter    = Config->Filter,
+        };
+        TIM_SlaveConfigType slave = {
+            .SlaveMode    = Config->Mode,
+            .SlaveTrigger = Config->SampleTrigger,
+        };
+
+        /* Encoder inputs */
+        input.Polarity = Config->Polarity[0];
+        XPD_TIM_Input_ChannelConfig(htim, TIM_CHANNEL_1, &input);
+        input.Polarity = Config->Polarity[1];
+        XPD_TIM_Input_ChannelConfig(htim, TIM_CHANNEL_2, &input);
+
+        /* Encoder mode, TRGI selects the sampling trigger */
+        if (Config->Sampling == DISABLE)
+        {
+            slave.SlaveTrigger = TIM_TRGI_ITR0;
+        }
+        XPD_TIM_SlaveConfig(htim, &slave);
+
+        /* Channel 3 captures the counter on the sampling trigger */
+        if (Config->Sampling != DISABLE)
+        {
+            input.Source   = TIM_INPUT_TRC;
+            input.Polarity = ACTIVE_HIGH;
+            input.Filter   = 0;
+            XPD_TIM_Input_ChannelConfig(htim, TIM_CHANNEL_3, &input);
+        }
+
+        henc->Extension  = 0;
+        henc->Velocity   = 0;
+        henc->LastSample = 0;
+    }
+
+    return result;
+}
+
+/**
+ * @brief Starts the encoder counting and enables its interrupts.
+ * @note  The timer interrupt(s) have to be enabled in the NVIC and serviced by
+ *        @ref XPD_TIM_Encoder_IRQHandler.
+ * @param henc: pointer to the TIM encoder handle structure
+ */
+void XPD_TIM_Encoder_Start(TIM_EncoderHandleType * henc)
+{
+    TIM_HandleType * htim = &henc->Timer;
+
+    henc->LastSample = htim->Inst->CNT;
+
+    XPD_TIM_ClearFlag(htim, U);
+    XPD_TIM_EnableIT(htim, U);
+
+    /* Sampling is active if channel 3 is connected to TRC */
+    if (htim->Inst->CCMR2.IC.C3S == TIM_INPUT_TRC)
+    {
+        XPD_TIM_Channel_ClearFlag(htim, TIM_CHANNEL_3);
+        XPD_TIM_EnableIT(htim, CC3);
+        XPD_TIM_Channel_Start(htim, TIM_CHANNEL_3);
+    }
+
+    XPD_TIM_Channel_Start(htim, TIM_CHANNEL_1);
+    XPD_TIM_Channel_Start(htim, TIM_CHANNEL_2);
+}
+
+/**
+ * @brief Stops the encoder counting and disables its interrupts.
+ * @param henc: pointer to the TIM encoder handle structure
+ */
+void XPD_TIM_Encoder_Stop(TIM_EncoderHandleType * henc)
+{
+    TIM_HandleType * htim = &henc->Timer;
+
+    XPD_TIM_DisableIT(htim, U);
+    XPD_TIM_DisableIT(htim, CC3);
+
+    XPD_TIM_Channel_Stop(htim, TIM_CHANNEL_3);
+    XPD_TIM_Channel_Stop(htim, TIM_CHANNEL_1);
+    XPD_TIM_Channel_Stop(htim, TIM_CHANNEL_2);
+}
+
+/**
+ * @brief Returns the extended encoder position, taking into account
+ *        a counter overflow which hasn't been serviced yet.
+ * @param henc: pointer to the TIM encoder handle structure
+ * @return The 32-bit encoder position in encoder counts
+ */
+int32_t XPD_TIM_Encoder_GetPosition(TIM_EncoderHandleType * henc)
+{
+    TIM_HandleType * htim = &henc->Timer;
+    int32_t extension;
+    uint32_t pending;
+    uint16_t count;
+
+    /* Repeat until the extension, the overflow flag and the counter are consistent */
+    do {
+        extension = henc->Extension;
+        pending   = XPD_TIM_GetFlag(htim, U);
+        count     = htim->Inst->CNT;
+    } while ((extension != henc->Extension) || (pending != XPD_TIM_GetFlag(htim, U)));
+
+    if (pending != 0)
+    {
+        /* The counter direction of the overflow is determined by the counter half */
+        if (count < 0x8000)
+        {
+            extension += 0x10000;
+        }
+        else
+        {
+            extension -= 0x10000;
+        }
+    }
+
+    return extension + count;
+}
+
+/**
+ * @brief Sets the current encoder position.
+ * @param henc: pointer to the TIM encoder handle structure
+ * @param Position: the new 32-bit encoder position
+ */
+void XPD_TIM_Encoder_SetPosition(TIM_EncoderHandleType * henc, int32_t Position)
+{
+    TIM_HandleType * htim = &henc->Timer;
+    uint16_t count = htim->Inst->CNT;
+
+    htim->Inst->CNT = (uint16_t)Position;
+    XPD_TIM_ClearFlag(htim, U);
+
+    /* Shift the last sample to keep the next velocity measurement valid */
+    henc->LastSample += (uint16_t)Position - count;
+    henc->Extension   = Position - (uint16_t)Position;
+}
+
+/**
+ * @brief TIM encoder interrupt handler that extends the position on counter overflows
+ *        and calculates the velocity on sampling triggers.
+ *        The ChannelEvent callback is called after each velocity sampling.
+ * @note  For timers with separate update and capture/compare interrupt lines
+ *        this handler has to be called from both of them.
+ * @param henc: pointer to the TIM encoder handle structure
+ */
+void XPD_TIM_Encoder_IRQHandler(TIM_EncoderHandleType * henc)
+{
+    XPD_PROFILE_BEGIN();
+
+    TIM_HandleType * htim = &henc->Timer;
+
+    /* Counter overflow */
+    if ((XPD_TIM_GetFlag(htim, U) != 0) && (TIM_REG_BIT(htim, DIER, UIE) != 0))
+    {
+        XPD_TIM_ClearFlag(htim, U);
+
+        /* The counter direction of the overflow is determined by the counter half */
+        if (htim->Inst->CNT < 0x8000)
+        {
+            henc->Extension += 0x10000;
+        }
+        else
+        {
+            henc->Extension -= 0x10000;
+        }
+
+        XPD_SAFE_CALLBACK(htim->Callbacks.Update, htim);
+    }
+
+    /* Velocity sampling */
+    if ((XPD_TIM_GetFlag(htim, CC3) != 0) && (TIM_REG_BIT(htim, DIER, CC3IE) != 0))
+    {
+        /* Reading the captured value clears the flag */
+        uint16_t sample = htim->Inst->CCR3;
+
+        henc->Velocity   = (int16_t)(sample - henc->LastSample);
+        henc->LastSample = sample;
+
+        htim->ActiveChannel = TIM_CHANNEL_3;
+        XPD_SAFE_CALLBACK(htim->Callbacks.ChannelEvent, htim);
+    }
+
+    XPD_PROFILE_END();
+}
+
+/** @} */
+
+/** @} */
+
+/** @addtogroup TIM_Motor
+ * @{ */
+
+/* 6-step commutation table: the PWM driven and the low-side switched phase of each step */
+static const TIM_ChannelType tim_motorSteps[6][2] = {
+        { TIM_CHANNEL_1, TIM_CHANNEL_2 },
+        { TIM_CHANNEL_1, TIM_CHANNEL_3 },
+        { TIM_CHANNEL_2, TIM_CHANNEL_3 },
+        { TIM_CHANNEL_2, TIM_CHANNEL_1 },
+        { TIM_CHANNEL_3, TIM_CHANNEL_1 },
+        { TIM_CHANNEL_3, TIM_CHANNEL_2 },
+};
+
+/** @defgroup TIM_Motor_Exported_Functions TIM Motor Control PWM Exported Functions
+ * @{ */
+
+/**
+ * @brief Initializes an advanced timer for center-aligned 3-phase complementary PWM.
+ *        Channels 1-3 drive the phases with the configured dead time,
+ *        channel 4 provides the ADC injected trigger on TRGO.
+ * @note  Select the timer's TRGO as the ADC injected external trigger.
+ *        The burst DMA has to be initialized in normal mode with halfword data alignment.
+ * @param hmot: pointer to the TIM motor handle structure
+ * @param Config: pointer to TIM motor PWM setup configuration
+ */
+void XPD_TIM_Motor_Init(TIM_MotorHandleType * hmot, const TIM_Motor_InitType * Config)
+{
+    TIM_HandleType * htim = &hmot->Timer;
+    TIM_Counter_InitType counter = {
+        .Prescaler         = Config->Prescaler,
+        .Period            = Config->Period,
+        .Mode              = TIM_COUNTER_CENTERALIGNED1,
+        .ClockDivision     = CLK_DIV1,
+        .RepetitionCounter = Config->RepetitionCounter,
+    };
+    TIM_Output_InitType output = {
+        .Mode          = TIM_OUTPUT_PWM1,
+        .Polarity      = Config->Polarity,
+        .IdleState     = RESET,
+        .CompPolarity  = Config->CompPolarity,
+        .CompIdleState = RESET,
+    };
+    TIM_Output_DriveType drive = {
+        .DeadCounts      = Config->DeadCounts,
+        .AutomaticOutput = DISABLE,
+        .IdleOffState    = ENABLE,
+        .RunOffState     = ENABLE,
+    };
+    TIM_MasterConfigType master = {
+        .MasterSlaveMode = DISABLE,
+        .MasterTrigger   = TIM_TRGO_OC4REF,
+#ifdef TIM_CR2_MMS2
+        .MasterTrigger2  = TIM_TRGO2_OC4REF,
+#endif
+    };
+    TIM_ChannelType ch;
+
+    (void) XPD_TIM_Init(htim, &counter);
+
+    /* Phase outputs start with zero duty */
+    for (ch = TIM_CHANNEL_1; ch <= TIM_CHANNEL_3; ch++)
+    {
+        XPD_TIM_Output_ChannelConfig(htim, ch, &output);
+        XPD_TIM_Channel_Value(htim, ch) = 0;
+        hmot->Duty[ch] = 0;
+    }
+
+    /* OC4REF rises when the counter passes the trigger point upwards */
+    output.Mode = TIM_OUTPUT_PWM2;
+    XPD_TIM_Output_ChannelConfig(htim, TIM_CHANNEL_4, &output);
+    XPD_TIM_Channel_Value(htim, TIM_CHANNEL_4) = Config->TriggerPoint;
+
+    XPD_TIM_Output_DriveConfig(htim, &drive);
+    XPD_TIM_MasterConfig(htim, &master);
+    XPD_TIM_Output_CommutationConfig(htim, Config->ComSource);
+}
+
+/**
+ * @brief Starts the motor PWM generation and enables the main output.
+ *        In 6-step operation only the ADC trigger channel is started,
+ *        the phase outputs are enabled by @ref XPD_TIM_Motor_SetStep.
+ * @param hmot: pointer to the TIM motor handle structure
+ */
+void XPD_TIM_Motor_Start(TIM_MotorHandleType * hmot)
+{
+    TIM_HandleType * htim = &hmot->Timer;
+
+    if (TIM_REG_BIT(htim, CR2, CCPC) == 0)
+    {
+        XPD_TIM_Channel_Start(htim, TIM_CHANNEL_1);
+        XPD_TIM_Channel_Start(htim, TIM_CHANNEL_2);
+        XPD_TIM_Channel_Start(htim, TIM_CHANNEL_3);
+    }
+    XPD_TIM_Channel_Start(htim, TIM_CHANNEL_4);
+
+    XPD_TIM_Output_Enable(htim);
+}
+
+/**
+ * @brief Disables the main output and stops the motor PWM generation.
+ * @param hmot: pointer to the TIM motor handle structure
+ */
+void XPD_TIM_Motor_Stop(TIM_MotorHandleType * hmot)
+{
+    TIM_HandleType * htim = &hmot->Timer;
+
+    XPD_TIM_Output_Disable(htim);
+
+    XPD_TIM_Burst_Stop_DMA(htim, TIM_BURSTSOURCE_UPDATE);
+
+    XPD_TIM_Channel_Stop(htim, TIM_CHANNEL_1);
+    XPD_TIM_Channel_Stop(htim, TIM_CHANNEL_2);
+    XPD_TIM_Channel_Stop(htim, TIM_CHANNEL_3);
+    XPD_TIM_Channel_Stop(htim, TIM_CHANNEL_4);
+}
+
+/**
+ * @brief Sets the duties of the three phases at once. The compare values are
+ *        written to CCR1-3 in a single DMA burst after the next update event,
+ *        so all phases take effect together on the following update.
+ *        The Update callback is called when the burst is complete.
+ * @param hmot: pointer to the TIM motor handle structure
+ * @param Duty1: the compare value of phase 1
+ * @param Duty2: the compare value of phase 2
+ * @param Duty3: the compare value of phase 3
+ * @return BUSY if the previous duty update is still pending, OK otherwise
+ */
+XPD_ReturnType XPD_TIM_Motor_SetDuty(TIM_MotorHandleType * hmot,
+        uint16_t Duty1, uint16_t Duty2, uint16_t Duty3)
+{
+    XPD_ReturnType result = XPD_BUSY;
+
+    /* Buffer can only be modified when the previous burst is done */
+    if (XPD_DMA_GetStatus(hmot->Timer.DMA.Burst) == 0)
+    {
+        TIM_Burst_InitType burst = {
+            .RegIndex = TIM_CCR1_REG_INDEX,
+            .Source   = TIM_BURSTSOURCE_UPDATE,
+        };
+
+        hmot->Duty[0] = Duty1;
+        hmot->Duty[1] = Duty2;
+        hmot->Duty[2] = Duty3;
+
+        result = XPD_TIM_Burst_Start_DMA(&hmot->Timer, &burst, hmot->Duty, 3);
+    }
+
+    return result;
+}
+
+/**
+ * @brief Preloads the output configuration of a 6-step commutation step:
+ *        one phase is driven by PWM, one phase has its low-side switch on,
+ *        and the third phase is floating. The new step is applied on the next
+ *        commutation event, which is generated here for software commutation.
+ * @param hmot: pointer to the TIM motor handle structure
+ * @param Step: the commutation step [0..5]
+ */
+void XPD_TIM_Motor_SetStep(TIM_MotorHandleType * hmot, uint8_t Step)
+{
+    TIM_HandleType * htim = &hmot->Timer;
+    TIM_ChannelType pwm = tim_motorSteps[Step][0], low = tim_motorSteps[Step][1];
+    uint32_t ccer, ccmr1, ccmr2;
+    uint32_t modes[3] = {TIM_OUTPUT_FORCEDINACTIVE, TIM_OUTPUT_FORCEDINACTIVE, TIM_OUTPUT_FORCEDINACTIVE};
+
+    modes[pwm] = TIM_OUTPUT_PWM1;
+
+    /* Floating phase has both outputs disabled */
+    ccer = htim->Inst->CCER.w & ~((TIM_CCER_CC1E | TIM_CCER_CC1NE) * 0x111);
+    ccer |= (TIM_CCER_CC1E | TIM_CCER_CC1NE) << (4 * pwm);
+    ccer |= (TIM_CCER_CC1E | TIM_CCER_CC1NE) << (4 * low);
+
+    ccmr1 = htim->Inst->CCMR1.w & ~(TIM_CCMR1_OC1M | TIM_CCMR1_OC2M);
+    ccmr1 |= (modes[0] << TIM_CCMR1_OC1M_Pos) | (modes[1] << TIM_CCMR1_OC2M_Pos);
+    ccmr2 = htim->Inst->CCMR2.w & ~TIM_CCMR2_OC3M;
+    ccmr2 |= modes[2] << TIM_CCMR2_OC3M_Pos;
+
+    /* Preloaded until the commutation event */
+    htim->Inst->CCMR1.w = ccmr1;
+    htim->Inst->CCMR2.w = ccmr2;
+    htim->Inst->CCER.w  = ccer;
+
+    if (TIM_REG_BIT(htim, CR2, CCUS) == 0)
+    {
+        XPD_TIM_GenerateEvent(htim, COM);
+    }
+}
+
+/** @} */
+
+/** @} */
+
+/** @addtogroup TIM_Scheduler
+ * @{ */
+
+/* inserts the software timer into the queue in deadline order */
+static void tim_schedulerInsert(TIM_SchedulerHandleType * hsch, TIM_SoftTimerType * Timer)
+{
+    TIM_SoftTimerType ** pprev = &hsch->Queue;
+
+    /* Timers with the same deadline expire in their start order */
+    while ((*pprev != NULL) && ((int32_t)((*pprev)->Deadline - Timer->Deadline) <= 0))
+    {
+        pprev = &(*pprev)->Next;
+    }
+    Timer->Next = *pprev;
+    *pprev = Timer;
+}
+
+/* removes the software timer from the queue if it's scheduled */
+static void tim_schedulerRemove(TIM_SchedulerHandleType * hsch, TIM_SoftTimerType * Timer)
+{
+    TIM_SoftTimerType ** pprev = &hsch->Queue;
+
+    while ((*pprev != NULL) && (*pprev != Timer))
+    {
+        pprev = &(*pprev)->Next;
+    }
+    if (*pprev != NULL)
+    {
+        *pprev = Timer->Next;
+    }
+}
+
+/* sets the compare interrupt to the nearest deadline */
+static void tim_schedulerArm(TIM_SchedulerHandleType * hsch)
+{
+    TIM_HandleType * htim = &hsch->Timer;
+
+    if (hsch->Queue != NULL)
+    {
+        htim->Inst->CCR1 = hsch->Queue->Deadline;
+
+        /* If the deadline has already passed, the match is generated by software */
+        if ((int32_t)(hsch->Queue->Deadline - htim->Inst->CNT) <= 0)
+        {
+            XPD_TIM_GenerateEvent(htim, CC1);
+        }
+        XPD_TIM_EnableIT(htim, CC1);
+    }
+}
+
+/** @defgroup TIM_Scheduler_Exported_Functions TIM Software Timer Scheduler Exported Functions
+ * @{ */
+
+/**
+ * @brief Initializes the timer as a free-running microsecond counter for software timers.
+ *        The expirations are scheduled with the channel 1 compare interrupt
+ *        set to the nearest deadline, therefore no periodic tick is used.
+ * @note  Only 32-bit timers (e.g. TIM2, TIM5) are suitable, with an input clock of
+ *        an integer multiple of 1 MHz. The timer interrupt has to be enabled in the NVIC
+ *        and serviced by @ref XPD_TIM_Scheduler_IRQHandler.
+ * @param hsch: pointer to the TIM scheduler handle structure
+ */
+void XPD_TIM_Scheduler_Init(TIM_SchedulerHandleType * hsch)
+{
+    TIM_HandleType * htim = &hsch->Timer;
+    TIM_Counter_InitType counter = {
+        .Period            = 0, /* overflows to the full 32-bit range */
+        .Mode              = TIM_COUNTER_UP,
+        .ClockDivision     = CLK_DIV1,
+        .RepetitionCounter = 0,
+    };
+    TIM_Output_InitType output = {
+        .Mode              = TIM_OUTPUT_TIMING,
+        .Polarity          = ACTIVE_HIGH,
+        .IdleState         = RESET,
+        .CompPolarity      = ACTIVE_HIGH,
+        .CompIdleState     = RESET,
+    };
+
+    hsch->Queue = NULL;
+
+    /* microsecond ticks */
+    counter.Prescaler = XPD_TIM_GetClockFreq(htim) / 1000000;
+    (void) XPD_TIM_Init(htim, &counter);
+
+    XPD_TIM_Output_ChannelConfig(htim, TIM_CHANNEL_1, &output);
+
+    XPD_TIM_Counter_Start(htim);
+}
+
+/**
+ * @brief Stops the scheduler timer, all scheduled software timers are discarded.
+ * @param hsch: pointer to the TIM scheduler handle structure
+ */
+void XPD_TIM_Scheduler_Deinit(TIM_SchedulerHandleType * hsch)
+{
+    XPD_TIM_DisableIT(&hsch->Timer, CC1);
+
+    hsch->Queue = NULL;
+
+    (void) XPD_TIM_Deinit(&hsch->Timer);
+}
+
+/**
+ * @brief Starts (or restarts) a software timer.
+ * @param hsch: pointer to the TIM scheduler handle structure
+ * @param Timer: pointer to the software timer
+ * @param Delay: the time until the first expiration in microseconds
+ */
+void XPD_TIM_SoftTimer_Start(TIM_SchedulerHandleType * hsch, TIM_SoftTimerType * Timer, uint32_t Delay)
+{
+    TIM_HandleType * htim = &hsch->Timer;
+
+    /* The queue is only modified by the interrupt handler otherwise */
+    XPD_TIM_DisableIT(htim, CC1);
+
+    tim_schedulerRemove(hsch, Timer);
+
+    Timer->Deadline = htim->Inst->CNT + Delay;
+    tim_schedulerInsert(hsch, Timer);
+
+    tim_schedulerArm(hsch);
+}
+
+/**
+ * @brief Stops a software timer.
+ * @param hsch: pointer to the TIM scheduler handle structure
+ * @param Timer: pointer to the software timer
+ */
+void XPD_TIM_SoftTimer_Stop(TIM_SchedulerHandleType * hsch, TIM_SoftTimerType * Timer)
+{
+    XPD_TIM_DisableIT(&hsch->Timer, CC1);
+
+    tim_schedulerRemove(hsch, Timer);
+
+    tim_schedulerArm(hsch);
+}
+
+/**
+ * @brief TIM scheduler interrupt handler that calls the callbacks of the expired software timers
+ *        and reschedules the periodic ones.
+ * @param hsch: pointer to the TIM scheduler handle structure
+ */
+void XPD_TIM_Scheduler_IRQHandler(TIM_SchedulerHandleType * hsch)
+{
+    XPD_PROFILE_BEGIN();
+
+    TIM_HandleType * htim = &hsch->Timer;
+
+    if ((XPD_TIM_GetFlag(htim, CC1) != 0) && (TIM_REG_BIT(htim, DIER, CC1IE) != 0))
+    {
+        TIM_SoftTimerType * timer;
+
+        XPD_TIM_ClearFlag(htim, CC1);
+
+        /* Process all expired timers */
+        while (((timer = hsch->Queue) != NULL)
+            && ((int32_t)(timer->Deadline - htim->Inst->CNT) <= 0))
+        {
+            hsch->Queue = timer->Next;
+
+            /* Periodic timers are rescheduled without accumulating latency */
+            if (timer->Period != 0)
+            {
+                timer->Deadline += timer->Period;
+                tim_schedulerInsert(hsch, timer);
+            }
+
+            XPD_SAFE_CALLBACK(timer->Callback, timer);
+        }
+
+        if (hsch->Queue == NULL)
+        {
+            XPD_TIM_DisableIT(htim, CC1);
+        }
+        else
+        {
+            tim_schedulerArm(hsch);
+        }
+    }
+
+    XPD_PROFILE_END();
+}
+
+/** @} */
+
+/** @} */
+
+/** @addtogroup TIM_Debounce
+ * @{ */
+
+/* The attached inputs by EXTI line */
+static TIM_DebounceInputType * tim_debounceInputs[16];
+
+/* queues an edge event of the input, and notifies the user */
+static void tim_debounceReport(TIM_DebounceInputType * Input, uint8_t Level, uint32_t Timestamp)
+{
+    TIM_DebounceHandleType * hdeb = Input->Owner;
+    uint16_t head = hdeb->Queue.Head;
+    uint16_t next = head + 1;
+
+    if (next >= hdeb->Queue.Size)
+    {
+        next = 0;
+    }
+
+    Input->Level = Level;
+
+    if (next != hdeb->Queue.Tail)
+    {
+        hdeb->Queue.Buffer[head].Timestamp = Timestamp;
+        hdeb->Queue.Buffer[head].Line      = Input->Pin;
+        hdeb->Queue.Buffer[head].Level     = Level;
+        hdeb->Queue.Head = next;
+    }
+    else
+    {
+        hdeb->Queue.Dropped++;
+    }
+
+    XPD_SAFE_CALLBACK(hdeb->Callback, hdeb);
+}
+
+/* EXTI edge of an attached input: report, then ignore the line for the holdoff period */
+static void tim_debounceEdge(uint32_t Line)
+{
+    TIM_DebounceInputType * input = tim_debounceInputs[Line];
+    TIM_DebounceHandleType * hdeb = input->Owner;
+    uint32_t timestamp = XPD_TIM_Scheduler_GetTime(hdeb->Scheduler);
+    uint8_t level = XPD_GPIO_ReadPin(input->GPIOx, Line);
+
+    XPD_EXTI_DisableIT(Line);
+
+    /* A bounce which returned to the reported level before being sampled is dropped */
+    if (level != input->Level)
+    {
+        tim_debounceReport(input, level, timestamp);
+    }
+
+    XPD_TIM_SoftTimer_Start(hdeb->Scheduler, &input->Holdoff, hdeb->Holdoff);
+}
+
+/* end of the holdoff period: report a missed change, or listen to the line again */
+static void tim_debounceHoldoffEnd(void * Timer)
+{
+    TIM_DebounceInputType * input = (TIM_DebounceInputType *)Timer;
+    TIM_DebounceHandleType * hdeb = input->Owner;
+    uint8_t level = XPD_GPIO_ReadPin(input->GPIOx, input->Pin);
+
+    XPD_EXTI_ClearFlag(input->Pin);
+
+    if (level != input->Level)
+    {
+        /* The input settled at the other level during the holdoff */
+        tim_debounceReport(input, level, XPD_TIM_Scheduler_GetTime(hdeb->Scheduler));
+
+        XPD_TIM_SoftTimer_Start(hdeb->Scheduler, &input->Holdoff, hdeb->Holdoff);
+    }
+    else
+    {
+        XPD_EXTI_EnableIT(input->Pin);
+    }
+}
+
+/** @defgroup TIM_Debounce_Exported_Functions TIM Debounced Inputs Exported Functions
+ *  @brief    Debouncing and edge timestamping of EXTI inputs
+ *  @details  Each edge interrupt of an input is timestamped with the scheduler time,
+ *            then the line's interrupt is masked for the holdoff period, so bouncing contacts
+ *            generate a single interrupt. At the end of the holdoff the input is sampled again,
+ *            and a missed change is reported with the sampling time.
+ * @note      The EXTI and the scheduler timer interrupts have to be configured
+ *            with the same NVIC priority.
+ * @{
+ */
+
+/**
+ * @brief Initializes the debouncer handle with an empty event queue.
+ * @param hdeb: pointer to the TIM debouncer handle structure
+ */
+void XPD_TIM_Debounce_Init(TIM_DebounceHandleType * hdeb)
+{
+    hdeb->Queue.Head    = 0;
+    hdeb->Queue.Tail    = 0;
+    hdeb->Queue.Dropped = 0;
+}
+
+/**
+ * @brief Attaches an input pin to the debouncer.
+ * @note  The pin has to be initialized in GPIO_MODE_EXTI with the edges to report
+ *        (typically EDGE_RISING_FALLING) and REACTION_IT. The EXTI callback of the line
+ *        is taken over by the debouncer.
+ * @param hdeb: pointer to the TIM debouncer handle structure
+ * @param Input: pointer to the debounced input
+ */
+void XPD_TIM_Debounce_Attach(TIM_DebounceHandleType * hdeb, TIM_DebounceInputType * Input)
+{
+    XPD_EXTI_DisableIT(Input->Pin);
+
+    Input->Owner            = hdeb;
+    Input->Holdoff.Period   = 0;
+    Input->Holdoff.Callback = tim_debounceHoldoffEnd;
+    Input->Level            = XPD_GPIO_ReadPin(Input->GPIOx, Input->Pin);
+
+    tim_debounceInputs[Input->Pin] = Input;
+    XPD_EXTI_Callbacks[Input->Pin] = tim_debounceEdge;
+
+    XPD_EXTI_ClearFlag(Input->Pin);
+    XPD_EXTI_EnableIT(Input->Pin);
+}
+
+/**
+ * @brief Detaches an input pin from the debouncer, and disables its EXTI interrupt.
+ * @param hdeb: pointer to the TIM debouncer handle structure
+ * @param Input: pointer to the debounced input
+ */
+void XPD_TIM_Debounce_Detach(TIM_DebounceHandleType * hdeb, TIM_DebounceInputType * Input)
+{
+    XPD_EXTI_DisableIT(Input->Pin);
+
+    XPD_TIM_SoftTimer_Stop(hdeb->Scheduler, &Input->Holdoff);
+
+    XPD_EXTI_Callbacks[Input->Pin] = NULL;
+    tim_debounceInputs[Input->Pin] = NULL;
+}
+
+/**
+ * @brief Removes the oldest edge event from the queue.
+ * @param hdeb: pointer to the TIM debouncer handle structure
+ * @param Event: pointer to the event to fill
+ * @return ERROR if the queue is empty, OK otherwise
+ */
+XPD_ReturnType XPD_TIM_Debounce_GetEvent(TIM_DebounceHandleType * hdeb, TIM_DebounceEventType * Event)
+{
+    uint16_t tail = hdeb->Queue.Tail;
+
+    if (tail == hdeb->Queue.Head)
+    {
+        return XPD_ERROR;
+    }
+
+    *Event = hdeb->Queue.Buffer[tail];
+
+    if (++tail >= hdeb->Queue.Size)
+    {
+        tail = 0;
+    }
+    hdeb->Queue.Tail = tail;
+
+    return XPD_OK;
+}
+
+/** @} */
+
+/** @} */
+
+/** @addtogroup TIM_Serial
+ * @{ */
+
+/* Start bit, 8 data bits and stop bit */
+#define TIM_SERIAL_FRAME_BITS       10
+
+/* The bit time has 8 fractional bits */
+#define TIM_SERIAL_FRACTION_BITS    8
+
+/* encodes the next characters to BSRR words, as many as fit in the buffer */
+static uint16_t tim_serialTxEncode(TIM_SerialTxType * htx)
+{
+    uint32_t set = 1UL << htx->Pin, reset = set << 16;
+    uint32_t * word = htx->Buffer;
+    uint16_t count = (htx->Size - 1) / TIM_SERIAL_FRAME_BITS;
+    uint16_t i;
+
+    if (count > htx->Remaining)
+    {
+        count = htx->Remaining;
+    }
+
+    for (i = 0; i < count; i++)
+    {
+        uint32_t frame = ((uint32_t)*(htx->Data++) << 1) | (1 << (TIM_SERIAL_FRAME_BITS - 1));
+        uint8_t bit;
+
+        for (bit = 0; bit < TIM_SERIAL_FRAME_BITS; bit++, frame >>= 1)
+        {
+            *(word++) = ((frame & 1) != 0) ? set : reset;
+        }
+    }
+    htx->Remaining -= count;
+
+    /* An extra idle bit time keeps the stop bit complete
+     * when the restarted DMA serves a pending request right away */
+    *(word++) = set;
+
+    return word - htx->Buffer;
+}
+
+static void tim_serialTxRedirect(void * hdma)
+{
+    TIM_SerialTxType * htx = (TIM_SerialTxType*) ((DMA_HandleType*) hdma)->Owner;
+
+    if (htx->Remaining > 0)
+    {
+        (void) XPD_DMA_Start_IT(htx->Timer->DMA.Update,
+                (void*)&htx->GPIOx->BSRR, htx->Buffer, tim_serialTxEncode(htx));
+    }
+    else
+    {
+        TIM_REG_BIT(htx->Timer, DIER, UDE) = 0;
+        htx->Busy = 0;
+
+        XPD_SAFE_CALLBACK(htx->Complete, htx);
+    }
+}
+
+#ifdef USE_XPD_DMA_ERROR_DETECT
+static void tim_serialTxErrorRedirect(void * hdma)
+{
+    TIM_SerialTxType * htx = (TIM_SerialTxType*) ((DMA_HandleType*) hdma)->Owner;
+
+    /* The rest of the transmission is dropped */
+    htx->Remaining = 0;
+    tim_serialTxRedirect(hdma);
+}
+#endif
+
+/* samples the bits of the current frame which are centered before the time,
+ * returns the number of received characters */
+static uint16_t tim_serialRxSample(TIM_SerialRxType * hrx, uint32_t Time)
+{
+    uint16_t received = 0;
+
+    while (hrx->Bit > 0)
+    {
+        uint32_t center = hrx->FrameStart + (((2 * hrx->Bit - 1) * hrx->BitTime)
+                >> (TIM_SERIAL_FRACTION_BITS + 1));
+
+        if ((int32_t)(Time - center) < 0)
+        {
+            break;
+        }
+
+        hrx->Shift |= (uint16_t)hrx->Level << (hrx->Bit - 1);
+
+        if (hrx->Bit < TIM_SERIAL_FRAME_BITS)
+        {
+            hrx->Bit++;
+        }
+        else
+        {
+            /* Low start bit and high stop bit are required */
+            if (((hrx->Shift & 1) != 0) || ((hrx->Shift >> (TIM_SERIAL_FRAME_BITS - 1)) == 0)
+                    || (XPD_Ring_PutByte(hrx->Ring, (uint8_t)(hrx->Shift >> 1)) != XPD_OK))
+            {
+                hrx->Errors++;
+            }
+            else
+            {
+                received++;
+            }
+            hrx->Bit = 0;
+        }
+    }
+    return received;
+}
+
+/** @defgroup TIM_Serial_Exported_Functions TIM Software Serial Ports Exported Functions
+ *  @brief    8N1 asynchronous serial ports on timer paced DMA transfers
+ *  @details  The transmitter writes a precomputed bit pattern to the GPIO port's BSRR
+ *            by Update DMA requests of a dedicated timer, so each bit costs no CPU time,
+ *            only the encoding of each chunk of the buffer.
+ *            The receiver streams the timestamps of both edges of the RX input to a
+ *            circular buffer by the channel DMA, and the frames are decoded from the edge
+ *            timestamps in blocks. A single free-running timer can serve a receiver
+ *            on each of its channels.
+ * @note      The GPIO access restrictions of @ref TIM_Parallel_Exported_Functions apply
+ *            to the transmitter DMA.
+ * @{
+ */
+
+/**
+ * @brief Initializes the transmitter's timer to the bit rate, and drives the TX output idle.
+ * @note  The TX pin has to be configured as push-pull output,
+ *        and the Update DMA of the timer has to be initialized in memory to peripheral
+ *        direction, with word data alignment, without peripheral address increment.
+ * @param htx: pointer to the TIM software serial transmitter handle structure
+ * @param Baudrate: the bit rate of the port
+ * @return ERROR if the buffer is too small or the bit rate is too high, OK otherwise
+ */
+XPD_ReturnType XPD_TIM_SerialTx_Init(TIM_SerialTxType * htx, uint32_t Baudrate)
+{
+    uint32_t clock = XPD_TIM_GetClockFreq(htx->Timer);
+    uint32_t prescaler = (clock / Baudrate) / 0x10000 + 1;
+    TIM_Counter_InitType counter = {
+        .Prescaler         = prescaler,
+        .Mode              = TIM_COUNTER_UP,
+        .ClockDivision     = CLK_DIV1,
+        .RepetitionCounter = 0,
+    };
+
+    counter.Period = XPD_DIV_ROUND(clock / prescaler, Baudrate);
+
+    if ((htx->Size <= TIM_SERIAL_FRAME_BITS) || (counter.Period < 2))
+    {
+        return XPD_ERROR;
+    }
+
+    htx->Remaining = 0;
+    htx->Busy      = 0;
+
+    XPD_GPIO_WritePin(htx->GPIOx, htx->Pin, 1);
+
+    (void) XPD_TIM_Init(htx->Timer, &counter);
+
+    XPD_TIM_Counter_Start(htx->Timer);
+
+    return XPD_OK;
+}
+
+/**
+ * @brief Starts the transmission of the data. The buffer is refilled
+ *        in the DMA complete interrupt, until all characters are sent.
+ * @param htx: pointer to the TIM software serial transmitter handle structure
+ * @param Data: pointer to the characters to send
+ * @param Length: the number of characters to send
+ * @return BUSY if a transmission is in progress or the DMA is used by other peripheral, OK otherwise
+ */
+XPD_ReturnType XPD_TIM_SerialTx_Start_DMA(TIM_SerialTxType * htx, const uint8_t * Data, uint16_t Length)
+{
+    XPD_ReturnType result = XPD_BUSY;
+    DMA_HandleType * hdma = htx->Timer->DMA.Update;
+
+    if (htx->Busy == 0)
+    {
+        htx->Data      = Data;
+        htx->Remaining = Length;
+
+        /* Set up DMA for transfer */
+        result = XPD_DMA_Start_IT(hdma, (void*)&htx->GPIOx->BSRR, htx->Buffer, tim_serialTxEncode(htx));
+
+        if (result == XPD_OK)
+        {
+            htx->Busy = 1;
+
+            /* Set the callback owner */
+            hdma->Owner = htx;
+
+            /* Set the DMA transfer callbacks */
+            hdma->Callbacks.Complete     = tim_serialTxRedirect;
+            hdma->Callbacks.HalfComplete = NULL;
+#ifdef USE_XPD_DMA_ERROR_DETECT
+            hdma->Callbacks.Error        = tim_serialTxErrorRedirect;
+#endif
+
+            /* enable the TIM Update DMA request */
+            TIM_REG_BIT(htx->Timer, DIER, UDE) = 1;
+        }
+    }
+    return result;
+}
+
+/**
+ * @brief Aborts the ongoing transmission, and drives the TX output idle.
+ * @param htx: pointer to the TIM software serial transmitter handle structure
+ */
+void XPD_TIM_SerialTx_Stop_DMA(TIM_SerialTxType * htx)
+{
+    TIM_REG_BIT(htx->Timer, DIER, UDE) = 0;
+
+    XPD_DMA_Stop_IT(htx->Timer->DMA.Update);
+
+    htx->Remaining = 0;
+    htx->Busy      = 0;
+
+    XPD_GPIO_WritePin(htx->GPIOx, htx->Pin, 1);
+}
+
+/**
+ * @brief Starts the edge capture of the receiver's input.
+ * @note  The timer has to be initialized and started as a free-running up-counter
+ *        with a period fitting in 16 bits, and a bit time of at least 8 counter ticks. The channel DMA has to be initialized
+ *        in circular mode with halfword memory data alignment. The RX line has to be idle (high)
+ *        when the receiver is started.
+ * @param hrx: pointer to the TIM software serial receiver handle structure
+ * @param Baudrate: the bit rate of the port
+ * @return ERROR if the DMA isn't circular, BUSY if the DMA is used by other peripheral, OK otherwise
+ */
+XPD_ReturnType XPD_TIM_SerialRx_Start_DMA(TIM_SerialRxType * hrx, uint32_t Baudrate)
+{
+    TIM_HandleType * htim = hrx->Timer;
+    uint32_t freq = XPD_TIM_GetClockFreq(htim) / (htim->Inst->PSC + 1);
+    TIM_Input_InitType input = {
+        .Source    = TIM_INPUT_OWN_TI,
+        .Polarity  = ACTIVE_HIGH,
+        .Prescaler = CLK_DIV1,
+        .Filter    = 0,
+    };
+    hrx->BitTime = ((freq / Baudrate) << TIM_SERIAL_FRACTION_BITS)
+                 + (((freq % Baudrate) << TIM_SERIAL_FRACTION_BITS) / Baudrate);
+    hrx->Bit     = 0;
+    hrx->Level   = 1;
+    hrx->Time    = 0;
+    hrx->Errors  = 0;
+
+    XPD_TIM_Input_ChannelConfig(htim, hrx->Channel, &input);
+
+    /* Both edges are captured */
+    htim->Inst->CCER.w |= (TIM_CCER_CC1P | TIM_CCER_CC1NP) << (4 * hrx->Channel);
+
+    hrx->Count = htim->Inst->CNT;
+
+    return XPD_TIM_Capture_Start_DMA(htim, hrx->Channel, &hrx->Stream, hrx->Buffer, hrx->Size);
+}
+
+/**
+ * @brief Stops the edge capture of the receiver's input.
+ * @param hrx: pointer to the TIM software serial receiver handle structure
+ */
+void XPD_TIM_SerialRx_Stop_DMA(TIM_SerialRxType * hrx)
+{
+    XPD_TIM_Capture_Stop_DMA(hrx->Timer, &hrx->Stream);
+}
+
+/**
+ * @brief Decodes the captured edges of the receiver to characters in the receive ring.
+ *        The last frame is completed by the current time, so the characters ending with
+ *        high data bits are received without waiting for the next edge.
+ * @note  The function has to be called at least once per counter period
+ *        (e.g. from the timer's Update callback), and before the capture buffer fills up.
+ * @param hrx: pointer to the TIM software serial receiver handle structure
+ * @return The number of received characters
+ */
+uint16_t XPD_TIM_SerialRx_Process(TIM_SerialRxType * hrx)
+{
+    TIM_HandleType * htim = hrx->Timer;
+    TIM_CaptureStreamType * stream = &hrx->Stream;
+    uint32_t period = htim->Inst->ARR + 1;
+    uint16_t writeIndex = stream->Length - XPD_DMA_GetStatus(htim->DMA.Channel[hrx->Channel]);
+    uint16_t count = htim->Inst->CNT;
+    uint16_t received = 0;
+    uint32_t now;
+
+    if (writeIndex >= stream->Length)
+    {
+        writeIndex = 0;
+    }
+
+    /* The captures read before the counter all happened since the last processing */
+    now = hrx->Time + ((count >= hrx->Count) ?
+            (uint32_t)(count - hrx->Count) : (count + period - hrx->Count));
+
+    while (stream->Index != writeIndex)
+    {
+        uint16_t value = stream->Buffer[stream->Index];
+        uint32_t edge = now - ((count >= value) ?
+                (uint32_t)(count - value) : (count + period - value));
+
+        if (++stream->Index >= stream->Length)
+        {
+            stream->Index = 0;
+        }
+
+        /* The bits before the edge have the previous level */
+        received += tim_serialRxSample(hrx, edge);
+
+        hrx->Level ^= 1;
+
+        /* Falling edge of the start bit */
+        if ((hrx->Bit == 0) && (hrx->Level == 0))
+        {
+            hrx->FrameStart = edge;
+            hrx->Shift      = 0;
+            hrx->Bit        = 1;
+        }
+    }
+
+    /* The remaining bits of the frame have the current level */
+    received += tim_serialRxSample(hrx, now);
+
+    hrx->Time  = now;
+    hrx->Count = count;
+
+    return received;
+}
+
+/** @} */
+
+/** @} */
+
+/** @addtogroup TIM_Latency
+ * @{ */
+
+/** @defgroup TIM_Latency_Exported_Functions TIM Interrupt Latency Measurement Exported Functions
+ *  @brief    Event to interrupt handler entry latency measurement
+ *  @details  The toggling output of a timer channel drives a pin, which is wired back to
+ *            the EXTI line (or other interrupt source) under test. The handler of the
+ *            interrupt records the elapsed time since the stimulus edge as its first action,
+ *            and schedules the next edge. The edge time is either the output compare value,
+ *            or the input capture of the looped back signal on another channel of the timer,
+ *            which also includes the pin delays. The latency is measured in timer counts,
+ *            which are core clock cycles when the timer clock equals HCLK and its prescaler is 0.
+ *            Each measured interrupt priority level needs its own stimulus channel and structure.
+ * @{
+ */
+
+/**
+ * @brief Starts the stimulus generation and clears the latency statistics.
+ * @note  The counter of the timer has to be running with 0xFFFF period, the stimulus pin
+ *        has to be configured as timer alternate function and the interrupt under test
+ *        has to be triggered on both edges. The main output of advanced timers
+ *        has to be enabled by @ref XPD_TIM_Output_Enable.
+ * @param hlat: pointer to the TIM latency measurement structure
+ */
+void XPD_TIM_Latency_Start(TIM_LatencyType * hlat)
+{
+    TIM_HandleType * htim = hlat->Timer;
+    const TIM_Output_InitType output = {
+        .Mode      = TIM_OUTPUT_TOGGLE,
+        .Polarity  = ACTIVE_HIGH,
+        .IdleState = RESET,
+    };
+    uint32_t i;
+
+    hlat->Count = 0;
+    hlat->Min   = 0xFFFF;
+    hlat->Max   = 0;
+    hlat->Total = 0;
+    for (i = 0; i < hlat->Bins; i++)
+    {
+        hlat->Histogram[i] = 0;
+    }
+
+    XPD_TIM_Output_ChannelConfig(htim, hlat->Output, &output);
+
+    if (hlat->Capture != hlat->Output)
+    {
+        const TIM_Input_InitType input = {
+            .Source    = TIM_INPUT_OWN_TI,
+            .Polarity  = ACTIVE_HIGH,
+            .Prescaler = CLK_DIV1,
+            .Filter    = 0,
+        };
+        XPD_TIM_Input_ChannelConfig(htim, hlat->Capture, &input);
+
+        /* Both edges are captured */
+        htim->Inst->CCER.w |= (TIM_CCER_CC1P | TIM_CCER_CC1NP) << (4 * hlat->Capture);
+
+        XPD_TIM_Channel_Enable(htim, hlat->Capture);
+    }
+
+    XPD_TIM_Channel_Value(htim, hlat->Output) = (uint16_t)(htim->Inst->CNT + hlat->Interval);
+    XPD_TIM_Channel_Enable(htim, hlat->Output);
+}
+
+/**
+ * @brief Stops the stimulus generation.
+ * @param hlat: pointer to the TIM latency measurement structure
+ */
+void XPD_TIM_Latency_Stop(TIM_LatencyType * hlat)
+{
+    XPD_TIM_Channel_Disable(hlat->Timer, hlat->Output);
+
+    if (hlat->Capture != hlat->Output)
+    {
+        XPD_TIM_Channel_Disable(hlat->Timer, hlat->Capture);
+    }
+}
+
+/**
+ * @brief Records the latency of the current interrupt since the stimulus edge,
+ *        and schedules the next stimulus edge.
+ * @note  This function shall be called at the beginning of the measured interrupt handler.
+ *        The stimulus interval has to be longer than the worst-case latency.
+ * @param hlat: pointer to the TIM latency measurement structure
+ * @return The measured latency in timer counts
+ */
+uint16_t XPD_TIM_Latency_Record(TIM_LatencyType * hlat)
+{
+    TIM_HandleType * htim = hlat->Timer;
+    uint16_t now = htim->Inst->CNT;
+    uint16_t latency = now - (uint16_t)XPD_TIM_Channel_Value(htim, hlat->Capture);
+
+    XPD_TIM_Channel_Value(htim, hlat->Output) = (uint16_t)(now + hlat->Interval);
+
+    hlat->Count++;
+    hlat->Total += latency;
+    if (latency < hlat->Min)
+    {
+        hlat->Min = latency;
+    }
+    if (latency > hlat->Max)
+    {
+        hlat->Max = latency;
+    }
+
+    if (hlat->Bins > 0)
+    {
+        uint32_t bin = latency / hlat->BinWidth;
+
+        if (bin >= hlat->Bins)
+        {
+            bin = hlat->Bins - 1;
+        }
+        hlat->Histogram[bin]++;
+    }
+    return latency;
+}
+
 /** @} */
 
 /** @} */
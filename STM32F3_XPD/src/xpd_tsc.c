@@ -0,0 +1,348 @@
+/**
+  ******************************************************************************
+  * @file    xpd_tsc.c
+  * @author  Benedek Kupper
+  * @version V0.1
+  * @date    2018-01-20
+  * @brief   STM32 eXtensible Peripheral Drivers Touch Sensing Controller Module
+  *
+  *  This file is part of STM32_XPD.
+  *
+  *  STM32_XPD is free software: you can redistribute it and/or modify
+  *  it under the terms of the GNU General Public License as published by
+  *  the Free Software Foundation, either version 3 of the License, or
+  *  (at your option) any later version.
+  *
+  *  STM32_XPD is distributed in the hope that it will be useful,
+  *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with STM32_XPD.  If not, see <http://www.gnu.org/licenses/>.
+  */
+#include "xpd_tsc.h"
+
+#if defined(USE_XPD_TSC) && defined(TSC)
+
+/** @addtogroup TSC
+ * @{ */
+
+#define TSC_GROUPS              8
+#define TSC_GROUP_IOS           4
+
+/* One I/O of each group is used by the sampling capacitor */
+#define TSC_BANKS               (TSC_GROUP_IOS - 1)
+
+/* The filtered and baseline values have 4 fractional bits */
+#define TSC_FRACTION_BITS       4
+
+#define TSC_IOGCSR_GxS_Pos      16
+
+/* Determines the groups which have a selected channel */
+static uint32_t tsc_getGroups(uint32_t Channels)
+{
+    uint32_t groups = 0;
+    uint32_t g;
+
+    for (g = 0; g < TSC_GROUPS; g++)
+    {
+        if (((Channels >> (g * TSC_GROUP_IOS)) & ((1 << TSC_GROUP_IOS) - 1)) != 0)
+        {
+            groups |= 1 << g;
+        }
+    }
+    return groups;
+}
+
+/* Starts the acquisition of the current bank */
+static void tsc_bankStart(TSC_HandleType * htsc)
+{
+    uint32_t channels = htsc->Banks[htsc->Bank];
+
+    htsc->Inst->IOCCR.w  = channels;
+    htsc->Inst->IOGCSR.w = tsc_getGroups(channels);
+
+    htsc->Inst->ICR.w = TSC_ICR_EOAIC | TSC_ICR_MCEIC;
+    htsc->Inst->CR.w |= TSC_CR_START;
+}
+
+/* Filters the new count of the sensor, tracks the baseline and detects the touch state */
+static uint8_t tsc_sensorUpdate(TSC_HandleType * htsc, TSC_SensorType * Sensor, uint16_t Count)
+{
+    uint32_t value = (uint32_t)Count << TSC_FRACTION_BITS;
+    uint32_t delta;
+    uint8_t touched = Sensor->Touched;
+
+    Sensor->Raw = Count;
+
+    /* First acquisition, the sensor is assumed to be untouched */
+    if (Sensor->Baseline == 0)
+    {
+        Sensor->Filtered = Sensor->Baseline = value;
+    }
+    else if (value > Sensor->Filtered)
+    {
+        Sensor->Filtered += (value - Sensor->Filtered) >> htsc->FilterShift;
+    }
+    else
+    {
+        Sensor->Filtered -= (Sensor->Filtered - value) >> htsc->FilterShift;
+    }
+
+    /* The touch increases the electrode capacitance, which decreases the count */
+    delta = (Sensor->Baseline > Sensor->Filtered) ?
+            (Sensor->Baseline - Sensor->Filtered) >> TSC_FRACTION_BITS : 0;
+    Sensor->Delta = delta;
+
+    if (touched == 0)
+    {
+        touched = delta >= Sensor->Threshold;
+    }
+    else
+    {
+        touched = (delta + Sensor->Hysteresis) >= Sensor->Threshold;
+    }
+
+    /* The baseline only follows the slow environmental changes while untouched,
+     * it recovers immediately from a count increase */
+    if (touched == 0)
+    {
+        if (Sensor->Filtered > Sensor->Baseline)
+        {
+            Sensor->Baseline = Sensor->Filtered;
+        }
+        else
+        {
+            Sensor->Baseline -= (Sensor->Baseline - Sensor->Filtered) >> htsc->BaselineShift;
+        }
+    }
+
+    if (touched != Sensor->Touched)
+    {
+        Sensor->Touched = touched;
+        return 1;
+    }
+    return 0;
+}
+
+/** @defgroup TSC_Exported_Functions TSC Exported Functions
+ * @{ */
+
+/**
+ * @brief Initializes the TSC peripheral using the setup configuration.
+ * @note  The unused I/Os are driven low, discharging the capacitors between acquisitions.
+ * @param htsc: pointer to the TSC handle structure
+ * @param Config: TSC setup configuration
+ */
+void XPD_TSC_Init(TSC_HandleType * htsc, const TSC_InitType * Config)
+{
+    uint32_t cr;
+
+    /* enable clock */
+    XPD_SAFE_CALLBACK(htsc->ClockCtrl, ENABLE);
+
+    cr = ((uint32_t)(Config->PulseHigh - 1) << TSC_CR_CTPH_Pos)
+       | ((uint32_t)(Config->PulseLow  - 1) << TSC_CR_CTPL_Pos)
+       | ((uint32_t)Config->Prescaler << TSC_CR_PGPSC_Pos)
+       | ((uint32_t)Config->MaxCount  << TSC_CR_MCV_Pos)
+       | TSC_CR_TSCE;
+
+    if (Config->SpreadSpectrum > 0)
+    {
+        cr |= ((uint32_t)(Config->SpreadSpectrum - 1) << TSC_CR_SSD_Pos) | TSC_CR_SSE;
+    }
+
+    htsc->Inst->CR.w   = cr;
+    htsc->Inst->IER.w  = 0;
+    htsc->Inst->ICR.w  = TSC_ICR_EOAIC | TSC_ICR_MCEIC;
+
+    htsc->FilterShift   = Config->FilterShift;
+    htsc->BaselineShift = Config->BaselineShift;
+    htsc->SensorCount   = 0;
+    htsc->BankCount     = 0;
+
+    /* Dependencies initialization */
+    XPD_SAFE_CALLBACK(htsc->Callbacks.DepInit, htsc);
+}
+
+/**
+ * @brief Restores the TSC peripheral to its default inactive state.
+ * @param htsc: pointer to the TSC handle structure
+ */
+void XPD_TSC_Deinit(TSC_HandleType * htsc)
+{
+    XPD_TSC_Stop_IT(htsc);
+
+    htsc->Inst->CR.w = 0;
+
+    /* Deinitialize peripheral dependencies */
+    XPD_SAFE_CALLBACK(htsc->Callbacks.DepDeinit, htsc);
+
+    /* disable clock */
+    XPD_SAFE_CALLBACK(htsc->ClockCtrl, DISABLE);
+}
+
+/**
+ * @brief Sets up the sampling capacitor I/Os and the sensor channels,
+ *        and distributes the sensors to parallel acquisition banks.
+ * @note  The baselines are restarted from the first acquisition.
+ * @param htsc: pointer to the TSC handle structure
+ * @param Samplings: the sampling capacitor I/Os (a combination of @ref TSC_GROUP_IO values)
+ * @param Sensors: the sensors array, which is updated by each scan
+ * @param Count: the number of sensors
+ * @return ERROR if a sensor I/O is invalid, or a group has no free I/O for it, OK otherwise
+ */
+XPD_ReturnType XPD_TSC_SensorConfig(TSC_HandleType * htsc, uint32_t Samplings,
+        TSC_SensorType * Sensors, uint8_t Count)
+{
+    uint8_t groupSensors[TSC_GROUPS] = { 0 };
+    uint32_t channels = 0;
+    uint32_t i;
+
+    htsc->BankCount = 0;
+    for (i = 0; i < TSC_BANKS; i++)
+    {
+        htsc->Banks[i] = 0;
+    }
+
+    for (i = 0; i < Count; i++)
+    {
+        TSC_SensorType * sensor = &Sensors[i];
+        uint32_t io, group = sensor->Group - 1;
+
+        if ((group >= TSC_GROUPS) || ((uint32_t)(sensor->IO - 1) >= TSC_GROUP_IOS)
+                || (groupSensors[group] >= TSC_BANKS))
+        {
+            return XPD_ERROR;
+        }
+        io = TSC_GROUP_IO(sensor->Group, sensor->IO);
+        if (((Samplings & io) != 0) || ((channels & io) != 0))
+        {
+            return XPD_ERROR;
+        }
+
+        /* Each bank gets at most one channel of the group */
+        sensor->Bank = groupSensors[group]++;
+        htsc->Banks[sensor->Bank] |= io;
+        channels |= io;
+
+        if (htsc->BankCount <= sensor->Bank)
+        {
+            htsc->BankCount = sensor->Bank + 1;
+        }
+
+        sensor->Filtered = sensor->Baseline = 0;
+        sensor->Delta    = 0;
+        sensor->Touched  = 0;
+    }
+
+    htsc->Sensors     = Sensors;
+    htsc->SensorCount = Count;
+
+    /* The Schmitt trigger hysteresis of the used I/Os is disabled to reduce the leakage */
+    htsc->Inst->IOHCR.w  = ~(channels | Samplings);
+    htsc->Inst->IOASCR.w = 0;
+    htsc->Inst->IOSCR.w  = Samplings;
+
+    return XPD_OK;
+}
+
+/**
+ * @brief Starts a scan of all sensors. The banks are acquired one after the other
+ *        in the interrupt handler, and the Scan callback is called at the end.
+ * @param htsc: pointer to the TSC handle structure
+ * @return ERROR if there are no sensors, BUSY if a scan is in progress, OK if started
+ */
+XPD_ReturnType XPD_TSC_Start_IT(TSC_HandleType * htsc)
+{
+    if (htsc->BankCount == 0)
+    {
+        return XPD_ERROR;
+    }
+    if (XPD_TSC_IsScanning(htsc))
+    {
+        return XPD_BUSY;
+    }
+
+    htsc->Bank = 0;
+    tsc_bankStart(htsc);
+
+    htsc->Inst->IER.w = TSC_IER_EOAIE | TSC_IER_MCEIE;
+
+    return XPD_OK;
+}
+
+/**
+ * @brief Cancels the ongoing scan.
+ * @param htsc: pointer to the TSC handle structure
+ */
+void XPD_TSC_Stop_IT(TSC_HandleType * htsc)
+{
+    htsc->Inst->IER.w = 0;
+    htsc->Inst->CR.w &= ~TSC_CR_START;
+    htsc->Inst->ICR.w = TSC_ICR_EOAIC | TSC_ICR_MCEIC;
+}
+
+/**
+ * @brief TSC interrupt handler that processes the acquired bank counts,
+ *        continues the scan and provides the sensor callbacks.
+ * @param htsc: pointer to the TSC handle structure
+ */
+void XPD_TSC_IRQHandler(TSC_HandleType * htsc)
+{
+    uint32_t isr = htsc->Inst->ISR.w;
+
+    XPD_PROFILE_BEGIN();
+
+    htsc->Inst->ICR.w = isr & (TSC_ICR_EOAIC | TSC_ICR_MCEIC);
+
+    if ((isr & TSC_ISR_EOAF) != 0)
+    {
+        /* The groups which reached the max count have no valid result */
+        uint32_t completed = htsc->Inst->IOGCSR.w >> TSC_IOGCSR_GxS_Pos;
+        uint8_t changed = 0;
+        uint32_t i;
+
+        for (i = 0; i < htsc->SensorCount; i++)
+        {
+            TSC_SensorType * sensor = &htsc->Sensors[i];
+            uint32_t group = sensor->Group - 1;
+
+            if ((sensor->Bank == htsc->Bank) && ((completed & (1 << group)) != 0))
+            {
+                changed |= tsc_sensorUpdate(htsc, sensor,
+                        htsc->Inst->IOGXCR[group] & TSC_IOGXCR_CNT);
+            }
+        }
+
+        if ((isr & TSC_ISR_MCEF) != 0)
+        {
+            XPD_SAFE_CALLBACK(htsc->Callbacks.Error, htsc);
+        }
+        if (changed != 0)
+        {
+            XPD_SAFE_CALLBACK(htsc->Callbacks.Change, htsc);
+        }
+
+        /* Continue with the next bank, or finish the scan */
+        if (++htsc->Bank < htsc->BankCount)
+        {
+            tsc_bankStart(htsc);
+        }
+        else
+        {
+            htsc->Inst->IER.w = 0;
+
+            XPD_SAFE_CALLBACK(htsc->Callbacks.Scan, htsc);
+        }
+    }
+
+    XPD_PROFILE_END();
+}
+
+/** @} */
+
+/** @} */
+
+#endif /* USE_XPD_TSC */
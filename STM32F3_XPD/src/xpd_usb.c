@@ -85,6 +85,18 @@ do { if (USB_REG_BIT(husb,EP[EP_ID],BIT_NAME) != 0) USB_TOGGLE(EP_ID, BIT_NAME);
 
 #define USB_PMA_ALLOCATION(SIZE)    (SIZE)
 
+/* Packet memory size in the USB local address space */
+#ifndef USB_PMA_SIZE
+#ifdef USB_BCDR_BCDEN
+#define USB_PMA_SIZE                1024
+#else
+#define USB_PMA_SIZE                512
+#endif
+#endif
+
+/* Buffer descriptor table entry size in the USB local address space */
+#define USB_BDT_ENTRY_SIZE          8
+
 static const uint16_t usb_epTypeRemap[4] = {
     USB_EP_CONTROL,
     USB_EP_ISOCHRONOUS,
@@ -97,23 +109,38 @@ static void usb_writePMA(uint8_t * sourceBuf, uint16_t pmaAddress, uint16_t data
 {
     USB_PacketAddressType * dest = (USB_PacketAddressType *)USB_PMAADDR + (pmaAddress / 2);
 
-    /* Check if input data is aligned */
+    /* Word aligned input is loaded by words, each split to two PMA half-words */
+    if ((((uint32_t)sourceBuf) & 3) == 0)
+    {
+        const uint32_t * source = (const uint32_t *)sourceBuf;
+
+        for (; dataCount >= 8; dataCount -= 8, source += 2, dest += 4)
+        {
+            uint32_t word0 = source[0], word1 = source[1];
+
+            dest[0] = (uint16_t)word0;
+            dest[1] = (uint16_t)(word0 >> 16);
+            dest[2] = (uint16_t)word1;
+            dest[3] = (uint16_t)(word1 >> 16);
+        }
+        sourceBuf = (uint8_t *)source;
+    }
+
+    /* Check if the remaining input data is aligned */
     if ((((uint32_t)sourceBuf) & 1) == 0)
     {
-        uint16_t i;
+        const uint16_t * source = (const uint16_t *)sourceBuf;
 
-        for (i = 0; i < ((dataCount + 1) / 2); i++)
+        for (dataCount = (dataCount + 1) / 2; dataCount > 0; dataCount--)
         {
-            dest[i] = ((uint16_t*)sourceBuf)[i];
+            *dest++ = *source++;
         }
     }
     else
     {
-        dataCount = (dataCount + 1) / 2;
-        while (dataCount--)
+        for (dataCount = (dataCount + 1) / 2; dataCount > 0; dataCount--)
         {
-            *dest = ((uint16_t)(sourceBuf[1]) << 8) | (uint16_t)(sourceBuf[0]);
-            dest++;
+            *dest++ = ((uint16_t)(sourceBuf[1]) << 8) | (uint16_t)(sourceBuf[0]);
             sourceBuf += 2;
         }
     }
@@ -124,27 +151,46 @@ static void usb_readPMA(uint8_t * destBuf, uint16_t pmaAddress, uint16_t dataCou
 {
     USB_PacketAddressType * source = (USB_PacketAddressType *)USB_PMAADDR + (pmaAddress / 2);
 
-    /* Check if input data is aligned */
+    /* Word aligned output is stored by words, each merged from two PMA half-words */
+    if ((((uint32_t)destBuf) & 3) == 0)
+    {
+        uint32_t * dest = (uint32_t *)destBuf;
+
+        for (; dataCount >= 8; dataCount -= 8, source += 4, dest += 2)
+        {
+            dest[0] = (uint16_t)source[0] | ((uint32_t)source[1] << 16);
+            dest[1] = (uint16_t)source[2] | ((uint32_t)source[3] << 16);
+        }
+        destBuf = (uint8_t *)dest;
+    }
+
+    /* Check if the remaining output data is aligned */
     if ((((uint32_t)destBuf) & 1) == 0)
     {
-        uint16_t i;
-        for (i = 0; i < ((dataCount + 1) / 2); i++)
+        uint16_t * dest = (uint16_t *)destBuf;
+
+        for (; dataCount >= 2; dataCount -= 2)
         {
-            ((uint16_t*)destBuf)[i] = source[i];
+            *dest++ = *source++;
         }
+        destBuf = (uint8_t *)dest;
     }
     else
     {
-        dataCount = (dataCount + 1) / 2;
-        while (dataCount--)
+        for (; dataCount >= 2; dataCount -= 2)
         {
-            *destBuf = *source;
-            destBuf++;
-            *destBuf = (*source) >> 8;
-            destBuf++;
-            source++;
+            uint16_t halfWord = *source++;
+
+            *destBuf++ = halfWord;
+            *destBuf++ = halfWord >> 8;
         }
     }
+
+    /* The last odd byte is copied without overwriting the following data */
+    if (dataCount > 0)
+    {
+        *destBuf = *source;
+    }
 }
 
 /* Setting RX_COUNT requires special conversion */
@@ -172,6 +218,41 @@ static uint16_t usb_epConvertRxCount(uint16_t count)
     return blocks;
 }
 
+/* Packet memory size of one endpoint buffer, the reception buffers are allocated in 2 or 32 byte blocks */
+static uint16_t usb_pmaBufferSize(USB_HandleType * husb, USB_EndPointHandleType * ep)
+{
+    if (EP_IS_OUT(husb,ep) && (ep->MaxPacketSize > 62))
+    {
+        return (ep->MaxPacketSize + 31) & ~31;
+    }
+    else
+    {
+        return (ep->MaxPacketSize + 1) & ~1;
+    }
+}
+
+/* Number of endpoint registers used by the configured endpoints (including EP0) */
+static uint8_t usb_pmaRegCount(USB_HandleType * husb)
+{
+    uint8_t i, count = 1;
+
+    for (i = 1; i < USB_ENDPOINT_COUNT; i++)
+    {
+        USB_EndPointHandleType * in  = &husb->EP.IN[i];
+        USB_EndPointHandleType * out = &husb->EP.OUT[i];
+
+        count += ((in->MaxPacketSize > 0) ? 1 : 0) + ((out->MaxPacketSize > 0) ? 1 : 0);
+
+        /* One EPnR manages both single buffered IN-OUT endpoints of the same type */
+        if ((in->MaxPacketSize > 0) && (out->MaxPacketSize > 0) && (in->Type == out->Type) &&
+            (in->DoubleBuffer == DISABLE) && (out->DoubleBuffer == DISABLE))
+        {
+            count--;
+        }
+    }
+    return count;
+}
+
 /* Handle OUT EP transfer */
 static void usb_epReceive(USB_HandleType * husb, USB_EndPointHandleType * ep, uint16_t Length)
 {
@@ -179,21 +260,18 @@ static void usb_epReceive(USB_HandleType * husb, USB_EndPointHandleType * ep, ui
     if (Length > ep->MaxPacketSize)
     {
         ep->Transfer.length = Length - ep->MaxPacketSize;
-        Length = usb_epConvertRxCount(ep->MaxPacketSize);
+        ep->PacketLength = ep->MaxPacketSize;
     }
     else
     {
         ep->Transfer.length = 0;
-        Length = usb_epConvertRxCount(Length);
+        ep->PacketLength = Length;
     }
+    Length = usb_epConvertRxCount(ep->PacketLength);
 
-    /* Double buffering */
-    if ((ep->DoubleBuffer == ENABLE) && ((USB->EP[ep->RegId].w & USB_EP_DTOG_RX) != 0))
-    {
-        /* Set endpoint buffer 0 count */
-        USB_EP_BDT[ep->RegId].TX_COUNT = Length;
-    }
-    else
+    /* Double buffered endpoints keep both buffers at max packet size,
+     * since the next packet can arrive before this function is called */
+    if (ep->DoubleBuffer == DISABLE)
     {
         /*Set RX buffer count */
         USB_EP_BDT[ep->RegId].RX_COUNT = Length;
@@ -270,6 +348,7 @@ XPD_ReturnType XPD_USB_Init(USB_HandleType * husb, const USB_InitType * Config)
         husb->EP.IN[i].Stalled         = husb->EP.OUT[i].Stalled         = FALSE;
         husb->EP.IN[i].RegId           = husb->EP.OUT[i].RegId           = 0;
         husb->EP.IN[i].DoubleBuffer    = husb->EP.OUT[i].DoubleBuffer    = DISABLE;
+        husb->EP.IN[i].PendingZLP      = FALSE;
     }
 
     /* Initialize peripheral device */
@@ -435,6 +514,102 @@ void XPD_USB_EP_BufferInit(USB_HandleType * husb, uint8_t EpAddress, uint16_t Bu
     }
 }
 
+/**
+ * @brief Allocates the packet memory for the endpoints of the configuration
+ *        after device initialization and before starting the USB operation.
+ *        The buffer descriptor table is sized for the endpoint registers in use,
+ *        each endpoint gets one packet buffer (isochronous endpoints are double-buffered),
+ *        then the bulk endpoints are set to double-buffered in order while the space allows.
+ * @note  This function replaces the manual allocation by @ref XPD_USB_EP_BufferInit.
+ * @param husb: pointer to the USB handle structure
+ * @param Endpoints: the endpoints of the configuration (except EP0)
+ * @param Count: the number of endpoints
+ * @return ERROR if the endpoints are invalid or don't fit in the packet memory, OK if success
+ */
+XPD_ReturnType XPD_USB_EP_PmaAlloc(USB_HandleType * husb,
+        const USB_EndPointConfigType * Endpoints, uint8_t Count)
+{
+    USB_EndPointHandleType * ep;
+    uint8_t i, epAddress;
+    uint16_t used = 2 * USB_MAX_PACKET_SIZE, size;
+
+    for (i = 1; i < USB_ENDPOINT_COUNT; i++)
+    {
+        husb->EP.IN[i].MaxPacketSize = husb->EP.OUT[i].MaxPacketSize = 0;
+        husb->EP.IN[i].DoubleBuffer  = husb->EP.OUT[i].DoubleBuffer  = DISABLE;
+    }
+
+    /* The minimal buffers of the endpoints */
+    for (i = 0; i < Count; i++)
+    {
+        epAddress = Endpoints[i].Address;
+
+        if (((epAddress & 0x7F) == 0) || ((epAddress & 0x7F) >= USB_ENDPOINT_COUNT) ||
+            (Endpoints[i].MaxPacketSize == 0))
+        {
+            return XPD_ERROR;
+        }
+        ep = USB_GET_EP_AT(husb, epAddress);
+
+        /* Each endpoint can only be listed once */
+        if (ep->MaxPacketSize > 0)
+        {
+            return XPD_ERROR;
+        }
+        ep->MaxPacketSize = Endpoints[i].MaxPacketSize;
+        ep->Type          = Endpoints[i].Type;
+        ep->DoubleBuffer  = (ep->Type == USB_EP_TYPE_ISOCHRONOUS) ? ENABLE : DISABLE;
+
+        size  = usb_pmaBufferSize(husb, ep);
+        used += (ep->DoubleBuffer == ENABLE) ? 2 * size : size;
+    }
+
+    if ((usb_pmaRegCount(husb) > USB_ENDPOINT_COUNT) ||
+        ((usb_pmaRegCount(husb) * USB_BDT_ENTRY_SIZE + used) > USB_PMA_SIZE))
+    {
+        return XPD_ERROR;
+    }
+
+    /* Set the bulk endpoints to double-buffered while there is space,
+     * which can take a separate EPnR from the IN-OUT pair */
+    for (i = 0; i < Count; i++)
+    {
+        if (Endpoints[i].Type == USB_EP_TYPE_BULK)
+        {
+            epAddress = Endpoints[i].Address;
+            ep = USB_GET_EP_AT(husb, epAddress);
+            size = usb_pmaBufferSize(husb, ep);
+
+            ep->DoubleBuffer = ENABLE;
+            if ((usb_pmaRegCount(husb) <= USB_ENDPOINT_COUNT) &&
+                ((usb_pmaRegCount(husb) * USB_BDT_ENTRY_SIZE + used + size) <= USB_PMA_SIZE))
+            {
+                used += size;
+            }
+            else
+            {
+                ep->DoubleBuffer = DISABLE;
+            }
+        }
+    }
+
+    /* Lay out the buffers after the descriptor table and the EP0 buffers */
+    husb->BdtSize   = usb_pmaRegCount(husb) * USB_BDT_ENTRY_SIZE;
+    husb->PmaOffset = USB_PMA_ALLOCATION(2 * USB_MAX_PACKET_SIZE);
+
+    for (i = 0; i < Count; i++)
+    {
+        epAddress = Endpoints[i].Address;
+        ep = USB_GET_EP_AT(husb, epAddress);
+        size = usb_pmaBufferSize(husb, ep);
+
+        ep->PacketAddress = husb->PmaOffset;
+        husb->PmaOffset  += USB_PMA_ALLOCATION((ep->DoubleBuffer == ENABLE) ? 2 * size : size);
+    }
+
+    return XPD_OK;
+}
+
 /**
  * @brief Opens an endpoint
  * @param husb: pointer to the USB handle structure
@@ -457,7 +632,7 @@ void XPD_USB_EP_Open(USB_HandleType * husb, uint8_t EpAddress, USB_EndPointType
                 &husb->EP.OUT[EpAddress] : &husb->EP.IN[EpAddress]);
 
         /* Ensuring that double buffering is not enabled for control or interrupt EPs */
-        if ((ep->Type == USB_EP_CONTROL) || (ep->Type == USB_EP_INTERRUPT))
+        if ((ep->Type == USB_EP_TYPE_CONTROL) || (ep->Type == USB_EP_TYPE_INTERRUPT))
         {
             ep->DoubleBuffer = DISABLE;
         }
@@ -521,8 +696,9 @@ void XPD_USB_EP_Open(USB_HandleType * husb, uint8_t EpAddress, USB_EndPointType
         }
         else
         {
-            /* Set buffer address for double buffered mode */
+            /* Set buffer address and size for double buffered mode */
             USB_EP_BDT[ep->RegId].TX_ADDR  = pmaAddress + ep->MaxPacketSize;
+            USB_EP_BDT[ep->RegId].TX_COUNT = usb_epConvertRxCount(MaxPacketSize);
 
             /* Set SW_BUF flag */
             USB_TOGGLE(ep->RegId, DTOG_TX);
@@ -617,6 +793,13 @@ void XPD_USB_EP_Receive(USB_HandleType * husb, uint8_t EpAddress, uint8_t * Data
     ep->Transfer.buffer = Data;
     ep->Transfer.size   = 0;
 
+    /* Release the buffer which was held at the end of the previous transfer */
+    if ((ep->DoubleBuffer == ENABLE) && (EpAddress > 0) &&
+        (((USB->EP[ep->RegId].w ^ (USB->EP[ep->RegId].w >> 8)) & USB_EP_DTOG_TX) == 0))
+    {
+        USB_TOGGLE(ep->RegId, DTOG_TX);
+    }
+
     usb_epReceive(husb, ep, Length);
 }
 
@@ -633,6 +816,10 @@ uint16_t XPD_USB_EP_GetRxCount(USB_HandleType * husb, uint8_t EpAddress)
 
 /**
  * @brief Initiates data transmission on the IN endpoint
+ * @note  The transfer is split to packets and scheduled in the interrupt handler,
+ *        the DataInStage callback is only called when the complete transfer is done.
+ *        The transfer isn't terminated by a zero length packet, so it can be a part of
+ *        a larger data phase, @ref XPD_USB_EP_TransmitEnd shall be used for its last part.
  * @param husb: pointer to the USB handle structure
  * @param EpAddress: endpoint number
  * @param Data: pointer to the data buffer
@@ -645,6 +832,30 @@ void XPD_USB_EP_Transmit(USB_HandleType * husb, uint8_t EpAddress, uint8_t * Dat
     /* setup and start the transfer */
     ep->Transfer.buffer = Data;
     ep->Transfer.size   = 0;
+    ep->PendingZLP      = FALSE;
+
+    usb_epTransmit(husb, ep, Length);
+}
+
+/**
+ * @brief Initiates the last data transmission of a data phase on the IN endpoint.
+ * @note  The host can only detect the end of a bulk data phase by a short packet,
+ *        so the transfer is terminated by a zero length packet when its last packet is full.
+ *        The DataInStage callback is called after the zero length packet is sent.
+ * @param husb: pointer to the USB handle structure
+ * @param EpAddress: endpoint number
+ * @param Data: pointer to the data buffer
+ * @param Length: amount of data bytes to transfer
+ */
+void XPD_USB_EP_TransmitEnd(USB_HandleType * husb, uint8_t EpAddress, uint8_t * Data, uint16_t Length)
+{
+    USB_EndPointHandleType * ep = &husb->EP.IN[EpAddress & 0x7F];
+
+    /* setup and start the transfer */
+    ep->Transfer.buffer = Data;
+    ep->Transfer.size   = 0;
+    ep->PendingZLP      = (ep->Type == USB_EP_TYPE_BULK) && (Length > 0)
+            && ((Length % ep->MaxPacketSize) == 0);
 
     usb_epTransmit(husb, ep, Length);
 }
@@ -699,17 +910,40 @@ void XPD_USB_EP_ClearStall(USB_HandleType * husb, uint8_t EpAddress)
     ep->Stalled = FALSE;
 }
 
+#ifdef USE_XPD_CONST_CALLBACKS
 /**
- * @brief USB interrupt handler that provides event-driven peripheral management
- *        and handle callbacks.
+ * @brief USB event callback without any operation,
+ *        for the unused single parameter entries of the constant callback table.
+ * @param User: pointer to the upper stack handler
+ * @return 0
+ */
+int XPD_USB_NullCallback(void * User)
+{
+    (void) User;
+    return 0;
+}
+#endif
+
+/**
+ * @brief Services the pending USB events with bounded work, the handle callbacks
+ *        are called the same way as from the interrupt handler.
+ * @note  In polled operation the USB IRQ is kept disabled in NVIC, and this function
+ *        is called periodically from a fixed point of the application loop.
  * @param husb: pointer to the USB handle structure
+ * @param MaxPackets: the maximum number of endpoint packets to process,
+ *                    the rest of them remain pending for the next call
+ * @return The number of processed endpoint packets
  */
-void XPD_USB_IRQHandler(USB_HandleType * husb)
+uint32_t XPD_USB_Poll(USB_HandleType * husb, uint32_t MaxPackets)
 {
-    uint32_t istr;
+    XPD_PROFILE_BEGIN();
+    XPD_STATS_IRQ_BEGIN();
+
+    uint32_t istr, packets = 0;
 
     /* loop while Endpoint interrupts are present */
-    for (istr = USB->ISTR.w; (istr & USB_ISTR_CTR) != 0; istr = USB->ISTR.w)
+    for (istr = USB->ISTR.w; ((istr & USB_ISTR_CTR) != 0) && (packets < MaxPackets);
+            istr = USB->ISTR.w, packets++)
     {
         /* Read highest priority endpoint number */
         uint8_t  epId  = (uint8_t)(istr & USB_ISTR_EP_ID);
@@ -730,9 +964,12 @@ void XPD_USB_IRQHandler(USB_HandleType * husb)
 
                 ep->Transfer.size = USB_EP_BDT[0].TX_COUNT & 0x3FF;
                 ep->Transfer.buffer += ep->Transfer.size;
+                XPD_STATS_ADD(husb, Bytes, ep->Transfer.size);
+                XPD_STATS_ADD(husb, Transfers, 1);
 
                 /* IN packet successfully sent */
-                XPD_SAFE_CALLBACK(husb->Callbacks.DataInStage, husb->User, 0,
+                XPD_TRACE(XPD_TRACE_USB_DATA_IN, 0);
+                XPD_HANDLE_CALLBACK(husb, DataInStage, husb->User, 0,
                         ep->Transfer.buffer);
 
                 /* Set device address if new valid has been received */
@@ -754,13 +991,15 @@ void XPD_USB_IRQHandler(USB_HandleType * husb)
                 {
                     usb_readPMA((uint8_t*) husb->Setup, (husb->BdtSize + ep->PacketAddress),
                             ep->Transfer.size);
+                    XPD_STATS_ADD(husb, Bytes, ep->Transfer.size);
+                    XPD_STATS_ADD(husb, Transfers, 1);
 
                     /* Clear RX complete flag */
                     USB_CLEAR_EP_FLAG(0, CTR_RX);
 
                     /* Process SETUP Packet */
-                    XPD_SAFE_CALLBACK(husb->Callbacks.SetupStage,
-                            husb->User, (uint8_t *)husb->Setup);
+                    XPD_TRACE(XPD_TRACE_USB_SETUP, 0);
+                    XPD_HANDLE_CALLBACK(husb, SetupStage, husb->User, (uint8_t *)husb->Setup);
                 }
 
                 /* Get Control Data OUT Packet */
@@ -775,11 +1014,13 @@ void XPD_USB_IRQHandler(USB_HandleType * husb)
                         usb_readPMA(ep->Transfer.buffer, (husb->BdtSize + ep->PacketAddress),
                                 ep->Transfer.size);
                         ep->Transfer.buffer += ep->Transfer.size;
+                        XPD_STATS_ADD(husb, Bytes, ep->Transfer.size);
                     }
+                    XPD_STATS_ADD(husb, Transfers, 1);
 
                     /* Process Control Data OUT Packet */
-                    XPD_SAFE_CALLBACK(husb->Callbacks.DataOutStage,
-                            husb->User, 0, ep->Transfer.buffer);
+                    XPD_TRACE(XPD_TRACE_USB_DATA_OUT, 0);
+                    XPD_HANDLE_CALLBACK(husb, DataOutStage, husb->User, 0, ep->Transfer.buffer);
 
                     /* Keep EP0 in receiving state */
                     USB_EP_BDT[0].RX_COUNT = usb_epConvertRxCount(ep->MaxPacketSize);
@@ -815,23 +1056,45 @@ void XPD_USB_IRQHandler(USB_HandleType * husb)
                     count       = USB_EP_BDT[epId].RX_COUNT & 0x3FF;
                 }
 
-                usb_readPMA(ep->Transfer.buffer, pmaAddress, count);
+                /* The reception buffers are larger than the remaining space of a short transfer
+                 * (max packet size when double buffered, rounded up to block size otherwise),
+                 * the excess data is dropped as overrun */
+                if (count > ep->PacketLength)
+                {
+                    XPD_STATS_ERROR(husb, 2);
+                    count = ep->PacketLength;
+                }
 
-                /* Switch the reception buffer by toggling SW_BUF flag */
                 if (ep->DoubleBuffer == ENABLE)
                 {
-                    USB_TOGGLE(epId, DTOG_TX);
+                    /* If more packets follow, switch the reception buffer by toggling SW_BUF flag
+                     * before reading, so the next packet is received during the copy,
+                     * otherwise the buffer is held (NAK) until the next reception request */
+                    if ((ep->Transfer.length == 0) || (count < ep->MaxPacketSize))
+                    {
+                        USB_EP_SET_STATUS(epId, RX, NAK);
+                    }
+                    else if (((epReg ^ (epReg >> 8)) & USB_EP_DTOG_TX) == 0)
+                    {
+                        USB_TOGGLE(epId, DTOG_TX);
+                    }
                 }
 
+                usb_readPMA(ep->Transfer.buffer, pmaAddress, count);
+                XPD_STATS_ADD(husb, Bytes, count);
+
                 ep->Transfer.size   += count;
                 ep->Transfer.buffer += count;
 
-                /* If the last packet of the data, transfer is complete */
+                /* If the last packet of the data, transfer is complete
+                 * (a full last packet is followed by ZLP from the host
+                 * when the transfer is shorter than requested) */
                 if ((ep->Transfer.length == 0) || (count < ep->MaxPacketSize))
                 {
                     /* Reception finished */
-                    XPD_SAFE_CALLBACK(husb->Callbacks.DataOutStage,
-                            husb->User, EpAddress, ep->Transfer.buffer);
+                    XPD_STATS_ADD(husb, Transfers, 1);
+                    XPD_TRACE(XPD_TRACE_USB_DATA_OUT, EpAddress);
+                    XPD_HANDLE_CALLBACK(husb, DataOutStage, husb->User, EpAddress, ep->Transfer.buffer);
                 }
                 else
                 {
@@ -864,16 +1127,24 @@ void XPD_USB_IRQHandler(USB_HandleType * husb)
 
                 /* Clear register to avoid initial repeated data sending */
                 (*pCountReg) = 0;
+                XPD_STATS_ADD(husb, Bytes, count);
 
                 ep->Transfer.size   += count;
                 ep->Transfer.buffer += count;
 
                 /* If the last packet of the data */
-                if (ep->Transfer.length == 0)
+                if ((ep->Transfer.length == 0) && (ep->PendingZLP == TRUE))
+                {
+                    /* Terminate the transfer with a zero length packet */
+                    ep->PendingZLP = FALSE;
+                    usb_epTransmit(husb, ep, 0);
+                }
+                else if (ep->Transfer.length == 0)
                 {
                     /* Transmission complete */
-                    XPD_SAFE_CALLBACK(husb->Callbacks.DataInStage,
-                            husb->User, EpAddress, ep->Transfer.buffer);
+                    XPD_STATS_ADD(husb, Transfers, 1);
+                    XPD_TRACE(XPD_TRACE_USB_DATA_IN, EpAddress);
+                    XPD_HANDLE_CALLBACK(husb, DataInStage, husb->User, EpAddress, ep->Transfer.buffer);
                 }
                 else
                 {
@@ -888,7 +1159,8 @@ void XPD_USB_IRQHandler(USB_HandleType * husb)
     if ((istr & USB_ISTR_RESET) != 0)
     {
         XPD_USB_ClearFlag(husb, RESET);
-        XPD_SAFE_CALLBACK(husb->Callbacks.Reset, husb->User);
+        XPD_TRACE(XPD_TRACE_USB_RESET, 0);
+        XPD_HANDLE_CALLBACK(husb, Reset, husb->User);
 
         /* reset device address, enable addressing */
         USB->DADDR.w = USB_DADDR_EF;
@@ -902,7 +1174,8 @@ void XPD_USB_IRQHandler(USB_HandleType * husb)
 
         XPD_USB_ClearFlag(husb, WKUP);
 
-        XPD_SAFE_CALLBACK(husb->Callbacks.Resume, husb->User);
+        XPD_TRACE(XPD_TRACE_USB_RESUME, 0);
+        XPD_HANDLE_CALLBACK(husb, Resume, husb->User);
 
         /* LPM state is changed after Resume callback
          * -> possible to determine exited suspend level */
@@ -920,7 +1193,8 @@ void XPD_USB_IRQHandler(USB_HandleType * husb)
 
         /* Set the target Link State */
         husb->LinkState = USB_LPM_L1;
-        XPD_SAFE_CALLBACK(husb->Callbacks.Suspend, husb->User);
+        XPD_TRACE(XPD_TRACE_USB_SUSPEND, husb->LinkState);
+        XPD_HANDLE_CALLBACK(husb, Suspend, husb->User);
     }
 #endif
 
@@ -936,7 +1210,8 @@ void XPD_USB_IRQHandler(USB_HandleType * husb)
         {
             /* Set the target Link State */
             husb->LinkState = USB_LPM_L2;
-            XPD_SAFE_CALLBACK(husb->Callbacks.Suspend, husb->User);
+            XPD_TRACE(XPD_TRACE_USB_SUSPEND, husb->LinkState);
+            XPD_HANDLE_CALLBACK(husb, Suspend, husb->User);
         }
     }
 
@@ -944,8 +1219,35 @@ void XPD_USB_IRQHandler(USB_HandleType * husb)
     if ((istr & USB_ISTR_SOF) != 0)
     {
         XPD_USB_ClearFlag(husb, SOF);
-        XPD_SAFE_CALLBACK(husb->Callbacks.SOF, husb->User);
+        XPD_HANDLE_CALLBACK(husb, SOF, husb->User);
     }
+
+#ifdef USE_XPD_STATISTICS
+    /* Count the packet errors and overruns, their interrupts are not used */
+    if ((istr & (USB_ISTR_ERR | USB_ISTR_PMAOVR)) != 0)
+    {
+        XPD_STATS_ERROR(husb, (((istr & USB_ISTR_ERR) != 0) ? 1 : 0)
+                            | (((istr & USB_ISTR_PMAOVR) != 0) ? 2 : 0));
+
+        XPD_USB_ClearFlag(husb, ERR);
+        XPD_USB_ClearFlag(husb, PMAOVR);
+    }
+#endif
+
+    XPD_STATS_IRQ_END(husb);
+    XPD_PROFILE_END();
+
+    return packets;
+}
+
+/**
+ * @brief USB interrupt handler that provides event-driven peripheral management
+ *        and handle callbacks.
+ * @param husb: pointer to the USB handle structure
+ */
+void XPD_USB_IRQHandler(USB_HandleType * husb)
+{
+    (void) XPD_USB_Poll(husb, ~0UL);
 }
 
 /**
@@ -0,0 +1,255 @@
+/**
+  ******************************************************************************
+  * @file    xpd_usb_sync.c
+  * @author  Benedek Kupper
+  * @version V0.1
+  * @date    2018-01-20
+  * @brief   STM32 eXtensible Peripheral Drivers USB Frame Synchronization Module
+  *
+  *  This file is part of STM32_XPD.
+  *
+  *  STM32_XPD is free software: you can redistribute it and/or modify
+  *  it under the terms of the GNU General Public License as published by
+  *  the Free Software Foundation, either version 3 of the License, or
+  *  (at your option) any later version.
+  *
+  *  STM32_XPD is distributed in the hope that it will be useful,
+  *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with STM32_XPD.  If not, see <http://www.gnu.org/licenses/>.
+  */
+#include "xpd_usb_sync.h"
+
+#if defined(USE_XPD_USB_SYNC) && (defined(USB) || defined(USB_OTG_FS))
+
+/** @addtogroup USB_Sync
+ * @{ */
+
+/* The frame number on the bus is 11 bits wide */
+#define USB_SYNC_FRAME_MASK     0x7FF
+
+/* Larger SOF gaps (e.g. suspend) restart the phase tracking */
+#define USB_SYNC_MAX_GAP        16
+
+/* Determines the signed distance of two counter values within the counter period */
+static int32_t usb_sync_ticks(USB_SyncHandleType * hsync, uint32_t To, uint32_t From)
+{
+    uint32_t reload = XPD_TIM_Counter_Reload(hsync->Timer);
+    uint32_t diff = To - From;
+
+    if (To < From)
+    {
+        diff += reload + 1;
+    }
+    if (diff > (reload / 2))
+    {
+        diff -= reload + 1;
+    }
+    return (int32_t)diff;
+}
+
+/* Offsets a counter value by a signed amount of ticks within the counter period */
+static uint32_t usb_sync_offset(USB_SyncHandleType * hsync, uint32_t Value, int32_t Ticks)
+{
+    uint32_t reload = XPD_TIM_Counter_Reload(hsync->Timer);
+    uint32_t result = Value + (uint32_t)Ticks;
+
+    if (Ticks < 0)
+    {
+        if (Value < (uint32_t)-Ticks)
+        {
+            result += reload + 1;
+        }
+    }
+    else if ((result > reload) || (result < Value))
+    {
+        result -= reload + 1;
+    }
+    return result;
+}
+
+/** @defgroup USB_Sync_Exported_Functions USB Sync Exported Functions
+ * @{ */
+
+/**
+ * @brief Initializes the frame synchronization using the setup configuration.
+ * @note  The timer counter has to be initialized and running.
+ *        When the SOF is captured, the timer's slave trigger selection is set to the SOF trigger.
+ * @param hsync: pointer to the USB frame synchronization handle structure
+ * @param Config: frame synchronization setup configuration
+ */
+void XPD_USB_Sync_Init(USB_SyncHandleType * hsync, const USB_Sync_InitType * Config)
+{
+    hsync->Capture  = Config->Capture != DISABLE;
+    hsync->Channel  = Config->Channel;
+    hsync->Shift    = Config->Shift;
+    hsync->Frame    = 0;
+    hsync->Period   = 0;
+    hsync->Tracked  = 0;
+
+    if (hsync->Capture != 0)
+    {
+        const TIM_SlaveConfigType trigger = {
+            .SlaveMode    = TIM_SLAVEMODE_DISABLE,
+            .SlaveTrigger = Config->Trigger,
+        };
+        const TIM_Input_InitType input = {
+            .Source    = TIM_INPUT_TRC,
+            .Polarity  = ACTIVE_HIGH,
+            .Prescaler = CLK_DIV1,
+            .Filter    = 0,
+        };
+
+        XPD_TIM_SlaveConfig(hsync->Timer, &trigger);
+        XPD_TIM_Input_ChannelConfig(hsync->Timer, hsync->Channel, &input);
+        XPD_TIM_Channel_Start(hsync->Timer, hsync->Channel);
+    }
+}
+
+/**
+ * @brief Stops the SOF capture of the frame synchronization.
+ * @param hsync: pointer to the USB frame synchronization handle structure
+ */
+void XPD_USB_Sync_Deinit(USB_SyncHandleType * hsync)
+{
+    if (hsync->Capture != 0)
+    {
+        XPD_TIM_Channel_Stop(hsync->Timer, hsync->Channel);
+    }
+    hsync->Tracked = 0;
+}
+
+/**
+ * @brief Timestamps the current frame and updates the tracking loop.
+ *        Has to be called from the SOF callback of each frame.
+ * @note  The phase and period errors are corrected by a second order loop,
+ *        a phase error beyond half a frame restarts the phase tracking.
+ * @param hsync: pointer to the USB frame synchronization handle structure
+ */
+void XPD_USB_Sync_SOF(USB_SyncHandleType * hsync)
+{
+    uint32_t stamp, frames, elapsed;
+    uint16_t frameNumber;
+    int32_t error;
+
+    if (hsync->Capture != 0)
+    {
+        stamp = XPD_TIM_Channel_Value(hsync->Timer, hsync->Channel);
+    }
+    else
+    {
+        stamp = XPD_TIM_Counter_Value(hsync->Timer);
+    }
+    frameNumber = XPD_USB_GetFrameNumber(hsync->Usb) & USB_SYNC_FRAME_MASK;
+    frames = (frameNumber - hsync->FrameNumber) & USB_SYNC_FRAME_MASK;
+
+    if (hsync->Tracked == 0)
+    {
+        /* The host frame count starts from the bus frame number */
+        hsync->Frame = frameNumber;
+    }
+    else if (frames == 0)
+    {
+        /* Repeated call within the same frame */
+        return;
+    }
+    else
+    {
+        hsync->Frame += frames;
+    }
+    hsync->FrameNumber = frameNumber;
+
+    if ((hsync->Tracked == 0) || (frames > USB_SYNC_MAX_GAP))
+    {
+        /* Restart from this frame */
+        hsync->Stamp    = stamp;
+        hsync->Fraction = 0;
+        hsync->Tracked  = 1;
+        return;
+    }
+
+    if (hsync->Period == 0)
+    {
+        /* The initial period is measured between the first two frames */
+        error = usb_sync_ticks(hsync, stamp, hsync->Stamp);
+        if (error > 0)
+        {
+            hsync->Period = ((uint32_t)error << 8) / frames;
+        }
+        hsync->Stamp    = stamp;
+        hsync->Fraction = 0;
+        hsync->Tracked  = 2;
+        return;
+    }
+
+    /* The frame start is predicted with the estimated period */
+    elapsed = hsync->Period * frames + hsync->Fraction;
+    hsync->Stamp = usb_sync_offset(hsync, hsync->Stamp, elapsed >> 8);
+    error = usb_sync_ticks(hsync, stamp, hsync->Stamp);
+
+    if ((uint32_t)((error < 0) ? -error : error) > (hsync->Period >> 9))
+    {
+        hsync->Stamp    = stamp;
+        hsync->Fraction = 0;
+        hsync->Tracked  = 1;
+        return;
+    }
+
+    /* Phase correction, and period correction with the critically damped gain */
+    {
+        int32_t phase = (int32_t)(elapsed & 0xFF) + ((error * 256) >> hsync->Shift);
+
+        hsync->Stamp    = usb_sync_offset(hsync, hsync->Stamp, phase >> 8);
+        hsync->Fraction = phase & 0xFF;
+        hsync->Period  += (error * 256) >> (2 * hsync->Shift + 1);
+    }
+
+    if (hsync->Tracked < 0xFFFF)
+    {
+        hsync->Tracked++;
+    }
+}
+
+/**
+ * @brief Converts a local timer value to the host's time.
+ * @param hsync: pointer to the USB frame synchronization handle structure
+ * @param Ticks: the timer counter or capture value, within half a counter period of the last SOF
+ * @return The host time in microseconds, the low 11 bits of the milliseconds are the bus frame number
+ */
+uint32_t XPD_USB_Sync_ToHostTime(USB_SyncHandleType * hsync, uint32_t Ticks)
+{
+    uint32_t time = hsync->Frame * 1000;
+
+    if (hsync->Period > 0)
+    {
+        int64_t elapsed = ((int64_t)usb_sync_ticks(hsync, Ticks, hsync->Stamp) << 8) - hsync->Fraction;
+
+        time += (int32_t)((elapsed * 1000) / hsync->Period);
+    }
+    return time;
+}
+
+/**
+ * @brief Provides the deviation of the local timer's clock from the host's frame clock.
+ * @param hsync: pointer to the USB frame synchronization handle structure
+ * @return The clock deviation in ppm, positive if the local clock is faster
+ */
+int32_t XPD_USB_Sync_GetDrift(USB_SyncHandleType * hsync)
+{
+    int32_t nominal = (hsync->Timer->CounterFreq / 1000) << 8;
+
+    if ((hsync->Period == 0) || (nominal == 0))
+    {
+        return 0;
+    }
+    return (int32_t)(((int64_t)((int32_t)hsync->Period - nominal) * 1000000) / nominal);
+}
+
+/** @} */
+
+/** @} */
+
+#endif /* USE_XPD_USB_SYNC */
@@ -28,6 +28,12 @@
 #include "xpd_config.h"
 #include "xpd_adc_calc.h"
 #include "xpd_dma.h"
+#include "xpd_utils.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
 
 /** @defgroup ADC
  * @{ */
@@ -174,6 +180,15 @@ typedef struct
     uint16_t Low;              /*!< Watchdog low threshold */
 }ADC_WatchdogThresholdType;
 
+/** @brief ADC scheduled channel setup structure */
+typedef struct
+{
+    ADC_ChannelInitType Channel;    /*!< The channel configuration (watchdog selection is not recommended) */
+    uint8_t             Weight;     /*!< The number of conversions of the channel in each sequence [1..16] */
+    XPD_RingType *      Ring;       /*!< The ring of 16 bit elements to receive the channel's conversions,
+                                         or NULL to discard them */
+}ADC_ScheduledChannelType;
+
 /** @brief ADC Handle structure */
 typedef struct
 {
@@ -188,6 +203,7 @@ typedef struct
         XPD_HandleCallbackType ConvComplete;        /*!< Conversion(s) complete callback */
         XPD_HandleCallbackType InjConvComplete;     /*!< Injected conversion(s) complete callback */
         XPD_HandleCallbackType Watchdog;            /*!< Watchdog alert callback */
+        XPD_HandleCallbackType BlockReady;          /*!< Streaming conversions block filled callback */
 #if defined(USE_XPD_ADC_ERROR_DETECT) || defined(USE_XPD_DMA_ERROR_DETECT)
         XPD_HandleCallbackType Error;               /*!< DMA transfer or overrun error callback */
 #endif
@@ -195,6 +211,24 @@ typedef struct
     struct {
         DMA_HandleType * Conversion;                /*!< DMA handle for update transfer */
     }DMA;                                           /*   DMA handle references */
+    DataStreamType Block;                           /*!< The last filled block of the streaming conversions */
+    struct {
+        DMA_DescriptorType Blocks[2];               /*!< [Internal] The post-trigger transfers of the capture */
+        uint16_t PostTrigger;                       /*!< [Internal] The number of conversions stored after the trigger */
+        uint16_t Trigger;                           /*!< The buffer index of the first conversion after the trigger */
+        uint16_t Start;                             /*!< The buffer index of the oldest conversion of the capture */
+        volatile uint8_t Armed;                     /*!< [Internal] The capture is waiting for the trigger */
+    }Capture;                                       /*   Watchdog triggered capture state */
+    struct {
+        volatile uint16_t Temperature;              /*!< The last temperature sensor conversion of the monitor */
+        uint8_t Active;                             /*!< [Internal] The injected group is used by the monitor */
+    }Monitor;                                       /*   Background supply and temperature monitor state */
+    struct {
+        const ADC_ScheduledChannelType * Channels;  /*!< [Internal] The scheduled channels */
+        uint8_t Ranks[16];                          /*!< [Internal] The scheduled channel index of each sequence rank */
+        uint8_t Length;                             /*!< [Internal] The number of sequence ranks */
+        uint8_t Rank;                               /*!< [Internal] The sequence rank of the next conversion to distribute */
+    }Schedule;                                      /*   Multirate channel schedule */
     volatile uint8_t ActiveConversions;             /*!< ADC number of current regular conversion rank */
 #if defined(USE_XPD_ADC_ERROR_DETECT) || defined(USE_XPD_DMA_ERROR_DETECT)
     volatile ADC_ErrorType Errors;                  /*!< Conversion errors */
@@ -387,6 +421,14 @@ void            XPD_ADC_IRQHandler          (ADC_HandleType * hadc);
 
 XPD_ReturnType  XPD_ADC_Start_DMA           (ADC_HandleType * hadc, void * Address);
 void            XPD_ADC_Stop_DMA            (ADC_HandleType * hadc);
+XPD_ReturnType  XPD_ADC_DMA_BytePacking     (ADC_HandleType * hadc, FunctionalState NewState);
+XPD_ReturnType  XPD_ADC_Stream_Start        (ADC_HandleType * hadc, void * Buffer, uint16_t BlockSize);
+XPD_ReturnType  XPD_ADC_Capture_Start       (ADC_HandleType * hadc, ADC_WatchdogType Watchdog,
+                                             void * Buffer, uint16_t Length, uint16_t PostTrigger);
+XPD_ReturnType  XPD_ADC_Schedule_Config     (ADC_HandleType * hadc,
+                                             const ADC_ScheduledChannelType * Channels, uint8_t ChannelCount);
+void            XPD_ADC_Schedule_Demux      (ADC_HandleType * hadc, const uint16_t * Conversions,
+                                             uint32_t Count);
 
 void            XPD_ADC_WatchdogConfig      (ADC_HandleType * hadc, ADC_WatchdogType Watchdog,
                                              const ADC_WatchdogThresholdType * Config);
@@ -461,6 +503,10 @@ void            XPD_ADC_Injected_Stop       (ADC_HandleType * hadc);
 void            XPD_ADC_Injected_Start_IT   (ADC_HandleType * hadc);
 void            XPD_ADC_Injected_Stop_IT    (ADC_HandleType * hadc);
 
+void            XPD_ADC_Monitor_Start       (ADC_HandleType * hadc, ADC_InjTriggerSourceType Trigger,
+                                             ADC_SampleTimeType SampleTime);
+void            XPD_ADC_Monitor_Stop        (ADC_HandleType * hadc);
+
 /**
  * @brief Return the result of an ADC injected conversion.
  * @param hadc: pointer to the ADC handle structure
@@ -475,6 +521,16 @@ __STATIC_INLINE uint16_t XPD_ADC_Inject_GetValue(ADC_HandleType * hadc, uint8_t
     return (uint16_t)((&hadc->Inst->JDR1)[Index]);
 }
 
+/**
+ * @brief Returns the die temperature measured by the background monitor.
+ * @param hadc: pointer to the ADC handle structure
+ * @return The temperature in degree Celsius
+ */
+__STATIC_INLINE int32_t XPD_ADC_Monitor_GetTemperature(ADC_HandleType * hadc)
+{
+    return XPD_ADC_GetTemperature(hadc->Monitor.Temperature);
+}
+
 /** @} */
 
 /** @} */
@@ -531,6 +587,12 @@ typedef struct
 void            XPD_ADC_MultiMode_Config        (ADC_HandleType * hadc, const ADC_MultiMode_InitType * Config);
 XPD_ReturnType  XPD_ADC_MultiMode_Start_DMA     (ADC_HandleType * hadc, void * Address);
 void            XPD_ADC_MultiMode_Stop_DMA      (ADC_HandleType * hadc);
+XPD_ReturnType  XPD_ADC_MultiMode_Stream_Start  (ADC_HandleType * hadc, void * Buffer, uint16_t BlockSize);
+
+void            XPD_ADC_MultiMode_Deinterleave  (const uint16_t * Packed, uint16_t * const Values[],
+                                                 uint8_t ADCCount, uint32_t Count);
+void            XPD_ADC_MultiMode_Deinterleave8 (const uint8_t * Packed, uint8_t * const Values[],
+                                                 uint8_t ADCCount, uint32_t Count);
 
 /**
  * @brief Return the result of the last common ADC regular conversions.
@@ -554,4 +616,8 @@ __STATIC_INLINE uint32_t XPD_ADC_MultiMode_GetValues(ADC_HandleType * hadc)
 #include "xpd_rcc_gen.h"
 #undef XPD_ADC_API
 
+#ifdef __cplusplus
+}
+#endif
+
 #endif /* __XPD_ADC_H_ */
@@ -27,21 +27,43 @@
 #include "xpd_common.h"
 #include "xpd_config.h"
 
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
 /** @addtogroup ADC
  * @{ */
 
 /** @defgroup ADC_Calculations ADC Calculations
  * @{ */
 
+/** @defgroup ADC_Calculations_Exported_Macros ADC Calculations Exported Macros
+ * @{ */
+
+#ifndef ADC_VDDA_FILTER_SHIFT
+/** @brief Smoothing of the tracked VREFINT conversions, the filter weight is 2^-N [overrideable] */
+#define ADC_VDDA_FILTER_SHIFT   3
+#endif
+
+/** @} */
+
 /** @addtogroup ADC_Calculations_Exported_Functions
  * @{ */
 int32_t         XPD_ADC_SetVDDA             (uint16_t vRefintConversion);
+int32_t         XPD_ADC_TrackVDDA           (uint16_t vRefintConversion);
 
 int32_t         XPD_ADC_GetValue_mV         (uint16_t channelConversion);
 int32_t         XPD_ADC_GetVDDA_mV          (void);
 int32_t         XPD_ADC_GetVBAT_mV          (uint16_t vBatConversion);
 int32_t         XPD_ADC_GetTemperature      (uint16_t tempConversion);
 
+void            XPD_ADC_ConvertBlock_mV     (const uint16_t * channelConversions, int32_t * values,
+                                             uint32_t count);
+void            XPD_ADC_ConvertBlock8_mV    (const uint8_t * channelConversions, int32_t * values,
+                                             uint32_t count);
+uint32_t        XPD_ADC_FindLevel8          (const uint8_t * input, uint32_t count, uint8_t level);
+
 #if (__FPU_PRESENT == 1) && (__FPU_USED == 1)
 float           XPD_ADC_GetValue_V          (uint16_t channelConversion);
 float           XPD_ADC_GetVDDA_V           (void);
@@ -52,6 +74,64 @@ float           XPD_ADC_GetTemperature_C    (uint16_t tempConversion);
 
 /** @} */
 
+/** @defgroup ADC_Decimation ADC Decimation Filters
+ *  @brief    Block-based decimating low-pass filters for the streamed conversion blocks
+ *  @details  The filters keep their state between the blocks, so they can be directly
+ *            applied on the blocks filled by @ref XPD_ADC_Stream_Start:
+ *  @code
+    static void ADC_BlockReady(void * handle)
+    {
+        ADC_HandleType * hadc = handle;
+
+        (void) XPD_ADC_FIR_Decimate(&lowpass, hadc->Block.buffer, filtered, hadc->Block.length);
+    }
+ *  @endcode
+ * @{ */
+
+/** @defgroup ADC_Decimation_Exported_Types ADC Decimation Exported Types
+ * @{ */
+
+/** @brief ADC CIC decimation filter structure */
+typedef struct
+{
+    uint32_t Integrators[4];    /*!< [Internal] The integrator stages */
+    uint32_t Combs[4];          /*!< [Internal] The delayed inputs of the comb stages */
+    uint16_t Decimation;        /*!< The rate change factor */
+    uint16_t Phase;             /*!< [Internal] The input count since the last output */
+    uint8_t  Order;             /*!< The number of integrator and comb stages [1..4] */
+    uint8_t  Shift;             /*!< The output attenuation of the filter gain */
+}ADC_CICFilterType;
+
+/** @brief ADC FIR decimation filter structure */
+typedef struct
+{
+    const int16_t * Coeffs;     /*!< The Q15 coefficients in time reversed order (word aligned) */
+    uint16_t *      State;      /*!< The sample history buffer for (Length - 1 + largest block length)
+                                     samples (word aligned) */
+    uint16_t        Length;     /*!< The number of coefficients */
+    uint16_t        Decimation; /*!< The rate change factor */
+}ADC_FIRFilterType;
+
+/** @} */
+
+/** @defgroup ADC_Decimation_Exported_Functions ADC Decimation Exported Functions
+ * @{ */
+void            XPD_ADC_CIC_Init            (ADC_CICFilterType * cic, uint8_t Order, uint16_t Decimation);
+uint32_t        XPD_ADC_CIC_Decimate        (ADC_CICFilterType * cic, const uint16_t * input,
+                                             uint16_t * output, uint32_t count);
+
+void            XPD_ADC_FIR_Init            (ADC_FIRFilterType * fir, const int16_t * Coeffs,
+                                             uint16_t Length, uint16_t Decimation, uint16_t * State);
+uint32_t        XPD_ADC_FIR_Decimate        (ADC_FIRFilterType * fir, const uint16_t * input,
+                                             uint16_t * output, uint32_t count);
+/** @} */
+
+/** @} */
+
 /** @} */
 
+#ifdef __cplusplus
+}
+#endif
+
 #endif /* __XPD_ADC_CALC_H_ */
@@ -0,0 +1,165 @@
+/**
+  ******************************************************************************
+  * @file    xpd_async.h
+  * @author  Benedek Kupper
+  * @version V0.1
+  * @date    2018-01-20
+  * @brief   STM32 eXtensible Peripheral Drivers Cooperative Asynchronous Operations
+  *
+  *  This file is part of STM32_XPD.
+  *
+  *  STM32_XPD is free software: you can redistribute it and/or modify
+  *  it under the terms of the GNU General Public License as published by
+  *  the Free Software Foundation, either version 3 of the License, or
+  *  (at your option) any later version.
+  *
+  *  STM32_XPD is distributed in the hope that it will be useful,
+  *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with STM32_XPD.  If not, see <http://www.gnu.org/licenses/>.
+  */
+#ifndef __XPD_ASYNC_H_
+#define __XPD_ASYNC_H_
+
+#include "xpd_common.h"
+#include "xpd_config.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/** @defgroup XPD_Async XPD Cooperative Asynchronous Operations
+ *  @brief    Stackless continuations for sequencing multi-step driver operations
+ *  @details  An asynchronous function resumes at its last suspension point each time it is called,
+ *            returning BUSY until it reaches its end. The completion tokens of the driver operations
+ *            are the Result fields of the queued transactions and jobs, which are BUSY
+ *            while the operation is pending. A single-threaded main loop can thus keep multiple
+ *            peripherals busy without blocking waits, e.g. programming an SPI flash page:
+ *  @code
+    XPD_ReturnType SpiFlash_Program(SpiFlash_Type * flash)
+    {
+        XPD_ASYNC_BEGIN(&flash->Async);
+
+        flash->Xfer.TxData = (void*)writeEnableCmd;
+        flash->Xfer.RxData = NULL;
+        flash->Xfer.Length = sizeof(writeEnableCmd);
+        (void) XPD_SPI_Queue_Submit(flash->hspi, &flash->Xfer);
+        XPD_ASYNC_AWAIT_TOKEN(&flash->Async, flash->Xfer.Result);
+
+        flash->Xfer.TxData = flash->PageBuffer;
+        flash->Xfer.Length = sizeof(flash->PageBuffer);
+        (void) XPD_SPI_Queue_Submit(flash->hspi, &flash->Xfer);
+        XPD_ASYNC_AWAIT_TOKEN(&flash->Async, flash->Xfer.Result);
+
+        do {
+            flash->Xfer.TxData = (void*)readStatusCmd;
+            flash->Xfer.RxData = flash->Status;
+            flash->Xfer.Length = sizeof(readStatusCmd);
+            (void) XPD_SPI_Queue_Submit(flash->hspi, &flash->Xfer);
+            XPD_ASYNC_AWAIT_TOKEN(&flash->Async, flash->Xfer.Result);
+        } while ((flash->Status[1] & WIP_BIT) != 0);
+
+        XPD_ASYNC_END(&flash->Async);
+    }
+
+    while (1)
+    {
+        (void) SpiFlash_Program(&extFlash);
+        (void) Sensor_Poll(&sensor);
+    }
+ *  @endcode
+ *  @note     The local variables of the asynchronous function are not preserved
+ *            between the calls, the state has to be kept in static or context structure variables.
+ *            Only one suspension point is allowed per source line, and the function body
+ *            must not contain switch statements spanning the suspension points.
+ * @{ */
+
+/** @defgroup XPD_Async_Exported_Types XPD Async Exported Types
+ * @{ */
+
+/** @brief XPD asynchronous function context */
+typedef struct
+{
+    uint16_t State;                 /*!< [Internal] The source line of the suspension point, 0 when not started */
+}XPD_AsyncType;
+
+/** @} */
+
+/** @defgroup XPD_Async_Exported_Macros XPD Async Exported Macros
+ * @{ */
+
+/**
+ * @brief Restarts the asynchronous function from its beginning at the next call.
+ * @param CTX: pointer to the @ref XPD_AsyncType context
+ */
+#define XPD_ASYNC_INIT(CTX)                                                 \
+    ((CTX)->State = 0)
+
+/**
+ * @brief Opens the body of the asynchronous function, resuming at the last suspension point.
+ * @param CTX: pointer to the @ref XPD_AsyncType context
+ */
+#define XPD_ASYNC_BEGIN(CTX)                                                \
+    switch ((CTX)->State) { case 0:
+
+/**
+ * @brief Suspends the asynchronous function until the condition is true.
+ * @param CTX: pointer to the @ref XPD_AsyncType context
+ * @param COND: the condition to wait for, reevaluated at each call
+ */
+#define XPD_ASYNC_AWAIT(CTX, COND)                                          \
+    do { (CTX)->State = __LINE__; case __LINE__:                            \
+         if (!(COND)) { return XPD_BUSY; } } while (0)
+
+/**
+ * @brief Suspends the asynchronous function until the operation of the completion token is finished.
+ * @param CTX: pointer to the @ref XPD_AsyncType context
+ * @param TOKEN: the volatile Result of the submitted transaction or job
+ */
+#define XPD_ASYNC_AWAIT_TOKEN(CTX, TOKEN)                                   \
+    XPD_ASYNC_AWAIT(CTX, (TOKEN) != XPD_BUSY)
+
+/**
+ * @brief Suspends the asynchronous function until the nested asynchronous function is finished.
+ * @param CTX: pointer to the @ref XPD_AsyncType context
+ * @param RESULT: the XPD_ReturnType variable to store the result of the nested function
+ * @param CALL: the call expression of the nested asynchronous function
+ */
+#define XPD_ASYNC_AWAIT_CALL(CTX, RESULT, CALL)                             \
+    XPD_ASYNC_AWAIT(CTX, ((RESULT) = (CALL)) != XPD_BUSY)
+
+/**
+ * @brief Suspends the asynchronous function until the next call.
+ * @param CTX: pointer to the @ref XPD_AsyncType context
+ */
+#define XPD_ASYNC_YIELD(CTX)                                                \
+    do { (CTX)->State = __LINE__; return XPD_BUSY; case __LINE__:; } while (0)
+
+/**
+ * @brief Finishes the asynchronous function with the specified result.
+ * @param CTX: pointer to the @ref XPD_AsyncType context
+ * @param RESULT: the XPD_ReturnType result of the function
+ */
+#define XPD_ASYNC_EXIT(CTX, RESULT)                                         \
+    do { (CTX)->State = 0; return (RESULT); } while (0)
+
+/**
+ * @brief Closes the body of the asynchronous function, which finishes with OK result.
+ * @param CTX: pointer to the @ref XPD_AsyncType context
+ */
+#define XPD_ASYNC_END(CTX)                                                  \
+    } (CTX)->State = 0; return XPD_OK
+
+/** @} */
+
+/** @} */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __XPD_ASYNC_H_ */
@@ -0,0 +1,152 @@
+/**
+  ******************************************************************************
+  * @file    xpd_cryp.h
+  * @author  Benedek Kupper
+  * @version V0.1
+  * @date    2018-01-20
+  * @brief   STM32 eXtensible Peripheral Drivers Cryptographic Processor Module
+  *
+  *  This file is part of STM32_XPD.
+  *
+  *  STM32_XPD is free software: you can redistribute it and/or modify
+  *  it under the terms of the GNU General Public License as published by
+  *  the Free Software Foundation, either version 3 of the License, or
+  *  (at your option) any later version.
+  *
+  *  STM32_XPD is distributed in the hope that it will be useful,
+  *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with STM32_XPD.  If not, see <http://www.gnu.org/licenses/>.
+  */
+#ifndef __XPD_CRYP_H_
+#define __XPD_CRYP_H_
+
+#include "xpd_common.h"
+#include "xpd_config.h"
+#include "xpd_dma.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#ifdef CRYP
+
+/** @defgroup CRYP
+ * @{ */
+
+/** @defgroup CRYP_Exported_Types CRYP Exported Types
+ * @{ */
+
+/** @brief CRYP AES chaining modes */
+typedef enum
+{
+    CRYP_AES_ECB = 4, /*!< Electronic codebook */
+    CRYP_AES_CBC = 5, /*!< Cipher block chaining */
+    CRYP_AES_CTR = 6, /*!< Counter mode */
+    CRYP_AES_GCM = 8, /*!< Galois counter mode with authentication tag
+                           @note Only available on STM32F43x devices */
+}CRYP_ModeType;
+
+/** @brief CRYP AES key sizes */
+typedef enum
+{
+    CRYP_KEY_128 = 0, /*!< 128 bit key */
+    CRYP_KEY_192 = 1, /*!< 192 bit key */
+    CRYP_KEY_256 = 2, /*!< 256 bit key */
+}CRYP_KeySizeType;
+
+/** @brief CRYP operation directions */
+typedef enum
+{
+    CRYP_ENCRYPT = 0, /*!< Encryption */
+    CRYP_DECRYPT = 1, /*!< Decryption */
+}CRYP_DirectionType;
+
+/** @brief CRYP AES job structure */
+typedef struct CRYP_JobType
+{
+    struct CRYP_JobType * Next;     /*!< [Internal] The next queued job */
+    CRYP_ModeType Mode;             /*!< The chaining mode */
+    CRYP_DirectionType Direction;   /*!< The operation direction */
+    CRYP_KeySizeType KeySize;       /*!< The key size */
+    const uint8_t * Key;            /*!< The key bytes */
+    const uint8_t * IV;             /*!< CBC: 16 byte initialization vector,
+                                         CTR: 16 byte initial counter block,
+                                         GCM: 12 byte nonce */
+    const void * Header;            /*!< GCM additional authenticated data (NULL if not used) */
+    uint32_t HeaderLength;          /*!< GCM additional authenticated data length in bytes */
+    const void * Input;             /*!< Input data (word aligned) */
+    void * Output;                  /*!< Output data (word aligned), can be the same as the input */
+    uint32_t Length;                /*!< Data length in bytes, multiple of 16 */
+    uint32_t Tag[4];                /*!< GCM authentication tag, computed at the end of the job */
+    XPD_HandleCallbackType Complete;/*!< Job finished callback, the argument is the job */
+    volatile XPD_ReturnType Result; /*!< BUSY while the job is pending, then the result of the job */
+}CRYP_JobType;
+
+/** @brief CRYP Handle structure */
+typedef struct
+{
+    CRYP_TypeDef * Inst;                     /*!< The address of the peripheral instance used by the handle */
+    XPD_CtrlFnType ClockCtrl;                /*!< Function pointer for RCC clock control */
+    struct {
+        XPD_HandleCallbackType DepInit;      /*!< Callback to initialize module dependencies (DMAs) */
+        XPD_HandleCallbackType DepDeinit;    /*!< Callback to restore module dependencies (DMAs) */
+    }Callbacks;                              /*   Handle Callbacks */
+    struct {
+        DMA_HandleType * In;                 /*!< DMA handle for input data transfer */
+        DMA_HandleType * Out;                /*!< DMA handle for output data transfer */
+    }DMA;                                    /*   DMA handle references */
+    struct {
+        CRYP_JobType * Head;                 /*!< [Internal] The ongoing job */
+        CRYP_JobType * Tail;                 /*!< [Internal] The last queued job */
+    }Queue;                                  /*   Job queue */
+#ifdef USE_XPD_STATISTICS
+    XPD_StatsType Stats;                     /*!< Runtime statistics */
+#endif
+}CRYP_HandleType;
+
+/** @} */
+
+/** @defgroup CRYP_Exported_Macros CRYP Exported Macros
+ * @{ */
+
+/**
+ * @brief  CRYP Handle initializer macro
+ * @param  INSTANCE: specifies the CRYP peripheral instance.
+ * @param  INIT_FN: specifies the dependency initialization function to call back.
+ * @param  DEINIT_FN: specifies the dependency deinitialization function to call back.
+ */
+#define         NEW_CRYP_HANDLE(INSTANCE, INIT_FN, DEINIT_FN)   \
+    {.Inst = (INSTANCE),                                        \
+     .ClockCtrl = XPD_##INSTANCE##_ClockCtrl,                   \
+     .Callbacks.DepInit   = (INIT_FN),                          \
+     .Callbacks.DepDeinit = (DEINIT_FN)}
+
+/** @} */
+
+/** @addtogroup CRYP_Exported_Functions
+ * @{ */
+void            XPD_CRYP_Init               (CRYP_HandleType * hcryp);
+void            XPD_CRYP_Deinit             (CRYP_HandleType * hcryp);
+
+XPD_ReturnType  XPD_CRYP_Submit             (CRYP_HandleType * hcryp, CRYP_JobType * Job);
+/** @} */
+
+/** @} */
+
+#endif /* CRYP */
+
+#define XPD_CRYP_API
+#include "xpd_rcc_gen.h"
+#include "xpd_rcc_pc.h"
+#undef XPD_CRYP_API
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __XPD_CRYP_H_ */
@@ -0,0 +1,188 @@
+/**
+  ******************************************************************************
+  * @file    xpd_dcmi.h
+  * @author  Benedek Kupper
+  * @version V0.1
+  * @date    2018-01-20
+  * @brief   STM32 eXtensible Peripheral Drivers Digital Camera Interface Module
+  *
+  *  This file is part of STM32_XPD.
+  *
+  *  STM32_XPD is free software: you can redistribute it and/or modify
+  *  it under the terms of the GNU General Public License as published by
+  *  the Free Software Foundation, either version 3 of the License, or
+  *  (at your option) any later version.
+  *
+  *  STM32_XPD is distributed in the hope that it will be useful,
+  *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with STM32_XPD.  If not, see <http://www.gnu.org/licenses/>.
+  */
+#ifndef __XPD_DCMI_H_
+#define __XPD_DCMI_H_
+
+#include "xpd_common.h"
+#include "xpd_config.h"
+#include "xpd_dma.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#ifdef DCMI
+
+/** @defgroup DCMI
+ * @{ */
+
+/** @defgroup DCMI_Exported_Types DCMI Exported Types
+ * @{ */
+
+/** @brief DCMI capture modes */
+typedef enum
+{
+    DCMI_CAPTURE_CONTINUOUS = 0, /*!< Frames are captured until the capture is stopped */
+    DCMI_CAPTURE_SNAPSHOT   = 1, /*!< A single frame is captured */
+}DCMI_CaptureModeType;
+
+/** @brief DCMI parallel data widths */
+typedef enum
+{
+    DCMI_DATA_8BIT  = 0, /*!< 8 data lines per pixel clock */
+    DCMI_DATA_10BIT = 1, /*!< 10 data lines per pixel clock */
+    DCMI_DATA_12BIT = 2, /*!< 12 data lines per pixel clock */
+    DCMI_DATA_14BIT = 3, /*!< 14 data lines per pixel clock */
+}DCMI_DataWidthType;
+
+/** @brief DCMI frame capture rates */
+typedef enum
+{
+    DCMI_FRAMES_ALL     = 0, /*!< Every frame is captured */
+    DCMI_FRAMES_HALF    = 1, /*!< Every second frame is captured */
+    DCMI_FRAMES_QUARTER = 2, /*!< Every fourth frame is captured */
+}DCMI_FrameRateType;
+
+/** @brief DCMI error types */
+typedef enum
+{
+    DCMI_ERROR_NONE     = 0,      /*!< No error */
+    DCMI_ERROR_OVERRUN  = 1 << 1, /*!< Data was lost because the DMA couldn't keep up */
+    DCMI_ERROR_SYNC     = 1 << 2, /*!< Embedded synchronization code sequence error */
+    DCMI_ERROR_DMA      = 1 << 3, /*!< DMA transfer error */
+}DCMI_ErrorType;
+
+/** @brief DCMI setup structure */
+typedef struct
+{
+    DCMI_DataWidthType DataWidth;   /*!< Parallel data width */
+    DCMI_FrameRateType FrameRate;   /*!< Frame capture rate */
+    FunctionalState JPEG;           /*!< Compressed data format, the frame length is not fixed */
+    FunctionalState EmbeddedSync;   /*!< Synchronization codes are embedded in the data flow instead of HSYNC and VSYNC */
+    struct {
+        uint8_t PixelClockRising : 1; /*!< Data is sampled on the rising edge of the pixel clock */
+        uint8_t HSyncHigh : 1;      /*!< Horizontal blanking is indicated by high HSYNC level */
+        uint8_t VSyncHigh : 1;      /*!< Vertical blanking is indicated by high VSYNC level */
+    }Polarity;                      /*   Signal polarities (hardware synchronization) */
+    struct {
+        uint8_t FrameStart;         /*!< Frame start code */
+        uint8_t LineStart;          /*!< Line start code */
+        uint8_t LineEnd;            /*!< Line end code */
+        uint8_t FrameEnd;           /*!< Frame end code */
+    }SyncCodes;                     /*   Synchronization codes (embedded synchronization) */
+}DCMI_InitType;
+
+/** @brief DCMI crop window structure */
+typedef struct
+{
+    uint16_t X;                     /*!< Horizontal start in pixel clocks */
+    uint16_t Y;                     /*!< Vertical start in lines */
+    uint16_t Width;                 /*!< Width in pixel clocks (the bytes of a pixel may take several clocks) */
+    uint16_t Height;                /*!< Height in lines */
+}DCMI_WindowType;
+
+/** @brief DCMI Handle structure */
+typedef struct
+{
+    DCMI_TypeDef * Inst;                     /*!< The address of the peripheral instance used by the handle */
+    XPD_CtrlFnType ClockCtrl;                /*!< Function pointer for RCC clock control */
+    struct {
+        XPD_HandleCallbackType DepInit;      /*!< Callback to initialize module dependencies (GPIOs, IRQs, DMAs) */
+        XPD_HandleCallbackType DepDeinit;    /*!< Callback to restore module dependencies (GPIOs, IRQs, DMAs) */
+        XPD_HandleCallbackType Frame;        /*!< Frame captured callback */
+        XPD_HandleCallbackType Line;         /*!< Line captured callback (only enabled if set at capture start) */
+        XPD_HandleCallbackType VSync;        /*!< Vertical synchronization callback (only enabled if set at capture start) */
+        XPD_HandleCallbackType Error;        /*!< Overrun, synchronization or DMA error callback */
+    }Callbacks;                              /*   Handle Callbacks */
+    struct {
+        DMA_HandleType * Capture;            /*!< DMA handle for data transfer */
+    }DMA;                                    /*   DMA handle references */
+    struct {
+        uint32_t * Buffer;                   /*!< [Internal] The frame buffer */
+        uint32_t Length;                     /*!< [Internal] The frame length in words */
+        uint16_t BlockLength;                /*!< [Internal] The DMA block length in words */
+        uint16_t Blocks;                     /*!< [Internal] The number of DMA blocks in the frame */
+        uint16_t Next;                       /*!< [Internal] The next block to load to the inactive DMA memory register */
+    }Frame;                                  /*   Frame capture context */
+    volatile DCMI_ErrorType Errors;          /*!< Capture errors */
+#ifdef USE_XPD_STATISTICS
+    XPD_StatsType Stats;                     /*!< Runtime statistics (errors indexed by @ref DCMI_ErrorType bits) */
+#endif
+}DCMI_HandleType;
+
+/** @} */
+
+/** @defgroup DCMI_Exported_Macros DCMI Exported Macros
+ * @{ */
+
+/**
+ * @brief  DCMI Handle initializer macro
+ * @param  INSTANCE: specifies the DCMI peripheral instance.
+ * @param  INIT_FN: specifies the dependency initialization function to call back.
+ * @param  DEINIT_FN: specifies the dependency deinitialization function to call back.
+ */
+#define         NEW_DCMI_HANDLE(INSTANCE, INIT_FN, DEINIT_FN)   \
+    {.Inst = (INSTANCE),                                        \
+     .ClockCtrl = XPD_##INSTANCE##_ClockCtrl,                   \
+     .Callbacks.DepInit   = (INIT_FN),                          \
+     .Callbacks.DepDeinit = (DEINIT_FN)}
+
+/**
+ * @brief  Determines whether a capture is in progress.
+ * @param  HANDLE: specifies the DCMI Handle.
+ */
+#define         XPD_DCMI_IsCapturing(HANDLE)                    \
+    ((HANDLE)->Inst->CR.b.CAPTURE != 0)
+
+/** @} */
+
+/** @addtogroup DCMI_Exported_Functions
+ * @{ */
+void            XPD_DCMI_Init               (DCMI_HandleType * hdcmi, const DCMI_InitType * Config);
+void            XPD_DCMI_Deinit             (DCMI_HandleType * hdcmi);
+
+void            XPD_DCMI_CropConfig         (DCMI_HandleType * hdcmi, const DCMI_WindowType * Window);
+
+XPD_ReturnType  XPD_DCMI_Start_DMA          (DCMI_HandleType * hdcmi, void * Buffer, uint32_t Length,
+                                             DCMI_CaptureModeType Mode);
+void            XPD_DCMI_Stop_DMA           (DCMI_HandleType * hdcmi);
+
+void            XPD_DCMI_IRQHandler         (DCMI_HandleType * hdcmi);
+/** @} */
+
+/** @} */
+
+#endif /* DCMI */
+
+#define XPD_DCMI_API
+#include "xpd_rcc_gen.h"
+#include "xpd_rcc_pc.h"
+#undef XPD_DCMI_API
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __XPD_DCMI_H_ */
@@ -0,0 +1,168 @@
+/**
+  ******************************************************************************
+  * @file    xpd_dma2d.h
+  * @author  Benedek Kupper
+  * @version V0.1
+  * @date    2018-01-20
+  * @brief   STM32 eXtensible Peripheral Drivers DMA2D Module
+  *
+  *  This file is part of STM32_XPD.
+  *
+  *  STM32_XPD is free software: you can redistribute it and/or modify
+  *  it under the terms of the GNU General Public License as published by
+  *  the Free Software Foundation, either version 3 of the License, or
+  *  (at your option) any later version.
+  *
+  *  STM32_XPD is distributed in the hope that it will be useful,
+  *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with STM32_XPD.  If not, see <http://www.gnu.org/licenses/>.
+  */
+#ifndef __XPD_DMA2D_H_
+#define __XPD_DMA2D_H_
+
+#include "xpd_common.h"
+#include "xpd_config.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#ifdef DMA2D
+
+/** @defgroup DMA2D
+ * @{ */
+
+/** @defgroup DMA2D_Exported_Types DMA2D Exported Types
+ * @{ */
+
+/** @brief DMA2D operation types */
+typedef enum
+{
+    DMA2D_OPERATION_COPY    = 0, /*!< Memory to memory copy in the foreground format */
+    DMA2D_OPERATION_CONVERT = 1, /*!< Memory to memory copy with pixel format conversion */
+    DMA2D_OPERATION_BLEND   = 2, /*!< Foreground alpha blending over the background */
+    DMA2D_OPERATION_FILL    = 3, /*!< Output area fill with a constant color */
+}DMA2D_OperationType;
+
+/** @brief DMA2D pixel formats (the output only supports the first five) */
+typedef enum
+{
+    DMA2D_FORMAT_ARGB8888 = 0,   /*!< 32 bit ARGB */
+    DMA2D_FORMAT_RGB888   = 1,   /*!< 24 bit RGB */
+    DMA2D_FORMAT_RGB565   = 2,   /*!< 16 bit RGB */
+    DMA2D_FORMAT_ARGB1555 = 3,   /*!< 16 bit ARGB, 1 bit alpha */
+    DMA2D_FORMAT_ARGB4444 = 4,   /*!< 16 bit ARGB, 4 bit channels */
+    DMA2D_FORMAT_AL44     = 6,   /*!< 8 bit alpha and luminance */
+    DMA2D_FORMAT_AL88     = 7,   /*!< 16 bit alpha and luminance */
+    DMA2D_FORMAT_A8       = 9,   /*!< 8 bit alpha, the color is fixed */
+    DMA2D_FORMAT_A4       = 10,  /*!< 4 bit alpha, the color is fixed */
+}DMA2D_FormatType;
+
+/** @brief DMA2D alpha modes of the input layers */
+typedef enum
+{
+    DMA2D_ALPHA_KEEP     = 0,   /*!< The pixel alpha is used */
+    DMA2D_ALPHA_REPLACE  = 1,   /*!< The layer alpha replaces the pixel alpha */
+    DMA2D_ALPHA_MULTIPLY = 2,   /*!< The pixel alpha is multiplied by the layer alpha */
+}DMA2D_AlphaModeType;
+
+/** @brief DMA2D image layer structure */
+typedef struct
+{
+    void * Address;                 /*!< The address of the top left pixel of the area */
+    uint16_t LineOffset;            /*!< The number of pixels between the end and start of two lines */
+    DMA2D_FormatType Format;        /*!< The pixel format */
+    DMA2D_AlphaModeType AlphaMode;  /*!< The alpha mode (input layers only) */
+    uint8_t Alpha;                  /*!< The layer alpha value (input layers only) */
+    uint32_t Color;                 /*!< The fixed RGB888 color of A8 and A4 input layers */
+}DMA2D_LayerType;
+
+/** @brief DMA2D drawing job structure */
+typedef struct
+{
+    DMA2D_OperationType Operation;  /*!< The drawing operation */
+    uint16_t Width;                 /*!< The width of the area in pixels */
+    uint16_t Height;                /*!< The height of the area in lines */
+    DMA2D_LayerType Output;         /*!< The output area */
+    DMA2D_LayerType Foreground;     /*!< The source area of copy, convert and blend operations */
+    DMA2D_LayerType Background;     /*!< The background area of blend operations */
+    uint32_t FillColor;             /*!< The fill color in the output pixel format */
+    XPD_HandleCallbackType Complete;/*!< Job finished callback, the argument is the job */
+    volatile XPD_ReturnType Result; /*!< BUSY while the job is queued, OK if successful, ERROR otherwise */
+}DMA2D_JobType;
+
+/** @brief DMA2D Handle structure */
+typedef struct
+{
+    DMA2D_TypeDef * Inst;                    /*!< The address of the peripheral instance used by the handle */
+    XPD_CtrlFnType ClockCtrl;                /*!< Function pointer for RCC clock control */
+    struct {
+        XPD_HandleCallbackType DepInit;      /*!< Callback to initialize module dependencies (IRQs) */
+        XPD_HandleCallbackType DepDeinit;    /*!< Callback to restore module dependencies (IRQs) */
+    }Callbacks;                              /*   Handle Callbacks */
+    struct {
+        DMA2D_JobType ** Buffer;             /*!< [Internal] Queued jobs in submission order */
+        uint8_t Size;                        /*!< [Internal] Number of jobs the queue can hold */
+        uint8_t Head;                        /*!< [Internal] The index of the ongoing job */
+        volatile uint8_t Count;              /*!< [Internal] Number of queued jobs, including the ongoing one */
+    }Queue;                                  /*   Job queue */
+#ifdef USE_XPD_STATISTICS
+    XPD_StatsType Stats;                     /*!< Runtime statistics */
+#endif
+}DMA2D_HandleType;
+
+/** @} */
+
+/** @defgroup DMA2D_Exported_Macros DMA2D Exported Macros
+ * @{ */
+
+/**
+ * @brief  DMA2D Handle initializer macro
+ * @param  INSTANCE: specifies the DMA2D peripheral instance.
+ * @param  INIT_FN: specifies the dependency initialization function to call back.
+ * @param  DEINIT_FN: specifies the dependency deinitialization function to call back.
+ */
+#define         NEW_DMA2D_HANDLE(INSTANCE, INIT_FN, DEINIT_FN)  \
+    {.Inst = (INSTANCE),                                        \
+     .ClockCtrl = XPD_##INSTANCE##_ClockCtrl,                   \
+     .Callbacks.DepInit   = (INIT_FN),                          \
+     .Callbacks.DepDeinit = (DEINIT_FN)}
+
+/**
+ * @brief  Determines whether any job is queued or in progress.
+ * @param  HANDLE: specifies the DMA2D Handle.
+ */
+#define         XPD_DMA2D_IsBusy(HANDLE)                        \
+    ((HANDLE)->Queue.Count != 0)
+
+/** @} */
+
+/** @addtogroup DMA2D_Exported_Functions
+ * @{ */
+void            XPD_DMA2D_Init              (DMA2D_HandleType * hdma2d, DMA2D_JobType ** Queue, uint8_t Size);
+void            XPD_DMA2D_Deinit            (DMA2D_HandleType * hdma2d);
+
+XPD_ReturnType  XPD_DMA2D_Submit            (DMA2D_HandleType * hdma2d, DMA2D_JobType * Job);
+
+void            XPD_DMA2D_IRQHandler        (DMA2D_HandleType * hdma2d);
+/** @} */
+
+/** @} */
+
+#endif /* DMA2D */
+
+#define XPD_DMA2D_API
+#include "xpd_rcc_gen.h"
+#include "xpd_rcc_pc.h"
+#undef XPD_DMA2D_API
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __XPD_DMA2D_H_ */
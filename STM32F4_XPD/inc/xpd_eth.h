@@ -0,0 +1,239 @@
+/**
+  ******************************************************************************
+  * @file    xpd_eth.h
+  * @author  Benedek Kupper
+  * @version V0.1
+  * @date    2018-01-20
+  * @brief   STM32 eXtensible Peripheral Drivers Ethernet MAC Module
+  *
+  *  This file is part of STM32_XPD.
+  *
+  *  STM32_XPD is free software: you can redistribute it and/or modify
+  *  it under the terms of the GNU General Public License as published by
+  *  the Free Software Foundation, either version 3 of the License, or
+  *  (at your option) any later version.
+  *
+  *  STM32_XPD is distributed in the hope that it will be useful,
+  *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with STM32_XPD.  If not, see <http://www.gnu.org/licenses/>.
+  */
+#ifndef __XPD_ETH_H_
+#define __XPD_ETH_H_
+
+#include "xpd_common.h"
+#include "xpd_config.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#ifdef ETH
+
+/** @defgroup ETH
+ * @{ */
+
+/** @defgroup ETH_Exported_Macros ETH Exported Macros
+ * @{ */
+
+#ifndef ETH_RX_BUFFER_SIZE
+/* Size of each receive buffer, fits a VLAN tagged frame with CRC (multiple of 4) */
+#define ETH_RX_BUFFER_SIZE      1524
+#endif
+
+/** @} */
+
+/** @defgroup ETH_Exported_Types ETH Exported Types
+ * @{ */
+
+/** @brief ETH PHY interface types */
+typedef enum
+{
+    ETH_INTERFACE_MII  = 0, /*!< Media Independent Interface */
+    ETH_INTERFACE_RMII = 1, /*!< Reduced Media Independent Interface */
+}ETH_InterfaceType;
+
+/** @brief ETH link speed types */
+typedef enum
+{
+    ETH_SPEED_10M  = 0, /*!< 10 Mbit/s */
+    ETH_SPEED_100M = 1, /*!< 100 Mbit/s */
+}ETH_SpeedType;
+
+/** @brief ETH error types */
+typedef enum
+{
+    ETH_ERROR_NONE     = 0, /*!< No error */
+    ETH_ERROR_RECEIVE  = 1, /*!< Frame dropped due to reception error */
+    ETH_ERROR_TRANSMIT = 2, /*!< Frame transmission failed */
+    ETH_ERROR_BUS      = 4, /*!< DMA fatal bus error */
+}ETH_ErrorType;
+
+/** @brief ETH enhanced DMA descriptor structure (chained mode) */
+typedef struct
+{
+    volatile uint32_t Status;       /*!< [DES0] Ownership, control and status bits */
+    uint32_t ControlSize;           /*!< [DES1] Control bits and buffer size */
+    void * Buffer;                  /*!< [DES2] Data buffer address */
+    void * Next;                    /*!< [DES3] Next descriptor address */
+    volatile uint32_t ExtStatus;    /*!< [DES4] Extended receive status */
+    void * Context;                 /*!< [DES5] Reserved, holds the transmitted frame's context */
+    uint32_t TimeStamp[2];          /*!< [DES6-7] Frame time stamp (nanoseconds, seconds) */
+}ETH_DescType;
+
+/** @brief ETH PTP time structure */
+typedef struct
+{
+    uint32_t Seconds;               /*!< The seconds part of the time */
+    uint32_t Nanoseconds;           /*!< The subseconds part of the time [0 .. 999999999] */
+}ETH_TimeType;
+
+/** @brief ETH transmit buffer structure, a frame is built from one or more buffers */
+typedef struct
+{
+    const void * Data;              /*!< The buffer contents */
+    uint16_t Length;                /*!< The number of bytes in the buffer [1 .. 8191] */
+}ETH_BufferType;
+
+/** @brief ETH setup structure */
+typedef struct
+{
+    uint8_t MACAddress[6];          /*!< The station MAC address */
+    ETH_InterfaceType Interface;    /*!< The PHY interface type */
+    ETH_SpeedType Speed;            /*!< The link speed */
+    FunctionalState FullDuplex;     /*!< Full duplex mode of the link */
+    FunctionalState ChecksumOffload;/*!< IPv4 header, TCP, UDP and ICMP checksums are inserted
+                                         on transmission and checked on reception (frames
+                                         with checksum errors are dropped) */
+    uint8_t RxWatchdog;             /*!< Receive interrupt coalescing: when non-zero, the receive
+                                         interrupt is delayed by RxWatchdog * 256 HCLK cycles
+                                         after the first unsignaled frame */
+    uint8_t TxInterruptFrames;      /*!< Transmit interrupt coalescing: only every n-th
+                                         transmitted frame raises an interrupt (0 and 1 mean each frame) */
+}ETH_InitType;
+
+/** @brief ETH Handle structure */
+typedef struct
+{
+    ETH_TypeDef * Inst;                      /*!< The address of the peripheral instance used by the handle */
+    XPD_CtrlFnType ClockCtrl;                /*!< Function pointer for RCC clock control */
+    struct {
+        XPD_HandleCallbackType DepInit;      /*!< Callback to initialize module dependencies (GPIOs, IRQs) */
+        XPD_HandleCallbackType DepDeinit;    /*!< Callback to restore module dependencies (GPIOs, IRQs) */
+        XPD_HandleCallbackType Received;     /*!< Frame(s) received callback */
+        XPD_HandleCallbackType Transmitted;  /*!< Frame(s) transmitted callback */
+        XPD_HandleCallbackType Error;        /*!< Error callback */
+        XPD_HandleCallbackType TargetTime;   /*!< PTP target time reached callback */
+    }Callbacks;                              /*   Handle Callbacks */
+    struct {
+        ETH_DescType * Desc;                 /*!< [Internal] Receive descriptor ring */
+        uint8_t Count;                       /*!< [Internal] Number of descriptors */
+        uint8_t Next;                        /*!< [Internal] Next descriptor to complete reception */
+        uint8_t Fill;                        /*!< [Internal] Next descriptor to be given a buffer */
+        volatile uint8_t Free;               /*!< [Internal] Number of descriptors without buffer */
+        boolean_t Stamped;                   /*!< [Internal] The last taken frame has a time stamp */
+        ETH_TimeType Timestamp;              /*!< [Internal] Time stamp of the last taken frame */
+    }RxRing;                                 /*   Receive ring state */
+    struct {
+        ETH_DescType * Desc;                 /*!< [Internal] Transmit descriptor ring */
+        uint8_t Count;                       /*!< [Internal] Number of descriptors */
+        uint8_t Head;                        /*!< [Internal] Next descriptor to be filled */
+        uint8_t Tail;                        /*!< [Internal] Oldest descriptor to be reclaimed */
+        volatile uint8_t Used;               /*!< [Internal] Number of descriptors in use */
+        uint8_t Unsignaled;                  /*!< [Internal] Frames queued since the last interrupt request */
+        uint8_t Coalesce;                    /*!< [Internal] Frames per transmit interrupt */
+        boolean_t Stamped;                   /*!< [Internal] The last reclaimed frame has a time stamp */
+        ETH_TimeType Timestamp;              /*!< [Internal] Time stamp of the last reclaimed frame */
+    }TxRing;                                 /*   Transmit ring state */
+    uint32_t PtpAddend;                      /*!< [Internal] Nominal PTP clock frequency addend */
+    volatile ETH_ErrorType Errors;           /*!< Transfer errors */
+#ifdef USE_XPD_STATISTICS
+    XPD_StatsType Stats;                     /*!< Runtime statistics (errors indexed by @ref ETH_ErrorType bits) */
+#endif
+}ETH_HandleType;
+
+/** @} */
+
+/** @addtogroup ETH_Exported_Macros
+ * @{ */
+
+/**
+ * @brief  ETH Handle initializer macro
+ * @param  INSTANCE: specifies the ETH peripheral instance.
+ * @param  INIT_FN: specifies the dependency initialization function to call back.
+ * @param  DEINIT_FN: specifies the dependency deinitialization function to call back.
+ */
+#define         NEW_ETH_HANDLE(INSTANCE, INIT_FN, DEINIT_FN)    \
+    {.Inst = (INSTANCE),                                        \
+     .ClockCtrl = XPD_##INSTANCE##MAC_ClockCtrl,                \
+     .Callbacks.DepInit   = (INIT_FN),                          \
+     .Callbacks.DepDeinit = (DEINIT_FN)}
+
+/**
+ * @brief  Determines whether the transmit ring has room for a frame of the given buffer count.
+ * @param  HANDLE: specifies the ETH Handle.
+ * @param  COUNT: the number of buffers of the frame.
+ */
+#define         XPD_ETH_TxRing_HasRoom(HANDLE, COUNT)           \
+    (((HANDLE)->TxRing.Count - (HANDLE)->TxRing.Used) >= (COUNT))
+
+/** @} */
+
+/** @addtogroup ETH_Exported_Functions
+ * @{ */
+XPD_ReturnType  XPD_ETH_Init                (ETH_HandleType * heth, const ETH_InitType * Config);
+XPD_ReturnType  XPD_ETH_Deinit              (ETH_HandleType * heth);
+
+void            XPD_ETH_Start               (ETH_HandleType * heth);
+void            XPD_ETH_Stop                (ETH_HandleType * heth);
+void            XPD_ETH_LinkConfig          (ETH_HandleType * heth, ETH_SpeedType Speed,
+                                             FunctionalState FullDuplex);
+
+XPD_ReturnType  XPD_ETH_PHY_Read            (ETH_HandleType * heth, uint8_t PhyAddress,
+                                             uint8_t Register, uint16_t * Value);
+XPD_ReturnType  XPD_ETH_PHY_Write           (ETH_HandleType * heth, uint8_t PhyAddress,
+                                             uint8_t Register, uint16_t Value);
+
+void            XPD_ETH_RxRing_Init         (ETH_HandleType * heth, ETH_DescType * Desc, uint8_t Count);
+XPD_ReturnType  XPD_ETH_RxRing_Give         (ETH_HandleType * heth, void * Buffer);
+void *          XPD_ETH_RxRing_Take         (ETH_HandleType * heth, uint16_t * Length);
+boolean_t       XPD_ETH_RxRing_GetTimestamp (ETH_HandleType * heth, ETH_TimeType * Time);
+
+void            XPD_ETH_TxRing_Init         (ETH_HandleType * heth, ETH_DescType * Desc, uint8_t Count);
+XPD_ReturnType  XPD_ETH_Transmit            (ETH_HandleType * heth, const ETH_BufferType * Buffers,
+                                             uint8_t Count, void * Context);
+XPD_ReturnType  XPD_ETH_TransmitTimestamped (ETH_HandleType * heth, const ETH_BufferType * Buffers,
+                                             uint8_t Count, void * Context);
+boolean_t       XPD_ETH_TxRing_Reclaim      (ETH_HandleType * heth, void ** Context);
+boolean_t       XPD_ETH_TxRing_GetTimestamp (ETH_HandleType * heth, ETH_TimeType * Time);
+
+XPD_ReturnType  XPD_ETH_PTP_Init            (ETH_HandleType * heth, const ETH_TimeType * Time);
+void            XPD_ETH_PTP_Deinit          (ETH_HandleType * heth);
+void            XPD_ETH_PTP_GetTime         (ETH_HandleType * heth, ETH_TimeType * Time);
+XPD_ReturnType  XPD_ETH_PTP_SetTime         (ETH_HandleType * heth, const ETH_TimeType * Time);
+XPD_ReturnType  XPD_ETH_PTP_AdjustTime      (ETH_HandleType * heth, int64_t Nanoseconds);
+XPD_ReturnType  XPD_ETH_PTP_AdjustFreq      (ETH_HandleType * heth, int32_t PartsPerBillion);
+XPD_ReturnType  XPD_ETH_PTP_SetTargetTime   (ETH_HandleType * heth, const ETH_TimeType * Time);
+void            XPD_ETH_PTP_TimerTrigger    (FunctionalState NewState);
+
+void            XPD_ETH_IRQHandler          (ETH_HandleType * heth);
+/** @} */
+
+/** @} */
+
+#endif /* ETH */
+
+#define XPD_ETH_API
+#include "xpd_rcc_gen.h"
+#include "xpd_rcc_pc.h"
+#undef XPD_ETH_API
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __XPD_ETH_H_ */
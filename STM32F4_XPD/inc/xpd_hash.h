@@ -0,0 +1,133 @@
+/**
+  ******************************************************************************
+  * @file    xpd_hash.h
+  * @author  Benedek Kupper
+  * @version V0.1
+  * @date    2018-01-20
+  * @brief   STM32 eXtensible Peripheral Drivers Hash Processor Module
+  *
+  *  This file is part of STM32_XPD.
+  *
+  *  STM32_XPD is free software: you can redistribute it and/or modify
+  *  it under the terms of the GNU General Public License as published by
+  *  the Free Software Foundation, either version 3 of the License, or
+  *  (at your option) any later version.
+  *
+  *  STM32_XPD is distributed in the hope that it will be useful,
+  *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with STM32_XPD.  If not, see <http://www.gnu.org/licenses/>.
+  */
+#ifndef __XPD_HASH_H_
+#define __XPD_HASH_H_
+
+#include "xpd_common.h"
+#include "xpd_config.h"
+#include "xpd_dma.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#ifdef HASH
+
+/** @defgroup HASH
+ * @{ */
+
+/** @defgroup HASH_Exported_Types HASH Exported Types
+ * @{ */
+
+/** @brief HASH algorithms */
+typedef enum
+{
+    HASH_SHA1   = 0,                                 /*!< SHA-1, 20 byte digest */
+    HASH_MD5    = HASH_CR_ALGO_0,                    /*!< MD5, 16 byte digest */
+#ifdef HASH_CR_ALGO_1
+    HASH_SHA224 = HASH_CR_ALGO_1,                    /*!< SHA-224, 28 byte digest
+                                                          @note Only available on STM32F43x devices */
+    HASH_SHA256 = HASH_CR_ALGO_1 | HASH_CR_ALGO_0,   /*!< SHA-256, 32 byte digest
+                                                          @note Only available on STM32F43x devices */
+#endif
+}HASH_AlgorithmType;
+
+/** @brief HASH Handle structure */
+typedef struct
+{
+    HASH_TypeDef * Inst;                     /*!< The address of the peripheral instance used by the handle */
+    XPD_CtrlFnType ClockCtrl;                /*!< Function pointer for RCC clock control */
+    struct {
+        XPD_HandleCallbackType DepInit;      /*!< Callback to initialize module dependencies (DMA) */
+        XPD_HandleCallbackType DepDeinit;    /*!< Callback to restore module dependencies (DMA) */
+        XPD_HandleCallbackType Complete;     /*!< DMA data input complete callback */
+    }Callbacks;                              /*   Handle Callbacks */
+    struct {
+        DMA_HandleType * In;                 /*!< DMA handle for input data transfer */
+    }DMA;                                    /*   DMA handle references */
+    struct {
+        const uint8_t * Key;                 /*!< [Internal] The HMAC key (NULL for plain hash) */
+        uint32_t KeyLength;                  /*!< [Internal] The HMAC key length in bytes */
+        uint32_t Pending;                    /*!< [Internal] The incomplete input word */
+        uint8_t PendingCount;                /*!< [Internal] The number of bytes in the incomplete word */
+        uint8_t DigestSize;                  /*!< [Internal] The digest size in bytes */
+    }Context;                                /*   Digest calculation context */
+#ifdef USE_XPD_STATISTICS
+    XPD_StatsType Stats;                     /*!< Runtime statistics */
+#endif
+}HASH_HandleType;
+
+/** @} */
+
+/** @defgroup HASH_Exported_Macros HASH Exported Macros
+ * @{ */
+
+/**
+ * @brief  HASH Handle initializer macro
+ * @param  INSTANCE: specifies the HASH peripheral instance.
+ * @param  INIT_FN: specifies the dependency initialization function to call back.
+ * @param  DEINIT_FN: specifies the dependency deinitialization function to call back.
+ */
+#define         NEW_HASH_HANDLE(INSTANCE, INIT_FN, DEINIT_FN)   \
+    {.Inst = (INSTANCE),                                        \
+     .ClockCtrl = XPD_##INSTANCE##_ClockCtrl,                   \
+     .Callbacks.DepInit   = (INIT_FN),                          \
+     .Callbacks.DepDeinit = (DEINIT_FN)}
+
+/**
+ * @brief  Determines whether a DMA data input is in progress.
+ * @param  HANDLE: specifies the HASH Handle.
+ */
+#define         XPD_HASH_IsBusy(HANDLE)                         \
+    (((HANDLE)->Inst->CR.w & HASH_CR_DMAE) != 0)
+
+/** @} */
+
+/** @addtogroup HASH_Exported_Functions
+ * @{ */
+void            XPD_HASH_Init               (HASH_HandleType * hhash);
+void            XPD_HASH_Deinit             (HASH_HandleType * hhash);
+
+XPD_ReturnType  XPD_HASH_Start              (HASH_HandleType * hhash, HASH_AlgorithmType Algorithm,
+                                             const uint8_t * Key, uint32_t KeyLength);
+void            XPD_HASH_Update             (HASH_HandleType * hhash, const void * Data, uint32_t Length);
+XPD_ReturnType  XPD_HASH_Update_DMA         (HASH_HandleType * hhash, const void * Data, uint32_t Length);
+XPD_ReturnType  XPD_HASH_Finish             (HASH_HandleType * hhash, uint8_t * Digest);
+/** @} */
+
+/** @} */
+
+#endif /* HASH */
+
+#define XPD_HASH_API
+#include "xpd_rcc_gen.h"
+#include "xpd_rcc_pc.h"
+#undef XPD_HASH_API
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __XPD_HASH_H_ */
@@ -0,0 +1,241 @@
+/**
+  ******************************************************************************
+  * @file    xpd_i2c.h
+  * @author  Benedek Kupper
+  * @version V0.1
+  * @date    2018-01-20
+  * @brief   STM32 eXtensible Peripheral Drivers I2C Module
+  *
+  *  This file is part of STM32_XPD.
+  *
+  *  STM32_XPD is free software: you can redistribute it and/or modify
+  *  it under the terms of the GNU General Public License as published by
+  *  the Free Software Foundation, either version 3 of the License, or
+  *  (at your option) any later version.
+  *
+  *  STM32_XPD is distributed in the hope that it will be useful,
+  *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with STM32_XPD.  If not, see <http://www.gnu.org/licenses/>.
+  */
+#ifndef __XPD_I2C_H_
+#define __XPD_I2C_H_
+
+#include "xpd_common.h"
+#include "xpd_config.h"
+#include "xpd_dma.h"
+#include "xpd_os.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/** @defgroup I2C
+ * @{ */
+
+/** @defgroup I2C_Exported_Types I2C Exported Types
+ * @{ */
+
+/** @brief I2C setup structure */
+typedef struct
+{
+    uint32_t        BusFreq;        /*!< Specifies the maximal serial clock frequency in Hz:
+                                         up to 100000 in Standard-mode, 400000 in Fast-mode */
+#ifdef I2C_FLTR_ANOFF
+    FunctionalState AnalogFilter;   /*!< Specifies if the analog noise filter is enabled or not. */
+    uint8_t         DigitalFilter;  /*!< Specifies the digital noise filter length in I2C clock periods.
+                                         This parameter can be a value between 0 (disabled) and 15. */
+#endif
+} I2C_InitType;
+
+/** @brief I2C transfer direction types */
+typedef enum
+{
+    I2C_DIRECTION_WRITE = 0, /*!< Data is transmitted to the slave */
+    I2C_DIRECTION_READ  = 1, /*!< Data is received from the slave */
+}I2C_DirectionType;
+
+/** @brief I2C error types */
+typedef enum
+{
+    I2C_ERROR_NONE        = 0,   /*!< No error */
+    I2C_ERROR_NACK        = 1,   /*!< The slave didn't acknowledge the address or a data byte */
+    I2C_ERROR_BUS         = 2,   /*!< Misplaced START or STOP condition on the bus */
+    I2C_ERROR_ARBITRATION = 4,   /*!< Bus arbitration lost to another master */
+    I2C_ERROR_OVERRUN     = 8,   /*!< Data overrun/underrun */
+    I2C_ERROR_DMA         = 16,  /*!< DMA transfer error */
+}I2C_ErrorType;
+
+/** @brief I2C bus transaction structure */
+typedef struct I2C_TransactionType
+{
+    struct I2C_TransactionType * Next;      /*!< [Internal] The next queued transaction */
+    uint8_t           Address;              /*!< The 7-bit slave address */
+    uint8_t           RegSize;              /*!< The number of register address bytes to transmit
+                                                 before the data (0 if not used, up to 4) */
+    uint32_t          Register;             /*!< The slave register address, transmitted MSB first */
+    I2C_DirectionType Direction;            /*!< The direction of the data transfer */
+    void *            Data;                 /*!< The data to transmit or the buffer of the reception */
+    uint16_t          Length;               /*!< Amount of data bytes */
+    XPD_HandleCallbackType Complete;        /*!< Transaction finished callback, the argument is the transaction */
+    volatile XPD_ReturnType Result;         /*!< BUSY while the transaction is pending, OK if successful, ERROR otherwise */
+    volatile I2C_ErrorType  Errors;         /*!< The errors that occurred during the transaction */
+#ifdef USE_XPD_OS
+    XPD_OS_SignalType Signal;               /*!< [Internal] Completion signal of @ref XPD_I2C_Transfer_Blocking */
+#endif
+}I2C_TransactionType;
+
+/** @brief I2C Handle structure */
+typedef struct
+{
+    I2C_TypeDef * Inst;                      /*!< The address of the peripheral instance used by the handle */
+#ifdef I2C_BB
+    I2C_BitBand_TypeDef * Inst_BB;           /*!< The address of the peripheral instance in the bit-band region */
+#endif
+    XPD_CtrlFnType ClockCtrl;                /*!< Function pointer for RCC clock control */
+    struct {
+        XPD_HandleCallbackType DepInit;      /*!< Callback to initialize module dependencies (GPIOs, IRQs, DMAs) */
+        XPD_HandleCallbackType DepDeinit;    /*!< Callback to restore module dependencies (GPIOs, IRQs, DMAs) */
+        XPD_HandleCallbackType Error;        /*!< Transaction error callback */
+    }Callbacks;                              /*   Handle Callbacks */
+    struct {
+        DMA_HandleType * Transmit;           /*!< DMA handle for data transmission (NULL for interrupt driven transfer) */
+        DMA_HandleType * Receive;            /*!< DMA handle for data reception (NULL for interrupt driven transfer) */
+    }DMA;                                    /*   DMA handle references */
+    DataStreamType Stream;                   /*!< [Internal] Interrupt driven byte stream */
+    volatile I2C_ErrorType Errors;           /*!< Transfer errors of the ongoing transaction */
+    uint32_t BusFreq;                        /*!< [Internal] The serial clock frequency of the initial setup */
+    uint8_t  Phase;                          /*!< [Internal] The phase of the ongoing transaction */
+    uint8_t  Read;                           /*!< [Internal] The ongoing bus transfer is a reception */
+    uint8_t  Restart;                        /*!< [Internal] The repeated START of the next transaction is requested */
+    uint8_t  Pending;                        /*!< [Internal] The DMA transfer of the ongoing transaction is active */
+    uint8_t  RegBuffer[4];                   /*!< [Internal] The register address bytes of the ongoing transaction */
+    struct {
+        I2C_TransactionType * Head;          /*!< [Internal] The ongoing transaction */
+        I2C_TransactionType * Tail;          /*!< [Internal] The last queued transaction */
+    }Queue;                                  /*   Transaction queue */
+#ifdef USE_XPD_STATISTICS
+    XPD_StatsType Stats;                     /*!< Runtime statistics (errors indexed by @ref I2C_ErrorType bits) */
+#endif
+}I2C_HandleType;
+
+/** @} */
+
+/** @defgroup I2C_Exported_Macros I2C Exported Macros
+ * @{ */
+
+#ifdef I2C_BB
+/**
+ * @brief  I2C Handle initializer macro
+ * @param  INSTANCE: specifies the I2C peripheral instance.
+ * @param  INIT_FN: specifies the dependency initialization function to call back.
+ * @param  DEINIT_FN: specifies the dependency deinitialization function to call back.
+ */
+#define         NEW_I2C_HANDLE(INSTANCE, INIT_FN, DEINIT_FN)    \
+    {.Inst = (INSTANCE), .Inst_BB = I2C_BB(INSTANCE),           \
+     .ClockCtrl = XPD_##INSTANCE##_ClockCtrl,                   \
+     .Callbacks.DepInit   = (INIT_FN),                          \
+     .Callbacks.DepDeinit = (DEINIT_FN)}
+
+/**
+ * @brief I2C register bit accessing macro
+ * @param HANDLE: specifies the peripheral handle.
+ * @param REG: specifies the register name.
+ * @param BIT: specifies the register bit name.
+ */
+#define         I2C_REG_BIT(_HANDLE_, _REG_NAME_, _BIT_NAME_)   \
+    ((_HANDLE_)->Inst_BB->_REG_NAME_._BIT_NAME_)
+
+#else
+/**
+ * @brief  I2C Handle initializer macro
+ * @param  INSTANCE: specifies the I2C peripheral instance.
+ * @param  INIT_FN: specifies the dependency initialization function to call back.
+ * @param  DEINIT_FN: specifies the dependency deinitialization function to call back.
+ */
+#define         NEW_I2C_HANDLE(INSTANCE, INIT_FN, DEINIT_FN)    \
+    {.Inst = (INSTANCE),                                        \
+     .ClockCtrl = XPD_##INSTANCE##_ClockCtrl,                   \
+     .Callbacks.DepInit   = (INIT_FN),                          \
+     .Callbacks.DepDeinit = (DEINIT_FN)}
+
+/**
+ * @brief I2C register bit accessing macro
+ * @param HANDLE: specifies the peripheral handle.
+ * @param REG: specifies the register name.
+ * @param BIT: specifies the register bit name.
+ */
+#define         I2C_REG_BIT(_HANDLE_, _REG_NAME_, _BIT_NAME_)   \
+    ((_HANDLE_)->Inst->_REG_NAME_.b._BIT_NAME_)
+
+#endif /* I2C_BB */
+
+/**
+ * @brief  Get the specified I2C flag.
+ * @param  HANDLE: specifies the I2C Handle.
+ * @param  FLAG_NAME: specifies the flag to return.
+ *         This parameter can be one of the following values:
+ *            @arg SB:      Start bit generated
+ *            @arg ADDR:    Address sent
+ *            @arg BTF:     Byte transfer finished
+ *            @arg RXNE:    Receive data register not empty
+ *            @arg TXE:     Transmit data register empty
+ *            @arg BERR:    Bus error
+ *            @arg ARLO:    Arbitration lost
+ *            @arg AF:      Acknowledge failure
+ *            @arg OVR:     Overrun/Underrun
+ */
+#define         XPD_I2C_GetFlag(HANDLE, FLAG_NAME)              \
+    (I2C_REG_BIT((HANDLE),SR1,FLAG_NAME))
+
+/**
+ * @brief  Clear the specified I2C flag.
+ * @param  HANDLE: specifies the I2C Handle.
+ * @param  FLAG_NAME: specifies the flag to clear.
+ *         This parameter can be one of the following values:
+ *            @arg BERR:    Bus error
+ *            @arg ARLO:    Arbitration lost
+ *            @arg AF:      Acknowledge failure
+ *            @arg OVR:     Overrun/Underrun
+ */
+#define         XPD_I2C_ClearFlag(HANDLE, FLAG_NAME)            \
+    (I2C_REG_BIT((HANDLE),SR1,FLAG_NAME) = 0)
+
+/** @} */
+
+/** @addtogroup I2C_Exported_Functions
+ * @{ */
+XPD_ReturnType  XPD_I2C_Init                (I2C_HandleType * hi2c, const I2C_InitType * Config);
+XPD_ReturnType  XPD_I2C_Deinit              (I2C_HandleType * hi2c);
+void            XPD_I2C_Enable              (I2C_HandleType * hi2c);
+void            XPD_I2C_Disable             (I2C_HandleType * hi2c);
+
+XPD_ReturnType  XPD_I2C_GetStatus           (I2C_HandleType * hi2c);
+
+XPD_ReturnType  XPD_I2C_Queue_Submit        (I2C_HandleType * hi2c, I2C_TransactionType * Transaction);
+#ifdef USE_XPD_OS
+XPD_ReturnType  XPD_I2C_Transfer_Blocking   (I2C_HandleType * hi2c, I2C_TransactionType * Transaction,
+                                             uint32_t Timeout);
+#endif
+
+void            XPD_I2C_IRQHandler          (I2C_HandleType * hi2c);
+
+XPD_ReturnType  XPD_I2C_ClockUpdate         (I2C_HandleType * hi2c);
+/** @} */
+
+/** @} */
+
+#define XPD_I2C_API
+#include "xpd_rcc_gen.h"
+#include "xpd_rcc_pc.h"
+#undef XPD_I2C_API
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __XPD_I2C_H_ */
@@ -0,0 +1,180 @@
+/**
+  ******************************************************************************
+  * @file    xpd_i2s.h
+  * @author  Benedek Kupper
+  * @version V0.1
+  * @date    2018-01-20
+  * @brief   STM32 eXtensible Peripheral Drivers I2S Module
+  *
+  *  This file is part of STM32_XPD.
+  *
+  *  STM32_XPD is free software: you can redistribute it and/or modify
+  *  it under the terms of the GNU General Public License as published by
+  *  the Free Software Foundation, either version 3 of the License, or
+  *  (at your option) any later version.
+  *
+  *  STM32_XPD is distributed in the hope that it will be useful,
+  *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with STM32_XPD.  If not, see <http://www.gnu.org/licenses/>.
+  */
+#ifndef __XPD_I2S_H_
+#define __XPD_I2S_H_
+
+#include "xpd_common.h"
+#include "xpd_config.h"
+#include "xpd_dma.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/** @defgroup I2S
+ * @{ */
+
+/** @defgroup I2S_Exported_Types I2S Exported Types
+ * @{ */
+
+/** @brief I2S operating modes */
+typedef enum
+{
+    I2S_MODE_SLAVE_TX  = 0, /*!< Slave transmitter */
+    I2S_MODE_SLAVE_RX  = 1, /*!< Slave receiver */
+    I2S_MODE_MASTER_TX = 2, /*!< Master transmitter */
+    I2S_MODE_MASTER_RX = 3, /*!< Master receiver */
+}I2S_ModeType;
+
+/** @brief I2S frame standards */
+typedef enum
+{
+    I2S_STANDARD_PHILIPS   = 0, /*!< I2S Philips standard */
+    I2S_STANDARD_MSB       = 1, /*!< MSB justified standard */
+    I2S_STANDARD_LSB       = 2, /*!< LSB justified standard */
+    I2S_STANDARD_PCM_SHORT = 3, /*!< PCM standard with short frame synchronization */
+    I2S_STANDARD_PCM_LONG  = 7, /*!< PCM standard with long frame synchronization */
+}I2S_StandardType;
+
+/** @brief I2S data formats */
+typedef enum
+{
+    I2S_DATA_16          = 0, /*!< 16 bit data in 16 bit channel */
+    I2S_DATA_16_EXTENDED = 1, /*!< 16 bit data in 32 bit channel */
+    I2S_DATA_24          = 3, /*!< 24 bit data in 32 bit channel */
+    I2S_DATA_32          = 5, /*!< 32 bit data in 32 bit channel */
+}I2S_DataFormatType;
+
+/** @brief I2S error types */
+typedef enum
+{
+    I2S_ERROR_NONE     = 0, /*!< No error */
+    I2S_ERROR_UNDERRUN = 1, /*!< Transmit data underrun */
+    I2S_ERROR_OVERRUN  = 2, /*!< Receive data overrun */
+    I2S_ERROR_FRAME    = 4, /*!< Frame format error in slave mode */
+    I2S_ERROR_DMA      = 8, /*!< DMA transfer error */
+}I2S_ErrorType;
+
+/** @brief I2S setup structure */
+typedef struct
+{
+    I2S_ModeType       Mode;          /*!< Operating mode of the main instance */
+    I2S_StandardType   Standard;      /*!< Frame standard */
+    I2S_DataFormatType Format;        /*!< Data and channel length */
+    ActiveLevelType    ClockPolarity; /*!< Serial clock steady state */
+    uint32_t           SampleRate;    /*!< Audio sample rate in Hz (only used in master mode) */
+    FunctionalState    MasterClock;   /*!< Master clock output (256 x SampleRate) state */
+    FunctionalState    FullDuplex;    /*!< Full-duplex operation using the I2Sext instance
+                                           in the opposite direction */
+}I2S_InitType;
+
+/** @brief I2S Handle structure */
+typedef struct
+{
+    SPI_TypeDef * Inst;                      /*!< The address of the peripheral instance used by the handle */
+    SPI_TypeDef * Ext;                       /*!< The address of the full-duplex extension instance (NULL if not available) */
+    XPD_CtrlFnType ClockCtrl;                /*!< Function pointer for RCC clock control */
+    struct {
+        XPD_HandleCallbackType DepInit;      /*!< Callback to initialize module dependencies (GPIOs, IRQs, DMAs) */
+        XPD_HandleCallbackType DepDeinit;    /*!< Callback to restore module dependencies (GPIOs, IRQs, DMAs) */
+        XPD_HandleCallbackType BlockReady;   /*!< Streaming block transferred callback */
+#if defined(USE_XPD_I2S_ERROR_DETECT) || defined(USE_XPD_DMA_ERROR_DETECT)
+        XPD_HandleCallbackType Error;        /*!< Error callback */
+#endif
+    }Callbacks;                              /*   Handle Callbacks */
+    struct {
+        DMA_HandleType * Transmit;           /*!< DMA handle for data transmission */
+        DMA_HandleType * Receive;            /*!< DMA handle for data reception */
+    }DMA;                                    /*   DMA handle references */
+    DataStreamType TxBlock;                  /*!< The transmitted block of the stream, which is free to refill */
+    DataStreamType RxBlock;                  /*!< The received block of the stream, which is ready to process */
+    void * TxBuffer;                         /*!< [Internal] The transmit double buffer */
+    void * RxBuffer;                         /*!< [Internal] The receive double buffer */
+    uint32_t SampleRate;                     /*!< The actual sample rate of the master mode setup */
+    uint8_t FrameSize;                       /*!< [Internal] The number of bytes in a stereo frame */
+    uint8_t Duplex;                          /*!< [Internal] The extension instance is used */
+#if defined(USE_XPD_I2S_ERROR_DETECT) || defined(USE_XPD_DMA_ERROR_DETECT)
+    volatile I2S_ErrorType Errors;           /*!< Transfer errors */
+#endif
+#ifdef USE_XPD_STATISTICS
+    XPD_StatsType Stats;                     /*!< Runtime statistics (errors indexed by @ref I2S_ErrorType bits) */
+#endif
+}I2S_HandleType;
+
+/** @} */
+
+/** @defgroup I2S_Exported_Macros I2S Exported Macros
+ * @{ */
+
+/**
+ * @brief  I2S Handle initializer macro
+ * @param  INSTANCE: specifies the SPI peripheral instance used in I2S mode.
+ * @param  EXTENSION: specifies the I2Sext peripheral instance (NULL if not used).
+ * @param  INIT_FN: specifies the dependency initialization function to call back.
+ * @param  DEINIT_FN: specifies the dependency deinitialization function to call back.
+ */
+#define         NEW_I2S_HANDLE(INSTANCE, EXTENSION, INIT_FN, DEINIT_FN) \
+    {.Inst = (INSTANCE), .Ext = (EXTENSION),                    \
+     .ClockCtrl = XPD_##INSTANCE##_ClockCtrl,                   \
+     .Callbacks.DepInit   = (INIT_FN),                          \
+     .Callbacks.DepDeinit = (DEINIT_FN)}
+
+/**
+ * @brief  The ratio of the I2S prescaler output clock and the sample rate
+ *         for the @ref XPD_RCC_PLLI2SAudioConfig setup.
+ * @param  FORMAT: the @ref I2S_DataFormatType of the stream
+ * @param  MCLK: the master clock output state
+ */
+#define         I2S_CLOCK_RATIO(FORMAT, MCLK)                   \
+    (((MCLK) != DISABLE) ? 256 : ((((FORMAT) & 1) != 0) ? 64 : 32))
+
+/** @} */
+
+/** @addtogroup I2S_Exported_Functions
+ * @{ */
+XPD_ReturnType  XPD_I2S_Init                (I2S_HandleType * hi2s, const I2S_InitType * Config);
+XPD_ReturnType  XPD_I2S_Deinit              (I2S_HandleType * hi2s);
+
+XPD_ReturnType  XPD_I2S_Stream_Start        (I2S_HandleType * hi2s, void * TxBuffer,
+                                             void * RxBuffer, uint16_t BlockSize);
+void            XPD_I2S_Stream_Stop         (I2S_HandleType * hi2s);
+
+#ifdef USE_XPD_I2S_ERROR_DETECT
+void            XPD_I2S_IRQHandler          (I2S_HandleType * hi2s);
+#endif
+/** @} */
+
+/** @} */
+
+#define XPD_I2S_API
+#include "xpd_rcc_gen.h"
+#include "xpd_rcc_pc.h"
+#undef XPD_I2S_API
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __XPD_I2S_H_ */
@@ -0,0 +1,194 @@
+/**
+  ******************************************************************************
+  * @file    xpd_ltdc.h
+  * @author  Benedek Kupper
+  * @version V0.1
+  * @date    2018-01-20
+  * @brief   STM32 eXtensible Peripheral Drivers LCD-TFT Display Controller Module
+  *
+  *  This file is part of STM32_XPD.
+  *
+  *  STM32_XPD is free software: you can redistribute it and/or modify
+  *  it under the terms of the GNU General Public License as published by
+  *  the Free Software Foundation, either version 3 of the License, or
+  *  (at your option) any later version.
+  *
+  *  STM32_XPD is distributed in the hope that it will be useful,
+  *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with STM32_XPD.  If not, see <http://www.gnu.org/licenses/>.
+  */
+#ifndef __XPD_LTDC_H_
+#define __XPD_LTDC_H_
+
+#include "xpd_common.h"
+#include "xpd_config.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#ifdef LTDC
+
+/** @defgroup LTDC
+ * @{ */
+
+/** @defgroup LTDC_Exported_Types LTDC Exported Types
+ * @{ */
+
+/** @brief LTDC layer pixel formats */
+typedef enum
+{
+    LTDC_FORMAT_ARGB8888 = 0, /*!< 32 bit ARGB */
+    LTDC_FORMAT_RGB888   = 1, /*!< 24 bit RGB */
+    LTDC_FORMAT_RGB565   = 2, /*!< 16 bit RGB */
+    LTDC_FORMAT_ARGB1555 = 3, /*!< 16 bit ARGB, 1 bit alpha */
+    LTDC_FORMAT_ARGB4444 = 4, /*!< 16 bit ARGB, 4 bit channels */
+    LTDC_FORMAT_L8       = 5, /*!< 8 bit CLUT index */
+    LTDC_FORMAT_AL44     = 6, /*!< 4 bit alpha and 4 bit CLUT index */
+    LTDC_FORMAT_AL88     = 7, /*!< 8 bit alpha and 8 bit CLUT index */
+}LTDC_FormatType;
+
+/** @brief LTDC layer blending modes */
+typedef enum
+{
+    LTDC_BLEND_CONSTANT = 0, /*!< The layer is blended with the constant alpha */
+    LTDC_BLEND_PIXEL    = 1, /*!< The layer is blended with the product of the pixel and constant alpha */
+}LTDC_BlendType;
+
+/** @brief LTDC error types */
+typedef enum
+{
+    LTDC_ERROR_NONE     = 0,      /*!< No error */
+    LTDC_ERROR_UNDERRUN = 1 << 1, /*!< FIFO underrun, the pixel data arrived too late */
+    LTDC_ERROR_TRANSFER = 1 << 2, /*!< Bus error during framebuffer read */
+}LTDC_ErrorType;
+
+/** @brief LTDC display timing and polarity setup structure */
+typedef struct
+{
+    struct {
+        uint16_t Sync;                  /*!< Synchronization pulse length */
+        uint16_t BackPorch;             /*!< Back porch length */
+        uint16_t Active;                /*!< Active display size */
+        uint16_t FrontPorch;            /*!< Front porch length */
+    }Horizontal, Vertical;              /*   Timing in pixel clocks and lines, respectively */
+    struct {
+        uint8_t HSyncHigh : 1;          /*!< Horizontal synchronization is active high */
+        uint8_t VSyncHigh : 1;          /*!< Vertical synchronization is active high */
+        uint8_t DataEnableHigh : 1;     /*!< Data enable is active high */
+        uint8_t ClockInverted : 1;      /*!< Pixel clock output is inverted */
+    }Polarity;                          /*   Signal polarities */
+    uint32_t PixelClock;                /*!< The pixel clock frequency in Hz, set up by PLLSAI */
+    uint32_t BackgroundColor;           /*!< RGB888 color displayed where no layer is active */
+    FunctionalState Dither;             /*!< Dithering of the output when the panel has less than 8 bits per channel */
+}LTDC_InitType;
+
+/** @brief LTDC layer setup structure */
+typedef struct
+{
+    uint16_t X;                         /*!< Horizontal position of the window in the active area */
+    uint16_t Y;                         /*!< Vertical position of the window in the active area */
+    uint16_t Width;                     /*!< Width of the window in pixels */
+    uint16_t Height;                    /*!< Height of the window in lines */
+    LTDC_FormatType Format;             /*!< Framebuffer pixel format */
+    uint16_t Pitch;                     /*!< Framebuffer line distance in pixels, 0 if equals to the width */
+    uint8_t Alpha;                      /*!< Constant alpha of the layer */
+    LTDC_BlendType Blending;            /*!< Blending mode with the lower layers */
+    uint32_t DefaultColor;              /*!< ARGB8888 color outside of the window */
+    void * Buffer;                      /*!< Initial framebuffer */
+}LTDC_LayerInitType;
+
+/** @brief LTDC Handle structure */
+typedef struct
+{
+    LTDC_TypeDef * Inst;                     /*!< The address of the peripheral instance used by the handle */
+    XPD_CtrlFnType ClockCtrl;                /*!< Function pointer for RCC clock control */
+    struct {
+        XPD_HandleCallbackType DepInit;      /*!< Callback to initialize module dependencies (GPIOs, IRQs) */
+        XPD_HandleCallbackType DepDeinit;    /*!< Callback to restore module dependencies (GPIOs, IRQs) */
+        XPD_HandleCallbackType Swapped;      /*!< Framebuffer swap completed at vertical blanking callback */
+        XPD_HandleCallbackType Line;         /*!< Line event callback */
+        XPD_HandleCallbackType Error;        /*!< Underrun or transfer error callback */
+    }Callbacks;                              /*   Handle Callbacks */
+    struct {
+        void * Front;                        /*!< The framebuffer being displayed */
+        void * volatile Pending;             /*!< The framebuffer to display from the next frame */
+    }Layer[2];                               /*   Framebuffer state of the layers */
+    volatile LTDC_ErrorType Errors;          /*!< Transfer errors */
+#ifdef USE_XPD_STATISTICS
+    XPD_StatsType Stats;                     /*!< Runtime statistics (errors indexed by @ref LTDC_ErrorType bits) */
+#endif
+}LTDC_HandleType;
+
+/** @} */
+
+/** @defgroup LTDC_Exported_Macros LTDC Exported Macros
+ * @{ */
+
+/**
+ * @brief  LTDC Handle initializer macro
+ * @param  INSTANCE: specifies the LTDC peripheral instance.
+ * @param  INIT_FN: specifies the dependency initialization function to call back.
+ * @param  DEINIT_FN: specifies the dependency deinitialization function to call back.
+ */
+#define         NEW_LTDC_HANDLE(INSTANCE, INIT_FN, DEINIT_FN)   \
+    {.Inst = (INSTANCE),                                        \
+     .ClockCtrl = XPD_##INSTANCE##_ClockCtrl,                   \
+     .Callbacks.DepInit   = (INIT_FN),                          \
+     .Callbacks.DepDeinit = (DEINIT_FN)}
+
+/**
+ * @brief  Determines whether a framebuffer swap is waiting for the vertical blanking.
+ * @param  HANDLE: specifies the LTDC Handle.
+ * @param  LAYER: the layer index [0, 1]
+ */
+#define         XPD_LTDC_IsSwapPending(HANDLE, LAYER)           \
+    ((HANDLE)->Layer[LAYER].Pending != NULL)
+
+/**
+ * @brief  Gets the framebuffer of the layer that is being displayed.
+ * @param  HANDLE: specifies the LTDC Handle.
+ * @param  LAYER: the layer index [0, 1]
+ */
+#define         XPD_LTDC_GetFrontBuffer(HANDLE, LAYER)          \
+    ((HANDLE)->Layer[LAYER].Front)
+
+/** @} */
+
+/** @addtogroup LTDC_Exported_Functions
+ * @{ */
+XPD_ReturnType  XPD_LTDC_Init               (LTDC_HandleType * hltdc, const LTDC_InitType * Config);
+void            XPD_LTDC_Deinit             (LTDC_HandleType * hltdc);
+
+void            XPD_LTDC_LayerInit          (LTDC_HandleType * hltdc, uint8_t Layer,
+                                             const LTDC_LayerInitType * Config);
+void            XPD_LTDC_LayerCtrl          (LTDC_HandleType * hltdc, uint8_t Layer, FunctionalState NewState);
+void            XPD_LTDC_LayerSetAlpha      (LTDC_HandleType * hltdc, uint8_t Layer, uint8_t Alpha);
+void            XPD_LTDC_LoadCLUT           (LTDC_HandleType * hltdc, uint8_t Layer,
+                                             const uint32_t * Colors, uint16_t Count);
+
+XPD_ReturnType  XPD_LTDC_SwapBuffer         (LTDC_HandleType * hltdc, uint8_t Layer, void * Buffer);
+void            XPD_LTDC_SetLineEvent       (LTDC_HandleType * hltdc, uint16_t Line, FunctionalState NewState);
+
+void            XPD_LTDC_IRQHandler         (LTDC_HandleType * hltdc);
+/** @} */
+
+/** @} */
+
+#endif /* LTDC */
+
+#define XPD_LTDC_API
+#include "xpd_rcc_gen.h"
+#include "xpd_rcc_pc.h"
+#undef XPD_LTDC_API
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __XPD_LTDC_H_ */
@@ -27,6 +27,11 @@
 #include "xpd_common.h"
 #include "xpd_config.h"
 
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
 /** @defgroup PWR
  * @{ */
 
@@ -75,6 +80,15 @@ typedef enum
 #define         XPD_PWR_ClearFlag(FLAG_NAME)    \
     (PWR_REG_BIT(CR,C##FLAG_NAME) = 1)
 
+/** @brief RTC wakeup timer EXTI line number */
+#define PWR_RTC_WAKEUP_EXTI_LINE        22
+
+/** @brief RTC alarms EXTI line number */
+#define PWR_RTC_ALARM_EXTI_LINE         17
+
+/** @brief RTC tamper and timestamp EXTI line number */
+#define PWR_RTC_TAMP_STAMP_EXTI_LINE    21
+
 #ifdef PWR_BB
 #define PWR_REG_BIT(_REG_NAME_, _BIT_NAME_) (PWR_BB->_REG_NAME_._BIT_NAME_)
 #else
@@ -237,6 +251,57 @@ __STATIC_INLINE void XPD_PWR_PVD_Disable(void)
 /** @} */
 
 /** @} */
+
+#ifdef BKPSRAM_BASE
+#include "xpd_dma.h"
+
+/** @defgroup PWR_Checkpoint PWR Brownout Checkpoint
+ *  @brief    Saving of critical RAM buffers to the backup SRAM on supply collapse
+ *  @details  The PVD interrupt is raised when the supply falls below the selected level,
+ *            and the registered buffers are copied to the backup SRAM within the holdup time
+ *            of the supply. The checkpoint is only valid when all buffers are saved,
+ *            it can be restored once at the next startup.
+ * @{ */
+
+/** @defgroup PWR_Checkpoint_Exported_Types PWR Checkpoint Exported Types
+ * @{ */
+
+/** @brief Checkpoint buffer descriptor */
+typedef struct
+{
+    void *   Data;                      /*!< The critical RAM buffer */
+    uint16_t Size;                      /*!< The size of the buffer in bytes */
+}PWR_CheckpointRegionType;
+
+/** @brief Checkpoint configuration structure */
+typedef struct
+{
+    const PWR_CheckpointRegionType * Regions; /*!< The buffers to save, has to remain valid while in use */
+    uint8_t                 Count;      /*!< The number of buffers */
+    PWR_PVDLevelType        Level;      /*!< The supply level below which the checkpoint is saved */
+    DMA_MemEngineType *     Engine;     /*!< The memory operation engine to copy with, or NULL for CPU copy */
+    XPD_SimpleCallbackType  Complete;   /*!< Callback when the checkpoint is saved */
+}PWR_Checkpoint_InitType;
+
+/** @} */
+
+/** @defgroup PWR_Checkpoint_Exported_Macros PWR Checkpoint Exported Macros
+ * @{ */
+
+/** @brief The available backup SRAM space for the buffers (each buffer is padded to word size) */
+#define PWR_CHECKPOINT_CAPACITY         (4096 - 8)
+
+/** @} */
+
+/** @addtogroup PWR_Checkpoint_Exported_Functions
+ * @{ */
+XPD_ReturnType  XPD_PWR_Checkpoint_Init     (const PWR_Checkpoint_InitType * Config);
+void            XPD_PWR_Checkpoint_Save     (void);
+XPD_ReturnType  XPD_PWR_Checkpoint_Restore  (void);
+/** @} */
+
+/** @} */
+#endif /* BKPSRAM_BASE */
 #endif /* PWR_CR_PLS */
 
 #ifdef PWR_CR_VOS
@@ -276,7 +341,7 @@ void            XPD_PWR_RegLowVoltageConfig (PWR_RegulatorType Regulator, Functi
  */
 __STATIC_INLINE PWR_RegVoltScaleType XPD_PWR_GetVoltageScale(void)
 {
-    return PWR->CR.b.VOS;
+    return (PWR_RegVoltScaleType)PWR->CR.b.VOS;
 }
 
 /** @} */
@@ -299,4 +364,8 @@ XPD_ReturnType  XPD_PWR_OverDrive_Disable   (void);
 
 /** @} */
 
+#ifdef __cplusplus
+}
+#endif
+
 #endif /* __XPD_PWR_H_ */
@@ -26,6 +26,12 @@
 
 #include "xpd_common.h"
 #include "xpd_config.h"
+#include "xpd_pwr.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
 
 /** @addtogroup RCC
  * @{ */
@@ -81,6 +87,20 @@ typedef struct
                                   @arg @ref RCC_OscType::HSE */
 }RCC_PLL_InitType;
 
+#ifdef RCC_CR_PLLI2SON
+/** @brief PLLI2S setup structure */
+typedef struct
+{
+    uint16_t N; /*!< Multiplication factor for PLLI2S VCO input [50 .. 432],
+                     the VCO input is the main PLL input clock divided by its M factor */
+#ifdef RCC_PLLI2SCFGR_PLLI2SQ
+    uint8_t  Q; /*!< Division factor for SAI clock [2 .. 15] */
+#endif
+    uint8_t  R; /*!< Division factor for I2S clock [2 .. 7] */
+    FunctionalState State; /*!< PLLI2S state */
+}RCC_PLLI2S_InitType;
+#endif
+
 /** @brief RCC core clock types */
 typedef enum
 {
@@ -136,6 +156,33 @@ typedef struct {
     XPD_SimpleCallbackType CSS;      /*!< Clock Security System callback */
 }XPD_RCC_CallbacksType;
 
+/** @brief RCC clock change listener structure */
+typedef struct RCC_ClockListenerType
+{
+    struct RCC_ClockListenerType * Next; /*!< [Internal] The next registered listener */
+    XPD_HandleCallbackType Callback;     /*!< Clock change callback, called with the Handle as argument */
+    void *                 Handle;       /*!< The handle of the peripheral with clock dependent settings */
+}RCC_ClockListenerType;
+
+/** @brief RCC operating point setup structure */
+typedef struct
+{
+    const RCC_PLL_InitType * PLL;       /*!< PLL configuration (NULL if the PLL is left unchanged) */
+#ifdef HSE_VALUE
+    RCC_OscStateType     HSE_State;     /*!< HSE state to start it with if it's not ready (OSC_OFF if the HSE is not needed) */
+#endif
+#ifdef PWR_CR_VOS
+    PWR_RegVoltScaleType VoltageScale;  /*!< Regulator voltage scaling */
+#endif
+#ifdef PWR_CR_ODEN
+    FunctionalState      OverDrive;     /*!< Regulator over-drive mode */
+#endif
+    RCC_OscType      SYSCLK_Source;     /*!< SYSCLK input source */
+    ClockDividerType HCLK_Divider;      /*!< Clock divider of HCLK. Must not be CLK_DIV32. */
+    ClockDividerType PCLK1_Divider;     /*!< Clock divider of PCLK1 */
+    ClockDividerType PCLK2_Divider;     /*!< Clock divider of PCLK2 */
+}RCC_OperatingPointType;
+
 /** @} */
 
 /** @defgroup RCC_Core_Exported_Variables RCC Core Exported Variables
@@ -221,6 +268,15 @@ extern XPD_RCC_CallbacksType XPD_RCC_Callbacks;
 XPD_ReturnType      XPD_RCC_HSIConfig           (FunctionalState NewState);
 XPD_ReturnType      XPD_RCC_LSIConfig           (FunctionalState NewState);
 XPD_ReturnType      XPD_RCC_PLLConfig           (const RCC_PLL_InitType * Config);
+#ifdef RCC_CR_PLLI2SON
+XPD_ReturnType      XPD_RCC_PLLI2SConfig        (const RCC_PLLI2S_InitType * Config);
+XPD_ReturnType      XPD_RCC_PLLI2SAudioConfig   (uint32_t SampleRate, uint16_t ClockRatio);
+uint32_t            XPD_RCC_GetPLLI2SFreq       (void);
+#endif
+#ifdef RCC_DCKCFGR_PLLSAIDIVR
+XPD_ReturnType      XPD_RCC_LTDCClockConfig     (uint32_t PixelClock);
+uint32_t            XPD_RCC_GetLTDCFreq         (void);
+#endif
 #ifdef HSE_VALUE
 XPD_ReturnType      XPD_RCC_HSEConfig           (RCC_OscStateType NewState);
 #endif
@@ -245,6 +301,16 @@ void                XPD_RCC_PCLKConfig          (RCC_ClockType PCLKx, ClockDivid
 uint32_t            XPD_RCC_GetClockFreq        (RCC_ClockType SelectedClock);
 /** @} */
 
+/** @addtogroup RCC_Core_Clocks_Exported_Functions_Scaling
+ * @{ */
+XPD_ReturnType      XPD_RCC_OperatingPointConfig(const RCC_OperatingPointType * Config);
+XPD_ReturnType      XPD_RCC_OperatingPointConfig_IT(const RCC_OperatingPointType * Config);
+XPD_ReturnType      XPD_RCC_OperatingPointComplete  (void);
+
+void                XPD_RCC_ClockListener_Register  (RCC_ClockListenerType * Listener);
+void                XPD_RCC_ClockListener_Unregister(RCC_ClockListenerType * Listener);
+/** @} */
+
 /** @addtogroup RCC_Core_Clocks_Exported_Functions_MCO
  * @{ */
 void                XPD_RCC_MCO_Init            (uint8_t MCOx, uint8_t MCOSource,
@@ -256,6 +322,11 @@ void                XPD_RCC_MCO_Deinit          (uint8_t MCOx);
  *  @brief    RCC Clock Security System
  * @{
  */
+#ifdef HSE_VALUE
+void                XPD_RCC_CSS_Init            (const RCC_OperatingPointType * Nominal);
+void                XPD_RCC_CSS_Failover        (void);
+XPD_ReturnType      XPD_RCC_CSS_Retry           (void);
+#endif
 
 /**
  * @brief RCC interrupt handler that provides Clock Security System callback.
@@ -268,6 +339,11 @@ __STATIC_INLINE void XPD_NMI_IRQHandler(void)
         /* Clear RCC CSS pending bit */
         XPD_RCC_ClearFlag(CSS);
 
+#ifdef HSE_VALUE
+        /* Recover the clocks on HSI */
+        XPD_RCC_CSS_Failover();
+#endif
+
         /* RCC Clock Security System interrupt user callback */
         XPD_SAFE_CALLBACK(XPD_RCC_Callbacks.CSS,);
     }
@@ -287,6 +363,7 @@ __STATIC_INLINE void XPD_RCC_CSS(FunctionalState NewState)
 /** @addtogroup RCC_Core_Clocks_Exported_Functions_Reset
  * @{ */
 void                XPD_RCC_Deinit              (void);
+void                XPD_RCC_ClockTreeSync       (void);
 
 void                XPD_RCC_ResetAHB1           (void);
 void                XPD_RCC_ResetAHB2           (void);
@@ -303,4 +380,8 @@ RCC_ResetSourceType XPD_RCC_GetResetSource      (boolean_t Destructive);
 
 /** @} */
 
+#ifdef __cplusplus
+}
+#endif
+
 #endif /* __XPD_RCC_CC_H_ */
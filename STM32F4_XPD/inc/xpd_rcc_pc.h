@@ -39,6 +39,35 @@ uint32_t        XPD_I2C_GetClockFreq        (I2C_HandleType * hi2c);
 
 /** @} */
 
+#elif defined(XPD_I2S_API)
+
+/** @addtogroup I2S
+ * @{ */
+
+/** @defgroup I2S_Clock_Source I2S Clock Source
+ * @{ */
+
+/** @defgroup I2S_Clock_Source_Exported_Types I2S Clock Source Exported Types
+ * @{ */
+
+/** @brief I2S clock source types */
+typedef enum
+{
+    I2S_CLOCKSOURCE_PLLI2S = 0, /*!< PLLI2S R output clock source */
+    I2S_CLOCKSOURCE_EXT    = 1, /*!< External clock source on the I2S_CKIN pin */
+}I2S_ClockSourceType;
+/** @} */
+
+/** @addtogroup I2S_Clock_Source_Exported_Functions
+ * @{ */
+void            XPD_I2S_ClockConfig         (I2S_ClockSourceType ClockSource);
+uint32_t        XPD_I2S_GetClockFreq        (void);
+/** @} */
+
+/** @} */
+
+/** @} */
+
 #elif defined(XPD_RTC_API)
 /** @addtogroup RTC
  * @{ */
@@ -73,6 +102,23 @@ uint32_t        XPD_RTC_GetClockFreq        (void);
 
 /** @} */
 
+#elif defined(XPD_SPI_API)
+
+/** @addtogroup SPI
+ * @{ */
+
+/** @defgroup SPI_Clock_Source SPI Clock Source
+ * @{ */
+
+/** @addtogroup SPI_Clock_Source_Exported_Functions
+ * @{ */
+uint32_t        XPD_SPI_GetClockFreq        (SPI_HandleType * hspi);
+/** @} */
+
+/** @} */
+
+/** @} */
+
 #elif defined(XPD_TIM_API)
 
 /** @addtogroup TIM
@@ -0,0 +1,96 @@
+/**
+  ******************************************************************************
+  * @file    xpd_rng.h
+  * @author  Benedek Kupper
+  * @version V0.1
+  * @date    2018-01-20
+  * @brief   STM32 eXtensible Peripheral Drivers RNG Module
+  *
+  *  This file is part of STM32_XPD.
+  *
+  *  STM32_XPD is free software: you can redistribute it and/or modify
+  *  it under the terms of the GNU General Public License as published by
+  *  the Free Software Foundation, either version 3 of the License, or
+  *  (at your option) any later version.
+  *
+  *  STM32_XPD is distributed in the hope that it will be useful,
+  *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with STM32_XPD.  If not, see <http://www.gnu.org/licenses/>.
+  */
+#ifndef __XPD_RNG_H_
+#define __XPD_RNG_H_
+
+#include "xpd_common.h"
+#include "xpd_config.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/** @defgroup RNG
+ * @{ */
+
+/** @defgroup RNG_Exported_Types RNG Exported Types
+ * @{ */
+
+/** @brief RNG error types */
+typedef enum
+{
+    RNG_ERROR_NONE  = 0,            /*!< No error */
+    RNG_ERROR_CLOCK = RNG_SR_CEIS,  /*!< The RNG clock is too slow compared to the AHB clock */
+    RNG_ERROR_SEED  = RNG_SR_SEIS,  /*!< Faulty sequence detected in the analog seed */
+}RNG_ErrorType;
+
+/** @brief RNG callbacks container structure */
+typedef struct {
+    XPD_ValueCallbackType Error;    /*!< Generation error callback, the passed parameter is the @ref RNG_ErrorType */
+}XPD_RNG_CallbacksType;
+
+/** @} */
+
+/** @defgroup RNG_Exported_Variables RNG Exported Variables
+ * @{ */
+
+/** @brief RNG callbacks container struct */
+extern XPD_RNG_CallbacksType XPD_RNG_Callbacks;
+
+/** @} */
+
+/** @defgroup RNG_Exported_Macros RNG Exported Macros
+ * @{ */
+
+#ifndef RNG_POOL_SIZE
+/** @brief The number of 32-bit random words held in the entropy pool [overrideable] */
+#define RNG_POOL_SIZE           16
+#endif
+
+/** @} */
+
+/** @addtogroup RNG_Exported_Functions
+ * @{ */
+void            XPD_RNG_Init            (void);
+void            XPD_RNG_Deinit          (void);
+
+uint32_t        XPD_RNG_Available       (void);
+XPD_ReturnType  XPD_RNG_Read            (void * Buffer, uint32_t Length);
+
+void            XPD_RNG_IRQHandler      (void);
+/** @} */
+
+/** @} */
+
+#define XPD_RNG_API
+#include "xpd_rcc_gen.h"
+#include "xpd_rcc_pc.h"
+#undef XPD_RNG_API
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __XPD_RNG_H_ */
@@ -0,0 +1,167 @@
+/**
+  ******************************************************************************
+  * @file    xpd_sdmmc.h
+  * @author  Benedek Kupper
+  * @version V0.1
+  * @date    2018-01-20
+  * @brief   STM32 eXtensible Peripheral Drivers SDMMC Module
+  *
+  *  This file is part of STM32_XPD.
+  *
+  *  STM32_XPD is free software: you can redistribute it and/or modify
+  *  it under the terms of the GNU General Public License as published by
+  *  the Free Software Foundation, either version 3 of the License, or
+  *  (at your option) any later version.
+  *
+  *  STM32_XPD is distributed in the hope that it will be useful,
+  *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with STM32_XPD.  If not, see <http://www.gnu.org/licenses/>.
+  */
+#ifndef __XPD_SDMMC_H_
+#define __XPD_SDMMC_H_
+
+#include "xpd_common.h"
+#include "xpd_config.h"
+#include "xpd_dma.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/** @defgroup SDMMC
+ * @{ */
+
+/** @defgroup SDMMC_Exported_Types SDMMC Exported Types
+ * @{ */
+
+#ifdef SDIO
+/** @brief The SDIO peripheral has the same register layout as the SDMMC */
+typedef SDIO_TypeDef SDMMC_TypeDef;
+#endif
+
+/** @brief SD card capacity types */
+typedef enum
+{
+    SDMMC_CARD_SDSC = 0, /*!< Standard capacity card, byte addressed */
+    SDMMC_CARD_SDHC = 1, /*!< High or extended capacity card, block addressed */
+}SDMMC_CardType;
+
+/** @brief SD card request operations */
+typedef enum
+{
+    SDMMC_OPERATION_READ  = 0, /*!< Blocks are read from the card */
+    SDMMC_OPERATION_WRITE = 1, /*!< Blocks are written to the card */
+}SDMMC_OperationType;
+
+/** @brief SDMMC error types */
+typedef enum
+{
+    SDMMC_ERROR_NONE         = 0,  /*!< No error */
+    SDMMC_ERROR_COMMAND      = 1,  /*!< Command response timeout or CRC error */
+    SDMMC_ERROR_CARD         = 2,  /*!< The card status reports an error */
+    SDMMC_ERROR_DATA_CRC     = 4,  /*!< Data block CRC error */
+    SDMMC_ERROR_DATA_TIMEOUT = 8,  /*!< Data timeout */
+    SDMMC_ERROR_OVERRUN      = 16, /*!< Data FIFO overrun or underrun */
+    SDMMC_ERROR_DMA          = 32, /*!< DMA transfer error */
+}SDMMC_ErrorType;
+
+/** @brief SDMMC setup structure */
+typedef struct
+{
+    FunctionalState WideBus;        /*!< The 4-bit data bus is used instead of the single data line */
+    FunctionalState HighSpeed;      /*!< The card is switched to high speed mode (50 MHz bus class)
+                                         if it supports it */
+    FunctionalState ClockPowerSave; /*!< The bus clock is only output while the bus is active */
+}SDMMC_InitType;
+
+/** @brief SD card block transfer request structure */
+typedef struct
+{
+    SDMMC_OperationType Operation;          /*!< The direction of the request */
+    uint32_t            BlockAddress;       /*!< The index of the first 512 byte block */
+    uint16_t            BlockCount;         /*!< The number of consecutive blocks [1 .. 511] */
+    void *              Buffer;             /*!< The word aligned data buffer of BlockCount * 512 bytes */
+    XPD_HandleCallbackType Complete;        /*!< Request finished callback, the argument is the request */
+    volatile XPD_ReturnType  Result;        /*!< BUSY while the request is pending, OK if successful, ERROR otherwise */
+    volatile SDMMC_ErrorType Errors;        /*!< The errors that occurred during the request */
+}SDMMC_RequestType;
+
+/** @brief SDMMC Handle structure */
+typedef struct
+{
+    SDMMC_TypeDef * Inst;                    /*!< The address of the peripheral instance used by the handle */
+    XPD_CtrlFnType ClockCtrl;                /*!< Function pointer for RCC clock control */
+    struct {
+        XPD_HandleCallbackType DepInit;      /*!< Callback to initialize module dependencies (GPIOs, IRQs, DMAs) */
+        XPD_HandleCallbackType DepDeinit;    /*!< Callback to restore module dependencies (GPIOs, IRQs, DMAs) */
+#if defined(USE_XPD_SDMMC_ERROR_DETECT) || defined(USE_XPD_DMA_ERROR_DETECT)
+        XPD_HandleCallbackType Error;        /*!< Request error callback */
+#endif
+    }Callbacks;                              /*   Handle Callbacks */
+    struct {
+        DMA_HandleType * Transmit;           /*!< DMA handle for block writes */
+        DMA_HandleType * Receive;            /*!< DMA handle for block reads */
+    }DMA;                                    /*   DMA handle references */
+    SDMMC_RequestType * volatile Request;    /*!< [Internal] The ongoing request */
+    SDMMC_CardType CardType;                 /*!< The capacity type of the identified card */
+    uint32_t Capacity;                       /*!< The number of 512 byte blocks of the card */
+    uint32_t BusFreq;                        /*!< The bus clock frequency of the data transfers */
+    uint16_t RCA;                            /*!< [Internal] The relative card address */
+#ifdef USE_XPD_STATISTICS
+    XPD_StatsType Stats;                     /*!< Runtime statistics (errors indexed by @ref SDMMC_ErrorType bits) */
+#endif
+}SDMMC_HandleType;
+
+/** @} */
+
+/** @defgroup SDMMC_Exported_Macros SDMMC Exported Macros
+ * @{ */
+
+/**
+ * @brief  SDMMC Handle initializer macro
+ * @param  INSTANCE: specifies the SDMMC (SDIO) peripheral instance.
+ * @param  INIT_FN: specifies the dependency initialization function to call back.
+ * @param  DEINIT_FN: specifies the dependency deinitialization function to call back.
+ */
+#define         NEW_SDMMC_HANDLE(INSTANCE, INIT_FN, DEINIT_FN)  \
+    {.Inst = (INSTANCE),                                        \
+     .ClockCtrl = XPD_##INSTANCE##_ClockCtrl,                   \
+     .Callbacks.DepInit   = (INIT_FN),                          \
+     .Callbacks.DepDeinit = (DEINIT_FN)}
+
+/**
+ * @brief  Determines whether a request is being processed by the handle.
+ * @param  HANDLE: specifies the SDMMC Handle.
+ */
+#define         XPD_SDMMC_IsBusy(HANDLE)                        \
+    ((HANDLE)->Request != NULL)
+
+/** @} */
+
+/** @addtogroup SDMMC_Exported_Functions
+ * @{ */
+XPD_ReturnType  XPD_SDMMC_Init              (SDMMC_HandleType * hsd, const SDMMC_InitType * Config);
+XPD_ReturnType  XPD_SDMMC_Deinit            (SDMMC_HandleType * hsd);
+
+XPD_ReturnType  XPD_SDMMC_Submit            (SDMMC_HandleType * hsd, SDMMC_RequestType * Request);
+
+void            XPD_SDMMC_IRQHandler        (SDMMC_HandleType * hsd);
+/** @} */
+
+/** @} */
+
+#define XPD_SDMMC_API
+#include "xpd_rcc_gen.h"
+#include "xpd_rcc_pc.h"
+#undef XPD_SDMMC_API
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __XPD_SDMMC_H_ */
@@ -0,0 +1,157 @@
+/**
+  ******************************************************************************
+  * @file    xpd_sdram.h
+  * @author  Benedek Kupper
+  * @version V0.1
+  * @date    2018-01-20
+  * @brief   STM32 eXtensible Peripheral Drivers FMC SDRAM Module
+  *
+  *  This file is part of STM32_XPD.
+  *
+  *  STM32_XPD is free software: you can redistribute it and/or modify
+  *  it under the terms of the GNU General Public License as published by
+  *  the Free Software Foundation, either version 3 of the License, or
+  *  (at your option) any later version.
+  *
+  *  STM32_XPD is distributed in the hope that it will be useful,
+  *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with STM32_XPD.  If not, see <http://www.gnu.org/licenses/>.
+  */
+#ifndef __XPD_SDRAM_H_
+#define __XPD_SDRAM_H_
+
+#include "xpd_common.h"
+#include "xpd_config.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#ifdef FMC_Bank5_6
+
+/** @defgroup SDRAM
+ * @{ */
+
+/** @defgroup SDRAM_Exported_Macros SDRAM Exported Macros
+ * @{ */
+
+/** @brief Start address of the SDRAM banks */
+#define SDRAM_BANK1_ADDRESS     0xC0000000
+#define SDRAM_BANK2_ADDRESS     0xD0000000
+
+/**
+ * @brief  Places the variable in the .sdram output section. The start of the buffer
+ *         is aligned to the largest DMA burst (16 beats of words), so bursts
+ *         selected by @ref XPD_DMA_SelectBurst don't cross the 1 kB boundaries.
+ * @note   The linker script has to place the section to the SDRAM bank
+ *         without initialization, e.g.:
+ *         MEMORY   { SDRAM (rw) : ORIGIN = 0xD0000000, LENGTH = 8M }
+ *         SECTIONS { .sdram (NOLOAD) : { *(.sdram) *(.sdram*) } >SDRAM }
+ *         The default memory map marks the SDRAM banks as device memory,
+ *         which doesn't allow unaligned CPU accesses.
+ */
+#define SDRAM_SECTION           __attribute__((section(".sdram"), aligned(64)))
+
+/** @} */
+
+/** @defgroup SDRAM_Exported_Types SDRAM Exported Types
+ * @{ */
+
+/** @brief SDRAM bank selection */
+typedef enum
+{
+    SDRAM_BANK1 = 0, /*!< Bank 1 at 0xC0000000, SDCKE0 and SDNE0 pins */
+    SDRAM_BANK2 = 1, /*!< Bank 2 at 0xD0000000, SDCKE1 and SDNE1 pins */
+}SDRAM_BankType;
+
+/** @brief SDRAM data bus width */
+typedef enum
+{
+    SDRAM_BUS_8BIT  = 0, /*!< 8 bit data bus */
+    SDRAM_BUS_16BIT = 1, /*!< 16 bit data bus */
+    SDRAM_BUS_32BIT = 2, /*!< 32 bit data bus */
+}SDRAM_BusWidthType;
+
+/** @brief SDRAM setup structure */
+typedef struct
+{
+    uint8_t ColumnBits;             /*!< The number of column address bits [8 .. 11] */
+    uint8_t RowBits;                /*!< The number of row address bits [11 .. 13] */
+    SDRAM_BusWidthType BusWidth;    /*!< The memory data bus width */
+    uint8_t InternalBanks;          /*!< The number of internal banks [2, 4] */
+    uint8_t CASLatency;             /*!< The CAS latency in memory clock cycles [1 .. 3] */
+    uint8_t ClockDivider;           /*!< The memory clock is HCLK divided by [2, 3] */
+    FunctionalState ReadBurst;      /*!< Consecutive single reads are managed as bursts,
+                                         recommended for DMA and CPU sequential reads */
+    uint8_t ReadPipeDelay;          /*!< Read data sampling delay in HCLK cycles [0 .. 2] */
+    struct {
+        uint8_t LoadToActive;       /*!< tMRD: load mode register to active command delay (in clock cycles) */
+        uint8_t ExitSelfRefresh;    /*!< tXSR: exit self-refresh to active command delay (in ns) */
+        uint8_t SelfRefresh;        /*!< tRAS: minimal self-refresh period (in ns) */
+        uint8_t RowCycle;           /*!< tRC: refresh to active and active to active command delay (in ns) */
+        uint8_t WriteRecovery;      /*!< tWR: write to precharge command delay (in clock cycles) */
+        uint8_t RowPrecharge;       /*!< tRP: precharge to other command delay (in ns) */
+        uint8_t RowToColumn;        /*!< tRCD: active to read/write command delay (in ns) */
+    }Timing;                        /*   Memory timing parameters from the datasheet */
+    uint16_t RefreshPeriod;         /*!< The period in which all rows have to be refreshed (in ms) */
+}SDRAM_InitType;
+
+/** @brief SDRAM Handle structure */
+typedef struct
+{
+    SDRAM_BankType Bank;                     /*!< The FMC SDRAM bank used by the handle */
+    XPD_CtrlFnType ClockCtrl;                /*!< Function pointer for RCC clock control */
+    struct {
+        XPD_HandleCallbackType DepInit;      /*!< Callback to initialize module dependencies (GPIOs) */
+        XPD_HandleCallbackType DepDeinit;    /*!< Callback to restore module dependencies (GPIOs) */
+    }Callbacks;                              /*   Handle Callbacks */
+    void * Address;                          /*!< The start address of the memory */
+    uint32_t Size;                           /*!< The size of the memory in bytes */
+}SDRAM_HandleType;
+
+/** @} */
+
+/** @addtogroup SDRAM_Exported_Macros
+ * @{ */
+
+/**
+ * @brief  SDRAM Handle initializer macro
+ * @param  BANK: specifies the SDRAM bank (1 or 2).
+ * @param  INIT_FN: specifies the dependency initialization function to call back.
+ * @param  DEINIT_FN: specifies the dependency deinitialization function to call back.
+ */
+#define         NEW_SDRAM_HANDLE(BANK, INIT_FN, DEINIT_FN)      \
+    {.Bank = SDRAM_BANK##BANK,                                  \
+     .ClockCtrl = XPD_FMC_ClockCtrl,                            \
+     .Callbacks.DepInit   = (INIT_FN),                          \
+     .Callbacks.DepDeinit = (DEINIT_FN)}
+
+/** @} */
+
+/** @addtogroup SDRAM_Exported_Functions
+ * @{ */
+XPD_ReturnType  XPD_SDRAM_Init              (SDRAM_HandleType * hsdram, const SDRAM_InitType * Config);
+XPD_ReturnType  XPD_SDRAM_Deinit            (SDRAM_HandleType * hsdram);
+
+XPD_ReturnType  XPD_SDRAM_SelfRefresh       (SDRAM_HandleType * hsdram, FunctionalState NewState);
+/** @} */
+
+/** @} */
+
+#endif /* FMC_Bank5_6 */
+
+#define XPD_SDRAM_API
+#include "xpd_rcc_gen.h"
+#include "xpd_rcc_pc.h"
+#undef XPD_SDRAM_API
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __XPD_SDRAM_H_ */
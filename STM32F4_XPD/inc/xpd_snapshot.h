@@ -0,0 +1,128 @@
+/**
+  ******************************************************************************
+  * @file    xpd_snapshot.h
+  * @author  Benedek Kupper
+  * @version V0.1
+  * @date    2018-01-20
+  * @brief   STM32 eXtensible Peripheral Drivers Register Snapshot Module
+  *
+  *  This file is part of STM32_XPD.
+  *
+  *  STM32_XPD is free software: you can redistribute it and/or modify
+  *  it under the terms of the GNU General Public License as published by
+  *  the Free Software Foundation, either version 3 of the License, or
+  *  (at your option) any later version.
+  *
+  *  STM32_XPD is distributed in the hope that it will be useful,
+  *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with STM32_XPD.  If not, see <http://www.gnu.org/licenses/>.
+  */
+#ifndef __XPD_SNAPSHOT_H_
+#define __XPD_SNAPSHOT_H_
+
+#include "xpd_common.h"
+#include "xpd_config.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/** @defgroup SNAPSHOT
+ *  @brief    Peripheral register image capture and bulk restore
+ *  @details  The register contents of the initialized peripherals are captured into an image,
+ *            which is stored in a memory retained through the low power mode (backup SRAM,
+ *            SRAM2 in Standby) or programmed to flash after the first boot. On wakeup the
+ *            registers are written back from the image instead of the full peripheral initialization.
+ *            The image is only accepted if the register layout and the application configuration key
+ *            match the ones it was captured with, and its contents are intact.
+ *            The regions are restored in the listed order, so the pin configurations and
+ *            the dependent registers have to come before the enabling ones. The ENABLE bits
+ *            of a region's first register can be held until the rest of the region is written.
+ *  @code
+    static const SNAPSHOT_RegionType regions[] = {
+        { .Registers = &GPIOA->ODR,     .Count = 1, .ClockCtrl = XPD_GPIOA_ClockCtrl },
+        { .Registers = &GPIOA->AFR[0],  .Count = 2 },
+        { .Registers = &GPIOA->MODER,   .Count = 4 },
+        { .Registers = &USART2->CR1.w,  .Count = 4, .Hold = USART_CR1_UE,
+          .ClockCtrl = XPD_USART2_ClockCtrl },
+    };
+    SNAPSHOT_InitType snap = { .Regions = regions, .Count = 4 };
+
+    snap.Key = XPD_Snapshot_Hash(SNAPSHOT_HASH_INIT, &usartConfig, sizeof(usartConfig));
+    if (XPD_Snapshot_Restore(&snap, retainedImage) != XPD_OK)
+    {
+        // full initialization ...
+        XPD_Snapshot_Capture(&snap, retainedImage, sizeof(retainedImage) / sizeof(uint32_t));
+    }
+ *  @endcode
+ *  @note     The software states of the driver handles are not part of the image, those have to be
+ *            kept in retained memory or set up again. Peripherals which require a handshake
+ *            for their configuration (e.g. the CAN controller initialization mode)
+ *            can't be restored by register writes only.
+ * @{ */
+
+/** @defgroup SNAPSHOT_Exported_Types SNAPSHOT Exported Types
+ * @{ */
+
+/** @brief Snapshot register region structure */
+typedef struct
+{
+    volatile uint32_t * Registers;      /*!< The first register of the consecutive region */
+    uint16_t            Count;          /*!< The number of registers in the region */
+    uint32_t            Hold;           /*!< The bits of the first register which are only set
+                                             after the rest of the region is restored */
+    XPD_CtrlFnType      ClockCtrl;      /*!< The clock control of the peripheral, NULL if not needed */
+}SNAPSHOT_RegionType;
+
+/** @brief Snapshot setup structure */
+typedef struct
+{
+    const SNAPSHOT_RegionType * Regions;/*!< The captured regions in their restore order */
+    uint8_t                     Count;  /*!< The number of regions */
+    uint32_t                    Key;    /*!< The identifier of the application configuration,
+                                             e.g. the hash of the peripheral setup structures */
+}SNAPSHOT_InitType;
+
+/** @} */
+
+/** @defgroup SNAPSHOT_Exported_Macros SNAPSHOT Exported Macros
+ * @{ */
+
+/** @brief The initial value of the snapshot hash calculation */
+#define SNAPSHOT_HASH_INIT      0x811C9DC5UL
+
+/** @brief The number of words in the image header */
+#define SNAPSHOT_HEADER_WORDS   3
+
+/**
+ * @brief  Provides the size of the image in words.
+ * @param  REGISTERS: the total number of registers in the regions
+ */
+#define SNAPSHOT_IMAGE_WORDS(REGISTERS)                     \
+    (SNAPSHOT_HEADER_WORDS + (REGISTERS))
+
+/** @} */
+
+/** @addtogroup SNAPSHOT_Exported_Functions
+ * @{ */
+uint32_t        XPD_Snapshot_Hash           (uint32_t Hash, const void * Data, uint32_t Size);
+uint32_t        XPD_Snapshot_GetSize        (const SNAPSHOT_InitType * Config);
+
+XPD_ReturnType  XPD_Snapshot_Capture        (const SNAPSHOT_InitType * Config,
+                                             uint32_t * Image, uint32_t Capacity);
+XPD_ReturnType  XPD_Snapshot_Restore        (const SNAPSHOT_InitType * Config,
+                                             const uint32_t * Image);
+/** @} */
+
+/** @} */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __XPD_SNAPSHOT_H_ */
@@ -27,10 +27,20 @@
 #include "xpd_common.h"
 #include "xpd_config.h"
 #include "xpd_dma.h"
+#include "xpd_os.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
 
 /** @defgroup SPI
  * @{ */
 
+/* Code size reduction option, to be defined in xpd_config.h:
+ * XPD_SPI_EXCLUDE_DMA: the DMA transfers and the transaction queue
+ *                      are excluded from the driver */
+
 /** @defgroup SPI_Exported_Types SPI Exported Types
  * @{ */
 
@@ -107,6 +117,29 @@ typedef enum
     SPI_ERROR_DMA       = 16,  /*!< DMA transfer error */
 }SPI_ErrorType;
 
+/** @brief SPI bus transaction structure */
+typedef struct SPI_TransactionType
+{
+    struct SPI_TransactionType * Next;      /*!< [Internal] The next queued transaction */
+    GPIO_TypeDef *   CS_Port;               /*!< The GPIO port of the slave chip select (NULL if not used) */
+    uint8_t          CS_Pin;                /*!< The GPIO pin of the active low slave chip select */
+    struct {
+        ActiveLevelType  Polarity;          /*!< Specifies the serial clock steady state. */
+        ClockPhaseType   Phase;             /*!< Specifies the clock active edge for the bit capture. */
+        ClockDividerType Prescaler;         /*!< Specifies the Baud Rate prescaler value. */
+    } Clock;                                /*   Serial clock setup of the slave */
+    const void *     Command;               /*!< The command header transmitted before the data (NULL if not used) */
+    uint8_t          CommandLength;         /*!< Amount of command header transfers */
+    void *           TxData;                /*!< The transmitted data (NULL if only reception is needed) */
+    void *           RxData;                /*!< The received data (NULL if only transmission is needed) */
+    uint16_t         Length;                /*!< Amount of data transfers */
+    XPD_HandleCallbackType Complete;        /*!< Transaction finished callback, the argument is the transaction */
+    volatile XPD_ReturnType Result;         /*!< BUSY while the transaction is pending, then the result of the transaction */
+#ifdef USE_XPD_OS
+    XPD_OS_SignalType Signal;               /*!< [Internal] Completion signal of @ref XPD_SPI_Transfer_Blocking */
+#endif
+}SPI_TransactionType;
+
 /** @brief SPI Handle structure */
 typedef struct
 {
@@ -124,10 +157,12 @@ typedef struct
         XPD_HandleCallbackType Error;        /*!< Error callbacks */
 #endif
     }Callbacks;                              /*   Handle Callbacks */
+#ifndef XPD_SPI_EXCLUDE_DMA
     struct {
         DMA_HandleType * Transmit;           /*!< DMA handle for data transmission */
         DMA_HandleType * Receive;            /*!< DMA handle for data reception */
     }DMA;                                    /*   DMA handle references */
+#endif
     DataStreamType RxStream;                 /*!< Data reception stream */
     DataStreamType TxStream;                 /*!< Data transmission stream */
 #if defined(USE_XPD_SPI_ERROR_DETECT) || defined(USE_XPD_DMA_ERROR_DETECT)
@@ -136,6 +171,24 @@ typedef struct
 #ifdef USE_XPD_SPI_ERROR_DETECT
     uint8_t CRCSize;                         /*!< CRC size in bytes */
 #endif
+#ifdef SPI_SR_FRLVL
+    uint8_t DMAPacking;                      /*!< [Internal] Two data frames are packed in each DMA transfer */
+#endif
+    uint32_t ClockFreq;                      /*!< [Internal] The serial clock frequency of the initial setup */
+#ifndef XPD_SPI_EXCLUDE_DMA
+    struct {
+        SPI_TransactionType * Head;          /*!< [Internal] The ongoing transaction */
+        SPI_TransactionType * Tail;          /*!< [Internal] The last queued transaction */
+    }Queue;                                  /*   Transaction queue */
+    struct {
+        uint16_t RxStart;                    /*!< Ring index of the first data of the last received frame */
+        uint16_t RxLength;                   /*!< Amount of data transfers in the last received frame */
+        uint16_t TxStart;                    /*!< Ring index of the next data to be fetched for transmission */
+    }Frame;                                  /*   Slave stream frame boundaries */
+#endif
+#ifdef USE_XPD_STATISTICS
+    XPD_StatsType Stats;                     /*!< Runtime statistics (errors indexed by @ref SPI_ErrorType bits) */
+#endif
 }SPI_HandleType;
 
 /** @} */
@@ -156,6 +209,17 @@ typedef struct
      .Callbacks.DepInit   = (INIT_FN),                          \
      .Callbacks.DepDeinit = (DEINIT_FN)}
 
+/**
+ * @brief  Constant SPI Handle reference for a peripheral instance.
+ * @note   Resolved at compile time, it can replace the handle argument of the
+ *         flag and interrupt control macros in time-critical code, such as
+ *         user interrupt handlers, so that the register addresses become
+ *         immediate values instead of loads through the handle.
+ * @param  INSTANCE: specifies the SPI peripheral instance.
+ */
+#define         SPI_INST_HANDLE(INSTANCE)                       \
+    (&(const SPI_HandleType){.Inst = (INSTANCE), .Inst_BB = SPI_BB(INSTANCE)})
+
 /**
  * @brief SPI register bit accessing macro
  * @param HANDLE: specifies the peripheral handle.
@@ -178,6 +242,17 @@ typedef struct
      .Callbacks.DepInit   = (INIT_FN),                          \
      .Callbacks.DepDeinit = (DEINIT_FN)}
 
+/**
+ * @brief  Constant SPI Handle reference for a peripheral instance.
+ * @note   Resolved at compile time, it can replace the handle argument of the
+ *         flag and interrupt control macros in time-critical code, such as
+ *         user interrupt handlers, so that the register addresses become
+ *         immediate values instead of loads through the handle.
+ * @param  INSTANCE: specifies the SPI peripheral instance.
+ */
+#define         SPI_INST_HANDLE(INSTANCE)                       \
+    (&(const SPI_HandleType){.Inst = (INSTANCE)})
+
 /**
  * @brief SPI register bit accessing macro
  * @param HANDLE: specifies the peripheral handle.
@@ -189,6 +264,22 @@ typedef struct
 
 #endif /* SPI_BB */
 
+/**
+ * @brief  Selects the serial clock prescaler at build time.
+ * @param  CLOCK: the constant SPI kernel clock frequency in Hz
+ * @param  MAX_FREQ: the highest permitted serial clock frequency in Hz
+ * @return The smallest @ref ClockDividerType that doesn't exceed MAX_FREQ
+ *         (CLK_DIV256 if none of them fit)
+ */
+#define         SPI_PRESCALER(CLOCK, MAX_FREQ)                  \
+    ((((CLOCK) >> 1) <= (MAX_FREQ)) ? CLK_DIV2  :               \
+     (((CLOCK) >> 2) <= (MAX_FREQ)) ? CLK_DIV4  :               \
+     (((CLOCK) >> 3) <= (MAX_FREQ)) ? CLK_DIV8  :               \
+     (((CLOCK) >> 4) <= (MAX_FREQ)) ? CLK_DIV16 :               \
+     (((CLOCK) >> 5) <= (MAX_FREQ)) ? CLK_DIV32 :               \
+     (((CLOCK) >> 6) <= (MAX_FREQ)) ? CLK_DIV64 :               \
+     (((CLOCK) >> 7) <= (MAX_FREQ)) ? CLK_DIV128 : CLK_DIV256)
+
 /**
  * @brief  Enable the specified SPI interrupt.
  * @param  HANDLE: specifies the SPI Handle.
@@ -288,11 +379,33 @@ void            XPD_SPI_TransmitReceive_IT  (SPI_HandleType * hspi, void * TxDat
 
 void            XPD_SPI_IRQHandler          (SPI_HandleType * hspi);
 
+#ifndef XPD_SPI_EXCLUDE_DMA
 XPD_ReturnType  XPD_SPI_Transmit_DMA        (SPI_HandleType * hspi, void * TxData, uint16_t Length);
 XPD_ReturnType  XPD_SPI_Receive_DMA         (SPI_HandleType * hspi, void * RxData, uint16_t Length);
 XPD_ReturnType  XPD_SPI_TransmitReceive_DMA (SPI_HandleType * hspi, void * TxData,
                                              void * RxData, uint16_t Length);
 void            XPD_SPI_Stop_DMA            (SPI_HandleType * hspi);
+#ifdef SPI_SR_FRLVL
+XPD_ReturnType  XPD_SPI_DMAPackingConfig    (SPI_HandleType * hspi, FunctionalState NewState);
+#endif
+
+XPD_ReturnType  XPD_SPI_SlaveStream_Start   (SPI_HandleType * hspi, void * TxData,
+                                             void * RxData, uint16_t Length);
+void            XPD_SPI_SlaveStream_FrameEnd(SPI_HandleType * hspi);
+void            XPD_SPI_SlaveStream_Stop    (SPI_HandleType * hspi);
+
+XPD_ReturnType  XPD_SPI_PacedStream_Start   (SPI_HandleType * hspi, DMA_HandleType * Pacer,
+                                             const void * TxData, void * RxData, uint16_t Length);
+void            XPD_SPI_PacedStream_Stop    (SPI_HandleType * hspi, DMA_HandleType * Pacer);
+
+XPD_ReturnType  XPD_SPI_Queue_Submit        (SPI_HandleType * hspi, SPI_TransactionType * Transaction);
+#ifdef USE_XPD_OS
+XPD_ReturnType  XPD_SPI_Transfer_Blocking   (SPI_HandleType * hspi, SPI_TransactionType * Transaction,
+                                             uint32_t Timeout);
+#endif
+#endif /* XPD_SPI_EXCLUDE_DMA */
+
+void            XPD_SPI_ClockUpdate         (SPI_HandleType * hspi);
 /** @} */
 
 /** @} */
@@ -302,4 +415,8 @@ void            XPD_SPI_Stop_DMA            (SPI_HandleType * hspi);
 #include "xpd_rcc_pc.h"
 #undef XPD_SPI_API
 
+#ifdef __cplusplus
+}
+#endif
+
 #endif /* __XPD_SPI_H_ */
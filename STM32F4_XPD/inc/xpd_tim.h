@@ -27,6 +27,12 @@
 #include "xpd_common.h"
 #include "xpd_config.h"
 #include "xpd_dma.h"
+#include "xpd_utils.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
 
 #if defined(TIM_CCR5_CCR5) && defined(TIM_CCR6_CCR6)
 #define TIM_SUPPORTED_CHANNEL_COUNT   6
@@ -81,6 +87,15 @@ typedef enum
 #endif
 }TIM_ChannelType;
 
+/**
+ * @brief TIM waveform encoder callback type
+ * @param Handle: pointer to the TIM handle structure
+ * @param Buffer: the buffer to fill with the next compare values
+ * @param Length: the size of the buffer
+ * @return The number of filled values, less than Length at the end of the waveform
+ */
+typedef uint16_t (*TIM_WaveformEncoderType)(void * Handle, uint16_t * Buffer, uint16_t Length);
+
 /** @brief TIM Handle structure */
 typedef struct
 {
@@ -107,6 +122,14 @@ typedef struct
         DMA_HandleType * Burst;              /*!< DMA handle for burst transfers */
     }DMA;                                    /*   DMA handle references */
     volatile TIM_ChannelType ActiveChannel;  /*!< The currently active timer channel */
+    struct {
+        TIM_WaveformEncoderType Encoder;     /*!< [Internal] Callback to encode the next part of the waveform */
+        uint16_t * Buffer;                   /*!< [Internal] The circular DMA buffer of the compare values */
+        uint16_t   Length;                   /*!< [Internal] The number of compare values in a buffer half */
+        uint8_t    Countdown;                /*!< [Internal] The number of half transfers left after the waveform end */
+        TIM_ChannelType Channel;             /*!< [Internal] The channel which outputs the waveform */
+    }Waveform;                               /*   Waveform streaming context */
+    uint32_t CounterFreq;                    /*!< [Internal] The counter clock frequency of the initial setup */
 }TIM_HandleType;
 
 /** @} */
@@ -160,6 +183,22 @@ typedef struct
 
 #endif /* TIM_BB */
 
+/**
+ * @brief  Computes the counter prescaler at build time.
+ * @param  CLOCK: the constant timer kernel clock frequency in Hz
+ * @param  COUNTER_FREQ: the requested counter frequency in Hz
+ */
+#define         TIM_PRESCALER(CLOCK, COUNTER_FREQ)              \
+    XPD_DIV_ROUND((CLOCK), (COUNTER_FREQ))
+
+/**
+ * @brief  Computes the counter period at build time.
+ * @param  COUNTER_FREQ: the counter frequency in Hz
+ * @param  UPDATE_FREQ: the requested update event frequency in Hz
+ */
+#define         TIM_PERIOD(COUNTER_FREQ, UPDATE_FREQ)           \
+    XPD_DIV_ROUND((COUNTER_FREQ), (UPDATE_FREQ))
+
 /**
  * @brief  Enable the specified TIM interrupt.
  * @param  HANDLE: specifies the TIM Handle.
@@ -375,7 +414,7 @@ typedef struct
  * @return The value of the channel.
  */
 #define         XPD_TIM_Channel_Value(HANDLE, CH)           \
-    ((&(HANDLE)->Inst->CCR1)[ CH ]))
+    ((&(HANDLE)->Inst->CCR1)[ CH ])
 #endif
 
 /** @} */
@@ -384,6 +423,7 @@ typedef struct
  * @{ */
 XPD_ReturnType  XPD_TIM_Init                (TIM_HandleType * htim, const TIM_Counter_InitType * Config);
 XPD_ReturnType  XPD_TIM_Deinit              (TIM_HandleType * htim);
+void            XPD_TIM_ClockUpdate         (TIM_HandleType * htim);
 
 void            XPD_TIM_Counter_Start_IT    (TIM_HandleType * htim);
 void            XPD_TIM_Counter_Stop_IT     (TIM_HandleType * htim);
@@ -398,6 +438,11 @@ XPD_ReturnType  XPD_TIM_Channel_Start_DMA   (TIM_HandleType * htim, TIM_ChannelT
                                              void * Address, uint16_t Length);
 void            XPD_TIM_Channel_Stop_DMA    (TIM_HandleType * htim, TIM_ChannelType Channel);
 
+XPD_ReturnType  XPD_TIM_Waveform_Start_DMA  (TIM_HandleType * htim, TIM_ChannelType Channel,
+                                             uint16_t * Buffer, uint16_t Length,
+                                             TIM_WaveformEncoderType Encoder);
+void            XPD_TIM_Waveform_Stop_DMA   (TIM_HandleType * htim);
+
 void            XPD_TIM_UP_IRQHandler       (TIM_HandleType * htim);
 void            XPD_TIM_CC_IRQHandler       (TIM_HandleType * htim);
 void            XPD_TIM_TRG_COM_IRQHandler  (TIM_HandleType * htim);
@@ -529,8 +574,18 @@ typedef struct
 {
     TIM_Burst_RegIndexType RegIndex; /*!< TIM register offset starting from the timer base */
     TIM_BurstSourceType    Source;   /*!< TIM burst DMA and trigger source */
+    uint8_t                Registers;/*!< The number of registers written by each DMA request,
+                                          0 to transfer the whole buffer in a single burst */
 }TIM_Burst_InitType;
 
+/** @brief TIM capture snapshot structure, filled by a single burst read of CNT .. CCR4 */
+typedef struct
+{
+    uint32_t Counter;                /*!< The counter value at the DMA request */
+    uint32_t Reserved[3];            /*!< The PSC, ARR and RCR values, read by the same burst */
+    uint32_t Capture[4];             /*!< The capture values of channels 1 .. 4 */
+}TIM_SnapshotType;
+
 /** @} */
 
 /** @addtogroup TIM_Burst_Exported_Functions
@@ -538,6 +593,38 @@ typedef struct
 XPD_ReturnType  XPD_TIM_Burst_Start_DMA     (TIM_HandleType * htim, const TIM_Burst_InitType * Config,
                                              void * Address, uint16_t Length);
 void            XPD_TIM_Burst_Stop_DMA      (TIM_HandleType * htim, TIM_BurstSourceType Source);
+
+XPD_ReturnType  XPD_TIM_Snapshot_Start_DMA  (TIM_HandleType * htim, TIM_BurstSourceType Source,
+                                             TIM_SnapshotType * Ring, uint16_t Count);
+void            XPD_TIM_Snapshot_Stop_DMA   (TIM_HandleType * htim, TIM_BurstSourceType Source);
+uint32_t        XPD_TIM_Snapshot_GetCount   (TIM_HandleType * htim);
+/** @} */
+
+/** @} */
+
+/** @defgroup TIM_Parallel TIM Parallel GPIO Bus Mode
+ * @{ */
+
+/** @defgroup TIM_Parallel_Exported_Types TIM Parallel GPIO Bus Exported Types
+ * @{ */
+
+/** @brief TIM paced GPIO port register selection */
+typedef enum
+{
+    TIM_PARALLEL_BSRR = 0, /*!< Memory to port bit set/reset register,
+                                each 32 bit word only changes the pins selected by it */
+    TIM_PARALLEL_ODR  = 1, /*!< Memory to port output data register, all outputs are written */
+    TIM_PARALLEL_IDR  = 2, /*!< Port input data register to memory, for logic capture */
+}TIM_ParallelRegisterType;
+
+/** @} */
+
+/** @addtogroup TIM_Parallel_Exported_Functions
+ * @{ */
+XPD_ReturnType  XPD_TIM_Parallel_Start_DMA  (TIM_HandleType * htim, GPIO_TypeDef * GPIOx,
+                                             TIM_ParallelRegisterType Register,
+                                             void * Address, uint16_t Length);
+void            XPD_TIM_Parallel_Stop_DMA   (TIM_HandleType * htim);
 /** @} */
 
 /** @} */
@@ -671,34 +758,6 @@ __STATIC_INLINE void XPD_TIM_Output_Disable(TIM_HandleType * htim)
 
 /** @} */
 
-/** @defgroup TIM_OnePulseMode TIM One Pulse Mode
- * @{ */
-
-/** @defgroup TIM_OnePulseMode_Exported_Functions TIM One Pulse Mode Exported Functions
- * @{ */
-
-/**
- * @brief Enables the one pulse mode of the timer output.
- * @param htim: pointer to the TIM handle structure
- */
-__STATIC_INLINE void XPD_TIM_OnePulseMode_Enable(TIM_HandleType * htim)
-{
-    TIM_REG_BIT(htim, CR1, OPM) = 1;
-}
-
-/**
- * @brief Disables the one pulse mode of the timer output.
- * @param htim: pointer to the TIM handle structure
- */
-__STATIC_INLINE void XPD_TIM_OnePulseMode_Disable(TIM_HandleType * htim)
-{
-    TIM_REG_BIT(htim, CR1, OPM) = 0;
-}
-
-/** @} */
-
-/** @} */
-
 /** @defgroup TIM_Input TIM Input
  * @{ */
 
@@ -722,6 +781,17 @@ typedef struct
     uint8_t              Filter;    /*!< Specifies the input capture filter. [0..15] */
 }TIM_Input_InitType;
 
+/** @brief TIM input capture DMA stream context structure */
+typedef struct
+{
+    uint16_t *      Buffer;         /*!< [Internal] The circular DMA buffer of the captured values */
+    uint16_t        Length;         /*!< [Internal] The size of the capture buffer */
+    uint16_t        Index;          /*!< [Internal] The index of the next unread capture value */
+    uint16_t        LastValue;      /*!< [Internal] The last read capture value */
+    uint32_t        Timestamp;      /*!< [Internal] The extended timestamp of the last read capture */
+    TIM_ChannelType Channel;        /*!< [Internal] The capture channel of the stream */
+}TIM_CaptureStreamType;
+
 /** @} */
 
 /** @addtogroup TIM_Input_Exported_Functions
@@ -729,6 +799,21 @@ typedef struct
 void            XPD_TIM_Input_ChannelConfig (TIM_HandleType * htim, TIM_ChannelType Channel,
                                              const TIM_Input_InitType * Config);
 
+XPD_ReturnType  XPD_TIM_Capture_Start_DMA   (TIM_HandleType * htim, TIM_ChannelType Channel,
+                                             TIM_CaptureStreamType * Stream,
+                                             uint16_t * Buffer, uint16_t Length);
+void            XPD_TIM_Capture_Stop_DMA    (TIM_HandleType * htim, TIM_CaptureStreamType * Stream);
+void            XPD_TIM_Capture_SyncStream  (TIM_CaptureStreamType * Stream,
+                                             const TIM_CaptureStreamType * Reference);
+uint16_t        XPD_TIM_Capture_Read        (TIM_HandleType * htim, TIM_CaptureStreamType * Stream,
+                                             uint32_t * Timestamps, uint16_t Count);
+
+uint32_t        XPD_TIM_Capture_GetPeriod   (const uint32_t * Timestamps, uint16_t Count);
+uint32_t        XPD_TIM_Capture_GetFrequency(TIM_HandleType * htim,
+                                             const uint32_t * Timestamps, uint16_t Count);
+uint16_t        XPD_TIM_Capture_GetDutyCycle(const uint32_t * Rising, const uint32_t * Falling,
+                                             uint16_t Count);
+
 /**
  * @brief Sets the TI1 input source as XOR(Ch1, Ch2, Ch3) instead of default Ch1.
  * @param htim: pointer to the TIM handle structure
@@ -836,12 +921,409 @@ typedef struct {
     uint8_t              Filter;       /*!< Specifies the input clock filter. [0..15] */
 }TIM_SlaveConfigType;
 
+/** @brief TIM synchronized group member structure */
+typedef struct
+{
+    TIM_HandleType *     Timer;        /*!< The timer handle of the member */
+    TIM_TriggerInputType Trigger;      /*!< Internal trigger connected to the master's TRGO
+                                            [TIM_TRGI_ITR0..TIM_TRGI_ITR3], unused for the master */
+    uint32_t             Phase;        /*!< The counter value at the common start, which advances
+                                            the member's waveform by this amount of counts */
+}TIM_GroupMemberType;
+
 /** @} */
 
 /** @addtogroup TIM_MasterSlave_Exported_Functions
  * @{ */
 void            XPD_TIM_MasterConfig        (TIM_HandleType * htim, const TIM_MasterConfigType * Config);
 void            XPD_TIM_SlaveConfig         (TIM_HandleType * htim, const TIM_SlaveConfigType * Config);
+
+void            XPD_TIM_Group_Start         (const TIM_GroupMemberType * Members, uint8_t Count);
+void            XPD_TIM_Group_Stop          (const TIM_GroupMemberType * Members, uint8_t Count);
+void            XPD_TIM_Group_SetPeriod     (const TIM_GroupMemberType * Members, uint8_t Count,
+                                             uint32_t Period);
+
+/**
+ * @brief Disables the update events of the group members, so that
+ *        the preloaded registers can be modified consistently.
+ * @param Members: array of the group members
+ * @param Count: the number of group members
+ */
+__STATIC_INLINE void XPD_TIM_Group_Lock(const TIM_GroupMemberType * Members, uint8_t Count)
+{
+    uint8_t i;
+    for (i = 0; i < Count; i++)
+    {
+        TIM_REG_BIT(Members[i].Timer,CR1,UDIS) = 1;
+    }
+}
+
+/**
+ * @brief Reenables the update events of the group members, the modified preloaded
+ *        registers are applied by each member at its next update event.
+ * @param Members: array of the group members
+ * @param Count: the number of group members
+ */
+__STATIC_INLINE void XPD_TIM_Group_Unlock(const TIM_GroupMemberType * Members, uint8_t Count)
+{
+    uint8_t i;
+    for (i = 0; i < Count; i++)
+    {
+        TIM_REG_BIT(Members[i].Timer,CR1,UDIS) = 0;
+    }
+}
+/** @} */
+
+/** @} */
+
+/** @defgroup TIM_OnePulseMode TIM One Pulse Mode
+ * @{ */
+
+/** @defgroup TIM_OnePulseMode_Exported_Types TIM One Pulse Mode Exported Types
+ * @{ */
+
+/** @brief TIM triggered one pulse setup structure */
+typedef struct
+{
+    uint32_t             Delay;         /*!< The pulse start delay from the trigger [counts] */
+    uint32_t             Width;         /*!< The pulse width [counts] */
+    ActiveLevelType      Polarity;      /*!< The active level of the pulse output */
+    TIM_TriggerInputType Trigger;       /*!< The input trigger source of the pulse */
+    ActiveLevelType      TriggerPolarity; /*!< The active edge of the input trigger */
+    uint8_t              TriggerFilter; /*!< The input trigger filter [0..15] */
+#if defined(TIM_SMCR_SMS_3) && (TIM_CCMR1_OC1M > 0xFFFF)
+    FunctionalState      Retriggerable; /*!< A trigger during the pulse restarts the pulse period */
+#endif
+}TIM_OnePulse_InitType;
+
+/** @brief TIM pulse train sequence entry */
+typedef struct
+{
+    uint16_t Reload;        /*!< The auto-reload value of the pulse period (period - 1) */
+    uint16_t Repetition;    /*!< The number of repeated periods (advanced timers only) */
+    uint16_t Compare[4];    /*!< The compare values of channels 1 to 4 */
+}TIM_PulseType;
+
+/** @} */
+
+/** @defgroup TIM_OnePulseMode_Exported_Functions TIM One Pulse Mode Exported Functions
+ * @{ */
+void            XPD_TIM_OnePulse_Init       (TIM_HandleType * htim, TIM_ChannelType Channel,
+                                             const TIM_OnePulse_InitType * Config);
+
+XPD_ReturnType  XPD_TIM_PulseTrain_Start_DMA(TIM_HandleType * htim,
+                                             const TIM_PulseType * Pulses, uint16_t Count);
+void            XPD_TIM_PulseTrain_Stop_DMA (TIM_HandleType * htim);
+
+/**
+ * @brief Enables the one pulse mode of the timer output.
+ * @param htim: pointer to the TIM handle structure
+ */
+__STATIC_INLINE void XPD_TIM_OnePulseMode_Enable(TIM_HandleType * htim)
+{
+    TIM_REG_BIT(htim, CR1, OPM) = 1;
+}
+
+/**
+ * @brief Disables the one pulse mode of the timer output.
+ * @param htim: pointer to the TIM handle structure
+ */
+__STATIC_INLINE void XPD_TIM_OnePulseMode_Disable(TIM_HandleType * htim)
+{
+    TIM_REG_BIT(htim, CR1, OPM) = 0;
+}
+
+/** @} */
+
+/** @} */
+
+/** @defgroup TIM_Encoder TIM Encoder
+ * @{ */
+
+/** @defgroup TIM_Encoder_Exported_Types TIM Encoder Exported Types
+ * @{ */
+
+/** @brief TIM quadrature encoder setup structure */
+typedef struct
+{
+    TIM_SlaveModeType    Mode;          /*!< Encoder mode selection [TIM_SLAVEMODE_ENCODER_x] */
+    ActiveLevelType      Polarity[2];   /*!< Specifies the active edge of the TI1 and TI2 inputs */
+    uint8_t              Filter;        /*!< Specifies the input filter of both inputs. [0..15] */
+    FunctionalState      Sampling;      /*!< Velocity sampling on a master timer trigger output */
+    TIM_TriggerInputType SampleTrigger; /*!< Internal trigger connected to the sampling timer's TRGO
+                                             [TIM_TRGI_ITR0..TIM_TRGI_ITR3] */
+}TIM_Encoder_InitType;
+
+/** @brief TIM quadrature encoder handle structure */
+typedef struct
+{
+    TIM_HandleType   Timer;             /*!< The timer handle of the encoder counter */
+    volatile int32_t Extension;         /*!< [Internal] The position extension by the counter overflows */
+    volatile int32_t Velocity;          /*!< [Internal] The position change in the last sampling period */
+    uint16_t         LastSample;        /*!< [Internal] The counter value at the last sampling */
+}TIM_EncoderHandleType;
+
+/** @} */
+
+/** @defgroup TIM_Encoder_Exported_Functions TIM Encoder Exported Functions
+ * @{ */
+XPD_ReturnType  XPD_TIM_Encoder_Init        (TIM_EncoderHandleType * henc,
+                                             const TIM_Encoder_InitType * Config);
+void            XPD_TIM_Encoder_Start       (TIM_EncoderHandleType * henc);
+void            XPD_TIM_Encoder_Stop        (TIM_EncoderHandleType * henc);
+int32_t         XPD_TIM_Encoder_GetPosition (TIM_EncoderHandleType * henc);
+void            XPD_TIM_Encoder_SetPosition (TIM_EncoderHandleType * henc, int32_t Position);
+
+void            XPD_TIM_Encoder_IRQHandler  (TIM_EncoderHandleType * henc);
+
+/**
+ * @brief Returns the encoder velocity measured on the last sampling trigger.
+ * @param henc: pointer to the TIM encoder handle structure
+ * @return The position change during the last sampling period in encoder counts
+ */
+__STATIC_INLINE int32_t XPD_TIM_Encoder_GetVelocity(TIM_EncoderHandleType * henc)
+{
+    return henc->Velocity;
+}
+/** @} */
+
+/** @} */
+
+/** @defgroup TIM_Motor TIM Motor Control PWM
+ * @{ */
+
+/** @defgroup TIM_Motor_Exported_Types TIM Motor Control PWM Exported Types
+ * @{ */
+
+/** @brief TIM 3-phase motor PWM setup structure */
+typedef struct
+{
+    uint32_t                  Prescaler;         /*!< Clock prescaler for the counter */
+    uint16_t                  Period;            /*!< Counter period, the center-aligned PWM period is twice as long */
+    uint8_t                   RepetitionCounter; /*!< Half PWM periods between update events,
+                                                      set to 1 for one duty update per PWM period */
+    uint16_t                  DeadCounts;        /*!< The dead time between the complementary outputs
+                                                      in deadtime clock counts */
+    ActiveLevelType           Polarity;          /*!< High-side (OCx) output active level */
+    ActiveLevelType           CompPolarity;      /*!< Low-side (OCxN) output active level */
+    uint16_t                  TriggerPoint;      /*!< Channel 4 compare value which triggers the ADC
+                                                      injected conversions on TRGO (OC4REF rising edge) */
+    TIM_CommutationSourceType ComSource;         /*!< Commutation source for 6-step operation,
+                                                      TIM_COMSOURCE_NONE for sinusoidal operation */
+}TIM_Motor_InitType;
+
+/** @brief TIM 3-phase motor PWM handle structure */
+typedef struct
+{
+    TIM_HandleType Timer;   /*!< The handle of the advanced timer */
+    uint16_t       Duty[3]; /*!< [Internal] The phase compare values of the pending burst update */
+}TIM_MotorHandleType;
+
+/** @} */
+
+/** @defgroup TIM_Motor_Exported_Functions TIM Motor Control PWM Exported Functions
+ * @{ */
+void            XPD_TIM_Motor_Init          (TIM_MotorHandleType * hmot, const TIM_Motor_InitType * Config);
+void            XPD_TIM_Motor_Start         (TIM_MotorHandleType * hmot);
+void            XPD_TIM_Motor_Stop          (TIM_MotorHandleType * hmot);
+XPD_ReturnType  XPD_TIM_Motor_SetDuty       (TIM_MotorHandleType * hmot,
+                                             uint16_t Duty1, uint16_t Duty2, uint16_t Duty3);
+void            XPD_TIM_Motor_SetStep       (TIM_MotorHandleType * hmot, uint8_t Step);
+/** @} */
+
+/** @} */
+
+/** @defgroup TIM_Scheduler TIM Software Timer Scheduler
+ * @{ */
+
+/** @defgroup TIM_Scheduler_Exported_Types TIM Software Timer Scheduler Exported Types
+ * @{ */
+
+/** @brief TIM software timer structure */
+typedef struct TIM_SoftTimerType
+{
+    struct TIM_SoftTimerType * Next;     /*!< [Internal] The next scheduled software timer */
+    uint32_t               Deadline;     /*!< [Internal] The counter value of the next expiration */
+    uint32_t               Period;       /*!< The reload period in microseconds (0 for one-shot timers) */
+    XPD_HandleCallbackType Callback;     /*!< Expiration callback, called with the software timer as argument */
+}TIM_SoftTimerType;
+
+/** @brief TIM software timer scheduler handle structure */
+typedef struct
+{
+    TIM_HandleType      Timer;           /*!< The handle of the free-running 32-bit timer */
+    TIM_SoftTimerType * Queue;           /*!< [Internal] The scheduled software timers in deadline order */
+}TIM_SchedulerHandleType;
+
+/** @} */
+
+/** @defgroup TIM_Scheduler_Exported_Functions TIM Software Timer Scheduler Exported Functions
+ * @{ */
+void            XPD_TIM_Scheduler_Init      (TIM_SchedulerHandleType * hsch);
+void            XPD_TIM_Scheduler_Deinit    (TIM_SchedulerHandleType * hsch);
+
+void            XPD_TIM_SoftTimer_Start     (TIM_SchedulerHandleType * hsch, TIM_SoftTimerType * Timer,
+                                             uint32_t Delay);
+void            XPD_TIM_SoftTimer_Stop      (TIM_SchedulerHandleType * hsch, TIM_SoftTimerType * Timer);
+
+void            XPD_TIM_Scheduler_IRQHandler(TIM_SchedulerHandleType * hsch);
+
+/**
+ * @brief Returns the current time of the scheduler.
+ * @param hsch: pointer to the TIM scheduler handle structure
+ * @return The free-running counter value in microseconds
+ */
+__STATIC_INLINE uint32_t XPD_TIM_Scheduler_GetTime(TIM_SchedulerHandleType * hsch)
+{
+    return hsch->Timer.Inst->CNT;
+}
+/** @} */
+
+/** @} */
+
+/** @defgroup TIM_Debounce TIM Debounced Inputs
+ * @{ */
+
+/** @defgroup TIM_Debounce_Exported_Types TIM Debounced Inputs Exported Types
+ * @{ */
+
+/** @brief TIM debounced input edge event structure */
+typedef struct
+{
+    uint32_t Timestamp;                  /*!< The scheduler time of the edge in microseconds */
+    uint8_t  Line;                       /*!< The EXTI line of the input */
+    uint8_t  Level;                      /*!< The input level after the edge (1 for rising, 0 for falling edge) */
+}TIM_DebounceEventType;
+
+/** @brief TIM debounced input structure */
+typedef struct
+{
+    TIM_SoftTimerType Holdoff;           /*!< [Internal] The software timer of the holdoff period */
+    GPIO_TypeDef *    GPIOx;             /*!< The GPIO port of the input */
+    uint8_t           Pin;               /*!< The pin of the input, which is also its EXTI line [0 .. 15] */
+    uint8_t           Level;             /*!< [Internal] The last reported input level */
+    void *            Owner;             /*!< [Internal] The debouncer handle of the input */
+}TIM_DebounceInputType;
+
+/** @brief TIM debouncer handle structure */
+typedef struct
+{
+    TIM_SchedulerHandleType * Scheduler; /*!< The scheduler which provides the timestamps and holdoff timers */
+    uint32_t                  Holdoff;   /*!< The time while the input is ignored after an edge in microseconds */
+    XPD_HandleCallbackType    Callback;  /*!< Edge event callback, called after the event is queued */
+    struct {
+        TIM_DebounceEventType * Buffer;  /*!< The event buffer */
+        uint16_t Size;                   /*!< The number of events fitting in the buffer */
+        volatile uint16_t Head;          /*!< [Internal] The position of the next queued event */
+        volatile uint16_t Tail;          /*!< [Internal] The position of the oldest queued event */
+        uint16_t Dropped;                /*!< The number of events lost due to a full buffer */
+    }Queue;                              /*   Edge event queue */
+}TIM_DebounceHandleType;
+
+/** @} */
+
+/** @defgroup TIM_Debounce_Exported_Functions TIM Debounced Inputs Exported Functions
+ * @{ */
+void            XPD_TIM_Debounce_Init       (TIM_DebounceHandleType * hdeb);
+void            XPD_TIM_Debounce_Attach     (TIM_DebounceHandleType * hdeb, TIM_DebounceInputType * Input);
+void            XPD_TIM_Debounce_Detach     (TIM_DebounceHandleType * hdeb, TIM_DebounceInputType * Input);
+XPD_ReturnType  XPD_TIM_Debounce_GetEvent   (TIM_DebounceHandleType * hdeb, TIM_DebounceEventType * Event);
+/** @} */
+
+/** @} */
+
+/** @defgroup TIM_Serial TIM Software Serial Ports
+ * @{ */
+
+/** @defgroup TIM_Serial_Exported_Types TIM Software Serial Ports Exported Types
+ * @{ */
+
+/** @brief TIM software serial transmitter handle structure */
+typedef struct
+{
+    TIM_HandleType *       Timer;        /*!< The handle of the bit pacing timer (with Update DMA) */
+    GPIO_TypeDef *         GPIOx;        /*!< The GPIO port of the TX output */
+    uint8_t                Pin;          /*!< The pin of the TX output [0 .. 15] */
+    uint32_t *             Buffer;       /*!< The bit pattern buffer of the DMA */
+    uint16_t               Size;         /*!< The number of words in the buffer, at least 11
+                                              (10 words per character and 1 idle word) */
+    XPD_HandleCallbackType Complete;     /*!< Transmission complete callback */
+    const uint8_t *        Data;         /*!< [Internal] The next character to encode */
+    volatile uint16_t      Remaining;    /*!< [Internal] The number of characters to encode */
+    volatile uint8_t       Busy;         /*!< [Internal] A transmission is in progress */
+}TIM_SerialTxType;
+
+/** @brief TIM software serial receiver handle structure */
+typedef struct
+{
+    TIM_HandleType *       Timer;        /*!< The handle of the free-running capture timer */
+    TIM_ChannelType        Channel;      /*!< The capture channel of the RX input */
+    uint16_t *             Buffer;       /*!< The circular edge capture buffer of the DMA */
+    uint16_t               Size;         /*!< The number of edges fitting in the buffer */
+    XPD_RingType *         Ring;         /*!< The receive ring buffer of the characters */
+    uint16_t               Errors;       /*!< The number of frames lost due to framing error or full ring */
+    TIM_CaptureStreamType  Stream;       /*!< [Internal] The edge capture stream */
+    uint32_t               BitTime;      /*!< [Internal] The bit time in 1/256 counter ticks */
+    uint32_t               Time;         /*!< [Internal] The receiver time of the last processing */
+    uint16_t               Count;        /*!< [Internal] The counter value of the last processing */
+    uint16_t               Shift;        /*!< [Internal] The sampled bits of the current frame */
+    uint32_t               FrameStart;   /*!< [Internal] The receiver time of the current start bit edge */
+    uint8_t                Bit;          /*!< [Internal] The next bit to sample in the frame [1 .. 10], 0 when idle */
+    uint8_t                Level;        /*!< [Internal] The line level after the last edge */
+}TIM_SerialRxType;
+
+/** @} */
+
+/** @defgroup TIM_Serial_Exported_Functions TIM Software Serial Ports Exported Functions
+ * @{ */
+XPD_ReturnType  XPD_TIM_SerialTx_Init       (TIM_SerialTxType * htx, uint32_t Baudrate);
+XPD_ReturnType  XPD_TIM_SerialTx_Start_DMA  (TIM_SerialTxType * htx, const uint8_t * Data, uint16_t Length);
+void            XPD_TIM_SerialTx_Stop_DMA   (TIM_SerialTxType * htx);
+
+XPD_ReturnType  XPD_TIM_SerialRx_Start_DMA  (TIM_SerialRxType * hrx, uint32_t Baudrate);
+void            XPD_TIM_SerialRx_Stop_DMA   (TIM_SerialRxType * hrx);
+uint16_t        XPD_TIM_SerialRx_Process    (TIM_SerialRxType * hrx);
+/** @} */
+
+/** @} */
+
+/** @defgroup TIM_Latency TIM Interrupt Latency Measurement
+ * @{ */
+
+/** @brief TIM interrupt latency measurement structure */
+typedef struct
+{
+    TIM_HandleType *  Timer;            /*!< The handle of the free-running timer with 0xFFFF period */
+    TIM_ChannelType   Output;           /*!< The toggling stimulus output channel, looped back to the measured interrupt */
+    TIM_ChannelType   Capture;          /*!< The input capture channel of the looped back stimulus,
+                                             equal to Output to measure from the compare event */
+    uint16_t          Interval;         /*!< The minimal time between the stimulus edges in timer counts */
+    uint32_t *        Histogram;        /*!< The latency histogram (optional), the last bin counts all higher values */
+    uint16_t          Bins;             /*!< The number of histogram bins */
+    uint16_t          BinWidth;         /*!< The latency range of a histogram bin in timer counts */
+    uint32_t          Count;            /*!< The number of measurements */
+    uint16_t          Min;              /*!< The minimal measured latency in timer counts */
+    uint16_t          Max;              /*!< The maximal measured latency in timer counts */
+    uint64_t          Total;            /*!< The sum of all measured latencies */
+}TIM_LatencyType;
+
+/** @} */
+
+/** @defgroup TIM_Latency_Exported_Functions TIM Interrupt Latency Measurement Exported Functions
+ * @{ */
+void            XPD_TIM_Latency_Start       (TIM_LatencyType * hlat);
+void            XPD_TIM_Latency_Stop        (TIM_LatencyType * hlat);
+uint16_t        XPD_TIM_Latency_Record      (TIM_LatencyType * hlat);
+
+/**
+ * @brief Returns the jitter of the measured latency.
+ * @param hlat: pointer to the TIM latency measurement structure
+ * @return The difference of the maximal and minimal latency in timer counts
+ */
+__STATIC_INLINE uint16_t XPD_TIM_Latency_GetJitter(TIM_LatencyType * hlat)
+{
+    return (hlat->Count > 0) ? (hlat->Max - hlat->Min) : 0;
+}
 /** @} */
 
 /** @} */
@@ -853,4 +1335,8 @@ void            XPD_TIM_SlaveConfig         (TIM_HandleType * htim, const TIM_Sl
 #include "xpd_rcc_pc.h"
 #undef XPD_TIM_API
 
+#ifdef __cplusplus
+}
+#endif
+
 #endif /* __XPD_TIM_H_ */
@@ -27,6 +27,12 @@
 #include "xpd_common.h"
 #include "xpd_config.h"
 #include "xpd_dma.h"
+#include "xpd_os.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
 /** @defgroup USART
  * @{ */
 
@@ -42,6 +48,12 @@
 #define USART_PERIPHERAL_VERSION    1
 #endif
 
+/* Code size reduction options, to be defined in xpd_config.h:
+ * XPD_USART_EXCLUDE_DMA:   the DMA transfers, the circular reception and the transmit queue
+ *                          are excluded from the driver
+ * XPD_USART_EXCLUDE_MODES: the LIN, MultiSlave UART, SmartCard, IrDA, RS485 and 1-Wire modes
+ *                          are excluded from the driver */
+
 /** @defgroup USART_Common_Exported_Types USART Common Exported Types
  * @{ */
 
@@ -98,6 +110,17 @@ typedef enum
     USART_ERROR_DMA     = 16 /*!< DMA transfer error */
 }USART_ErrorType;
 
+#if defined(USART_CR2_RTOEN) && !defined(XPD_USART_EXCLUDE_DMA)
+/** @brief USART framed reception setup structure */
+typedef struct
+{
+    uint32_t        RxTimeout;   /*!< The frame ends when the line is idle for this many bit durations
+                                      after a received character [0 (disabled) .. 0xFFFFFF] */
+    FunctionalState CharMatch;   /*!< The frame ends when the Delimiter character is received */
+    uint8_t         Delimiter;   /*!< The frame end character */
+}USART_Frame_InitType;
+#endif
+
 /** @brief USART Handle structure */
 typedef struct
 {
@@ -114,19 +137,58 @@ typedef struct
         XPD_HandleCallbackType Break;        /*!< LIN break detection callback */
         XPD_HandleCallbackType Idle;         /*!< Idle callback */
         XPD_HandleCallbackType ClearToSend;  /*!< Clear To Send callback */
+#if (USART_PERIPHERAL_VERSION > 2)
+        XPD_HandleCallbackType WakeUp;       /*!< Wakeup from Stop mode callback */
+#endif
+#ifdef USART_CR2_ABREN
+        XPD_HandleCallbackType AutoBaud;     /*!< Auto baudrate detection complete callback */
+#endif
 #if defined(USE_XPD_USART_ERROR_DETECT) || defined(USE_XPD_DMA_ERROR_DETECT)
         XPD_HandleCallbackType Error;        /*!< Error callbacks */
 #endif
     }Callbacks;                              /*   Handle Callbacks */
+#ifndef XPD_USART_EXCLUDE_DMA
     struct {
         DMA_HandleType * Transmit;           /*!< DMA handle for data transmission */
         DMA_HandleType * Receive;            /*!< DMA handle for data reception */
     }DMA;                                    /*   DMA handle references */
+#endif
     DataStreamType RxStream;                 /*!< Data reception stream */
     DataStreamType TxStream;                 /*!< Data transmission stream */
+    uint32_t BaudRate;                       /*!< [Internal] The configured baud rate */
+#ifndef XPD_USART_EXCLUDE_DMA
+    uint16_t RxTail;                         /*!< [Internal] Read index of the circular reception buffer */
+#ifdef USART_CR2_RTOEN
+    uint16_t RxFrameLength;                  /*!< The amount of data transfers of the last received frame */
+#endif
+#ifdef USART_CR2_ABREN
+    volatile uint8_t AutoBaud;               /*!< [Internal] The auto baudrate detection is ongoing */
+#endif
+    struct {
+        DMA_DescriptorType * Buffer;         /*!< [Internal] Storage of the queued transmit data blocks */
+        uint8_t Size;                        /*!< [Internal] The capacity of the queue storage */
+        volatile uint8_t Head;               /*!< [Internal] Write index of the queue (producer) */
+        volatile uint8_t Tail;               /*!< [Internal] Read index of the queue (consumer) */
+        volatile uint8_t Pending;            /*!< [Internal] The number of blocks in the ongoing transfer */
+    }TxQueue;                                /*   Transmit queue context */
+    struct {
+        char * Buffer;                       /*!< [Internal] Storage of the formatted text ring */
+        uint16_t Mask;                       /*!< [Internal] The size of the text ring - 1 */
+        uint16_t Head;                       /*!< [Internal] Write index of the text ring */
+    }TxText;                                 /*   Formatted transmit text context */
+#endif
 #if defined(USE_XPD_USART_ERROR_DETECT) || defined(USE_XPD_DMA_ERROR_DETECT)
     volatile USART_ErrorType Errors;         /*!< Transfer errors */
 #endif
+#ifdef USE_XPD_OS
+    struct {
+        XPD_OS_SignalType Transmit;          /*!< [Internal] Signal of @ref XPD_USART_Transmit_Blocking */
+        XPD_OS_SignalType Receive;           /*!< [Internal] Signal of @ref XPD_USART_Receive_Blocking */
+    }Signal;                                 /*   Blocking transfer completion signals */
+#endif
+#ifdef USE_XPD_STATISTICS
+    XPD_StatsType Stats;                     /*!< Runtime statistics (errors indexed by @ref USART_ErrorType bits) */
+#endif
 }USART_HandleType;
 
 /** @} */
@@ -147,6 +209,17 @@ typedef struct
      .Callbacks.DepInit   = (INIT_FN),                          \
      .Callbacks.DepDeinit = (DEINIT_FN)}
 
+/**
+ * @brief  Constant USART Handle reference for a peripheral instance.
+ * @note   Resolved at compile time, it can replace the handle argument of the
+ *         flag and interrupt control macros in time-critical code, such as
+ *         user interrupt handlers, so that the register addresses become
+ *         immediate values instead of loads through the handle.
+ * @param  INSTANCE: specifies the USART peripheral instance.
+ */
+#define         USART_INST_HANDLE(INSTANCE)                     \
+    (&(const USART_HandleType){.Inst = (INSTANCE), .Inst_BB = USART_BB(INSTANCE)})
+
 /**
  * @brief USART register bit accessing macro
  * @param HANDLE: specifies the peripheral handle.
@@ -169,6 +242,17 @@ typedef struct
      .Callbacks.DepInit   = (INIT_FN),                          \
      .Callbacks.DepDeinit = (DEINIT_FN)}
 
+/**
+ * @brief  Constant USART Handle reference for a peripheral instance.
+ * @note   Resolved at compile time, it can replace the handle argument of the
+ *         flag and interrupt control macros in time-critical code, such as
+ *         user interrupt handlers, so that the register addresses become
+ *         immediate values instead of loads through the handle.
+ * @param  INSTANCE: specifies the USART peripheral instance.
+ */
+#define         USART_INST_HANDLE(INSTANCE)                     \
+    (&(const USART_HandleType){.Inst = (INSTANCE)})
+
 /**
  * @brief USART register bit accessing macro
  * @param HANDLE: specifies the peripheral handle.
@@ -180,6 +264,34 @@ typedef struct
 
 #endif /* USART_BB */
 
+/**
+ * @brief  Computes the BRR register value with 16x oversampling at build time.
+ * @note   The result can be verified with @ref USART_BAUDRATE_ERROR_PERMILLE, e.g.
+ *         XPD_STATIC_ASSERT(USART_BAUDRATE_ERROR_PERMILLE(48000000, 115200) <= 20, "baudrate");
+ * @param  CLOCK: the constant USART kernel clock frequency in Hz
+ * @param  BAUDRATE: the requested baudrate
+ */
+#define         USART_BRR_VALUE(CLOCK, BAUDRATE)                \
+    XPD_DIV_ROUND((CLOCK), (BAUDRATE))
+
+/**
+ * @brief  Computes the BRR register value with 8x oversampling at build time.
+ * @param  CLOCK: the constant USART kernel clock frequency in Hz
+ * @param  BAUDRATE: the requested baudrate
+ */
+#define         USART_BRR_VALUE_OVER8(CLOCK, BAUDRATE)          \
+    ((XPD_DIV_ROUND((CLOCK) * 2, (BAUDRATE)) & ~0xFUL) |        \
+    ((XPD_DIV_ROUND((CLOCK) * 2, (BAUDRATE)) & 0xFUL) >> 1))
+
+/**
+ * @brief  Computes the relative baudrate error of the 16x oversampling divider.
+ * @param  CLOCK: the constant USART kernel clock frequency in Hz
+ * @param  BAUDRATE: the requested baudrate
+ * @return The baudrate deviation in permille
+ */
+#define         USART_BAUDRATE_ERROR_PERMILLE(CLOCK, BAUDRATE)  \
+    XPD_ERROR_PERMILLE(USART_BRR_VALUE(CLOCK, BAUDRATE) * (BAUDRATE), (CLOCK))
+
 /**
  * @brief  Enable the specified USART interrupt.
  * @param  HANDLE: specifies the USART Handle.
@@ -194,6 +306,8 @@ typedef struct
  *            @arg LBD:     LIN break detection
  *            @arg CTS:     Clear To Send
  *            @arg WU:      Wake Up
+ *            @arg RTO:     Receiver timeout
+ *            @arg CM:      Character match
  */
 #define         XPD_USART_EnableIT(  HANDLE,  IT_NAME)          \
     (__XPD_USART_##IT_NAME##IECtrl(HANDLE, ENABLE))
@@ -212,6 +326,8 @@ typedef struct
  *            @arg LBD:     LIN break detection
  *            @arg CTS:     Clear To Send
  *            @arg WU:      Wake Up
+ *            @arg RTO:     Receiver timeout
+ *            @arg CM:      Character match
  */
 #define         XPD_USART_DisableIT( HANDLE,  IT_NAME)          \
         (__XPD_USART_##IT_NAME##IECtrl(HANDLE, DISABLE))
@@ -246,6 +362,10 @@ typedef struct
 #define USART_ISR_LBD       USART_ISR_LBDF
 #define USART_ISR_LBD_Pos   USART_ISR_LBDF_Pos
 #define USART_ICR_RXNECF    0
+#define USART_ISR_RTO       USART_ISR_RTOF
+#define USART_ISR_RTO_Pos   USART_ISR_RTOF_Pos
+#define USART_ISR_CM        USART_ISR_CMF
+#define USART_ISR_CM_Pos    USART_ISR_CMF_Pos
 
 /**
  * @brief  Get the specified USART flag.
@@ -266,6 +386,8 @@ typedef struct
  *            @arg LBD:     LIN break detection
  *            @arg CTS:     Clear To Send
  *            @arg WU:      Wake Up
+ *            @arg RTO:     Receiver timeout
+ *            @arg CM:      Character match
  */
 #define         XPD_USART_GetFlag(  HANDLE, FLAG_NAME)          \
     (((HANDLE)->Inst->ISR.w >> USART_ISR_##FLAG_NAME##_Pos) & 1)
@@ -285,11 +407,14 @@ typedef struct
  *            @arg LBD:     LIN break detection
  *            @arg CTS:     Clear To Send
  *            @arg WU:      Wake Up
+ *            @arg RTO:     Receiver timeout
+ *            @arg CM:      Character match
  */
 #define         XPD_USART_ClearFlag(HANDLE, FLAG_NAME)          \
-    ((USART_ISR_##FLAG_NAME != USART_ISR_RXNE) ?                \
-    ((HANDLE)->Inst->ICR.w = USART_ICR_##FLAG_NAME##CF) :       \
-    ((HANDLE)->Inst->RQR.w = USART_RQR_RXFRQ))
+    do { if (USART_ISR_##FLAG_NAME != USART_ISR_RXNE)           \
+       { (HANDLE)->Inst->ICR.w = USART_ICR_##FLAG_NAME##CF; }   \
+       else                                                     \
+       { (HANDLE)->Inst->RQR.w = USART_RQR_RXFRQ; } } while(0)
 #else
 
 /**
@@ -362,6 +487,12 @@ typedef struct
 #define __XPD_USART_WUIECtrl(HANDLE, NEWSTATE)                  \
     (USART_REG_BIT((HANDLE),CR3,WUFIE) = NEWSTATE)
 
+#define __XPD_USART_RTOIECtrl(HANDLE, NEWSTATE)                 \
+    (USART_REG_BIT((HANDLE),CR1,RTOIE) = NEWSTATE)
+
+#define __XPD_USART_CMIECtrl(HANDLE, NEWSTATE)                  \
+    (USART_REG_BIT((HANDLE),CR1,CMIE) = NEWSTATE)
+
 /** @} */
 
 /** @addtogroup USART_Common_Exported_Functions
@@ -383,12 +514,46 @@ void            XPD_USART_Receive_IT        (USART_HandleType * husart, void * R
 
 void            XPD_USART_IRQHandler        (USART_HandleType * husart);
 
+#ifndef XPD_USART_EXCLUDE_DMA
 XPD_ReturnType  XPD_USART_Transmit_DMA      (USART_HandleType * husart, void * TxData, uint16_t Length);
 XPD_ReturnType  XPD_USART_Receive_DMA       (USART_HandleType * husart, void * RxData, uint16_t Length);
 XPD_ReturnType  XPD_USART_TransmitReceive_DMA(USART_HandleType* husart, void * TxData,
                                              void * RxData, uint16_t Length);
 void            XPD_USART_Stop_DMA          (USART_HandleType * husart);
 
+XPD_ReturnType  XPD_USART_RxRing_Start      (USART_HandleType * husart, void * RxData, uint16_t Length);
+void            XPD_USART_RxRing_Stop       (USART_HandleType * husart);
+uint16_t        XPD_USART_RxRing_Peek       (USART_HandleType * husart, void ** Data);
+void            XPD_USART_RxRing_Consume    (USART_HandleType * husart, uint16_t Count);
+uint16_t        XPD_USART_RxRing_Count      (USART_HandleType * husart);
+void            XPD_USART_RxRing_Hold       (USART_HandleType * husart);
+void            XPD_USART_RxRing_Resume     (USART_HandleType * husart);
+
+#ifdef USART_CR2_RTOEN
+XPD_ReturnType  XPD_USART_Frame_Start       (USART_HandleType * husart, const USART_Frame_InitType * Config,
+                                             void * RxData, uint16_t Length);
+#endif
+
+void            XPD_USART_TxQueue_Init      (USART_HandleType * husart, DMA_DescriptorType * Buffer,
+                                             uint8_t Size);
+XPD_ReturnType  XPD_USART_TxQueue_Put       (USART_HandleType * husart, void * TxData, uint16_t Length);
+
+XPD_ReturnType  XPD_USART_Print_Init        (USART_HandleType * husart, char * Buffer, uint16_t Size);
+XPD_ReturnType  XPD_USART_Printf            (USART_HandleType * husart, const char * Format, ...);
+#ifdef USE_XPD_TRACE
+void            XPD_USART_TraceFlush        (USART_HandleType * husart);
+#endif
+#endif /* XPD_USART_EXCLUDE_DMA */
+
+#ifdef USE_XPD_OS
+XPD_ReturnType  XPD_USART_Transmit_Blocking (USART_HandleType * husart, void * TxData,
+                                             uint16_t Length, uint32_t Timeout);
+XPD_ReturnType  XPD_USART_Receive_Blocking  (USART_HandleType * husart, void * RxData,
+                                             uint16_t Length, uint32_t Timeout);
+#endif
+
+void            XPD_USART_ClockUpdate       (USART_HandleType * husart);
+
 #if (USART_PERIPHERAL_VERSION > 1)
 void            XPD_USART_InversionConfig   (USART_HandleType * husart, USART_InversionType Inversions);
 void            XPD_USART_OverrunConfig     (USART_HandleType * husart, FunctionalState Mode);
@@ -412,14 +577,6 @@ typedef enum
     UART_FLOWCONTROL_RTS_CTS = 3  /*!< Request To Send and Clear To Send signals are used */
 }UART_FlowControlType;
 
-/** @brief UART setup structure */
-typedef struct {
-    UART_FlowControlType FlowControl;   /*!< Hardware flow control select */
-    FunctionalState      OverSampling8; /*!< When the over sampling 8 is enabled (instead of 16),
-                                             higher baudrate is available */
-    FunctionalState      HalfDuplex;    /*!< Half-duplex communication select */
-}UART_InitType;
-
 #if (USART_PERIPHERAL_VERSION > 1)
 /** @brief UART baudrate detection strategy */
 typedef enum
@@ -444,15 +601,31 @@ typedef enum
 }UART_BaudrateModeType;
 #endif
 
+/** @brief UART setup structure */
+typedef struct {
+    UART_FlowControlType FlowControl;   /*!< Hardware flow control select */
+    FunctionalState      OverSampling8; /*!< When the over sampling 8 is enabled (instead of 16),
+                                             higher baudrate is available */
+    FunctionalState      HalfDuplex;    /*!< Half-duplex communication select */
+#ifdef USART_CR2_ABREN
+    UART_BaudrateModeType BaudrateMode; /*!< Baudrate detection strategy */
+#endif
+}UART_InitType;
+
+
 /** @} */
 
 /** @addtogroup UART_Exported_Functions
  * @{ */
 XPD_ReturnType  XPD_UART_Init               (USART_HandleType * husart, const USART_InitType * Common,
                                              const UART_InitType * Config);
+XPD_ReturnType  XPD_UART_Reconfigure        (USART_HandleType * husart, const USART_InitType * Common);
 #if (USART_PERIPHERAL_VERSION > 1)
 void            XPD_UART_BaudrateModeConfig (USART_HandleType * husart, UART_BaudrateModeType Mode);
 #endif
+#if defined(USART_CR2_ABREN) && !defined(XPD_USART_EXCLUDE_DMA)
+XPD_ReturnType  XPD_UART_AutoBaud_Start     (USART_HandleType * husart, void * RxData, uint16_t Length);
+#endif
 /** @} */
 
 /** @} */
@@ -481,6 +654,7 @@ XPD_ReturnType  XPD_USRT_Init               (USART_HandleType * husart, const US
 
 /** @} */
 
+#ifndef XPD_USART_EXCLUDE_MODES
 /** @defgroup LIN Local Interconnect Network
  * @{ */
 
@@ -536,6 +710,10 @@ typedef struct {
 XPD_ReturnType  XPD_MSUART_Init             (USART_HandleType * husart, const USART_InitType * Common,
                                              const MSUART_InitType * Config);
 void            XPD_MSUART_MuteCtrl         (USART_HandleType * husart, FunctionalState NewState);
+#if defined(USART_CR2_RTOEN) && !defined(XPD_USART_EXCLUDE_DMA)
+XPD_ReturnType  XPD_MSUART_Endpoint_Start   (USART_HandleType * husart, uint32_t RxTimeout,
+                                             void * RxData, uint16_t Length);
+#endif
 
 #if (USART_PERIPHERAL_VERSION > 2)
 void            XPD_MSUART_StopModeCtrl     (USART_HandleType * husart, FunctionalState NewState);
@@ -628,11 +806,69 @@ typedef struct
  * @{ */
 XPD_ReturnType  XPD_RS485_Init              (USART_HandleType * husart, const USART_InitType * Common,
                                              const RS485_InitType * Config);
+#if defined(USART_CR2_RTOEN) && !defined(XPD_USART_EXCLUDE_DMA)
+XPD_ReturnType  XPD_RS485_Transaction       (USART_HandleType * husart, const USART_Frame_InitType * Frame,
+                                             void * TxData, uint16_t TxLength,
+                                             void * RxData, uint16_t RxLength);
+#endif
 /** @} */
 
 /** @} */
 #endif
 
+#ifndef XPD_USART_EXCLUDE_DMA
+/** @defgroup OneWire 1-Wire bus master
+ * @{ */
+
+/** @defgroup OneWire_Exported_Types OneWire Exported Types
+ * @{ */
+
+/** @brief 1-Wire transfer structure, each transfer starts with a reset */
+typedef struct
+{
+    const uint8_t * TxData;             /*!< The bytes to write after the reset (ROM and function commands) */
+    uint8_t *       RxData;             /*!< The destination of the bytes read after the written ones */
+    uint8_t         TxLength;           /*!< The number of bytes to write */
+    uint8_t         RxLength;           /*!< The number of bytes to read */
+}OneWire_TransferType;
+
+/** @brief 1-Wire bus master handle structure */
+typedef struct
+{
+    USART_HandleType *           Serial;    /*!< The handle of the bus USART (with Transmit and Receive DMA) */
+    uint8_t *                    Slots;     /*!< The slot buffer of the DMA, 8 bytes per data byte */
+    uint16_t                     Size;      /*!< The size of the slot buffer, at least 10 */
+    XPD_HandleCallbackType       Complete;  /*!< Sequence or search complete callback */
+    uint8_t                      Absent;    /*!< The number of resets of the last operation without presence pulse */
+    uint8_t                      Found;     /*!< The number of ROM codes found by the last search */
+    const OneWire_TransferType * Transfers; /*!< [Internal] The transfers of the sequence, NULL when searching */
+    uint8_t *                    Roms;      /*!< [Internal] The destination of the searched ROM codes */
+    uint8_t                      Count;     /*!< [Internal] The number of transfers or the ROM codes capacity */
+    uint8_t                      Index;     /*!< [Internal] The current transfer */
+    uint8_t                      Phase;     /*!< [Internal] The ongoing slot exchange */
+    uint8_t                      Bit;       /*!< [Internal] The number of searched ROM bits of the pass */
+    uint8_t                      Branch;    /*!< [Internal] The last zero direction ROM bit of the previous pass */
+    uint8_t                      LastZero;  /*!< [Internal] The last zero direction ROM bit of the current pass */
+    uint16_t                     Offset;    /*!< [Internal] The number of exchanged bytes of the transfer */
+    uint16_t                     Chunk;     /*!< [Internal] The number of bytes in the ongoing exchange */
+    volatile uint8_t             Busy;      /*!< [Internal] An operation is in progress */
+}OneWire_HandleType;
+
+/** @} */
+
+/** @addtogroup OneWire_Exported_Functions
+ * @{ */
+XPD_ReturnType  XPD_OneWire_Init            (OneWire_HandleType * how);
+XPD_ReturnType  XPD_OneWire_Sequence_DMA    (OneWire_HandleType * how,
+                                             const OneWire_TransferType * Transfers, uint8_t Count);
+XPD_ReturnType  XPD_OneWire_Search_DMA      (OneWire_HandleType * how, uint8_t * Roms, uint8_t Count);
+uint8_t         XPD_OneWire_CRC8            (const uint8_t * Data, uint16_t Length);
+/** @} */
+
+/** @} */
+#endif /* XPD_USART_EXCLUDE_DMA */
+#endif /* XPD_USART_EXCLUDE_MODES */
+
 /** @} */
 
 #define XPD_USART_API
@@ -640,4 +876,8 @@ XPD_ReturnType  XPD_RS485_Init              (USART_HandleType * husart, const US
 #include "xpd_rcc_pc.h"
 #undef XPD_USART_API
 
+#ifdef __cplusplus
+}
+#endif
+
 #endif /* __XPD_USART_H_ */
@@ -26,6 +26,11 @@
 #include "xpd_common.h"
 #include "xpd_config.h"
 
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
 #ifdef USB_OTG_FS
 /** @defgroup USB
  * @{ */
@@ -48,11 +53,16 @@ typedef struct
     USB_SpeedType   Speed;              /*!< Device speed selection */
     FunctionalState SOF;                /*!< StartOfFrame signal interrupt and callback activation */
     FunctionalState LowPowerMode;       /*!< Low power mode activation */
+    FunctionalState TxFifoEmpty;        /*!< IN FIFOs are refilled when they are completely empty (instead of half empty) */
 #ifdef USB_OTG_GLPMCFG_LPMEN
     FunctionalState LinkPowerMgmt;      /*!< Link Power Management L1 sleep mode support */
 #endif
 #if (USB_DATA_WORD_ALIGNED == 1) && defined(USB_OTG_GAHBCFG_DMAEN)
-    FunctionalState DMA;                /*!< Use dedicated DMA for data transfer */
+    FunctionalState DMA;                /*!< Use dedicated DMA for data transfer (only available in HS core) */
+    uint16_t        DMAThreshold;       /*!< DMA transfer threshold in words [1 .. 511], 0 selects 64 words */
+#endif
+#ifdef USB_OTG_HS
+    FunctionalState DedicatedEP1;       /*!< EP1 events are served by the dedicated EP1 IRQ handlers (only available in HS core) */
 #endif
 }USB_InitType;
 
@@ -65,11 +75,19 @@ typedef enum
     USB_EP_TYPE_INTERRUPT   = 3  /*!< Interrupt endpoint type */
 }USB_EndPointType;
 
+/** @brief USB Endpoint configuration structure for FIFO allocation */
+typedef struct
+{
+    uint8_t             Address;        /*!< Endpoint address (the direction is set by bit 7) */
+    USB_EndPointType    Type;           /*!< Endpoint type */
+    uint16_t            MaxPacketSize;  /*!< Endpoint Max packet size [0..1024] */
+}USB_EndPointConfigType;
+
 /** @brief USB Endpoint management structure */
 typedef struct
 {
     DataStreamType      Transfer;       /*!< Endpoint data transfer context */
-    uint16_t            FifoSize;       /*!< Data FIFO size */
+    uint16_t            FifoSize;       /*!< Data FIFO size [32-bit words] */
     uint16_t            MaxPacketSize;  /*!< Endpoint Max packet size [0..512] */
     USB_EndPointType    Type;           /*!< Endpoint type */
     boolean_t           Stalled;        /*!< Endpoint stall status */
@@ -98,6 +116,20 @@ typedef enum
 }USB_ChargerType;
 #endif
 
+/** @brief USB event callbacks structure */
+typedef struct
+{
+    int (*SetupStage)       (void *, uint8_t *);            /*!< SETUP packet received */
+    int (*DataOutStage)     (void *, uint8_t, uint8_t *);   /*!< OUT data received */
+    int (*DataInStage)      (void *, uint8_t, uint8_t *);   /*!< IN data transmitted */
+    int (*SOF)              (void *);                       /*!< StartOfFrame signal */
+    int (*Reset)            (void *);                       /*!< Device reset */
+    int (*Suspend)          (void *);                       /*!< Suspend request */
+    int (*Resume)           (void *);                       /*!< Resume request */
+    int (*Connected)        (void *);                       /*!< Device connected to bus */
+    int (*Disconnected)     (void *);                       /*!< Device disconnected from bus */
+}USB_CallbacksType;
+
 /** @brief USB Handle structure */
 typedef struct
 {
@@ -109,6 +141,10 @@ typedef struct
     struct {
         XPD_HandleCallbackType DepInit;                         /*!< Callback to initialize module dependencies */
         XPD_HandleCallbackType DepDeinit;                       /*!< Callback to restore module dependencies */
+#ifdef USE_XPD_CONST_CALLBACKS
+        const USB_CallbacksType * Table;                        /*!< Constant event callbacks table, none of its
+                                                                     entries may be NULL (see @ref XPD_USB_NullCallback) */
+#else
         int (*SetupStage)       (void *, uint8_t *);            /*!< SETUP packet received */
         int (*DataOutStage)     (void *, uint8_t, uint8_t *);   /*!< OUT data received */
         int (*DataInStage)      (void *, uint8_t, uint8_t *);   /*!< IN data transmitted */
@@ -118,6 +154,7 @@ typedef struct
         int (*Resume)           (void *);                       /*!< Resume request */
         int (*Connected)        (void *);                       /*!< Device connected to bus */
         int (*Disconnected)     (void *);                       /*!< Device disconnected from bus */
+#endif
     }Callbacks;                                                 /*   Handle Callbacks */
     uint32_t                    Setup[12];                      /*!< Setup packet buffer */
     struct {
@@ -131,6 +168,12 @@ typedef struct
 #if (USB_DATA_WORD_ALIGNED == 1) && defined(USB_OTG_GAHBCFG_DMAEN)
     FunctionalState             DMA;                            /*!< DMA activation */
 #endif
+#ifdef USB_OTG_HS
+    FunctionalState             DedicatedEP1;                   /*!< EP1 dedicated interrupts activation */
+#endif
+#ifdef USE_XPD_STATISTICS
+    XPD_StatsType               Stats;                          /*!< Runtime statistics (errors: [0] packet error, [1] packet memory overrun) */
+#endif
 }USB_HandleType;
 
 /** @} */
@@ -213,6 +256,13 @@ typedef struct
 #define         XPD_USB_ClearFlag(HANDLE, FLAG_NAME)    \
     ((HANDLE)->Inst->GINTSTS.w = USB_OTG_GINTSTS_##FLAG_NAME)
 
+/**
+ * @brief  Provides the frame number of the last received SOF.
+ * @param  HANDLE: specifies the USB Handle.
+ */
+#define         XPD_USB_GetFrameNumber(HANDLE)          \
+    (((HANDLE)->Inst->DSTS.w & USB_OTG_DSTS_FNSOF) >> USB_OTG_DSTS_FNSOF_Pos)
+
 /** @brief USB OTG FS Wake up line number */
 #define USB_OTG_FS_WAKEUP_EXTI_LINE     18
 
@@ -231,6 +281,16 @@ typedef struct
  */
 #define         XPD_USB_BESL(HANDLE)                ((HANDLE)->Inst->GLPMCFG.b.BESL)
 
+/**
+ * @brief  Provides the host's resume latency of the L1 sleep state in microseconds,
+ *         as determined by the BESL value of the last acknowledged LPM token.
+ * @param  HANDLE: specifies the USB Handle.
+ */
+#define         XPD_USB_L1Latency_us(HANDLE)                                \
+    ((XPD_USB_BESL(HANDLE) < 2) ? (125 + 25 * XPD_USB_BESL(HANDLE)) :       \
+     (XPD_USB_BESL(HANDLE) < 6) ? (100 * XPD_USB_BESL(HANDLE)) :            \
+                                  (1000 * (XPD_USB_BESL(HANDLE) - 5)))
+
 /** @} */
 
 /** @addtogroup USB_Exported_Functions
@@ -245,6 +305,8 @@ void            XPD_USB_SetAddress              (USB_HandleType * husb, uint8_t
 
 void            XPD_USB_EP_BufferInit           (USB_HandleType * husb, uint8_t EpAddress,
                                                  uint16_t BufferSize);
+XPD_ReturnType  XPD_USB_EP_FifoAlloc            (USB_HandleType * husb,
+                                                 const USB_EndPointConfigType * Endpoints, uint8_t Count);
 
 void            XPD_USB_EP_Open                 (USB_HandleType * husb, uint8_t EpAddress,
                                                  USB_EndPointType Type, uint16_t MaxPacketSize);
@@ -262,6 +324,17 @@ void            XPD_USB_EP_SetStall             (USB_HandleType * husb, uint8_t
 void            XPD_USB_EP_ClearStall           (USB_HandleType * husb, uint8_t EpAddress);
 
 void            XPD_USB_IRQHandler              (USB_HandleType * husb);
+uint32_t        XPD_USB_Poll                    (USB_HandleType * husb, uint32_t MaxPackets);
+
+void            XPD_USB_SOF_TimerTrigger        (USB_HandleType * husb, FunctionalState NewState);
+
+#ifdef USE_XPD_CONST_CALLBACKS
+int             XPD_USB_NullCallback            (void * User);
+#endif
+#ifdef USB_OTG_HS
+void            XPD_USB_EP1_OUT_IRQHandler      (USB_HandleType * husb);
+void            XPD_USB_EP1_IN_IRQHandler       (USB_HandleType * husb);
+#endif
 
 void            XPD_USB_PHY_ClockCtrl           (USB_HandleType * husb, FunctionalState NewState);
 
@@ -281,4 +354,8 @@ USB_ChargerType XPD_USB_ChargerDetect           (USB_HandleType * husb);
 
 #endif /* USB_OTG_FS */
 
+#ifdef __cplusplus
+}
+#endif
+
 #endif /* __XPD_USB_H_ */
@@ -0,0 +1,219 @@
+/**
+  ******************************************************************************
+  * @file    xpd_usbh.h
+  * @author  Benedek Kupper
+  * @version V0.1
+  * @date    2018-01-20
+  * @brief   STM32 eXtensible Peripheral Drivers USB Host Controller Module
+  *
+  *  This file is part of STM32_XPD.
+  *
+  *  STM32_XPD is free software: you can redistribute it and/or modify
+  *  it under the terms of the GNU General Public License as published by
+  *  the Free Software Foundation, either version 3 of the License, or
+  *  (at your option) any later version.
+  *
+  *  STM32_XPD is distributed in the hope that it will be useful,
+  *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with STM32_XPD.  If not, see <http://www.gnu.org/licenses/>.
+  */
+#ifndef __XPD_USBH_H_
+#define __XPD_USBH_H_
+
+#include "xpd_common.h"
+#include "xpd_config.h"
+#include "xpd_usb.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#ifdef USB_OTG_FS
+
+/** @defgroup USBH
+ *  @brief    USB OTG core host controller
+ *  @details  The host channels (pipes) of the core are allocated to device endpoints,
+ *            and carry out complete transfers: the core splits a transfer into maximum size
+ *            packets, and the controller keeps the packet pipeline filled from the interrupts
+ *            (refilling the transmit FIFO, and rearming the IN channel after each popped packet).
+ *            NAKed bulk and control transactions are retried without upper layer intervention
+ *            in batches: at most @ref XPD_USBH_NAK_RETRIES times within a frame right away,
+ *            then the channel rests until the next SOF, so that a continuously NAKing device
+ *            (e.g. an idle serial adapter) costs a few interrupts per frame.
+ *            OUT transfers are resumed from the last acknowledged packet.
+ *            The transfer result is reported via the Transfer callback as the channel's URB state.
+ *            Only the embedded full speed PHY is supported.
+ *  @code
+    uint8_t bulkIn = XPD_USBH_Channel_Alloc(&husbh);
+
+    XPD_USBH_Start(&husbh);
+    // Connected callback -> XPD_USBH_PortReset(&husbh);
+    // PortEnabled callback -> enumerate the device on a control channel pair
+    XPD_USBH_Channel_Open(&husbh, bulkIn, address, 0x81, USB_EP_TYPE_BULK, 64);
+    XPD_USBH_Channel_Submit(&husbh, bulkIn, FALSE, buffer, sizeof(buffer));
+    // Transfer callback -> XPD_USBH_Channel_GetState(&husbh, bulkIn) == USBH_URB_DONE
+ *  @endcode
+ * @{ */
+
+/** @defgroup USBH_Exported_Types USBH Exported Types
+ * @{ */
+
+/** @brief USB host port speed types */
+typedef enum
+{
+    USBH_SPEED_FULL = 1, /*!< Full speed device is attached */
+    USBH_SPEED_LOW  = 2, /*!< Low speed device is attached */
+}USBH_SpeedType;
+
+/** @brief USB host request block states */
+typedef enum
+{
+    USBH_URB_IDLE     = 0, /*!< No transfer is submitted, or the transfer is in progress */
+    USBH_URB_DONE     = 1, /*!< The transfer is completed (with short packet, or the requested length) */
+    USBH_URB_NOTREADY = 2, /*!< The periodic endpoint NAKed the transfer */
+    USBH_URB_STALL    = 3, /*!< The endpoint responded with STALL */
+    USBH_URB_ERROR    = 4, /*!< The transfer failed with repeated transaction errors */
+}USBH_UrbStateType;
+
+/** @brief USB host configuration structure */
+typedef struct
+{
+    FunctionalState SOF;                /*!< StartOfFrame signal interrupt and callback activation */
+    uint16_t        RxFifoSize;         /*!< Receive FIFO size [32-bit words] */
+    uint16_t        NPTxFifoSize;       /*!< Non-periodic (bulk and control) transmit FIFO size [32-bit words] */
+    uint16_t        PTxFifoSize;        /*!< Periodic (interrupt and isochronous) transmit FIFO size [32-bit words] */
+}USBH_InitType;
+
+/** @brief USB host channel management structure */
+typedef struct
+{
+    uint8_t *           Data;           /*!< The transfer buffer */
+    uint32_t            Length;         /*!< The requested transfer length */
+    uint32_t            Count;          /*!< The number of transferred bytes */
+    uint16_t            MaxPacketSize;  /*!< Endpoint Max packet size */
+    uint8_t             EpAddress;      /*!< Endpoint address (the direction is set by bit 7) */
+    USB_EndPointType    Type;           /*!< Endpoint type */
+    volatile USBH_UrbStateType State;   /*!< The state of the last submitted transfer */
+    uint8_t             Toggle;         /*!< [Internal] The data PID of the next transaction */
+    uint8_t             Status;         /*!< [Internal] The reason of the channel halt */
+    uint8_t             ErrorCount;     /*!< [Internal] The consecutive transaction errors */
+    uint8_t             NakCount;       /*!< [Internal] The NAK retries in the current frame */
+    uint16_t            NakFrame;       /*!< [Internal] The frame number of the NAK retries */
+    uint16_t            Packets;        /*!< [Internal] The packet count of the ongoing core transfer */
+    uint32_t            XferSize;       /*!< [Internal] The size of the ongoing core transfer */
+    uint32_t            Pending;        /*!< [Internal] The bytes of the core transfer which aren't in the FIFO yet */
+}USBH_ChannelHandleType;
+
+/** @brief USB Host Handle structure */
+typedef struct
+{
+    USB_OTG_TypeDef * Inst;                                     /*!< The address of the peripheral instance used by the handle */
+    void *                      User;                           /*!< Pointer to upper stack handler */
+    struct {
+        XPD_HandleCallbackType DepInit;                         /*!< Callback to initialize module dependencies */
+        XPD_HandleCallbackType DepDeinit;                       /*!< Callback to restore module dependencies */
+        XPD_HandleCallbackType Connected;                       /*!< Device connected to the port */
+        XPD_HandleCallbackType Disconnected;                    /*!< Device disconnected from the port */
+        XPD_HandleCallbackType PortEnabled;                     /*!< Port enabled after reset, the device speed is available */
+        XPD_HandleCallbackType SOF;                             /*!< StartOfFrame signal */
+        void (*Transfer)       (void *, uint8_t);               /*!< URB state of the channel changed */
+    }Callbacks;                                                 /*   Handle Callbacks */
+    USBH_ChannelHandleType      Channel[12];                    /*!< Host channel status */
+    uint16_t                    Allocated;                      /*!< [Internal] The allocated channels mask */
+    uint16_t                    Deferred;                       /*!< [Internal] The NAKed channels which are restarted at the next SOF */
+    boolean_t                   SOF;                            /*!< [Internal] The SOF callback is enabled by the configuration */
+    USBH_SpeedType              Speed;                          /*!< The speed of the attached device */
+}USBH_HandleType;
+
+/** @} */
+
+/** @defgroup USBH_Exported_Macros USBH Exported Macros
+ * @{ */
+
+/**
+ * @brief  USB Host Handle initializer macro
+ * @param  INSTANCE: specifies the USB peripheral instance.
+ * @param  INIT_FN: specifies the dependency initialization function to call back.
+ * @param  DEINIT_FN: specifies the dependency deinitialization function to call back.
+ */
+#define         NEW_USBH_HANDLE(INSTANCE,INIT_FN,DEINIT_FN)         \
+     {  .Inst = (INSTANCE),                                         \
+        .Callbacks.DepInit = (INIT_FN), .Callbacks.DepDeinit = (DEINIT_FN)}
+
+#ifndef XPD_USBH_NAK_RETRIES
+/** @brief The number of immediate retries of NAKed bulk and control transactions within a frame,
+ *         the further retries are deferred to the next frame [overrideable] */
+#define XPD_USBH_NAK_RETRIES            2
+#endif
+
+/** @brief Value returned by @ref XPD_USBH_Channel_Alloc when all channels are in use */
+#define USBH_NO_CHANNEL                 0xFF
+
+/**
+ * @brief  Provides the current frame number of the host.
+ * @param  HANDLE: specifies the USB Host Handle.
+ */
+#define         XPD_USBH_GetFrameNumber(HANDLE)     ((HANDLE)->Inst->HFNUM.b.FRNUM)
+
+/**
+ * @brief  Determines whether a device is connected to the port.
+ * @param  HANDLE: specifies the USB Host Handle.
+ */
+#define         XPD_USBH_IsConnected(HANDLE)        ((HANDLE)->Inst->HPRT.b.PCSTS)
+
+/**
+ * @brief  Provides the URB state of the channel's last submitted transfer.
+ * @param  HANDLE: specifies the USB Host Handle.
+ * @param  CHANNEL: the host channel number
+ */
+#define         XPD_USBH_Channel_GetState(HANDLE, CHANNEL)  ((HANDLE)->Channel[CHANNEL].State)
+
+/**
+ * @brief  Provides the transferred data count of the channel's last submitted transfer.
+ * @param  HANDLE: specifies the USB Host Handle.
+ * @param  CHANNEL: the host channel number
+ */
+#define         XPD_USBH_Channel_GetCount(HANDLE, CHANNEL)  ((HANDLE)->Channel[CHANNEL].Count)
+
+/** @} */
+
+/** @addtogroup USBH_Exported_Functions
+ * @{ */
+XPD_ReturnType  XPD_USBH_Init                   (USBH_HandleType * husbh, const USBH_InitType * Config);
+XPD_ReturnType  XPD_USBH_Deinit                 (USBH_HandleType * husbh);
+
+void            XPD_USBH_Start                  (USBH_HandleType * husbh);
+void            XPD_USBH_Stop                   (USBH_HandleType * husbh);
+
+void            XPD_USBH_PortReset              (USBH_HandleType * husbh);
+
+uint8_t         XPD_USBH_Channel_Alloc          (USBH_HandleType * husbh);
+void            XPD_USBH_Channel_Free           (USBH_HandleType * husbh, uint8_t Channel);
+
+void            XPD_USBH_Channel_Open           (USBH_HandleType * husbh, uint8_t Channel,
+                                                 uint8_t DevAddress, uint8_t EpAddress,
+                                                 USB_EndPointType Type, uint16_t MaxPacketSize);
+void            XPD_USBH_Channel_Close          (USBH_HandleType * husbh, uint8_t Channel);
+
+XPD_ReturnType  XPD_USBH_Channel_Submit         (USBH_HandleType * husbh, uint8_t Channel,
+                                                 boolean_t Setup, uint8_t * Data, uint32_t Length);
+void            XPD_USBH_Channel_SetToggle      (USBH_HandleType * husbh, uint8_t Channel, uint8_t Toggle);
+void            XPD_USBH_Channel_Abort          (USBH_HandleType * husbh, uint8_t Channel);
+
+void            XPD_USBH_IRQHandler             (USBH_HandleType * husbh);
+/** @} */
+
+/** @} */
+
+#endif /* USB_OTG_FS */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __XPD_USBH_H_ */
@@ -68,6 +68,7 @@ uint32_t XPD_ADC_GetClockFreq(void)
 #define ADC_SQR_MASK            (ADC_SQR3_SQ1 >> ADC_SQR3_SQ1_Pos)
 #define ADC_SQR_SIZE            (ADC_SQR3_SQ2_Pos - ADC_SQR3_SQ1_Pos)
 #define ADC_SQR_REGDIR          (-1)
+#define ADC_SCHEDULE_RANKS      16
 
 static void adc_dmaConversionRedirect(void *hdma)
 {
@@ -95,6 +96,147 @@ static void adc_dmaErrorRedirect(void *hdma)
 }
 #endif
 
+static void adc_dmaHalfBlockRedirect(void *hdma)
+{
+    ADC_HandleType* hadc = (ADC_HandleType*) ((DMA_HandleType*) hdma)->Owner;
+
+    /* The first half of the double buffer is filled */
+    hadc->Block.buffer = (void*)((DMA_HandleType*) hdma)->Inst->M0AR;
+
+    XPD_SAFE_CALLBACK(hadc->Callbacks.BlockReady, hadc);
+}
+
+static void adc_dmaBlockRedirect(void *hdma)
+{
+    DMA_HandleType * dma = (DMA_HandleType*) hdma;
+    ADC_HandleType* hadc = (ADC_HandleType*) dma->Owner;
+
+    if (DMA_REG_BIT(dma, CR, DBM) != 0)
+    {
+        /* The memory which the DMA has just switched from is filled */
+        hadc->Block.buffer = (void*)(&dma->Inst->M0AR)[1 - XPD_DMA_GetActiveMemory(dma)];
+    }
+    else
+    {
+        /* The second half of the double buffer is filled */
+        hadc->Block.buffer = (uint8_t*)dma->Inst->M0AR + hadc->Block.length * hadc->Block.size;
+    }
+
+    XPD_SAFE_CALLBACK(hadc->Callbacks.BlockReady, hadc);
+}
+
+static void adc_dmaCaptureRedirect(void *hdma)
+{
+    ADC_HandleType* hadc = (ADC_HandleType*) ((DMA_HandleType*) hdma)->Owner;
+
+    /* The post-trigger conversions are stored */
+    XPD_ADC_Stop_DMA(hadc);
+    XPD_DMA_CircularMode(hadc->DMA.Conversion) = 1;
+
+    XPD_SAFE_CALLBACK(hadc->Callbacks.BlockReady, hadc);
+}
+
+/* Redirects the circular capture transfer to stop after the post-trigger conversions */
+static void adc_captureTrigger(ADC_HandleType * hadc)
+{
+    if (hadc->Capture.Armed != 0)
+    {
+        DMA_HandleType * hdma = hadc->DMA.Conversion;
+        uint16_t index, count;
+
+        hadc->Capture.Armed = 0;
+        XPD_ADC_DisableIT(hadc, AWD);
+
+        /* Freeze the circular transfer at the current position */
+        XPD_DMA_Stop_IT(hdma);
+        while (DMA_REG_BIT(hdma, CR, EN) != 0)
+        {
+            /* The ongoing transfer is finished before the stream is disabled */
+        }
+        index = (hadc->Block.length - hdma->Inst->NDTR) % hadc->Block.length;
+        XPD_DMA_CircularMode(hdma) = 0;
+
+        hadc->Capture.Trigger = index;
+        hadc->Capture.Start   = (index + hadc->Capture.PostTrigger) % hadc->Block.length;
+
+        /* The post-trigger conversions overwrite the oldest ones, wrapping at the buffer end */
+        count = hadc->Block.length - index;
+        if (count > hadc->Capture.PostTrigger)
+        {
+            count = hadc->Capture.PostTrigger;
+        }
+        hadc->Capture.Blocks[0].MemAddress = (uint8_t*)hadc->Block.buffer + index * hadc->Block.size;
+        hadc->Capture.Blocks[0].DataCount  = count;
+        hadc->Capture.Blocks[1].MemAddress = hadc->Block.buffer;
+        hadc->Capture.Blocks[1].DataCount  = hadc->Capture.PostTrigger - count;
+
+        hdma->Callbacks.Complete = adc_dmaCaptureRedirect;
+
+        if (count == 0)
+        {
+            adc_dmaCaptureRedirect(hdma);
+        }
+        else
+        {
+            (void) XPD_DMA_StartChain_IT(hdma, (void *)&hadc->Inst->DR, hadc->Capture.Blocks,
+                    (hadc->Capture.Blocks[1].DataCount > 0) ? 2 : 1);
+        }
+    }
+}
+
+/* Updates the VDDA and the temperature with the monitor's injected sequence results */
+static void adc_monitorUpdate(ADC_HandleType * hadc)
+{
+    (void) XPD_ADC_TrackVDDA((uint16_t)hadc->Inst->JDR1);
+
+    hadc->Monitor.Temperature = (uint16_t)hadc->Inst->JDR2;
+}
+
+static XPD_ReturnType adc_streamStart(ADC_HandleType * hadc, void * PeriphAddress, void * Buffer, uint16_t BlockSize)
+{
+    XPD_ReturnType result = XPD_ERROR;
+    DMA_HandleType * hdma = hadc->DMA.Conversion;
+    uint32_t dbm = DMA_REG_BIT(hdma, CR, DBM);
+
+    /* The double buffer is continuously filled by circular or double buffer mode DMA */
+    if (XPD_DMA_CircularMode(hdma) != 0)
+    {
+        hadc->Block.length = BlockSize;
+        hadc->Block.size   = 1 << hdma->Inst->CR.b.PSIZE;
+
+        /* Set up DMA for transfer, in double buffer mode each block has its own memory register */
+        result = XPD_DMA_Start_IT(hdma, PeriphAddress, Buffer, BlockSize << (1 - dbm));
+    }
+
+    if (result == XPD_OK)
+    {
+        /* Set the callback owner */
+        hdma->Owner = hadc;
+
+        /* Set the DMA transfer callbacks */
+        hdma->Callbacks.HalfComplete = adc_dmaHalfBlockRedirect;
+        hdma->Callbacks.Complete     = adc_dmaBlockRedirect;
+#ifdef USE_XPD_DMA_ERROR_DETECT
+        hdma->Callbacks.Error        = adc_dmaErrorRedirect;
+#endif
+        if (dbm != 0)
+        {
+            /* The second block is placed in the inactive memory register */
+            XPD_DMA_SetSwapMemory(hdma, (uint8_t*)Buffer + BlockSize * hadc->Block.size);
+        }
+        else
+        {
+            XPD_DMA_EnableIT(hdma, HT);
+        }
+
+#ifdef USE_XPD_ADC_ERROR_DETECT
+        /* Enable ADC overrun interrupt */
+        XPD_ADC_EnableIT(hadc, OVR);
+#endif
+    }
+    return result;
+}
+
 /* Sets the sample time for a channel configuration */
 static void adc_sampleTimeConfig(ADC_HandleType * hadc, const ADC_ChannelInitType * Channel)
 {
@@ -395,6 +537,8 @@ void XPD_ADC_Stop_IT(ADC_HandleType * hadc)
  */
 void XPD_ADC_IRQHandler(ADC_HandleType * hadc)
 {
+    XPD_PROFILE_BEGIN();
+
     uint32_t sr = hadc->Inst->SR.w;
     uint32_t cr1 = hadc->Inst->CR1.w;
 
@@ -457,6 +601,11 @@ void XPD_ADC_IRQHandler(ADC_HandleType * hadc)
         /* clear the ADC flag for injected end of conversion */
         XPD_ADC_ClearFlag(hadc, JEOC);
 
+        if (hadc->Monitor.Active != 0)
+        {
+            adc_monitorUpdate(hadc);
+        }
+
         /* injected conversion complete callback */
         XPD_SAFE_CALLBACK(hadc->Callbacks.InjConvComplete, hadc);
     }
@@ -465,6 +614,8 @@ void XPD_ADC_IRQHandler(ADC_HandleType * hadc)
     if (    ((sr  & ADC_SR_AWD) != 0)
          && ((cr1 & ADC_CR1_AWDIE) != 0))
     {
+        adc_captureTrigger(hadc);
+
         /* watchdog callback */
         XPD_SAFE_CALLBACK(hadc->Callbacks.Watchdog, hadc);
 
@@ -488,6 +639,8 @@ void XPD_ADC_IRQHandler(ADC_HandleType * hadc)
         XPD_SAFE_CALLBACK(hadc->Callbacks.Error, hadc);
     }
 #endif
+
+    XPD_PROFILE_END();
 }
 
 /**
@@ -544,6 +697,245 @@ void XPD_ADC_Stop_DMA(ADC_HandleType * hadc)
     XPD_DMA_Stop_IT(hadc->DMA.Conversion);
 }
 
+/**
+ * @brief Sets the data widths of the conversion DMA to store each reduced resolution conversion
+ *        in a single byte, so the DMA buffers hold twice as many conversions.
+ * @note  The packed conversions have 8 bit range if the ADC is initialized with 8 bit resolution
+ *        right-aligned, or 6 bit resolution left-aligned (the left-aligned 8 bit data is in the
+ *        upper byte of the data register).
+ *        This function shall be called while the conversion DMA is not running.
+ * @param hadc: pointer to the ADC handle structure
+ * @param NewState: ENABLE for byte storage, DISABLE for the default half word storage
+ * @return ERROR if the conversion data doesn't fit in a byte, OK otherwise
+ */
+XPD_ReturnType XPD_ADC_DMA_BytePacking(ADC_HandleType * hadc, FunctionalState NewState)
+{
+    XPD_ReturnType result = XPD_OK;
+
+    if (NewState == DISABLE)
+    {
+        XPD_DMA_SetDataAlignment(hadc->DMA.Conversion, DMA_ALIGN_HALFWORD, DMA_ALIGN_HALFWORD);
+    }
+    else if ((hadc->Inst->CR1.b.RES == ADC_RESOLUTION_6BIT) ||
+            ((hadc->Inst->CR1.b.RES == ADC_RESOLUTION_8BIT) && (ADC_REG_BIT(hadc, CR2, ALIGN) == 0)))
+    {
+        /* The conversion is read by bytes, as the FIFO would unpack
+         * a half word to two bytes */
+        XPD_DMA_SetDataAlignment(hadc->DMA.Conversion, DMA_ALIGN_BYTE, DMA_ALIGN_BYTE);
+    }
+    else
+    {
+        result = XPD_ERROR;
+    }
+    return result;
+}
+
+/**
+ * @brief Starts continuous DMA-managed streaming of the ADC regular conversions
+ *        into a double buffer. The BlockReady callback is called each time a block is filled,
+ *        the filled block is available in the handle's Block stream while the DMA fills the other.
+ * @note  The conversions shall be triggered by a timer (see @ref XPD_TIM_MasterConfig)
+ *        for a constant sampling rate. The conversion DMA must be initialized in circular mode.
+ *        The streaming is stopped by @ref XPD_ADC_Stop_DMA.
+ * @param hadc: pointer to the ADC handle structure
+ * @param Buffer: memory address of the double buffer, which has the storage for two blocks
+ * @param BlockSize: the number of conversions in a single block
+ * @return ERROR if the DMA is not circular, BUSY if the DMA is in use, OK if successful
+ */
+XPD_ReturnType XPD_ADC_Stream_Start(ADC_HandleType * hadc, void * Buffer, uint16_t BlockSize)
+{
+    XPD_ReturnType result;
+
+    result = adc_streamStart(hadc, (void *)&hadc->Inst->DR, Buffer, BlockSize);
+
+    if (result == XPD_OK)
+    {
+        /* Enable ADC DMA mode with continuous requests */
+        ADC_REG_BIT(hadc, CR2, DDS) = 1;
+        ADC_REG_BIT(hadc, CR2, DMA) = 1;
+
+        XPD_ADC_Start(hadc);
+    }
+    return result;
+}
+
+/**
+ * @brief Starts the watchdog triggered capture of the ADC regular conversions.
+ *        The conversions are continuously stored in a circular buffer until the selected
+ *        analog watchdog is triggered, after which only the requested number of conversions
+ *        is stored. The buffer then contains a contiguous window of conversions before and after
+ *        the trigger, starting at the Capture.Start index (wrapping at the buffer end),
+ *        and the BlockReady callback is called.
+ * @note  The conversions shall be triggered by a timer (see @ref XPD_TIM_MasterConfig)
+ *        for a constant sampling rate. The watchdog has to be configured beforehand,
+ *        and its interrupt is enabled until the trigger. The Capture.Trigger index is the
+ *        first conversion stored after the watchdog interrupt is serviced.
+ *        The capture is stopped by @ref XPD_ADC_Stop_DMA.
+ * @param hadc: pointer to the ADC handle structure
+ * @param Watchdog: the analog watchdog which triggers the capture
+ * @param Buffer: memory address of the circular capture buffer
+ * @param Length: the number of conversions in the buffer
+ * @param PostTrigger: the number of conversions stored after the trigger [0 .. Length]
+ * @return ERROR if the input is invalid, BUSY if the DMA is in use, OK if successful
+ */
+XPD_ReturnType XPD_ADC_Capture_Start(ADC_HandleType * hadc, ADC_WatchdogType Watchdog,
+        void * Buffer, uint16_t Length, uint16_t PostTrigger)
+{
+    XPD_ReturnType result = XPD_ERROR;
+    DMA_HandleType * hdma = hadc->DMA.Conversion;
+
+    if ((Watchdog != ADC_AWD_NONE) && (PostTrigger <= Length))
+    {
+        result = XPD_BUSY;
+    }
+    if ((result == XPD_BUSY) && (XPD_DMA_GetStatus(hdma) == 0))
+    {
+        /* The pre-trigger conversions are continuously stored by circular DMA */
+        XPD_DMA_CircularMode(hdma) = 1;
+        DMA_REG_BIT(hdma, CR, DBM) = 0;
+
+        hadc->Block.buffer  = Buffer;
+        hadc->Block.length  = Length;
+        hadc->Block.size    = 1 << hdma->Inst->CR.b.PSIZE;
+        hadc->Capture.PostTrigger = PostTrigger;
+        hadc->Capture.Trigger     = 0;
+        hadc->Capture.Start       = 0;
+
+        /* Set the callback owner */
+        hdma->Owner = hadc;
+
+        /* Set the DMA transfer callbacks */
+        hdma->Callbacks.HalfComplete = NULL;
+        hdma->Callbacks.Complete     = NULL;
+#ifdef USE_XPD_DMA_ERROR_DETECT
+        hdma->Callbacks.Error        = adc_dmaErrorRedirect;
+#endif
+
+        /* Set up DMA for transfer */
+        result = XPD_DMA_Start_IT(hdma, (void *)&hadc->Inst->DR, Buffer, Length);
+    }
+
+    if (result == XPD_OK)
+    {
+        hadc->Capture.Armed = 1;
+        XPD_ADC_EnableIT(hadc, AWD);
+
+#ifdef USE_XPD_ADC_ERROR_DETECT
+        /* Enable ADC overrun interrupt */
+        XPD_ADC_EnableIT(hadc, OVR);
+#endif
+
+        /* Enable ADC DMA mode with continuous requests */
+        ADC_REG_BIT(hadc, CR2, DDS) = 1;
+        ADC_REG_BIT(hadc, CR2, DMA) = 1;
+
+        XPD_ADC_Start(hadc);
+    }
+
+    return result;
+}
+
+/**
+ * @brief Sets up the regular sequence to convert the channels at different rates.
+ *        Each channel is repeated in the sequence according to its weight, with the repetitions
+ *        spread evenly, so the sample rate of each channel is proportional to its weight.
+ *        The conversions of the single streaming buffer are distributed to the rings of the channels
+ *        by @ref XPD_ADC_Schedule_Demux.
+ * @note  The channel array is referenced by the handle, it shall remain valid while the schedule is used.
+ * @param hadc: pointer to the ADC handle structure
+ * @param Channels: the scheduled channel configuration array pointer
+ * @param ChannelCount: number of scheduled channels
+ * @return ERROR if a weight is zero or the total weight exceeds the sequence length, OK otherwise
+ */
+XPD_ReturnType XPD_ADC_Schedule_Config(ADC_HandleType * hadc,
+        const ADC_ScheduledChannelType * Channels, uint8_t ChannelCount)
+{
+    ADC_ChannelInitType sequence[ADC_SCHEDULE_RANKS];
+    uint8_t counts[ADC_SCHEDULE_RANKS];
+    uint8_t i, rank;
+    uint32_t length = 0;
+
+    if (ChannelCount > ADC_SCHEDULE_RANKS)
+    {
+        return XPD_ERROR;
+    }
+
+    for (i = 0; i < ChannelCount; i++)
+    {
+        if (Channels[i].Weight == 0)
+        {
+            return XPD_ERROR;
+        }
+        length += Channels[i].Weight;
+        counts[i] = 0;
+    }
+
+    if ((length == 0) || (length > ADC_SCHEDULE_RANKS))
+    {
+        return XPD_ERROR;
+    }
+
+    for (rank = 0; rank < length; rank++)
+    {
+        uint8_t next = 0;
+
+        /* Select the channel whose next conversion is due the earliest:
+         * the k-th conversion of a channel is due at (2k + 1) / (2 * Weight) of the sequence */
+        for (i = 1; i < ChannelCount; i++)
+        {
+            if (((2 * counts[i] + 1) * Channels[next].Weight)
+              < ((2 * counts[next] + 1) * Channels[i].Weight))
+            {
+                next = i;
+            }
+        }
+        counts[next]++;
+
+        sequence[rank] = Channels[next].Channel;
+        hadc->Schedule.Ranks[rank] = next;
+    }
+
+    hadc->Schedule.Channels = Channels;
+    hadc->Schedule.Length   = length;
+    hadc->Schedule.Rank     = 0;
+
+    XPD_ADC_ChannelConfig(hadc, sequence, length);
+
+    return XPD_OK;
+}
+
+/**
+ * @brief Distributes the conversions of the scheduled sequence to the rings of the channels.
+ *        The sequence position is kept between the calls, so the function can be called
+ *        with each block from the BlockReady callback of the conversion stream.
+ * @note  The conversions of a channel are dropped when its ring is full.
+ * @param hadc: pointer to the ADC handle structure
+ * @param Conversions: pointer to the conversions in sequence order
+ * @param Count: the number of conversions
+ */
+void XPD_ADC_Schedule_Demux(ADC_HandleType * hadc, const uint16_t * Conversions, uint32_t Count)
+{
+    uint8_t rank = hadc->Schedule.Rank;
+
+    for (; Count > 0; Count--)
+    {
+        XPD_RingType * ring = hadc->Schedule.Channels[hadc->Schedule.Ranks[rank]].Ring;
+
+        if (ring != NULL)
+        {
+            (void) XPD_Ring_Put(ring, Conversions);
+        }
+        Conversions++;
+
+        if (++rank == hadc->Schedule.Length)
+        {
+            rank = 0;
+        }
+    }
+
+    hadc->Schedule.Rank = rank;
+}
+
 /**
  * @brief Initializes the analog watchdog using the setup configuration.
  * @param hadc: pointer to the ADC handle structure
@@ -741,7 +1133,7 @@ void XPD_ADC_Injected_Start_IT(ADC_HandleType * hadc)
 #endif
     XPD_ADC_EnableIT(hadc, JEOC);
 
-    XPD_ADC_Inject_Start(hadc);
+    XPD_ADC_Injected_Start(hadc);
 }
 
 /**
@@ -756,6 +1148,53 @@ void XPD_ADC_Injected_Stop_IT(ADC_HandleType * hadc)
     XPD_ADC_DisableIT(hadc, JEOC);
 }
 
+/**
+ * @brief Starts the background monitoring of the analog supply and the die temperature.
+ *        The injected group converts VREFINT and the temperature sensor at each trigger
+ *        (preferably a slow timer), and the VDDA used by the ADC calculations is updated
+ *        from the filtered VREFINT results in the interrupt context. The regular group remains
+ *        available to the application, and its conversions can be scaled without additional work.
+ * @note  The injected group shall not be used by the application while the monitor is active.
+ *        The function shall be called while the ADC is disabled, on the ADC instance
+ *        which has the internal channels connected.
+ * @param hadc: pointer to the ADC handle structure
+ * @param Trigger: the external trigger of the monitor conversions
+ * @param SampleTime: the sample time of the internal channels (see the device datasheet for the minimum)
+ */
+void XPD_ADC_Monitor_Start(ADC_HandleType * hadc, ADC_InjTriggerSourceType Trigger,
+        ADC_SampleTimeType SampleTime)
+{
+    ADC_Injected_InitType config = {
+        .AutoInjection     = DISABLE,
+        .DiscontinuousMode = DISABLE,
+        .Trigger.InjSource = Trigger,
+        .Trigger.Edge      = EDGE_RISING,
+    };
+    ADC_ChannelInitType channels[2] = {
+        { .Number = ADC1_VREFINT_CHANNEL,    .SampleTime = SampleTime },
+        { .Number = ADC1_TEMPSENSOR_CHANNEL, .SampleTime = SampleTime },
+    };
+
+    XPD_ADC_Injected_Init(hadc, &config);
+    XPD_ADC_Injected_ChannelConfig(hadc, channels, 2);
+
+    hadc->Monitor.Active = 1;
+
+    XPD_ADC_Injected_Start_IT(hadc);
+}
+
+/**
+ * @brief Stops the background monitoring of the analog supply and the die temperature.
+ *        The last VDDA value is kept for the ADC calculations.
+ * @param hadc: pointer to the ADC handle structure
+ */
+void XPD_ADC_Monitor_Stop(ADC_HandleType * hadc)
+{
+    XPD_ADC_Injected_Stop_IT(hadc);
+
+    hadc->Monitor.Active = 0;
+}
+
 /** @} */
 
 /** @} */
@@ -821,6 +1260,83 @@ XPD_ReturnType XPD_ADC_MultiMode_Start_DMA(ADC_HandleType * hadc, void * Address
     return result;
 }
 
+/**
+ * @brief Starts continuous DMA-managed streaming of the packed multi ADC regular conversions
+ *        into a double buffer. The BlockReady callback is called each time a block is filled,
+ *        the filled block is available in the handle's Block stream while the DMA fills the other.
+ * @note  The DMA access mode is selected by the ADC resolution: mode 2 packs two half-word
+ *        conversions, mode 3 packs two byte conversions (6 and 8 bit resolution) in each request.
+ *        The DMA stream is reconfigured for word memory access through a full FIFO with
+ *        4-beat memory bursts, so the Buffer has to be word aligned, and the blocks have to
+ *        consist of whole bursts: the BlockSize has to be a multiple of 4 in mode 2,
+ *        and a multiple of 8 in mode 3.
+ * @note  The conversion DMA must be initialized in circular mode.
+ *        The streaming is stopped by @ref XPD_ADC_MultiMode_Stop_DMA.
+ * @param hadc: pointer to the master ADC handle structure
+ * @param Buffer: memory address of the double buffer, which has the storage for two blocks
+ * @param BlockSize: the number of DMA requests (conversion pairs) in a single block
+ * @return ERROR if the DMA is not circular or the BlockSize is invalid,
+ *         BUSY if the DMA is in use, OK if successful
+ */
+XPD_ReturnType XPD_ADC_MultiMode_Stream_Start(ADC_HandleType * hadc, void * Buffer, uint16_t BlockSize)
+{
+    XPD_ReturnType result = XPD_BUSY;
+    DMA_HandleType * hdma = hadc->DMA.Conversion;
+    /* 6 and 8 bit resolutions use byte pairs, others use half-word pairs */
+    uint32_t mode3 = hadc->Inst->CR1.b.RES > 1;
+
+    /* A memory burst of 4 words transfers 4 requests in mode 2, 8 requests in mode 3 */
+    if ((BlockSize == 0) || ((BlockSize & ((mode3 != 0) ? 7 : 3)) != 0))
+    {
+        result = XPD_ERROR;
+    }
+    /* The stream configuration can only be changed while the DMA is unused */
+    else if (XPD_DMA_GetStatus(hdma) == 0)
+    {
+        uint32_t cr  = hdma->Inst->CR.w;
+        uint32_t fcr = hdma->Inst->FCR.w;
+        uint32_t accessMode = ADC_COMMON(hadc)->CCR.b.DMA;
+
+        if (mode3 != 0)
+        {
+            ADC_COMMON(hadc)->CCR.b.DMA = ADC_DMAACCESSMODE_3;
+            XPD_DMA_SetDataAlignment(hdma, DMA_ALIGN_HALFWORD, DMA_ALIGN_WORD);
+        }
+        else
+        {
+            ADC_COMMON(hadc)->CCR.b.DMA = ADC_DMAACCESSMODE_2;
+            XPD_DMA_SetDataAlignment(hdma, DMA_ALIGN_WORD, DMA_ALIGN_WORD);
+        }
+
+        /* The FIFO collects 4 words for each memory burst */
+        hdma->Inst->CR.b.MBURST = DMA_BURST_INC4;
+        hdma->Inst->CR.b.PBURST = DMA_BURST_SINGLE;
+        hdma->Inst->FCR.b.FTH   = 3;
+        DMA_REG_BIT(hdma,FCR,DMDIS) = 1;
+
+        result = adc_streamStart(hadc, (void *)&ADC_COMMON(hadc)->CDR.w, Buffer, BlockSize);
+
+        if (result != XPD_OK)
+        {
+            /* Restore the original stream configuration */
+            hdma->Inst->CR.w  = cr;
+            hdma->Inst->FCR.w = fcr;
+            ADC_COMMON(hadc)->CCR.b.DMA = accessMode;
+        }
+    }
+
+    if (result == XPD_OK)
+    {
+        /* Enable common DMA mode with continuous requests */
+        ADC_COMMON_REG_BIT(hadc,CCR,DDS) = 1;
+        ADC_REG_BIT(hadc, CR2, DDS) = 1;
+        ADC_REG_BIT(hadc, CR2, DMA) = 1;
+
+        XPD_ADC_Start(hadc);
+    }
+    return result;
+}
+
 /**
  * @brief Disables the ADC and the common DMA transfer.
  * @param hadc: pointer to the ADC handle structure
@@ -833,6 +1349,69 @@ void XPD_ADC_MultiMode_Stop_DMA(ADC_HandleType * hadc)
     XPD_ADC_Stop_DMA(hadc);
 }
 
+/**
+ * @brief Splits packed half-word multi ADC conversions into separate arrays for each ADC.
+ * @note  Both DMA access mode 2 streams and single half-word requests (mode 1) are ordered
+ *        as ADC1, ADC2 (, ADC3) conversions in memory.
+ * @param Packed: the packed conversion results
+ * @param Values: array of the output arrays for each ADC
+ * @param ADCCount: the number of ADCs in the multi mode [2 .. 3]
+ * @param Count: the number of conversions of each ADC to split
+ */
+void XPD_ADC_MultiMode_Deinterleave(const uint16_t * Packed, uint16_t * const Values[],
+        uint8_t ADCCount, uint32_t Count)
+{
+    uint16_t * values1 = Values[0];
+    uint16_t * values2 = Values[1];
+    uint32_t i;
+
+    if (ADCCount == 2)
+    {
+        const uint32_t * pairs = (const uint32_t *)Packed;
+
+        /* A word contains the ADC1 result in the lower, and the ADC2 result in the upper half */
+        for (i = 0; i < Count; i++)
+        {
+            uint32_t pair = pairs[i];
+
+            values1[i] = (uint16_t)pair;
+            values2[i] = (uint16_t)(pair >> 16);
+        }
+    }
+    else
+    {
+        uint16_t * values3 = Values[2];
+
+        for (i = 0; i < Count; i++, Packed += 3)
+        {
+            values1[i] = Packed[0];
+            values2[i] = Packed[1];
+            values3[i] = Packed[2];
+        }
+    }
+}
+
+/**
+ * @brief Splits packed byte multi ADC conversions (DMA access mode 3) into separate arrays for each ADC.
+ * @param Packed: the packed conversion results
+ * @param Values: array of the output arrays for each ADC
+ * @param ADCCount: the number of ADCs in the multi mode [2 .. 3]
+ * @param Count: the number of conversions of each ADC to split
+ */
+void XPD_ADC_MultiMode_Deinterleave8(const uint8_t * Packed, uint8_t * const Values[],
+        uint8_t ADCCount, uint32_t Count)
+{
+    uint32_t i, j;
+
+    for (i = 0; i < Count; i++)
+    {
+        for (j = 0; j < ADCCount; j++)
+        {
+            Values[j][i] = *Packed++;
+        }
+    }
+}
+
 /** @} */
 
 /** @} */
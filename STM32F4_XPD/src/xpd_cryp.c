@@ -0,0 +1,419 @@
+/**
+  ******************************************************************************
+  * @file    xpd_cryp.c
+  * @author  Benedek Kupper
+  * @version V0.1
+  * @date    2018-01-20
+  * @brief   STM32 eXtensible Peripheral Drivers Cryptographic Processor Module
+  *
+  *  This file is part of STM32_XPD.
+  *
+  *  STM32_XPD is free software: you can redistribute it and/or modify
+  *  it under the terms of the GNU General Public License as published by
+  *  the Free Software Foundation, either version 3 of the License, or
+  *  (at your option) any later version.
+  *
+  *  STM32_XPD is distributed in the hope that it will be useful,
+  *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with STM32_XPD.  If not, see <http://www.gnu.org/licenses/>.
+  */
+#include "xpd_cryp.h"
+#include "xpd_utils.h"
+
+#if defined(USE_XPD_CRYP) && defined(CRYP)
+
+/** @addtogroup CRYP
+ * @{ */
+
+#define CRYP_TIMEOUT            10
+
+/* The data is byte swapped, so the byte streams are processed in memory order */
+#define CRYP_CR_DATATYPE_BYTE   CRYP_CR_DATATYPE_1
+
+#define CRYP_CR_ALGOMODE_KEYPREP CRYP_CR_ALGOMODE_AES_KEY
+
+/* GCM phases */
+#define CRYP_GCM_PHASE_INIT     0
+#define CRYP_GCM_PHASE_HEADER   CRYP_CR_GCM_CCMPH_0
+#define CRYP_GCM_PHASE_PAYLOAD  CRYP_CR_GCM_CCMPH_1
+#define CRYP_GCM_PHASE_FINAL    CRYP_CR_GCM_CCMPH
+
+/* The payload counter of GCM starts from 2, as 1 is used for the tag */
+#define CRYP_GCM_COUNTER_START  2
+
+#define CRYP_BLOCK_SIZE         16
+
+static void cryp_queueStart(CRYP_HandleType * hcryp);
+
+/* Reads a big endian word from a byte stream */
+static uint32_t cryp_getWord(const uint8_t * Bytes)
+{
+    return ((uint32_t)Bytes[0] << 24) | ((uint32_t)Bytes[1] << 16)
+         | ((uint32_t)Bytes[2] << 8)  |  (uint32_t)Bytes[3];
+}
+
+/* Control register value of the job's mode */
+static uint32_t cryp_control(const CRYP_JobType * Job)
+{
+    return ((Job->Mode & 7) << CRYP_CR_ALGOMODE_Pos)
+         | ((Job->Mode > 7) ? CRYP_CR_ALGOMODE_3 : 0)
+         | ((uint32_t)Job->KeySize << CRYP_CR_KEYSIZE_Pos)
+         | ((Job->Direction == CRYP_DECRYPT) ? CRYP_CR_ALGODIR : 0)
+         | CRYP_CR_DATATYPE_BYTE;
+}
+
+/* Loads the key of the job, which is right aligned in the key registers */
+static void cryp_keyLoad(CRYP_HandleType * hcryp, const CRYP_JobType * Job)
+{
+    __IO uint32_t * keyReg = &hcryp->Inst->K3RR;
+    const uint8_t * key = Job->Key + ((Job->KeySize + 2) * 8);
+    uint32_t i;
+
+    for (i = 0; i < ((Job->KeySize + 2) * 2); i++)
+    {
+        key -= sizeof(uint32_t);
+        *(keyReg--) = cryp_getWord(key);
+    }
+}
+
+/* Enables the processor and waits for the processing of the current phase */
+static XPD_ReturnType cryp_runPhase(CRYP_HandleType * hcryp, uint32_t Control)
+{
+    uint32_t timeout = CRYP_TIMEOUT;
+
+    hcryp->Inst->CR.w = Control | CRYP_CR_CRYPEN;
+
+    return XPD_WaitForMatch(&hcryp->Inst->SR.w, CRYP_SR_BUSY, 0, &timeout);
+}
+
+/* Feeds zero padded blocks to the processor without reading output */
+static XPD_ReturnType cryp_feedBlocks(CRYP_HandleType * hcryp, const uint8_t * Data, uint32_t Length)
+{
+    XPD_ReturnType result = XPD_OK;
+    uint32_t timeout = CRYP_TIMEOUT;
+
+    while ((Length > 0) && (result == XPD_OK))
+    {
+        uint32_t block[CRYP_BLOCK_SIZE / sizeof(uint32_t)] = { 0 };
+        uint32_t i, size = (Length < CRYP_BLOCK_SIZE) ? Length : CRYP_BLOCK_SIZE;
+
+        for (i = 0; i < size; i++)
+        {
+            ((uint8_t*)block)[i] = Data[i];
+        }
+        Data   += size;
+        Length -= size;
+
+        result = XPD_WaitForMatch(&hcryp->Inst->SR.w, CRYP_SR_IFEM, CRYP_SR_IFEM, &timeout);
+
+        for (i = 0; i < (CRYP_BLOCK_SIZE / sizeof(uint32_t)); i++)
+        {
+            hcryp->Inst->DR = block[i];
+        }
+    }
+    if (result == XPD_OK)
+    {
+        result = XPD_WaitForMatch(&hcryp->Inst->SR.w, CRYP_SR_BUSY, 0, &timeout);
+    }
+    return result;
+}
+
+/* Computes the GCM authentication tag in the final phase */
+static XPD_ReturnType cryp_gcmFinal(CRYP_HandleType * hcryp, CRYP_JobType * Job)
+{
+    XPD_ReturnType result;
+    uint32_t timeout = CRYP_TIMEOUT;
+    uint32_t i;
+
+    /* The final phase is always performed in encryption direction */
+    hcryp->Inst->CR.w = (cryp_control(Job) & ~CRYP_CR_ALGODIR) | CRYP_GCM_PHASE_FINAL | CRYP_CR_CRYPEN;
+
+    /* The bit lengths of the header and the payload as 64 bit big endian values,
+     * reversed to the byte swapped data type */
+    hcryp->Inst->DR = 0;
+    hcryp->Inst->DR = __REV(Job->HeaderLength * 8);
+    hcryp->Inst->DR = 0;
+    hcryp->Inst->DR = __REV(Job->Length * 8);
+
+    result = XPD_WaitForMatch(&hcryp->Inst->SR.w, CRYP_SR_OFNE, CRYP_SR_OFNE, &timeout);
+
+    for (i = 0; (i < 4) && (result == XPD_OK); i++)
+    {
+        Job->Tag[i] = hcryp->Inst->DOUT;
+    }
+    return result;
+}
+
+/* Finishes the ongoing job and starts the next queued one */
+static void cryp_queueFinish(CRYP_HandleType * hcryp, XPD_ReturnType Result)
+{
+    CRYP_JobType * job = hcryp->Queue.Head;
+
+    hcryp->Inst->DMACR.w = 0;
+
+    if ((Result == XPD_OK) && (job->Mode == CRYP_AES_GCM))
+    {
+        Result = cryp_gcmFinal(hcryp, job);
+    }
+    hcryp->Inst->CR.w = 0;
+
+    if (Result == XPD_OK)
+    {
+        XPD_STATS_ADD(hcryp, Transfers, 1);
+        XPD_STATS_ADD(hcryp, Bytes, job->Length);
+    }
+
+    XPD_ENTER_CRITICAL(hcryp);
+
+    /* Remove the finished job from the queue */
+    hcryp->Queue.Head = job->Next;
+    if (hcryp->Queue.Head == NULL)
+    {
+        hcryp->Queue.Tail = NULL;
+    }
+
+    XPD_EXIT_CRITICAL(hcryp);
+
+    /* Start the next job without delay */
+    if (hcryp->Queue.Head != NULL)
+    {
+        cryp_queueStart(hcryp);
+    }
+
+    /* Release the completion token */
+    job->Result = Result;
+    XPD_SAFE_CALLBACK(job->Complete, job);
+}
+
+static void cryp_dmaOutRedirect(void * hdma)
+{
+    cryp_queueFinish((CRYP_HandleType*) ((DMA_HandleType*) hdma)->Owner, XPD_OK);
+}
+
+#ifdef USE_XPD_DMA_ERROR_DETECT
+static void cryp_dmaErrorRedirect(void * hdma)
+{
+    CRYP_HandleType * hcryp = (CRYP_HandleType*) ((DMA_HandleType*) hdma)->Owner;
+
+    XPD_DMA_Stop_IT(hcryp->DMA.In);
+    XPD_DMA_Stop_IT(hcryp->DMA.Out);
+
+    cryp_queueFinish(hcryp, XPD_ERROR);
+}
+#endif
+
+/* Configures the processor for the job, performs the GCM header phase and starts the data DMA */
+static XPD_ReturnType cryp_jobStart(CRYP_HandleType * hcryp, CRYP_JobType * Job)
+{
+    XPD_ReturnType result = XPD_OK;
+    uint32_t control = cryp_control(Job);
+    uint32_t words = Job->Length / sizeof(uint32_t);
+
+    hcryp->Inst->CR.w = 0;
+    hcryp->Inst->CR.w = CRYP_CR_FFLUSH;
+
+    cryp_keyLoad(hcryp, Job);
+
+    /* The decryption key schedule is prepared from the encryption key */
+    if ((Job->Direction == CRYP_DECRYPT) && (Job->Mode <= CRYP_AES_CBC))
+    {
+        result = cryp_runPhase(hcryp, CRYP_CR_ALGOMODE_KEYPREP
+                | ((uint32_t)Job->KeySize << CRYP_CR_KEYSIZE_Pos) | CRYP_CR_DATATYPE_BYTE);
+        hcryp->Inst->CR.w = 0;
+    }
+
+    if (Job->Mode == CRYP_AES_GCM)
+    {
+        uint32_t timeout = CRYP_TIMEOUT;
+
+        hcryp->Inst->IV0LR = cryp_getWord(&Job->IV[0]);
+        hcryp->Inst->IV0RR = cryp_getWord(&Job->IV[4]);
+        hcryp->Inst->IV1LR = cryp_getWord(&Job->IV[8]);
+        hcryp->Inst->IV1RR = CRYP_GCM_COUNTER_START;
+
+        /* Init phase: the hash subkey is computed, CRYPEN is cleared when finished */
+        hcryp->Inst->CR.w = control | CRYP_GCM_PHASE_INIT | CRYP_CR_CRYPEN;
+        result = XPD_WaitForMatch(&hcryp->Inst->CR.w, CRYP_CR_CRYPEN, 0, &timeout);
+
+        /* Header phase: the additional data is only authenticated */
+        if ((result == XPD_OK) && (Job->HeaderLength > 0))
+        {
+            hcryp->Inst->CR.w = control | CRYP_GCM_PHASE_HEADER | CRYP_CR_CRYPEN;
+            result = cryp_feedBlocks(hcryp, Job->Header, Job->HeaderLength);
+        }
+
+        control |= CRYP_GCM_PHASE_PAYLOAD;
+    }
+    else if (Job->Mode != CRYP_AES_ECB)
+    {
+        hcryp->Inst->IV0LR = cryp_getWord(&Job->IV[0]);
+        hcryp->Inst->IV0RR = cryp_getWord(&Job->IV[4]);
+        hcryp->Inst->IV1LR = cryp_getWord(&Job->IV[8]);
+        hcryp->Inst->IV1RR = cryp_getWord(&Job->IV[12]);
+    }
+
+    if (result != XPD_OK)
+    {
+        /* Setup failed */
+    }
+    else if (words == 0)
+    {
+        /* Authentication only, the tag is computed right away */
+        hcryp->Inst->CR.w = control | CRYP_CR_CRYPEN;
+        cryp_queueFinish(hcryp, XPD_OK);
+    }
+    else
+    {
+        hcryp->Inst->CR.w = control | CRYP_CR_CRYPEN;
+
+        /* The output stream signals the job completion */
+        result = XPD_DMA_Start_IT(hcryp->DMA.Out, (void*)&hcryp->Inst->DOUT, Job->Output, words);
+
+        if (result == XPD_OK)
+        {
+            result = XPD_DMA_Start_IT(hcryp->DMA.In, (void*)&hcryp->Inst->DR, (void*)Job->Input, words);
+
+            if (result == XPD_OK)
+            {
+                hcryp->Inst->DMACR.w = CRYP_DMACR_DIEN | CRYP_DMACR_DOEN;
+            }
+            else
+            {
+                XPD_DMA_Stop_IT(hcryp->DMA.Out);
+            }
+        }
+    }
+    return result;
+}
+
+/* Starts the first queued job */
+static void cryp_queueStart(CRYP_HandleType * hcryp)
+{
+    XPD_ReturnType result = cryp_jobStart(hcryp, hcryp->Queue.Head);
+
+    /* Job could not be started, finish it */
+    if (result != XPD_OK)
+    {
+        cryp_queueFinish(hcryp, result);
+    }
+}
+
+/** @defgroup CRYP_Exported_Functions CRYP Exported Functions
+ * @{ */
+
+/**
+ * @brief Initializes the CRYP peripheral and its DMA streams.
+ * @note  The DMA streams have to be initialized by the DepInit callback with word data alignment,
+ *        the In stream in memory to peripheral, the Out stream in peripheral to memory direction.
+ * @param hcryp: pointer to the CRYP handle structure
+ */
+void XPD_CRYP_Init(CRYP_HandleType * hcryp)
+{
+    /* enable clock */
+    XPD_SAFE_CALLBACK(hcryp->ClockCtrl, ENABLE);
+
+    hcryp->Inst->CR.w = 0;
+    hcryp->Inst->DMACR.w = 0;
+    hcryp->Inst->IMSCR.w = 0;
+
+    hcryp->Queue.Head = hcryp->Queue.Tail = NULL;
+
+    /* Dependencies initialization */
+    XPD_SAFE_CALLBACK(hcryp->Callbacks.DepInit, hcryp);
+
+    hcryp->DMA.In->Owner  = hcryp;
+    hcryp->DMA.Out->Owner = hcryp;
+
+    hcryp->DMA.In->Callbacks.Complete      = NULL;
+    hcryp->DMA.In->Callbacks.HalfComplete  = NULL;
+    hcryp->DMA.Out->Callbacks.Complete     = cryp_dmaOutRedirect;
+    hcryp->DMA.Out->Callbacks.HalfComplete = NULL;
+#ifdef USE_XPD_DMA_ERROR_DETECT
+    hcryp->DMA.In->Callbacks.Error         = cryp_dmaErrorRedirect;
+    hcryp->DMA.Out->Callbacks.Error        = cryp_dmaErrorRedirect;
+#endif
+}
+
+/**
+ * @brief Stops the ongoing job and restores the CRYP peripheral to its default inactive state.
+ * @note  The queued jobs are not completed.
+ * @param hcryp: pointer to the CRYP handle structure
+ */
+void XPD_CRYP_Deinit(CRYP_HandleType * hcryp)
+{
+    hcryp->Inst->DMACR.w = 0;
+    hcryp->Inst->CR.w = 0;
+
+    XPD_DMA_Stop_IT(hcryp->DMA.In);
+    XPD_DMA_Stop_IT(hcryp->DMA.Out);
+
+    hcryp->Queue.Head = hcryp->Queue.Tail = NULL;
+
+    /* Deinitialize peripheral dependencies */
+    XPD_SAFE_CALLBACK(hcryp->Callbacks.DepDeinit, hcryp);
+
+    /* disable clock */
+    XPD_SAFE_CALLBACK(hcryp->ClockCtrl, DISABLE);
+}
+
+/**
+ * @brief Adds an AES job to the processor queue. The queued jobs are performed
+ *        one after the other, with the data streamed through the processor by DMA,
+ *        each with its own key and mode. The GCM additional data is fed by the CPU,
+ *        and the authentication tag is computed at the end of the job.
+ *        The Complete callback of the job is called when the output is written.
+ * @note  The job structure must remain valid until its Complete callback.
+ *        The decrypted GCM tag has to be compared with the received one by the application.
+ * @param hcryp: pointer to the CRYP handle structure
+ * @param Job: pointer to the job to queue
+ * @return ERROR if the data length is invalid, BUSY if the job is queued after others,
+ *         otherwise the result of the job start
+ *         (the Result of the job is BUSY until the job is finished)
+ */
+XPD_ReturnType XPD_CRYP_Submit(CRYP_HandleType * hcryp, CRYP_JobType * Job)
+{
+    XPD_ReturnType result = XPD_BUSY;
+    CRYP_JobType * tail;
+
+    if (((Job->Length % CRYP_BLOCK_SIZE) != 0) || ((Job->Length / sizeof(uint32_t)) > 0xFFFF))
+    {
+        return XPD_ERROR;
+    }
+
+    Job->Next   = NULL;
+    Job->Result = XPD_BUSY;
+
+    XPD_ENTER_CRITICAL(hcryp);
+
+    tail = hcryp->Queue.Tail;
+    if (tail != NULL)
+    {
+        tail->Next = Job;
+    }
+    else
+    {
+        hcryp->Queue.Head = Job;
+    }
+    hcryp->Queue.Tail = Job;
+
+    XPD_EXIT_CRITICAL(hcryp);
+
+    /* The processor is idle, start the job now */
+    if (tail == NULL)
+    {
+        cryp_queueStart(hcryp);
+
+        result = (Job->Result == XPD_BUSY) ? XPD_OK : Job->Result;
+    }
+    return result;
+}
+
+/** @} */
+
+/** @} */
+
+#endif /* USE_XPD_CRYP */
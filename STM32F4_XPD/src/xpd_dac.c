@@ -0,0 +1,399 @@
+/**
+  ******************************************************************************
+  * @file    xpd_dac.c
+  * @author  Benedek Kupper
+  * @version V0.1
+  * @date    2018-01-20
+  * @brief   STM32 eXtensible Peripheral Drivers DAC Module
+  *
+  *  This file is part of STM32_XPD.
+  *
+  *  STM32_XPD is free software: you can redistribute it and/or modify
+  *  it under the terms of the GNU General Public License as published by
+  *  the Free Software Foundation, either version 3 of the License, or
+  *  (at your option) any later version.
+  *
+  *  STM32_XPD is distributed in the hope that it will be useful,
+  *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with STM32_XPD.  If not, see <http://www.gnu.org/licenses/>.
+  */
+#include "xpd_dac.h"
+#include "xpd_utils.h"
+
+#if defined(USE_XPD_DAC)
+
+/** @addtogroup DAC
+ * @{ */
+
+/* The channel 2 control bits are located above the channel 1 bits */
+#define DAC_CR_SHIFT(CHANNEL)       (16 * (CHANNEL))
+
+/* The channel 1 control bits which are set up by the channel configuration */
+#define DAC_CR_CONFIG_MASK          (DAC_CR_TEN1 | DAC_CR_TSEL1 | DAC_CR_WAVE1 | DAC_CR_MAMP1)
+
+#ifdef DAC_CR_BOFF1
+#define DAC_CR_BUFFER_OFF           DAC_CR_BOFF1
+#endif
+
+static void dac_dmaHalfBlockRedirect(void * hdma)
+{
+    DAC_StreamType * stream = (DAC_StreamType*) ((DMA_HandleType*) hdma)->Owner;
+    DAC_HandleType * hdac = (DAC_HandleType*) stream->Owner;
+    (void) hdac;
+
+    /* The first half of the double buffer is transmitted */
+    stream->Block.buffer = stream->Buffer;
+
+    XPD_STATS_ADD(hdac, Transfers, 1);
+    XPD_STATS_ADD(hdac, Bytes, stream->Block.length * stream->Block.size);
+
+    XPD_SAFE_CALLBACK(stream->BlockFree, stream);
+}
+
+static void dac_dmaBlockRedirect(void * hdma)
+{
+    DAC_StreamType * stream = (DAC_StreamType*) ((DMA_HandleType*) hdma)->Owner;
+    DAC_HandleType * hdac = (DAC_HandleType*) stream->Owner;
+    (void) hdac;
+
+    /* The second half of the double buffer is transmitted */
+    stream->Block.buffer = (uint8_t*)stream->Buffer
+            + stream->Block.length * stream->Block.size;
+
+    XPD_STATS_ADD(hdac, Transfers, 1);
+    XPD_STATS_ADD(hdac, Bytes, stream->Block.length * stream->Block.size);
+
+    XPD_SAFE_CALLBACK(stream->BlockFree, stream);
+}
+
+#ifdef USE_XPD_DMA_ERROR_DETECT
+static void dac_dmaErrorRedirect(void * hdma)
+{
+    DAC_StreamType * stream = (DAC_StreamType*) ((DMA_HandleType*) hdma)->Owner;
+    DAC_HandleType * hdac = (DAC_HandleType*) stream->Owner;
+
+    /* Update error code */
+    hdac->Errors |= DAC_ERROR_DMA;
+    XPD_STATS_ERROR(hdac, DAC_ERROR_DMA);
+
+    XPD_SAFE_CALLBACK(hdac->Callbacks.Error, hdac);
+}
+#endif
+
+/* Sets up the circular DMA transfer of the stream and enables the DMA requests of the channel */
+static XPD_ReturnType dac_streamStart(DAC_HandleType * hdac, DAC_ChannelType Channel,
+        DAC_StreamType * Stream, volatile uint32_t * Register, DMA_AlignmentType Align,
+        void * Buffer, uint16_t BlockSize)
+{
+    XPD_ReturnType result = XPD_ERROR;
+    DMA_HandleType * hdma = hdac->DMA.Channel[Channel];
+
+    /* The double buffer is continuously transmitted by circular DMA */
+    if (XPD_DMA_CircularMode(hdma) != 0)
+    {
+        result = XPD_BUSY;
+
+        /* The data width can only be changed while the DMA is idle */
+        if (XPD_DMA_GetStatus(hdma) == 0)
+        {
+            XPD_DMA_SetDataAlignment(hdma, Align, Align);
+
+            /* Set up DMA for transfer */
+            result = XPD_DMA_Start_IT(hdma, (void *)Register, Buffer, 2 * BlockSize);
+        }
+    }
+
+    if (result == XPD_OK)
+    {
+        uint32_t dmaBits = DAC_CR_DMAEN1;
+
+        Stream->Buffer       = Buffer;
+        Stream->Block.buffer = Buffer;
+        Stream->Block.length = BlockSize;
+        Stream->Block.size   = 1 << Align;
+        Stream->Owner        = hdac;
+        Stream->Channel      = Channel;
+
+        /* Set the callback owner */
+        hdma->Owner = Stream;
+
+        /* Set the DMA transfer callbacks */
+        hdma->Callbacks.HalfComplete = dac_dmaHalfBlockRedirect;
+        hdma->Callbacks.Complete     = dac_dmaBlockRedirect;
+#ifdef USE_XPD_DMA_ERROR_DETECT
+        hdma->Callbacks.Error        = dac_dmaErrorRedirect;
+#endif
+        XPD_DMA_EnableIT(hdma, HT);
+
+#ifdef USE_XPD_DAC_ERROR_DETECT
+        /* Enable DMA underrun interrupt */
+        hdac->Inst->SR.w = DAC_SR_DMAUDR1 << DAC_CR_SHIFT(Channel);
+        dmaBits |= DAC_CR_DMAUDRIE1;
+#endif
+        SET_BIT(hdac->Inst->CR.w, dmaBits << DAC_CR_SHIFT(Channel));
+    }
+    return result;
+}
+
+/** @defgroup DAC_Exported_Functions DAC Exported Functions
+ * @{ */
+
+/**
+ * @brief Initializes the DAC peripheral.
+ * @param hdac: pointer to the DAC handle structure
+ * @return OK
+ */
+XPD_ReturnType XPD_DAC_Init(DAC_HandleType * hdac)
+{
+    /* enable clock */
+    XPD_SAFE_CALLBACK(hdac->ClockCtrl, ENABLE);
+
+    /* Both channels are disabled */
+    hdac->Inst->CR.w = 0;
+
+#if defined(USE_XPD_DAC_ERROR_DETECT) || defined(USE_XPD_DMA_ERROR_DETECT)
+    hdac->Errors = DAC_ERROR_NONE;
+#endif
+
+    /* Dependencies initialization */
+    XPD_SAFE_CALLBACK(hdac->Callbacks.DepInit, hdac);
+
+    return XPD_OK;
+}
+
+/**
+ * @brief Restores the DAC peripheral to its default inactive state.
+ * @param hdac: pointer to the DAC handle structure
+ * @return OK
+ */
+XPD_ReturnType XPD_DAC_Deinit(DAC_HandleType * hdac)
+{
+    hdac->Inst->CR.w = 0;
+
+    /* Deinitialize peripheral dependencies */
+    XPD_SAFE_CALLBACK(hdac->Callbacks.DepDeinit, hdac);
+
+    /* Disable clock */
+    XPD_SAFE_CALLBACK(hdac->ClockCtrl, DISABLE);
+
+    return XPD_OK;
+}
+
+/**
+ * @brief Configures a DAC output channel.
+ * @note  The channel shall be disabled during the configuration.
+ *        For a constant sample rate, select a timer trigger and set the timer's TRGO
+ *        to the update event by @ref XPD_TIM_MasterConfig.
+ * @param hdac: pointer to the DAC handle structure
+ * @param Channel: the selected output channel
+ * @param Config: pointer to the channel setup configuration
+ */
+void XPD_DAC_Channel_Init(DAC_HandleType * hdac, DAC_ChannelType Channel,
+        const DAC_Channel_InitType * Config)
+{
+    uint32_t cr = 0;
+
+    if (Config->Trigger != DAC_TRIGGER_NONE)
+    {
+        cr = DAC_CR_TEN1 | ((uint32_t)Config->Trigger << DAC_CR_TSEL1_Pos);
+    }
+
+#ifdef DAC_CR_BUFFER_OFF
+    if (Config->OutputBuffer == DISABLE)
+    {
+        cr |= DAC_CR_BUFFER_OFF;
+    }
+    MODIFY_REG(hdac->Inst->CR.w, (DAC_CR_CONFIG_MASK | DAC_CR_BUFFER_OFF) << DAC_CR_SHIFT(Channel),
+            cr << DAC_CR_SHIFT(Channel));
+#else
+    MODIFY_REG(hdac->Inst->CR.w, DAC_CR_CONFIG_MASK << DAC_CR_SHIFT(Channel),
+            cr << DAC_CR_SHIFT(Channel));
+
+    /* The output connects to the pin, with or without buffer */
+    MODIFY_REG(hdac->Inst->MCR.w, DAC_MCR_MODE1 << DAC_CR_SHIFT(Channel),
+            ((Config->OutputBuffer == DISABLE) ? DAC_MCR_MODE1_1 : 0) << DAC_CR_SHIFT(Channel));
+#endif
+}
+
+/**
+ * @brief Enables the DAC output channel.
+ * @param hdac: pointer to the DAC handle structure
+ * @param Channel: the selected output channel
+ */
+void XPD_DAC_Channel_Enable(DAC_HandleType * hdac, DAC_ChannelType Channel)
+{
+    SET_BIT(hdac->Inst->CR.w, DAC_CR_EN1 << DAC_CR_SHIFT(Channel));
+}
+
+/**
+ * @brief Disables the DAC output channel.
+ * @param hdac: pointer to the DAC handle structure
+ * @param Channel: the selected output channel
+ */
+void XPD_DAC_Channel_Disable(DAC_HandleType * hdac, DAC_ChannelType Channel)
+{
+    CLEAR_BIT(hdac->Inst->CR.w, DAC_CR_EN1 << DAC_CR_SHIFT(Channel));
+}
+
+/**
+ * @brief Sets the next output value of the DAC channel.
+ * @param hdac: pointer to the DAC handle structure
+ * @param Channel: the selected output channel
+ * @param Format: the alignment of the value
+ * @param Value: the new output value
+ */
+void XPD_DAC_Channel_SetValue(DAC_HandleType * hdac, DAC_ChannelType Channel,
+        DAC_DataFormatType Format, uint16_t Value)
+{
+    /* DHR12R, DHR12L, DHR8R of each channel follow each other */
+    (&hdac->Inst->DHR1.D12R)[(3 * Channel) + Format] = Value;
+}
+
+/**
+ * @brief Sets the next output values of both DAC channels at once.
+ * @param hdac: pointer to the DAC handle structure
+ * @param Format: the alignment of the values
+ * @param Value1: the new output value of channel 1
+ * @param Value2: the new output value of channel 2
+ */
+void XPD_DAC_Dual_SetValue(DAC_HandleType * hdac, DAC_DataFormatType Format,
+        uint16_t Value1, uint16_t Value2)
+{
+    uint32_t shift = (Format == DAC_DATA_8R) ? 8 : 16;
+
+    (&hdac->Inst->DHRD.D12R)[Format] = (uint32_t)Value1 | ((uint32_t)Value2 << shift);
+}
+
+/**
+ * @brief Starts continuous DMA-managed streaming of a double buffer to the DAC channel.
+ *        The buffer elements are 16 bit wide for 12-bit data, 8 bit wide for 8-bit data.
+ *        The BlockFree callback of the stream is called each time a block is transmitted,
+ *        the transmitted block is available in the stream's Block while the DMA sends the other.
+ * @note  The complete double buffer shall be filled before the start.
+ *        The conversions shall be triggered by a timer (see @ref XPD_TIM_MasterConfig)
+ *        for a constant sample rate. The channel DMA must be initialized in circular mode.
+ *        The streaming is stopped by @ref XPD_DAC_Stream_Stop.
+ * @param hdac: pointer to the DAC handle structure
+ * @param Channel: the selected output channel
+ * @param Stream: pointer to the stream context
+ * @param Format: the alignment of the buffer data
+ * @param Buffer: memory address of the double buffer, which has the storage for two blocks
+ * @param BlockSize: the number of samples in a single block
+ * @return ERROR if the DMA is not circular, BUSY if the DMA is in use, OK if successful
+ */
+XPD_ReturnType XPD_DAC_Stream_Start(DAC_HandleType * hdac, DAC_ChannelType Channel,
+        DAC_StreamType * Stream, DAC_DataFormatType Format, void * Buffer, uint16_t BlockSize)
+{
+    XPD_ReturnType result;
+
+    result = dac_streamStart(hdac, Channel, Stream,
+            &(&hdac->Inst->DHR1.D12R)[(3 * Channel) + Format],
+            (Format == DAC_DATA_8R) ? DMA_ALIGN_BYTE : DMA_ALIGN_HALFWORD,
+            Buffer, BlockSize);
+
+    if (result == XPD_OK)
+    {
+        XPD_DAC_Channel_Enable(hdac, Channel);
+    }
+    return result;
+}
+
+/**
+ * @brief Starts continuous DMA-managed streaming of a double buffer to both DAC channels.
+ *        Each buffer element is a channel 1 sample in the lower and a channel 2 sample
+ *        in the upper half, 32 bit wide for 12-bit data, 16 bit wide for 8-bit data.
+ *        The BlockFree callback of the stream is called each time a block is transmitted,
+ *        the transmitted block is available in the stream's Block while the DMA sends the other.
+ * @note  Both channels shall be configured with the same trigger, and the DMA of
+ *        channel 1 is used for the transfer. The channel DMA must be initialized in circular mode.
+ *        The streaming is stopped by @ref XPD_DAC_Stream_Stop.
+ * @param hdac: pointer to the DAC handle structure
+ * @param Stream: pointer to the stream context
+ * @param Format: the alignment of the buffer data
+ * @param Buffer: memory address of the double buffer, which has the storage for two blocks
+ * @param BlockSize: the number of sample pairs in a single block
+ * @return ERROR if the DMA is not circular, BUSY if the DMA is in use, OK if successful
+ */
+XPD_ReturnType XPD_DAC_DualStream_Start(DAC_HandleType * hdac, DAC_StreamType * Stream,
+        DAC_DataFormatType Format, void * Buffer, uint16_t BlockSize)
+{
+    XPD_ReturnType result;
+
+    result = dac_streamStart(hdac, DAC_CHANNEL_1, Stream,
+            &(&hdac->Inst->DHRD.D12R)[Format],
+            (Format == DAC_DATA_8R) ? DMA_ALIGN_HALFWORD : DMA_ALIGN_WORD,
+            Buffer, BlockSize);
+
+    if (result == XPD_OK)
+    {
+        SET_BIT(hdac->Inst->CR.w, DAC_CR_EN1 | DAC_CR_EN2);
+    }
+    return result;
+}
+
+/**
+ * @brief Stops the DMA stream of the DAC. The outputs keep the last converted value.
+ * @param hdac: pointer to the DAC handle structure
+ * @param Stream: pointer to the stream context
+ */
+void XPD_DAC_Stream_Stop(DAC_HandleType * hdac, DAC_StreamType * Stream)
+{
+    /* Disable the DMA requests of the channel */
+    CLEAR_BIT(hdac->Inst->CR.w, (DAC_CR_DMAEN1 | DAC_CR_DMAUDRIE1) << DAC_CR_SHIFT(Stream->Channel));
+
+    XPD_DMA_Stop_IT(hdac->DMA.Channel[Stream->Channel]);
+}
+
+#ifdef USE_XPD_DAC_ERROR_DETECT
+/**
+ * @brief DAC DMA underrun interrupt handler.
+ * @note  The DMA requests of the channel are no longer served after an underrun,
+ *        the stream has to be restarted (e.g. in the Error callback).
+ *        The DAC interrupt line is shared with TIM6 on most devices.
+ * @param hdac: pointer to the DAC handle structure
+ */
+void XPD_DAC_IRQHandler(DAC_HandleType * hdac)
+{
+    XPD_PROFILE_BEGIN();
+    XPD_STATS_IRQ_BEGIN();
+
+    uint32_t sr = hdac->Inst->SR.w;
+    uint32_t cr = hdac->Inst->CR.w;
+    DAC_ErrorType errors = DAC_ERROR_NONE;
+
+    if (((sr & DAC_SR_DMAUDR1) != 0) && ((cr & DAC_CR_DMAUDRIE1) != 0))
+    {
+        errors |= DAC_ERROR_UNDERRUN1;
+    }
+    if (((sr & DAC_SR_DMAUDR2) != 0) && ((cr & DAC_CR_DMAUDRIE2) != 0))
+    {
+        errors |= DAC_ERROR_UNDERRUN2;
+    }
+
+    if (errors != DAC_ERROR_NONE)
+    {
+        /* Clear the underrun flags */
+        hdac->Inst->SR.w = sr & (DAC_SR_DMAUDR1 | DAC_SR_DMAUDR2);
+
+        /* Update error code */
+        hdac->Errors |= errors;
+        XPD_STATS_ERROR(hdac, errors);
+
+        /* Error callback */
+        XPD_SAFE_CALLBACK(hdac->Callbacks.Error, hdac);
+    }
+
+    XPD_STATS_IRQ_END(hdac);
+    XPD_PROFILE_END();
+}
+#endif
+
+/** @} */
+
+/** @} */
+
+#endif /* USE_XPD_DAC */
@@ -0,0 +1,328 @@
+/**
+  ******************************************************************************
+  * @file    xpd_dcmi.c
+  * @author  Benedek Kupper
+  * @version V0.1
+  * @date    2018-01-20
+  * @brief   STM32 eXtensible Peripheral Drivers Digital Camera Interface Module
+  *
+  *  This file is part of STM32_XPD.
+  *
+  *  STM32_XPD is free software: you can redistribute it and/or modify
+  *  it under the terms of the GNU General Public License as published by
+  *  the Free Software Foundation, either version 3 of the License, or
+  *  (at your option) any later version.
+  *
+  *  STM32_XPD is distributed in the hope that it will be useful,
+  *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with STM32_XPD.  If not, see <http://www.gnu.org/licenses/>.
+  */
+#include "xpd_dcmi.h"
+#include "xpd_utils.h"
+
+#if defined(USE_XPD_DCMI) && defined(DCMI)
+
+/** @addtogroup DCMI
+ * @{ */
+
+/* The maximal number of word transfers of a DMA block */
+#define DCMI_DMA_MAX_BLOCK      0xFFFF
+
+/* The maximal number of DMA blocks in a frame */
+#define DCMI_MAX_BLOCKS         256
+
+#define DCMI_ERRORS             (DCMI_MIS_OVR_MIS | DCMI_MIS_ERR_MIS)
+
+/* Starts the DMA transfer of the frame with the first two blocks */
+static XPD_ReturnType dcmi_dmaStart(DCMI_HandleType * hdcmi)
+{
+    DMA_HandleType * hdma = hdcmi->DMA.Capture;
+    XPD_ReturnType result;
+
+    result = XPD_DMA_Start_IT(hdma, (void *)&hdcmi->Inst->DR,
+            hdcmi->Frame.Buffer, hdcmi->Frame.BlockLength);
+
+    if (result == XPD_OK)
+    {
+        /* The second block is placed in the inactive memory register */
+        XPD_DMA_SetSwapMemory(hdma, hdcmi->Frame.Buffer + hdcmi->Frame.BlockLength);
+        hdcmi->Frame.Next = (hdcmi->Frame.Blocks > 2) ? 2 : 0;
+    }
+    return result;
+}
+
+static void dcmi_dmaBlockRedirect(void *hdma)
+{
+    DMA_HandleType * dma = (DMA_HandleType*) hdma;
+    DCMI_HandleType * hdcmi = (DCMI_HandleType*) dma->Owner;
+
+    /* The memory register which the DMA has just switched from receives the next block,
+     * after the last block the frame continues from the start of the buffer */
+    XPD_DMA_SetSwapMemory(dma, hdcmi->Frame.Buffer
+            + (uint32_t)hdcmi->Frame.Next * hdcmi->Frame.BlockLength);
+
+    if (++hdcmi->Frame.Next >= hdcmi->Frame.Blocks)
+    {
+        hdcmi->Frame.Next = 0;
+    }
+}
+
+#ifdef USE_XPD_DMA_ERROR_DETECT
+static void dcmi_dmaErrorRedirect(void *hdma)
+{
+    DCMI_HandleType * hdcmi = (DCMI_HandleType*) ((DMA_HandleType*) hdma)->Owner;
+
+    /* Update error code */
+    hdcmi->Errors |= DCMI_ERROR_DMA;
+
+    XPD_SAFE_CALLBACK(hdcmi->Callbacks.Error, hdcmi);
+}
+#endif
+
+/** @defgroup DCMI_Exported_Functions DCMI Exported Functions
+ * @{ */
+
+/**
+ * @brief Initializes the DCMI peripheral using the setup configuration.
+ * @param hdcmi: pointer to the DCMI handle structure
+ * @param Config: pointer to DCMI setup configuration
+ */
+void XPD_DCMI_Init(DCMI_HandleType * hdcmi, const DCMI_InitType * Config)
+{
+    /* enable clock */
+    XPD_SAFE_CALLBACK(hdcmi->ClockCtrl, ENABLE);
+
+    hdcmi->Inst->CR.w = 0;
+    hdcmi->Inst->CR.b.EDM  = Config->DataWidth;
+    hdcmi->Inst->CR.b.FCRC = Config->FrameRate;
+    hdcmi->Inst->CR.b.JPEG = Config->JPEG;
+    hdcmi->Inst->CR.b.ESS  = Config->EmbeddedSync;
+    hdcmi->Inst->CR.b.PCKPOL = Config->Polarity.PixelClockRising;
+    hdcmi->Inst->CR.b.HSPOL  = Config->Polarity.HSyncHigh;
+    hdcmi->Inst->CR.b.VSPOL  = Config->Polarity.VSyncHigh;
+
+    if (Config->EmbeddedSync != DISABLE)
+    {
+        hdcmi->Inst->ESCR.w = ((uint32_t)Config->SyncCodes.FrameEnd   << DCMI_ESCR_FEC_Pos)
+                            | ((uint32_t)Config->SyncCodes.LineEnd    << DCMI_ESCR_LEC_Pos)
+                            | ((uint32_t)Config->SyncCodes.LineStart  << DCMI_ESCR_LSC_Pos)
+                            | ((uint32_t)Config->SyncCodes.FrameStart << DCMI_ESCR_FSC_Pos);
+
+        /* All bits of the codes are compared */
+        hdcmi->Inst->ESUR.w = ~0;
+    }
+
+    hdcmi->Inst->IER.w = 0;
+    hdcmi->Errors = DCMI_ERROR_NONE;
+
+    /* Dependencies initialization */
+    XPD_SAFE_CALLBACK(hdcmi->Callbacks.DepInit, hdcmi);
+
+    hdcmi->Inst->CR.b.ENABLE = 1;
+}
+
+/**
+ * @brief Restores the DCMI peripheral to its default inactive state.
+ * @param hdcmi: pointer to the DCMI handle structure
+ */
+void XPD_DCMI_Deinit(DCMI_HandleType * hdcmi)
+{
+    XPD_DCMI_Stop_DMA(hdcmi);
+
+    hdcmi->Inst->CR.w = 0;
+
+    /* Deinitialize peripheral dependencies */
+    XPD_SAFE_CALLBACK(hdcmi->Callbacks.DepDeinit, hdcmi);
+
+    /* disable clock */
+    XPD_SAFE_CALLBACK(hdcmi->ClockCtrl, DISABLE);
+}
+
+/**
+ * @brief Sets up the cropping window of the captured frames.
+ *        Only the data within the window is transferred, which reduces the
+ *        frame buffer size and the bus load of the capture.
+ * @note  The frame rate can be reduced by the FrameRate setup parameter.
+ * @param hdcmi: pointer to the DCMI handle structure
+ * @param Window: pointer to the crop window, NULL to capture the whole frame
+ */
+void XPD_DCMI_CropConfig(DCMI_HandleType * hdcmi, const DCMI_WindowType * Window)
+{
+    if (Window != NULL)
+    {
+        hdcmi->Inst->CWSTRTR.w = ((uint32_t)Window->Y << DCMI_CWSTRT_VST_Pos) | Window->X;
+        hdcmi->Inst->CWSIZER.w = (((uint32_t)Window->Height - 1) << DCMI_CWSIZE_VLINE_Pos)
+                               | (Window->Width - 1);
+        hdcmi->Inst->CR.b.CROP = 1;
+    }
+    else
+    {
+        hdcmi->Inst->CR.b.CROP = 0;
+    }
+}
+
+/**
+ * @brief Starts the frame capture to the buffer using the DMA in double buffer mode.
+ *        The frame is divided into equal blocks which fit the DMA transfer counter,
+ *        and the next block is swapped in by the block completion, so any frame size
+ *        is captured without gaps or CPU copying.
+ * @note  The DMA stream has to be initialized in double buffer mode with word peripheral
+ *        data alignment. The Line and VSync callbacks are only enabled if they are set.
+ *        In continuous mode each frame overwrites the buffer after the Frame callback.
+ * @param hdcmi: pointer to the DCMI handle structure
+ * @param Buffer: the frame buffer (word aligned)
+ * @param Length: the frame length in bytes, a multiple of 4
+ * @param Mode: snapshot or continuous capture
+ * @return ERROR if the DMA mode or the frame length isn't suitable, BUSY if the DMA is in use, OK if success
+ */
+XPD_ReturnType XPD_DCMI_Start_DMA(DCMI_HandleType * hdcmi, void * Buffer, uint32_t Length,
+        DCMI_CaptureModeType Mode)
+{
+    DMA_HandleType * hdma = hdcmi->DMA.Capture;
+    XPD_ReturnType result;
+    uint32_t words = Length / sizeof(uint32_t);
+    uint32_t blocks;
+
+    if (DMA_REG_BIT(hdma, CR, DBM) == 0)
+    {
+        return XPD_ERROR;
+    }
+
+    /* The frame is split to the fewest equal blocks which fit the DMA counter */
+    for (blocks = 2; ((words % blocks) != 0) || ((words / blocks) > DCMI_DMA_MAX_BLOCK); blocks++)
+    {
+        if (blocks >= DCMI_MAX_BLOCKS)
+        {
+            return XPD_ERROR;
+        }
+    }
+
+    hdcmi->Frame.Buffer = Buffer;
+    hdcmi->Frame.Length = words;
+    hdcmi->Frame.Blocks = blocks;
+    hdcmi->Frame.BlockLength = words / blocks;
+
+    result = dcmi_dmaStart(hdcmi);
+
+    if (result == XPD_OK)
+    {
+        /* Set the callback owner */
+        hdma->Owner = hdcmi;
+
+        /* Set the DMA transfer callbacks */
+        hdma->Callbacks.Complete     = dcmi_dmaBlockRedirect;
+        hdma->Callbacks.HalfComplete = NULL;
+#ifdef USE_XPD_DMA_ERROR_DETECT
+        hdma->Callbacks.Error        = dcmi_dmaErrorRedirect;
+#endif
+        hdcmi->Errors = DCMI_ERROR_NONE;
+
+        hdcmi->Inst->ICR.w = DCMI_ICR_FRAME_ISC | DCMI_ICR_OVR_ISC | DCMI_ICR_ERR_ISC
+                           | DCMI_ICR_VSYNC_ISC | DCMI_ICR_LINE_ISC;
+        hdcmi->Inst->IER.w = DCMI_IER_FRAME_IE | DCMI_IER_OVR_IE
+                | ((hdcmi->Inst->CR.b.ESS != 0)     ? DCMI_IER_ERR_IE   : 0)
+                | ((hdcmi->Callbacks.Line != NULL)  ? DCMI_IER_LINE_IE  : 0)
+                | ((hdcmi->Callbacks.VSync != NULL) ? DCMI_IER_VSYNC_IE : 0);
+
+        hdcmi->Inst->CR.b.CM = Mode;
+        hdcmi->Inst->CR.b.CAPTURE = 1;
+    }
+    return result;
+}
+
+/**
+ * @brief Stops the frame capture and the DMA transfer.
+ * @param hdcmi: pointer to the DCMI handle structure
+ */
+void XPD_DCMI_Stop_DMA(DCMI_HandleType * hdcmi)
+{
+    hdcmi->Inst->CR.b.CAPTURE = 0;
+    hdcmi->Inst->IER.w = 0;
+
+    if (hdcmi->DMA.Capture != NULL)
+    {
+        XPD_DMA_Stop_IT(hdcmi->DMA.Capture);
+    }
+}
+
+/**
+ * @brief DCMI global interrupt handler that provides the capture callbacks.
+ * @param hdcmi: pointer to the DCMI handle structure
+ */
+void XPD_DCMI_IRQHandler(DCMI_HandleType * hdcmi)
+{
+    XPD_PROFILE_BEGIN();
+    XPD_STATS_IRQ_BEGIN();
+
+    uint32_t misr = hdcmi->Inst->MISR.w;
+
+    /* Vertical synchronization */
+    if ((misr & DCMI_MIS_VSYNC_MIS) != 0)
+    {
+        hdcmi->Inst->ICR.w = DCMI_ICR_VSYNC_ISC;
+
+        XPD_SAFE_CALLBACK(hdcmi->Callbacks.VSync, hdcmi);
+    }
+
+    /* Line captured */
+    if ((misr & DCMI_MIS_LINE_MIS) != 0)
+    {
+        hdcmi->Inst->ICR.w = DCMI_ICR_LINE_ISC;
+
+        XPD_SAFE_CALLBACK(hdcmi->Callbacks.Line, hdcmi);
+    }
+
+    /* Overrun or synchronization error */
+    if ((misr & DCMI_ERRORS) != 0)
+    {
+        hdcmi->Inst->ICR.w = misr & DCMI_ERRORS;
+        hdcmi->Errors |= misr & DCMI_ERRORS;
+
+        XPD_STATS_ERROR(hdcmi, misr & DCMI_ERRORS);
+
+        /* The interface waits for the next frame, the DMA position is realigned to the frame start */
+        (void) XPD_DMA_Stop(hdcmi->DMA.Capture);
+
+        if (hdcmi->Inst->CR.b.CM == DCMI_CAPTURE_CONTINUOUS)
+        {
+            (void) dcmi_dmaStart(hdcmi);
+        }
+        else
+        {
+            hdcmi->Inst->CR.b.CAPTURE = 0;
+        }
+
+        XPD_SAFE_CALLBACK(hdcmi->Callbacks.Error, hdcmi);
+    }
+
+    /* Frame captured */
+    if ((misr & DCMI_MIS_FRAME_MIS) != 0)
+    {
+        hdcmi->Inst->ICR.w = DCMI_ICR_FRAME_ISC;
+
+        /* The snapshot is complete, the capture is stopped by hardware */
+        if (hdcmi->Inst->CR.b.CM == DCMI_CAPTURE_SNAPSHOT)
+        {
+            hdcmi->Inst->IER.w = 0;
+            XPD_DMA_Stop_IT(hdcmi->DMA.Capture);
+        }
+
+        XPD_STATS_ADD(hdcmi, Transfers, 1);
+        XPD_STATS_ADD(hdcmi, Bytes, hdcmi->Frame.Length * sizeof(uint32_t));
+
+        XPD_SAFE_CALLBACK(hdcmi->Callbacks.Frame, hdcmi);
+    }
+
+    XPD_STATS_IRQ_END(hdcmi);
+    XPD_PROFILE_END();
+}
+
+/** @} */
+
+/** @} */
+
+#endif /* USE_XPD_DCMI */
@@ -24,6 +24,7 @@
 #include "xpd_dma.h"
 #include "xpd_rcc.h"
 #include "xpd_utils.h"
+#include "xpd_mem.h"
 
 /** @addtogroup DMA
  * @{ */
@@ -42,6 +43,12 @@ static const XPD_CtrlFnType dma_clkCtrl[] = {
         XPD_DMA2_ClockCtrl
 #endif
 };
+static DMA_TypeDef * const dma_bases[] = {
+        DMA1,
+#ifdef DMA2
+        DMA2
+#endif
+};
 static volatile uint8_t dma_users[] = {
         0,
 #ifdef DMA2
@@ -65,6 +72,46 @@ static void dma_clockCtrl(DMA_HandleType * hdma, FunctionalState ClockState)
     dma_clkCtrl[bo]((dma_users[bo] > 0) ? ENABLE : DISABLE);
 }
 
+#ifdef RCC_AHB1LPENR_DMA1LPEN
+static const XPD_CtrlFnType dma_sleepClkCtrl[] = {
+        XPD_DMA1_SleepClockCtrl,
+#ifdef DMA2
+        XPD_DMA2_SleepClockCtrl
+#endif
+};
+static uint8_t dma_active[] = {
+        0,
+#ifdef DMA2
+        0
+#endif
+};
+
+/* Keeps the DMA clock running in Sleep mode only while any of its transfers are ongoing */
+static void dma_sleepClockCtrl(DMA_HandleType * hdma, FunctionalState ClockState)
+{
+    uint32_t bo = DMA_BASE_OFFSET(hdma->Inst);
+    uint32_t primask = __get_PRIMASK();
+
+    /* the transfers are started and finished from different contexts */
+    __disable_irq();
+
+    if (ClockState == DISABLE)
+    {
+        CLEAR_BIT(dma_active[bo], 1 << DMA_STREAM_NUMBER(hdma->Inst));
+    }
+    else
+    {
+        SET_BIT(dma_active[bo], 1 << DMA_STREAM_NUMBER(hdma->Inst));
+    }
+
+    dma_sleepClkCtrl[bo]((dma_active[bo] > 0) ? ENABLE : DISABLE);
+
+    __set_PRIMASK(primask);
+}
+#else
+#define dma_sleepClockCtrl(HANDLE, STATE)   ((void)0)
+#endif
+
 static void dma_calcBase(DMA_HandleType * hdma)
 {
     uint8_t streamNumber = DMA_STREAM_NUMBER(hdma->Inst);
@@ -73,6 +120,121 @@ static void dma_calcBase(DMA_HandleType * hdma)
     hdma->StreamOffset = ((streamNumber & 2) * 8) + ((streamNumber & 1) * 6);
 }
 
+/* Selects the FIFO and memory burst settings for the memory block, or falls back to direct mode */
+static void dma_tuneFIFO(DMA_HandleType * hdma, void * MemAddress, uint16_t DataCount)
+{
+    DMA_BurstType burst;
+    uint8_t threshold;
+
+    if (XPD_DMA_SelectBurst(hdma->Inst->CR.b.MSIZE, MemAddress,
+            (uint32_t)DataCount << hdma->Inst->CR.b.PSIZE, &burst, &threshold) == XPD_OK)
+    {
+        hdma->Inst->CR.b.MBURST     = burst;
+        hdma->Inst->FCR.b.FTH       = threshold - 1;
+        DMA_REG_BIT(hdma,FCR,DMDIS) = 1;
+    }
+    else
+    {
+        hdma->Inst->CR.b.MBURST     = DMA_BURST_SINGLE;
+        hdma->Inst->FCR.b.FTH       = 0;
+        DMA_REG_BIT(hdma,FCR,DMDIS) = 0;
+    }
+}
+
+/* Loads the next block of a chained transfer, returns 0 when the chain is finished */
+static uint32_t dma_chainReload(DMA_HandleType * hdma)
+{
+    uint32_t reloaded = 0;
+
+    if (hdma->Chain.Count == 0)
+    {
+        /* no chained transfer */
+    }
+    else if (DMA_REG_BIT(hdma,CR,DBM) != 0)
+    {
+        /* double buffer mode: the completed block's register receives the next block,
+         * the chain is cyclic until the transfer is stopped */
+        XPD_DMA_SetSwapMemory(hdma, hdma->Chain.List[hdma->Chain.Index].MemAddress);
+
+        if (++hdma->Chain.Index >= hdma->Chain.Count)
+        {
+            hdma->Chain.Index = 0;
+        }
+    }
+    else if (hdma->Chain.Index < hdma->Chain.Count)
+    {
+        const DMA_DescriptorType * desc = &hdma->Chain.List[hdma->Chain.Index++];
+
+        /* the stream is disabled by hardware at transfer completion,
+         * all stream flags have to be cleared before enabling it again */
+        XPD_DMA_ClearFlag(hdma, HT);
+
+        hdma->Inst->NDTR = desc->DataCount;
+        hdma->Inst->M0AR = (uint32_t)desc->MemAddress;
+        hdma->BlockLength = desc->DataCount;
+        if (hdma->AutoFIFO != 0)
+        {
+            dma_tuneFIFO(hdma, desc->MemAddress, desc->DataCount);
+        }
+
+        XPD_DMA_Enable(hdma);
+
+        reloaded = 1;
+    }
+    return reloaded;
+}
+
+#ifdef USE_XPD_DMA_ERROR_DETECT
+/* Restarts the circular transfer stopped by a transfer error with the remainder of the block,
+ * returns 0 if the error can't be recovered */
+static uint32_t dma_errorRestart(DMA_HandleType * hdma)
+{
+    uint32_t remaining = hdma->Inst->NDTR;
+
+    /* a repeated error before the block is restored is not recovered,
+     * neither are double buffer and memory burst transfers */
+    if ((hdma->ErrorRecovery == DISABLE) || (XPD_DMA_CircularMode(hdma) == 0)
+            || (DMA_REG_BIT(hdma,CR,DBM) != 0) || (hdma->Inst->CR.b.MBURST != 0)
+            || (hdma->RecoveryBase != 0) || (remaining == 0))
+    {
+        return 0;
+    }
+
+    /* the transfer counter counts peripheral data items */
+    hdma->RecoveryBase = hdma->Inst->M0AR;
+    if (DMA_REG_BIT(hdma,CR,MINC) != 0)
+    {
+        hdma->Inst->M0AR += (hdma->BlockLength - remaining) << hdma->Inst->CR.b.PSIZE;
+    }
+
+    /* the remainder is transferred once, then the circular block is restored;
+     * all stream flags have to be cleared before enabling it again */
+    DMA_REG_BIT(hdma,CR,CIRC) = 0;
+    XPD_DMA_ClearFlag(hdma, HT);
+    XPD_DMA_Enable(hdma);
+
+    hdma->Recoveries++;
+    return 1;
+}
+
+/* Restores the circular block after its remainder is transferred */
+static void dma_errorRestore(DMA_HandleType * hdma)
+{
+    if (hdma->RecoveryBase != 0)
+    {
+        /* the stream is disabled by hardware at transfer completion */
+        XPD_DMA_ClearFlag(hdma, HT);
+
+        hdma->Inst->NDTR = hdma->BlockLength;
+        hdma->Inst->M0AR = hdma->RecoveryBase;
+        hdma->RecoveryBase = 0;
+        DMA_REG_BIT(hdma,CR,CIRC) = 1;
+
+        XPD_DMA_Enable(hdma);
+    }
+}
+#endif
+
 /** @defgroup DMA_Exported_Functions DMA Exported Functions
  * @{ */
 
@@ -86,6 +248,7 @@ XPD_ReturnType XPD_DMA_Init(DMA_HandleType * hdma, const DMA_InitType * Config)
 {
     /* enable DMA clock */
     dma_clockCtrl(hdma, ENABLE);
+    dma_sleepClockCtrl(hdma, DISABLE);
 
     DMA_REG_BIT(hdma,CR,CT) = 0;
 
@@ -109,7 +272,7 @@ XPD_ReturnType XPD_DMA_Init(DMA_HandleType * hdma, const DMA_InitType * Config)
         hdma->Inst->CR.b.MBURST = Config->Memory.Burst;
         hdma->Inst->CR.b.PBURST = Config->Peripheral.Burst;
 
-        hdma->Inst->FCR.b.FTH   = Config->FIFO.Threshold;
+        hdma->Inst->FCR.b.FTH   = Config->FIFO.Threshold - 1;
     }
     else
     {
@@ -120,6 +283,12 @@ XPD_ReturnType XPD_DMA_Init(DMA_HandleType * hdma, const DMA_InitType * Config)
     }
     DMA_REG_BIT(hdma,FCR,DMDIS) = Config->FIFO.Mode;
 
+    /* memory to peripheral transfers in direct mode are tuned for each memory block,
+     * the reception streams stay in direct mode, as their consumers derive
+     * the position of the written data from the remaining data count */
+    hdma->AutoFIFO = (Config->FIFO.Mode == DISABLE) && (Config->Memory.Increment == ENABLE)
+            && (Config->Direction == DMA_MEMORY2PERIPH) && (Config->Mode == DMA_MODE_NORMAL);
+
     hdma->Inst->NDTR = 0;
     hdma->Inst->PAR = 0;
 
@@ -158,11 +327,74 @@ XPD_ReturnType XPD_DMA_Deinit(DMA_HandleType * hdma)
     XPD_DMA_ClearFlag(hdma, TE);
 
     /* disable DMA clock */
+    dma_sleepClockCtrl(hdma, DISABLE);
     dma_clockCtrl(hdma, DISABLE);
 
     return XPD_OK;
 }
 
+/**
+ * @brief Assigns a free DMA stream to the peripheral request, and initializes it
+ *        using the setup configuration.
+ * @param hdma: pointer to the DMA stream handle structure, its instance is set by the function
+ * @param Request: the peripheral request which the DMA stream shall serve
+ * @param Config: DMA stream setup configuration, the channel selection is overridden
+ * @return BUSY if all candidate streams are in use, ERROR if the request isn't available
+ *         on the device, OK if success
+ * @note  The stream candidates of the request are tried in order, the reservation is
+ *        tracked together with the handles initialized by @ref XPD_DMA_Init.
+ *        The stream can be released by @ref XPD_DMA_Deinit.
+ */
+XPD_ReturnType XPD_DMA_Allocate(DMA_HandleType * hdma, DMA_RequestType Request, const DMA_InitType * Config)
+{
+    XPD_ReturnType result = XPD_ERROR;
+    const DMA_RequestMapType * map = XPD_DMA_RequestMap[Request];
+    uint32_t i, bo = 0, st = 0;
+
+    XPD_ENTER_CRITICAL(hdma);
+
+    for (i = 0; (i < 2) && (map[i].Stream != 0); i++)
+    {
+        bo = (map[i].Stream >> 3) - 1;
+        st = map[i].Stream & 7;
+
+        if (bo >= sizeof(dma_users) / sizeof(dma_users[0]))
+        {
+            continue;
+        }
+        else if ((dma_users[bo] & (1 << st)) == 0)
+        {
+            /* reserve the stream before leaving the critical section */
+            SET_BIT(dma_users[bo], 1 << st);
+            result = XPD_OK;
+            break;
+        }
+        else
+        {
+            result = XPD_BUSY;
+        }
+    }
+
+    XPD_EXIT_CRITICAL(hdma);
+
+    if (result == XPD_OK)
+    {
+        DMA_InitType config = *Config;
+
+        hdma->Inst = (DMA_Stream_TypeDef*)((uint32_t)dma_bases[bo] + 0x10 + 0x18 * st);
+#ifdef DMA_Stream_BB
+        hdma->Inst_BB = DMA_Stream_BB(hdma->Inst);
+#endif
+
+        /* route the request to the stream */
+        config.Channel = map[i].Select;
+
+        result = XPD_DMA_Init(hdma, &config);
+    }
+
+    return result;
+}
+
 /**
  * @brief Enables the DMA stream.
  * @param hdma: pointer to the DMA stream handle structure
@@ -181,25 +413,26 @@ void XPD_DMA_Disable(DMA_HandleType * hdma)
     DMA_REG_BIT(hdma, CR, EN) = 0;
 }
 
-/**
- * @brief Sets up a DMA transfer and starts it.
- * @param hdma: pointer to the DMA stream handle structure
- * @param PeriphAddress: pointer to the peripheral data register
- * @param MemAddress: pointer to the memory data
- * @param DataCount: the amount of data to be transferred
- * @return BUSY if DMA is in use, OK if success
- */
-XPD_ReturnType XPD_DMA_Start(DMA_HandleType * hdma, void * PeriphAddress, void * MemAddress, uint16_t DataCount)
+/* Sets up the stream registers and enables the stream,
+ * SwapAddress is the double buffer mode's second memory address if not NULL */
+static XPD_ReturnType dma_start(DMA_HandleType * hdma, void * PeriphAddress, void * MemAddress,
+        uint16_t DataCount, void * SwapAddress)
 {
     XPD_ReturnType result = XPD_OK;
 
     /* Enter critical section to ensure single user of DMA */
     XPD_ENTER_CRITICAL(hdma);
 
+    /* The CPU coupled memories can't be accessed */
+    if (!DMA_ADDRESS_ACCESSIBLE(MemAddress) || !DMA_ADDRESS_ACCESSIBLE(PeriphAddress)
+            || ((SwapAddress != NULL) && !DMA_ADDRESS_ACCESSIBLE(SwapAddress)))
+    {
+        result = XPD_ERROR;
+    }
     /* If previous user was a different peripheral, check busy state first */
-    if ((uint32_t)PeriphAddress != hdma->Inst->PAR)
+    else if ((uint32_t)PeriphAddress != hdma->Inst->PAR)
     {
-        result = XPD_DMA_GetStatus(hdma);
+        result = (XPD_DMA_GetStatus(hdma) == 0) ? XPD_OK : XPD_BUSY;
     }
 
     if (result == XPD_OK)
@@ -207,29 +440,59 @@ XPD_ReturnType XPD_DMA_Start(DMA_HandleType * hdma, void * PeriphAddress, void *
         XPD_DMA_Disable(hdma);
 
         /* DMA transfer setup */
+        DMA_REG_BIT(hdma,CR,CT) = 0;
         hdma->Inst->NDTR = DataCount;
         hdma->Inst->PAR  = (uint32_t)PeriphAddress;
         hdma->Inst->M0AR = (uint32_t)MemAddress;
+        if (SwapAddress != NULL)
+        {
+            /* the second buffer has to be set before the stream is enabled */
+            hdma->Inst->M1AR = (uint32_t)SwapAddress;
+        }
+        hdma->BlockLength = DataCount;
+        hdma->Wraps = 0;
+        if (hdma->AutoFIFO != 0)
+        {
+            dma_tuneFIFO(hdma, MemAddress, DataCount);
+        }
+
+        /* no chained transfer by default */
+        hdma->Chain.Count = hdma->Chain.Index = 0;
 
 #ifdef USE_XPD_DMA_ERROR_DETECT
         /* reset error state */
         hdma->Errors = DMA_ERROR_NONE;
+        hdma->RecoveryBase = 0;
 #endif
 
+        dma_sleepClockCtrl(hdma, ENABLE);
         XPD_DMA_Enable(hdma);
     }
-    else
-    {
-        result = XPD_BUSY;
-    }
 
     XPD_EXIT_CRITICAL(hdma);
 
     return result;
 }
 
+/**
+ * @brief Sets up a DMA transfer and starts it.
+ * @param hdma: pointer to the DMA stream handle structure
+ * @param PeriphAddress: pointer to the peripheral data register
+ * @param MemAddress: pointer to the memory data
+ * @param DataCount: the amount of data to be transferred
+ * @return ERROR if the memory isn't accessible by the DMA, BUSY if DMA is in use, OK if success
+ */
+XPD_ReturnType XPD_DMA_Start(DMA_HandleType * hdma, void * PeriphAddress, void * MemAddress, uint16_t DataCount)
+{
+    return dma_start(hdma, PeriphAddress, MemAddress, DataCount, NULL);
+}
+
 /**
  * @brief Sets up a DMA transfer, starts it and produces completion callback using the interrupt stack.
+ * @note  When ErrorRecovery is enabled, FIFO and direct mode errors are tolerated,
+ *        and a circular transfer stopped by a transfer error is restarted from its current position,
+ *        only the Recoveries counter is increased.
+ *        The half transfer event of the restarted block occurs at the half of its remainder.
  * @param hdma: pointer to the DMA stream handle structure
  * @param PeriphAddress: pointer to the peripheral data register
  * @param MemAddress: pointer to the memory data
@@ -254,6 +517,59 @@ XPD_ReturnType XPD_DMA_Start_IT(DMA_HandleType * hdma, void * PeriphAddress, voi
     return result;
 }
 
+/**
+ * @brief Sets up a chained DMA transfer of multiple memory blocks, starts it and
+ *        produces completion callback using the interrupt stack.
+ * @note  In normal mode the stream is reloaded with the next descriptor's block from the
+ *        transfer complete interrupt, and the completion callback is only called
+ *        when the last block is transferred.
+ *        In double buffer mode the blocks are swapped in by hardware without gaps: the chain
+ *        is cyclic until the transfer is stopped, and the completion callback is called
+ *        after each block. In this mode at least two descriptors are required,
+ *        and all blocks must have the same DataCount.
+ *        The descriptor list must remain valid until the chained transfer is completed.
+ * @param hdma: pointer to the DMA stream handle structure
+ * @param PeriphAddress: pointer to the peripheral data register
+ * @param Descriptors: pointer to the array of memory block descriptors
+ * @param Count: the number of descriptors in the array
+ * @return ERROR if the descriptor list is invalid, BUSY if DMA is in use, OK if success
+ */
+XPD_ReturnType XPD_DMA_StartChain_IT(DMA_HandleType * hdma, void * PeriphAddress,
+        const DMA_DescriptorType * Descriptors, uint16_t Count)
+{
+    XPD_ReturnType result = XPD_ERROR;
+    uint32_t dbm = DMA_REG_BIT(hdma,CR,DBM);
+
+    if (Count > dbm)
+    {
+        /* in double buffer mode the second block is set before the stream is enabled */
+        result = dma_start(hdma, PeriphAddress, Descriptors[0].MemAddress, Descriptors[0].DataCount,
+                (dbm != 0) ? Descriptors[1].MemAddress : NULL);
+    }
+
+    if (result == XPD_OK)
+    {
+        /* Save chain context before the completion interrupt is enabled */
+        hdma->Chain.List  = Descriptors;
+        hdma->Chain.Count = Count;
+        hdma->Chain.Index = 1 + dbm;
+        if (hdma->Chain.Index >= Count)
+        {
+            hdma->Chain.Index = 0;
+        }
+
+        /* enable interrupts
+         * half transfer interrupt has to be enabled by user if callback is used */
+#ifdef USE_XPD_DMA_ERROR_DETECT
+        SET_BIT(hdma->Inst->CR.w, DMA_SxCR_TCIE | DMA_SxCR_TEIE | DMA_SxCR_DMEIE);
+        DMA_REG_BIT(hdma,FCR,FEIE) = 1;
+#else
+        XPD_DMA_EnableIT(hdma,TC);
+#endif
+    }
+    return result;
+}
+
 /**
  * @brief Stops a DMA transfer.
  * @param hdma: pointer to the DMA stream handle structure
@@ -267,6 +583,8 @@ XPD_ReturnType XPD_DMA_Stop(DMA_HandleType *hdma)
     /* disable the stream */
     XPD_DMA_Disable(hdma);
 
+    dma_sleepClockCtrl(hdma, DISABLE);
+
     /* wait until stream is effectively disabled */
     result = XPD_WaitForMatch(&hdma->Inst->CR.w, DMA_SxCR_EN, 0, &timeout);
 
@@ -287,6 +605,20 @@ void XPD_DMA_Stop_IT(DMA_HandleType *hdma)
 #ifdef USE_XPD_DMA_ERROR_DETECT
     DMA_REG_BIT(hdma,FCR,FEIE) = 0;
 #endif
+
+    /* abandon the remaining chained blocks */
+    hdma->Chain.Count = 0;
+
+#ifdef USE_XPD_DMA_ERROR_DETECT
+    /* restore the circular mode of an interrupted recovery */
+    if (hdma->RecoveryBase != 0)
+    {
+        DMA_REG_BIT(hdma,CR,CIRC) = 1;
+        hdma->RecoveryBase = 0;
+    }
+#endif
+
+    dma_sleepClockCtrl(hdma, DISABLE);
 }
 
 /**
@@ -299,6 +631,55 @@ uint16_t XPD_DMA_GetStatus(DMA_HandleType * hdma)
     return DMA_REG_BIT(hdma, CR, EN) * hdma->Inst->NDTR;
 }
 
+/**
+ * @brief Gets a consistent snapshot of the circular or chained transfer progress.
+ * @note  The transfer complete interrupt has to be enabled for the block counting,
+ *        a pending transfer complete flag is accounted for in the result.
+ *        In double buffer mode the Buffer is the currently active memory target.
+ * @param hdma: pointer to the DMA stream handle structure
+ * @param Buffer: pointer to set to the currently transferred memory block (can be NULL)
+ * @param Offset: pointer to set to the number of data transfers done in the current block
+ * @return The number of completed blocks since the transfer start
+ */
+uint32_t XPD_DMA_GetPosition(DMA_HandleType * hdma, void ** Buffer, uint16_t * Offset)
+{
+    uint32_t wraps, flag, cr;
+    uint16_t count;
+    void * buffer;
+
+    /* re-read until no transfer completion happened during the sampling */
+    do {
+        wraps  = hdma->Wraps;
+        flag   = XPD_DMA_GetFlag(hdma, TC);
+        cr     = hdma->Inst->CR.w;
+        count  = hdma->Inst->NDTR;
+        buffer = (void*)((&hdma->Inst->M0AR)[(cr & DMA_SxCR_CT) >> DMA_SxCR_CT_Pos]);
+#ifdef USE_XPD_DMA_ERROR_DETECT
+        /* the remainder of the block is transferred after a recovered error */
+        if (hdma->RecoveryBase != 0)
+        {
+            buffer = (void*)hdma->RecoveryBase;
+        }
+#endif
+    } while ((wraps != hdma->Wraps) || (flag != XPD_DMA_GetFlag(hdma, TC))
+          || (cr != hdma->Inst->CR.w));
+
+    /* the transfer completion is not yet processed by the interrupt handler */
+    if (flag != 0)
+    {
+        wraps++;
+    }
+
+    if (Buffer != NULL)
+    {
+        *Buffer = buffer;
+    }
+    /* the transfer counter is reloaded after the last element */
+    *Offset = (count < hdma->BlockLength) ? hdma->BlockLength - count : 0;
+
+    return wraps;
+}
+
 /**
  * @brief Polls the status of the DMA transfer.
  * @param hdma: pointer to the DMA stream handle structure
@@ -326,6 +707,7 @@ XPD_ReturnType XPD_DMA_PollStatus(DMA_HandleType * hdma, DMA_OperationType Opera
         {
             /* Update error code */
             hdma->Errors |= DMA_ERROR_TRANSFER;
+            XPD_STATS_ERROR(hdma, DMA_ERROR_TRANSFER);
 
             /* Clear the transfer error flag */
             XPD_DMA_ClearFlag(hdma, TE);
@@ -336,6 +718,7 @@ XPD_ReturnType XPD_DMA_PollStatus(DMA_HandleType * hdma, DMA_OperationType Opera
         {
             /* Update error code */
             hdma->Errors |= DMA_ERROR_FIFO;
+            XPD_STATS_ERROR(hdma, DMA_ERROR_FIFO);
 
             /* Clear the FIFO error flag */
             XPD_DMA_ClearFlag(hdma, FE);
@@ -346,6 +729,7 @@ XPD_ReturnType XPD_DMA_PollStatus(DMA_HandleType * hdma, DMA_OperationType Opera
         {
             /* Update error code */
             hdma->Errors |= DMA_ERROR_DIRECTM;
+            XPD_STATS_ERROR(hdma, DMA_ERROR_DIRECTM);
 
             /* Clear the Direct Mode error flag */
             XPD_DMA_ClearFlag(hdma, DME);
@@ -359,6 +743,11 @@ XPD_ReturnType XPD_DMA_PollStatus(DMA_HandleType * hdma, DMA_OperationType Opera
             if (Operation == DMA_OPERATION_TRANSFER)
             {
                 XPD_DMA_ClearFlag(hdma, TC);
+
+                if (XPD_DMA_CircularMode(hdma) == 0)
+                {
+                    dma_sleepClockCtrl(hdma, DISABLE);
+                }
             }
             XPD_DMA_ClearFlag(hdma, HT);
         }
@@ -373,11 +762,15 @@ XPD_ReturnType XPD_DMA_PollStatus(DMA_HandleType * hdma, DMA_OperationType Opera
  */
 void XPD_DMA_IRQHandler(DMA_HandleType * hdma)
 {
+    XPD_PROFILE_BEGIN();
+    XPD_STATS_IRQ_BEGIN();
+
     /* Half Transfer Complete interrupt management */
     if ((DMA_REG_BIT(hdma,CR,HTIE) != 0) && (XPD_DMA_GetFlag(hdma, HT) != 0))
     {
         /* clear the half transfer complete flag */
         XPD_DMA_ClearFlag(hdma, HT);
+        XPD_TRACE(XPD_TRACE_DMA_HALF, (uint32_t)hdma->Inst);
 
         /* half transfer callback */
         XPD_SAFE_CALLBACK(hdma->Callbacks.HalfComplete, hdma);
@@ -388,52 +781,129 @@ void XPD_DMA_IRQHandler(DMA_HandleType * hdma)
     {
         /* clear the transfer complete flag */
         XPD_DMA_ClearFlag(hdma, TC);
+        hdma->Wraps++;
+        XPD_STATS_ADD(hdma, Bytes, (uint32_t)hdma->BlockLength << hdma->Inst->CR.b.PSIZE);
 
-        /* DMA mode is not CIRCULAR */
-        if (XPD_DMA_CircularMode(hdma) == 0)
+        /* continue chained transfer with the next block */
+        if (dma_chainReload(hdma) == 0)
         {
-            CLEAR_BIT(hdma->Inst->CR.w, DMA_SxCR_TCIE | DMA_SxCR_HTIE | DMA_SxCR_TEIE | DMA_SxCR_DMEIE);
 #ifdef USE_XPD_DMA_ERROR_DETECT
-            DMA_REG_BIT(hdma,FCR,FEIE) = 0;
+            /* the remainder of a recovered circular block is completed */
+            dma_errorRestore(hdma);
 #endif
-        }
+            /* DMA mode is not CIRCULAR */
+            if (XPD_DMA_CircularMode(hdma) == 0)
+            {
+                dma_sleepClockCtrl(hdma, DISABLE);
+                CLEAR_BIT(hdma->Inst->CR.w, DMA_SxCR_TCIE | DMA_SxCR_HTIE | DMA_SxCR_TEIE | DMA_SxCR_DMEIE);
+#ifdef USE_XPD_DMA_ERROR_DETECT
+                DMA_REG_BIT(hdma,FCR,FEIE) = 0;
+#endif
+            }
 
-        /* transfer complete callback */
-        XPD_SAFE_CALLBACK(hdma->Callbacks.Complete, hdma);
+            /* transfer complete callback */
+            XPD_TRACE(XPD_TRACE_DMA_COMPLETE, (uint32_t)hdma->Inst);
+            XPD_STATS_ADD(hdma, Transfers, 1);
+            XPD_SAFE_CALLBACK(hdma->Callbacks.Complete, hdma);
+        }
     }
 
 #ifdef USE_XPD_DMA_ERROR_DETECT
-    /* Transfer Error interrupt management */
-    if (XPD_DMA_GetFlag(hdma, TE) != 0)
-    {
-        /* clear the transfer error flag */
-        XPD_DMA_ClearFlag(hdma, TE);
-
-        hdma->Errors |= DMA_ERROR_TRANSFER;
-    }
     /* FIFO Error interrupt management */
     if (XPD_DMA_GetFlag(hdma, FE) != 0)
     {
         /* clear the FIFO error flag */
         XPD_DMA_ClearFlag(hdma, FE);
+        XPD_STATS_ERROR(hdma, DMA_ERROR_FIFO);
 
-        hdma->Errors |= DMA_ERROR_FIFO;
+        /* the stream is not stopped, the error is tolerated if enabled */
+        if (hdma->ErrorRecovery != DISABLE)
+        {
+            hdma->Recoveries++;
+        }
+        else
+        {
+            hdma->Errors |= DMA_ERROR_FIFO;
+        }
     }
     /* Direct Mode Error interrupt management */
     if (XPD_DMA_GetFlag(hdma, DME) != 0)
     {
         /* clear the direct mode error flag */
         XPD_DMA_ClearFlag(hdma, DME);
+        XPD_STATS_ERROR(hdma, DMA_ERROR_DIRECTM);
 
-        hdma->Errors |= DMA_ERROR_DIRECTM;
+        if (hdma->ErrorRecovery != DISABLE)
+        {
+            hdma->Recoveries++;
+        }
+        else
+        {
+            hdma->Errors |= DMA_ERROR_DIRECTM;
+        }
+    }
+    /* Transfer Error interrupt management */
+    if (XPD_DMA_GetFlag(hdma, TE) != 0)
+    {
+        /* clear the transfer error flag */
+        XPD_DMA_ClearFlag(hdma, TE);
+        XPD_STATS_ERROR(hdma, DMA_ERROR_TRANSFER);
+
+        /* the transfer is stopped by hardware,
+         * a circular transfer is continued from the current position if enabled */
+        if (dma_errorRestart(hdma) == 0)
+        {
+            dma_sleepClockCtrl(hdma, DISABLE);
+
+            hdma->Errors |= DMA_ERROR_TRANSFER;
+        }
     }
 
     if (hdma->Errors != 0)
     {
+        XPD_TRACE(XPD_TRACE_DMA_ERROR, (uint32_t)hdma->Inst);
+
         /* transfer errors callback */
         XPD_SAFE_CALLBACK(hdma->Callbacks.Error, hdma);
     }
 #endif
+
+    XPD_STATS_IRQ_END(hdma);
+    XPD_PROFILE_END();
+}
+
+/**
+ * @brief Selects the longest memory burst and the matching FIFO threshold for a memory block.
+ * @param DataAlignment: the memory side data size
+ * @param MemAddress: the start address of the memory block
+ * @param Size: the size of the memory block in bytes
+ * @param Burst: pointer to the memory burst output
+ * @param Threshold: pointer to the FIFO threshold output in quarters [1 .. 4]
+ * @return ERROR if the block doesn't allow bursts, OK if the outputs are set
+ * @note  The burst length is limited by the 16 byte FIFO, and the memory block has to be
+ *        aligned to the burst size, which also ensures that no burst crosses the 1 kB
+ *        address boundary. The selected threshold is always the smallest legal one.
+ */
+XPD_ReturnType XPD_DMA_SelectBurst(DMA_AlignmentType DataAlignment, void * MemAddress, uint32_t Size,
+        DMA_BurstType * Burst, uint8_t * Threshold)
+{
+    XPD_ReturnType result = XPD_ERROR;
+    uint32_t burst, bytes;
+
+    for (burst = DMA_BURST_INC16; burst > DMA_BURST_SINGLE; burst--)
+    {
+        /* INC4, INC8, INC16 beats of the data size */
+        bytes = (2 << burst) << DataAlignment;
+
+        if ((bytes <= 16) && ((((uint32_t)MemAddress | Size) & (bytes - 1)) == 0))
+        {
+            *Burst     = burst;
+            *Threshold = bytes / 4;
+            result     = XPD_OK;
+            break;
+        }
+    }
+    return result;
 }
 
 /**
@@ -459,4 +929,389 @@ void XPD_DMA_SetSwapMemory(DMA_HandleType * hdma, void * Address)
 
 /** @} */
 
+/** @addtogroup DMA_Memory
+ * @{ */
+
+/* Performs a small memory operation with the CPU */
+static void dma_memCpuRun(DMA_MemJobType * job)
+{
+    uint32_t i;
+
+    if (job->DestIncrement != DISABLE)
+    {
+        if (job->Src == NULL)
+        {
+            XPD_MemSet(job->Dest, (uint8_t)job->Pattern, job->Size);
+        }
+        else
+        {
+            XPD_MemCopy(job->Dest, job->Src, job->Size);
+        }
+    }
+    /* A fixed destination register is fed by single accesses */
+    else if (job->Src == NULL)
+    {
+        volatile uint8_t * dest = job->Dest;
+
+        for (i = 0; i < job->Size; i++)
+        {
+            *dest = (uint8_t)job->Pattern;
+        }
+    }
+    else if ((((uint32_t)job->Dest | (uint32_t)job->Src | job->Size) & 3) == 0)
+    {
+        volatile uint32_t * dw = (volatile uint32_t*)job->Dest;
+        const uint32_t * sw = (const uint32_t*)job->Src;
+
+        for (i = 0; i < (job->Size / 4); i++)
+        {
+            *dw = sw[i];
+        }
+    }
+    else
+    {
+        volatile uint8_t * dest = job->Dest;
+
+        for (i = 0; i < job->Size; i++)
+        {
+            *dest = job->Src[i];
+        }
+    }
+    job->Size = 0;
+}
+
+/* Starts the transfer of the next block of the current job */
+static void dma_memStart(DMA_MemEngineType * hmem)
+{
+    DMA_HandleType * hdma = hmem->DMA;
+    DMA_MemJobType * job = hmem->Head;
+    uint32_t addr = (uint32_t)job->Dest | job->Size;
+    uint32_t align, count, burst;
+
+    if (job->Src != NULL)
+    {
+        addr |= (uint32_t)job->Src;
+    }
+
+    /* use the widest data size which all addresses and the size are aligned to */
+    align = ((addr & 3) == 0) ? DMA_ALIGN_WORD : (((addr & 1) == 0) ? DMA_ALIGN_HALFWORD : DMA_ALIGN_BYTE);
+    count = job->Size >> align;
+    if (count > 0xFFFC)
+    {
+        count = 0xFFFC;
+    }
+
+    /* 4 word bursts fill the FIFO entirely, and cannot cross the 1 kB
+     * address boundary when the addresses are aligned to 16 bytes */
+    burst = ((addr & 0xF) == 0) ? DMA_BURST_INC4 : DMA_BURST_SINGLE;
+
+    /* the stream configuration is only writable when the stream is disabled */
+    XPD_DMA_Disable(hdma);
+
+    DMA_REG_BIT(hdma,CR,PINC)   = (job->Src != NULL) ? 1 : 0;
+    DMA_REG_BIT(hdma,CR,MINC)   = job->DestIncrement;
+    hdma->Inst->CR.b.PSIZE      = align;
+    hdma->Inst->CR.b.MSIZE      = align;
+    hdma->Inst->CR.b.PBURST     = burst;
+    hdma->Inst->CR.b.MBURST     = (job->DestIncrement != DISABLE) ? burst : DMA_BURST_SINGLE;
+
+    (void) XPD_DMA_Start_IT(hdma, (job->Src != NULL) ? (void*)job->Src : &job->Pattern,
+            job->Dest, count);
+
+    /* advance the job to the next block */
+    count <<= align;
+    if (job->DestIncrement != DISABLE)
+    {
+        job->Dest += count;
+    }
+    if (job->Src != NULL)
+    {
+        job->Src += count;
+    }
+    job->Size -= count;
+}
+
+/* Removes the current job from the queue, and starts the next one */
+static void dma_memFinish(DMA_MemEngineType * hmem, XPD_ReturnType Status)
+{
+    DMA_MemJobType * job = hmem->Head;
+
+    hmem->Head = job->Next;
+    if (hmem->Head != NULL)
+    {
+        dma_memStart(hmem);
+    }
+
+    /* the job can be reused from the callback */
+    job->Status = Status;
+    XPD_SAFE_CALLBACK(job->Callback, job);
+}
+
+/* DMA transfer complete callback */
+static void dma_memComplete(void * handle)
+{
+    DMA_MemEngineType * hmem = ((DMA_HandleType*)handle)->Owner;
+
+    if (hmem->Head->Size > 0)
+    {
+        dma_memStart(hmem);
+    }
+    else
+    {
+        dma_memFinish(hmem, XPD_OK);
+    }
+}
+
+#ifdef USE_XPD_DMA_ERROR_DETECT
+/* DMA transfer error callback */
+static void dma_memError(void * handle)
+{
+    DMA_MemEngineType * hmem = ((DMA_HandleType*)handle)->Owner;
+
+    dma_memFinish(hmem, XPD_ERROR);
+}
+#endif
+
+/* Queues the job, and starts it if the engine is idle */
+static XPD_ReturnType dma_memSubmit(DMA_MemEngineType * hmem, DMA_MemJobType * job)
+{
+    uint32_t idle;
+
+    job->Next   = NULL;
+    job->Status = XPD_BUSY;
+
+    /* small operations are performed immediately, unless they would overtake queued jobs */
+    if ((job->Size <= hmem->Threshold) && (hmem->Head == NULL))
+    {
+        dma_memCpuRun(job);
+
+        job->Status = XPD_OK;
+        XPD_SAFE_CALLBACK(job->Callback, job);
+    }
+    else
+    {
+        XPD_ENTER_CRITICAL(hmem->DMA);
+
+        idle = hmem->Head == NULL;
+        if (idle)
+        {
+            hmem->Head = job;
+        }
+        else
+        {
+            hmem->Tail->Next = job;
+        }
+        hmem->Tail = job;
+
+        XPD_EXIT_CRITICAL(hmem->DMA);
+
+        if (idle)
+        {
+            dma_memStart(hmem);
+        }
+    }
+    return XPD_OK;
+}
+
+/** @defgroup DMA_Memory_Exported_Functions DMA Memory Operations Exported Functions
+ * @{ */
+
+/**
+ * @brief Initializes the DMA stream of the memory operation engine for memory-to-memory transfers.
+ * @param hmem: pointer to the memory operation engine structure
+ * @return Result of @ref XPD_DMA_Init
+ * @note  The DMA handle's instance has to be set, and its interrupt has to be served
+ *        by @ref XPD_DMA_IRQHandler.
+ *        Only the DMA2 streams are capable of memory-to-memory transfers.
+ */
+XPD_ReturnType XPD_DMA_MemInit(DMA_MemEngineType * hmem)
+{
+    DMA_InitType config = {
+        .Direction = DMA_MEMORY2MEMORY,
+        .Mode      = DMA_MODE_NORMAL,
+        .Priority  = LOW,
+        .Memory    = { .Increment = ENABLE, .DataAlignment = DMA_ALIGN_BYTE },
+        .Peripheral= { .Increment = ENABLE, .DataAlignment = DMA_ALIGN_BYTE },
+        .FIFO      = { .Mode = ENABLE, .Threshold = 4 },
+    };
+
+    hmem->Head = hmem->Tail = NULL;
+
+    hmem->DMA->Owner = hmem;
+    hmem->DMA->Callbacks.Complete = dma_memComplete;
+#ifdef USE_XPD_DMA_ERROR_DETECT
+    hmem->DMA->Callbacks.Error    = dma_memError;
+#endif
+
+    return XPD_DMA_Init(hmem->DMA, &config);
+}
+
+/**
+ * @brief Copies a memory block in the background, the transfer data size is selected
+ *        according to the common alignment of the addresses and the size.
+ * @param hmem: pointer to the memory operation engine structure
+ * @param Job: pointer to the job structure, which has to remain valid until completion
+ * @param Dest: the destination address
+ * @param Src: the source address
+ * @param Size: the number of bytes to copy
+ * @return OK (the job's Status and Callback indicate completion)
+ * @note  Blocks up to the engine's Threshold size are copied by the CPU from this call.
+ */
+XPD_ReturnType XPD_DMA_MemCpy_IT(DMA_MemEngineType * hmem, DMA_MemJobType * Job,
+        void * Dest, const void * Src, uint32_t Size)
+{
+    Job->Dest    = Dest;
+    Job->Src     = Src;
+    Job->Size    = Size;
+    Job->DestIncrement = ENABLE;
+
+    return dma_memSubmit(hmem, Job);
+}
+
+/**
+ * @brief Fills a memory block with a byte value in the background.
+ * @param hmem: pointer to the memory operation engine structure
+ * @param Job: pointer to the job structure, which has to remain valid until completion
+ * @param Dest: the destination address
+ * @param Value: the fill value
+ * @param Size: the number of bytes to fill
+ * @return OK (the job's Status and Callback indicate completion)
+ * @note  Blocks up to the engine's Threshold size are filled by the CPU from this call.
+ */
+XPD_ReturnType XPD_DMA_MemSet_IT(DMA_MemEngineType * hmem, DMA_MemJobType * Job,
+        void * Dest, uint8_t Value, uint32_t Size)
+{
+    Job->Dest    = Dest;
+    Job->Src     = NULL;
+    Job->Size    = Size;
+    Job->Pattern = Value * 0x01010101;
+    Job->DestIncrement = ENABLE;
+
+    return dma_memSubmit(hmem, Job);
+}
+
+/**
+ * @brief Writes a memory block to a single data register in the background,
+ *        e.g. to feed a peripheral which doesn't generate DMA requests.
+ * @param hmem: pointer to the memory operation engine structure
+ * @param Job: pointer to the job structure, which has to remain valid until completion
+ * @param Register: the address of the destination register
+ * @param Src: the source address
+ * @param Size: the number of bytes to write
+ * @return OK (the job's Status and Callback indicate completion)
+ * @note  The register access width is selected the same way as for @ref XPD_DMA_MemCpy_IT,
+ *        Blocks up to the engine's Threshold size are written by the CPU from this call.
+ */
+XPD_ReturnType XPD_DMA_MemFeed_IT(DMA_MemEngineType * hmem, DMA_MemJobType * Job,
+        volatile void * Register, const void * Src, uint32_t Size)
+{
+    Job->Dest    = (uint8_t*)Register;
+    Job->Src     = Src;
+    Job->Size    = Size;
+    Job->DestIncrement = DISABLE;
+
+    return dma_memSubmit(hmem, Job);
+}
+
+/** @} */
+
+/** @} */
+
+/** @addtogroup DMA_Bridge
+ * @{ */
+
+/* Starts the destination side of the ring bridge when the ring is half filled */
+static void dma_bridgeHalfRedirect(void * handle)
+{
+    DMA_BridgeType * hbr = ((DMA_HandleType*)handle)->Owner;
+
+    XPD_DMA_DisableIT(hbr->Source, HT);
+
+    (void) XPD_DMA_Start(hbr->Destination, (void *)hbr->DestRegister, hbr->Ring, hbr->Length);
+}
+
+/** @addtogroup DMA_Bridge_Exported_Functions
+ * @{ */
+
+/**
+ * @brief Starts the continuous forwarding of the source peripheral data to the destination peripheral.
+ *        The DMA streams are set to circular mode.
+ * @note  In ring mode the DMA interrupt of the source stream has to be enabled in the NVIC,
+ *        as it starts the destination stream once. The ring has the data width of the source
+ *        stream's memory side.
+ * @param hbr: pointer to the DMA bridge structure
+ * @param SrcRegister: pointer to the source peripheral data register
+ * @param DestRegister: pointer to the destination peripheral data register
+ * @param Ring: the RAM ring in ring mode, not used in direct mode
+ * @param Length: the number of elements in the ring (at least 2), not used in direct mode
+ * @return ERROR if the ring is invalid, BUSY if a DMA stream is in use, OK if successful
+ */
+XPD_ReturnType XPD_DMA_Bridge_Start(DMA_BridgeType * hbr, volatile void * SrcRegister,
+        volatile void * DestRegister, void * Ring, uint16_t Length)
+{
+    XPD_ReturnType result;
+    DMA_HandleType * hsrc = hbr->Source;
+
+    XPD_DMA_CircularMode(hsrc) = 1;
+
+    if (hbr->Destination == NULL)
+    {
+        /* The destination register is addressed by the memory side */
+        DMA_REG_BIT(hsrc,CR,MINC) = 0;
+
+        result = XPD_DMA_Start(hsrc, (void *)SrcRegister, (void *)DestRegister, 0xFFFF);
+    }
+    else if ((Ring == NULL) || (Length < 2))
+    {
+        result = XPD_ERROR;
+    }
+    else if (XPD_DMA_GetStatus(hbr->Destination) != 0)
+    {
+        result = XPD_BUSY;
+    }
+    else
+    {
+        hbr->DestRegister = DestRegister;
+        hbr->Ring         = Ring;
+        hbr->Length       = Length;
+
+        DMA_REG_BIT(hsrc,CR,MINC) = 1;
+        DMA_REG_BIT(hbr->Destination,CR,MINC) = 1;
+        XPD_DMA_CircularMode(hbr->Destination) = 1;
+
+        /* Set the callback owner */
+        hsrc->Owner = hbr;
+
+        /* The destination is started by the half transfer interrupt */
+        hsrc->Callbacks.HalfComplete = dma_bridgeHalfRedirect;
+        hsrc->Callbacks.Complete     = NULL;
+
+        result = XPD_DMA_Start(hsrc, (void *)SrcRegister, Ring, Length);
+
+        if (result == XPD_OK)
+        {
+            XPD_DMA_EnableIT(hsrc, HT);
+        }
+    }
+    return result;
+}
+
+/**
+ * @brief Stops the forwarding of the peripheral bridge.
+ * @param hbr: pointer to the DMA bridge structure
+ */
+void XPD_DMA_Bridge_Stop(DMA_BridgeType * hbr)
+{
+    XPD_DMA_Stop_IT(hbr->Source);
+
+    if (hbr->Destination != NULL)
+    {
+        XPD_DMA_Stop_IT(hbr->Destination);
+    }
+}
+
+/** @} */
+
+/** @} */
+
 /** @} */
@@ -0,0 +1,218 @@
+/**
+  ******************************************************************************
+  * @file    xpd_dma2d.c
+  * @author  Benedek Kupper
+  * @version V0.1
+  * @date    2018-01-20
+  * @brief   STM32 eXtensible Peripheral Drivers DMA2D Module
+  *
+  *  This file is part of STM32_XPD.
+  *
+  *  STM32_XPD is free software: you can redistribute it and/or modify
+  *  it under the terms of the GNU General Public License as published by
+  *  the Free Software Foundation, either version 3 of the License, or
+  *  (at your option) any later version.
+  *
+  *  STM32_XPD is distributed in the hope that it will be useful,
+  *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with STM32_XPD.  If not, see <http://www.gnu.org/licenses/>.
+  */
+#include "xpd_dma2d.h"
+#include "xpd_utils.h"
+
+#if defined(USE_XPD_DMA2D) && defined(DMA2D)
+
+/** @addtogroup DMA2D
+ * @{ */
+
+#define DMA2D_INTERRUPTS        (DMA2D_CR_TCIE | DMA2D_CR_TEIE | DMA2D_CR_CEIE)
+
+#define DMA2D_FLAGS             (DMA2D_IFCR_CTCIF | DMA2D_IFCR_CTEIF | DMA2D_IFCR_CCEIF)
+
+/* Pixel format conversion control register value of an input layer */
+static uint32_t dma2d_layerControl(const DMA2D_LayerType * Layer)
+{
+    return ((uint32_t)Layer->Format << DMA2D_FGPFCCR_CM_Pos)
+         | ((uint32_t)Layer->AlphaMode << DMA2D_FGPFCCR_AM_Pos)
+         | ((uint32_t)Layer->Alpha << DMA2D_FGPFCCR_ALPHA_Pos);
+}
+
+/* Programs the job's layers and starts its transfer */
+static void dma2d_start(DMA2D_HandleType * hdma2d, const DMA2D_JobType * Job)
+{
+    hdma2d->Inst->OMAR  = (uint32_t)Job->Output.Address;
+    hdma2d->Inst->OOR   = Job->Output.LineOffset;
+    hdma2d->Inst->OPFCCR.w = Job->Output.Format;
+    hdma2d->Inst->NLR.w = ((uint32_t)Job->Width << DMA2D_NLR_PL_Pos) | Job->Height;
+
+    if (Job->Operation == DMA2D_OPERATION_FILL)
+    {
+        hdma2d->Inst->OCOLR = Job->FillColor;
+    }
+    else
+    {
+        hdma2d->Inst->FGMAR     = (uint32_t)Job->Foreground.Address;
+        hdma2d->Inst->FGOR      = Job->Foreground.LineOffset;
+        hdma2d->Inst->FGPFCCR.w = dma2d_layerControl(&Job->Foreground);
+        hdma2d->Inst->FGCOLR.w  = Job->Foreground.Color;
+
+        if (Job->Operation == DMA2D_OPERATION_BLEND)
+        {
+            hdma2d->Inst->BGMAR     = (uint32_t)Job->Background.Address;
+            hdma2d->Inst->BGOR      = Job->Background.LineOffset;
+            hdma2d->Inst->BGPFCCR.w = dma2d_layerControl(&Job->Background);
+            hdma2d->Inst->BGCOLR.w  = Job->Background.Color;
+        }
+    }
+
+    hdma2d->Inst->CR.w = ((uint32_t)Job->Operation << DMA2D_CR_MODE_Pos)
+                       | DMA2D_INTERRUPTS | DMA2D_CR_START;
+}
+
+/** @defgroup DMA2D_Exported_Functions DMA2D Exported Functions
+ * @{ */
+
+/**
+ * @brief Initializes the DMA2D peripheral with an empty job queue.
+ * @param hdma2d: pointer to the DMA2D handle structure
+ * @param Queue: the job pointer array of the queue
+ * @param Size: the number of jobs the queue can hold
+ */
+void XPD_DMA2D_Init(DMA2D_HandleType * hdma2d, DMA2D_JobType ** Queue, uint8_t Size)
+{
+    /* enable clock */
+    XPD_SAFE_CALLBACK(hdma2d->ClockCtrl, ENABLE);
+
+    hdma2d->Inst->CR.w = 0;
+    hdma2d->Inst->IFCR.w = DMA2D_FLAGS;
+
+    hdma2d->Queue.Buffer = Queue;
+    hdma2d->Queue.Size   = Size;
+    hdma2d->Queue.Head   = 0;
+    hdma2d->Queue.Count  = 0;
+
+    /* Dependencies initialization */
+    XPD_SAFE_CALLBACK(hdma2d->Callbacks.DepInit, hdma2d);
+}
+
+/**
+ * @brief Aborts the ongoing transfer and restores the DMA2D peripheral to its reset state.
+ * @note  The queued jobs are not completed.
+ * @param hdma2d: pointer to the DMA2D handle structure
+ */
+void XPD_DMA2D_Deinit(DMA2D_HandleType * hdma2d)
+{
+    if ((hdma2d->Inst->CR.w & DMA2D_CR_START) != 0)
+    {
+        hdma2d->Inst->CR.w |= DMA2D_CR_ABORT;
+    }
+    hdma2d->Inst->CR.w = 0;
+    hdma2d->Queue.Count = 0;
+
+    /* Deinitialize peripheral dependencies */
+    XPD_SAFE_CALLBACK(hdma2d->Callbacks.DepDeinit, hdma2d);
+
+    /* disable clock */
+    XPD_SAFE_CALLBACK(hdma2d->ClockCtrl, DISABLE);
+}
+
+/**
+ * @brief Queues a drawing job, which is started immediately if the peripheral is idle.
+ *        The jobs are executed in submission order, the next job is started
+ *        from the interrupt handler when the previous one completes.
+ * @note  The job structure has to remain valid until it is completed.
+ * @param hdma2d: pointer to the DMA2D handle structure
+ * @param Job: the drawing job
+ * @return BUSY if the queue is full, OK if the job is queued
+ */
+XPD_ReturnType XPD_DMA2D_Submit(DMA2D_HandleType * hdma2d, DMA2D_JobType * Job)
+{
+    XPD_ReturnType result = XPD_BUSY;
+
+    XPD_ENTER_CRITICAL(hdma2d);
+
+    if (hdma2d->Queue.Count < hdma2d->Queue.Size)
+    {
+        uint8_t index = hdma2d->Queue.Head + hdma2d->Queue.Count;
+
+        if (index >= hdma2d->Queue.Size)
+        {
+            index -= hdma2d->Queue.Size;
+        }
+        Job->Result = XPD_BUSY;
+        hdma2d->Queue.Buffer[index] = Job;
+
+        XPD_STATS_MAX(hdma2d, QueueHighWater, hdma2d->Queue.Count + 1);
+
+        if (hdma2d->Queue.Count++ == 0)
+        {
+            dma2d_start(hdma2d, Job);
+        }
+        result = XPD_OK;
+    }
+
+    XPD_EXIT_CRITICAL(hdma2d);
+
+    return result;
+}
+
+/**
+ * @brief DMA2D global interrupt handler that completes the ongoing job
+ *        and starts the next queued one.
+ * @param hdma2d: pointer to the DMA2D handle structure
+ */
+void XPD_DMA2D_IRQHandler(DMA2D_HandleType * hdma2d)
+{
+    XPD_PROFILE_BEGIN();
+    XPD_STATS_IRQ_BEGIN();
+
+    uint32_t isr = hdma2d->Inst->ISR.w;
+
+    if (((isr & DMA2D_FLAGS) != 0) && (hdma2d->Queue.Count > 0))
+    {
+        DMA2D_JobType * job = hdma2d->Queue.Buffer[hdma2d->Queue.Head];
+
+        hdma2d->Inst->IFCR.w = DMA2D_FLAGS;
+
+        if (++hdma2d->Queue.Head == hdma2d->Queue.Size)
+        {
+            hdma2d->Queue.Head = 0;
+        }
+        hdma2d->Queue.Count--;
+
+        /* Keep the engine busy before notifying the application */
+        if (hdma2d->Queue.Count > 0)
+        {
+            dma2d_start(hdma2d, hdma2d->Queue.Buffer[hdma2d->Queue.Head]);
+        }
+
+        if ((isr & (DMA2D_ISR_TEIF | DMA2D_ISR_CEIF)) != 0)
+        {
+            job->Result = XPD_ERROR;
+        }
+        else
+        {
+            job->Result = XPD_OK;
+            XPD_STATS_ADD(hdma2d, Transfers, 1);
+        }
+
+        XPD_SAFE_CALLBACK(job->Complete, job);
+    }
+    else
+    {
+        hdma2d->Inst->IFCR.w = isr;
+    }
+
+    XPD_STATS_IRQ_END(hdma2d);
+    XPD_PROFILE_END();
+}
+
+/** @} */
+
+/** @} */
+
+#endif /* USE_XPD_DMA2D */
@@ -0,0 +1,848 @@
+/**
+  ******************************************************************************
+  * @file    xpd_eth.c
+  * @author  Benedek Kupper
+  * @version V0.1
+  * @date    2018-01-20
+  * @brief   STM32 eXtensible Peripheral Drivers Ethernet MAC Module
+  *
+  *  This file is part of STM32_XPD.
+  *
+  *  STM32_XPD is free software: you can redistribute it and/or modify
+  *  it under the terms of the GNU General Public License as published by
+  *  the Free Software Foundation, either version 3 of the License, or
+  *  (at your option) any later version.
+  *
+  *  STM32_XPD is distributed in the hope that it will be useful,
+  *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with STM32_XPD.  If not, see <http://www.gnu.org/licenses/>.
+  */
+#include "xpd_eth.h"
+#include "xpd_rcc.h"
+#include "xpd_utils.h"
+
+#if defined(USE_XPD_ETH) && defined(ETH)
+
+/** @addtogroup ETH
+ * @{ */
+
+/* Timeouts in ms */
+#define ETH_RESET_TIMEOUT       10
+#define ETH_MDIO_TIMEOUT        2
+
+/* Transmit descriptor bits */
+#define ETH_TDES0_OWN           0x80000000
+#define ETH_TDES0_IC            0x40000000
+#define ETH_TDES0_LS            0x20000000
+#define ETH_TDES0_FS            0x10000000
+#define ETH_TDES0_TTSE          0x02000000
+#define ETH_TDES0_CIC_FULL      0x00C00000
+#define ETH_TDES0_TCH           0x00100000
+#define ETH_TDES0_TTSS          0x00020000
+#define ETH_TDES0_ES            0x00008000
+#define ETH_TDES1_TBS1          0x00001FFF
+
+/* Receive descriptor bits */
+#define ETH_RDES0_OWN           0x80000000
+#define ETH_RDES0_FL_Pos        16
+#define ETH_RDES0_FL            0x3FFF0000
+#define ETH_RDES0_ES            0x00008000
+#define ETH_RDES0_FS            0x00000200
+#define ETH_RDES0_LS            0x00000100
+#define ETH_RDES0_TSV           0x00000080
+#define ETH_RDES1_DIC           0x80000000
+#define ETH_RDES1_RCH           0x00004000
+
+#define ETH_FCS_SIZE            4
+
+#define ETH_NS_PER_SECOND       1000000000
+
+/* The frame snapshot and rollover selection bits are in the PTP control register,
+ * the device header names them after the status register */
+#define ETH_PTPTSCR_TSSARFE     ETH_PTPTSSR_TSSARFE
+#define ETH_PTPTSCR_TSSSR       ETH_PTPTSSR_TSSSR
+#define ETH_PTPTSCR_UPDATES     (ETH_PTPTSCR_TSSTI | ETH_PTPTSCR_TSSTU | ETH_PTPTSCR_TSARU)
+
+/* MDC clock range selection: HCLK divided by 16, 26, 42, 62 or 102 */
+static uint32_t eth_mdcClockRange(void)
+{
+    uint32_t hclk = XPD_RCC_GetClockFreq(HCLK);
+
+    if (hclk < 35000000)
+    {
+        return ETH_MACMIIAR_CR_Div16;
+    }
+    else if (hclk < 60000000)
+    {
+        return ETH_MACMIIAR_CR_Div26;
+    }
+    else if (hclk < 100000000)
+    {
+        return ETH_MACMIIAR_CR_Div42;
+    }
+    else if (hclk < 150000000)
+    {
+        return ETH_MACMIIAR_CR_Div62;
+    }
+    else
+    {
+        return ETH_MACMIIAR_CR_Div102;
+    }
+}
+
+/* Performs an MDIO register access and waits for its completion */
+static XPD_ReturnType eth_mdioAccess(ETH_HandleType * heth, uint8_t PhyAddress,
+        uint8_t Register, uint32_t Write)
+{
+    uint32_t timeout = ETH_MDIO_TIMEOUT;
+
+    if ((heth->Inst->MACMIIAR.w & ETH_MACMIIAR_MB) != 0)
+    {
+        return XPD_BUSY;
+    }
+
+    heth->Inst->MACMIIAR.w = (heth->Inst->MACMIIAR.w & ETH_MACMIIAR_CR)
+            | (((uint32_t)PhyAddress << ETH_MACMIIAR_PA_Pos) & ETH_MACMIIAR_PA)
+            | (((uint32_t)Register << ETH_MACMIIAR_MR_Pos) & ETH_MACMIIAR_MR)
+            | Write | ETH_MACMIIAR_MB;
+
+    return XPD_WaitForMatch(&heth->Inst->MACMIIAR.w, ETH_MACMIIAR_MB, 0, &timeout);
+}
+
+/* Queues the frame buffers to the transmit ring with the given descriptor control bits */
+static XPD_ReturnType eth_transmit(ETH_HandleType * heth, const ETH_BufferType * Buffers,
+        uint8_t Count, void * Context, uint32_t Control)
+{
+    ETH_DescType * first = &heth->TxRing.Desc[heth->TxRing.Head];
+    uint32_t control = ETH_TDES0_TCH | ETH_TDES0_FS | Control;
+    uint8_t i;
+
+    if ((Count == 0) || !XPD_ETH_TxRing_HasRoom(heth, Count))
+    {
+        return XPD_BUSY;
+    }
+
+    if (heth->Inst->MACCR.b.IPCO != 0)
+    {
+        control |= ETH_TDES0_CIC_FULL;
+    }
+
+    for (i = 0; i < Count; i++)
+    {
+        ETH_DescType * desc = &heth->TxRing.Desc[heth->TxRing.Head];
+        uint32_t status = control;
+
+        desc->Buffer      = (void*)Buffers[i].Data;
+        desc->ControlSize = Buffers[i].Length & ETH_TDES1_TBS1;
+        desc->Context     = NULL;
+
+        if (i == (Count - 1))
+        {
+            status |= ETH_TDES0_LS;
+            desc->Context = Context;
+
+            /* Transmit interrupt coalescing */
+            if (++heth->TxRing.Unsignaled >= heth->TxRing.Coalesce)
+            {
+                heth->TxRing.Unsignaled = 0;
+                status |= ETH_TDES0_IC;
+            }
+        }
+        /* The first descriptor is handed over last */
+        if (i > 0)
+        {
+            status |= ETH_TDES0_OWN;
+        }
+        desc->Status = status;
+
+        control &= ~ETH_TDES0_FS;
+        if (++heth->TxRing.Head == heth->TxRing.Count)
+        {
+            heth->TxRing.Head = 0;
+        }
+    }
+    heth->TxRing.Used += Count;
+
+    __DMB();
+    first->Status |= ETH_TDES0_OWN;
+
+    /* Resume the suspended transmission */
+    heth->Inst->DMASR.w  = ETH_DMASR_TBUS;
+    heth->Inst->DMATPDR = 0;
+
+    return XPD_OK;
+}
+
+/** @defgroup ETH_Exported_Functions ETH Exported Functions
+ * @{ */
+
+/**
+ * @brief Initializes the Ethernet MAC and its DMA according to the setup parameters.
+ * @note  The PHY reference clock has to be present for the DMA reset to complete.
+ *        The descriptor rings have to be set up before starting the transfers.
+ * @param heth: pointer to the ETH handle structure
+ * @param Config: pointer to ETH setup configuration
+ * @return TIMEOUT if the DMA reset fails, OK otherwise
+ */
+XPD_ReturnType XPD_ETH_Init(ETH_HandleType * heth, const ETH_InitType * Config)
+{
+    XPD_ReturnType result;
+    uint32_t timeout = ETH_RESET_TIMEOUT;
+
+    /* The PHY interface is selected while the MAC is in reset */
+    XPD_SYSCFG_ClockCtrl(ENABLE);
+    SYSCFG->PMC.b.MII_RMII_SEL = Config->Interface;
+
+    /* enable clocks */
+    XPD_SAFE_CALLBACK(heth->ClockCtrl, ENABLE);
+    XPD_ETHMAC_TX_ClockCtrl(ENABLE);
+    XPD_ETHMAC_RX_ClockCtrl(ENABLE);
+    XPD_ETHMAC_Reset();
+
+    /* Dependencies initialization */
+    XPD_SAFE_CALLBACK(heth->Callbacks.DepInit, heth);
+
+    /* The software reset waits for the PHY clocks */
+    heth->Inst->DMABMR.w = ETH_DMABMR_SR;
+    result = XPD_WaitForMatch(&heth->Inst->DMABMR.w, ETH_DMABMR_SR, 0, &timeout);
+    if (result != XPD_OK)
+    {
+        return result;
+    }
+
+    heth->Inst->MACMIIAR.w = eth_mdcClockRange();
+
+    /* Perfect address filtering, broadcast frames are accepted */
+    heth->Inst->MACFFR.w = 0;
+    heth->Inst->MACA0HR = ((uint32_t)Config->MACAddress[5] << 8) | Config->MACAddress[4];
+    heth->Inst->MACA0LR = ((uint32_t)Config->MACAddress[3] << 24)
+                        | ((uint32_t)Config->MACAddress[2] << 16)
+                        | ((uint32_t)Config->MACAddress[1] << 8)
+                        |  (uint32_t)Config->MACAddress[0];
+
+    heth->Inst->MACCR.w = ETH_MACCR_APCS;
+    heth->Inst->MACCR.b.IPCO = Config->ChecksumOffload;
+    XPD_ETH_LinkConfig(heth, Config->Speed, Config->FullDuplex);
+
+    /* Store and forward operation is required by the checksum offload */
+    heth->Inst->DMAOMR.w = ETH_DMAOMR_RSF | ETH_DMAOMR_TSF | ETH_DMAOMR_OSF;
+
+    /* Enhanced descriptors, 32 beat bursts on aligned addresses */
+    heth->Inst->DMABMR.w = ETH_DMABMR_AAB | ETH_DMABMR_FB | ETH_DMABMR_USP
+                         | ETH_DMABMR_RDP_32Beat | ETH_DMABMR_PBL_32Beat | ETH_DMABMR_EDE;
+
+    /* Receive interrupt coalescing is done by the watchdog,
+     * the descriptors are set up with disabled completion interrupt */
+    heth->Inst->DMARSWTR = Config->RxWatchdog;
+    heth->TxRing.Coalesce = (Config->TxInterruptFrames > 1) ? Config->TxInterruptFrames : 1;
+
+    heth->Errors = ETH_ERROR_NONE;
+    heth->Inst->DMASR.w  = heth->Inst->DMASR.w;
+    heth->Inst->DMAIER.w = ETH_DMAIER_NISE | ETH_DMAIER_RIE | ETH_DMAIER_TIE
+                         | ETH_DMAIER_AISE | ETH_DMAIER_FBEIE;
+
+    return XPD_OK;
+}
+
+/**
+ * @brief Stops the Ethernet transfers and restores the peripheral to its reset state.
+ * @param heth: pointer to the ETH handle structure
+ * @return ERROR if input is incorrect, OK if success
+ */
+XPD_ReturnType XPD_ETH_Deinit(ETH_HandleType * heth)
+{
+    XPD_ETH_Stop(heth);
+    heth->Inst->DMAIER.w = 0;
+
+    /* Deinitialize peripheral dependencies */
+    XPD_SAFE_CALLBACK(heth->Callbacks.DepDeinit, heth);
+
+    /* disable clocks */
+    XPD_ETHMAC_RX_ClockCtrl(DISABLE);
+    XPD_ETHMAC_TX_ClockCtrl(DISABLE);
+    XPD_SAFE_CALLBACK(heth->ClockCtrl, DISABLE);
+
+    return XPD_OK;
+}
+
+/**
+ * @brief Starts the transmission and reception of frames.
+ * @param heth: pointer to the ETH handle structure
+ */
+void XPD_ETH_Start(ETH_HandleType * heth)
+{
+    heth->Inst->MACCR.b.TE = 1;
+    heth->Inst->DMAOMR.b.FTF = 1;
+    heth->Inst->DMAOMR.b.ST = 1;
+    heth->Inst->MACCR.b.RE = 1;
+    heth->Inst->DMAOMR.b.SR = 1;
+}
+
+/**
+ * @brief Stops the transmission and reception of frames.
+ * @note  The frames in progress are completed before stopping.
+ * @param heth: pointer to the ETH handle structure
+ */
+void XPD_ETH_Stop(ETH_HandleType * heth)
+{
+    heth->Inst->DMAOMR.b.ST = 0;
+    heth->Inst->MACCR.b.RE = 0;
+    heth->Inst->DMAOMR.b.FTF = 1;
+    heth->Inst->MACCR.b.TE = 0;
+    heth->Inst->DMAOMR.b.SR = 0;
+}
+
+/**
+ * @brief Sets the MAC link parameters to the result of the PHY auto-negotiation.
+ * @param heth: pointer to the ETH handle structure
+ * @param Speed: the link speed
+ * @param FullDuplex: whether the link is full duplex
+ */
+void XPD_ETH_LinkConfig(ETH_HandleType * heth, ETH_SpeedType Speed, FunctionalState FullDuplex)
+{
+    heth->Inst->MACCR.b.FES = Speed;
+    heth->Inst->MACCR.b.DM  = FullDuplex;
+
+    /* Own frames are only received back in half duplex mode */
+    heth->Inst->MACCR.b.ROD = (FullDuplex == DISABLE) ? 1 : 0;
+}
+
+/**
+ * @brief Reads a PHY register through the MDIO interface.
+ * @param heth: pointer to the ETH handle structure
+ * @param PhyAddress: the PHY address [0 .. 31]
+ * @param Register: the PHY register index [0 .. 31]
+ * @param Value: pointer to the read register value
+ * @return BUSY if an access is ongoing, TIMEOUT if the PHY doesn't respond, OK if success
+ */
+XPD_ReturnType XPD_ETH_PHY_Read(ETH_HandleType * heth, uint8_t PhyAddress,
+        uint8_t Register, uint16_t * Value)
+{
+    XPD_ReturnType result = eth_mdioAccess(heth, PhyAddress, Register, 0);
+
+    if (result == XPD_OK)
+    {
+        *Value = (uint16_t)heth->Inst->MACMIIDR;
+    }
+    return result;
+}
+
+/**
+ * @brief Writes a PHY register through the MDIO interface.
+ * @param heth: pointer to the ETH handle structure
+ * @param PhyAddress: the PHY address [0 .. 31]
+ * @param Register: the PHY register index [0 .. 31]
+ * @param Value: the new register value
+ * @return BUSY if an access is ongoing, TIMEOUT if the PHY doesn't respond, OK if success
+ */
+XPD_ReturnType XPD_ETH_PHY_Write(ETH_HandleType * heth, uint8_t PhyAddress,
+        uint8_t Register, uint16_t Value)
+{
+    if ((heth->Inst->MACMIIAR.w & ETH_MACMIIAR_MB) != 0)
+    {
+        return XPD_BUSY;
+    }
+    heth->Inst->MACMIIDR = Value;
+
+    return eth_mdioAccess(heth, PhyAddress, Register, ETH_MACMIIAR_MW);
+}
+
+/**
+ * @brief Sets up the chained receive descriptor ring. The descriptors are empty,
+ *        they have to be given receive buffers by @ref XPD_ETH_RxRing_Give.
+ * @note  Must be called before @ref XPD_ETH_Start.
+ * @param heth: pointer to the ETH handle structure
+ * @param Desc: the word aligned descriptor array
+ * @param Count: the number of descriptors
+ */
+void XPD_ETH_RxRing_Init(ETH_HandleType * heth, ETH_DescType * Desc, uint8_t Count)
+{
+    uint8_t i;
+
+    for (i = 0; i < Count; i++)
+    {
+        Desc[i].Status      = 0;
+        Desc[i].ControlSize = ETH_RDES1_RCH;
+        Desc[i].Buffer      = NULL;
+        Desc[i].Next        = &Desc[(i + 1) % Count];
+    }
+
+    heth->RxRing.Desc  = Desc;
+    heth->RxRing.Count = Count;
+    heth->RxRing.Next  = 0;
+    heth->RxRing.Fill  = 0;
+    heth->RxRing.Free  = Count;
+    heth->RxRing.Stamped = FALSE;
+
+    heth->Inst->DMARDLAR = (uint32_t)Desc;
+}
+
+/**
+ * @brief Gives a receive buffer to the next empty receive descriptor.
+ *        The buffer is owned by the DMA until its frame is taken.
+ * @note  Must not be called concurrently with @ref XPD_ETH_RxRing_Take.
+ * @param heth: pointer to the ETH handle structure
+ * @param Buffer: the word aligned buffer of ETH_RX_BUFFER_SIZE bytes
+ * @return ERROR if all descriptors have a buffer, OK if success
+ */
+XPD_ReturnType XPD_ETH_RxRing_Give(ETH_HandleType * heth, void * Buffer)
+{
+    ETH_DescType * desc;
+
+    if (heth->RxRing.Free == 0)
+    {
+        return XPD_ERROR;
+    }
+
+    desc = &heth->RxRing.Desc[heth->RxRing.Fill];
+    desc->Buffer      = Buffer;
+    desc->ControlSize = ETH_RDES1_RCH | ETH_RX_BUFFER_SIZE
+            | ((heth->Inst->DMARSWTR != 0) ? ETH_RDES1_DIC : 0);
+
+    /* The descriptor is complete before handing it over */
+    __DMB();
+    desc->Status = ETH_RDES0_OWN;
+
+    if (++heth->RxRing.Fill == heth->RxRing.Count)
+    {
+        heth->RxRing.Fill = 0;
+    }
+    heth->RxRing.Free--;
+
+    /* Resume the suspended reception */
+    if ((heth->Inst->DMASR.w & ETH_DMASR_RBUS) != 0)
+    {
+        heth->Inst->DMASR.w  = ETH_DMASR_RBUS;
+        heth->Inst->DMARPDR = 0;
+    }
+    return XPD_OK;
+}
+
+/**
+ * @brief Takes the buffer of the next received frame from the receive ring without copying.
+ *        The erroneous frames are dropped, their buffers are given back to the ring.
+ * @param heth: pointer to the ETH handle structure
+ * @param Length: pointer to the received frame length (without the frame check sequence)
+ * @return The buffer holding the frame, or NULL if no frame is received
+ */
+void * XPD_ETH_RxRing_Take(ETH_HandleType * heth, uint16_t * Length)
+{
+    ETH_DescType * desc;
+    void * buffer = NULL;
+    uint32_t status;
+
+    while ((buffer == NULL) && (heth->RxRing.Free < heth->RxRing.Count))
+    {
+        desc = &heth->RxRing.Desc[heth->RxRing.Next];
+        status = desc->Status;
+
+        if ((status & ETH_RDES0_OWN) != 0)
+        {
+            break;
+        }
+
+        buffer = desc->Buffer;
+        desc->Buffer = NULL;
+        if (++heth->RxRing.Next == heth->RxRing.Count)
+        {
+            heth->RxRing.Next = 0;
+        }
+        heth->RxRing.Free++;
+
+        /* The buffer fits a whole frame, so it must be the first and last segment */
+        if (((status & ETH_RDES0_ES) != 0) ||
+            ((status & (ETH_RDES0_FS | ETH_RDES0_LS)) != (ETH_RDES0_FS | ETH_RDES0_LS)))
+        {
+            heth->Errors |= ETH_ERROR_RECEIVE;
+            XPD_STATS_ERROR(heth, ETH_ERROR_RECEIVE);
+
+            (void) XPD_ETH_RxRing_Give(heth, buffer);
+            buffer = NULL;
+        }
+        else
+        {
+            *Length = ((status & ETH_RDES0_FL) >> ETH_RDES0_FL_Pos) - ETH_FCS_SIZE;
+
+            heth->RxRing.Stamped = (status & ETH_RDES0_TSV) != 0;
+            heth->RxRing.Timestamp.Nanoseconds = desc->TimeStamp[0];
+            heth->RxRing.Timestamp.Seconds     = desc->TimeStamp[1];
+
+            XPD_STATS_ADD(heth, Transfers, 1);
+            XPD_STATS_ADD(heth, Bytes, *Length);
+        }
+    }
+    return buffer;
+}
+
+/**
+ * @brief Provides the reception time stamp of the last taken frame.
+ * @note  The time stamps are only captured while the PTP unit is enabled.
+ * @param heth: pointer to the ETH handle structure
+ * @param Time: pointer to the time stamp output
+ * @return TRUE if the frame is time stamped, FALSE otherwise
+ */
+boolean_t XPD_ETH_RxRing_GetTimestamp(ETH_HandleType * heth, ETH_TimeType * Time)
+{
+    *Time = heth->RxRing.Timestamp;
+    return heth->RxRing.Stamped;
+}
+
+/**
+ * @brief Sets up the chained transmit descriptor ring.
+ * @note  Must be called before @ref XPD_ETH_Start.
+ * @param heth: pointer to the ETH handle structure
+ * @param Desc: the word aligned descriptor array
+ * @param Count: the number of descriptors
+ */
+void XPD_ETH_TxRing_Init(ETH_HandleType * heth, ETH_DescType * Desc, uint8_t Count)
+{
+    uint8_t i;
+
+    for (i = 0; i < Count; i++)
+    {
+        Desc[i].Status      = ETH_TDES0_TCH;
+        Desc[i].ControlSize = 0;
+        Desc[i].Buffer      = NULL;
+        Desc[i].Next        = &Desc[(i + 1) % Count];
+        Desc[i].Context     = NULL;
+    }
+
+    heth->TxRing.Desc       = Desc;
+    heth->TxRing.Count      = Count;
+    heth->TxRing.Head       = 0;
+    heth->TxRing.Tail       = 0;
+    heth->TxRing.Used       = 0;
+    heth->TxRing.Unsignaled = 0;
+    heth->TxRing.Stamped    = FALSE;
+
+    heth->Inst->DMATDLAR = (uint32_t)Desc;
+}
+
+/**
+ * @brief Queues a frame for transmission directly from the provided buffers,
+ *        using one descriptor per buffer.
+ * @note  The buffers have to remain valid until the frame's context is reclaimed
+ *        by @ref XPD_ETH_TxRing_Reclaim.
+ * @param heth: pointer to the ETH handle structure
+ * @param Buffers: the consecutive parts of the frame
+ * @param Count: the number of frame buffers
+ * @param Context: the frame's context which is returned when it is reclaimed
+ * @return BUSY if the ring doesn't have enough free descriptors, OK if the frame is queued
+ */
+XPD_ReturnType XPD_ETH_Transmit(ETH_HandleType * heth, const ETH_BufferType * Buffers,
+        uint8_t Count, void * Context)
+{
+    return eth_transmit(heth, Buffers, Count, Context, 0);
+}
+
+/**
+ * @brief Queues a frame for transmission as @ref XPD_ETH_Transmit,
+ *        and captures the time of its transmission.
+ * @note  The time stamp is provided by @ref XPD_ETH_TxRing_GetTimestamp
+ *        after the frame is reclaimed.
+ * @param heth: pointer to the ETH handle structure
+ * @param Buffers: the consecutive parts of the frame
+ * @param Count: the number of frame buffers
+ * @param Context: the frame's context which is returned when it is reclaimed
+ * @return BUSY if the ring doesn't have enough free descriptors, OK if the frame is queued
+ */
+XPD_ReturnType XPD_ETH_TransmitTimestamped(ETH_HandleType * heth, const ETH_BufferType * Buffers,
+        uint8_t Count, void * Context)
+{
+    return eth_transmit(heth, Buffers, Count, Context, ETH_TDES0_TTSE);
+}
+
+/**
+ * @brief Releases the descriptors of the oldest transmitted frame.
+ * @param heth: pointer to the ETH handle structure
+ * @param Context: pointer to the reclaimed frame's context
+ * @return TRUE if a transmitted frame is reclaimed, FALSE if none are complete
+ */
+boolean_t XPD_ETH_TxRing_Reclaim(ETH_HandleType * heth, void ** Context)
+{
+    while (heth->TxRing.Used > 0)
+    {
+        ETH_DescType * desc = &heth->TxRing.Desc[heth->TxRing.Tail];
+        uint32_t status = desc->Status;
+
+        if ((status & ETH_TDES0_OWN) != 0)
+        {
+            break;
+        }
+
+        if (++heth->TxRing.Tail == heth->TxRing.Count)
+        {
+            heth->TxRing.Tail = 0;
+        }
+        heth->TxRing.Used--;
+
+        if ((status & ETH_TDES0_LS) != 0)
+        {
+            if ((status & ETH_TDES0_ES) != 0)
+            {
+                heth->Errors |= ETH_ERROR_TRANSMIT;
+                XPD_STATS_ERROR(heth, ETH_ERROR_TRANSMIT);
+            }
+            else
+            {
+                XPD_STATS_ADD(heth, Transfers, 1);
+            }
+
+            heth->TxRing.Stamped = (status & ETH_TDES0_TTSS) != 0;
+            heth->TxRing.Timestamp.Nanoseconds = desc->TimeStamp[0];
+            heth->TxRing.Timestamp.Seconds     = desc->TimeStamp[1];
+
+            *Context = desc->Context;
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
+/**
+ * @brief Provides the transmission time stamp of the last reclaimed frame.
+ * @note  Only the frames sent by @ref XPD_ETH_TransmitTimestamped are time stamped.
+ * @param heth: pointer to the ETH handle structure
+ * @param Time: pointer to the time stamp output
+ * @return TRUE if the frame is time stamped, FALSE otherwise
+ */
+boolean_t XPD_ETH_TxRing_GetTimestamp(ETH_HandleType * heth, ETH_TimeType * Time)
+{
+    *Time = heth->TxRing.Timestamp;
+    return heth->TxRing.Stamped;
+}
+
+/**
+ * @brief Enables the IEEE 1588 time stamp unit and starts the system time.
+ *        The time stamps of all received frames are captured to their descriptors.
+ * @note  The system time is incremented by fine update from HCLK, with a nominal
+ *        accumulator frequency of about HCLK / 2, which allows frequency corrections
+ *        by @ref XPD_ETH_PTP_AdjustFreq.
+ * @param heth: pointer to the ETH handle structure
+ * @param Time: the initial system time
+ * @return TIMEOUT if the time initialization fails, OK otherwise
+ */
+XPD_ReturnType XPD_ETH_PTP_Init(ETH_HandleType * heth, const ETH_TimeType * Time)
+{
+    uint32_t hclk = XPD_RCC_GetClockFreq(HCLK);
+    uint32_t timeout = ETH_RESET_TIMEOUT;
+    uint32_t ssinc;
+
+    XPD_ETHMAC_PTP_ClockCtrl(ENABLE);
+
+    /* Digital subsecond rollover, the subseconds count nanoseconds */
+    heth->Inst->MACIMR.w |= ETH_MACIMR_TSTIM;
+    heth->Inst->PTPTSCR.w = ETH_PTPTSCR_TSE | ETH_PTPTSCR_TSSARFE | ETH_PTPTSCR_TSSSR;
+
+    /* The accumulator overflows at (1e9 / ssinc) Hz, the addend scales HCLK to it */
+    ssinc = (2 * ETH_NS_PER_SECOND + hclk - 1) / hclk;
+    heth->PtpAddend = (uint32_t)(((uint64_t)ETH_NS_PER_SECOND << 32) / ((uint64_t)ssinc * hclk));
+    heth->Inst->PTPSSIR = ssinc;
+    heth->Inst->PTPTSAR = heth->PtpAddend;
+    heth->Inst->PTPTSCR.w |= ETH_PTPTSCR_TSARU;
+
+    if (XPD_WaitForMatch(&heth->Inst->PTPTSCR.w, ETH_PTPTSCR_TSARU, 0, &timeout) != XPD_OK)
+    {
+        return XPD_TIMEOUT;
+    }
+    heth->Inst->PTPTSCR.w |= ETH_PTPTSCR_TSFCU;
+
+    heth->Inst->PTPTSHUR = Time->Seconds;
+    heth->Inst->PTPTSLUR.w = Time->Nanoseconds;
+    heth->Inst->PTPTSCR.w |= ETH_PTPTSCR_TSSTI;
+
+    return XPD_WaitForMatch(&heth->Inst->PTPTSCR.w, ETH_PTPTSCR_TSSTI, 0, &timeout);
+}
+
+/**
+ * @brief Disables the IEEE 1588 time stamp unit.
+ * @param heth: pointer to the ETH handle structure
+ */
+void XPD_ETH_PTP_Deinit(ETH_HandleType * heth)
+{
+    heth->Inst->MACIMR.w |= ETH_MACIMR_TSTIM;
+    heth->Inst->PTPTSCR.w = 0;
+
+    XPD_ETHMAC_PTP_ClockCtrl(DISABLE);
+}
+
+/**
+ * @brief Reads the current system time.
+ * @param heth: pointer to the ETH handle structure
+ * @param Time: pointer to the time output
+ */
+void XPD_ETH_PTP_GetTime(ETH_HandleType * heth, ETH_TimeType * Time)
+{
+    uint32_t seconds;
+
+    /* Repeat the read if the seconds rolled over in the meantime */
+    do {
+        seconds = heth->Inst->PTPTSHR;
+        Time->Nanoseconds = heth->Inst->PTPTSLR.w & ETH_PTPTSLR_STSS;
+        Time->Seconds = heth->Inst->PTPTSHR;
+    } while (seconds != Time->Seconds);
+}
+
+/**
+ * @brief Overwrites the system time.
+ * @param heth: pointer to the ETH handle structure
+ * @param Time: the new system time
+ * @return BUSY if a previous time update is pending, OK if success
+ */
+XPD_ReturnType XPD_ETH_PTP_SetTime(ETH_HandleType * heth, const ETH_TimeType * Time)
+{
+    if ((heth->Inst->PTPTSCR.w & ETH_PTPTSCR_UPDATES) != 0)
+    {
+        return XPD_BUSY;
+    }
+
+    heth->Inst->PTPTSHUR = Time->Seconds;
+    heth->Inst->PTPTSLUR.w = Time->Nanoseconds;
+    heth->Inst->PTPTSCR.w |= ETH_PTPTSCR_TSSTI;
+
+    return XPD_OK;
+}
+
+/**
+ * @brief Performs a coarse correction of the system time by adding the offset to it.
+ * @param heth: pointer to the ETH handle structure
+ * @param Nanoseconds: the signed time offset
+ * @return BUSY if a previous time update is pending, OK if success
+ */
+XPD_ReturnType XPD_ETH_PTP_AdjustTime(ETH_HandleType * heth, int64_t Nanoseconds)
+{
+    uint64_t offset = (Nanoseconds < 0) ? -Nanoseconds : Nanoseconds;
+
+    if ((heth->Inst->PTPTSCR.w & ETH_PTPTSCR_UPDATES) != 0)
+    {
+        return XPD_BUSY;
+    }
+
+    heth->Inst->PTPTSHUR = (uint32_t)(offset / ETH_NS_PER_SECOND);
+    heth->Inst->PTPTSLUR.w = (uint32_t)(offset % ETH_NS_PER_SECOND)
+            | ((Nanoseconds < 0) ? ETH_PTPTSLUR_TSUPNS : 0);
+    heth->Inst->PTPTSCR.w |= ETH_PTPTSCR_TSSTU;
+
+    return XPD_OK;
+}
+
+/**
+ * @brief Performs a fine correction of the system time frequency.
+ * @param heth: pointer to the ETH handle structure
+ * @param PartsPerBillion: the signed frequency offset relative to the nominal rate
+ * @return BUSY if a previous addend update is pending, OK if success
+ */
+XPD_ReturnType XPD_ETH_PTP_AdjustFreq(ETH_HandleType * heth, int32_t PartsPerBillion)
+{
+    if ((heth->Inst->PTPTSCR.w & ETH_PTPTSCR_TSARU) != 0)
+    {
+        return XPD_BUSY;
+    }
+
+    heth->Inst->PTPTSAR = heth->PtpAddend
+            + (int32_t)(((int64_t)heth->PtpAddend * PartsPerBillion) / ETH_NS_PER_SECOND);
+    heth->Inst->PTPTSCR.w |= ETH_PTPTSCR_TSARU;
+
+    return XPD_OK;
+}
+
+/**
+ * @brief Sets up a single target time event, which raises an interrupt
+ *        and pulses the PTP trigger output.
+ * @param heth: pointer to the ETH handle structure
+ * @param Time: the system time of the event
+ * @return BUSY if the previous target time is pending, OK if success
+ */
+XPD_ReturnType XPD_ETH_PTP_SetTargetTime(ETH_HandleType * heth, const ETH_TimeType * Time)
+{
+    if ((heth->Inst->PTPTSCR.w & ETH_PTPTSCR_TSITE) != 0)
+    {
+        return XPD_BUSY;
+    }
+
+    heth->Inst->PTPTTHR = Time->Seconds;
+    heth->Inst->PTPTTLR = Time->Nanoseconds;
+
+    /* The status flag is cleared by reading */
+    (void) heth->Inst->PTPTSSR.w;
+    heth->Inst->MACIMR.w &= ~ETH_MACIMR_TSTIM;
+    heth->Inst->PTPTSCR.w |= ETH_PTPTSCR_TSITE;
+
+    return XPD_OK;
+}
+
+/**
+ * @brief Connects the PTP trigger output to the TIM2 internal trigger 1,
+ *        so the target time events can start or synchronize the timer.
+ * @note  The TIM2 slave mode has to use the TIM_TRGI_ITR1 trigger input.
+ * @param NewState: whether TIM2 ITR1 is connected to the PTP trigger instead of TIM8 TRGO
+ */
+void XPD_ETH_PTP_TimerTrigger(FunctionalState NewState)
+{
+    if (NewState != DISABLE)
+    {
+        MODIFY_REG(TIM2->OR, TIM_OR_ITR1_RMP, TIM_OR_ITR1_RMP_0);
+    }
+    else
+    {
+        CLEAR_BIT(TIM2->OR, TIM_OR_ITR1_RMP);
+    }
+}
+
+/**
+ * @brief ETH global interrupt handler that provides handle callbacks.
+ * @param heth: pointer to the ETH handle structure
+ */
+void XPD_ETH_IRQHandler(ETH_HandleType * heth)
+{
+    XPD_PROFILE_BEGIN();
+    XPD_STATS_IRQ_BEGIN();
+
+    uint32_t sr = heth->Inst->DMASR.w;
+
+    if ((sr & ETH_DMASR_RS) != 0)
+    {
+        heth->Inst->DMASR.w = ETH_DMASR_RS | ETH_DMASR_NIS;
+
+        XPD_SAFE_CALLBACK(heth->Callbacks.Received, heth);
+    }
+    if ((sr & ETH_DMASR_TS) != 0)
+    {
+        heth->Inst->DMASR.w = ETH_DMASR_TS | ETH_DMASR_NIS;
+
+        XPD_SAFE_CALLBACK(heth->Callbacks.Transmitted, heth);
+    }
+    if ((sr & ETH_DMASR_FBES) != 0)
+    {
+        heth->Inst->DMASR.w = ETH_DMASR_FBES | ETH_DMASR_AIS;
+
+        /* The DMA stops on a fatal bus error */
+        heth->Errors |= ETH_ERROR_BUS;
+        XPD_STATS_ERROR(heth, ETH_ERROR_BUS);
+
+        XPD_SAFE_CALLBACK(heth->Callbacks.Error, heth);
+    }
+    if ((sr & ETH_DMASR_TSTS) != 0)
+    {
+        /* Reading the status clears the time stamp trigger interrupt */
+        if ((heth->Inst->PTPTSSR.w & ETH_PTPTSSR_TSTTR) != 0)
+        {
+            heth->Inst->MACIMR.w |= ETH_MACIMR_TSTIM;
+
+            XPD_SAFE_CALLBACK(heth->Callbacks.TargetTime, heth);
+        }
+    }
+
+    XPD_STATS_IRQ_END(heth);
+    XPD_PROFILE_END();
+}
+
+/** @} */
+
+/** @} */
+
+#endif /* USE_XPD_ETH */
@@ -24,10 +24,9 @@
 
 #include "xpd_exti.h"
 
-XPD_ValueCallbackType XPD_EXTI_Callbacks[] = {
-        NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL,
-        NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL,
-};
+#define EXTI_LINE_COUNT     32
+
+XPD_ValueCallbackType XPD_EXTI_Callbacks[EXTI_LINE_COUNT];
 
 /** @addtogroup EXTI
  * @{ */
@@ -46,17 +45,14 @@ void XPD_EXTI_Init(uint8_t Line, const EXTI_InitType * Config)
     XPD_EXTI_ClockCtrl(ENABLE);
 #endif
 
-    /* GPIO callbacks only */
-    if (Line < 16)
+    /* The event lines are dispatched by XPD_WaitForEvents */
+    if (Config->Reaction != REACTION_NONE)
+    {
+        XPD_EXTI_Callbacks[Line] = Config->ITCallback;
+    }
+    else
     {
-        if (Config->Reaction & REACTION_IT)
-        {
-            XPD_EXTI_Callbacks[Line] = Config->ITCallback;
-        }
-        else
-        {
-            XPD_EXTI_Callbacks[Line] = NULL;
-        }
+        XPD_EXTI_Callbacks[Line] = NULL;
     }
 
 #ifdef EXTI_BB
@@ -139,6 +135,32 @@ void XPD_EXTI_Deinit(uint8_t Line)
 #endif
 }
 
+/**
+ * @brief EXTI interrupt handler for a range of lines sharing an interrupt vector.
+ *        The pending lines are cleared together, then their callbacks are called
+ *        in ascending line order.
+ * @param FirstLine: the lowest EXTI line served by the interrupt vector
+ * @param LastLine: the highest EXTI line served by the interrupt vector
+ */
+void XPD_EXTI_IRQHandler(uint8_t FirstLine, uint8_t LastLine)
+{
+    /* the enabled lines of the vector which are pending */
+    uint32_t pending = EXTI->PR & EXTI->IMR
+            & (0xFFFFFFFF << FirstLine) & (0xFFFFFFFF >> (31 - LastLine));
+
+    /* clear all served lines with a single write */
+    EXTI->PR = pending;
+
+    while (pending != 0)
+    {
+        uint8_t line = POSITION_VAL(pending);
+
+        pending &= pending - 1;
+
+        XPD_SAFE_CALLBACK(XPD_EXTI_Callbacks[line], line);
+    }
+}
+
 /** @} */
 
 /** @} */
@@ -22,9 +22,783 @@
   *  along with STM32_XPD.  If not, see <http://www.gnu.org/licenses/>.
   */
 #include "xpd_flash.h"
+#include "xpd_utils.h"
+
+#ifdef USE_XPD_FLASH
 
 /** @addtogroup FLASH
  * @{ */
 
+/** @addtogroup FLASH_Private_Macros
+ * @{ */
+
+#define FLASH_TIMEOUT_MS        50000 /* 50 s */
+
+#define hflash                  (&xpd_flashHandle)
+
+#ifdef FLASH_CR_MER2
+#define FLASH_CR_MERALL         (FLASH_CR_MER | FLASH_CR_MER2)
+/* The physical banks are swapped when the second bank is mapped to the flash base */
+#define FLASH_BANKS_SWAPPED()   (SYSCFG->MEMRMP.b.UFB_MODE != 0)
+#else
+#define FLASH_CR_MERALL         (FLASH_CR_MER)
+#endif
+
+#define FLASH_GETOPERATION()    (FLASH->CR.w & (FLASH_CR_SER | FLASH_CR_MERALL | FLASH_CR_PG))
+
+#ifdef FLASH_SR_RDERR
+#define FLASH_SR_ERRORS         (FLASH_SR_SOP | FLASH_SR_WRPERR | FLASH_SR_PGAERR | \
+                                 FLASH_SR_PGPERR | FLASH_SR_PGSERR | FLASH_SR_RDERR)
+#else
+#define FLASH_SR_ERRORS         (FLASH_SR_SOP | FLASH_SR_WRPERR | FLASH_SR_PGAERR | \
+                                 FLASH_SR_PGPERR | FLASH_SR_PGSERR)
+#endif
+
+#ifndef FLASH_KEY1
+#define FLASH_KEY1              0x45670123
+#endif
+#ifndef FLASH_KEY2
+#define FLASH_KEY2              0xCDEF89AB
+#endif
+#ifndef FLASH_OPTKEY1
+#define FLASH_OPTKEY1           0x08192A3B
+#endif
+#ifndef FLASH_OPTKEY2
+#define FLASH_OPTKEY2           0x4C5D6E7F
+#endif
+
+/* Internal variable for context storage */
+static struct
+{
+    uint8_t * Address;
+    const uint8_t * Data;
+    uint32_t Length;
+    uint8_t UnitSize;
+    volatile FLASH_ErrorType Errors;
+#ifdef USE_XPD_OS
+    XPD_OS_SignalType Signal;
+#endif
+} xpd_flashHandle =
+{
+        .Errors = FLASH_ERROR_NONE,
+};
+
+/* Determines the sector number (SNB value) and size of the sector containing the address */
+static uint32_t flash_getSector(uint32_t Address, uint32_t * Size)
+{
+    uint32_t offset = Address - FLASH_BASE;
+    uint32_t sector = 0;
+
+#ifdef FLASH_BANK_SIZE
+    boolean_t upperBank = offset >= FLASH_BANK_SIZE;
+
+    if (upperBank)
+    {
+        offset -= FLASH_BANK_SIZE;
+    }
+
+    /* Second physical bank sectors are numbered from 0x10 */
+    if (upperBank != FLASH_BANKS_SWAPPED())
+    {
+        sector  = 0x10;
+    }
+#endif
+
+    if (offset < 0x10000)
+    {
+        /* 4 * 16 kB */
+        *Size   = 0x4000;
+        sector += offset / 0x4000;
+    }
+    else if (offset < 0x20000)
+    {
+        /* 1 * 64 kB */
+        *Size   = 0x10000;
+        sector += 4;
+    }
+    else
+    {
+        /* n * 128 kB */
+        *Size   = 0x20000;
+        sector += 4 + offset / 0x20000;
+    }
+    return sector;
+}
+
+/* Erase the next scheduled sector */
+static void flash_blockErase(void)
+{
+    uint32_t size;
+
+    FLASH->CR.b.SNB   = flash_getSector((uint32_t)hflash->Address, &size);
+    FLASH->CR.b.PSIZE = FLASH_PARALLELISM;
+
+    /* Proceed to erase the sector */
+    FLASH_REG_BIT(CR,SER) = 1;
+    FLASH_REG_BIT(CR,STRT) = 1;
+}
+
+/* Start the mass erase of the selected bank */
+static void flash_bankErase(uint8_t Bank)
+{
+    FLASH->CR.b.PSIZE = FLASH_PARALLELISM;
+
+#ifdef FLASH_CR_MER2
+    /* The mass erase is selected by physical bank */
+    if ((Bank == 2) != FLASH_BANKS_SWAPPED())
+    {
+        SET_BIT(FLASH->CR.w, FLASH_CR_MER2);
+    }
+    else
+#endif
+    {
+        SET_BIT(FLASH->CR.w, FLASH_CR_MER);
+    }
+    FLASH_REG_BIT(CR,STRT) = 1;
+}
+
+/* Program the next data unit with the widest access the alignment allows */
+static void flash_unitProgram(void)
+{
+    uint32_t address = (uint32_t)hflash->Address;
+    uint32_t size = 1 << FLASH_PARALLELISM;
+    uint32_t data[2] = { 0, 0 };
+    uint32_t i;
+
+    /* Narrower access for the unaligned head and the tail of the data */
+    while ((size > 1) && ((hflash->Length < size) || ((address & (size - 1)) != 0)))
+    {
+        size >>= 1;
+    }
+
+    /* The source data may not be aligned */
+    for (i = 0; i < size; i++)
+    {
+        ((uint8_t*)data)[i] = hflash->Data[i];
+    }
+    hflash->UnitSize = size;
+
+    FLASH->CR.b.PSIZE = (size == 8) ? FLASH_PARALLELISM_X64 : (size >> 1);
+
+    /* Enable flash programming */
+    FLASH_REG_BIT(CR,PG) = 1;
+
+    switch (size)
+    {
+        case 1:
+            *((__IO uint8_t  *)address) = (uint8_t)data[0];
+            break;
+        case 2:
+            *((__IO uint16_t *)address) = (uint16_t)data[0];
+            break;
+        case 4:
+            *((__IO uint32_t *)address) = data[0];
+            break;
+        default:
+            *((__IO uint32_t *)address) = data[0];
+            *((__IO uint32_t *)(address + 4)) = data[1];
+            break;
+    }
+}
+
+/* Advance the program context after the completed unit */
+static void flash_unitAdvance(void)
+{
+    hflash->Address += hflash->UnitSize;
+    hflash->Data    += hflash->UnitSize;
+    hflash->Length  -= hflash->UnitSize;
+}
+
+/* Read errors to context, and clear them in register */
+static void flash_checkErrors(void)
+{
+    /* Read error flags */
+    hflash->Errors = FLASH->SR.w & FLASH_SR_ERRORS;
+
+    /* Clear error flags */
+    FLASH->SR.w = hflash->Errors;
+}
+
+#ifdef USE_XPD_OS
+/* Waits until the interrupt driven operation is finished */
+static XPD_ReturnType flash_waitBlocking(uint32_t * timeout)
+{
+    XPD_ReturnType result = XPD_OK;
+
+    while ((result == XPD_OK) && (FLASH_GETOPERATION() != FLASH_OPERATION_NONE))
+    {
+        result = XPD_OS_SignalWait(&hflash->Signal, timeout);
+    }
+    if ((result == XPD_OK) && (hflash->Errors != FLASH_ERROR_NONE))
+    {
+        result = XPD_ERROR;
+    }
+    return result;
+}
+#endif
+
+/** @} */
+
+/** @addtogroup FLASH_Exported_Functions
+ * @{ */
+
+/**
+ * @brief Unlock the FLASH control register access.
+ */
+void XPD_FLASH_Unlock(void)
+{
+    if (FLASH_REG_BIT(CR,LOCK) != 0)
+    {
+        /* Authorize the FLASH Registers access */
+        FLASH->KEYR = FLASH_KEY1;
+        FLASH->KEYR = FLASH_KEY2;
+    }
+    CLEAR_BIT(FLASH->CR.w, FLASH_CR_SER | FLASH_CR_MERALL | FLASH_CR_PG);
+}
+
+/**
+ * @brief Lock the FLASH control register access.
+ */
+void XPD_FLASH_Lock(void)
+{
+    /* Set the LOCK Bit to lock the FLASH Registers access */
+    FLASH_REG_BIT(CR,LOCK) = 1;
+}
+
+/**
+ * @brief Polls the status of the ongoing FLASH operation.
+ * @param Timeout: the timeout in ms for the polling.
+ * @return ERROR    if there were errors,
+ *         TIMEOUT  if timed out,
+ *         OK       if successful
+ */
+XPD_ReturnType XPD_FLASH_PollStatus(uint32_t Timeout)
+{
+    /* Wait for the FLASH operation to complete by polling on BUSY flag to be reset.
+     Even if the FLASH operation fails, the BUSY flag will be reset and an error
+     flag will be set */
+    XPD_ReturnType result = XPD_WaitForDiff(&FLASH->SR.w,
+            FLASH_SR_BSY, FLASH_SR_BSY, &Timeout);
+
+    /* Check FLASH End of Operation flag (only set when EOPIE is set) */
+    if (XPD_FLASH_GetFlag(EOP) != 0)
+    {
+        /* Clear FLASH End of Operation pending bit */
+        XPD_FLASH_ClearFlag(EOP);
+    }
+
+    flash_checkErrors();
+    if (hflash->Errors != FLASH_ERROR_NONE)
+    {
+        result = XPD_ERROR;
+    }
+
+    return result;
+}
+
+/**
+ * @brief Programs the input data to the specified flash address.
+ * @note  The FLASH interface should be unlocked beforehand, and locked afterwards.
+ * @note  The data is programmed with FLASH_PARALLELISM wide accesses,
+ *        the unaligned head and the tail of the data with narrower ones.
+ * @param Address: the start flash address to write
+ * @param Data: input data to program
+ * @param Length: amount of bytes to program
+ * @return BUSY     if another operation is already ongoing,
+ *         ERROR    if there were errors,
+ *         TIMEOUT  if timed out,
+ *         OK       if successful
+ */
+XPD_ReturnType XPD_FLASH_Program(void * Address, const void * Data, uint16_t Length)
+{
+    /* Wait for last operation to be completed */
+    XPD_ReturnType result = XPD_FLASH_PollStatus(FLASH_TIMEOUT_MS);
+
+    if (result == XPD_OK)
+    {
+        hflash->Address = Address;
+        hflash->Data    = Data;
+        hflash->Length  = Length;
+
+        while (hflash->Length > 0)
+        {
+            flash_unitProgram();
+
+            /* Wait for last operation to be completed */
+            result = XPD_FLASH_PollStatus(FLASH_TIMEOUT_MS);
+
+            /* Disable flash programming */
+            FLASH_REG_BIT(CR,PG) = 0;
+
+            /* In case of error, stop flash programming */
+            if (result != XPD_OK)
+            {
+                break;
+            }
+
+            flash_unitAdvance();
+        }
+    }
+
+    return result;
+}
+
+/**
+ * @brief Programs the input data to the specified flash address in interrupt (non-blocking) mode.
+ * @note  The FLASH interface should be unlocked beforehand, and locked afterwards.
+ * @note  The data is programmed with FLASH_PARALLELISM wide accesses,
+ *        the unaligned head and the tail of the data with narrower ones.
+ * @param Address: the start flash address to write
+ * @param Data: input data to program
+ * @param Length: amount of bytes to program
+ * @return BUSY     if another operation is already ongoing,
+ *         OK       if programming started
+ */
+XPD_ReturnType XPD_FLASH_Program_IT(void * Address, const void * Data, uint16_t Length)
+{
+    XPD_ReturnType result = XPD_BUSY;
+
+    /* Only start if no ongoing operations are present */
+    if ((FLASH_GETOPERATION() == FLASH_OPERATION_NONE) && (Length > 0))
+    {
+        hflash->Address = Address;
+        hflash->Data    = Data;
+        hflash->Length  = Length;
+
+        /* Enable interrupts */
+        SET_BIT(FLASH->CR.w, FLASH_CR_EOPIE | FLASH_CR_ERRIE);
+
+        flash_unitProgram();
+
+        result = XPD_OK;
+    }
+    return result;
+}
+
+/**
+ * @brief Performs a mass erase on a flash memory bank.
+ * @note  The FLASH interface should be unlocked beforehand, and locked afterwards.
+ * @param Bank: The selected memory bank [1 .. 2] in address order (only relevant for dual bank devices)
+ * @return BUSY     if another operation is already ongoing,
+ *         ERROR    if there were errors,
+ *         TIMEOUT  if timed out,
+ *         OK       if successful
+ */
+XPD_ReturnType XPD_FLASH_EraseBank(uint8_t Bank)
+{
+    /* Wait for last operation to be completed */
+    XPD_ReturnType result = XPD_FLASH_PollStatus(FLASH_TIMEOUT_MS);
+
+    if (result == XPD_OK)
+    {
+        flash_bankErase(Bank);
+
+        result = XPD_FLASH_PollStatus(FLASH_TIMEOUT_MS);
+
+        CLEAR_BIT(FLASH->CR.w, FLASH_CR_MERALL);
+
+        XPD_FLASH_ResetCaches();
+    }
+
+    return result;
+}
+
+/**
+ * @brief Performs a mass erase on a flash memory bank in interrupt (non-blocking) mode.
+ * @note  The FLASH interface should be unlocked beforehand, and locked afterwards.
+ * @param Bank: The selected memory bank [1 .. 2] in address order (only relevant for dual bank devices)
+ * @return BUSY     if another operation is already ongoing,
+ *         OK       if mass erase started
+ */
+XPD_ReturnType XPD_FLASH_EraseBank_IT(uint8_t Bank)
+{
+    XPD_ReturnType result = XPD_BUSY;
+
+    /* Only start if no ongoing operations are present */
+    if (FLASH_GETOPERATION() == FLASH_OPERATION_NONE)
+    {
+        /* Enable interrupts */
+        SET_BIT(FLASH->CR.w, FLASH_CR_EOPIE | FLASH_CR_ERRIE);
+
+        flash_bankErase(Bank);
+
+        result = XPD_OK;
+    }
+
+    return result;
+}
+
+/**
+ * @brief Performs consecutive sector erases in flash.
+ * @note  The FLASH interface should be unlocked beforehand, and locked afterwards.
+ * @param Address: start address of first sector to be erased
+ * @param kBytes: amount of flash memory to erase in kilobytes (sectors are 16, 64 or 128 kB)
+ * @return BUSY     if another operation is already ongoing,
+ *         ERROR    if there were errors,
+ *         TIMEOUT  if timed out,
+ *         OK       if successful
+ */
+XPD_ReturnType XPD_FLASH_Erase(void * Address, uint16_t kBytes)
+{
+    /* Wait for last operation to be completed */
+    XPD_ReturnType result = XPD_FLASH_PollStatus(FLASH_TIMEOUT_MS);
+
+    if (result == XPD_OK)
+    {
+        hflash->Address = Address;
+        hflash->Length  = kBytes;
+
+        /* Keep erasing sectors until at least the requested amount */
+        while (hflash->Length > 0)
+        {
+            uint32_t blocksize;
+            (void) flash_getSector((uint32_t)hflash->Address, &blocksize);
+            blocksize >>= 10;
+
+            flash_blockErase();
+
+            /* Wait for last operation to be completed */
+            result = XPD_FLASH_PollStatus(FLASH_TIMEOUT_MS);
+
+            /* If the erase operation is completed, disable the SER Bit */
+            FLASH_REG_BIT(CR,SER) = 0;
+
+            /* In case of error or length underflow, stop erasing */
+            if ((result != XPD_OK) || (hflash->Length <= blocksize))
+            {
+                break;
+            }
+
+            /* Increase flash address */
+            hflash->Address += blocksize << 10;
+            hflash->Length  -= blocksize;
+        }
+
+        XPD_FLASH_ResetCaches();
+    }
+
+    return result;
+}
+
+/**
+ * @brief Performs consecutive sector erases in flash in interrupt (non-blocking) mode.
+ * @note  The FLASH interface should be unlocked beforehand, and locked afterwards.
+ * @param Address: start address of first sector to be erased
+ * @param kBytes: amount of flash memory to erase in kilobytes (sectors are 16, 64 or 128 kB)
+ * @return BUSY     if another operation is already ongoing,
+ *         OK       if sector erase started
+ */
+XPD_ReturnType XPD_FLASH_Erase_IT(void * Address, uint16_t kBytes)
+{
+    XPD_ReturnType result = XPD_BUSY;
+
+    /* Only start if no ongoing operations are present */
+    if (FLASH_GETOPERATION() == FLASH_OPERATION_NONE)
+    {
+        hflash->Address = Address;
+        hflash->Length  = kBytes;
+
+        /* Enable interrupts */
+        SET_BIT(FLASH->CR.w, FLASH_CR_EOPIE | FLASH_CR_ERRIE);
+
+        flash_blockErase();
+
+        result = XPD_OK;
+    }
+
+    return result;
+}
+
+#ifdef USE_XPD_OS
+/**
+ * @brief Programs the input data to the specified flash address,
+ *        blocking the calling task until the programming is finished.
+ * @note  The FLASH interface should be unlocked beforehand, and locked afterwards.
+ * @note  Other tasks can only run meanwhile if they don't access the flash bank
+ *        being programmed (e.g. they execute from RAM or from the other bank).
+ * @param Address: the start flash address to write
+ * @param Data: input data to program
+ * @param Length: amount of bytes to program
+ * @param Timeout: available time for the operation in ms
+ * @return BUSY     if another operation is already ongoing,
+ *         ERROR    if there were errors,
+ *         TIMEOUT  if timed out,
+ *         OK       if successful
+ */
+XPD_ReturnType XPD_FLASH_Program_Blocking(void * Address, const void * Data, uint16_t Length, uint32_t Timeout)
+{
+    XPD_ReturnType result;
+
+    XPD_OS_SignalInit(&hflash->Signal);
+
+    result = XPD_FLASH_Program_IT(Address, Data, Length);
+
+    if (result == XPD_OK)
+    {
+        result = flash_waitBlocking(&Timeout);
+    }
+    return result;
+}
+
+/**
+ * @brief Performs consecutive flash erases, blocking the calling task until the erase is finished.
+ * @note  The FLASH interface should be unlocked beforehand, and locked afterwards.
+ * @note  Other tasks can only run meanwhile if they don't access the flash bank
+ *        being erased (e.g. they execute from RAM or from the other bank).
+ * @param Address: start address of first block to be erased
+ * @param kBytes: amount of flash memory to erase in kilobytes
+ * @param Timeout: available time for the operation in ms
+ * @return BUSY     if another operation is already ongoing,
+ *         ERROR    if there were errors,
+ *         TIMEOUT  if timed out,
+ *         OK       if successful
+ */
+XPD_ReturnType XPD_FLASH_Erase_Blocking(void * Address, uint16_t kBytes, uint32_t Timeout)
+{
+    XPD_ReturnType result;
+
+    XPD_OS_SignalInit(&hflash->Signal);
+
+    result = XPD_FLASH_Erase_IT(Address, kBytes);
+
+    if (result == XPD_OK)
+    {
+        result = flash_waitBlocking(&Timeout);
+    }
+    return result;
+}
+#endif /* USE_XPD_OS */
+
+/**
+ * @brief FLASH interrupt handler that manages consecutive sector erasing
+ *        and programming, and provides completion and error callbacks.
+ */
+void XPD_FLASH_IRQHandler(void)
+{
+    XPD_PROFILE_BEGIN();
+
+    /* Check FLASH error flags */
+    flash_checkErrors();
+    if (hflash->Errors != FLASH_ERROR_NONE)
+    {
+        /* Stop the operation */
+        hflash->Length = 0;
+        CLEAR_BIT(FLASH->CR.w, FLASH_CR_SER | FLASH_CR_MERALL | FLASH_CR_PG);
+
+        /* Error callback */
+        XPD_SAFE_CALLBACK(XPD_FLASH_Callbacks.Error,);
+    }
+
+    /* Check FLASH End of Operation flag  */
+    if (XPD_FLASH_GetFlag(EOP) != 0)
+    {
+        uint32_t operation = FLASH_GETOPERATION();
+
+        /* Clear FLASH End of Operation pending bit */
+        XPD_FLASH_ClearFlag(EOP);
+
+        /* If the operation completed, disable its control bit */
+        CLEAR_BIT(FLASH->CR.w, operation);
+
+        if ((operation & FLASH_OPERATION_ERASE_BLOCK) != 0)
+        {
+            uint32_t blocksize;
+            (void) flash_getSector((uint32_t)hflash->Address, &blocksize);
+            blocksize >>= 10;
+
+            if (hflash->Length > blocksize)
+            {
+                /* Continue with erasing consecutive sectors */
+                hflash->Address += blocksize << 10;
+                hflash->Length  -= blocksize;
+                flash_blockErase();
+            }
+            else
+            {
+                XPD_FLASH_ResetCaches();
+
+                /* provide completion callback */
+                XPD_SAFE_CALLBACK(XPD_FLASH_Callbacks.EraseComplete,);
+            }
+        }
+        else if ((operation & FLASH_CR_MERALL) != 0)
+        {
+            XPD_FLASH_ResetCaches();
+
+            /* provide completion callback */
+            XPD_SAFE_CALLBACK(XPD_FLASH_Callbacks.EraseComplete,);
+        }
+        else if ((operation & FLASH_OPERATION_PROGRAM) != 0)
+        {
+            flash_unitAdvance();
+
+            /* Check if there are still data to program */
+            if (hflash->Length > 0)
+            {
+                flash_unitProgram();
+            }
+            else
+            {
+                /* provide completion callback */
+                XPD_SAFE_CALLBACK(XPD_FLASH_Callbacks.ProgramComplete,);
+            }
+        }
+    }
+
+    /* No more pending operations, disable further interrupts */
+    if (FLASH_GETOPERATION() == FLASH_OPERATION_NONE)
+    {
+        CLEAR_BIT(FLASH->CR.w, FLASH_CR_EOPIE | FLASH_CR_ERRIE);
+
+        /* Wake up the waiting task */
+        XPD_OS_SIGNAL(hflash->Signal);
+    }
+
+    XPD_PROFILE_END();
+}
+
+/**
+ * @brief Provides the errors which have occurred during the last operation.
+ * @return The occurred errors
+ */
+FLASH_ErrorType XPD_FLASH_GetError(void)
+{
+    return hflash->Errors;
+}
+
+#ifdef FLASH_OPTCR_BFB2
+/**
+ * @brief Determines which physical flash bank is mapped to the flash base address,
+ *        i.e. which bank the device is running from.
+ * @return The active memory bank [1 .. 2]
+ */
+uint8_t XPD_FLASH_GetActiveBank(void)
+{
+    return FLASH_BANKS_SWAPPED() ? 2 : 1;
+}
+
+/**
+ * @brief Swaps the flash banks for the next boot by toggling the dual bank boot option,
+ *        then resets the device.
+ * @note  The new image is programmed to @ref FLASH_INACTIVE_BANK_ADDRESS while the application
+ *        keeps running from the active bank, and it should be verified (e.g. by
+ *        @ref XPD_CRC_Calculate) before the swap, as the device boots from it afterwards.
+ * @note  The second bank is booted through the system memory boot loader,
+ *        which only selects it if it contains a valid stack pointer.
+ * @return BUSY     if another operation is already ongoing,
+ *         ERROR    if the option programming failed,
+ *         TIMEOUT  if timed out,
+ *         otherwise the function doesn't return
+ */
+XPD_ReturnType XPD_FLASH_BankSwap(void)
+{
+    /* Wait for last operation to be completed */
+    XPD_ReturnType result = XPD_FLASH_PollStatus(FLASH_TIMEOUT_MS);
+
+    if (result == XPD_OK)
+    {
+        if (FLASH_REG_BIT(OPTCR,OPTLOCK) != 0)
+        {
+            /* Authorize the option bytes access */
+            FLASH->OPTKEYR = FLASH_OPTKEY1;
+            FLASH->OPTKEYR = FLASH_OPTKEY2;
+        }
+
+        /* Boot from the currently inactive bank */
+        FLASH_REG_BIT(OPTCR,BFB2) = !FLASH_BANKS_SWAPPED();
+
+        /* Program the option bytes */
+        FLASH_REG_BIT(OPTCR,OPTSTRT) = 1;
+
+        result = XPD_FLASH_PollStatus(FLASH_TIMEOUT_MS);
+
+        FLASH_REG_BIT(OPTCR,OPTLOCK) = 1;
+
+        if (result == XPD_OK)
+        {
+            /* The new options are loaded after reset */
+            NVIC_SystemReset();
+        }
+    }
+
+    return result;
+}
+#endif
+
+/** @} */
+
+XPD_FLASH_CallbacksType XPD_FLASH_Callbacks = { NULL, NULL, NULL };
+
+/** @} */
+
+#endif /* USE_XPD_FLASH */
+
+/** @addtogroup FLASH
+ * @{ */
+
+/** @addtogroup FLASH_Exported_Functions
+ * @{ */
+
+/**
+ * @brief Determines the minimal flash access latency for the HCLK frequency.
+ * @param HCLK_Frequency: the target AHB clock frequency [Hz]
+ * @return The minimal number of flash wait states
+ */
+uint8_t XPD_FLASH_GetMinLatency(uint32_t HCLK_Frequency)
+{
+    uint8_t latency = 0;
+
+    if (HCLK_Frequency > FLASH_WAITSTATE_FREQ)
+    {
+        latency = (HCLK_Frequency - 1) / FLASH_WAITSTATE_FREQ;
+    }
+    return latency;
+}
+
+/**
+ * @brief Resets the enabled flash caches, as they might contain outdated flash data.
+ */
+void XPD_FLASH_ResetCaches(void)
+{
+    if (FLASH_REG_BIT(ACR,ICEN) != 0)
+    {
+        FLASH_REG_BIT(ACR,ICEN)  = 0;
+        FLASH_REG_BIT(ACR,ICRST) = 1;
+        FLASH_REG_BIT(ACR,ICRST) = 0;
+        FLASH_REG_BIT(ACR,ICEN)  = 1;
+    }
+    if (FLASH_REG_BIT(ACR,DCEN) != 0)
+    {
+        FLASH_REG_BIT(ACR,DCEN)  = 0;
+        FLASH_REG_BIT(ACR,DCRST) = 1;
+        FLASH_REG_BIT(ACR,DCRST) = 0;
+        FLASH_REG_BIT(ACR,DCEN)  = 1;
+    }
+}
+
+/**
+ * @brief Sets the new state for the flash accelerator: the prefetch buffer,
+ *        the instruction and the data caches. The caches are reset before enabling.
+ * @param NewState: the new state
+ */
+void XPD_FLASH_AcceleratorCtrl(FunctionalState NewState)
+{
+    FLASH_REG_BIT(ACR,ICEN) = 0;
+    FLASH_REG_BIT(ACR,DCEN) = 0;
+
+    if (NewState != DISABLE)
+    {
+        FLASH_REG_BIT(ACR,ICRST) = 1;
+        FLASH_REG_BIT(ACR,ICRST) = 0;
+        FLASH_REG_BIT(ACR,DCRST) = 1;
+        FLASH_REG_BIT(ACR,DCRST) = 0;
+
+        FLASH_REG_BIT(ACR,ICEN) = 1;
+        FLASH_REG_BIT(ACR,DCEN) = 1;
+    }
+    FLASH_REG_BIT(ACR,PRFTEN) = NewState;
+}
+
+/** @} */
 
 /** @} */
@@ -90,6 +90,41 @@ static const XPD_CtrlFnType gpio_clockCtrl[] = {
 #endif
 };
 
+/* Extends each bit of the pin mask to the 2 bit wide pin fields */
+static uint32_t gpio_pinMask2(uint32_t Pins)
+{
+    Pins &= 0xFFFF;
+    Pins = (Pins | (Pins << 8)) & 0x00FF00FF;
+    Pins = (Pins | (Pins << 4)) & 0x0F0F0F0F;
+    Pins = (Pins | (Pins << 2)) & 0x33333333;
+    Pins = (Pins | (Pins << 1)) & 0x55555555;
+    return Pins * 0x3;
+}
+
+/* Extends each bit of the pin mask byte to the 4 bit wide pin fields */
+static uint32_t gpio_pinMask4(uint32_t Pins)
+{
+    Pins &= 0xFF;
+    Pins = (Pins | (Pins << 12)) & 0x000F000F;
+    Pins = (Pins | (Pins << 6))  & 0x03030303;
+    Pins = (Pins | (Pins << 3))  & 0x11111111;
+    return Pins * 0xF;
+}
+
+#ifdef PWR_CR3_APC
+/* Sets the pull direction of a pin in power down */
+static void gpio_powerDownPullConfig(GPIO_TypeDef * GPIOx, uint32_t Pin, GPIO_PullType Pull)
+{
+#ifdef PWR_BB
+    pwr_pullPinConfig[GPIO_PORT_OFFSET(GPIOx)].PUC[Pin] = Pull;
+    pwr_pullPinConfig[GPIO_PORT_OFFSET(GPIOx)].PDC[Pin] = Pull >> 1;
+#else
+    MODIFY_REG(pwr_pullConfig[GPIO_PORT_OFFSET(GPIOx)].PUCR, 1 << Pin, ((uint32_t)Pull & 1) << Pin);
+    MODIFY_REG(pwr_pullConfig[GPIO_PORT_OFFSET(GPIOx)].PDCR, 1 << Pin, ((uint32_t)Pull >> 1) << Pin);
+#endif
+}
+#endif
+
 /** @defgroup GPIO
  * @{ */
 
@@ -226,6 +261,39 @@ void XPD_GPIO_InitPort(GPIO_TypeDef * GPIOx, const GPIO_InitType * Config)
     /* EXTI mode configuration is left out */
 }
 
+/**
+ * @brief Initializes the selected pins of a GPIO port with precomputed register contents.
+ *        Each configuration register is updated by a single write.
+ * @param Config: pointer to the port register contents, see @ref GPIO_PORT_CONFIG
+ */
+void XPD_GPIO_InitPortConfig(const GPIO_PortConfigType * Config)
+{
+    GPIO_TypeDef * GPIOx = Config->GPIOx;
+    uint32_t mask = gpio_pinMask2(Config->Pins);
+
+    /* enable GPIO clock */
+    gpio_clockCtrl[GPIO_PORT_OFFSET(GPIOx)](ENABLE);
+
+    /* alternate mapping before the mode, to avoid glitches on the pins */
+    MODIFY_REG(GPIOx->AFR[0], gpio_pinMask4(Config->Pins),      Config->AFR[0]);
+    MODIFY_REG(GPIOx->AFR[1], gpio_pinMask4(Config->Pins >> 8), Config->AFR[1]);
+
+    /* output stage configuration */
+    MODIFY_REG(GPIOx->OSPEEDR, mask, Config->OSPEEDR);
+    MODIFY_REG(GPIOx->OTYPER, Config->Pins, Config->OTYPER);
+
+    /* pull resistors */
+    MODIFY_REG(GPIOx->PUPDR, mask, Config->PUPDR);
+
+    /* IO mode */
+    MODIFY_REG(GPIOx->MODER, mask, Config->MODER);
+
+#ifdef GPIO_ASCR_ASC0
+    /* ADC connection */
+    MODIFY_REG(GPIOx->ASCR, Config->Pins, Config->ASCR);
+#endif
+}
+
 /** @} */
 
 /** @defgroup GPIO_Exported_Functions_Pin GPIO Pin Handling Functions
@@ -251,13 +319,7 @@ void XPD_GPIO_InitPin(GPIO_TypeDef * GPIOx, uint8_t Pin, const GPIO_InitType * C
 
 #ifdef PWR_CR3_APC
     /* configure pull direction in power down */
-#ifdef PWR_BB
-    pwr_pullPinConfig[GPIO_PORT_OFFSET(GPIOx)].PUC[Pin] = Config->PowerDownPull;
-    pwr_pullPinConfig[GPIO_PORT_OFFSET(GPIOx)].PDC[Pin] = Config->PowerDownPull >> 1;
-#else
-    MODIFY_REG(pwr_pullConfig[GPIO_PORT_OFFSET(GPIOx)].PUCR, 1 << Pin, (uin32_t)Config->PowerDownPull << Pin);
-    MODIFY_REG(pwr_pullConfig[GPIO_PORT_OFFSET(GPIOx)].PDCR, 1 << Pin, ((uin32_t)Config->PowerDownPull >> 1) << Pin);
-#endif
+    gpio_powerDownPullConfig(GPIOx, Pin, Config->PowerDownPull);
 #endif
 
     /* alternate mapping */
@@ -364,6 +426,103 @@ void XPD_GPIO_LockPin(GPIO_TypeDef * GPIOx, uint8_t Pin)
     }
 }
 
+/**
+ * @brief Initializes the GPIO pins listed in the pin map.
+ *        The register contents are collected for each consecutive group of entries
+ *        on the same port, and are applied with @ref XPD_GPIO_InitPortConfig.
+ * @param PinMap: pointer to the pin map array, ordered by port for best efficiency
+ * @param Count: number of entries in the pin map
+ */
+void XPD_GPIO_InitPinMap(const GPIO_PinMapType * PinMap, uint8_t Count)
+{
+    GPIO_PortConfigType port = { .GPIOx = NULL };
+
+    for (; Count > 0; Count--, PinMap++)
+    {
+        const GPIO_InitType * config = PinMap->Config;
+        uint32_t pin = PinMap->Pin;
+
+        /* apply collected configuration when the port changes */
+        if (PinMap->GPIOx != port.GPIOx)
+        {
+            if (port.GPIOx != NULL)
+            {
+                XPD_GPIO_InitPortConfig(&port);
+            }
+            port = (GPIO_PortConfigType){ .GPIOx = PinMap->GPIOx };
+        }
+
+        port.Pins  |= 1 << pin;
+        port.MODER |= ((uint32_t)config->Mode & 3) << (pin * 2);
+        port.PUPDR |= (uint32_t)config->Pull << (pin * 2);
+
+        if (config->Mode == GPIO_MODE_ALTERNATE)
+        {
+            port.AFR[pin >> 3] |= (uint32_t)config->AlternateMap << ((pin & 0x7) * 4);
+        }
+
+        if (    (config->Mode == GPIO_MODE_OUTPUT)
+             || (config->Mode == GPIO_MODE_ALTERNATE))
+        {
+            port.OSPEEDR |= (uint32_t)config->Output.Speed << (pin * 2);
+            port.OTYPER  |= (uint32_t)config->Output.Type << pin;
+        }
+
+#ifdef GPIO_ASCR_ASC0
+        port.ASCR |= (uint32_t)(config->AlternateMap >> 4) << pin;
+#endif
+
+#ifdef PWR_CR3_APC
+        gpio_powerDownPullConfig(PinMap->GPIOx, pin, config->PowerDownPull);
+#endif
+
+        /* EXTI configuration */
+        if (config->Mode == GPIO_MODE_EXTI)
+        {
+            uint32_t shifter = (pin & 0x03) * 4;
+
+            MODIFY_REG(SYSCFG->EXTICR[pin >> 2], ((uint32_t) 0x0F) << shifter, GPIO_PORT_OFFSET(PinMap->GPIOx) << shifter);
+
+            XPD_EXTI_Init(pin, &config->ExtI);
+        }
+    }
+
+    if (port.GPIOx != NULL)
+    {
+        XPD_GPIO_InitPortConfig(&port);
+    }
+}
+
+/** @} */
+
+/** @defgroup GPIO_Exported_Functions_Mode GPIO Pin Mode Switching Functions
+ *  @brief    Fast mode switching of initialized pins, e.g. for bidirectional bit-banged buses
+ * @{
+ */
+
+/**
+ * @brief Calculates the mode switching token of pins of a port in run time.
+ * @param Token: pointer to the mode switching token to set up
+ * @param Pins: bit mask of the switched pins of the port
+ * @param Mode: the new mode of the pins (EXTI mode is not supported)
+ */
+void XPD_GPIO_InitModeToken(GPIO_ModeTokenType * Token, uint16_t Pins, GPIO_ModeType Mode)
+{
+    uint32_t fields = 0;
+    uint8_t pin;
+
+    for (pin = 0; Pins != 0; pin++, Pins >>= 1)
+    {
+        if ((Pins & 1) != 0)
+        {
+            fields |= 1 << (pin * 2);
+        }
+    }
+
+    Token->Mask  = fields * 3;
+    Token->MODER = fields * ((uint32_t)Mode & 3);
+}
+
 /** @} */
 
 /** @} */
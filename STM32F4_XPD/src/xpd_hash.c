@@ -0,0 +1,336 @@
+/**
+  ******************************************************************************
+  * @file    xpd_hash.c
+  * @author  Benedek Kupper
+  * @version V0.1
+  * @date    2018-01-20
+  * @brief   STM32 eXtensible Peripheral Drivers Hash Processor Module
+  *
+  *  This file is part of STM32_XPD.
+  *
+  *  STM32_XPD is free software: you can redistribute it and/or modify
+  *  it under the terms of the GNU General Public License as published by
+  *  the Free Software Foundation, either version 3 of the License, or
+  *  (at your option) any later version.
+  *
+  *  STM32_XPD is distributed in the hope that it will be useful,
+  *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with STM32_XPD.  If not, see <http://www.gnu.org/licenses/>.
+  */
+#include "xpd_hash.h"
+#include "xpd_utils.h"
+
+#if defined(USE_XPD_HASH) && defined(HASH)
+
+/** @addtogroup HASH
+ * @{ */
+
+#define HASH_TIMEOUT            10
+
+/* The data is byte swapped, so the byte streams are processed in memory order */
+#define HASH_CR_DATATYPE_BYTE   HASH_CR_DATATYPE_1
+
+/* Keys longer than a block are hashed first */
+#define HASH_BLOCK_SIZE         64
+
+/* Feeds a byte stream to the processor, the incomplete last word is kept pending */
+static void hash_feed(HASH_HandleType * hhash, const uint8_t * Data, uint32_t Length)
+{
+    /* Complete the pending word first */
+    while ((Length > 0) && (hhash->Context.PendingCount > 0))
+    {
+        hhash->Context.Pending |= (uint32_t)*(Data++) << (8 * hhash->Context.PendingCount);
+        Length--;
+
+        if (++hhash->Context.PendingCount == sizeof(uint32_t))
+        {
+            hhash->Inst->DIN = hhash->Context.Pending;
+            hhash->Context.Pending = 0;
+            hhash->Context.PendingCount = 0;
+        }
+    }
+
+    /* Whole words, the memory order is kept by the little endian load */
+    if (((uint32_t)Data & (sizeof(uint32_t) - 1)) == 0)
+    {
+        for (; Length >= sizeof(uint32_t); Length -= sizeof(uint32_t), Data += sizeof(uint32_t))
+        {
+            hhash->Inst->DIN = *(const uint32_t*)Data;
+        }
+    }
+    else
+    {
+        for (; Length >= sizeof(uint32_t); Length -= sizeof(uint32_t), Data += sizeof(uint32_t))
+        {
+            hhash->Inst->DIN = (uint32_t)Data[0]         | ((uint32_t)Data[1] << 8)
+                             | ((uint32_t)Data[2] << 16) | ((uint32_t)Data[3] << 24);
+        }
+    }
+
+    /* Keep the remaining bytes pending */
+    for (; Length > 0; Length--)
+    {
+        hhash->Context.Pending |= (uint32_t)*(Data++) << (8 * hhash->Context.PendingCount);
+        hhash->Context.PendingCount++;
+    }
+}
+
+/* Writes the pending word and starts the digest calculation of the fed data */
+static void hash_calculate(HASH_HandleType * hhash)
+{
+    uint32_t validBits = 8 * hhash->Context.PendingCount;
+
+    if (validBits > 0)
+    {
+        hhash->Inst->DIN = hhash->Context.Pending;
+    }
+    hhash->Context.Pending = 0;
+    hhash->Context.PendingCount = 0;
+
+    hhash->Inst->STR.w = validBits | HASH_STR_DCAL;
+}
+
+static void hash_dmaRedirect(void * hdma)
+{
+    HASH_HandleType * hhash = (HASH_HandleType*) ((DMA_HandleType*) hdma)->Owner;
+
+    hhash->Inst->CR.w &= ~HASH_CR_DMAE;
+
+    XPD_SAFE_CALLBACK(hhash->Callbacks.Complete, hhash);
+}
+
+#ifdef USE_XPD_DMA_ERROR_DETECT
+static void hash_dmaErrorRedirect(void * hdma)
+{
+    HASH_HandleType * hhash = (HASH_HandleType*) ((DMA_HandleType*) hdma)->Owner;
+
+    hhash->Inst->CR.w &= ~HASH_CR_DMAE;
+
+    XPD_STATS_ERROR(hhash, 1);
+
+    XPD_SAFE_CALLBACK(hhash->Callbacks.Complete, hhash);
+}
+#endif
+
+/** @defgroup HASH_Exported_Functions HASH Exported Functions
+ * @{ */
+
+/**
+ * @brief Initializes the HASH peripheral and its DMA stream.
+ * @note  The DMA stream has to be initialized by the DepInit callback
+ *        with word data alignment in memory to peripheral direction.
+ * @param hhash: pointer to the HASH handle structure
+ */
+void XPD_HASH_Init(HASH_HandleType * hhash)
+{
+    /* enable clock */
+    XPD_SAFE_CALLBACK(hhash->ClockCtrl, ENABLE);
+
+    hhash->Inst->CR.w = 0;
+    hhash->Inst->IMR.w = 0;
+
+    /* Dependencies initialization */
+    XPD_SAFE_CALLBACK(hhash->Callbacks.DepInit, hhash);
+
+    if (hhash->DMA.In != NULL)
+    {
+        hhash->DMA.In->Owner = hhash;
+        hhash->DMA.In->Callbacks.Complete     = hash_dmaRedirect;
+        hhash->DMA.In->Callbacks.HalfComplete = NULL;
+#ifdef USE_XPD_DMA_ERROR_DETECT
+        hhash->DMA.In->Callbacks.Error        = hash_dmaErrorRedirect;
+#endif
+    }
+}
+
+/**
+ * @brief Restores the HASH peripheral to its default inactive state.
+ * @param hhash: pointer to the HASH handle structure
+ */
+void XPD_HASH_Deinit(HASH_HandleType * hhash)
+{
+    if (hhash->DMA.In != NULL)
+    {
+        XPD_DMA_Stop_IT(hhash->DMA.In);
+    }
+    hhash->Inst->CR.w = 0;
+
+    /* Deinitialize peripheral dependencies */
+    XPD_SAFE_CALLBACK(hhash->Callbacks.DepDeinit, hhash);
+
+    /* disable clock */
+    XPD_SAFE_CALLBACK(hhash->ClockCtrl, DISABLE);
+}
+
+/**
+ * @brief Starts a new digest calculation. When a key is provided, the HMAC
+ *        of the message is calculated, and the inner key is processed right away.
+ * @param hhash: pointer to the HASH handle structure
+ * @param Algorithm: the hash algorithm to use
+ * @param Key: the HMAC key (NULL for plain hash)
+ * @param KeyLength: the HMAC key length in bytes
+ * @return TIMEOUT if the key processing doesn't finish in time, OK otherwise
+ */
+XPD_ReturnType XPD_HASH_Start(HASH_HandleType * hhash, HASH_AlgorithmType Algorithm,
+        const uint8_t * Key, uint32_t KeyLength)
+{
+    XPD_ReturnType result = XPD_OK;
+    uint32_t control = (uint32_t)Algorithm | HASH_CR_DATATYPE_BYTE;
+
+    switch (Algorithm)
+    {
+        case HASH_MD5:
+            hhash->Context.DigestSize = 16;
+            break;
+#ifdef HASH_CR_ALGO_1
+        case HASH_SHA224:
+            hhash->Context.DigestSize = 28;
+            break;
+        case HASH_SHA256:
+            hhash->Context.DigestSize = 32;
+            break;
+#endif
+        default:
+            hhash->Context.DigestSize = 20;
+            break;
+    }
+
+    hhash->Context.Key = Key;
+    hhash->Context.KeyLength = KeyLength;
+    hhash->Context.Pending = 0;
+    hhash->Context.PendingCount = 0;
+
+    if (Key != NULL)
+    {
+        control |= HASH_CR_MODE;
+        if (KeyLength > HASH_BLOCK_SIZE)
+        {
+            control |= HASH_CR_LKEY;
+        }
+    }
+
+    hhash->Inst->CR.w = control;
+    hhash->Inst->CR.w = control | HASH_CR_INIT;
+
+    /* The inner key is processed before the message */
+    if (Key != NULL)
+    {
+        uint32_t timeout = HASH_TIMEOUT;
+
+        hash_feed(hhash, Key, KeyLength);
+        hash_calculate(hhash);
+
+        result = XPD_WaitForMatch(&hhash->Inst->SR.w, HASH_SR_BUSY, 0, &timeout);
+    }
+    return result;
+}
+
+/**
+ * @brief Feeds message data to the processor by the CPU.
+ * @note  The data can be split to any number of updates of any length.
+ * @param hhash: pointer to the HASH handle structure
+ * @param Data: pointer to the message data
+ * @param Length: the data length in bytes
+ */
+void XPD_HASH_Update(HASH_HandleType * hhash, const void * Data, uint32_t Length)
+{
+    hash_feed(hhash, Data, Length);
+
+    XPD_STATS_ADD(hhash, Bytes, Length);
+}
+
+/**
+ * @brief Starts feeding message data to the processor by DMA.
+ *        The Complete callback is called when the DMA transfer is finished,
+ *        then the message can be continued or finished.
+ * @note  Only whole words can be transferred by DMA, which requires that
+ *        all previous updates were also made of whole words.
+ * @param hhash: pointer to the HASH handle structure
+ * @param Data: pointer to the word aligned message data
+ * @param Length: the data length in bytes, multiple of 4
+ * @return ERROR if the data cannot be transferred by DMA, BUSY if the DMA is busy, OK if started
+ */
+XPD_ReturnType XPD_HASH_Update_DMA(HASH_HandleType * hhash, const void * Data, uint32_t Length)
+{
+    XPD_ReturnType result;
+    uint32_t words = Length / sizeof(uint32_t);
+
+    if ((hhash->Context.PendingCount > 0) || ((Length % sizeof(uint32_t)) != 0) || (words > 0xFFFF))
+    {
+        return XPD_ERROR;
+    }
+
+    result = XPD_DMA_Start_IT(hhash->DMA.In, (void*)&hhash->Inst->DIN, (void*)Data, words);
+
+    if (result == XPD_OK)
+    {
+        /* The digest calculation is started by the Finish call */
+        hhash->Inst->CR.w |= HASH_CR_MDMAT | HASH_CR_DMAE;
+
+        XPD_STATS_ADD(hhash, Bytes, Length);
+    }
+    return result;
+}
+
+/**
+ * @brief Finishes the message and reads the calculated digest.
+ *        For HMAC the outer key is processed before the digest is read.
+ * @param hhash: pointer to the HASH handle structure
+ * @param Digest: pointer to the digest output (16 to 32 bytes depending on the algorithm)
+ * @return TIMEOUT if the calculation doesn't finish in time, OK otherwise
+ */
+XPD_ReturnType XPD_HASH_Finish(HASH_HandleType * hhash, uint8_t * Digest)
+{
+    XPD_ReturnType result = XPD_OK;
+    uint32_t timeout = HASH_TIMEOUT;
+    uint32_t i;
+
+    hhash->Inst->CR.w &= ~HASH_CR_MDMAT;
+
+    hash_calculate(hhash);
+
+    if (hhash->Context.Key != NULL)
+    {
+        /* The outer key is fed when the message digest is done */
+        result = XPD_WaitForMatch(&hhash->Inst->SR.w, HASH_SR_BUSY, 0, &timeout);
+
+        if (result == XPD_OK)
+        {
+            hash_feed(hhash, hhash->Context.Key, hhash->Context.KeyLength);
+            hash_calculate(hhash);
+        }
+    }
+
+    if (result == XPD_OK)
+    {
+        result = XPD_WaitForMatch(&hhash->Inst->SR.w, HASH_SR_DCIS, HASH_SR_DCIS, &timeout);
+    }
+
+    for (i = 0; (i < (hhash->Context.DigestSize / sizeof(uint32_t))) && (result == XPD_OK); i++)
+    {
+        uint32_t word = (i < 5) ? hhash->Inst->HR[i] : HASH_DIGEST->HR[i];
+
+        /* The digest words are big endian */
+        Digest[0] = word >> 24;
+        Digest[1] = word >> 16;
+        Digest[2] = word >> 8;
+        Digest[3] = word;
+        Digest += sizeof(uint32_t);
+    }
+
+    if (result == XPD_OK)
+    {
+        XPD_STATS_ADD(hhash, Transfers, 1);
+    }
+    return result;
+}
+
+/** @} */
+
+/** @} */
+
+#endif /* USE_XPD_HASH */
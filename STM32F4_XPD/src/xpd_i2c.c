@@ -0,0 +1,730 @@
+/**
+  ******************************************************************************
+  * @file    xpd_i2c.c
+  * @author  Benedek Kupper
+  * @version V0.1
+  * @date    2018-01-20
+  * @brief   STM32 eXtensible Peripheral Drivers I2C Module
+  *
+  *  This file is part of STM32_XPD.
+  *
+  *  STM32_XPD is free software: you can redistribute it and/or modify
+  *  it under the terms of the GNU General Public License as published by
+  *  the Free Software Foundation, either version 3 of the License, or
+  *  (at your option) any later version.
+  *
+  *  STM32_XPD is distributed in the hope that it will be useful,
+  *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with STM32_XPD.  If not, see <http://www.gnu.org/licenses/>.
+  */
+#include "xpd_i2c.h"
+#include "xpd_utils.h"
+
+#if defined(USE_XPD_I2C)
+
+/** @addtogroup I2C
+ * @{ */
+
+#define I2C_PHASE_REGISTER      0   /* The register address is transmitted */
+#define I2C_PHASE_DATA          1   /* The data bytes are transferred */
+
+#define I2C_STANDARD_MODE_FREQ  100000
+#define I2C_FAST_MODE_FREQ      400000
+
+#define I2C_STOP_TIMEOUT        1
+
+#define I2C_ERROR_FLAGS         (I2C_SR1_AF | I2C_SR1_BERR | I2C_SR1_ARLO | I2C_SR1_OVR)
+
+/* Calculates the bus timing for the current peripheral clock */
+static XPD_ReturnType i2c_setTiming(I2C_HandleType * hi2c)
+{
+    XPD_ReturnType result = XPD_ERROR;
+    uint32_t pclk = XPD_I2C_GetClockFreq(hi2c);
+    uint32_t mhz  = pclk / 1000000;
+    uint32_t freq = hi2c->BusFreq;
+
+    /* The peripheral clock has to be between 2 and 50 MHz */
+    if ((freq > 0) && (freq <= I2C_FAST_MODE_FREQ) && (mhz >= 2) && (mhz <= 50))
+    {
+        hi2c->Inst->CR2.b.FREQ = mhz;
+
+        if (freq <= I2C_STANDARD_MODE_FREQ)
+        {
+            /* Symmetric SCL levels */
+            uint32_t ccr = (pclk + (2 * freq) - 1) / (2 * freq);
+
+            if (ccr < 4)
+            {
+                ccr = 4;
+            }
+            if (ccr <= (I2C_CCR_CCR >> I2C_CCR_CCR_Pos))
+            {
+                hi2c->Inst->CCR.w   = ccr;
+
+                /* 1000 ns maximal rise time */
+                hi2c->Inst->TRISE.w = mhz + 1;
+
+                result = XPD_OK;
+            }
+        }
+        else
+        {
+            /* Tlow/Thigh = 2 or 16/9, whichever gets closer to the requested frequency */
+            uint32_t ccr  = (pclk + (3 * freq) - 1) / (3 * freq);
+            uint32_t ccr9 = (pclk + (25 * freq) - 1) / (25 * freq);
+
+            if ((pclk / (25 * ccr9)) > (pclk / (3 * ccr)))
+            {
+                hi2c->Inst->CCR.w = I2C_CCR_FS | I2C_CCR_DUTY | ccr9;
+            }
+            else
+            {
+                hi2c->Inst->CCR.w = I2C_CCR_FS | ccr;
+            }
+
+            /* 300 ns maximal rise time */
+            hi2c->Inst->TRISE.w = ((mhz * 300) / 1000) + 1;
+
+            result = XPD_OK;
+        }
+    }
+    return result;
+}
+
+static void i2c_queueFinish(I2C_HandleType * hi2c);
+
+/* Ends the bus transfer of the transaction: with repeated START if another
+ * transaction is queued, otherwise with STOP */
+static void i2c_busEnd(I2C_HandleType * hi2c)
+{
+    if ((hi2c->Queue.Head->Next != NULL) && (hi2c->Errors == I2C_ERROR_NONE))
+    {
+        I2C_REG_BIT(hi2c, CR1, START) = 1;
+        hi2c->Restart = 1;
+    }
+    else
+    {
+        I2C_REG_BIT(hi2c, CR1, STOP) = 1;
+    }
+}
+
+static void i2c_dmaTransmitRedirect(void * hdma)
+{
+    I2C_HandleType * hi2c = (I2C_HandleType*) ((DMA_HandleType*) hdma)->Owner;
+
+    /* Disable DMA Request, the end of the transfer is signalled by BTF */
+    I2C_REG_BIT(hi2c, CR2, DMAEN) = 0;
+    hi2c->Pending = 0;
+}
+
+static void i2c_dmaReceiveRedirect(void * hdma)
+{
+    I2C_HandleType * hi2c = (I2C_HandleType*) ((DMA_HandleType*) hdma)->Owner;
+
+    /* The last byte is already not acknowledged */
+    CLEAR_BIT(hi2c->Inst->CR2.w, I2C_CR2_DMAEN | I2C_CR2_LAST);
+    hi2c->Pending = 0;
+
+    i2c_busEnd(hi2c);
+
+    i2c_queueFinish(hi2c);
+}
+
+#ifdef USE_XPD_DMA_ERROR_DETECT
+static void i2c_dmaErrorRedirect(void * hdma)
+{
+    I2C_HandleType * hi2c = (I2C_HandleType*) ((DMA_HandleType*) hdma)->Owner;
+
+    hi2c->Errors |= I2C_ERROR_DMA;
+    XPD_STATS_ERROR(hi2c, I2C_ERROR_DMA);
+
+    /* Abort the bus transfer */
+    I2C_REG_BIT(hi2c, CR1, STOP) = 1;
+
+    i2c_queueFinish(hi2c);
+}
+#endif
+
+/* Starts the data transfer using DMA when available, returns 0 if it has to be interrupt driven */
+static uint32_t i2c_dmaStart(I2C_HandleType * hi2c, DMA_HandleType * hdma)
+{
+    I2C_TransactionType * transaction = hi2c->Queue.Head;
+    uint32_t started = 0;
+
+    if ((hdma != NULL) && (XPD_DMA_Start_IT(hdma, (void*)&hi2c->Inst->DR, transaction->Data,
+            transaction->Length) == XPD_OK))
+    {
+        /* Set the callback owner */
+        hdma->Owner = hi2c;
+
+        /* Set the DMA transfer callbacks */
+        hdma->Callbacks.Complete     = (hi2c->Read != 0) ?
+                i2c_dmaReceiveRedirect : i2c_dmaTransmitRedirect;
+#ifdef USE_XPD_DMA_ERROR_DETECT
+        hdma->Callbacks.Error        = i2c_dmaErrorRedirect;
+#endif
+        hi2c->Pending = 1;
+        started = 1;
+    }
+    return started;
+}
+
+/* Sets up the transmission of the written data */
+static void i2c_transmitStart(I2C_HandleType * hi2c)
+{
+    I2C_TransactionType * transaction = hi2c->Queue.Head;
+
+    hi2c->Phase = I2C_PHASE_DATA;
+
+    if (i2c_dmaStart(hi2c, hi2c->DMA.Transmit) != 0)
+    {
+        I2C_REG_BIT(hi2c, CR2, ITBUFEN) = 0;
+        I2C_REG_BIT(hi2c, CR2, DMAEN)   = 1;
+    }
+    else
+    {
+        /* Interrupt driven transmission */
+        hi2c->Stream.buffer = transaction->Data;
+        hi2c->Stream.length = transaction->Length;
+        hi2c->Stream.size   = 1;
+
+        I2C_REG_BIT(hi2c, CR2, ITBUFEN) = 1;
+    }
+}
+
+/* Sets up the data transfer when the slave acknowledged its address */
+static void i2c_addressed(I2C_HandleType * hi2c)
+{
+    I2C_TransactionType * transaction = hi2c->Queue.Head;
+    uint32_t sr2;
+
+    if (hi2c->Read == 0)
+    {
+        if (hi2c->Phase == I2C_PHASE_REGISTER)
+        {
+            /* The register address is transmitted by interrupts */
+            I2C_REG_BIT(hi2c, CR2, ITBUFEN) = 1;
+        }
+        else if (transaction->Length > 0)
+        {
+            i2c_transmitStart(hi2c);
+        }
+        /* Clear ADDR flag */
+        sr2 = hi2c->Inst->SR2.w;
+
+        /* Only the address is transmitted */
+        if ((hi2c->Phase == I2C_PHASE_DATA) && (transaction->Length == 0))
+        {
+            i2c_busEnd(hi2c);
+
+            i2c_queueFinish(hi2c);
+        }
+    }
+    else
+    {
+        hi2c->Stream.buffer = transaction->Data;
+        hi2c->Stream.length = transaction->Length;
+        hi2c->Stream.size   = 1;
+
+        if (transaction->Length == 1)
+        {
+            /* The single byte is not acknowledged, the end condition is set in advance */
+            I2C_REG_BIT(hi2c, CR1, ACK) = 0;
+            sr2 = hi2c->Inst->SR2.w;
+
+            i2c_busEnd(hi2c);
+
+            I2C_REG_BIT(hi2c, CR2, ITBUFEN) = 1;
+        }
+        else if (i2c_dmaStart(hi2c, hi2c->DMA.Receive) != 0)
+        {
+            /* The last DMA transfer is not acknowledged */
+            I2C_REG_BIT(hi2c, CR1, ACK) = 1;
+            SET_BIT(hi2c->Inst->CR2.w, I2C_CR2_DMAEN | I2C_CR2_LAST);
+            sr2 = hi2c->Inst->SR2.w;
+        }
+        else
+        {
+            /* Interrupt driven reception */
+            I2C_REG_BIT(hi2c, CR1, ACK) = 1;
+            sr2 = hi2c->Inst->SR2.w;
+
+            I2C_REG_BIT(hi2c, CR2, ITBUFEN) = 1;
+        }
+    }
+    (void) sr2;
+}
+
+/* Starts the first queued transaction */
+static void i2c_queueStart(I2C_HandleType * hi2c)
+{
+    I2C_TransactionType * transaction = hi2c->Queue.Head;
+
+    hi2c->Errors  = I2C_ERROR_NONE;
+    hi2c->Pending = 0;
+
+    if (transaction->RegSize > 0)
+    {
+        uint32_t i;
+
+        /* The register address is transmitted MSB first */
+        for (i = 0; i < transaction->RegSize; i++)
+        {
+            hi2c->RegBuffer[i] = (uint8_t)(transaction->Register >> (8 * (transaction->RegSize - 1 - i)));
+        }
+        hi2c->Phase         = I2C_PHASE_REGISTER;
+        hi2c->Read          = 0;
+        hi2c->Stream.buffer = hi2c->RegBuffer;
+        hi2c->Stream.length = transaction->RegSize;
+        hi2c->Stream.size   = 1;
+    }
+    else
+    {
+        hi2c->Phase = I2C_PHASE_DATA;
+        hi2c->Read  = (uint8_t)transaction->Direction;
+    }
+
+    /* The repeated START is already requested by the previous transaction */
+    if (hi2c->Restart == 0)
+    {
+        uint32_t timeout = I2C_STOP_TIMEOUT;
+
+        /* Wait until the previous STOP condition is generated */
+        (void) XPD_WaitForMatch(&hi2c->Inst->CR1.w, I2C_CR1_STOP, 0, &timeout);
+
+        I2C_REG_BIT(hi2c, CR1, START) = 1;
+    }
+    hi2c->Restart = 0;
+}
+
+/* Finishes the ongoing transaction and starts the next queued one */
+static void i2c_queueFinish(I2C_HandleType * hi2c)
+{
+    I2C_TransactionType * transaction = hi2c->Queue.Head;
+
+    /* Stop the data transfer */
+    CLEAR_BIT(hi2c->Inst->CR2.w, I2C_CR2_ITBUFEN | I2C_CR2_DMAEN | I2C_CR2_LAST);
+    if (hi2c->Pending != 0)
+    {
+        XPD_DMA_Stop_IT((hi2c->Read != 0) ? hi2c->DMA.Receive : hi2c->DMA.Transmit);
+        hi2c->Pending = 0;
+    }
+
+    transaction->Errors = hi2c->Errors;
+    if (hi2c->Errors == I2C_ERROR_NONE)
+    {
+        XPD_STATS_ADD(hi2c, Bytes, transaction->Length);
+        XPD_STATS_ADD(hi2c, Transfers, 1);
+        transaction->Result = XPD_OK;
+    }
+    else
+    {
+        XPD_SAFE_CALLBACK(hi2c->Callbacks.Error, hi2c);
+        transaction->Result = XPD_ERROR;
+    }
+
+    XPD_ENTER_CRITICAL(hi2c);
+
+    /* Remove the finished transaction from the queue */
+    hi2c->Queue.Head = transaction->Next;
+    if (hi2c->Queue.Head == NULL)
+    {
+        hi2c->Queue.Tail = NULL;
+    }
+
+    XPD_EXIT_CRITICAL(hi2c);
+
+    /* Continue with the next transaction */
+    if (hi2c->Queue.Head != NULL)
+    {
+        i2c_queueStart(hi2c);
+    }
+
+    XPD_SAFE_CALLBACK(transaction->Complete, transaction);
+}
+
+#ifdef USE_XPD_OS
+/* Wakes up the task waiting for the finished transaction */
+static void i2c_blockingRedirect(void * transaction)
+{
+    XPD_OS_SIGNAL(((I2C_TransactionType*)transaction)->Signal);
+}
+#endif
+
+/** @defgroup I2C_Exported_Functions I2C Exported Functions
+ * @{ */
+
+/**
+ * @brief Initializes the I2C peripheral as bus master using the setup configuration.
+ * @note  The bus timing is calculated from the current I2C clock frequency.
+ *        The resulting serial clock frequency doesn't exceed the requested one.
+ * @param hi2c: pointer to the I2C handle structure
+ * @param Config: I2C setup configuration
+ * @return ERROR if the bus frequency cannot be set up, OK if success
+ */
+XPD_ReturnType XPD_I2C_Init(I2C_HandleType * hi2c, const I2C_InitType * Config)
+{
+    XPD_ReturnType result;
+
+    /* enable clock */
+    XPD_SAFE_CALLBACK(hi2c->ClockCtrl, ENABLE);
+
+    XPD_I2C_Disable(hi2c);
+
+    /* Reset the peripheral state */
+    I2C_REG_BIT(hi2c, CR1, SWRST) = 1;
+    I2C_REG_BIT(hi2c, CR1, SWRST) = 0;
+
+#ifdef I2C_FLTR_ANOFF
+    /* Noise filters configuration */
+    I2C_REG_BIT(hi2c, FLTR, ANOFF) = (Config->AnalogFilter == DISABLE) ? 1 : 0;
+    hi2c->Inst->FLTR.b.DNF         = Config->DigitalFilter;
+#endif
+
+    hi2c->BusFreq = Config->BusFreq;
+    result = i2c_setTiming(hi2c);
+
+    /* Master operation only, bit 14 has to be kept set */
+    hi2c->Inst->OAR1.w = 1 << 14;
+    hi2c->Inst->OAR2.w = 0;
+
+    /* The bus events are interrupt driven */
+    SET_BIT(hi2c->Inst->CR2.w, I2C_CR2_ITEVTEN | I2C_CR2_ITERREN);
+
+    /* Initialize handle variables */
+    hi2c->Queue.Head = hi2c->Queue.Tail = NULL;
+    hi2c->Pending    = 0;
+    hi2c->Restart    = 0;
+
+    /* Dependencies initialization */
+    XPD_SAFE_CALLBACK(hi2c->Callbacks.DepInit, hi2c);
+
+    XPD_I2C_Enable(hi2c);
+
+    return result;
+}
+
+/**
+ * @brief Restores the I2C peripheral to its default inactive state.
+ * @param hi2c: pointer to the I2C handle structure
+ * @return OK
+ */
+XPD_ReturnType XPD_I2C_Deinit(I2C_HandleType * hi2c)
+{
+    XPD_I2C_Disable(hi2c);
+
+    /* Deinitialize peripheral dependencies */
+    XPD_SAFE_CALLBACK(hi2c->Callbacks.DepDeinit, hi2c);
+
+    /* Disable clock */
+    XPD_SAFE_CALLBACK(hi2c->ClockCtrl, DISABLE);
+
+    return XPD_OK;
+}
+
+/**
+ * @brief Enables the I2C peripheral.
+ * @param hi2c: pointer to the I2C handle structure
+ */
+void XPD_I2C_Enable(I2C_HandleType * hi2c)
+{
+    I2C_REG_BIT(hi2c, CR1, PE) = 1;
+}
+
+/**
+ * @brief Disables the I2C peripheral.
+ * @param hi2c: pointer to the I2C handle structure
+ */
+void XPD_I2C_Disable(I2C_HandleType * hi2c)
+{
+    I2C_REG_BIT(hi2c, CR1, PE) = 0;
+}
+
+/**
+ * @brief Determines the current status of I2C peripheral.
+ * @param hi2c: pointer to the I2C handle structure
+ * @return BUSY if a transaction is queued or the bus is busy, OK if I2C is ready for new transfer
+ */
+XPD_ReturnType XPD_I2C_GetStatus(I2C_HandleType * hi2c)
+{
+    return ((hi2c->Queue.Head != NULL) || (I2C_REG_BIT(hi2c, SR2, BUSY) != 0)) ? XPD_BUSY : XPD_OK;
+}
+
+/**
+ * @brief Adds a transaction to the I2C bus queue. The queued transactions are performed
+ *        one after the other, each ended with a repeated START if another one is queued.
+ *        When the RegSize is set, the register address is transmitted first,
+ *        followed by the written data, or a repeated START and the read data.
+ *        The data is transferred by DMA if the handle has a DMA handle for the direction,
+ *        otherwise by interrupts. The Complete callback of the transaction is called when
+ *        its transfer is finished.
+ * @note  The transaction structure must remain valid until its Complete callback.
+ *        The I2C and DMA interrupts have to be configured with the same priority.
+ *        The interrupt driven reception requires the interrupt latency to stay below a byte time.
+ *        The queue can be used by multiple drivers if XPD_ENTER_CRITICAL provides mutual exclusion.
+ * @param hi2c: pointer to the I2C handle structure
+ * @param Transaction: pointer to the transaction to queue
+ * @return ERROR if the register address is too long or no data is to be read,
+ *         BUSY if the transaction is queued after others, otherwise OK
+ */
+XPD_ReturnType XPD_I2C_Queue_Submit(I2C_HandleType * hi2c, I2C_TransactionType * Transaction)
+{
+    XPD_ReturnType result = XPD_ERROR;
+    I2C_TransactionType * tail;
+
+    if ((Transaction->RegSize <= sizeof(hi2c->RegBuffer))
+            && ((Transaction->Direction == I2C_DIRECTION_WRITE) || (Transaction->Length > 0)))
+    {
+        Transaction->Next   = NULL;
+        Transaction->Result = XPD_BUSY;
+        Transaction->Errors = I2C_ERROR_NONE;
+
+        XPD_ENTER_CRITICAL(hi2c);
+
+        tail = hi2c->Queue.Tail;
+        if (tail != NULL)
+        {
+            tail->Next = Transaction;
+        }
+        else
+        {
+            hi2c->Queue.Head = Transaction;
+        }
+        hi2c->Queue.Tail = Transaction;
+
+#ifdef USE_XPD_STATISTICS
+        {
+            I2C_TransactionType * queued;
+            uint16_t depth = 0;
+
+            for (queued = hi2c->Queue.Head; queued != NULL; queued = queued->Next)
+            {
+                depth++;
+            }
+            XPD_STATS_MAX(hi2c, QueueHighWater, depth);
+        }
+#endif
+
+        XPD_EXIT_CRITICAL(hi2c);
+
+        /* The bus is idle, start the transaction now */
+        if (tail == NULL)
+        {
+            i2c_queueStart(hi2c);
+
+            result = XPD_OK;
+        }
+        else
+        {
+            result = XPD_BUSY;
+        }
+    }
+    return result;
+}
+
+#ifdef USE_XPD_OS
+/**
+ * @brief Performs a transaction through the I2C bus queue, blocking the calling task
+ *        until the transaction is finished.
+ * @note  The Complete callback of the transaction is used by this function.
+ *        If the function times out, the transaction remains queued, and its structure
+ *        must remain valid until its Result is no longer BUSY.
+ * @param hi2c: pointer to the I2C handle structure
+ * @param Transaction: pointer to the transaction to perform
+ * @param Timeout: available time for the queued and the own transfers in ms
+ * @return ERROR if the register address is too long or the transaction failed,
+ *         TIMEOUT if timed out, OK if the transaction is successful
+ */
+XPD_ReturnType XPD_I2C_Transfer_Blocking(I2C_HandleType * hi2c, I2C_TransactionType * Transaction,
+        uint32_t Timeout)
+{
+    XPD_ReturnType result;
+
+    Transaction->Complete = i2c_blockingRedirect;
+    XPD_OS_SignalInit(&Transaction->Signal);
+
+    result = XPD_I2C_Queue_Submit(hi2c, Transaction);
+
+    if (result != XPD_ERROR)
+    {
+        result = XPD_OS_SignalWait(&Transaction->Signal, &Timeout);
+        if (result == XPD_OK)
+        {
+            result = Transaction->Result;
+        }
+    }
+    return result;
+}
+#endif /* USE_XPD_OS */
+
+/**
+ * @brief I2C transfer event and error interrupt handler that drives the transaction queue.
+ * @note  It shall be called from both the event and the error interrupt of the peripheral.
+ * @param hi2c: pointer to the I2C handle structure
+ */
+void XPD_I2C_IRQHandler(I2C_HandleType * hi2c)
+{
+    XPD_PROFILE_BEGIN();
+    XPD_STATS_IRQ_BEGIN();
+
+    uint32_t cr2 = hi2c->Inst->CR2.w;
+    uint32_t sr1 = hi2c->Inst->SR1.w;
+
+    /* Transfer errors */
+    if ((sr1 & I2C_ERROR_FLAGS) != 0)
+    {
+        if ((sr1 & I2C_SR1_AF) != 0)
+        {
+            XPD_I2C_ClearFlag(hi2c, AF);
+
+            hi2c->Errors |= I2C_ERROR_NACK;
+            XPD_STATS_ERROR(hi2c, I2C_ERROR_NACK);
+        }
+        if ((sr1 & I2C_SR1_BERR) != 0)
+        {
+            XPD_I2C_ClearFlag(hi2c, BERR);
+
+            hi2c->Errors |= I2C_ERROR_BUS;
+            XPD_STATS_ERROR(hi2c, I2C_ERROR_BUS);
+        }
+        if ((sr1 & I2C_SR1_OVR) != 0)
+        {
+            XPD_I2C_ClearFlag(hi2c, OVR);
+
+            hi2c->Errors |= I2C_ERROR_OVERRUN;
+            XPD_STATS_ERROR(hi2c, I2C_ERROR_OVERRUN);
+        }
+
+        /* The bus is released by the hardware when the arbitration is lost */
+        if ((sr1 & I2C_SR1_ARLO) != 0)
+        {
+            XPD_I2C_ClearFlag(hi2c, ARLO);
+
+            hi2c->Errors |= I2C_ERROR_ARBITRATION;
+            XPD_STATS_ERROR(hi2c, I2C_ERROR_ARBITRATION);
+        }
+        else
+        {
+            I2C_REG_BIT(hi2c, CR1, STOP) = 1;
+        }
+
+        if (hi2c->Queue.Head != NULL)
+        {
+            i2c_queueFinish(hi2c);
+        }
+    }
+    else if (hi2c->Queue.Head == NULL)
+    {
+        /* No ongoing transaction */
+    }
+
+    /* Interrupt driven reception, the end condition is set after the second last byte */
+    else if (((sr1 & I2C_SR1_RXNE) != 0) && ((cr2 & I2C_CR2_ITBUFEN) != 0))
+    {
+        XPD_ReadToStream(&hi2c->Inst->DR, &hi2c->Stream);
+
+        if (hi2c->Stream.length == 1)
+        {
+            I2C_REG_BIT(hi2c, CR1, ACK) = 0;
+
+            i2c_busEnd(hi2c);
+        }
+        else if (hi2c->Stream.length == 0)
+        {
+            i2c_queueFinish(hi2c);
+        }
+    }
+
+    /* Interrupt driven transmission */
+    else if (((sr1 & I2C_SR1_TXE) != 0) && ((cr2 & I2C_CR2_ITBUFEN) != 0))
+    {
+        if (hi2c->Stream.length > 0)
+        {
+            XPD_WriteFromStream(&hi2c->Inst->DR, &hi2c->Stream);
+        }
+
+        if (hi2c->Stream.length == 0)
+        {
+            /* The written data follows the register address */
+            if ((hi2c->Phase == I2C_PHASE_REGISTER)
+                    && (hi2c->Queue.Head->Direction == I2C_DIRECTION_WRITE)
+                    && (hi2c->Queue.Head->Length > 0))
+            {
+                i2c_transmitStart(hi2c);
+            }
+            else
+            {
+                /* Wait for the transmission of the last byte */
+                I2C_REG_BIT(hi2c, CR2, ITBUFEN) = 0;
+            }
+        }
+    }
+
+    /* The transmission is finished, BTF remains set until the requested condition is generated */
+    else if (((sr1 & I2C_SR1_BTF) != 0) && (hi2c->Read == 0)
+            && ((hi2c->Inst->CR1.w & (I2C_CR1_START | I2C_CR1_STOP)) == 0))
+    {
+        if ((hi2c->Phase == I2C_PHASE_REGISTER)
+                && (hi2c->Queue.Head->Direction == I2C_DIRECTION_READ))
+        {
+            /* Read the data after the register address */
+            hi2c->Phase = I2C_PHASE_DATA;
+            hi2c->Read  = 1;
+
+            I2C_REG_BIT(hi2c, CR1, START) = 1;
+        }
+        else
+        {
+            i2c_busEnd(hi2c);
+
+            i2c_queueFinish(hi2c);
+        }
+    }
+
+    /* START generated, send the slave address */
+    else if ((sr1 & I2C_SR1_SB) != 0)
+    {
+        hi2c->Inst->DR = (hi2c->Queue.Head->Address << 1) | hi2c->Read;
+    }
+
+    /* The slave acknowledged its address */
+    else if ((sr1 & I2C_SR1_ADDR) != 0)
+    {
+        i2c_addressed(hi2c);
+    }
+
+    XPD_STATS_IRQ_END(hi2c);
+    XPD_PROFILE_END();
+}
+
+/**
+ * @brief Recalculates the bus timing for the current I2C clock frequency,
+ *        the new serial clock frequency doesn't exceed the one of the initial setup.
+ * @note  It can be registered as RCC clock change listener callback.
+ *        It shouldn't be called during communication.
+ * @param hi2c: pointer to the I2C handle structure
+ * @return ERROR if the bus frequency cannot be set up, OK if success
+ */
+XPD_ReturnType XPD_I2C_ClockUpdate(I2C_HandleType * hi2c)
+{
+    XPD_ReturnType result;
+
+    /* The timing can only be changed when the peripheral is disabled */
+    XPD_I2C_Disable(hi2c);
+
+    result = i2c_setTiming(hi2c);
+
+    XPD_I2C_Enable(hi2c);
+
+    return result;
+}
+
+/** @} */
+
+/** @} */
+
+#endif /* USE_XPD_I2C */
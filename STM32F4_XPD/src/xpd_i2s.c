@@ -0,0 +1,425 @@
+/**
+  ******************************************************************************
+  * @file    xpd_i2s.c
+  * @author  Benedek Kupper
+  * @version V0.1
+  * @date    2018-01-20
+  * @brief   STM32 eXtensible Peripheral Drivers I2S Module
+  *
+  *  This file is part of STM32_XPD.
+  *
+  *  STM32_XPD is free software: you can redistribute it and/or modify
+  *  it under the terms of the GNU General Public License as published by
+  *  the Free Software Foundation, either version 3 of the License, or
+  *  (at your option) any later version.
+  *
+  *  STM32_XPD is distributed in the hope that it will be useful,
+  *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with STM32_XPD.  If not, see <http://www.gnu.org/licenses/>.
+  */
+#include "xpd_i2s.h"
+#include "xpd_rcc.h"
+#include "xpd_utils.h"
+
+#if defined(USE_XPD_I2S)
+
+/** @addtogroup I2S
+ * @{ */
+
+/* I2S prescaler (2 * I2SDIV + ODD) limits */
+#define I2S_DIV_MIN             4
+#define I2S_DIV_MAX             511
+
+/* The receiver bit of the I2SCFG mode */
+#define I2S_MODE_RX             1
+
+static void i2s_dmaHalfBlockRedirect(void * hdma)
+{
+    I2S_HandleType * hi2s = (I2S_HandleType*) ((DMA_HandleType*) hdma)->Owner;
+
+    /* The first half of the double buffers is transferred */
+    hi2s->TxBlock.buffer = hi2s->TxBuffer;
+    hi2s->RxBlock.buffer = hi2s->RxBuffer;
+
+    XPD_STATS_ADD(hi2s, Transfers, 1);
+
+    XPD_SAFE_CALLBACK(hi2s->Callbacks.BlockReady, hi2s);
+}
+
+static void i2s_dmaBlockRedirect(void * hdma)
+{
+    I2S_HandleType * hi2s = (I2S_HandleType*) ((DMA_HandleType*) hdma)->Owner;
+
+    /* The second half of the double buffers is transferred */
+    if (hi2s->TxBuffer != NULL)
+    {
+        hi2s->TxBlock.buffer = (uint8_t*)hi2s->TxBuffer + hi2s->TxBlock.length * hi2s->TxBlock.size;
+    }
+    if (hi2s->RxBuffer != NULL)
+    {
+        hi2s->RxBlock.buffer = (uint8_t*)hi2s->RxBuffer + hi2s->RxBlock.length * hi2s->RxBlock.size;
+    }
+
+    XPD_STATS_ADD(hi2s, Transfers, 1);
+
+    XPD_SAFE_CALLBACK(hi2s->Callbacks.BlockReady, hi2s);
+}
+
+#ifdef USE_XPD_DMA_ERROR_DETECT
+static void i2s_dmaErrorRedirect(void * hdma)
+{
+    I2S_HandleType * hi2s = (I2S_HandleType*) ((DMA_HandleType*) hdma)->Owner;
+
+    /* Update error code */
+    hi2s->Errors |= I2S_ERROR_DMA;
+    XPD_STATS_ERROR(hi2s, I2S_ERROR_DMA);
+
+    XPD_SAFE_CALLBACK(hi2s->Callbacks.Error, hi2s);
+}
+#endif
+
+#ifdef USE_XPD_I2S_ERROR_DETECT
+/* Reads and clears the error flags of an I2S instance */
+static I2S_ErrorType i2s_getErrors(SPI_TypeDef * SPIx)
+{
+    I2S_ErrorType errors = I2S_ERROR_NONE;
+    uint32_t sr = SPIx->SR.w;
+
+    /* UDR and FRE are cleared by the status read */
+    if ((sr & SPI_SR_UDR) != 0)
+    {
+        errors |= I2S_ERROR_UNDERRUN;
+    }
+    if ((sr & SPI_SR_FRE) != 0)
+    {
+        errors |= I2S_ERROR_FRAME;
+    }
+    if ((sr & SPI_SR_OVR) != 0)
+    {
+        errors |= I2S_ERROR_OVERRUN;
+
+        /* OVR is cleared by reading DR then SR */
+        (void) SPIx->DR;
+        (void) SPIx->SR.w;
+    }
+    return errors;
+}
+#endif
+
+/** @defgroup I2S_Exported_Functions I2S Exported Functions
+ * @{ */
+
+/**
+ * @brief Initializes the SPI peripheral in I2S mode (and its extension for full-duplex).
+ * @note  In master mode the prescaler is set up from @ref XPD_I2S_GetClockFreq,
+ *        the I2S clock has to be configured beforehand (see @ref XPD_RCC_PLLI2SAudioConfig).
+ * @param hi2s: pointer to the I2S handle structure
+ * @param Config: pointer to I2S setup configuration
+ * @return ERROR if the sample rate cannot be set or full-duplex isn't available, OK otherwise
+ */
+XPD_ReturnType XPD_I2S_Init(I2S_HandleType * hi2s, const I2S_InitType * Config)
+{
+    XPD_ReturnType result = XPD_OK;
+    uint32_t cfgr;
+
+    /* enable clock */
+    XPD_SAFE_CALLBACK(hi2s->ClockCtrl, ENABLE);
+
+    /* Common frame format of the instances, in disabled state */
+    cfgr = SPI_I2SCFGR_I2SMOD
+         | ((uint32_t)Config->Format        << SPI_I2SCFGR_CHLEN_Pos)
+         | ((uint32_t)(Config->Standard & 3) << SPI_I2SCFGR_I2SSTD_Pos)
+         | ((uint32_t)(Config->Standard >> 2) << SPI_I2SCFGR_PCMSYNC_Pos)
+         | ((uint32_t)Config->ClockPolarity << SPI_I2SCFGR_CKPOL_Pos);
+
+    hi2s->Inst->I2SCFGR.w = cfgr | ((uint32_t)Config->Mode << SPI_I2SCFGR_I2SCFG_Pos);
+    hi2s->Inst->CR2.w     = 0;
+
+    /* Each channel sample is transferred as one or two half-words */
+    hi2s->FrameSize = (Config->Format > I2S_DATA_16_EXTENDED) ? 8 : 4;
+
+    if (Config->Mode >= I2S_MODE_MASTER_TX)
+    {
+        uint32_t ratio = I2S_CLOCK_RATIO(Config->Format, Config->MasterClock);
+        uint32_t clk   = XPD_I2S_GetClockFreq();
+        uint32_t unit  = ratio * Config->SampleRate;
+        uint32_t div   = (clk + unit / 2) / unit;
+
+        if ((div >= I2S_DIV_MIN) && (div <= I2S_DIV_MAX))
+        {
+            hi2s->Inst->I2SPR.w = (div >> 1) | ((div & 1) << SPI_I2SPR_ODD_Pos)
+                    | ((Config->MasterClock != DISABLE) ? SPI_I2SPR_MCKOE : 0);
+
+            hi2s->SampleRate = clk / (ratio * div);
+        }
+        else
+        {
+            result = XPD_ERROR;
+        }
+    }
+    else
+    {
+        hi2s->Inst->I2SPR.w = 2;
+        hi2s->SampleRate = Config->SampleRate;
+    }
+
+    /* The extension is a slave in the opposite direction */
+    hi2s->Duplex = 0;
+    if (Config->FullDuplex != DISABLE)
+    {
+        if (hi2s->Ext != NULL)
+        {
+            uint32_t mode = (Config->Mode & I2S_MODE_RX) ^ I2S_MODE_RX;
+
+            hi2s->Ext->I2SCFGR.w = cfgr | (mode << SPI_I2SCFGR_I2SCFG_Pos);
+            hi2s->Ext->I2SPR.w   = 2;
+            hi2s->Ext->CR2.w     = 0;
+            hi2s->Duplex = 1;
+        }
+        else
+        {
+            result = XPD_ERROR;
+        }
+    }
+
+#if defined(USE_XPD_I2S_ERROR_DETECT) || defined(USE_XPD_DMA_ERROR_DETECT)
+    hi2s->Errors = I2S_ERROR_NONE;
+#endif
+
+    /* Dependencies initialization */
+    XPD_SAFE_CALLBACK(hi2s->Callbacks.DepInit, hi2s);
+
+    return result;
+}
+
+/**
+ * @brief Restores the I2S peripheral to its default inactive state.
+ * @param hi2s: pointer to the I2S handle structure
+ * @return OK
+ */
+XPD_ReturnType XPD_I2S_Deinit(I2S_HandleType * hi2s)
+{
+    hi2s->Inst->I2SCFGR.w = 0;
+    if (hi2s->Duplex != 0)
+    {
+        hi2s->Ext->I2SCFGR.w = 0;
+    }
+
+    /* Deinitialize peripheral dependencies */
+    XPD_SAFE_CALLBACK(hi2s->Callbacks.DepDeinit, hi2s);
+
+    /* Disable clock */
+    XPD_SAFE_CALLBACK(hi2s->ClockCtrl, DISABLE);
+
+    return XPD_OK;
+}
+
+/**
+ * @brief Starts continuous DMA-managed audio streaming with double buffers.
+ *        The BlockReady callback is called each time a block is transferred:
+ *        the handle's RxBlock is filled with received frames, the TxBlock is free to refill,
+ *        while the DMA transfers the other halves of the buffers.
+ * @note  The transmit buffer shall be filled completely before the start.
+ *        The used DMAs must be initialized in circular mode with half-word data width.
+ *        In full-duplex operation the callbacks are driven by the receive DMA,
+ *        the transmit DMA runs ahead so its block is already sent by then.
+ *        The streaming is stopped by @ref XPD_I2S_Stream_Stop.
+ * @param hi2s: pointer to the I2S handle structure
+ * @param TxBuffer: memory address of the transmit double buffer (NULL if not used)
+ * @param RxBuffer: memory address of the receive double buffer (NULL if not used)
+ * @param BlockSize: the number of stereo frames in a single block
+ * @return ERROR if the configuration doesn't support the directions or the DMA is not circular,
+ *         BUSY if a DMA is in use, OK if successful
+ */
+XPD_ReturnType XPD_I2S_Stream_Start(I2S_HandleType * hi2s, void * TxBuffer,
+        void * RxBuffer, uint16_t BlockSize)
+{
+    XPD_ReturnType result = XPD_ERROR;
+    SPI_TypeDef * ext = (hi2s->Duplex != 0) ? hi2s->Ext : NULL;
+    SPI_TypeDef * txInst, * rxInst;
+    uint16_t count = BlockSize * hi2s->FrameSize;
+
+    /* The main instance direction is configured, the extension is the opposite */
+    if ((hi2s->Inst->I2SCFGR.w & (I2S_MODE_RX << SPI_I2SCFGR_I2SCFG_Pos)) != 0)
+    {
+        rxInst = hi2s->Inst;
+        txInst = ext;
+    }
+    else
+    {
+        txInst = hi2s->Inst;
+        rxInst = ext;
+    }
+
+    /* Validate the requested directions */
+    if (    ((TxBuffer != NULL) || (RxBuffer != NULL))
+         && ((TxBuffer == NULL) || ((txInst != NULL) && (XPD_DMA_CircularMode(hi2s->DMA.Transmit) != 0)))
+         && ((RxBuffer == NULL) || ((rxInst != NULL) && (XPD_DMA_CircularMode(hi2s->DMA.Receive) != 0))))
+    {
+        result = XPD_OK;
+
+        hi2s->TxBuffer       = TxBuffer;
+        hi2s->TxBlock.buffer = TxBuffer;
+        hi2s->TxBlock.length = BlockSize;
+        hi2s->TxBlock.size   = hi2s->FrameSize;
+        hi2s->RxBuffer       = RxBuffer;
+        hi2s->RxBlock.buffer = RxBuffer;
+        hi2s->RxBlock.length = BlockSize;
+        hi2s->RxBlock.size   = hi2s->FrameSize;
+    }
+
+    if ((result == XPD_OK) && (RxBuffer != NULL))
+    {
+        DMA_HandleType * hdma = hi2s->DMA.Receive;
+
+        /* Set up DMA for transfer */
+        result = XPD_DMA_Start_IT(hdma, (void *)&rxInst->DR, RxBuffer, count);
+
+        if (result == XPD_OK)
+        {
+            /* Set the callback owner */
+            hdma->Owner = hi2s;
+
+            /* Set the DMA transfer callbacks */
+            hdma->Callbacks.HalfComplete = i2s_dmaHalfBlockRedirect;
+            hdma->Callbacks.Complete     = i2s_dmaBlockRedirect;
+#ifdef USE_XPD_DMA_ERROR_DETECT
+            hdma->Callbacks.Error        = i2s_dmaErrorRedirect;
+#endif
+            XPD_DMA_EnableIT(hdma, HT);
+        }
+    }
+
+    if ((result == XPD_OK) && (TxBuffer != NULL))
+    {
+        DMA_HandleType * hdma = hi2s->DMA.Transmit;
+
+        /* Set up DMA for transfer */
+        result = XPD_DMA_Start_IT(hdma, (void *)&txInst->DR, TxBuffer, count);
+
+        if (result == XPD_OK)
+        {
+            /* Set the callback owner */
+            hdma->Owner = hi2s;
+#ifdef USE_XPD_DMA_ERROR_DETECT
+            hdma->Callbacks.Error = i2s_dmaErrorRedirect;
+#endif
+            if (RxBuffer == NULL)
+            {
+                /* Set the DMA transfer callbacks */
+                hdma->Callbacks.HalfComplete = i2s_dmaHalfBlockRedirect;
+                hdma->Callbacks.Complete     = i2s_dmaBlockRedirect;
+                XPD_DMA_EnableIT(hdma, HT);
+            }
+            else
+            {
+                /* The receive DMA notifies about both blocks */
+                XPD_DMA_DisableIT(hdma, TC);
+            }
+        }
+        else if (RxBuffer != NULL)
+        {
+            XPD_DMA_Stop_IT(hi2s->DMA.Receive);
+        }
+    }
+
+    if (result == XPD_OK)
+    {
+        uint32_t cr2 = 0;
+#ifdef USE_XPD_I2S_ERROR_DETECT
+        cr2 = SPI_CR2_ERRIE;
+#endif
+        /* Enable the DMA requests */
+        if (TxBuffer != NULL)
+        {
+            SET_BIT(txInst->CR2.w, cr2 | SPI_CR2_TXDMAEN);
+        }
+        if (RxBuffer != NULL)
+        {
+            SET_BIT(rxInst->CR2.w, cr2 | SPI_CR2_RXDMAEN);
+        }
+
+        /* The slave extension is enabled before the main instance */
+        if ((ext != NULL) && ((ext == txInst) ? (TxBuffer != NULL) : (RxBuffer != NULL)))
+        {
+            SET_BIT(ext->I2SCFGR.w, SPI_I2SCFGR_I2SE);
+        }
+        if ((hi2s->Inst == txInst) ? (TxBuffer != NULL) : (RxBuffer != NULL))
+        {
+            SET_BIT(hi2s->Inst->I2SCFGR.w, SPI_I2SCFGR_I2SE);
+        }
+    }
+    return result;
+}
+
+/**
+ * @brief Stops the audio streaming of the I2S handle.
+ * @param hi2s: pointer to the I2S handle structure
+ */
+void XPD_I2S_Stream_Stop(I2S_HandleType * hi2s)
+{
+    uint32_t cr2 = hi2s->Inst->CR2.w;
+
+    CLEAR_BIT(hi2s->Inst->I2SCFGR.w, SPI_I2SCFGR_I2SE);
+    hi2s->Inst->CR2.w = 0;
+
+    if (hi2s->Duplex != 0)
+    {
+        cr2 |= hi2s->Ext->CR2.w;
+
+        CLEAR_BIT(hi2s->Ext->I2SCFGR.w, SPI_I2SCFGR_I2SE);
+        hi2s->Ext->CR2.w = 0;
+    }
+
+    /* Stop the DMAs which served the stream */
+    if ((cr2 & SPI_CR2_TXDMAEN) != 0)
+    {
+        XPD_DMA_Stop_IT(hi2s->DMA.Transmit);
+    }
+    if ((cr2 & SPI_CR2_RXDMAEN) != 0)
+    {
+        XPD_DMA_Stop_IT(hi2s->DMA.Receive);
+    }
+}
+
+#ifdef USE_XPD_I2S_ERROR_DETECT
+/**
+ * @brief I2S error interrupt handler, shared with the full-duplex extension.
+ * @param hi2s: pointer to the I2S handle structure
+ */
+void XPD_I2S_IRQHandler(I2S_HandleType * hi2s)
+{
+    XPD_PROFILE_BEGIN();
+    XPD_STATS_IRQ_BEGIN();
+
+    I2S_ErrorType errors = i2s_getErrors(hi2s->Inst);
+
+    if (hi2s->Duplex != 0)
+    {
+        errors |= i2s_getErrors(hi2s->Ext);
+    }
+
+    if (errors != I2S_ERROR_NONE)
+    {
+        /* Update error code */
+        hi2s->Errors |= errors;
+        XPD_STATS_ERROR(hi2s, errors);
+
+        /* Error callback */
+        XPD_SAFE_CALLBACK(hi2s->Callbacks.Error, hi2s);
+    }
+
+    XPD_STATS_IRQ_END(hi2s);
+    XPD_PROFILE_END();
+}
+#endif
+
+/** @} */
+
+/** @} */
+
+#endif /* USE_XPD_I2S */
@@ -0,0 +1,407 @@
+/**
+  ******************************************************************************
+  * @file    xpd_lin.c
+  * @author  Benedek Kupper
+  * @version V0.1
+  * @date    2018-01-20
+  * @brief   STM32 eXtensible Peripheral Drivers LIN Bus Module
+  *
+  *  This file is part of STM32_XPD.
+  *
+  *  STM32_XPD is free software: you can redistribute it and/or modify
+  *  it under the terms of the GNU General Public License as published by
+  *  the Free Software Foundation, either version 3 of the License, or
+  *  (at your option) any later version.
+  *
+  *  STM32_XPD is distributed in the hope that it will be useful,
+  *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with STM32_XPD.  If not, see <http://www.gnu.org/licenses/>.
+  */
+#include "xpd_lin.h"
+
+#if defined(USE_XPD_LIN) && !defined(XPD_USART_EXCLUDE_DMA) && !defined(XPD_USART_EXCLUDE_MODES)
+
+/** @addtogroup LIN_Bus
+ * @{ */
+
+#define LIN_SYNC_BYTE           0x55
+#define LIN_HEADER_LENGTH       2
+#define LIN_MAX_DATA_LENGTH     8
+
+/* The diagnostic frames always use the classic checksum */
+#define LIN_DIAGNOSTIC_ID       60
+
+#define LIN_ID_MASK             0x3F
+
+/* Frame transfer states */
+#define LIN_STATE_IDLE          0
+#define LIN_STATE_BREAK         1
+#define LIN_STATE_HEADER        2
+#define LIN_STATE_RESPONSE      3
+
+/* Calculates the protected identifier with the parity bits */
+static uint8_t lin_getPid(uint8_t Id)
+{
+    uint8_t p0 = ((Id >> 0) ^ (Id >> 1) ^ (Id >> 2) ^ (Id >> 4)) & 1;
+    uint8_t p1 = (~((Id >> 1) ^ (Id >> 3) ^ (Id >> 4) ^ (Id >> 5))) & 1;
+
+    return (Id & LIN_ID_MASK) | (p0 << 6) | (p1 << 7);
+}
+
+/* Calculates the checksum of the frame response */
+static uint8_t lin_getChecksum(const LIN_FrameType * Frame, uint8_t Pid, const uint8_t * Data)
+{
+    uint32_t sum = 0;
+    uint8_t i;
+
+    if ((Frame->Checksum == LIN_CHECKSUM_ENHANCED) && (Frame->Id < LIN_DIAGNOSTIC_ID))
+    {
+        sum = Pid;
+    }
+    for (i = 0; i < Frame->Length; i++)
+    {
+        /* sum with carry */
+        sum += Data[i];
+        if (sum > 0xFF)
+        {
+            sum -= 0xFF;
+        }
+    }
+    return (uint8_t)~sum;
+}
+
+/* Appends the response of the frame to the transmit buffer */
+static void lin_buildResponse(LIN_HandleType * hlin, LIN_FrameType * Frame)
+{
+    uint8_t * response = &hlin->TxBuffer[LIN_HEADER_LENGTH];
+    uint8_t i;
+
+    for (i = 0; i < Frame->Length; i++)
+    {
+        response[i] = Frame->Data[i];
+    }
+    response[i] = lin_getChecksum(Frame, hlin->TxBuffer[1], Frame->Data);
+}
+
+/* Ends the current frame transfer with the status */
+static void lin_frameEnd(LIN_HandleType * hlin, LIN_StatusType Status)
+{
+    hlin->State = LIN_STATE_IDLE;
+    hlin->Current->Status = Status;
+
+    XPD_SAFE_CALLBACK(hlin->Callbacks.Frame, hlin);
+}
+
+/* Validates the completely received frame */
+static void lin_frameCheck(LIN_HandleType * hlin)
+{
+    LIN_FrameType * frame = hlin->Current;
+    const uint8_t * rx = hlin->RxBuffer;
+    LIN_StatusType status = LIN_STATUS_OK;
+    uint8_t i;
+
+    if (frame->Publish != 0)
+    {
+        /* the whole frame is read back */
+        for (i = (hlin->Master != 0) ? 0 : LIN_HEADER_LENGTH; i < hlin->Expected; i++)
+        {
+            if (rx[i] != hlin->TxBuffer[i])
+            {
+                status = LIN_STATUS_READBACK;
+                break;
+            }
+        }
+    }
+    else if ((rx[0] != LIN_SYNC_BYTE) || (rx[1] != hlin->TxBuffer[1]))
+    {
+        status = LIN_STATUS_READBACK;
+    }
+    else if (rx[hlin->Expected - 1] != lin_getChecksum(frame, rx[1], &rx[LIN_HEADER_LENGTH]))
+    {
+        status = LIN_STATUS_CHECKSUM;
+    }
+    else
+    {
+        for (i = 0; i < frame->Length; i++)
+        {
+            frame->Data[i] = rx[LIN_HEADER_LENGTH + i];
+        }
+    }
+    lin_frameEnd(hlin, status);
+}
+
+/* Finds the slave frame of the received protected identifier */
+static LIN_FrameType * lin_findFrame(LIN_HandleType * hlin, uint8_t Pid)
+{
+    uint8_t i;
+
+    if (lin_getPid(Pid) == Pid)
+    {
+        for (i = 0; i < hlin->Count; i++)
+        {
+            if (hlin->Frames[i].Id == (Pid & LIN_ID_MASK))
+            {
+                return &hlin->Frames[i];
+            }
+        }
+    }
+    return NULL;
+}
+
+/* Ends the unfinished frame, which response didn't arrive in time */
+static void lin_frameAbort(LIN_HandleType * hlin)
+{
+    uint8_t received = 0;
+
+    if (hlin->State == LIN_STATE_RESPONSE)
+    {
+        received = hlin->Expected - XPD_DMA_GetStatus(hlin->Serial.DMA.Receive);
+    }
+    XPD_USART_Stop_DMA(&hlin->Serial);
+
+    lin_frameEnd(hlin, (received > LIN_HEADER_LENGTH) ?
+            LIN_STATUS_INCOMPLETE : LIN_STATUS_NO_RESPONSE);
+}
+
+/* Starts the transfer of the next frame of the schedule table */
+static void lin_masterSend(LIN_HandleType * hlin)
+{
+    const LIN_ScheduleEntryType * entry = &hlin->Schedule[hlin->Index];
+    LIN_FrameType * frame = entry->Frame;
+    uint8_t length = LIN_HEADER_LENGTH;
+
+    if (++hlin->Index >= hlin->Count)
+    {
+        hlin->Index = 0;
+    }
+    hlin->Ticks    = entry->Slots;
+    hlin->Current  = frame;
+    hlin->Expected = LIN_HEADER_LENGTH + frame->Length + 1;
+
+    hlin->TxBuffer[0] = LIN_SYNC_BYTE;
+    hlin->TxBuffer[1] = lin_getPid(frame->Id);
+    if (frame->Publish != 0)
+    {
+        lin_buildResponse(hlin, frame);
+        length = hlin->Expected;
+    }
+
+    frame->Status = LIN_STATUS_PENDING;
+    hlin->State   = LIN_STATE_BREAK;
+
+    /* The header follows the break directly */
+    XPD_LIN_SendBreak(&hlin->Serial);
+    (void) XPD_USART_Transmit_DMA(&hlin->Serial, hlin->TxBuffer, length);
+}
+
+/* LIN break detection callback of the USART */
+static void lin_breakRedirect(void * husart)
+{
+    LIN_HandleType * hlin = (LIN_HandleType*) husart;
+
+    /* The break is received as a zero character with framing error */
+    XPD_USART_ClearFlag(&hlin->Serial, FE);
+    XPD_USART_ClearFlag(&hlin->Serial, RXNE);
+
+    if (hlin->Master != 0)
+    {
+        /* The frame is received back from the sync byte */
+        if (hlin->State == LIN_STATE_BREAK)
+        {
+            hlin->State = LIN_STATE_RESPONSE;
+            (void) XPD_USART_Receive_DMA(&hlin->Serial, hlin->RxBuffer, hlin->Expected);
+        }
+    }
+    else
+    {
+        /* A new header interrupts the unfinished frame */
+        if (hlin->State == LIN_STATE_RESPONSE)
+        {
+            lin_frameAbort(hlin);
+        }
+        else if (hlin->State == LIN_STATE_HEADER)
+        {
+            XPD_USART_Stop_DMA(&hlin->Serial);
+        }
+
+        hlin->State = LIN_STATE_HEADER;
+        (void) XPD_USART_Receive_DMA(&hlin->Serial, hlin->RxBuffer, LIN_HEADER_LENGTH);
+    }
+}
+
+/* Reception complete callback of the USART */
+static void lin_receiveRedirect(void * husart)
+{
+    LIN_HandleType * hlin = (LIN_HandleType*) husart;
+
+    if (hlin->State == LIN_STATE_RESPONSE)
+    {
+        lin_frameCheck(hlin);
+    }
+    else if (hlin->State == LIN_STATE_HEADER)
+    {
+        LIN_FrameType * frame = NULL;
+
+        if (hlin->RxBuffer[0] == LIN_SYNC_BYTE)
+        {
+            frame = lin_findFrame(hlin, hlin->RxBuffer[1]);
+        }
+
+        /* The frames of other nodes are ignored */
+        if (frame == NULL)
+        {
+            hlin->State = LIN_STATE_IDLE;
+        }
+        else
+        {
+            hlin->Current  = frame;
+            hlin->Expected = LIN_HEADER_LENGTH + frame->Length + 1;
+            hlin->TxBuffer[0] = LIN_SYNC_BYTE;
+            hlin->TxBuffer[1] = hlin->RxBuffer[1];
+
+            frame->Status = LIN_STATUS_PENDING;
+            hlin->State   = LIN_STATE_RESPONSE;
+
+            (void) XPD_USART_Receive_DMA(&hlin->Serial, &hlin->RxBuffer[LIN_HEADER_LENGTH],
+                    frame->Length + 1);
+
+            if (frame->Publish != 0)
+            {
+                lin_buildResponse(hlin, frame);
+                (void) XPD_USART_Transmit_DMA(&hlin->Serial, &hlin->TxBuffer[LIN_HEADER_LENGTH],
+                        frame->Length + 1);
+            }
+        }
+    }
+}
+
+/* Starts the operation of the handle */
+static void lin_start(LIN_HandleType * hlin, uint8_t Master, uint8_t Count)
+{
+    hlin->Master = Master;
+    hlin->Count  = Count;
+    hlin->Index  = 0;
+    hlin->State  = LIN_STATE_IDLE;
+
+    hlin->Serial.Callbacks.Break    = lin_breakRedirect;
+    hlin->Serial.Callbacks.Receive  = lin_receiveRedirect;
+    hlin->Serial.Callbacks.Transmit = NULL;
+
+    XPD_USART_ClearFlag(&hlin->Serial, LBD);
+    XPD_USART_EnableIT(&hlin->Serial, LBD);
+}
+
+/** @defgroup LIN_Bus_Exported_Functions LIN Bus Exported Functions
+ * @{ */
+
+/**
+ * @brief Starts the LIN master operation with the schedule table.
+ *        The first frame is sent by the next call of @ref XPD_LIN_Master_Tick.
+ * @param hlin: pointer to the LIN handle structure
+ * @param Schedule: the schedule table, which has to remain valid while in use
+ * @param Length: the number of entries in the schedule table
+ * @return ERROR if the schedule table is empty or it contains invalid frames, OK if started
+ */
+XPD_ReturnType XPD_LIN_Master_Start(LIN_HandleType * hlin,
+        const LIN_ScheduleEntryType * Schedule, uint8_t Length)
+{
+    uint8_t i;
+
+    if (Length == 0)
+    {
+        return XPD_ERROR;
+    }
+    for (i = 0; i < Length; i++)
+    {
+        if ((Schedule[i].Slots == 0) || (Schedule[i].Frame->Length == 0) ||
+            (Schedule[i].Frame->Length > LIN_MAX_DATA_LENGTH))
+        {
+            return XPD_ERROR;
+        }
+    }
+
+    hlin->Schedule = Schedule;
+    hlin->Ticks    = 1;
+    lin_start(hlin, 1, Length);
+
+    return XPD_OK;
+}
+
+/**
+ * @brief Advances the schedule table of the LIN master by one time base tick.
+ *        At the end of each slot the unfinished frame is reported with NO_RESPONSE
+ *        or INCOMPLETE status, and the next frame of the schedule is started.
+ * @note  This function has to be called periodically, e.g. from a timer update interrupt
+ *        with the same priority as the USART interrupt.
+ * @param hlin: pointer to the LIN handle structure
+ */
+void XPD_LIN_Master_Tick(LIN_HandleType * hlin)
+{
+    if ((hlin->Master == 0) || (hlin->Count == 0))
+    {
+        return;
+    }
+    if (--hlin->Ticks > 0)
+    {
+        return;
+    }
+
+    if (hlin->State != LIN_STATE_IDLE)
+    {
+        lin_frameAbort(hlin);
+    }
+    lin_masterSend(hlin);
+}
+
+/**
+ * @brief Starts the LIN slave operation. Each header is received after the break detection,
+ *        and the response of the matching frame is transmitted or received.
+ * @param hlin: pointer to the LIN handle structure
+ * @param Frames: the frames processed by the node, which have to remain valid while in use
+ * @param Count: the number of frames
+ * @return ERROR if a frame is invalid, OK if started
+ */
+XPD_ReturnType XPD_LIN_Slave_Start(LIN_HandleType * hlin, LIN_FrameType * Frames, uint8_t Count)
+{
+    uint8_t i;
+
+    for (i = 0; i < Count; i++)
+    {
+        if ((Frames[i].Id > LIN_ID_MASK) || (Frames[i].Length == 0) ||
+            (Frames[i].Length > LIN_MAX_DATA_LENGTH))
+        {
+            return XPD_ERROR;
+        }
+    }
+
+    hlin->Frames = Frames;
+    lin_start(hlin, 0, Count);
+
+    return XPD_OK;
+}
+
+/**
+ * @brief Stops the LIN operation, cancelling the ongoing transfers.
+ * @param hlin: pointer to the LIN handle structure
+ */
+void XPD_LIN_Stop(LIN_HandleType * hlin)
+{
+    XPD_USART_DisableIT(&hlin->Serial, LBD);
+
+    hlin->Count = 0;
+    hlin->State = LIN_STATE_IDLE;
+    hlin->Serial.Callbacks.Break   = NULL;
+    hlin->Serial.Callbacks.Receive = NULL;
+
+    XPD_USART_Stop_DMA(&hlin->Serial);
+}
+
+/** @} */
+
+/** @} */
+
+#endif /* USE_XPD_LIN */
@@ -0,0 +1,306 @@
+/**
+  ******************************************************************************
+  * @file    xpd_ltdc.c
+  * @author  Benedek Kupper
+  * @version V0.1
+  * @date    2018-01-20
+  * @brief   STM32 eXtensible Peripheral Drivers LCD-TFT Display Controller Module
+  *
+  *  This file is part of STM32_XPD.
+  *
+  *  STM32_XPD is free software: you can redistribute it and/or modify
+  *  it under the terms of the GNU General Public License as published by
+  *  the Free Software Foundation, either version 3 of the License, or
+  *  (at your option) any later version.
+  *
+  *  STM32_XPD is distributed in the hope that it will be useful,
+  *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with STM32_XPD.  If not, see <http://www.gnu.org/licenses/>.
+  */
+#include "xpd_ltdc.h"
+#include "xpd_rcc.h"
+#include "xpd_utils.h"
+
+#if defined(USE_XPD_LTDC) && defined(LTDC)
+
+/** @addtogroup LTDC
+ * @{ */
+
+#define LTDC_ERROR_INTERRUPTS   (LTDC_IER_FUIE | LTDC_IER_TERRIE)
+
+/* Blending factors of the layer with the constant and the pixel alpha */
+#define LTDC_BF_CONSTANT        ((4 << LTDC_LxBFCR_BF1_Pos) | (5 << LTDC_LxBFCR_BF2_Pos))
+#define LTDC_BF_PIXEL           ((6 << LTDC_LxBFCR_BF1_Pos) | (7 << LTDC_LxBFCR_BF2_Pos))
+
+static LTDC_Layer_TypeDef * const ltdc_layers[] = { LTDC_Layer1, LTDC_Layer2 };
+
+/* Bytes per pixel of each pixel format */
+static const uint8_t ltdc_pixelSize[] = { 4, 3, 2, 2, 2, 1, 1, 2 };
+
+/** @defgroup LTDC_Exported_Functions LTDC Exported Functions
+ * @{ */
+
+/**
+ * @brief Initializes the LTDC peripheral with the display timing,
+ *        and sets up the pixel clock with the PLLSAI.
+ * @note  The layers are configured separately by @ref XPD_LTDC_LayerInit.
+ * @param hltdc: pointer to the LTDC handle structure
+ * @param Config: pointer to LTDC setup configuration
+ * @return The result of @ref XPD_RCC_LTDCClockConfig
+ */
+XPD_ReturnType XPD_LTDC_Init(LTDC_HandleType * hltdc, const LTDC_InitType * Config)
+{
+    XPD_ReturnType result = XPD_RCC_LTDCClockConfig(Config->PixelClock);
+
+    if (result == XPD_OK)
+    {
+        uint32_t h = Config->Horizontal.Sync - 1;
+        uint32_t v = Config->Vertical.Sync - 1;
+
+        /* enable clock */
+        XPD_SAFE_CALLBACK(hltdc->ClockCtrl, ENABLE);
+
+        /* The timing registers hold the accumulated lengths */
+        hltdc->Inst->SSCR.w = (h << LTDC_SSCR_HSW_Pos) | v;
+        h += Config->Horizontal.BackPorch;
+        v += Config->Vertical.BackPorch;
+        hltdc->Inst->BPCR.w = (h << LTDC_BPCR_AHBP_Pos) | v;
+        h += Config->Horizontal.Active;
+        v += Config->Vertical.Active;
+        hltdc->Inst->AWCR.w = (h << LTDC_AWCR_AAW_Pos) | v;
+        h += Config->Horizontal.FrontPorch;
+        v += Config->Vertical.FrontPorch;
+        hltdc->Inst->TWCR.w = (h << LTDC_TWCR_TOTALW_Pos) | v;
+
+        hltdc->Inst->BCCR.w = Config->BackgroundColor & 0xFFFFFF;
+
+        hltdc->Layer[0].Front   = hltdc->Layer[1].Front   = NULL;
+        hltdc->Layer[0].Pending = hltdc->Layer[1].Pending = NULL;
+        hltdc->Errors = LTDC_ERROR_NONE;
+
+        /* Dependencies initialization */
+        XPD_SAFE_CALLBACK(hltdc->Callbacks.DepInit, hltdc);
+
+        hltdc->Inst->ICR.w = LTDC_ICR_CLIF | LTDC_ICR_CFUIF | LTDC_ICR_CTERRIF | LTDC_ICR_CRRIF;
+        hltdc->Inst->IER.w = LTDC_ERROR_INTERRUPTS;
+
+        hltdc->Inst->GCR.w = LTDC_GCR_LTDCEN
+                | ((Config->Polarity.HSyncHigh      != 0) ? LTDC_GCR_HSPOL : 0)
+                | ((Config->Polarity.VSyncHigh      != 0) ? LTDC_GCR_VSPOL : 0)
+                | ((Config->Polarity.DataEnableHigh != 0) ? LTDC_GCR_DEPOL : 0)
+                | ((Config->Polarity.ClockInverted  != 0) ? LTDC_GCR_PCPOL : 0)
+                | ((Config->Dither != DISABLE) ? LTDC_GCR_DEN : 0);
+    }
+    return result;
+}
+
+/**
+ * @brief Restores the LTDC peripheral to its default inactive state.
+ * @param hltdc: pointer to the LTDC handle structure
+ */
+void XPD_LTDC_Deinit(LTDC_HandleType * hltdc)
+{
+    hltdc->Inst->IER.w = 0;
+    hltdc->Inst->GCR.w = 0;
+
+    /* Deinitialize peripheral dependencies */
+    XPD_SAFE_CALLBACK(hltdc->Callbacks.DepDeinit, hltdc);
+
+    /* disable clock */
+    XPD_SAFE_CALLBACK(hltdc->ClockCtrl, DISABLE);
+}
+
+/**
+ * @brief Configures and enables a display layer. The settings take effect immediately.
+ * @param hltdc: pointer to the LTDC handle structure
+ * @param Layer: the layer index [0, 1]
+ * @param Config: pointer to the layer setup configuration
+ */
+void XPD_LTDC_LayerInit(LTDC_HandleType * hltdc, uint8_t Layer, const LTDC_LayerInitType * Config)
+{
+    LTDC_Layer_TypeDef * layer = ltdc_layers[Layer];
+    uint32_t pixelSize = ltdc_pixelSize[Config->Format];
+    uint32_t pitch = (Config->Pitch != 0) ? Config->Pitch : Config->Width;
+    uint32_t hstart = ((hltdc->Inst->BPCR.w & LTDC_BPCR_AHBP) >> LTDC_BPCR_AHBP_Pos) + Config->X + 1;
+    uint32_t vstart = (hltdc->Inst->BPCR.w & LTDC_BPCR_AVBP) + Config->Y + 1;
+
+    layer->WHPCR.w = hstart | ((hstart + Config->Width - 1) << LTDC_LxWHPCR_WHSPPOS_Pos);
+    layer->WVPCR.w = vstart | ((vstart + Config->Height - 1) << LTDC_LxWVPCR_WVSPPOS_Pos);
+
+    layer->PFCR  = Config->Format;
+    layer->CACR  = Config->Alpha;
+    layer->DCCR.w = Config->DefaultColor;
+    layer->BFCR.w = (Config->Blending == LTDC_BLEND_PIXEL) ? LTDC_BF_PIXEL : LTDC_BF_CONSTANT;
+
+    /* The line length includes the 3 bytes of the FIFO pipeline */
+    layer->CFBAR   = (uint32_t)Config->Buffer;
+    layer->CFBLR.w = ((pitch * pixelSize) << LTDC_LxCFBLR_CFBP_Pos) | (Config->Width * pixelSize + 3);
+    layer->CFBLNR  = Config->Height;
+
+    layer->CR.w = (layer->CR.w & LTDC_LxCR_CLUTEN) | LTDC_LxCR_LEN;
+
+    hltdc->Layer[Layer].Front   = Config->Buffer;
+    hltdc->Layer[Layer].Pending = NULL;
+
+    hltdc->Inst->SRCR.w = LTDC_SRCR_IMR;
+}
+
+/**
+ * @brief Enables or disables a display layer from the next frame.
+ * @param hltdc: pointer to the LTDC handle structure
+ * @param Layer: the layer index [0, 1]
+ * @param NewState: the new state of the layer
+ */
+void XPD_LTDC_LayerCtrl(LTDC_HandleType * hltdc, uint8_t Layer, FunctionalState NewState)
+{
+    ltdc_layers[Layer]->CR.b.LEN = NewState;
+
+    hltdc->Inst->SRCR.w = LTDC_SRCR_VBR;
+}
+
+/**
+ * @brief Sets the constant alpha of a display layer from the next frame.
+ * @param hltdc: pointer to the LTDC handle structure
+ * @param Layer: the layer index [0, 1]
+ * @param Alpha: the new constant alpha of the layer
+ */
+void XPD_LTDC_LayerSetAlpha(LTDC_HandleType * hltdc, uint8_t Layer, uint8_t Alpha)
+{
+    ltdc_layers[Layer]->CACR = Alpha;
+
+    hltdc->Inst->SRCR.w = LTDC_SRCR_VBR;
+}
+
+/**
+ * @brief Loads the color lookup table of a layer with indexed pixel format, and enables it.
+ * @note  The CLUT can only be written while the layer is disabled or during vertical blanking.
+ * @param hltdc: pointer to the LTDC handle structure
+ * @param Layer: the layer index [0, 1]
+ * @param Colors: the RGB888 colors of the table starting from index 0
+ * @param Count: the number of colors to load [1 .. 256]
+ */
+void XPD_LTDC_LoadCLUT(LTDC_HandleType * hltdc, uint8_t Layer, const uint32_t * Colors, uint16_t Count)
+{
+    LTDC_Layer_TypeDef * layer = ltdc_layers[Layer];
+    uint32_t i;
+
+    for (i = 0; i < Count; i++)
+    {
+        layer->CLUTWR.w = (i << LTDC_LxCLUTWR_CLUTADD_Pos) | (Colors[i] & 0xFFFFFF);
+    }
+    layer->CR.b.CLUTEN = 1;
+
+    hltdc->Inst->SRCR.w = LTDC_SRCR_VBR;
+}
+
+/**
+ * @brief Requests the layer to display a new framebuffer from the next frame.
+ *        The swap is performed at the vertical blanking, so the displayed frame
+ *        is never torn. The previous framebuffer can be drawn again after
+ *        the Swapped callback, or when @ref XPD_LTDC_IsSwapPending becomes false.
+ * @param hltdc: pointer to the LTDC handle structure
+ * @param Layer: the layer index [0, 1]
+ * @param Buffer: the new framebuffer with the layer's format and geometry
+ * @return BUSY if the previous swap of the layer is still pending, OK otherwise
+ */
+XPD_ReturnType XPD_LTDC_SwapBuffer(LTDC_HandleType * hltdc, uint8_t Layer, void * Buffer)
+{
+    if (hltdc->Layer[Layer].Pending != NULL)
+    {
+        return XPD_BUSY;
+    }
+
+    hltdc->Layer[Layer].Pending = Buffer;
+    ltdc_layers[Layer]->CFBAR = (uint32_t)Buffer;
+
+    /* The shadow registers are reloaded at the start of the vertical blanking */
+    hltdc->Inst->IER.w |= LTDC_IER_RRIE;
+    hltdc->Inst->SRCR.w = LTDC_SRCR_VBR;
+
+    return XPD_OK;
+}
+
+/**
+ * @brief Sets up the line interrupt which triggers the Line callback.
+ * @param hltdc: pointer to the LTDC handle structure
+ * @param Line: the line position, including the synchronization and back porch lines
+ * @param NewState: the new state of the line interrupt
+ */
+void XPD_LTDC_SetLineEvent(LTDC_HandleType * hltdc, uint16_t Line, FunctionalState NewState)
+{
+    if (NewState != DISABLE)
+    {
+        hltdc->Inst->LIPCR = Line;
+        hltdc->Inst->IER.w |= LTDC_IER_LIE;
+    }
+    else
+    {
+        hltdc->Inst->IER.w &= ~LTDC_IER_LIE;
+    }
+}
+
+/**
+ * @brief LTDC global and error interrupt handler that completes the pending
+ *        framebuffer swaps and provides the line and error callbacks.
+ * @param hltdc: pointer to the LTDC handle structure
+ */
+void XPD_LTDC_IRQHandler(LTDC_HandleType * hltdc)
+{
+    XPD_PROFILE_BEGIN();
+    XPD_STATS_IRQ_BEGIN();
+
+    uint32_t isr = hltdc->Inst->ISR.w & hltdc->Inst->IER.w;
+
+    /* Register reload at vertical blanking */
+    if ((isr & LTDC_ISR_RRIF) != 0)
+    {
+        uint8_t i;
+
+        hltdc->Inst->ICR.w = LTDC_ICR_CRRIF;
+        hltdc->Inst->IER.w &= ~LTDC_IER_RRIE;
+
+        for (i = 0; i < 2; i++)
+        {
+            if (hltdc->Layer[i].Pending != NULL)
+            {
+                hltdc->Layer[i].Front = hltdc->Layer[i].Pending;
+                hltdc->Layer[i].Pending = NULL;
+            }
+        }
+        XPD_STATS_ADD(hltdc, Transfers, 1);
+
+        XPD_SAFE_CALLBACK(hltdc->Callbacks.Swapped, hltdc);
+    }
+
+    /* Line position reached */
+    if ((isr & LTDC_ISR_LIF) != 0)
+    {
+        hltdc->Inst->ICR.w = LTDC_ICR_CLIF;
+
+        XPD_SAFE_CALLBACK(hltdc->Callbacks.Line, hltdc);
+    }
+
+    /* FIFO underrun or transfer error */
+    if ((isr & (LTDC_ISR_FUIF | LTDC_ISR_TERRIF)) != 0)
+    {
+        hltdc->Inst->ICR.w = isr & (LTDC_ICR_CFUIF | LTDC_ICR_CTERRIF);
+        hltdc->Errors |= isr & (LTDC_ISR_FUIF | LTDC_ISR_TERRIF);
+
+        XPD_STATS_ERROR(hltdc, isr & (LTDC_ISR_FUIF | LTDC_ISR_TERRIF));
+
+        XPD_SAFE_CALLBACK(hltdc->Callbacks.Error, hltdc);
+    }
+
+    XPD_STATS_IRQ_END(hltdc);
+    XPD_PROFILE_END();
+}
+
+/** @} */
+
+/** @} */
+
+#endif /* USE_XPD_LTDC */
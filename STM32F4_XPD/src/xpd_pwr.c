@@ -24,6 +24,7 @@
 #include "xpd_pwr.h"
 #include "xpd_rcc.h"
 #include "xpd_utils.h"
+#include "xpd_mem.h"
 
 /** @addtogroup PWR
  * @{ */
@@ -52,6 +53,8 @@ void XPD_PWR_SleepMode(ReactionType WakeUpOn)
     /* Clear SLEEPDEEP bit of Cortex System Control Register */
     SCB->SCR.b.SLEEPDEEP = 0;
 
+    XPD_ENERGY_STATE(XPD_ENERGY_SLEEP);
+
     if (WakeUpOn == REACTION_IT)
     {
         /* Request Wait For Interrupt */
@@ -64,6 +67,8 @@ void XPD_PWR_SleepMode(ReactionType WakeUpOn)
         __WFE();
         __WFE();
     }
+
+    XPD_ENERGY_STATE(XPD_ENERGY_RUN);
 }
 
 /**
@@ -114,6 +119,8 @@ void XPD_PWR_StopMode(ReactionType WakeUpOn, PWR_RegulatorType Regulator)
     /* Set SLEEPDEEP bit of Cortex System Control Register */
     SCB->SCR.b.SLEEPDEEP = 1;
 
+    XPD_ENERGY_STATE(XPD_ENERGY_STOP);
+
     /* Select STOP mode entry */
     if (WakeUpOn == REACTION_IT)
     {
@@ -130,6 +137,8 @@ void XPD_PWR_StopMode(ReactionType WakeUpOn, PWR_RegulatorType Regulator)
 
     /* Reset SLEEPDEEP bit of Cortex System Control Register */
     SCB->SCR.b.SLEEPDEEP = 0;
+
+    XPD_ENERGY_STATE(XPD_ENERGY_RUN);
 }
 
 /**
@@ -258,6 +267,214 @@ void XPD_PWR_WakeUpPin_SetPolarity(uint8_t WakeUpPin, EdgeType RisingOrFalling)
 
 /** @} */
 
+#if defined(PWR_CR_PLS) && defined(BKPSRAM_BASE)
+/** @addtogroup PWR_Checkpoint
+ * @{ */
+
+#define PWR_CHECKPOINT_MAGIC    0x43484B50
+
+/* Backup SRAM layout: the checkpoint header is followed by the word padded buffers */
+#define PWR_CHECKPOINT_HEADER   ((volatile uint32_t *)BKPSRAM_BASE)
+#define PWR_CHECKPOINT_DATA     ((uint8_t *)(BKPSRAM_BASE + 8))
+
+#define PWR_CHECKPOINT_PADDED(SIZE) (((uint32_t)(SIZE) + 3) & ~3UL)
+
+static struct {
+    const PWR_Checkpoint_InitType * Config;
+    DMA_MemJobType Job;
+    uint32_t Offset;
+    uint8_t Index;
+    volatile uint8_t Busy;
+} pwr_checkpoint;
+
+/* Validates the checkpoint once all buffers are saved */
+static void pwr_checkpointFinish(void)
+{
+    PWR_CHECKPOINT_HEADER[1] = pwr_checkpoint.Offset;
+    PWR_CHECKPOINT_HEADER[0] = PWR_CHECKPOINT_MAGIC;
+
+    /* the checkpoint has to reach the backup SRAM before the supply collapses */
+    __DSB();
+
+    pwr_checkpoint.Busy = 0;
+    XPD_SAFE_CALLBACK(pwr_checkpoint.Config->Complete,);
+}
+
+/* Memory job completion callback, queues the copy of the next buffer */
+static void pwr_checkpointNext(void * Job)
+{
+    const PWR_Checkpoint_InitType * config = pwr_checkpoint.Config;
+
+    if (((DMA_MemJobType*)Job)->Status != XPD_OK)
+    {
+        /* the checkpoint remains invalid */
+        pwr_checkpoint.Busy = 0;
+    }
+    else
+    {
+        pwr_checkpoint.Offset += PWR_CHECKPOINT_PADDED(config->Regions[pwr_checkpoint.Index].Size);
+        pwr_checkpoint.Index++;
+
+        if (pwr_checkpoint.Index < config->Count)
+        {
+            (void) XPD_DMA_MemCpy_IT(config->Engine, &pwr_checkpoint.Job,
+                    PWR_CHECKPOINT_DATA + pwr_checkpoint.Offset,
+                    config->Regions[pwr_checkpoint.Index].Data,
+                    config->Regions[pwr_checkpoint.Index].Size);
+        }
+        else
+        {
+            pwr_checkpointFinish();
+        }
+    }
+}
+
+/* PVD EXTI callback */
+static void pwr_pvdCallback(uint32_t Line)
+{
+    /* the supply is below the threshold */
+    if (XPD_PWR_GetFlag(PVDO) != 0)
+    {
+        XPD_PWR_Checkpoint_Save();
+    }
+}
+
+/** @defgroup PWR_Checkpoint_Exported_Functions PWR Checkpoint Exported Functions
+ * @{ */
+
+/**
+ * @brief Enables the backup SRAM retention and the PVD interrupt triggered checkpoint saving.
+ * @note  The PVD EXTI line interrupt has to be served by @ref XPD_EXTI_IRQHandler
+ *        with a priority that allows the memory engine's DMA interrupt to preempt it,
+ *        or the engine has to be omitted. An existing valid checkpoint is kept
+ *        until it is overwritten by a new one.
+ * @param Config: pointer to the checkpoint configuration, has to remain valid while in use
+ * @return ERROR if the buffers don't fit in the backup SRAM, TIMEOUT if the backup regulator
+ *         failed to start, OK if the checkpoint is armed
+ */
+XPD_ReturnType XPD_PWR_Checkpoint_Init(const PWR_Checkpoint_InitType * Config)
+{
+    XPD_ReturnType result = XPD_ERROR;
+    uint32_t i, size = 0;
+
+    for (i = 0; i < Config->Count; i++)
+    {
+        size += PWR_CHECKPOINT_PADDED(Config->Regions[i].Size);
+    }
+
+    if (size <= PWR_CHECKPOINT_CAPACITY)
+    {
+        XPD_BKPSRAM_ClockCtrl(ENABLE);
+        XPD_PWR_BackupAccess(ENABLE);
+
+        /* the backup regulator retains the backup SRAM content on VBAT */
+        result = XPD_PWR_BackupRegulatorCtrl(ENABLE);
+    }
+
+    if (result == XPD_OK)
+    {
+        PWR_PVD_InitType pvd = {
+            .Level = Config->Level,
+            .ExtI  = {
+                .ITCallback = pwr_pvdCallback,
+                .Edge       = EDGE_RISING,
+                .Reaction   = REACTION_IT,
+            },
+        };
+
+        pwr_checkpoint.Config = Config;
+        pwr_checkpoint.Job.Callback = pwr_checkpointNext;
+        pwr_checkpoint.Busy = 0;
+
+        XPD_PWR_PVD_Init(&pvd);
+        XPD_PWR_PVD_Enable();
+    }
+    return result;
+}
+
+/**
+ * @brief Saves the registered buffers to the backup SRAM. It is called by the PVD interrupt,
+ *        but it can also be used for checkpointing on demand.
+ * @note  The buffers are copied by the memory engine if it is configured, then the
+ *        checkpoint is validated and the Complete callback is called.
+ */
+void XPD_PWR_Checkpoint_Save(void)
+{
+    const PWR_Checkpoint_InitType * config = pwr_checkpoint.Config;
+
+    if ((config != NULL) && (pwr_checkpoint.Busy == 0))
+    {
+        pwr_checkpoint.Busy = 1;
+
+        /* invalidate the previous checkpoint until all buffers are saved */
+        PWR_CHECKPOINT_HEADER[0] = 0;
+        pwr_checkpoint.Offset = 0;
+        pwr_checkpoint.Index = 0;
+
+        if (config->Count == 0)
+        {
+            pwr_checkpointFinish();
+        }
+        else if (config->Engine != NULL)
+        {
+            (void) XPD_DMA_MemCpy_IT(config->Engine, &pwr_checkpoint.Job,
+                    PWR_CHECKPOINT_DATA, config->Regions[0].Data, config->Regions[0].Size);
+        }
+        else
+        {
+            for (; pwr_checkpoint.Index < config->Count; pwr_checkpoint.Index++)
+            {
+                XPD_MemCopy(PWR_CHECKPOINT_DATA + pwr_checkpoint.Offset,
+                        config->Regions[pwr_checkpoint.Index].Data,
+                        config->Regions[pwr_checkpoint.Index].Size);
+                pwr_checkpoint.Offset += PWR_CHECKPOINT_PADDED(config->Regions[pwr_checkpoint.Index].Size);
+            }
+            pwr_checkpointFinish();
+        }
+    }
+}
+
+/**
+ * @brief Restores the registered buffers from the last valid checkpoint, and invalidates it.
+ * @note  @ref XPD_PWR_Checkpoint_Init has to be called first with the same buffer layout
+ *        as the checkpoint was saved with.
+ * @return ERROR if there is no valid checkpoint of the buffers, OK if the buffers are restored
+ */
+XPD_ReturnType XPD_PWR_Checkpoint_Restore(void)
+{
+    const PWR_Checkpoint_InitType * config = pwr_checkpoint.Config;
+    XPD_ReturnType result = XPD_ERROR;
+    uint32_t i, offset = 0;
+
+    if ((config != NULL) && (PWR_CHECKPOINT_HEADER[0] == PWR_CHECKPOINT_MAGIC))
+    {
+        for (i = 0; i < config->Count; i++)
+        {
+            offset += PWR_CHECKPOINT_PADDED(config->Regions[i].Size);
+        }
+
+        if (offset == PWR_CHECKPOINT_HEADER[1])
+        {
+            for (i = 0, offset = 0; i < config->Count; i++)
+            {
+                XPD_MemCopy(config->Regions[i].Data, PWR_CHECKPOINT_DATA + offset,
+                        config->Regions[i].Size);
+                offset += PWR_CHECKPOINT_PADDED(config->Regions[i].Size);
+            }
+            result = XPD_OK;
+        }
+
+        /* the checkpoint is consumed */
+        PWR_CHECKPOINT_HEADER[0] = 0;
+    }
+    return result;
+}
+
+/** @} */
+
+/** @} */
+#endif /* PWR_CR_PLS && BKPSRAM_BASE */
+
 #ifdef PWR_CR_VOS
 /** @addtogroup PWR_Regulator_Voltage_Scaling
  * @{ */
@@ -286,6 +503,7 @@ XPD_ReturnType XPD_PWR_VoltageScaleConfig(PWR_RegVoltScaleType Scaling)
     {
 #ifdef PWR_CR_VOS_1
         boolean_t pll_on = RCC_REG_BIT(CR,PLLRDY);
+        uint32_t pll_timeout = RCC_PLL_TIMEOUT;
 
         if (pll_on)
         {
@@ -293,7 +511,7 @@ XPD_ReturnType XPD_PWR_VoltageScaleConfig(PWR_RegVoltScaleType Scaling)
             RCC_REG_BIT(CR,PLLON) = OSC_OFF;
 
             /* wait until PLL is disabled */
-            result = XPD_WaitForMatch(&RCC->CR.w, RCC_CR_PLLRDY, 0, RCC_PLL_TIMEOUT);
+            result = XPD_WaitForMatch(&RCC->CR.w, RCC_CR_PLLRDY, 0, &pll_timeout);
             if (result != XPD_OK)
             {
                 return result;
@@ -309,7 +527,7 @@ XPD_ReturnType XPD_PWR_VoltageScaleConfig(PWR_RegVoltScaleType Scaling)
             RCC_REG_BIT(CR,PLLON) = OSC_ON;
 
             /* wait until PLL is enabled */
-            result = XPD_WaitForMatch(&RCC->CR.w, RCC_CR_PLLRDY, RCC_CR_PLLRDY, RCC_PLL_TIMEOUT);
+            result = XPD_WaitForMatch(&RCC->CR.w, RCC_CR_PLLRDY, RCC_CR_PLLRDY, &pll_timeout);
             if (result != XPD_OK)
             {
                 return result;
@@ -370,7 +588,7 @@ XPD_ReturnType XPD_PWR_OverDrive_Enable(void)
     PWR_REG_BIT(CR, ODEN) = ENABLE;
 
     /* Wait until Overdrive is ready */
-    result = XPD_WaitForMatch(&RCC->CR.w, PWR_CSR_ODRDY, PWR_CSR_ODRDY, &timeout);
+    result = XPD_WaitForMatch(&PWR->CSR.w, PWR_CSR_ODRDY, PWR_CSR_ODRDY, &timeout);
 
     if (result == XPD_OK)
     {
@@ -378,7 +596,7 @@ XPD_ReturnType XPD_PWR_OverDrive_Enable(void)
         PWR_REG_BIT(CR, ODSWEN) = ENABLE;
 
         /* Wait until Overdrive SW is ready */
-        result = XPD_WaitForMatch(&RCC->CR.w, PWR_CSR_ODSWRDY, PWR_CSR_ODSWRDY, &timeout);
+        result = XPD_WaitForMatch(&PWR->CSR.w, PWR_CSR_ODSWRDY, PWR_CSR_ODSWRDY, &timeout);
     }
 
     return result;
@@ -400,7 +618,7 @@ XPD_ReturnType XPD_PWR_OverDrive_Disable(void)
     PWR_REG_BIT(CR, ODSWEN) = DISABLE;
 
     /* Wait until Overdrive SW is not ready */
-    result = XPD_WaitForMatch(&RCC->CR.w, PWR_CSR_ODSWRDY, 0, &timeout);
+    result = XPD_WaitForMatch(&PWR->CSR.w, PWR_CSR_ODSWRDY, 0, &timeout);
 
     if (result == XPD_OK)
     {
@@ -408,7 +626,7 @@ XPD_ReturnType XPD_PWR_OverDrive_Disable(void)
         PWR_REG_BIT(CR, ODEN) = DISABLE;
 
         /* Wait until Overdrive is not ready */
-        result = XPD_WaitForMatch(&RCC->CR.w, PWR_CSR_ODRDY, 0, &timeout);
+        result = XPD_WaitForMatch(&PWR->CSR.w, PWR_CSR_ODRDY, 0, &timeout);
     }
 
     return result;
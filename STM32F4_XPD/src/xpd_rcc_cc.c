@@ -59,6 +59,39 @@ static uint32_t rcc_convertClockDivider(RCC_ClockType clockType, ClockDividerTyp
     }
 }
 
+/* cached core clock frequencies, updated by the clock configuration functions */
+static struct {
+    uint32_t SYSCLK;
+    uint32_t PCLK1;
+    uint32_t PCLK2;
+    uint32_t PLL;       /* 0 when it has to be recalculated */
+}rcc_clockTree = { HSI_VALUE, HSI_VALUE, HSI_VALUE, 0 };
+
+static RCC_ClockListenerType * rcc_clockListeners = NULL;
+static boolean_t rcc_clockTransition = FALSE;
+
+/* the operating point which is applied once its oscillators are ready */
+static RCC_OperatingPointType rcc_pendingOperatingPoint;
+static boolean_t rcc_operatingPointPending = FALSE;
+static boolean_t rcc_operatingPointReady   = FALSE;
+
+static void rcc_operatingPointProceed(void);
+
+/* notifies the registered listeners about the changed clock frequencies */
+static void rcc_clockChanged(void)
+{
+    RCC_ClockListenerType * listener;
+
+    /* the listeners are only notified at the end of an operating point transition */
+    if (rcc_clockTransition == FALSE)
+    {
+        for (listener = rcc_clockListeners; listener != NULL; listener = listener->Next)
+        {
+            XPD_SAFE_CALLBACK(listener->Callback, listener->Handle);
+        }
+    }
+}
+
 /** @defgroup RCC_Core_Clocks_Exported_Functions RCC Core Exported Functions
  * @{ */
 
@@ -160,6 +193,20 @@ XPD_ReturnType XPD_RCC_HSEConfig(RCC_OscStateType NewState)
 }
 #endif
 
+/* configures the PLL source and factors, the PLL has to be disabled */
+static void rcc_pllSetup(const RCC_PLL_InitType * Config)
+{
+    RCC_REG_BIT(PLLCFGR,PLLSRC) = Config->Source;
+
+    RCC->PLLCFGR.b.PLLM = Config->M;
+    RCC->PLLCFGR.b.PLLN = Config->N;
+    RCC->PLLCFGR.b.PLLP = (Config->P >> 1) - 1;
+    RCC->PLLCFGR.b.PLLQ = Config->Q;
+#ifdef RCC_PLLCFGR_PLLR
+    RCC->PLLCFGR.b.PLLR = Config->R;
+#endif
+}
+
 /**
  * Configures the phase locked loop.
  * @param Config: pointer to the configuration parameters
@@ -183,15 +230,7 @@ XPD_ReturnType XPD_RCC_PLLConfig(const RCC_PLL_InitType * Config)
         if ((result == XPD_OK) && (Config->State != OSC_OFF))
         {
             /* Configure the main PLL clock source and multiplication factor. */
-            RCC_REG_BIT(PLLCFGR,PLLSRC) = Config->Source;
-
-            RCC->PLLCFGR.b.PLLM = Config->M;
-            RCC->PLLCFGR.b.PLLN = Config->N;
-            RCC->PLLCFGR.b.PLLP = (Config->P >> 1) - 1;
-            RCC->PLLCFGR.b.PLLQ = Config->Q;
-#ifdef RCC_PLLCFGR_PLLR
-            RCC->PLLCFGR.b.PLLR = Config->R;
-#endif
+            rcc_pllSetup(Config);
 
             /* Enable the main PLL. */
             RCC_REG_BIT(CR,PLLON) = OSC_ON;
@@ -200,9 +239,233 @@ XPD_ReturnType XPD_RCC_PLLConfig(const RCC_PLL_InitType * Config)
             result = XPD_WaitForMatch(&RCC->CR.w, RCC_CR_PLLRDY, RCC_CR_PLLRDY, &timeout);
         }
     }
+    /* the PLL output frequency is recalculated on demand */
+    rcc_clockTree.PLL = 0;
+
+    return result;
+}
+
+#ifdef RCC_CR_PLLI2SON
+/* PLLI2S VCO output frequency limits */
+#define RCC_PLLI2S_VCO_MIN      100000000
+#define RCC_PLLI2S_VCO_MAX      432000000
+#define RCC_PLLI2S_R_MAX_FREQ   192000000
+
+/* I2S prescaler (2 * I2SDIV + ODD) limits */
+#define RCC_I2S_DIV_MIN         4
+#define RCC_I2S_DIV_MAX         511
+
+/**
+ * Configures the I2S phase locked loop.
+ * @note  The PLLI2S uses the input clock and M divider of the main PLL.
+ * @param Config: pointer to the configuration parameters
+ * @return Result of the operation
+ */
+XPD_ReturnType XPD_RCC_PLLI2SConfig(const RCC_PLLI2S_InitType * Config)
+{
+    XPD_ReturnType result;
+    uint32_t timeout = RCC_PLL_TIMEOUT;
+
+    /* Disable the PLLI2S */
+    RCC_REG_BIT(CR,PLLI2SON) = OSC_OFF;
+
+    /* Wait until PLLI2S is disabled */
+    result = XPD_WaitForMatch(&RCC->CR.w, RCC_CR_PLLI2SRDY, 0, &timeout);
+
+    if ((result == XPD_OK) && (Config->State != OSC_OFF))
+    {
+        /* Set I2S PLL parameters */
+        RCC->PLLI2SCFGR.b.PLLI2SN = Config->N;
+#ifdef RCC_PLLI2SCFGR_PLLI2SQ
+        RCC->PLLI2SCFGR.b.PLLI2SQ = Config->Q;
+#endif
+        RCC->PLLI2SCFGR.b.PLLI2SR = Config->R;
+
+        /* Enable the PLLI2S */
+        RCC_REG_BIT(CR,PLLI2SON) = OSC_ON;
+
+        /* Wait until PLLI2S is ready */
+        result = XPD_WaitForMatch(&RCC->CR.w, RCC_CR_PLLI2SRDY, RCC_CR_PLLI2SRDY, &timeout);
+    }
+    return result;
+}
+
+/**
+ * Configures the I2S phase locked loop for an audio sample rate.
+ * The factors are selected so that the I2S clock is the closest to an integer multiple
+ * of ClockRatio x SampleRate, which the I2S prescaler divides down to the sample rate.
+ * @note  The PLLI2S uses the input clock and M divider of the main PLL,
+ *        a 1 or 2 MHz VCO input gives the most accurate rates.
+ * @param SampleRate: the audio sample rate in Hz
+ * @param ClockRatio: the ratio of the I2S prescaler output and the sample rate:
+ *        256 with master clock output, otherwise 32 for 16 bit and 64 for 32 bit channels
+ * @return ERROR if no valid setup is found, otherwise the result of @ref XPD_RCC_PLLI2SConfig
+ */
+XPD_ReturnType XPD_RCC_PLLI2SAudioConfig(uint32_t SampleRate, uint16_t ClockRatio)
+{
+    RCC_PLLI2S_InitType pll = { .State = ENABLE };
+    uint32_t vcoIn = XPD_RCC_GetOscFreq(XPD_RCC_GetPLLSource()) / RCC->PLLCFGR.b.PLLM;
+    uint32_t unit = (uint32_t)ClockRatio * SampleRate;
+    uint32_t bestError = ~0;
+    uint32_t n, r;
+
+#ifdef RCC_PLLI2SCFGR_PLLI2SQ
+    /* The SAI clock divider is left unchanged */
+    pll.Q = RCC->PLLI2SCFGR.b.PLLI2SQ;
+#endif
+
+    for (r = 2; (r <= 7) && (bestError != 0); r++)
+    {
+        for (n = 50; n <= 432; n++)
+        {
+            uint32_t vco = vcoIn * n;
+            uint32_t i2sclk = vco / r;
+            uint32_t div, error;
+
+            if ((vco > RCC_PLLI2S_VCO_MAX) || (i2sclk > RCC_PLLI2S_R_MAX_FREQ))
+            {
+                break;
+            }
+            if (vco < RCC_PLLI2S_VCO_MIN)
+            {
+                continue;
+            }
+
+            /* The closest prescaler value */
+            div = (i2sclk + unit / 2) / unit;
+            if ((div < RCC_I2S_DIV_MIN) || (div > RCC_I2S_DIV_MAX))
+            {
+                continue;
+            }
+
+            /* Prescaler output deviation */
+            error = (i2sclk > (div * unit)) ? (i2sclk - div * unit) : (div * unit - i2sclk);
+            error = (error + div / 2) / div;
+
+            if (error < bestError)
+            {
+                bestError = error;
+                pll.N = n;
+                pll.R = r;
+            }
+        }
+    }
+
+    if (bestError == (uint32_t)~0)
+    {
+        return XPD_ERROR;
+    }
+    else
+    {
+        return XPD_RCC_PLLI2SConfig(&pll);
+    }
+}
+
+/**
+ * @brief Gets the I2S clock output frequency of the PLLI2S.
+ * @return The frequency of the PLLI2S R output in Hz.
+ */
+uint32_t XPD_RCC_GetPLLI2SFreq(void)
+{
+    return XPD_RCC_GetOscFreq(XPD_RCC_GetPLLSource()) / RCC->PLLCFGR.b.PLLM
+            * RCC->PLLI2SCFGR.b.PLLI2SN / RCC->PLLI2SCFGR.b.PLLI2SR;
+}
+#endif /* RCC_CR_PLLI2SON */
+
+#ifdef RCC_DCKCFGR_PLLSAIDIVR
+/* PLLSAI VCO output frequency limits */
+#define RCC_PLLSAI_VCO_MIN      100000000
+#define RCC_PLLSAI_VCO_MAX      432000000
+
+/**
+ * Configures the SAI phase locked loop to generate the LCD-TFT pixel clock.
+ * The multiplier and the dividers of the PLLSAI R output are selected so that
+ * the LTDC clock is the closest to the requested pixel clock.
+ * @note  The PLLSAI uses the input clock and M divider of the main PLL,
+ *        its SAI clock divider is left unchanged.
+ * @param PixelClock: the requested pixel clock frequency in Hz
+ * @return ERROR if no valid setup is found, TIMEOUT if the PLL doesn't lock, OK if successful
+ */
+XPD_ReturnType XPD_RCC_LTDCClockConfig(uint32_t PixelClock)
+{
+    XPD_ReturnType result;
+    uint32_t timeout = RCC_PLL_TIMEOUT;
+    uint32_t vcoIn = XPD_RCC_GetOscFreq(XPD_RCC_GetPLLSource()) / RCC->PLLCFGR.b.PLLM;
+    uint32_t bestError = ~0;
+    uint32_t n, r, div, bestN = 0, bestR = 0, bestDiv = 0;
+
+    for (div = 0; (div < 4) && (bestError != 0); div++)
+    {
+        for (r = 2; (r <= 7) && (bestError != 0); r++)
+        {
+            uint32_t ratio = r * (2 << div);
+
+            for (n = 50; n <= 432; n++)
+            {
+                uint32_t vco = vcoIn * n;
+                uint32_t error;
+
+                if (vco > RCC_PLLSAI_VCO_MAX)
+                {
+                    break;
+                }
+                if (vco < RCC_PLLSAI_VCO_MIN)
+                {
+                    continue;
+                }
+
+                error = vco / ratio;
+                error = (error > PixelClock) ? (error - PixelClock) : (PixelClock - error);
+
+                if (error < bestError)
+                {
+                    bestError = error;
+                    bestN = n;
+                    bestR = r;
+                    bestDiv = div;
+                }
+            }
+        }
+    }
+
+    if (bestError == (uint32_t)~0)
+    {
+        return XPD_ERROR;
+    }
+
+    /* Disable the PLLSAI */
+    RCC_REG_BIT(CR,PLLSAION) = OSC_OFF;
+
+    /* Wait until PLLSAI is disabled */
+    result = XPD_WaitForMatch(&RCC->CR.w, RCC_CR_PLLSAIRDY, 0, &timeout);
+
+    if (result == XPD_OK)
+    {
+        RCC->PLLSAICFGR.b.PLLSAIN = bestN;
+        RCC->PLLSAICFGR.b.PLLSAIR = bestR;
+        RCC->DCKCFGR.b.PLLSAIDIVR = bestDiv;
+
+        /* Enable the PLLSAI */
+        RCC_REG_BIT(CR,PLLSAION) = OSC_ON;
+
+        /* Wait until PLLSAI is ready */
+        result = XPD_WaitForMatch(&RCC->CR.w, RCC_CR_PLLSAIRDY, RCC_CR_PLLSAIRDY, &timeout);
+    }
     return result;
 }
 
+/**
+ * @brief Gets the LCD-TFT pixel clock frequency generated by the PLLSAI.
+ * @return The frequency of the LTDC clock in Hz.
+ */
+uint32_t XPD_RCC_GetLTDCFreq(void)
+{
+    return XPD_RCC_GetOscFreq(XPD_RCC_GetPLLSource()) / RCC->PLLCFGR.b.PLLM
+            * RCC->PLLSAICFGR.b.PLLSAIN / RCC->PLLSAICFGR.b.PLLSAIR
+            / (2 << RCC->DCKCFGR.b.PLLSAIDIVR);
+}
+#endif /* RCC_DCKCFGR_PLLSAIDIVR */
+
 /**
  * Sets the new state of the low speed internal oscillator.
  * @param NewState: the new operation state
@@ -317,20 +580,25 @@ uint32_t XPD_RCC_GetOscFreq(RCC_OscType Oscillator)
 
         case PLL:
         {
-            m = RCC->PLLCFGR.b.PLLM;
-            n = RCC->PLLCFGR.b.PLLN;
-            p = (RCC->PLLCFGR.b.PLLP + 1) * 2;
+            /* the PLL output is only calculated after reconfiguration */
+            if (rcc_clockTree.PLL == 0)
+            {
+                m = RCC->PLLCFGR.b.PLLM;
+                n = RCC->PLLCFGR.b.PLLN;
+                p = (RCC->PLLCFGR.b.PLLP + 1) * 2;
 
 #ifdef HSE_VALUE
-            if (XPD_RCC_GetPLLSource() != HSI)
-            {
-                return HSE_VALUE / m * n / p;
-            }
-            else
+                if (XPD_RCC_GetPLLSource() != HSI)
+                {
+                    rcc_clockTree.PLL = HSE_VALUE / m * n / p;
+                }
+                else
 #endif
-            {
-                return HSI_VALUE / m * n / p;
+                {
+                    rcc_clockTree.PLL = HSI_VALUE / m * n / p;
+                }
             }
+            return rcc_clockTree.PLL;
         }
 #ifdef RCC_CFGR_SWS_PLLR
         case PLLR:
@@ -381,6 +649,8 @@ RCC_OscType XPD_RCC_GetReadyOsc(void)
  */
 void XPD_RCC_IRQHandler(void)
 {
+    XPD_PROFILE_BEGIN();
+
     uint32_t cir = RCC->CIR.w;
 
 #ifdef LSE_VALUE
@@ -411,6 +681,12 @@ void XPD_RCC_IRQHandler(void)
         /* Clear RCC PLLRDY pending bit */
         XPD_RCC_ClearFlag(PLLRDY);
 
+        /* Continue the pending operating point switch */
+        if (rcc_operatingPointPending != FALSE)
+        {
+            rcc_operatingPointProceed();
+        }
+
         /* PLL Ready callback */
         rcc_readyOscillator = PLL;
         XPD_SAFE_CALLBACK(XPD_RCC_Callbacks.OscReady,);
@@ -422,6 +698,12 @@ void XPD_RCC_IRQHandler(void)
         /* Clear RCC HSERDY pending bit */
         XPD_RCC_ClearFlag(HSERDY);
 
+        /* Continue the pending operating point switch */
+        if (rcc_operatingPointPending != FALSE)
+        {
+            rcc_operatingPointProceed();
+        }
+
         /* HSE Ready callback */
         rcc_readyOscillator = HSE;
         XPD_SAFE_CALLBACK(XPD_RCC_Callbacks.OscReady,);
@@ -437,6 +719,8 @@ void XPD_RCC_IRQHandler(void)
         rcc_readyOscillator = HSI;
         XPD_SAFE_CALLBACK(XPD_RCC_Callbacks.OscReady,);
     }
+
+    XPD_PROFILE_END();
 }
 
 /** @} */
@@ -449,6 +733,14 @@ void XPD_RCC_IRQHandler(void)
 static const uint8_t AHBPrescTable[16] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 2, 3, 4, 6, 7, 8, 9};
 #define APBPrescTable (&AHBPrescTable[4])
 
+/* recalculates the cached frequencies of the core clocks */
+static void rcc_clockTreeUpdate(void)
+{
+    rcc_clockTree.SYSCLK = XPD_RCC_GetOscFreq(XPD_RCC_GetSYSCLKSource());
+    rcc_clockTree.PCLK1  = SystemCoreClock >> APBPrescTable[RCC->CFGR.b.PPRE1];
+    rcc_clockTree.PCLK2  = SystemCoreClock >> APBPrescTable[RCC->CFGR.b.PPRE2];
+}
+
 /**
  * @brief Sets the new configuration for the AHB system clocks and the new matching flash latency.
  * @param SYSCLK_Source: @ref RCC_ClockType::SYSCLK input source selection. Permitted values:
@@ -456,7 +748,8 @@ static const uint8_t AHBPrescTable[16] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 2, 3, 4, 6,
              @arg @ref RCC_OscType::HSE
              @arg @ref RCC_OscType::PLL
  * @param HCLK_Divider: Clock divider of @ref RCC_ClockType::HCLK clock. Must not be CLK_DIV32.
- * @param FlashLatency: the desired amount of flash wait states
+ * @param FlashLatency: the desired amount of flash wait states,
+ *        or @ref FLASH_LATENCY_AUTO to select the minimal wait states for the new HCLK frequency
  * @return Result of the operation
  * @note To correctly read data from FLASH memory, the number of wait states must be
  * correctly programmed according to the frequency of the CPU clock (HCLK) of the device.
@@ -465,6 +758,7 @@ XPD_ReturnType XPD_RCC_HCLKConfig(RCC_OscType SYSCLK_Source, ClockDividerType HC
 {
     XPD_ReturnType result;
     uint32_t clkDiv;
+    uint8_t prevLatency;
     uint32_t timeout = RCC_CLOCKSWITCH_TIMEOUT;
 
     /* Checking whether the SYSCLK source is ready to be used */
@@ -503,6 +797,15 @@ XPD_ReturnType XPD_RCC_HCLKConfig(RCC_OscType SYSCLK_Source, ClockDividerType HC
             return XPD_ERROR;
     }
 
+    clkDiv = rcc_convertClockDivider(HCLK, HCLK_Divider);
+
+    /* Select the minimal wait states for the new HCLK frequency */
+    if (FlashLatency == FLASH_LATENCY_AUTO)
+    {
+        FlashLatency = XPD_FLASH_GetMinLatency(XPD_RCC_GetOscFreq(SYSCLK_Source) >> AHBPrescTable[clkDiv]);
+    }
+    prevLatency = XPD_FLASH_GetLatency();
+
     /* Increasing the CPU frequency */
     if (FlashLatency > XPD_FLASH_GetLatency())
     {
@@ -518,7 +821,6 @@ XPD_ReturnType XPD_RCC_HCLKConfig(RCC_OscType SYSCLK_Source, ClockDividerType HC
     }
 
     /* Set SYSCLK source and HCLK prescaler */
-    clkDiv = rcc_convertClockDivider(HCLK, HCLK_Divider);
     RCC->CFGR.b.HPRE = clkDiv;
     RCC->CFGR.b.SW   = SYSCLK_Source;
 
@@ -539,12 +841,21 @@ XPD_ReturnType XPD_RCC_HCLKConfig(RCC_OscType SYSCLK_Source, ClockDividerType HC
         }
     }
 
+    /* Reset the caches after the flash access timing has changed */
+    if (FlashLatency != prevLatency)
+    {
+        XPD_FLASH_ResetCaches();
+    }
+
     /* Update SystemCoreClock variable */
     SystemCoreClock = XPD_RCC_GetOscFreq(SYSCLK_Source) >> AHBPrescTable[clkDiv];
+    rcc_clockTreeUpdate();
 
     /* Configure the source of time base considering new system clocks settings*/
     XPD_InitTimer();
 
+    rcc_clockChanged();
+
     return result;
 }
 
@@ -578,6 +889,10 @@ void XPD_RCC_PCLKConfig(RCC_ClockType PCLKx, ClockDividerType PCLK_Divider)
         default:
             break;
     }
+
+    rcc_clockTreeUpdate();
+
+    rcc_clockChanged();
 }
 
 /**
@@ -593,13 +908,13 @@ uint32_t XPD_RCC_GetClockFreq(RCC_ClockType SelectedClock)
         return SystemCoreClock;
 
     case SYSCLK:
-        return XPD_RCC_GetOscFreq(XPD_RCC_GetSYSCLKSource());
+        return rcc_clockTree.SYSCLK;
 
     case PCLK1:
-        return SystemCoreClock >> APBPrescTable[RCC->CFGR.b.PPRE1];
+        return rcc_clockTree.PCLK1;
 
     case PCLK2:
-        return SystemCoreClock >> APBPrescTable[RCC->CFGR.b.PPRE2];
+        return rcc_clockTree.PCLK2;
 
     default:
         return 0;
@@ -608,6 +923,406 @@ uint32_t XPD_RCC_GetClockFreq(RCC_ClockType SelectedClock)
 
 /** @} */
 
+/** @defgroup RCC_Core_Clocks_Exported_Functions_Scaling RCC Operating Point Functions
+ *  @brief    RCC dynamic frequency and voltage scaling
+ * @{
+ */
+
+/**
+ * @brief Switches the system to a new operating point: configures the clock tree,
+ *        the flash latency and the regulator voltage scaling, then notifies the registered clock change listeners.
+ * @note  The PLL and the regulator are reconfigured while the SYSCLK is provided by HSI.
+ *        The flash latency is always set to the minimal value for the new HCLK frequency.
+ * @param Config: pointer to the operating point configuration
+ * @return Result of the operation
+ */
+XPD_ReturnType XPD_RCC_OperatingPointConfig(const RCC_OperatingPointType * Config)
+{
+    XPD_ReturnType result = XPD_OK;
+
+    rcc_clockTransition = TRUE;
+    XPD_ENERGY_STATE(XPD_ENERGY_CLOCK);
+
+#ifdef HSE_VALUE
+    /* Start the HSE if it's needed by the new clock tree */
+    if ((Config->HSE_State != OSC_OFF) && (RCC_REG_BIT(CR,HSERDY) == 0))
+    {
+        result = XPD_RCC_HSEConfig(Config->HSE_State);
+    }
+#endif
+
+    /* Step on the HSI while the PLL and the regulator are reconfigured */
+#ifdef PWR_CR_VOS
+    if ((Config->PLL != NULL) || (Config->VoltageScale != XPD_PWR_GetVoltageScale())
+#ifdef PWR_CR_ODEN
+            || (Config->OverDrive != PWR_REG_BIT(CR,ODEN))
+#endif
+       )
+#else
+    if (Config->PLL != NULL)
+#endif
+    {
+        if (XPD_RCC_GetSYSCLKSource() != HSI)
+        {
+            result = XPD_RCC_HSIConfig(ENABLE);
+
+            if (result == XPD_OK)
+            {
+                result = XPD_RCC_HCLKConfig(HSI, CLK_DIV1, FLASH_LATENCY_AUTO);
+            }
+        }
+#ifdef PWR_CR_ODEN
+        if ((result == XPD_OK) && (Config->OverDrive == DISABLE) && (PWR_REG_BIT(CR,ODEN) != 0))
+        {
+            result = XPD_PWR_OverDrive_Disable();
+        }
+#endif
+#ifdef PWR_CR_VOS
+        if ((result == XPD_OK) && (Config->VoltageScale != XPD_PWR_GetVoltageScale()))
+        {
+            XPD_PWR_ClockCtrl(ENABLE);
+
+            result = XPD_PWR_VoltageScaleConfig(Config->VoltageScale);
+        }
+#endif
+        if ((result == XPD_OK) && (Config->PLL != NULL))
+        {
+            result = XPD_RCC_PLLConfig(Config->PLL);
+        }
+#ifdef PWR_CR_ODEN
+        if ((result == XPD_OK) && (Config->OverDrive != DISABLE) && (PWR_REG_BIT(CR,ODEN) == 0))
+        {
+            result = XPD_PWR_OverDrive_Enable();
+        }
+#endif
+    }
+
+    if (result == XPD_OK)
+    {
+        uint32_t hclk = XPD_RCC_GetOscFreq(Config->SYSCLK_Source)
+                >> AHBPrescTable[rcc_convertClockDivider(HCLK, Config->HCLK_Divider)];
+
+        /* The APB dividers are set on the lower HCLK frequency,
+         * so the APB clocks remain within limits during the transition */
+        if (hclk > XPD_RCC_GetClockFreq(HCLK))
+        {
+            XPD_RCC_PCLKConfig(PCLK1, Config->PCLK1_Divider);
+            XPD_RCC_PCLKConfig(PCLK2, Config->PCLK2_Divider);
+
+            result = XPD_RCC_HCLKConfig(Config->SYSCLK_Source, Config->HCLK_Divider, FLASH_LATENCY_AUTO);
+        }
+        else
+        {
+            result = XPD_RCC_HCLKConfig(Config->SYSCLK_Source, Config->HCLK_Divider, FLASH_LATENCY_AUTO);
+
+            XPD_RCC_PCLKConfig(PCLK1, Config->PCLK1_Divider);
+            XPD_RCC_PCLKConfig(PCLK2, Config->PCLK2_Divider);
+        }
+    }
+
+    /* Notify the listeners once about the new clock configuration */
+    rcc_clockTransition = FALSE;
+    XPD_ENERGY_STATE(XPD_ENERGY_RUN);
+    rcc_clockChanged();
+
+    return result;
+}
+
+/* advances the pending operating point switch: starts the next oscillator
+ * which isn't ready yet, or completes the switch when all of them are */
+static void rcc_operatingPointProceed(void)
+{
+#ifdef HSE_VALUE
+    if ((rcc_pendingOperatingPoint.HSE_State != OSC_OFF) && (RCC_REG_BIT(CR,HSERDY) == 0))
+    {
+        /* Start the HSE, continue on HSERDY interrupt */
+        XPD_RCC_EnableIT(HSERDY);
+
+        if (RCC_REG_BIT(CR,HSEON) == 0)
+        {
+            RCC_REG_BIT(CR,HSEBYP) = rcc_pendingOperatingPoint.HSE_State >> 1;
+            RCC_REG_BIT(CR,HSEON)  = 1;
+        }
+    }
+    else
+#endif
+    if ((rcc_pendingOperatingPoint.PLL != NULL) && (rcc_pendingOperatingPoint.PLL->State != OSC_OFF))
+    {
+        const RCC_PLL_InitType * pll = rcc_pendingOperatingPoint.PLL;
+        uint32_t timeout = RCC_PLL_TIMEOUT;
+
+        /* The PLL is started only once, the completion leaves it untouched */
+        rcc_pendingOperatingPoint.PLL = NULL;
+
+        /* Disable the main PLL. */
+        RCC_REG_BIT(CR,PLLON) = OSC_OFF;
+        (void) XPD_WaitForMatch(&RCC->CR.w, RCC_CR_PLLRDY, 0, &timeout);
+
+#ifdef PWR_CR_VOS
+        /* The voltage scaling is written while the PLL is off,
+         * as the VOSRDY flag is only set once the PLL is locked */
+        if (rcc_pendingOperatingPoint.VoltageScale != XPD_PWR_GetVoltageScale())
+        {
+            XPD_PWR_ClockCtrl(ENABLE);
+
+            PWR->CR.b.VOS = rcc_pendingOperatingPoint.VoltageScale;
+        }
+#endif
+
+        /* Configure the PLL while it's disabled */
+        rcc_pllSetup(pll);
+
+        /* the PLL output frequency is recalculated on demand */
+        rcc_clockTree.PLL = 0;
+
+        /* Start the PLL, continue on PLLRDY interrupt */
+        XPD_RCC_EnableIT(PLLRDY);
+        RCC_REG_BIT(CR,PLLON) = OSC_ON;
+    }
+    else
+    {
+        /* All oscillators are ready, the switch is completed in thread context */
+        rcc_operatingPointReady = TRUE;
+    }
+}
+
+/**
+ * @brief Starts the switch to a new operating point without waiting for the oscillators to stabilize.
+ *        The HSE and the PLL are started in the background, and when they are ready
+ *        the switch is completed by @ref XPD_RCC_OperatingPointComplete.
+ *        Meanwhile the application can carry on with its clock independent initialization
+ *        (GPIO, DMA, RAM structures) on the current HSI clock.
+ * @note  The RCC interrupt has to be enabled in the NVIC, it only starts the oscillators.
+ *        The readiness is signalled by the OscReady callback with @ref XPD_RCC_GetReadyOsc
+ *        returning PLL (or HSE), then @ref XPD_RCC_OperatingPointComplete has to be called
+ *        from thread context, which notifies the registered clock change listeners.
+ * @param Config: pointer to the operating point configuration (copied)
+ * @return BUSY if a switch is already pending or the PLL to reconfigure provides the SYSCLK, OK otherwise
+ */
+XPD_ReturnType XPD_RCC_OperatingPointConfig_IT(const RCC_OperatingPointType * Config)
+{
+    XPD_ReturnType result = XPD_OK;
+
+    if ((rcc_operatingPointPending != FALSE)
+     || ((Config->PLL != NULL) && (XPD_RCC_GetSYSCLKSource() == PLL)))
+    {
+        result = XPD_BUSY;
+    }
+    else
+    {
+        rcc_pendingOperatingPoint = *Config;
+        rcc_operatingPointPending = TRUE;
+        rcc_operatingPointReady   = FALSE;
+
+        rcc_operatingPointProceed();
+    }
+    return result;
+}
+
+/**
+ * @brief Completes the operating point switch started by @ref XPD_RCC_OperatingPointConfig_IT
+ *        once its oscillators are ready. The clock tree reconfiguration waits for the clock
+ *        switch and the regulator, therefore it's performed in thread context
+ *        instead of @ref XPD_RCC_IRQHandler.
+ * @return BUSY if the oscillators are still starting, OK if no switch is pending,
+ *         otherwise the result of @ref XPD_RCC_OperatingPointConfig
+ */
+XPD_ReturnType XPD_RCC_OperatingPointComplete(void)
+{
+    XPD_ReturnType result = XPD_OK;
+
+    if (rcc_operatingPointPending != FALSE)
+    {
+        if (rcc_operatingPointReady == FALSE)
+        {
+            result = XPD_BUSY;
+        }
+        else
+        {
+            rcc_operatingPointPending = FALSE;
+            rcc_operatingPointReady   = FALSE;
+
+            result = XPD_RCC_OperatingPointConfig(&rcc_pendingOperatingPoint);
+        }
+    }
+    return result;
+}
+
+/**
+ * @brief Registers a listener which is notified after each change of the core clocks,
+ *        so that the clock dependent peripheral settings can be recalculated.
+ * @note  The peripheral drivers provide such callbacks, e.g. @ref XPD_USART_ClockUpdate,
+ *        @ref XPD_SPI_ClockUpdate and @ref XPD_TIM_ClockUpdate.
+ * @param Listener: pointer to the listener, which has to remain valid while it's registered
+ */
+void XPD_RCC_ClockListener_Register(RCC_ClockListenerType * Listener)
+{
+    Listener->Next = rcc_clockListeners;
+    rcc_clockListeners = Listener;
+}
+
+/**
+ * @brief Removes a listener from the clock change notification list.
+ * @param Listener: pointer to the registered listener
+ */
+void XPD_RCC_ClockListener_Unregister(RCC_ClockListenerType * Listener)
+{
+    RCC_ClockListenerType ** link;
+
+    for (link = &rcc_clockListeners; *link != NULL; link = &(*link)->Next)
+    {
+        if (*link == Listener)
+        {
+            *link = Listener->Next;
+            break;
+        }
+    }
+}
+
+/** @} */
+
+#ifdef HSE_VALUE
+/** @addtogroup RCC_Core_Clocks_Exported_Functions_CSS
+ * @{ */
+
+/* the operating point which is restored when the HSE recovers */
+static const RCC_OperatingPointType * rcc_cssNominal = NULL;
+static RCC_OperatingPointType rcc_cssFallback;
+static RCC_PLL_InitType rcc_cssFallbackPLL;
+static boolean_t rcc_cssFailed = FALSE;
+
+/**
+ * @brief Enables the Clock Security System with managed HSE failure handling.
+ *        When the HSE fails, the SYSCLK is recovered on HSI, or on a HSI based PLL
+ *        with the closest frequency not above the nominal one, and the registered
+ *        clock change listeners are notified. @ref XPD_RCC_CSS_Retry restores the
+ *        nominal operating point once the HSE is available again.
+ * @note  @ref XPD_NMI_IRQHandler has to be called from the NMI handler, and the RCC
+ *        interrupt has to be enabled in the NVIC for the PLL recovery, which is completed
+ *        by @ref XPD_RCC_CSS_Retry.
+ * @param Nominal: pointer to the HSE based operating point, has to remain valid while in use
+ */
+void XPD_RCC_CSS_Init(const RCC_OperatingPointType * Nominal)
+{
+    rcc_cssNominal = Nominal;
+    rcc_cssFailed  = FALSE;
+
+    XPD_RCC_CSS(ENABLE);
+}
+
+/**
+ * @brief Handles the HSE failure, called by @ref XPD_NMI_IRQHandler.
+ * @note  The hardware has already switched SYSCLK to HSI, and stopped the HSE
+ *        and the HSE based PLL.
+ */
+void XPD_RCC_CSS_Failover(void)
+{
+    const RCC_OperatingPointType * nominal = rcc_cssNominal;
+
+    /* the interrupted clock configurations are abandoned */
+    rcc_operatingPointPending = FALSE;
+    rcc_operatingPointReady   = FALSE;
+    rcc_clockTransition = FALSE;
+    rcc_clockTree.PLL = 0;
+
+    SystemCoreClock = XPD_RCC_GetOscFreq(XPD_RCC_GetSYSCLKSource()) >> AHBPrescTable[RCC->CFGR.b.HPRE];
+    rcc_clockTreeUpdate();
+    XPD_InitTimer();
+
+    rcc_clockChanged();
+
+    if (nominal != NULL)
+    {
+        rcc_cssFailed = TRUE;
+
+        if ((nominal->PLL != NULL) && (nominal->PLL->Source == HSE)
+                && (XPD_RCC_GetSYSCLKSource() == HSI))
+        {
+            /* the same VCO input frequency is approximated with the HSI */
+            uint32_t m = (nominal->PLL->M * HSI_VALUE + HSE_VALUE / 2) / HSE_VALUE;
+            uint32_t n;
+
+            if (m < 2)
+            {
+                m = 2;
+            }
+            else if (m > 63)
+            {
+                m = 63;
+            }
+            n = (nominal->PLL->N * m * (HSE_VALUE / 1000)) / (nominal->PLL->M * (HSI_VALUE / 1000));
+            if (n < 50)
+            {
+                n = 50;
+            }
+            else if (n > 432)
+            {
+                n = 432;
+            }
+
+            rcc_cssFallbackPLL        = *nominal->PLL;
+            rcc_cssFallbackPLL.Source = HSI;
+            rcc_cssFallbackPLL.M      = m;
+            rcc_cssFallbackPLL.N      = n;
+
+            rcc_cssFallback           = *nominal;
+            rcc_cssFallback.PLL       = &rcc_cssFallbackPLL;
+            rcc_cssFallback.HSE_State = OSC_OFF;
+
+            /* the PLL is started in the background, the retry completes the switch */
+            (void) XPD_RCC_OperatingPointConfig_IT(&rcc_cssFallback);
+        }
+    }
+}
+
+/**
+ * @brief Attempts to restore the nominal operating point after a HSE failure.
+ *        It shall be called periodically, the HSE is restarted by the first call,
+ *        and the nominal clocks are restored when it's ready.
+ * @return OK if the nominal clocks are in use, BUSY while the HSE or the fallback PLL is starting,
+ *         otherwise the result of @ref XPD_RCC_OperatingPointConfig
+ */
+XPD_ReturnType XPD_RCC_CSS_Retry(void)
+{
+    XPD_ReturnType result = XPD_OK;
+
+    if (rcc_cssFailed != FALSE)
+    {
+        if (rcc_operatingPointPending != FALSE)
+        {
+            /* the fallback PLL switch is completed first */
+            result = XPD_RCC_OperatingPointComplete();
+            if (result == XPD_OK)
+            {
+                result = XPD_BUSY;
+            }
+        }
+        else if (RCC_REG_BIT(CR,HSERDY) == 0)
+        {
+            /* restart the HSE, its startup is checked at the next retry */
+            if (RCC_REG_BIT(CR,HSEON) == 0)
+            {
+                RCC_REG_BIT(CR,HSEBYP) = rcc_cssNominal->HSE_State >> 1;
+                RCC_REG_BIT(CR,HSEON)  = 1;
+            }
+            result = XPD_BUSY;
+        }
+        else
+        {
+            rcc_cssFailed = FALSE;
+
+            result = XPD_RCC_OperatingPointConfig(rcc_cssNominal);
+
+            /* monitor the recovered HSE */
+            XPD_RCC_CSS(ENABLE);
+        }
+    }
+    return result;
+}
+
+/** @} */
+#endif /* HSE_VALUE */
+
 /** @defgroup RCC_Core_Clocks_Exported_Functions_MCO RCC Clock Outputs
  *  @brief    RCC microcontroller clock outputs
  * @{
@@ -730,6 +1445,26 @@ void XPD_RCC_Deinit(void)
     RCC->CIR.w = 0;
 
     SystemCoreClock = HSI_VALUE;
+    rcc_clockTree.SYSCLK = HSI_VALUE;
+    rcc_clockTree.PCLK1  = HSI_VALUE;
+    rcc_clockTree.PCLK2  = HSI_VALUE;
+    rcc_clockTree.PLL    = 0;
+
+    rcc_operatingPointPending = FALSE;
+    rcc_operatingPointReady   = FALSE;
+}
+
+/**
+ * @brief Updates the cached clock frequencies to the current clock configuration,
+ *        which was set up before the application started (e.g. by a boot loader).
+ */
+void XPD_RCC_ClockTreeSync(void)
+{
+    rcc_clockTree.PLL = 0;
+
+    /* Update SystemCoreClock variable */
+    SystemCoreClock = XPD_RCC_GetOscFreq(XPD_RCC_GetSYSCLKSource()) >> AHBPrescTable[RCC->CFGR.b.HPRE];
+    rcc_clockTreeUpdate();
 }
 
 /**
@@ -53,6 +53,54 @@ uint32_t XPD_I2C_GetClockFreq(I2C_HandleType * hi2c)
 
 #endif /* USE_XPD_I2C */
 
+#if defined(USE_XPD_I2S)
+#include "xpd_i2s.h"
+
+/** @addtogroup I2S
+ * @{ */
+
+/** @addtogroup I2S_Clock_Source
+ * @{ */
+
+/** @defgroup I2S_Clock_Source_Exported_Functions I2S Clock Source Exported Functions
+ * @{ */
+
+/**
+ * @brief Sets the new source clock for the I2S peripherals.
+ * @param ClockSource: the new source clock which should be configured
+ */
+void XPD_I2S_ClockConfig(I2S_ClockSourceType ClockSource)
+{
+    RCC_REG_BIT(CFGR, I2SSRC) = ClockSource;
+}
+
+/**
+ * @brief Returns the input clock frequency of the I2S peripherals.
+ * @return The clock frequency of the I2S in Hz
+ */
+uint32_t XPD_I2S_GetClockFreq(void)
+{
+    if (RCC_REG_BIT(CFGR, I2SSRC) == I2S_CLOCKSOURCE_PLLI2S)
+    {
+        return XPD_RCC_GetPLLI2SFreq();
+    }
+    else
+    {
+#ifdef EXTERNAL_CLOCK_VALUE
+        return EXTERNAL_CLOCK_VALUE;
+#else
+        return 0;
+#endif
+    }
+}
+
+/** @} */
+
+/** @} */
+
+/** @} */
+#endif /* USE_XPD_I2S */
+
 #if defined(USE_XPD_RTC)
 #include "xpd_pwr.h"
 #include "xpd_rtc.h"
@@ -145,21 +193,26 @@ uint32_t XPD_RTC_GetClockFreq(void)
     /* Get the current RTC source */
     srcclk = RCC->BDCR.b.RTCSEL;
 
+#ifdef LSE_VALUE
     /* Check if LSE is ready and if RTC clock selection is LSE */
     if ((srcclk == RTC_CLOCKSOURCE_LSE) && (RCC_REG_BIT(BDCR,LSERDY) != 0))
     {
         return LSE_VALUE;
     }
+    else
+#endif
     /* Check if LSI is ready and if RTC clock selection is LSI */
-    else if ((srcclk == RTC_CLOCKSOURCE_LSI) && (RCC_REG_BIT(CSR,LSIRDY) != 0))
+    if ((srcclk == RTC_CLOCKSOURCE_LSI) && (RCC_REG_BIT(CSR,LSIRDY) != 0))
     {
         return LSI_VALUE;
     }
+#ifdef HSE_VALUE
     /* Check if HSE is ready  and if RTC clock selection is HSE / x */
     else if ((srcclk == RTC_CLOCKSOURCE_HSE) && (RCC_REG_BIT(CR,HSERDY) != 0))
     {
         return HSE_VALUE / RCC->CFGR.b.RTCPRE;
     }
+#endif
     /* Clock not enabled for RTC */
     else
     {
@@ -174,6 +227,43 @@ uint32_t XPD_RTC_GetClockFreq(void)
 /** @} */
 #endif /* USE_XPD_RTC */
 
+#if defined(USE_XPD_SPI)
+#include "xpd_spi.h"
+
+/** @addtogroup SPI
+ * @{ */
+
+/** @addtogroup SPI_Clock_Source
+ * @{ */
+
+/** @defgroup SPI_Clock_Source_Exported_Functions SPI Clock Source Exported Functions
+ * @{ */
+
+/**
+ * @brief Returns the input clock frequency of the SPI.
+ * @param hspi: pointer to the SPI handle structure
+ * @return The clock frequency of the SPI in Hz
+ */
+uint32_t XPD_SPI_GetClockFreq(SPI_HandleType * hspi)
+{
+    /* decide which APB bus the SPI is on */
+    if (((uint32_t)hspi->Inst) < APB2PERIPH_BASE)
+    {
+        return XPD_RCC_GetClockFreq(PCLK1);
+    }
+    else
+    {
+        return XPD_RCC_GetClockFreq(PCLK2);
+    }
+}
+
+/** @} */
+
+/** @} */
+
+/** @} */
+#endif /* USE_XPD_SPI */
+
 #if defined(USE_XPD_TIM)
 #include "xpd_tim.h"
 
@@ -0,0 +1,169 @@
+/**
+  ******************************************************************************
+  * @file    xpd_rng.c
+  * @author  Benedek Kupper
+  * @version V0.1
+  * @date    2018-01-20
+  * @brief   STM32 eXtensible Peripheral Drivers RNG Module
+  *
+  *  This file is part of STM32_XPD.
+  *
+  *  STM32_XPD is free software: you can redistribute it and/or modify
+  *  it under the terms of the GNU General Public License as published by
+  *  the Free Software Foundation, either version 3 of the License, or
+  *  (at your option) any later version.
+  *
+  *  STM32_XPD is distributed in the hope that it will be useful,
+  *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with STM32_XPD.  If not, see <http://www.gnu.org/licenses/>.
+  */
+#include "xpd_rng.h"
+#include "xpd_rcc.h"
+
+#if defined(USE_XPD_RNG)
+
+/** @addtogroup RNG
+ * @{ */
+
+/* The entropy pool is a single producer (IRQ) single consumer ring,
+ * its free running counters are only written by their owner */
+static struct {
+    uint32_t Words[RNG_POOL_SIZE];
+    volatile uint32_t Head;
+    volatile uint32_t Tail;
+} rng_pool;
+
+/** @defgroup RNG_Exported_Functions RNG Exported Functions
+ * @{ */
+
+/**
+ * @brief Enables the random number generator and starts filling the entropy pool.
+ * @note  The generator requires a 48 MHz clock source (see RCC), and its interrupt line
+ *        (RNG_IRQn or HASH_RNG_IRQn) shall be enabled with @ref XPD_RNG_IRQHandler called.
+ */
+void XPD_RNG_Init(void)
+{
+    XPD_RNG_ClockCtrl(ENABLE);
+
+    rng_pool.Head = 0;
+    rng_pool.Tail = 0;
+
+    RNG->SR.w = 0;
+    RNG->CR.w = RNG_CR_RNGEN | RNG_CR_IE;
+}
+
+/**
+ * @brief Stops the random number generator and discards the entropy pool.
+ */
+void XPD_RNG_Deinit(void)
+{
+    RNG->CR.w = 0;
+
+    rng_pool.Tail = rng_pool.Head;
+
+    XPD_RNG_ClockCtrl(DISABLE);
+}
+
+/**
+ * @brief Provides the amount of random data available in the entropy pool.
+ * @return The number of readily available random bytes
+ */
+uint32_t XPD_RNG_Available(void)
+{
+    return (rng_pool.Head - rng_pool.Tail) * sizeof(uint32_t);
+}
+
+/**
+ * @brief Copies random data from the entropy pool without waiting for the generator.
+ * @note  Each started 32-bit word is consumed entirely.
+ * @param Buffer: the destination of the random data
+ * @param Length: the number of random bytes to read
+ * @return BUSY if the pool doesn't hold the requested amount (nothing is consumed), OK otherwise
+ */
+XPD_ReturnType XPD_RNG_Read(void * Buffer, uint32_t Length)
+{
+    XPD_ReturnType result = XPD_BUSY;
+    uint32_t tail = rng_pool.Tail;
+
+    if (((rng_pool.Head - tail) * sizeof(uint32_t)) >= Length)
+    {
+        uint8_t * dest = Buffer;
+
+        while (Length > 0)
+        {
+            uint32_t word = rng_pool.Words[tail % RNG_POOL_SIZE];
+            uint32_t i;
+
+            for (i = 0; (i < sizeof(uint32_t)) && (Length > 0); i++, Length--)
+            {
+                *dest++ = (uint8_t)word;
+                word >>= 8;
+            }
+            tail++;
+        }
+        rng_pool.Tail = tail;
+
+        /* Resume the refilling of the pool */
+        RNG->CR.b.IE = 1;
+
+        result = XPD_OK;
+    }
+    return result;
+}
+
+/**
+ * @brief RNG interrupt handler that stores the generated words in the entropy pool,
+ *        recovers from seed errors and provides error callbacks.
+ */
+void XPD_RNG_IRQHandler(void)
+{
+    uint32_t sr = RNG->SR.w;
+    uint32_t errors = sr & (RNG_SR_CEIS | RNG_SR_SEIS);
+
+    XPD_PROFILE_BEGIN();
+
+    if (errors != 0)
+    {
+        RNG->SR.w = ~errors;
+
+        if ((errors & RNG_SR_SEIS) != 0)
+        {
+            /* The pending word is invalid, the generator is restarted */
+            RNG->CR.b.RNGEN = 0;
+            RNG->CR.b.RNGEN = 1;
+            sr = 0;
+        }
+
+        XPD_SAFE_CALLBACK(XPD_RNG_Callbacks.Error, errors);
+    }
+
+    if ((sr & RNG_SR_DRDY) != 0)
+    {
+        uint32_t head = rng_pool.Head;
+
+        if ((head - rng_pool.Tail) < RNG_POOL_SIZE)
+        {
+            rng_pool.Words[head % RNG_POOL_SIZE] = RNG->DR;
+            rng_pool.Head = head + 1;
+        }
+        else
+        {
+            /* The pool is full, refilling is resumed by the next read */
+            RNG->CR.b.IE = 0;
+        }
+    }
+
+    XPD_PROFILE_END();
+}
+
+/** @} */
+
+XPD_RNG_CallbacksType XPD_RNG_Callbacks = { NULL };
+
+/** @} */
+
+#endif /* USE_XPD_RNG */
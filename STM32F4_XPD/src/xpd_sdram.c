@@ -0,0 +1,224 @@
+/**
+  ******************************************************************************
+  * @file    xpd_sdram.c
+  * @author  Benedek Kupper
+  * @version V0.1
+  * @date    2018-01-20
+  * @brief   STM32 eXtensible Peripheral Drivers FMC SDRAM Module
+  *
+  *  This file is part of STM32_XPD.
+  *
+  *  STM32_XPD is free software: you can redistribute it and/or modify
+  *  it under the terms of the GNU General Public License as published by
+  *  the Free Software Foundation, either version 3 of the License, or
+  *  (at your option) any later version.
+  *
+  *  STM32_XPD is distributed in the hope that it will be useful,
+  *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with STM32_XPD.  If not, see <http://www.gnu.org/licenses/>.
+  */
+#include "xpd_sdram.h"
+#include "xpd_rcc.h"
+#include "xpd_utils.h"
+
+#if defined(USE_XPD_SDRAM) && defined(FMC_Bank5_6)
+
+/** @addtogroup SDRAM
+ * @{ */
+
+#define SDRAM_CMD_TIMEOUT       1
+
+/* Command modes */
+#define SDRAM_CMD_NORMAL        0
+#define SDRAM_CMD_CLK_ENABLE    1
+#define SDRAM_CMD_PALL          2
+#define SDRAM_CMD_AUTOREFRESH   3
+#define SDRAM_CMD_LOAD_MODE     4
+#define SDRAM_CMD_SELFREFRESH   5
+
+/* Mode register: burst length 1, sequential burst, standard operation, single write burst */
+#define SDRAM_MODE_CAS_Pos          4
+#define SDRAM_MODE_WRITEBURST_SINGLE 0x0200
+
+#define SDRAM_AUTOREFRESH_COUNT     8
+#define SDRAM_POWERUP_DELAY_US      100
+
+/* The refresh timer counts from the safety margin before the refresh request */
+#define SDRAM_REFRESH_MARGIN        20
+
+/* Register reset values */
+#define SDRAM_SDCR_RESET            0x000002D0
+#define SDRAM_SDTR_RESET            0x0FFFFFFF
+
+/* Converts a delay in ns to the timing register field of memory clock cycles */
+static uint32_t sdram_cycles(uint32_t ns, uint32_t sdclk)
+{
+    uint32_t cycles = (uint32_t)((((uint64_t)ns * sdclk) + 999999999) / 1000000000);
+
+    if (cycles < 1)
+    {
+        cycles = 1;
+    }
+    else if (cycles > 16)
+    {
+        cycles = 16;
+    }
+    return cycles - 1;
+}
+
+/* Issues an SDRAM command to the bank of the handle */
+static XPD_ReturnType sdram_command(SDRAM_HandleType * hsdram, uint32_t Mode,
+        uint32_t Refreshes, uint32_t ModeRegister)
+{
+    uint32_t timeout = SDRAM_CMD_TIMEOUT;
+    XPD_ReturnType result;
+
+    result = XPD_WaitForMatch(&FMC_Bank5_6->SDSR.w, FMC_SDSR_BUSY, 0, &timeout);
+
+    if (result == XPD_OK)
+    {
+        FMC_Bank5_6->SDCMR.w = Mode
+                | ((hsdram->Bank == SDRAM_BANK1) ? FMC_SDCMR_CTB1 : FMC_SDCMR_CTB2)
+                | ((Refreshes - 1) << FMC_SDCMR_NRFS_Pos)
+                | (ModeRegister << FMC_SDCMR_MRD_Pos);
+
+        result = XPD_WaitForMatch(&FMC_Bank5_6->SDSR.w, FMC_SDSR_BUSY, 0, &timeout);
+    }
+    return result;
+}
+
+/** @defgroup SDRAM_Exported_Functions SDRAM Exported Functions
+ * @{ */
+
+/**
+ * @brief Initializes the FMC SDRAM bank and performs the memory power-up sequence.
+ * @note  The memory timings are calculated from the current HCLK frequency,
+ *        so the clock tree must not change while the memory is in use.
+ *        The memory clock frequency shall not exceed 90 MHz.
+ * @param hsdram: pointer to the SDRAM handle structure
+ * @param Config: pointer to SDRAM setup configuration
+ * @return TIMEOUT if the controller doesn't execute the commands, OK if the memory is ready
+ */
+XPD_ReturnType XPD_SDRAM_Init(SDRAM_HandleType * hsdram, const SDRAM_InitType * Config)
+{
+    XPD_ReturnType result;
+    uint32_t sdclk = XPD_RCC_GetClockFreq(HCLK) / Config->ClockDivider;
+    uint32_t sdcr, sdtr, common, count;
+
+    /* enable clock */
+    XPD_SAFE_CALLBACK(hsdram->ClockCtrl, ENABLE);
+
+    /* Dependencies initialization */
+    XPD_SAFE_CALLBACK(hsdram->Callbacks.DepInit, hsdram);
+
+    /* The clock, burst and pipe settings are common, and only set in the first bank's register */
+    common = ((uint32_t)Config->ClockDivider << FMC_SDCR1_SDCLK_Pos)
+           | ((uint32_t)Config->ReadPipeDelay << FMC_SDCR1_RPIPE_Pos)
+           | ((Config->ReadBurst != DISABLE) ? FMC_SDCR1_RBURST : 0);
+
+    sdcr = ((uint32_t)(Config->ColumnBits - 8) << FMC_SDCR1_NC_Pos)
+         | ((uint32_t)(Config->RowBits - 11) << FMC_SDCR1_NR_Pos)
+         | ((uint32_t)Config->BusWidth << FMC_SDCR1_MWID_Pos)
+         | ((Config->InternalBanks == 4) ? FMC_SDCR1_NB : 0)
+         | ((uint32_t)Config->CASLatency << FMC_SDCR1_CAS_Pos);
+
+    /* The row cycle and precharge delays are common, and only set in the first bank's register */
+    sdtr = (((uint32_t)Config->Timing.LoadToActive - 1) << FMC_SDTR1_TMRD_Pos)
+         | (sdram_cycles(Config->Timing.ExitSelfRefresh, sdclk) << FMC_SDTR1_TXSR_Pos)
+         | (sdram_cycles(Config->Timing.SelfRefresh, sdclk) << FMC_SDTR1_TRAS_Pos)
+         | (((uint32_t)Config->Timing.WriteRecovery - 1) << FMC_SDTR1_TWR_Pos)
+         | (sdram_cycles(Config->Timing.RowToColumn, sdclk) << FMC_SDTR1_TRCD_Pos);
+
+    if (hsdram->Bank == SDRAM_BANK1)
+    {
+        FMC_Bank5_6->SDCR[0].w = sdcr | common;
+        FMC_Bank5_6->SDTR[0].w = sdtr
+                | (sdram_cycles(Config->Timing.RowCycle, sdclk) << FMC_SDTR1_TRC_Pos)
+                | (sdram_cycles(Config->Timing.RowPrecharge, sdclk) << FMC_SDTR1_TRP_Pos);
+    }
+    else
+    {
+        MODIFY_REG(FMC_Bank5_6->SDCR[0].w,
+                FMC_SDCR1_SDCLK | FMC_SDCR1_RPIPE | FMC_SDCR1_RBURST, common);
+        FMC_Bank5_6->SDCR[1].w = sdcr;
+
+        MODIFY_REG(FMC_Bank5_6->SDTR[0].w, FMC_SDTR1_TRC | FMC_SDTR1_TRP,
+                (sdram_cycles(Config->Timing.RowCycle, sdclk) << FMC_SDTR1_TRC_Pos)
+              | (sdram_cycles(Config->Timing.RowPrecharge, sdclk) << FMC_SDTR1_TRP_Pos));
+        FMC_Bank5_6->SDTR[1].w = sdtr;
+    }
+
+    /* Power-up sequence: clock enable, precharge all, auto-refresh cycles, mode register load */
+    result = sdram_command(hsdram, SDRAM_CMD_CLK_ENABLE, 1, 0);
+    if (result == XPD_OK)
+    {
+        XPD_Delay_us(SDRAM_POWERUP_DELAY_US);
+
+        result = sdram_command(hsdram, SDRAM_CMD_PALL, 1, 0);
+    }
+    if (result == XPD_OK)
+    {
+        result = sdram_command(hsdram, SDRAM_CMD_AUTOREFRESH, SDRAM_AUTOREFRESH_COUNT, 0);
+    }
+    if (result == XPD_OK)
+    {
+        result = sdram_command(hsdram, SDRAM_CMD_LOAD_MODE, 1,
+                ((uint32_t)Config->CASLatency << SDRAM_MODE_CAS_Pos) | SDRAM_MODE_WRITEBURST_SINGLE);
+    }
+    if (result == XPD_OK)
+    {
+        /* Each row has to be refreshed within the refresh period */
+        count = (uint32_t)(((uint64_t)sdclk * Config->RefreshPeriod / 1000) >> Config->RowBits);
+        FMC_Bank5_6->SDRTR.w = (count - SDRAM_REFRESH_MARGIN) << FMC_SDRTR_COUNT_Pos;
+
+        hsdram->Address = (void*)((hsdram->Bank == SDRAM_BANK1) ?
+                SDRAM_BANK1_ADDRESS : SDRAM_BANK2_ADDRESS);
+        hsdram->Size = ((uint32_t)Config->InternalBanks << (Config->ColumnBits + Config->RowBits))
+                << Config->BusWidth;
+    }
+    return result;
+}
+
+/**
+ * @brief Restores the FMC SDRAM bank to its default state.
+ * @param hsdram: pointer to the SDRAM handle structure
+ * @return ERROR if input is incorrect, OK if success
+ */
+XPD_ReturnType XPD_SDRAM_Deinit(SDRAM_HandleType * hsdram)
+{
+    FMC_Bank5_6->SDCR[hsdram->Bank].w = SDRAM_SDCR_RESET;
+    FMC_Bank5_6->SDTR[hsdram->Bank].w = SDRAM_SDTR_RESET;
+
+    /* Deinitialize peripheral dependencies */
+    XPD_SAFE_CALLBACK(hsdram->Callbacks.DepDeinit, hsdram);
+
+    /* disable clock */
+    XPD_SAFE_CALLBACK(hsdram->ClockCtrl, DISABLE);
+
+    hsdram->Size = 0;
+
+    return XPD_OK;
+}
+
+/**
+ * @brief Puts the memory to self-refresh mode, in which it retains its contents
+ *        without the controller's refresh commands, or returns to normal mode.
+ * @param hsdram: pointer to the SDRAM handle structure
+ * @param NewState: whether the memory enters or exits self-refresh mode
+ * @return TIMEOUT if the controller doesn't execute the command, OK if success
+ */
+XPD_ReturnType XPD_SDRAM_SelfRefresh(SDRAM_HandleType * hsdram, FunctionalState NewState)
+{
+    return sdram_command(hsdram, (NewState != DISABLE) ?
+            SDRAM_CMD_SELFREFRESH : SDRAM_CMD_NORMAL, 1, 0);
+}
+
+/** @} */
+
+/** @} */
+
+#endif /* USE_XPD_SDRAM */
@@ -63,14 +63,32 @@
 #define USART_TXDR(HANDLE)          ((HANDLE)->Inst->DR)
 #endif
 
+#define USART_DATA_EVENTS           (USART_STATF(RXNE) | USART_STATF(TXE) | \
+                                     USART_STATF(TC)   | USART_STATF(IDLE))
+
+#if (USART_PERIPHERAL_VERSION > 2)
+#define USART_RARE_EVENTS           (USART_STATF(PE)  | USART_STATF(FE)  | \
+                                     USART_STATF(NE)  | USART_STATF(ORE) | \
+                                     USART_STATF(LBD) | USART_STATF(CTS) | \
+                                     USART_ISR_WUF)
+#else
+#define USART_RARE_EVENTS           (USART_STATF(PE)  | USART_STATF(FE)  | \
+                                     USART_STATF(NE)  | USART_STATF(ORE) | \
+                                     USART_STATF(LBD) | USART_STATF(CTS))
+#endif
+
+#ifndef XPD_USART_EXCLUDE_DMA
 #ifdef USE_XPD_DMA_ERROR_DETECT
 static void usart_dmaErrorRedirect(void *hdma)
 {
     USART_HandleType * husart = (USART_HandleType*) ((DMA_HandleType*) hdma)->Owner;
 
     husart->Errors |= USART_ERROR_DMA;
+    XPD_STATS_ERROR(husart, USART_ERROR_DMA);
 
     XPD_SAFE_CALLBACK(husart->Callbacks.Error, husart);
+    XPD_OS_SIGNAL(husart->Signal.Transmit);
+    XPD_OS_SIGNAL(husart->Signal.Receive);
 }
 #endif
 
@@ -88,12 +106,14 @@ static void usart_dmaTransmitRedirect(void *hdma)
         XPD_USART_EnableIT(husart, TC);
 
         /* Update stream status */
+        XPD_STATS_ADD(husart, Bytes, husart->TxStream.length * husart->TxStream.size);
         husart->TxStream.buffer += husart->TxStream.length * husart->TxStream.size;
         husart->TxStream.length = 0;
     }
     /* DMA circular mode */
     else
     {
+        XPD_STATS_ADD(husart, Transfers, 1);
         XPD_SAFE_CALLBACK(husart->Callbacks.Transmit, husart);
     }
 }
@@ -109,16 +129,161 @@ static void usart_dmaReceiveRedirect(void *hdma)
         USART_REG_BIT(husart, CR3, DMAR) = 0;
 
         /* Update stream status */
+        XPD_STATS_ADD(husart, Bytes, husart->RxStream.length * husart->RxStream.size);
         husart->RxStream.buffer += husart->RxStream.length * husart->RxStream.size;
         husart->RxStream.length = 0;
     }
+    XPD_STATS_ADD(husart, Transfers, 1);
+    XPD_SAFE_CALLBACK(husart->Callbacks.Receive, husart);
+    XPD_OS_SIGNAL(husart->Signal.Receive);
+}
+
+/* Collects the contiguous queued blocks from the queue tail, returns the number of merged blocks */
+static uint8_t usart_txQueueCollect(USART_HandleType * husart, void ** data, uint16_t * length)
+{
+    uint8_t count = 0, index = husart->TxQueue.Tail, head = husart->TxQueue.Head;
+    uint32_t total = 0;
+    uint8_t * end = husart->TxQueue.Buffer[index].MemAddress;
+
+    *data = end;
+
+    /* merge the blocks which directly follow each other in memory */
+    while ((index != head) && (husart->TxQueue.Buffer[index].MemAddress == end) &&
+           ((total + husart->TxQueue.Buffer[index].DataCount) <= 0xFFFF))
+    {
+        total += husart->TxQueue.Buffer[index].DataCount;
+        end   += husart->TxQueue.Buffer[index].DataCount * husart->TxStream.size;
+        count++;
+
+        if (++index >= husart->TxQueue.Size)
+        {
+            index = 0;
+        }
+    }
+    *length = total;
+
+    return count;
+}
+
+static void usart_dmaTxQueueRedirect(void *hdma)
+{
+    USART_HandleType * husart = (USART_HandleType*) ((DMA_HandleType*) hdma)->Owner;
+    uint32_t tail = husart->TxQueue.Tail + husart->TxQueue.Pending;
+
+    /* release the transferred blocks */
+    if (tail >= husart->TxQueue.Size)
+    {
+        tail -= husart->TxQueue.Size;
+    }
+    husart->TxQueue.Tail = tail;
+    husart->TxQueue.Pending = 0;
+
+    XPD_STATS_ADD(husart, Bytes, husart->TxStream.length * husart->TxStream.size);
+    husart->TxStream.buffer += husart->TxStream.length * husart->TxStream.size;
+    husart->TxStream.length = 0;
+
+    if (husart->TxQueue.Head != husart->TxQueue.Tail)
+    {
+        /* Continue with the next queued data while the last element is being shifted out */
+        husart->TxQueue.Pending = usart_txQueueCollect(husart,
+                &husart->TxStream.buffer, &husart->TxStream.length);
+
+        (void) XPD_DMA_Start_IT(husart->DMA.Transmit, (void*) &USART_TXDR(husart),
+                husart->TxStream.buffer, husart->TxStream.length);
+    }
+    else
+    {
+        /* Disable Tx DMA Request */
+        USART_REG_BIT(husart, CR3, DMAT) = 0;
+
+        /* Transmit complete interrupt will provide callback */
+        XPD_USART_EnableIT(husart, TC);
+    }
+}
+
+static void usart_dmaRxRingRedirect(void *hdma)
+{
+    USART_HandleType * husart = (USART_HandleType*) ((DMA_HandleType*) hdma)->Owner;
+
+    /* new data is available in the circular buffer */
+    XPD_SAFE_CALLBACK(husart->Callbacks.Receive, husart);
+}
+
+/* Gets the element index of the circular buffer which is written next by the DMA */
+static uint16_t usart_rxRingHead(USART_HandleType * husart)
+{
+    uint16_t head;
+
+    /* the snapshot is consistent even if the buffer wraps around meanwhile */
+    (void) XPD_DMA_GetPosition(husart->DMA.Receive, NULL, &head);
+
+    return head;
+}
+
+#ifdef USART_CR2_RTOEN
+/* Finishes the framed reception at the frame end or when the buffer is full */
+static void usart_frameEnd(USART_HandleType * husart)
+{
+    uint16_t remaining;
+    uint32_t timeout = 1;
+
+    XPD_USART_DisableIT(husart, RTO);
+    XPD_USART_DisableIT(husart, CM);
+    XPD_USART_ClearFlag(husart, RTO);
+    XPD_USART_ClearFlag(husart, CM);
+
+    /* the matched character is only transferred by the DMA after the flag is set */
+    if (XPD_DMA_GetStatus(husart->DMA.Receive) > 0)
+    {
+        (void) XPD_WaitForMatch(&USART_STATR(husart), USART_STATF(RXNE), 0, &timeout);
+    }
+
+    USART_REG_BIT(husart, CR3, DMAR) = 0;
+
+    /* The frame length is given by the transfer counter */
+    remaining = XPD_DMA_GetStatus(husart->DMA.Receive);
+    XPD_DMA_Stop_IT(husart->DMA.Receive);
+
+#ifndef XPD_USART_EXCLUDE_MODES
+    /* multidrop endpoint: wait muted for the next own address mark */
+    if ((husart->Inst->CR1.w & (USART_CR1_MME | USART_CR1_WAKE)) == (USART_CR1_MME | USART_CR1_WAKE))
+    {
+        husart->Inst->RQR.w = USART_RQR_MMRQ;
+    }
+#endif
+
+    husart->RxFrameLength = husart->RxStream.length - remaining;
+    husart->RxStream.buffer += husart->RxFrameLength * husart->RxStream.size;
+    husart->RxStream.length = remaining;
+
+    XPD_STATS_ADD(husart, Bytes, husart->RxFrameLength * husart->RxStream.size);
+    XPD_STATS_ADD(husart, Transfers, 1);
     XPD_SAFE_CALLBACK(husart->Callbacks.Receive, husart);
+    XPD_OS_SIGNAL(husart->Signal.Receive);
 }
 
+static void usart_dmaFrameRedirect(void *hdma)
+{
+    usart_frameEnd((USART_HandleType*) ((DMA_HandleType*) hdma)->Owner);
+}
+#endif
+#endif /* XPD_USART_EXCLUDE_DMA */
+
 /* Calculates and configures the baudrate */
 static void usart_baudrateConfig(USART_HandleType * husart, uint32_t baudrate)
 {
+    husart->BaudRate = baudrate;
+
 #if (USART_PERIPHERAL_VERSION > 1)
+#ifdef LPUART1
+    if (husart->Inst == LPUART1)
+    {
+        /* LPUART divider has 8 fractional bits */
+        husart->Inst->BRR.w = (uint32_t)((((uint64_t)XPD_USART_GetClockFreq(husart) << 8)
+                + (baudrate / 2)) / baudrate);
+    }
+    else
+#endif
     if (USART_REG_BIT(husart, CR1, OVER8) == 0)
     {
         husart->Inst->BRR.w = (XPD_USART_GetClockFreq(husart) + (baudrate / 2)) / baudrate;
@@ -154,23 +319,86 @@ static void usart_setDirection(USART_HandleType * husart, uint32_t direction)
     }
 }
 
-/* First stage of initialization */
-static XPD_ReturnType usart_init1(USART_HandleType * husart, const USART_InitType * Common)
+#ifndef XPD_USART_EXCLUDE_DMA
+/* Sets up the DMA-managed data transmission with the selected DMA completion callback */
+static XPD_ReturnType usart_transmitDMA(USART_HandleType * husart, void * TxData, uint16_t Length,
+        XPD_HandleCallbackType completeCallback)
 {
-    uint8_t framesize;
+    XPD_ReturnType result;
 
-    /* enable clock */
-    XPD_SAFE_CALLBACK(husart->ClockCtrl, ENABLE);
+    /* save stream info */
+    husart->TxStream.buffer = TxData;
+    husart->TxStream.length = Length;
 
-    /* Dependencies initialization */
-    XPD_SAFE_CALLBACK(husart->Callbacks.DepInit, husart);
+    /* Set up DMA for transfer */
+    result = XPD_DMA_Start_IT(husart->DMA.Transmit, (void*) &USART_TXDR(husart), TxData, Length);
 
-    husart->Inst->CR1.w = 0;
-    husart->Inst->CR2.w = 0;
-    husart->Inst->CR3.w = 0;
+    if (result == XPD_OK)
+    {
+        /* Set the callback owner */
+        husart->DMA.Transmit->Owner = husart;
+
+        /* Set the DMA transfer callbacks */
+        husart->DMA.Transmit->Callbacks.Complete     = completeCallback;
+#ifdef USE_XPD_DMA_ERROR_DETECT
+        husart->DMA.Transmit->Callbacks.Error        = usart_dmaErrorRedirect;
+#endif
+        USART_RESET_ERRORS(husart);
+
+        /* The direction has to be set in half-duplex mode */
+        usart_setDirection(husart, USART_CR1_TE);
+
+        XPD_USART_ClearFlag(husart, TC);
+
+        USART_REG_BIT(husart, CR3, DMAT) = 1;
+    }
+    return result;
+}
+#endif /* XPD_USART_EXCLUDE_DMA */
+
+#ifdef USE_XPD_OS
+/* Waits until the stream is finished and the masked interrupts are disabled,
+ * the transfer of the direction is stopped if it fails */
+static XPD_ReturnType usart_waitBlocking(USART_HandleType * husart, XPD_OS_SignalType * signal,
+        DataStreamType * stream, uint32_t cr1mask, uint32_t * timeout)
+{
+    XPD_ReturnType result = XPD_OK;
+
+    while ((stream->length > 0) || ((husart->Inst->CR1.w & cr1mask) != 0))
+    {
+        result = XPD_OS_SignalWait(signal, timeout);
+
+#if defined(USE_XPD_USART_ERROR_DETECT) || defined(USE_XPD_DMA_ERROR_DETECT)
+        if ((result == XPD_OK) && (husart->Errors != USART_ERROR_NONE))
+        {
+            result = XPD_ERROR;
+        }
+#endif
+        if (result != XPD_OK)
+        {
+#ifndef XPD_USART_EXCLUDE_DMA
+            uint32_t dmaEnable = (stream == &husart->TxStream) ? USART_CR3_DMAT : USART_CR3_DMAR;
+
+            if ((husart->Inst->CR3.w & dmaEnable) != 0)
+            {
+                CLEAR_BIT(husart->Inst->CR3.w, dmaEnable);
+                XPD_DMA_Stop_IT((stream == &husart->TxStream) ?
+                        husart->DMA.Transmit : husart->DMA.Receive);
+            }
+#endif
+            /* Stop the interrupt driven transfer */
+            CLEAR_BIT(husart->Inst->CR1.w, cr1mask);
+            break;
+        }
+    }
+    return result;
+}
+#endif /* USE_XPD_OS */
 
-    /* configure frame format and mode */
-    framesize = Common->DataSize + (uint8_t)(Common->Parity != USART_PARITY_NONE);
+/* Sets the frame format bits and returns the matching data transfer size */
+static uint8_t usart_frameConfig(USART_HandleType * husart, const USART_InitType * Common)
+{
+    uint8_t framesize = Common->DataSize + (uint8_t)(Common->Parity != USART_PARITY_NONE);
 
     USART_REG_BIT(husart, CR1, PS)     = Common->Parity;
     USART_REG_BIT(husart, CR1, PCE)    = Common->Parity >> 1;
@@ -181,9 +409,8 @@ static XPD_ReturnType usart_init1(USART_HandleType * husart, const USART_InitTyp
 #else
     USART_REG_BIT(husart, CR1, M)      = (uint32_t)(framesize > 8);
 #endif
-    USART_REG_BIT(husart, CR3, ONEBIT) = Common->SingleSample;
 
-    /* Set data transfer size */
+    /* Get data transfer size */
     switch (husart->Inst->CR1.w & (USART_CR1_M | USART_CR1_PCE))
     {
         /* data size = 9, no parity -> mask = 0x1FF */
@@ -192,8 +419,7 @@ static XPD_ReturnType usart_init1(USART_HandleType * husart, const USART_InitTyp
 #else
         case USART_CR1_M:
 #endif
-            husart->TxStream.size = husart->RxStream.size = 2;
-            break;
+            return 2;
 
 #ifdef USART_CR1_M1
         /* data size = 7 including parity -> mask = 0x3F */
@@ -205,9 +431,27 @@ static XPD_ReturnType usart_init1(USART_HandleType * husart, const USART_InitTyp
         case USART_CR1_PCE:
         /* data size = 8, or = 9 with parity -> mask = 0xFF */
         default:
-            husart->TxStream.size = husart->RxStream.size = 1;
-            break;
+            return 1;
     }
+}
+
+/* First stage of initialization */
+static XPD_ReturnType usart_init1(USART_HandleType * husart, const USART_InitType * Common)
+{
+    /* enable clock */
+    XPD_SAFE_CALLBACK(husart->ClockCtrl, ENABLE);
+
+    /* Dependencies initialization */
+    XPD_SAFE_CALLBACK(husart->Callbacks.DepInit, husart);
+
+    husart->Inst->CR1.w = 0;
+    husart->Inst->CR2.w = 0;
+    husart->Inst->CR3.w = 0;
+
+    /* configure frame format and mode, set data transfer size */
+    husart->TxStream.size = husart->RxStream.size = usart_frameConfig(husart, Common);
+    USART_REG_BIT(husart, CR3, ONEBIT) = Common->SingleSample;
+
     husart->TxStream.length = husart->RxStream.length = 0;
 
     return XPD_OK;
@@ -308,6 +552,7 @@ XPD_ReturnType XPD_USART_PollStatus(USART_HandleType * husart, uint32_t Timeout)
     {
         /* Update error code */
         husart->Errors |= USART_ERROR_PARITY;
+        XPD_STATS_ERROR(husart, USART_ERROR_PARITY);
 
         /* Clear the transfer error flag */
         XPD_USART_ClearFlag(husart, PE);
@@ -318,6 +563,7 @@ XPD_ReturnType XPD_USART_PollStatus(USART_HandleType * husart, uint32_t Timeout)
     {
         /* Update error code */
         husart->Errors |= USART_ERROR_NOISE;
+        XPD_STATS_ERROR(husart, USART_ERROR_NOISE);
 
         /* Clear the transfer error flag */
         XPD_USART_ClearFlag(husart, NE);
@@ -328,6 +574,7 @@ XPD_ReturnType XPD_USART_PollStatus(USART_HandleType * husart, uint32_t Timeout)
     {
         /* Update error code */
         husart->Errors |= USART_ERROR_FRAME;
+        XPD_STATS_ERROR(husart, USART_ERROR_FRAME);
 
         /* Clear the transfer error flag */
         XPD_USART_ClearFlag(husart, FE);
@@ -338,6 +585,7 @@ XPD_ReturnType XPD_USART_PollStatus(USART_HandleType * husart, uint32_t Timeout)
     {
         /* Update error code */
         husart->Errors |= USART_ERROR_OVERRUN;
+        XPD_STATS_ERROR(husart, USART_ERROR_OVERRUN);
 
         /* Clear the transfer error flag */
         XPD_USART_ClearFlag(husart, ORE);
@@ -556,16 +804,29 @@ void XPD_USART_TransmitReceive_IT(USART_HandleType * husart, void * TxData, void
  */
 void XPD_USART_IRQHandler(USART_HandleType * husart)
 {
+    XPD_PROFILE_BEGIN();
+    XPD_STATS_IRQ_BEGIN();
+
     uint32_t sr  = USART_STATR(husart);
     uint32_t cr1 = husart->Inst->CR1.w;
-    uint32_t cr2 = husart->Inst->CR2.w;
-    uint32_t cr3 = husart->Inst->CR3.w;
+    uint32_t cr3 = 0;
+
+    /* the data event flags share their bit positions with the CR1 enable bits,
+     * so the active data events are resolved with a single mask */
+    uint32_t active = sr & cr1 & USART_DATA_EVENTS;
+
+    /* CR3 is only read if a rare event is flagged */
+    if ((sr & USART_RARE_EVENTS) != 0)
+    {
+        cr3 = husart->Inst->CR3.w;
+    }
 
 #ifdef USE_XPD_USART_ERROR_DETECT
     /* parity error */
     if (((sr & USART_STATF(PE)) != 0) && ((cr1 & USART_CR1_PEIE) != 0))
     {
         husart->Errors |= USART_ERROR_PARITY;
+        XPD_STATS_ERROR(husart, USART_ERROR_PARITY);
         XPD_USART_ClearFlag(husart, PE);
     }
     /* channel errors */
@@ -574,29 +835,73 @@ void XPD_USART_IRQHandler(USART_HandleType * husart)
         if ((sr & USART_STATF(NE)) != 0)
         {
             husart->Errors |= USART_ERROR_NOISE;
+            XPD_STATS_ERROR(husart, USART_ERROR_NOISE);
             XPD_USART_ClearFlag(husart, NE);
         }
         if ((sr & USART_STATF(FE)) != 0)
         {
             husart->Errors |= USART_ERROR_FRAME;
+            XPD_STATS_ERROR(husart, USART_ERROR_FRAME);
             XPD_USART_ClearFlag(husart, FE);
         }
         if ((sr & USART_STATF(ORE)) != 0)
         {
             husart->Errors |= USART_ERROR_OVERRUN;
+            XPD_STATS_ERROR(husart, USART_ERROR_OVERRUN);
             XPD_USART_ClearFlag(husart, ORE);
         }
     }
     if (husart->Errors != USART_ERROR_NONE)
     {
+        XPD_TRACE(XPD_TRACE_USART_ERROR, husart->Errors);
         XPD_SAFE_CALLBACK(husart->Callbacks.Error, husart);
+        XPD_OS_SIGNAL(husart->Signal.Receive);
+    }
+#endif
+
+#if defined(USART_CR2_ABREN) && !defined(XPD_USART_EXCLUDE_DMA)
+    /* auto baudrate detection character received */
+    if (((active & USART_STATF(RXNE)) != 0) && (husart->AutoBaud != 0)
+     && ((sr & (USART_ISR_ABRF | USART_ISR_ABRE)) != 0))
+    {
+        active &= ~USART_STATF(RXNE);
+        husart->Inst->RQR.w = USART_RQR_RXFRQ;
+
+        if ((sr & USART_ISR_ABRE) != 0)
+        {
+            /* retry on the next character */
+            husart->Inst->RQR.w = USART_RQR_ABRRQ;
+        }
+        else
+        {
+            uint32_t brr = husart->Inst->BRR.w;
+
+            XPD_USART_DisableIT(husart, RXNE);
+            husart->AutoBaud = 0;
+
+            /* the detected baudrate is used until the next clock update */
+            if (USART_REG_BIT(husart, CR1, OVER8) == 0)
+            {
+                husart->BaudRate = XPD_USART_GetClockFreq(husart) / brr;
+            }
+            else
+            {
+                brr = (brr & USART_BRR_DIV_MANTISSA) | ((brr & (USART_BRR_DIV_FRACTION >> 1)) << 1);
+                husart->BaudRate = (XPD_USART_GetClockFreq(husart) * 2) / brr;
+            }
+
+            (void) XPD_USART_RxRing_Start(husart, husart->RxStream.buffer, husart->RxStream.length);
+
+            XPD_SAFE_CALLBACK(husart->Callbacks.AutoBaud, husart);
+        }
     }
 #endif
 
     /* successful reception */
-    if (((sr & USART_STATF(RXNE)) != 0) && ((cr1 & USART_CR1_RXNEIE) != 0))
+    if ((active & USART_STATF(RXNE)) != 0)
     {
         XPD_ReadToStream((__IO uint32_t*)&USART_RXDR(husart), &husart->RxStream);
+        XPD_STATS_ADD(husart, Bytes, husart->RxStream.size);
 
         /* End of reception */
         if (husart->RxStream.length == 0)
@@ -608,14 +913,18 @@ void XPD_USART_IRQHandler(USART_HandleType * husart)
 #endif
 
             /* reception finished callback */
+            XPD_TRACE(XPD_TRACE_USART_RECEIVE, (uint32_t)husart->Inst);
+            XPD_STATS_ADD(husart, Transfers, 1);
             XPD_SAFE_CALLBACK(husart->Callbacks.Receive, husart);
+            XPD_OS_SIGNAL(husart->Signal.Receive);
         }
     }
 
     /* successful transmission */
-    if (((sr & USART_STATF(TXE)) != 0) && ((cr1 & USART_CR1_TXEIE) != 0))
+    if ((active & USART_STATF(TXE)) != 0)
     {
         XPD_WriteFromStream(&USART_TXDR(husart), &husart->TxStream);
+        XPD_STATS_ADD(husart, Bytes, husart->TxStream.size);
 
         /* last transmission, disable TXE, enable transmit complete interrupt */
         if (husart->TxStream.length == 0)
@@ -626,30 +935,55 @@ void XPD_USART_IRQHandler(USART_HandleType * husart)
     }
 
     /* last element in data stream is transmitted successfully */
-    else if (((sr & USART_STATF(TC)) != 0) && ((cr1 & USART_CR1_TCIE) != 0))
+    else if ((active & USART_STATF(TC)) != 0)
     {
         XPD_USART_ClearFlag(husart, TC);
         XPD_USART_DisableIT(husart, TC);
 
         /* transmission finished callback */
+        XPD_TRACE(XPD_TRACE_USART_TRANSMIT, (uint32_t)husart->Inst);
+        XPD_STATS_ADD(husart, Transfers, 1);
         XPD_SAFE_CALLBACK(husart->Callbacks.Transmit, husart);
+        XPD_OS_SIGNAL(husart->Signal.Transmit);
     }
 
     /* IDLE detected */
-    if (((sr & USART_STATF(IDLE)) != 0) && ((cr1 & USART_CR1_IDLEIE) != 0))
+    if ((active & USART_STATF(IDLE)) != 0)
     {
         XPD_USART_ClearFlag(husart, IDLE);
+        XPD_TRACE(XPD_TRACE_USART_IDLE, (uint32_t)husart->Inst);
+
+#ifndef XPD_USART_EXCLUDE_DMA
+        /* circular DMA reception: the end of the received frame is available */
+        if (((husart->Inst->CR3.w & USART_CR3_DMAR) != 0) && (XPD_DMA_CircularMode(husart->DMA.Receive) != 0))
+        {
+            XPD_STATS_ADD(husart, Transfers, 1);
+            XPD_SAFE_CALLBACK(husart->Callbacks.Receive, husart);
+        }
+#endif
 
         XPD_SAFE_CALLBACK(husart->Callbacks.Idle, husart);
     }
 
+#if defined(USART_CR2_RTOEN) && !defined(XPD_USART_EXCLUDE_DMA)
+    /* framed reception end by receiver timeout or character match */
+    if (((sr & (USART_ISR_RTOF | USART_ISR_CMF)) != 0)
+     && ((cr1 & (USART_CR1_RTOIE | USART_CR1_CMIE)) != 0))
+    {
+        XPD_TRACE(XPD_TRACE_USART_RECEIVE, (uint32_t)husart->Inst);
+        usart_frameEnd(husart);
+    }
+#endif
+
+#ifndef XPD_USART_EXCLUDE_MODES
     /* LIN break detected */
-    if (((sr & USART_STATF(LBD)) != 0) && ((cr2 & USART_CR2_LBDIE) != 0))
+    if (((sr & USART_STATF(LBD)) != 0) && ((husart->Inst->CR2.w & USART_CR2_LBDIE) != 0))
     {
         XPD_USART_ClearFlag(husart, LBD);
 
         XPD_SAFE_CALLBACK(husart->Callbacks.Break, husart);
     }
+#endif /* XPD_USART_EXCLUDE_MODES */
 
     /* CTS detected */
     if (((sr & USART_STATF(CTS)) != 0) && ((cr3 & USART_CR3_CTSIE) != 0))
@@ -659,15 +993,21 @@ void XPD_USART_IRQHandler(USART_HandleType * husart)
         XPD_SAFE_CALLBACK(husart->Callbacks.ClearToSend, husart);
     }
 
-#if (USART_PERIPHERAL_VERSION > 2)
+#if (USART_PERIPHERAL_VERSION > 2) && !defined(XPD_USART_EXCLUDE_MODES)
     /* UART wakeup from Stop mode interrupt occurred */
     if(((sr & USART_ISR_WUF) != 0) && ((cr3 & USART_CR3_WUFIE) != 0))
     {
         XPD_USART_ClearFlag(husart, WU);
+
+        XPD_SAFE_CALLBACK(husart->Callbacks.WakeUp, husart);
     }
 #endif
+
+    XPD_STATS_IRQ_END(husart);
+    XPD_PROFILE_END();
 }
 
+#ifndef XPD_USART_EXCLUDE_DMA
 /**
  * @brief Starts DMA-managed data transmission over USART.
  * @param husart: pointer to the USART handle structure
@@ -677,35 +1017,7 @@ void XPD_USART_IRQHandler(USART_HandleType * husart)
  */
 XPD_ReturnType XPD_USART_Transmit_DMA(USART_HandleType * husart, void * TxData, uint16_t Length)
 {
-    XPD_ReturnType result;
-
-    /* save stream info */
-    husart->TxStream.buffer = TxData;
-    husart->TxStream.length = Length;
-
-    /* Set up DMA for transfer */
-    result = XPD_DMA_Start_IT(husart->DMA.Transmit, (void*) &USART_TXDR(husart), TxData, Length);
-
-    if (result == XPD_OK)
-    {
-        /* Set the callback owner */
-        husart->DMA.Transmit->Owner = husart;
-
-        /* Set the DMA transfer callbacks */
-        husart->DMA.Transmit->Callbacks.Complete     = usart_dmaTransmitRedirect;
-#ifdef USE_XPD_DMA_ERROR_DETECT
-        husart->DMA.Transmit->Callbacks.Error        = usart_dmaErrorRedirect;
-#endif
-        USART_RESET_ERRORS(husart);
-
-        /* The direction has to be set in half-duplex mode */
-        usart_setDirection(husart, USART_CR1_TE);
-
-        XPD_USART_ClearFlag(husart, TC);
-
-        USART_REG_BIT(husart, CR3, DMAT) = 1;
-    }
-    return result;
+    return usart_transmitDMA(husart, TxData, Length, usart_dmaTransmitRedirect);
 }
 
 /**
@@ -824,6 +1136,10 @@ void XPD_USART_Stop_DMA(USART_HandleType * husart)
         husart->TxStream.length = remaining;
 
         XPD_DMA_Stop_IT(husart->DMA.Transmit);
+
+        /* Drop the queued transmit blocks */
+        husart->TxQueue.Tail = husart->TxQueue.Head;
+        husart->TxQueue.Pending = 0;
     }
     /* Receive DMA disable */
     if (USART_REG_BIT(husart,CR3,DMAR) != 0)
@@ -840,49 +1156,553 @@ void XPD_USART_Stop_DMA(USART_HandleType * husart)
         husart->RxStream.length = remaining;
 
         XPD_DMA_Stop_IT(husart->DMA.Receive);
+
+#ifdef USART_CR2_RTOEN
+        /* Stop the framed reception */
+        XPD_USART_DisableIT(husart, RTO);
+        XPD_USART_DisableIT(husart, CM);
+#endif
     }
 }
 
-#if (USART_PERIPHERAL_VERSION > 1)
 /**
- * @brief Sets the selected inversion configuration for the USART
+ * @brief Starts continuous DMA-managed data reception over USART into a circular buffer.
+ *        The Receive callback is called when the first or second half of the buffer is filled,
+ *        and when the line becomes idle after a frame. The received data can be accessed in place
+ *        by @ref XPD_USART_RxRing_Peek and released by @ref XPD_USART_RxRing_Consume.
+ * @note  The receive DMA must be initialized in circular mode. The buffer has no overflow
+ *        protection, the application has to consume the data before the buffer wraps around.
  * @param husart: pointer to the USART handle structure
- * @param Inversions: the selected logical levels and order to invert
+ * @param RxData: pointer to the circular buffer
+ * @param Length: the size of the circular buffer in data transfers
+ * @return ERROR if the receive DMA is not circular, BUSY if DMA is in use, OK if reception is started
  */
-void XPD_USART_InversionConfig(USART_HandleType * husart, USART_InversionType Inversions)
+XPD_ReturnType XPD_USART_RxRing_Start(USART_HandleType * husart, void * RxData, uint16_t Length)
 {
-    USART_APPLY_CONFIG(husart, CR2,
-            USART_CR2_TXINV | USART_CR2_RXINV | USART_CR2_DATAINV | USART_CR2_MSBFIRST | USART_CR2_SWAP,
-            Inversions);
-}
+    XPD_ReturnType result = XPD_ERROR;
 
-/**
- * @brief Sets the overrun detection configuration for the USART (enabled by default)
- * @param husart: pointer to the USART handle structure
- * @param Mode: the selected detection strategy
- */
-void XPD_USART_OverrunConfig(USART_HandleType * husart, FunctionalState Mode)
-{
-    USART_APPLY_CONFIG(husart, CR3, USART_CR3_OVRDIS, (1 - Mode) << USART_CR3_OVRDIS_Pos);
-}
+    if (XPD_DMA_CircularMode(husart->DMA.Receive) != 0)
+    {
+        /* save stream info */
+        husart->RxStream.buffer = RxData;
+        husart->RxStream.length = Length;
+        husart->RxTail = 0;
+
+        /* Set up DMA for transfer */
+        result = XPD_DMA_Start_IT(husart->DMA.Receive, (void*) &USART_RXDR(husart), RxData, Length);
+    }
+
+    if (result == XPD_OK)
+    {
+        /* Set the callback owner */
+        husart->DMA.Receive->Owner = husart;
+
+        /* Set the DMA transfer callbacks */
+        husart->DMA.Receive->Callbacks.HalfComplete = usart_dmaRxRingRedirect;
+        husart->DMA.Receive->Callbacks.Complete     = usart_dmaRxRingRedirect;
+#ifdef USE_XPD_DMA_ERROR_DETECT
+        husart->DMA.Receive->Callbacks.Error        = usart_dmaErrorRedirect;
 #endif
+        XPD_DMA_EnableIT(husart->DMA.Receive, HT);
 
-/** @} */
+        USART_RESET_ERRORS(husart);
 
-/** @} */
+        XPD_USART_ClearFlag(husart, ORE);
+        XPD_USART_ClearFlag(husart, IDLE);
+        XPD_USART_EnableIT(husart, IDLE);
 
-/** @addtogroup UART
- * @{ */
+        USART_REG_BIT(husart, CR3, DMAR) = 1;
 
-/** @defgroup UART_Exported_Functions UART Exported Functions
- * @{ */
+        /* The direction has to be set in half-duplex mode */
+        usart_setDirection(husart, USART_CR1_RE);
+    }
+    return result;
+}
 
 /**
- * @brief Initializes the USART peripheral in asynchronous mode using the setup configuration
+ * @brief Stops the circular buffer DMA-managed reception over USART.
  * @param husart: pointer to the USART handle structure
- * @param Common: General peripheral setup configuration
- * @param Config: UART setup configuration
- * @return ERROR if input is incorrect, OK if success
+ */
+void XPD_USART_RxRing_Stop(USART_HandleType * husart)
+{
+    USART_REG_BIT(husart, CR3, DMAR) = 0;
+
+    XPD_USART_DisableIT(husart, IDLE);
+
+    XPD_DMA_Stop_IT(husart->DMA.Receive);
+}
+
+/**
+ * @brief Gets the received and not yet consumed data from the circular reception buffer.
+ * @param husart: pointer to the USART handle structure
+ * @param Data: set to the address of the first unread data in the buffer
+ * @return The amount of unread data transfers which are contiguous in the buffer
+ */
+uint16_t XPD_USART_RxRing_Peek(USART_HandleType * husart, void ** Data)
+{
+    uint16_t head = usart_rxRingHead(husart);
+    uint16_t tail = husart->RxTail;
+
+    *Data = (uint8_t*)husart->RxStream.buffer + tail * husart->RxStream.size;
+
+    /* the data until the end of the buffer is returned when wrapped around */
+    return (head >= tail) ? (head - tail) : (husart->RxStream.length - tail);
+}
+
+/**
+ * @brief Releases the processed data of the circular reception buffer.
+ * @param husart: pointer to the USART handle structure
+ * @param Count: the amount of data transfers to release
+ */
+void XPD_USART_RxRing_Consume(USART_HandleType * husart, uint16_t Count)
+{
+    uint32_t tail = husart->RxTail + Count;
+
+    if (tail >= husart->RxStream.length)
+    {
+        tail -= husart->RxStream.length;
+    }
+    husart->RxTail = tail;
+}
+
+/**
+ * @brief Gets the amount of received and not yet consumed data in the circular reception buffer.
+ * @param husart: pointer to the USART handle structure
+ * @return The amount of unread data transfers in the buffer
+ */
+uint16_t XPD_USART_RxRing_Count(USART_HandleType * husart)
+{
+    uint16_t head = usart_rxRingHead(husart);
+    uint16_t tail = husart->RxTail;
+
+    return (head >= tail) ? (head - tail) : (husart->RxStream.length - tail + head);
+}
+
+/**
+ * @brief Holds the DMA transfers of the circular reception. The next received data
+ *        stays in the data register, which deasserts the RTS signal
+ *        when the hardware flow control is enabled.
+ * @note  Without RTS flow control the held reception overruns when more data arrives.
+ * @param husart: pointer to the USART handle structure
+ */
+void XPD_USART_RxRing_Hold(USART_HandleType * husart)
+{
+    USART_REG_BIT(husart, CR3, DMAR) = 0;
+}
+
+/**
+ * @brief Resumes the DMA transfers of the held circular reception.
+ * @param husart: pointer to the USART handle structure
+ */
+void XPD_USART_RxRing_Resume(USART_HandleType * husart)
+{
+    USART_REG_BIT(husart, CR3, DMAR) = 1;
+}
+
+#ifdef USART_CR2_RTOEN
+/**
+ * @brief Starts DMA-managed reception of a single frame over USART. The frame ends
+ *        when the line is idle for the configured receiver timeout after a character,
+ *        when the delimiter character is received, or when the buffer is full.
+ *        The Receive callback is called at the frame end, when the amount of received
+ *        data transfers is available in the RxFrameLength field of the handle.
+ * @note  The receiver timeout is counted in bit durations, e.g. the 3.5 character
+ *        frame end of Modbus RTU with 11 bit characters is 39 bit durations.
+ *        The delimiter is configured in the address field, therefore the character match
+ *        can't be used together with the MultiSlave UART addressed modes.
+ * @param husart: pointer to the USART handle structure
+ * @param Config: pointer to the frame end setup
+ * @param RxData: pointer to the frame buffer
+ * @param Length: the size of the frame buffer in data transfers
+ * @return BUSY if DMA is in use, OK if reception is started
+ */
+XPD_ReturnType XPD_USART_Frame_Start(USART_HandleType * husart, const USART_Frame_InitType * Config,
+        void * RxData, uint16_t Length)
+{
+    XPD_ReturnType result;
+
+    if (Config->CharMatch != DISABLE)
+    {
+        /* The delimiter can only be written while the receiver is disabled */
+        uint32_t re = husart->Inst->CR1.w & USART_CR1_RE;
+
+        husart->Inst->CR1.w &= ~USART_CR1_RE;
+        husart->Inst->CR2.b.ADD = Config->Delimiter;
+#ifdef USART_CR2_ADDM7
+        USART_REG_BIT(husart, CR2, ADDM7) = 1;
+#endif
+        husart->Inst->CR1.w |= re;
+    }
+
+    result = XPD_USART_Receive_DMA(husart, RxData, Length);
+
+    if (result == XPD_OK)
+    {
+        husart->RxFrameLength = 0;
+        husart->DMA.Receive->Callbacks.Complete = usart_dmaFrameRedirect;
+
+        XPD_USART_ClearFlag(husart, RTO);
+        XPD_USART_ClearFlag(husart, CM);
+
+        if (Config->RxTimeout > 0)
+        {
+            husart->Inst->RTOR.b.RTO = Config->RxTimeout;
+            USART_REG_BIT(husart, CR2, RTOEN) = ENABLE;
+            XPD_USART_EnableIT(husart, RTO);
+        }
+        if (Config->CharMatch != DISABLE)
+        {
+            XPD_USART_EnableIT(husart, CM);
+        }
+    }
+    return result;
+}
+#endif
+
+/**
+ * @brief Sets up the transmit queue of the USART.
+ * @param husart: pointer to the USART handle structure
+ * @param Buffer: pointer to the storage of the queue elements
+ * @param Size: the number of elements in the storage
+ */
+void XPD_USART_TxQueue_Init(USART_HandleType * husart, DMA_DescriptorType * Buffer, uint8_t Size)
+{
+    husart->TxQueue.Buffer  = Buffer;
+    husart->TxQueue.Size    = Size;
+    husart->TxQueue.Head    = 0;
+    husart->TxQueue.Tail    = 0;
+    husart->TxQueue.Pending = 0;
+}
+
+/**
+ * @brief Adds a data block to the transmit queue, and starts DMA-managed transmission
+ *        if the USART transmitter is idle. The queued blocks are transmitted back-to-back,
+ *        the blocks which are contiguous in memory are merged into a single DMA transfer.
+ *        The Transmit callback is called when the queue is emptied.
+ * @note  The queue is lock-free for a single producer, which may run in interrupt context.
+ *        The data blocks must remain valid until they are transmitted.
+ * @param husart: pointer to the USART handle structure
+ * @param TxData: pointer to the data buffer
+ * @param Length: amount of data transfers
+ * @return BUSY if the queue is full or the DMA is in use, OK if the data is queued
+ */
+XPD_ReturnType XPD_USART_TxQueue_Put(USART_HandleType * husart, void * TxData, uint16_t Length)
+{
+    XPD_ReturnType result = XPD_BUSY;
+    uint32_t head = husart->TxQueue.Head + 1;
+
+    if (head >= husart->TxQueue.Size)
+    {
+        head = 0;
+    }
+
+    if (head != husart->TxQueue.Tail)
+    {
+        husart->TxQueue.Buffer[husart->TxQueue.Head].MemAddress = TxData;
+        husart->TxQueue.Buffer[husart->TxQueue.Head].DataCount  = Length;
+
+        /* publish the new element only after it is filled */
+        husart->TxQueue.Head = head;
+        result = XPD_OK;
+#ifdef USE_XPD_STATISTICS
+        {
+            uint32_t fill = husart->TxQueue.Size + head - husart->TxQueue.Tail;
+
+            if (fill >= husart->TxQueue.Size)
+            {
+                fill -= husart->TxQueue.Size;
+            }
+            XPD_STATS_MAX(husart, QueueHighWater, fill);
+        }
+#endif
+
+        /* no ongoing transfer, the DMA completion can't advance the queue */
+        if (husart->TxQueue.Pending == 0)
+        {
+            void * data;
+            uint16_t length;
+
+            husart->TxQueue.Pending = usart_txQueueCollect(husart, &data, &length);
+
+            result = usart_transmitDMA(husart, data, length, usart_dmaTxQueueRedirect);
+
+            if (result != XPD_OK)
+            {
+                husart->TxQueue.Pending = 0;
+            }
+        }
+    }
+    return result;
+}
+
+/**
+ * @brief Sets up the formatted text ring of the USART transmit queue.
+ * @note  The text ring uses the transmit queue exclusively, therefore the queue
+ *        must not be used for other data, and it needs at least 3 elements.
+ *        The USART has to use 8-bit data frames.
+ * @param husart: pointer to the USART handle structure
+ * @param Buffer: pointer to the storage of the text ring
+ * @param Size: the size of the text ring, it has to be a power of 2
+ * @return ERROR if the size is invalid, OK otherwise
+ */
+XPD_ReturnType XPD_USART_Print_Init(USART_HandleType * husart, char * Buffer, uint16_t Size)
+{
+    XPD_ReturnType result = XPD_ERROR;
+
+    if ((Size > 1) && ((Size & (Size - 1)) == 0))
+    {
+        husart->TxText.Buffer = Buffer;
+        husart->TxText.Mask   = Size - 1;
+        husart->TxText.Head   = 0;
+        result = XPD_OK;
+    }
+    return result;
+}
+
+/**
+ * @brief Formats text directly into the text ring, and queues it for transmission.
+ *        The supported format conversions are listed at @ref XPD_VFormat.
+ * @note  The function can be called from any context, the interrupts are masked
+ *        while the text is formatted, so the text ring and the queue keep their order.
+ *        The text is dropped if it doesn't fit into the free part of the ring.
+ * @param husart: pointer to the USART handle structure
+ * @param Format: the format string
+ * @return BUSY if the text ring or the queue is full, OK if the text is queued
+ */
+XPD_ReturnType XPD_USART_Printf(USART_HandleType * husart, const char * Format, ...)
+{
+    XPD_ReturnType result = XPD_BUSY;
+    uint32_t primask = __get_PRIMASK();
+    uint32_t free;
+
+    __disable_irq();
+
+    /* two queue elements are necessary when the text wraps around in the ring */
+    free = husart->TxQueue.Size + husart->TxQueue.Tail - husart->TxQueue.Head - 1;
+    if (free >= husart->TxQueue.Size)
+    {
+        free -= husart->TxQueue.Size;
+    }
+
+    if (free >= 2)
+    {
+        uint16_t mask = husart->TxText.Mask;
+        uint16_t head = husart->TxText.Head;
+        uint16_t tail = head;
+        uint16_t length, first;
+        va_list args;
+
+        /* the oldest text under transmission is at the queue tail */
+        if (husart->TxQueue.Head != husart->TxQueue.Tail)
+        {
+            tail = (char*)husart->TxQueue.Buffer[husart->TxQueue.Tail].MemAddress - husart->TxText.Buffer;
+        }
+
+        va_start(args, Format);
+        length = XPD_VFormat(husart->TxText.Buffer, mask, head, (tail - head - 1) & mask, Format, args);
+        va_end(args);
+
+        if (length > 0)
+        {
+            first = mask + 1 - head;
+            if (first > length)
+            {
+                first = length;
+            }
+            husart->TxText.Head = (head + length) & mask;
+
+            result = XPD_USART_TxQueue_Put(husart, &husart->TxText.Buffer[head], first);
+
+            if ((result == XPD_OK) && (first < length))
+            {
+                result = XPD_USART_TxQueue_Put(husart, husart->TxText.Buffer, length - first);
+            }
+        }
+    }
+
+    __set_PRIMASK(primask);
+
+    return result;
+}
+
+#ifdef USE_XPD_TRACE
+/* the number of trace records under transmission */
+static uint16_t usart_traceSent = 0;
+
+/**
+ * @brief Transmits the recorded trace events in binary format using the transmit queue,
+ *        as an alternative to the ITM output on cores without it.
+ *        The records are released once their transfer is completed.
+ * @note  This function shall be called periodically from the background.
+ *        The USART has to use 8-bit data frames, and its transmit queue must be
+ *        initialized and dedicated to the trace output.
+ * @param husart: pointer to the USART handle structure
+ */
+void XPD_USART_TraceFlush(USART_HandleType * husart)
+{
+    /* the DMA is finished with the queued records */
+    if ((husart->TxQueue.Pending == 0) && (husart->TxQueue.Head == husart->TxQueue.Tail))
+    {
+        const XPD_TraceEventType * events;
+        uint16_t count;
+
+        XPD_Trace_Consume(usart_traceSent);
+        usart_traceSent = 0;
+
+        count = XPD_Trace_Peek(&events);
+
+        /* the transfer length is limited to 16 bits */
+        if (count > (0xFFFF / sizeof(XPD_TraceEventType)))
+        {
+            count = 0xFFFF / sizeof(XPD_TraceEventType);
+        }
+
+        if ((count > 0) && (XPD_USART_TxQueue_Put(husart, (void*)events,
+                count * sizeof(XPD_TraceEventType)) == XPD_OK))
+        {
+            usart_traceSent = count;
+        }
+    }
+}
+#endif
+#endif /* XPD_USART_EXCLUDE_DMA */
+
+#ifdef USE_XPD_OS
+/**
+ * @brief Transmits data over USART, blocking the calling task until the transmission is complete.
+ *        The transfer is DMA-managed if the handle has a transmit DMA, otherwise interrupt-driven.
+ * @note  Only one task can wait on the transmission or reception of a handle at a time.
+ * @param husart: pointer to the USART handle structure
+ * @param TxData: pointer to the data buffer
+ * @param Length: amount of data transfers
+ * @param Timeout: available time for successful transmission in ms
+ * @return BUSY if DMA is in use, TIMEOUT if timed out, ERROR if a DMA error occurred,
+ *         OK if transfer is completed
+ */
+XPD_ReturnType XPD_USART_Transmit_Blocking(USART_HandleType * husart, void * TxData, uint16_t Length, uint32_t Timeout)
+{
+    XPD_ReturnType result = XPD_OK;
+
+    XPD_OS_SignalInit(&husart->Signal.Transmit);
+
+#ifndef XPD_USART_EXCLUDE_DMA
+    if (husart->DMA.Transmit != NULL)
+    {
+        result = XPD_USART_Transmit_DMA(husart, TxData, Length);
+    }
+    else
+#endif
+    {
+        XPD_USART_Transmit_IT(husart, TxData, Length);
+    }
+
+    if (result == XPD_OK)
+    {
+        result = usart_waitBlocking(husart, &husart->Signal.Transmit, &husart->TxStream,
+                USART_CR1_TXEIE | USART_CR1_TCIE, &Timeout);
+    }
+    return result;
+}
+
+/**
+ * @brief Receives data over USART, blocking the calling task until the reception is complete.
+ *        The transfer is DMA-managed if the handle has a receive DMA, otherwise interrupt-driven.
+ * @note  Only one task can wait on the transmission or reception of a handle at a time.
+ * @note  In synchronous mode the user has to ensure data transmission in order to generate clock.
+ * @param husart: pointer to the USART handle structure
+ * @param RxData: pointer to the data buffer
+ * @param Length: amount of data transfers
+ * @param Timeout: available time for successful reception in ms
+ * @return BUSY if DMA is in use, TIMEOUT if timed out, ERROR if a reception error occurred,
+ *         OK if transfer is completed
+ */
+XPD_ReturnType XPD_USART_Receive_Blocking(USART_HandleType * husart, void * RxData, uint16_t Length, uint32_t Timeout)
+{
+    XPD_ReturnType result = XPD_OK;
+
+    XPD_OS_SignalInit(&husart->Signal.Receive);
+
+#ifndef XPD_USART_EXCLUDE_DMA
+    if (husart->DMA.Receive != NULL)
+    {
+        result = XPD_USART_Receive_DMA(husart, RxData, Length);
+    }
+    else
+#endif
+    {
+        XPD_USART_Receive_IT(husart, RxData, Length);
+    }
+
+    if (result == XPD_OK)
+    {
+        result = usart_waitBlocking(husart, &husart->Signal.Receive, &husart->RxStream,
+                USART_CR1_RXNEIE, &Timeout);
+    }
+    return result;
+}
+#endif /* USE_XPD_OS */
+
+/**
+ * @brief Recalculates the baud rate divider for the current USART clock frequency.
+ * @note  It can be registered as RCC clock change listener callback.
+ *        The peripheral is disabled while the divider is updated, ongoing transfers are disrupted.
+ * @param husart: pointer to the USART handle structure
+ */
+void XPD_USART_ClockUpdate(USART_HandleType * husart)
+{
+#if (USART_PERIPHERAL_VERSION > 1)
+    /* BRR can only be written when the USART is disabled */
+    uint32_t cr1 = husart->Inst->CR1.w;
+    husart->Inst->CR1.w = cr1 & ~USART_CR1_UE;
+
+    usart_baudrateConfig(husart, husart->BaudRate);
+
+    husart->Inst->CR1.w = cr1;
+#else
+    usart_baudrateConfig(husart, husart->BaudRate);
+#endif
+}
+
+#if (USART_PERIPHERAL_VERSION > 1)
+/**
+ * @brief Sets the selected inversion configuration for the USART
+ * @param husart: pointer to the USART handle structure
+ * @param Inversions: the selected logical levels and order to invert
+ */
+void XPD_USART_InversionConfig(USART_HandleType * husart, USART_InversionType Inversions)
+{
+    USART_APPLY_CONFIG(husart, CR2,
+            USART_CR2_TXINV | USART_CR2_RXINV | USART_CR2_DATAINV | USART_CR2_MSBFIRST | USART_CR2_SWAP,
+            Inversions);
+}
+
+/**
+ * @brief Sets the overrun detection configuration for the USART (enabled by default)
+ * @param husart: pointer to the USART handle structure
+ * @param Mode: the selected detection strategy
+ */
+void XPD_USART_OverrunConfig(USART_HandleType * husart, FunctionalState Mode)
+{
+    USART_APPLY_CONFIG(husart, CR3, USART_CR3_OVRDIS, (1 - Mode) << USART_CR3_OVRDIS_Pos);
+}
+#endif
+
+/** @} */
+
+/** @} */
+
+/** @addtogroup UART
+ * @{ */
+
+/** @defgroup UART_Exported_Functions UART Exported Functions
+ * @{ */
+
+/**
+ * @brief Initializes the USART peripheral in asynchronous mode using the setup configuration
+ * @param husart: pointer to the USART handle structure
+ * @param Common: General peripheral setup configuration
+ * @param Config: UART setup configuration
+ * @return ERROR if input is incorrect, OK if success
  */
 XPD_ReturnType XPD_UART_Init(USART_HandleType * husart,
         const USART_InitType * Common, const UART_InitType * Config)
@@ -897,12 +1717,64 @@ XPD_ReturnType XPD_UART_Init(USART_HandleType * husart,
         /* configure hardware flow control */
         husart->Inst->CR3.w |= (USART_CR3_RTSE | USART_CR3_CTSE) & ((uint32_t)Config->FlowControl << USART_CR3_RTSE_Pos);
 
+#ifdef USART_CR2_ABREN
+        /* configure baudrate detection */
+        MODIFY_REG(husart->Inst->CR2.w, USART_CR2_ABREN | USART_CR2_ABRMODE, Config->BaudrateMode);
+#endif
+
         result = usart_init2(husart, Common);
     }
 
     return result;
 }
 
+/**
+ * @brief Changes the baudrate, parity and stop bits of the initialized UART
+ *        without stopping its ongoing reception. The DMA configuration and
+ *        a running @ref XPD_USART_RxRing_Start circular reception are kept.
+ * @note  The frame being received while the configuration is applied may be lost.
+ * @param husart: pointer to the USART handle structure
+ * @param Common: General peripheral setup configuration (the mode and sampling fields are ignored)
+ * @return BUSY if the transmitter is not idle,
+ *         ERROR if the new frame format would change the data transfer size,
+ *         OK if the new configuration is applied
+ */
+XPD_ReturnType XPD_UART_Reconfigure(USART_HandleType * husart, const USART_InitType * Common)
+{
+    XPD_ReturnType result = XPD_BUSY;
+
+    /* The transmitter has to be idle, including the last frame's shifting */
+    if ((husart->TxStream.length == 0) && (USART_REG_BIT(husart, CR3, DMAT) == 0)
+            && (XPD_USART_GetFlag(husart, TC) != 0))
+    {
+        uint32_t cr1 = husart->Inst->CR1.w;
+        uint32_t cr2 = husart->Inst->CR2.w;
+
+#if (USART_PERIPHERAL_VERSION > 1)
+        /* The frame format and BRR can only be written when the USART is disabled */
+        husart->Inst->CR1.w = cr1 & ~USART_CR1_UE;
+#endif
+
+        if (usart_frameConfig(husart, Common) != husart->RxStream.size)
+        {
+            /* The DMA transfer width would have to be changed, revert */
+            husart->Inst->CR2.w = cr2;
+            result = XPD_ERROR;
+        }
+        else
+        {
+            usart_baudrateConfig(husart, Common->BaudRate);
+
+            /* Keep the new frame format with the original enabled state */
+            cr1 = (husart->Inst->CR1.w & ~USART_CR1_UE) | (cr1 & USART_CR1_UE);
+            result = XPD_OK;
+        }
+
+        husart->Inst->CR1.w = cr1;
+    }
+    return result;
+}
+
 #if (USART_PERIPHERAL_VERSION > 1)
 /**
  * @brief Sets the baudrate detection strategy for the UART
@@ -915,6 +1787,43 @@ void XPD_UART_BaudrateModeConfig(USART_HandleType * husart, UART_BaudrateModeTyp
 }
 #endif
 
+#if defined(USART_CR2_ABREN) && !defined(XPD_USART_EXCLUDE_DMA)
+/**
+ * @brief Starts the auto baudrate detection on the next received character, after which
+ *        the circular DMA reception is started by @ref XPD_USART_RxRing_Start.
+ *        The AutoBaud callback is called when the detected baudrate is set and the reception is started.
+ * @note  The detection character is discarded. A failed detection is restarted automatically.
+ *        The USART interrupt line has to be enabled.
+ * @param husart: pointer to the USART handle structure
+ * @param RxData: pointer to the circular buffer
+ * @param Length: the size of the circular buffer in data transfers
+ * @return ERROR if auto baudrate detection isn't configured or the receive DMA is not circular,
+ *         OK if the detection is started
+ */
+XPD_ReturnType XPD_UART_AutoBaud_Start(USART_HandleType * husart, void * RxData, uint16_t Length)
+{
+    XPD_ReturnType result = XPD_ERROR;
+
+    if ((USART_REG_BIT(husart, CR2, ABREN) != 0) && (XPD_DMA_CircularMode(husart->DMA.Receive) != 0))
+    {
+        /* save the ring buffer until the detection is complete */
+        husart->AutoBaud = 1;
+        husart->RxStream.buffer = RxData;
+        husart->RxStream.length = Length;
+
+        USART_REG_BIT(husart, CR3, DMAR) = 0;
+        husart->Inst->RQR.w = USART_RQR_ABRRQ | USART_RQR_RXFRQ;
+
+        /* The direction has to be set in half-duplex mode */
+        usart_setDirection(husart, USART_CR1_RE);
+
+        XPD_USART_EnableIT(husart, RXNE);
+        result = XPD_OK;
+    }
+    return result;
+}
+#endif
+
 /** @} */
 
 /** @} */
@@ -956,6 +1865,7 @@ XPD_ReturnType XPD_USRT_Init(USART_HandleType * husart,
 
 /** @} */
 
+#ifndef XPD_USART_EXCLUDE_MODES
 /** @addtogroup LIN
  * @{ */
 
@@ -1068,10 +1978,49 @@ void XPD_MSUART_MuteCtrl(USART_HandleType * husart, FunctionalState NewState)
 #endif
 }
 
+#if defined(USART_CR2_RTOEN) && !defined(XPD_USART_EXCLUDE_DMA)
+/**
+ * @brief Starts the multidrop bus endpoint reception: the UART is muted until its own
+ *        address mark is received, then the addressed frame is received by DMA
+ *        until the receiver timeout (see @ref XPD_USART_Frame_Start). At the frame end
+ *        the UART re-enters mute, and the Receive callback is called, where the next
+ *        frame reception can be started. The foreign frames are filtered by the peripheral
+ *        without interrupts.
+ * @note  The UART has to be initialized with @ref MSUART_UNMUTE_ADDRESSED method.
+ *        The character match frame end isn't available, as the address field holds the node address.
+ * @param husart: pointer to the USART handle structure
+ * @param RxTimeout: the frame end idle time in bit durations after a received character
+ * @param RxData: pointer to the frame buffer
+ * @param Length: the size of the frame buffer in data transfers
+ * @return ERROR if the address mark unmute isn't configured, BUSY if DMA is in use,
+ *         OK if the reception is started
+ */
+XPD_ReturnType XPD_MSUART_Endpoint_Start(USART_HandleType * husart, uint32_t RxTimeout,
+        void * RxData, uint16_t Length)
+{
+    XPD_ReturnType result = XPD_ERROR;
+    const USART_Frame_InitType frame = {
+        .RxTimeout = RxTimeout,
+        .CharMatch = DISABLE,
+    };
+
+    if (USART_REG_BIT(husart, CR1, WAKE) == MSUART_UNMUTE_ADDRESSED)
+    {
+        result = XPD_USART_Frame_Start(husart, &frame, RxData, Length);
+    }
+    if (result == XPD_OK)
+    {
+        XPD_MSUART_MuteCtrl(husart, ENABLE);
+    }
+    return result;
+}
+#endif
+
 #if (USART_PERIPHERAL_VERSION > 2)
 /**
  * @brief Sets the Stop mode for the UART
  * @note  The UART is able to wake up the MCU from Stop 1 mode as long as UART clock is HSI or LSE.
+ *        LPUART1 is also able to wake up the MCU from Stop 2 mode.
  * @note  There shall be no ongoing transfer in the UART when Stop mode is entered.
  * @param husart: pointer to the USART handle structure
  * @param NewState: Mute state to set
@@ -1223,11 +2172,515 @@ XPD_ReturnType XPD_RS485_Init(USART_HandleType * husart,
     return result;
 }
 
+#if defined(USART_CR2_RTOEN) && !defined(XPD_USART_EXCLUDE_DMA)
+/* Ends the request transmission without interrupting at the transmission complete */
+static void usart_dmaRequestRedirect(void *hdma)
+{
+    USART_HandleType * husart = (USART_HandleType*) ((DMA_HandleType*) hdma)->Owner;
+
+    /* the DE signal is deasserted by the peripheral after the last stop bit */
+    USART_REG_BIT(husart, CR3, DMAT) = 0;
+
+    XPD_STATS_ADD(husart, Bytes, husart->TxStream.length * husart->TxStream.size);
+    husart->TxStream.buffer += husart->TxStream.length * husart->TxStream.size;
+    husart->TxStream.length = 0;
+}
+
+/**
+ * @brief Performs a request - response transaction on the RS485 bus using DMA.
+ *        The response frame reception is armed before the request is transmitted,
+ *        and the DE signal is released by the peripheral, so the only interrupt of the transaction
+ *        is the Receive callback at the end of the response frame (see @ref XPD_USART_Frame_Start).
+ * @note  Requires separate RX and TX lines (HalfDuplex disabled), with the transceiver
+ *        receiver disabled (or the RX line held idle) while DE is asserted, otherwise the request
+ *        is received as well. The receiver timeout is only counted after the first response character,
+ *        the missing response has to be detected by the application using @ref XPD_USART_Stop_DMA.
+ * @param husart: pointer to the USART handle structure
+ * @param Frame: pointer to the response frame end setup
+ * @param TxData: pointer to the request data
+ * @param TxLength: amount of request data transfers
+ * @param RxData: pointer to the response buffer
+ * @param RxLength: the size of the response buffer in data transfers
+ * @return ERROR if half-duplex mode is used, BUSY if a DMA is in use, OK if the transaction is started
+ */
+XPD_ReturnType XPD_RS485_Transaction(USART_HandleType * husart, const USART_Frame_InitType * Frame,
+        void * TxData, uint16_t TxLength, void * RxData, uint16_t RxLength)
+{
+    XPD_ReturnType result = XPD_ERROR;
+
+    if (!USART_HALF_DUPLEX_MODE(husart))
+    {
+        result = XPD_USART_Frame_Start(husart, Frame, RxData, RxLength);
+    }
+    if (result == XPD_OK)
+    {
+        result = usart_transmitDMA(husart, TxData, TxLength, usart_dmaRequestRedirect);
+
+        /* If the transmission failed, cancel the reception */
+        if (result != XPD_OK)
+        {
+            USART_REG_BIT(husart, CR3, DMAR) = 0;
+            XPD_USART_DisableIT(husart, RTO);
+            XPD_USART_DisableIT(husart, CM);
+            XPD_DMA_Stop_IT(husart->DMA.Receive);
+        }
+    }
+    return result;
+}
+#endif
+
 /** @} */
 
 /** @} */
 #endif
 
+#ifndef XPD_USART_EXCLUDE_DMA
+/** @addtogroup OneWire
+ * @{ */
+
+/* The reset pulse and presence detection is a 0xF0 character at 9600 baud,
+ * each time slot is a character at 115200 baud */
+#define ONEWIRE_RESET_BAUDRATE      9600
+#define ONEWIRE_SLOT_BAUDRATE       115200
+#define ONEWIRE_RESET_PULSE         0xF0
+
+/* The read slot is the same as the write 1 slot, the slave holds the line low for 0 */
+#define ONEWIRE_SLOT_0              0x00
+#define ONEWIRE_SLOT_1              0xFF
+
+#define ONEWIRE_CMD_SEARCH_ROM      0xF0
+#define ONEWIRE_ROM_BITS            64
+
+#define ONEWIRE_PHASE_RESET         0
+#define ONEWIRE_PHASE_DATA          1
+#define ONEWIRE_PHASE_SEARCH        2
+#define ONEWIRE_PHASE_SEARCH_END    3
+
+/* Changes the baud rate, the BRR can only be written when the USART is disabled */
+static void onewire_baudrateConfig(USART_HandleType * husart, uint32_t Baudrate)
+{
+    uint32_t cr1 = husart->Inst->CR1.w;
+
+    husart->Inst->CR1.w = cr1 & ~USART_CR1_UE;
+    usart_baudrateConfig(husart, Baudrate);
+    husart->Inst->CR1.w = cr1;
+}
+
+/* Transmits the slots and receives the bus levels to the same buffer by DMA */
+static void onewire_exchange(OneWire_HandleType * how, uint16_t Length)
+{
+    USART_HandleType * husart = how->Serial;
+
+    /* Each slot is received after it's transmitted, the buffer is overwritten behind the transmitter */
+    XPD_USART_ClearFlag(husart, ORE);
+    XPD_USART_ClearFlag(husart, RXNE);
+
+    (void) XPD_DMA_Start_IT(husart->DMA.Receive, (void*) &USART_RXDR(husart), how->Slots, Length);
+    (void) XPD_DMA_Start(husart->DMA.Transmit, (void*) &USART_TXDR(husart), how->Slots, Length);
+
+    SET_BIT(husart->Inst->CR3.w, USART_CR3_DMAR | USART_CR3_DMAT);
+}
+
+/* Starts the reset of the next transfer or search pass */
+static void onewire_reset(OneWire_HandleType * how)
+{
+    onewire_baudrateConfig(how->Serial, ONEWIRE_RESET_BAUDRATE);
+
+    how->Phase    = ONEWIRE_PHASE_RESET;
+    how->Slots[0] = ONEWIRE_RESET_PULSE;
+    onewire_exchange(how, 1);
+}
+
+/* Encodes the byte to write slots, the read bytes are encoded as 0xFF */
+static void onewire_encode(uint8_t * Slots, uint8_t Data)
+{
+    uint8_t bit;
+
+    for (bit = 0; bit < 8; bit++, Data >>= 1)
+    {
+        Slots[bit] = ((Data & 1) != 0) ? ONEWIRE_SLOT_1 : ONEWIRE_SLOT_0;
+    }
+}
+
+/* Decodes the bus levels of the slots */
+static uint8_t onewire_decode(const uint8_t * Slots)
+{
+    uint8_t data = 0;
+    uint8_t bit;
+
+    for (bit = 0; bit < 8; bit++)
+    {
+        data |= (uint8_t)(Slots[bit] == ONEWIRE_SLOT_1) << bit;
+    }
+    return data;
+}
+
+/* Ends the operation and notifies the user */
+static void onewire_finish(OneWire_HandleType * how)
+{
+    how->Busy = 0;
+
+    XPD_SAFE_CALLBACK(how->Complete, how);
+}
+
+/* Exchanges the next chunk of the current transfer, or starts the next transfer */
+static void onewire_transferNext(OneWire_HandleType * how)
+{
+    const OneWire_TransferType * transfer = &how->Transfers[how->Index];
+    uint16_t remaining = transfer->TxLength + transfer->RxLength - how->Offset;
+
+    if (remaining > 0)
+    {
+        uint16_t i;
+
+        how->Chunk = how->Size / 8;
+        if (how->Chunk > remaining)
+        {
+            how->Chunk = remaining;
+        }
+
+        for (i = 0; i < how->Chunk; i++)
+        {
+            uint16_t pos = how->Offset + i;
+
+            onewire_encode(&how->Slots[8 * i], (pos < transfer->TxLength) ?
+                    transfer->TxData[pos] : 0xFF);
+        }
+
+        how->Phase = ONEWIRE_PHASE_DATA;
+        onewire_exchange(how, 8 * how->Chunk);
+    }
+    else if (++how->Index < how->Count)
+    {
+        how->Offset = 0;
+        onewire_reset(how);
+    }
+    else
+    {
+        onewire_finish(how);
+    }
+}
+
+/* Processes the exchanged slots of a search pass, and selects the direction of the next ROM bit */
+static void onewire_searchNext(OneWire_HandleType * how, uint16_t Length)
+{
+    uint8_t * rom = &how->Roms[8 * how->Found];
+    uint8_t idBit  = how->Slots[Length - 2] == ONEWIRE_SLOT_1;
+    uint8_t cmpBit = how->Slots[Length - 1] == ONEWIRE_SLOT_1;
+    uint8_t pos = how->Bit + 1;
+    uint8_t dir;
+
+    /* No device participates in the search */
+    if ((idBit != 0) && (cmpBit != 0))
+    {
+        onewire_finish(how);
+        return;
+    }
+
+    if (idBit != cmpBit)
+    {
+        dir = idBit;
+    }
+    else
+    {
+        /* Devices with both values: the previous path is followed until its last branch,
+         * which is now taken in the 1 direction */
+        if (pos < how->Branch)
+        {
+            dir = (rom[how->Bit / 8] >> (how->Bit % 8)) & 1;
+        }
+        else
+        {
+            dir = pos == how->Branch;
+        }
+        if (dir == 0)
+        {
+            how->LastZero = pos;
+        }
+    }
+
+    if (dir != 0)
+    {
+        rom[how->Bit / 8] |= 1 << (how->Bit % 8);
+    }
+    else
+    {
+        rom[how->Bit / 8] &= ~(1 << (how->Bit % 8));
+    }
+    how->Bit++;
+
+    /* The direction is written together with the next bit's read slots */
+    how->Slots[0] = (dir != 0) ? ONEWIRE_SLOT_1 : ONEWIRE_SLOT_0;
+    if (how->Bit < ONEWIRE_ROM_BITS)
+    {
+        how->Slots[1] = how->Slots[2] = ONEWIRE_SLOT_1;
+        onewire_exchange(how, 3);
+    }
+    else
+    {
+        how->Phase = ONEWIRE_PHASE_SEARCH_END;
+        onewire_exchange(how, 1);
+    }
+}
+
+static void onewire_dmaRedirect(void *hdma)
+{
+    OneWire_HandleType * how = (OneWire_HandleType*) ((DMA_HandleType*) hdma)->Owner;
+    uint16_t length = ((DMA_HandleType*) hdma)->BlockLength;
+    uint16_t i;
+
+    CLEAR_BIT(how->Serial->Inst->CR3.w, USART_CR3_DMAR | USART_CR3_DMAT);
+
+    switch (how->Phase)
+    {
+        case ONEWIRE_PHASE_RESET:
+            /* The presence pulse of the devices overlaps the high bits */
+            if (how->Slots[0] == ONEWIRE_RESET_PULSE)
+            {
+                how->Absent++;
+            }
+            onewire_baudrateConfig(how->Serial, ONEWIRE_SLOT_BAUDRATE);
+
+            if (how->Transfers != NULL)
+            {
+                onewire_transferNext(how);
+            }
+            else if (how->Slots[0] == ONEWIRE_RESET_PULSE)
+            {
+                onewire_finish(how);
+            }
+            else
+            {
+                /* The search command is followed by the first bit's read slots */
+                onewire_encode(how->Slots, ONEWIRE_CMD_SEARCH_ROM);
+                how->Slots[8] = how->Slots[9] = ONEWIRE_SLOT_1;
+
+                how->Phase    = ONEWIRE_PHASE_SEARCH;
+                how->Bit      = 0;
+                how->LastZero = 0;
+                onewire_exchange(how, 10);
+            }
+            break;
+
+        case ONEWIRE_PHASE_DATA:
+        {
+            const OneWire_TransferType * transfer = &how->Transfers[how->Index];
+
+            for (i = 0; i < how->Chunk; i++)
+            {
+                uint16_t pos = how->Offset + i;
+
+                if (pos >= transfer->TxLength)
+                {
+                    transfer->RxData[pos - transfer->TxLength] = onewire_decode(&how->Slots[8 * i]);
+                }
+            }
+            how->Offset += how->Chunk;
+
+            onewire_transferNext(how);
+            break;
+        }
+
+        case ONEWIRE_PHASE_SEARCH:
+            onewire_searchNext(how, length);
+            break;
+
+        case ONEWIRE_PHASE_SEARCH_END:
+        default:
+            how->Found++;
+            how->Branch = how->LastZero;
+
+            /* The next pass starts from the found ROM code */
+            if ((how->Branch != 0) && (how->Found < how->Count))
+            {
+                for (i = 0; i < 8; i++)
+                {
+                    how->Roms[8 * how->Found + i] = how->Roms[8 * (how->Found - 1) + i];
+                }
+                onewire_reset(how);
+            }
+            else
+            {
+                onewire_finish(how);
+            }
+            break;
+    }
+}
+
+#ifdef USE_XPD_DMA_ERROR_DETECT
+static void onewire_dmaErrorRedirect(void *hdma)
+{
+    OneWire_HandleType * how = (OneWire_HandleType*) ((DMA_HandleType*) hdma)->Owner;
+
+    CLEAR_BIT(how->Serial->Inst->CR3.w, USART_CR3_DMAR | USART_CR3_DMAT);
+    XPD_DMA_Stop_IT(how->Serial->DMA.Transmit);
+
+    how->Serial->Errors |= USART_ERROR_DMA;
+    XPD_STATS_ERROR(how->Serial, USART_ERROR_DMA);
+
+    onewire_baudrateConfig(how->Serial, ONEWIRE_SLOT_BAUDRATE);
+    onewire_finish(how);
+}
+#endif
+
+/* Takes over the DMA callbacks, and starts the first reset */
+static void onewire_start(OneWire_HandleType * how)
+{
+    DMA_HandleType * hdma = how->Serial->DMA.Receive;
+
+    /* Set the callback owner */
+    hdma->Owner = how;
+
+    /* Set the DMA transfer callbacks */
+    hdma->Callbacks.Complete     = onewire_dmaRedirect;
+    hdma->Callbacks.HalfComplete = NULL;
+#ifdef USE_XPD_DMA_ERROR_DETECT
+    hdma->Callbacks.Error        = onewire_dmaErrorRedirect;
+#endif
+    USART_RESET_ERRORS(how->Serial);
+
+    how->Busy   = 1;
+    how->Absent = 0;
+    how->Index  = 0;
+    how->Offset = 0;
+    onewire_reset(how);
+}
+
+/** @defgroup OneWire_Exported_Functions OneWire Exported Functions
+ *  @brief    1-Wire bus master on a half-duplex USART
+ *  @details  Each time slot of the bus is a USART character, so the bits of the bytes are
+ *            exchanged by DMA, without timing critical CPU code. A sequence of transfers
+ *            (e.g. reading the scratchpad of each sensor) or an entire ROM search
+ *            is processed in the DMA interrupts, and finished by a single Complete callback.
+ * @note      The USART TX pin is the bus line, which has to be configured as open-drain output
+ *            with an external pull-up resistor. The Transmit and Receive DMA of the USART
+ *            have to be initialized in normal mode with byte data alignment.
+ * @{
+ */
+
+/**
+ * @brief Initializes the USART as 1-Wire bus master in half-duplex mode.
+ * @param how: pointer to the 1-Wire handle structure
+ * @return ERROR if the slot buffer is too small, OK otherwise
+ */
+XPD_ReturnType XPD_OneWire_Init(OneWire_HandleType * how)
+{
+    USART_HandleType * husart = how->Serial;
+    USART_InitType common = {
+        .BaudRate     = ONEWIRE_SLOT_BAUDRATE,
+        .Transmitter  = ENABLE,
+        .Receiver     = ENABLE,
+        .DataSize     = 8,
+        .StopBits     = USART_STOPBITS_1,
+        .SingleSample = DISABLE,
+        .Parity       = USART_PARITY_NONE,
+    };
+    XPD_ReturnType result = XPD_ERROR;
+
+    if (how->Size >= 10)
+    {
+        how->Busy  = 0;
+        how->Found = 0;
+
+        result = usart_init1(husart, &common);
+
+        /* Both directions stay enabled, the transmitted slots are received with the bus level */
+        USART_REG_BIT(husart, CR3, HDSEL) = ENABLE;
+
+        result = usart_init2(husart, &common);
+    }
+    return result;
+}
+
+/**
+ * @brief Starts a sequence of transfers on the bus. Each transfer consists of a reset,
+ *        the written bytes and the read bytes. The Complete callback is called when
+ *        the sequence is finished, the missing presence pulses are counted by Absent.
+ * @param how: pointer to the 1-Wire handle structure
+ * @param Transfers: the transfers of the sequence, which have to be kept until completion
+ * @param Count: the number of transfers
+ * @return ERROR if the sequence is empty, BUSY if an operation is in progress, OK if started
+ */
+XPD_ReturnType XPD_OneWire_Sequence_DMA(OneWire_HandleType * how,
+        const OneWire_TransferType * Transfers, uint8_t Count)
+{
+    if (Count == 0)
+    {
+        return XPD_ERROR;
+    }
+    if (how->Busy != 0)
+    {
+        return XPD_BUSY;
+    }
+
+    how->Transfers = Transfers;
+    how->Count     = Count;
+
+    onewire_start(how);
+    return XPD_OK;
+}
+
+/**
+ * @brief Starts the search of the ROM codes of all devices on the bus.
+ *        The Complete callback is called when all devices are found, or the capacity is full,
+ *        and the number of found ROM codes is provided by Found.
+ * @note  The ROM codes should be validated using @ref XPD_OneWire_CRC8.
+ * @param how: pointer to the 1-Wire handle structure
+ * @param Roms: the destination of the 8 byte ROM codes
+ * @param Count: the number of ROM codes fitting in the destination
+ * @return ERROR if the destination is empty, BUSY if an operation is in progress, OK if started
+ */
+XPD_ReturnType XPD_OneWire_Search_DMA(OneWire_HandleType * how, uint8_t * Roms, uint8_t Count)
+{
+    if (Count == 0)
+    {
+        return XPD_ERROR;
+    }
+    if (how->Busy != 0)
+    {
+        return XPD_BUSY;
+    }
+
+    how->Transfers = NULL;
+    how->Roms      = Roms;
+    how->Count     = Count;
+    how->Found     = 0;
+    how->Branch    = 0;
+
+    onewire_start(how);
+    return XPD_OK;
+}
+
+/**
+ * @brief Calculates the 1-Wire CRC (X^8 + X^5 + X^4 + 1) of the data.
+ * @param Data: pointer to the data (e.g. ROM code or scratchpad)
+ * @param Length: the data length in bytes
+ * @return The CRC value, 0 if the data includes its valid CRC
+ */
+uint8_t XPD_OneWire_CRC8(const uint8_t * Data, uint16_t Length)
+{
+    uint8_t crc = 0;
+
+    for (; Length > 0; Length--)
+    {
+        uint8_t bit;
+
+        crc ^= *(Data++);
+        for (bit = 0; bit < 8; bit++)
+        {
+            crc = ((crc & 1) != 0) ? ((crc >> 1) ^ 0x8C) : (crc >> 1);
+        }
+    }
+    return crc;
+}
+
+/** @} */
+
+/** @} */
+#endif /* XPD_USART_EXCLUDE_DMA */
+
+#endif /* XPD_USART_EXCLUDE_MODES */
+
 /** @} */
 
 #endif /* USE_XPD_USART */
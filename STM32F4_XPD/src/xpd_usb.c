@@ -54,6 +54,27 @@
 #define USB_ENDPOINT_COUNT(HANDLE)     4
 #endif
 
+#ifdef USB_OTG_HS
+/* The EP1 interrupts of the HS core can be routed to the dedicated interrupt lines,
+ * the mask bits of DEACHMSK are at the same positions as in DAINTMSK */
+#define USB_EP_INT_MASK(HANDLE, NUMBER)  \
+    ((((NUMBER) == 1) && ((HANDLE)->DedicatedEP1 != DISABLE)) ? \
+        (&(HANDLE)->Inst->DEACHMSK) : (&(HANDLE)->Inst->DAINTMSK.w))
+#else
+#define USB_EP_INT_MASK(HANDLE, NUMBER)  (&(HANDLE)->Inst->DAINTMSK.w)
+#endif
+
+#ifdef USB_OTG_HS
+#define USB_FIFO_RAM_WORDS(HANDLE)     \
+    ((((uint32_t) husb->Inst) == ((uint32_t)USB_OTG_HS)) ? (4096 / 4) : (1280 / 4))
+#else
+#define USB_FIFO_RAM_WORDS(HANDLE)     (1280 / 4)
+#endif
+
+/* FIFO sizes are in 32-bit words, the minimal transmit FIFO depth is 16 words */
+#define USB_FIFO_WORDS(BYTES)          (((uint32_t)(BYTES) + 3) / 4)
+#define USB_FIFO_DEPTH(BYTES)          ((USB_FIFO_WORDS(BYTES) > 16) ? USB_FIFO_WORDS(BYTES) : 16)
+
 /* Set the status of the DP pull-up resistor */
 __STATIC_INLINE void usb_connectionStateCtrl(USB_HandleType * husb, FunctionalState NewState)
 {
@@ -115,14 +136,40 @@ static void usb_writePacket(USB_OTG_TypeDef * USBx, uint8_t FIFOx, uint8_t * Dat
 /* Pop packet data from OUT FIFO */
 static void usb_readPacket(USB_OTG_TypeDef * USBx, uint8_t * Data, uint16_t Length)
 {
-    uint32_t wordCount = (Length + 3) / 4;
+    uint32_t wordCount = Length / 4;
+    uint32_t remaining = Length & 3;
 
     for (; wordCount > 0; wordCount--, Data += 4)
     {
         *(__packed uint32_t *) Data = USBx->DFIFO[0].DR;
+    }
+
+    /* The last partial word is stored without overrunning the buffer */
+    if (remaining > 0)
+    {
+        uint32_t word = USBx->DFIFO[0].DR;
+
+        for (; remaining > 0; remaining--, word >>= 8)
+        {
+            *Data++ = (uint8_t)word;
+        }
+    }
+}
+
+#if (USB_DATA_WORD_ALIGNED == 1) && defined(USB_OTG_GAHBCFG_DMAEN)
+/* Get the transfer size programmed for the OUT endpoint, which is
+ * an integer multiple of the max packet size */
+__STATIC_INLINE uint32_t usb_outTransferSize(USB_EndPointHandleType * ep)
+{
+    uint32_t pktcnt = (ep->Transfer.length + ep->MaxPacketSize - 1) / ep->MaxPacketSize;
 
+    if (pktcnt == 0)
+    {
+        pktcnt = 1;
     }
+    return pktcnt * ep->MaxPacketSize;
 }
+#endif
 
 /* Set up EP0 to receive control data */
 static void usb_EP0_outStart(USB_HandleType * husb)
@@ -141,6 +188,153 @@ static void usb_EP0_outStart(USB_HandleType * husb)
 #endif
 }
 
+/* Handle the masked events of an OUT endpoint */
+static void usb_outEpEvent(USB_HandleType * husb, uint8_t EpAddress, uint32_t epint)
+{
+    /* Transfer completed */
+    if ((epint & USB_OTG_DOEPINT_XFRC) != 0)
+    {
+        /* Clear IT flag */
+        husb->Inst->OEP[EpAddress].DOEPINT.w = USB_OTG_DOEPINT_XFRC;
+
+#if (USB_DATA_WORD_ALIGNED == 1) && defined(USB_OTG_GAHBCFG_DMAEN)
+        if (husb->DMA == ENABLE)
+        {
+            USB_EndPointHandleType * ep = &husb->EP.OUT[EpAddress];
+
+            /* The received size is the programmed size minus the remainder */
+            ep->Transfer.size = usb_outTransferSize(ep)
+                    - husb->Inst->OEP[EpAddress].DOEPTSIZ.b.XFRSIZ;
+            ep->Transfer.buffer += ep->Transfer.size;
+            XPD_STATS_ADD(husb, Bytes, ep->Transfer.size);
+        }
+#endif
+
+        /* Data packet received callback */
+        XPD_STATS_ADD(husb, Transfers, 1);
+        XPD_TRACE(XPD_TRACE_USB_DATA_OUT, EpAddress);
+        XPD_HANDLE_CALLBACK(husb, DataOutStage, husb->User, EpAddress, husb->EP.OUT[EpAddress].Transfer.buffer);
+
+#if (USB_DATA_WORD_ALIGNED == 1) && defined(USB_OTG_GAHBCFG_DMAEN)
+        if (husb->DMA == ENABLE)
+        {
+            if ((EpAddress == 0) && (husb->EP.OUT[EpAddress].Transfer.length == 0))
+            {
+                /* this is ZLP, so prepare EP0 for next setup */
+                usb_EP0_outStart(husb);
+            }
+        }
+#endif
+    }
+
+    /* Setup request arrived */
+    if ((epint & USB_OTG_DOEPINT_STUP) != 0)
+    {
+        /* Clear IT flag */
+        husb->Inst->OEP[EpAddress].DOEPINT.w = USB_OTG_DOEPINT_STUP;
+
+        /* Setup packet received callback */
+        XPD_STATS_ADD(husb, Transfers, 1);
+        XPD_TRACE(XPD_TRACE_USB_SETUP, 0);
+        XPD_HANDLE_CALLBACK(husb, SetupStage, husb->User, (uint8_t *)husb->Setup);
+    }
+
+    /* Clear irrelevant flags */
+    husb->Inst->OEP[EpAddress].DOEPINT.w =
+#ifdef USB_OTG_DOEPINT_OTEPSPR
+            USB_OTG_DOEPINT_OTEPSPR |
+#endif
+            USB_OTG_DOEPINT_OTEPDIS;
+}
+
+/* Handle the masked events of an IN endpoint */
+static void usb_inEpEvent(USB_HandleType * husb, uint8_t EpAddress, uint32_t epint)
+{
+    /* Transfer completed */
+    if ((epint & USB_OTG_DIEPINT_XFRC) != 0)
+    {
+        CLEAR_BIT(husb->Inst->DIEPEMPMSK, 0x1 << EpAddress);
+
+        /* Clear IT flag */
+        husb->Inst->IEP[EpAddress].DIEPINT.w = USB_OTG_DIEPINT_XFRC;
+
+#if (USB_DATA_WORD_ALIGNED == 1) && defined(USB_OTG_GAHBCFG_DMAEN)
+        if (husb->DMA == ENABLE)
+        {
+            /* The complete multi-packet transfer is done */
+            husb->EP.IN[EpAddress].Transfer.size    = husb->EP.IN[EpAddress].Transfer.length;
+            husb->EP.IN[EpAddress].Transfer.buffer += husb->EP.IN[EpAddress].Transfer.length;
+            XPD_STATS_ADD(husb, Bytes, husb->EP.IN[EpAddress].Transfer.length);
+        }
+#endif
+
+        XPD_STATS_ADD(husb, Transfers, 1);
+        XPD_TRACE(XPD_TRACE_USB_DATA_IN, EpAddress);
+        XPD_HANDLE_CALLBACK(husb, DataInStage, husb->User, EpAddress, husb->EP.IN[EpAddress].Transfer.buffer);
+
+#if (USB_DATA_WORD_ALIGNED == 1) && defined(USB_OTG_GAHBCFG_DMAEN)
+        if (husb->DMA == ENABLE)
+        {
+            /* this is ZLP, so prepare EP0 for next setup */
+            if ((EpAddress == 0) && (husb->EP.IN[EpAddress].Transfer.length == 0))
+            {
+                usb_EP0_outStart(husb);
+            }
+        }
+#endif
+    }
+
+    /* Fill empty Tx FIFO with available data */
+    if ((epint & USB_OTG_DIEPINT_TXFE) != 0)
+    {
+        USB_EndPointHandleType * ep = &husb->EP.IN[EpAddress];
+        uint32_t space = husb->Inst->IEP[EpAddress].DTXFSTS & USB_OTG_DTXFSTS_INEPTFSAV;
+
+        /* The FIFO space only grows while it is filled,
+         * so as many whole packets are written as the space read once allows */
+        while (ep->Transfer.size < ep->Transfer.length)
+        {
+            uint32_t count = ep->Transfer.length - ep->Transfer.size;
+
+            if (count > ep->MaxPacketSize)
+            {
+                count = ep->MaxPacketSize;
+            }
+            if (space < ((count + 3) / 4))
+            {
+                break;
+            }
+            space -= (count + 3) / 4;
+
+            /* Write another packet to FIFO */
+            usb_writePacket(husb->Inst, EpAddress, ep->Transfer.buffer, count);
+            XPD_STATS_ADD(husb, Bytes, count);
+
+            ep->Transfer.buffer += count;
+            ep->Transfer.size   += count;
+        }
+
+        if (ep->Transfer.size >= ep->Transfer.length)
+        {
+            /* All data is in the FIFO, clear empty EP flag */
+            CLEAR_BIT(husb->Inst->DIEPEMPMSK, 0x1 << EpAddress);
+        }
+    }
+
+#ifdef USE_XPD_STATISTICS
+    /* IN token timeout is counted as packet error */
+    if ((epint & USB_OTG_DIEPINT_TOC) != 0)
+    {
+        XPD_STATS_ERROR(husb, 1);
+    }
+#endif
+
+    /* Clear irrelevant flags */
+    husb->Inst->IEP[EpAddress].DIEPINT.w =
+            USB_OTG_DIEPINT_TOC    | USB_OTG_DIEPINT_ITTXFE
+          | USB_OTG_DIEPINT_INEPNE | USB_OTG_DIEPINT_EPDISD;
+}
+
 /** @defgroup USB_Exported_Functions USB Exported Functions
  * @{ */
 
@@ -165,6 +359,24 @@ XPD_ReturnType XPD_USB_Init(USB_HandleType * husb, const USB_InitType * Config)
         }
 
         XPD_OTG_HS_Reset();
+
+        husb->DedicatedEP1 = Config->DedicatedEP1;
+
+        if (Config->Speed == USB_SPEED_HIGH)
+        {
+            /* Select the external ULPI PHY with internal VBUS drive and indicator */
+            CLEAR_BIT(husb->Inst->GUSBCFG.w,
+                    USB_OTG_GUSBCFG_TSDPS | USB_OTG_GUSBCFG_ULPIFSLS | USB_OTG_GUSBCFG_PHYSEL |
+                    USB_OTG_GUSBCFG_ULPIEVBUSD | USB_OTG_GUSBCFG_ULPIEVBUSI);
+        }
+        else
+        {
+            /* Select FS Embedded PHY */
+            USB_REG_BIT(husb,GUSBCFG,PHYSEL) = 1;
+
+            /* Deactivate the power down */
+            USB_REG_BIT(husb,GCCFG,PWRDWN) = 1;
+        }
     }
     /* OTG_FS does not support Hgh speed ULPI interface */
     else if (Config->Speed == USB_SPEED_HIGH)
@@ -175,6 +387,10 @@ XPD_ReturnType XPD_USB_Init(USB_HandleType * husb, const USB_InitType * Config)
 #endif
     /* Embedded FS interface */
     {
+#ifdef USB_OTG_HS
+        husb->DedicatedEP1 = DISABLE;
+#endif
+
         XPD_OTG_FS_ClockCtrl(ENABLE);
 
         XPD_OTG_FS_Reset();
@@ -189,6 +405,21 @@ XPD_ReturnType XPD_USB_Init(USB_HandleType * husb, const USB_InitType * Config)
     /* Disable the Interrupts */
     USB_REG_BIT(husb,GAHBCFG,GINT) = 0;
 
+    /* Select the IN FIFO level of the Tx FIFO empty interrupt */
+    USB_REG_BIT(husb,GAHBCFG,TXFELVL) = Config->TxFifoEmpty;
+
+#if (USB_DATA_WORD_ALIGNED == 1) && defined(USB_OTG_GAHBCFG_DMAEN)
+    /* Only the HS core has dedicated DMA */
+    if ((Config->DMA != DISABLE)
+#ifdef USB_OTG_HS
+         && (((uint32_t)husb->Inst) != ((uint32_t)USB_OTG_HS))
+#endif
+       )
+    {
+        return XPD_ERROR;
+    }
+#endif
+
 #if (USB_DATA_WORD_ALIGNED == 1) && defined(USB_OTG_GAHBCFG_DMAEN)
     /* Set dedicated DMA */
     if (Config->DMA != DISABLE)
@@ -249,6 +480,9 @@ XPD_ReturnType XPD_USB_Init(USB_HandleType * husb, const USB_InitType * Config)
         husb->Inst->DOEPMSK.w  = 0;
         husb->Inst->DAINT.w    = ~0;
         husb->Inst->DAINTMSK.w = 0;
+#ifdef USB_OTG_HS
+        husb->Inst->DEACHMSK   = 0;
+#endif
 
         /* Init endpoints structures */
         for (i = 0; i < epCount; i++)
@@ -295,10 +529,13 @@ XPD_ReturnType XPD_USB_Init(USB_HandleType * husb, const USB_InitType * Config)
 #if (USB_DATA_WORD_ALIGNED == 1) && defined(USB_OTG_GAHBCFG_DMAEN)
         if (Config->DMA != DISABLE)
         {
-            /*Set threshold parameters */
-            husb->Inst->DTHRCTL.w = (USB_OTG_DTHRCTL_TXTHRLEN_6 | USB_OTG_DTHRCTL_RXTHRLEN_6 |
+            uint32_t threshold = (Config->DMAThreshold != 0) ? Config->DMAThreshold : 64;
+
+            /* Set threshold parameters */
+            husb->Inst->DTHRCTL.w = (threshold << USB_OTG_DTHRCTL_TXTHRLEN_Pos) |
+                    (threshold << USB_OTG_DTHRCTL_RXTHRLEN_Pos) |
                     USB_OTG_DTHRCTL_RXTHREN |
-                    USB_OTG_DTHRCTL_ISOTHREN | USB_OTG_DTHRCTL_NONISOTHREN);
+                    USB_OTG_DTHRCTL_ISOTHREN | USB_OTG_DTHRCTL_NONISOTHREN;
         }
 #endif
 
@@ -422,6 +659,9 @@ void XPD_USB_Stop(USB_HandleType * husb)
     husb->Inst->DIEPMSK.w  = 0;
     husb->Inst->DOEPMSK.w  = 0;
     husb->Inst->DAINTMSK.w = 0;
+#ifdef USB_OTG_HS
+    husb->Inst->DEACHMSK   = 0;
+#endif
 
     /* Flush the FIFO */
     usb_flushRxFifo(husb->Inst);
@@ -468,6 +708,89 @@ void XPD_USB_EP_BufferInit(USB_HandleType * husb, uint8_t EpAddress, uint16_t Bu
     }
 }
 
+/**
+ * @brief Allocates the peripheral FIFO RAM for the endpoints of the configuration
+ *        after device initialization and before starting the USB operation.
+ *        The global receive FIFO holds the SETUP packets and two of the largest OUT packets,
+ *        each IN endpoint gets a transmit FIFO of one packet, then the remaining space
+ *        is shared out by whole packets among the bulk and isochronous IN endpoints,
+ *        so that multiple packets can be queued for them.
+ * @note  This function replaces the manual allocation by @ref XPD_USB_EP_BufferInit.
+ * @param husb: pointer to the USB handle structure
+ * @param Endpoints: the endpoints of the configuration (except EP0)
+ * @param Count: the number of endpoints
+ * @return ERROR if the endpoints are invalid or don't fit in the FIFO RAM, OK if success
+ */
+XPD_ReturnType XPD_USB_EP_FifoAlloc(USB_HandleType * husb,
+        const USB_EndPointConfigType * Endpoints, uint8_t Count)
+{
+    uint8_t i, epCount = USB_ENDPOINT_COUNT(husb);
+    uint32_t maxOut = USB_EP0_MAX_PACKET_SIZE, outCount = 1;
+    uint32_t used, added;
+
+    for (i = 1; i < epCount; i++)
+    {
+        husb->EP.IN[i].FifoSize = 0;
+    }
+
+    /* The minimal transmit FIFOs of the IN endpoints */
+    husb->EP.IN[0].FifoSize = USB_FIFO_DEPTH(USB_EP0_MAX_PACKET_SIZE);
+    used = husb->EP.IN[0].FifoSize;
+
+    for (i = 0; i < Count; i++)
+    {
+        uint8_t epNum = Endpoints[i].Address & 0x7F;
+
+        if ((epNum == 0) || (epNum >= epCount))
+        {
+            return XPD_ERROR;
+        }
+        else if (Endpoints[i].Address > 0x7F)
+        {
+            husb->EP.IN[epNum].FifoSize = USB_FIFO_DEPTH(Endpoints[i].MaxPacketSize);
+            used += husb->EP.IN[epNum].FifoSize;
+        }
+        else
+        {
+            outCount++;
+            if (maxOut < Endpoints[i].MaxPacketSize)
+            {
+                maxOut = Endpoints[i].MaxPacketSize;
+            }
+        }
+    }
+
+    /* Receive FIFO: SETUP packets, two of the largest packets with their status,
+     * transfer complete status of each OUT endpoint and global OUT NAK */
+    husb->EP.OUT[0].FifoSize = (5 + 8) + 2 * (USB_FIFO_WORDS(maxOut) + 1) + 2 * outCount + 1;
+    used += husb->EP.OUT[0].FifoSize;
+
+    if (used > USB_FIFO_RAM_WORDS(husb))
+    {
+        return XPD_ERROR;
+    }
+
+    /* Extend the streaming IN endpoint FIFOs by a packet in turns while there is space */
+    do {
+        added = 0;
+        for (i = 0; i < Count; i++)
+        {
+            uint32_t words = USB_FIFO_WORDS(Endpoints[i].MaxPacketSize);
+
+            if ((Endpoints[i].Address > 0x7F) && (words > 0) &&
+                ((Endpoints[i].Type == USB_EP_TYPE_BULK) || (Endpoints[i].Type == USB_EP_TYPE_ISOCHRONOUS)) &&
+                ((used + words) <= USB_FIFO_RAM_WORDS(husb)))
+            {
+                husb->EP.IN[Endpoints[i].Address & 0x7F].FifoSize += words;
+                used  += words;
+                added += words;
+            }
+        }
+    } while (added > 0);
+
+    return XPD_OK;
+}
+
 /**
  * @brief Opens an endpoint
  * @param husb: pointer to the USB handle structure
@@ -485,7 +808,7 @@ void XPD_USB_EP_Open(USB_HandleType * husb, uint8_t EpAddress, USB_EndPointType
     /* Activate Endpoint */
     if (EP_IS_IN(husb,ep))
     {
-        SET_BIT(husb->Inst->DAINTMSK.w, 1 << EpAddress);
+        SET_BIT(*USB_EP_INT_MASK(husb, EpAddress), 1 << EpAddress);
 
         /* Check if currently inactive */
         if (husb->Inst->IEP[EpAddress].DIEPCTL.b.USBAEP == 0)
@@ -499,7 +822,7 @@ void XPD_USB_EP_Open(USB_HandleType * husb, uint8_t EpAddress, USB_EndPointType
     }
     else
     {
-        SET_BIT(husb->Inst->DAINTMSK.w, 1 << (EpAddress + 16));
+        SET_BIT(*USB_EP_INT_MASK(husb, EpAddress), 1 << (EpAddress + 16));
 
         /* Check if currently inactive */
         if (husb->Inst->OEP[EpAddress].DOEPCTL.b.USBAEP == 0)
@@ -540,7 +863,7 @@ void XPD_USB_EP_Close(USB_HandleType * husb, uint8_t EpAddress)
         usb_flushTxFifo(husb->Inst, 0x10);
 
         /* Disable endpoint interrupts */
-        CLEAR_BIT(husb->Inst->DAINTMSK.w, 1 << EpAddress);
+        CLEAR_BIT(*USB_EP_INT_MASK(husb, EpAddress), 1 << EpAddress);
     }
     else
     {
@@ -559,7 +882,7 @@ void XPD_USB_EP_Close(USB_HandleType * husb, uint8_t EpAddress)
         USB_REG_BIT(husb,DCTL,CGONAK) = 1;
 
         /* Disable endpoint interrupts */
-        CLEAR_BIT(husb->Inst->DAINTMSK.w, 1 << (EpAddress + 16));
+        CLEAR_BIT(*USB_EP_INT_MASK(husb, EpAddress), 1 << (EpAddress + 16));
     }
 }
 
@@ -582,6 +905,9 @@ void XPD_USB_EP_Flush(USB_HandleType * husb, uint8_t EpAddress)
 
 /**
  * @brief Initiates data reception on the OUT endpoint
+ * @note  When DMA is used, the whole transfer is received without CPU intervention,
+ *        and the Data buffer shall be word aligned, and have space for
+ *        the Length rounded up to an integer multiple of the max packet size.
  * @param husb: pointer to the USB handle structure
  * @param EpAddress: endpoint number
  * @param Data: pointer to the data buffer
@@ -661,6 +987,8 @@ uint16_t XPD_USB_EP_GetRxCount(USB_HandleType * husb, uint8_t EpAddress)
 
 /**
  * @brief Initiates data transmission on the IN endpoint
+ * @note  When DMA is used, the whole transfer is transmitted without CPU intervention,
+ *        and the Data buffer shall be word aligned.
  * @param husb: pointer to the USB handle structure
  * @param EpAddress: endpoint number
  * @param Data: pointer to the data buffer
@@ -816,12 +1144,55 @@ void XPD_USB_EP_ClearStall(USB_HandleType * husb, uint8_t EpAddress)
     ep->Stalled = FALSE;
 }
 
+#ifdef USE_XPD_CONST_CALLBACKS
+/**
+ * @brief USB event callback without any operation,
+ *        for the unused single parameter entries of the constant callback table.
+ * @param User: pointer to the upper stack handler
+ * @return 0
+ */
+int XPD_USB_NullCallback(void * User)
+{
+    (void) User;
+    return 0;
+}
+#endif
+
+/**
+ * @brief Connects the SOF pulse of the USB peripheral to the TIM2 internal trigger 1,
+ *        so the timer can capture the start of each frame.
+ * @note  The TIM2 capture channel has to use the TIM_INPUT_TRC source and
+ *        the TIM_TRGI_ITR1 trigger input.
+ * @param husb: pointer to the USB handle structure
+ * @param NewState: whether TIM2 ITR1 is connected to the USB SOF instead of TIM8 TRGO
+ */
+void XPD_USB_SOF_TimerTrigger(USB_HandleType * husb, FunctionalState NewState)
+{
+    if (NewState == DISABLE)
+    {
+        CLEAR_BIT(TIM2->OR, TIM_OR_ITR1_RMP);
+    }
+#ifdef USB_OTG_HS
+    else if (((uint32_t)husb->Inst) == ((uint32_t)USB_OTG_HS))
+    {
+        MODIFY_REG(TIM2->OR, TIM_OR_ITR1_RMP, TIM_OR_ITR1_RMP);
+    }
+#endif
+    else
+    {
+        MODIFY_REG(TIM2->OR, TIM_OR_ITR1_RMP, TIM_OR_ITR1_RMP_1);
+    }
+}
+
 /**
  * @brief USB interrupt handler that provides event-driven peripheral management and handle callbacks.
  * @param husb: pointer to the USB handle structure
  */
 void XPD_USB_IRQHandler(USB_HandleType * husb)
 {
+    XPD_PROFILE_BEGIN();
+    XPD_STATS_IRQ_BEGIN();
+
     uint32_t gints = husb->Inst->GINTSTS.w & husb->Inst->GINTMSK.w;
 
     if (gints != 0)
@@ -846,52 +1217,7 @@ void XPD_USB_IRQHandler(USB_HandleType * husb)
                 {
                     uint32_t epint = husb->Inst->OEP[EpAddress].DOEPINT.w & husb->Inst->DOEPMSK.w;
 
-                    /* Transfer completed */
-                    if ((epint & USB_OTG_DOEPINT_XFRC) != 0)
-                    {
-                        /* Clear IT flag */
-                        husb->Inst->OEP[EpAddress].DOEPINT.w = USB_OTG_DOEPINT_XFRC;
-
-#if (USB_DATA_WORD_ALIGNED == 1) && defined(USB_OTG_GAHBCFG_DMAEN)
-                        if (husb->DMA == ENABLE)
-                        {
-                            husb->EP.OUT[EpAddress].Transfer.size = husb->EP.OUT[EpAddress].MaxPacketSize
-                                    - husb->Inst->OEP[EpAddress]->DOEPTSIZ.b.XFRSIZ;
-                            husb->EP.OUT[EpAddress].Transfer.buffer += husb->EP.OUT[EpAddress].MaxPacketSize;
-                        }
-#endif
-
-                        /* Data packet received callback */
-                        XPD_SAFE_CALLBACK(husb->Callbacks.DataOutStage, husb->User, EpAddress, husb->EP.OUT[EpAddress].Transfer.buffer);
-
-#if (USB_DATA_WORD_ALIGNED == 1) && defined(USB_OTG_GAHBCFG_DMAEN)
-                        if (husb->DMA == ENABLE)
-                        {
-                            if ((EpAddress == 0) && (husb->EP.OUT[EpAddress].Transfer.length == 0))
-                            {
-                                /* this is ZLP, so prepare EP0 for next setup */
-                                usb_EP0_outStart(husb);
-                            }
-                        }
-#endif
-                    }
-
-                    /* Setup request arrived */
-                    if ((epint & USB_OTG_DOEPINT_STUP) != 0)
-                    {
-                        /* Clear IT flag */
-                        husb->Inst->OEP[EpAddress].DOEPINT.w = USB_OTG_DOEPINT_STUP;
-
-                        /* Setup packet received callback */
-                        XPD_SAFE_CALLBACK(husb->Callbacks.SetupStage, husb->User, (uint8_t *)husb->Setup);
-                    }
-
-                    /* Clear irrelevant flags */
-                    husb->Inst->OEP[EpAddress].DOEPINT.w =
-#ifdef USB_OTG_DOEPINT_OTEPSPR
-                    USB_OTG_DOEPINT_OTEPSPR |
-#endif
-                    USB_OTG_DOEPINT_OTEPDIS;
+                    usb_outEpEvent(husb, EpAddress, epint);
                 }
             }
         }
@@ -911,74 +1237,7 @@ void XPD_USB_IRQHandler(USB_HandleType * husb)
                     uint32_t epint = husb->Inst->IEP[EpAddress].DIEPINT.w &
                             (husb->Inst->DIEPMSK.w | (((husb->Inst->DIEPEMPMSK >> EpAddress) & 0x1) << 7));
 
-                    /* Transfer completed */
-                    if ((epint & USB_OTG_DIEPINT_XFRC) != 0)
-                    {
-                        CLEAR_BIT(husb->Inst->DIEPEMPMSK, 0x1 << EpAddress);
-
-                        /* Clear IT flag */
-                        husb->Inst->IEP[EpAddress].DIEPINT.w = USB_OTG_DIEPINT_XFRC;
-
-#if (USB_DATA_WORD_ALIGNED == 1) && defined(USB_OTG_GAHBCFG_DMAEN)
-                        if (husb->DMA == ENABLE)
-                        {
-                            husb->EP.IN[EpAddress].Transfer.buffer += husb->EP.IN[EpAddress].MaxPacketSize;
-                        }
-#endif
-
-                        XPD_SAFE_CALLBACK(husb->Callbacks.DataInStage, husb->User, EpAddress, husb->EP.IN[EpAddress].Transfer.buffer);
-
-#if (USB_DATA_WORD_ALIGNED == 1) && defined(USB_OTG_GAHBCFG_DMAEN)
-                        if (husb->DMA == ENABLE)
-                        {
-                            /* this is ZLP, so prepare EP0 for next setup */
-                            if ((EpAddress == 0) && (husb->EP.IN[EpAddress].Transfer.length == 0))
-                            {
-                                usb_EP0_outStart(husb);
-                            }
-                        }
-#endif
-                    }
-
-                    /* Fill empty Tx FIFO with available data */
-                    if ((epint & USB_OTG_DIEPINT_TXFE) != 0)
-                    {
-                        USB_EndPointHandleType * ep = &husb->EP.IN[EpAddress];
-                        uint32_t count = ep->Transfer.length - ep->Transfer.size;
-
-                        if (count > ep->MaxPacketSize)
-                        {
-                            count = ep->MaxPacketSize;
-                        }
-
-                        while ((ep->Transfer.size < ep->Transfer.length) &&
-                               (husb->Inst->IEP[EpAddress].DTXFSTS > ((count + 3) / 4)))
-                        {
-                            count = ep->Transfer.length - ep->Transfer.size;
-
-                            if (count > ep->MaxPacketSize)
-                            {
-                                count = ep->MaxPacketSize;
-                            }
-
-                            /* Write another packet to FIFO */
-                            usb_writePacket(husb->Inst, EpAddress, ep->Transfer.buffer, count);
-
-                            ep->Transfer.buffer += count;
-                            ep->Transfer.size   += count;
-                        }
-
-                        if (count == 0)
-                        {
-                            /* Clear empty EP flag */
-                            CLEAR_BIT(husb->Inst->DIEPEMPMSK, 0x1 << EpAddress);
-                        }
-                    }
-
-                    /* Clear irrelevant flags */
-                    husb->Inst->IEP[EpAddress].DIEPINT.w =
-                            USB_OTG_DIEPINT_TOC    | USB_OTG_DIEPINT_ITTXFE
-                          | USB_OTG_DIEPINT_INEPNE | USB_OTG_DIEPINT_EPDISD;
+                    usb_inEpEvent(husb, EpAddress, epint);
                 }
             }
         }
@@ -999,6 +1258,7 @@ void XPD_USB_IRQHandler(USB_HandleType * husb)
                 case STS_DATA_UPDT:
                     /* Data packet received */
                     usb_readPacket(husb->Inst, ep->Transfer.buffer, count);
+                    XPD_STATS_ADD(husb, Bytes, count);
                     ep->Transfer.buffer += count;
                     ep->Transfer.size   += count;
                     break;
@@ -1006,6 +1266,7 @@ void XPD_USB_IRQHandler(USB_HandleType * husb)
                 case STS_SETUP_UPDT:
                     /* Setup packet received */
                     usb_readPacket(husb->Inst, (uint8_t *) husb->Setup, count);
+                    XPD_STATS_ADD(husb, Bytes, count);
                     ep->Transfer.size += count;
                     break;
 
@@ -1044,6 +1305,14 @@ void XPD_USB_IRQHandler(USB_HandleType * husb)
                 SET_BIT(husb->Inst->DIEPMSK.w, USB_OTG_DIEPMSK_TOM
                         | USB_OTG_DIEPMSK_XFRCM | USB_OTG_DIEPMSK_EPDM);
             }
+#ifdef USB_OTG_HS
+            /* The dedicated EP1 lines use the same endpoint event masks */
+            if (husb->DedicatedEP1 != DISABLE)
+            {
+                husb->Inst->DOUTEP1MSK = husb->Inst->DOEPMSK.w;
+                husb->Inst->DINEP1MSK  = husb->Inst->DIEPMSK.w;
+            }
+#endif
 
             /* Set Default Address to 0 */
             husb->Inst->DCFG.b.DAD = 0;
@@ -1087,18 +1356,26 @@ void XPD_USB_IRQHandler(USB_HandleType * husb)
 
             XPD_USB_ClearFlag(husb, ENUMDNE);
 
-            XPD_SAFE_CALLBACK(husb->Callbacks.Reset, husb->User);
+            XPD_TRACE(XPD_TRACE_USB_RESET, 0);
+            XPD_HANDLE_CALLBACK(husb, Reset, husb->User);
         }
 
         /* Handle Resume Interrupt */
         if ((gints & USB_OTG_GINTSTS_WKUINT) != 0)
         {
+            /* Restore the PHY clock first to resume the link quickly */
+            if (husb->LowPowerMode == ENABLE)
+            {
+                XPD_USB_PHY_ClockCtrl(husb, ENABLE);
+            }
+
             /* Clear the Remote Wake-up Signaling */
             USB_REG_BIT(husb,DCTL,RWUSIG) = 0;
 
             XPD_USB_ClearFlag(husb, WKUINT);
 
-            XPD_SAFE_CALLBACK(husb->Callbacks.Resume, husb->User);
+            XPD_TRACE(XPD_TRACE_USB_RESUME, 0);
+            XPD_HANDLE_CALLBACK(husb, Resume, husb->User);
 
             /* LPM state is changed after Resume callback
              * -> possible to determine exited suspend level */
@@ -1111,9 +1388,20 @@ void XPD_USB_IRQHandler(USB_HandleType * husb)
         {
             XPD_USB_ClearFlag(husb, LPMINT);
 
-            /* Set the target Link State */
-            husb->LinkState = USB_LPM_L1;
-            XPD_SAFE_CALLBACK(husb->Callbacks.Suspend, husb->User);
+            /* Only the transition from the active state is an L1 entry */
+            if (husb->LinkState == USB_LPM_L0)
+            {
+                /* Set the target Link State */
+                husb->LinkState = USB_LPM_L1;
+                XPD_TRACE(XPD_TRACE_USB_SUSPEND, husb->LinkState);
+                XPD_HANDLE_CALLBACK(husb, Suspend, husb->User);
+
+                /* Gate the PHY clock, the host resumes within the BESL time */
+                if (husb->LowPowerMode == ENABLE)
+                {
+                    XPD_USB_PHY_ClockCtrl(husb, DISABLE);
+                }
+            }
         }
 #endif
 
@@ -1126,7 +1414,14 @@ void XPD_USB_IRQHandler(USB_HandleType * husb)
             {
                 /* Set the target Link State */
                 husb->LinkState = USB_LPM_L2;
-                XPD_SAFE_CALLBACK(husb->Callbacks.Suspend, husb->User);
+                XPD_TRACE(XPD_TRACE_USB_SUSPEND, husb->LinkState);
+                XPD_HANDLE_CALLBACK(husb, Suspend, husb->User);
+
+                /* Gate the PHY clock until the bus is resumed */
+                if (husb->LowPowerMode == ENABLE)
+                {
+                    XPD_USB_PHY_ClockCtrl(husb, DISABLE);
+                }
             }
         }
 
@@ -1134,7 +1429,7 @@ void XPD_USB_IRQHandler(USB_HandleType * husb)
         if ((gints & USB_OTG_GINTSTS_SRQINT) != 0)
         {
             XPD_USB_ClearFlag(husb, SRQINT);
-            XPD_SAFE_CALLBACK(husb->Callbacks.Connected, husb->User);
+            XPD_HANDLE_CALLBACK(husb, Connected, husb->User);
         }
 
         /* Handle Disconnection event Interrupt */
@@ -1142,7 +1437,7 @@ void XPD_USB_IRQHandler(USB_HandleType * husb)
         {
             if ((husb->Inst->GOTGINT.w & USB_OTG_GOTGINT_SEDET) != 0)
             {
-                XPD_SAFE_CALLBACK(husb->Callbacks.Disconnected, husb->User);
+                XPD_HANDLE_CALLBACK(husb, Disconnected, husb->User);
             }
 
             /* Clear all flags */
@@ -1154,10 +1449,78 @@ void XPD_USB_IRQHandler(USB_HandleType * husb)
         {
             XPD_USB_ClearFlag(husb, SOF);
 
-            XPD_SAFE_CALLBACK(husb->Callbacks.SOF, husb->User);
+            XPD_HANDLE_CALLBACK(husb, SOF, husb->User);
         }
     }
+
+    XPD_STATS_IRQ_END(husb);
+    XPD_PROFILE_END();
+}
+
+/**
+ * @brief Services the pending USB events with bounded work, the handle callbacks
+ *        are called the same way as from the interrupt handler.
+ * @note  In polled operation the USB IRQ is kept disabled in NVIC, and this function
+ *        is called periodically from a fixed point of the application loop.
+ * @param husb: pointer to the USB handle structure
+ * @param MaxPackets: the maximum number of interrupt handler passes, each of them
+ *                    processes at most one received packet from the receive FIFO
+ * @return The number of performed passes
+ */
+uint32_t XPD_USB_Poll(USB_HandleType * husb, uint32_t MaxPackets)
+{
+    uint32_t packets;
+
+    for (packets = 0; (packets < MaxPackets)
+            && ((husb->Inst->GINTSTS.w & husb->Inst->GINTMSK.w) != 0); packets++)
+    {
+        XPD_USB_IRQHandler(husb);
+    }
+    return packets;
+}
+
+#ifdef USB_OTG_HS
+/**
+ * @brief USB HS core EP1 OUT dedicated interrupt handler.
+ * @note  Only serves events when @ref USB_InitType::DedicatedEP1 is enabled,
+ *        in which case the OTG_HS_EP1_OUT IRQ shall be enabled as well.
+ * @param husb: pointer to the USB handle structure
+ */
+void XPD_USB_EP1_OUT_IRQHandler(USB_HandleType * husb)
+{
+    XPD_PROFILE_BEGIN();
+    XPD_STATS_IRQ_BEGIN();
+
+    if (husb->Inst->DEACHINT.b.OEP1INT != 0)
+    {
+        usb_outEpEvent(husb, 1, husb->Inst->OEP[1].DOEPINT.w & husb->Inst->DOUTEP1MSK);
+    }
+
+    XPD_STATS_IRQ_END(husb);
+    XPD_PROFILE_END();
+}
+
+/**
+ * @brief USB HS core EP1 IN dedicated interrupt handler.
+ * @note  Only serves events when @ref USB_InitType::DedicatedEP1 is enabled,
+ *        in which case the OTG_HS_EP1_IN IRQ shall be enabled as well.
+ * @param husb: pointer to the USB handle structure
+ */
+void XPD_USB_EP1_IN_IRQHandler(USB_HandleType * husb)
+{
+    XPD_PROFILE_BEGIN();
+    XPD_STATS_IRQ_BEGIN();
+
+    if (husb->Inst->DEACHINT.b.IEP1INT != 0)
+    {
+        usb_inEpEvent(husb, 1, husb->Inst->IEP[1].DIEPINT.w &
+                (husb->Inst->DINEP1MSK | (((husb->Inst->DIEPEMPMSK >> 1) & 0x1) << 7)));
+    }
+
+    XPD_STATS_IRQ_END(husb);
+    XPD_PROFILE_END();
 }
+#endif
 
 /**
  * @brief Sets the USB PHY clock status.
@@ -1175,8 +1538,19 @@ void XPD_USB_PHY_ClockCtrl(USB_HandleType * husb, FunctionalState NewState)
  */
 void XPD_USB_ActivateRemoteWakeup(USB_HandleType * husb)
 {
-    if (USB_REG_BIT(husb,DSTS,SUSPSTS) != 0)
+    if ((USB_REG_BIT(husb,DSTS,SUSPSTS) != 0)
+#ifdef USB_OTG_GLPMCFG_LPMEN
+        /* L1 remote wakeup is only allowed if the host enabled it in the LPM token */
+        || ((husb->LinkState == USB_LPM_L1) && (USB_REG_BIT(husb,GLPMCFG,REMWAKE) != 0))
+#endif
+       )
     {
+        /* The PHY clock is needed for the signaling */
+        if (husb->LowPowerMode == ENABLE)
+        {
+            XPD_USB_PHY_ClockCtrl(husb, ENABLE);
+        }
+
         /* Activate Remote wakeup signaling */
         USB_REG_BIT(husb,DCTL,RWUSIG) = 1;
     }
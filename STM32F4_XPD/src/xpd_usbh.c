@@ -0,0 +1,1009 @@
+/**
+  ******************************************************************************
+  * @file    xpd_usbh.c
+  * @author  Benedek Kupper
+  * @version V0.1
+  * @date    2018-01-20
+  * @brief   STM32 eXtensible Peripheral Drivers USB Host Controller Module
+  *
+  *  This file is part of STM32_XPD.
+  *
+  *  STM32_XPD is free software: you can redistribute it and/or modify
+  *  it under the terms of the GNU General Public License as published by
+  *  the Free Software Foundation, either version 3 of the License, or
+  *  (at your option) any later version.
+  *
+  *  STM32_XPD is distributed in the hope that it will be useful,
+  *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with STM32_XPD.  If not, see <http://www.gnu.org/licenses/>.
+  */
+#include "xpd_usbh.h"
+#include "xpd_rcc.h"
+#include "xpd_utils.h"
+
+#if defined(USB_OTG_FS) && defined(USE_XPD_USBH)
+
+/** @addtogroup USBH
+ * @{ */
+
+#ifdef USB_OTG_HS
+#define USBH_CHANNEL_COUNT(HANDLE)     \
+    ((((uint32_t)(HANDLE)->Inst) == ((uint32_t)USB_OTG_HS)) ? 12 : 8)
+#else
+#define USBH_CHANNEL_COUNT(HANDLE)     8
+#endif
+
+/* The port status change bits are cleared, and the port is disabled by writing 1 */
+#define USBH_HPRT_WC_MASK       \
+    (USB_OTG_HPRT_PENA | USB_OTG_HPRT_PCDET | USB_OTG_HPRT_PENCHNG | USB_OTG_HPRT_POCCHNG)
+
+#define USBH_PID_DATA0          0
+#define USBH_PID_DATA1          2
+#define USBH_PID_SETUP          3
+
+#define STS_IN_DATA             (2 << USB_OTG_GRXSTSP_PKTSTS_Pos)
+
+/* The packet count of a single core transfer, the buffer is split to multiple transfers above it */
+#define USBH_MAX_PACKETS        256
+
+/* The number of transaction errors after which the transfer is given up */
+#define USBH_MAX_ERRORS         3
+
+#define USB_FIFO_WORDS(BYTES)   (((uint32_t)(BYTES) + 3) / 4)
+
+/* Channel halt reasons */
+#define USBH_CH_IDLE            0
+#define USBH_CH_ACTIVE          1
+#define USBH_CH_DONE            2
+#define USBH_CH_NAK             3
+#define USBH_CH_STALL           4
+#define USBH_CH_TXERR           5
+#define USBH_CH_ERROR           6
+#define USBH_CH_ABORT           7
+
+#define CH_IS_IN(CHANNEL)       (((CHANNEL)->EpAddress & 0x80) != 0)
+
+#define CH_IS_PERIODIC(CHANNEL) \
+    (((CHANNEL)->Type == USB_EP_TYPE_INTERRUPT) || ((CHANNEL)->Type == USB_EP_TYPE_ISOCHRONOUS))
+
+static void usbh_channelFinish(USBH_HandleType * husbh, uint8_t Channel);
+static void usbh_channelStart(USBH_HandleType * husbh, uint8_t Channel, uint32_t Pid);
+
+/* Get the port register value which can be written back without side effects */
+__STATIC_INLINE uint32_t usbh_getPort(USBH_HandleType * husbh)
+{
+    return husbh->Inst->HPRT.w & ~USBH_HPRT_WC_MASK;
+}
+
+/* Flush all transmit FIFOs */
+__STATIC_INLINE void usbh_flushTxFifo(USB_OTG_TypeDef * USBx)
+{
+    uint32_t timeout = 2;
+    USBx->GRSTCTL.w = USB_OTG_GRSTCTL_TXFFLSH | (0x10 << 6);
+
+    XPD_WaitForDiff(&USBx->GRSTCTL.w, USB_OTG_GRSTCTL_TXFFLSH, USB_OTG_GRSTCTL_TXFFLSH, &timeout);
+}
+
+/* Flush the receive FIFO */
+__STATIC_INLINE void usbh_flushRxFifo(USB_OTG_TypeDef * USBx)
+{
+    uint32_t timeout = 2;
+    USBx->GRSTCTL.w = USB_OTG_GRSTCTL_RXFFLSH;
+
+    XPD_WaitForDiff(&USBx->GRSTCTL.w, USB_OTG_GRSTCTL_RXFFLSH, USB_OTG_GRSTCTL_RXFFLSH, &timeout);
+}
+
+/* Push packet data to the channel's transmit FIFO */
+static void usbh_writePacket(USB_OTG_TypeDef * USBx, uint8_t Channel, uint8_t * Data, uint32_t Length)
+{
+    int32_t wordCount = (Length + 3) / 4;
+
+    for (; wordCount > 0; wordCount--, Data += 4)
+    {
+        USBx->DFIFO[Channel].DR = *((__packed uint32_t *) Data);
+    }
+}
+
+/* Pop a received packet from the FIFO, storing at most Length bytes of it */
+static void usbh_readPacket(USB_OTG_TypeDef * USBx, uint8_t * Data, uint32_t Length, uint32_t Count)
+{
+    uint32_t wordCount = (Count + 3) / 4;
+
+    for (; wordCount > 0; wordCount--)
+    {
+        uint32_t word = USBx->DFIFO[0].DR;
+
+        if (Length >= 4)
+        {
+            *(__packed uint32_t *) Data = word;
+            Data   += 4;
+            Length -= 4;
+        }
+        else
+        {
+            /* The buffer end is not overrun, the excess data is discarded */
+            for (; Length > 0; Length--, word >>= 8)
+            {
+                *Data++ = (uint8_t)word;
+            }
+        }
+    }
+}
+
+/* Fill the transmit FIFO with the pending OUT packets of the channel, as long as it has space */
+static boolean_t usbh_channelPush(USBH_HandleType * husbh, uint8_t Channel)
+{
+    USBH_ChannelHandleType * ch = &husbh->Channel[Channel];
+
+    while (ch->Pending > 0)
+    {
+        uint32_t length = (ch->Pending < ch->MaxPacketSize) ? ch->Pending : ch->MaxPacketSize;
+        uint32_t space, queue;
+
+        if (CH_IS_PERIODIC(ch))
+        {
+            space = husbh->Inst->HPTXSTS.b.PTXFSAVL;
+            queue = husbh->Inst->HPTXSTS.b.PTXQSAV;
+        }
+        else
+        {
+            space = husbh->Inst->HNPTXSTS.b.NPTXFSAV;
+            queue = husbh->Inst->HNPTXSTS.b.NPTQXSAV;
+        }
+
+        if ((queue == 0) || (space < USB_FIFO_WORDS(length)))
+        {
+            break;
+        }
+
+        usbh_writePacket(husbh->Inst, Channel,
+                &ch->Data[ch->Count + ch->XferSize - ch->Pending], length);
+        ch->Pending -= length;
+    }
+
+    return ch->Pending > 0;
+}
+
+/* Start a core transfer with the remaining data of the channel */
+static void usbh_channelStart(USBH_HandleType * husbh, uint8_t Channel, uint32_t Pid)
+{
+    USBH_ChannelHandleType * ch = &husbh->Channel[Channel];
+    USB_OTG_HostChannelTypeDef * hc = &husbh->Inst->HC[Channel];
+    uint32_t remaining = ch->Length - ch->Count;
+    uint32_t packets = (remaining + ch->MaxPacketSize - 1) / ch->MaxPacketSize;
+    uint32_t hcchar;
+
+    if (packets == 0)
+    {
+        packets = 1;
+    }
+    else if (packets > USBH_MAX_PACKETS)
+    {
+        packets = USBH_MAX_PACKETS;
+    }
+
+    /* IN transfers have to be a multiple of the packet size */
+    ch->XferSize = packets * ch->MaxPacketSize;
+    if (!CH_IS_IN(ch) && (ch->XferSize > remaining))
+    {
+        ch->XferSize = remaining;
+    }
+    ch->Packets = packets;
+    ch->Pending = CH_IS_IN(ch) ? 0 : ch->XferSize;
+    ch->Status  = USBH_CH_ACTIVE;
+
+    hc->HCTSIZ.w = ch->XferSize | (packets << USB_OTG_HCTSIZ_PKTCNT_Pos)
+                 | (Pid << USB_OTG_HCTSIZ_DPID_Pos);
+
+    /* Periodic transactions are scheduled for the next frame */
+    hcchar = hc->HCCHAR.w & ~(USB_OTG_HCCHAR_CHDIS | USB_OTG_HCCHAR_ODDFRM);
+    if (CH_IS_PERIODIC(ch) && ((husbh->Inst->HFNUM.b.FRNUM & 1) == 0))
+    {
+        hcchar |= USB_OTG_HCCHAR_ODDFRM;
+    }
+    hc->HCCHAR.w = hcchar | USB_OTG_HCCHAR_CHENA;
+
+    /* The rest of the packets are pushed when the FIFO is emptied */
+    if (usbh_channelPush(husbh, Channel))
+    {
+        SET_BIT(husbh->Inst->GINTMSK.w,
+                CH_IS_PERIODIC(ch) ? USB_OTG_GINTMSK_PTXFEM : USB_OTG_GINTMSK_NPTXFEM);
+    }
+}
+
+/* Count a NAK retry of the channel, returns whether the frame's retry budget allows it right away */
+static boolean_t usbh_nakRetry(USBH_HandleType * husbh, USBH_ChannelHandleType * ch)
+{
+    uint16_t frame = husbh->Inst->HFNUM.b.FRNUM;
+
+    if (frame != ch->NakFrame)
+    {
+        ch->NakFrame = frame;
+        ch->NakCount = 0;
+    }
+    if (ch->NakCount < XPD_USBH_NAK_RETRIES)
+    {
+        ch->NakCount++;
+        return TRUE;
+    }
+    return FALSE;
+}
+
+/* Park the halted channel's NAKed transfer until the next SOF */
+static void usbh_channelDefer(USBH_HandleType * husbh, uint8_t Channel)
+{
+    husbh->Channel[Channel].Status = USBH_CH_ACTIVE;
+    husbh->Deferred |= 1 << Channel;
+
+    SET_BIT(husbh->Inst->GINTMSK.w, USB_OTG_GINTMSK_SOFM);
+}
+
+/* Restart the deferred transfers in the new frame */
+static void usbh_sofEvent(USBH_HandleType * husbh)
+{
+    uint16_t deferred = husbh->Deferred;
+    uint8_t Channel;
+
+    husbh->Deferred = 0;
+
+    for (Channel = 0; deferred != 0; Channel++, deferred >>= 1)
+    {
+        if ((deferred & 1) != 0)
+        {
+            usbh_channelStart(husbh, Channel, husbh->Channel[Channel].Toggle);
+        }
+    }
+
+    if ((husbh->Deferred == 0) && (husbh->SOF == FALSE))
+    {
+        CLEAR_BIT(husbh->Inst->GINTMSK.w, USB_OTG_GINTMSK_SOFM);
+    }
+}
+
+/* Halt the channel, the transfer is concluded when the channel is disabled */
+static void usbh_channelHalt(USBH_HandleType * husbh, uint8_t Channel, uint8_t Status)
+{
+    USB_OTG_HostChannelTypeDef * hc = &husbh->Inst->HC[Channel];
+
+    husbh->Channel[Channel].Status = Status;
+    husbh->Deferred &= ~(1 << Channel);
+
+    if (hc->HCCHAR.b.CHENA != 0)
+    {
+        hc->HCCHAR.w |= USB_OTG_HCCHAR_CHDIS | USB_OTG_HCCHAR_CHENA;
+    }
+    else
+    {
+        usbh_channelFinish(husbh, Channel);
+    }
+}
+
+/* Conclude the halted channel's core transfer: continue, retry or report the result */
+static void usbh_channelFinish(USBH_HandleType * husbh, uint8_t Channel)
+{
+    USBH_ChannelHandleType * ch = &husbh->Channel[Channel];
+    uint32_t hctsiz = husbh->Inst->HC[Channel].HCTSIZ.w;
+    uint32_t pid = (hctsiz & USB_OTG_HCTSIZ_DPID) >> USB_OTG_HCTSIZ_DPID_Pos;
+    boolean_t complete = TRUE;
+    uint8_t status = ch->Status;
+
+    ch->Status = USBH_CH_IDLE;
+
+    if (!CH_IS_IN(ch))
+    {
+        /* The IN data is counted when popped, the OUT data when acknowledged */
+        uint32_t sent = ch->XferSize;
+
+        if (status != USBH_CH_DONE)
+        {
+            uint32_t acked = ch->Packets - ((hctsiz & USB_OTG_HCTSIZ_PKTCNT) >> USB_OTG_HCTSIZ_PKTCNT_Pos);
+
+            acked *= ch->MaxPacketSize;
+            if (acked < sent)
+            {
+                sent = acked;
+            }
+        }
+        if (sent > 0)
+        {
+            ch->ErrorCount = 0;
+        }
+        ch->Count  += sent;
+        ch->Pending = 0;
+    }
+    else
+    {
+        /* A short packet terminated the IN transfer */
+        complete = (hctsiz & USB_OTG_HCTSIZ_XFRSIZ) != 0;
+    }
+    ch->Toggle = pid;
+
+    switch (status)
+    {
+        case USBH_CH_DONE:
+            ch->ErrorCount = 0;
+
+            /* Transfers above the core limit are continued */
+            if (!complete && (ch->Count < ch->Length))
+            {
+                usbh_channelStart(husbh, Channel, pid);
+                return;
+            }
+            ch->State = USBH_URB_DONE;
+            break;
+
+        case USBH_CH_NAK:
+            /* The bulk and control OUT transfers are resumed from the NAKed packet,
+             * within the frame's retry budget, or at the next SOF (the IN channels
+             * are only halted when their budget is spent),
+             * the periodic endpoints are polled by the upper layer */
+            if (!CH_IS_PERIODIC(ch))
+            {
+                if (!CH_IS_IN(ch) && usbh_nakRetry(husbh, ch))
+                {
+                    usbh_channelStart(husbh, Channel, pid);
+                }
+                else
+                {
+                    usbh_channelDefer(husbh, Channel);
+                }
+                return;
+            }
+            ch->State = USBH_URB_NOTREADY;
+            break;
+
+        case USBH_CH_TXERR:
+            if (++ch->ErrorCount < USBH_MAX_ERRORS)
+            {
+                usbh_channelStart(husbh, Channel, pid);
+                return;
+            }
+            ch->State = USBH_URB_ERROR;
+            break;
+
+        case USBH_CH_STALL:
+            ch->State = USBH_URB_STALL;
+            break;
+
+        case USBH_CH_ERROR:
+            ch->State = USBH_URB_ERROR;
+            break;
+
+        default:
+            return;
+    }
+
+    XPD_SAFE_CALLBACK(husbh->Callbacks.Transfer, husbh, Channel);
+}
+
+/* Host channel event handler */
+static void usbh_channelEvent(USBH_HandleType * husbh, uint8_t Channel)
+{
+    USBH_ChannelHandleType * ch = &husbh->Channel[Channel];
+    USB_OTG_HostChannelTypeDef * hc = &husbh->Inst->HC[Channel];
+    uint32_t hcint = hc->HCINT.w & hc->HCINTMSK.w;
+
+    hc->HCINT.w = hcint;
+
+    if ((hcint & (USB_OTG_HCINT_AHBERR | USB_OTG_HCINT_BBERR)) != 0)
+    {
+        usbh_channelHalt(husbh, Channel, USBH_CH_ERROR);
+    }
+    else if ((hcint & USB_OTG_HCINT_STALL) != 0)
+    {
+        usbh_channelHalt(husbh, Channel, USBH_CH_STALL);
+    }
+    else if ((hcint & (USB_OTG_HCINT_TXERR | USB_OTG_HCINT_DTERR | USB_OTG_HCINT_FRMOR)) != 0)
+    {
+        usbh_channelHalt(husbh, Channel, USBH_CH_TXERR);
+    }
+    else if ((hcint & USB_OTG_HCINT_XFRC) != 0)
+    {
+        usbh_channelHalt(husbh, Channel, USBH_CH_DONE);
+    }
+    else if ((hcint & USB_OTG_HCINT_NAK) != 0)
+    {
+        if (CH_IS_IN(ch) && !CH_IS_PERIODIC(ch) && usbh_nakRetry(husbh, ch))
+        {
+            /* NAKed IN token is reissued right away within the frame's budget */
+            hc->HCCHAR.w = (hc->HCCHAR.w & ~USB_OTG_HCCHAR_CHDIS) | USB_OTG_HCCHAR_CHENA;
+        }
+        else
+        {
+            usbh_channelHalt(husbh, Channel, USBH_CH_NAK);
+        }
+    }
+
+    /* The requested halt is complete */
+    if (((hcint & USB_OTG_HCINT_CHH) != 0) && (ch->Status > USBH_CH_ACTIVE))
+    {
+        usbh_channelFinish(husbh, Channel);
+    }
+}
+
+/* Receive FIFO non-empty event handler */
+static void usbh_rxFifoEvent(USBH_HandleType * husbh)
+{
+    uint32_t status, count;
+    uint8_t Channel;
+
+    CLEAR_BIT(husbh->Inst->GINTMSK.w, USB_OTG_GINTMSK_RXFLVLM);
+
+    status  = husbh->Inst->GRXSTSP.w;
+    Channel = status & USB_OTG_GRXSTSP_EPNUM;
+    count   = (status & USB_OTG_GRXSTSP_BCNT) >> USB_OTG_GRXSTSP_BCNT_Pos;
+
+    if (((status & USB_OTG_GRXSTSP_PKTSTS) == STS_IN_DATA) && (count > 0))
+    {
+        USBH_ChannelHandleType * ch = &husbh->Channel[Channel];
+        USB_OTG_HostChannelTypeDef * hc = &husbh->Inst->HC[Channel];
+        uint32_t length = ch->Length - ch->Count;
+
+        if (length > count)
+        {
+            length = count;
+        }
+        usbh_readPacket(husbh->Inst, &ch->Data[ch->Count], length, count);
+        ch->Count     += length;
+        ch->ErrorCount = 0;
+
+        /* Rearm the channel for the next packet of the transfer */
+        if ((count == ch->MaxPacketSize) && ((hc->HCTSIZ.w & USB_OTG_HCTSIZ_PKTCNT) != 0))
+        {
+            hc->HCCHAR.w = (hc->HCCHAR.w & ~USB_OTG_HCCHAR_CHDIS) | USB_OTG_HCCHAR_CHENA;
+        }
+    }
+
+    SET_BIT(husbh->Inst->GINTMSK.w, USB_OTG_GINTMSK_RXFLVLM);
+}
+
+/* Transmit FIFO empty event handler */
+static void usbh_txFifoEvent(USBH_HandleType * husbh, boolean_t Periodic)
+{
+    boolean_t pending = FALSE;
+    uint8_t i;
+
+    for (i = 0; i < USBH_CHANNEL_COUNT(husbh); i++)
+    {
+        USBH_ChannelHandleType * ch = &husbh->Channel[i];
+
+        if ((ch->Pending > 0) && (CH_IS_PERIODIC(ch) == Periodic))
+        {
+            pending |= usbh_channelPush(husbh, i);
+        }
+    }
+
+    if (pending == FALSE)
+    {
+        CLEAR_BIT(husbh->Inst->GINTMSK.w,
+                (Periodic != FALSE) ? USB_OTG_GINTMSK_PTXFEM : USB_OTG_GINTMSK_NPTXFEM);
+    }
+}
+
+/* Host port event handler */
+static void usbh_portEvent(USBH_HandleType * husbh)
+{
+    uint32_t hprt = husbh->Inst->HPRT.w;
+    uint32_t hprtw = hprt & ~USBH_HPRT_WC_MASK;
+    boolean_t connected = FALSE, enabled = FALSE;
+
+    if ((hprt & USB_OTG_HPRT_PCDET) != 0)
+    {
+        hprtw |= USB_OTG_HPRT_PCDET;
+        connected = TRUE;
+    }
+    if ((hprt & USB_OTG_HPRT_PENCHNG) != 0)
+    {
+        hprtw |= USB_OTG_HPRT_PENCHNG;
+
+        if ((hprt & USB_OTG_HPRT_PENA) != 0)
+        {
+            husbh->Speed = (hprt & USB_OTG_HPRT_PSPD) >> USB_OTG_HPRT_PSPD_Pos;
+
+            /* The PHY clock is adjusted to the device speed */
+            if (husbh->Speed == USBH_SPEED_LOW)
+            {
+                husbh->Inst->HCFG.b.FSLSPCS = 2;
+                husbh->Inst->HFIR = 6000;
+            }
+            else
+            {
+                husbh->Inst->HCFG.b.FSLSPCS = 1;
+                husbh->Inst->HFIR = 48000;
+            }
+            enabled = TRUE;
+        }
+    }
+    if ((hprt & USB_OTG_HPRT_POCCHNG) != 0)
+    {
+        hprtw |= USB_OTG_HPRT_POCCHNG;
+    }
+    husbh->Inst->HPRT.w = hprtw;
+
+    if (connected)
+    {
+        XPD_SAFE_CALLBACK(husbh->Callbacks.Connected, husbh);
+    }
+    if (enabled)
+    {
+        XPD_SAFE_CALLBACK(husbh->Callbacks.PortEnabled, husbh);
+    }
+}
+
+/* Device disconnect event handler */
+static void usbh_disconnectEvent(USBH_HandleType * husbh)
+{
+    uint8_t i;
+
+    /* The ongoing transfers are failed */
+    for (i = 0; i < USBH_CHANNEL_COUNT(husbh); i++)
+    {
+        if (husbh->Channel[i].Status == USBH_CH_ACTIVE)
+        {
+            usbh_channelHalt(husbh, i, USBH_CH_ERROR);
+        }
+    }
+
+    usbh_flushTxFifo(husbh->Inst);
+    usbh_flushRxFifo(husbh->Inst);
+
+    XPD_SAFE_CALLBACK(husbh->Callbacks.Disconnected, husbh);
+}
+
+/** @defgroup USBH_Exported_Functions USBH Exported Functions
+ * @{ */
+
+/**
+ * @brief Initializes the USB peripheral in host mode using the setup configuration.
+ * @note  The FIFO sizes together must fit in the core's packet memory (320 words in the FS core).
+ * @param husbh: pointer to the USB Host handle structure
+ * @param Config: USB Host setup configuration
+ * @return OK
+ */
+XPD_ReturnType XPD_USBH_Init(USBH_HandleType * husbh, const USBH_InitType * Config)
+{
+    uint32_t i, gintmsk;
+
+    /* Enable peripheral clock */
+#ifdef USB_OTG_HS
+    if (((uint32_t)husbh->Inst) == ((uint32_t)USB_OTG_HS))
+    {
+        XPD_OTG_HS_ClockCtrl(ENABLE);
+
+        XPD_OTG_HS_Reset();
+    }
+    else
+#endif
+    {
+        XPD_OTG_FS_ClockCtrl(ENABLE);
+
+        XPD_OTG_FS_Reset();
+    }
+
+    /* Select FS Embedded PHY */
+    husbh->Inst->GUSBCFG.b.PHYSEL = 1;
+
+    /* Deactivate the power down */
+    husbh->Inst->GCCFG.b.PWRDWN = 1;
+
+    /* Disable the Interrupts */
+    husbh->Inst->GAHBCFG.b.GINT = 0;
+
+    /* Set Host Mode, which takes effect after 25 ms */
+    MODIFY_REG(husbh->Inst->GUSBCFG.w,
+            USB_OTG_GUSBCFG_FHMOD | USB_OTG_GUSBCFG_FDMOD,
+            USB_OTG_GUSBCFG_FHMOD);
+    XPD_Delay_ms(50);
+
+    /* VBUS is driven by the application, not sensed */
+#ifdef USB_OTG_GCCFG_VBDEN
+    husbh->Inst->GCCFG.b.VBDEN = 0;
+#else
+    MODIFY_REG(husbh->Inst->GCCFG.w,
+            USB_OTG_GCCFG_VBUSASEN | USB_OTG_GCCFG_VBUSBSEN,
+            USB_OTG_GCCFG_NOVBUSSENS);
+#endif
+
+    /* Restart the Phy Clock */
+    husbh->Inst->PCGCCTL.w = 0;
+
+    /* FS and LS devices only, 48 MHz PHY clock */
+    husbh->Inst->HCFG.w = USB_OTG_HCFG_FSLSS | USB_OTG_HCFG_FSLSPCS_0;
+    husbh->Inst->HFIR   = 48000;
+
+    /* Set FIFO sizes */
+    husbh->Inst->GRXFSIZ = Config->RxFifoSize;
+    husbh->Inst->DIEPTXF0_HNPTXFSIZ.w = ((uint32_t)Config->NPTxFifoSize << 16) | Config->RxFifoSize;
+    husbh->Inst->HPTXFSIZ.w = ((uint32_t)Config->PTxFifoSize << 16)
+                            | (Config->RxFifoSize + Config->NPTxFifoSize);
+
+    /* Flush the FIFOs */
+    usbh_flushTxFifo(husbh->Inst);
+    usbh_flushRxFifo(husbh->Inst);
+
+    /* Clear all pending channel interrupts */
+    for (i = 0; i < USBH_CHANNEL_COUNT(husbh); i++)
+    {
+        husbh->Inst->HC[i].HCINT.w    = ~0;
+        husbh->Inst->HC[i].HCINTMSK.w = 0;
+        husbh->Channel[i].Status      = USBH_CH_IDLE;
+        husbh->Channel[i].State       = USBH_URB_IDLE;
+        husbh->Channel[i].Pending     = 0;
+    }
+    husbh->Inst->HAINT    = ~0;
+    husbh->Inst->HAINTMSK = 0;
+    husbh->Allocated      = 0;
+    husbh->Deferred       = 0;
+    husbh->SOF            = (Config->SOF == ENABLE) ? TRUE : FALSE;
+    husbh->Speed          = USBH_SPEED_FULL;
+
+    /* Clear any pending interrupts */
+    husbh->Inst->GINTSTS.w = 0xBFFFFFFF;
+
+    /* Enable interrupts matching to the Host mode ONLY */
+    gintmsk = USB_OTG_GINTMSK_RXFLVLM | USB_OTG_GINTMSK_PRTIM |
+              USB_OTG_GINTMSK_HCIM    | USB_OTG_GINTMSK_DISCINT;
+    if (Config->SOF == ENABLE)
+    {
+        gintmsk |= USB_OTG_GINTMSK_SOFM;
+    }
+
+    /* Initialize dependencies (pins, IRQ lines, VBUS switch) */
+    XPD_SAFE_CALLBACK(husbh->Callbacks.DepInit, husbh);
+
+    /* Apply interrupts selection */
+    husbh->Inst->GINTMSK.w = gintmsk;
+
+    return XPD_OK;
+}
+
+/**
+ * @brief Restores the USB peripheral to its default inactive state.
+ * @param husbh: pointer to the USB Host handle structure
+ * @return OK
+ */
+XPD_ReturnType XPD_USBH_Deinit(USBH_HandleType * husbh)
+{
+    XPD_USBH_Stop(husbh);
+
+    /* Deinitialize dependencies */
+    XPD_SAFE_CALLBACK(husbh->Callbacks.DepDeinit, husbh);
+
+    /* Disable peripheral clock */
+#ifdef USB_OTG_HS
+    if (((uint32_t)husbh->Inst) == ((uint32_t)USB_OTG_HS))
+    {
+        XPD_OTG_HS_ClockCtrl(DISABLE);
+    }
+    else
+#endif
+    {
+        XPD_OTG_FS_ClockCtrl(DISABLE);
+    }
+
+    return XPD_OK;
+}
+
+/**
+ * @brief Powers the host port and starts the host operation.
+ * @param husbh: pointer to the USB Host handle structure
+ */
+void XPD_USBH_Start(USBH_HandleType * husbh)
+{
+    husbh->Inst->HPRT.w = usbh_getPort(husbh) | USB_OTG_HPRT_PPWR;
+
+    /* Enable global interrupts */
+    husbh->Inst->GAHBCFG.b.GINT = 1;
+}
+
+/**
+ * @brief Halts all channels and removes the host port power.
+ * @param husbh: pointer to the USB Host handle structure
+ */
+void XPD_USBH_Stop(USBH_HandleType * husbh)
+{
+    uint32_t i;
+
+    /* Disable global interrupts */
+    husbh->Inst->GAHBCFG.b.GINT = 0;
+
+    for (i = 0; i < USBH_CHANNEL_COUNT(husbh); i++)
+    {
+        XPD_USBH_Channel_Close(husbh, i);
+        husbh->Inst->HC[i].HCINT.w = ~0;
+    }
+    husbh->Inst->HAINT = ~0;
+
+    usbh_flushTxFifo(husbh->Inst);
+    usbh_flushRxFifo(husbh->Inst);
+
+    husbh->Inst->HPRT.w = usbh_getPort(husbh) & ~USB_OTG_HPRT_PPWR;
+
+    /* Clear any pending interrupts */
+    husbh->Inst->GINTSTS.w = 0xBFFFFFFF;
+}
+
+/**
+ * @brief Drives USB reset on the port, which leads to port enable with the device speed detection.
+ * @note  This function blocks for about 25 ms.
+ * @param husbh: pointer to the USB Host handle structure
+ */
+void XPD_USBH_PortReset(USBH_HandleType * husbh)
+{
+    uint32_t hprt = usbh_getPort(husbh);
+
+    husbh->Inst->HPRT.w = hprt | USB_OTG_HPRT_PRST;
+    XPD_Delay_ms(15);
+
+    husbh->Inst->HPRT.w = hprt & ~USB_OTG_HPRT_PRST;
+
+    /* Reset recovery time of the device */
+    XPD_Delay_ms(10);
+}
+
+/**
+ * @brief Allocates a free host channel.
+ * @param husbh: pointer to the USB Host handle structure
+ * @return The allocated channel number, or @ref USBH_NO_CHANNEL if none is free
+ */
+uint8_t XPD_USBH_Channel_Alloc(USBH_HandleType * husbh)
+{
+    uint8_t i;
+
+    for (i = 0; i < USBH_CHANNEL_COUNT(husbh); i++)
+    {
+        if ((husbh->Allocated & (1 << i)) == 0)
+        {
+            husbh->Allocated |= 1 << i;
+            return i;
+        }
+    }
+    return USBH_NO_CHANNEL;
+}
+
+/**
+ * @brief Closes and releases an allocated host channel.
+ * @param husbh: pointer to the USB Host handle structure
+ * @param Channel: the host channel number
+ */
+void XPD_USBH_Channel_Free(USBH_HandleType * husbh, uint8_t Channel)
+{
+    XPD_USBH_Channel_Close(husbh, Channel);
+
+    husbh->Allocated &= ~(1 << Channel);
+}
+
+/**
+ * @brief Assigns a device endpoint to the host channel.
+ * @note  The data toggle is reset to DATA0.
+ * @param husbh: pointer to the USB Host handle structure
+ * @param Channel: the host channel number
+ * @param DevAddress: the USB address of the device
+ * @param EpAddress: endpoint address (the direction is set by bit 7)
+ * @param Type: endpoint type
+ * @param MaxPacketSize: endpoint max packet size
+ */
+void XPD_USBH_Channel_Open(USBH_HandleType * husbh, uint8_t Channel,
+        uint8_t DevAddress, uint8_t EpAddress, USB_EndPointType Type, uint16_t MaxPacketSize)
+{
+    USBH_ChannelHandleType * ch = &husbh->Channel[Channel];
+    USB_OTG_HostChannelTypeDef * hc = &husbh->Inst->HC[Channel];
+    uint32_t hcchar;
+
+    ch->EpAddress     = EpAddress;
+    ch->Type          = Type;
+    ch->MaxPacketSize = MaxPacketSize;
+    ch->Toggle        = USBH_PID_DATA0;
+    ch->Status        = USBH_CH_IDLE;
+    ch->State         = USBH_URB_IDLE;
+    ch->ErrorCount    = 0;
+    ch->NakCount      = 0;
+    ch->Pending       = 0;
+
+    hc->HCINT.w    = ~0;
+    hc->HCINTMSK.w = USB_OTG_HCINTMSK_XFRCM  | USB_OTG_HCINTMSK_CHHM   |
+                     USB_OTG_HCINTMSK_STALLM | USB_OTG_HCINTMSK_NAKM   |
+                     USB_OTG_HCINTMSK_TXERRM | USB_OTG_HCINTMSK_BBERRM |
+                     USB_OTG_HCINTMSK_FRMORM | USB_OTG_HCINTMSK_DTERRM |
+                     USB_OTG_HCINTMSK_AHBERR;
+
+    hcchar = ((uint32_t)MaxPacketSize << USB_OTG_HCCHAR_MPSIZ_Pos)
+           | ((uint32_t)(EpAddress & 0xF) << USB_OTG_HCCHAR_EPNUM_Pos)
+           | ((uint32_t)Type << USB_OTG_HCCHAR_EPTYP_Pos)
+           | ((uint32_t)DevAddress << USB_OTG_HCCHAR_DAD_Pos)
+           | USB_OTG_HCCHAR_MC_0;
+    if (CH_IS_IN(ch))
+    {
+        hcchar |= USB_OTG_HCCHAR_EPDIR;
+    }
+    if (husbh->Speed == USBH_SPEED_LOW)
+    {
+        hcchar |= USB_OTG_HCCHAR_LSDEV;
+    }
+    hc->HCCHAR.w = hcchar;
+
+    husbh->Inst->HAINTMSK |= 1 << Channel;
+}
+
+/**
+ * @brief Aborts the ongoing transfer and disables the host channel.
+ * @param husbh: pointer to the USB Host handle structure
+ * @param Channel: the host channel number
+ */
+void XPD_USBH_Channel_Close(USBH_HandleType * husbh, uint8_t Channel)
+{
+    USB_OTG_HostChannelTypeDef * hc = &husbh->Inst->HC[Channel];
+
+    husbh->Inst->HAINTMSK &= ~(1 << Channel);
+    husbh->Deferred &= ~(1 << Channel);
+    hc->HCINTMSK.w = 0;
+
+    if (hc->HCCHAR.b.CHENA != 0)
+    {
+        hc->HCCHAR.w |= USB_OTG_HCCHAR_CHDIS | USB_OTG_HCCHAR_CHENA;
+    }
+
+    husbh->Channel[Channel].Status  = USBH_CH_IDLE;
+    husbh->Channel[Channel].Pending = 0;
+}
+
+/**
+ * @brief Submits a transfer to the host channel. The transfer is carried out in multi-packet
+ *        core transfers, and its result is reported by the Transfer callback.
+ * @param husbh: pointer to the USB Host handle structure
+ * @param Channel: the host channel number
+ * @param Setup: the data is a SETUP packet (only for control OUT channels)
+ * @param Data: pointer to the transfer buffer
+ * @param Length: the transfer length
+ * @return BUSY if the channel has an ongoing transfer, OK if submitted
+ */
+XPD_ReturnType XPD_USBH_Channel_Submit(USBH_HandleType * husbh, uint8_t Channel,
+        boolean_t Setup, uint8_t * Data, uint32_t Length)
+{
+    USBH_ChannelHandleType * ch = &husbh->Channel[Channel];
+
+    if (ch->Status != USBH_CH_IDLE)
+    {
+        return XPD_BUSY;
+    }
+
+    ch->Data   = Data;
+    ch->Length = Length;
+    ch->Count  = 0;
+    ch->State  = USBH_URB_IDLE;
+
+    usbh_channelStart(husbh, Channel, (Setup != FALSE) ? USBH_PID_SETUP : ch->Toggle);
+
+    return XPD_OK;
+}
+
+/**
+ * @brief Sets the data toggle of the next transaction on the host channel.
+ * @param husbh: pointer to the USB Host handle structure
+ * @param Channel: the host channel number
+ * @param Toggle: 0 for DATA0, 1 for DATA1
+ */
+void XPD_USBH_Channel_SetToggle(USBH_HandleType * husbh, uint8_t Channel, uint8_t Toggle)
+{
+    husbh->Channel[Channel].Toggle = (Toggle != 0) ? USBH_PID_DATA1 : USBH_PID_DATA0;
+}
+
+/**
+ * @brief Aborts the ongoing transfer of the host channel. The channel remains open,
+ *        with the data toggle following the last acknowledged transaction.
+ * @note  The aborted transfer is concluded with ERROR state, without Transfer callback.
+ *        This function blocks until the channel is halted (at most 2 ms),
+ *        it shall not be called from a context which preempts the USB interrupt.
+ * @param husbh: pointer to the USB Host handle structure
+ * @param Channel: the host channel number
+ */
+void XPD_USBH_Channel_Abort(USBH_HandleType * husbh, uint8_t Channel)
+{
+    USBH_ChannelHandleType * ch = &husbh->Channel[Channel];
+    USB_OTG_HostChannelTypeDef * hc = &husbh->Inst->HC[Channel];
+    uint32_t primask = __get_PRIMASK();
+    uint32_t timeout = 2;
+
+    /* The channel events are held back until the halt is complete */
+    __disable_irq();
+    husbh->Inst->HAINTMSK &= ~(1 << Channel);
+    husbh->Deferred &= ~(1 << Channel);
+    __set_PRIMASK(primask);
+
+    if (hc->HCCHAR.b.CHENA != 0)
+    {
+        hc->HCCHAR.w |= USB_OTG_HCCHAR_CHDIS | USB_OTG_HCCHAR_CHENA;
+
+        (void) XPD_WaitForMatch(&hc->HCINT.w, USB_OTG_HCINT_CHH, USB_OTG_HCINT_CHH, &timeout);
+    }
+    hc->HCINT.w = ~0;
+
+    ch->Toggle  = (hc->HCTSIZ.w & USB_OTG_HCTSIZ_DPID) >> USB_OTG_HCTSIZ_DPID_Pos;
+    ch->Status  = USBH_CH_IDLE;
+    ch->Pending = 0;
+    if (ch->State == USBH_URB_IDLE)
+    {
+        ch->State = USBH_URB_ERROR;
+    }
+
+    husbh->Inst->HAINTMSK |= 1 << Channel;
+}
+
+/**
+ * @brief USB host interrupt handler that provides event-driven channel and port management
+ *        and handle callbacks.
+ * @param husbh: pointer to the USB Host handle structure
+ */
+void XPD_USBH_IRQHandler(USBH_HandleType * husbh)
+{
+    uint32_t gints = husbh->Inst->GINTSTS.w & husbh->Inst->GINTMSK.w;
+
+    XPD_PROFILE_BEGIN();
+
+    if ((gints & USB_OTG_GINTSTS_SOF) != 0)
+    {
+        XPD_USB_ClearFlag(husbh, SOF);
+
+        usbh_sofEvent(husbh);
+
+        if (husbh->SOF != FALSE)
+        {
+            XPD_SAFE_CALLBACK(husbh->Callbacks.SOF, husbh);
+        }
+    }
+
+    /* Received packets are popped before the channel events */
+    if ((gints & USB_OTG_GINTSTS_RXFLVL) != 0)
+    {
+        usbh_rxFifoEvent(husbh);
+    }
+
+    if ((gints & USB_OTG_GINTSTS_NPTXFE) != 0)
+    {
+        usbh_txFifoEvent(husbh, FALSE);
+    }
+
+    if ((gints & USB_OTG_GINTSTS_PTXFE) != 0)
+    {
+        usbh_txFifoEvent(husbh, TRUE);
+    }
+
+    if ((gints & USB_OTG_GINTSTS_HCINT) != 0)
+    {
+        uint32_t haint = husbh->Inst->HAINT & husbh->Inst->HAINTMSK;
+        uint8_t Channel;
+
+        for (Channel = 0; haint != 0; Channel++, haint >>= 1)
+        {
+            if ((haint & 1) != 0)
+            {
+                usbh_channelEvent(husbh, Channel);
+            }
+        }
+    }
+
+    /* The port interrupt is cleared through the port register */
+    if ((gints & USB_OTG_GINTSTS_HPRTINT) != 0)
+    {
+        usbh_portEvent(husbh);
+    }
+
+    if ((gints & USB_OTG_GINTSTS_DISCINT) != 0)
+    {
+        XPD_USB_ClearFlag(husbh, DISCINT);
+
+        usbh_disconnectEvent(husbh);
+    }
+
+    XPD_PROFILE_END();
+}
+
+/** @} */
+
+/** @} */
+
+#endif /* USE_XPD_USBH */
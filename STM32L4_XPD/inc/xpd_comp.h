@@ -0,0 +1,158 @@
+/**
+  ******************************************************************************
+  * @file    xpd_comp.h
+  * @author  Benedek Kupper
+  * @version V0.1
+  * @date    2018-01-20
+  * @brief   STM32 eXtensible Peripheral Drivers COMP Module
+  *
+  *  This file is part of STM32_XPD.
+  *
+  *  STM32_XPD is free software: you can redistribute it and/or modify
+  *  it under the terms of the GNU General Public License as published by
+  *  the Free Software Foundation, either version 3 of the License, or
+  *  (at your option) any later version.
+  *
+  *  STM32_XPD is distributed in the hope that it will be useful,
+  *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with STM32_XPD.  If not, see <http://www.gnu.org/licenses/>.
+  */
+#ifndef __XPD_COMP_H_
+#define __XPD_COMP_H_
+
+#include "xpd_common.h"
+#include "xpd_config.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/** @defgroup COMP
+ *  @brief    Analog comparators with direct timer break and OCREF_CLR routing
+ *  @details  The comparator output reaches the timer inputs without software intervention,
+ *            so it can limit the current of a PWM output cycle-by-cycle:
+ *  @code
+    const COMP_InitType overcurrent = {
+        .InputMinus = COMP_INPUTMINUS_DAC1_CH1,
+        .Polarity   = ACTIVE_HIGH,
+        .Hysteresis = COMP_HYSTERESIS_LOW,
+        .PowerMode  = COMP_POWER_HIGHSPEED,
+    };
+    const TIM_Output_BreakInitType brk = { .State = ENABLE, .Polarity = ACTIVE_HIGH };
+
+    XPD_COMP_Init(COMP1, &overcurrent);
+    XPD_COMP_BreakConfig(COMP1, TIM1, 2, ENABLE);
+    XPD_COMP_Enable(COMP1);
+    XPD_TIM_Output_BreakConfig(&htim1, 2, &brk);
+ *  @endcode
+ * @{ */
+
+/** @defgroup COMP_Exported_Types COMP Exported Types
+ * @{ */
+
+/** @brief COMP inverting input selection */
+typedef enum
+{
+    COMP_INPUTMINUS_VREFINT_1_4 = 0, /*!< 1/4 of the internal reference voltage */
+    COMP_INPUTMINUS_VREFINT_1_2 = 1, /*!< 1/2 of the internal reference voltage */
+    COMP_INPUTMINUS_VREFINT_3_4 = 2, /*!< 3/4 of the internal reference voltage */
+    COMP_INPUTMINUS_VREFINT     = 3, /*!< The internal reference voltage */
+    COMP_INPUTMINUS_DAC1_CH1    = 4, /*!< DAC1 channel 1 output */
+    COMP_INPUTMINUS_DAC1_CH2    = 5, /*!< DAC1 channel 2 output */
+    COMP_INPUTMINUS_IO1         = 6, /*!< First I/O pin of the comparator */
+    COMP_INPUTMINUS_IO2         = 7, /*!< Second I/O pin of the comparator */
+}COMP_InputMinusType;
+
+/** @brief COMP hysteresis levels */
+typedef enum
+{
+    COMP_HYSTERESIS_NONE   = 0, /*!< No hysteresis */
+    COMP_HYSTERESIS_LOW    = 1, /*!< Low hysteresis */
+    COMP_HYSTERESIS_MEDIUM = 2, /*!< Medium hysteresis */
+    COMP_HYSTERESIS_HIGH   = 3, /*!< High hysteresis */
+}COMP_HysteresisType;
+
+/** @brief COMP power modes */
+typedef enum
+{
+    COMP_POWER_HIGHSPEED   = 0, /*!< High speed, full power */
+    COMP_POWER_MEDIUMSPEED = 1, /*!< Medium speed, medium power */
+    COMP_POWER_ULTRALOW    = 3, /*!< Ultra low power */
+}COMP_PowerModeType;
+
+/** @brief COMP setup structure */
+typedef struct
+{
+    COMP_InputMinusType InputMinus;     /*!< Inverting input selection */
+    uint8_t             InputPlus;      /*!< Non-inverting input I/O pin selection [0..1] */
+    ActiveLevelType     Polarity;       /*!< Output polarity, high level output means higher non-inverting input
+                                             when ACTIVE_HIGH */
+    uint8_t             Blanking;       /*!< The comparator specific timer output compare blanking source,
+                                             0 for no blanking */
+    COMP_HysteresisType Hysteresis;     /*!< Input hysteresis */
+    COMP_PowerModeType  PowerMode;      /*!< Power and speed mode */
+}COMP_InitType;
+
+/** @} */
+
+/** @addtogroup COMP_Exported_Functions
+ * @{ */
+void            XPD_COMP_Init           (COMP_TypeDef * COMPx, const COMP_InitType * Config);
+void            XPD_COMP_Deinit         (COMP_TypeDef * COMPx);
+
+void            XPD_COMP_BreakConfig    (COMP_TypeDef * COMPx, TIM_TypeDef * TIMx, uint8_t BreakLine,
+                                         FunctionalState NewState);
+void            XPD_COMP_ETRConfig      (COMP_TypeDef * COMPx, TIM_TypeDef * TIMx);
+
+/**
+ * @brief Enables the comparator.
+ * @param COMPx: the comparator peripheral
+ */
+__STATIC_INLINE void XPD_COMP_Enable(COMP_TypeDef * COMPx)
+{
+    COMPx->CSR.b.EN = 1;
+}
+
+/**
+ * @brief Disables the comparator.
+ * @param COMPx: the comparator peripheral
+ */
+__STATIC_INLINE void XPD_COMP_Disable(COMP_TypeDef * COMPx)
+{
+    COMPx->CSR.b.EN = 0;
+}
+
+/**
+ * @brief Returns the output level of the comparator.
+ * @param COMPx: the comparator peripheral
+ * @return The output level after the polarity selection
+ */
+__STATIC_INLINE uint8_t XPD_COMP_GetOutput(COMP_TypeDef * COMPx)
+{
+    return COMPx->CSR.b.VALUE;
+}
+
+/**
+ * @brief Makes the comparator configuration read-only until the next system reset,
+ *        so the protection can't be disabled by faulty software.
+ * @param COMPx: the comparator peripheral
+ */
+__STATIC_INLINE void XPD_COMP_Lock(COMP_TypeDef * COMPx)
+{
+    COMPx->CSR.b.LOCK = 1;
+}
+
+/** @} */
+
+/** @} */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __XPD_COMP_H_ */
@@ -27,6 +27,11 @@
 #include "xpd_common.h"
 #include "xpd_config.h"
 
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
 /** @defgroup EXTI
  * @{ */
 
@@ -36,7 +41,8 @@
 /** @brief EXTI setup structure */
 typedef struct
 {
-    XPD_ValueCallbackType ITCallback; /*!< Callback for the interrupt line, the passed parameter is the line number */
+    XPD_ValueCallbackType ITCallback; /*!< Callback for the interrupt line (or for the event line, called by
+                                           @ref XPD_WaitForEvents), the passed parameter is the line number */
     EdgeType              Edge;       /*!< The selected edges trigger a reaction */
     ReactionType          Reaction;   /*!< Type of generated reaction for the detected edge */
 }EXTI_InitType;
@@ -56,6 +62,8 @@ extern XPD_ValueCallbackType XPD_EXTI_Callbacks[];
 void            XPD_EXTI_Init           (uint8_t Line, const EXTI_InitType * Config);
 void            XPD_EXTI_Deinit         (uint8_t Line);
 
+void            XPD_EXTI_IRQHandler     (uint8_t FirstLine, uint8_t LastLine);
+
 /**
  * @brief Gets the pending flag for the line.
  * @param Line: the selected EXTI line
@@ -65,14 +73,14 @@ __STATIC_INLINE FlagStatus XPD_EXTI_GetFlag(uint8_t Line)
 {
 #ifdef EXTI_BB
     if (Line < 32)
-        return EXTI_BB->PR1[Line];
+        return (FlagStatus)EXTI_BB->PR1[Line];
     else
-        return EXTI_BB->PR2[Line - 32];
+        return (FlagStatus)EXTI_BB->PR2[Line - 32];
 #else
     if (Line < 32)
-        return (EXTI->PR1 >> (uint32_t)Line) & 1;
+        return (FlagStatus)((EXTI->PR1 >> (uint32_t)Line) & 1);
     else
-        return (EXTI->PR2 >> ((uint32_t)Line - 32)) & 1;
+        return (FlagStatus)((EXTI->PR2 >> ((uint32_t)Line - 32)) & 1);
 #endif
 }
 
@@ -95,6 +103,44 @@ __STATIC_INLINE void XPD_EXTI_ClearFlag(uint8_t Line)
 #endif
 }
 
+/**
+ * @brief Enables the interrupt generation of the line.
+ * @param Line: the selected EXTI line
+ */
+__STATIC_INLINE void XPD_EXTI_EnableIT(uint8_t Line)
+{
+#ifdef EXTI_BB
+    if (Line < 32)
+        EXTI_BB->IMR1[Line] = 1;
+    else
+        EXTI_BB->IMR2[Line - 32] = 1;
+#else
+    if (Line < 32)
+        SET_BIT(EXTI->IMR1, 1 << (uint32_t)Line);
+    else
+        SET_BIT(EXTI->IMR2, 1 << ((uint32_t)Line - 32));
+#endif
+}
+
+/**
+ * @brief Disables the interrupt generation of the line.
+ * @param Line: the selected EXTI line
+ */
+__STATIC_INLINE void XPD_EXTI_DisableIT(uint8_t Line)
+{
+#ifdef EXTI_BB
+    if (Line < 32)
+        EXTI_BB->IMR1[Line] = 0;
+    else
+        EXTI_BB->IMR2[Line - 32] = 0;
+#else
+    if (Line < 32)
+        CLEAR_BIT(EXTI->IMR1, 1 << (uint32_t)Line);
+    else
+        CLEAR_BIT(EXTI->IMR2, 1 << ((uint32_t)Line - 32));
+#endif
+}
+
 /**
  * @brief Generates a software triggered interrupt.
  * @param Line: the selected EXTI line to trigger
@@ -114,22 +160,12 @@ __STATIC_INLINE void XPD_EXTI_GenerateIT(uint8_t Line)
 #endif
 }
 
-/**
- * @brief EXTI interrupt handler.
- * @param Line: an interrupt line which may be responsible for the interrupt generation.
- */
-__STATIC_INLINE void XPD_EXTI_IRQHandler(uint8_t Line)
-{
-    if (XPD_EXTI_GetFlag(Line))
-    {
-        XPD_EXTI_ClearFlag(Line);
-
-        XPD_SAFE_CALLBACK(XPD_EXTI_Callbacks[Line], Line);
-    }
-}
-
 /** @} */
 
 /** @} */
 
+#ifdef __cplusplus
+}
+#endif
+
 #endif /* __XPD_EXTI_H_ */
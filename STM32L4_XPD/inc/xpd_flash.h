@@ -26,18 +26,183 @@
 
 #include "xpd_common.h"
 #include "xpd_config.h"
+#include "xpd_os.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
 
 /** @defgroup FLASH
  * @{ */
 
+/** @defgroup FLASH_Exported_Types FLASH Exported Types
+ * @{ */
+
+/** @brief FLASH operation types */
+typedef enum
+{
+  FLASH_OPERATION_NONE        = 0,              /*!< FLASH idle */
+  FLASH_OPERATION_ERASE_BLOCK = FLASH_CR_PER,   /*!< FLASH page erase operation */
+  FLASH_OPERATION_ERASE_BANK  = FLASH_CR_MER1,  /*!< FLASH bank mass erase operation */
+  FLASH_OPERATION_PROGRAM     = FLASH_CR_PG,    /*!< FLASH write program operation */
+  FLASH_OPERATION_FAST        = FLASH_CR_FSTPG, /*!< FLASH fast row program operation */
+}FLASH_OperationType;
+
+/** @brief FLASH error types */
+typedef enum
+{
+    FLASH_ERROR_NONE      = 0,                /*!< No errors */
+    FLASH_ERROR_OPERATION = FLASH_SR_OPERR,   /*!< Operation error */
+    FLASH_ERROR_PROGRAM   = FLASH_SR_PROGERR, /*!< Programming error */
+    FLASH_ERROR_WRITEPROT = FLASH_SR_WRPERR,  /*!< Write protection error */
+    FLASH_ERROR_ALIGNMENT = FLASH_SR_PGAERR,  /*!< Programming alignment error */
+    FLASH_ERROR_SIZE      = FLASH_SR_SIZERR,  /*!< Size error */
+    FLASH_ERROR_SEQUENCE  = FLASH_SR_PGSERR,  /*!< Programming sequence error */
+    FLASH_ERROR_MISS      = FLASH_SR_MISERR,  /*!< Fast programming data miss error */
+    FLASH_ERROR_FAST      = FLASH_SR_FASTERR, /*!< Fast programming error */
+}FLASH_ErrorType;
+
+/** @brief FLASH callbacks container structure */
+typedef struct {
+    XPD_SimpleCallbackType EraseComplete;   /*!< Erase operation complete callback */
+    XPD_SimpleCallbackType ProgramComplete; /*!< Program operation complete callback */
+    XPD_SimpleCallbackType Error;           /*!< Operation error callback */
+}XPD_FLASH_CallbacksType;
+
+/** @} */
+
+/** @defgroup FLASH_Exported_Variables FLASH Exported Variables
+ * @{ */
+
+/** @brief FLASH callbacks container struct */
+extern XPD_FLASH_CallbacksType XPD_FLASH_Callbacks;
+
+/** @} */
+
+/** @defgroup FLASH_Exported_Macros FLASH Exported Macros
+ * @{ */
+
+/** @brief Flash latency value for automatic selection of the minimal wait states */
+#define             FLASH_LATENCY_AUTO      0xFF
+
+#ifdef FLASH_CR_MER2
+/** @brief Size of a single flash bank of dual bank devices */
+#define             FLASH_BANK_SIZE         ((uint32_t)DEVICE_FLASH_SIZE_KB << 9)
+
+/** @brief Address of the inactive flash bank, as the active bank is always mapped to the flash base */
+#define             FLASH_INACTIVE_BANK_ADDRESS ((void *)(FLASH_BASE + FLASH_BANK_SIZE))
+#endif
+
 #ifdef FLASH_BB
-#define FLASH_REG_BIT(REG_NAME, BIT_NAME) (FLASH_BB->REG_NAME.BIT_NAME)
+/**
+ * @brief FLASH register bit accessing macro
+ * @param REG: specifies the register name.
+ * @param BIT: specifies the register bit name.
+ */
+#define             FLASH_REG_BIT(REG_NAME, BIT_NAME)   \
+    (FLASH_BB->REG_NAME.BIT_NAME)
 #else
-#define FLASH_REG_BIT(REG_NAME, BIT_NAME) (FLASH->REG_NAME.b.BIT_NAME)
+/**
+ * @brief FLASH register bit accessing macro
+ * @param REG: specifies the register name.
+ * @param BIT: specifies the register bit name.
+ */
+#define             FLASH_REG_BIT(REG_NAME, BIT_NAME)   \
+    (FLASH->REG_NAME.b.BIT_NAME)
 #endif
 
+/**
+ * @brief  Enable the specified FLASH interrupt.
+ * @param  IT_NAME: specifies the interrupt to enable.
+ *         This parameter can be one of the following values:
+ *            @arg ERR:         Error occurrence
+ *            @arg EOP:         End of Operation
+ *            @arg RDERR:       PCROP read error
+ */
+#define             XPD_FLASH_EnableIT(IT_NAME)         \
+    (FLASH_REG_BIT(CR,IT_NAME##IE) = 1)
+
+/**
+ * @brief  Disable the specified FLASH interrupt.
+ * @param  IT_NAME: specifies the interrupt to disable.
+ *         This parameter can be one of the following values:
+ *            @arg ERR:         Error occurrence
+ *            @arg EOP:         End of Operation
+ *            @arg RDERR:       PCROP read error
+ */
+#define             XPD_FLASH_DisableIT(IT_NAME)        \
+    (FLASH_REG_BIT(CR,IT_NAME##IE) = 0)
+
+/**
+ * @brief  Get the specified FLASH flag.
+ * @param  FLAG_NAME: specifies the flag to return.
+ *         This parameter can be one of the following values:
+ *            @arg BSY:         Busy flag
+ *            @arg EOP:         End of Operation flag
+ *            @arg OPERR:       Operation error flag
+ *            @arg PROGERR:     Programming error flag
+ *            @arg WRPERR:      Write protected error flag
+ *            @arg PGAERR:      Programming alignment error flag
+ *            @arg SIZERR:      Size error flag
+ *            @arg PGSERR:      Programming sequence error flag
+ *            @arg MISERR:      Fast programming data miss error flag
+ *            @arg FASTERR:     Fast programming error flag
+ */
+#define         XPD_FLASH_GetFlag(FLAG_NAME)            \
+    (FLASH_REG_BIT(SR,FLAG_NAME))
+
+/**
+ * @brief  Clear the specified FLASH flag.
+ * @param  FLAG_NAME: specifies the flag to clear.
+ *         This parameter can be one of the following values:
+ *            @arg EOP:         End of Operation flag
+ *            @arg OPERR:       Operation error flag
+ *            @arg PROGERR:     Programming error flag
+ *            @arg WRPERR:      Write protected error flag
+ *            @arg PGAERR:      Programming alignment error flag
+ *            @arg SIZERR:      Size error flag
+ *            @arg PGSERR:      Programming sequence error flag
+ *            @arg MISERR:      Fast programming data miss error flag
+ *            @arg FASTERR:     Fast programming error flag
+ */
+#define         XPD_FLASH_ClearFlag(FLAG_NAME)          \
+    (FLASH->SR.w = FLASH_SR_##FLAG_NAME)
+
+/** @} */
+
 /** @defgroup FLASH_Exported_Functions FLASH Exported Functions
  * @{ */
+void            XPD_FLASH_Unlock            (void);
+void            XPD_FLASH_Lock              (void);
+
+XPD_ReturnType  XPD_FLASH_Program           (void * Address, const void * Data, uint16_t Length);
+XPD_ReturnType  XPD_FLASH_Program_IT        (void * Address, const void * Data, uint16_t Length);
+XPD_ReturnType  XPD_FLASH_ProgramFast       (void * Address, const void * Data, uint16_t Length);
+
+XPD_ReturnType  XPD_FLASH_EraseBank         (uint8_t Bank);
+XPD_ReturnType  XPD_FLASH_EraseBank_IT      (uint8_t Bank);
+XPD_ReturnType  XPD_FLASH_Erase             (void * Address, uint16_t kBytes);
+XPD_ReturnType  XPD_FLASH_Erase_IT          (void * Address, uint16_t kBytes);
+#ifdef USE_XPD_OS
+XPD_ReturnType  XPD_FLASH_Program_Blocking  (void * Address, const void * Data, uint16_t Length,
+                                             uint32_t Timeout);
+XPD_ReturnType  XPD_FLASH_Erase_Blocking    (void * Address, uint16_t kBytes, uint32_t Timeout);
+#endif
+
+XPD_ReturnType  XPD_FLASH_PollStatus        (uint32_t Timeout);
+FLASH_ErrorType XPD_FLASH_GetError          (void);
+
+uint8_t         XPD_FLASH_GetMinLatency     (uint32_t HCLK_Frequency);
+void            XPD_FLASH_ResetCaches       (void);
+void            XPD_FLASH_AcceleratorCtrl   (FunctionalState NewState);
+
+void            XPD_FLASH_IRQHandler        (void);
+
+#ifdef FLASH_OPTR_BFB2
+uint8_t         XPD_FLASH_GetActiveBank     (void);
+XPD_ReturnType  XPD_FLASH_BankSwap          (void);
+#endif
 
 /**
  * @brief Sets the flash memory access latency (in clock cycles).
@@ -94,4 +259,8 @@ __STATIC_INLINE void XPD_FLASH_DataCacheCtrl(FunctionalState NewState)
 
 /** @} */
 
+#ifdef __cplusplus
+}
+#endif
+
 #endif /* __XPD_FLASH_H_ */
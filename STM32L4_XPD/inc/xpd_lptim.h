@@ -0,0 +1,146 @@
+/**
+  ******************************************************************************
+  * @file    xpd_lptim.h
+  * @author  Benedek Kupper
+  * @version V0.1
+  * @date    2018-01-20
+  * @brief   STM32 eXtensible Peripheral Drivers LPTIM Module
+  *
+  *  This file is part of STM32_XPD.
+  *
+  *  STM32_XPD is free software: you can redistribute it and/or modify
+  *  it under the terms of the GNU General Public License as published by
+  *  the Free Software Foundation, either version 3 of the License, or
+  *  (at your option) any later version.
+  *
+  *  STM32_XPD is distributed in the hope that it will be useful,
+  *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with STM32_XPD.  If not, see <http://www.gnu.org/licenses/>.
+  */
+#ifndef __XPD_LPTIM_H_
+#define __XPD_LPTIM_H_
+
+#include "xpd_common.h"
+#include "xpd_config.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/** @defgroup LPTIM
+ * @{ */
+
+/** @defgroup LPTIM_Exported_Types LPTIM Exported Types
+ * @{ */
+
+/** @brief LPTIM counter sources */
+typedef enum
+{
+    LPTIM_COUNT_INTERNAL = 0, /*!< The counter is clocked by the prescaled kernel clock */
+    LPTIM_COUNT_EXTERNAL = 1, /*!< The counter counts the pulses of the Input1 pin
+                                   (the kernel clock is used for filtering only) */
+}LPTIM_CounterSourceType;
+
+/** @brief LPTIM setup structure */
+typedef struct
+{
+    LPTIM_CounterSourceType Source;    /*!< Counter clock source */
+    ClockDividerType        Prescaler; /*!< Counter clock prescaler [CLK_DIV1 .. CLK_DIV128] */
+    struct {
+        EdgeType            Edge;      /*!< The counted edges of the Input1 pin */
+        uint8_t             Filter;    /*!< Digital filter: number of consecutive samples
+                                            of the kernel clock [0: none, 1: 2, 2: 4, 3: 8] */
+    }Input;                            /*   External counting settings */
+}LPTIM_InitType;
+
+/** @brief LPTIM Handle structure */
+typedef struct
+{
+    LPTIM_TypeDef * Inst;                    /*!< The address of the peripheral instance used by the handle */
+    XPD_CtrlFnType ClockCtrl;                /*!< Function pointer for RCC clock control */
+    struct {
+        XPD_HandleCallbackType DepInit;      /*!< Callback to initialize module dependencies (GPIOs, IRQs) */
+        XPD_HandleCallbackType DepDeinit;    /*!< Callback to restore module dependencies (GPIOs, IRQs) */
+        XPD_HandleCallbackType Period;       /*!< The counter reached the period (timeout elapsed) callback */
+        XPD_HandleCallbackType Compare;      /*!< The counter reached the compare value callback */
+    }Callbacks;                              /*   Handle Callbacks */
+}LPTIM_HandleType;
+
+/** @} */
+
+/** @defgroup LPTIM_Exported_Macros LPTIM Exported Macros
+ * @{ */
+
+/**
+ * @brief  LPTIM Handle initializer macro
+ * @param  INSTANCE: specifies the LPTIM peripheral instance.
+ * @param  INIT_FN: specifies the dependency initialization function to call back.
+ * @param  DEINIT_FN: specifies the dependency deinitialization function to call back.
+ */
+#define         NEW_LPTIM_HANDLE(INSTANCE, INIT_FN, DEINIT_FN)  \
+    {.Inst = (INSTANCE),                                        \
+     .ClockCtrl = XPD_##INSTANCE##_ClockCtrl,                   \
+     .Callbacks.DepInit   = (INIT_FN),                          \
+     .Callbacks.DepDeinit = (DEINIT_FN)}
+
+/**
+ * @brief  Get the specified LPTIM flag.
+ * @param  HANDLE: specifies the LPTIM Handle.
+ * @param  FLAG_NAME: specifies the flag to return.
+ *         This parameter can be one of the following values:
+ *            @arg CMPM:      Compare match
+ *            @arg ARRM:      Autoreload match
+ *            @arg EXTTRIG:   External trigger edge event
+ *            @arg CMPOK:     Compare register update OK
+ *            @arg ARROK:     Autoreload register update OK
+ */
+#define         XPD_LPTIM_GetFlag(HANDLE, FLAG_NAME)            \
+    ((HANDLE)->Inst->ISR.b.FLAG_NAME)
+
+/**
+ * @brief  Clear the specified LPTIM flag.
+ * @param  HANDLE: specifies the LPTIM Handle.
+ * @param  FLAG_NAME: specifies the flag to clear.
+ *         This parameter can be one of the following values:
+ *            @arg CMPM:      Compare match
+ *            @arg ARRM:      Autoreload match
+ *            @arg EXTTRIG:   External trigger edge event
+ *            @arg CMPOK:     Compare register update OK
+ *            @arg ARROK:     Autoreload register update OK
+ */
+#define         XPD_LPTIM_ClearFlag(HANDLE, FLAG_NAME)          \
+    ((HANDLE)->Inst->ICR.w = LPTIM_ICR_##FLAG_NAME##CF)
+
+/** @} */
+
+/** @addtogroup LPTIM_Exported_Functions
+ * @{ */
+XPD_ReturnType  XPD_LPTIM_Init              (LPTIM_HandleType * hlptim, const LPTIM_InitType * Config);
+XPD_ReturnType  XPD_LPTIM_Deinit            (LPTIM_HandleType * hlptim);
+
+XPD_ReturnType  XPD_LPTIM_Timeout_Start     (LPTIM_HandleType * hlptim, uint16_t Period);
+XPD_ReturnType  XPD_LPTIM_Counter_Start     (LPTIM_HandleType * hlptim, uint16_t Period, uint16_t Compare);
+void            XPD_LPTIM_Stop              (LPTIM_HandleType * hlptim);
+
+uint16_t        XPD_LPTIM_GetCounter        (LPTIM_HandleType * hlptim);
+
+void            XPD_LPTIM_IRQHandler        (LPTIM_HandleType * hlptim);
+/** @} */
+
+/** @} */
+
+#define XPD_LPTIM_API
+#include "xpd_rcc_gen.h"
+#include "xpd_rcc_pc.h"
+#undef XPD_LPTIM_API
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __XPD_LPTIM_H_ */
@@ -0,0 +1,55 @@
+/**
+  ******************************************************************************
+  * @file    xpd_mem.h
+  * @author  Benedek Kupper
+  * @version V0.1
+  * @date    2018-01-20
+  * @brief   STM32 eXtensible Peripheral Drivers Memory Operations Module
+  *
+  *  This file is part of STM32_XPD.
+  *
+  *  STM32_XPD is free software: you can redistribute it and/or modify
+  *  it under the terms of the GNU General Public License as published by
+  *  the Free Software Foundation, either version 3 of the License, or
+  *  (at your option) any later version.
+  *
+  *  STM32_XPD is distributed in the hope that it will be useful,
+  *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with STM32_XPD.  If not, see <http://www.gnu.org/licenses/>.
+  */
+#ifndef __XPD_MEM_H_
+#define __XPD_MEM_H_
+
+#include "xpd_common.h"
+#include "xpd_config.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/** @defgroup MEM
+ *  @brief    Memory copy and fill operations of the CPU without library dependency
+ *  @details  The bulk of the data is transferred in 16 byte blocks by multiple load and store
+ *            instructions, once the destination is word aligned. On Cortex-M0 cores this requires
+ *            the same word alignment offset of the source, otherwise the data is copied by bytes.
+ *            The Cortex-M3/M4 cores read the misaligned source by unaligned word accesses.
+ * @{ */
+
+/** @addtogroup MEM_Exported_Functions
+ * @{ */
+void            XPD_MemCopy             (void * Dest, const void * Src, uint32_t Size);
+void            XPD_MemSet              (void * Dest, uint8_t Value, uint32_t Size);
+/** @} */
+
+/** @} */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __XPD_MEM_H_ */
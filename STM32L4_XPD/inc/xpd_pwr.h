@@ -28,6 +28,11 @@
 #include "xpd_config.h"
 #include "xpd_flash.h"
 
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
 /** @defgroup PWR
  * @{ */
 
@@ -44,6 +49,14 @@ typedef enum
     PWR_LOWPOWERREGULATOR = 1, /*!< Low Power regulator ON in Sleep/Stop mode */
 }PWR_RegulatorType;
 
+/** @brief PWR Stop modes */
+typedef enum
+{
+    PWR_STOP0 = 0, /*!< Stop 0 mode: main regulator ON, fastest wakeup */
+    PWR_STOP1 = 1, /*!< Stop 1 mode: low-power regulator ON, all peripherals retained */
+    PWR_STOP2 = 2, /*!< Stop 2 mode: low-power regulator ON, reduced peripheral set, lowest consumption */
+}PWR_StopModeType;
+
 /** @} */
 
 /** @defgroup PWR_Exported_Macros PWR Exported Macros
@@ -86,6 +99,15 @@ typedef enum
 #define         XPD_PWR_ClearFlag(FLAG_NAME)    \
     (PWR_REG_BIT(SCR,C##FLAG_NAME) = 1)
 
+/** @brief RTC wakeup timer EXTI line number */
+#define PWR_RTC_WAKEUP_EXTI_LINE        20
+
+/** @brief RTC alarms EXTI line number */
+#define PWR_RTC_ALARM_EXTI_LINE         18
+
+/** @brief RTC tamper and timestamp EXTI line number */
+#define PWR_RTC_TAMP_STAMP_EXTI_LINE    19
+
 #ifdef PWR_BB
 #define PWR_REG_BIT(_REG_NAME_, _BIT_NAME_) (PWR_BB->_REG_NAME_._BIT_NAME_)
 #else
@@ -115,6 +137,7 @@ typedef enum
 XPD_ReturnType  XPD_PWR_LowPowerRunMode     (FunctionalState NewState);
 void            XPD_PWR_SleepMode           (ReactionType WakeUpOn);
 void            XPD_PWR_StopMode            (ReactionType WakeUpOn, PWR_RegulatorType Regulator);
+void            XPD_PWR_StopModeSelect      (ReactionType WakeUpOn, PWR_StopModeType Mode);
 void            XPD_PWR_StandbyMode         (void);
 void            XPD_PWR_ShutdownMode        (void);
 
@@ -364,7 +387,7 @@ XPD_ReturnType  XPD_PWR_VoltageScaleConfig  (PWR_RegVoltScaleType Scaling);
  */
 __STATIC_INLINE PWR_RegVoltScaleType XPD_PWR_GetVoltageScale(void)
 {
-    return PWR->CR1.b.VOS;
+    return (PWR_RegVoltScaleType)PWR->CR1.b.VOS;
 }
 
 /** @} */
@@ -443,4 +466,8 @@ __STATIC_INLINE void XPD_PWR_PVM_Disable(PWR_PVMType pvm)
 
 /** @} */
 
+#ifdef __cplusplus
+}
+#endif
+
 #endif /* __XPD_PWR_H_ */
@@ -0,0 +1,233 @@
+/**
+  ******************************************************************************
+  * @file    xpd_qspi.h
+  * @author  Benedek Kupper
+  * @version V0.1
+  * @date    2018-01-20
+  * @brief   STM32 eXtensible Peripheral Drivers QSPI Module
+  *
+  *  This file is part of STM32_XPD.
+  *
+  *  STM32_XPD is free software: you can redistribute it and/or modify
+  *  it under the terms of the GNU General Public License as published by
+  *  the Free Software Foundation, either version 3 of the License, or
+  *  (at your option) any later version.
+  *
+  *  STM32_XPD is distributed in the hope that it will be useful,
+  *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with STM32_XPD.  If not, see <http://www.gnu.org/licenses/>.
+  */
+#ifndef __XPD_QSPI_H_
+#define __XPD_QSPI_H_
+
+#include "xpd_common.h"
+#include "xpd_config.h"
+#include "xpd_dma.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/** @defgroup QSPI
+ * @{ */
+
+/** @defgroup QSPI_Exported_Types QSPI Exported Types
+ * @{ */
+
+/** @brief QSPI clock modes */
+typedef enum
+{
+    QSPI_CLOCKMODE_0 = 0, /*!< Clock stays low while nCS is released */
+    QSPI_CLOCKMODE_3 = 1, /*!< Clock stays high while nCS is released */
+}QSPI_ClockModeType;
+
+/** @brief QSPI command phase line counts */
+typedef enum
+{
+    QSPI_LINES_NONE   = 0, /*!< The phase is skipped */
+    QSPI_LINES_SINGLE = 1, /*!< The phase uses a single line */
+    QSPI_LINES_DUAL   = 2, /*!< The phase uses two lines */
+    QSPI_LINES_QUAD   = 3, /*!< The phase uses four lines */
+}QSPI_LinesType;
+
+/** @brief QSPI address and alternate bytes sizes */
+typedef enum
+{
+    QSPI_SIZE_8BIT  = 0, /*!< 8 bit field */
+    QSPI_SIZE_16BIT = 1, /*!< 16 bit field */
+    QSPI_SIZE_24BIT = 2, /*!< 24 bit field */
+    QSPI_SIZE_32BIT = 3, /*!< 32 bit field */
+}QSPI_SizeType;
+
+/** @brief QSPI status polling match modes */
+typedef enum
+{
+    QSPI_MATCH_AND = 0, /*!< Match when all unmasked status bits match */
+    QSPI_MATCH_OR  = 1, /*!< Match when any unmasked status bit matches */
+}QSPI_MatchModeType;
+
+/** @brief QSPI error types */
+typedef enum
+{
+    QSPI_ERROR_NONE     = 0, /*!< No error */
+    QSPI_ERROR_TRANSFER = 1, /*!< Invalid address accessed in indirect mode */
+    QSPI_ERROR_DMA      = 2, /*!< DMA transfer error */
+}QSPI_ErrorType;
+
+/** @brief QSPI setup structure */
+typedef struct
+{
+    uint16_t           ClockPrescaler;      /*!< Kernel (AHB) clock divider [1 .. 256] */
+    uint8_t            FlashSizeLog2;       /*!< The memory size is 2^FlashSizeLog2 bytes [1 .. 32] */
+    uint8_t            ChipSelectHighTime;  /*!< Minimum nCS high time between commands in clock cycles [1 .. 8] */
+    QSPI_ClockModeType ClockMode;           /*!< Clock level while nCS is released */
+    FunctionalState    SampleShift;         /*!< Sampling is shifted by half clock cycle */
+}QSPI_InitType;
+
+/** @brief QSPI command structure */
+typedef struct
+{
+    uint8_t         Instruction;            /*!< The instruction code */
+    QSPI_LinesType  InstructionLines;       /*!< Lines used for the instruction phase */
+    QSPI_LinesType  AddressLines;           /*!< Lines used for the address phase */
+    QSPI_SizeType   AddressSize;            /*!< Size of the address */
+    uint32_t        Address;                /*!< The address (not used in memory-mapped mode) */
+    QSPI_LinesType  AltBytesLines;          /*!< Lines used for the alternate bytes phase */
+    QSPI_SizeType   AltBytesSize;           /*!< Size of the alternate bytes */
+    uint32_t        AltBytes;               /*!< The alternate bytes (e.g. continuous read mode bits) */
+    uint8_t         DummyCycles;            /*!< Number of dummy cycles before the data phase [0 .. 31] */
+    QSPI_LinesType  DataLines;              /*!< Lines used for the data phase */
+    FunctionalState DoubleDataRate;         /*!< The address, alternate bytes and data phases use DDR */
+    FunctionalState SendInstructionOnce;    /*!< The instruction is only sent for the first command */
+}QSPI_CommandType;
+
+/** @brief QSPI Handle structure */
+typedef struct
+{
+    QUADSPI_TypeDef * Inst;                  /*!< The address of the peripheral instance used by the handle */
+    XPD_CtrlFnType ClockCtrl;                /*!< Function pointer for RCC clock control */
+    struct {
+        XPD_HandleCallbackType DepInit;      /*!< Callback to initialize module dependencies (GPIOs, IRQs, DMAs) */
+        XPD_HandleCallbackType DepDeinit;    /*!< Callback to restore module dependencies (GPIOs, IRQs, DMAs) */
+        XPD_HandleCallbackType Transmit;     /*!< Indirect write successful callback */
+        XPD_HandleCallbackType Receive;      /*!< Indirect read successful callback */
+        XPD_HandleCallbackType StatusMatch;  /*!< Automatic status polling matched callback */
+#if defined(USE_XPD_QSPI_ERROR_DETECT) || defined(USE_XPD_DMA_ERROR_DETECT)
+        XPD_HandleCallbackType Error;        /*!< Error callback */
+#endif
+    }Callbacks;                              /*   Handle Callbacks */
+    struct {
+        DMA_HandleType * Transfer;           /*!< DMA handle for indirect data transfers */
+    }DMA;                                    /*   DMA handle references */
+    DataStreamType Stream;                   /*!< Indirect data transfer stream */
+#if defined(USE_XPD_QSPI_ERROR_DETECT) || defined(USE_XPD_DMA_ERROR_DETECT)
+    volatile QSPI_ErrorType Errors;          /*!< Transfer errors */
+#endif
+#ifdef USE_XPD_STATISTICS
+    XPD_StatsType Stats;                     /*!< Runtime statistics (errors indexed by @ref QSPI_ErrorType bits) */
+#endif
+}QSPI_HandleType;
+
+/** @} */
+
+/** @defgroup QSPI_Exported_Macros QSPI Exported Macros
+ * @{ */
+
+/**
+ * @brief  QSPI Handle initializer macro
+ * @param  INSTANCE: specifies the QUADSPI peripheral instance.
+ * @param  INIT_FN: specifies the dependency initialization function to call back.
+ * @param  DEINIT_FN: specifies the dependency deinitialization function to call back.
+ */
+#define         NEW_QSPI_HANDLE(INSTANCE, INIT_FN, DEINIT_FN)   \
+    {.Inst = (INSTANCE),                                        \
+     .ClockCtrl = XPD_QSPI_ClockCtrl,                           \
+     .Callbacks.DepInit   = (INIT_FN),                          \
+     .Callbacks.DepDeinit = (DEINIT_FN)}
+
+/**
+ * @brief  Get the specified QSPI flag.
+ * @param  HANDLE: specifies the QSPI Handle.
+ * @param  FLAG_NAME: specifies the flag to return.
+ *         This parameter can be one of the following values:
+ *            @arg TEF:       Transfer error
+ *            @arg TCF:       Transfer complete
+ *            @arg FTF:       FIFO threshold
+ *            @arg SMF:       Status match
+ *            @arg TOF:       Timeout
+ *            @arg BUSY:      Busy
+ */
+#define         XPD_QSPI_GetFlag(HANDLE, FLAG_NAME)             \
+    (((HANDLE)->Inst->SR.w & QUADSPI_SR_##FLAG_NAME) != 0)
+
+/**
+ * @brief  Clear the specified QSPI flag.
+ * @param  HANDLE: specifies the QSPI Handle.
+ * @param  FLAG_NAME: specifies the flag to clear.
+ *         This parameter can be one of the following values:
+ *            @arg TEF:       Transfer error
+ *            @arg TCF:       Transfer complete
+ *            @arg SMF:       Status match
+ *            @arg TOF:       Timeout
+ */
+#define         XPD_QSPI_ClearFlag(HANDLE, FLAG_NAME)           \
+    ((HANDLE)->Inst->FCR.w = QUADSPI_FCR_C##FLAG_NAME)
+
+/**
+ * @brief  Provides the memory-mapped address of the external memory.
+ * @param  OFFSET: the byte offset in the external memory
+ */
+#define         XPD_QSPI_MemoryAddress(OFFSET)                  \
+    ((void *)(QSPI_BASE + (OFFSET)))
+
+/** @} */
+
+/** @addtogroup QSPI_Exported_Functions
+ * @{ */
+XPD_ReturnType  XPD_QSPI_Init               (QSPI_HandleType * hqspi, const QSPI_InitType * Config);
+XPD_ReturnType  XPD_QSPI_Deinit             (QSPI_HandleType * hqspi);
+
+XPD_ReturnType  XPD_QSPI_Command            (QSPI_HandleType * hqspi, const QSPI_CommandType * Cmd,
+                                             uint32_t Timeout);
+XPD_ReturnType  XPD_QSPI_Transmit           (QSPI_HandleType * hqspi, const QSPI_CommandType * Cmd,
+                                             const void * TxData, uint32_t Length, uint32_t Timeout);
+XPD_ReturnType  XPD_QSPI_Receive            (QSPI_HandleType * hqspi, const QSPI_CommandType * Cmd,
+                                             void * RxData, uint32_t Length, uint32_t Timeout);
+
+XPD_ReturnType  XPD_QSPI_Transmit_DMA       (QSPI_HandleType * hqspi, const QSPI_CommandType * Cmd,
+                                             const void * TxData, uint16_t Length);
+XPD_ReturnType  XPD_QSPI_Receive_DMA        (QSPI_HandleType * hqspi, const QSPI_CommandType * Cmd,
+                                             void * RxData, uint16_t Length);
+
+XPD_ReturnType  XPD_QSPI_AutoPolling        (QSPI_HandleType * hqspi, const QSPI_CommandType * Cmd,
+                                             uint32_t Match, uint32_t Mask, uint8_t Size,
+                                             QSPI_MatchModeType MatchMode, uint16_t Interval,
+                                             uint32_t Timeout);
+XPD_ReturnType  XPD_QSPI_AutoPolling_IT     (QSPI_HandleType * hqspi, const QSPI_CommandType * Cmd,
+                                             uint32_t Match, uint32_t Mask, uint8_t Size,
+                                             QSPI_MatchModeType MatchMode, uint16_t Interval);
+
+XPD_ReturnType  XPD_QSPI_MemoryMapped       (QSPI_HandleType * hqspi, const QSPI_CommandType * Cmd,
+                                             uint16_t IdleTimeout);
+XPD_ReturnType  XPD_QSPI_Abort              (QSPI_HandleType * hqspi);
+
+void            XPD_QSPI_IRQHandler         (QSPI_HandleType * hqspi);
+/** @} */
+
+/** @} */
+
+#define XPD_QSPI_API
+#include "xpd_rcc_gen.h"
+#include "xpd_rcc_pc.h"
+#undef XPD_QSPI_API
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __XPD_QSPI_H_ */
@@ -26,6 +26,12 @@
 
 #include "xpd_common.h"
 #include "xpd_config.h"
+#include "xpd_pwr.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
 
 /** @addtogroup RCC
  * @{ */
@@ -178,6 +184,30 @@ typedef struct {
 #endif
 }XPD_RCC_CallbacksType;
 
+/** @brief RCC clock change listener structure */
+typedef struct RCC_ClockListenerType
+{
+    struct RCC_ClockListenerType * Next; /*!< [Internal] The next registered listener */
+    XPD_HandleCallbackType Callback;     /*!< Clock change callback, called with the Handle as argument */
+    void *                 Handle;       /*!< The handle of the peripheral with clock dependent settings */
+}RCC_ClockListenerType;
+
+/** @brief RCC operating point setup structure */
+typedef struct
+{
+    const RCC_PLL_InitType * PLL;       /*!< PLL configuration (NULL if the PLL is left unchanged) */
+#ifdef HSE_VALUE
+    RCC_OscStateType     HSE_State;     /*!< HSE state to start it with if it's not ready (OSC_OFF if the HSE is not needed) */
+#endif
+#ifdef PWR_CR1_VOS
+    PWR_RegVoltScaleType VoltageScale;  /*!< Regulator voltage scaling */
+#endif
+    RCC_OscType      SYSCLK_Source;     /*!< SYSCLK input source */
+    ClockDividerType HCLK_Divider;      /*!< Clock divider of HCLK. Must not be CLK_DIV32. */
+    ClockDividerType PCLK1_Divider;     /*!< Clock divider of PCLK1 */
+    ClockDividerType PCLK2_Divider;     /*!< Clock divider of PCLK2 */
+}RCC_OperatingPointType;
+
 /** @} */
 
 /** @defgroup RCC_Core_Exported_Variables RCC Core Exported Variables
@@ -270,6 +300,7 @@ XPD_ReturnType      XPD_RCC_LSIConfig           (FunctionalState NewState);
 XPD_ReturnType      XPD_RCC_PLLConfig           (const RCC_PLL_InitType * Config);
 
 XPD_ReturnType      XPD_RCC_PLLSAI1Config       (const RCC_PLL_InitType * Config);
+XPD_ReturnType      XPD_RCC_PLLSAI1AudioConfig  (uint32_t SampleRate);
 #ifdef RCC_PLLSAI2_SUPPORT
 XPD_ReturnType      XPD_RCC_PLLSAI2Config       (const RCC_PLL_InitType * Config);
 #endif
@@ -300,6 +331,20 @@ void                XPD_RCC_PCLKConfig          (RCC_ClockType PCLKx, ClockDivid
 uint32_t            XPD_RCC_GetClockFreq        (RCC_ClockType SelectedClock);
 /** @} */
 
+/** @addtogroup RCC_Core_Clocks_Exported_Functions_Scaling
+ * @{ */
+XPD_ReturnType      XPD_RCC_OperatingPointConfig(const RCC_OperatingPointType * Config);
+XPD_ReturnType      XPD_RCC_OperatingPointConfig_IT(const RCC_OperatingPointType * Config);
+XPD_ReturnType      XPD_RCC_OperatingPointComplete  (void);
+
+void                XPD_RCC_ClockListener_Register  (RCC_ClockListenerType * Listener);
+void                XPD_RCC_ClockListener_Unregister(RCC_ClockListenerType * Listener);
+
+XPD_ReturnType      XPD_RCC_RunModeConfig       (const RCC_OperatingPointType * Config,
+                                                 FunctionalState LowPowerRun);
+XPD_ReturnType      XPD_RCC_StopMode            (ReactionType WakeUpOn, PWR_StopModeType Mode);
+/** @} */
+
 /** @addtogroup RCC_Core_Clocks_Exported_Functions_MCO
  * @{ */
 void                XPD_RCC_MCO_Init            (uint8_t MCOx, RCC_MCO1_ClockSourceType MCOSource,
@@ -354,6 +399,7 @@ __STATIC_INLINE void XPD_RCC_CSS(FunctionalState NewState)
 /** @addtogroup RCC_Core_Clocks_Exported_Functions_Reset
  * @{ */
 void                XPD_RCC_Deinit              (void);
+void                XPD_RCC_ClockTreeSync       (void);
 
 void                XPD_RCC_ResetAHB1           (void);
 void                XPD_RCC_ResetAHB2           (void);
@@ -370,4 +416,8 @@ RCC_ResetSourceType XPD_RCC_GetResetSource      (boolean_t Destructive);
 
 /** @} */
 
+#ifdef __cplusplus
+}
+#endif
+
 #endif /* __XPD_RCC_CC_H_ */
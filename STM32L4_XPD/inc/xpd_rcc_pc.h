@@ -120,6 +120,39 @@ uint32_t        XPD_I2C_GetClockFreq        (I2C_HandleType * hi2c);
 
 /** @} */
 
+#elif defined(XPD_LPTIM_API)
+
+/** @addtogroup LPTIM
+ * @{ */
+
+/** @defgroup LPTIM_Clock_Source LPTIM Clock Source
+ * @{ */
+
+/** @defgroup LPTIM_Clock_Source_Exported_Types LPTIM Clock Source Exported Types
+ * @{ */
+
+/** @brief LPTIM clock source types */
+typedef enum
+{
+    LPTIM_CLOCKSOURCE_PCLK1   = 0, /*!< default clock source */
+    LPTIM_CLOCKSOURCE_LSI     = 1, /*!< LSI clock source */
+    LPTIM_CLOCKSOURCE_HSI     = 2, /*!< HSI clock source */
+#ifdef LSE_VALUE
+    LPTIM_CLOCKSOURCE_LSE     = 3, /*!< LSE clock source */
+#endif
+}LPTIM_ClockSourceType;
+/** @} */
+
+/** @addtogroup LPTIM_Clock_Source_Exported_Functions
+ * @{ */
+void            XPD_LPTIM_ClockConfig       (LPTIM_HandleType * hlptim, LPTIM_ClockSourceType ClockSource);
+uint32_t        XPD_LPTIM_GetClockFreq      (LPTIM_HandleType * hlptim);
+/** @} */
+
+/** @} */
+
+/** @} */
+
 #elif defined(XPD_RTC_API)
 /** @addtogroup RTC
  * @{ */
@@ -154,6 +187,56 @@ uint32_t        XPD_RTC_GetClockFreq        (void);
 
 /** @} */
 
+#elif defined(XPD_SAI_API)
+
+/** @addtogroup SAI
+ * @{ */
+
+/** @defgroup SAI_Clock_Source SAI Clock Source
+ * @{ */
+
+/** @defgroup SAI_Clock_Source_Exported_Types SAI Clock Source Exported Types
+ * @{ */
+
+/** @brief SAI clock source types */
+typedef enum
+{
+    SAI_CLOCKSOURCE_PLLSAI1 = 0, /*!< PLLSAI1 P output clock source */
+#ifdef RCC_PLLSAI2_SUPPORT
+    SAI_CLOCKSOURCE_PLLSAI2 = 1, /*!< PLLSAI2 P output clock source */
+#endif
+    SAI_CLOCKSOURCE_PLL     = 2, /*!< PLL P output clock source */
+    SAI_CLOCKSOURCE_EXT     = 3, /*!< External clock source on the SAI_EXTCLK pin */
+}SAI_ClockSourceType;
+/** @} */
+
+/** @addtogroup SAI_Clock_Source_Exported_Functions
+ * @{ */
+void            XPD_SAI_ClockConfig         (SAI_HandleType * hsai, SAI_ClockSourceType ClockSource);
+uint32_t        XPD_SAI_GetClockFreq        (SAI_HandleType * hsai);
+/** @} */
+
+/** @} */
+
+/** @} */
+
+#elif defined(XPD_SPI_API)
+
+/** @addtogroup SPI
+ * @{ */
+
+/** @defgroup SPI_Clock_Source SPI Clock Source
+ * @{ */
+
+/** @addtogroup SPI_Clock_Source_Exported_Functions
+ * @{ */
+uint32_t        XPD_SPI_GetClockFreq        (SPI_HandleType * hspi);
+/** @} */
+
+/** @} */
+
+/** @} */
+
 #elif defined(XPD_TIM_API)
 
 /** @addtogroup TIM
@@ -0,0 +1,147 @@
+/**
+  ******************************************************************************
+  * @file    xpd_rtc.h
+  * @author  Benedek Kupper
+  * @version V0.1
+  * @date    2018-01-20
+  * @brief   STM32 eXtensible Peripheral Drivers Real Time Clock Module
+  *
+  *  This file is part of STM32_XPD.
+  *
+  *  STM32_XPD is free software: you can redistribute it and/or modify
+  *  it under the terms of the GNU General Public License as published by
+  *  the Free Software Foundation, either version 3 of the License, or
+  *  (at your option) any later version.
+  *
+  *  STM32_XPD is distributed in the hope that it will be useful,
+  *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with STM32_XPD.  If not, see <http://www.gnu.org/licenses/>.
+  */
+#ifndef __XPD_RTC_H_
+#define __XPD_RTC_H_
+
+#include "xpd_common.h"
+#include "xpd_config.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/** @defgroup RTC
+ *  @brief    Backup domain calendar with sub-second resolution
+ *  @details  The calendar keeps running in Stop and Standby modes, and through system resets.
+ *            The interrupts of the RTC are routed through EXTI lines
+ *            (see PWR_RTC_..._EXTI_LINE), which have to be configured for rising edge interrupt
+ *            with @ref XPD_RTC_IRQHandler called from the RTC interrupt vectors.
+ * @{ */
+
+/** @defgroup RTC_Exported_Types RTC Exported Types
+ * @{ */
+
+/** @brief RTC setup structure */
+typedef struct
+{
+    uint8_t AsyncPrescaler;         /*!< The asynchronous prescaler [1..128], the sub-second resolution
+                                         is AsyncPrescaler / RTCCLK, the power consumption decreases
+                                         with higher values */
+    FunctionalState BypassShadow;   /*!< The calendar is read directly from the counters instead of the
+                                         shadow registers, which don't need to be resynchronized after
+                                         low power modes, but have to be read repeatedly to get a
+                                         consistent value */
+}RTC_InitType;
+
+/** @brief RTC calendar structure */
+typedef struct
+{
+    uint8_t Year;                   /*!< Year within the century [0..99] */
+    uint8_t Month;                  /*!< Month [1..12] */
+    uint8_t Day;                    /*!< Day of the month [1..31] */
+    uint8_t WeekDay;                /*!< Day of the week [1..7], Monday is 1 */
+    uint8_t Hour;                   /*!< Hour [0..23] */
+    uint8_t Minute;                 /*!< Minute [0..59] */
+    uint8_t Second;                 /*!< Second [0..59] */
+    uint16_t SubSecond;             /*!< Elapsed sub-second ticks [0 .. @ref XPD_RTC_GetTicksPerSecond - 1] */
+}RTC_DateTimeType;
+
+/** @brief RTC alarm structure */
+typedef struct
+{
+    uint8_t Day;                    /*!< Day of the month [1..31] or RTC_ALARM_ANY */
+    uint8_t Hour;                   /*!< Hour [0..23] or RTC_ALARM_ANY */
+    uint8_t Minute;                 /*!< Minute [0..59] or RTC_ALARM_ANY */
+    uint8_t Second;                 /*!< Second [0..59] or RTC_ALARM_ANY */
+}RTC_AlarmType;
+
+/** @brief RTC callbacks container structure */
+typedef struct {
+    XPD_ValueCallbackType  Alarm;       /*!< Alarm callback, the passed parameter is the alarm index */
+    XPD_SimpleCallbackType Wakeup;      /*!< Wakeup timer period elapsed callback */
+    XPD_SimpleCallbackType Timestamp;   /*!< Timestamp event callback
+                                             (the event time is read by @ref XPD_RTC_GetEventTimestamp) */
+}XPD_RTC_CallbacksType;
+
+/** @} */
+
+/** @defgroup RTC_Exported_Variables RTC Exported Variables
+ * @{ */
+
+/** @brief RTC callbacks container struct */
+extern XPD_RTC_CallbacksType XPD_RTC_Callbacks;
+
+/** @} */
+
+/** @defgroup RTC_Exported_Macros RTC Exported Macros
+ * @{ */
+
+/** @brief Alarm field value which matches any value */
+#define RTC_ALARM_ANY           0xFF
+
+/**
+ * @brief  Provides the number of sub-second ticks in a second.
+ */
+#define         XPD_RTC_GetTicksPerSecond()                     \
+    ((RTC->PRER.w & RTC_PRER_PREDIV_S) + 1)
+
+/** @} */
+
+/** @addtogroup RTC_Exported_Functions
+ * @{ */
+XPD_ReturnType  XPD_RTC_Init                (const RTC_InitType * Config);
+
+XPD_ReturnType  XPD_RTC_SetDateTime         (const RTC_DateTimeType * DateTime);
+void            XPD_RTC_GetDateTime         (RTC_DateTimeType * DateTime);
+uint32_t        XPD_RTC_GetTimestamp        (void);
+XPD_ReturnType  XPD_RTC_WaitForSync         (void);
+
+XPD_ReturnType  XPD_RTC_AlarmStart_IT       (uint8_t Alarm, const RTC_AlarmType * Config);
+void            XPD_RTC_AlarmStop_IT        (uint8_t Alarm);
+
+#ifdef RTC_CR_WUTE
+uint32_t        XPD_RTC_WakeupStart_IT      (uint32_t Milliseconds);
+void            XPD_RTC_WakeupStop_IT       (void);
+#endif
+
+void            XPD_RTC_TimestampStart_IT   (EdgeType Edge);
+void            XPD_RTC_TimestampStop_IT    (void);
+XPD_ReturnType  XPD_RTC_GetEventTimestamp   (RTC_DateTimeType * DateTime);
+
+void            XPD_RTC_IRQHandler          (void);
+/** @} */
+
+/** @} */
+
+#define XPD_RTC_API
+#include "xpd_rcc_gen.h"
+#include "xpd_rcc_pc.h"
+#undef XPD_RTC_API
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __XPD_RTC_H_ */
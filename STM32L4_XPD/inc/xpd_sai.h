@@ -0,0 +1,199 @@
+/**
+  ******************************************************************************
+  * @file    xpd_sai.h
+  * @author  Benedek Kupper
+  * @version V0.1
+  * @date    2018-01-20
+  * @brief   STM32 eXtensible Peripheral Drivers SAI Module
+  *
+  *  This file is part of STM32_XPD.
+  *
+  *  STM32_XPD is free software: you can redistribute it and/or modify
+  *  it under the terms of the GNU General Public License as published by
+  *  the Free Software Foundation, either version 3 of the License, or
+  *  (at your option) any later version.
+  *
+  *  STM32_XPD is distributed in the hope that it will be useful,
+  *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with STM32_XPD.  If not, see <http://www.gnu.org/licenses/>.
+  */
+#ifndef __XPD_SAI_H_
+#define __XPD_SAI_H_
+
+#include "xpd_common.h"
+#include "xpd_config.h"
+#include "xpd_dma.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/** @defgroup SAI
+ * @{ */
+
+/** @defgroup SAI_Exported_Types SAI Exported Types
+ * @{ */
+
+/** @brief SAI audio block operating modes */
+typedef enum
+{
+    SAI_MODE_MASTER_TX = 0, /*!< Master transmitter */
+    SAI_MODE_MASTER_RX = 1, /*!< Master receiver */
+    SAI_MODE_SLAVE_TX  = 2, /*!< Slave transmitter */
+    SAI_MODE_SLAVE_RX  = 3, /*!< Slave receiver */
+}SAI_ModeType;
+
+/** @brief SAI frame standards */
+typedef enum
+{
+    SAI_STANDARD_PHILIPS   = 0, /*!< I2S Philips standard */
+    SAI_STANDARD_MSB       = 1, /*!< MSB justified standard */
+    SAI_STANDARD_LSB       = 2, /*!< LSB justified standard */
+    SAI_STANDARD_PCM_SHORT = 3, /*!< PCM standard with short frame synchronization */
+    SAI_STANDARD_PCM_LONG  = 4, /*!< PCM standard with long frame synchronization */
+}SAI_StandardType;
+
+/** @brief SAI data formats */
+typedef enum
+{
+    SAI_DATA_16          = 0, /*!< 16 bit data in 16 bit slot */
+    SAI_DATA_16_EXTENDED = 1, /*!< 16 bit data in 32 bit slot */
+    SAI_DATA_24          = 2, /*!< 24 bit data in 32 bit slot */
+    SAI_DATA_32          = 3, /*!< 32 bit data in 32 bit slot */
+}SAI_DataFormatType;
+
+/** @brief SAI error types */
+typedef enum
+{
+    SAI_ERROR_NONE     = 0, /*!< No error */
+    SAI_ERROR_OVRUDR   = 1, /*!< FIFO overrun (receiver) or underrun (transmitter) */
+    SAI_ERROR_CLOCK    = 2, /*!< Wrong master clock configuration */
+    SAI_ERROR_DMA      = 4, /*!< DMA transfer error */
+}SAI_ErrorType;
+
+/** @brief SAI setup structure */
+typedef struct
+{
+    SAI_ModeType       Mode;       /*!< Operating mode of the main audio block */
+    SAI_StandardType   Standard;   /*!< Frame standard of the two-slot stereo frame */
+    SAI_DataFormatType Format;     /*!< Data and slot length */
+    uint32_t           SampleRate; /*!< Audio sample rate in Hz (only used in master mode) */
+    FunctionalState    FullDuplex; /*!< Full-duplex operation using the other audio block
+                                        as synchronous slave in the opposite direction */
+}SAI_InitType;
+
+/** @brief SAI Handle structure */
+typedef struct
+{
+    SAI_Block_TypeDef * Inst;                /*!< The address of the main audio block used by the handle */
+    SAI_Block_TypeDef * Ext;                 /*!< The address of the synchronous audio block for full-duplex */
+    XPD_CtrlFnType ClockCtrl;                /*!< Function pointer for RCC clock control */
+    struct {
+        XPD_HandleCallbackType DepInit;      /*!< Callback to initialize module dependencies (GPIOs, IRQs, DMAs) */
+        XPD_HandleCallbackType DepDeinit;    /*!< Callback to restore module dependencies (GPIOs, IRQs, DMAs) */
+        XPD_HandleCallbackType BlockReady;   /*!< Streaming block transferred callback */
+#if defined(USE_XPD_SAI_ERROR_DETECT) || defined(USE_XPD_DMA_ERROR_DETECT)
+        XPD_HandleCallbackType Error;        /*!< Error callback */
+#endif
+    }Callbacks;                              /*   Handle Callbacks */
+    struct {
+        DMA_HandleType * Transmit;           /*!< DMA handle for data transmission */
+        DMA_HandleType * Receive;            /*!< DMA handle for data reception */
+    }DMA;                                    /*   DMA handle references */
+    DataStreamType TxBlock;                  /*!< The transmitted block of the stream, which is free to refill */
+    DataStreamType RxBlock;                  /*!< The received block of the stream, which is ready to process */
+    void * TxBuffer;                         /*!< [Internal] The transmit double buffer */
+    void * RxBuffer;                         /*!< [Internal] The receive double buffer */
+    uint32_t SampleRate;                     /*!< The actual sample rate of the master mode setup */
+    uint8_t FrameSize;                       /*!< [Internal] The number of bytes in a stereo frame */
+    uint8_t Duplex;                          /*!< [Internal] The synchronous audio block is used */
+#if defined(USE_XPD_SAI_ERROR_DETECT) || defined(USE_XPD_DMA_ERROR_DETECT)
+    volatile SAI_ErrorType Errors;           /*!< Transfer errors */
+#endif
+#ifdef USE_XPD_STATISTICS
+    XPD_StatsType Stats;                     /*!< Runtime statistics (errors indexed by @ref SAI_ErrorType bits) */
+#endif
+}SAI_HandleType;
+
+/** @} */
+
+/** @defgroup SAI_Exported_Macros SAI Exported Macros
+ * @{ */
+
+/**
+ * @brief  SAI Handle initializer macro
+ * @note   The audio block A is the main block, the block B is used for full-duplex operation.
+ * @param  INSTANCE: specifies the SAI peripheral instance.
+ * @param  INIT_FN: specifies the dependency initialization function to call back.
+ * @param  DEINIT_FN: specifies the dependency deinitialization function to call back.
+ */
+#define         NEW_SAI_HANDLE(INSTANCE, INIT_FN, DEINIT_FN)    \
+    {.Inst = INSTANCE##_Block_A, .Ext = INSTANCE##_Block_B,     \
+     .ClockCtrl = XPD_##INSTANCE##_ClockCtrl,                   \
+     .Callbacks.DepInit   = (INIT_FN),                          \
+     .Callbacks.DepDeinit = (DEINIT_FN)}
+
+/**
+ * @brief  Get the specified SAI flag of the main audio block.
+ * @param  HANDLE: specifies the SAI Handle.
+ * @param  FLAG_NAME: specifies the flag to return.
+ *         This parameter can be one of the following values:
+ *            @arg OVRUDR:    Overrun / underrun
+ *            @arg MUTEDET:   Mute detection
+ *            @arg WCKCFG:    Wrong clock configuration
+ *            @arg FREQ:      FIFO request
+ *            @arg CNRDY:     Codec not ready
+ *            @arg AFSDET:    Anticipated frame synchronization detection
+ *            @arg LFSDET:    Late frame synchronization detection
+ */
+#define         XPD_SAI_GetFlag(HANDLE, FLAG_NAME)              \
+    (((HANDLE)->Inst->SR & SAI_xSR_##FLAG_NAME) != 0)
+
+/**
+ * @brief  Clear the specified SAI flag of the main audio block.
+ * @param  HANDLE: specifies the SAI Handle.
+ * @param  FLAG_NAME: specifies the flag to clear.
+ *         This parameter can be one of the following values:
+ *            @arg OVRUDR:    Overrun / underrun
+ *            @arg MUTEDET:   Mute detection
+ *            @arg WCKCFG:    Wrong clock configuration
+ *            @arg CNRDY:     Codec not ready
+ *            @arg AFSDET:    Anticipated frame synchronization detection
+ *            @arg LFSDET:    Late frame synchronization detection
+ */
+#define         XPD_SAI_ClearFlag(HANDLE, FLAG_NAME)            \
+    ((HANDLE)->Inst->CLRFR = SAI_xCLRFR_C##FLAG_NAME)
+
+/** @} */
+
+/** @addtogroup SAI_Exported_Functions
+ * @{ */
+XPD_ReturnType  XPD_SAI_Init                (SAI_HandleType * hsai, const SAI_InitType * Config);
+XPD_ReturnType  XPD_SAI_Deinit              (SAI_HandleType * hsai);
+
+XPD_ReturnType  XPD_SAI_Stream_Start        (SAI_HandleType * hsai, void * TxBuffer,
+                                             void * RxBuffer, uint16_t BlockSize);
+void            XPD_SAI_Stream_Stop         (SAI_HandleType * hsai);
+
+#ifdef USE_XPD_SAI_ERROR_DETECT
+void            XPD_SAI_IRQHandler          (SAI_HandleType * hsai);
+#endif
+/** @} */
+
+/** @} */
+
+#define XPD_SAI_API
+#include "xpd_rcc_gen.h"
+#include "xpd_rcc_pc.h"
+#undef XPD_SAI_API
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __XPD_SAI_H_ */
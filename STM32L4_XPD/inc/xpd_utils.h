@@ -26,6 +26,14 @@
 
 #include "xpd_common.h"
 #include "xpd_config.h"
+#include "xpd_rcc.h"
+#include "xpd_nvic.h"
+#include <stdarg.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
 
 /** @defgroup XPD_Utils XPD Utilities
  * @{ */
@@ -49,6 +57,359 @@
 #define XPD_EXIT_CRITICAL(HANDLE)
 #endif
 
+/**
+ * @brief Defines the storage of a block pool, which can be placed in a RAM region
+ *        by prefixing it with e.g. @ref __CCMRAM (CCM RAM on STM32F3/F4, SRAM2 on STM32L4)
+ * @param NAME: the name of the storage variable
+ * @param BLOCKSIZE: the size of one block in bytes
+ * @param COUNT: the number of blocks
+ */
+#define XPD_POOL_STORAGE(NAME, BLOCKSIZE, COUNT)   \
+    uint32_t NAME[(((BLOCKSIZE) + 3) / 4) * (COUNT)]
+
+/**
+ * @brief Provides the maximal encoded size of a frame, including the delimiters.
+ * @param TYPE: the @ref XPD_FramingType of the frame
+ * @param LENGTH: the frame length in bytes
+ */
+#define XPD_FRAME_ENCODED_SIZE(TYPE, LENGTH)       \
+    (((TYPE) == XPD_FRAMING_COBS) ? ((LENGTH) + ((LENGTH) / 254) + 2) : ((2 * (LENGTH)) + 2))
+
+#ifdef USE_XPD_PROFILING
+#ifdef DWT_CTRL_CYCCNTENA_Msk
+/**
+ * @brief Reads the current core clock cycle count for profiling.
+ */
+#define XPD_PROFILE_TICKS()     (DWT->CYCCNT)
+#else
+#define XPD_PROFILE_TICKS()     ((uint32_t)XPD_GetTicks64())
+#endif
+
+#undef XPD_PROFILE_BEGIN
+/**
+ * @brief Starts the cycle measurement of the enclosing function's body.
+ */
+#define XPD_PROFILE_BEGIN()                                                 \
+    static XPD_ProfileType xpd_profile = { .Function = __func__, .Name = "" }; \
+    uint32_t xpd_profileStart = XPD_PROFILE_TICKS()
+
+#undef XPD_PROFILE_END
+/**
+ * @brief Finishes the cycle measurement of the enclosing function's body.
+ */
+#define XPD_PROFILE_END()                                                   \
+    XPD_Profile_Record(&xpd_profile, XPD_PROFILE_TICKS() - xpd_profileStart)
+
+#undef XPD_SAFE_CALLBACK
+/**
+ * @brief  Safe function pointer caller that checks it against NULL and calls it with parameters,
+ *         measuring the cycles spent in the callback.
+ * @param  CALLBACK: the function pointer
+ * @param  PARAMETERS: the required parameters of the function
+ */
+#define XPD_SAFE_CALLBACK(CALLBACK, ...)                                    \
+    do{ if ((CALLBACK) != NULL) {                                           \
+        static XPD_ProfileType xpd_cbProfile = { .Function = __func__, .Name = #CALLBACK }; \
+        uint32_t xpd_cbStart = XPD_PROFILE_TICKS();                         \
+        (void) CALLBACK(__VA_ARGS__);                                       \
+        XPD_Profile_Record(&xpd_cbProfile, XPD_PROFILE_TICKS() - xpd_cbStart); \
+    } }while(0)
+#endif
+
+#ifdef USE_XPD_CONST_CALLBACKS
+/**
+ * @brief  Calls an event callback of the handle from its constant callback table,
+ *         whose entries are never NULL, so no check is necessary.
+ * @param  HANDLE: pointer to the peripheral handle
+ * @param  CALLBACK: the callback name in the table
+ * @param  PARAMETERS: the required parameters of the function
+ */
+#define XPD_HANDLE_CALLBACK(HANDLE, CALLBACK, ...)  \
+    ((void) (HANDLE)->Callbacks.Table->CALLBACK(__VA_ARGS__))
+#else
+/**
+ * @brief  Calls an event callback of the handle if it is set.
+ * @param  HANDLE: pointer to the peripheral handle
+ * @param  CALLBACK: the callback name in the handle
+ * @param  PARAMETERS: the required parameters of the function
+ */
+#define XPD_HANDLE_CALLBACK(HANDLE, CALLBACK, ...)  \
+    XPD_SAFE_CALLBACK((HANDLE)->Callbacks.CALLBACK, __VA_ARGS__)
+#endif
+
+#ifdef USE_XPD_TRACE
+#undef XPD_TRACE
+/**
+ * @brief Emits a timestamped event to the trace ring.
+ * @param ID: the event identifier
+ * @param VALUE: the 16-bit event parameter
+ */
+#define XPD_TRACE(ID, VALUE)                                                \
+    XPD_Trace_Event((ID), (uint16_t)(VALUE))
+#endif
+
+#ifdef USE_XPD_ENERGY_PROFILING
+#undef XPD_ENERGY_STATE
+/**
+ * @brief Records a power state transition for the energy profiling.
+ * @param STATE: the new @ref XPD_EnergyStateType
+ */
+#define XPD_ENERGY_STATE(STATE)                                             \
+    XPD_Energy_SetState(STATE)
+#endif
+
+#ifdef USE_XPD_STATISTICS
+#ifdef DWT_CTRL_CYCCNTENA_Msk
+/**
+ * @brief Reads the current core clock cycle count for the statistics.
+ */
+#define XPD_STATS_TICKS()       (DWT->CYCCNT)
+#else
+#define XPD_STATS_TICKS()       ((uint32_t)XPD_GetTicks64())
+#endif
+
+#undef XPD_STATS_ADD
+/**
+ * @brief Adds a value to a statistics counter of the handle.
+ * @param HANDLE: pointer to the peripheral handle
+ * @param FIELD: the statistics field name
+ * @param VALUE: the value to add
+ */
+#define XPD_STATS_ADD(HANDLE, FIELD, VALUE)                                 \
+    ((HANDLE)->Stats.FIELD += (VALUE))
+
+#undef XPD_STATS_MAX
+/**
+ * @brief Raises a statistics field of the handle to the value if it exceeds it.
+ * @param HANDLE: pointer to the peripheral handle
+ * @param FIELD: the statistics field name
+ * @param VALUE: the observed value
+ */
+#define XPD_STATS_MAX(HANDLE, FIELD, VALUE)                                 \
+    do{ if ((VALUE) > (HANDLE)->Stats.FIELD) (HANDLE)->Stats.FIELD = (VALUE); }while(0)
+
+#undef XPD_STATS_ERROR
+/**
+ * @brief Counts the set error flags in the error counters of the handle.
+ * @param HANDLE: pointer to the peripheral handle
+ * @param ERRORS: the newly detected error flags
+ */
+#define XPD_STATS_ERROR(HANDLE, ERRORS)                                     \
+    XPD_Stats_CountErrors(&(HANDLE)->Stats, (ERRORS))
+
+#undef XPD_STATS_IRQ_BEGIN
+/**
+ * @brief Starts the execution time measurement of the IRQ handler for the statistics.
+ */
+#define XPD_STATS_IRQ_BEGIN()                                               \
+    uint32_t xpd_statsStart = XPD_STATS_TICKS()
+
+#undef XPD_STATS_IRQ_END
+/**
+ * @brief Finishes the IRQ handler execution time measurement of the handle.
+ * @param HANDLE: pointer to the peripheral handle
+ */
+#define XPD_STATS_IRQ_END(HANDLE)                                           \
+    XPD_STATS_MAX(HANDLE, MaxIRQCycles, XPD_STATS_TICKS() - xpd_statsStart)
+#endif
+
+/** @} */
+
+#ifdef USE_XPD_PROFILING
+/** @defgroup XPD_Exported_Types XPD Exported Types
+ * @{ */
+
+/** @brief XPD profiled code section statistics structure */
+typedef struct XPD_ProfileType
+{
+    struct XPD_ProfileType * Next;  /*!< [Internal] The next recorded profile */
+    const char * Function;          /*!< The name of the function containing the profiled code */
+    const char * Name;              /*!< The name of the profiled callback (empty for the function body) */
+    uint32_t     Count;             /*!< The number of measurements */
+    uint32_t     Min;               /*!< The minimal measured cycle count */
+    uint32_t     Max;               /*!< The maximal measured cycle count */
+    uint64_t     Total;             /*!< The sum of all measured cycle counts */
+    uint32_t     FPUCount;          /*!< The number of measurements in handler mode which used the FPU */
+    uint32_t     StackDepth;        /*!< The maximal main stack usage at the end of the profiled code
+                                         in handler mode in bytes, including all preempted contexts */
+}XPD_ProfileType;
+
+/** @} */
+#endif
+
+#if defined(USE_XPD_PROFILING) || defined(USE_XPD_ENERGY_PROFILING)
+/** @addtogroup XPD_Exported_Types
+ * @{ */
+
+/**
+ * @brief Text output function pointer type for the profile dump
+ * @param Text: the text to output
+ * @param Length: the length of the text
+ */
+typedef void ( *XPD_ProfileWriterType )     ( const char * Text, uint16_t Length );
+
+/** @} */
+#endif
+
+#ifdef USE_XPD_ENERGY_PROFILING
+/** @addtogroup XPD_Exported_Types
+ * @{ */
+
+/** @brief XPD energy profiling power states */
+typedef enum
+{
+    XPD_ENERGY_RUN    = 0, /*!< Run mode */
+    XPD_ENERGY_SLEEP  = 1, /*!< Sleep mode */
+    XPD_ENERGY_STOP   = 2, /*!< Stop mode */
+    XPD_ENERGY_CLOCK  = 3, /*!< Operating point transition (clock tree and voltage scaling) */
+    XPD_ENERGY_STATES = 4  /*!< The number of power states */
+}XPD_EnergyStateType;
+
+/** @brief XPD energy profiling setup structure */
+typedef struct
+{
+    uint32_t (*GetTime)(void);      /*!< The timebase function, which has to keep running in Stop mode
+                                         (e.g. @ref XPD_RTC_GetTimestamp or an LPTIM counter) */
+    uint32_t Period;                /*!< The wraparound period of the timebase, 0 for the full 32-bit range */
+    struct {
+        GPIO_TypeDef * Port;        /*!< The GPIO port of the marker pin, NULL if unused */
+        uint8_t Pin;                /*!< The pin number of the marker */
+    }Markers[XPD_ENERGY_STATES];    /*   The marker pins, driven high while the system is in the state */
+}XPD_EnergyInitType;
+
+/** @brief XPD energy profiling power state residency structure */
+typedef struct
+{
+    uint64_t Time[XPD_ENERGY_STATES];    /*!< The time spent in each state in timebase ticks */
+    uint32_t Entries[XPD_ENERGY_STATES]; /*!< The number of entries to each state */
+}XPD_EnergyStatsType;
+
+/** @} */
+#endif
+
+#ifdef USE_XPD_TRACE
+/** @addtogroup XPD_Exported_Types
+ * @{ */
+
+/** @brief XPD trace event identifiers */
+typedef enum
+{
+    XPD_TRACE_DMA_HALF       = 0x0101, /*!< DMA half transfer, value: channel address */
+    XPD_TRACE_DMA_COMPLETE   = 0x0102, /*!< DMA transfer complete, value: channel address */
+    XPD_TRACE_DMA_ERROR      = 0x0103, /*!< DMA transfer error, value: channel address */
+    XPD_TRACE_USART_RECEIVE  = 0x0201, /*!< USART reception complete, value: instance address */
+    XPD_TRACE_USART_TRANSMIT = 0x0202, /*!< USART transmission complete, value: instance address */
+    XPD_TRACE_USART_IDLE     = 0x0203, /*!< USART line idle, value: instance address */
+    XPD_TRACE_USART_ERROR    = 0x0204, /*!< USART errors detected, value: the error flags */
+    XPD_TRACE_USB_SETUP      = 0x0301, /*!< USB SETUP packet received */
+    XPD_TRACE_USB_DATA_OUT   = 0x0302, /*!< USB OUT transfer complete, value: endpoint number */
+    XPD_TRACE_USB_DATA_IN    = 0x0303, /*!< USB IN transfer complete, value: endpoint number */
+    XPD_TRACE_USB_RESET      = 0x0304, /*!< USB bus reset */
+    XPD_TRACE_USB_SUSPEND    = 0x0305, /*!< USB suspend, value: the target link state */
+    XPD_TRACE_USB_RESUME     = 0x0306, /*!< USB resume */
+    XPD_TRACE_USER           = 0x8000  /*!< The first identifier available for the application */
+}XPD_TraceIdType;
+
+/** @brief XPD binary trace event record, transferred as two little-endian words */
+typedef struct
+{
+    uint32_t Timestamp; /*!< The core clock tick count at the event */
+    uint16_t Id;        /*!< The event identifier (0 marks an unfinished record) */
+    uint16_t Value;     /*!< The event parameter */
+}XPD_TraceEventType;
+
+/** @} */
+#endif
+
+/** @addtogroup XPD_Exported_Types
+ * @{ */
+
+/** @brief XPD single producer single consumer ring buffer structure */
+typedef struct
+{
+    uint8_t *         Buffer;       /*!< [Internal] The element storage */
+    uint16_t          Mask;         /*!< [Internal] The element count - 1 */
+    uint8_t           ElementSize;  /*!< [Internal] The size of an element in bytes */
+    volatile uint16_t Head;         /*!< [Internal] Free-running write index, modified by the producer */
+    volatile uint16_t Tail;         /*!< [Internal] Free-running read index, modified by the consumer */
+}XPD_RingType;
+
+/** @brief XPD multiple producer single consumer message queue structure */
+typedef struct
+{
+    uint8_t *           Buffer;     /*!< [Internal] The element storage */
+    volatile uint16_t * Sequence;   /*!< [Internal] The publication sequence of each element */
+    uint16_t            Mask;       /*!< [Internal] The element count - 1 */
+    uint8_t             ElementSize;/*!< [Internal] The size of an element in bytes */
+    volatile uint16_t   Head;       /*!< [Internal] Free-running reservation index, shared by the producers */
+    uint16_t            Tail;       /*!< [Internal] Free-running read index, modified by the consumer */
+}XPD_QueueType;
+
+/** @brief XPD fixed-size block pool structure */
+typedef struct
+{
+    void * volatile Free;           /*!< [Internal] The first free block */
+    uint8_t *       Start;          /*!< [Internal] The start of the block storage */
+    uint8_t *       End;            /*!< [Internal] The end of the block storage */
+    uint16_t        BlockSize;      /*!< [Internal] The size of the blocks in bytes */
+#ifdef USE_XPD_STATISTICS
+    volatile uint16_t Used;         /*!< The number of allocated blocks */
+    uint16_t        HighWater;      /*!< The maximal number of allocated blocks */
+#endif
+}XPD_PoolType;
+
+/** @brief XPD deferred work item */
+typedef struct
+{
+    XPD_HandleCallbackType Function;/*!< The function to execute in the PendSV context */
+    void *                 Argument;/*!< The argument of the function */
+}XPD_WorkType;
+
+/** @brief XPD peripheral event source, which is dispatched by @ref XPD_WaitForEvents */
+typedef struct
+{
+    IRQn_Type              IRQn;    /*!< The interrupt line of the peripheral, which is disabled in NVIC */
+    XPD_HandleCallbackType Callback;/*!< The function to dispatch the event with, e.g. the peripheral IRQ handler */
+    void *                 Handle;  /*!< The argument of the function */
+}XPD_EventSourceType;
+
+/** @brief XPD byte stream framing methods */
+typedef enum
+{
+    XPD_FRAMING_COBS = 0,           /*!< Consistent Overhead Byte Stuffing, frames are delimited by zero bytes */
+    XPD_FRAMING_SLIP = 1,           /*!< Serial Line IP (RFC 1055), frames are delimited by 0xC0 bytes */
+}XPD_FramingType;
+
+/** @brief XPD streaming frame decoder structure */
+typedef struct
+{
+    XPD_FramingType        Type;    /*!< The framing method of the stream */
+    uint8_t *              Buffer;  /*!< The buffer of the decoded frame */
+    uint16_t               Size;    /*!< The size of the buffer, the longer frames are dropped */
+    XPD_HandleCallbackType Callback;/*!< Frame received callback, the frame is the first Length bytes of Buffer */
+    uint16_t               Length;  /*!< The decoded length of the current frame */
+    uint16_t               Errors;  /*!< The number of dropped frames due to overflow or invalid encoding */
+    uint8_t                State;   /*!< [Internal] COBS: remaining data bytes of the block, SLIP: pending escape */
+    uint8_t                Block;   /*!< [Internal] COBS: the code of the current block, 0 at frame start */
+    uint8_t                Drop;    /*!< [Internal] The current frame is dropped until the next delimiter */
+}XPD_FrameDecoderType;
+
+/** @brief XPD boot handoff options, selecting the resources which are kept for the started application */
+typedef enum
+{
+    XPD_HANDOFF_NONE        = 0, /*!< The clocks and peripherals are reset, as by @ref XPD_BootTo */
+    XPD_HANDOFF_CLOCKS      = 1, /*!< The clock configuration is kept */
+    XPD_HANDOFF_PERIPHERALS = 2, /*!< The peripherals aren't reset (the unused ones have to be deinitialized beforehand) */
+}XPD_HandoffFlagType;
+
+/** @brief XPD boot handoff structure, which is passed to the started application */
+typedef struct
+{
+    uint32_t Magic;                 /*!< [Internal] Validity marker */
+    uint32_t Flags;                 /*!< The kept resources, the combination of @ref XPD_HandoffFlagType values */
+    uint32_t Data[4];               /*!< Application specific data */
+}XPD_HandoffType;
+
 /** @} */
 
 /** @addtogroup XPD_Exported_Functions
@@ -59,16 +420,552 @@
 void            XPD_InitTimer           (void);
 void            XPD_Delay_ms            (uint32_t milliseconds);
 void            XPD_Delay_us            (uint32_t microseconds);
+uint64_t        XPD_GetTicks64          (void);
 XPD_ReturnType  XPD_WaitForMatch        (volatile uint32_t * varAddress, uint32_t bitSelector,
                                          uint32_t            match,      uint32_t * mstimeout);
 XPD_ReturnType  XPD_WaitForDiff         (volatile uint32_t * varAddress, uint32_t bitSelector,
                                          uint32_t            match,      uint32_t * mstimeout);
+XPD_ReturnType  XPD_WaitForMatchEvent   (volatile uint32_t * varAddress, uint32_t bitSelector,
+                                         uint32_t match, IRQn_Type IRQn, uint32_t * mstimeout);
+XPD_ReturnType  XPD_WaitForDiffEvent    (volatile uint32_t * varAddress, uint32_t bitSelector,
+                                         uint32_t match, IRQn_Type IRQn, uint32_t * mstimeout);
+/** @} */
+
+/** @addtogroup XPD_Exported_Functions_Event
+ * @{ */
+uint32_t        XPD_WaitForEvents       (uint32_t Lines, const XPD_EventSourceType * Sources, uint8_t Count);
 /** @} */
 
-/** @addtogroup XPD_Exported_Functions_Stream
+/** @addtogroup XPD_Exported_Functions_Pool
  * @{ */
-void            XPD_ReadToStream        (volatile uint32_t * reg, DataStreamType * stream);
-void            XPD_WriteFromStream     (volatile uint32_t * reg, DataStreamType * stream);
+XPD_ReturnType  XPD_Pool_Init           (XPD_PoolType * Pool, void * Storage, uint16_t BlockSize, uint16_t Count);
+void *          XPD_Pool_Alloc          (XPD_PoolType * Pool);
+void            XPD_Pool_Free           (XPD_PoolType * Pool, void * Block);
+void *          XPD_Pool_AllocSize      (XPD_PoolType * Pools, uint8_t PoolCount, uint32_t Size);
+void            XPD_Pool_FreeAny        (XPD_PoolType * Pools, uint8_t PoolCount, void * Block);
+/** @} */
+
+/** @addtogroup XPD_Exported_Functions_Defer
+ * @{ */
+XPD_ReturnType  XPD_Defer_Init          (XPD_WorkType * Buffer, uint16_t * Sequence, uint16_t Count);
+XPD_ReturnType  XPD_Defer               (XPD_HandleCallbackType Function, void * Argument);
+void            XPD_Defer_IRQHandler    (void);
+/** @} */
+
+/** @addtogroup XPD_Exported_Functions_Framing
+ * @{ */
+void            XPD_Frame_DecoderInit   (XPD_FrameDecoderType * Decoder);
+uint16_t        XPD_Frame_Decode        (XPD_FrameDecoderType * Decoder, const uint8_t * Data, uint16_t Length);
+uint16_t        XPD_Frame_Encode        (XPD_FramingType Type, const uint8_t * Data, uint16_t Length,
+                                         uint8_t * Output);
+/** @} */
+
+/** @addtogroup XPD_Exported_Functions_Format
+ * @{ */
+uint16_t        XPD_Format              (char * Buffer, uint16_t Size, const char * Format, ...);
+uint16_t        XPD_VFormat             (char * Buffer, uint16_t Mask, uint16_t Start, uint16_t Space,
+                                         const char * Format, va_list Args);
+/** @} */
+
+#if defined(USE_XPD_RTC) && defined(RTC_CR_WUTE)
+/** @addtogroup XPD_Exported_Functions_LowPower
+ * @{ */
+uint32_t        XPD_TicklessIdle        (uint32_t milliseconds, const RCC_OperatingPointType * clocks);
+/** @} */
+#endif
+
+#ifdef USE_XPD_TRACE
+/** @addtogroup XPD_Exported_Functions_Trace
+ * @{ */
+void            XPD_Trace_Init          (XPD_TraceEventType * Buffer, uint16_t Size);
+void            XPD_Trace_Event         (uint16_t Id, uint16_t Value);
+uint16_t        XPD_Trace_Peek          (const XPD_TraceEventType ** Events);
+void            XPD_Trace_Consume       (uint16_t Count);
+uint32_t        XPD_Trace_GetDropped    (void);
+#ifdef ITM_TCR_ITMENA_Msk
+void            XPD_Trace_ITMFlush      (uint8_t Port);
+#endif
+/** @} */
+#endif
+
+#ifdef USE_XPD_STATISTICS
+/** @addtogroup XPD_Exported_Functions_Statistics
+ * @{ */
+void            XPD_Stats_CountErrors   (XPD_StatsType * Stats, uint32_t Errors);
+void            XPD_Stats_Reset         (XPD_StatsType * Stats);
+
+void            XPD_Stack_Paint         (uint32_t * Bottom, uint32_t * Top);
+uint32_t        XPD_Stack_GetUsage      (const uint32_t * Bottom, const uint32_t * Top);
+uint32_t *      XPD_Stack_GetMainTop    (void);
+/** @} */
+#endif
+
+#ifdef USE_XPD_PROFILING
+/** @addtogroup XPD_Exported_Functions_Profiling
+ * @{ */
+void            XPD_Profile_Record      (XPD_ProfileType * Profile, uint32_t Cycles);
+const XPD_ProfileType * XPD_Profile_GetList (void);
+void            XPD_Profile_Reset       (void);
+void            XPD_Profile_Dump        (XPD_ProfileWriterType Write);
+void            XPD_Profile_LatencyDump (const NVIC_PriorityConfigType * Table, uint8_t Count,
+                                         XPD_ProfileWriterType Write);
+#ifdef ITM_TCR_ITMENA_Msk
+void            XPD_Profile_ITMWrite    (const char * Text, uint16_t Length);
+#endif
+/** @} */
+#endif
+
+#ifdef USE_XPD_ENERGY_PROFILING
+/** @addtogroup XPD_Exported_Functions_Energy
+ * @{ */
+void            XPD_Energy_Init         (const XPD_EnergyInitType * Config);
+void            XPD_Energy_SetState     (XPD_EnergyStateType State);
+void            XPD_Energy_GetStats     (XPD_EnergyStatsType * Stats);
+void            XPD_Energy_Reset        (void);
+void            XPD_Energy_Dump         (XPD_ProfileWriterType Write);
+/** @} */
+#endif
+
+/** @defgroup XPD_Exported_Functions_Stream XPD Data Stream Handling Functions
+ *  @brief    XPD Utilities data stream handlers
+ * @{
+ */
+
+/**
+ * @brief Reads new register data to the stream and updates its context.
+ * @note  Inlined to avoid the function call overhead in the interrupt handlers.
+ * @param reg: pointer to the register to read from
+ * @param stream: pointer to the destination stream
+ */
+__STATIC_INLINE void XPD_ReadToStream(volatile uint32_t * reg, DataStreamType * stream)
+{
+    /* Different size of data transferred */
+    switch (stream->size)
+    {
+        case 1:
+            *((uint8_t*) stream->buffer) = *((__IO uint8_t  *)reg);
+            break;
+        case 2:
+            *((uint16_t*)stream->buffer) = *((__IO uint16_t *)reg);
+            break;
+        default:
+            *((uint32_t*)stream->buffer) = *((__IO uint32_t *)reg);
+            break;
+    }
+    /* Stream context update */
+    stream->buffer = (uint8_t*)stream->buffer + stream->size;
+    stream->length--;
+}
+
+/**
+ * @brief Writes a new stream data element to the register and updates the stream context.
+ * @note  Inlined to avoid the function call overhead in the interrupt handlers.
+ * @param reg: pointer to the register to write to
+ * @param stream: pointer to the source stream
+ */
+__STATIC_INLINE void XPD_WriteFromStream(volatile uint32_t * reg, DataStreamType * stream)
+{
+    /* Different size of data transferred */
+    switch (stream->size)
+    {
+        case 1:
+            *((__IO uint8_t  *)reg) = *((uint8_t*) stream->buffer);
+            break;
+        case 2:
+            *((__IO uint16_t *)reg) = *((uint16_t*)stream->buffer);
+            break;
+        default:
+            *((__IO uint32_t *)reg) = *((uint32_t*)stream->buffer);
+            break;
+    }
+    /* Stream context update */
+    stream->buffer = (uint8_t*)stream->buffer + stream->size;
+    stream->length--;
+}
+
+/** @} */
+
+/** @defgroup XPD_Exported_Functions_Atomic XPD Atomic Bit Functions
+ *  @brief    Handle state flag updates which are shared between thread and interrupt context
+ *  @details  The read-modify-write sequence is made atomic by exclusive access on Cortex-M3/M4,
+ *            and by a short interrupt masked section on Cortex-M0, so the callers don't need
+ *            to disable the interrupts around the driver calls.
+ * @{
+ */
+
+/**
+ * @brief Sets bits of a state variable atomically.
+ * @param State: pointer to the state variable
+ * @param Bits: the bits to set
+ */
+__STATIC_INLINE void XPD_AtomicSetBits(volatile uint8_t * State, uint8_t Bits)
+{
+#if (__CORTEX_M >= 3)
+    while (__STREXB(__LDREXB(State) | Bits, State) != 0);
+#else
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+
+    *State |= Bits;
+
+    __set_PRIMASK(primask);
+#endif
+}
+
+/**
+ * @brief Clears bits of a state variable atomically.
+ * @param State: pointer to the state variable
+ * @param Bits: the bits to clear
+ */
+__STATIC_INLINE void XPD_AtomicClearBits(volatile uint8_t * State, uint8_t Bits)
+{
+#if (__CORTEX_M >= 3)
+    while (__STREXB(__LDREXB(State) & ~Bits, State) != 0);
+#else
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+
+    *State &= ~Bits;
+
+    __set_PRIMASK(primask);
+#endif
+}
+
+/** @} */
+
+/** @defgroup XPD_Exported_Functions_Ring XPD Ring Buffer Functions
+ *  @brief    Lock-free ring buffers for interrupt and main loop data handoff
+ * @{
+ */
+
+/* Copies an element without library dependency */
+__STATIC_INLINE void xpd_elementCopy(void * Dest, const void * Src, uint8_t Size)
+{
+    uint8_t * dest = (uint8_t*)Dest;
+    const uint8_t * src = (const uint8_t*)Src;
+
+    while (Size-- > 0)
+    {
+        *dest++ = *src++;
+    }
+}
+
+/**
+ * @brief Initializes a single producer single consumer ring buffer.
+ * @param Ring: pointer to the ring buffer structure
+ * @param Buffer: the element storage of Count * ElementSize bytes
+ * @param ElementSize: the size of one element in bytes (1 for a byte ring)
+ * @param Count: the number of elements, a power of two [2 .. 32768]
+ * @return ERROR if the element count isn't a power of two, OK if success
+ */
+__STATIC_INLINE XPD_ReturnType XPD_Ring_Init(XPD_RingType * Ring, void * Buffer, uint8_t ElementSize, uint32_t Count)
+{
+    XPD_ReturnType result = XPD_ERROR;
+
+    if ((Count >= 2) && (Count <= 0x8000) && ((Count & (Count - 1)) == 0))
+    {
+        Ring->Buffer      = (uint8_t*)Buffer;
+        Ring->Mask        = Count - 1;
+        Ring->ElementSize = ElementSize;
+        Ring->Head        = 0;
+        Ring->Tail        = 0;
+        result = XPD_OK;
+    }
+    return result;
+}
+
+/**
+ * @brief Gets the number of elements stored in the ring buffer.
+ * @param Ring: pointer to the ring buffer structure
+ * @return The number of readable elements
+ */
+__STATIC_INLINE uint16_t XPD_Ring_Count(const XPD_RingType * Ring)
+{
+    return (uint16_t)(Ring->Head - Ring->Tail);
+}
+
+/**
+ * @brief Gets the number of free elements in the ring buffer.
+ * @param Ring: pointer to the ring buffer structure
+ * @return The number of writable elements
+ */
+__STATIC_INLINE uint16_t XPD_Ring_Space(const XPD_RingType * Ring)
+{
+    return Ring->Mask + 1 - XPD_Ring_Count(Ring);
+}
+
+/**
+ * @brief Gets the contiguous free space at the write position of the ring buffer,
+ *        which can be filled directly (e.g. by DMA) before calling @ref XPD_Ring_Commit.
+ * @note  Producer side function.
+ * @param Ring: pointer to the ring buffer structure
+ * @param Data: pointer to the write position output
+ * @return The number of contiguous writable elements
+ */
+__STATIC_INLINE uint16_t XPD_Ring_Reserve(XPD_RingType * Ring, void ** Data)
+{
+    uint16_t head = Ring->Head & Ring->Mask;
+    uint16_t space = XPD_Ring_Space(Ring);
+
+    if (space > (Ring->Mask + 1 - head))
+    {
+        space = Ring->Mask + 1 - head;
+    }
+    *Data = &Ring->Buffer[head * Ring->ElementSize];
+    return space;
+}
+
+/**
+ * @brief Publishes the elements written to the reserved space of the ring buffer.
+ * @note  Producer side function.
+ * @param Ring: pointer to the ring buffer structure
+ * @param Count: the number of written elements
+ */
+__STATIC_INLINE void XPD_Ring_Commit(XPD_RingType * Ring, uint16_t Count)
+{
+    /* the element data has to be visible before the index */
+    __DMB();
+    Ring->Head += Count;
+}
+
+/**
+ * @brief Gets the contiguous readable elements at the read position of the ring buffer,
+ *        which can be processed directly (e.g. by DMA) before calling @ref XPD_Ring_Consume.
+ * @note  Consumer side function.
+ * @param Ring: pointer to the ring buffer structure
+ * @param Data: pointer to the read position output
+ * @return The number of contiguous readable elements
+ */
+__STATIC_INLINE uint16_t XPD_Ring_Peek(XPD_RingType * Ring, void ** Data)
+{
+    uint16_t tail = Ring->Tail & Ring->Mask;
+    uint16_t count = XPD_Ring_Count(Ring);
+
+    if (count > (Ring->Mask + 1 - tail))
+    {
+        count = Ring->Mask + 1 - tail;
+    }
+    /* the element data is read after the index */
+    __DMB();
+    *Data = &Ring->Buffer[tail * Ring->ElementSize];
+    return count;
+}
+
+/**
+ * @brief Releases the processed elements of the ring buffer.
+ * @note  Consumer side function.
+ * @param Ring: pointer to the ring buffer structure
+ * @param Count: the number of processed elements
+ */
+__STATIC_INLINE void XPD_Ring_Consume(XPD_RingType * Ring, uint16_t Count)
+{
+    /* the element data has to be read before the space is released */
+    __DMB();
+    Ring->Tail += Count;
+}
+
+/**
+ * @brief Writes an element to the ring buffer.
+ * @note  Producer side function.
+ * @param Ring: pointer to the ring buffer structure
+ * @param Element: pointer to the element to copy
+ * @return BUSY if the ring buffer is full, OK if success
+ */
+__STATIC_INLINE XPD_ReturnType XPD_Ring_Put(XPD_RingType * Ring, const void * Element)
+{
+    XPD_ReturnType result = XPD_BUSY;
+
+    if (XPD_Ring_Space(Ring) > 0)
+    {
+        xpd_elementCopy(&Ring->Buffer[(Ring->Head & Ring->Mask) * Ring->ElementSize],
+                Element, Ring->ElementSize);
+        XPD_Ring_Commit(Ring, 1);
+        result = XPD_OK;
+    }
+    return result;
+}
+
+/**
+ * @brief Reads an element from the ring buffer.
+ * @note  Consumer side function.
+ * @param Ring: pointer to the ring buffer structure
+ * @param Element: pointer to the element output
+ * @return BUSY if the ring buffer is empty, OK if success
+ */
+__STATIC_INLINE XPD_ReturnType XPD_Ring_Get(XPD_RingType * Ring, void * Element)
+{
+    XPD_ReturnType result = XPD_BUSY;
+
+    if (XPD_Ring_Count(Ring) > 0)
+    {
+        __DMB();
+        xpd_elementCopy(Element, &Ring->Buffer[(Ring->Tail & Ring->Mask) * Ring->ElementSize],
+                Ring->ElementSize);
+        XPD_Ring_Consume(Ring, 1);
+        result = XPD_OK;
+    }
+    return result;
+}
+
+/**
+ * @brief Writes a byte to a byte ring buffer.
+ * @note  Producer side function.
+ * @param Ring: pointer to the ring buffer structure with single byte elements
+ * @param Data: the byte to write
+ * @return BUSY if the ring buffer is full, OK if success
+ */
+__STATIC_INLINE XPD_ReturnType XPD_Ring_PutByte(XPD_RingType * Ring, uint8_t Data)
+{
+    XPD_ReturnType result = XPD_BUSY;
+
+    if (XPD_Ring_Space(Ring) > 0)
+    {
+        Ring->Buffer[Ring->Head & Ring->Mask] = Data;
+        XPD_Ring_Commit(Ring, 1);
+        result = XPD_OK;
+    }
+    return result;
+}
+
+/**
+ * @brief Reads a byte from a byte ring buffer.
+ * @note  Consumer side function.
+ * @param Ring: pointer to the ring buffer structure with single byte elements
+ * @param Data: pointer to the byte output
+ * @return BUSY if the ring buffer is empty, OK if success
+ */
+__STATIC_INLINE XPD_ReturnType XPD_Ring_GetByte(XPD_RingType * Ring, uint8_t * Data)
+{
+    XPD_ReturnType result = XPD_BUSY;
+
+    if (XPD_Ring_Count(Ring) > 0)
+    {
+        __DMB();
+        *Data = Ring->Buffer[Ring->Tail & Ring->Mask];
+        XPD_Ring_Consume(Ring, 1);
+        result = XPD_OK;
+    }
+    return result;
+}
+
+/**
+ * @brief Initializes a multiple producer single consumer message queue.
+ * @param Queue: pointer to the message queue structure
+ * @param Buffer: the element storage of Count * ElementSize bytes
+ * @param Sequence: the publication sequence storage of Count elements
+ * @param ElementSize: the size of one element in bytes
+ * @param Count: the number of elements, a power of two [2 .. 32768]
+ * @return ERROR if the element count isn't a power of two, OK if success
+ */
+__STATIC_INLINE XPD_ReturnType XPD_Queue_Init(XPD_QueueType * Queue, void * Buffer,
+        uint16_t * Sequence, uint8_t ElementSize, uint32_t Count)
+{
+    XPD_ReturnType result = XPD_ERROR;
+
+    if ((Count >= 2) && (Count <= 0x8000) && ((Count & (Count - 1)) == 0))
+    {
+        uint32_t i;
+
+        Queue->Buffer      = (uint8_t*)Buffer;
+        Queue->Sequence    = Sequence;
+        Queue->Mask        = Count - 1;
+        Queue->ElementSize = ElementSize;
+        Queue->Head        = 0;
+        Queue->Tail        = 0;
+
+        /* each element is free for the reservation index of its first round */
+        for (i = 0; i < Count; i++)
+        {
+            Sequence[i] = i;
+        }
+        result = XPD_OK;
+    }
+    return result;
+}
+
+/**
+ * @brief Writes an element to the message queue. The producers only contend for
+ *        the reservation of the element, so a preempted producer doesn't block the others.
+ * @note  Producer side function, can be called from any context.
+ * @param Queue: pointer to the message queue structure
+ * @param Element: pointer to the element to copy
+ * @return BUSY if the message queue is full, OK if success
+ */
+__STATIC_INLINE XPD_ReturnType XPD_Queue_Put(XPD_QueueType * Queue, const void * Element)
+{
+    XPD_ReturnType result = XPD_OK;
+    uint16_t pos;
+
+#if (__CORTEX_M >= 3)
+    do
+    {
+        pos = __LDREXH(&Queue->Head);
+
+        /* the element of the previous round hasn't been consumed yet */
+        if (Queue->Sequence[pos & Queue->Mask] != pos)
+        {
+            __CLREX();
+            result = XPD_BUSY;
+            break;
+        }
+    }
+    while (__STREXH(pos + 1, &Queue->Head) != 0);
+#else
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+
+    pos = Queue->Head;
+    if (Queue->Sequence[pos & Queue->Mask] != pos)
+    {
+        result = XPD_BUSY;
+    }
+    else
+    {
+        Queue->Head = pos + 1;
+    }
+
+    __set_PRIMASK(primask);
+#endif
+
+    if (result == XPD_OK)
+    {
+        xpd_elementCopy(&Queue->Buffer[(pos & Queue->Mask) * Queue->ElementSize],
+                Element, Queue->ElementSize);
+
+        /* publish the element for the consumer */
+        __DMB();
+        Queue->Sequence[pos & Queue->Mask] = pos + 1;
+    }
+    return result;
+}
+
+/**
+ * @brief Reads the oldest published element from the message queue.
+ * @note  Consumer side function.
+ * @param Queue: pointer to the message queue structure
+ * @param Element: pointer to the element output
+ * @return BUSY if the next element isn't published yet, OK if success
+ */
+__STATIC_INLINE XPD_ReturnType XPD_Queue_Get(XPD_QueueType * Queue, void * Element)
+{
+    XPD_ReturnType result = XPD_BUSY;
+    uint16_t pos = Queue->Tail;
+
+    if (Queue->Sequence[pos & Queue->Mask] == (uint16_t)(pos + 1))
+    {
+        __DMB();
+        xpd_elementCopy(Element, &Queue->Buffer[(pos & Queue->Mask) * Queue->ElementSize],
+                Queue->ElementSize);
+
+        /* release the element for the producers of the next round */
+        __DMB();
+        Queue->Sequence[pos & Queue->Mask] = pos + Queue->Mask + 1;
+        Queue->Tail = pos + 1;
+        result = XPD_OK;
+    }
+    return result;
+}
+
 /** @} */
 
 /** @addtogroup XPD_Exported_Functions_Init
@@ -76,10 +973,21 @@ void            XPD_WriteFromStream     (volatile uint32_t * reg, DataStreamType
 void            XPD_Init                (void);
 void            XPD_Deinit              (void);
 void            XPD_BootTo              (void * StartAddress);
+#ifdef USE_XPD_CONST_CALLBACKS
+void            XPD_NullCallback        (void * Handle);
+#endif
+#ifdef XPD_HANDOFF_ADDRESS
+void            XPD_BootHandoff         (void * StartAddress, const XPD_HandoffType * Handoff);
+const XPD_HandoffType * XPD_GetHandoff  (void);
+#endif
 /** @} */
 
 /** @} */
 
 /** @} */
 
+#ifdef __cplusplus
+}
+#endif
+
 #endif /* __XPD_UTILS_H_ */
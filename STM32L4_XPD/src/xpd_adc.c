@@ -48,6 +48,7 @@
 #define ADC_SQR_MASK            (ADC_SQR1_SQ1 >> ADC_SQR1_SQ1_Pos)
 #define ADC_SQR_SIZE            (ADC_SQR1_SQ2_Pos - ADC_SQR1_SQ1_Pos)
 #define ADC_SQR_REGDIR          (1)
+#define ADC_SCHEDULE_RANKS      16
 
 #if (ADC_COUNT > 1)
 
@@ -125,6 +126,90 @@ static void adc_dmaErrorRedirect(void *hdma)
 }
 #endif
 
+static void adc_dmaHalfBlockRedirect(void *hdma)
+{
+    ADC_HandleType* hadc = (ADC_HandleType*) ((DMA_HandleType*) hdma)->Owner;
+
+    /* The first half of the double buffer is filled */
+    hadc->Block.buffer = (void*)((DMA_HandleType*) hdma)->Inst->CMAR;
+
+    XPD_SAFE_CALLBACK(hadc->Callbacks.BlockReady, hadc);
+}
+
+static void adc_dmaBlockRedirect(void *hdma)
+{
+    ADC_HandleType* hadc = (ADC_HandleType*) ((DMA_HandleType*) hdma)->Owner;
+
+    /* The second half of the double buffer is filled */
+    hadc->Block.buffer = (uint8_t*)((DMA_HandleType*) hdma)->Inst->CMAR
+            + hadc->Block.length * hadc->Block.size;
+
+    XPD_SAFE_CALLBACK(hadc->Callbacks.BlockReady, hadc);
+}
+
+static void adc_dmaCaptureRedirect(void *hdma)
+{
+    ADC_HandleType* hadc = (ADC_HandleType*) ((DMA_HandleType*) hdma)->Owner;
+
+    /* The post-trigger conversions are stored */
+    XPD_ADC_Stop_DMA(hadc);
+    XPD_DMA_CircularMode(hadc->DMA.Conversion) = 1;
+
+    XPD_SAFE_CALLBACK(hadc->Callbacks.BlockReady, hadc);
+}
+
+/* Redirects the circular capture transfer to stop after the post-trigger conversions */
+static void adc_captureTrigger(ADC_HandleType * hadc)
+{
+    if (hadc->Capture.Armed != 0)
+    {
+        DMA_HandleType * hdma = hadc->DMA.Conversion;
+        uint16_t index, count;
+
+        hadc->Capture.Armed = 0;
+        CLEAR_BIT(hadc->Inst->IER.w, ADC_IER_AWD1IE << (hadc->ActiveWatchdog - ADC_AWD1));
+
+        /* Freeze the circular transfer at the current position */
+        XPD_DMA_Stop_IT(hdma);
+        index = (hadc->Block.length - hdma->Inst->CNDTR) % hadc->Block.length;
+        XPD_DMA_CircularMode(hdma) = 0;
+
+        hadc->Capture.Trigger = index;
+        hadc->Capture.Start   = (index + hadc->Capture.PostTrigger) % hadc->Block.length;
+
+        /* The post-trigger conversions overwrite the oldest ones, wrapping at the buffer end */
+        count = hadc->Block.length - index;
+        if (count > hadc->Capture.PostTrigger)
+        {
+            count = hadc->Capture.PostTrigger;
+        }
+        hadc->Capture.Blocks[0].MemAddress = (uint8_t*)hadc->Block.buffer + index * hadc->Block.size;
+        hadc->Capture.Blocks[0].DataCount  = count;
+        hadc->Capture.Blocks[1].MemAddress = hadc->Block.buffer;
+        hadc->Capture.Blocks[1].DataCount  = hadc->Capture.PostTrigger - count;
+
+        hdma->Callbacks.Complete = adc_dmaCaptureRedirect;
+
+        if (count == 0)
+        {
+            adc_dmaCaptureRedirect(hdma);
+        }
+        else
+        {
+            (void) XPD_DMA_StartChain_IT(hdma, (void *)&hadc->Inst->DR, hadc->Capture.Blocks,
+                    (hadc->Capture.Blocks[1].DataCount > 0) ? 2 : 1);
+        }
+    }
+}
+
+/* Updates the VDDA and the temperature with the monitor's injected sequence results */
+static void adc_monitorUpdate(ADC_HandleType * hadc)
+{
+    (void) XPD_ADC_TrackVDDA((uint16_t)hadc->Inst->JDR1);
+
+    hadc->Monitor.Temperature = (uint16_t)hadc->Inst->JDR2;
+}
+
 /* Enables the peripheral */
 static boolean_t adcx_enable(ADC_TypeDef * ADCx)
 {
@@ -805,6 +890,8 @@ void XPD_ADC_Stop_IT(ADC_HandleType * hadc)
  */
 void XPD_ADC_IRQHandler(ADC_HandleType * hadc)
 {
+    XPD_PROFILE_BEGIN();
+
     uint32_t isr = hadc->Inst->ISR.w;
     uint32_t ier = hadc->Inst->IER.w;
     uint32_t dual = ADC_COMMON(hadc)->CCR.b.DUAL;
@@ -875,6 +962,11 @@ void XPD_ADC_IRQHandler(ADC_HandleType * hadc)
         /* clear the ADC flag for injected end of conversion */
         SET_BIT(hadc->Inst->ISR.w, ADC_ISR_JEOC | ADC_ISR_JEOS);
 
+        if ((hadc->Monitor.Active != 0) && ((isr & ADC_ISR_JEOS) != 0))
+        {
+            adc_monitorUpdate(hadc);
+        }
+
         /* injected conversion complete callback */
         XPD_SAFE_CALLBACK(hadc->Callbacks.InjConvComplete, hadc);
     }
@@ -885,6 +977,8 @@ void XPD_ADC_IRQHandler(ADC_HandleType * hadc)
     {
         hadc->ActiveWatchdog = ADC_AWD1;
 
+        adc_captureTrigger(hadc);
+
         /* watchdog callback */
         XPD_SAFE_CALLBACK(hadc->Callbacks.Watchdog, hadc);
 
@@ -897,6 +991,8 @@ void XPD_ADC_IRQHandler(ADC_HandleType * hadc)
     {
         hadc->ActiveWatchdog = ADC_AWD2;
 
+        adc_captureTrigger(hadc);
+
         /* watchdog callback */
         XPD_SAFE_CALLBACK(hadc->Callbacks.Watchdog, hadc);
 
@@ -909,6 +1005,8 @@ void XPD_ADC_IRQHandler(ADC_HandleType * hadc)
     {
         hadc->ActiveWatchdog = ADC_AWD3;
 
+        adc_captureTrigger(hadc);
+
         /* watchdog callback */
         XPD_SAFE_CALLBACK(hadc->Callbacks.Watchdog, hadc);
 
@@ -945,6 +1043,8 @@ void XPD_ADC_IRQHandler(ADC_HandleType * hadc)
         XPD_SAFE_CALLBACK(hadc->Callbacks.Error, hadc);
     }
 #endif
+
+    XPD_PROFILE_END();
 }
 
 /**
@@ -1012,6 +1112,274 @@ void XPD_ADC_Stop_DMA(ADC_HandleType * hadc)
     XPD_DMA_Stop_IT(hadc->DMA.Conversion);
 }
 
+/**
+ * @brief Sets the data widths of the conversion DMA to store each reduced resolution conversion
+ *        in a single byte, so the DMA buffers hold twice as many conversions.
+ * @note  The packed conversions have 8 bit range if the ADC is initialized with 8 bit resolution
+ *        right-aligned, or 6 bit resolution left-aligned (the left-aligned 8 bit data is in the
+ *        upper byte of the data register). The offset and oversampling features shall not be used.
+ *        This function shall be called while the conversion DMA is not running.
+ * @param hadc: pointer to the ADC handle structure
+ * @param NewState: ENABLE for byte storage, DISABLE for the default half word storage
+ * @return ERROR if the conversion data doesn't fit in a byte, OK otherwise
+ */
+XPD_ReturnType XPD_ADC_DMA_BytePacking(ADC_HandleType * hadc, FunctionalState NewState)
+{
+    XPD_ReturnType result = XPD_OK;
+
+    if (NewState == DISABLE)
+    {
+        XPD_DMA_SetDataAlignment(hadc->DMA.Conversion, DMA_ALIGN_HALFWORD, DMA_ALIGN_HALFWORD);
+    }
+    else if ((hadc->Inst->CFGR.b.RES == ADC_RESOLUTION_6BIT) ||
+            ((hadc->Inst->CFGR.b.RES == ADC_RESOLUTION_8BIT) && (ADC_REG_BIT(hadc, CFGR, ALIGN) == 0)))
+    {
+        /* Only the low byte of the read half word is stored */
+        XPD_DMA_SetDataAlignment(hadc->DMA.Conversion, DMA_ALIGN_HALFWORD, DMA_ALIGN_BYTE);
+    }
+    else
+    {
+        result = XPD_ERROR;
+    }
+    return result;
+}
+
+/**
+ * @brief Starts continuous DMA-managed streaming of the ADC regular conversions
+ *        into a double buffer. The BlockReady callback is called each time a block is filled,
+ *        the filled block is available in the handle's Block stream while the DMA fills the other.
+ * @note  The conversions shall be triggered by a timer (see @ref XPD_TIM_MasterConfig)
+ *        for a constant sampling rate. The conversion DMA must be initialized in circular mode.
+ *        The streaming is stopped by @ref XPD_ADC_Stop_DMA.
+ * @param hadc: pointer to the ADC handle structure
+ * @param Buffer: memory address of the double buffer, which has the storage for two blocks
+ * @param BlockSize: the number of conversions in a single block
+ * @return ERROR if the DMA is not circular, BUSY if the DMA is in use, OK if successful
+ */
+XPD_ReturnType XPD_ADC_Stream_Start(ADC_HandleType * hadc, void * Buffer, uint16_t BlockSize)
+{
+    XPD_ReturnType result = XPD_ERROR;
+
+    /* If multimode is used, multimode function shall be used,
+     * the double buffer is continuously filled by circular DMA */
+    if ((ADC_COMMON(hadc)->CCR.b.DUAL == ADC_MULTIMODE_SINGE) &&
+        (XPD_DMA_CircularMode(hadc->DMA.Conversion) != 0))
+    {
+        hadc->Block.length = BlockSize;
+        hadc->Block.size   = 1 << hadc->DMA.Conversion->Inst->CCR.b.MSIZE;
+
+        /* Set up DMA for transfer */
+        result = XPD_DMA_Start_IT(hadc->DMA.Conversion,
+                (void *)&hadc->Inst->DR, Buffer, 2 * BlockSize);
+    }
+
+    if (result == XPD_OK)
+    {
+        /* Set the callback owner */
+        hadc->DMA.Conversion->Owner = hadc;
+
+        /* Set the DMA transfer callbacks */
+        hadc->DMA.Conversion->Callbacks.HalfComplete = adc_dmaHalfBlockRedirect;
+        hadc->DMA.Conversion->Callbacks.Complete     = adc_dmaBlockRedirect;
+#ifdef USE_XPD_DMA_ERROR_DETECT
+        hadc->DMA.Conversion->Callbacks.Error        = adc_dmaErrorRedirect;
+#endif
+        XPD_DMA_EnableIT(hadc->DMA.Conversion, HT);
+
+#ifdef USE_XPD_ADC_ERROR_DETECT
+        /* Enable ADC overrun interrupt */
+        XPD_ADC_EnableIT(hadc, OVR);
+#endif
+
+        /* Enable ADC DMA mode with continuous requests */
+        ADC_REG_BIT(hadc, CFGR, DMACFG) = 1;
+        ADC_REG_BIT(hadc, CFGR, DMAEN)  = 1;
+
+        XPD_ADC_Start(hadc);
+    }
+
+    return result;
+}
+
+/**
+ * @brief Starts the watchdog triggered capture of the ADC regular conversions.
+ *        The conversions are continuously stored in a circular buffer until the selected
+ *        analog watchdog is triggered, after which only the requested number of conversions
+ *        is stored. The buffer then contains a contiguous window of conversions before and after
+ *        the trigger, starting at the Capture.Start index (wrapping at the buffer end),
+ *        and the BlockReady callback is called.
+ * @note  The conversions shall be triggered by a timer (see @ref XPD_TIM_MasterConfig)
+ *        for a constant sampling rate. The watchdog has to be configured beforehand,
+ *        and its interrupt is enabled until the trigger. The Capture.Trigger index is the
+ *        first conversion stored after the watchdog interrupt is serviced.
+ *        The capture is stopped by @ref XPD_ADC_Stop_DMA.
+ * @param hadc: pointer to the ADC handle structure
+ * @param Watchdog: the analog watchdog which triggers the capture
+ * @param Buffer: memory address of the circular capture buffer
+ * @param Length: the number of conversions in the buffer
+ * @param PostTrigger: the number of conversions stored after the trigger [0 .. Length]
+ * @return ERROR if the input is invalid, BUSY if the DMA is in use, OK if successful
+ */
+XPD_ReturnType XPD_ADC_Capture_Start(ADC_HandleType * hadc, ADC_WatchdogType Watchdog,
+        void * Buffer, uint16_t Length, uint16_t PostTrigger)
+{
+    XPD_ReturnType result = XPD_ERROR;
+    DMA_HandleType * hdma = hadc->DMA.Conversion;
+
+    /* If multimode is used, multimode function shall be used */
+    if ((ADC_COMMON(hadc)->CCR.b.DUAL == ADC_MULTIMODE_SINGE) &&
+        (Watchdog != ADC_AWD_NONE) && (PostTrigger <= Length))
+    {
+        result = XPD_BUSY;
+    }
+    if ((result == XPD_BUSY) && (XPD_DMA_GetStatus(hdma) == 0))
+    {
+        /* The pre-trigger conversions are continuously stored by circular DMA */
+        XPD_DMA_CircularMode(hdma) = 1;
+
+        hadc->Block.buffer  = Buffer;
+        hadc->Block.length  = Length;
+        hadc->Block.size    = 1 << hdma->Inst->CCR.b.MSIZE;
+        hadc->Capture.PostTrigger = PostTrigger;
+        hadc->Capture.Trigger     = 0;
+        hadc->Capture.Start       = 0;
+
+        /* Set the callback owner */
+        hdma->Owner = hadc;
+
+        /* Set the DMA transfer callbacks */
+        hdma->Callbacks.HalfComplete = NULL;
+        hdma->Callbacks.Complete     = NULL;
+#ifdef USE_XPD_DMA_ERROR_DETECT
+        hdma->Callbacks.Error        = adc_dmaErrorRedirect;
+#endif
+
+        /* Set up DMA for transfer */
+        result = XPD_DMA_Start_IT(hdma, (void *)&hadc->Inst->DR, Buffer, Length);
+    }
+
+    if (result == XPD_OK)
+    {
+        hadc->Capture.Armed = 1;
+        SET_BIT(hadc->Inst->IER.w, ADC_IER_AWD1IE << (Watchdog - ADC_AWD1));
+
+#ifdef USE_XPD_ADC_ERROR_DETECT
+        /* Enable ADC overrun interrupt */
+        XPD_ADC_EnableIT(hadc, OVR);
+#endif
+
+        /* Enable ADC DMA mode with continuous requests */
+        ADC_REG_BIT(hadc, CFGR, DMACFG) = 1;
+        ADC_REG_BIT(hadc, CFGR, DMAEN)  = 1;
+
+        XPD_ADC_Start(hadc);
+    }
+
+    return result;
+}
+
+/**
+ * @brief Sets up the regular sequence to convert the channels at different rates.
+ *        Each channel is repeated in the sequence according to its weight, with the repetitions
+ *        spread evenly, so the sample rate of each channel is proportional to its weight.
+ *        The conversions of the single streaming buffer are distributed to the rings of the channels
+ *        by @ref XPD_ADC_Schedule_Demux.
+ * @note  The ADC shall be initialized with scan mode enabled.
+ * @note  The channel array is referenced by the handle, it shall remain valid while the schedule is used.
+ * @param hadc: pointer to the ADC handle structure
+ * @param Channels: the scheduled channel configuration array pointer
+ * @param ChannelCount: number of scheduled channels
+ * @return ERROR if a weight is zero or the total weight exceeds the sequence length, OK otherwise
+ */
+XPD_ReturnType XPD_ADC_Schedule_Config(ADC_HandleType * hadc,
+        const ADC_ScheduledChannelType * Channels, uint8_t ChannelCount)
+{
+    ADC_ChannelInitType sequence[ADC_SCHEDULE_RANKS];
+    uint8_t counts[ADC_SCHEDULE_RANKS];
+    uint8_t i, rank;
+    uint32_t length = 0;
+
+    if (ChannelCount > ADC_SCHEDULE_RANKS)
+    {
+        return XPD_ERROR;
+    }
+
+    for (i = 0; i < ChannelCount; i++)
+    {
+        if (Channels[i].Weight == 0)
+        {
+            return XPD_ERROR;
+        }
+        length += Channels[i].Weight;
+        counts[i] = 0;
+    }
+
+    if ((length == 0) || (length > ADC_SCHEDULE_RANKS))
+    {
+        return XPD_ERROR;
+    }
+
+    for (rank = 0; rank < length; rank++)
+    {
+        uint8_t next = 0;
+
+        /* Select the channel whose next conversion is due the earliest:
+         * the k-th conversion of a channel is due at (2k + 1) / (2 * Weight) of the sequence */
+        for (i = 1; i < ChannelCount; i++)
+        {
+            if (((2 * counts[i] + 1) * Channels[next].Weight)
+              < ((2 * counts[next] + 1) * Channels[i].Weight))
+            {
+                next = i;
+            }
+        }
+        counts[next]++;
+
+        sequence[rank] = Channels[next].Channel;
+        hadc->Schedule.Ranks[rank] = next;
+    }
+
+    hadc->Schedule.Channels = Channels;
+    hadc->Schedule.Length   = length;
+    hadc->Schedule.Rank     = 0;
+
+    XPD_ADC_ChannelConfig(hadc, sequence, length);
+
+    return XPD_OK;
+}
+
+/**
+ * @brief Distributes the conversions of the scheduled sequence to the rings of the channels.
+ *        The sequence position is kept between the calls, so the function can be called
+ *        with each block from the BlockReady callback of the conversion stream.
+ * @note  The conversions of a channel are dropped when its ring is full.
+ * @param hadc: pointer to the ADC handle structure
+ * @param Conversions: pointer to the conversions in sequence order
+ * @param Count: the number of conversions
+ */
+void XPD_ADC_Schedule_Demux(ADC_HandleType * hadc, const uint16_t * Conversions, uint32_t Count)
+{
+    uint8_t rank = hadc->Schedule.Rank;
+
+    for (; Count > 0; Count--)
+    {
+        XPD_RingType * ring = hadc->Schedule.Channels[hadc->Schedule.Ranks[rank]].Ring;
+
+        if (ring != NULL)
+        {
+            (void) XPD_Ring_Put(ring, Conversions);
+        }
+        Conversions++;
+
+        if (++rank == hadc->Schedule.Length)
+        {
+            rank = 0;
+        }
+    }
+
+    hadc->Schedule.Rank = rank;
+}
+
 /**
  * @brief Initializes the analog watchdog using the setup configuration.
  * @param hadc: pointer to the ADC handle structure
@@ -1068,6 +1436,45 @@ ADC_WatchdogType XPD_ADC_WatchdogStatus(ADC_HandleType * hadc)
     return hadc->ActiveWatchdog;
 }
 
+/**
+ * @brief Reconfigures the hardware oversampling of a conversion group.
+ * @note  The ratio and shift settings are shared by the regular and injected groups.
+ *        The oversampled result is truncated to 16 bits, so the shift has to be set accordingly
+ *        when the accumulated data would exceed this width.
+ * @param hadc: pointer to the ADC handle structure
+ * @param Operation: the conversion group to configure
+ *          This parameter can be one of the following values:
+ *            @arg ADC_OPERATION_CONVERSION:    regular group
+ *            @arg ADC_OPERATION_INJCONVERSION: injected group
+ * @param Config: pointer to the oversampling configuration
+ * @return BUSY if a conversion is ongoing, OK if successful
+ */
+XPD_ReturnType XPD_ADC_OversamplingConfig(ADC_HandleType * hadc, ADC_OperationType Operation,
+        const ADC_OversamplingType * Config)
+{
+    XPD_ReturnType result = XPD_BUSY;
+
+    /* Oversampling can only be changed when no conversion is ongoing */
+    if ((hadc->Inst->CR.w & ADC_STARTCTRL) == 0)
+    {
+        if (Config->State == ENABLE)
+        {
+            adc_oversamplingConfig(hadc, Config);
+        }
+
+        if (Operation == ADC_OPERATION_INJCONVERSION)
+        {
+            ADC_REG_BIT(hadc, CFGR2, JOVSE) = Config->State;
+        }
+        else
+        {
+            ADC_REG_BIT(hadc, CFGR2, ROVSE) = Config->State;
+        }
+        result = XPD_OK;
+    }
+    return result;
+}
+
 /** @} */
 
 /** @} */
@@ -1333,6 +1740,77 @@ void XPD_ADC_Injected_Stop_IT(ADC_HandleType * hadc)
     XPD_ADC_DisableIT(hadc, JEOC);
 }
 
+/**
+ * @brief Reads the results of the complete injected sequence in a single call.
+ * @param hadc: pointer to the ADC handle structure
+ * @param Values: output array for the conversion results, in the order of the sequence ranks
+ * @return The number of injected conversion results read [1 .. 4]
+ */
+uint8_t XPD_ADC_Injected_GetValues(ADC_HandleType * hadc, uint16_t * Values)
+{
+    uint8_t i, count = ((hadc->Inst->JSQR.w & ADC_JSQR_JL) >> ADC_JSQR_JL_Pos) + 1;
+
+    for (i = 0; i < count; i++)
+    {
+        Values[i] = (uint16_t)((&hadc->Inst->JDR1)[i]);
+    }
+
+    /* clear the flags for injected end of conversion and sequence */
+    hadc->Inst->ISR.w = ADC_ISR_JEOC | ADC_ISR_JEOS;
+
+    return count;
+}
+
+/**
+ * @brief Starts the background monitoring of the analog supply and the die temperature.
+ *        The injected group converts VREFINT and the temperature sensor at each trigger
+ *        (preferably a slow timer), and the VDDA used by the ADC calculations is updated
+ *        from the filtered VREFINT results in the interrupt context. The regular group remains
+ *        available to the application, and its conversions can be scaled without additional work.
+ * @note  The injected group shall not be used by the application while the monitor is active.
+ *        The function shall be called while the ADC is disabled, on the ADC instance
+ *        which has the internal channels connected.
+ * @param hadc: pointer to the ADC handle structure
+ * @param Trigger: the external trigger of the monitor conversions
+ * @param SampleTime: the sample time of the internal channels (see the device datasheet for the minimum)
+ */
+void XPD_ADC_Monitor_Start(ADC_HandleType * hadc, ADC_InjTriggerSourceType Trigger,
+        ADC_SampleTimeType SampleTime)
+{
+    ADC_Injected_InitType config = {
+        .AutoInjection     = DISABLE,
+        .DiscontinuousMode = DISABLE,
+        .Trigger.InjSource = Trigger,
+        .Trigger.Edge      = EDGE_RISING,
+    };
+    ADC_ChannelInitType channels[2] = {
+        { .Number = ADC1_VREFINT_CHANNEL,    .SampleTime = SampleTime },
+        { .Number = ADC1_TEMPSENSOR_CHANNEL, .SampleTime = SampleTime },
+    };
+
+    XPD_ADC_Injected_Init(hadc, &config);
+    XPD_ADC_Injected_ChannelConfig(hadc, channels, 2);
+
+    hadc->Monitor.Active = 1;
+
+    /* Only the end of the sequence is signalled */
+    SET_BIT(hadc->Inst->IER.w, ADC_IER_JEOSIE);
+    XPD_ADC_Injected_Start_IT(hadc);
+}
+
+/**
+ * @brief Stops the background monitoring of the analog supply and the die temperature.
+ *        The last VDDA value is kept for the ADC calculations.
+ * @param hadc: pointer to the ADC handle structure
+ */
+void XPD_ADC_Monitor_Stop(ADC_HandleType * hadc)
+{
+    XPD_ADC_Injected_Stop_IT(hadc);
+    CLEAR_BIT(hadc->Inst->IER.w, ADC_IER_JEOSIE);
+
+    hadc->Monitor.Active = 0;
+}
+
 /** @} */
 
 /** @} */
@@ -1475,6 +1953,86 @@ XPD_ReturnType XPD_ADC_Calibrate(ADC_HandleType * hadc, boolean_t Differential)
     return result;
 }
 
+/**
+ * @brief Reads out the calibration factors of the last self-calibrations,
+ *        so they can be stored (e.g. in backup registers or flash) for later restoration.
+ * @note  The operating conditions of the calibration have to be filled in by the caller.
+ * @param hadc: pointer to the ADC handle structure
+ * @param Calibration: pointer to the calibration factors storage
+ */
+void XPD_ADC_GetCalibration(ADC_HandleType * hadc, ADC_CalibrationType * Calibration)
+{
+    Calibration->Single       = hadc->Inst->CALFACT.b.CALFACT_S;
+    Calibration->Differential = hadc->Inst->CALFACT.b.CALFACT_D;
+}
+
+/**
+ * @brief Restores previously read out calibration factors instead of the self-calibrations.
+ *        The ADC is temporarily enabled for the factor update if it was disabled.
+ * @param hadc: pointer to the ADC handle structure
+ * @param Calibration: pointer to the stored calibration factors
+ * @return ERROR if a conversion is ongoing, TIMEOUT if the ADC didn't become ready, OK if successful
+ */
+XPD_ReturnType XPD_ADC_SetCalibration(ADC_HandleType * hadc, const ADC_CalibrationType * Calibration)
+{
+    XPD_ReturnType result = XPD_ERROR;
+
+    /* The factors can only be written when the ADC is enabled, and no conversion is ongoing */
+    if ((hadc->Inst->CR.w & ADC_STARTCTRL) == 0)
+    {
+        uint32_t timeout = 1;
+        boolean_t enabled = ADC_REG_BIT(hadc, CR, ADEN);
+
+        if (enabled)
+        {
+            result = XPD_OK;
+        }
+        else if (adcx_enable(hadc->Inst))
+        {
+            /* Wait until ADRDY flag is set ( < 1us) */
+            result = XPD_WaitForMatch(&hadc->Inst->ISR.w, ADC_ISR_ADRDY, ADC_ISR_ADRDY, &timeout);
+        }
+
+        if (result == XPD_OK)
+        {
+            hadc->Inst->CALFACT.w = (Calibration->Differential << ADC_CALFACT_CALFACT_D_Pos)
+                                  | (Calibration->Single       << ADC_CALFACT_CALFACT_S_Pos);
+        }
+
+        /* The factors are kept while the ADC is disabled */
+        if (!enabled)
+        {
+            timeout = 1;
+            adcx_disable(hadc->Inst);
+            XPD_WaitForMatch(&hadc->Inst->ISR.w, ADC_ISR_ADRDY, 0, &timeout);
+        }
+    }
+    return result;
+}
+
+/**
+ * @brief Determines if the stored calibration factors can be reused
+ *        in the current operating conditions, or a self-calibration is necessary.
+ * @note  The conditions may be measured by uncalibrated conversions,
+ *        as the drift limits are much larger than the calibration error.
+ * @param Calibration: pointer to the stored calibration factors
+ * @param Temperature: the current die temperature [C]
+ * @param VDDA: the current analog supply voltage [mV]
+ * @return TRUE if the calibration is valid, FALSE if it has to be renewed
+ */
+boolean_t XPD_ADC_CalibrationValid(const ADC_CalibrationType * Calibration,
+        int16_t Temperature, uint16_t VDDA)
+{
+    int32_t tdiff = (int32_t)Temperature - Calibration->Temperature;
+    int32_t vdiff = (int32_t)VDDA - Calibration->VDDA;
+
+    return (Calibration->VDDA != 0)
+        && (tdiff <=  ADC_CALIBRATION_TEMPERATURE_DRIFT)
+        && (tdiff >= -ADC_CALIBRATION_TEMPERATURE_DRIFT)
+        && (vdiff <=  ADC_CALIBRATION_VDDA_DRIFT)
+        && (vdiff >= -ADC_CALIBRATION_VDDA_DRIFT);
+}
+
 /** @} */
 
 /** @} */
@@ -0,0 +1,125 @@
+/**
+  ******************************************************************************
+  * @file    xpd_comp.c
+  * @author  Benedek Kupper
+  * @version V0.1
+  * @date    2018-01-20
+  * @brief   STM32 eXtensible Peripheral Drivers COMP Module
+  *
+  *  This file is part of STM32_XPD.
+  *
+  *  STM32_XPD is free software: you can redistribute it and/or modify
+  *  it under the terms of the GNU General Public License as published by
+  *  the Free Software Foundation, either version 3 of the License, or
+  *  (at your option) any later version.
+  *
+  *  STM32_XPD is distributed in the hope that it will be useful,
+  *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with STM32_XPD.  If not, see <http://www.gnu.org/licenses/>.
+  */
+#include "xpd_comp.h"
+#include "xpd_rcc.h"
+
+#if defined(USE_XPD_COMP)
+
+/** @addtogroup COMP
+ * @{ */
+
+/* The break input enable and polarity bits of COMP1 in the timer option registers,
+ * the COMP2 bits are located one position higher */
+#define COMP_TIM_OR_BKCMPE          TIM1_OR2_BKCMP1E
+#define COMP_TIM_OR_BKCMPP          TIM1_OR2_BKCMP1P
+
+/* The comparator index of the timer option register bits */
+#define COMP_INDEX(COMPx)           (((COMPx) == COMP1) ? 0 : 1)
+
+/** @defgroup COMP_Exported_Functions COMP Exported Functions
+ * @{ */
+
+/**
+ * @brief Initializes the comparator using the setup configuration.
+ *        The comparator is left disabled.
+ * @param COMPx: the comparator peripheral
+ * @param Config: pointer to COMP setup configuration
+ */
+void XPD_COMP_Init(COMP_TypeDef * COMPx, const COMP_InitType * Config)
+{
+    /* The comparators are clocked with the system configuration controller */
+    XPD_SYSCFG_ClockCtrl(ENABLE);
+
+    COMPx->CSR.w = 0;
+
+    COMPx->CSR.b.INMSEL   = Config->InputMinus;
+    COMPx->CSR.b.INPSEL   = Config->InputPlus;
+    COMPx->CSR.b.POLARITY = Config->Polarity;
+    COMPx->CSR.b.BLANKING = Config->Blanking;
+    COMPx->CSR.b.HYST     = Config->Hysteresis;
+    COMPx->CSR.b.PWRMODE  = Config->PowerMode;
+
+    /* The internal reference needs the scaler, its fractions the resistor bridge as well */
+    if (Config->InputMinus <= COMP_INPUTMINUS_VREFINT)
+    {
+        COMPx->CSR.b.SCALEN = 1;
+        COMPx->CSR.b.BRGEN  = (Config->InputMinus != COMP_INPUTMINUS_VREFINT) ? 1 : 0;
+    }
+}
+
+/**
+ * @brief Restores the comparator to its default state.
+ * @note  A locked comparator can only be reset by a system reset.
+ * @param COMPx: the comparator peripheral
+ */
+void XPD_COMP_Deinit(COMP_TypeDef * COMPx)
+{
+    COMPx->CSR.w = 0;
+}
+
+/**
+ * @brief Connects the comparator output to a timer break input.
+ *        The break function itself is set up by @ref XPD_TIM_Output_BreakConfig.
+ * @param COMPx: the comparator peripheral
+ * @param TIMx: the timer with break input (TIM1, TIM8, TIM15, TIM16 or TIM17)
+ * @param BreakLine: the break input [1..2], break 2 is only available on TIM1 and TIM8
+ * @param NewState: the new state of the connection
+ */
+void XPD_COMP_BreakConfig(COMP_TypeDef * COMPx, TIM_TypeDef * TIMx, uint8_t BreakLine,
+        FunctionalState NewState)
+{
+    __IO uint32_t * orx = (BreakLine > 1) ? &TIMx->OR3 : &TIMx->OR2;
+    uint32_t enable = COMP_TIM_OR_BKCMPE << COMP_INDEX(COMPx);
+
+    /* The break polarity is set by the comparator polarity */
+    CLEAR_BIT(*orx, COMP_TIM_OR_BKCMPP << COMP_INDEX(COMPx));
+
+    if (NewState != DISABLE)
+    {
+        SET_BIT(*orx, enable);
+    }
+    else
+    {
+        CLEAR_BIT(*orx, enable);
+    }
+}
+
+/**
+ * @brief Connects the comparator output to the external trigger of an advanced-control timer,
+ *        which can clear the output compare references by
+ *        @ref XPD_TIM_Output_OCRefClearConfig with ETR source.
+ * @param COMPx: the comparator peripheral
+ * @param TIMx: the advanced-control timer (TIM1 or TIM8)
+ */
+void XPD_COMP_ETRConfig(COMP_TypeDef * COMPx, TIM_TypeDef * TIMx)
+{
+    MODIFY_REG(TIMx->OR2, TIM1_OR2_ETRSEL,
+            (COMP_INDEX(COMPx) + 1) << TIM1_OR2_ETRSEL_Pos);
+}
+
+/** @} */
+
+/** @} */
+
+#endif /* USE_XPD_COMP */
@@ -0,0 +1,150 @@
+/**
+  ******************************************************************************
+  * @file    xpd_crc.c
+  * @author  Benedek Kupper
+  * @version V0.1
+  * @date    2018-01-20
+  * @brief   STM32 eXtensible Peripheral Drivers CRC Module
+  *
+  *  This file is part of STM32_XPD.
+  *
+  *  STM32_XPD is free software: you can redistribute it and/or modify
+  *  it under the terms of the GNU General Public License as published by
+  *  the Free Software Foundation, either version 3 of the License, or
+  *  (at your option) any later version.
+  *
+  *  STM32_XPD is distributed in the hope that it will be useful,
+  *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with STM32_XPD.  If not, see <http://www.gnu.org/licenses/>.
+  */
+#include "xpd_crc.h"
+#include "xpd_rcc.h"
+
+/** @addtogroup CRC
+ * @{ */
+
+/** @defgroup CRC_Exported_Functions CRC Exported Functions
+ * @{ */
+
+/**
+ * @brief Initializes the CRC unit using the setup configuration.
+ * @param Config: CRC setup configuration (the fixed CRC-32 unit has no settings)
+ */
+void XPD_CRC_Init(const CRC_InitType * Config)
+{
+    XPD_CRC_ClockCtrl(ENABLE);
+
+#ifdef CRC_CR_POLYSIZE
+    CRC->POL = Config->Polynomial;
+    CRC->CR.b.POLYSIZE = Config->PolySize;
+#endif
+#ifdef CRC_CR_REV_IN
+    CRC->INIT = Config->InitValue;
+    CRC->CR.b.REV_IN   = Config->InputReverse;
+    CRC->CR.b.REV_OUT  = Config->OutputReverse;
+#endif
+
+    XPD_CRC_Restart();
+}
+
+/**
+ * @brief Restores the CRC unit to its default state.
+ */
+void XPD_CRC_Deinit(void)
+{
+#ifdef CRC_CR_POLYSIZE
+    CRC->POL = 0x04C11DB7;
+#endif
+#ifdef CRC_CR_REV_IN
+    CRC->INIT = 0xFFFFFFFF;
+#endif
+    CRC->CR.w = CRC_CR_RESET;
+    CRC->IDR  = 0;
+
+    XPD_CRC_ClockCtrl(DISABLE);
+}
+
+/**
+ * @brief Continues the calculation with a block of words.
+ * @param Data: pointer to the input words
+ * @param Count: the number of input words
+ * @return The CRC value after the input
+ */
+uint32_t XPD_CRC_Accumulate(const uint32_t * Data, uint32_t Count)
+{
+    while (Count-- > 0)
+    {
+        CRC->DR = *Data++;
+    }
+    return CRC->DR;
+}
+
+/**
+ * @brief Restarts the calculation and processes a block of words.
+ * @param Data: pointer to the input words
+ * @param Count: the number of input words
+ * @return The CRC value of the input
+ */
+uint32_t XPD_CRC_Calculate(const uint32_t * Data, uint32_t Count)
+{
+    XPD_CRC_Restart();
+
+    return XPD_CRC_Accumulate(Data, Count);
+}
+
+#ifdef CRC_CR_REV_IN
+/**
+ * @brief Continues the calculation with a byte stream.
+ * @param Data: pointer to the input bytes
+ * @param Length: the number of input bytes
+ * @return The CRC value after the input
+ * @note  The bytes are processed in memory order: four bytes are fed as one big-endian word,
+ *        the remaining bytes by byte access. Reflected CRCs require @ref CRC_REVERSE_BYTE.
+ */
+uint32_t XPD_CRC_Accumulate8(const uint8_t * Data, uint32_t Length)
+{
+    for (; Length >= 4; Length -= 4, Data += 4)
+    {
+        CRC->DR = ((uint32_t)Data[0] << 24) | ((uint32_t)Data[1] << 16)
+                | ((uint32_t)Data[2] << 8)  |  (uint32_t)Data[3];
+    }
+    while (Length-- > 0)
+    {
+        *((__IO uint8_t *)&CRC->DR) = *Data++;
+    }
+    return CRC->DR;
+}
+#endif
+
+/**
+ * @brief Continues the calculation with a block of words in the background,
+ *        using the memory-to-memory DMA engine to write the data register.
+ * @param hmem: pointer to the initialized memory operation engine
+ * @param Job: pointer to the job structure, which has to remain valid until completion
+ * @param Data: pointer to the word aligned input words
+ * @param Count: the number of input words
+ * @return ERROR if the input isn't word aligned, OK if the job is queued
+ * @note  The result can be read by @ref XPD_CRC_GetValue from the job's callback.
+ *        The CRC unit inserts AHB wait states while it processes the previous data,
+ *        so the transfer needs no flow control.
+ */
+XPD_ReturnType XPD_CRC_Accumulate_DMA(DMA_MemEngineType * hmem, DMA_MemJobType * Job,
+        const uint32_t * Data, uint32_t Count)
+{
+    XPD_ReturnType result = XPD_ERROR;
+
+    /* the engine uses word access for word aligned blocks */
+    if (((uint32_t)Data & 3) == 0)
+    {
+        result = XPD_DMA_MemFeed_IT(hmem, Job, &CRC->DR, Data, Count * 4);
+    }
+    return result;
+}
+
+/** @} */
+
+/** @} */
@@ -24,6 +24,7 @@
 #include "xpd_dma.h"
 #include "xpd_rcc.h"
 #include "xpd_utils.h"
+#include "xpd_mem.h"
 
 /** @addtogroup DMA
  * @{ */
@@ -44,6 +45,20 @@ static const XPD_CtrlFnType dma_clkCtrl[] = {
         XPD_DMA2_ClockCtrl
 #endif
 };
+static DMA_TypeDef * const dma_bases[] = {
+        DMA1,
+#ifdef DMA2
+        DMA2
+#endif
+};
+#ifdef DMA_CSELR_C1S
+static DMA_Request_TypeDef * const dma_cselrs[] = {
+        DMA1_CSELR,
+#ifdef DMA2
+        DMA2_CSELR
+#endif
+};
+#endif
 static uint8_t dma_users[] = {
         0,
 #ifdef DMA2
@@ -67,12 +82,121 @@ static void dma_clockCtrl(DMA_HandleType * hdma, FunctionalState ClockState)
     dma_clkCtrl[bo]((dma_users[bo] > 0) ? ENABLE : DISABLE);
 }
 
+#ifdef RCC_AHB1SMENR_DMA1SMEN
+static const XPD_CtrlFnType dma_sleepClkCtrl[] = {
+        XPD_DMA1_SleepClockCtrl,
+#ifdef DMA2
+        XPD_DMA2_SleepClockCtrl
+#endif
+};
+static uint8_t dma_active[] = {
+        0,
+#ifdef DMA2
+        0
+#endif
+};
+
+/* Keeps the DMA clock running in Sleep mode only while any of its transfers are ongoing */
+static void dma_sleepClockCtrl(DMA_HandleType * hdma, FunctionalState ClockState)
+{
+    uint32_t bo = DMA_BASE_OFFSET(hdma->Inst);
+    uint32_t primask = __get_PRIMASK();
+
+    /* the transfers are started and finished from different contexts */
+    __disable_irq();
+
+    if (ClockState == DISABLE)
+    {
+        CLEAR_BIT(dma_active[bo], 1 << DMA_CHANNEL_NUMBER(hdma->Inst));
+    }
+    else
+    {
+        SET_BIT(dma_active[bo], 1 << DMA_CHANNEL_NUMBER(hdma->Inst));
+    }
+
+    dma_sleepClkCtrl[bo]((dma_active[bo] > 0) ? ENABLE : DISABLE);
+
+    __set_PRIMASK(primask);
+}
+#else
+#define dma_sleepClockCtrl(HANDLE, STATE)   ((void)0)
+#endif
+
 static void dma_calcBase(DMA_HandleType * hdma)
 {
     hdma->Base = DMA_BASE(hdma->Inst);
     hdma->ChannelOffset = DMA_CHANNEL_NUMBER(hdma->Inst) * 4;
 }
 
+/* Loads the next block of a chained transfer, returns 0 when the chain is finished */
+static uint32_t dma_chainReload(DMA_HandleType * hdma)
+{
+    uint32_t reloaded = 0;
+
+    if (hdma->Chain.Index < hdma->Chain.Count)
+    {
+        const DMA_DescriptorType * desc = &hdma->Chain.List[hdma->Chain.Index++];
+
+        /* The channel registers are only writable when the channel is disabled */
+        XPD_DMA_Disable(hdma);
+
+        hdma->Inst->CNDTR = desc->DataCount;
+        hdma->Inst->CMAR  = (uint32_t)desc->MemAddress;
+        hdma->BlockLength = desc->DataCount;
+
+        XPD_DMA_Enable(hdma);
+
+        reloaded = 1;
+    }
+    return reloaded;
+}
+
+#ifdef USE_XPD_DMA_ERROR_DETECT
+/* Restarts the circular transfer stopped by a transfer error with the remainder of the block,
+ * returns 0 if the error can't be recovered */
+static uint32_t dma_errorRestart(DMA_HandleType * hdma)
+{
+    uint32_t remaining = hdma->Inst->CNDTR;
+
+    /* a repeated error before the block is restored is not recovered */
+    if ((hdma->ErrorRecovery == DISABLE) || (XPD_DMA_CircularMode(hdma) == 0)
+            || (hdma->RecoveryBase != 0) || (remaining == 0))
+    {
+        return 0;
+    }
+
+    hdma->RecoveryBase = hdma->Inst->CMAR;
+    if (DMA_REG_BIT(hdma,CCR,MINC) != 0)
+    {
+        hdma->Inst->CMAR += (hdma->BlockLength - remaining) << hdma->Inst->CCR.b.MSIZE;
+    }
+
+    /* the remainder is transferred once, then the circular block is restored */
+    DMA_REG_BIT(hdma,CCR,CIRC) = 0;
+    XPD_DMA_ClearFlag(hdma, HT);
+    XPD_DMA_Enable(hdma);
+
+    hdma->Recoveries++;
+    return 1;
+}
+
+/* Restores the circular block after its remainder is transferred */
+static void dma_errorRestore(DMA_HandleType * hdma)
+{
+    if (hdma->RecoveryBase != 0)
+    {
+        XPD_DMA_Disable(hdma);
+
+        hdma->Inst->CNDTR = hdma->BlockLength;
+        hdma->Inst->CMAR  = hdma->RecoveryBase;
+        hdma->RecoveryBase = 0;
+        DMA_REG_BIT(hdma,CCR,CIRC) = 1;
+
+        XPD_DMA_Enable(hdma);
+    }
+}
+#endif
+
 /** @defgroup DMA_Exported_Functions DMA Exported Functions
  * @{ */
 
@@ -86,6 +210,7 @@ XPD_ReturnType XPD_DMA_Init(DMA_HandleType * hdma, const DMA_InitType * Config)
 {
     /* enable DMA clock */
     dma_clockCtrl(hdma, ENABLE);
+    dma_sleepClockCtrl(hdma, DISABLE);
 
     hdma->Inst->CCR.b.PL         = Config->Priority;
     DMA_REG_BIT(hdma,CCR,DIR)    = Config->Direction;
@@ -130,11 +255,87 @@ XPD_ReturnType XPD_DMA_Deinit(DMA_HandleType * hdma)
     XPD_DMA_ClearFlag(hdma, TE);
 
     /* disable DMA clock */
+    dma_sleepClockCtrl(hdma, DISABLE);
     dma_clockCtrl(hdma, DISABLE);
 
     return XPD_OK;
 }
 
+/**
+ * @brief Assigns a free DMA channel to the peripheral request, and initializes it
+ *        using the setup configuration.
+ * @param hdma: pointer to the DMA stream handle structure, its instance is set by the function
+ * @param Request: the peripheral request which the DMA channel shall serve
+ * @param Config: DMA stream setup configuration
+ * @return BUSY if all candidate channels are in use, ERROR if the request isn't available
+ *         on the device, OK if success
+ * @note  The channel candidates of the request are tried in order, the reservation is
+ *        tracked together with the handles initialized by @ref XPD_DMA_Init.
+ *        The channel can be released by @ref XPD_DMA_Deinit.
+ */
+XPD_ReturnType XPD_DMA_Allocate(DMA_HandleType * hdma, DMA_RequestType Request, const DMA_InitType * Config)
+{
+    XPD_ReturnType result = XPD_ERROR;
+    const DMA_RequestMapType * map = XPD_DMA_RequestMap[Request];
+    uint32_t i, bo = 0, ch = 0;
+
+    XPD_ENTER_CRITICAL(hdma);
+
+    for (i = 0; (i < 2) && (map[i].Channel != 0); i++)
+    {
+        bo = (map[i].Channel >> 3) - 1;
+        ch = map[i].Channel & 7;
+
+        if (bo >= sizeof(dma_users) / sizeof(dma_users[0]))
+        {
+            continue;
+        }
+        else if ((dma_users[bo] & (1 << ch)) == 0)
+        {
+            /* reserve the channel before leaving the critical section */
+            SET_BIT(dma_users[bo], 1 << ch);
+            result = XPD_OK;
+            break;
+        }
+        else
+        {
+            result = XPD_BUSY;
+        }
+    }
+
+    XPD_EXIT_CRITICAL(hdma);
+
+    if (result == XPD_OK)
+    {
+        hdma->Inst = (DMA_Channel_TypeDef*)((uint32_t)dma_bases[bo] + 8 + 20 * ch);
+#ifdef DMA_Channel_BB
+        hdma->Inst_BB = DMA_Channel_BB(hdma->Inst);
+#endif
+
+        result = XPD_DMA_Init(hdma, Config);
+
+#ifdef DMA_CSELR_C1S
+        /* route the request to the channel */
+        MODIFY_REG(dma_cselrs[bo]->CSELR.w, 0xF << (ch * 4), map[i].Select << (ch * 4));
+#else
+        if ((map[i].Select & 0x7F) != 0)
+        {
+            /* remap the request to the alternate channel */
+            if ((map[i].Select & 0x80) != 0)
+            {
+                SET_BIT(SYSCFG->CFGR1.w, 1 << (map[i].Select & 0x7F));
+            }
+            else
+            {
+                CLEAR_BIT(SYSCFG->CFGR1.w, 1 << (map[i].Select & 0x7F));
+            }
+        }
+#endif
+    }
+
+    return result;
+}
+
 /**
  * @brief Enables the DMA stream.
  * @param hdma: pointer to the DMA stream handle structure
@@ -159,7 +360,7 @@ void XPD_DMA_Disable(DMA_HandleType * hdma)
  * @param PeriphAddress: pointer to the peripheral data register
  * @param MemAddress: pointer to the memory data
  * @param DataCount: the amount of data to be transferred
- * @return BUSY if DMA is in use, OK if success
+ * @return ERROR if the memory isn't accessible by the DMA, BUSY if DMA is in use, OK if success
  */
 XPD_ReturnType XPD_DMA_Start(DMA_HandleType * hdma, void * PeriphAddress, void * MemAddress, uint16_t DataCount)
 {
@@ -168,10 +369,15 @@ XPD_ReturnType XPD_DMA_Start(DMA_HandleType * hdma, void * PeriphAddress, void *
     /* Enter critical section to ensure single user of DMA */
     XPD_ENTER_CRITICAL(hdma);
 
+    /* The CPU coupled memories can't be accessed */
+    if (!DMA_ADDRESS_ACCESSIBLE(MemAddress) || !DMA_ADDRESS_ACCESSIBLE(PeriphAddress))
+    {
+        result = XPD_ERROR;
+    }
     /* If previous user was a different peripheral, check busy state first */
-    if ((uint32_t)PeriphAddress != hdma->Inst->CPAR)
+    else if ((uint32_t)PeriphAddress != hdma->Inst->CPAR)
     {
-        result = XPD_DMA_GetStatus(hdma);
+        result = (XPD_DMA_GetStatus(hdma) == 0) ? XPD_OK : XPD_BUSY;
     }
 
     if (result == XPD_OK)
@@ -182,17 +388,20 @@ XPD_ReturnType XPD_DMA_Start(DMA_HandleType * hdma, void * PeriphAddress, void *
         hdma->Inst->CNDTR = DataCount;
         hdma->Inst->CPAR  = (uint32_t)PeriphAddress;
         hdma->Inst->CMAR  = (uint32_t)MemAddress;
+        hdma->BlockLength = DataCount;
+        hdma->Wraps = 0;
+
+        /* no chained transfer by default */
+        hdma->Chain.Count = hdma->Chain.Index = 0;
 #ifdef USE_XPD_DMA_ERROR_DETECT
         /* reset error state */
         hdma->Errors = DMA_ERROR_NONE;
+        hdma->RecoveryBase = 0;
 #endif
 
+        dma_sleepClockCtrl(hdma, ENABLE);
         XPD_DMA_Enable(hdma);
     }
-    else
-    {
-        result = XPD_BUSY;
-    }
 
     XPD_EXIT_CRITICAL(hdma);
 
@@ -201,6 +410,9 @@ XPD_ReturnType XPD_DMA_Start(DMA_HandleType * hdma, void * PeriphAddress, void *
 
 /**
  * @brief Sets up a DMA transfer, starts it and produces completion callback using the interrupt stack.
+ * @note  When ErrorRecovery is enabled, a circular transfer stopped by a transfer error
+ *        is restarted from its current position, and only the Recoveries counter is increased.
+ *        The half transfer event of the restarted block occurs at the half of its remainder.
  * @param hdma: pointer to the DMA stream handle structure
  * @param PeriphAddress: pointer to the peripheral data register
  * @param MemAddress: pointer to the memory data
@@ -224,6 +436,46 @@ XPD_ReturnType XPD_DMA_Start_IT(DMA_HandleType * hdma, void * PeriphAddress, voi
     return result;
 }
 
+/**
+ * @brief Sets up a chained DMA transfer of multiple memory blocks, starts it and
+ *        produces completion callback using the interrupt stack.
+ * @note  The channel is reloaded with the next descriptor's block from the transfer complete
+ *        interrupt, so the completion callback is only called when the last block is transferred.
+ *        The descriptor list must remain valid until the chained transfer is completed.
+ * @param hdma: pointer to the DMA stream handle structure
+ * @param PeriphAddress: pointer to the peripheral data register
+ * @param Descriptors: pointer to the array of memory block descriptors
+ * @param Count: the number of descriptors in the array
+ * @return ERROR if the descriptor list is empty, BUSY if DMA is in use, OK if success
+ */
+XPD_ReturnType XPD_DMA_StartChain_IT(DMA_HandleType * hdma, void * PeriphAddress,
+        const DMA_DescriptorType * Descriptors, uint16_t Count)
+{
+    XPD_ReturnType result = XPD_ERROR;
+
+    if (Count > 0)
+    {
+        result = XPD_DMA_Start(hdma, PeriphAddress, Descriptors[0].MemAddress, Descriptors[0].DataCount);
+    }
+
+    if (result == XPD_OK)
+    {
+        /* Save chain context before the completion interrupt is enabled */
+        hdma->Chain.List  = Descriptors;
+        hdma->Chain.Count = Count;
+        hdma->Chain.Index = 1;
+
+        /* enable interrupts
+         * half transfer interrupt has to be enabled by user if callback is used */
+#ifdef USE_XPD_DMA_ERROR_DETECT
+        SET_BIT(hdma->Inst->CCR.w, DMA_CCR_TCIE | DMA_CCR_TEIE);
+#else
+        XPD_DMA_EnableIT(hdma,TC);
+#endif
+    }
+    return result;
+}
+
 /**
  * @brief Stops a DMA transfer.
  * @param hdma: pointer to the DMA stream handle structure
@@ -237,6 +489,8 @@ XPD_ReturnType XPD_DMA_Stop(DMA_HandleType *hdma)
     /* disable the stream */
     XPD_DMA_Disable(hdma);
 
+    dma_sleepClockCtrl(hdma, DISABLE);
+
     /* wait until stream is effectively disabled */
     result = XPD_WaitForMatch(&hdma->Inst->CCR.w, DMA_CCR_EN, 0, &timeout);
 
@@ -254,6 +508,20 @@ void XPD_DMA_Stop_IT(DMA_HandleType *hdma)
 
     /* disable interrupts */
     CLEAR_BIT(hdma->Inst->CCR.w, DMA_CCR_TCIE | DMA_CCR_HTIE | DMA_CCR_TEIE);
+
+    /* abandon the remaining chained blocks */
+    hdma->Chain.Count = 0;
+
+#ifdef USE_XPD_DMA_ERROR_DETECT
+    /* restore the circular mode of an interrupted recovery */
+    if (hdma->RecoveryBase != 0)
+    {
+        DMA_REG_BIT(hdma,CCR,CIRC) = 1;
+        hdma->RecoveryBase = 0;
+    }
+#endif
+
+    dma_sleepClockCtrl(hdma, DISABLE);
 }
 
 /**
@@ -266,6 +534,52 @@ uint16_t XPD_DMA_GetStatus(DMA_HandleType * hdma)
     return DMA_REG_BIT(hdma, CCR, EN) * hdma->Inst->CNDTR;
 }
 
+/**
+ * @brief Gets a consistent snapshot of the circular or chained transfer progress.
+ * @note  The transfer complete interrupt has to be enabled for the block counting,
+ *        a pending transfer complete flag is accounted for in the result.
+ * @param hdma: pointer to the DMA stream handle structure
+ * @param Buffer: pointer to set to the currently transferred memory block (can be NULL)
+ * @param Offset: pointer to set to the number of data transfers done in the current block
+ * @return The number of completed blocks since the transfer start
+ */
+uint32_t XPD_DMA_GetPosition(DMA_HandleType * hdma, void ** Buffer, uint16_t * Offset)
+{
+    uint32_t wraps, flag;
+    uint16_t count;
+    void * buffer;
+
+    /* re-read until no transfer completion happened during the sampling */
+    do {
+        wraps  = hdma->Wraps;
+        flag   = XPD_DMA_GetFlag(hdma, TC);
+        count  = hdma->Inst->CNDTR;
+        buffer = (void*)hdma->Inst->CMAR;
+#ifdef USE_XPD_DMA_ERROR_DETECT
+        /* the remainder of the block is transferred after a recovered error */
+        if (hdma->RecoveryBase != 0)
+        {
+            buffer = (void*)hdma->RecoveryBase;
+        }
+#endif
+    } while ((wraps != hdma->Wraps) || (flag != XPD_DMA_GetFlag(hdma, TC)));
+
+    /* the transfer completion is not yet processed by the interrupt handler */
+    if (flag != 0)
+    {
+        wraps++;
+    }
+
+    if (Buffer != NULL)
+    {
+        *Buffer = buffer;
+    }
+    /* the transfer counter is reloaded after the last element */
+    *Offset = (count < hdma->BlockLength) ? hdma->BlockLength - count : 0;
+
+    return wraps;
+}
+
 /**
  * @brief Polls the status of the DMA transfer.
  * @param hdma: pointer to the DMA stream handle structure
@@ -293,6 +607,7 @@ XPD_ReturnType XPD_DMA_PollStatus(DMA_HandleType * hdma, DMA_OperationType Opera
         {
             /* Update error code */
             hdma->Errors |= DMA_ERROR_TRANSFER;
+            XPD_STATS_ERROR(hdma, DMA_ERROR_TRANSFER);
 
             /* Clear the transfer error flag */
             XPD_DMA_ClearFlag(hdma, TE);
@@ -306,6 +621,11 @@ XPD_ReturnType XPD_DMA_PollStatus(DMA_HandleType * hdma, DMA_OperationType Opera
             if (Operation == DMA_OPERATION_TRANSFER)
             {
                 XPD_DMA_ClearFlag(hdma, TC);
+
+                if (XPD_DMA_CircularMode(hdma) == 0)
+                {
+                    dma_sleepClockCtrl(hdma, DISABLE);
+                }
             }
             XPD_DMA_ClearFlag(hdma, HT);
         }
@@ -320,11 +640,15 @@ XPD_ReturnType XPD_DMA_PollStatus(DMA_HandleType * hdma, DMA_OperationType Opera
  */
 void XPD_DMA_IRQHandler(DMA_HandleType * hdma)
 {
+    XPD_PROFILE_BEGIN();
+    XPD_STATS_IRQ_BEGIN();
+
     /* Half Transfer Complete interrupt management */
     if ((DMA_REG_BIT(hdma,CCR,HTIE) != 0) && (XPD_DMA_GetFlag(hdma, HT) != 0))
     {
         /* clear the half transfer complete flag */
         XPD_DMA_ClearFlag(hdma, HT);
+        XPD_TRACE(XPD_TRACE_DMA_HALF, (uint32_t)hdma->Inst);
 
         /* half transfer callback */
         XPD_SAFE_CALLBACK(hdma->Callbacks.HalfComplete, hdma);
@@ -335,15 +659,28 @@ void XPD_DMA_IRQHandler(DMA_HandleType * hdma)
     {
         /* clear the transfer complete flag */
         XPD_DMA_ClearFlag(hdma, TC);
+        hdma->Wraps++;
+        XPD_STATS_ADD(hdma, Bytes, (uint32_t)hdma->BlockLength << hdma->Inst->CCR.b.PSIZE);
 
-        /* DMA mode is not CIRCULAR */
-        if (XPD_DMA_CircularMode(hdma) == 0)
+        /* continue chained transfer with the next block */
+        if (dma_chainReload(hdma) == 0)
         {
-            CLEAR_BIT(hdma->Inst->CCR.w, DMA_CCR_TCIE | DMA_CCR_HTIE | DMA_CCR_TEIE);
-        }
+#ifdef USE_XPD_DMA_ERROR_DETECT
+            /* the remainder of a recovered circular block is completed */
+            dma_errorRestore(hdma);
+#endif
+            /* DMA mode is not CIRCULAR */
+            if (XPD_DMA_CircularMode(hdma) == 0)
+            {
+                dma_sleepClockCtrl(hdma, DISABLE);
+                CLEAR_BIT(hdma->Inst->CCR.w, DMA_CCR_TCIE | DMA_CCR_HTIE | DMA_CCR_TEIE);
+            }
 
-        /* transfer complete callback */
-        XPD_SAFE_CALLBACK(hdma->Callbacks.Complete, hdma);
+            /* transfer complete callback */
+            XPD_TRACE(XPD_TRACE_DMA_COMPLETE, (uint32_t)hdma->Inst);
+            XPD_STATS_ADD(hdma, Transfers, 1);
+            XPD_SAFE_CALLBACK(hdma->Callbacks.Complete, hdma);
+        }
     }
 
 #ifdef USE_XPD_DMA_ERROR_DETECT
@@ -353,14 +690,404 @@ void XPD_DMA_IRQHandler(DMA_HandleType * hdma)
         /* clear the transfer error flag */
         XPD_DMA_ClearFlag(hdma, TE);
 
-        hdma->Errors |= DMA_ERROR_TRANSFER;
+        /* the transfer is stopped by hardware */
+        XPD_STATS_ERROR(hdma, DMA_ERROR_TRANSFER);
+        XPD_TRACE(XPD_TRACE_DMA_ERROR, (uint32_t)hdma->Inst);
 
-        /* transfer errors callback */
-        XPD_SAFE_CALLBACK(hdma->Callbacks.Error, hdma);
+        /* a circular transfer is continued from the current position if enabled */
+        if (dma_errorRestart(hdma) == 0)
+        {
+            dma_sleepClockCtrl(hdma, DISABLE);
+
+            hdma->Errors |= DMA_ERROR_TRANSFER;
+
+            /* transfer errors callback */
+            XPD_SAFE_CALLBACK(hdma->Callbacks.Error, hdma);
+        }
     }
 #endif
+
+    XPD_STATS_IRQ_END(hdma);
+    XPD_PROFILE_END();
+}
+
+/** @} */
+
+/** @addtogroup DMA_Memory
+ * @{ */
+
+/* Performs a small memory operation with the CPU */
+static void dma_memCpuRun(DMA_MemJobType * job)
+{
+    uint32_t i;
+
+    if (job->DestIncrement != DISABLE)
+    {
+        if (job->Src == NULL)
+        {
+            XPD_MemSet(job->Dest, (uint8_t)job->Pattern, job->Size);
+        }
+        else
+        {
+            XPD_MemCopy(job->Dest, job->Src, job->Size);
+        }
+    }
+    /* A fixed destination register is fed by single accesses */
+    else if (job->Src == NULL)
+    {
+        volatile uint8_t * dest = job->Dest;
+
+        for (i = 0; i < job->Size; i++)
+        {
+            *dest = (uint8_t)job->Pattern;
+        }
+    }
+    else if ((((uint32_t)job->Dest | (uint32_t)job->Src | job->Size) & 3) == 0)
+    {
+        volatile uint32_t * dw = (volatile uint32_t*)job->Dest;
+        const uint32_t * sw = (const uint32_t*)job->Src;
+
+        for (i = 0; i < (job->Size / 4); i++)
+        {
+            *dw = sw[i];
+        }
+    }
+    else
+    {
+        volatile uint8_t * dest = job->Dest;
+
+        for (i = 0; i < job->Size; i++)
+        {
+            *dest = job->Src[i];
+        }
+    }
+    job->Size = 0;
+}
+
+/* Starts the transfer of the next block of the current job */
+static void dma_memStart(DMA_MemEngineType * hmem)
+{
+    DMA_HandleType * hdma = hmem->DMA;
+    DMA_MemJobType * job = hmem->Head;
+    uint32_t addr = (uint32_t)job->Dest | job->Size;
+    uint32_t align, count;
+
+    if (job->Src != NULL)
+    {
+        addr |= (uint32_t)job->Src;
+    }
+
+    /* use the widest data size which all addresses and the size are aligned to */
+    align = ((addr & 3) == 0) ? DMA_ALIGN_WORD : (((addr & 1) == 0) ? DMA_ALIGN_HALFWORD : DMA_ALIGN_BYTE);
+    count = job->Size >> align;
+    if (count > 0xFFFC)
+    {
+        count = 0xFFFC;
+    }
+
+    /* the channel configuration is only writable when the channel is disabled */
+    XPD_DMA_Disable(hdma);
+
+    DMA_REG_BIT(hdma,CCR,PINC)   = (job->Src != NULL) ? 1 : 0;
+    DMA_REG_BIT(hdma,CCR,MINC)   = job->DestIncrement;
+    hdma->Inst->CCR.b.PSIZE      = align;
+    hdma->Inst->CCR.b.MSIZE      = align;
+
+    (void) XPD_DMA_Start_IT(hdma, (job->Src != NULL) ? (void*)job->Src : &job->Pattern,
+            job->Dest, count);
+
+    /* advance the job to the next block */
+    count <<= align;
+    if (job->DestIncrement != DISABLE)
+    {
+        job->Dest += count;
+    }
+    if (job->Src != NULL)
+    {
+        job->Src += count;
+    }
+    job->Size -= count;
+}
+
+/* Removes the current job from the queue, and starts the next one */
+static void dma_memFinish(DMA_MemEngineType * hmem, XPD_ReturnType Status)
+{
+    DMA_MemJobType * job = hmem->Head;
+
+    hmem->Head = job->Next;
+    if (hmem->Head != NULL)
+    {
+        dma_memStart(hmem);
+    }
+
+    /* the job can be reused from the callback */
+    job->Status = Status;
+    XPD_SAFE_CALLBACK(job->Callback, job);
+}
+
+/* DMA transfer complete callback */
+static void dma_memComplete(void * handle)
+{
+    DMA_MemEngineType * hmem = ((DMA_HandleType*)handle)->Owner;
+
+    if (hmem->Head->Size > 0)
+    {
+        dma_memStart(hmem);
+    }
+    else
+    {
+        dma_memFinish(hmem, XPD_OK);
+    }
+}
+
+#ifdef USE_XPD_DMA_ERROR_DETECT
+/* DMA transfer error callback */
+static void dma_memError(void * handle)
+{
+    DMA_MemEngineType * hmem = ((DMA_HandleType*)handle)->Owner;
+
+    dma_memFinish(hmem, XPD_ERROR);
+}
+#endif
+
+/* Queues the job, and starts it if the engine is idle */
+static XPD_ReturnType dma_memSubmit(DMA_MemEngineType * hmem, DMA_MemJobType * job)
+{
+    uint32_t idle;
+
+    job->Next   = NULL;
+    job->Status = XPD_BUSY;
+
+    /* small operations are performed immediately, unless they would overtake queued jobs */
+    if ((job->Size <= hmem->Threshold) && (hmem->Head == NULL))
+    {
+        dma_memCpuRun(job);
+
+        job->Status = XPD_OK;
+        XPD_SAFE_CALLBACK(job->Callback, job);
+    }
+    else
+    {
+        XPD_ENTER_CRITICAL(hmem->DMA);
+
+        idle = hmem->Head == NULL;
+        if (idle)
+        {
+            hmem->Head = job;
+        }
+        else
+        {
+            hmem->Tail->Next = job;
+        }
+        hmem->Tail = job;
+
+        XPD_EXIT_CRITICAL(hmem->DMA);
+
+        if (idle)
+        {
+            dma_memStart(hmem);
+        }
+    }
+    return XPD_OK;
+}
+
+/** @defgroup DMA_Memory_Exported_Functions DMA Memory Operations Exported Functions
+ * @{ */
+
+/**
+ * @brief Initializes the DMA channel of the memory operation engine for memory-to-memory transfers.
+ * @param hmem: pointer to the memory operation engine structure
+ * @return Result of @ref XPD_DMA_Init
+ * @note  The DMA handle's instance has to be set, and its interrupt has to be served
+ *        by @ref XPD_DMA_IRQHandler.
+ */
+XPD_ReturnType XPD_DMA_MemInit(DMA_MemEngineType * hmem)
+{
+    DMA_InitType config = {
+        .Direction = DMA_MEMORY2MEMORY,
+        .Mode      = DMA_MODE_NORMAL,
+        .Priority  = LOW,
+        .Memory    = { .Increment = ENABLE, .DataAlignment = DMA_ALIGN_BYTE },
+        .Peripheral= { .Increment = ENABLE, .DataAlignment = DMA_ALIGN_BYTE },
+    };
+
+    hmem->Head = hmem->Tail = NULL;
+
+    hmem->DMA->Owner = hmem;
+    hmem->DMA->Callbacks.Complete = dma_memComplete;
+#ifdef USE_XPD_DMA_ERROR_DETECT
+    hmem->DMA->Callbacks.Error    = dma_memError;
+#endif
+
+    return XPD_DMA_Init(hmem->DMA, &config);
+}
+
+/**
+ * @brief Copies a memory block in the background, the transfer data size is selected
+ *        according to the common alignment of the addresses and the size.
+ * @param hmem: pointer to the memory operation engine structure
+ * @param Job: pointer to the job structure, which has to remain valid until completion
+ * @param Dest: the destination address
+ * @param Src: the source address
+ * @param Size: the number of bytes to copy
+ * @return OK (the job's Status and Callback indicate completion)
+ * @note  Blocks up to the engine's Threshold size are copied by the CPU from this call.
+ */
+XPD_ReturnType XPD_DMA_MemCpy_IT(DMA_MemEngineType * hmem, DMA_MemJobType * Job,
+        void * Dest, const void * Src, uint32_t Size)
+{
+    Job->Dest    = Dest;
+    Job->Src     = Src;
+    Job->Size    = Size;
+    Job->DestIncrement = ENABLE;
+
+    return dma_memSubmit(hmem, Job);
+}
+
+/**
+ * @brief Fills a memory block with a byte value in the background.
+ * @param hmem: pointer to the memory operation engine structure
+ * @param Job: pointer to the job structure, which has to remain valid until completion
+ * @param Dest: the destination address
+ * @param Value: the fill value
+ * @param Size: the number of bytes to fill
+ * @return OK (the job's Status and Callback indicate completion)
+ * @note  Blocks up to the engine's Threshold size are filled by the CPU from this call.
+ */
+XPD_ReturnType XPD_DMA_MemSet_IT(DMA_MemEngineType * hmem, DMA_MemJobType * Job,
+        void * Dest, uint8_t Value, uint32_t Size)
+{
+    Job->Dest    = Dest;
+    Job->Src     = NULL;
+    Job->Size    = Size;
+    Job->Pattern = Value * 0x01010101;
+    Job->DestIncrement = ENABLE;
+
+    return dma_memSubmit(hmem, Job);
+}
+
+/**
+ * @brief Writes a memory block to a single data register in the background,
+ *        e.g. to feed a peripheral which doesn't generate DMA requests.
+ * @param hmem: pointer to the memory operation engine structure
+ * @param Job: pointer to the job structure, which has to remain valid until completion
+ * @param Register: the address of the destination register
+ * @param Src: the source address
+ * @param Size: the number of bytes to write
+ * @return OK (the job's Status and Callback indicate completion)
+ * @note  The register access width is selected the same way as for @ref XPD_DMA_MemCpy_IT,
+ *        Blocks up to the engine's Threshold size are written by the CPU from this call.
+ */
+XPD_ReturnType XPD_DMA_MemFeed_IT(DMA_MemEngineType * hmem, DMA_MemJobType * Job,
+        volatile void * Register, const void * Src, uint32_t Size)
+{
+    Job->Dest    = (uint8_t*)Register;
+    Job->Src     = Src;
+    Job->Size    = Size;
+    Job->DestIncrement = DISABLE;
+
+    return dma_memSubmit(hmem, Job);
 }
 
 /** @} */
 
 /** @} */
+
+/** @addtogroup DMA_Bridge
+ * @{ */
+
+/* Starts the destination side of the ring bridge when the ring is half filled */
+static void dma_bridgeHalfRedirect(void * handle)
+{
+    DMA_BridgeType * hbr = ((DMA_HandleType*)handle)->Owner;
+
+    XPD_DMA_DisableIT(hbr->Source, HT);
+
+    (void) XPD_DMA_Start(hbr->Destination, (void *)hbr->DestRegister, hbr->Ring, hbr->Length);
+}
+
+/** @addtogroup DMA_Bridge_Exported_Functions
+ * @{ */
+
+/**
+ * @brief Starts the continuous forwarding of the source peripheral data to the destination peripheral.
+ *        The DMA channels are set to circular mode.
+ * @note  In ring mode the DMA interrupt of the source channel has to be enabled in the NVIC,
+ *        as it starts the destination channel once. The ring has the data width of the source
+ *        channel's memory side.
+ * @param hbr: pointer to the DMA bridge structure
+ * @param SrcRegister: pointer to the source peripheral data register
+ * @param DestRegister: pointer to the destination peripheral data register
+ * @param Ring: the RAM ring in ring mode, not used in direct mode
+ * @param Length: the number of elements in the ring (at least 2), not used in direct mode
+ * @return ERROR if the ring is invalid, BUSY if a DMA channel is in use, OK if successful
+ */
+XPD_ReturnType XPD_DMA_Bridge_Start(DMA_BridgeType * hbr, volatile void * SrcRegister,
+        volatile void * DestRegister, void * Ring, uint16_t Length)
+{
+    XPD_ReturnType result;
+    DMA_HandleType * hsrc = hbr->Source;
+
+    XPD_DMA_CircularMode(hsrc) = 1;
+
+    if (hbr->Destination == NULL)
+    {
+        /* The destination register is addressed by the memory side */
+        DMA_REG_BIT(hsrc,CCR,MINC) = 0;
+
+        result = XPD_DMA_Start(hsrc, (void *)SrcRegister, (void *)DestRegister, 0xFFFF);
+    }
+    else if ((Ring == NULL) || (Length < 2))
+    {
+        result = XPD_ERROR;
+    }
+    else if (XPD_DMA_GetStatus(hbr->Destination) != 0)
+    {
+        result = XPD_BUSY;
+    }
+    else
+    {
+        hbr->DestRegister = DestRegister;
+        hbr->Ring         = Ring;
+        hbr->Length       = Length;
+
+        DMA_REG_BIT(hsrc,CCR,MINC) = 1;
+        DMA_REG_BIT(hbr->Destination,CCR,MINC) = 1;
+        XPD_DMA_CircularMode(hbr->Destination) = 1;
+
+        /* Set the callback owner */
+        hsrc->Owner = hbr;
+
+        /* The destination is started by the half transfer interrupt */
+        hsrc->Callbacks.HalfComplete = dma_bridgeHalfRedirect;
+        hsrc->Callbacks.Complete     = NULL;
+
+        result = XPD_DMA_Start(hsrc, (void *)SrcRegister, Ring, Length);
+
+        if (result == XPD_OK)
+        {
+            XPD_DMA_EnableIT(hsrc, HT);
+        }
+    }
+    return result;
+}
+
+/**
+ * @brief Stops the forwarding of the peripheral bridge.
+ * @param hbr: pointer to the DMA bridge structure
+ */
+void XPD_DMA_Bridge_Stop(DMA_BridgeType * hbr)
+{
+    XPD_DMA_Stop_IT(hbr->Source);
+
+    if (hbr->Destination != NULL)
+    {
+        XPD_DMA_Stop_IT(hbr->Destination);
+    }
+}
+
+/** @} */
+
+/** @} */
+
+/** @} */
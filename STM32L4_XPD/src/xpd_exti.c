@@ -24,10 +24,27 @@
 
 #include "xpd_exti.h"
 
-XPD_ValueCallbackType XPD_EXTI_Callbacks[] = {
-        NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL,
-        NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL,
-};
+#define EXTI_LINE_COUNT     41
+
+XPD_ValueCallbackType XPD_EXTI_Callbacks[EXTI_LINE_COUNT];
+
+/* Clears and dispatches the pending lines of an EXTI register */
+static void exti_dispatch(__IO uint32_t * PR, uint32_t Lines, uint8_t Offset)
+{
+    uint32_t pending = *PR & Lines;
+
+    /* clear all served lines with a single write */
+    *PR = pending;
+
+    while (pending != 0)
+    {
+        uint8_t line = POSITION_VAL(pending);
+
+        pending &= pending - 1;
+
+        XPD_SAFE_CALLBACK(XPD_EXTI_Callbacks[Offset + line], Offset + line);
+    }
+}
 
 /** @addtogroup EXTI
  * @{ */
@@ -42,17 +59,14 @@ XPD_ValueCallbackType XPD_EXTI_Callbacks[] = {
  */
 void XPD_EXTI_Init(uint8_t Line, const EXTI_InitType * Config)
 {
-    /* GPIO callbacks only */
-    if (Line < 16)
+    /* The event lines are dispatched by XPD_WaitForEvents */
+    if (Config->Reaction != REACTION_NONE)
     {
-        if (Config->Reaction & REACTION_IT)
-        {
-            XPD_EXTI_Callbacks[Line] = Config->ITCallback;
-        }
-        else
-        {
-            XPD_EXTI_Callbacks[Line] = NULL;
-        }
+        XPD_EXTI_Callbacks[Line] = Config->ITCallback;
+    }
+    else
+    {
+        XPD_EXTI_Callbacks[Line] = NULL;
     }
 
 #ifdef EXTI_BB
@@ -225,6 +239,29 @@ void XPD_EXTI_Deinit(uint8_t Line)
 #endif
 }
 
+/**
+ * @brief EXTI interrupt handler for a range of lines sharing an interrupt vector.
+ *        The pending lines are cleared together, then their callbacks are called
+ *        in ascending line order.
+ * @param FirstLine: the lowest EXTI line served by the interrupt vector
+ * @param LastLine: the highest EXTI line served by the interrupt vector
+ */
+void XPD_EXTI_IRQHandler(uint8_t FirstLine, uint8_t LastLine)
+{
+    if (FirstLine < 32)
+    {
+        uint32_t last = (LastLine < 32) ? LastLine : 31;
+
+        exti_dispatch(&EXTI->PR1, EXTI->IMR1 & (0xFFFFFFFF << FirstLine) & (0xFFFFFFFF >> (31 - last)), 0);
+    }
+    if (LastLine >= 32)
+    {
+        uint32_t first = (FirstLine >= 32) ? (FirstLine - 32) : 0;
+
+        exti_dispatch(&EXTI->PR2, EXTI->IMR2 & (0xFFFFFFFF << first) & (0xFFFFFFFF >> (63 - LastLine)), 32);
+    }
+}
+
 /** @} */
 
 /** @} */
@@ -22,9 +22,821 @@
   *  along with STM32_XPD.  If not, see <http://www.gnu.org/licenses/>.
   */
 #include "xpd_flash.h"
+#include "xpd_pwr.h"
+#include "xpd_syscfg.h"
+#include "xpd_utils.h"
+
+#ifdef USE_XPD_FLASH
+
+/** @addtogroup FLASH
+ * @{ */
+
+/** @addtogroup FLASH_Private_Macros
+ * @{ */
+
+#define FLASH_TIMEOUT_MS        50000 /* 50 s */
+
+#define hflash                  (&xpd_flashHandle)
+
+#define FLASH_PAGE_SIZE         0x800
+#define FLASH_ROW_SIZE          (32 * sizeof(uint64_t))
+
+#ifdef FLASH_CR_MER2
+#define FLASH_CR_MERALL         (FLASH_CR_MER1 | FLASH_CR_MER2)
+/* The physical banks are swapped when the second bank is mapped to the flash base */
+#define FLASH_BANKS_SWAPPED()   (SYSCFG_REG_BIT(MEMRMP,FB_MODE) != 0)
+#else
+#define FLASH_CR_MERALL         (FLASH_CR_MER1)
+#endif
+
+#define FLASH_GETOPERATION()    (FLASH->CR.w & (FLASH_CR_PER | FLASH_CR_MERALL | FLASH_CR_PG | FLASH_CR_FSTPG))
+
+#define FLASH_SR_ERRORS         (FLASH_SR_OPERR | FLASH_SR_PROGERR | FLASH_SR_WRPERR  | \
+                                 FLASH_SR_PGAERR | FLASH_SR_SIZERR | FLASH_SR_PGSERR  | \
+                                 FLASH_SR_MISERR | FLASH_SR_FASTERR)
+
+#ifndef FLASH_KEY1
+#define FLASH_KEY1              0x45670123
+#endif
+#ifndef FLASH_KEY2
+#define FLASH_KEY2              0xCDEF89AB
+#endif
+#ifndef FLASH_OPTKEY1
+#define FLASH_OPTKEY1           0x08192A3B
+#endif
+#ifndef FLASH_OPTKEY2
+#define FLASH_OPTKEY2           0x4C5D6E7F
+#endif
+
+/* Internal variable for context storage */
+static struct
+{
+    uint8_t * Address;
+    const uint8_t * Data;
+    uint32_t Length;
+    volatile FLASH_ErrorType Errors;
+#ifdef USE_XPD_OS
+    XPD_OS_SignalType Signal;
+#endif
+} xpd_flashHandle =
+{
+        .Errors = FLASH_ERROR_NONE,
+};
+
+/* Reads a word from a possibly unaligned source, padding the missing bytes with erased state */
+static uint32_t flash_readWord(const uint8_t * Data, uint32_t Length)
+{
+    uint32_t word = 0xFFFFFFFF;
+    uint32_t i;
+
+    for (i = 0; (i < sizeof(uint32_t)) && (i < Length); i++)
+    {
+        ((uint8_t*)&word)[i] = Data[i];
+    }
+    return word;
+}
+
+/* Erase the next scheduled page */
+static void flash_blockErase(void)
+{
+    uint32_t offset = (uint32_t)hflash->Address - FLASH_BASE;
+
+#ifdef FLASH_BANK_SIZE
+    boolean_t upperBank = offset >= FLASH_BANK_SIZE;
+
+    if (upperBank)
+    {
+        offset -= FLASH_BANK_SIZE;
+    }
+
+    /* The page is selected in the physical bank */
+    FLASH_REG_BIT(CR,BKER) = upperBank != FLASH_BANKS_SWAPPED();
+#endif
+    FLASH->CR.b.PNB = offset / FLASH_PAGE_SIZE;
+
+    /* Proceed to erase the page */
+    FLASH_REG_BIT(CR,PER) = 1;
+    FLASH_REG_BIT(CR,STRT) = 1;
+}
+
+/* Start the mass erase of the selected bank */
+static void flash_bankErase(uint8_t Bank)
+{
+#ifdef FLASH_CR_MER2
+    /* The mass erase is selected by physical bank */
+    if ((Bank == 2) != FLASH_BANKS_SWAPPED())
+    {
+        SET_BIT(FLASH->CR.w, FLASH_CR_MER2);
+    }
+    else
+#endif
+    {
+        SET_BIT(FLASH->CR.w, FLASH_CR_MER1);
+    }
+    FLASH_REG_BIT(CR,STRT) = 1;
+}
+
+/* Program the next double word of data */
+static void flash_unitProgram(void)
+{
+    uint32_t address = (uint32_t)hflash->Address;
+
+    /* Enable flash programming */
+    FLASH_REG_BIT(CR,PG) = 1;
+
+    /* The double word is written by two consecutive word accesses */
+    *((__IO uint32_t *)address)
+            = flash_readWord(&hflash->Data[0], hflash->Length);
+    *((__IO uint32_t *)(address + 4))
+            = flash_readWord(&hflash->Data[4], (hflash->Length > 4) ? (hflash->Length - 4) : 0);
+}
+
+/* Advance the program context after the completed unit */
+static void flash_unitAdvance(uint32_t Size)
+{
+    if (hflash->Length > Size)
+    {
+        hflash->Address += Size;
+        hflash->Data    += Size;
+        hflash->Length  -= Size;
+    }
+    else
+    {
+        hflash->Length = 0;
+    }
+}
+
+/* Read errors to context, and clear them in register */
+static void flash_checkErrors(void)
+{
+    /* Read error flags */
+    hflash->Errors = FLASH->SR.w & FLASH_SR_ERRORS;
+
+    /* Clear error flags */
+    FLASH->SR.w = hflash->Errors;
+}
+
+#ifdef USE_XPD_OS
+/* Waits until the interrupt driven operation is finished */
+static XPD_ReturnType flash_waitBlocking(uint32_t * timeout)
+{
+    XPD_ReturnType result = XPD_OK;
+
+    while ((result == XPD_OK) && (FLASH_GETOPERATION() != FLASH_OPERATION_NONE))
+    {
+        result = XPD_OS_SignalWait(&hflash->Signal, timeout);
+    }
+    if ((result == XPD_OK) && (hflash->Errors != FLASH_ERROR_NONE))
+    {
+        result = XPD_ERROR;
+    }
+    return result;
+}
+#endif
+
+/** @} */
+
+/** @addtogroup FLASH_Exported_Functions
+ * @{ */
+
+/**
+ * @brief Unlock the FLASH control register access.
+ */
+void XPD_FLASH_Unlock(void)
+{
+    if (FLASH_REG_BIT(CR,LOCK) != 0)
+    {
+        /* Authorize the FLASH Registers access */
+        FLASH->KEYR = FLASH_KEY1;
+        FLASH->KEYR = FLASH_KEY2;
+    }
+    CLEAR_BIT(FLASH->CR.w, FLASH_CR_PER | FLASH_CR_MERALL | FLASH_CR_PG | FLASH_CR_FSTPG);
+
+    /* Clear stale flags which would block new operations */
+    FLASH->SR.w = FLASH_SR_EOP | FLASH_SR_ERRORS | FLASH_SR_OPTVERR;
+}
+
+/**
+ * @brief Lock the FLASH control register access.
+ */
+void XPD_FLASH_Lock(void)
+{
+    /* Set the LOCK Bit to lock the FLASH Registers access */
+    FLASH_REG_BIT(CR,LOCK) = 1;
+}
+
+/**
+ * @brief Polls the status of the ongoing FLASH operation.
+ * @param Timeout: the timeout in ms for the polling.
+ * @return ERROR    if there were errors,
+ *         TIMEOUT  if timed out,
+ *         OK       if successful
+ */
+XPD_ReturnType XPD_FLASH_PollStatus(uint32_t Timeout)
+{
+    /* Wait for the FLASH operation to complete by polling on BUSY flag to be reset.
+     Even if the FLASH operation fails, the BUSY flag will be reset and an error
+     flag will be set */
+    XPD_ReturnType result = XPD_WaitForDiff(&FLASH->SR.w,
+            FLASH_SR_BSY, FLASH_SR_BSY, &Timeout);
+
+    /* Check FLASH End of Operation flag  */
+    if (XPD_FLASH_GetFlag(EOP) != 0)
+    {
+        /* Clear FLASH End of Operation pending bit */
+        XPD_FLASH_ClearFlag(EOP);
+    }
+
+    flash_checkErrors();
+    if (hflash->Errors != FLASH_ERROR_NONE)
+    {
+        result = XPD_ERROR;
+    }
+
+    return result;
+}
+
+/**
+ * @brief Programs the input data to the specified flash address.
+ * @note  The FLASH interface should be unlocked beforehand, and locked afterwards.
+ * @note  The flash is programmed by double words, the address has to be aligned to 8 bytes,
+ *        and the last double word is padded with erased (0xFF) bytes.
+ * @param Address: the start flash address to write
+ * @param Data: input data to program
+ * @param Length: amount of bytes to program
+ * @return BUSY     if another operation is already ongoing,
+ *         ERROR    if there were errors,
+ *         TIMEOUT  if timed out,
+ *         OK       if successful
+ */
+XPD_ReturnType XPD_FLASH_Program(void * Address, const void * Data, uint16_t Length)
+{
+    /* Wait for last operation to be completed */
+    XPD_ReturnType result = XPD_FLASH_PollStatus(FLASH_TIMEOUT_MS);
+
+    if (result == XPD_OK)
+    {
+        hflash->Address = Address;
+        hflash->Data    = Data;
+        hflash->Length  = Length;
+
+        while (hflash->Length > 0)
+        {
+            flash_unitProgram();
+
+            /* Wait for last operation to be completed */
+            result = XPD_FLASH_PollStatus(FLASH_TIMEOUT_MS);
+
+            /* Disable flash programming */
+            FLASH_REG_BIT(CR,PG) = 0;
+
+            /* In case of error, stop flash programming */
+            if (result != XPD_OK)
+            {
+                break;
+            }
+
+            flash_unitAdvance(sizeof(uint64_t));
+        }
+    }
+
+    return result;
+}
+
+/**
+ * @brief Programs the input data to the specified flash address in interrupt (non-blocking) mode.
+ * @note  The FLASH interface should be unlocked beforehand, and locked afterwards.
+ * @note  The flash is programmed by double words, the address has to be aligned to 8 bytes,
+ *        and the last double word is padded with erased (0xFF) bytes.
+ * @param Address: the start flash address to write
+ * @param Data: input data to program
+ * @param Length: amount of bytes to program
+ * @return BUSY     if another operation is already ongoing,
+ *         OK       if programming started
+ */
+XPD_ReturnType XPD_FLASH_Program_IT(void * Address, const void * Data, uint16_t Length)
+{
+    XPD_ReturnType result = XPD_BUSY;
+
+    /* Only start if no ongoing operations are present */
+    if ((FLASH_GETOPERATION() == FLASH_OPERATION_NONE) && (Length > 0))
+    {
+        hflash->Address = Address;
+        hflash->Data    = Data;
+        hflash->Length  = Length;
+
+        /* Enable interrupts */
+        SET_BIT(FLASH->CR.w, FLASH_CR_EOPIE | FLASH_CR_ERRIE);
+
+        flash_unitProgram();
+
+        result = XPD_OK;
+    }
+    return result;
+}
+
+/**
+ * @brief Programs the input data to the specified flash address using fast programming,
+ *        which writes rows of 32 double words without verifying each double word.
+ * @note  The FLASH interface should be unlocked beforehand, and locked afterwards.
+ * @note  The bank of the address has to be mass erased beforehand, and HCLK must be
+ *        at least 8 MHz. The address has to be aligned to a row (256 bytes), the data
+ *        after the last full row is programmed by double words.
+ * @note  Interrupts are disabled while a row is written, as the double words
+ *        have to be provided without delay.
+ * @param Address: the start flash address to write
+ * @param Data: input data to program
+ * @param Length: amount of bytes to program
+ * @return BUSY     if another operation is already ongoing,
+ *         ERROR    if there were errors,
+ *         TIMEOUT  if timed out,
+ *         OK       if successful
+ */
+XPD_ReturnType XPD_FLASH_ProgramFast(void * Address, const void * Data, uint16_t Length)
+{
+    /* Wait for last operation to be completed */
+    XPD_ReturnType result = XPD_FLASH_PollStatus(FLASH_TIMEOUT_MS);
+
+    if (result == XPD_OK)
+    {
+        hflash->Address = Address;
+        hflash->Data    = Data;
+        hflash->Length  = Length;
+
+        while (hflash->Length >= FLASH_ROW_SIZE)
+        {
+            __IO uint32_t * dest = (__IO uint32_t *)hflash->Address;
+            uint32_t primask = __get_PRIMASK();
+            uint32_t i;
+
+            /* Enable fast programming */
+            FLASH_REG_BIT(CR,FSTPG) = 1;
+
+            __set_PRIMASK(1);
+
+            for (i = 0; i < FLASH_ROW_SIZE; i += sizeof(uint32_t))
+            {
+                *dest++ = flash_readWord(&hflash->Data[i], sizeof(uint32_t));
+            }
+
+            __set_PRIMASK(primask);
+
+            /* Wait for the row programming to be completed */
+            result = XPD_FLASH_PollStatus(FLASH_TIMEOUT_MS);
+
+            /* Disable fast programming */
+            FLASH_REG_BIT(CR,FSTPG) = 0;
+
+            /* In case of error, stop flash programming */
+            if (result != XPD_OK)
+            {
+                break;
+            }
+
+            flash_unitAdvance(FLASH_ROW_SIZE);
+        }
+
+        /* Program the remaining partial row by double words */
+        if ((result == XPD_OK) && (hflash->Length > 0))
+        {
+            result = XPD_FLASH_Program(hflash->Address, hflash->Data, hflash->Length);
+        }
+    }
+
+    return result;
+}
+
+/**
+ * @brief Performs a mass erase on a flash memory bank.
+ * @note  The FLASH interface should be unlocked beforehand, and locked afterwards.
+ * @param Bank: The selected memory bank [1 .. 2] in address order (only relevant for dual bank devices)
+ * @return BUSY     if another operation is already ongoing,
+ *         ERROR    if there were errors,
+ *         TIMEOUT  if timed out,
+ *         OK       if successful
+ */
+XPD_ReturnType XPD_FLASH_EraseBank(uint8_t Bank)
+{
+    /* Wait for last operation to be completed */
+    XPD_ReturnType result = XPD_FLASH_PollStatus(FLASH_TIMEOUT_MS);
+
+    if (result == XPD_OK)
+    {
+        flash_bankErase(Bank);
+
+        result = XPD_FLASH_PollStatus(FLASH_TIMEOUT_MS);
+
+        CLEAR_BIT(FLASH->CR.w, FLASH_CR_MERALL);
+
+        XPD_FLASH_ResetCaches();
+    }
+
+    return result;
+}
+
+/**
+ * @brief Performs a mass erase on a flash memory bank in interrupt (non-blocking) mode.
+ * @note  The FLASH interface should be unlocked beforehand, and locked afterwards.
+ * @param Bank: The selected memory bank [1 .. 2] in address order (only relevant for dual bank devices)
+ * @return BUSY     if another operation is already ongoing,
+ *         OK       if mass erase started
+ */
+XPD_ReturnType XPD_FLASH_EraseBank_IT(uint8_t Bank)
+{
+    XPD_ReturnType result = XPD_BUSY;
+
+    /* Only start if no ongoing operations are present */
+    if (FLASH_GETOPERATION() == FLASH_OPERATION_NONE)
+    {
+        /* Enable interrupts */
+        SET_BIT(FLASH->CR.w, FLASH_CR_EOPIE | FLASH_CR_ERRIE);
+
+        flash_bankErase(Bank);
+
+        result = XPD_OK;
+    }
+
+    return result;
+}
+
+/**
+ * @brief Performs consecutive page erases in flash.
+ * @note  The FLASH interface should be unlocked beforehand, and locked afterwards.
+ * @param Address: start address of first page to be erased
+ * @param kBytes: amount of flash memory to erase in kilobytes (one page is 2 kB)
+ * @return BUSY     if another operation is already ongoing,
+ *         ERROR    if there were errors,
+ *         TIMEOUT  if timed out,
+ *         OK       if successful
+ */
+XPD_ReturnType XPD_FLASH_Erase(void * Address, uint16_t kBytes)
+{
+    /* Wait for last operation to be completed */
+    XPD_ReturnType result = XPD_FLASH_PollStatus(FLASH_TIMEOUT_MS);
+
+    if (result == XPD_OK)
+    {
+        hflash->Address = Address;
+        hflash->Length  = kBytes;
+
+        /* Keep erasing pages until at least the requested amount */
+        while (hflash->Length > 0)
+        {
+            flash_blockErase();
+
+            /* Wait for last operation to be completed */
+            result = XPD_FLASH_PollStatus(FLASH_TIMEOUT_MS);
+
+            /* If the erase operation is completed, disable the PER Bit */
+            FLASH_REG_BIT(CR,PER) = 0;
+
+            /* In case of error or length underflow, stop erasing */
+            if ((result != XPD_OK) || (hflash->Length <= (FLASH_PAGE_SIZE >> 10)))
+            {
+                break;
+            }
+
+            /* Increase flash address */
+            hflash->Address += FLASH_PAGE_SIZE;
+            hflash->Length  -= FLASH_PAGE_SIZE >> 10;
+        }
+
+        XPD_FLASH_ResetCaches();
+    }
+
+    return result;
+}
+
+/**
+ * @brief Performs consecutive page erases in flash in interrupt (non-blocking) mode.
+ * @note  The FLASH interface should be unlocked beforehand, and locked afterwards.
+ * @param Address: start address of first page to be erased
+ * @param kBytes: amount of flash memory to erase in kilobytes (one page is 2 kB)
+ * @return BUSY     if another operation is already ongoing,
+ *         OK       if page erase started
+ */
+XPD_ReturnType XPD_FLASH_Erase_IT(void * Address, uint16_t kBytes)
+{
+    XPD_ReturnType result = XPD_BUSY;
+
+    /* Only start if no ongoing operations are present */
+    if (FLASH_GETOPERATION() == FLASH_OPERATION_NONE)
+    {
+        hflash->Address = Address;
+        hflash->Length  = kBytes;
+
+        /* Enable interrupts */
+        SET_BIT(FLASH->CR.w, FLASH_CR_EOPIE | FLASH_CR_ERRIE);
+
+        flash_blockErase();
+
+        result = XPD_OK;
+    }
+
+    return result;
+}
+
+#ifdef USE_XPD_OS
+/**
+ * @brief Programs the input data to the specified flash address,
+ *        blocking the calling task until the programming is finished.
+ * @note  The FLASH interface should be unlocked beforehand, and locked afterwards.
+ * @note  Other tasks can only run meanwhile if they don't access the flash bank
+ *        being programmed (e.g. they execute from RAM or from the other bank).
+ * @param Address: the start flash address to write
+ * @param Data: input data to program
+ * @param Length: amount of bytes to program
+ * @param Timeout: available time for the operation in ms
+ * @return BUSY     if another operation is already ongoing,
+ *         ERROR    if there were errors,
+ *         TIMEOUT  if timed out,
+ *         OK       if successful
+ */
+XPD_ReturnType XPD_FLASH_Program_Blocking(void * Address, const void * Data, uint16_t Length, uint32_t Timeout)
+{
+    XPD_ReturnType result;
+
+    XPD_OS_SignalInit(&hflash->Signal);
+
+    result = XPD_FLASH_Program_IT(Address, Data, Length);
+
+    if (result == XPD_OK)
+    {
+        result = flash_waitBlocking(&Timeout);
+    }
+    return result;
+}
+
+/**
+ * @brief Performs consecutive flash erases, blocking the calling task until the erase is finished.
+ * @note  The FLASH interface should be unlocked beforehand, and locked afterwards.
+ * @note  Other tasks can only run meanwhile if they don't access the flash bank
+ *        being erased (e.g. they execute from RAM or from the other bank).
+ * @param Address: start address of first block to be erased
+ * @param kBytes: amount of flash memory to erase in kilobytes
+ * @param Timeout: available time for the operation in ms
+ * @return BUSY     if another operation is already ongoing,
+ *         ERROR    if there were errors,
+ *         TIMEOUT  if timed out,
+ *         OK       if successful
+ */
+XPD_ReturnType XPD_FLASH_Erase_Blocking(void * Address, uint16_t kBytes, uint32_t Timeout)
+{
+    XPD_ReturnType result;
+
+    XPD_OS_SignalInit(&hflash->Signal);
+
+    result = XPD_FLASH_Erase_IT(Address, kBytes);
+
+    if (result == XPD_OK)
+    {
+        result = flash_waitBlocking(&Timeout);
+    }
+    return result;
+}
+#endif /* USE_XPD_OS */
+
+/**
+ * @brief FLASH interrupt handler that manages consecutive page erasing
+ *        and programming, and provides completion and error callbacks.
+ */
+void XPD_FLASH_IRQHandler(void)
+{
+    XPD_PROFILE_BEGIN();
+
+    /* Check FLASH error flags */
+    flash_checkErrors();
+    if (hflash->Errors != FLASH_ERROR_NONE)
+    {
+        /* Stop the operation */
+        hflash->Length = 0;
+        CLEAR_BIT(FLASH->CR.w, FLASH_CR_PER | FLASH_CR_MERALL | FLASH_CR_PG);
+
+        /* Error callback */
+        XPD_SAFE_CALLBACK(XPD_FLASH_Callbacks.Error,);
+    }
+
+    /* Check FLASH End of Operation flag  */
+    if (XPD_FLASH_GetFlag(EOP) != 0)
+    {
+        uint32_t operation = FLASH_GETOPERATION();
+
+        /* Clear FLASH End of Operation pending bit */
+        XPD_FLASH_ClearFlag(EOP);
+
+        /* If the operation completed, disable its control bit */
+        CLEAR_BIT(FLASH->CR.w, operation);
+
+        if ((operation & FLASH_OPERATION_ERASE_BLOCK) != 0)
+        {
+            if (hflash->Length > (FLASH_PAGE_SIZE >> 10))
+            {
+                /* Continue with erasing consecutive pages */
+                hflash->Address += FLASH_PAGE_SIZE;
+                hflash->Length  -= FLASH_PAGE_SIZE >> 10;
+                flash_blockErase();
+            }
+            else
+            {
+                XPD_FLASH_ResetCaches();
+
+                /* provide completion callback */
+                XPD_SAFE_CALLBACK(XPD_FLASH_Callbacks.EraseComplete,);
+            }
+        }
+        else if ((operation & FLASH_CR_MERALL) != 0)
+        {
+            XPD_FLASH_ResetCaches();
+
+            /* provide completion callback */
+            XPD_SAFE_CALLBACK(XPD_FLASH_Callbacks.EraseComplete,);
+        }
+        else if ((operation & FLASH_OPERATION_PROGRAM) != 0)
+        {
+            flash_unitAdvance(sizeof(uint64_t));
+
+            /* Check if there are still data to program */
+            if (hflash->Length > 0)
+            {
+                flash_unitProgram();
+            }
+            else
+            {
+                /* provide completion callback */
+                XPD_SAFE_CALLBACK(XPD_FLASH_Callbacks.ProgramComplete,);
+            }
+        }
+    }
+
+    /* No more pending operations, disable further interrupts */
+    if (FLASH_GETOPERATION() == FLASH_OPERATION_NONE)
+    {
+        CLEAR_BIT(FLASH->CR.w, FLASH_CR_EOPIE | FLASH_CR_ERRIE);
+
+        /* Wake up the waiting task */
+        XPD_OS_SIGNAL(hflash->Signal);
+    }
+
+    XPD_PROFILE_END();
+}
+
+/**
+ * @brief Provides the errors which have occurred during the last operation.
+ * @return The occurred errors
+ */
+FLASH_ErrorType XPD_FLASH_GetError(void)
+{
+    return hflash->Errors;
+}
+
+#ifdef FLASH_OPTR_BFB2
+/**
+ * @brief Determines which physical flash bank is mapped to the flash base address,
+ *        i.e. which bank the device is running from.
+ * @return The active memory bank [1 .. 2]
+ */
+uint8_t XPD_FLASH_GetActiveBank(void)
+{
+    return FLASH_BANKS_SWAPPED() ? 2 : 1;
+}
+
+/**
+ * @brief Swaps the flash banks for the next boot by toggling the dual bank boot option,
+ *        then reloads the option bytes, which resets the device.
+ * @note  The FLASH interface should be unlocked beforehand.
+ * @note  The new image is programmed to @ref FLASH_INACTIVE_BANK_ADDRESS while the application
+ *        keeps running from the active bank, and it should be verified (e.g. by
+ *        @ref XPD_CRC_Calculate) before the swap, as the device boots from it afterwards.
+ * @return BUSY     if another operation is already ongoing,
+ *         ERROR    if the option programming failed,
+ *         TIMEOUT  if timed out,
+ *         otherwise the function doesn't return
+ */
+XPD_ReturnType XPD_FLASH_BankSwap(void)
+{
+    /* Wait for last operation to be completed */
+    XPD_ReturnType result = XPD_FLASH_PollStatus(FLASH_TIMEOUT_MS);
+
+    if (result == XPD_OK)
+    {
+        if (FLASH_REG_BIT(CR,OPTLOCK) != 0)
+        {
+            /* Authorize the option bytes access */
+            FLASH->OPTKEYR = FLASH_OPTKEY1;
+            FLASH->OPTKEYR = FLASH_OPTKEY2;
+        }
+
+        /* Boot from the currently inactive bank */
+        FLASH_REG_BIT(OPTR,BFB2) = !FLASH_BANKS_SWAPPED();
+
+        /* Program the option bytes */
+        FLASH_REG_BIT(CR,OPTSTRT) = 1;
+
+        result = XPD_FLASH_PollStatus(FLASH_TIMEOUT_MS);
+
+        if (result == XPD_OK)
+        {
+            /* Load the new options, which generates a system reset */
+            FLASH_REG_BIT(CR,OBL_LAUNCH) = 1;
+        }
+
+        FLASH_REG_BIT(CR,OPTLOCK) = 1;
+    }
+
+    return result;
+}
+#endif
+
+/** @} */
+
+XPD_FLASH_CallbacksType XPD_FLASH_Callbacks = { NULL, NULL, NULL };
+
+/** @} */
+
+#endif /* USE_XPD_FLASH */
 
 /** @addtogroup FLASH
  * @{ */
 
+/** @addtogroup FLASH_Exported_Functions
+ * @{ */
+
+/**
+ * @brief Determines the minimal flash access latency for the HCLK frequency.
+ * @param HCLK_Frequency: the target AHB clock frequency [Hz]
+ * @return The minimal number of flash wait states
+ */
+uint8_t XPD_FLASH_GetMinLatency(uint32_t HCLK_Frequency)
+{
+    uint8_t latency = 0;
+
+    if (XPD_PWR_GetVoltageScale() == PWR_REGVOLT_SCALE1)
+    {
+        /* Range 1: 16 MHz for each wait state */
+        if (HCLK_Frequency > 16000000)
+        {
+            latency = (HCLK_Frequency - 1) / 16000000;
+        }
+    }
+    else
+    {
+        /* Range 2: 6 MHz for each wait state up to 18 MHz, 26 MHz with 3 WS */
+        if (HCLK_Frequency > 18000000)
+        {
+            latency = 3;
+        }
+        else if (HCLK_Frequency > 6000000)
+        {
+            latency = (HCLK_Frequency - 1) / 6000000;
+        }
+    }
+    return latency;
+}
+
+/**
+ * @brief Resets the enabled flash caches, as they might contain outdated flash data.
+ */
+void XPD_FLASH_ResetCaches(void)
+{
+    if (FLASH_REG_BIT(ACR,ICEN) != 0)
+    {
+        FLASH_REG_BIT(ACR,ICEN)  = 0;
+        FLASH_REG_BIT(ACR,ICRST) = 1;
+        FLASH_REG_BIT(ACR,ICRST) = 0;
+        FLASH_REG_BIT(ACR,ICEN)  = 1;
+    }
+    if (FLASH_REG_BIT(ACR,DCEN) != 0)
+    {
+        FLASH_REG_BIT(ACR,DCEN)  = 0;
+        FLASH_REG_BIT(ACR,DCRST) = 1;
+        FLASH_REG_BIT(ACR,DCRST) = 0;
+        FLASH_REG_BIT(ACR,DCEN)  = 1;
+    }
+}
+
+/**
+ * @brief Sets the new state for the flash accelerator: the prefetch buffer,
+ *        the instruction and the data caches. The caches are reset before enabling.
+ * @param NewState: the new state
+ */
+void XPD_FLASH_AcceleratorCtrl(FunctionalState NewState)
+{
+    FLASH_REG_BIT(ACR,ICEN) = 0;
+    FLASH_REG_BIT(ACR,DCEN) = 0;
+
+    if (NewState != DISABLE)
+    {
+        FLASH_REG_BIT(ACR,ICRST) = 1;
+        FLASH_REG_BIT(ACR,ICRST) = 0;
+        FLASH_REG_BIT(ACR,DCRST) = 1;
+        FLASH_REG_BIT(ACR,DCRST) = 0;
+
+        FLASH_REG_BIT(ACR,ICEN) = 1;
+        FLASH_REG_BIT(ACR,DCEN) = 1;
+    }
+    FLASH_REG_BIT(ACR,PRFTEN) = NewState;
+}
+
+/** @} */
 
 /** @} */
@@ -0,0 +1,745 @@
+/**
+  ******************************************************************************
+  * @file    xpd_i2c.c
+  * @author  Benedek Kupper
+  * @version V0.1
+  * @date    2018-01-20
+  * @brief   STM32 eXtensible Peripheral Drivers I2C Module
+  *
+  *  This file is part of STM32_XPD.
+  *
+  *  STM32_XPD is free software: you can redistribute it and/or modify
+  *  it under the terms of the GNU General Public License as published by
+  *  the Free Software Foundation, either version 3 of the License, or
+  *  (at your option) any later version.
+  *
+  *  STM32_XPD is distributed in the hope that it will be useful,
+  *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with STM32_XPD.  If not, see <http://www.gnu.org/licenses/>.
+  */
+#include "xpd_i2c.h"
+#include "xpd_utils.h"
+
+#if defined(USE_XPD_I2C)
+
+/** @addtogroup I2C
+ * @{ */
+
+#define I2C_PHASE_REGISTER      0   /* The register address is transmitted */
+#define I2C_PHASE_DATA          1   /* The data bytes are transferred */
+
+#define I2C_PENDING_BUS         1   /* The bus transfer is ongoing */
+#define I2C_PENDING_DMA         2   /* The DMA transfer is ongoing */
+
+#define I2C_MAX_NBYTES          255
+
+/* The delay of the analog noise filter in ns */
+#define I2C_ANALOG_FILTER_DELAY 50
+
+/* Converts a duration in ns to the rounded up number of periods of a clock given in kHz */
+#define I2C_NS_TO_TICKS(NS, KHZ)    ((((NS) * (KHZ)) + 999999) / 1000000)
+
+/* The bus characteristics of the I2C speed modes, the durations are in ns */
+static const struct {
+    uint32_t MaxFreq;   /* Maximal SCL frequency in Hz */
+    uint16_t LowMin;    /* Minimal SCL low period */
+    uint16_t HighMin;   /* Minimal SCL high period */
+    uint16_t SetupMin;  /* Minimal data setup time */
+    uint16_t FallMax;   /* Maximal signal fall time */
+    uint16_t RiseMax;   /* Maximal signal rise time */
+} i2c_modes[] = {
+    {  100000, 4700, 4000, 250, 300, 1000 }, /* Standard-mode */
+    {  400000, 1300,  600, 100, 300,  300 }, /* Fast-mode */
+    { 1000000,  500,  260,  50, 120,  120 }, /* Fast-mode Plus */
+};
+
+#define I2C_MODE_COUNT  (sizeof(i2c_modes) / sizeof(i2c_modes[0]))
+
+/* Calculates the bus timing for the current kernel clock and the configured noise filters */
+static XPD_ReturnType i2c_setTiming(I2C_HandleType * hi2c)
+{
+    XPD_ReturnType result = XPD_ERROR;
+    uint32_t clk    = XPD_I2C_GetClockFreq(hi2c);
+    uint32_t dnf    = hi2c->Inst->CR1.b.DNF;
+    uint32_t filter = (I2C_REG_BIT(hi2c, CR1, ANFOFF) == 0) ? I2C_ANALOG_FILTER_DELAY : 0;
+    uint32_t mode, presc;
+
+    /* Select the slowest speed mode which allows the requested frequency */
+    mode = 0;
+    while ((mode < I2C_MODE_COUNT) && (hi2c->BusFreq > i2c_modes[mode].MaxFreq))
+    {
+        mode++;
+    }
+
+    /* Find the finest timing prescaler which fits the periods in the register fields */
+    for (presc = 0; (mode < I2C_MODE_COUNT) && (hi2c->BusFreq > 0) && (presc < 16); presc++)
+    {
+        uint32_t pclk   = clk / (presc + 1);
+        uint32_t khz    = pclk / 1000;
+        uint32_t period = (pclk + hi2c->BusFreq - 1) / hi2c->BusFreq;
+        /* Both SCL edges are resynchronized through the digital filter and 3 kernel clocks */
+        uint32_t sync   = (2 * (dnf + 3) + presc) / (presc + 1);
+        uint32_t low    = I2C_NS_TO_TICKS(i2c_modes[mode].LowMin, khz);
+        uint32_t high   = I2C_NS_TO_TICKS(i2c_modes[mode].HighMin, khz);
+        uint32_t hold   = I2C_NS_TO_TICKS(i2c_modes[mode].FallMax - filter, khz);
+        uint32_t setup  = I2C_NS_TO_TICKS(i2c_modes[mode].RiseMax + i2c_modes[mode].SetupMin, khz) - 1;
+
+        /* SDA is changed only after the falling SCL passed the filters */
+        hold = (hold > ((dnf + 3) / (presc + 1))) ? (hold - ((dnf + 3) / (presc + 1))) : 0;
+
+        if (period > (2 * 256 + sync))
+        {
+            continue;
+        }
+
+        /* The rest of the period is distributed to the levels proportionally */
+        if (period > (low + high + sync))
+        {
+            uint32_t rest = period - (low + high + sync);
+            uint32_t restLow = (rest * i2c_modes[mode].LowMin)
+                    / (i2c_modes[mode].LowMin + i2c_modes[mode].HighMin);
+
+            low  += restLow;
+            high += rest - restLow;
+        }
+
+        if ((low <= 256) && (high <= 256) && (hold <= 15) && (setup <= 15))
+        {
+            hi2c->Inst->TIMINGR.w = (presc  << I2C_TIMINGR_PRESC_Pos)
+                                  | (setup  << I2C_TIMINGR_SCLDEL_Pos)
+                                  | (hold   << I2C_TIMINGR_SDADEL_Pos)
+                                  | ((high - 1) << I2C_TIMINGR_SCLH_Pos)
+                                  | ((low  - 1) << I2C_TIMINGR_SCLL_Pos);
+            result = XPD_OK;
+            break;
+        }
+    }
+    return result;
+}
+
+/* Returns the SYSCFG Fast-mode Plus driving capability flag of the I2C instance */
+static uint32_t i2c_fastModePlusFlag(I2C_HandleType * hi2c)
+{
+    switch ((uint32_t)hi2c->Inst)
+    {
+#if   defined(SYSCFG_CFGR1_I2C_FMP_I2C1)
+        case I2C1_BASE:
+            return SYSCFG_CFGR1_I2C_FMP_I2C1;
+#elif defined(SYSCFG_CFGR1_I2C1_FMP)
+        case I2C1_BASE:
+            return SYSCFG_CFGR1_I2C1_FMP;
+#endif
+#if   defined(SYSCFG_CFGR1_I2C_FMP_I2C2)
+        case I2C2_BASE:
+            return SYSCFG_CFGR1_I2C_FMP_I2C2;
+#elif defined(SYSCFG_CFGR1_I2C2_FMP)
+        case I2C2_BASE:
+            return SYSCFG_CFGR1_I2C2_FMP;
+#endif
+#if   defined(SYSCFG_CFGR1_I2C3_FMP)
+        case I2C3_BASE:
+            return SYSCFG_CFGR1_I2C3_FMP;
+#endif
+        default:
+            return 0;
+    }
+}
+
+/* Calculates the NBYTES, RELOAD and AUTOEND settings of the next transfer chunk */
+static uint32_t i2c_nextChunk(I2C_HandleType * hi2c)
+{
+    I2C_TransactionType * transaction = hi2c->Queue.Head;
+    uint32_t count = hi2c->Remaining;
+    uint32_t cr2;
+
+    if (count > I2C_MAX_NBYTES)
+    {
+        count = I2C_MAX_NBYTES;
+        cr2 = I2C_CR2_RELOAD;
+    }
+    /* The last transfer of the transaction ends with STOP if no other transaction is queued,
+     * otherwise the bus is held until the next transaction's repeated START */
+    else if (((hi2c->Phase == I2C_PHASE_DATA) || (transaction->Direction == I2C_DIRECTION_WRITE))
+            && (transaction->Next == NULL))
+    {
+        cr2 = I2C_CR2_AUTOEND;
+    }
+    else
+    {
+        cr2 = 0;
+    }
+    hi2c->Remaining -= count;
+
+    return cr2 | (count << I2C_CR2_NBYTES_Pos);
+}
+
+/* Generates the (repeated) START condition of a new bus transfer */
+static void i2c_transferStart(I2C_HandleType * hi2c, I2C_DirectionType Direction, uint32_t Count)
+{
+    uint32_t cr2 = (hi2c->Queue.Head->Address << 1) | I2C_CR2_START;
+
+    if (Direction == I2C_DIRECTION_READ)
+    {
+        cr2 |= I2C_CR2_RD_WRN;
+    }
+    hi2c->Remaining = Count;
+
+    hi2c->Inst->CR2.w = cr2 | i2c_nextChunk(hi2c);
+}
+
+static void i2c_queueFinish(I2C_HandleType * hi2c);
+
+/* Completes an event of the transaction, finishes it when nothing else is pending */
+static void i2c_eventDone(I2C_HandleType * hi2c, uint8_t Event)
+{
+    XPD_AtomicClearBits(&hi2c->Pending, Event);
+
+    if ((hi2c->Pending == 0) || ((Event == I2C_PENDING_BUS) && (hi2c->Errors != I2C_ERROR_NONE)))
+    {
+        i2c_queueFinish(hi2c);
+    }
+}
+
+static void i2c_dmaRedirect(void * hdma)
+{
+    I2C_HandleType * hi2c = (I2C_HandleType*) ((DMA_HandleType*) hdma)->Owner;
+
+    /* Disable DMA Requests */
+    CLEAR_BIT(hi2c->Inst->CR1.w, I2C_CR1_TXDMAEN | I2C_CR1_RXDMAEN);
+
+    i2c_eventDone(hi2c, I2C_PENDING_DMA);
+}
+
+#ifdef USE_XPD_DMA_ERROR_DETECT
+static void i2c_dmaErrorRedirect(void * hdma)
+{
+    I2C_HandleType * hi2c = (I2C_HandleType*) ((DMA_HandleType*) hdma)->Owner;
+
+    hi2c->Errors |= I2C_ERROR_DMA;
+    XPD_STATS_ERROR(hi2c, I2C_ERROR_DMA);
+
+    /* Abort the bus transfer, the transaction is finished at STOP detection */
+    I2C_REG_BIT(hi2c, CR2, STOP) = 1;
+}
+#endif
+
+/* Sets up the data transfer of the transaction, using DMA when available */
+static void i2c_dataStart(I2C_HandleType * hi2c)
+{
+    I2C_TransactionType * transaction = hi2c->Queue.Head;
+    DMA_HandleType * hdma;
+    volatile uint32_t * reg;
+    uint32_t enable;
+
+    hi2c->Phase = I2C_PHASE_DATA;
+
+    if (transaction->Direction == I2C_DIRECTION_READ)
+    {
+        hdma   = hi2c->DMA.Receive;
+        reg    = &hi2c->Inst->RXDR;
+        enable = I2C_CR1_RXDMAEN;
+    }
+    else
+    {
+        hdma   = hi2c->DMA.Transmit;
+        reg    = &hi2c->Inst->TXDR;
+        enable = I2C_CR1_TXDMAEN;
+    }
+
+    if (transaction->Length == 0)
+    {
+        /* Nothing to transfer */
+    }
+    else if ((hdma != NULL) && (XPD_DMA_Start_IT(hdma, (void*)reg, transaction->Data,
+            transaction->Length) == XPD_OK))
+    {
+        /* Set the callback owner */
+        hdma->Owner = hi2c;
+
+        /* Set the DMA transfer callbacks */
+        hdma->Callbacks.Complete     = i2c_dmaRedirect;
+#ifdef USE_XPD_DMA_ERROR_DETECT
+        hdma->Callbacks.Error        = i2c_dmaErrorRedirect;
+#endif
+        XPD_AtomicSetBits(&hi2c->Pending, I2C_PENDING_DMA);
+
+        SET_BIT(hi2c->Inst->CR1.w, enable);
+    }
+    else
+    {
+        /* Interrupt driven transfer */
+        hi2c->Stream.buffer = transaction->Data;
+        hi2c->Stream.length = transaction->Length;
+        hi2c->Stream.size   = 1;
+
+        SET_BIT(hi2c->Inst->CR1.w, (transaction->Direction == I2C_DIRECTION_READ) ?
+                I2C_CR1_RXIE : I2C_CR1_TXIE);
+    }
+}
+
+/* Starts the first queued transaction */
+static void i2c_queueStart(I2C_HandleType * hi2c)
+{
+    I2C_TransactionType * transaction = hi2c->Queue.Head;
+
+    hi2c->Errors  = I2C_ERROR_NONE;
+    hi2c->Pending = I2C_PENDING_BUS;
+
+    SET_BIT(hi2c->Inst->CR1.w, I2C_CR1_TCIE);
+
+    if (transaction->RegSize > 0)
+    {
+        uint32_t i;
+
+        /* The register address is transmitted MSB first by interrupts */
+        for (i = 0; i < transaction->RegSize; i++)
+        {
+            hi2c->RegBuffer[i] = (uint8_t)(transaction->Register >> (8 * (transaction->RegSize - 1 - i)));
+        }
+        hi2c->Phase         = I2C_PHASE_REGISTER;
+        hi2c->Stream.buffer = hi2c->RegBuffer;
+        hi2c->Stream.length = transaction->RegSize;
+        hi2c->Stream.size   = 1;
+
+        SET_BIT(hi2c->Inst->CR1.w, I2C_CR1_TXIE);
+
+        /* Written data directly follows the register address,
+         * read data is preceded by a repeated START */
+        i2c_transferStart(hi2c, I2C_DIRECTION_WRITE, transaction->RegSize +
+                ((transaction->Direction == I2C_DIRECTION_WRITE) ? transaction->Length : 0));
+    }
+    else
+    {
+        i2c_dataStart(hi2c);
+
+        i2c_transferStart(hi2c, transaction->Direction, transaction->Length);
+    }
+}
+
+/* Finishes the ongoing transaction and starts the next queued one */
+static void i2c_queueFinish(I2C_HandleType * hi2c)
+{
+    I2C_TransactionType * transaction = hi2c->Queue.Head;
+
+    /* Stop the data transfer */
+    CLEAR_BIT(hi2c->Inst->CR1.w, I2C_CR1_TXIE | I2C_CR1_RXIE | I2C_CR1_TXDMAEN | I2C_CR1_RXDMAEN);
+    if ((hi2c->Pending & I2C_PENDING_DMA) != 0)
+    {
+        XPD_DMA_Stop_IT((transaction->Direction == I2C_DIRECTION_READ) ?
+                hi2c->DMA.Receive : hi2c->DMA.Transmit);
+    }
+    hi2c->Pending = 0;
+
+    /* Flush the data which wasn't transmitted */
+    hi2c->Inst->ISR.w = I2C_ISR_TXE;
+
+    transaction->Errors = hi2c->Errors;
+    if (hi2c->Errors == I2C_ERROR_NONE)
+    {
+        XPD_STATS_ADD(hi2c, Bytes, transaction->Length);
+        XPD_STATS_ADD(hi2c, Transfers, 1);
+        transaction->Result = XPD_OK;
+    }
+    else
+    {
+        XPD_SAFE_CALLBACK(hi2c->Callbacks.Error, hi2c);
+        transaction->Result = XPD_ERROR;
+    }
+
+    XPD_ENTER_CRITICAL(hi2c);
+
+    /* Remove the finished transaction from the queue */
+    hi2c->Queue.Head = transaction->Next;
+    if (hi2c->Queue.Head == NULL)
+    {
+        hi2c->Queue.Tail = NULL;
+    }
+
+    XPD_EXIT_CRITICAL(hi2c);
+
+    /* Continue with the next transaction by repeated START */
+    if (hi2c->Queue.Head != NULL)
+    {
+        i2c_queueStart(hi2c);
+    }
+    /* Release the bus if it is still held */
+    else if (XPD_I2C_GetFlag(hi2c, TC) != 0)
+    {
+        I2C_REG_BIT(hi2c, CR2, STOP) = 1;
+    }
+
+    XPD_SAFE_CALLBACK(transaction->Complete, transaction);
+}
+
+#ifdef USE_XPD_OS
+/* Wakes up the task waiting for the finished transaction */
+static void i2c_blockingRedirect(void * transaction)
+{
+    XPD_OS_SIGNAL(((I2C_TransactionType*)transaction)->Signal);
+}
+#endif
+
+/** @defgroup I2C_Exported_Functions I2C Exported Functions
+ * @{ */
+
+/**
+ * @brief Initializes the I2C peripheral as bus master using the setup configuration.
+ * @note  The bus timing is calculated from the current I2C clock frequency.
+ *        The resulting serial clock frequency doesn't exceed the requested one.
+ *        The SYSCFG clock has to be enabled for Fast-mode Plus operation.
+ * @param hi2c: pointer to the I2C handle structure
+ * @param Config: I2C setup configuration
+ * @return ERROR if the bus frequency cannot be set up, OK if success
+ */
+XPD_ReturnType XPD_I2C_Init(I2C_HandleType * hi2c, const I2C_InitType * Config)
+{
+    XPD_ReturnType result;
+    uint32_t fmp;
+
+    /* enable clock */
+    XPD_SAFE_CALLBACK(hi2c->ClockCtrl, ENABLE);
+
+    XPD_I2C_Disable(hi2c);
+
+    /* Noise filters are taken into account for the timing */
+    I2C_REG_BIT(hi2c, CR1, ANFOFF) = (Config->AnalogFilter == DISABLE) ? 1 : 0;
+    hi2c->Inst->CR1.b.DNF          = Config->DigitalFilter;
+
+    hi2c->BusFreq = Config->BusFreq;
+    result = i2c_setTiming(hi2c);
+
+    /* Fast-mode Plus requires increased driving capability */
+    fmp = i2c_fastModePlusFlag(hi2c);
+    if (Config->BusFreq > i2c_modes[1].MaxFreq)
+    {
+        SET_BIT(SYSCFG->CFGR1.w, fmp);
+    }
+    else
+    {
+        CLEAR_BIT(SYSCFG->CFGR1.w, fmp);
+    }
+
+    /* Master operation only */
+    hi2c->Inst->OAR1.w = 0;
+    hi2c->Inst->OAR2.w = 0;
+    hi2c->Inst->CR2.w  = 0;
+
+    /* The bus events are interrupt driven */
+    SET_BIT(hi2c->Inst->CR1.w, I2C_CR1_STOPIE | I2C_CR1_NACKIE | I2C_CR1_ERRIE);
+
+    /* Initialize handle variables */
+    hi2c->Queue.Head = hi2c->Queue.Tail = NULL;
+    hi2c->Pending    = 0;
+
+    /* Dependencies initialization */
+    XPD_SAFE_CALLBACK(hi2c->Callbacks.DepInit, hi2c);
+
+    XPD_I2C_Enable(hi2c);
+
+    return result;
+}
+
+/**
+ * @brief Restores the I2C peripheral to its default inactive state.
+ * @param hi2c: pointer to the I2C handle structure
+ * @return OK
+ */
+XPD_ReturnType XPD_I2C_Deinit(I2C_HandleType * hi2c)
+{
+    XPD_I2C_Disable(hi2c);
+
+    CLEAR_BIT(SYSCFG->CFGR1.w, i2c_fastModePlusFlag(hi2c));
+
+    /* Deinitialize peripheral dependencies */
+    XPD_SAFE_CALLBACK(hi2c->Callbacks.DepDeinit, hi2c);
+
+    /* Disable clock */
+    XPD_SAFE_CALLBACK(hi2c->ClockCtrl, DISABLE);
+
+    return XPD_OK;
+}
+
+/**
+ * @brief Enables the I2C peripheral.
+ * @param hi2c: pointer to the I2C handle structure
+ */
+void XPD_I2C_Enable(I2C_HandleType * hi2c)
+{
+    I2C_REG_BIT(hi2c, CR1, PE) = 1;
+}
+
+/**
+ * @brief Disables the I2C peripheral.
+ * @param hi2c: pointer to the I2C handle structure
+ */
+void XPD_I2C_Disable(I2C_HandleType * hi2c)
+{
+    I2C_REG_BIT(hi2c, CR1, PE) = 0;
+}
+
+/**
+ * @brief Determines the current status of I2C peripheral.
+ * @param hi2c: pointer to the I2C handle structure
+ * @return BUSY if a transaction is queued or the bus is busy, OK if I2C is ready for new transfer
+ */
+XPD_ReturnType XPD_I2C_GetStatus(I2C_HandleType * hi2c)
+{
+    return ((hi2c->Queue.Head != NULL) || (XPD_I2C_GetFlag(hi2c, BUSY) != 0)) ? XPD_BUSY : XPD_OK;
+}
+
+/**
+ * @brief Adds a transaction to the I2C bus queue. The queued transactions are performed
+ *        one after the other, each ended with a repeated START if another one is queued.
+ *        When the RegSize is set, the register address is transmitted first,
+ *        followed by the written data, or a repeated START and the read data.
+ *        The data is transferred by DMA if the handle has a DMA handle for the direction,
+ *        otherwise by interrupts. The Complete callback of the transaction is called when
+ *        its transfer is finished.
+ * @note  The transaction structure must remain valid until its Complete callback.
+ *        The I2C and DMA interrupts have to be configured with the same priority.
+ *        The queue can be used by multiple drivers if XPD_ENTER_CRITICAL provides mutual exclusion.
+ * @param hi2c: pointer to the I2C handle structure
+ * @param Transaction: pointer to the transaction to queue
+ * @return ERROR if the register address is too long, BUSY if the transaction is queued after others,
+ *         otherwise OK
+ */
+XPD_ReturnType XPD_I2C_Queue_Submit(I2C_HandleType * hi2c, I2C_TransactionType * Transaction)
+{
+    XPD_ReturnType result = XPD_ERROR;
+    I2C_TransactionType * tail;
+
+    if (Transaction->RegSize <= sizeof(hi2c->RegBuffer))
+    {
+        Transaction->Next   = NULL;
+        Transaction->Result = XPD_BUSY;
+        Transaction->Errors = I2C_ERROR_NONE;
+
+        XPD_ENTER_CRITICAL(hi2c);
+
+        tail = hi2c->Queue.Tail;
+        if (tail != NULL)
+        {
+            tail->Next = Transaction;
+        }
+        else
+        {
+            hi2c->Queue.Head = Transaction;
+        }
+        hi2c->Queue.Tail = Transaction;
+
+#ifdef USE_XPD_STATISTICS
+        {
+            I2C_TransactionType * queued;
+            uint16_t depth = 0;
+
+            for (queued = hi2c->Queue.Head; queued != NULL; queued = queued->Next)
+            {
+                depth++;
+            }
+            XPD_STATS_MAX(hi2c, QueueHighWater, depth);
+        }
+#endif
+
+        XPD_EXIT_CRITICAL(hi2c);
+
+        /* The bus is idle, start the transaction now */
+        if (tail == NULL)
+        {
+            i2c_queueStart(hi2c);
+
+            result = XPD_OK;
+        }
+        else
+        {
+            result = XPD_BUSY;
+        }
+    }
+    return result;
+}
+
+#ifdef USE_XPD_OS
+/**
+ * @brief Performs a transaction through the I2C bus queue, blocking the calling task
+ *        until the transaction is finished.
+ * @note  The Complete callback of the transaction is used by this function.
+ *        If the function times out, the transaction remains queued, and its structure
+ *        must remain valid until its Result is no longer BUSY.
+ * @param hi2c: pointer to the I2C handle structure
+ * @param Transaction: pointer to the transaction to perform
+ * @param Timeout: available time for the queued and the own transfers in ms
+ * @return ERROR if the register address is too long or the transaction failed,
+ *         TIMEOUT if timed out, OK if the transaction is successful
+ */
+XPD_ReturnType XPD_I2C_Transfer_Blocking(I2C_HandleType * hi2c, I2C_TransactionType * Transaction,
+        uint32_t Timeout)
+{
+    XPD_ReturnType result;
+
+    Transaction->Complete = i2c_blockingRedirect;
+    XPD_OS_SignalInit(&Transaction->Signal);
+
+    result = XPD_I2C_Queue_Submit(hi2c, Transaction);
+
+    if (result != XPD_ERROR)
+    {
+        result = XPD_OS_SignalWait(&Transaction->Signal, &Timeout);
+        if (result == XPD_OK)
+        {
+            result = Transaction->Result;
+        }
+    }
+    return result;
+}
+#endif /* USE_XPD_OS */
+
+/**
+ * @brief I2C transfer event and error interrupt handler that drives the transaction queue.
+ * @note  On devices with separate event and error interrupt lines it shall be called from both.
+ * @param hi2c: pointer to the I2C handle structure
+ */
+void XPD_I2C_IRQHandler(I2C_HandleType * hi2c)
+{
+    XPD_PROFILE_BEGIN();
+    XPD_STATS_IRQ_BEGIN();
+
+    uint32_t cr1 = hi2c->Inst->CR1.w;
+    uint32_t isr = hi2c->Inst->ISR.w;
+
+    /* Interrupt driven transmission */
+    if (((isr & I2C_ISR_TXIS) != 0) && ((cr1 & I2C_CR1_TXIE) != 0))
+    {
+        XPD_WriteFromStream(&hi2c->Inst->TXDR, &hi2c->Stream);
+
+        if (hi2c->Stream.length == 0)
+        {
+            CLEAR_BIT(hi2c->Inst->CR1.w, I2C_CR1_TXIE);
+
+            /* The written data follows the register address */
+            if ((hi2c->Phase == I2C_PHASE_REGISTER)
+                    && (hi2c->Queue.Head->Direction == I2C_DIRECTION_WRITE))
+            {
+                i2c_dataStart(hi2c);
+            }
+        }
+    }
+
+    /* Interrupt driven reception */
+    if (((isr & I2C_ISR_RXNE) != 0) && ((cr1 & I2C_CR1_RXIE) != 0))
+    {
+        XPD_ReadToStream(&hi2c->Inst->RXDR, &hi2c->Stream);
+
+        if (hi2c->Stream.length == 0)
+        {
+            CLEAR_BIT(hi2c->Inst->CR1.w, I2C_CR1_RXIE);
+        }
+    }
+
+    /* The next chunk of a long transfer */
+    if ((isr & I2C_ISR_TCR) != 0)
+    {
+        MODIFY_REG(hi2c->Inst->CR2.w, I2C_CR2_NBYTES | I2C_CR2_RELOAD | I2C_CR2_AUTOEND,
+                i2c_nextChunk(hi2c));
+    }
+
+    /* The bus is held after the transfer */
+    if (((isr & I2C_ISR_TC) != 0) && ((cr1 & I2C_CR1_TCIE) != 0))
+    {
+        if (hi2c->Phase == I2C_PHASE_REGISTER)
+        {
+            /* Read the data after the register address */
+            i2c_dataStart(hi2c);
+
+            i2c_transferStart(hi2c, I2C_DIRECTION_READ, hi2c->Queue.Head->Length);
+        }
+        else
+        {
+            /* The flag remains set until the next START */
+            CLEAR_BIT(hi2c->Inst->CR1.w, I2C_CR1_TCIE);
+
+            i2c_eventDone(hi2c, I2C_PENDING_BUS);
+        }
+    }
+
+    /* The slave didn't acknowledge, STOP is generated automatically */
+    if ((isr & I2C_ISR_NACKF) != 0)
+    {
+        XPD_I2C_ClearFlag(hi2c, NACK);
+
+        hi2c->Errors |= I2C_ERROR_NACK;
+        XPD_STATS_ERROR(hi2c, I2C_ERROR_NACK);
+    }
+
+    if ((isr & I2C_ISR_OVR) != 0)
+    {
+        XPD_I2C_ClearFlag(hi2c, OVR);
+
+        hi2c->Errors |= I2C_ERROR_OVERRUN;
+        XPD_STATS_ERROR(hi2c, I2C_ERROR_OVERRUN);
+
+        /* Abort the transfer */
+        I2C_REG_BIT(hi2c, CR2, STOP) = 1;
+    }
+
+    /* The bus is released by STOP or by the loss of control */
+    if ((isr & (I2C_ISR_BERR | I2C_ISR_ARLO | I2C_ISR_STOPF)) != 0)
+    {
+        if ((isr & I2C_ISR_BERR) != 0)
+        {
+            XPD_I2C_ClearFlag(hi2c, BERR);
+
+            hi2c->Errors |= I2C_ERROR_BUS;
+            XPD_STATS_ERROR(hi2c, I2C_ERROR_BUS);
+        }
+        if ((isr & I2C_ISR_ARLO) != 0)
+        {
+            XPD_I2C_ClearFlag(hi2c, ARLO);
+
+            hi2c->Errors |= I2C_ERROR_ARBITRATION;
+            XPD_STATS_ERROR(hi2c, I2C_ERROR_ARBITRATION);
+        }
+        if ((isr & I2C_ISR_STOPF) != 0)
+        {
+            XPD_I2C_ClearFlag(hi2c, STOP);
+        }
+
+        if ((hi2c->Pending & I2C_PENDING_BUS) != 0)
+        {
+            i2c_eventDone(hi2c, I2C_PENDING_BUS);
+        }
+    }
+
+    XPD_STATS_IRQ_END(hi2c);
+    XPD_PROFILE_END();
+}
+
+/**
+ * @brief Recalculates the bus timing for the current I2C clock frequency,
+ *        the new serial clock frequency doesn't exceed the one of the initial setup.
+ * @note  It can be registered as RCC clock change listener callback.
+ *        It shouldn't be called during communication.
+ * @param hi2c: pointer to the I2C handle structure
+ * @return ERROR if the bus frequency cannot be set up, OK if success
+ */
+XPD_ReturnType XPD_I2C_ClockUpdate(I2C_HandleType * hi2c)
+{
+    XPD_ReturnType result;
+
+    /* The timing can only be changed when the peripheral is disabled */
+    XPD_I2C_Disable(hi2c);
+
+    result = i2c_setTiming(hi2c);
+
+    XPD_I2C_Enable(hi2c);
+
+    return result;
+}
+
+/** @} */
+
+/** @} */
+
+#endif /* USE_XPD_I2C */
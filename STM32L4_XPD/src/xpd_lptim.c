@@ -0,0 +1,251 @@
+/**
+  ******************************************************************************
+  * @file    xpd_lptim.c
+  * @author  Benedek Kupper
+  * @version V0.1
+  * @date    2018-01-20
+  * @brief   STM32 eXtensible Peripheral Drivers LPTIM Module
+  *
+  *  This file is part of STM32_XPD.
+  *
+  *  STM32_XPD is free software: you can redistribute it and/or modify
+  *  it under the terms of the GNU General Public License as published by
+  *  the Free Software Foundation, either version 3 of the License, or
+  *  (at your option) any later version.
+  *
+  *  STM32_XPD is distributed in the hope that it will be useful,
+  *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with STM32_XPD.  If not, see <http://www.gnu.org/licenses/>.
+  */
+#include "xpd_lptim.h"
+#include "xpd_utils.h"
+
+#if defined(USE_XPD_LPTIM)
+
+/** @addtogroup LPTIM
+ * @{ */
+
+/** @addtogroup LPTIM_Private_Macros
+ * @{ */
+
+/* The register updates are synchronized to the kernel clock, which can be as slow as LSI */
+#define LPTIM_TIMEOUT_MS        5
+
+#define LPTIM_ICR_ALL           (LPTIM_ICR_CMPMCF | LPTIM_ICR_ARRMCF | LPTIM_ICR_EXTTRIGCF | \
+                                 LPTIM_ICR_CMPOKCF | LPTIM_ICR_ARROKCF)
+
+/** @} */
+
+/* Writes a compare or autoreload register, and waits for its synchronization */
+static XPD_ReturnType lptim_writeSync(LPTIM_HandleType * hlptim, volatile uint32_t * reg,
+        uint32_t value, uint32_t okFlag)
+{
+    uint32_t timeout = LPTIM_TIMEOUT_MS;
+    XPD_ReturnType result;
+
+    *reg = value;
+    result = XPD_WaitForMatch(&hlptim->Inst->ISR.w, okFlag, okFlag, &timeout);
+    hlptim->Inst->ICR.w = okFlag;
+
+    return result;
+}
+
+/* Restarts the counter with the new period, compare value and interrupt selection */
+static XPD_ReturnType lptim_start(LPTIM_HandleType * hlptim, uint16_t Period, uint16_t Compare,
+        uint32_t interrupts, uint32_t mode)
+{
+    XPD_ReturnType result;
+
+    /* Interrupts can only be configured while the timer is disabled */
+    hlptim->Inst->CR.w  = 0;
+    hlptim->Inst->ICR.w = LPTIM_ICR_ALL;
+    hlptim->Inst->IER.w = interrupts;
+
+    /* The registers can only be written while the timer is enabled */
+    hlptim->Inst->CR.w  = LPTIM_CR_ENABLE;
+
+    result = lptim_writeSync(hlptim, &hlptim->Inst->ARR, Period, LPTIM_ISR_ARROK);
+    if (result == XPD_OK)
+    {
+        result = lptim_writeSync(hlptim, &hlptim->Inst->CMP, Compare, LPTIM_ISR_CMPOK);
+    }
+
+    if (result == XPD_OK)
+    {
+        hlptim->Inst->CR.w = LPTIM_CR_ENABLE | mode;
+    }
+    else
+    {
+        hlptim->Inst->CR.w = 0;
+    }
+    return result;
+}
+
+/** @defgroup LPTIM_Exported_Functions LPTIM Exported Functions
+ * @{ */
+
+/**
+ * @brief Initializes the LPTIM peripheral using the setup configuration.
+ * @note  The counter keeps running in Stop mode when the kernel clock is LSE, LSI or HSI
+ *        (or the input pulses are counted). LPTIM1 is able to wake up the MCU from Stop 2 mode,
+ *        LPTIM2 only from Stop 1 mode.
+ * @param hlptim: pointer to the LPTIM handle structure
+ * @param Config: LPTIM setup configuration
+ * @return OK
+ */
+XPD_ReturnType XPD_LPTIM_Init(LPTIM_HandleType * hlptim, const LPTIM_InitType * Config)
+{
+    uint32_t cfgr = Config->Prescaler << LPTIM_CFGR_PRESC_Pos;
+
+    /* enable clock */
+    XPD_SAFE_CALLBACK(hlptim->ClockCtrl, ENABLE);
+
+    /* The configuration can only be written while the timer is disabled */
+    hlptim->Inst->CR.w = 0;
+
+    if (Config->Source == LPTIM_COUNT_EXTERNAL)
+    {
+        cfgr |= LPTIM_CFGR_COUNTMODE
+              | ((Config->Input.Edge - EDGE_RISING) << LPTIM_CFGR_CKPOL_Pos)
+              | (Config->Input.Filter << LPTIM_CFGR_CKFLT_Pos);
+    }
+    hlptim->Inst->CFGR.w = cfgr;
+
+    /* Dependencies initialization */
+    XPD_SAFE_CALLBACK(hlptim->Callbacks.DepInit, hlptim);
+
+    return XPD_OK;
+}
+
+/**
+ * @brief Restores the LPTIM peripheral to its default inactive state.
+ * @param hlptim: pointer to the LPTIM handle structure
+ * @return OK
+ */
+XPD_ReturnType XPD_LPTIM_Deinit(LPTIM_HandleType * hlptim)
+{
+    hlptim->Inst->CR.w   = 0;
+    hlptim->Inst->CFGR.w = 0;
+
+    /* Deinitialize peripheral dependencies */
+    XPD_SAFE_CALLBACK(hlptim->Callbacks.DepDeinit, hlptim);
+
+    /* Disable clock */
+    XPD_SAFE_CALLBACK(hlptim->ClockCtrl, DISABLE);
+
+    return XPD_OK;
+}
+
+/**
+ * @brief Starts a single timeout: the Period callback is called once the counter has
+ *        counted the specified number of ticks, then the counter stops.
+ * @param hlptim: pointer to the LPTIM handle structure
+ * @param Period: the number of counter ticks until the timeout [1 .. 65535]
+ * @return ERROR if the period is invalid, TIMEOUT if the kernel clock isn't running, OK if started
+ */
+XPD_ReturnType XPD_LPTIM_Timeout_Start(LPTIM_HandleType * hlptim, uint16_t Period)
+{
+    XPD_ReturnType result = XPD_ERROR;
+
+    if (Period > 0)
+    {
+        result = lptim_start(hlptim, Period, 0, LPTIM_IER_ARRMIE, LPTIM_CR_SNGSTRT);
+    }
+    return result;
+}
+
+/**
+ * @brief Starts the continuous counting: the Period callback is called each time
+ *        the counter reaches the period value (then it restarts from 0), and the Compare callback
+ *        is called each time the counter reaches the compare value.
+ * @param hlptim: pointer to the LPTIM handle structure
+ * @param Period: the last counter value of the counting period [1 .. 65535]
+ * @param Compare: the counter value to signal (set to Period or above to disable)
+ * @return ERROR if the period is invalid, TIMEOUT if the kernel clock isn't running, OK if started
+ */
+XPD_ReturnType XPD_LPTIM_Counter_Start(LPTIM_HandleType * hlptim, uint16_t Period, uint16_t Compare)
+{
+    XPD_ReturnType result = XPD_ERROR;
+
+    if (Period > 0)
+    {
+        uint32_t interrupts = LPTIM_IER_ARRMIE;
+
+        if (Compare < Period)
+        {
+            interrupts |= LPTIM_IER_CMPMIE;
+        }
+        else
+        {
+            Compare = 0;
+        }
+        result = lptim_start(hlptim, Period, Compare, interrupts, LPTIM_CR_CNTSTRT);
+    }
+    return result;
+}
+
+/**
+ * @brief Stops the counter and its interrupts.
+ * @param hlptim: pointer to the LPTIM handle structure
+ */
+void XPD_LPTIM_Stop(LPTIM_HandleType * hlptim)
+{
+    hlptim->Inst->CR.w  = 0;
+    hlptim->Inst->IER.w = 0;
+    hlptim->Inst->ICR.w = LPTIM_ICR_ALL;
+}
+
+/**
+ * @brief Reads the current value of the counter.
+ * @note  As the counter is clocked asynchronously, the value is read until two consecutive reads match.
+ * @param hlptim: pointer to the LPTIM handle structure
+ * @return The counter value
+ */
+uint16_t XPD_LPTIM_GetCounter(LPTIM_HandleType * hlptim)
+{
+    uint32_t cnt, prev;
+
+    cnt = hlptim->Inst->CNT.w;
+    do {
+        prev = cnt;
+        cnt  = hlptim->Inst->CNT.w;
+    } while (cnt != prev);
+
+    return (uint16_t)cnt;
+}
+
+/**
+ * @brief LPTIM interrupt handler that provides the period and compare match callbacks.
+ * @param hlptim: pointer to the LPTIM handle structure
+ */
+void XPD_LPTIM_IRQHandler(LPTIM_HandleType * hlptim)
+{
+    uint32_t isr = hlptim->Inst->ISR.w & hlptim->Inst->IER.w
+                 & (LPTIM_ISR_CMPM | LPTIM_ISR_ARRM);
+
+    XPD_PROFILE_BEGIN();
+
+    hlptim->Inst->ICR.w = isr;
+
+    if ((isr & LPTIM_ISR_CMPM) != 0)
+    {
+        XPD_SAFE_CALLBACK(hlptim->Callbacks.Compare, hlptim);
+    }
+
+    if ((isr & LPTIM_ISR_ARRM) != 0)
+    {
+        XPD_SAFE_CALLBACK(hlptim->Callbacks.Period, hlptim);
+    }
+
+    XPD_PROFILE_END();
+}
+
+/** @} */
+
+/** @} */
+
+#endif /* USE_XPD_LPTIM */
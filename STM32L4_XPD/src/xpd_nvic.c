@@ -0,0 +1,327 @@
+/**
+  ******************************************************************************
+  * @file    xpd_nvic.c
+  * @author  Benedek Kupper
+  * @version V0.1
+  * @date    2018-01-20
+  * @brief   STM32 eXtensible Peripheral Drivers NVIC Module
+  *
+  *  This file is part of STM32_XPD.
+  *
+  *  STM32_XPD is free software: you can redistribute it and/or modify
+  *  it under the terms of the GNU General Public License as published by
+  *  the Free Software Foundation, either version 3 of the License, or
+  *  (at your option) any later version.
+  *
+  *  STM32_XPD is distributed in the hope that it will be useful,
+  *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with STM32_XPD.  If not, see <http://www.gnu.org/licenses/>.
+  */
+
+#include "xpd_nvic.h"
+
+/** @addtogroup NVIC
+ * @{ */
+
+#ifdef USE_XPD_IRQ_REGISTRY
+/* The Thumb instructions of the handler stub, which loads the handle to R0
+ * and branches to the handler, keeping the exception return address in LR:
+ *   ldr r0, [pc, #4]   ; Handle
+ *   ldr r1, [pc, #8]   ; Handler
+ *   bx  r1
+ *   nop                ; literal alignment */
+#define NVIC_STUB_CODE          { 0x4801, 0x4902, 0x4708, 0x46C0 }
+
+/* The registered handler entry, its beginning is the vector of the line in the RAM vector table */
+typedef struct
+{
+    uint16_t               Code[4];     /* the stub instructions */
+    void *                 Handle;      /* the stub literals */
+    XPD_HandleCallbackType Handler;     /* NULL if the entry is free */
+    uint32_t               Vector;      /* the vector of the line before the registration */
+    IRQn_Type              IRQn;
+}NVIC_HandlerEntryType;
+
+static NVIC_HandlerEntryType nvic_handlers[XPD_NVIC_HANDLER_COUNT];
+static uint32_t * nvic_vectors = NULL;
+static uint16_t nvic_vectorCount = 0;
+
+/* Finds the registered handler entry of the interrupt line */
+static NVIC_HandlerEntryType * nvic_findHandler(IRQn_Type IRQn)
+{
+    uint32_t i;
+
+    for (i = 0; i < XPD_NVIC_HANDLER_COUNT; i++)
+    {
+        if ((nvic_handlers[i].Handler != NULL) && (nvic_handlers[i].IRQn == IRQn))
+        {
+            return &nvic_handlers[i];
+        }
+    }
+    return NULL;
+}
+
+/* Provides the RAM vector table entry of the interrupt line, NULL if the line isn't relocated */
+static uint32_t * nvic_getVector(IRQn_Type IRQn)
+{
+    uint32_t index = (uint32_t)((int32_t)IRQn + 16);
+
+    return (index < nvic_vectorCount) ? &nvic_vectors[index] : NULL;
+}
+#endif
+
+/** @defgroup NVIC_Exported_Functions NVIC Exported Functions
+ *  @brief    NVIC priority planning
+ *  @details  The interrupt priorities of the application are kept in a single table
+ *            instead of being set in the dependency initializer callbacks of the drivers.
+ *            The preemption requirements between the interrupt lines (e.g. a DMA stream
+ *            has to preempt the peripheral which consumes its data) are verified
+ *            on the configured hardware priorities.
+ * @{
+ */
+
+/**
+ * @brief Returns the preemption priority of the interrupt line, as currently configured.
+ * @param IRQn: the selected interrupt line
+ * @return The preemption priority value
+ */
+uint32_t XPD_NVIC_GetPreemptPriority(IRQn_Type IRQn)
+{
+#if (__CORTEX_M >= 3)
+    uint32_t preempt, sub;
+
+    NVIC_DecodePriority(NVIC_GetPriority(IRQn), NVIC_GetPriorityGrouping(), &preempt, &sub);
+
+    return preempt;
+#else
+    /* Cortex M0 has no subpriorities */
+    return NVIC_GetPriority(IRQn);
+#endif
+}
+
+/**
+ * @brief Sets the priorities of all interrupt lines in the table.
+ * @note  The priority group has to be set before, with @ref XPD_NVIC_SetPriorityGroup.
+ * @param Table: pointer to the priority table
+ * @param Count: number of entries in the table
+ */
+void XPD_NVIC_InitPriorities(const NVIC_PriorityConfigType * Table, uint8_t Count)
+{
+    for (; Count > 0; Count--, Table++)
+    {
+        XPD_NVIC_SetPriorityConfig(Table->IRQn, Table->Preemption, Table->Sub);
+    }
+}
+
+/**
+ * @brief Checks that each producer interrupt line preempts its consumer line.
+ * @param Order: pointer to the preemption requirement list
+ * @param Count: number of entries in the list
+ * @param FailedIndex: set to the index of the first violated requirement (can be NULL)
+ * @return ERROR if a producer can't preempt its consumer, OK otherwise
+ */
+XPD_ReturnType XPD_NVIC_CheckPriorityOrder(const NVIC_PriorityOrderType * Order, uint8_t Count,
+        uint8_t * FailedIndex)
+{
+    uint8_t i;
+
+    for (i = 0; i < Count; i++)
+    {
+        /* Only a numerically lower preemption priority can preempt */
+        if (XPD_NVIC_GetPreemptPriority(Order[i].Producer)
+                >= XPD_NVIC_GetPreemptPriority(Order[i].Consumer))
+        {
+            if (FailedIndex != NULL)
+            {
+                *FailedIndex = i;
+            }
+            return XPD_ERROR;
+        }
+    }
+    return XPD_OK;
+}
+
+#ifdef USE_XPD_IRQ_REGISTRY
+/**
+ * @brief Copies the active vector table to RAM and relocates the vector table to the copy,
+ *        so that the registered handlers are called directly from their vectors.
+ * @note  The function shall be called once, before the handler registrations.
+ *        The table has to be aligned to its size rounded up to a power of 2 (on cores with VTOR),
+ *        or placed at the start of the SRAM with the SYSCFG clock enabled (Cortex M0).
+ *        The handler stubs are executed from RAM, which must not be set execute-never by the MPU.
+ * @param Table: pointer to the RAM vector table storage
+ * @param Count: the number of vectors, including the 16 system exception vectors
+ * @return ERROR if the table location is invalid, OK otherwise
+ */
+XPD_ReturnType XPD_NVIC_InitVectorTable(uint32_t * Table, uint16_t Count)
+{
+    const uint32_t * active;
+    uint32_t i;
+
+#ifdef SCB_VTOR_TBLOFF_Msk
+    uint32_t size = 32 * sizeof(uint32_t);
+
+    while (size < (Count * sizeof(uint32_t)))
+    {
+        size <<= 1;
+    }
+    if (((uint32_t)Table & (size - 1)) != 0)
+    {
+        return XPD_ERROR;
+    }
+    active = (const uint32_t *)SCB->VTOR.w;
+#else
+    /* the volatile pointer prevents the null dereference optimization */
+    const uint32_t * volatile boot = 0;
+
+    if ((uint32_t)Table != SRAM_BASE)
+    {
+        return XPD_ERROR;
+    }
+    active = boot;
+#endif
+
+    if (Table != active)
+    {
+        for (i = 0; i < Count; i++)
+        {
+            Table[i] = active[i];
+        }
+        __DSB();
+
+#ifdef SCB_VTOR_TBLOFF_Msk
+        SCB->VTOR.w = (uint32_t)Table;
+#else
+        /* the SRAM is mapped to the boot address */
+        SET_BIT(SYSCFG->CFGR1.w, SYSCFG_CFGR1_MEM_MODE);
+#endif
+        __DSB();
+        __ISB();
+    }
+
+    nvic_vectors = Table;
+    nvic_vectorCount = Count;
+
+    return XPD_OK;
+}
+
+/**
+ * @brief Registers the handler function and the handle which serve the interrupt line.
+ *        When the line is in the RAM vector table, its vector is set to the stub of the entry,
+ *        which calls the handler with the handle directly, without any trampoline function.
+ *        Otherwise the line is served by @ref XPD_NVIC_IRQHandler if that's set as its vector.
+ * @note  The registration of a registered line replaces its handler and handle.
+ * @param IRQn: the selected interrupt line
+ * @param Handler: the handler function of the line (e.g. the driver IRQ handler)
+ * @param Handle: the handle to pass to the handler
+ * @return ERROR if the handler is NULL, BUSY if the registry is full
+ *         (see @ref XPD_NVIC_HANDLER_COUNT), OK if success
+ */
+XPD_ReturnType XPD_NVIC_RegisterHandler(IRQn_Type IRQn, XPD_HandleCallbackType Handler, void * Handle)
+{
+    static const uint16_t code[] = NVIC_STUB_CODE;
+    NVIC_HandlerEntryType * entry;
+    uint32_t * vector = nvic_getVector(IRQn);
+    uint32_t primask = __get_PRIMASK();
+    XPD_ReturnType result = XPD_OK;
+    uint32_t i, j;
+
+    if (Handler == NULL)
+    {
+        return XPD_ERROR;
+    }
+
+    __disable_irq();
+
+    entry = nvic_findHandler(IRQn);
+    if (entry == NULL)
+    {
+        result = XPD_BUSY;
+
+        for (i = 0; i < XPD_NVIC_HANDLER_COUNT; i++)
+        {
+            if (nvic_handlers[i].Handler == NULL)
+            {
+                entry = &nvic_handlers[i];
+                for (j = 0; j < sizeof(code) / sizeof(code[0]); j++)
+                {
+                    entry->Code[j] = code[j];
+                }
+                entry->IRQn   = IRQn;
+                entry->Vector = (vector != NULL) ? *vector : 0;
+                result = XPD_OK;
+                break;
+            }
+        }
+    }
+
+    if (result == XPD_OK)
+    {
+        entry->Handle  = Handle;
+        entry->Handler = Handler;
+
+        if (vector != NULL)
+        {
+            /* the stub is complete before the vector points to it */
+            __DSB();
+            *vector = (uint32_t)entry->Code | 1;
+            __DSB();
+            __ISB();
+        }
+    }
+
+    __set_PRIMASK(primask);
+
+    return result;
+}
+
+/**
+ * @brief Removes the registered handler of the interrupt line,
+ *        restoring its vector from before the registration.
+ * @param IRQn: the selected interrupt line
+ */
+void XPD_NVIC_UnregisterHandler(IRQn_Type IRQn)
+{
+    NVIC_HandlerEntryType * entry;
+    uint32_t * vector = nvic_getVector(IRQn);
+    uint32_t primask = __get_PRIMASK();
+
+    __disable_irq();
+
+    entry = nvic_findHandler(IRQn);
+    if (entry != NULL)
+    {
+        if (vector != NULL)
+        {
+            *vector = entry->Vector;
+            __DSB();
+        }
+        entry->Handler = NULL;
+    }
+
+    __set_PRIMASK(primask);
+}
+
+/**
+ * @brief Common interrupt handler which calls the registered handler of the active line.
+ * @note  The registry is searched in each call, the RAM vector table (@ref XPD_NVIC_InitVectorTable)
+ *        avoids this overhead by calling the registered handlers directly.
+ */
+void XPD_NVIC_IRQHandler(void)
+{
+    NVIC_HandlerEntryType * entry = nvic_findHandler(XPD_NVIC_GetCurrentIRQ());
+
+    if (entry != NULL)
+    {
+        entry->Handler(entry->Handle);
+    }
+}
+#endif
+
+/** @} */
+
+/** @} */
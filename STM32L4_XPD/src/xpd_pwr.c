@@ -82,6 +82,8 @@ void XPD_PWR_SleepMode(ReactionType WakeUpOn)
     /* Clear SLEEPDEEP bit of Cortex System Control Register */
     SCB->SCR.b.SLEEPDEEP = 0;
 
+    XPD_ENERGY_STATE(XPD_ENERGY_SLEEP);
+
     if (WakeUpOn == REACTION_IT)
     {
         /* Request Wait For Interrupt */
@@ -94,6 +96,8 @@ void XPD_PWR_SleepMode(ReactionType WakeUpOn)
         __WFE();
         __WFE();
     }
+
+    XPD_ENERGY_STATE(XPD_ENERGY_RUN);
 }
 
 /**
@@ -118,22 +122,37 @@ void XPD_PWR_StopMode(ReactionType WakeUpOn, PWR_RegulatorType Regulator)
     /* Using the main regulator the Stop 0 mode is entered */
     if (Regulator == PWR_MAINREGULATOR)
     {
-        PWR->CR1.b.LPMS = 0;
+        XPD_PWR_StopModeSelect(WakeUpOn, PWR_STOP0);
     }
     /* If Low-power Run is enabled, Stop 1 mode can be entered only */
     else if (PWR_REG_BIT(CR1, LPR) != 0)
     {
-        PWR->CR1.b.LPMS = 1;
+        XPD_PWR_StopModeSelect(WakeUpOn, PWR_STOP1);
     }
     else
     {
-        /* Stop 2 mode */
-        PWR->CR1.b.LPMS = 2;
+        XPD_PWR_StopModeSelect(WakeUpOn, PWR_STOP2);
     }
+}
+
+/**
+ * @brief Enters the selected STOP mode.
+ * @note  Stop 2 mode cannot be entered from Low-power Run mode.
+ * @param WakeUpOn: Specifies if STOP mode is exited with WFI or WFE instruction
+ *           This parameter can be one of the following values:
+ *            @arg REACTION_IT: enter SLEEP mode with WFI instruction
+ *            @arg REACTION_EVENT: enter SLEEP mode with WFE instruction
+ * @param Mode: the Stop mode to enter
+ */
+void XPD_PWR_StopModeSelect(ReactionType WakeUpOn, PWR_StopModeType Mode)
+{
+    PWR->CR1.b.LPMS = Mode;
 
     /* Set SLEEPDEEP bit of Cortex System Control Register */
     SCB->SCR.b.SLEEPDEEP = 1;
 
+    XPD_ENERGY_STATE(XPD_ENERGY_STOP);
+
     /* Select STOP mode entry */
     if (WakeUpOn == REACTION_IT)
     {
@@ -150,6 +169,8 @@ void XPD_PWR_StopMode(ReactionType WakeUpOn, PWR_RegulatorType Regulator)
 
     /* Reset SLEEPDEEP bit of Cortex System Control Register */
     SCB->SCR.b.SLEEPDEEP = 0;
+
+    XPD_ENERGY_STATE(XPD_ENERGY_RUN);
 }
 
 /**
@@ -0,0 +1,607 @@
+/**
+  ******************************************************************************
+  * @file    xpd_qspi.c
+  * @author  Benedek Kupper
+  * @version V0.1
+  * @date    2018-01-20
+  * @brief   STM32 eXtensible Peripheral Drivers QSPI Module
+  *
+  *  This file is part of STM32_XPD.
+  *
+  *  STM32_XPD is free software: you can redistribute it and/or modify
+  *  it under the terms of the GNU General Public License as published by
+  *  the Free Software Foundation, either version 3 of the License, or
+  *  (at your option) any later version.
+  *
+  *  STM32_XPD is distributed in the hope that it will be useful,
+  *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with STM32_XPD.  If not, see <http://www.gnu.org/licenses/>.
+  */
+#include "xpd_qspi.h"
+#include "xpd_rcc.h"
+#include "xpd_utils.h"
+
+#if defined(USE_XPD_QSPI)
+
+/** @addtogroup QSPI
+ * @{ */
+
+#define QSPI_ABORT_TIMEOUT      10
+
+/* Functional modes of the command */
+#define QSPI_FMODE_WRITE        0
+#define QSPI_FMODE_READ         1
+#define QSPI_FMODE_POLLING      2
+#define QSPI_FMODE_MAPPED       3
+
+/* Builds the communication configuration register value of the command */
+static uint32_t qspi_commandConfig(const QSPI_CommandType * Cmd, uint32_t FMode)
+{
+    uint32_t ccr = ((uint32_t)Cmd->InstructionLines << QUADSPI_CCR_IMODE_Pos)
+                 | ((uint32_t)Cmd->AddressLines     << QUADSPI_CCR_ADMODE_Pos)
+                 | ((uint32_t)Cmd->AddressSize      << QUADSPI_CCR_ADSIZE_Pos)
+                 | ((uint32_t)Cmd->AltBytesLines    << QUADSPI_CCR_ABMODE_Pos)
+                 | ((uint32_t)Cmd->AltBytesSize     << QUADSPI_CCR_ABSIZE_Pos)
+                 | ((uint32_t)Cmd->DummyCycles      << QUADSPI_CCR_DCYC_Pos)
+                 | ((uint32_t)Cmd->DataLines        << QUADSPI_CCR_DMODE_Pos)
+                 | (FMode << QUADSPI_CCR_FMODE_Pos);
+
+    if (Cmd->InstructionLines != QSPI_LINES_NONE)
+    {
+        ccr |= (uint32_t)Cmd->Instruction << QUADSPI_CCR_INSTRUCTION_Pos;
+    }
+    if (Cmd->SendInstructionOnce != DISABLE)
+    {
+        ccr |= QUADSPI_CCR_SIOO;
+    }
+    if (Cmd->DoubleDataRate != DISABLE)
+    {
+        ccr |= QUADSPI_CCR_DDRM;
+    }
+    return ccr;
+}
+
+/* Writes the command registers, the transfer is started by the last register write
+ * which is required by the command's phases */
+static void qspi_startCommand(QSPI_HandleType * hqspi, const QSPI_CommandType * Cmd,
+        uint32_t FMode, uint32_t Length)
+{
+    if (Length > 0)
+    {
+        hqspi->Inst->DLR = Length - 1;
+    }
+    if (Cmd->AltBytesLines != QSPI_LINES_NONE)
+    {
+        hqspi->Inst->ABR = Cmd->AltBytes;
+    }
+
+    hqspi->Inst->CCR.w = qspi_commandConfig(Cmd, FMode);
+
+    if ((Cmd->AddressLines != QSPI_LINES_NONE) && (FMode != QSPI_FMODE_MAPPED))
+    {
+        hqspi->Inst->AR = Cmd->Address;
+    }
+}
+
+/* Waits for the end of the indirect transfer and clears the flags */
+static XPD_ReturnType qspi_waitComplete(QSPI_HandleType * hqspi, uint32_t * Timeout)
+{
+    XPD_ReturnType result = XPD_WaitForMatch(&hqspi->Inst->SR.w, QUADSPI_SR_TCF,
+            QUADSPI_SR_TCF, Timeout);
+
+    hqspi->Inst->FCR.w = QUADSPI_FCR_CTCF | QUADSPI_FCR_CTEF;
+
+    return result;
+}
+
+/* Sets up the status match registers of the automatic polling */
+static void qspi_pollingConfig(QSPI_HandleType * hqspi, uint32_t Match, uint32_t Mask,
+        QSPI_MatchModeType MatchMode, uint16_t Interval)
+{
+    hqspi->Inst->PSMAR = Match;
+    hqspi->Inst->PSMKR = Mask;
+    hqspi->Inst->PIR   = Interval;
+
+    /* Stop the polling at the first match */
+    MODIFY_REG(hqspi->Inst->CR.w, QUADSPI_CR_PMM,
+            QUADSPI_CR_APMS | ((uint32_t)MatchMode << QUADSPI_CR_PMM_Pos));
+}
+
+static void qspi_dmaRedirect(void * hdma)
+{
+    QSPI_HandleType * hqspi = (QSPI_HandleType*) ((DMA_HandleType*) hdma)->Owner;
+
+    /* The FIFO is processed, the transfer completion is signalled by the peripheral */
+    CLEAR_BIT(hqspi->Inst->CR.w, QUADSPI_CR_DMAEN);
+    SET_BIT(hqspi->Inst->CR.w, QUADSPI_CR_TCIE);
+}
+
+#ifdef USE_XPD_DMA_ERROR_DETECT
+static void qspi_dmaErrorRedirect(void * hdma)
+{
+    QSPI_HandleType * hqspi = (QSPI_HandleType*) ((DMA_HandleType*) hdma)->Owner;
+
+    CLEAR_BIT(hqspi->Inst->CR.w, QUADSPI_CR_DMAEN);
+
+    /* Update error code */
+    hqspi->Errors |= QSPI_ERROR_DMA;
+    XPD_STATS_ERROR(hqspi, QSPI_ERROR_DMA);
+
+    (void) XPD_QSPI_Abort(hqspi);
+
+    XPD_SAFE_CALLBACK(hqspi->Callbacks.Error, hqspi);
+}
+#endif
+
+/* Starts an indirect transfer served by the DMA */
+static XPD_ReturnType qspi_startDMA(QSPI_HandleType * hqspi, const QSPI_CommandType * Cmd,
+        uint32_t FMode, void * Data, uint16_t Length)
+{
+    XPD_ReturnType result = XPD_BUSY;
+    DMA_HandleType * hdma = hqspi->DMA.Transfer;
+
+    if ((hqspi->Inst->SR.w & QUADSPI_SR_BUSY) == 0)
+    {
+        /* Set up DMA for transfer */
+        XPD_DMA_SetDataAlignment(hdma, DMA_ALIGN_BYTE, DMA_ALIGN_BYTE);
+        result = XPD_DMA_Start_IT(hdma, (void*) &hqspi->Inst->DR, Data, Length);
+    }
+
+    if (result == XPD_OK)
+    {
+        /* Set the callback owner */
+        hdma->Owner = hqspi;
+
+        /* Set the DMA transfer callbacks */
+        hdma->Callbacks.Complete = qspi_dmaRedirect;
+#ifdef USE_XPD_DMA_ERROR_DETECT
+        hdma->Callbacks.Error    = qspi_dmaErrorRedirect;
+#endif
+
+        hqspi->Stream.buffer = Data;
+        hqspi->Stream.length = Length;
+        hqspi->Stream.size   = 1;
+
+#if defined(USE_XPD_QSPI_ERROR_DETECT) || defined(USE_XPD_DMA_ERROR_DETECT)
+        hqspi->Errors = QSPI_ERROR_NONE;
+#endif
+        hqspi->Inst->FCR.w = QUADSPI_FCR_CTCF | QUADSPI_FCR_CTEF;
+#ifdef USE_XPD_QSPI_ERROR_DETECT
+        SET_BIT(hqspi->Inst->CR.w, QUADSPI_CR_TEIE);
+#endif
+
+        qspi_startCommand(hqspi, Cmd, FMode, Length);
+
+        SET_BIT(hqspi->Inst->CR.w, QUADSPI_CR_DMAEN);
+    }
+    return result;
+}
+
+/** @defgroup QSPI_Exported_Functions QSPI Exported Functions
+ * @{ */
+
+/**
+ * @brief Initializes the QUADSPI peripheral using the setup configuration.
+ * @param hqspi: pointer to the QSPI handle structure
+ * @param Config: pointer to QSPI setup configuration
+ * @return BUSY if a command is in progress, OK otherwise
+ */
+XPD_ReturnType XPD_QSPI_Init(QSPI_HandleType * hqspi, const QSPI_InitType * Config)
+{
+    uint32_t cr;
+
+    /* enable clock */
+    XPD_SAFE_CALLBACK(hqspi->ClockCtrl, ENABLE);
+
+    if ((hqspi->Inst->SR.w & QUADSPI_SR_BUSY) != 0)
+    {
+        return XPD_BUSY;
+    }
+
+    /* FIFO threshold of one byte */
+    cr = ((uint32_t)(Config->ClockPrescaler - 1) << QUADSPI_CR_PRESCALER_Pos);
+    if (Config->SampleShift != DISABLE)
+    {
+        cr |= QUADSPI_CR_SSHIFT;
+    }
+    hqspi->Inst->CR.w  = cr;
+    hqspi->Inst->DCR.w = ((uint32_t)(Config->FlashSizeLog2 - 1)      << QUADSPI_DCR_FSIZE_Pos)
+                       | ((uint32_t)(Config->ChipSelectHighTime - 1) << QUADSPI_DCR_CSHT_Pos)
+                       | ((uint32_t)Config->ClockMode                << QUADSPI_DCR_CKMODE_Pos);
+
+#if defined(USE_XPD_QSPI_ERROR_DETECT) || defined(USE_XPD_DMA_ERROR_DETECT)
+    hqspi->Errors = QSPI_ERROR_NONE;
+#endif
+
+    /* Dependencies initialization */
+    XPD_SAFE_CALLBACK(hqspi->Callbacks.DepInit, hqspi);
+
+    SET_BIT(hqspi->Inst->CR.w, QUADSPI_CR_EN);
+
+    return XPD_OK;
+}
+
+/**
+ * @brief Restores the QUADSPI peripheral to its default inactive state.
+ * @param hqspi: pointer to the QSPI handle structure
+ * @return OK
+ */
+XPD_ReturnType XPD_QSPI_Deinit(QSPI_HandleType * hqspi)
+{
+    (void) XPD_QSPI_Abort(hqspi);
+
+    hqspi->Inst->CR.w = 0;
+
+    /* Deinitialize peripheral dependencies */
+    XPD_SAFE_CALLBACK(hqspi->Callbacks.DepDeinit, hqspi);
+
+    /* Disable clock */
+    XPD_SAFE_CALLBACK(hqspi->ClockCtrl, DISABLE);
+
+    return XPD_OK;
+}
+
+/**
+ * @brief Sends a command without data phase to the external memory.
+ * @param hqspi: pointer to the QSPI handle structure
+ * @param Cmd: pointer to the command structure (the data phase is ignored)
+ * @param Timeout: the timeout in ms for the command completion
+ * @return BUSY if a command is in progress, TIMEOUT if the command didn't complete in time,
+ *         OK if successful
+ */
+XPD_ReturnType XPD_QSPI_Command(QSPI_HandleType * hqspi, const QSPI_CommandType * Cmd,
+        uint32_t Timeout)
+{
+    QSPI_CommandType cmd = *Cmd;
+
+    if ((hqspi->Inst->SR.w & QUADSPI_SR_BUSY) != 0)
+    {
+        return XPD_BUSY;
+    }
+
+    cmd.DataLines = QSPI_LINES_NONE;
+    qspi_startCommand(hqspi, &cmd, QSPI_FMODE_WRITE, 0);
+
+    return qspi_waitComplete(hqspi, &Timeout);
+}
+
+/**
+ * @brief Writes data to the external memory in indirect mode.
+ * @param hqspi: pointer to the QSPI handle structure
+ * @param Cmd: pointer to the command structure
+ * @param TxData: pointer to the data to write
+ * @param Length: the amount of data bytes to write
+ * @param Timeout: the timeout in ms for the complete transfer
+ * @return BUSY if a command is in progress, TIMEOUT if the transfer didn't complete in time,
+ *         OK if successful
+ */
+XPD_ReturnType XPD_QSPI_Transmit(QSPI_HandleType * hqspi, const QSPI_CommandType * Cmd,
+        const void * TxData, uint32_t Length, uint32_t Timeout)
+{
+    XPD_ReturnType result = XPD_OK;
+    const uint8_t * data = (const uint8_t *)TxData;
+    uint32_t i;
+
+    if ((hqspi->Inst->SR.w & QUADSPI_SR_BUSY) != 0)
+    {
+        return XPD_BUSY;
+    }
+
+    qspi_startCommand(hqspi, Cmd, QSPI_FMODE_WRITE, Length);
+
+    for (i = 0; (i < Length) && (result == XPD_OK); i++)
+    {
+        /* Wait for free space in the FIFO */
+        result = XPD_WaitForMatch(&hqspi->Inst->SR.w, QUADSPI_SR_FTF, QUADSPI_SR_FTF, &Timeout);
+
+        if (result == XPD_OK)
+        {
+            *((__IO uint8_t *)&hqspi->Inst->DR) = data[i];
+        }
+    }
+
+    if (result == XPD_OK)
+    {
+        result = qspi_waitComplete(hqspi, &Timeout);
+
+        XPD_STATS_ADD(hqspi, Transfers, 1);
+        XPD_STATS_ADD(hqspi, Bytes, Length);
+    }
+    else
+    {
+        (void) XPD_QSPI_Abort(hqspi);
+    }
+    return result;
+}
+
+/**
+ * @brief Reads data from the external memory in indirect mode.
+ * @param hqspi: pointer to the QSPI handle structure
+ * @param Cmd: pointer to the command structure
+ * @param RxData: pointer to the data buffer
+ * @param Length: the amount of data bytes to read
+ * @param Timeout: the timeout in ms for the complete transfer
+ * @return BUSY if a command is in progress, TIMEOUT if the transfer didn't complete in time,
+ *         OK if successful
+ */
+XPD_ReturnType XPD_QSPI_Receive(QSPI_HandleType * hqspi, const QSPI_CommandType * Cmd,
+        void * RxData, uint32_t Length, uint32_t Timeout)
+{
+    XPD_ReturnType result = XPD_OK;
+    uint8_t * data = (uint8_t *)RxData;
+    uint32_t i;
+
+    if ((hqspi->Inst->SR.w & QUADSPI_SR_BUSY) != 0)
+    {
+        return XPD_BUSY;
+    }
+
+    qspi_startCommand(hqspi, Cmd, QSPI_FMODE_READ, Length);
+
+    for (i = 0; (i < Length) && (result == XPD_OK); i++)
+    {
+        /* Wait for received data in the FIFO */
+        result = XPD_WaitForMatch(&hqspi->Inst->SR.w, QUADSPI_SR_FTF, QUADSPI_SR_FTF, &Timeout);
+
+        if (result == XPD_OK)
+        {
+            data[i] = *((__IO uint8_t *)&hqspi->Inst->DR);
+        }
+    }
+
+    if (result == XPD_OK)
+    {
+        result = qspi_waitComplete(hqspi, &Timeout);
+
+        XPD_STATS_ADD(hqspi, Transfers, 1);
+        XPD_STATS_ADD(hqspi, Bytes, Length);
+    }
+    else
+    {
+        (void) XPD_QSPI_Abort(hqspi);
+    }
+    return result;
+}
+
+/**
+ * @brief Starts writing data to the external memory in indirect mode using DMA.
+ *        The Transmit callback is called once the transfer is complete.
+ * @note  The QSPI interrupt has to be enabled, as the transfer completion is signalled by it.
+ * @param hqspi: pointer to the QSPI handle structure
+ * @param Cmd: pointer to the command structure
+ * @param TxData: pointer to the data to write
+ * @param Length: the amount of data bytes to write
+ * @return BUSY if a command or the DMA is in progress, OK if successful
+ */
+XPD_ReturnType XPD_QSPI_Transmit_DMA(QSPI_HandleType * hqspi, const QSPI_CommandType * Cmd,
+        const void * TxData, uint16_t Length)
+{
+    return qspi_startDMA(hqspi, Cmd, QSPI_FMODE_WRITE, (void*)TxData, Length);
+}
+
+/**
+ * @brief Starts reading data from the external memory in indirect mode using DMA.
+ *        The Receive callback is called once the transfer is complete.
+ * @note  The QSPI interrupt has to be enabled, as the transfer completion is signalled by it.
+ * @param hqspi: pointer to the QSPI handle structure
+ * @param Cmd: pointer to the command structure
+ * @param RxData: pointer to the data buffer
+ * @param Length: the amount of data bytes to read
+ * @return BUSY if a command or the DMA is in progress, OK if successful
+ */
+XPD_ReturnType XPD_QSPI_Receive_DMA(QSPI_HandleType * hqspi, const QSPI_CommandType * Cmd,
+        void * RxData, uint16_t Length)
+{
+    return qspi_startDMA(hqspi, Cmd, QSPI_FMODE_READ, RxData, Length);
+}
+
+/**
+ * @brief Periodically reads the status of the external memory until it matches the pattern.
+ * @param hqspi: pointer to the QSPI handle structure
+ * @param Cmd: pointer to the status read command structure
+ * @param Match: the expected value of the unmasked status bits
+ * @param Mask: the selection of the compared status bits
+ * @param Size: the size of the status in bytes [1 .. 4]
+ * @param MatchMode: the combination of the compared bits
+ * @param Interval: the number of clock cycles between two status reads
+ * @param Timeout: the timeout in ms for the status match
+ * @return BUSY if a command is in progress, TIMEOUT if the status didn't match in time,
+ *         OK if the status matched
+ */
+XPD_ReturnType XPD_QSPI_AutoPolling(QSPI_HandleType * hqspi, const QSPI_CommandType * Cmd,
+        uint32_t Match, uint32_t Mask, uint8_t Size, QSPI_MatchModeType MatchMode,
+        uint16_t Interval, uint32_t Timeout)
+{
+    XPD_ReturnType result;
+
+    if ((hqspi->Inst->SR.w & QUADSPI_SR_BUSY) != 0)
+    {
+        return XPD_BUSY;
+    }
+
+    qspi_pollingConfig(hqspi, Match, Mask, MatchMode, Interval);
+    qspi_startCommand(hqspi, Cmd, QSPI_FMODE_POLLING, Size);
+
+    result = XPD_WaitForMatch(&hqspi->Inst->SR.w, QUADSPI_SR_SMF, QUADSPI_SR_SMF, &Timeout);
+
+    if (result == XPD_OK)
+    {
+        hqspi->Inst->FCR.w = QUADSPI_FCR_CSMF;
+    }
+    else
+    {
+        (void) XPD_QSPI_Abort(hqspi);
+    }
+    return result;
+}
+
+/**
+ * @brief Starts the periodic status read of the external memory.
+ *        The StatusMatch callback is called when the status matches the pattern.
+ * @param hqspi: pointer to the QSPI handle structure
+ * @param Cmd: pointer to the status read command structure
+ * @param Match: the expected value of the unmasked status bits
+ * @param Mask: the selection of the compared status bits
+ * @param Size: the size of the status in bytes [1 .. 4]
+ * @param MatchMode: the combination of the compared bits
+ * @param Interval: the number of clock cycles between two status reads
+ * @return BUSY if a command is in progress, OK if successful
+ */
+XPD_ReturnType XPD_QSPI_AutoPolling_IT(QSPI_HandleType * hqspi, const QSPI_CommandType * Cmd,
+        uint32_t Match, uint32_t Mask, uint8_t Size, QSPI_MatchModeType MatchMode,
+        uint16_t Interval)
+{
+    if ((hqspi->Inst->SR.w & QUADSPI_SR_BUSY) != 0)
+    {
+        return XPD_BUSY;
+    }
+
+    qspi_pollingConfig(hqspi, Match, Mask, MatchMode, Interval);
+
+    hqspi->Inst->FCR.w = QUADSPI_FCR_CSMF | QUADSPI_FCR_CTEF;
+#ifdef USE_XPD_QSPI_ERROR_DETECT
+    SET_BIT(hqspi->Inst->CR.w, QUADSPI_CR_SMIE | QUADSPI_CR_TEIE);
+#else
+    SET_BIT(hqspi->Inst->CR.w, QUADSPI_CR_SMIE);
+#endif
+
+    qspi_startCommand(hqspi, Cmd, QSPI_FMODE_POLLING, Size);
+
+    return XPD_OK;
+}
+
+/**
+ * @brief Maps the external memory to the QSPI memory region, so it can be read
+ *        (and code can be executed) directly from @ref XPD_QSPI_MemoryAddress.
+ * @note  The peripheral stays busy in this mode, @ref XPD_QSPI_Abort has to be called
+ *        before any other command.
+ * @param hqspi: pointer to the QSPI handle structure
+ * @param Cmd: pointer to the read command structure (the address is ignored)
+ * @param IdleTimeout: the number of idle clock cycles after which the nCS is released
+ *        (0 to keep the memory selected until the next access)
+ * @return BUSY if a command is in progress, OK if successful
+ */
+XPD_ReturnType XPD_QSPI_MemoryMapped(QSPI_HandleType * hqspi, const QSPI_CommandType * Cmd,
+        uint16_t IdleTimeout)
+{
+    if ((hqspi->Inst->SR.w & QUADSPI_SR_BUSY) != 0)
+    {
+        return XPD_BUSY;
+    }
+
+    if (IdleTimeout > 0)
+    {
+        hqspi->Inst->LPTR = IdleTimeout;
+        SET_BIT(hqspi->Inst->CR.w, QUADSPI_CR_TCEN);
+    }
+    else
+    {
+        CLEAR_BIT(hqspi->Inst->CR.w, QUADSPI_CR_TCEN);
+    }
+
+    qspi_startCommand(hqspi, Cmd, QSPI_FMODE_MAPPED, 0);
+
+    return XPD_OK;
+}
+
+/**
+ * @brief Aborts the ongoing command (including memory-mapped mode and automatic polling).
+ * @param hqspi: pointer to the QSPI handle structure
+ * @return TIMEOUT if the abort didn't finish in time, OK otherwise
+ */
+XPD_ReturnType XPD_QSPI_Abort(QSPI_HandleType * hqspi)
+{
+    XPD_ReturnType result;
+    uint32_t timeout = QSPI_ABORT_TIMEOUT;
+
+    CLEAR_BIT(hqspi->Inst->CR.w, QUADSPI_CR_TEIE | QUADSPI_CR_TCIE | QUADSPI_CR_FTIE
+            | QUADSPI_CR_SMIE | QUADSPI_CR_TOIE);
+
+    if ((hqspi->Inst->CR.w & QUADSPI_CR_DMAEN) != 0)
+    {
+        CLEAR_BIT(hqspi->Inst->CR.w, QUADSPI_CR_DMAEN);
+        XPD_DMA_Stop_IT(hqspi->DMA.Transfer);
+    }
+
+    SET_BIT(hqspi->Inst->CR.w, QUADSPI_CR_ABORT);
+
+    result = XPD_WaitForMatch(&hqspi->Inst->CR.w, QUADSPI_CR_ABORT, 0, &timeout);
+
+    hqspi->Inst->FCR.w = QUADSPI_FCR_CTEF | QUADSPI_FCR_CTCF | QUADSPI_FCR_CSMF | QUADSPI_FCR_CTOF;
+
+    /* Clear the functional mode of the aborted command */
+    hqspi->Inst->CCR.w = 0;
+
+    return result;
+}
+
+/**
+ * @brief QSPI global interrupt handler that provides handle callbacks.
+ * @param hqspi: pointer to the QSPI handle structure
+ */
+void XPD_QSPI_IRQHandler(QSPI_HandleType * hqspi)
+{
+    XPD_PROFILE_BEGIN();
+    XPD_STATS_IRQ_BEGIN();
+
+    uint32_t sr = hqspi->Inst->SR.w;
+    uint32_t cr = hqspi->Inst->CR.w;
+
+    /* Indirect DMA transfer complete */
+    if (((sr & QUADSPI_SR_TCF) != 0) && ((cr & QUADSPI_CR_TCIE) != 0))
+    {
+        CLEAR_BIT(hqspi->Inst->CR.w, QUADSPI_CR_TCIE | QUADSPI_CR_TEIE);
+        hqspi->Inst->FCR.w = QUADSPI_FCR_CTCF;
+
+        XPD_STATS_ADD(hqspi, Transfers, 1);
+        XPD_STATS_ADD(hqspi, Bytes, hqspi->Stream.length);
+
+        if ((hqspi->Inst->CCR.w & QUADSPI_CCR_FMODE) == (QSPI_FMODE_READ << QUADSPI_CCR_FMODE_Pos))
+        {
+            XPD_SAFE_CALLBACK(hqspi->Callbacks.Receive, hqspi);
+        }
+        else
+        {
+            XPD_SAFE_CALLBACK(hqspi->Callbacks.Transmit, hqspi);
+        }
+    }
+
+    /* Automatic polling status match */
+    if (((sr & QUADSPI_SR_SMF) != 0) && ((cr & QUADSPI_CR_SMIE) != 0))
+    {
+        CLEAR_BIT(hqspi->Inst->CR.w, QUADSPI_CR_SMIE | QUADSPI_CR_TEIE);
+        hqspi->Inst->FCR.w = QUADSPI_FCR_CSMF;
+
+        XPD_SAFE_CALLBACK(hqspi->Callbacks.StatusMatch, hqspi);
+    }
+
+#ifdef USE_XPD_QSPI_ERROR_DETECT
+    /* Transfer error */
+    if (((sr & QUADSPI_SR_TEF) != 0) && ((cr & QUADSPI_CR_TEIE) != 0))
+    {
+        hqspi->Inst->FCR.w = QUADSPI_FCR_CTEF;
+
+        /* Update error code */
+        hqspi->Errors |= QSPI_ERROR_TRANSFER;
+        XPD_STATS_ERROR(hqspi, QSPI_ERROR_TRANSFER);
+
+        (void) XPD_QSPI_Abort(hqspi);
+
+        /* Error callback */
+        XPD_SAFE_CALLBACK(hqspi->Callbacks.Error, hqspi);
+    }
+#endif
+
+    XPD_STATS_IRQ_END(hqspi);
+    XPD_PROFILE_END();
+}
+
+/** @} */
+
+/** @} */
+
+#endif /* USE_XPD_QSPI */
@@ -43,6 +43,9 @@ static const uint8_t msiTable[] = {1, 2, 4, 8, 16, 24, 32, 48};
 static const uint8_t AHBPrescTable[16] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 2, 3, 4, 6, 7, 8, 9};
 #define APBPrescTable (&AHBPrescTable[4])
 
+/* the highest HCLK frequency in Low-power run mode */
+#define RCC_LPRUN_MAX_HCLK      2000000
+
 /* gets the appropriate FLASH latency for MSI range */
 static uint8_t rcc_getFlashLatencyForMSI(RCC_MSIFreqType clockRange)
 {
@@ -108,6 +111,47 @@ static uint32_t rcc_convertClockDivider(RCC_ClockType clockType, ClockDividerTyp
     }
 }
 
+/* cached core clock frequencies, updated by the clock configuration functions */
+static struct {
+    uint32_t SYSCLK;
+    uint32_t PCLK1;
+    uint32_t PCLK2;
+    uint32_t PLL;       /* 0 when it has to be recalculated */
+}rcc_clockTree = { 4000000, 4000000, 4000000, 0 };
+
+/* recalculates the cached frequencies of the core clocks */
+static void rcc_clockTreeUpdate(void)
+{
+    rcc_clockTree.SYSCLK = XPD_RCC_GetOscFreq(XPD_RCC_GetSYSCLKSource());
+    rcc_clockTree.PCLK1  = SystemCoreClock >> APBPrescTable[RCC->CFGR.b.PPRE1];
+    rcc_clockTree.PCLK2  = SystemCoreClock >> APBPrescTable[RCC->CFGR.b.PPRE2];
+}
+
+static RCC_ClockListenerType * rcc_clockListeners = NULL;
+static boolean_t rcc_clockTransition = FALSE;
+
+/* the operating point which is applied once its oscillators are ready */
+static RCC_OperatingPointType rcc_pendingOperatingPoint;
+static boolean_t rcc_operatingPointPending = FALSE;
+static boolean_t rcc_operatingPointReady   = FALSE;
+
+static void rcc_operatingPointProceed(void);
+
+/* notifies the registered listeners about the changed clock frequencies */
+static void rcc_clockChanged(void)
+{
+    RCC_ClockListenerType * listener;
+
+    /* the listeners are only notified at the end of an operating point transition */
+    if (rcc_clockTransition == FALSE)
+    {
+        for (listener = rcc_clockListeners; listener != NULL; listener = listener->Next)
+        {
+            XPD_SAFE_CALLBACK(listener->Callback, listener->Handle);
+        }
+    }
+}
+
 /** @defgroup RCC_Core_Clocks_Exported_Functions RCC Core Exported Functions
  * @{ */
 
@@ -126,6 +170,9 @@ XPD_ReturnType XPD_RCC_MSIConfig(const RCC_MSI_InitType * Config)
     XPD_ReturnType result = XPD_OK;
     RCC_OscType sysclock = XPD_RCC_GetSYSCLKSource();
 
+    /* MSI might be the PLL input */
+    rcc_clockTree.PLL = 0;
+
     /* Check if MSI is used as system clock */
     if (sysclock == MSI)
     {
@@ -173,9 +220,12 @@ XPD_ReturnType XPD_RCC_MSIConfig(const RCC_MSI_InitType * Config)
 
             /* Update SystemCoreClock variable */
             SystemCoreClock = XPD_RCC_GetOscFreq(MSI) >> AHBPrescTable[RCC->CFGR.b.HPRE];
+            rcc_clockTreeUpdate();
 
             /* Configure the source of time base considering new system clocks settings */
             XPD_InitTimer();
+
+            rcc_clockChanged();
         }
     }
     else
@@ -299,6 +349,18 @@ XPD_ReturnType XPD_RCC_HSEConfig(RCC_OscStateType NewState)
 }
 #endif
 
+/* configures the PLL source and factors, the PLL has to be disabled */
+static void rcc_pllSetup(const RCC_PLL_InitType * Config)
+{
+    RCC->PLLCFGR.b.PLLSRC = Config->Source + 1;
+
+    RCC->PLLCFGR.b.PLLM = Config->M - 1;
+    RCC->PLLCFGR.b.PLLN = Config->N;
+    RCC_SET_PLLP_CFG(PLL, Config->P);
+    RCC->PLLCFGR.b.PLLQ = (Config->Q >> 1) - 1;
+    RCC->PLLCFGR.b.PLLR = (Config->R >> 1) - 1;
+}
+
 /**
  * Configures the phase locked loop.
  * @param Config: pointer to the configuration parameters
@@ -324,13 +386,7 @@ XPD_ReturnType XPD_RCC_PLLConfig(const RCC_PLL_InitType * Config)
             if (result == XPD_OK)
             {
                 /* Configure the main PLL clock source and multiplication factor. */
-                RCC->PLLCFGR.b.PLLSRC = Config->Source + 1;
-
-                RCC->PLLCFGR.b.PLLM = Config->M - 1;
-                RCC->PLLCFGR.b.PLLN = Config->N;
-                RCC_SET_PLLP_CFG(PLL, Config->P);
-                RCC->PLLCFGR.b.PLLQ = (Config->Q >> 1) - 1;
-                RCC->PLLCFGR.b.PLLR = (Config->R >> 1) - 1;
+                rcc_pllSetup(Config);
 
                 /* Enable the main PLL. */
                 RCC_REG_BIT(CR,PLLON) = OSC_ON;
@@ -357,6 +413,9 @@ XPD_ReturnType XPD_RCC_PLLConfig(const RCC_PLL_InitType * Config)
             result = XPD_WaitForMatch(&RCC->CR.w, RCC_CR_PLLRDY, 0, &timeout);
         }
     }
+    /* the PLL output frequency is recalculated on demand */
+    rcc_clockTree.PLL = 0;
+
     return result;
 }
 
@@ -396,6 +455,10 @@ XPD_ReturnType XPD_RCC_PLLSAI1Config(const RCC_PLL_InitType * Config)
             RCC->PLLSAI1CFGR.b.PLLSAI1Q = (Config->Q >> 1) - 1;
             RCC->PLLSAI1CFGR.b.PLLSAI1R = (Config->R >> 1) - 1;
 
+            /* Enable the PLLSAI1 outputs */
+            SET_BIT(RCC->PLLSAI1CFGR.w, RCC_PLLSAI1CFGR_PLLSAI1PEN |
+                    RCC_PLLSAI1CFGR_PLLSAI1QEN | RCC_PLLSAI1CFGR_PLLSAI1REN);
+
             /* Enable the PLLSAI1 */
             RCC_REG_BIT(CR, PLLSAI1ON) = ENABLE;
 
@@ -406,6 +469,92 @@ XPD_ReturnType XPD_RCC_PLLSAI1Config(const RCC_PLL_InitType * Config)
     return result;
 }
 
+/* PLLSAI1 VCO output frequency limits */
+#define RCC_PLLSAI_VCO_MIN      64000000
+#define RCC_PLLSAI_VCO_MAX      344000000
+#define RCC_PLLSAI_P_MAX_FREQ   80000000
+
+/* SAI master clock divider (2 * MCKDIV) limit */
+#define RCC_SAI_MCKDIV_MAX      15
+
+/**
+ * Configures the SAI1 phase locked loop P output for an audio sample rate.
+ * The factors are selected so that the SAI clock is the closest to 256 x SampleRate
+ * multiplied by one of the SAI master clock dividers.
+ * @note  The PLLSAI1 uses the input clock and M divider of the main PLL,
+ *        which has to be configured beforehand. The Q and R outputs are left unchanged.
+ * @param SampleRate: the audio sample rate in Hz
+ * @return ERROR if no valid setup is found, otherwise the result of @ref XPD_RCC_PLLSAI1Config
+ */
+XPD_ReturnType XPD_RCC_PLLSAI1AudioConfig(uint32_t SampleRate)
+{
+    RCC_PLL_InitType pll = { .State = ENABLE };
+    RCC_OscType pllsrc = XPD_RCC_GetPLLSource();
+    uint32_t unit = 256 * SampleRate;
+    uint32_t bestError = ~0;
+    uint32_t vcoIn, n, p;
+
+    if (pllsrc == NO_OSC)
+    {
+        return XPD_ERROR;
+    }
+    vcoIn = XPD_RCC_GetOscFreq(pllsrc) / (RCC->PLLCFGR.b.PLLM + 1);
+
+    pll.Q = (RCC->PLLSAI1CFGR.b.PLLSAI1Q + 1) * 2;
+    pll.R = (RCC->PLLSAI1CFGR.b.PLLSAI1R + 1) * 2;
+
+#ifdef RCC_PLLP_DIV_2_31_SUPPORT
+    for (p = 2; (p <= 31) && (bestError != 0); p++)
+#else
+    for (p = 7; (p <= 17) && (bestError != 0); p += 10)
+#endif
+    {
+        for (n = 8; n <= 86; n++)
+        {
+            uint32_t vco = vcoIn * n;
+            uint32_t saiclk = vco / p;
+            uint32_t div, error;
+
+            if (vco > RCC_PLLSAI_VCO_MAX)
+            {
+                break;
+            }
+            if ((vco < RCC_PLLSAI_VCO_MIN) || (saiclk > RCC_PLLSAI_P_MAX_FREQ))
+            {
+                continue;
+            }
+
+            /* The closest master clock divider: 1 or 2 x MCKDIV */
+            div = (saiclk + unit) / (2 * unit);
+            if (div > RCC_SAI_MCKDIV_MAX)
+            {
+                continue;
+            }
+            div = ((2 * saiclk) < (3 * unit)) ? 1 : (2 * div);
+
+            /* Master clock deviation */
+            error = (saiclk > (div * unit)) ? (saiclk - div * unit) : (div * unit - saiclk);
+            error = (error + div / 2) / div;
+
+            if (error < bestError)
+            {
+                bestError = error;
+                pll.N = n;
+                pll.P = p;
+            }
+        }
+    }
+
+    if (bestError == (uint32_t)~0)
+    {
+        return XPD_ERROR;
+    }
+    else
+    {
+        return XPD_RCC_PLLSAI1Config(&pll);
+    }
+}
+
 #ifdef RCC_PLLSAI2_SUPPORT
 /**
  * Configures the SAI2 phase locked loop.
@@ -442,6 +591,9 @@ XPD_ReturnType XPD_RCC_PLLSAI2Config(const RCC_PLL_InitType * Config)
             RCC_SET_PLLP_CFG(PLLSAI2, Config->P);
             RCC->PLLSAI2CFGR.b.PLLSAI2R = (Config->R >> 1) - 1;
 
+            /* Enable the PLLSAI2 outputs */
+            SET_BIT(RCC->PLLSAI2CFGR.w, RCC_PLLSAI2CFGR_PLLSAI2PEN | RCC_PLLSAI2CFGR_PLLSAI2REN);
+
             /* Enable the PLLSAI2 */
             RCC_REG_BIT(CR, PLLSAI2ON) = ENABLE;
 
@@ -618,11 +770,16 @@ uint32_t XPD_RCC_GetOscFreq(RCC_OscType Oscillator)
 
         case PLL:
         {
-            m = RCC->PLLCFGR.b.PLLM + 1;
-            n = RCC->PLLCFGR.b.PLLN;
-            r = (RCC->PLLCFGR.b.PLLR + 1) * 2;
+            /* the PLL output is only calculated after reconfiguration */
+            if (rcc_clockTree.PLL == 0)
+            {
+                m = RCC->PLLCFGR.b.PLLM + 1;
+                n = RCC->PLLCFGR.b.PLLN;
+                r = (RCC->PLLCFGR.b.PLLR + 1) * 2;
 
-            return XPD_RCC_GetOscFreq(XPD_RCC_GetPLLSource()) * n / (m * r);
+                rcc_clockTree.PLL = XPD_RCC_GetOscFreq(XPD_RCC_GetPLLSource()) * n / (m * r);
+            }
+            return rcc_clockTree.PLL;
         }
 
         case LSI:
@@ -654,8 +811,10 @@ RCC_OscType XPD_RCC_GetReadyOsc(void)
  */
 void XPD_RCC_IRQHandler(void)
 {
+    XPD_PROFILE_BEGIN();
+
     uint32_t cifr = RCC->CIFR.w;
-    uint32_t cier = RCC->CIFR.w;
+    uint32_t cier = RCC->CIER.w;
 
 #ifdef LSE_VALUE
     /* Check RCC LSERDY flag  */
@@ -685,6 +844,12 @@ void XPD_RCC_IRQHandler(void)
         /* Clear RCC PLLRDY pending bit */
         XPD_RCC_ClearFlag(PLLRDY);
 
+        /* Continue the pending operating point switch */
+        if (rcc_operatingPointPending != FALSE)
+        {
+            rcc_operatingPointProceed();
+        }
+
         /* PLL Ready callback */
         rcc_readyOscillator = PLL;
         XPD_SAFE_CALLBACK(XPD_RCC_Callbacks.OscReady,);
@@ -696,6 +861,12 @@ void XPD_RCC_IRQHandler(void)
         /* Clear RCC HSERDY pending bit */
         XPD_RCC_ClearFlag(HSERDY);
 
+        /* Continue the pending operating point switch */
+        if (rcc_operatingPointPending != FALSE)
+        {
+            rcc_operatingPointProceed();
+        }
+
         /* HSE Ready callback */
         rcc_readyOscillator = HSE;
         XPD_SAFE_CALLBACK(XPD_RCC_Callbacks.OscReady,);
@@ -721,6 +892,8 @@ void XPD_RCC_IRQHandler(void)
         rcc_readyOscillator = MSI;
         XPD_SAFE_CALLBACK(XPD_RCC_Callbacks.OscReady,);
     }
+
+    XPD_PROFILE_END();
 }
 
 /** @} */
@@ -737,7 +910,8 @@ void XPD_RCC_IRQHandler(void)
              @arg @ref RCC_OscType::HSE
              @arg @ref RCC_OscType::PLL
  * @param HCLK_Divider: Clock divider of @ref RCC_ClockType::HCLK clock. Must not be CLK_DIV32.
- * @param FlashLatency: the desired amount of flash wait states
+ * @param FlashLatency: the desired amount of flash wait states,
+ *        or @ref FLASH_LATENCY_AUTO to select the minimal wait states for the new HCLK frequency
  * @return Result of the operation
  * @note To correctly read data from FLASH memory, the number of wait states must be
  * correctly programmed according to the frequency of the CPU clock (HCLK) of the device.
@@ -746,6 +920,7 @@ XPD_ReturnType XPD_RCC_HCLKConfig(RCC_OscType SYSCLK_Source, ClockDividerType HC
 {
     XPD_ReturnType result;
     uint32_t clkDiv;
+    uint8_t prevLatency;
     uint32_t timeout = RCC_CLOCKSWITCH_TIMEOUT;
 
     /* Checking whether the SYSCLK source is ready to be used */
@@ -789,6 +964,15 @@ XPD_ReturnType XPD_RCC_HCLKConfig(RCC_OscType SYSCLK_Source, ClockDividerType HC
             return XPD_ERROR;
     }
 
+    clkDiv = rcc_convertClockDivider(HCLK, HCLK_Divider);
+
+    /* Select the minimal wait states for the new HCLK frequency */
+    if (FlashLatency == FLASH_LATENCY_AUTO)
+    {
+        FlashLatency = XPD_FLASH_GetMinLatency(XPD_RCC_GetOscFreq(SYSCLK_Source) >> AHBPrescTable[clkDiv]);
+    }
+    prevLatency = XPD_FLASH_GetLatency();
+
     /* Increasing the CPU frequency */
     if (FlashLatency > XPD_FLASH_GetLatency())
     {
@@ -804,7 +988,6 @@ XPD_ReturnType XPD_RCC_HCLKConfig(RCC_OscType SYSCLK_Source, ClockDividerType HC
     }
 
     /* Set SYSCLK source and HCLK prescaler */
-    clkDiv = rcc_convertClockDivider(HCLK, HCLK_Divider);
     RCC->CFGR.b.HPRE = clkDiv;
     RCC->CFGR.b.SW   = SYSCLK_Source;
 
@@ -825,12 +1008,21 @@ XPD_ReturnType XPD_RCC_HCLKConfig(RCC_OscType SYSCLK_Source, ClockDividerType HC
         }
     }
 
+    /* Reset the caches after the flash access timing has changed */
+    if (FlashLatency != prevLatency)
+    {
+        XPD_FLASH_ResetCaches();
+    }
+
     /* Update SystemCoreClock variable */
     SystemCoreClock = XPD_RCC_GetOscFreq(SYSCLK_Source) >> AHBPrescTable[clkDiv];
+    rcc_clockTreeUpdate();
 
     /* Configure the source of time base considering new system clocks settings*/
     XPD_InitTimer();
 
+    rcc_clockChanged();
+
     return result;
 }
 
@@ -864,6 +1056,10 @@ void XPD_RCC_PCLKConfig(RCC_ClockType PCLKx, ClockDividerType PCLK_Divider)
         default:
             break;
     }
+
+    rcc_clockTreeUpdate();
+
+    rcc_clockChanged();
 }
 
 /**
@@ -879,13 +1075,13 @@ uint32_t XPD_RCC_GetClockFreq(RCC_ClockType SelectedClock)
         return SystemCoreClock;
 
     case SYSCLK:
-        return XPD_RCC_GetOscFreq(XPD_RCC_GetSYSCLKSource());
+        return rcc_clockTree.SYSCLK;
 
     case PCLK1:
-        return SystemCoreClock >> APBPrescTable[RCC->CFGR.b.PPRE1];
+        return rcc_clockTree.PCLK1;
 
     case PCLK2:
-        return SystemCoreClock >> APBPrescTable[RCC->CFGR.b.PPRE2];
+        return rcc_clockTree.PCLK2;
 
     default:
         return 0;
@@ -894,6 +1090,374 @@ uint32_t XPD_RCC_GetClockFreq(RCC_ClockType SelectedClock)
 
 /** @} */
 
+/** @defgroup RCC_Core_Clocks_Exported_Functions_Scaling RCC Operating Point Functions
+ *  @brief    RCC dynamic frequency and voltage scaling
+ * @{
+ */
+
+/**
+ * @brief Switches the system to a new operating point: configures the clock tree,
+ *        the flash latency and the regulator voltage scaling, then notifies the registered clock change listeners.
+ * @note  The PLL and the regulator are reconfigured while the SYSCLK is provided by HSI.
+ *        The flash latency is always set to the minimal value for the new HCLK frequency.
+ * @param Config: pointer to the operating point configuration
+ * @return Result of the operation
+ */
+XPD_ReturnType XPD_RCC_OperatingPointConfig(const RCC_OperatingPointType * Config)
+{
+    XPD_ReturnType result = XPD_OK;
+
+    rcc_clockTransition = TRUE;
+    XPD_ENERGY_STATE(XPD_ENERGY_CLOCK);
+
+#ifdef HSE_VALUE
+    /* Start the HSE if it's needed by the new clock tree */
+    if ((Config->HSE_State != OSC_OFF) && (RCC_REG_BIT(CR,HSERDY) == 0))
+    {
+        result = XPD_RCC_HSEConfig(Config->HSE_State);
+    }
+#endif
+
+    /* Step on the HSI while the PLL and the regulator are reconfigured */
+#ifdef PWR_CR1_VOS
+    if ((Config->PLL != NULL) || (Config->VoltageScale != XPD_PWR_GetVoltageScale())
+       )
+#else
+    if (Config->PLL != NULL)
+#endif
+    {
+        if (XPD_RCC_GetSYSCLKSource() != HSI)
+        {
+            result = XPD_RCC_HSIConfig(ENABLE);
+
+            if (result == XPD_OK)
+            {
+                result = XPD_RCC_HCLKConfig(HSI, CLK_DIV1, FLASH_LATENCY_AUTO);
+            }
+        }
+#ifdef PWR_CR1_VOS
+        if ((result == XPD_OK) && (Config->VoltageScale != XPD_PWR_GetVoltageScale()))
+        {
+            XPD_PWR_ClockCtrl(ENABLE);
+
+            result = XPD_PWR_VoltageScaleConfig(Config->VoltageScale);
+        }
+#endif
+        if ((result == XPD_OK) && (Config->PLL != NULL))
+        {
+            result = XPD_RCC_PLLConfig(Config->PLL);
+        }
+    }
+
+    if (result == XPD_OK)
+    {
+        uint32_t hclk = XPD_RCC_GetOscFreq(Config->SYSCLK_Source)
+                >> AHBPrescTable[rcc_convertClockDivider(HCLK, Config->HCLK_Divider)];
+
+        /* The APB dividers are set on the lower HCLK frequency,
+         * so the APB clocks remain within limits during the transition */
+        if (hclk > XPD_RCC_GetClockFreq(HCLK))
+        {
+            XPD_RCC_PCLKConfig(PCLK1, Config->PCLK1_Divider);
+            XPD_RCC_PCLKConfig(PCLK2, Config->PCLK2_Divider);
+
+            result = XPD_RCC_HCLKConfig(Config->SYSCLK_Source, Config->HCLK_Divider, FLASH_LATENCY_AUTO);
+        }
+        else
+        {
+            result = XPD_RCC_HCLKConfig(Config->SYSCLK_Source, Config->HCLK_Divider, FLASH_LATENCY_AUTO);
+
+            XPD_RCC_PCLKConfig(PCLK1, Config->PCLK1_Divider);
+            XPD_RCC_PCLKConfig(PCLK2, Config->PCLK2_Divider);
+        }
+    }
+
+    /* Notify the listeners once about the new clock configuration */
+    rcc_clockTransition = FALSE;
+    XPD_ENERGY_STATE(XPD_ENERGY_RUN);
+    rcc_clockChanged();
+
+    return result;
+}
+
+/* advances the pending operating point switch: starts the next oscillator
+ * which isn't ready yet, or completes the switch when all of them are */
+static void rcc_operatingPointProceed(void)
+{
+#ifdef HSE_VALUE
+    if ((rcc_pendingOperatingPoint.HSE_State != OSC_OFF) && (RCC_REG_BIT(CR,HSERDY) == 0))
+    {
+        /* Start the HSE, continue on HSERDY interrupt */
+        XPD_RCC_EnableIT(HSERDY);
+
+        if (RCC_REG_BIT(CR,HSEON) == 0)
+        {
+            RCC_REG_BIT(CR,HSEBYP) = rcc_pendingOperatingPoint.HSE_State >> 1;
+            RCC_REG_BIT(CR,HSEON)  = 1;
+        }
+    }
+    else
+#endif
+    if ((rcc_pendingOperatingPoint.PLL != NULL) && (rcc_pendingOperatingPoint.PLL->State != OSC_OFF))
+    {
+        const RCC_PLL_InitType * pll = rcc_pendingOperatingPoint.PLL;
+        uint32_t timeout = RCC_PLL_TIMEOUT;
+
+        /* The PLL is started only once, the completion leaves it untouched */
+        rcc_pendingOperatingPoint.PLL = NULL;
+
+        /* Disable the main PLL. */
+        RCC_REG_BIT(CR,PLLON) = OSC_OFF;
+        (void) XPD_WaitForMatch(&RCC->CR.w, RCC_CR_PLLRDY, 0, &timeout);
+
+#ifdef PWR_CR1_VOS
+        /* The voltage scaling is set while the PLL is off */
+        if (rcc_pendingOperatingPoint.VoltageScale != XPD_PWR_GetVoltageScale())
+        {
+            XPD_PWR_ClockCtrl(ENABLE);
+
+            (void) XPD_PWR_VoltageScaleConfig(rcc_pendingOperatingPoint.VoltageScale);
+        }
+#endif
+
+        /* Configure the PLL while it's disabled */
+        rcc_pllSetup(pll);
+
+        /* the PLL output frequency is recalculated on demand */
+        rcc_clockTree.PLL = 0;
+
+        /* Start the PLL, continue on PLLRDY interrupt */
+        XPD_RCC_EnableIT(PLLRDY);
+        RCC_REG_BIT(CR,PLLON) = OSC_ON;
+        RCC_REG_BIT(PLLCFGR,PLLREN) = ENABLE;
+    }
+    else
+    {
+        /* All oscillators are ready, the switch is completed in thread context */
+        rcc_operatingPointReady = TRUE;
+    }
+}
+
+/**
+ * @brief Starts the switch to a new operating point without waiting for the oscillators to stabilize.
+ *        The HSE and the PLL are started in the background, and when they are ready
+ *        the switch is completed by @ref XPD_RCC_OperatingPointComplete.
+ *        Meanwhile the application can carry on with its clock independent initialization
+ *        (GPIO, DMA, RAM structures) on the current MSI clock.
+ * @note  The RCC interrupt has to be enabled in the NVIC, it only starts the oscillators.
+ *        The readiness is signalled by the OscReady callback with @ref XPD_RCC_GetReadyOsc
+ *        returning PLL (or HSE), then @ref XPD_RCC_OperatingPointComplete has to be called
+ *        from thread context, which notifies the registered clock change listeners.
+ * @param Config: pointer to the operating point configuration (copied)
+ * @return BUSY if a switch is already pending or the PLL to reconfigure provides the SYSCLK, OK otherwise
+ */
+XPD_ReturnType XPD_RCC_OperatingPointConfig_IT(const RCC_OperatingPointType * Config)
+{
+    XPD_ReturnType result = XPD_OK;
+
+    if ((rcc_operatingPointPending != FALSE)
+     || ((Config->PLL != NULL) && (XPD_RCC_GetSYSCLKSource() == PLL)))
+    {
+        result = XPD_BUSY;
+    }
+    else
+    {
+        rcc_pendingOperatingPoint = *Config;
+        rcc_operatingPointPending = TRUE;
+        rcc_operatingPointReady   = FALSE;
+
+        rcc_operatingPointProceed();
+    }
+    return result;
+}
+
+/**
+ * @brief Completes the operating point switch started by @ref XPD_RCC_OperatingPointConfig_IT
+ *        once its oscillators are ready. The clock tree reconfiguration waits for the clock
+ *        switch and the regulator, therefore it's performed in thread context
+ *        instead of @ref XPD_RCC_IRQHandler.
+ * @return BUSY if the oscillators are still starting, OK if no switch is pending,
+ *         otherwise the result of @ref XPD_RCC_OperatingPointConfig
+ */
+XPD_ReturnType XPD_RCC_OperatingPointComplete(void)
+{
+    XPD_ReturnType result = XPD_OK;
+
+    if (rcc_operatingPointPending != FALSE)
+    {
+        if (rcc_operatingPointReady == FALSE)
+        {
+            result = XPD_BUSY;
+        }
+        else
+        {
+            rcc_operatingPointPending = FALSE;
+            rcc_operatingPointReady   = FALSE;
+
+            result = XPD_RCC_OperatingPointConfig(&rcc_pendingOperatingPoint);
+        }
+    }
+    return result;
+}
+
+/**
+ * @brief Registers a listener which is notified after each change of the core clocks,
+ *        so that the clock dependent peripheral settings can be recalculated.
+ * @note  The peripheral drivers provide such callbacks, e.g. @ref XPD_USART_ClockUpdate,
+ *        @ref XPD_SPI_ClockUpdate and @ref XPD_TIM_ClockUpdate.
+ * @param Listener: pointer to the listener, which has to remain valid while it's registered
+ */
+void XPD_RCC_ClockListener_Register(RCC_ClockListenerType * Listener)
+{
+    Listener->Next = rcc_clockListeners;
+    rcc_clockListeners = Listener;
+}
+
+/**
+ * @brief Removes a listener from the clock change notification list.
+ * @param Listener: pointer to the registered listener
+ */
+void XPD_RCC_ClockListener_Unregister(RCC_ClockListenerType * Listener)
+{
+    RCC_ClockListenerType ** link;
+
+    for (link = &rcc_clockListeners; *link != NULL; link = &(*link)->Next)
+    {
+        if (*link == Listener)
+        {
+            *link = Listener->Next;
+            break;
+        }
+    }
+}
+
+/* the Run mode operating point which is restored after Stop mode wakeup */
+static const RCC_OperatingPointType * rcc_runOperatingPoint = NULL;
+
+/* selects the Stop mode wakeup oscillator, which the restored clock tree is derived from,
+ * or HSI, which starts faster than the HSE */
+static RCC_OscType rcc_stopWakeUpOsc(void)
+{
+    RCC_OscType osc = MSI;
+
+    if (rcc_runOperatingPoint != NULL)
+    {
+        osc = rcc_runOperatingPoint->SYSCLK_Source;
+
+        if (osc == PLL)
+        {
+            osc = (rcc_runOperatingPoint->PLL != NULL) ?
+                    rcc_runOperatingPoint->PLL->Source : XPD_RCC_GetPLLSource();
+        }
+        if (osc != MSI)
+        {
+            osc = HSI;
+        }
+    }
+    return osc;
+}
+
+/**
+ * @brief Switches the system to Run mode (voltage range 1 or 2) or to Low-power run mode
+ *        at the selected operating point, which is also restored after Stop mode wakeup
+ *        by @ref XPD_RCC_StopMode.
+ * @note  The regulator voltage scaling can only be changed in Run mode, therefore Low-power run
+ *        is left before the operating point is applied.
+ * @note  For Low-power run mode the operating point shall use MSI as SYSCLK source
+ *        (configured by @ref XPD_RCC_MSIConfig), and its HCLK shall not exceed 2 MHz.
+ * @param Config: pointer to the operating point configuration (referenced)
+ * @param LowPowerRun: ENABLE to enter Low-power run mode after the operating point is applied
+ * @return ERROR if the HCLK is too high for Low-power run, TIMEOUT if Low-power run was not left,
+ *         otherwise the result of the operating point configuration
+ */
+XPD_ReturnType XPD_RCC_RunModeConfig(const RCC_OperatingPointType * Config, FunctionalState LowPowerRun)
+{
+    XPD_ReturnType result = XPD_OK;
+
+    XPD_PWR_ClockCtrl(ENABLE);
+
+    if (PWR_REG_BIT(CR1, LPR) != 0)
+    {
+        result = XPD_PWR_LowPowerRunMode(DISABLE);
+    }
+    if (result == XPD_OK)
+    {
+        result = XPD_RCC_OperatingPointConfig(Config);
+    }
+    if (result == XPD_OK)
+    {
+        rcc_runOperatingPoint = Config;
+
+        if (LowPowerRun != DISABLE)
+        {
+            if (XPD_RCC_GetClockFreq(HCLK) > RCC_LPRUN_MAX_HCLK)
+            {
+                result = XPD_ERROR;
+            }
+            else
+            {
+                (void) XPD_PWR_LowPowerRunMode(ENABLE);
+            }
+        }
+    }
+    return result;
+}
+
+/**
+ * @brief Enters the selected Stop mode, and after wakeup restores the Run or Low-power run mode
+ *        the system was in, at the operating point set by @ref XPD_RCC_RunModeConfig.
+ *        The system wakes up on the oscillator (MSI or HSI) which the restored clock tree
+ *        is derived from, so only the PLL and HSE have to be restarted.
+ * @note  The peripherals keep their enabled clocks, and the clock change listeners are notified
+ *        when the clock tree is restored.
+ * @note  Low-power run mode is left to enter Stop 2 mode, and entered again after wakeup.
+ *        In Stop 2 mode only a reduced set of peripherals is functional.
+ * @param WakeUpOn: Specifies if STOP mode is exited with WFI or WFE instruction
+ *           This parameter can be one of the following values:
+ *            @arg REACTION_IT: enter STOP mode with WFI instruction
+ *            @arg REACTION_EVENT: enter STOP mode with WFE instruction
+ * @param Mode: the Stop mode to enter
+ * @return TIMEOUT if Low-power run was not left, otherwise the result of the clock tree restoration
+ */
+XPD_ReturnType XPD_RCC_StopMode(ReactionType WakeUpOn, PWR_StopModeType Mode)
+{
+    XPD_ReturnType result = XPD_OK;
+    boolean_t lowPowerRun = (PWR_REG_BIT(CR1, LPR) != 0) ? TRUE : FALSE;
+
+    if ((lowPowerRun != FALSE) && (Mode == PWR_STOP2))
+    {
+        result = XPD_PWR_LowPowerRunMode(DISABLE);
+    }
+
+    if (result == XPD_OK)
+    {
+        /* Low-power run can only be resumed on the MSI */
+        RCC_REG_BIT(CFGR, STOPWUCK) = ((lowPowerRun == FALSE) && (rcc_stopWakeUpOsc() == HSI)) ? 1 : 0;
+
+        XPD_PWR_StopModeSelect(WakeUpOn, Mode);
+
+        /* The SYSCLK is provided by the wakeup oscillator, the PLL and the HSE are stopped */
+        XPD_RCC_ClockTreeSync();
+
+        if (rcc_runOperatingPoint != NULL)
+        {
+            result = XPD_RCC_OperatingPointConfig(rcc_runOperatingPoint);
+        }
+        else
+        {
+            rcc_clockChanged();
+        }
+
+        if ((lowPowerRun != FALSE) && (Mode == PWR_STOP2))
+        {
+            (void) XPD_PWR_LowPowerRunMode(ENABLE);
+        }
+    }
+    return result;
+}
+
+/** @} */
+
 /** @defgroup RCC_Core_Clocks_Exported_Functions_MCO RCC Clock Outputs
  *  @brief    RCC microcontroller clock outputs
  * @{
@@ -1021,6 +1585,26 @@ void XPD_RCC_Deinit(void)
 
     /* Default MSI clock is 4 MHz */
     SystemCoreClock = 4000000;
+    rcc_clockTree.SYSCLK = 4000000;
+    rcc_clockTree.PCLK1  = 4000000;
+    rcc_clockTree.PCLK2  = 4000000;
+    rcc_clockTree.PLL    = 0;
+
+    rcc_operatingPointPending = FALSE;
+    rcc_operatingPointReady   = FALSE;
+}
+
+/**
+ * @brief Updates the cached clock frequencies to the current clock configuration,
+ *        which was set up before the application started (e.g. by a boot loader).
+ */
+void XPD_RCC_ClockTreeSync(void)
+{
+    rcc_clockTree.PLL = 0;
+
+    /* Update SystemCoreClock variable */
+    SystemCoreClock = XPD_RCC_GetOscFreq(XPD_RCC_GetSYSCLKSource()) >> AHBPrescTable[RCC->CFGR.b.HPRE];
+    rcc_clockTreeUpdate();
 }
 
 /**
@@ -26,20 +26,20 @@
 #ifdef RCC_PLLP_DIV_2_31_SUPPORT
 #define RCC_PLLP_FREQ(PLL_NAME) \
     (XPD_RCC_GetOscFreq(XPD_RCC_GetPLLSource()) * RCC->PLL_NAME##CFGR.b.PLL_NAME##N \
-    / (RCC->PLLCFGR.b.PLLM * RCC->PLL_NAME##CFGR.b.PLL_NAME##PDIV))
+    / ((RCC->PLLCFGR.b.PLLM + 1) * RCC->PLL_NAME##CFGR.b.PLL_NAME##PDIV))
 #else
 #define RCC_PLLP_FREQ(PLL_NAME) \
     (XPD_RCC_GetOscFreq(XPD_RCC_GetPLLSource()) * RCC->PLL_NAME##CFGR.b.PLL_NAME##N \
-    / (RCC->PLLCFGR.b.PLLM * ((RCC->PLL_NAME##CFGR.b.PLL_NAME##P == 0) ? 7 : 17)))
+    / ((RCC->PLLCFGR.b.PLLM + 1) * ((RCC->PLL_NAME##CFGR.b.PLL_NAME##P == 0) ? 7 : 17)))
 #endif
 
 #define RCC_PLLR_FREQ(PLL_NAME) \
     (XPD_RCC_GetOscFreq(XPD_RCC_GetPLLSource()) * RCC->PLL_NAME##CFGR.b.PLL_NAME##N \
-    / (RCC->PLLCFGR.b.PLLM * (2 * (RCC->PLL_NAME##CFGR.b.PLL_NAME##R + 1))))
+    / ((RCC->PLLCFGR.b.PLLM + 1) * (2 * (RCC->PLL_NAME##CFGR.b.PLL_NAME##R + 1))))
 
 #define RCC_PLLQ_FREQ(PLL_NAME) \
     (XPD_RCC_GetOscFreq(XPD_RCC_GetPLLSource()) * RCC->PLL_NAME##CFGR.b.PLL_NAME##N \
-    / (RCC->PLLCFGR.b.PLLM * (2 * (RCC->PLL_NAME##CFGR.b.PLL_NAME##Q + 1))))
+    / ((RCC->PLLCFGR.b.PLLM + 1) * (2 * (RCC->PLL_NAME##CFGR.b.PLL_NAME##Q + 1))))
 
 #if defined(USE_XPD_ADC)
 #include "xpd_adc.h"
@@ -244,6 +244,94 @@ uint32_t XPD_I2C_GetClockFreq(I2C_HandleType * hi2c)
 
 #endif /* USE_XPD_I2C */
 
+#if defined(USE_XPD_LPTIM)
+#include "xpd_lptim.h"
+
+/** @addtogroup LPTIM
+ * @{ */
+
+/** @addtogroup LPTIM_Clock_Source
+ * @{ */
+
+/** @defgroup LPTIM_Clock_Source_Exported_Functions LPTIM Clock Source Exported Functions
+ * @{ */
+
+/**
+ * @brief Sets the new source clock for the selected LPTIM.
+ * @param hlptim: pointer to the LPTIM handle structure
+ * @param ClockSource: the new source clock which should be configured
+ */
+void XPD_LPTIM_ClockConfig(LPTIM_HandleType * hlptim, LPTIM_ClockSourceType ClockSource)
+{
+    switch ((uint32_t)hlptim->Inst)
+    {
+#ifdef RCC_CCIPR_LPTIM1SEL
+        case LPTIM1_BASE:
+            RCC->CCIPR.b.LPTIM1SEL = ClockSource;
+            break;
+#endif
+#ifdef RCC_CCIPR_LPTIM2SEL
+        case LPTIM2_BASE:
+            RCC->CCIPR.b.LPTIM2SEL = ClockSource;
+            break;
+#endif
+        default:
+            break;
+    }
+}
+
+/**
+ * @brief Returns the input clock frequency of the LPTIM.
+ * @param hlptim: pointer to the LPTIM handle structure
+ * @return The clock frequency of the LPTIM in Hz
+ */
+uint32_t XPD_LPTIM_GetClockFreq(LPTIM_HandleType * hlptim)
+{
+    LPTIM_ClockSourceType source;
+
+    switch ((uint32_t)hlptim->Inst)
+    {
+#ifdef RCC_CCIPR_LPTIM1SEL
+        case LPTIM1_BASE:
+            source = RCC->CCIPR.b.LPTIM1SEL;
+            break;
+#endif
+#ifdef RCC_CCIPR_LPTIM2SEL
+        case LPTIM2_BASE:
+            source = RCC->CCIPR.b.LPTIM2SEL;
+            break;
+#endif
+        default:
+            source = LPTIM_CLOCKSOURCE_PCLK1;
+            break;
+    }
+    /* get the value for the configured source */
+    switch (source)
+    {
+        case LPTIM_CLOCKSOURCE_LSI:
+            return LSI_VALUE;
+
+        case LPTIM_CLOCKSOURCE_HSI:
+            return HSI_VALUE;
+
+#ifdef LSE_VALUE
+        case LPTIM_CLOCKSOURCE_LSE:
+            return LSE_VALUE;
+#endif
+
+        default:
+            return XPD_RCC_GetClockFreq(PCLK1);
+    }
+}
+
+/** @} */
+
+/** @} */
+
+/** @} */
+
+#endif /* USE_XPD_LPTIM */
+
 #if defined(USE_XPD_RTC)
 #include "xpd_pwr.h"
 #include "xpd_rtc.h"
@@ -352,6 +440,119 @@ uint32_t XPD_RTC_GetClockFreq(void)
 /** @} */
 #endif /* USE_XPD_RTC */
 
+#if defined(USE_XPD_SAI)
+#include "xpd_sai.h"
+
+/** @addtogroup SAI
+ * @{ */
+
+/** @addtogroup SAI_Clock_Source
+ * @{ */
+
+/** @defgroup SAI_Clock_Source_Exported_Functions SAI Clock Source Exported Functions
+ * @{ */
+
+/**
+ * @brief Sets the new source clock for the selected SAI.
+ * @param hsai: pointer to the SAI handle structure
+ * @param ClockSource: the new source clock which should be configured
+ */
+void XPD_SAI_ClockConfig(SAI_HandleType * hsai, SAI_ClockSourceType ClockSource)
+{
+#ifdef SAI2
+    if ((hsai->Inst == SAI2_Block_A) || (hsai->Inst == SAI2_Block_B))
+    {
+        RCC->CCIPR.b.SAI2SEL = ClockSource;
+    }
+    else
+#endif
+    {
+        RCC->CCIPR.b.SAI1SEL = ClockSource;
+    }
+}
+
+/**
+ * @brief Returns the input clock frequency of the SAI.
+ * @param hsai: pointer to the SAI handle structure
+ * @return The clock frequency of the SAI in Hz
+ */
+uint32_t XPD_SAI_GetClockFreq(SAI_HandleType * hsai)
+{
+    uint32_t source = RCC->CCIPR.b.SAI1SEL;
+
+#ifdef SAI2
+    if ((hsai->Inst == SAI2_Block_A) || (hsai->Inst == SAI2_Block_B))
+    {
+        source = RCC->CCIPR.b.SAI2SEL;
+    }
+#endif
+
+    switch (source)
+    {
+        case SAI_CLOCKSOURCE_PLLSAI1:
+            return RCC_PLLP_FREQ(PLLSAI1);
+
+#ifdef RCC_PLLSAI2_SUPPORT
+        case SAI_CLOCKSOURCE_PLLSAI2:
+            return RCC_PLLP_FREQ(PLLSAI2);
+#endif
+
+        case SAI_CLOCKSOURCE_PLL:
+            return RCC_PLLP_FREQ(PLL);
+
+        default:
+#ifdef EXTERNAL_SAI1_CLOCK_VALUE
+            return EXTERNAL_SAI1_CLOCK_VALUE;
+#else
+            return 0;
+#endif
+    }
+}
+
+/** @} */
+
+/** @} */
+
+/** @} */
+#endif /* USE_XPD_SAI */
+
+#if defined(USE_XPD_SPI)
+#include "xpd_spi.h"
+
+/** @addtogroup SPI
+ * @{ */
+
+/** @addtogroup SPI_Clock_Source
+ * @{ */
+
+/** @defgroup SPI_Clock_Source_Exported_Functions SPI Clock Source Exported Functions
+ * @{ */
+
+/**
+ * @brief Returns the input clock frequency of the SPI.
+ * @param hspi: pointer to the SPI handle structure
+ * @return The clock frequency of the SPI in Hz
+ */
+uint32_t XPD_SPI_GetClockFreq(SPI_HandleType * hspi)
+{
+    /* decide which APB bus the SPI is on */
+    if (((uint32_t)hspi->Inst) < APB2PERIPH_BASE)
+    {
+        return XPD_RCC_GetClockFreq(PCLK1);
+    }
+    else
+    {
+        return XPD_RCC_GetClockFreq(PCLK2);
+    }
+}
+
+/** @} */
+
+/** @} */
+
+/** @} */
+#endif /* USE_XPD_SPI */
+
 #if defined(USE_XPD_TIM)
 #include "xpd_tim.h"
 
@@ -454,6 +655,11 @@ void XPD_USART_ClockConfig(USART_HandleType * husart, USART_ClockSourceType Cloc
         case UART5_BASE:
             RCC->CCIPR.b.UART5SEL = ClockSource;
             break;
+#endif
+#ifdef RCC_CCIPR_LPUART1SEL
+        case LPUART1_BASE:
+            RCC->CCIPR.b.LPUART1SEL = ClockSource;
+            break;
 #endif
         default:
             break;
@@ -496,6 +702,11 @@ uint32_t XPD_USART_GetClockFreq(USART_HandleType * husart)
         case UART5_BASE:
             source = RCC->CCIPR.b.UART5SEL;
             break;
+#endif
+#ifdef RCC_CCIPR_LPUART1SEL
+        case LPUART1_BASE:
+            source = RCC->CCIPR.b.LPUART1SEL;
+            break;
 #endif
         default:
             source = USART_CLOCKSOURCE_PCLKx;
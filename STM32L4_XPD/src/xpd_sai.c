@@ -0,0 +1,493 @@
+/**
+  ******************************************************************************
+  * @file    xpd_sai.c
+  * @author  Benedek Kupper
+  * @version V0.1
+  * @date    2018-01-20
+  * @brief   STM32 eXtensible Peripheral Drivers SAI Module
+  *
+  *  This file is part of STM32_XPD.
+  *
+  *  STM32_XPD is free software: you can redistribute it and/or modify
+  *  it under the terms of the GNU General Public License as published by
+  *  the Free Software Foundation, either version 3 of the License, or
+  *  (at your option) any later version.
+  *
+  *  STM32_XPD is distributed in the hope that it will be useful,
+  *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with STM32_XPD.  If not, see <http://www.gnu.org/licenses/>.
+  */
+#include "xpd_sai.h"
+#include "xpd_rcc.h"
+#include "xpd_utils.h"
+
+#if defined(USE_XPD_SAI)
+
+/** @addtogroup SAI
+ * @{ */
+
+#define SAI_DISABLE_TIMEOUT     10
+
+/* Master clock divider (2 * MCKDIV) limit */
+#define SAI_MCKDIV_MAX          15
+
+/* The receiver and slave bits of the audio block mode */
+#define SAI_MODE_RX             1
+#define SAI_MODE_SLAVE          2
+
+/* Data size register values and bit counts of the data formats */
+static const uint8_t sai_dataSizeTable[] = { 4, 4, 6, 7 };
+static const uint8_t sai_dataBitsTable[] = { 16, 16, 24, 32 };
+
+static void sai_dmaHalfBlockRedirect(void * hdma)
+{
+    SAI_HandleType * hsai = (SAI_HandleType*) ((DMA_HandleType*) hdma)->Owner;
+
+    /* The first half of the double buffers is transferred */
+    hsai->TxBlock.buffer = hsai->TxBuffer;
+    hsai->RxBlock.buffer = hsai->RxBuffer;
+
+    XPD_STATS_ADD(hsai, Transfers, 1);
+
+    XPD_SAFE_CALLBACK(hsai->Callbacks.BlockReady, hsai);
+}
+
+static void sai_dmaBlockRedirect(void * hdma)
+{
+    SAI_HandleType * hsai = (SAI_HandleType*) ((DMA_HandleType*) hdma)->Owner;
+
+    /* The second half of the double buffers is transferred */
+    if (hsai->TxBuffer != NULL)
+    {
+        hsai->TxBlock.buffer = (uint8_t*)hsai->TxBuffer + hsai->TxBlock.length * hsai->TxBlock.size;
+    }
+    if (hsai->RxBuffer != NULL)
+    {
+        hsai->RxBlock.buffer = (uint8_t*)hsai->RxBuffer + hsai->RxBlock.length * hsai->RxBlock.size;
+    }
+
+    XPD_STATS_ADD(hsai, Transfers, 1);
+
+    XPD_SAFE_CALLBACK(hsai->Callbacks.BlockReady, hsai);
+}
+
+#ifdef USE_XPD_DMA_ERROR_DETECT
+static void sai_dmaErrorRedirect(void * hdma)
+{
+    SAI_HandleType * hsai = (SAI_HandleType*) ((DMA_HandleType*) hdma)->Owner;
+
+    /* Update error code */
+    hsai->Errors |= SAI_ERROR_DMA;
+    XPD_STATS_ERROR(hsai, SAI_ERROR_DMA);
+
+    XPD_SAFE_CALLBACK(hsai->Callbacks.Error, hsai);
+}
+#endif
+
+#ifdef USE_XPD_SAI_ERROR_DETECT
+/* Reads and clears the error flags of an audio block */
+static SAI_ErrorType sai_getErrors(SAI_Block_TypeDef * SAIx)
+{
+    SAI_ErrorType errors = SAI_ERROR_NONE;
+    uint32_t sr = SAIx->SR;
+
+    if ((sr & SAI_xSR_OVRUDR) != 0)
+    {
+        errors |= SAI_ERROR_OVRUDR;
+    }
+    if ((sr & SAI_xSR_WCKCFG) != 0)
+    {
+        errors |= SAI_ERROR_CLOCK;
+    }
+    SAIx->CLRFR = sr & (SAI_xCLRFR_COVRUDR | SAI_xCLRFR_CWCKCFG);
+
+    return errors;
+}
+#endif
+
+/* Disables the audio block, its state changes at the end of the current frame */
+static XPD_ReturnType sai_disable(SAI_Block_TypeDef * SAIx)
+{
+    uint32_t timeout = SAI_DISABLE_TIMEOUT;
+
+    CLEAR_BIT(SAIx->CR1, SAI_xCR1_SAIEN | SAI_xCR1_DMAEN);
+
+    return XPD_WaitForMatch(&SAIx->CR1, SAI_xCR1_SAIEN, 0, &timeout);
+}
+
+/** @defgroup SAI_Exported_Functions SAI Exported Functions
+ * @{ */
+
+/**
+ * @brief Initializes the SAI audio block (and the other block for full-duplex)
+ *        for two-slot stereo audio frames.
+ * @note  In master mode the master clock (256 x SampleRate) divider is set up
+ *        from @ref XPD_SAI_GetClockFreq, the SAI clock has to be configured beforehand
+ *        (see @ref XPD_RCC_PLLSAI1AudioConfig).
+ * @param hsai: pointer to the SAI handle structure
+ * @param Config: pointer to SAI setup configuration
+ * @return ERROR if the sample rate cannot be set, TIMEOUT if the block cannot be disabled,
+ *         OK otherwise
+ */
+XPD_ReturnType XPD_SAI_Init(SAI_HandleType * hsai, const SAI_InitType * Config)
+{
+    XPD_ReturnType result;
+    uint32_t slot = (Config->Format == SAI_DATA_16) ? 16 : 32;
+    uint32_t cr1, frcr, slotr;
+
+    /* enable clock */
+    XPD_SAFE_CALLBACK(hsai->ClockCtrl, ENABLE);
+
+    result = sai_disable(hsai->Inst);
+    if ((result == XPD_OK) && (Config->FullDuplex != DISABLE))
+    {
+        result = sai_disable(hsai->Ext);
+    }
+    if (result != XPD_OK)
+    {
+        return result;
+    }
+
+    /* Free protocol with data output on the falling, sampling on the rising clock edge */
+    cr1 = ((uint32_t)sai_dataSizeTable[Config->Format] << SAI_xCR1_DS_Pos) | SAI_xCR1_CKSTR;
+
+    /* Stereo frame of two slots */
+    frcr = (2 * slot - 1) << SAI_xFRCR_FRL_Pos;
+    slotr = (3 << SAI_xSLOTR_SLOTEN_Pos) | (1 << SAI_xSLOTR_NBSLOT_Pos)
+          | (((slot == 16) ? 1 : 2) << SAI_xSLOTR_SLOTSZ_Pos);
+
+    switch (Config->Standard)
+    {
+        case SAI_STANDARD_PCM_SHORT:
+            frcr |= SAI_xFRCR_FSPOL | SAI_xFRCR_FSOFF;
+            break;
+
+        case SAI_STANDARD_PCM_LONG:
+            frcr |= (12 << SAI_xFRCR_FSALL_Pos) | SAI_xFRCR_FSPOL;
+            break;
+
+        case SAI_STANDARD_PHILIPS:
+            /* Left channel while FS is low, one bit before the data */
+            frcr |= ((slot - 1) << SAI_xFRCR_FSALL_Pos) | SAI_xFRCR_FSDEF | SAI_xFRCR_FSOFF;
+            break;
+
+        case SAI_STANDARD_LSB:
+            slotr |= (slot - sai_dataBitsTable[Config->Format]) << SAI_xSLOTR_FBOFF_Pos;
+            /* no break */
+
+        default:
+            frcr |= ((slot - 1) << SAI_xFRCR_FSALL_Pos) | SAI_xFRCR_FSDEF | SAI_xFRCR_FSPOL;
+            break;
+    }
+
+    if (Config->Mode < SAI_MODE_SLAVE_TX)
+    {
+        uint32_t clk  = XPD_SAI_GetClockFreq(hsai);
+        uint32_t unit = 256 * Config->SampleRate;
+        uint32_t div  = (clk + unit) / (2 * unit);
+
+        /* The closest master clock divider: 1 or 2 x MCKDIV */
+        if ((2 * clk) < (3 * unit))
+        {
+            div = 0;
+        }
+
+        if ((clk >= (unit / 2)) && (div <= SAI_MCKDIV_MAX))
+        {
+            cr1 |= div << SAI_xCR1_MCKDIV_Pos;
+
+            hsai->SampleRate = clk / (256 * ((div == 0) ? 1 : (2 * div)));
+        }
+        else
+        {
+            result = XPD_ERROR;
+        }
+    }
+    else
+    {
+        hsai->SampleRate = Config->SampleRate;
+    }
+
+    hsai->Inst->CR1   = cr1 | ((uint32_t)Config->Mode << SAI_xCR1_MODE_Pos);
+    hsai->Inst->CR2   = (1 << SAI_xCR2_FTH_Pos) | SAI_xCR2_FFLUSH;
+    hsai->Inst->FRCR  = frcr;
+    hsai->Inst->SLOTR = slotr;
+    hsai->Inst->IMR   = 0;
+
+    /* Each slot sample is transferred as one half-word or word */
+    hsai->FrameSize = (Config->Format > SAI_DATA_16_EXTENDED) ? 8 : 4;
+
+    /* The other block is a synchronous slave in the opposite direction */
+    hsai->Duplex = 0;
+    if (Config->FullDuplex != DISABLE)
+    {
+        uint32_t mode = SAI_MODE_SLAVE | ((Config->Mode & SAI_MODE_RX) ^ SAI_MODE_RX);
+
+        hsai->Ext->CR1   = (cr1 & ~SAI_xCR1_MCKDIV) | (mode << SAI_xCR1_MODE_Pos)
+                         | (1 << SAI_xCR1_SYNCEN_Pos);
+        hsai->Ext->CR2   = (1 << SAI_xCR2_FTH_Pos) | SAI_xCR2_FFLUSH;
+        hsai->Ext->FRCR  = frcr;
+        hsai->Ext->SLOTR = slotr;
+        hsai->Ext->IMR   = 0;
+        hsai->Duplex = 1;
+    }
+
+#if defined(USE_XPD_SAI_ERROR_DETECT) || defined(USE_XPD_DMA_ERROR_DETECT)
+    hsai->Errors = SAI_ERROR_NONE;
+#endif
+
+    /* Dependencies initialization */
+    XPD_SAFE_CALLBACK(hsai->Callbacks.DepInit, hsai);
+
+    return result;
+}
+
+/**
+ * @brief Restores the SAI peripheral to its default inactive state.
+ * @param hsai: pointer to the SAI handle structure
+ * @return OK
+ */
+XPD_ReturnType XPD_SAI_Deinit(SAI_HandleType * hsai)
+{
+    (void) sai_disable(hsai->Inst);
+    hsai->Inst->CR1 = 0;
+    if (hsai->Duplex != 0)
+    {
+        (void) sai_disable(hsai->Ext);
+        hsai->Ext->CR1 = 0;
+    }
+
+    /* Deinitialize peripheral dependencies */
+    XPD_SAFE_CALLBACK(hsai->Callbacks.DepDeinit, hsai);
+
+    /* Disable clock */
+    XPD_SAFE_CALLBACK(hsai->ClockCtrl, DISABLE);
+
+    return XPD_OK;
+}
+
+/**
+ * @brief Starts continuous DMA-managed audio streaming with double buffers.
+ *        The BlockReady callback is called each time a block is transferred:
+ *        the handle's RxBlock is filled with received frames, the TxBlock is free to refill,
+ *        while the DMA transfers the other halves of the buffers.
+ * @note  The transmit buffer shall be filled completely before the start.
+ *        The used DMAs must be initialized in circular mode, their data width is set
+ *        according to the slot size. In full-duplex operation the callbacks are driven
+ *        by the receive DMA, the transmit DMA runs ahead so its block is already sent by then.
+ *        The streaming is stopped by @ref XPD_SAI_Stream_Stop.
+ * @param hsai: pointer to the SAI handle structure
+ * @param TxBuffer: memory address of the transmit double buffer (NULL if not used)
+ * @param RxBuffer: memory address of the receive double buffer (NULL if not used)
+ * @param BlockSize: the number of stereo frames in a single block
+ * @return ERROR if the configuration doesn't support the directions or the DMA is not circular,
+ *         BUSY if a DMA is in use, OK if successful
+ */
+XPD_ReturnType XPD_SAI_Stream_Start(SAI_HandleType * hsai, void * TxBuffer,
+        void * RxBuffer, uint16_t BlockSize)
+{
+    XPD_ReturnType result = XPD_ERROR;
+    SAI_Block_TypeDef * ext = (hsai->Duplex != 0) ? hsai->Ext : NULL;
+    SAI_Block_TypeDef * txInst, * rxInst;
+    DMA_AlignmentType align = (hsai->FrameSize == 4) ? DMA_ALIGN_HALFWORD : DMA_ALIGN_WORD;
+    uint16_t count = BlockSize * 4;
+
+    /* The main block direction is configured, the other block is the opposite */
+    if ((hsai->Inst->CR1 & (SAI_MODE_RX << SAI_xCR1_MODE_Pos)) != 0)
+    {
+        rxInst = hsai->Inst;
+        txInst = ext;
+    }
+    else
+    {
+        txInst = hsai->Inst;
+        rxInst = ext;
+    }
+
+    /* Validate the requested directions */
+    if (    ((TxBuffer != NULL) || (RxBuffer != NULL))
+         && ((TxBuffer == NULL) || ((txInst != NULL) && (XPD_DMA_CircularMode(hsai->DMA.Transmit) != 0)))
+         && ((RxBuffer == NULL) || ((rxInst != NULL) && (XPD_DMA_CircularMode(hsai->DMA.Receive) != 0))))
+    {
+        result = XPD_OK;
+
+        hsai->TxBuffer       = TxBuffer;
+        hsai->TxBlock.buffer = TxBuffer;
+        hsai->TxBlock.length = BlockSize;
+        hsai->TxBlock.size   = hsai->FrameSize;
+        hsai->RxBuffer       = RxBuffer;
+        hsai->RxBlock.buffer = RxBuffer;
+        hsai->RxBlock.length = BlockSize;
+        hsai->RxBlock.size   = hsai->FrameSize;
+    }
+
+    if ((result == XPD_OK) && (RxBuffer != NULL))
+    {
+        DMA_HandleType * hdma = hsai->DMA.Receive;
+
+        /* Set up DMA for transfer */
+        XPD_DMA_SetDataAlignment(hdma, align, align);
+        result = XPD_DMA_Start_IT(hdma, (void *)&rxInst->DR, RxBuffer, count);
+
+        if (result == XPD_OK)
+        {
+            /* Set the callback owner */
+            hdma->Owner = hsai;
+
+            /* Set the DMA transfer callbacks */
+            hdma->Callbacks.HalfComplete = sai_dmaHalfBlockRedirect;
+            hdma->Callbacks.Complete     = sai_dmaBlockRedirect;
+#ifdef USE_XPD_DMA_ERROR_DETECT
+            hdma->Callbacks.Error        = sai_dmaErrorRedirect;
+#endif
+            XPD_DMA_EnableIT(hdma, HT);
+        }
+    }
+
+    if ((result == XPD_OK) && (TxBuffer != NULL))
+    {
+        DMA_HandleType * hdma = hsai->DMA.Transmit;
+
+        /* Set up DMA for transfer */
+        XPD_DMA_SetDataAlignment(hdma, align, align);
+        result = XPD_DMA_Start_IT(hdma, (void *)&txInst->DR, TxBuffer, count);
+
+        if (result == XPD_OK)
+        {
+            /* Set the callback owner */
+            hdma->Owner = hsai;
+#ifdef USE_XPD_DMA_ERROR_DETECT
+            hdma->Callbacks.Error = sai_dmaErrorRedirect;
+#endif
+            if (RxBuffer == NULL)
+            {
+                /* Set the DMA transfer callbacks */
+                hdma->Callbacks.HalfComplete = sai_dmaHalfBlockRedirect;
+                hdma->Callbacks.Complete     = sai_dmaBlockRedirect;
+                XPD_DMA_EnableIT(hdma, HT);
+            }
+            else
+            {
+                /* The receive DMA notifies about both blocks */
+                XPD_DMA_DisableIT(hdma, TC);
+            }
+        }
+        else if (RxBuffer != NULL)
+        {
+            XPD_DMA_Stop_IT(hsai->DMA.Receive);
+        }
+    }
+
+    if (result == XPD_OK)
+    {
+        uint32_t imr = 0;
+#ifdef USE_XPD_SAI_ERROR_DETECT
+        imr = SAI_xIMR_OVRUDRIE | SAI_xIMR_WCKCFGIE;
+#endif
+        /* The synchronous slave block is enabled before the main block */
+        if ((ext != NULL) && ((ext == txInst) ? (TxBuffer != NULL) : (RxBuffer != NULL)))
+        {
+            ext->IMR = imr & SAI_xIMR_OVRUDRIE;
+            SET_BIT(ext->CR1, SAI_xCR1_DMAEN | SAI_xCR1_SAIEN);
+        }
+        if ((hsai->Inst == txInst) ? (TxBuffer != NULL) : (RxBuffer != NULL))
+        {
+            hsai->Inst->IMR = imr;
+            SET_BIT(hsai->Inst->CR1, SAI_xCR1_DMAEN | SAI_xCR1_SAIEN);
+        }
+    }
+    return result;
+}
+
+/**
+ * @brief Stops the audio streaming of the SAI handle.
+ * @param hsai: pointer to the SAI handle structure
+ */
+void XPD_SAI_Stream_Stop(SAI_HandleType * hsai)
+{
+    uint32_t txDma = 0, rxDma = 0;
+
+    /* Collect the DMA requests which served the stream */
+    if ((hsai->Inst->CR1 & SAI_xCR1_DMAEN) != 0)
+    {
+        if ((hsai->Inst->CR1 & (SAI_MODE_RX << SAI_xCR1_MODE_Pos)) != 0)
+        {
+            rxDma = 1;
+        }
+        else
+        {
+            txDma = 1;
+        }
+    }
+    if ((hsai->Duplex != 0) && ((hsai->Ext->CR1 & SAI_xCR1_DMAEN) != 0))
+    {
+        if ((hsai->Ext->CR1 & (SAI_MODE_RX << SAI_xCR1_MODE_Pos)) != 0)
+        {
+            rxDma = 1;
+        }
+        else
+        {
+            txDma = 1;
+        }
+    }
+
+    /* The master block is disabled first to stop the clocks */
+    hsai->Inst->IMR = 0;
+    (void) sai_disable(hsai->Inst);
+    if (hsai->Duplex != 0)
+    {
+        hsai->Ext->IMR = 0;
+        (void) sai_disable(hsai->Ext);
+    }
+
+    if (txDma != 0)
+    {
+        XPD_DMA_Stop_IT(hsai->DMA.Transmit);
+    }
+    if (rxDma != 0)
+    {
+        XPD_DMA_Stop_IT(hsai->DMA.Receive);
+    }
+}
+
+#ifdef USE_XPD_SAI_ERROR_DETECT
+/**
+ * @brief SAI error interrupt handler, shared with the synchronous audio block.
+ * @param hsai: pointer to the SAI handle structure
+ */
+void XPD_SAI_IRQHandler(SAI_HandleType * hsai)
+{
+    XPD_PROFILE_BEGIN();
+    XPD_STATS_IRQ_BEGIN();
+
+    SAI_ErrorType errors = sai_getErrors(hsai->Inst);
+
+    if (hsai->Duplex != 0)
+    {
+        errors |= sai_getErrors(hsai->Ext);
+    }
+
+    if (errors != SAI_ERROR_NONE)
+    {
+        /* Update error code */
+        hsai->Errors |= errors;
+        XPD_STATS_ERROR(hsai, errors);
+
+        /* Error callback */
+        XPD_SAFE_CALLBACK(hsai->Callbacks.Error, hsai);
+    }
+
+    XPD_STATS_IRQ_END(hsai);
+    XPD_PROFILE_END();
+}
+#endif
+
+/** @} */
+
+/** @} */
+
+#endif /* USE_XPD_SAI */
@@ -0,0 +1,644 @@
+/**
+  ******************************************************************************
+  * @file    xpd_sdmmc.c
+  * @author  Benedek Kupper
+  * @version V0.1
+  * @date    2018-01-20
+  * @brief   STM32 eXtensible Peripheral Drivers SDMMC Module
+  *
+  *  This file is part of STM32_XPD.
+  *
+  *  STM32_XPD is free software: you can redistribute it and/or modify
+  *  it under the terms of the GNU General Public License as published by
+  *  the Free Software Foundation, either version 3 of the License, or
+  *  (at your option) any later version.
+  *
+  *  STM32_XPD is distributed in the hope that it will be useful,
+  *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with STM32_XPD.  If not, see <http://www.gnu.org/licenses/>.
+  */
+#include "xpd_sdmmc.h"
+#include "xpd_rcc.h"
+#include "xpd_utils.h"
+
+#if defined(USE_XPD_SDMMC)
+
+/** @addtogroup SDMMC
+ * @{ */
+
+/* The SDIO and SDMMC register bit definitions only differ in their prefix */
+#ifdef SDIO
+#define SDMMC_MSK(NAME)         SDIO_##NAME
+#else
+#define SDMMC_MSK(NAME)         SDMMC_##NAME
+#endif
+
+#ifndef SDMMC_KERNEL_CLOCK_VALUE
+/* The kernel clock is the 48 MHz PLL output */
+#define SDMMC_KERNEL_CLOCK_VALUE    48000000
+#endif
+
+#define SDMMC_INIT_BUS_FREQ     400000
+#define SDMMC_BLOCK_SIZE        512
+#define SDMMC_MAX_BLOCK_COUNT   (0xFFFF / (SDMMC_BLOCK_SIZE / sizeof(uint32_t)))
+
+/* Timeouts in ms */
+#define SDMMC_CMD_TIMEOUT       5
+#define SDMMC_INIT_TIMEOUT      1000
+#define SDMMC_DATA_TIMEOUT      500
+
+/* Command indexes */
+#define SD_CMD_GO_IDLE_STATE        0
+#define SD_CMD_ALL_SEND_CID         2
+#define SD_CMD_SEND_RELATIVE_ADDR   3
+#define SD_CMD_SWITCH_FUNC          6
+#define SD_CMD_SELECT_CARD          7
+#define SD_CMD_SEND_IF_COND         8
+#define SD_CMD_SEND_CSD             9
+#define SD_CMD_STOP_TRANSMISSION    12
+#define SD_CMD_SEND_STATUS          13
+#define SD_CMD_SET_BLOCKLEN         16
+#define SD_CMD_READ_SINGLE_BLOCK    17
+#define SD_CMD_READ_MULT_BLOCK      18
+#define SD_CMD_WRITE_SINGLE_BLOCK   24
+#define SD_CMD_WRITE_MULT_BLOCK     25
+#define SD_CMD_APP_CMD              55
+#define SD_ACMD_SET_BUS_WIDTH       6
+#define SD_ACMD_SD_SEND_OP_COND     41
+
+/* Command arguments */
+#define SD_IF_COND_PATTERN          0x1AA
+#define SD_OCR_BUSY                 0x80000000
+#define SD_OCR_HCS                  0x40000000
+#define SD_OCR_VOLTAGE_WINDOW       0x00100000
+#define SD_SWITCH_HIGH_SPEED        0x80FFFFF1
+
+/* Card status bits */
+#define SD_R1_ERRORS                0xFDFFE008
+#define SD_R1_READY_FOR_DATA        0x00000100
+#define SD_R1_STATE_Pos             9
+#define SD_R1_STATE_TRAN            4
+
+/* Response types: the register wait field, and the CRC check omission bit */
+#define SDMMC_RESPONSE_NONE     0
+#define SDMMC_RESPONSE_SHORT    1
+#define SDMMC_RESPONSE_LONG     3
+#define SDMMC_RESPONSE_NO_CRC   (4 | SDMMC_RESPONSE_SHORT)
+
+#define SDMMC_CMD_FLAGS         (SDMMC_MSK(STA_CCRCFAIL) | SDMMC_MSK(STA_CTIMEOUT) \
+                               | SDMMC_MSK(STA_CMDREND)  | SDMMC_MSK(STA_CMDSENT))
+
+#define SDMMC_DATA_FLAGS        (SDMMC_MSK(STA_DCRCFAIL) | SDMMC_MSK(STA_DTIMEOUT) \
+                               | SDMMC_MSK(STA_TXUNDERR) | SDMMC_MSK(STA_RXOVERR)  \
+                               | SDMMC_MSK(STA_DATAEND)  | SDMMC_MSK(STA_DBCKEND))
+
+#define SDMMC_DATA_ERRORS       (SDMMC_MSK(STA_DCRCFAIL) | SDMMC_MSK(STA_DTIMEOUT) \
+                               | SDMMC_MSK(STA_TXUNDERR) | SDMMC_MSK(STA_RXOVERR))
+
+/* Sends a command and waits for its response */
+static XPD_ReturnType sdmmc_sendCommand(SDMMC_HandleType * hsd, uint8_t Index,
+        uint32_t Argument, uint8_t Response)
+{
+    XPD_ReturnType result;
+    uint32_t timeout = SDMMC_CMD_TIMEOUT;
+    uint32_t flags = (Response == SDMMC_RESPONSE_NONE) ? SDMMC_MSK(STA_CMDSENT) :
+            (SDMMC_MSK(STA_CMDREND) | SDMMC_MSK(STA_CCRCFAIL) | SDMMC_MSK(STA_CTIMEOUT));
+    uint32_t sta;
+
+    hsd->Inst->ICR.w = SDMMC_CMD_FLAGS;
+    hsd->Inst->ARG   = Argument;
+    hsd->Inst->CMD.w = ((uint32_t)Index << SDMMC_MSK(CMD_CMDINDEX_Pos))
+                     | ((uint32_t)(Response & SDMMC_RESPONSE_LONG) << SDMMC_MSK(CMD_WAITRESP_Pos))
+                     | SDMMC_MSK(CMD_CPSMEN);
+
+    result = XPD_WaitForDiff((volatile uint32_t *)&hsd->Inst->STA.w, flags, 0, &timeout);
+
+    sta = hsd->Inst->STA.w;
+    hsd->Inst->ICR.w = SDMMC_CMD_FLAGS;
+
+    if (result == XPD_OK)
+    {
+        if ((sta & SDMMC_MSK(STA_CTIMEOUT)) != 0)
+        {
+            result = XPD_TIMEOUT;
+        }
+        else if (((sta & SDMMC_MSK(STA_CCRCFAIL)) != 0) && (Response != SDMMC_RESPONSE_NO_CRC))
+        {
+            result = XPD_ERROR;
+        }
+    }
+    return result;
+}
+
+/* Sends a command with card status response, which is checked for errors */
+static XPD_ReturnType sdmmc_sendCommandR1(SDMMC_HandleType * hsd, uint8_t Index, uint32_t Argument)
+{
+    XPD_ReturnType result = sdmmc_sendCommand(hsd, Index, Argument, SDMMC_RESPONSE_SHORT);
+
+    if ((result == XPD_OK) && ((hsd->Inst->RESP1 & SD_R1_ERRORS) != 0))
+    {
+        result = XPD_ERROR;
+    }
+    return result;
+}
+
+/* Sends an application specific command */
+static XPD_ReturnType sdmmc_sendAppCommand(SDMMC_HandleType * hsd, uint8_t Index,
+        uint32_t Argument, uint8_t Response)
+{
+    XPD_ReturnType result = sdmmc_sendCommandR1(hsd, SD_CMD_APP_CMD, (uint32_t)hsd->RCA << 16);
+
+    if (result == XPD_OK)
+    {
+        result = sdmmc_sendCommand(hsd, Index, Argument, Response);
+    }
+    return result;
+}
+
+/* Sets the bus clock frequency, 0 divider selects the bypass */
+static void sdmmc_setBusFreq(SDMMC_HandleType * hsd, uint32_t Freq)
+{
+    if (Freq >= SDMMC_KERNEL_CLOCK_VALUE)
+    {
+        hsd->Inst->CLKCR.b.BYPASS = 1;
+        hsd->BusFreq = SDMMC_KERNEL_CLOCK_VALUE;
+    }
+    else
+    {
+        /* Bus clock = kernel clock / (CLKDIV + 2) */
+        uint32_t div = (SDMMC_KERNEL_CLOCK_VALUE + Freq - 1) / Freq;
+
+        div = (div < 2) ? 0 : div - 2;
+        hsd->Inst->CLKCR.b.CLKDIV = div;
+        hsd->Inst->CLKCR.b.BYPASS = 0;
+        hsd->BusFreq = SDMMC_KERNEL_CLOCK_VALUE / (div + 2);
+    }
+    hsd->Inst->DTIMER = (hsd->BusFreq / 1000) * SDMMC_DATA_TIMEOUT;
+}
+
+/* Calculates the number of 512 byte blocks from the CSD register */
+static uint32_t sdmmc_getCapacity(SDMMC_HandleType * hsd)
+{
+    uint32_t csd1 = hsd->Inst->RESP1, csd2 = hsd->Inst->RESP2, csd3 = hsd->Inst->RESP3;
+    uint32_t size, shift;
+
+    if ((csd1 >> 30) != 0)
+    {
+        /* CSD version 2.0: C_SIZE [69:48] in 512 kB units */
+        size  = ((csd2 & 0x3F) << 16) | (csd3 >> 16);
+        shift = 10;
+    }
+    else
+    {
+        /* CSD version 1.0: C_SIZE [73:62], C_SIZE_MULT [49:47], READ_BL_LEN [83:80] */
+        size  = ((csd2 & 0x3FF) << 2) | (csd3 >> 30);
+        shift = ((csd3 >> 15) & 7) + 2 + ((csd2 >> 16) & 0xF) - 9;
+    }
+    return (size + 1) << shift;
+}
+
+/* Switches the card to high speed mode, returns OK if successful */
+static XPD_ReturnType sdmmc_highSpeed(SDMMC_HandleType * hsd)
+{
+    XPD_ReturnType result;
+    uint32_t status[64 / sizeof(uint32_t)];
+    uint32_t i = 0, timeout = SDMMC_DATA_TIMEOUT;
+
+    /* The 512 bit switch status is read in a single 64 byte block */
+    hsd->Inst->DLEN    = sizeof(status);
+    hsd->Inst->DCTRL.w = SDMMC_MSK(DCTRL_DTEN) | SDMMC_MSK(DCTRL_DTDIR)
+                       | (6 << SDMMC_MSK(DCTRL_DBLOCKSIZE_Pos));
+
+    result = sdmmc_sendCommandR1(hsd, SD_CMD_SWITCH_FUNC, SD_SWITCH_HIGH_SPEED);
+
+    /* The FIFO is deeper than the status, it is read after the transfer */
+    if (result == XPD_OK)
+    {
+        result = XPD_WaitForDiff((volatile uint32_t *)&hsd->Inst->STA.w,
+                SDMMC_DATA_ERRORS | SDMMC_MSK(STA_DATAEND), 0, &timeout);
+    }
+    if ((result == XPD_OK) && ((hsd->Inst->STA.w & SDMMC_DATA_ERRORS) != 0))
+    {
+        result = XPD_ERROR;
+    }
+    while ((hsd->Inst->STA.w & SDMMC_MSK(STA_RXDAVL)) != 0)
+    {
+        uint32_t data = hsd->Inst->FIFO;
+
+        if (i < (sizeof(status) / sizeof(uint32_t)))
+        {
+            status[i++] = data;
+        }
+    }
+    hsd->Inst->DCTRL.w = 0;
+    hsd->Inst->ICR.w = SDMMC_DATA_FLAGS;
+
+    /* Function group 1 result [379:376] is in the 17th byte of the big-endian status */
+    if ((result == XPD_OK) && ((i < 5) || ((status[4] & 0xF) != 1)))
+    {
+        result = XPD_ERROR;
+    }
+    return result;
+}
+
+/* Ends the ongoing request */
+static void sdmmc_requestComplete(SDMMC_HandleType * hsd, SDMMC_ErrorType Errors)
+{
+    SDMMC_RequestType * request = hsd->Request;
+
+    hsd->Inst->MASK.w  = 0;
+    hsd->Inst->DCTRL.w = 0;
+    hsd->Inst->ICR.w   = SDMMC_DATA_FLAGS;
+
+    if (request == NULL)
+    {
+        return;
+    }
+    hsd->Request = NULL;
+
+    /* The card is returned to transfer state after the multiple block operations and errors */
+    if (((request->BlockCount > 1) || (Errors != SDMMC_ERROR_NONE))
+        && (sdmmc_sendCommand(hsd, SD_CMD_STOP_TRANSMISSION, 0, SDMMC_RESPONSE_SHORT) != XPD_OK))
+    {
+        Errors |= SDMMC_ERROR_COMMAND;
+    }
+
+    if (Errors == SDMMC_ERROR_NONE)
+    {
+        XPD_STATS_ADD(hsd, Transfers, 1);
+        XPD_STATS_ADD(hsd, Bytes, (uint32_t)request->BlockCount * SDMMC_BLOCK_SIZE);
+
+        request->Result = XPD_OK;
+    }
+    else
+    {
+        XPD_STATS_ERROR(hsd, Errors);
+
+        request->Errors = Errors;
+        request->Result = XPD_ERROR;
+
+#if defined(USE_XPD_SDMMC_ERROR_DETECT) || defined(USE_XPD_DMA_ERROR_DETECT)
+        XPD_SAFE_CALLBACK(hsd->Callbacks.Error, hsd);
+#endif
+    }
+
+    XPD_SAFE_CALLBACK(request->Complete, request);
+}
+
+static void sdmmc_dmaReceiveRedirect(void * hdma)
+{
+    SDMMC_HandleType * hsd = (SDMMC_HandleType*) ((DMA_HandleType*) hdma)->Owner;
+
+    /* All read data has left the FIFO */
+    sdmmc_requestComplete(hsd, SDMMC_ERROR_NONE);
+}
+
+#ifdef USE_XPD_DMA_ERROR_DETECT
+static void sdmmc_dmaErrorRedirect(void * hdma)
+{
+    SDMMC_HandleType * hsd = (SDMMC_HandleType*) ((DMA_HandleType*) hdma)->Owner;
+
+    XPD_DMA_Stop_IT(hdma);
+
+    sdmmc_requestComplete(hsd, SDMMC_ERROR_DMA);
+}
+#endif
+
+/** @defgroup SDMMC_Exported_Functions SDMMC Exported Functions
+ * @{ */
+
+/**
+ * @brief Initializes the SDMMC peripheral and identifies the inserted SD card,
+ *        then sets up the fastest data transfer mode allowed by the configuration.
+ * @note  The dependencies are initialized first, as the card communication starts immediately.
+ *        The kernel clock frequency is defined by SDMMC_KERNEL_CLOCK_VALUE (48 MHz by default).
+ * @param hsd: pointer to the SDMMC handle structure
+ * @param Config: pointer to SDMMC setup configuration
+ * @return TIMEOUT if no card responds, ERROR if the card isn't supported or fails,
+ *         OK if the card is ready for data transfers
+ */
+XPD_ReturnType XPD_SDMMC_Init(SDMMC_HandleType * hsd, const SDMMC_InitType * Config)
+{
+    XPD_ReturnType result;
+    uint32_t ocr = SD_OCR_VOLTAGE_WINDOW;
+    uint32_t i;
+
+    /* enable clock */
+    XPD_SAFE_CALLBACK(hsd->ClockCtrl, ENABLE);
+
+    /* Dependencies initialization */
+    XPD_SAFE_CALLBACK(hsd->Callbacks.DepInit, hsd);
+
+    hsd->Request = NULL;
+    hsd->RCA = 0;
+    hsd->Inst->MASK.w  = 0;
+    hsd->Inst->DCTRL.w = 0;
+    hsd->Inst->CLKCR.w = 0;
+    sdmmc_setBusFreq(hsd, SDMMC_INIT_BUS_FREQ);
+
+    /* Power up, then provide at least 74 clock cycles for the card */
+    hsd->Inst->POWER.w = SDMMC_MSK(POWER_PWRCTRL);
+    XPD_Delay_ms(2);
+    hsd->Inst->CLKCR.b.CLKEN = 1;
+    XPD_Delay_ms(1);
+
+    result = sdmmc_sendCommand(hsd, SD_CMD_GO_IDLE_STATE, 0, SDMMC_RESPONSE_NONE);
+
+    /* Version 2.0 cards echo the check pattern, older cards don't respond */
+    if (result == XPD_OK)
+    {
+        result = sdmmc_sendCommand(hsd, SD_CMD_SEND_IF_COND, SD_IF_COND_PATTERN,
+                SDMMC_RESPONSE_SHORT);
+
+        if (result == XPD_OK)
+        {
+            if ((hsd->Inst->RESP1 & 0xFFF) == SD_IF_COND_PATTERN)
+            {
+                ocr |= SD_OCR_HCS;
+            }
+            else
+            {
+                result = XPD_ERROR;
+            }
+        }
+        else if (result == XPD_TIMEOUT)
+        {
+            result = XPD_OK;
+        }
+    }
+
+    /* Wait for the end of the card power up */
+    for (i = 0; result == XPD_OK; i++)
+    {
+        result = sdmmc_sendAppCommand(hsd, SD_ACMD_SD_SEND_OP_COND, ocr, SDMMC_RESPONSE_NO_CRC);
+
+        if ((result != XPD_OK) || ((hsd->Inst->RESP1 & SD_OCR_BUSY) != 0))
+        {
+            break;
+        }
+        else if (i >= SDMMC_INIT_TIMEOUT)
+        {
+            result = XPD_TIMEOUT;
+        }
+        else
+        {
+            XPD_Delay_ms(1);
+        }
+    }
+
+    if (result == XPD_OK)
+    {
+        hsd->CardType = ((hsd->Inst->RESP1 & SD_OCR_HCS) != 0) ? SDMMC_CARD_SDHC : SDMMC_CARD_SDSC;
+
+        result = sdmmc_sendCommand(hsd, SD_CMD_ALL_SEND_CID, 0, SDMMC_RESPONSE_LONG);
+    }
+    if (result == XPD_OK)
+    {
+        result = sdmmc_sendCommand(hsd, SD_CMD_SEND_RELATIVE_ADDR, 0, SDMMC_RESPONSE_SHORT);
+
+        hsd->RCA = hsd->Inst->RESP1 >> 16;
+    }
+    if (result == XPD_OK)
+    {
+        result = sdmmc_sendCommand(hsd, SD_CMD_SEND_CSD, (uint32_t)hsd->RCA << 16,
+                SDMMC_RESPONSE_LONG);
+
+        hsd->Capacity = sdmmc_getCapacity(hsd);
+    }
+
+    /* Select the card for data transfers in the default speed mode */
+    if (result == XPD_OK)
+    {
+        result = sdmmc_sendCommandR1(hsd, SD_CMD_SELECT_CARD, (uint32_t)hsd->RCA << 16);
+    }
+    if ((result == XPD_OK) && (hsd->CardType == SDMMC_CARD_SDSC))
+    {
+        result = sdmmc_sendCommandR1(hsd, SD_CMD_SET_BLOCKLEN, SDMMC_BLOCK_SIZE);
+    }
+    if ((result == XPD_OK) && (Config->WideBus != DISABLE))
+    {
+        result = sdmmc_sendAppCommand(hsd, SD_ACMD_SET_BUS_WIDTH, 2, SDMMC_RESPONSE_SHORT);
+
+        if (result == XPD_OK)
+        {
+            hsd->Inst->CLKCR.b.WIDBUS = 1;
+        }
+    }
+    if (result == XPD_OK)
+    {
+        uint32_t freq = SDMMC_KERNEL_CLOCK_VALUE / 2;
+
+        /* Cards without the switch function remain in default speed */
+        if ((Config->HighSpeed != DISABLE) && (sdmmc_highSpeed(hsd) == XPD_OK))
+        {
+            freq = SDMMC_KERNEL_CLOCK_VALUE;
+        }
+        sdmmc_setBusFreq(hsd, freq);
+
+        hsd->Inst->CLKCR.b.PWRSAV = Config->ClockPowerSave;
+    }
+
+    return result;
+}
+
+/**
+ * @brief Powers off the card and restores the SDMMC peripheral to its default inactive state.
+ * @param hsd: pointer to the SDMMC handle structure
+ * @return OK
+ */
+XPD_ReturnType XPD_SDMMC_Deinit(SDMMC_HandleType * hsd)
+{
+    hsd->Inst->MASK.w  = 0;
+    hsd->Inst->DCTRL.w = 0;
+    hsd->Inst->CLKCR.w = 0;
+    hsd->Inst->POWER.w = 0;
+    hsd->Request = NULL;
+
+    /* Deinitialize peripheral dependencies */
+    XPD_SAFE_CALLBACK(hsd->Callbacks.DepDeinit, hsd);
+
+    /* Disable clock */
+    XPD_SAFE_CALLBACK(hsd->ClockCtrl, DISABLE);
+
+    return XPD_OK;
+}
+
+/**
+ * @brief Starts a DMA-managed block read or write request. A multiple block command is used
+ *        for more than one block. The request's Complete callback is called
+ *        when it is finished, its Result contains the outcome.
+ * @note  The DMAs must be set up for word transfers, on STM32F4 in peripheral flow control mode
+ *        with FIFO and 4-beat bursts. The SDMMC interrupt has to be enabled.
+ *        Only one request can be ongoing, and the card is busy programming for a while
+ *        after each write: BUSY is returned in both cases, the submission shall be retried later.
+ * @param hsd: pointer to the SDMMC handle structure
+ * @param Request: pointer to the request, which must remain valid until it is completed
+ * @return ERROR if the request is invalid or the card fails, BUSY if the handle or the card is busy,
+ *         OK if the request is started
+ */
+XPD_ReturnType XPD_SDMMC_Submit(SDMMC_HandleType * hsd, SDMMC_RequestType * Request)
+{
+    XPD_ReturnType result;
+    DMA_HandleType * hdma;
+    uint32_t address = Request->BlockAddress;
+    uint16_t count = Request->BlockCount * (SDMMC_BLOCK_SIZE / sizeof(uint32_t));
+    uint32_t dctrl = SDMMC_MSK(DCTRL_DTEN) | SDMMC_MSK(DCTRL_DMAEN)
+                   | (9 << SDMMC_MSK(DCTRL_DBLOCKSIZE_Pos));
+    uint8_t cmd;
+
+    if ((Request->BlockCount == 0) || (Request->BlockCount > SDMMC_MAX_BLOCK_COUNT)
+        || ((Request->BlockAddress + Request->BlockCount) > hsd->Capacity)
+        || ((((uint32_t)Request->Buffer) & (sizeof(uint32_t) - 1)) != 0))
+    {
+        return XPD_ERROR;
+    }
+    if (hsd->Request != NULL)
+    {
+        return XPD_BUSY;
+    }
+
+    /* The card must be in transfer state */
+    result = sdmmc_sendCommandR1(hsd, SD_CMD_SEND_STATUS, (uint32_t)hsd->RCA << 16);
+    if (result != XPD_OK)
+    {
+        return result;
+    }
+    else if (((hsd->Inst->RESP1 & SD_R1_READY_FOR_DATA) == 0)
+            || (((hsd->Inst->RESP1 >> SD_R1_STATE_Pos) & 0xF) != SD_R1_STATE_TRAN))
+    {
+        return XPD_BUSY;
+    }
+
+    if (hsd->CardType == SDMMC_CARD_SDSC)
+    {
+        address *= SDMMC_BLOCK_SIZE;
+    }
+
+    if (Request->Operation == SDMMC_OPERATION_READ)
+    {
+        hdma  = hsd->DMA.Receive;
+        dctrl |= SDMMC_MSK(DCTRL_DTDIR);
+        cmd   = (Request->BlockCount > 1) ? SD_CMD_READ_MULT_BLOCK : SD_CMD_READ_SINGLE_BLOCK;
+    }
+    else
+    {
+        hdma  = hsd->DMA.Transmit;
+        cmd   = (Request->BlockCount > 1) ? SD_CMD_WRITE_MULT_BLOCK : SD_CMD_WRITE_SINGLE_BLOCK;
+    }
+
+    /* Set up DMA for transfer */
+    XPD_DMA_SetDataAlignment(hdma, DMA_ALIGN_WORD, DMA_ALIGN_WORD);
+    result = XPD_DMA_Start_IT(hdma, (void*) &hsd->Inst->FIFO, Request->Buffer, count);
+    if (result != XPD_OK)
+    {
+        return result;
+    }
+
+    /* Set the callback owner */
+    hdma->Owner = hsd;
+
+    /* Set the DMA transfer callbacks */
+    hdma->Callbacks.Complete = (Request->Operation == SDMMC_OPERATION_READ) ?
+            sdmmc_dmaReceiveRedirect : NULL;
+#ifdef USE_XPD_DMA_ERROR_DETECT
+    hdma->Callbacks.Error    = sdmmc_dmaErrorRedirect;
+#endif
+
+    Request->Result = XPD_BUSY;
+    Request->Errors = SDMMC_ERROR_NONE;
+    hsd->Request = Request;
+
+    hsd->Inst->ICR.w  = SDMMC_DATA_FLAGS;
+    hsd->Inst->DLEN   = (uint32_t)Request->BlockCount * SDMMC_BLOCK_SIZE;
+
+    if (Request->Operation == SDMMC_OPERATION_READ)
+    {
+        /* The reception is complete when the DMA has emptied the FIFO */
+        hsd->Inst->MASK.w  = SDMMC_MSK(MASK_DCRCFAILIE) | SDMMC_MSK(MASK_DTIMEOUTIE)
+                           | SDMMC_MSK(MASK_RXOVERRIE);
+        hsd->Inst->DCTRL.w = dctrl;
+
+        result = sdmmc_sendCommandR1(hsd, cmd, address);
+    }
+    else
+    {
+        /* The write data path is enabled after the command response */
+        result = sdmmc_sendCommandR1(hsd, cmd, address);
+
+        if (result == XPD_OK)
+        {
+            hsd->Inst->MASK.w  = SDMMC_MSK(MASK_DCRCFAILIE) | SDMMC_MSK(MASK_DTIMEOUTIE)
+                               | SDMMC_MSK(MASK_TXUNDERRIE) | SDMMC_MSK(MASK_DATAENDIE);
+            hsd->Inst->DCTRL.w = dctrl;
+        }
+    }
+
+    if (result != XPD_OK)
+    {
+        hsd->Inst->MASK.w  = 0;
+        hsd->Inst->DCTRL.w = 0;
+        hsd->Request = NULL;
+        XPD_DMA_Stop_IT(hdma);
+
+        Request->Errors = SDMMC_ERROR_COMMAND;
+        Request->Result = XPD_ERROR;
+        XPD_STATS_ERROR(hsd, SDMMC_ERROR_COMMAND);
+    }
+    return result;
+}
+
+/**
+ * @brief SDMMC global interrupt handler that completes the ongoing request.
+ * @param hsd: pointer to the SDMMC handle structure
+ */
+void XPD_SDMMC_IRQHandler(SDMMC_HandleType * hsd)
+{
+    XPD_PROFILE_BEGIN();
+    XPD_STATS_IRQ_BEGIN();
+
+    uint32_t sta = hsd->Inst->STA.w & hsd->Inst->MASK.w;
+
+    if ((sta & SDMMC_DATA_ERRORS) != 0)
+    {
+        SDMMC_ErrorType errors = SDMMC_ERROR_NONE;
+
+        if ((sta & SDMMC_MSK(STA_DCRCFAIL)) != 0)
+        {
+            errors |= SDMMC_ERROR_DATA_CRC;
+        }
+        if ((sta & SDMMC_MSK(STA_DTIMEOUT)) != 0)
+        {
+            errors |= SDMMC_ERROR_DATA_TIMEOUT;
+        }
+        if ((sta & (SDMMC_MSK(STA_TXUNDERR) | SDMMC_MSK(STA_RXOVERR))) != 0)
+        {
+            errors |= SDMMC_ERROR_OVERRUN;
+        }
+
+        /* Abort the data transfer */
+        if (hsd->Request != NULL)
+        {
+            XPD_DMA_Stop_IT((hsd->Request->Operation == SDMMC_OPERATION_READ) ?
+                    hsd->DMA.Receive : hsd->DMA.Transmit);
+        }
+        sdmmc_requestComplete(hsd, errors);
+    }
+    else if ((sta & SDMMC_MSK(STA_DATAEND)) != 0)
+    {
+        /* All write data is sent to the card */
+        sdmmc_requestComplete(hsd, SDMMC_ERROR_NONE);
+    }
+
+    XPD_STATS_IRQ_END(hsd);
+    XPD_PROFILE_END();
+}
+
+/** @} */
+
+/** @} */
+
+#endif /* USE_XPD_SDMMC */
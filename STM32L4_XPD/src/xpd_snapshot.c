@@ -0,0 +1,211 @@
+/**
+  ******************************************************************************
+  * @file    xpd_snapshot.c
+  * @author  Benedek Kupper
+  * @version V0.1
+  * @date    2018-01-20
+  * @brief   STM32 eXtensible Peripheral Drivers Register Snapshot Module
+  *
+  *  This file is part of STM32_XPD.
+  *
+  *  STM32_XPD is free software: you can redistribute it and/or modify
+  *  it under the terms of the GNU General Public License as published by
+  *  the Free Software Foundation, either version 3 of the License, or
+  *  (at your option) any later version.
+  *
+  *  STM32_XPD is distributed in the hope that it will be useful,
+  *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with STM32_XPD.  If not, see <http://www.gnu.org/licenses/>.
+  */
+#include "xpd_snapshot.h"
+
+#ifdef USE_XPD_SNAPSHOT
+
+/** @addtogroup SNAPSHOT
+ * @{ */
+
+#define SNAPSHOT_HASH_PRIME     0x01000193UL
+
+/* The image header words */
+#define SNAPSHOT_KEY            0
+#define SNAPSHOT_SIZE           1
+#define SNAPSHOT_CHECK          2
+
+/* Builds a hash of a word */
+static uint32_t snapshot_hashWord(uint32_t Hash, uint32_t Word)
+{
+    uint32_t i;
+
+    for (i = 0; i < sizeof(uint32_t); i++, Word >>= 8)
+    {
+        Hash = (Hash ^ (Word & 0xFF)) * SNAPSHOT_HASH_PRIME;
+    }
+    return Hash;
+}
+
+/* Identifies the register layout and the application configuration */
+static uint32_t snapshot_getKey(const SNAPSHOT_InitType * Config)
+{
+    uint32_t key = snapshot_hashWord(SNAPSHOT_HASH_INIT, Config->Key);
+    uint8_t i;
+
+    for (i = 0; i < Config->Count; i++)
+    {
+        key = snapshot_hashWord(key, (uint32_t)Config->Regions[i].Registers);
+        key = snapshot_hashWord(key, Config->Regions[i].Count);
+        key = snapshot_hashWord(key, Config->Regions[i].Hold);
+    }
+    return key;
+}
+
+/* Calculates the check value of the register contents */
+static uint32_t snapshot_getCheck(const uint32_t * Data, uint32_t Size)
+{
+    uint32_t check = SNAPSHOT_HASH_INIT;
+
+    for (; Size > 0; Size--)
+    {
+        check = snapshot_hashWord(check, *Data++);
+    }
+    return check;
+}
+
+/** @defgroup SNAPSHOT_Exported_Functions SNAPSHOT Exported Functions
+ * @{ */
+
+/**
+ * @brief Continues the FNV-1a hash calculation with the input data,
+ *        used to build the configuration key of the snapshot.
+ * @param Hash: the hash of the preceding data, or @ref SNAPSHOT_HASH_INIT
+ * @param Data: the input data
+ * @param Size: the size of the input data in bytes
+ * @return The hash value
+ */
+uint32_t XPD_Snapshot_Hash(uint32_t Hash, const void * Data, uint32_t Size)
+{
+    const uint8_t * data = (const uint8_t*)Data;
+
+    for (; Size > 0; Size--)
+    {
+        Hash = (Hash ^ *data++) * SNAPSHOT_HASH_PRIME;
+    }
+    return Hash;
+}
+
+/**
+ * @brief Determines the image size required by the snapshot configuration.
+ * @param Config: the snapshot setup configuration
+ * @return The size of the image in words
+ */
+uint32_t XPD_Snapshot_GetSize(const SNAPSHOT_InitType * Config)
+{
+    uint32_t size = SNAPSHOT_HEADER_WORDS;
+    uint8_t i;
+
+    for (i = 0; i < Config->Count; i++)
+    {
+        size += Config->Regions[i].Count;
+    }
+    return size;
+}
+
+/**
+ * @brief Captures the current register contents of the regions into the image.
+ * @note  The image is only validated once it's completely written,
+ *        therefore an interrupted capture leaves an invalid image behind.
+ * @param Config: the snapshot setup configuration
+ * @param Image: the image storage
+ * @param Capacity: the size of the image storage in words
+ * @return ERROR if the image doesn't fit the storage, OK if captured
+ */
+XPD_ReturnType XPD_Snapshot_Capture(const SNAPSHOT_InitType * Config,
+        uint32_t * Image, uint32_t Capacity)
+{
+    uint32_t size = XPD_Snapshot_GetSize(Config);
+    uint32_t * data = &Image[SNAPSHOT_HEADER_WORDS];
+    uint32_t key = snapshot_getKey(Config);
+    uint8_t i;
+
+    if (size > Capacity)
+    {
+        return XPD_ERROR;
+    }
+
+    Image[SNAPSHOT_KEY] = ~key;
+
+    for (i = 0; i < Config->Count; i++)
+    {
+        const SNAPSHOT_RegionType * region = &Config->Regions[i];
+        uint32_t j;
+
+        for (j = 0; j < region->Count; j++)
+        {
+            *data++ = region->Registers[j];
+        }
+    }
+
+    size -= SNAPSHOT_HEADER_WORDS;
+    Image[SNAPSHOT_SIZE]  = size;
+    Image[SNAPSHOT_CHECK] = snapshot_getCheck(&Image[SNAPSHOT_HEADER_WORDS], size);
+    Image[SNAPSHOT_KEY]   = key;
+
+    return XPD_OK;
+}
+
+/**
+ * @brief Restores the register contents of the regions from a valid image.
+ *        The peripheral clocks are enabled before their registers are written.
+ * @param Config: the snapshot setup configuration
+ * @param Image: the captured image
+ * @return ERROR if the image doesn't match the configuration or it's corrupted,
+ *         OK if the registers are restored
+ */
+XPD_ReturnType XPD_Snapshot_Restore(const SNAPSHOT_InitType * Config, const uint32_t * Image)
+{
+    uint32_t size = XPD_Snapshot_GetSize(Config) - SNAPSHOT_HEADER_WORDS;
+    const uint32_t * data = &Image[SNAPSHOT_HEADER_WORDS];
+    uint8_t i;
+
+    /* The registers are only written if the whole image is valid */
+    if ((Image[SNAPSHOT_KEY] != snapshot_getKey(Config)) || (Image[SNAPSHOT_SIZE] != size)
+            || (Image[SNAPSHOT_CHECK] != snapshot_getCheck(data, size)))
+    {
+        return XPD_ERROR;
+    }
+
+    for (i = 0; i < Config->Count; i++)
+    {
+        const SNAPSHOT_RegionType * region = &Config->Regions[i];
+        uint32_t j;
+
+        XPD_SAFE_CALLBACK(region->ClockCtrl, ENABLE);
+
+        if (region->Count > 0)
+        {
+            region->Registers[0] = data[0] & ~region->Hold;
+
+            for (j = 1; j < region->Count; j++)
+            {
+                region->Registers[j] = data[j];
+            }
+
+            if (region->Hold != 0)
+            {
+                region->Registers[0] = data[0];
+            }
+            data += region->Count;
+        }
+    }
+
+    return XPD_OK;
+}
+
+/** @} */
+
+/** @} */
+
+#endif /* USE_XPD_SNAPSHOT */
@@ -85,6 +85,18 @@ do { if (USB_REG_BIT(husb,EP[EP_ID],BIT_NAME) != 0) USB_TOGGLE(EP_ID, BIT_NAME);
 
 #define USB_PMA_ALLOCATION(SIZE)    (SIZE)
 
+/* Packet memory size in the USB local address space */
+#ifndef USB_PMA_SIZE
+#ifdef USB_BCDR_BCDEN
+#define USB_PMA_SIZE                1024
+#else
+#define USB_PMA_SIZE                512
+#endif
+#endif
+
+/* Buffer descriptor table entry size in the USB local address space */
+#define USB_BDT_ENTRY_SIZE          8
+
 static const uint16_t usb_epTypeRemap[4] = {
     USB_EP_CONTROL,
     USB_EP_ISOCHRONOUS,
@@ -97,23 +109,38 @@ static void usb_writePMA(uint8_t * sourceBuf, uint16_t pmaAddress, uint16_t data
 {
     USB_PacketAddressType * dest = (USB_PacketAddressType *)USB_PMAADDR + (pmaAddress / 2);
 
-    /* Check if input data is aligned */
+    /* Word aligned input is loaded by words, each split to two PMA half-words */
+    if ((((uint32_t)sourceBuf) & 3) == 0)
+    {
+        const uint32_t * source = (const uint32_t *)sourceBuf;
+
+        for (; dataCount >= 8; dataCount -= 8, source += 2, dest += 4)
+        {
+            uint32_t word0 = source[0], word1 = source[1];
+
+            dest[0] = (uint16_t)word0;
+            dest[1] = (uint16_t)(word0 >> 16);
+            dest[2] = (uint16_t)word1;
+            dest[3] = (uint16_t)(word1 >> 16);
+        }
+        sourceBuf = (uint8_t *)source;
+    }
+
+    /* Check if the remaining input data is aligned */
     if ((((uint32_t)sourceBuf) & 1) == 0)
     {
-        uint16_t i;
+        const uint16_t * source = (const uint16_t *)sourceBuf;
 
-        for (i = 0; i < ((dataCount + 1) / 2); i++)
+        for (dataCount = (dataCount + 1) / 2; dataCount > 0; dataCount--)
         {
-            dest[i] = ((uint16_t*)sourceBuf)[i];
+            *dest++ = *source++;
         }
     }
     else
     {
-        dataCount = (dataCount + 1) / 2;
-        while (dataCount--)
+        for (dataCount = (dataCount + 1) / 2; dataCount > 0; dataCount--)
         {
-            *dest = ((uint16_t)(sourceBuf[1]) << 8) | (uint16_t)(sourceBuf[0]);
-            dest++;
+            *dest++ = ((uint16_t)(sourceBuf[1]) << 8) | (uint16_t)(sourceBuf[0]);
             sourceBuf += 2;
         }
     }
@@ -124,27 +151,46 @@ static void usb_readPMA(uint8_t * destBuf, uint16_t pmaAddress, uint16_t dataCou
 {
     USB_PacketAddressType * source = (USB_PacketAddressType *)USB_PMAADDR + (pmaAddress / 2);
 
-    /* Check if input data is aligned */
+    /* Word aligned output is stored by words, each merged from two PMA half-words */
+    if ((((uint32_t)destBuf) & 3) == 0)
+    {
+        uint32_t * dest = (uint32_t *)destBuf;
+
+        for (; dataCount >= 8; dataCount -= 8, source += 4, dest += 2)
+        {
+            dest[0] = (uint16_t)source[0] | ((uint32_t)source[1] << 16);
+            dest[1] = (uint16_t)source[2] | ((uint32_t)source[3] << 16);
+        }
+        destBuf = (uint8_t *)dest;
+    }
+
+    /* Check if the remaining output data is aligned */
     if ((((uint32_t)destBuf) & 1) == 0)
     {
-        uint16_t i;
-        for (i = 0; i < ((dataCount + 1) / 2); i++)
+        uint16_t * dest = (uint16_t *)destBuf;
+
+        for (; dataCount >= 2; dataCount -= 2)
         {
-            ((uint16_t*)destBuf)[i] = source[i];
+            *dest++ = *source++;
         }
+        destBuf = (uint8_t *)dest;
     }
     else
     {
-        dataCount = (dataCount + 1) / 2;
-        while (dataCount--)
+        for (; dataCount >= 2; dataCount -= 2)
         {
-            *destBuf = *source;
-            destBuf++;
-            *destBuf = (*source) >> 8;
-            destBuf++;
-            source++;
+            uint16_t halfWord = *source++;
+
+            *destBuf++ = halfWord;
+            *destBuf++ = halfWord >> 8;
         }
     }
+
+    /* The last odd byte is copied without overwriting the following data */
+    if (dataCount > 0)
+    {
+        *destBuf = *source;
+    }
 }
 
 /* Setting RX_COUNT requires special conversion */
@@ -172,6 +218,41 @@ static uint16_t usb_epConvertRxCount(uint16_t count)
     return blocks;
 }
 
+/* Packet memory size of one endpoint buffer, the reception buffers are allocated in 2 or 32 byte blocks */
+static uint16_t usb_pmaBufferSize(USB_HandleType * husb, USB_EndPointHandleType * ep)
+{
+    if (EP_IS_OUT(husb,ep) && (ep->MaxPacketSize > 62))
+    {
+        return (ep->MaxPacketSize + 31) & ~31;
+    }
+    else
+    {
+        return (ep->MaxPacketSize + 1) & ~1;
+    }
+}
+
+/* Number of endpoint registers used by the configured endpoints (including EP0) */
+static uint8_t usb_pmaRegCount(USB_HandleType * husb)
+{
+    uint8_t i, count = 1;
+
+    for (i = 1; i < USB_ENDPOINT_COUNT; i++)
+    {
+        USB_EndPointHandleType * in  = &husb->EP.IN[i];
+        USB_EndPointHandleType * out = &husb->EP.OUT[i];
+
+        count += ((in->MaxPacketSize > 0) ? 1 : 0) + ((out->MaxPacketSize > 0) ? 1 : 0);
+
+        /* One EPnR manages both single buffered IN-OUT endpoints of the same type */
+        if ((in->MaxPacketSize > 0) && (out->MaxPacketSize > 0) && (in->Type == out->Type) &&
+            (in->DoubleBuffer == DISABLE) && (out->DoubleBuffer == DISABLE))
+        {
+            count--;
+        }
+    }
+    return count;
+}
+
 /* Handle OUT EP transfer */
 static void usb_epReceive(USB_HandleType * husb, USB_EndPointHandleType * ep, uint16_t Length)
 {
@@ -179,21 +260,18 @@ static void usb_epReceive(USB_HandleType * husb, USB_EndPointHandleType * ep, ui
     if (Length > ep->MaxPacketSize)
     {
         ep->Transfer.length = Length - ep->MaxPacketSize;
-        Length = usb_epConvertRxCount(ep->MaxPacketSize);
+        ep->PacketLength = ep->MaxPacketSize;
     }
     else
     {
         ep->Transfer.length = 0;
-        Length = usb_epConvertRxCount(Length);
+        ep->PacketLength = Length;
     }
+    Length = usb_epConvertRxCount(ep->PacketLength);
 
-    /* Double buffering */
-    if ((ep->DoubleBuffer == ENABLE) && ((USB->EP[ep->RegId].w & USB_EP_DTOG_RX) != 0))
-    {
-        /* Set endpoint buffer 0 count */
-        USB_EP_BDT[ep->RegId].TX_COUNT = Length;
-    }
-    else
+    /* Double buffered endpoints keep both buffers at max packet size,
+     * since the next packet can arrive before this function is called */
+    if (ep->DoubleBuffer == DISABLE)
     {
         /*Set RX buffer count */
         USB_EP_BDT[ep->RegId].RX_COUNT = Length;
@@ -270,6 +348,7 @@ XPD_ReturnType XPD_USB_Init(USB_HandleType * husb, const USB_InitType * Config)
         husb->EP.IN[i].Stalled         = husb->EP.OUT[i].Stalled         = FALSE;
         husb->EP.IN[i].RegId           = husb->EP.OUT[i].RegId           = 0;
         husb->EP.IN[i].DoubleBuffer    = husb->EP.OUT[i].DoubleBuffer    = DISABLE;
+        husb->EP.IN[i].PendingZLP      = FALSE;
     }
 
     /* Initialize peripheral device */
@@ -435,6 +514,102 @@ void XPD_USB_EP_BufferInit(USB_HandleType * husb, uint8_t EpAddress, uint16_t Bu
     }
 }
 
+/**
+ * @brief Allocates the packet memory for the endpoints of the configuration
+ *        after device initialization and before starting the USB operation.
+ *        The buffer descriptor table is sized for the endpoint registers in use,
+ *        each endpoint gets one packet buffer (isochronous endpoints are double-buffered),
+ *        then the bulk endpoints are set to double-buffered in order while the space allows.
+ * @note  This function replaces the manual allocation by @ref XPD_USB_EP_BufferInit.
+ * @param husb: pointer to the USB handle structure
+ * @param Endpoints: the endpoints of the configuration (except EP0)
+ * @param Count: the number of endpoints
+ * @return ERROR if the endpoints are invalid or don't fit in the packet memory, OK if success
+ */
+XPD_ReturnType XPD_USB_EP_PmaAlloc(USB_HandleType * husb,
+        const USB_EndPointConfigType * Endpoints, uint8_t Count)
+{
+    USB_EndPointHandleType * ep;
+    uint8_t i, epAddress;
+    uint16_t used = 2 * USB_MAX_PACKET_SIZE, size;
+
+    for (i = 1; i < USB_ENDPOINT_COUNT; i++)
+    {
+        husb->EP.IN[i].MaxPacketSize = husb->EP.OUT[i].MaxPacketSize = 0;
+        husb->EP.IN[i].DoubleBuffer  = husb->EP.OUT[i].DoubleBuffer  = DISABLE;
+    }
+
+    /* The minimal buffers of the endpoints */
+    for (i = 0; i < Count; i++)
+    {
+        epAddress = Endpoints[i].Address;
+
+        if (((epAddress & 0x7F) == 0) || ((epAddress & 0x7F) >= USB_ENDPOINT_COUNT) ||
+            (Endpoints[i].MaxPacketSize == 0))
+        {
+            return XPD_ERROR;
+        }
+        ep = USB_GET_EP_AT(husb, epAddress);
+
+        /* Each endpoint can only be listed once */
+        if (ep->MaxPacketSize > 0)
+        {
+            return XPD_ERROR;
+        }
+        ep->MaxPacketSize = Endpoints[i].MaxPacketSize;
+        ep->Type          = Endpoints[i].Type;
+        ep->DoubleBuffer  = (ep->Type == USB_EP_TYPE_ISOCHRONOUS) ? ENABLE : DISABLE;
+
+        size  = usb_pmaBufferSize(husb, ep);
+        used += (ep->DoubleBuffer == ENABLE) ? 2 * size : size;
+    }
+
+    if ((usb_pmaRegCount(husb) > USB_ENDPOINT_COUNT) ||
+        ((usb_pmaRegCount(husb) * USB_BDT_ENTRY_SIZE + used) > USB_PMA_SIZE))
+    {
+        return XPD_ERROR;
+    }
+
+    /* Set the bulk endpoints to double-buffered while there is space,
+     * which can take a separate EPnR from the IN-OUT pair */
+    for (i = 0; i < Count; i++)
+    {
+        if (Endpoints[i].Type == USB_EP_TYPE_BULK)
+        {
+            epAddress = Endpoints[i].Address;
+            ep = USB_GET_EP_AT(husb, epAddress);
+            size = usb_pmaBufferSize(husb, ep);
+
+            ep->DoubleBuffer = ENABLE;
+            if ((usb_pmaRegCount(husb) <= USB_ENDPOINT_COUNT) &&
+                ((usb_pmaRegCount(husb) * USB_BDT_ENTRY_SIZE + used + size) <= USB_PMA_SIZE))
+            {
+                used += size;
+            }
+            else
+            {
+                ep->DoubleBuffer = DISABLE;
+            }
+        }
+    }
+
+    /* Lay out the buffers after the descriptor table and the EP0 buffers */
+    husb->BdtSize   = usb_pmaRegCount(husb) * USB_BDT_ENTRY_SIZE;
+    husb->PmaOffset = USB_PMA_ALLOCATION(2 * USB_MAX_PACKET_SIZE);
+
+    for (i = 0; i < Count; i++)
+    {
+        epAddress = Endpoints[i].Address;
+        ep = USB_GET_EP_AT(husb, epAddress);
+        size = usb_pmaBufferSize(husb, ep);
+
+        ep->PacketAddress = husb->PmaOffset;
+        husb->PmaOffset  += USB_PMA_ALLOCATION((ep->DoubleBuffer == ENABLE) ? 2 * size : size);
+    }
+
+    return XPD_OK;
+}
+
 /**
  * @brief Opens an endpoint
  * @param husb: pointer to the USB handle structure
@@ -457,7 +632,7 @@ void XPD_USB_EP_Open(USB_HandleType * husb, uint8_t EpAddress, USB_EndPointType
                 &husb->EP.OUT[EpAddress] : &husb->EP.IN[EpAddress]);
 
         /* Ensuring that double buffering is not enabled for control or interrupt EPs */
-        if ((ep->Type == USB_EP_CONTROL) || (ep->Type == USB_EP_INTERRUPT))
+        if ((ep->Type == USB_EP_TYPE_CONTROL) || (ep->Type == USB_EP_TYPE_INTERRUPT))
         {
             ep->DoubleBuffer = DISABLE;
         }
@@ -521,8 +696,9 @@ void XPD_USB_EP_Open(USB_HandleType * husb, uint8_t EpAddress, USB_EndPointType
         }
         else
         {
-            /* Set buffer address for double buffered mode */
+            /* Set buffer address and size for double buffered mode */
             USB_EP_BDT[ep->RegId].TX_ADDR  = pmaAddress + ep->MaxPacketSize;
+            USB_EP_BDT[ep->RegId].TX_COUNT = usb_epConvertRxCount(MaxPacketSize);
 
             /* Set SW_BUF flag */
             USB_TOGGLE(ep->RegId, DTOG_TX);
@@ -617,6 +793,13 @@ void XPD_USB_EP_Receive(USB_HandleType * husb, uint8_t EpAddress, uint8_t * Data
     ep->Transfer.buffer = Data;
     ep->Transfer.size   = 0;
 
+    /* Release the buffer which was held at the end of the previous transfer */
+    if ((ep->DoubleBuffer == ENABLE) && (EpAddress > 0) &&
+        (((USB->EP[ep->RegId].w ^ (USB->EP[ep->RegId].w >> 8)) & USB_EP_DTOG_TX) == 0))
+    {
+        USB_TOGGLE(ep->RegId, DTOG_TX);
+    }
+
     usb_epReceive(husb, ep, Length);
 }
 
@@ -633,6 +816,10 @@ uint16_t XPD_USB_EP_GetRxCount(USB_HandleType * husb, uint8_t EpAddress)
 
 /**
  * @brief Initiates data transmission on the IN endpoint
+ * @note  The transfer is split to packets and scheduled in the interrupt handler,
+ *        the DataInStage callback is only called when the complete transfer is done.
+ *        The transfer isn't terminated by a zero length packet, so it can be a part of
+ *        a larger data phase, @ref XPD_USB_EP_TransmitEnd shall be used for its last part.
  * @param husb: pointer to the USB handle structure
  * @param EpAddress: endpoint number
  * @param Data: pointer to the data buffer
@@ -645,6 +832,30 @@ void XPD_USB_EP_Transmit(USB_HandleType * husb, uint8_t EpAddress, uint8_t * Dat
     /* setup and start the transfer */
     ep->Transfer.buffer = Data;
     ep->Transfer.size   = 0;
+    ep->PendingZLP      = FALSE;
+
+    usb_epTransmit(husb, ep, Length);
+}
+
+/**
+ * @brief Initiates the last data transmission of a data phase on the IN endpoint.
+ * @note  The host can only detect the end of a bulk data phase by a short packet,
+ *        so the transfer is terminated by a zero length packet when its last packet is full.
+ *        The DataInStage callback is called after the zero length packet is sent.
+ * @param husb: pointer to the USB handle structure
+ * @param EpAddress: endpoint number
+ * @param Data: pointer to the data buffer
+ * @param Length: amount of data bytes to transfer
+ */
+void XPD_USB_EP_TransmitEnd(USB_HandleType * husb, uint8_t EpAddress, uint8_t * Data, uint16_t Length)
+{
+    USB_EndPointHandleType * ep = &husb->EP.IN[EpAddress & 0x7F];
+
+    /* setup and start the transfer */
+    ep->Transfer.buffer = Data;
+    ep->Transfer.size   = 0;
+    ep->PendingZLP      = (ep->Type == USB_EP_TYPE_BULK) && (Length > 0)
+            && ((Length % ep->MaxPacketSize) == 0);
 
     usb_epTransmit(husb, ep, Length);
 }
@@ -699,17 +910,40 @@ void XPD_USB_EP_ClearStall(USB_HandleType * husb, uint8_t EpAddress)
     ep->Stalled = FALSE;
 }
 
+#ifdef USE_XPD_CONST_CALLBACKS
 /**
- * @brief USB interrupt handler that provides event-driven peripheral management
- *        and handle callbacks.
+ * @brief USB event callback without any operation,
+ *        for the unused single parameter entries of the constant callback table.
+ * @param User: pointer to the upper stack handler
+ * @return 0
+ */
+int XPD_USB_NullCallback(void * User)
+{
+    (void) User;
+    return 0;
+}
+#endif
+
+/**
+ * @brief Services the pending USB events with bounded work, the handle callbacks
+ *        are called the same way as from the interrupt handler.
+ * @note  In polled operation the USB IRQ is kept disabled in NVIC, and this function
+ *        is called periodically from a fixed point of the application loop.
  * @param husb: pointer to the USB handle structure
+ * @param MaxPackets: the maximum number of endpoint packets to process,
+ *                    the rest of them remain pending for the next call
+ * @return The number of processed endpoint packets
  */
-void XPD_USB_IRQHandler(USB_HandleType * husb)
+uint32_t XPD_USB_Poll(USB_HandleType * husb, uint32_t MaxPackets)
 {
-    uint32_t istr;
+    XPD_PROFILE_BEGIN();
+    XPD_STATS_IRQ_BEGIN();
+
+    uint32_t istr, packets = 0;
 
     /* loop while Endpoint interrupts are present */
-    for (istr = USB->ISTR.w; (istr & USB_ISTR_CTR) != 0; istr = USB->ISTR.w)
+    for (istr = USB->ISTR.w; ((istr & USB_ISTR_CTR) != 0) && (packets < MaxPackets);
+            istr = USB->ISTR.w, packets++)
     {
         /* Read highest priority endpoint number */
         uint8_t  epId  = (uint8_t)(istr & USB_ISTR_EP_ID);
@@ -730,9 +964,12 @@ void XPD_USB_IRQHandler(USB_HandleType * husb)
 
                 ep->Transfer.size = USB_EP_BDT[0].TX_COUNT & 0x3FF;
                 ep->Transfer.buffer += ep->Transfer.size;
+                XPD_STATS_ADD(husb, Bytes, ep->Transfer.size);
+                XPD_STATS_ADD(husb, Transfers, 1);
 
                 /* IN packet successfully sent */
-                XPD_SAFE_CALLBACK(husb->Callbacks.DataInStage, husb->User, 0,
+                XPD_TRACE(XPD_TRACE_USB_DATA_IN, 0);
+                XPD_HANDLE_CALLBACK(husb, DataInStage, husb->User, 0,
                         ep->Transfer.buffer);
 
                 /* Set device address if new valid has been received */
@@ -754,13 +991,15 @@ void XPD_USB_IRQHandler(USB_HandleType * husb)
                 {
                     usb_readPMA((uint8_t*) husb->Setup, (husb->BdtSize + ep->PacketAddress),
                             ep->Transfer.size);
+                    XPD_STATS_ADD(husb, Bytes, ep->Transfer.size);
+                    XPD_STATS_ADD(husb, Transfers, 1);
 
                     /* Clear RX complete flag */
                     USB_CLEAR_EP_FLAG(0, CTR_RX);
 
                     /* Process SETUP Packet */
-                    XPD_SAFE_CALLBACK(husb->Callbacks.SetupStage,
-                            husb->User, (uint8_t *)husb->Setup);
+                    XPD_TRACE(XPD_TRACE_USB_SETUP, 0);
+                    XPD_HANDLE_CALLBACK(husb, SetupStage, husb->User, (uint8_t *)husb->Setup);
                 }
 
                 /* Get Control Data OUT Packet */
@@ -775,11 +1014,13 @@ void XPD_USB_IRQHandler(USB_HandleType * husb)
                         usb_readPMA(ep->Transfer.buffer, (husb->BdtSize + ep->PacketAddress),
                                 ep->Transfer.size);
                         ep->Transfer.buffer += ep->Transfer.size;
+                        XPD_STATS_ADD(husb, Bytes, ep->Transfer.size);
                     }
+                    XPD_STATS_ADD(husb, Transfers, 1);
 
                     /* Process Control Data OUT Packet */
-                    XPD_SAFE_CALLBACK(husb->Callbacks.DataOutStage,
-                            husb->User, 0, ep->Transfer.buffer);
+                    XPD_TRACE(XPD_TRACE_USB_DATA_OUT, 0);
+                    XPD_HANDLE_CALLBACK(husb, DataOutStage, husb->User, 0, ep->Transfer.buffer);
 
                     /* Keep EP0 in receiving state */
                     USB_EP_BDT[0].RX_COUNT = usb_epConvertRxCount(ep->MaxPacketSize);
@@ -815,24 +1056,45 @@ void XPD_USB_IRQHandler(USB_HandleType * husb)
                     count       = USB_EP_BDT[epId].RX_COUNT & 0x3FF;
                 }
 
-                usb_readPMA(ep->Transfer.buffer, pmaAddress, count);
+                /* The reception buffers are larger than the remaining space of a short transfer
+                 * (max packet size when double buffered, rounded up to block size otherwise),
+                 * the excess data is dropped as overrun */
+                if (count > ep->PacketLength)
+                {
+                    XPD_STATS_ERROR(husb, 2);
+                    count = ep->PacketLength;
+                }
 
-                /* Switch the reception buffer by toggling SW_BUF flag */
                 if (ep->DoubleBuffer == ENABLE)
                 {
-                    USB_TOGGLE(epId, DTOG_TX);
+                    /* If more packets follow, switch the reception buffer by toggling SW_BUF flag
+                     * before reading, so the next packet is received during the copy,
+                     * otherwise the buffer is held (NAK) until the next reception request */
+                    if ((ep->Transfer.length == 0) || (count < ep->MaxPacketSize))
+                    {
+                        USB_EP_SET_STATUS(epId, RX, NAK);
+                    }
+                    else if (((epReg ^ (epReg >> 8)) & USB_EP_DTOG_TX) == 0)
+                    {
+                        USB_TOGGLE(epId, DTOG_TX);
+                    }
                 }
 
+                usb_readPMA(ep->Transfer.buffer, pmaAddress, count);
+                XPD_STATS_ADD(husb, Bytes, count);
+
                 ep->Transfer.size   += count;
                 ep->Transfer.buffer += count;
 
                 /* If the last packet of the data, transfer is complete
-                 * TODO 64 byte single message is not handled */
+                 * (a full last packet is followed by ZLP from the host
+                 * when the transfer is shorter than requested) */
                 if ((ep->Transfer.length == 0) || (count < ep->MaxPacketSize))
                 {
                     /* Reception finished */
-                    XPD_SAFE_CALLBACK(husb->Callbacks.DataOutStage,
-                            husb->User, EpAddress, ep->Transfer.buffer);
+                    XPD_STATS_ADD(husb, Transfers, 1);
+                    XPD_TRACE(XPD_TRACE_USB_DATA_OUT, EpAddress);
+                    XPD_HANDLE_CALLBACK(husb, DataOutStage, husb->User, EpAddress, ep->Transfer.buffer);
                 }
                 else
                 {
@@ -865,16 +1127,24 @@ void XPD_USB_IRQHandler(USB_HandleType * husb)
 
                 /* Clear register to avoid initial repeated data sending */
                 (*pCountReg) = 0;
+                XPD_STATS_ADD(husb, Bytes, count);
 
                 ep->Transfer.size   += count;
                 ep->Transfer.buffer += count;
 
                 /* If the last packet of the data */
-                if (ep->Transfer.length == 0)
+                if ((ep->Transfer.length == 0) && (ep->PendingZLP == TRUE))
+                {
+                    /* Terminate the transfer with a zero length packet */
+                    ep->PendingZLP = FALSE;
+                    usb_epTransmit(husb, ep, 0);
+                }
+                else if (ep->Transfer.length == 0)
                 {
                     /* Transmission complete */
-                    XPD_SAFE_CALLBACK(husb->Callbacks.DataInStage,
-                            husb->User, EpAddress, ep->Transfer.buffer);
+                    XPD_STATS_ADD(husb, Transfers, 1);
+                    XPD_TRACE(XPD_TRACE_USB_DATA_IN, EpAddress);
+                    XPD_HANDLE_CALLBACK(husb, DataInStage, husb->User, EpAddress, ep->Transfer.buffer);
                 }
                 else
                 {
@@ -889,7 +1159,8 @@ void XPD_USB_IRQHandler(USB_HandleType * husb)
     if ((istr & USB_ISTR_RESET) != 0)
     {
         XPD_USB_ClearFlag(husb, RESET);
-        XPD_SAFE_CALLBACK(husb->Callbacks.Reset, husb->User);
+        XPD_TRACE(XPD_TRACE_USB_RESET, 0);
+        XPD_HANDLE_CALLBACK(husb, Reset, husb->User);
 
         /* reset device address, enable addressing */
         USB->DADDR.w = USB_DADDR_EF;
@@ -903,7 +1174,8 @@ void XPD_USB_IRQHandler(USB_HandleType * husb)
 
         XPD_USB_ClearFlag(husb, WKUP);
 
-        XPD_SAFE_CALLBACK(husb->Callbacks.Resume, husb->User);
+        XPD_TRACE(XPD_TRACE_USB_RESUME, 0);
+        XPD_HANDLE_CALLBACK(husb, Resume, husb->User);
 
         /* LPM state is changed after Resume callback
          * -> possible to determine exited suspend level */
@@ -921,7 +1193,8 @@ void XPD_USB_IRQHandler(USB_HandleType * husb)
 
         /* Set the target Link State */
         husb->LinkState = USB_LPM_L1;
-        XPD_SAFE_CALLBACK(husb->Callbacks.Suspend, husb->User);
+        XPD_TRACE(XPD_TRACE_USB_SUSPEND, husb->LinkState);
+        XPD_HANDLE_CALLBACK(husb, Suspend, husb->User);
     }
 #endif
 
@@ -937,7 +1210,8 @@ void XPD_USB_IRQHandler(USB_HandleType * husb)
         {
             /* Set the target Link State */
             husb->LinkState = USB_LPM_L2;
-            XPD_SAFE_CALLBACK(husb->Callbacks.Suspend, husb->User);
+            XPD_TRACE(XPD_TRACE_USB_SUSPEND, husb->LinkState);
+            XPD_HANDLE_CALLBACK(husb, Suspend, husb->User);
         }
     }
 
@@ -945,8 +1219,35 @@ void XPD_USB_IRQHandler(USB_HandleType * husb)
     if ((istr & USB_ISTR_SOF) != 0)
     {
         XPD_USB_ClearFlag(husb, SOF);
-        XPD_SAFE_CALLBACK(husb->Callbacks.SOF, husb->User);
+        XPD_HANDLE_CALLBACK(husb, SOF, husb->User);
+    }
+
+#ifdef USE_XPD_STATISTICS
+    /* Count the packet errors and overruns, their interrupts are not used */
+    if ((istr & (USB_ISTR_ERR | USB_ISTR_PMAOVR)) != 0)
+    {
+        XPD_STATS_ERROR(husb, (((istr & USB_ISTR_ERR) != 0) ? 1 : 0)
+                            | (((istr & USB_ISTR_PMAOVR) != 0) ? 2 : 0));
+
+        XPD_USB_ClearFlag(husb, ERR);
+        XPD_USB_ClearFlag(husb, PMAOVR);
     }
+#endif
+
+    XPD_STATS_IRQ_END(husb);
+    XPD_PROFILE_END();
+
+    return packets;
+}
+
+/**
+ * @brief USB interrupt handler that provides event-driven peripheral management
+ *        and handle callbacks.
+ * @param husb: pointer to the USB handle structure
+ */
+void XPD_USB_IRQHandler(USB_HandleType * husb)
+{
+    (void) XPD_USB_Poll(husb, ~0UL);
 }
 
 /**
@@ -1087,6 +1388,17 @@ USB_ChargerType XPD_USB_ChargerDetect(USB_HandleType * husb)
 #define USB_ENDPOINT_COUNT(HANDLE)     4
 #endif
 
+#ifdef USB_OTG_HS
+#define USB_FIFO_RAM_WORDS(HANDLE)     \
+    ((((uint32_t) husb->Inst) == ((uint32_t)USB_OTG_HS)) ? (4096 / 4) : (1280 / 4))
+#else
+#define USB_FIFO_RAM_WORDS(HANDLE)     (1280 / 4)
+#endif
+
+/* FIFO sizes are in 32-bit words, the minimal transmit FIFO depth is 16 words */
+#define USB_FIFO_WORDS(BYTES)          (((uint32_t)(BYTES) + 3) / 4)
+#define USB_FIFO_DEPTH(BYTES)          ((USB_FIFO_WORDS(BYTES) > 16) ? USB_FIFO_WORDS(BYTES) : 16)
+
 /* Set the status of the DP pull-up resistor */
 __STATIC_INLINE void usb_connectionStateCtrl(USB_HandleType * husb, FunctionalState NewState)
 {
@@ -1148,12 +1460,23 @@ static void usb_writePacket(USB_OTG_TypeDef * USBx, uint8_t FIFOx, uint8_t * Dat
 /* Pop packet data from OUT FIFO */
 static void usb_readPacket(USB_OTG_TypeDef * USBx, uint8_t * Data, uint16_t Length)
 {
-    uint32_t wordCount = (Length + 3) / 4;
+    uint32_t wordCount = Length / 4;
+    uint32_t remaining = Length & 3;
 
     for (; wordCount > 0; wordCount--, Data += 4)
     {
         *(__packed uint32_t *) Data = USBx->DFIFO[0].DR;
+    }
 
+    /* The last partial word is stored without overrunning the buffer */
+    if (remaining > 0)
+    {
+        uint32_t word = USBx->DFIFO[0].DR;
+
+        for (; remaining > 0; remaining--, word >>= 8)
+        {
+            *Data++ = (uint8_t)word;
+        }
     }
 }
 
@@ -1222,6 +1545,9 @@ XPD_ReturnType XPD_USB_Init(USB_HandleType * husb, const USB_InitType * Config)
     /* Disable the Interrupts */
     USB_REG_BIT(husb,GAHBCFG,GINT) = 0;
 
+    /* Select the IN FIFO level of the Tx FIFO empty interrupt */
+    USB_REG_BIT(husb,GAHBCFG,TXFELVL) = Config->TxFifoEmpty;
+
 #if (USB_DATA_WORD_ALIGNED == 1) && defined(USB_OTG_GAHBCFG_DMAEN)
     /* Set dedicated DMA */
     if (Config->DMA != DISABLE)
@@ -1501,6 +1827,89 @@ void XPD_USB_EP_BufferInit(USB_HandleType * husb, uint8_t EpAddress, uint16_t Bu
     }
 }
 
+/**
+ * @brief Allocates the peripheral FIFO RAM for the endpoints of the configuration
+ *        after device initialization and before starting the USB operation.
+ *        The global receive FIFO holds the SETUP packets and two of the largest OUT packets,
+ *        each IN endpoint gets a transmit FIFO of one packet, then the remaining space
+ *        is shared out by whole packets among the bulk and isochronous IN endpoints,
+ *        so that multiple packets can be queued for them.
+ * @note  This function replaces the manual allocation by @ref XPD_USB_EP_BufferInit.
+ * @param husb: pointer to the USB handle structure
+ * @param Endpoints: the endpoints of the configuration (except EP0)
+ * @param Count: the number of endpoints
+ * @return ERROR if the endpoints are invalid or don't fit in the FIFO RAM, OK if success
+ */
+XPD_ReturnType XPD_USB_EP_FifoAlloc(USB_HandleType * husb,
+        const USB_EndPointConfigType * Endpoints, uint8_t Count)
+{
+    uint8_t i, epCount = USB_ENDPOINT_COUNT(husb);
+    uint32_t maxOut = USB_EP0_MAX_PACKET_SIZE, outCount = 1;
+    uint32_t used, added;
+
+    for (i = 1; i < epCount; i++)
+    {
+        husb->EP.IN[i].FifoSize = 0;
+    }
+
+    /* The minimal transmit FIFOs of the IN endpoints */
+    husb->EP.IN[0].FifoSize = USB_FIFO_DEPTH(USB_EP0_MAX_PACKET_SIZE);
+    used = husb->EP.IN[0].FifoSize;
+
+    for (i = 0; i < Count; i++)
+    {
+        uint8_t epNum = Endpoints[i].Address & 0x7F;
+
+        if ((epNum == 0) || (epNum >= epCount))
+        {
+            return XPD_ERROR;
+        }
+        else if (Endpoints[i].Address > 0x7F)
+        {
+            husb->EP.IN[epNum].FifoSize = USB_FIFO_DEPTH(Endpoints[i].MaxPacketSize);
+            used += husb->EP.IN[epNum].FifoSize;
+        }
+        else
+        {
+            outCount++;
+            if (maxOut < Endpoints[i].MaxPacketSize)
+            {
+                maxOut = Endpoints[i].MaxPacketSize;
+            }
+        }
+    }
+
+    /* Receive FIFO: SETUP packets, two of the largest packets with their status,
+     * transfer complete status of each OUT endpoint and global OUT NAK */
+    husb->EP.OUT[0].FifoSize = (5 + 8) + 2 * (USB_FIFO_WORDS(maxOut) + 1) + 2 * outCount + 1;
+    used += husb->EP.OUT[0].FifoSize;
+
+    if (used > USB_FIFO_RAM_WORDS(husb))
+    {
+        return XPD_ERROR;
+    }
+
+    /* Extend the streaming IN endpoint FIFOs by a packet in turns while there is space */
+    do {
+        added = 0;
+        for (i = 0; i < Count; i++)
+        {
+            uint32_t words = USB_FIFO_WORDS(Endpoints[i].MaxPacketSize);
+
+            if ((Endpoints[i].Address > 0x7F) && (words > 0) &&
+                ((Endpoints[i].Type == USB_EP_TYPE_BULK) || (Endpoints[i].Type == USB_EP_TYPE_ISOCHRONOUS)) &&
+                ((used + words) <= USB_FIFO_RAM_WORDS(husb)))
+            {
+                husb->EP.IN[Endpoints[i].Address & 0x7F].FifoSize += words;
+                used  += words;
+                added += words;
+            }
+        }
+    } while (added > 0);
+
+    return XPD_OK;
+}
+
 /**
  * @brief Opens an endpoint
  * @param husb: pointer to the USB handle structure
@@ -1849,12 +2258,51 @@ void XPD_USB_EP_ClearStall(USB_HandleType * husb, uint8_t EpAddress)
     ep->Stalled = FALSE;
 }
 
+#ifdef USE_XPD_CONST_CALLBACKS
+/**
+ * @brief USB event callback without any operation,
+ *        for the unused single parameter entries of the constant callback table.
+ * @param User: pointer to the upper stack handler
+ * @return 0
+ */
+int XPD_USB_NullCallback(void * User)
+{
+    (void) User;
+    return 0;
+}
+#endif
+
+/**
+ * @brief Connects the SOF pulse of the USB peripheral to the TIM2 internal trigger 1,
+ *        so the timer can capture the start of each frame.
+ * @note  The TIM2 capture channel has to use the TIM_INPUT_TRC source and
+ *        the TIM_TRGI_ITR1 trigger input.
+ * @param husb: pointer to the USB handle structure
+ * @param NewState: whether TIM2 ITR1 is connected to the USB SOF instead of TIM8 TRGO
+ */
+void XPD_USB_SOF_TimerTrigger(USB_HandleType * husb, FunctionalState NewState)
+{
+    (void) husb;
+
+    if (NewState != DISABLE)
+    {
+        SET_BIT(TIM2->OR1, TIM2_OR1_ITR1_RMP);
+    }
+    else
+    {
+        CLEAR_BIT(TIM2->OR1, TIM2_OR1_ITR1_RMP);
+    }
+}
+
 /**
  * @brief USB interrupt handler that provides event-driven peripheral management and handle callbacks.
  * @param husb: pointer to the USB handle structure
  */
 void XPD_USB_IRQHandler(USB_HandleType * husb)
 {
+    XPD_PROFILE_BEGIN();
+    XPD_STATS_IRQ_BEGIN();
+
     uint32_t gints = husb->Inst->GINTSTS.w & husb->Inst->GINTMSK.w;
 
     if (gints != 0)
@@ -1895,7 +2343,9 @@ void XPD_USB_IRQHandler(USB_HandleType * husb)
 #endif
 
                         /* Data packet received callback */
-                        XPD_SAFE_CALLBACK(husb->Callbacks.DataOutStage, husb->User, EpAddress, husb->EP.OUT[EpAddress].Transfer.buffer);
+                        XPD_STATS_ADD(husb, Transfers, 1);
+                        XPD_TRACE(XPD_TRACE_USB_DATA_OUT, EpAddress);
+                        XPD_HANDLE_CALLBACK(husb, DataOutStage, husb->User, EpAddress, husb->EP.OUT[EpAddress].Transfer.buffer);
 
 #if (USB_DATA_WORD_ALIGNED == 1) && defined(USB_OTG_GAHBCFG_DMAEN)
                         if (husb->DMA == ENABLE)
@@ -1916,7 +2366,9 @@ void XPD_USB_IRQHandler(USB_HandleType * husb)
                         husb->Inst->OEP[EpAddress].DOEPINT.w = USB_OTG_DOEPINT_STUP;
 
                         /* Setup packet received callback */
-                        XPD_SAFE_CALLBACK(husb->Callbacks.SetupStage, husb->User, (uint8_t *)husb->Setup);
+                        XPD_STATS_ADD(husb, Transfers, 1);
+                        XPD_TRACE(XPD_TRACE_USB_SETUP, 0);
+                        XPD_HANDLE_CALLBACK(husb, SetupStage, husb->User, (uint8_t *)husb->Setup);
                     }
 
                     /* Clear irrelevant flags */
@@ -1959,7 +2411,9 @@ void XPD_USB_IRQHandler(USB_HandleType * husb)
                         }
 #endif
 
-                        XPD_SAFE_CALLBACK(husb->Callbacks.DataInStage, husb->User, EpAddress, husb->EP.IN[EpAddress].Transfer.buffer);
+                        XPD_STATS_ADD(husb, Transfers, 1);
+                        XPD_TRACE(XPD_TRACE_USB_DATA_IN, EpAddress);
+                        XPD_HANDLE_CALLBACK(husb, DataInStage, husb->User, EpAddress, husb->EP.IN[EpAddress].Transfer.buffer);
 
 #if (USB_DATA_WORD_ALIGNED == 1) && defined(USB_OTG_GAHBCFG_DMAEN)
                         if (husb->DMA == ENABLE)
@@ -1977,37 +2431,47 @@ void XPD_USB_IRQHandler(USB_HandleType * husb)
                     if ((epint & USB_OTG_DIEPINT_TXFE) != 0)
                     {
                         USB_EndPointHandleType * ep = &husb->EP.IN[EpAddress];
-                        uint32_t count = ep->Transfer.length - ep->Transfer.size;
-
-                        if (count > ep->MaxPacketSize)
-                        {
-                            count = ep->MaxPacketSize;
-                        }
+                        uint32_t space = husb->Inst->IEP[EpAddress].DTXFSTS & USB_OTG_DTXFSTS_INEPTFSAV;
 
-                        while ((ep->Transfer.size < ep->Transfer.length) &&
-                               (husb->Inst->IEP[EpAddress].DTXFSTS > ((count + 3) / 4)))
+                        /* The FIFO space only grows while it is filled,
+                         * so as many whole packets are written as the space read once allows */
+                        while (ep->Transfer.size < ep->Transfer.length)
                         {
-                            count = ep->Transfer.length - ep->Transfer.size;
+                            uint32_t count = ep->Transfer.length - ep->Transfer.size;
 
                             if (count > ep->MaxPacketSize)
                             {
                                 count = ep->MaxPacketSize;
                             }
+                            if (space < ((count + 3) / 4))
+                            {
+                                break;
+                            }
+                            space -= (count + 3) / 4;
 
                             /* Write another packet to FIFO */
                             usb_writePacket(husb->Inst, EpAddress, ep->Transfer.buffer, count);
+                            XPD_STATS_ADD(husb, Bytes, count);
 
                             ep->Transfer.buffer += count;
                             ep->Transfer.size   += count;
                         }
 
-                        if (count == 0)
+                        if (ep->Transfer.size >= ep->Transfer.length)
                         {
-                            /* Clear empty EP flag */
+                            /* All data is in the FIFO, clear empty EP flag */
                             CLEAR_BIT(husb->Inst->DIEPEMPMSK, 0x1 << EpAddress);
                         }
                     }
 
+#ifdef USE_XPD_STATISTICS
+                    /* IN token timeout is counted as packet error */
+                    if ((epint & USB_OTG_DIEPINT_TOC) != 0)
+                    {
+                        XPD_STATS_ERROR(husb, 1);
+                    }
+#endif
+
                     /* Clear irrelevant flags */
                     husb->Inst->IEP[EpAddress].DIEPINT.w =
                             USB_OTG_DIEPINT_TOC    | USB_OTG_DIEPINT_ITTXFE
@@ -2032,6 +2496,7 @@ void XPD_USB_IRQHandler(USB_HandleType * husb)
                 case STS_DATA_UPDT:
                     /* Data packet received */
                     usb_readPacket(husb->Inst, ep->Transfer.buffer, count);
+                    XPD_STATS_ADD(husb, Bytes, count);
                     ep->Transfer.buffer += count;
                     ep->Transfer.size   += count;
                     break;
@@ -2039,6 +2504,7 @@ void XPD_USB_IRQHandler(USB_HandleType * husb)
                 case STS_SETUP_UPDT:
                     /* Setup packet received */
                     usb_readPacket(husb->Inst, (uint8_t *) husb->Setup, count);
+                    XPD_STATS_ADD(husb, Bytes, count);
                     ep->Transfer.size += count;
                     break;
 
@@ -2120,18 +2586,26 @@ void XPD_USB_IRQHandler(USB_HandleType * husb)
 
             XPD_USB_ClearFlag(husb, ENUMDNE);
 
-            XPD_SAFE_CALLBACK(husb->Callbacks.Reset, husb->User);
+            XPD_TRACE(XPD_TRACE_USB_RESET, 0);
+            XPD_HANDLE_CALLBACK(husb, Reset, husb->User);
         }
 
         /* Handle Resume Interrupt */
         if ((gints & USB_OTG_GINTSTS_WKUINT) != 0)
         {
+            /* Restore the PHY clock first to resume the link quickly */
+            if (husb->LowPowerMode == ENABLE)
+            {
+                XPD_USB_PHY_ClockCtrl(husb, ENABLE);
+            }
+
             /* Clear the Remote Wake-up Signaling */
             USB_REG_BIT(husb,DCTL,RWUSIG) = 0;
 
             XPD_USB_ClearFlag(husb, WKUINT);
 
-            XPD_SAFE_CALLBACK(husb->Callbacks.Resume, husb->User);
+            XPD_TRACE(XPD_TRACE_USB_RESUME, 0);
+            XPD_HANDLE_CALLBACK(husb, Resume, husb->User);
 
             /* LPM state is changed after Resume callback
              * -> possible to determine exited suspend level */
@@ -2144,9 +2618,20 @@ void XPD_USB_IRQHandler(USB_HandleType * husb)
         {
             XPD_USB_ClearFlag(husb, LPMINT);
 
-            /* Set the target Link State */
-            husb->LinkState = USB_LPM_L1;
-            XPD_SAFE_CALLBACK(husb->Callbacks.Suspend, husb->User);
+            /* Only the transition from the active state is an L1 entry */
+            if (husb->LinkState == USB_LPM_L0)
+            {
+                /* Set the target Link State */
+                husb->LinkState = USB_LPM_L1;
+                XPD_TRACE(XPD_TRACE_USB_SUSPEND, husb->LinkState);
+                XPD_HANDLE_CALLBACK(husb, Suspend, husb->User);
+
+                /* Gate the PHY clock, the host resumes within the BESL time */
+                if (husb->LowPowerMode == ENABLE)
+                {
+                    XPD_USB_PHY_ClockCtrl(husb, DISABLE);
+                }
+            }
         }
 #endif
 
@@ -2159,7 +2644,14 @@ void XPD_USB_IRQHandler(USB_HandleType * husb)
             {
                 /* Set the target Link State */
                 husb->LinkState = USB_LPM_L2;
-                XPD_SAFE_CALLBACK(husb->Callbacks.Suspend, husb->User);
+                XPD_TRACE(XPD_TRACE_USB_SUSPEND, husb->LinkState);
+                XPD_HANDLE_CALLBACK(husb, Suspend, husb->User);
+
+                /* Gate the PHY clock until the bus is resumed */
+                if (husb->LowPowerMode == ENABLE)
+                {
+                    XPD_USB_PHY_ClockCtrl(husb, DISABLE);
+                }
             }
         }
 
@@ -2167,7 +2659,7 @@ void XPD_USB_IRQHandler(USB_HandleType * husb)
         if ((gints & USB_OTG_GINTSTS_SRQINT) != 0)
         {
             XPD_USB_ClearFlag(husb, SRQINT);
-            XPD_SAFE_CALLBACK(husb->Callbacks.Connected, husb->User);
+            XPD_HANDLE_CALLBACK(husb, Connected, husb->User);
         }
 
         /* Handle Disconnection event Interrupt */
@@ -2175,7 +2667,7 @@ void XPD_USB_IRQHandler(USB_HandleType * husb)
         {
             if ((husb->Inst->GOTGINT.w & USB_OTG_GOTGINT_SEDET) != 0)
             {
-                XPD_SAFE_CALLBACK(husb->Callbacks.Disconnected, husb->User);
+                XPD_HANDLE_CALLBACK(husb, Disconnected, husb->User);
             }
 
             /* Clear all flags */
@@ -2187,9 +2679,34 @@ void XPD_USB_IRQHandler(USB_HandleType * husb)
         {
             XPD_USB_ClearFlag(husb, SOF);
 
-            XPD_SAFE_CALLBACK(husb->Callbacks.SOF, husb->User);
+            XPD_HANDLE_CALLBACK(husb, SOF, husb->User);
         }
     }
+
+    XPD_STATS_IRQ_END(husb);
+    XPD_PROFILE_END();
+}
+
+/**
+ * @brief Services the pending USB events with bounded work, the handle callbacks
+ *        are called the same way as from the interrupt handler.
+ * @note  In polled operation the USB IRQ is kept disabled in NVIC, and this function
+ *        is called periodically from a fixed point of the application loop.
+ * @param husb: pointer to the USB handle structure
+ * @param MaxPackets: the maximum number of interrupt handler passes, each of them
+ *                    processes at most one received packet from the receive FIFO
+ * @return The number of performed passes
+ */
+uint32_t XPD_USB_Poll(USB_HandleType * husb, uint32_t MaxPackets)
+{
+    uint32_t packets;
+
+    for (packets = 0; (packets < MaxPackets)
+            && ((husb->Inst->GINTSTS.w & husb->Inst->GINTMSK.w) != 0); packets++)
+    {
+        XPD_USB_IRQHandler(husb);
+    }
+    return packets;
 }
 
 /**
@@ -2208,8 +2725,19 @@ void XPD_USB_PHY_ClockCtrl(USB_HandleType * husb, FunctionalState NewState)
  */
 void XPD_USB_ActivateRemoteWakeup(USB_HandleType * husb)
 {
-    if (USB_REG_BIT(husb,DSTS,SUSPSTS) != 0)
+    if ((USB_REG_BIT(husb,DSTS,SUSPSTS) != 0)
+#ifdef USB_OTG_GLPMCFG_LPMEN
+        /* L1 remote wakeup is only allowed if the host enabled it in the LPM token */
+        || ((husb->LinkState == USB_LPM_L1) && (USB_REG_BIT(husb,GLPMCFG,REMWAKE) != 0))
+#endif
+       )
     {
+        /* The PHY clock is needed for the signaling */
+        if (husb->LowPowerMode == ENABLE)
+        {
+            XPD_USB_PHY_ClockCtrl(husb, ENABLE);
+        }
+
         /* Activate Remote wakeup signaling */
         USB_REG_BIT(husb,DCTL,RWUSIG) = 1;
     }
@@ -25,6 +25,10 @@
 #include "xpd_rcc.h"
 #include "xpd_core.h"
 #include "xpd_flash.h"
+#include "xpd_exti.h"
+#include "xpd_pwr.h"
+#include "xpd_rtc.h"
+#include "xpd_gpio.h"
 
 extern uint32_t SystemCoreClock;
 
@@ -39,166 +43,2159 @@ extern uint32_t SystemCoreClock;
  * @{
  */
 
+static uint64_t xpd_ticks = 0;          /* the extended tick count at the last update */
+static uint32_t xpd_lastTickCount = 0;  /* the hardware counter value at the last update */
+
+/* updates the extended tick count with the elapsed core clock cycles */
+static uint64_t xpd_ticksUpdate(void)
+{
+    uint64_t ticks;
+    uint32_t count;
+    uint32_t primask = __get_PRIMASK();
+
+    /* The counter is sampled and the extended count is updated atomically,
+     * otherwise a preempting update could leave an older sample behind */
+    __disable_irq();
+
+#ifdef DWT_CTRL_CYCCNTENA_Msk
+    count = DWT->CYCCNT;
+
+    /* The cycle counter is counting up */
+    xpd_ticks += count - xpd_lastTickCount;
+#else
+    count = SysTick->VAL;
+
+    /* SysTick is counting down, and reloads from LOAD */
+    if (count <= xpd_lastTickCount)
+    {
+        xpd_ticks += xpd_lastTickCount - count;
+    }
+    else
+    {
+        xpd_ticks += xpd_lastTickCount + SysTick->LOAD + 1 - count;
+    }
+#endif
+    xpd_lastTickCount = count;
+    ticks = xpd_ticks;
+
+    __set_PRIMASK(primask);
+
+    return ticks;
+}
+
+/* waits until the masked value read from address equals or differs from the match,
+ * using the tick counter for the timeout */
+static XPD_ReturnType xpd_waitFor(volatile uint32_t * varAddress, uint32_t bitSelector,
+        uint32_t match, boolean_t equal, uint32_t * mstimeout)
+{
+    XPD_ReturnType result = XPD_OK;
+    uint32_t ticksPerMs = SystemCoreClock / 1000;
+    uint64_t now = xpd_ticksUpdate();
+    uint64_t deadline = now + (uint64_t)*mstimeout * ticksPerMs;
+
+    while (((*varAddress & bitSelector) == match) != equal)
+    {
+        now = xpd_ticksUpdate();
+        if (now >= deadline)
+        {
+            result = XPD_TIMEOUT;
+            break;
+        }
+    }
+
+    /* Return the remaining time */
+    if (result == XPD_OK)
+    {
+        *mstimeout = (uint32_t)((deadline - now) / ticksPerMs);
+    }
+    else
+    {
+        *mstimeout = 0;
+    }
+    return result;
+}
+
+/* waits like xpd_waitFor, sleeping with WFE until an interrupt becomes pending
+ * (SEVONPEND) or an exception is taken between the value checks */
+static XPD_ReturnType xpd_waitForEvent(volatile uint32_t * varAddress, uint32_t bitSelector,
+        uint32_t match, boolean_t equal, IRQn_Type IRQn, uint32_t * mstimeout)
+{
+    XPD_ReturnType result = XPD_OK;
+    uint32_t ticksPerMs = SystemCoreClock / 1000;
+    uint64_t now = xpd_ticksUpdate();
+    uint64_t deadline = now + (uint64_t)*mstimeout * ticksPerMs;
+    uint32_t irqMask = 1UL << ((uint32_t)IRQn & 0x1F);
+    boolean_t irqEnabled = (NVIC->ISER[(uint32_t)IRQn >> 5] & irqMask) != 0;
+    uint32_t sevonpend = SCB->SCR.b.SEVONPEND;
+
+    SCB->SCR.b.SEVONPEND = 1;
+
+    while (((*varAddress & bitSelector) == match) != equal)
+    {
+        /* without the periodic SysTick exception the timeout couldn't be detected */
+        if (SysTick->CTRL.b.TICKINT != 0)
+        {
+            __WFE();
+        }
+
+        /* a disabled line remains pending, which wouldn't signal the next event */
+        if (irqEnabled == FALSE)
+        {
+            NVIC->ICPR[(uint32_t)IRQn >> 5] = irqMask;
+        }
+
+        now = xpd_ticksUpdate();
+        if (now >= deadline)
+        {
+            result = XPD_TIMEOUT;
+            break;
+        }
+    }
+
+    SCB->SCR.b.SEVONPEND = sevonpend;
+
+    /* Return the remaining time */
+    if (result == XPD_OK)
+    {
+        *mstimeout = (uint32_t)((deadline - now) / ticksPerMs);
+    }
+    else
+    {
+        *mstimeout = 0;
+    }
+    return result;
+}
+
+/**
+ * @brief Millisecond timer initializer utility. [overrideable]
+ * @note  On Cortex-M3 and Cortex-M4 cores the DWT cycle counter is enabled as well
+ *        for the tick count based utilities.
+ */
+__weak void XPD_InitTimer(void)
+{
+    /* Enable SysTick and configure 1ms tick */
+    XPD_SysTick_Init(SystemCoreClock / 1000, SYSTICK_CLOCKSOURCE_HCLK);
+    XPD_SysTick_Enable();
+
+#ifdef DWT_CTRL_CYCCNTENA_Msk
+    /* Enable the DWT cycle counter */
+    CoreDebug->DEMCR.b.TRCENA = 1;
+    DWT->CYCCNT = 0;
+    DWT->CTRL.b.CYCCNTENA = 1;
+    xpd_lastTickCount = 0;
+#else
+    xpd_lastTickCount = SysTick->VAL;
+#endif
+}
+
+/**
+ * @brief Returns the number of core clock cycles elapsed since @ref XPD_InitTimer.
+ * @note  The DWT cycle counter is used on Cortex-M3 and Cortex-M4 cores,
+ *        it has to be read at least once per 2^32 cycles (about 25 seconds at 168 MHz).
+ *        On Cortex-M0 cores the SysTick counter is used, which has to be read
+ *        at least once per SysTick period (1 ms).
+ * @return The 64-bit core clock tick count
+ */
+uint64_t XPD_GetTicks64(void)
+{
+    return xpd_ticksUpdate();
+}
+
+/**
+ * @brief Inserts code delay of the specified time in milliseconds.
+ * @note  The milliseconds based waiting utilities shall not be used concurrently.
+ *        The time of the preempted waiters do not elapse.
+ * @param milliseconds: the desired delay in ms
+ */
+__weak void XPD_Delay_ms(uint32_t milliseconds)
+{
+    /* Initially clear flag */
+    __IO uint32_t dummy = SysTick->CTRL.b.COUNTFLAG;
+    while (milliseconds != 0)
+    {
+        /* COUNTFLAG returns 1 if timer counted to 0 since the last flag read */
+        milliseconds -= SysTick->CTRL.b.COUNTFLAG;
+    }
+}
+
+/**
+ * @brief Inserts code delay of the specified time in microseconds.
+ *        The delay is measured in core clock cycles, independently of the code execution speed.
+ * @param microseconds: the desired delay in us
+ */
+__weak void XPD_Delay_us(uint32_t microseconds)
+{
+    uint64_t deadline = xpd_ticksUpdate()
+            + (uint64_t)microseconds * (SystemCoreClock / 1000000);
+
+    while (xpd_ticksUpdate() < deadline);
+}
+
+/**
+ * @brief Waits until the masked value read from address matches the input match, or until times out. [overrideable]
+ * @param varAddress: the word address that needs to be monitored
+ * @param bitSelector: a bit mask that selects which bits should be considered
+ * @param match: the expected value to wait for
+ * @param mstimeout: pointer to the timeout in ms, updated with the remaining time
+ * @return TIMEOUT if timed out, or OK if match occurred within the deadline
+ */
+__weak XPD_ReturnType XPD_WaitForMatch(
+        volatile uint32_t * varAddress, uint32_t bitSelector, uint32_t match,
+        uint32_t * mstimeout)
+{
+    return xpd_waitFor(varAddress, bitSelector, match, TRUE, mstimeout);
+}
+
+/**
+ * @brief Waits until the masked value read from address differs from the input match, or until times out. [overrideable]
+ * @param varAddress: the word address that needs to be monitored
+ * @param bitSelector: a bit mask that selects which bits should be considered
+ * @param match: the initial value that needs to differ
+ * @param mstimeout: pointer to the timeout in ms, updated with the remaining time
+ * @return TIMEOUT if timed out, or OK if match occurred within the deadline
+ */
+__weak XPD_ReturnType XPD_WaitForDiff(
+        volatile uint32_t * varAddress, uint32_t bitSelector, uint32_t match,
+        uint32_t * mstimeout)
+{
+    return xpd_waitFor(varAddress, bitSelector, match, FALSE, mstimeout);
+}
+
+/**
+ * @brief Waits until the masked value read from address matches the input match, or until times out,
+ *        sleeping between the checks instead of continuously reading the value.
+ * @note  The core wakes up when the interrupt line becomes pending, therefore the peripheral
+ *        interrupt request of the awaited flag has to be enabled. If the line is disabled in NVIC,
+ *        its pending state is cleared by the function, otherwise its handler is executed.
+ *        The timeout is checked at each wake-up, which requires the SysTick interrupt,
+ *        without that the function reads the value continuously.
+ * @param varAddress: the word address that needs to be monitored
+ * @param bitSelector: a bit mask that selects which bits should be considered
+ * @param match: the expected value to wait for
+ * @param IRQn: the interrupt line of the peripheral which signals the change of the value
+ * @param mstimeout: pointer to the timeout in ms, updated with the remaining time
+ * @return TIMEOUT if timed out, or OK if match occurred within the deadline
+ */
+XPD_ReturnType XPD_WaitForMatchEvent(
+        volatile uint32_t * varAddress, uint32_t bitSelector, uint32_t match,
+        IRQn_Type IRQn, uint32_t * mstimeout)
+{
+    return xpd_waitForEvent(varAddress, bitSelector, match, TRUE, IRQn, mstimeout);
+}
+
+/**
+ * @brief Waits until the masked value read from address differs from the input match, or until times out,
+ *        sleeping between the checks instead of continuously reading the value.
+ * @note  See the requirements at @ref XPD_WaitForMatchEvent.
+ * @param varAddress: the word address that needs to be monitored
+ * @param bitSelector: a bit mask that selects which bits should be considered
+ * @param match: the initial value that needs to differ
+ * @param IRQn: the interrupt line of the peripheral which signals the change of the value
+ * @param mstimeout: pointer to the timeout in ms, updated with the remaining time
+ * @return TIMEOUT if timed out, or OK if match occurred within the deadline
+ */
+XPD_ReturnType XPD_WaitForDiffEvent(
+        volatile uint32_t * varAddress, uint32_t bitSelector, uint32_t match,
+        IRQn_Type IRQn, uint32_t * mstimeout)
+{
+    return xpd_waitForEvent(varAddress, bitSelector, match, FALSE, IRQn, mstimeout);
+}
+
+/** @} */
+
+/** @defgroup SysTick_Exported_Functions_Service SysTick Tick Service Functions
+ *  @brief    Shared 1 ms time base with uptime counter and periodic subscribers
+ *  @details  The SysTick interrupt has to be started (@ref XPD_SysTick_Start_IT) after @ref XPD_InitTimer,
+ *            and @ref XPD_SysTick_IRQHandler has to be called from SysTick_Handler.
+ *            Any number of components can subscribe to the tick with their own period,
+ *            and the uptime can be read from any context without locking.
+ *            The handler doesn't read COUNTFLAG, so @ref XPD_Delay_ms is unaffected.
+ *            The timeouts of @ref XPD_WaitForMatch and @ref XPD_WaitForDiff are measured
+ *            by @ref XPD_GetTicks64 independently of the uptime, so on Cortex-M0 cores
+ *            the waiters still have to read it at least once per SysTick period.
+ * @{
+ */
+
+static struct {
+    SysTick_SubscriberType * Head;  /* the first registered subscriber */
+    volatile uint32_t Low;          /* the lower word of the elapsed ms */
+    volatile uint32_t Epoch;        /* the number of toggles of the Low bit 31 */
+} xpd_uptime = { .Head = NULL };
+
+/* advances the uptime, the epoch is updated after the lower word,
+ * so a preempted update is detected by the bit 31 mismatch */
+static void xpd_uptimeAdvance(uint32_t Milliseconds)
+{
+    uint32_t low = xpd_uptime.Low + Milliseconds;
+
+    xpd_uptime.Low = low;
+
+    if ((low >> 31) != (xpd_uptime.Epoch & 1))
+    {
+        xpd_uptime.Epoch++;
+    }
+}
+
+/**
+ * @brief Registers a periodic callback on the SysTick interrupt.
+ * @note  The subscriber list shall only be modified from one context.
+ * @param Subscriber: the subscriber to register, its Callback and Divisor (at least 1)
+ *        shall be set beforehand
+ */
+void XPD_SysTick_Subscribe(SysTick_SubscriberType * Subscriber)
+{
+    Subscriber->Countdown = Subscriber->Divisor;
+    Subscriber->Next = xpd_uptime.Head;
+
+    /* the subscriber becomes visible to the handler with a single store */
+    xpd_uptime.Head = Subscriber;
+}
+
+/**
+ * @brief Removes a periodic callback from the SysTick interrupt.
+ * @note  The subscriber list shall only be modified from one context.
+ * @param Subscriber: the registered subscriber to remove
+ */
+void XPD_SysTick_Unsubscribe(SysTick_SubscriberType * Subscriber)
+{
+    SysTick_SubscriberType ** link = &xpd_uptime.Head;
+
+    while (*link != NULL)
+    {
+        if (*link == Subscriber)
+        {
+            /* the handler can still step over the removed subscriber */
+            *link = Subscriber->Next;
+            break;
+        }
+        link = &(*link)->Next;
+    }
+}
+
+/**
+ * @brief Returns the milliseconds elapsed since the SysTick interrupt is started.
+ * @note  The uptime is kept through clock reconfigurations,
+ *        and the time spent in @ref XPD_TicklessIdle is included.
+ * @return The 64-bit monotonic millisecond uptime
+ */
+uint64_t XPD_SysTick_GetUptime_ms(void)
+{
+    uint32_t epoch = xpd_uptime.Epoch;
+    uint32_t low   = xpd_uptime.Low;
+
+    /* the lower word is ahead of the epoch if the update is preempted,
+     * or it has been advanced since the epoch read */
+    if ((low >> 31) != (epoch & 1))
+    {
+        epoch++;
+    }
+    return ((uint64_t)(epoch >> 1) << 32) | low;
+}
+
+/**
+ * @brief Returns the microseconds elapsed since the SysTick interrupt is started,
+ *        interpolated from the SysTick counter value.
+ * @return The 64-bit monotonic microsecond uptime
+ */
+uint64_t XPD_SysTick_GetUptime_us(void)
+{
+    uint32_t load = SysTick->LOAD + 1;
+    uint64_t ms;
+    uint32_t val, pending;
+
+    /* repeated if the handler has run in the meantime */
+    do
+    {
+        ms      = XPD_SysTick_GetUptime_ms();
+        val     = SysTick->VAL;
+        pending = SCB->ICSR.b.PENDSTSET;
+
+        /* the counter has reloaded, but the handler hasn't run yet (masked or preempted),
+         * the value has to be read after the reload */
+        if (pending != 0)
+        {
+            val = SysTick->VAL;
+        }
+    }
+    while (ms != XPD_SysTick_GetUptime_ms());
+
+    ms += pending;
+
+    return ms * 1000 + ((uint64_t)(load - 1 - val) * 1000) / load;
+}
+
+/**
+ * @brief SysTick interrupt handler that advances the uptime and calls the due subscribers.
+ */
+void XPD_SysTick_IRQHandler(void)
+{
+    SysTick_SubscriberType * subscriber;
+
+    xpd_uptimeAdvance(1);
+
+    for (subscriber = xpd_uptime.Head; subscriber != NULL; subscriber = subscriber->Next)
+    {
+        if (--subscriber->Countdown == 0)
+        {
+            subscriber->Countdown = subscriber->Divisor;
+
+            XPD_SAFE_CALLBACK(subscriber->Callback,);
+        }
+    }
+}
+
+/** @} */
+
+/** @defgroup XPD_Exported_Functions_Event XPD Event Wait Functions
+ *  @brief    XPD Utilities interrupt-less event dispatching for WFE-driven main loops
+ *  @details  The main loop sleeps until one of the armed sources signals an event,
+ *            then their callbacks are called from the main loop, without taking an interrupt:
+ *            @n - EXTI lines, which are configured with @ref REACTION_EVENT only,
+ *                 their callback is the EXTI_InitType::ITCallback
+ *            @n - peripheral interrupt lines, which are disabled in NVIC, the peripheral
+ *                 interrupt request itself is enabled, and its pending state wakes the core (SEVONPEND)
+ *  @code
+    static const XPD_EventSourceType sources[] = {
+        { .IRQn = USART2_IRQn, .Callback = (XPD_HandleCallbackType)XPD_USART_IRQHandler, .Handle = &husart2 },
+    };
+
+    XPD_EXTI_Init(0, &buttonEvent); // { .ITCallback = onButton, .Edge = EDGE_FALLING, .Reaction = REACTION_EVENT }
+    while (1)
+    {
+        (void) XPD_WaitForEvents(1 << 0, sources, 1);
+    }
+ *  @endcode
+ * @{
+ */
+
+/* calls the callbacks of the armed sources which have an event pending */
+static uint32_t xpd_eventDispatch(uint32_t Lines, const XPD_EventSourceType * Sources, uint8_t Count)
+{
+    uint32_t events = 0;
+    uint32_t i;
+
+    for (i = 0; Lines != 0; i++, Lines >>= 1)
+    {
+        if (((Lines & 1) != 0) && (XPD_EXTI_GetFlag(i) != 0))
+        {
+            XPD_EXTI_ClearFlag(i);
+
+            XPD_SAFE_CALLBACK(XPD_EXTI_Callbacks[i], i);
+            events++;
+        }
+    }
+
+    for (i = 0; i < Count; i++)
+    {
+        uint32_t irqIndex = (uint32_t)Sources[i].IRQn >> 5;
+        uint32_t irqMask = 1UL << ((uint32_t)Sources[i].IRQn & 0x1F);
+
+        if ((NVIC->ISPR[irqIndex] & irqMask) != 0)
+        {
+            XPD_SAFE_CALLBACK(Sources[i].Callback, Sources[i].Handle);
+
+            /* the peripheral requests are level sensitive,
+             * an unserved request sets the pending state again */
+            NVIC->ICPR[irqIndex] = irqMask;
+            events++;
+        }
+    }
+    return events;
+}
+
+/**
+ * @brief Sleeps with WFE until any of the armed sources signals an event,
+ *        then dispatches all pending events of the sources.
+ * @note  The core is also woken up by any taken exception (e.g. the SysTick interrupt),
+ *        in that case no event might be dispatched, so the function is meant to be called in a loop.
+ * @param Lines: the armed EXTI lines (bit mask of the configurable lines 0 .. 31)
+ * @param Sources: the armed peripheral event sources
+ * @param Count: the number of peripheral event sources
+ * @return The number of dispatched events
+ */
+uint32_t XPD_WaitForEvents(uint32_t Lines, const XPD_EventSourceType * Sources, uint8_t Count)
+{
+    uint32_t events;
+    uint32_t sevonpend = SCB->SCR.b.SEVONPEND;
+
+    SCB->SCR.b.SEVONPEND = 1;
+
+    /* an already pending interrupt line wouldn't signal a new event */
+    events = xpd_eventDispatch(Lines, Sources, Count);
+
+    if (events == 0)
+    {
+        __WFE();
+
+        events = xpd_eventDispatch(Lines, Sources, Count);
+    }
+
+    SCB->SCR.b.SEVONPEND = sevonpend;
+
+    return events;
+}
+
+/** @} */
+
+#ifdef USE_XPD_TRACE
+/** @defgroup XPD_Exported_Functions_Trace XPD Trace Functions
+ *  @brief    XPD Utilities non-blocking binary event trace
+ *  @details  Events are written to a RAM ring by any context (lock-free on Cortex-M3/M4,
+ *            with a few cycles of masked interrupts on Cortex-M0), and they are
+ *            drained to a trace output from the background by a single consumer:
+ *            @n - @ref XPD_Trace_ITMFlush outputs them on an ITM stimulus port (SWO)
+ *            @n - @ref XPD_USART_TraceFlush transmits them with the USART transmit queue DMA
+ * @{
+ */
+
+static struct {
+    XPD_TraceEventType * Buffer;    /* the ring storage */
+    uint32_t Mask;                  /* the ring size - 1 */
+    volatile uint32_t Head;         /* the number of reserved records (producers) */
+    volatile uint32_t Tail;         /* the number of released records (consumer) */
+    volatile uint32_t Dropped;      /* the number of events lost due to full ring */
+} xpd_trace = { .Buffer = NULL };
+
+/**
+ * @brief Sets up the trace ring storage and discards all previous events.
+ * @param Buffer: the event record storage
+ * @param Size: the number of records in the storage, must be a power of 2
+ */
+void XPD_Trace_Init(XPD_TraceEventType * Buffer, uint16_t Size)
+{
+    uint16_t i;
+
+    /* stop recording until the ring is set up */
+    xpd_trace.Buffer  = NULL;
+
+    for (i = 0; i < Size; i++)
+    {
+        Buffer[i].Id = 0;
+    }
+    xpd_trace.Head    = 0;
+    xpd_trace.Tail    = 0;
+    xpd_trace.Dropped = 0;
+    xpd_trace.Mask    = Size - 1;
+    xpd_trace.Buffer  = Buffer;
+}
+
+/**
+ * @brief Records an event with the current timestamp in the trace ring.
+ *        If the ring is full, the event is dropped and counted.
+ * @note  This function is reentrant and can be called from any interrupt context.
+ * @param Id: the event identifier, shall not be 0
+ * @param Value: the event parameter
+ */
+void XPD_Trace_Event(uint16_t Id, uint16_t Value)
+{
+    XPD_TraceEventType * event;
+    uint32_t head, timestamp;
+
+    if (xpd_trace.Buffer == NULL)
+    {
+        return;
+    }
+
+#if (__CORTEX_M >= 3)
+    /* reserve a record with exclusive access */
+    do {
+        head = __LDREXW((volatile uint32_t *)&xpd_trace.Head);
+
+        if ((head - xpd_trace.Tail) > xpd_trace.Mask)
+        {
+            __CLREX();
+            xpd_trace.Dropped++;
+            return;
+        }
+    } while (__STREXW(head + 1, (volatile uint32_t *)&xpd_trace.Head) != 0);
+
+    timestamp = DWT->CYCCNT;
+#else
+    uint32_t primask = __get_PRIMASK();
+
+    /* reserve a record with interrupts masked */
+    __disable_irq();
+
+    head = xpd_trace.Head;
+    if ((head - xpd_trace.Tail) > xpd_trace.Mask)
+    {
+        xpd_trace.Dropped++;
+        __set_PRIMASK(primask);
+        return;
+    }
+    xpd_trace.Head = head + 1;
+    timestamp = (uint32_t)XPD_GetTicks64();
+
+    __set_PRIMASK(primask);
+#endif
+
+    event = &xpd_trace.Buffer[head & xpd_trace.Mask];
+    event->Timestamp = timestamp;
+    event->Value     = Value;
+
+    /* the identifier publishes the complete record */
+    __DMB();
+    event->Id        = Id;
+}
+
+/**
+ * @brief Gets the oldest completed trace records which are stored contiguously.
+ * @note  The records remain valid until they are released by @ref XPD_Trace_Consume.
+ * @param Events: set to the first available record
+ * @return The number of available contiguous records
+ */
+uint16_t XPD_Trace_Peek(const XPD_TraceEventType ** Events)
+{
+    uint32_t tail = xpd_trace.Tail, head = xpd_trace.Head;
+    uint32_t index = tail & xpd_trace.Mask, count = 0;
+
+    /* stop at the first unfinished record or at the end of the storage */
+    while (((tail + count) != head) && ((index + count) <= xpd_trace.Mask)
+            && (xpd_trace.Buffer[index + count].Id != 0))
+    {
+        count++;
+    }
+    *Events = &xpd_trace.Buffer[index];
+
+    return count;
+}
+
+/**
+ * @brief Frees the oldest trace records after they have been output.
+ * @param Count: the number of records to release
+ */
+void XPD_Trace_Consume(uint16_t Count)
+{
+    uint32_t tail = xpd_trace.Tail;
+
+    while (Count-- > 0)
+    {
+        xpd_trace.Buffer[tail & xpd_trace.Mask].Id = 0;
+        tail++;
+    }
+    __DMB();
+    xpd_trace.Tail = tail;
+}
+
+/**
+ * @brief Returns the number of events lost because the trace ring was full.
+ * @return The dropped event count since @ref XPD_Trace_Init
+ */
+uint32_t XPD_Trace_GetDropped(void)
+{
+    return xpd_trace.Dropped;
+}
+
+#ifdef ITM_TCR_ITMENA_Msk
+/**
+ * @brief Outputs the trace records on an ITM stimulus port while the port is ready,
+ *        returns without waiting when the port FIFO is full.
+ * @note  Only a started record waits for the port FIFO, for at most one word time.
+ * @param Port: the ITM stimulus port number [0 .. 31]
+ */
+void XPD_Trace_ITMFlush(uint8_t Port)
+{
+    if ((ITM->TCR.b.ITMENA != 0) && ((ITM->TER & (1UL << Port)) != 0))
+    {
+        const XPD_TraceEventType * events;
+        uint16_t i, count = XPD_Trace_Peek(&events);
+
+        for (i = 0; (i < count) && (ITM->PORT[Port].u32 != 0); i++)
+        {
+            ITM->PORT[Port].u32 = events[i].Timestamp;
+
+            while (ITM->PORT[Port].u32 == 0);
+            ITM->PORT[Port].u32 = ((uint32_t)events[i].Value << 16) | events[i].Id;
+        }
+        XPD_Trace_Consume(i);
+    }
+}
+#endif
+
+/** @} */
+#endif
+
+#if defined(USE_XPD_STATISTICS) || defined(USE_XPD_PROFILING)
+/* the initial main stack pointer is the first entry of the vector table */
+static uint32_t * xpd_mainStackTop(void)
+{
+#ifdef SCB_VTOR_TBLOFF_Msk
+    return *(uint32_t * const *)SCB->VTOR.w;
+#else
+    /* the vector table is always accessed at address 0,
+     * the volatile pointer prevents the null dereference optimization */
+    uint32_t * const * volatile table = 0;
+
+    return *table;
+#endif
+}
+#endif
+
+#ifdef USE_XPD_STATISTICS
+/* the fill value of the unused stack words */
+#define XPD_STACK_PATTERN       0xDEADBEEFUL
+
+/** @defgroup XPD_Exported_Functions_Statistics XPD Statistics Functions
+ *  @brief    XPD Utilities peripheral handle runtime statistics
+ * @{
+ */
+
+/**
+ * @brief Increments the error counters of the set error flags.
+ * @param Stats: pointer to the handle statistics
+ * @param Errors: the newly detected error flags
+ */
+void XPD_Stats_CountErrors(XPD_StatsType * Stats, uint32_t Errors)
+{
+    uint32_t i;
+
+    for (i = 0; (Errors != 0) && (i < sizeof(Stats->Errors) / sizeof(Stats->Errors[0])); i++, Errors >>= 1)
+    {
+        if ((Errors & 1) != 0)
+        {
+            Stats->Errors[i]++;
+        }
+    }
+}
+
+/**
+ * @brief Clears all counters of the handle statistics.
+ * @param Stats: pointer to the handle statistics
+ */
+void XPD_Stats_Reset(XPD_StatsType * Stats)
+{
+    uint8_t * bytes = (uint8_t *)Stats;
+    uint32_t i;
+
+    XPD_ENTER_CRITICAL(Stats);
+
+    for (i = 0; i < sizeof(XPD_StatsType); i++)
+    {
+        bytes[i] = 0;
+    }
+
+    XPD_EXIT_CRITICAL(Stats);
+}
+
+/**
+ * @brief Fills the unused words of a stack with a known pattern, so its peak usage
+ *        can be measured later by @ref XPD_Stack_GetUsage. If the stack is in use by
+ *        the caller, only the area below the current stack pointer is filled.
+ * @note  The main stack is painted most accurately at the start of the application.
+ * @param Bottom: the lowest address of the stack region
+ * @param Top: the end address of the stack region (the initial stack pointer),
+ *        e.g. @ref XPD_Stack_GetMainTop for the main stack
+ */
+void XPD_Stack_Paint(uint32_t * Bottom, uint32_t * Top)
+{
+    uint32_t * sp;
+
+    /* the current stack pointer of the caller */
+    if ((__get_IPSR() == 0) && ((__get_CONTROL() & CONTROL_SPSEL_Msk) != 0))
+    {
+        sp = (uint32_t *)__get_PSP();
+    }
+    else
+    {
+        sp = (uint32_t *)__get_MSP();
+    }
+    if ((sp > Bottom) && (sp <= Top))
+    {
+        Top = sp;
+    }
+
+    while (Bottom < Top)
+    {
+        *Bottom++ = XPD_STACK_PATTERN;
+    }
+}
+
+/**
+ * @brief Determines the peak usage of a painted stack (see @ref XPD_Stack_Paint).
+ * @param Bottom: the lowest address of the stack region
+ * @param Top: the end address of the stack region
+ * @return The high-water mark of the stack in bytes
+ */
+uint32_t XPD_Stack_GetUsage(const uint32_t * Bottom, const uint32_t * Top)
+{
+    const uint32_t * word = Bottom;
+
+    while ((word < Top) && (*word == XPD_STACK_PATTERN))
+    {
+        word++;
+    }
+    return (uint32_t)Top - (uint32_t)word;
+}
+
+/**
+ * @brief Provides the end address of the main stack from the vector table.
+ * @return The initial main stack pointer
+ */
+uint32_t * XPD_Stack_GetMainTop(void)
+{
+    return xpd_mainStackTop();
+}
+
+/** @} */
+#endif
+
+#if defined(USE_XPD_PROFILING) || defined(USE_XPD_ENERGY_PROFILING)
+/* writes a zero terminated text */
+static void xpd_profileWrite(XPD_ProfileWriterType Write, const char * Text)
+{
+    uint16_t length = 0;
+
+    while (Text[length] != 0)
+    {
+        length++;
+    }
+    Write(Text, length);
+}
+
+/* writes an unsigned decimal number */
+static void xpd_profileWriteNumber(XPD_ProfileWriterType Write, uint32_t Value)
+{
+    char text[10];
+    uint16_t i = sizeof(text);
+
+    do {
+        text[--i] = '0' + (Value % 10);
+        Value /= 10;
+    } while (Value != 0);
+
+    Write(&text[i], sizeof(text) - i);
+}
+#endif
+
+#ifdef USE_XPD_PROFILING
+/** @defgroup XPD_Exported_Functions_Profiling XPD Profiling Functions
+ *  @brief    XPD Utilities IRQ handler and callback cycle profiling
+ * @{
+ */
+
+static XPD_ProfileType * xpd_profiles = NULL;
+
+/**
+ * @brief Adds a cycle measurement to the profile statistics.
+ *        The profile is added to the profile list on its first measurement.
+ * @param Profile: pointer to the profile statistics
+ * @param Cycles: the measured core clock cycles
+ */
+void XPD_Profile_Record(XPD_ProfileType * Profile, uint32_t Cycles)
+{
+    XPD_ENTER_CRITICAL(Profile);
+
+    if (Profile->Count == 0)
+    {
+        Profile->Next  = xpd_profiles;
+        xpd_profiles   = Profile;
+        Profile->Min   = Cycles;
+        Profile->Max   = Cycles;
+        Profile->Total = 0;
+        Profile->FPUCount = 0;
+        Profile->StackDepth = 0;
+    }
+    else if (Cycles < Profile->Min)
+    {
+        Profile->Min = Cycles;
+    }
+    else if (Cycles > Profile->Max)
+    {
+        Profile->Max = Cycles;
+    }
+    Profile->Count++;
+    Profile->Total += Cycles;
+
+    /* In handler mode the main stack holds all preempted contexts */
+    if (__get_IPSR() != 0)
+    {
+        uint32_t depth = (uint32_t)xpd_mainStackTop() - __get_MSP();
+
+        if (depth > Profile->StackDepth)
+        {
+            Profile->StackDepth = depth;
+        }
+    }
+
+#if (__FPU_PRESENT == 1)
+    /* The FP context of the handler is active since its first FP instruction,
+     * which triggers the FP context stacking of the interrupted context */
+    if ((__get_IPSR() != 0) && ((__get_CONTROL() & CONTROL_FPCA_Msk) != 0))
+    {
+        Profile->FPUCount++;
+    }
+#endif
+
+    XPD_EXIT_CRITICAL(Profile);
+}
+
+/**
+ * @brief Returns the list of the recorded profiles.
+ * @return Pointer to the most recently registered profile, the rest is linked by the Next field
+ */
+const XPD_ProfileType * XPD_Profile_GetList(void)
+{
+    return xpd_profiles;
+}
+
+/**
+ * @brief Clears all recorded profile statistics.
+ */
+void XPD_Profile_Reset(void)
+{
+    XPD_ProfileType * profile;
+
+    XPD_ENTER_CRITICAL(NULL);
+
+    for (profile = xpd_profiles; profile != NULL; profile = profile->Next)
+    {
+        profile->Count = 0;
+    }
+    xpd_profiles = NULL;
+
+    XPD_EXIT_CRITICAL(NULL);
+}
+
+/**
+ * @brief Outputs the recorded profile statistics as text, one line per profile:
+ *        "<function> [<callback>] count=<n> min=<cycles> avg=<cycles> max=<cycles> [fpu=<n>] [stack=<bytes>]"
+ * @note  The fpu field is only present for the handlers which used the FPU,
+ *        therefore caused FP context stacking (see @ref NVIC_FPUStackingType).
+ *        The stack field is the main stack depth of the handler, including all preempted contexts.
+ * @param Write: the text output function (e.g. CDC transmit or @ref XPD_Profile_ITMWrite)
+ */
+void XPD_Profile_Dump(XPD_ProfileWriterType Write)
+{
+    const XPD_ProfileType * profile;
+
+    for (profile = xpd_profiles; profile != NULL; profile = profile->Next)
+    {
+        uint32_t count = profile->Count;
+
+        xpd_profileWrite(Write, profile->Function);
+        if (profile->Name[0] != 0)
+        {
+            xpd_profileWrite(Write, " ");
+            xpd_profileWrite(Write, profile->Name);
+        }
+        xpd_profileWrite(Write, " count=");
+        xpd_profileWriteNumber(Write, count);
+        xpd_profileWrite(Write, " min=");
+        xpd_profileWriteNumber(Write, profile->Min);
+        xpd_profileWrite(Write, " avg=");
+        xpd_profileWriteNumber(Write, (uint32_t)(profile->Total / count));
+        xpd_profileWrite(Write, " max=");
+        xpd_profileWriteNumber(Write, profile->Max);
+        if (profile->FPUCount != 0)
+        {
+            xpd_profileWrite(Write, " fpu=");
+            xpd_profileWriteNumber(Write, profile->FPUCount);
+        }
+        if (profile->StackDepth != 0)
+        {
+            xpd_profileWrite(Write, " stack=");
+            xpd_profileWriteNumber(Write, profile->StackDepth);
+        }
+        xpd_profileWrite(Write, "\r\n");
+    }
+}
+
+/* returns the maximal recorded cycle count of the function body */
+static uint32_t xpd_profileMax(const char * Function)
+{
+    const XPD_ProfileType * profile;
+
+    for (profile = xpd_profiles; profile != NULL; profile = profile->Next)
+    {
+        const char * a = profile->Function;
+        const char * b = Function;
+
+        while ((*a == *b) && (*a != 0))
+        {
+            a++;
+            b++;
+        }
+        if ((*a == *b) && (profile->Name[0] == 0))
+        {
+            return profile->Max;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Outputs the worst-case latency estimate of each interrupt line in the priority table,
+ *        based on the measured handler durations. A line can be delayed by all handlers
+ *        with higher preemption priority, and by the longest other handler of the same priority:
+ *        "IRQ<n> prio=<preemption> <handler> max=<cycles> latency=<cycles> [OVER BUDGET]"
+ * @param Table: pointer to the priority table
+ * @param Count: number of entries in the table
+ * @param Write: the text output function (e.g. CDC transmit or @ref XPD_Profile_ITMWrite)
+ */
+void XPD_Profile_LatencyDump(const NVIC_PriorityConfigType * Table, uint8_t Count,
+        XPD_ProfileWriterType Write)
+{
+    uint8_t i, j;
+
+    for (i = 0; i < Count; i++)
+    {
+        uint32_t prio = XPD_NVIC_GetPreemptPriority(Table[i].IRQn);
+        uint32_t preempting = 0, blocking = 0, latency;
+
+        for (j = 0; j < Count; j++)
+        {
+            uint32_t other = XPD_NVIC_GetPreemptPriority(Table[j].IRQn);
+            uint32_t max = (Table[j].Handler != NULL) ? xpd_profileMax(Table[j].Handler) : 0;
+
+            if (other < prio)
+            {
+                preempting += max;
+            }
+            else if ((other == prio) && (j != i) && (max > blocking))
+            {
+                blocking = max;
+            }
+        }
+        latency = preempting + blocking;
+
+        xpd_profileWrite(Write, "IRQ");
+        if ((int32_t)Table[i].IRQn < 0)
+        {
+            xpd_profileWrite(Write, "-");
+            xpd_profileWriteNumber(Write, -(int32_t)Table[i].IRQn);
+        }
+        else
+        {
+            xpd_profileWriteNumber(Write, Table[i].IRQn);
+        }
+        xpd_profileWrite(Write, " prio=");
+        xpd_profileWriteNumber(Write, prio);
+        if (Table[i].Handler != NULL)
+        {
+            xpd_profileWrite(Write, " ");
+            xpd_profileWrite(Write, Table[i].Handler);
+            xpd_profileWrite(Write, " max=");
+            xpd_profileWriteNumber(Write, xpd_profileMax(Table[i].Handler));
+        }
+        xpd_profileWrite(Write, " latency=");
+        xpd_profileWriteNumber(Write, latency);
+        if ((Table[i].Budget != 0) && (latency > Table[i].Budget))
+        {
+            xpd_profileWrite(Write, " OVER BUDGET");
+        }
+        xpd_profileWrite(Write, "\r\n");
+    }
+}
+
+#ifdef ITM_TCR_ITMENA_Msk
+/**
+ * @brief Profile dump output function using the ITM stimulus port 0 (SWO).
+ * @param Text: the text to output
+ * @param Length: the length of the text
+ */
+void XPD_Profile_ITMWrite(const char * Text, uint16_t Length)
+{
+    while (Length-- > 0)
+    {
+        (void) ITM_SendChar(*Text++);
+    }
+}
+#endif
+
+/** @} */
+#endif
+
+#ifdef USE_XPD_ENERGY_PROFILING
+/** @defgroup XPD_Exported_Functions_Energy XPD Energy Profiling Functions
+ *  @brief    XPD Utilities power state markers and residency accounting
+ *  @details  The power state transitions of @ref XPD_PWR_SleepMode, @ref XPD_PWR_StopMode
+ *            and @ref XPD_RCC_OperatingPointConfig drive the marker pins, so the current
+ *            measurement can be correlated with the code, and the time spent in each state
+ *            is accumulated with a timebase that keeps running in Stop mode.
+ * @{
+ */
+
+static struct {
+    const XPD_EnergyInitType * Config;
+    XPD_EnergyStateType State;
+    uint32_t Since;
+    XPD_EnergyStatsType Stats;
+} xpd_energy;
+
+static const char * const xpd_energyNames[XPD_ENERGY_STATES] = {
+    "run", "sleep", "stop", "clock"
+};
+
+/* accounts the time spent in the current state until now */
+static void xpd_energyUpdate(void)
+{
+    const XPD_EnergyInitType * config = xpd_energy.Config;
+    uint32_t now = config->GetTime();
+    uint32_t elapsed = now - xpd_energy.Since;
+
+    /* the timebase wraps around at its period */
+    if ((config->Period != 0) && (now < xpd_energy.Since))
+    {
+        elapsed += config->Period;
+    }
+    xpd_energy.Stats.Time[xpd_energy.State] += elapsed;
+    xpd_energy.Since = now;
+}
+
+/* drives the marker pin of the state */
+static void xpd_energyMarker(XPD_EnergyStateType State, uint8_t Value)
+{
+    if (xpd_energy.Config->Markers[State].Port != NULL)
+    {
+        XPD_GPIO_WritePin(xpd_energy.Config->Markers[State].Port,
+                xpd_energy.Config->Markers[State].Pin, Value);
+    }
+}
+
+/**
+ * @brief Starts the energy profiling in the Run state.
+ * @note  The marker pins have to be configured as outputs beforehand,
+ *        and the configuration has to remain valid while the profiling is used.
+ * @param Config: pointer to the energy profiling setup
+ */
+void XPD_Energy_Init(const XPD_EnergyInitType * Config)
+{
+    uint32_t i;
+
+    xpd_energy.Config = Config;
+    xpd_energy.State  = XPD_ENERGY_RUN;
+
+    for (i = 0; i < XPD_ENERGY_STATES; i++)
+    {
+        xpd_energyMarker(i, i == XPD_ENERGY_RUN);
+    }
+
+    XPD_Energy_Reset();
+}
+
+/**
+ * @brief Records a power state transition: swaps the marker pins
+ *        and accounts the time spent in the previous state.
+ * @note  The wakeup interrupt handlers run before the Run state is restored,
+ *        unless the low power mode is entered with interrupts masked (PRIMASK).
+ * @param State: the new power state
+ */
+void XPD_Energy_SetState(XPD_EnergyStateType State)
+{
+    uint32_t primask;
+
+    if ((xpd_energy.Config == NULL) || (State == xpd_energy.State))
+    {
+        return;
+    }
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+
+    xpd_energyUpdate();
+
+    xpd_energyMarker(xpd_energy.State, 0);
+    xpd_energyMarker(State, 1);
+
+    xpd_energy.State = State;
+    xpd_energy.Stats.Entries[State]++;
+
+    __set_PRIMASK(primask);
+}
+
+/**
+ * @brief Provides the power state residency, including the ongoing state until now.
+ * @param Stats: pointer to the output residency structure
+ */
+void XPD_Energy_GetStats(XPD_EnergyStatsType * Stats)
+{
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+
+    if (xpd_energy.Config != NULL)
+    {
+        xpd_energyUpdate();
+    }
+    *Stats = xpd_energy.Stats;
+
+    __set_PRIMASK(primask);
+}
+
+/**
+ * @brief Clears the power state residency.
+ */
+void XPD_Energy_Reset(void)
+{
+    uint32_t primask = __get_PRIMASK();
+    uint32_t i;
+    __disable_irq();
+
+    for (i = 0; i < XPD_ENERGY_STATES; i++)
+    {
+        xpd_energy.Stats.Time[i]    = 0;
+        xpd_energy.Stats.Entries[i] = 0;
+    }
+    if (xpd_energy.Config != NULL)
+    {
+        xpd_energy.Since = xpd_energy.Config->GetTime();
+    }
+
+    __set_PRIMASK(primask);
+}
+
+/**
+ * @brief Writes the power state residency table as text lines,
+ *        e.g. to a CDC virtual COM port or @ref XPD_Profile_ITMWrite.
+ * @param Write: the text output function
+ */
+void XPD_Energy_Dump(XPD_ProfileWriterType Write)
+{
+    XPD_EnergyStatsType stats;
+    uint64_t total = 0;
+    uint32_t i;
+
+    XPD_Energy_GetStats(&stats);
+
+    for (i = 0; i < XPD_ENERGY_STATES; i++)
+    {
+        total += stats.Time[i];
+    }
+
+    for (i = 0; i < XPD_ENERGY_STATES; i++)
+    {
+        xpd_profileWrite(Write, xpd_energyNames[i]);
+        xpd_profileWrite(Write, " time=");
+        xpd_profileWriteNumber(Write, (uint32_t)stats.Time[i]);
+        xpd_profileWrite(Write, " entries=");
+        xpd_profileWriteNumber(Write, stats.Entries[i]);
+        xpd_profileWrite(Write, " permille=");
+        xpd_profileWriteNumber(Write, (total != 0) ? (uint32_t)((stats.Time[i] * 1000) / total) : 0);
+        xpd_profileWrite(Write, "\r\n");
+    }
+}
+
+/** @} */
+#endif
+
+#ifdef USE_XPD_STATISTICS
+/* updates the allocated block count and its high-water mark */
+static void xpd_poolCount(XPD_PoolType * Pool, int32_t Change)
+{
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+
+    Pool->Used += Change;
+    if (Pool->Used > Pool->HighWater)
+    {
+        Pool->HighWater = Pool->Used;
+    }
+
+    __set_PRIMASK(primask);
+}
+#endif
+
+/** @defgroup XPD_Exported_Functions_Pool XPD Block Pool Functions
+ *  @brief    XPD Utilities fixed-size block pool functions
+ * @{
+ */
+
+/**
+ * @brief Initializes a block pool by linking all blocks of the storage in the free list.
+ * @param Pool: pointer to the block pool structure
+ * @param Storage: the word aligned storage of the blocks, see @ref XPD_POOL_STORAGE
+ * @param BlockSize: the size of one block in bytes, rounded up to whole words
+ * @param Count: the number of blocks in the storage
+ * @return ERROR if the parameters are invalid, OK if success
+ */
+XPD_ReturnType XPD_Pool_Init(XPD_PoolType * Pool, void * Storage, uint16_t BlockSize, uint16_t Count)
+{
+    XPD_ReturnType result = XPD_ERROR;
+
+    BlockSize = (BlockSize + 3) & ~3;
+
+    if ((Count > 0) && (BlockSize > 0) && (((uint32_t)Storage & 3) == 0))
+    {
+        uint8_t * block = Storage;
+        uint32_t i;
+
+        Pool->BlockSize = BlockSize;
+        Pool->Start     = block;
+        Pool->End       = block + (uint32_t)BlockSize * Count;
+
+        /* each free block stores the address of the next one */
+        for (i = 1; i < Count; i++, block += BlockSize)
+        {
+            *(void**)block = block + BlockSize;
+        }
+        *(void**)block = NULL;
+
+        Pool->Free = Storage;
+#ifdef USE_XPD_STATISTICS
+        Pool->Used      = 0;
+        Pool->HighWater = 0;
+#endif
+        result = XPD_OK;
+    }
+    return result;
+}
+
+/**
+ * @brief Takes a block from the pool in constant time.
+ * @note  Safe to call from any context: the free list is updated with exclusive access
+ *        on Cortex-M3/M4 (which is lost on any exception), and with interrupts masked on Cortex-M0.
+ * @param Pool: pointer to the block pool structure
+ * @return The address of the block, or NULL if the pool is empty
+ */
+void * XPD_Pool_Alloc(XPD_PoolType * Pool)
+{
+    void * block;
+
+#if (__CORTEX_M >= 3)
+    do
+    {
+        block = (void*)__LDREXW((volatile uint32_t *)&Pool->Free);
+
+        if (block == NULL)
+        {
+            __CLREX();
+            break;
+        }
+    }
+    while (__STREXW((uint32_t)*(void**)block, (volatile uint32_t *)&Pool->Free) != 0);
+#else
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+
+    block = Pool->Free;
+    if (block != NULL)
+    {
+        Pool->Free = *(void**)block;
+    }
+
+    __set_PRIMASK(primask);
+#endif
+
+#ifdef USE_XPD_STATISTICS
+    if (block != NULL)
+    {
+        xpd_poolCount(Pool, 1);
+    }
+#endif
+    return block;
+}
+
+/**
+ * @brief Returns a block to the pool in constant time.
+ * @note  Safe to call from any context.
+ * @param Pool: pointer to the block pool structure
+ * @param Block: the address of the block, which was taken from the same pool
+ */
+void XPD_Pool_Free(XPD_PoolType * Pool, void * Block)
+{
+#if (__CORTEX_M >= 3)
+    do
+    {
+        *(void**)Block = (void*)__LDREXW((volatile uint32_t *)&Pool->Free);
+    }
+    while (__STREXW((uint32_t)Block, (volatile uint32_t *)&Pool->Free) != 0);
+#else
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+
+    *(void**)Block = Pool->Free;
+    Pool->Free = Block;
+
+    __set_PRIMASK(primask);
+#endif
+
+#ifdef USE_XPD_STATISTICS
+    xpd_poolCount(Pool, -1);
+#endif
+}
+
+/**
+ * @brief Takes a block from the smallest size class which fits the requested size
+ *        and isn't empty.
+ * @param Pools: the array of block pools in increasing block size order
+ * @param PoolCount: the number of block pools in the array
+ * @param Size: the requested size in bytes
+ * @return The address of the block, or NULL if no fitting block is available
+ */
+void * XPD_Pool_AllocSize(XPD_PoolType * Pools, uint8_t PoolCount, uint32_t Size)
+{
+    void * block = NULL;
+    uint32_t i;
+
+    for (i = 0; (i < PoolCount) && (block == NULL); i++)
+    {
+        if (Pools[i].BlockSize >= Size)
+        {
+            block = XPD_Pool_Alloc(&Pools[i]);
+        }
+    }
+    return block;
+}
+
+/**
+ * @brief Returns a block to the size class which it was taken from.
+ * @param Pools: the array of block pools
+ * @param PoolCount: the number of block pools in the array
+ * @param Block: the address of the block, NULL is ignored
+ */
+void XPD_Pool_FreeAny(XPD_PoolType * Pools, uint8_t PoolCount, void * Block)
+{
+    uint32_t i;
+
+    for (i = 0; i < PoolCount; i++)
+    {
+        if (((uint8_t*)Block >= Pools[i].Start) && ((uint8_t*)Block < Pools[i].End))
+        {
+            XPD_Pool_Free(&Pools[i], Block);
+            break;
+        }
+    }
+}
+
+/** @} */
+
+/** @defgroup XPD_Exported_Functions_Defer XPD Deferred Work Functions
+ *  @brief    XPD Utilities deferred execution of interrupt work at the lowest priority
+ *  @details  Interrupt handlers (and driver callbacks) post work items to a lock-free
+ *            message queue, which are executed in order by the PendSV exception
+ *            at the lowest interrupt priority. This keeps the high priority handlers short.
+ *            The PendSV handler of the application has to call @ref XPD_Defer_IRQHandler,
+ *            therefore these functions can't be used with an RTOS which uses PendSV itself.
+ * @{
+ */
+
+static XPD_QueueType xpd_defer = { .Buffer = NULL };
+
+/**
+ * @brief Sets up the work item storage and sets the PendSV exception to the lowest priority.
+ * @param Buffer: the work item storage of Count elements
+ * @param Sequence: the publication sequence storage of Count elements
+ * @param Count: the number of work items, a power of two [2 .. 32768]
+ * @return ERROR if the item count isn't a power of two, OK if success
+ */
+XPD_ReturnType XPD_Defer_Init(XPD_WorkType * Buffer, uint16_t * Sequence, uint16_t Count)
+{
+    XPD_ReturnType result = XPD_Queue_Init(&xpd_defer, Buffer, Sequence, sizeof(XPD_WorkType), Count);
+
+    if (result == XPD_OK)
+    {
+        NVIC_SetPriority(PendSV_IRQn, (1UL << __NVIC_PRIO_BITS) - 1);
+    }
+    return result;
+}
+
+/**
+ * @brief Posts a work item to be executed in the PendSV context.
+ * @note  This function is reentrant and can be called from any interrupt context.
+ * @param Function: the function to execute
+ * @param Argument: the argument of the function
+ * @return ERROR if the work queue isn't set up, BUSY if it is full, OK if success
+ */
+XPD_ReturnType XPD_Defer(XPD_HandleCallbackType Function, void * Argument)
+{
+    XPD_WorkType work = { .Function = Function, .Argument = Argument };
+    XPD_ReturnType result = XPD_ERROR;
+
+    if (xpd_defer.Buffer != NULL)
+    {
+        result = XPD_Queue_Put(&xpd_defer, &work);
+    }
+    if (result == XPD_OK)
+    {
+        /* an item published by a preempted producer is executed at its own request */
+        SCB->ICSR.w = SCB_ICSR_PENDSVSET_Msk;
+    }
+    return result;
+}
+
+/**
+ * @brief Executes the posted work items in order, to be called from PendSV_Handler.
+ */
+void XPD_Defer_IRQHandler(void)
+{
+    XPD_WorkType work;
+
+    while (XPD_Queue_Get(&xpd_defer, &work) == XPD_OK)
+    {
+        work.Function(work.Argument);
+    }
+}
+
+/** @} */
+
+/** @defgroup XPD_Exported_Functions_Framing XPD Frame Codec Functions
+ *  @brief    XPD Utilities COBS and SLIP framing of byte streams
+ *  @details  The decoder processes the contiguous spans of a receive buffer in place,
+ *            e.g. the ones provided by @ref XPD_USART_RxRing_Peek, and calls back with each
+ *            complete frame. The delimiters and escapes are searched a word at a time,
+ *            so the frame contents are copied in runs instead of byte by byte.
+ *            The encoded frames can be transmitted by e.g. @ref XPD_USART_TxQueue_Put.
+ * @{
+ */
+
+#define XPD_SLIP_END            0xC0
+#define XPD_SLIP_ESC            0xDB
+#define XPD_SLIP_ESC_END        0xDC
+#define XPD_SLIP_ESC_ESC        0xDD
+
+/* The COBS block code of the longest block, which isn't followed by a zero */
+#define XPD_COBS_MAX_CODE       0xFF
+
+/* Finds the first occurrence of either byte value, or returns the length */
+static uint16_t xpd_frameSearch(const uint8_t * Data, uint16_t Length, uint8_t Value1, uint8_t Value2)
+{
+    uint16_t i = 0;
+
+#if (__CORTEX_M >= 3)
+    uint32_t pattern1 = Value1 * 0x01010101UL;
+    uint32_t pattern2 = Value2 * 0x01010101UL;
+
+    for (; (i < Length) && (((uint32_t)&Data[i] & 3) != 0); i++)
+    {
+        if ((Data[i] == Value1) || (Data[i] == Value2))
+        {
+            return i;
+        }
+    }
+    for (; (i + 4) <= Length; i += 4)
+    {
+        uint32_t word = *(const uint32_t*)&Data[i];
+        uint32_t x1 = word ^ pattern1, x2 = word ^ pattern2;
+
+        /* The bytes above a matching one may be marked as well,
+         * but the lowest marked byte is exactly the first match */
+        uint32_t mask = (((x1 - 0x01010101UL) & ~x1) | ((x2 - 0x01010101UL) & ~x2)) & 0x80808080UL;
+
+        if (mask != 0)
+        {
+            return i + (__CLZ(__RBIT(mask)) >> 3);
+        }
+    }
+#endif
+    for (; i < Length; i++)
+    {
+        if ((Data[i] == Value1) || (Data[i] == Value2))
+        {
+            break;
+        }
+    }
+    return i;
+}
+
+/* Copies the decoded data to the frame buffer, or drops the frame if it doesn't fit */
+static void xpd_frameAppend(XPD_FrameDecoderType * Decoder, const uint8_t * Data, uint16_t Length)
+{
+    if (Decoder->Drop == 0)
+    {
+        if ((Decoder->Size - Decoder->Length) < Length)
+        {
+            Decoder->Drop = 1;
+            Decoder->Errors++;
+        }
+        else
+        {
+            uint8_t * dest = &Decoder->Buffer[Decoder->Length];
+
+            Decoder->Length += Length;
+            for (; Length > 0; Length--)
+            {
+                *(dest++) = *(Data++);
+            }
+        }
+    }
+}
+
+/* Ends the current frame, and provides it to the user if it's valid */
+static uint16_t xpd_frameEnd(XPD_FrameDecoderType * Decoder, uint8_t Valid)
+{
+    uint16_t frames = 0;
+
+    if ((Valid != 0) && (Decoder->Drop == 0))
+    {
+        XPD_SAFE_CALLBACK(Decoder->Callback, Decoder);
+        frames = 1;
+    }
+    Decoder->Length = 0;
+    Decoder->State  = 0;
+    Decoder->Block  = 0;
+    Decoder->Drop   = 0;
+
+    return frames;
+}
+
+static uint16_t xpd_cobsDecode(XPD_FrameDecoderType * Decoder, const uint8_t * Data, uint16_t Length)
+{
+    uint16_t frames = 0;
+
+    while (Length > 0)
+    {
+        if (Decoder->State == 0)
+        {
+            uint8_t code = *(Data++);
+            Length--;
+
+            if (code == 0)
+            {
+                /* Consecutive delimiters carry no frame */
+                frames += xpd_frameEnd(Decoder, Decoder->Block != 0);
+            }
+            else
+            {
+                /* The blocks shorter than the maximum are followed by a zero */
+                if ((Decoder->Block != 0) && (Decoder->Block != XPD_COBS_MAX_CODE))
+                {
+                    uint8_t zero = 0;
+                    xpd_frameAppend(Decoder, &zero, 1);
+                }
+                Decoder->Block = code;
+                Decoder->State = code - 1;
+            }
+        }
+        else
+        {
+            uint16_t run = (Length < Decoder->State) ? Length : Decoder->State;
+            uint16_t delimiter = xpd_frameSearch(Data, run, 0, 0);
+
+            xpd_frameAppend(Decoder, Data, delimiter);
+
+            if (delimiter < run)
+            {
+                /* The frame is truncated by a delimiter inside a block */
+                if (Decoder->Drop == 0)
+                {
+                    Decoder->Errors++;
+                }
+                (void) xpd_frameEnd(Decoder, 0);
+                run = delimiter + 1;
+            }
+            else
+            {
+                Decoder->State -= run;
+            }
+            Data   += run;
+            Length -= run;
+        }
+    }
+    return frames;
+}
+
+static uint16_t xpd_slipDecode(XPD_FrameDecoderType * Decoder, const uint8_t * Data, uint16_t Length)
+{
+    uint16_t frames = 0;
+
+    while (Length > 0)
+    {
+        if (Decoder->State != 0)
+        {
+            uint8_t data = *Data;
+
+            Decoder->State = 0;
+            if ((data == XPD_SLIP_ESC_END) || (data == XPD_SLIP_ESC_ESC))
+            {
+                data = (data == XPD_SLIP_ESC_END) ? XPD_SLIP_END : XPD_SLIP_ESC;
+                xpd_frameAppend(Decoder, &data, 1);
+                Data++;
+                Length--;
+            }
+            else if (Decoder->Drop == 0)
+            {
+                /* Invalid escape, the byte is processed normally */
+                Decoder->Drop = 1;
+                Decoder->Errors++;
+            }
+        }
+        else
+        {
+            uint16_t run = xpd_frameSearch(Data, Length, XPD_SLIP_END, XPD_SLIP_ESC);
+
+            xpd_frameAppend(Decoder, Data, run);
+            Data   += run;
+            Length -= run;
+
+            if (Length > 0)
+            {
+                if (*Data == XPD_SLIP_ESC)
+                {
+                    Decoder->State = 1;
+                }
+                else
+                {
+                    /* Empty frames are only line noise separators */
+                    frames += xpd_frameEnd(Decoder, Decoder->Length != 0);
+                }
+                Data++;
+                Length--;
+            }
+        }
+    }
+    return frames;
+}
+
 /**
- * @brief Millisecond timer initializer utility. [overrideable]
+ * @brief Resets the decoder to wait for the start of a frame.
+ * @param Decoder: pointer to the frame decoder, with the framing type, buffer and callback set
  */
-__weak void XPD_InitTimer(void)
+void XPD_Frame_DecoderInit(XPD_FrameDecoderType * Decoder)
 {
-    /* Enable SysTick and configure 1ms tick */
-    XPD_SysTick_Init(SystemCoreClock / 1000, SYSTICK_CLOCKSOURCE_HCLK);
-    XPD_SysTick_Enable();
+    (void) xpd_frameEnd(Decoder, 0);
+
+    Decoder->Errors = 0;
 }
 
 /**
- * @brief Inserts code delay of the specified time in milliseconds.
- * @note  The milliseconds based waiting utilities shall not be used concurrently.
- *        The time of the preempted waiters do not elapse.
- * @param milliseconds: the desired delay in ms
+ * @brief Decodes a span of the received byte stream.
+ *        The Callback of the decoder is called with each completed frame,
+ *        the incomplete frame is continued by the next span.
+ * @param Decoder: pointer to the frame decoder
+ * @param Data: pointer to the received bytes
+ * @param Length: the number of received bytes
+ * @return The number of completed frames
  */
-__weak void XPD_Delay_ms(uint32_t milliseconds)
+uint16_t XPD_Frame_Decode(XPD_FrameDecoderType * Decoder, const uint8_t * Data, uint16_t Length)
 {
-    /* Initially clear flag */
-    __IO uint32_t dummy = SysTick->CTRL.b.COUNTFLAG;
-    while (milliseconds != 0)
+    if (Decoder->Type == XPD_FRAMING_COBS)
     {
-        /* COUNTFLAG returns 1 if timer counted to 0 since the last flag read */
-        milliseconds -= SysTick->CTRL.b.COUNTFLAG;
+        return xpd_cobsDecode(Decoder, Data, Length);
+    }
+    else
+    {
+        return xpd_slipDecode(Decoder, Data, Length);
     }
 }
 
 /**
- * @brief Inserts code delay of the specified time in microseconds.
- * @param microseconds: the desired delay in us
+ * @brief Encodes a frame including its delimiters.
+ * @param Type: the framing method
+ * @param Data: pointer to the frame
+ * @param Length: the frame length in bytes
+ * @param Output: the destination of the encoded frame, at least @ref XPD_FRAME_ENCODED_SIZE bytes
+ * @return The encoded length in bytes
  */
-__weak void XPD_Delay_us(uint32_t microseconds)
+uint16_t XPD_Frame_Encode(XPD_FramingType Type, const uint8_t * Data, uint16_t Length, uint8_t * Output)
 {
-    microseconds *= SystemCoreClock / 1000000;
-    while (microseconds != 0)
+    uint8_t * out = Output;
+
+    if (Type == XPD_FRAMING_COBS)
+    {
+        for (;;)
+        {
+            uint16_t run = xpd_frameSearch(Data,
+                    (Length < (XPD_COBS_MAX_CODE - 1)) ? Length : (XPD_COBS_MAX_CODE - 1), 0, 0);
+            uint16_t i;
+
+            *(out++) = run + 1;
+            for (i = 0; i < run; i++)
+            {
+                *(out++) = Data[i];
+            }
+
+            if (run == Length)
+            {
+                break;
+            }
+            /* The zero is implied by the block code, except for the maximal block */
+            else if (run < (XPD_COBS_MAX_CODE - 1))
+            {
+                run++;
+            }
+            Data   += run;
+            Length -= run;
+        }
+        *(out++) = 0;
+    }
+    else
     {
-        microseconds--;
+        /* The leading delimiter flushes the line noise at the receiver */
+        *(out++) = XPD_SLIP_END;
+
+        while (Length > 0)
+        {
+            uint16_t run = xpd_frameSearch(Data, Length, XPD_SLIP_END, XPD_SLIP_ESC);
+            uint16_t i;
+
+            for (i = 0; i < run; i++)
+            {
+                *(out++) = Data[i];
+            }
+            Data   += run;
+            Length -= run;
+
+            if (Length > 0)
+            {
+                *(out++) = XPD_SLIP_ESC;
+                *(out++) = (*(Data++) == XPD_SLIP_END) ? XPD_SLIP_ESC_END : XPD_SLIP_ESC_ESC;
+                Length--;
+            }
+        }
+        *(out++) = XPD_SLIP_END;
     }
+    return out - Output;
 }
 
-/**
- * @brief Waits until the masked value read from address matches the input match, or until times out. [overrideable]
- * @note  The milliseconds based waiting utilities shall not be used concurrently.
- *        The time of the preempted waiters do not elapse.
- * @param varAddress: the word address that needs to be monitored
- * @param bitSelector: a bit mask that selects which bits should be considered
- * @param match: the expected value to wait for
- * @param mstimeout: pointer to the timeout in ms
- * @return TIMEOUT if timed out, or OK if match occurred within the deadline
+/** @} */
+
+/** @defgroup XPD_Exported_Functions_Format XPD Formatted Output Functions
+ *  @brief    XPD Utilities heap-free formatted text output
+ *  @details  A small printf subset, which writes the text directly into the output memory:
+ *            @arg %d, %i, %u: decimal integers
+ *            @arg %x, %X: hexadecimal integers
+ *            @arg %.Nq: decimal fixed-point integer with N fractional digits [1..9],
+ *                 e.g. 1234 is printed as 12.34 with %.2q
+ *            @arg %s, %c, %%: strings, characters and the percent sign
+ *            The field width and the '-' and '0' flags are supported, the 'l' and 'h'
+ *            length modifiers are ignored, as the integer arguments are 32-bit.
+ * @{
  */
-__weak XPD_ReturnType XPD_WaitForMatch(
-        volatile uint32_t * varAddress, uint32_t bitSelector, uint32_t match,
-        uint32_t * mstimeout)
+
+typedef struct {
+    char *   Buffer;
+    uint16_t Mask;
+    uint16_t Start;
+    uint16_t Space;
+    uint32_t Length;
+} XPD_FormatOutputType;
+
+/* appends a character to the output, counts it even if there is no space left */
+static void xpd_formatPut(XPD_FormatOutputType * Output, char C)
 {
-    /* Initially clear flag */
-    __IO uint32_t dummy = SysTick->CTRL.b.COUNTFLAG;
-    XPD_ReturnType result = XPD_OK;
+    if (Output->Length < Output->Space)
+    {
+        Output->Buffer[(Output->Start + Output->Length) & Output->Mask] = C;
+    }
+    Output->Length++;
+}
+
+/* appends the padding of a field */
+static void xpd_formatPad(XPD_FormatOutputType * Output, char C, int32_t Count)
+{
+    for (; Count > 0; Count--)
+    {
+        xpd_formatPut(Output, C);
+    }
+}
+
+/* appends a number with the fixed-point fraction digits */
+static void xpd_formatNumber(XPD_FormatOutputType * Output, uint32_t Value, uint8_t Negative,
+        uint32_t Base, char Letter, uint8_t Width, uint8_t Fraction, char Pad, uint8_t Left)
+{
+    char digits[11];
+    uint32_t count = 0;
+    int32_t padding;
+
+    /* the integer part has at least one digit */
+    do {
+        uint32_t digit = Value % Base;
+
+        digits[count++] = (digit < 10) ? ('0' + digit) : (Letter + digit - 10);
+        Value /= Base;
+    } while ((Value != 0) || (count <= Fraction));
+
+    padding = (int32_t)Width - (int32_t)(count + Negative + (Fraction != 0));
 
-    while ((*varAddress & bitSelector) != match)
+    if ((Left == 0) && (Pad == ' '))
     {
-        if (*mstimeout == 0)
+        xpd_formatPad(Output, ' ', padding);
+    }
+    if (Negative != 0)
+    {
+        xpd_formatPut(Output, '-');
+    }
+    if ((Left == 0) && (Pad == '0'))
+    {
+        xpd_formatPad(Output, '0', padding);
+    }
+    while (count > 0)
+    {
+        if (count == Fraction)
         {
-            result = XPD_TIMEOUT;
-            break;
+            xpd_formatPut(Output, '.');
         }
-        /* COUNTFLAG returns 1 if timer counted to 0 since the last flag read */
-        *mstimeout -= SysTick->CTRL.b.COUNTFLAG;
+        xpd_formatPut(Output, digits[--count]);
+    }
+    if (Left != 0)
+    {
+        xpd_formatPad(Output, ' ', padding);
     }
-    return result;
 }
 
 /**
- * @brief Waits until the masked value read from address differs from the input match, or until times out. [overrideable]
- * @note  The milliseconds based waiting utilities shall not be used concurrently.
- *        The time of the preempted waiters do not elapse.
- * @param varAddress: the word address that needs to be monitored
- * @param bitSelector: a bit mask that selects which bits should be considered
- * @param match: the initial value that needs to differ
- * @param mstimeout: pointer to the timeout in ms
- * @return TIMEOUT if timed out, or OK if match occurred within the deadline
+ * @brief Formats text into a memory buffer.
+ * @note  The output isn't zero terminated.
+ * @param Buffer: the output buffer
+ * @param Size: the size of the output buffer
+ * @param Format: the format string
+ * @return The length of the formatted text, or 0 if it doesn't fit into the buffer
  */
-__weak XPD_ReturnType XPD_WaitForDiff(
-        volatile uint32_t * varAddress, uint32_t bitSelector, uint32_t match,
-        uint32_t * mstimeout)
+uint16_t XPD_Format(char * Buffer, uint16_t Size, const char * Format, ...)
 {
-    /* Initially clear flag */
-    __IO uint32_t dummy = SysTick->CTRL.b.COUNTFLAG;
-    XPD_ReturnType result = XPD_OK;
+    uint16_t length;
+    va_list args;
+
+    va_start(args, Format);
+    length = XPD_VFormat(Buffer, 0xFFFF, 0, Size, Format, args);
+    va_end(args);
+
+    return length;
+}
+
+/**
+ * @brief Formats text into a ring buffer in place, without any intermediate buffer.
+ *        The function is reentrant, it only uses the stack and the output memory.
+ * @param Buffer: the ring buffer, its size has to be a power of 2
+ * @param Mask: the size of the ring buffer - 1
+ * @param Start: the ring index of the first output character
+ * @param Space: the available space starting from the first output character
+ * @param Format: the format string
+ * @param Args: the arguments of the format string
+ * @return The length of the formatted text, or 0 if it doesn't fit into the available space
+ */
+uint16_t XPD_VFormat(char * Buffer, uint16_t Mask, uint16_t Start, uint16_t Space,
+        const char * Format, va_list Args)
+{
+    XPD_FormatOutputType output = {
+        .Buffer = Buffer, .Mask = Mask, .Start = Start, .Space = Space, .Length = 0 };
+    char c;
 
-    while ((*varAddress & bitSelector) == match)
+    while ((c = *(Format++)) != 0)
     {
-        if (*mstimeout == 0)
+        uint8_t left = 0, width = 0, fraction = 0;
+        char pad = ' ';
+
+        if (c != '%')
         {
-            result = XPD_TIMEOUT;
-            break;
+            xpd_formatPut(&output, c);
+            continue;
+        }
+
+        /* flags */
+        for (;; Format++)
+        {
+            if (*Format == '-')
+            {
+                left = 1;
+            }
+            else if (*Format == '0')
+            {
+                pad = '0';
+            }
+            else
+            {
+                break;
+            }
+        }
+        /* field width and fraction digits */
+        for (; (*Format >= '0') && (*Format <= '9'); Format++)
+        {
+            width = width * 10 + (*Format - '0');
+        }
+        if (*Format == '.')
+        {
+            for (Format++; (*Format >= '0') && (*Format <= '9'); Format++)
+            {
+                fraction = fraction * 10 + (*Format - '0');
+            }
+        }
+        while ((*Format == 'l') || (*Format == 'h'))
+        {
+            Format++;
+        }
+
+        switch (c = *(Format++))
+        {
+            case 'd':
+            case 'i':
+            case 'q':
+            {
+                int value = va_arg(Args, int);
+                uint32_t magnitude = (value < 0) ? (0 - (uint32_t)value) : (uint32_t)value;
+
+                if ((c != 'q') || (fraction > 9))
+                {
+                    fraction = 0;
+                }
+                xpd_formatNumber(&output, magnitude, value < 0, 10, 'a', width, fraction, pad, left);
+                break;
+            }
+
+            case 'u':
+                xpd_formatNumber(&output, va_arg(Args, unsigned int), 0, 10, 'a', width, 0, pad, left);
+                break;
+
+            case 'x':
+            case 'X':
+                xpd_formatNumber(&output, va_arg(Args, unsigned int), 0, 16,
+                        (c == 'x') ? 'a' : 'A', width, 0, pad, left);
+                break;
+
+            case 's':
+            {
+                const char * text = va_arg(Args, const char *);
+                int32_t length = 0;
+
+                while (text[length] != 0)
+                {
+                    length++;
+                }
+                if (left == 0)
+                {
+                    xpd_formatPad(&output, ' ', (int32_t)width - length);
+                }
+                while (*text != 0)
+                {
+                    xpd_formatPut(&output, *(text++));
+                }
+                if (left != 0)
+                {
+                    xpd_formatPad(&output, ' ', (int32_t)width - length);
+                }
+                break;
+            }
+
+            case 'c':
+                xpd_formatPut(&output, (char)va_arg(Args, int));
+                break;
+
+            case 0:
+                /* incomplete conversion at the end of the format */
+                Format--;
+                break;
+
+            default:
+                xpd_formatPut(&output, c);
+                break;
         }
-        /* COUNTFLAG returns 1 if timer counted to 0 since the last flag read */
-        *mstimeout -= SysTick->CTRL.b.COUNTFLAG;
     }
-    return result;
+
+    return (output.Length <= Space) ? output.Length : 0;
 }
 
 /** @} */
 
-/** @defgroup XPD_Exported_Functions_Stream XPD Data Stream Handling Functions
- *  @brief    XPD Utilities data stream handlers
+#if defined(USE_XPD_RTC) && defined(RTC_CR_WUTE)
+/** @defgroup XPD_Exported_Functions_LowPower XPD Low Power Functions
+ *  @brief    XPD Utilities timed low power mode functions
  * @{
  */
 
 /**
- * @brief Reads new register data to the stream and updates its context.
- * @param reg: pointer to the register to read from
- * @param stream: pointer to the destination stream
+ * @brief Enters Stop mode until the specified time elapses or another wakeup event occurs (tickless idle).
+ *        The wakeup is scheduled with the RTC wakeup timer, and the clocks are restored after wakeup.
+ *        As SysTick doesn't run in Stop mode, the elapsed time is added to the
+ *        SysTick uptime (@ref XPD_SysTick_GetUptime_ms), any other time base
+ *        of the application shall be advanced by the returned value.
+ * @note  The RTC clock has to be enabled and sourced by LSE or LSI beforehand.
+ *        The RTC wakeup timer and its EXTI line are used exclusively by this function.
+ *        Early wakeups (by interrupts or other EXTI events) can only be measured
+ *        when the RTC calendar is initialized, otherwise these are reported as 0 elapsed time.
+ * @param milliseconds: the requested Stop time in ms (limited to the RTC wakeup timer range,
+ *        see @ref XPD_RTC_WakeupStart_IT)
+ * @param clocks: the operating point to restore after wakeup,
+ *        or NULL to continue operating on the undivided wakeup oscillator
+ * @return The time spent in Stop mode in ms
  */
-void XPD_ReadToStream(volatile uint32_t * reg, DataStreamType * stream)
+uint32_t XPD_TicklessIdle(uint32_t milliseconds, const RCC_OperatingPointType * clocks)
 {
-    /* Different size of data transferred */
-    switch (stream->size)
+    const EXTI_InitType wakeupEvent = { .Edge = EDGE_RISING, .Reaction = REACTION_EVENT };
+    uint32_t startTime = 0, primask;
+    boolean_t calendar = RTC->ISR.b.INITS;
+
+    switch (RCC->BDCR.b.RTCSEL)
     {
-        case 1:
-            *((uint8_t*) stream->buffer) = *((__IO uint8_t  *)reg);
-            break;
-        case 2:
-            *((uint16_t*)stream->buffer) = *((__IO uint16_t *)reg);
+#ifdef LSE_VALUE
+        case RTC_CLOCKSOURCE_LSE:
+#endif
+        case RTC_CLOCKSOURCE_LSI:
             break;
+
         default:
-            *((uint32_t*)stream->buffer) = *((__IO uint32_t *)reg);
-            break;
+            /* The HSE is stopped in Stop mode */
+            return 0;
     }
-    /* Stream context update */
-    stream->buffer += stream->size;
-    stream->length--;
-}
 
-/**
- * @brief Writes a new stream data element to the register and updates the stream context.
- * @param reg: pointer to the register to write to
- * @param stream: pointer to the source stream
- */
-void XPD_WriteFromStream(volatile uint32_t * reg, DataStreamType * stream)
-{
-    /* Different size of data transferred */
-    switch (stream->size)
+    milliseconds = XPD_RTC_WakeupStart_IT(milliseconds);
+    if (milliseconds == 0)
     {
-        case 1:
-            *((__IO uint8_t  *)reg) = *((uint8_t*) stream->buffer);
-            break;
-        case 2:
-            *((__IO uint16_t *)reg) = *((uint16_t*)stream->buffer);
-            break;
-        default:
-            *((__IO uint32_t *)reg) = *((uint32_t*)stream->buffer);
-            break;
+        return 0;
+    }
+
+    /* The wakeup is performed by event, no interrupt handler is necessary */
+    XPD_EXTI_Init(PWR_RTC_WAKEUP_EXTI_LINE, &wakeupEvent);
+
+    if (calendar != 0)
+    {
+        startTime = XPD_RTC_GetTimestamp();
+    }
+
+    XPD_PWR_StopMode(REACTION_EVENT, PWR_LOWPOWERREGULATOR);
+
+    /* Restore the clocks, the system is running on the wakeup oscillator */
+    if (clocks != NULL)
+    {
+        (void) XPD_RCC_OperatingPointConfig(clocks);
+    }
+    else
+    {
+        (void) XPD_RCC_HCLKConfig(XPD_RCC_GetSYSCLKSource(), CLK_DIV1, FLASH_LATENCY_AUTO);
+    }
+
+    /* The shadow registers aren't updated in Stop mode */
+    if ((RTC->CR.w & RTC_CR_BYPSHAD) == 0)
+    {
+        (void) XPD_RTC_WaitForSync();
+    }
+
+    /* The full time has elapsed if the wakeup is triggered by the timer */
+    if (RTC->ISR.b.WUTF == 0)
+    {
+        if (calendar != 0)
+        {
+            uint32_t ticksPerSec = XPD_RTC_GetTicksPerSecond();
+            uint32_t endTime = XPD_RTC_GetTimestamp();
+            uint32_t elapsed;
+
+            /* The timestamp wraps around at midnight */
+            if (endTime >= startTime)
+            {
+                elapsed = endTime - startTime;
+            }
+            else
+            {
+                elapsed = endTime + (86400 * ticksPerSec - startTime);
+            }
+            elapsed = (elapsed / ticksPerSec) * 1000 + ((elapsed % ticksPerSec) * 1000) / ticksPerSec;
+
+            if (elapsed < milliseconds)
+            {
+                milliseconds = elapsed;
+            }
+        }
+        else
+        {
+            milliseconds = 0;
+        }
     }
-    /* Stream context update */
-    stream->buffer += stream->size;
-    stream->length--;
+
+    XPD_RTC_WakeupStop_IT();
+
+    XPD_EXTI_Deinit(PWR_RTC_WAKEUP_EXTI_LINE);
+
+    /* The SysTick interrupt may advance the uptime as well */
+    primask = __get_PRIMASK();
+    __disable_irq();
+
+    xpd_uptimeAdvance(milliseconds);
+
+    __set_PRIMASK(primask);
+
+    return milliseconds;
 }
 
 /** @} */
+#endif
 
 /** @defgroup XPD_Exported_Functions_Init XPD Startup and Shutdown Functions
  *  @brief    XPD Utilities startup and shutdown functions
@@ -215,6 +2212,11 @@ void XPD_Init(void)
     /* Configure systick timer */
     XPD_InitTimer();
 
+#if (__FPU_PRESENT == 1)
+    /* Configure the FP context stacking of the interrupts */
+    XPD_NVIC_SetFPUStacking(XPD_FPU_STACKING);
+#endif
+
     /* Enable clock for PWR */
     XPD_PWR_ClockCtrl(ENABLE);
 
@@ -255,6 +2257,24 @@ void XPD_Deinit(void)
 #endif
 }
 
+#ifdef XPD_HANDOFF_ADDRESS
+#define XPD_HANDOFF_MAGIC       0x48445058 /* "XPDH" */
+
+#define xpd_handoff             ((XPD_HandoffType *)(XPD_HANDOFF_ADDRESS))
+#endif
+
+/* Sets up the stack of the application and jumps to its reset handler */
+static void xpd_startApplication(void * StartAddress)
+{
+    void (*startApplication)(void) = *((const void **)(StartAddress + 4));
+
+    /* Set the main stack pointer */
+    __set_MSP(*((const uint32_t *)StartAddress));
+
+    /* Jump to application */
+    startApplication();
+}
+
 /**
  * @brief Resets the MCU peripherals to their startup state and
  *        boots to the application at the specified address
@@ -266,7 +2286,10 @@ void XPD_Deinit(void)
  */
 void XPD_BootTo(void * StartAddress)
 {
-    void (*startApplication)(void) = *((const void **)(StartAddress + 4));
+#ifdef XPD_HANDOFF_ADDRESS
+    /* No handoff to the application */
+    xpd_handoff->Magic = 0;
+#endif
 
     /* Reset clock configuration */
     XPD_RCC_Deinit();
@@ -275,12 +2298,81 @@ void XPD_BootTo(void * StartAddress)
     /* Disable SysTick interrupt as well */
     XPD_SysTick_DisableIT();
 
-    /* Set the main stack pointer */
-    __set_MSP(*((const uint32_t *)StartAddress));
+    xpd_startApplication(StartAddress);
+}
 
-    /* Jump to application */
-    startApplication();
+#ifdef XPD_HANDOFF_ADDRESS
+/**
+ * @brief Boots to the application at the specified address, keeping the selected resources
+ *        operational, and passes the handoff structure to the application.
+ * @param StartAddress: The address of the application to be started
+ * @param Handoff: The handoff options and data, which are copied to @ref XPD_HANDOFF_ADDRESS
+ * @note  The interrupts are disabled in the NVIC, and the vector table is relocated
+ *        to the start address (on cores with VTOR). The application receives the structure by @ref XPD_GetHandoff,
+ *        and it shall skip the reset of the kept resources in its startup accordingly.
+ * @note  The handoff address has to be excluded from the RAM sections of both images.
+ * @note  The integrity of the program has to be ensured as for @ref XPD_BootTo.
+ */
+void XPD_BootHandoff(void * StartAddress, const XPD_HandoffType * Handoff)
+{
+    uint32_t i;
+
+    if ((Handoff->Flags & XPD_HANDOFF_CLOCKS) == 0)
+    {
+        /* Reset clock configuration */
+        XPD_RCC_Deinit();
+    }
+    if ((Handoff->Flags & XPD_HANDOFF_PERIPHERALS) == 0)
+    {
+        /* Reset all peripherals */
+        XPD_Deinit();
+    }
+    /* Disable SysTick interrupt as well */
+    XPD_SysTick_DisableIT();
+
+    /* The kept peripherals' interrupts are handled by the application once it's ready */
+    for (i = 0; i < (sizeof(NVIC->ICER) / sizeof(NVIC->ICER[0])); i++)
+    {
+        NVIC->ICER[i] = ~0;
+        NVIC->ICPR[i] = ~0;
+    }
+
+    *xpd_handoff = *Handoff;
+    xpd_handoff->Magic = XPD_HANDOFF_MAGIC;
+
+#ifdef SCB_VTOR_TBLOFF_Msk
+    /* Relocate the vector table to the application */
+    SCB->VTOR.w = (uint32_t)StartAddress;
+#endif
+    __DSB();
+
+    xpd_startApplication(StartAddress);
+}
+
+/**
+ * @brief Provides the handoff structure passed by the boot loader.
+ * @note  When the clocks were kept, the cached clock frequencies are updated
+ *        by @ref XPD_RCC_ClockTreeSync instead of resetting the clock configuration.
+ * @return The handoff structure if the application was started by @ref XPD_BootHandoff,
+ *         NULL otherwise
+ */
+const XPD_HandoffType * XPD_GetHandoff(void)
+{
+    return (xpd_handoff->Magic == XPD_HANDOFF_MAGIC) ? xpd_handoff : NULL;
+}
+#endif
+
+#ifdef USE_XPD_CONST_CALLBACKS
+/**
+ * @brief Handle callback without any operation,
+ *        for the unused entries of the constant callback tables.
+ * @param Handle: pointer of the callback sender handle
+ */
+void XPD_NullCallback(void * Handle)
+{
+    (void) Handle;
 }
+#endif
 
 /** @} */
 
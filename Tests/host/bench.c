@@ -0,0 +1,184 @@
+/**
+  ******************************************************************************
+  * @file    bench.c
+  * @author  Benedek Kupper
+  * @version V0.1
+  * @date    2018-02-10
+  * @brief   STM32 eXtensible Peripheral Drivers host micro-benchmarks
+  *
+  *  This file is part of STM32_XPD.
+  *
+  *  STM32_XPD is free software: you can redistribute it and/or modify
+  *  it under the terms of the GNU General Public License as published by
+  *  the Free Software Foundation, either version 3 of the License, or
+  *  (at your option) any later version.
+  *
+  *  STM32_XPD is distributed in the hope that it will be useful,
+  *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with STM32_XPD.  If not, see <http://www.gnu.org/licenses/>.
+  */
+#include <stdio.h>
+#include <xpd_utils.h>
+#include <xpd_adc_calc.h>
+#include <xpd_can.h>
+#include "host_test.h"
+
+/* The host figures only compare revisions of the algorithms,
+ * the target timings are measured by Projects/Benchmarks */
+
+#define BENCH_ROUNDS    2000
+
+static uint64_t benchStart;
+
+static void bench_begin(void)
+{
+    benchStart = host_ns();
+}
+
+static void bench_end(const char * Name, uint32_t Operations)
+{
+    uint64_t ns = host_ns() - benchStart;
+
+    printf("%-24s %10.2f ns/op\n", Name, (double)ns / Operations);
+}
+
+static uint8_t bytes[1024] __attribute__((aligned(4)));
+static uint8_t encoded[XPD_FRAME_ENCODED_SIZE(XPD_FRAMING_SLIP, 1024)];
+static uint8_t decoded[1024];
+static volatile uint32_t sink;
+
+static void frameSink(void * Decoder)
+{
+    sink += ((XPD_FrameDecoderType*)Decoder)->Length;
+}
+
+static void bench_ring(void)
+{
+    XPD_RingType ring;
+    uint32_t i, r;
+    uint8_t byte = 0;
+
+    (void) XPD_Ring_Init(&ring, decoded, 1, sizeof(decoded));
+
+    bench_begin();
+    for (r = 0; r < BENCH_ROUNDS; r++)
+    {
+        for (i = 0; i < 512; i++)
+        {
+            (void) XPD_Ring_PutByte(&ring, bytes[i]);
+        }
+        for (i = 0; i < 512; i++)
+        {
+            (void) XPD_Ring_GetByte(&ring, &byte);
+            sink += byte;
+        }
+    }
+    bench_end("Ring_PutByte+GetByte", BENCH_ROUNDS * 512);
+}
+
+static void bench_frame(XPD_FramingType Type, const char * EncodeName, const char * DecodeName)
+{
+    XPD_FrameDecoderType decoder = {
+        .Type = Type, .Buffer = decoded, .Size = sizeof(decoded), .Callback = frameSink };
+    uint16_t length = 0;
+    uint32_t r;
+
+    XPD_Frame_DecoderInit(&decoder);
+
+    bench_begin();
+    for (r = 0; r < BENCH_ROUNDS; r++)
+    {
+        length = XPD_Frame_Encode(Type, bytes, sizeof(bytes), encoded);
+    }
+    bench_end(EncodeName, BENCH_ROUNDS);
+
+    bench_begin();
+    for (r = 0; r < BENCH_ROUNDS; r++)
+    {
+        sink += XPD_Frame_Decode(&decoder, encoded, length);
+    }
+    bench_end(DecodeName, BENCH_ROUNDS);
+}
+
+static void bench_adc(void)
+{
+    static const int16_t coeffs[16] __attribute__((aligned(4))) = {
+        512, 1024, 1536, 2048, 2560, 3072, 3584, 4096,
+        4096, 3584, 3072, 2560, 2048, 1536, 1024, 512 };
+    static uint16_t state[16 - 1 + 512] __attribute__((aligned(4)));
+    static uint16_t conversions[512], output[512];
+    static int32_t values[512];
+    ADC_CICFilterType cic;
+    ADC_FIRFilterType fir;
+    uint32_t i, r;
+
+    for (i = 0; i < 512; i++)
+    {
+        conversions[i] = host_random() & 0xFFF;
+    }
+
+    bench_begin();
+    for (r = 0; r < BENCH_ROUNDS; r++)
+    {
+        XPD_ADC_ConvertBlock_mV(conversions, values, 512);
+        sink += values[r & 0x1FF];
+    }
+    bench_end("ADC_ConvertBlock_mV[512]", BENCH_ROUNDS);
+
+    XPD_ADC_CIC_Init(&cic, 3, 16);
+    bench_begin();
+    for (r = 0; r < BENCH_ROUNDS; r++)
+    {
+        sink += XPD_ADC_CIC_Decimate(&cic, conversions, output, 512);
+    }
+    bench_end("ADC_CIC_Decimate[512]", BENCH_ROUNDS);
+
+    XPD_ADC_FIR_Init(&fir, coeffs, 16, 4, state);
+    bench_begin();
+    for (r = 0; r < BENCH_ROUNDS; r++)
+    {
+        sink += XPD_ADC_FIR_Decimate(&fir, conversions, output, 512);
+    }
+    bench_end("ADC_FIR_Decimate[512]", BENCH_ROUNDS);
+}
+
+static void bench_can(void)
+{
+    static const CAN_FilterRangeType ranges[] = {
+        { .First = 0x100, .Last = 0x17F, .Type = CAN_IDTYPE_STD_DATA, .FIFO = 0 },
+        { .First = 0x1D5, .Last = 0x30A, .Type = CAN_IDTYPE_STD_DATA, .FIFO = 1 },
+        { .First = 0x18DA00F1, .Last = 0x18DAFFF1, .Type = CAN_IDTYPE_EXT_DATA, .FIFO = 1 },
+    };
+    CAN_FilterType filters[64];
+    uint32_t r;
+
+    bench_begin();
+    for (r = 0; r < BENCH_ROUNDS; r++)
+    {
+        uint8_t count = 64;
+
+        (void) XPD_CAN_FilterCompile(ranges, 3, filters, &count);
+        sink += count;
+    }
+    bench_end("CAN_FilterCompile", BENCH_ROUNDS);
+}
+
+void bench_run(void)
+{
+    uint32_t i;
+
+    for (i = 0; i < sizeof(bytes); i++)
+    {
+        bytes[i] = host_random() >> 24;
+    }
+
+    bench_ring();
+    bench_frame(XPD_FRAMING_COBS, "Frame_Encode COBS[1024]", "Frame_Decode COBS[1024]");
+    bench_frame(XPD_FRAMING_SLIP, "Frame_Encode SLIP[1024]", "Frame_Decode SLIP[1024]");
+    bench_adc();
+    bench_can();
+}
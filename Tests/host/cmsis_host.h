@@ -0,0 +1,149 @@
+/**
+  ******************************************************************************
+  * @file    cmsis_host.h
+  * @author  Benedek Kupper
+  * @version V0.1
+  * @date    2018-02-10
+  * @brief   STM32 eXtensible Peripheral Drivers host build Cortex-M intrinsics
+  *
+  *  This file is part of STM32_XPD.
+  *
+  *  STM32_XPD is free software: you can redistribute it and/or modify
+  *  it under the terms of the GNU General Public License as published by
+  *  the Free Software Foundation, either version 3 of the License, or
+  *  (at your option) any later version.
+  *
+  *  STM32_XPD is distributed in the hope that it will be useful,
+  *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with STM32_XPD.  If not, see <http://www.gnu.org/licenses/>.
+  */
+#ifndef __CMSIS_HOST_H_
+#define __CMSIS_HOST_H_
+
+/* This header is included before every source of the host build, and replaces
+ * the inline assembly intrinsics of cmsis_gcc.h with their C equivalents.
+ * The host build is single threaded, so the exclusive accesses always succeed,
+ * and the interrupt mask is only a variable. */
+#define __CMSIS_GCC_H
+
+#include <stdint.h>
+
+/* Interrupt mask and the DSP GE flags of the emulated core */
+extern uint32_t host_PRIMASK;
+extern uint32_t host_GE;
+
+static inline void __enable_irq(void)                   { host_PRIMASK = 0; }
+static inline void __disable_irq(void)                  { host_PRIMASK = 1; }
+static inline uint32_t __get_PRIMASK(void)              { return host_PRIMASK; }
+static inline void __set_PRIMASK(uint32_t priMask)      { host_PRIMASK = priMask; }
+static inline uint32_t __get_BASEPRI(void)              { return 0; }
+static inline void __set_BASEPRI(uint32_t basePri)      { (void) basePri; }
+static inline uint32_t __get_CONTROL(void)              { return 0; }
+static inline void __set_CONTROL(uint32_t control)      { (void) control; }
+/* Thread mode */
+static inline uint32_t __get_IPSR(void)                 { return 0; }
+static inline uint32_t __get_MSP(void)                  { return 0; }
+static inline void __set_MSP(uint32_t topOfMainStack)   { (void) topOfMainStack; }
+static inline uint32_t __get_PSP(void)                  { return 0; }
+static inline void __set_PSP(uint32_t topOfProcStack)   { (void) topOfProcStack; }
+static inline uint32_t __get_FPSCR(void)                { return 0; }
+static inline void __set_FPSCR(uint32_t fpscr)          { (void) fpscr; }
+
+#define __NOP()                 do { } while (0)
+#define __WFI()                 do { } while (0)
+#define __WFE()                 do { } while (0)
+#define __SEV()                 do { } while (0)
+#define __BKPT(value)           do { } while (0)
+#define __ISB()                 __sync_synchronize()
+#define __DSB()                 __sync_synchronize()
+#define __DMB()                 __sync_synchronize()
+#define __CLREX()               do { } while (0)
+
+static inline uint32_t __REV(uint32_t value)            { return __builtin_bswap32(value); }
+static inline uint32_t __REV16(uint32_t value)
+{
+    return ((value & 0xFF00FF00UL) >> 8) | ((value & 0x00FF00FFUL) << 8);
+}
+static inline int32_t __REVSH(int32_t value)            { return (int16_t)__builtin_bswap16((uint16_t)value); }
+static inline uint32_t __ROR(uint32_t op1, uint32_t op2)
+{
+    op2 %= 32;
+    return (op2 == 0) ? op1 : ((op1 >> op2) | (op1 << (32 - op2)));
+}
+static inline uint32_t __RBIT(uint32_t value)
+{
+    uint32_t result = 0;
+    int i;
+
+    for (i = 0; i < 32; i++, value >>= 1)
+    {
+        result = (result << 1) | (value & 1);
+    }
+    return result;
+}
+static inline uint8_t __CLZ(uint32_t value)             { return (value == 0) ? 32 : __builtin_clz(value); }
+
+static inline uint8_t __LDREXB(volatile uint8_t * addr)             { return *addr; }
+static inline uint16_t __LDREXH(volatile uint16_t * addr)           { return *addr; }
+static inline uint32_t __LDREXW(volatile uint32_t * addr)           { return *addr; }
+static inline uint32_t __STREXB(uint8_t value, volatile uint8_t * addr)   { *addr = value; return 0; }
+static inline uint32_t __STREXH(uint16_t value, volatile uint16_t * addr) { *addr = value; return 0; }
+static inline uint32_t __STREXW(uint32_t value, volatile uint32_t * addr) { *addr = value; return 0; }
+
+static inline int32_t __SSAT(int32_t val, uint32_t sat)
+{
+    int32_t max = (int32_t)((1UL << (sat - 1)) - 1);
+    return (val > max) ? max : ((val < -max - 1) ? (-max - 1) : val);
+}
+static inline uint32_t __USAT(int32_t val, uint32_t sat)
+{
+    uint32_t max = (uint32_t)((1ULL << sat) - 1);
+    return (val < 0) ? 0 : (((uint32_t)val > max) ? max : (uint32_t)val);
+}
+
+/* DSP extension */
+static inline uint32_t __SMUAD(uint32_t op1, uint32_t op2)
+{
+    return (uint32_t)(((int32_t)(int16_t)op1 * (int16_t)op2)
+            + ((int32_t)(int16_t)(op1 >> 16) * (int16_t)(op2 >> 16)));
+}
+static inline uint32_t __SMLAD(uint32_t op1, uint32_t op2, uint32_t op3)
+{
+    return __SMUAD(op1, op2) + op3;
+}
+static inline uint32_t __UXTB16(uint32_t op1)           { return op1 & 0x00FF00FFUL; }
+static inline uint32_t __USUB8(uint32_t op1, uint32_t op2)
+{
+    uint32_t result = 0;
+    int i;
+
+    host_GE = 0;
+    for (i = 0; i < 32; i += 8)
+    {
+        uint32_t a = (op1 >> i) & 0xFF, b = (op2 >> i) & 0xFF;
+
+        result |= ((a - b) & 0xFF) << i;
+        if (a >= b)
+        {
+            host_GE |= 1UL << (i / 8);
+        }
+    }
+    return result;
+}
+static inline uint32_t __SEL(uint32_t op1, uint32_t op2)
+{
+    uint32_t result = 0;
+    int i;
+
+    for (i = 0; i < 4; i++)
+    {
+        result |= (((host_GE >> i) & 1) ? op1 : op2) & (0xFFUL << (i * 8));
+    }
+    return result;
+}
+
+#endif /* __CMSIS_HOST_H_ */
@@ -0,0 +1,45 @@
+/**
+  ******************************************************************************
+  * @file    host_test.h
+  * @author  Benedek Kupper
+  * @version V0.1
+  * @date    2018-02-10
+  * @brief   STM32 eXtensible Peripheral Drivers host tests common header
+  *
+  *  This file is part of STM32_XPD.
+  *
+  *  STM32_XPD is free software: you can redistribute it and/or modify
+  *  it under the terms of the GNU General Public License as published by
+  *  the Free Software Foundation, either version 3 of the License, or
+  *  (at your option) any later version.
+  *
+  *  STM32_XPD is distributed in the hope that it will be useful,
+  *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with STM32_XPD.  If not, see <http://www.gnu.org/licenses/>.
+  */
+#ifndef __HOST_TEST_H_
+#define __HOST_TEST_H_
+
+#include <stdint.h>
+
+/**
+ * @brief Records the result of a test condition.
+ * @param COND: the condition which has to hold
+ */
+#define HOST_CHECK(COND)    host_check((COND), #COND, __FILE__, __LINE__)
+
+void        host_check      (int Passed, const char * Condition, const char * File, int Line);
+uint64_t    host_ns         (void);
+uint32_t    host_random     (void);
+
+void        test_utils      (void);
+void        test_adc_calc   (void);
+void        test_can        (void);
+
+void        bench_run       (void);
+
+#endif /* __HOST_TEST_H_ */
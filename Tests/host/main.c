@@ -0,0 +1,78 @@
+/**
+  ******************************************************************************
+  * @file    main.c
+  * @author  Benedek Kupper
+  * @version V0.1
+  * @date    2018-02-10
+  * @brief   STM32 eXtensible Peripheral Drivers host tests runner
+  *
+  *  This file is part of STM32_XPD.
+  *
+  *  STM32_XPD is free software: you can redistribute it and/or modify
+  *  it under the terms of the GNU General Public License as published by
+  *  the Free Software Foundation, either version 3 of the License, or
+  *  (at your option) any later version.
+  *
+  *  STM32_XPD is distributed in the hope that it will be useful,
+  *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with STM32_XPD.  If not, see <http://www.gnu.org/licenses/>.
+  */
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "host_test.h"
+
+/* The state of the emulated core intrinsics */
+uint32_t host_PRIMASK = 0;
+uint32_t host_GE = 0;
+
+static uint32_t checks = 0, failures = 0;
+static uint32_t seed = 0x12345678;
+
+void host_check(int Passed, const char * Condition, const char * File, int Line)
+{
+    checks++;
+    if (!Passed)
+    {
+        failures++;
+        printf("%s:%d: check failed: %s\n", File, Line, Condition);
+    }
+}
+
+uint64_t host_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/* xorshift32, for reproducible test data */
+uint32_t host_random(void)
+{
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    return seed;
+}
+
+int main(int argc, char * argv[])
+{
+    if ((argc > 1) && (strcmp(argv[1], "bench") == 0))
+    {
+        bench_run();
+        return 0;
+    }
+
+    test_utils();
+    test_adc_calc();
+    test_can();
+
+    printf("%u checks, %u failed\n", checks, failures);
+
+    return (failures == 0) ? 0 : 1;
+}
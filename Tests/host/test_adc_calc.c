@@ -0,0 +1,143 @@
+/**
+  ******************************************************************************
+  * @file    test_adc_calc.c
+  * @author  Benedek Kupper
+  * @version V0.1
+  * @date    2018-02-10
+  * @brief   STM32 eXtensible Peripheral Drivers host tests of the ADC calculations
+  *
+  *  This file is part of STM32_XPD.
+  *
+  *  STM32_XPD is free software: you can redistribute it and/or modify
+  *  it under the terms of the GNU General Public License as published by
+  *  the Free Software Foundation, either version 3 of the License, or
+  *  (at your option) any later version.
+  *
+  *  STM32_XPD is distributed in the hope that it will be useful,
+  *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with STM32_XPD.  If not, see <http://www.gnu.org/licenses/>.
+  */
+#include <xpd_adc_calc.h>
+#include "host_test.h"
+
+/* The calibration values are read from the system memory, so only the
+ * calculations based on the configured VDDA_VALUE are exercised here */
+
+static void test_convert(void)
+{
+    static uint16_t conversions[67];
+    static uint8_t conversions8[67];
+    int32_t values[67];
+    uint32_t i, offset, mismatches = 0;
+
+    HOST_CHECK(XPD_ADC_GetValue_mV(0) == 0);
+    HOST_CHECK(XPD_ADC_GetValue_mV(4095) == VDDA_VALUE);
+
+    for (i = 0; i < 67; i++)
+    {
+        conversions[i]   = (i * 61) & 0xFFF;
+        conversions8[i]  = (i * 19) & 0xFF;
+    }
+
+    /* Both the word aligned and the unaligned starts */
+    for (offset = 0; offset < 4; offset++)
+    {
+        XPD_ADC_ConvertBlock_mV(&conversions[offset], values, 67 - offset);
+        for (i = 0; i < (67 - offset); i++)
+        {
+            int32_t diff = values[i] - XPD_ADC_GetValue_mV(conversions[offset + i]);
+            mismatches += (diff < -1) || (diff > 1);
+        }
+
+        XPD_ADC_ConvertBlock8_mV(&conversions8[offset], values, 67 - offset);
+        for (i = 0; i < (67 - offset); i++)
+        {
+            int32_t diff = values[i] - ((int32_t)conversions8[offset + i] * VDDA_VALUE) / 255;
+            mismatches += (diff < -1) || (diff > 1);
+        }
+    }
+    HOST_CHECK(mismatches == 0);
+}
+
+static void test_find_level(void)
+{
+    static uint8_t input[40];
+    uint32_t i, offset;
+
+    for (offset = 0; offset < 4; offset++)
+    {
+        for (i = 0; i < 40; i++)
+        {
+            input[i] = 10;
+        }
+        HOST_CHECK(XPD_ADC_FindLevel8(&input[offset], 40 - offset, 11) == (40 - offset));
+
+        input[offset + 21] = 200;
+        input[offset + 30] = 11;
+        HOST_CHECK(XPD_ADC_FindLevel8(&input[offset], 40 - offset, 11) == 21);
+        HOST_CHECK(XPD_ADC_FindLevel8(&input[offset], 40 - offset, 201) == (40 - offset));
+        HOST_CHECK(XPD_ADC_FindLevel8(&input[offset], 40 - offset, 10) == 0);
+    }
+}
+
+static void test_cic(void)
+{
+    ADC_CICFilterType cic;
+    uint16_t input[100], output[100];
+    uint32_t i, outputs;
+
+    for (i = 0; i < 100; i++)
+    {
+        input[i] = 2000;
+    }
+
+    /* The DC gain is compensated, the output settles after Order outputs */
+    XPD_ADC_CIC_Init(&cic, 3, 8);
+    outputs  = XPD_ADC_CIC_Decimate(&cic, input, output, 37);
+    outputs += XPD_ADC_CIC_Decimate(&cic, input, &output[outputs], 43);
+    HOST_CHECK(outputs == 10);
+    for (i = 3; i < outputs; i++)
+    {
+        HOST_CHECK(output[i] == 2000);
+    }
+}
+
+static void test_fir(void)
+{
+    /* 4 tap moving average */
+    static const int16_t coeffs[4] __attribute__((aligned(4))) = { 8192, 8192, 8192, 8192 };
+    static uint16_t state[4 - 1 + 32] __attribute__((aligned(4)));
+    ADC_FIRFilterType fir;
+    uint16_t input[32], output[32];
+    uint32_t i, outputs;
+
+    for (i = 0; i < 32; i++)
+    {
+        input[i] = (i & 1) ? 3000 : 1000;
+    }
+
+    XPD_ADC_FIR_Init(&fir, coeffs, 4, 2, state);
+    outputs = XPD_ADC_FIR_Decimate(&fir, input, output, 32);
+    HOST_CHECK(outputs == 16);
+    HOST_CHECK(output[0] == 250);
+    for (i = 2; i < outputs; i++)
+    {
+        HOST_CHECK(output[i] == 2000);
+    }
+
+    /* The history continues the previous block */
+    outputs = XPD_ADC_FIR_Decimate(&fir, input, output, 4);
+    HOST_CHECK((outputs == 2) && (output[0] == 2000) && (output[1] == 2000));
+}
+
+void test_adc_calc(void)
+{
+    test_convert();
+    test_find_level();
+    test_cic();
+    test_fir();
+}
@@ -0,0 +1,89 @@
+/**
+  ******************************************************************************
+  * @file    test_can.c
+  * @author  Benedek Kupper
+  * @version V0.1
+  * @date    2018-02-10
+  * @brief   STM32 eXtensible Peripheral Drivers host tests of the CAN filter compiler
+  *
+  *  This file is part of STM32_XPD.
+  *
+  *  STM32_XPD is free software: you can redistribute it and/or modify
+  *  it under the terms of the GNU General Public License as published by
+  *  the Free Software Foundation, either version 3 of the License, or
+  *  (at your option) any later version.
+  *
+  *  STM32_XPD is distributed in the hope that it will be useful,
+  *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with STM32_XPD.  If not, see <http://www.gnu.org/licenses/>.
+  */
+#include <xpd_can.h>
+#include "host_test.h"
+
+/* Evaluates the compiled filters in software, as the filter banks would */
+static int can_accepted(const CAN_FilterType * Filters, uint8_t Count, uint32_t Id, CAN_IdType Type)
+{
+    uint8_t i;
+
+    for (i = 0; i < Count; i++)
+    {
+        if ((Filters[i].Pattern.Type == Type)
+                && ((Filters[i].Pattern.Value & Filters[i].Mask) == (Id & Filters[i].Mask)))
+        {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static const CAN_FilterRangeType ranges[] = {
+    { .First = 0x100, .Last = 0x17F, .Type = CAN_IDTYPE_STD_DATA, .FIFO = 0 },
+    { .First = 0x1D5, .Last = 0x30A, .Type = CAN_IDTYPE_STD_DATA, .FIFO = 1 },
+    { .First = 0x7FF, .Last = 0x7FF, .Type = CAN_IDTYPE_STD_DATA, .FIFO = 0 },
+    { .First = 0x18DA00F1, .Last = 0x18DAFFF1, .Type = CAN_IDTYPE_EXT_DATA, .FIFO = 1 },
+};
+
+void test_can(void)
+{
+    CAN_FilterType filters[40];
+    uint8_t count = 40, i, exact = 1;
+    uint32_t id, mismatches = 0;
+
+    HOST_CHECK(XPD_CAN_FilterCompile(ranges, 4, filters, &count) == XPD_OK);
+
+    /* Every standard Identifier */
+    for (id = 0; id <= 0x7FF; id++)
+    {
+        int expected = ((id >= 0x100) && (id <= 0x17F)) || ((id >= 0x1D5) && (id <= 0x30A)) || (id == 0x7FF);
+
+        mismatches += can_accepted(filters, count, id, CAN_IDTYPE_STD_DATA) != expected;
+    }
+    HOST_CHECK(mismatches == 0);
+
+    /* The extended range boundaries */
+    HOST_CHECK(!can_accepted(filters, count, 0x18DA00F0, CAN_IDTYPE_EXT_DATA));
+    HOST_CHECK(can_accepted(filters, count, 0x18DA00F1, CAN_IDTYPE_EXT_DATA));
+    HOST_CHECK(can_accepted(filters, count, 0x18DA8000, CAN_IDTYPE_EXT_DATA));
+    HOST_CHECK(can_accepted(filters, count, 0x18DAFFF1, CAN_IDTYPE_EXT_DATA));
+    HOST_CHECK(!can_accepted(filters, count, 0x18DAFFF2, CAN_IDTYPE_EXT_DATA));
+    HOST_CHECK(!can_accepted(filters, count, 0x100, CAN_IDTYPE_EXT_DATA));
+
+    /* Single Identifiers are matched in list mode, the blocks in mask mode */
+    for (i = 0; i < count; i++)
+    {
+        uint32_t idMask = (filters[i].Pattern.Type == CAN_IDTYPE_STD_DATA) ? 0x7FF : 0x1FFFFFFF;
+
+        exact &= (filters[i].Mode == CAN_FILTER_MATCH) == (filters[i].Mask == idMask);
+    }
+    HOST_CHECK(exact);
+    HOST_CHECK((filters[0].Mask == 0x780) && (filters[0].FIFO == 0));
+
+    /* Too small filter array */
+    count = 3;
+    HOST_CHECK(XPD_CAN_FilterCompile(ranges, 4, filters, &count) == XPD_ERROR);
+    HOST_CHECK(count == 3);
+}
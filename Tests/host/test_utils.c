@@ -0,0 +1,220 @@
+/**
+  ******************************************************************************
+  * @file    test_utils.c
+  * @author  Benedek Kupper
+  * @version V0.1
+  * @date    2018-02-10
+  * @brief   STM32 eXtensible Peripheral Drivers host tests of the Utilities
+  *
+  *  This file is part of STM32_XPD.
+  *
+  *  STM32_XPD is free software: you can redistribute it and/or modify
+  *  it under the terms of the GNU General Public License as published by
+  *  the Free Software Foundation, either version 3 of the License, or
+  *  (at your option) any later version.
+  *
+  *  STM32_XPD is distributed in the hope that it will be useful,
+  *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with STM32_XPD.  If not, see <http://www.gnu.org/licenses/>.
+  */
+#include <string.h>
+#include <xpd_utils.h>
+#include "host_test.h"
+
+static void test_ring(void)
+{
+    XPD_RingType ring;
+    uint32_t storage[8], value = 0, i;
+    uint8_t bytes[4], byte;
+    void * data;
+
+    HOST_CHECK(XPD_Ring_Init(&ring, storage, sizeof(uint32_t), 6) == XPD_ERROR);
+    HOST_CHECK(XPD_Ring_Init(&ring, storage, sizeof(uint32_t), 8) == XPD_OK);
+    HOST_CHECK((XPD_Ring_Count(&ring) == 0) && (XPD_Ring_Space(&ring) == 8));
+
+    /* The free-running indexes wrap around the storage many times */
+    for (i = 0; i < 1000; i++)
+    {
+        uint32_t out = 0;
+
+        HOST_CHECK(XPD_Ring_Put(&ring, &i) == XPD_OK);
+        if ((i % 3) != 2)
+        {
+            continue;
+        }
+        while (XPD_Ring_Get(&ring, &out) == XPD_OK)
+        {
+            HOST_CHECK(out == value);
+            value++;
+        }
+    }
+    HOST_CHECK(XPD_Ring_Count(&ring) == 1);
+
+    /* Full ring */
+    while (XPD_Ring_Put(&ring, &i) == XPD_OK);
+    HOST_CHECK((XPD_Ring_Count(&ring) == 8) && (XPD_Ring_Space(&ring) == 0));
+
+    /* The contiguous regions end at the end of the storage */
+    HOST_CHECK(XPD_Ring_Init(&ring, bytes, 1, 4) == XPD_OK);
+    ring.Head = ring.Tail = 3;
+    HOST_CHECK(XPD_Ring_Reserve(&ring, &data) == 1);
+    HOST_CHECK(data == &bytes[3]);
+    *(uint8_t*)data = 0xA5;
+    XPD_Ring_Commit(&ring, 1);
+    HOST_CHECK(XPD_Ring_Reserve(&ring, &data) == 3);
+    HOST_CHECK(data == &bytes[0]);
+    HOST_CHECK(XPD_Ring_PutByte(&ring, 0x5A) == XPD_OK);
+    HOST_CHECK(XPD_Ring_Peek(&ring, &data) == 1);
+    HOST_CHECK(XPD_Ring_GetByte(&ring, &byte) == XPD_OK && byte == 0xA5);
+    HOST_CHECK(XPD_Ring_GetByte(&ring, &byte) == XPD_OK && byte == 0x5A);
+    HOST_CHECK(XPD_Ring_GetByte(&ring, &byte) == XPD_BUSY);
+}
+
+static void test_queue(void)
+{
+    XPD_QueueType queue;
+    uint16_t storage[4], sequence[4], value, i;
+
+    HOST_CHECK(XPD_Queue_Init(&queue, storage, sequence, sizeof(uint16_t), 4) == XPD_OK);
+    HOST_CHECK(XPD_Queue_Get(&queue, &value) == XPD_BUSY);
+
+    for (i = 0; i < 4; i++)
+    {
+        HOST_CHECK(XPD_Queue_Put(&queue, &i) == XPD_OK);
+    }
+    HOST_CHECK(XPD_Queue_Put(&queue, &i) == XPD_BUSY);
+
+    for (i = 0; i < 4; i++)
+    {
+        HOST_CHECK(XPD_Queue_Get(&queue, &value) == XPD_OK && value == i);
+        HOST_CHECK(XPD_Queue_Put(&queue, &i) == XPD_OK);
+    }
+}
+
+static void test_stream(void)
+{
+    static const uint32_t sizes[] = { 1, 2, 4 };
+    uint32_t reg, words[4] = { 0 }, s;
+
+    for (s = 0; s < 3; s++)
+    {
+        DataStreamType stream = { words, 3, sizes[s] };
+        uint32_t i;
+
+        memset(words, 0, sizeof(words));
+        for (i = 0; i < 3; i++)
+        {
+            reg = 0x03020100 + (i * 0x11111111);
+            XPD_ReadToStream(&reg, &stream);
+        }
+        HOST_CHECK(stream.length == 0);
+        HOST_CHECK(stream.buffer == (uint8_t*)words + (3 * sizes[s]));
+
+        stream.buffer = words;
+        stream.length = 2;
+        reg = 0;
+        XPD_WriteFromStream(&reg, &stream);
+        HOST_CHECK(reg == (0x03020100 & (0xFFFFFFFFUL >> (32 - 8 * sizes[s]))));
+        HOST_CHECK(stream.length == 1);
+    }
+}
+
+static uint8_t frameBuffer[600];
+static uint8_t frameExpected[600];
+static uint16_t frameExpectedLength;
+static uint32_t frameCount, frameMatches;
+
+static void frameReceived(void * Decoder)
+{
+    XPD_FrameDecoderType * decoder = Decoder;
+
+    frameCount++;
+    if ((decoder->Length == frameExpectedLength)
+            && (memcmp(decoder->Buffer, frameExpected, frameExpectedLength) == 0))
+    {
+        frameMatches++;
+    }
+}
+
+static void test_frame_type(XPD_FramingType Type)
+{
+    XPD_FrameDecoderType decoder = {
+        .Type = Type, .Buffer = frameBuffer, .Size = sizeof(frameBuffer), .Callback = frameReceived };
+    uint8_t encoded[XPD_FRAME_ENCODED_SIZE(XPD_FRAMING_SLIP, 600)];
+    uint32_t n;
+
+    XPD_Frame_DecoderInit(&decoder);
+    frameCount = frameMatches = 0;
+
+    for (n = 0; n < 200; n++)
+    {
+        uint16_t length = (n < 4) ? (n * 254) % 600 : (host_random() % sizeof(frameExpected)) + 1;
+        uint16_t encodedLength, pos = 0, i;
+
+        /* Sparse delimiter values, and long runs without them */
+        for (i = 0; i < length; i++)
+        {
+            uint32_t r = host_random();
+            frameExpected[i] = ((r & 0x1F) == 0) ? 0 : ((r & 0x3F) == 1) ? 0xC0 :
+                    ((r & 0x3F) == 2) ? 0xDB : (uint8_t)((r >> 8) | 1);
+            if (n == 2)
+            {
+                frameExpected[i] = 0x55;
+            }
+        }
+        frameExpectedLength = length;
+
+        encodedLength = XPD_Frame_Encode(Type, frameExpected, length, encoded);
+        HOST_CHECK(encodedLength <= XPD_FRAME_ENCODED_SIZE(Type, length));
+
+        /* Split the stream at random points, as the DMA blocks would */
+        while (pos < encodedLength)
+        {
+            uint16_t span = (host_random() % 64) + 1;
+
+            if (span > (encodedLength - pos))
+            {
+                span = encodedLength - pos;
+            }
+            (void) XPD_Frame_Decode(&decoder, &encoded[pos], span);
+            pos += span;
+        }
+    }
+    /* Empty frames only occur for n == 0 */
+    HOST_CHECK(frameCount == frameMatches);
+    HOST_CHECK(frameCount >= 199);
+    HOST_CHECK(decoder.Errors == 0);
+
+    /* Too long frames are dropped */
+    decoder.Size = 10;
+    frameCount = 0;
+    memset(frameExpected, 0x11, 20);
+    n = XPD_Frame_Encode(Type, frameExpected, 20, encoded);
+    HOST_CHECK(XPD_Frame_Decode(&decoder, encoded, n) == 0);
+    HOST_CHECK((frameCount == 0) && (decoder.Errors == 1));
+}
+
+static void test_format(void)
+{
+    char text[32];
+    uint16_t length;
+
+    length = XPD_Format(text, sizeof(text), "%d|%5u|%-4x|%.2q|%s%c", -12, 42, 0xAB, 1234, "ok", '!');
+    HOST_CHECK((length == 24) && (memcmp(text, "-12|   42|ab  |12.34|ok!", length) == 0));
+
+    HOST_CHECK(XPD_Format(text, 4, "%s", "too long") == 0);
+}
+
+void test_utils(void)
+{
+    test_ring();
+    test_queue();
+    test_stream();
+    test_frame_type(XPD_FRAMING_COBS);
+    test_frame_type(XPD_FRAMING_SLIP);
+    test_format();
+}